@@ -0,0 +1,50 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2005 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    (if your name is missing here, please add it)
+*/
+
+/*
+	Test for a compatible and working library.
+*/
+
+#include <X11/extensions/XInput2.h>
+// todo: add headers needed here.
+
+int main(int, char**)
+{
+	// todo: Add version info check here (if possible)
+//	return 1; // failure
+
+	return 0; // success
+}
+
+void used_stuff()
+{
+	// todo: call all functions used here (to make sure parameters are
+	// still the same, and that functions are resolved at linking.
+	XIQueryVersion(0, 0, 0);
+}
+
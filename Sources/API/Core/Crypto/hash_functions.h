@@ -38,9 +38,13 @@
 #include "../Crypto/sha512.h"
 #include "../Crypto/sha512_224.h"
 #include "../Crypto/sha512_256.h"
+#include <string>
+#include <vector>
 
 namespace clan
 {
+	class WorkQueue;
+
 	/// \addtogroup clanCore_Crypto clanCore Crypto
 	/// \{
 
@@ -207,6 +211,39 @@ namespace clan
 		/// \param out_hash = char
 		static void sha256(const DataBuffer &data, unsigned char out_hash[32]);
 
+		/// \brief Generate SHA-256 hashes of many independent buffers
+		///
+		/// Without SHA instructions, buffers are hashed eight at a time with AVX2 when the CPU supports it.
+		///
+		/// \param data = Pointers to the buffers
+		/// \param sizes = Sizes of the buffers
+		/// \param count = Number of buffers
+		/// \param out_hashes = Receives 32 bytes for each buffer
+		static void sha256_multi(const void *const *data, const int *sizes, int count, unsigned char *out_hashes);
+
+		/// \brief Generate SHA-256 hashes of many independent buffers, spread over the worker threads of a work queue
+		///
+		/// The calling thread hashes buffers as well and returns when all hashes are done.
+		static void sha256_multi(WorkQueue &work_queue, const void *const *data, const int *sizes, int count, unsigned char *out_hashes);
+
+		/// \brief Generate SHA-256 hashes of files
+		///
+		/// Files are read in chunks with an AsyncFileReader, and each chunk is hashed on the work queue while
+		/// the reads of other files are in flight. The calling thread helps with the hashing until all files are done.
+		///
+		/// \param filenames = Files to hash
+		/// \param out_hashes = Receives 32 bytes for each file
+		/// \param max_files_in_flight = Number of files read at the same time
+		/// \return For each file, true if it could be read
+		static std::vector<bool> sha256_files(WorkQueue &work_queue, const std::vector<std::string> &filenames, unsigned char *out_hashes, int max_files_in_flight = 16);
+
+		/// \brief Verifies the SHA-256 hashes of files
+		///
+		/// \param filenames = Files to verify
+		/// \param expected_hashes = 32 bytes for each file
+		/// \return Indices of the files that could not be read or did not match their hash
+		static std::vector<int> sha256_verify_files(WorkQueue &work_queue, const std::vector<std::string> &filenames, const unsigned char *expected_hashes, int max_files_in_flight = 16);
+
 		/// \brief Generate SHA-384 hash from data.
 		static std::string sha384(const void *data, int size, bool uppercase = false);
 
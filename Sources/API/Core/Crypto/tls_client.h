@@ -37,6 +37,7 @@ namespace clan
 	/// \{
 
 	class DataBuffer;
+	class Secret;
 	class TLSClient_Impl;
 
 	/// \brief Transport Layer Security (TLS) client class
@@ -59,6 +60,8 @@ namespace clan
 		int get_encrypted_data_available() const;
 
 		/// \brief Adds data to be encrypted.
+		///
+		/// Passing 0 bytes advances the handshake without adding data.
 		int encrypt(const void *data, int size);
 
 		/// \brief Adds data to be decrypted.
@@ -70,6 +73,25 @@ namespace clan
 		/// \brief Marks encrypted data as consumed.
 		void encrypted_data_consumed(int size);
 
+		/// \brief Returns true when the handshake has completed
+		bool is_connected() const;
+
+		/// \brief Offers a session from an earlier connection to the server
+		///
+		/// If the server agrees to resume it the handshake skips the certificate and the RSA key exchange.
+		/// Must be called before any data is passed to encrypt or decrypt.
+		/// \param session = Session returned by get_session for the same server
+		void set_session(const Secret &session);
+
+		/// \brief Returns the session of this connection for resuming it later
+		///
+		/// The session contains the master secret and must be kept as secure as the connection itself.
+		/// \return The session, or an empty secret if the handshake is incomplete or the server does not support resumption
+		Secret get_session() const;
+
+		/// \brief Returns true if the server agreed to resume the session passed to set_session
+		bool is_session_resumed() const;
+
 	private:
 		std::shared_ptr<TLSClient_Impl> impl;
 	};
@@ -30,6 +30,7 @@
 
 #include <string>
 #include <memory>
+#include <cstdint>
 
 namespace clan
 {
@@ -61,6 +62,16 @@ namespace clan
 		/// \brief Generate a crash report for the current thread without terminating.
 		static void generate_report();
 
+		/// \brief Returns an identifier for the calling thread, for use with capture_thread_stack().
+		static uint64_t get_current_thread_id();
+
+		/// \brief Captures the call stack of another thread in this process.
+		///
+		/// The thread is interrupted briefly while its stack is walked. Frames can be converted to text
+		/// with System::get_stack_frames_text.
+		/// \return The number of frames written to out_frames, or 0 if not supported on this platform.
+		static int capture_thread_stack(uint64_t thread_id, int max_frames, void **out_frames);
+
 	private:
 		std::shared_ptr<CrashReporter_Impl> impl;
 	};
@@ -0,0 +1,97 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+**    Harry Storbacka
+*/
+
+#pragma once
+
+#include <memory>
+#include <functional>
+#include <string>
+#include "../System/cl_platform.h"
+
+namespace clan
+{
+	/// \addtogroup clanCore_I_O_Data clanCore I/O Data
+	/// \{
+
+	class DataBuffer;
+	class WorkQueue;
+	class AsyncFileReader_Impl;
+
+	/// \brief Reads files asynchronously with many reads in flight at once
+	///
+	/// Reads are collected until submit() is called and then started together. On Linux they are
+	/// executed by io_uring, on Windows by overlapped I/O on a completion port and on macOS by dispatch_io.
+	/// When none of these are available each read is a blocking read on a worker thread of the work queue.
+	///
+	/// The completion callbacks are queued as work on the work queue passed to the constructor.
+	class AsyncFileReader
+	{
+	public:
+		/// \brief Called with the data read, or with success set to false if the file could not be read
+		///
+		/// The data is shorter than requested if the read went past the end of the file.
+		typedef std::function<void(bool success, DataBuffer &data)> Callback;
+
+		/// \brief Constructs a null instance
+		AsyncFileReader();
+
+		/// \brief Constructs an async file reader
+		///
+		/// \param completion_queue = Work queue that runs the completion callbacks
+		AsyncFileReader(const WorkQueue &completion_queue);
+
+		~AsyncFileReader();
+
+		/// \brief Returns true if this object is invalid.
+		bool is_null() const { return !impl; }
+
+		/// \brief Returns the name of the I/O mechanism used ("io_uring", "iocp", "dispatch_io" or "pread")
+		std::string get_backend_name() const;
+
+		/// \brief Returns the number of reads whose callbacks have not been queued yet
+		int get_reads_pending() const;
+
+		/// \brief Adds a read of part of a file to the current batch
+		void read(const std::string &filename, int64_t offset, int size, const Callback &completed);
+
+		/// \brief Adds a read of a whole file to the current batch
+		void read_file(const std::string &filename, const Callback &completed);
+
+		/// \brief Starts all reads in the current batch
+		///
+		/// Reads that have not been submitted when the reader is destroyed are dropped without calling their callbacks.
+		/// The destructor waits for submitted reads to finish.
+		void submit();
+
+	private:
+		std::shared_ptr<AsyncFileReader_Impl> impl;
+	};
+
+	/// \}
+}
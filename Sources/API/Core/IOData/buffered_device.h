@@ -0,0 +1,62 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include "iodevice.h"
+
+namespace clan
+{
+	/// \addtogroup clanCore_I_O_Data clanCore I/O Data
+	/// \{
+
+	/// \brief I/O device that buffers reads from another device
+	///
+	/// Small reads are served from a buffer that is filled by one large read of the device. Reads at least as
+	/// large as the buffer go straight to the device. Writes, and seeks outside the buffered data, discard the buffer.
+	/// When the last copy of the buffered device is destroyed, data read ahead but not consumed is given back by
+	/// seeking the device backwards.
+	class BufferedDevice : public IODevice
+	{
+	public:
+		/// \brief Constructs a buffered device
+		///
+		/// \param device = Device to read from
+		/// \param buffer_size = Size of the read buffer in bytes
+		BufferedDevice(IODevice device, int buffer_size = 32 * 1024);
+
+		/// \brief Returns the device being buffered
+		IODevice get_device();
+
+		/// \brief Returns the size of the read buffer
+		int get_buffer_size() const;
+	};
+
+	/// \}
+}
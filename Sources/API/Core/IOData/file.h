@@ -46,6 +46,13 @@ namespace clan
 		/// \brief Loads an file into a byte buffer.
 		static DataBuffer read_bytes(const std::string &filename);
 
+		/// \brief Maps a file into memory instead of reading it.
+		///
+		/// <p>Pages are only read from disk when they are first accessed. The mapping is copy-on-write,
+		///    so changes to the buffer are not written back to the file. The file must not be
+		///    truncated while the buffer exists.</p>
+		static DataBuffer map_bytes(const std::string &filename);
+
 		/// \brief Saves an UTF-8 text string to file.
 		static void write_text(const std::string &filename, const std::string &text, bool write_bom = false);
 
@@ -29,6 +29,9 @@
 
 #pragma once
 
+#include <cstdint>
+#include <string>
+
 namespace clan
 {
 	/// \addtogroup clanCore_I_O_Data clanCore I/O Data
@@ -54,6 +57,13 @@ namespace clan
 		///
 		/// \param filename File to check for existance
 		static bool file_exists(const std::string &filename);
+
+		/// \brief Returns when a file was last written to.
+		///
+		/// The value is only meaningful when compared with other values returned by this function.
+		/// \param filename File to check
+		/// \return The last write time, or 0 if the file does not exist
+		static uint64_t get_last_write_time(const std::string &filename);
 	};
 
 	/// \}
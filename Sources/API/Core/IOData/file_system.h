@@ -108,6 +108,9 @@ namespace clan
 			For example:
 			FileSystem new_vfs(new MyFileSource("Hello"));
 			vfs.mount("ABC", new_vfs);
+			Several file systems can be mounted at the same mount point. The mounted file systems are listed into one
+			merged index, in which files of the most recently mounted file system override files with the same name
+			in earlier ones. This allows patch archives to be mounted over base archives.
 			param: mount_point = Mount alias name to use
 			param: fs = Filesystem to use*/
 		void mount(const std::string &mount_point, FileSystem fs);
@@ -124,6 +127,12 @@ namespace clan
 		/** param: mount_point = The mount point to unmount*/
 		void unmount(const std::string &mount_point);
 
+		/// \brief Lists the mounted file systems again
+		/** The merged index and the cache of files that could not be opened are only updated for mount changes
+			done through this FileSystem. Call this after files were added or removed in a mounted directory.
+			param: mount_point = The mount point to refresh, or an empty string to refresh all mounts*/
+		void refresh_index(const std::string &mount_point = std::string());
+
 	private:
 		class NullVFS { };
 		explicit FileSystem(class NullVFS null_fs);
@@ -81,12 +81,12 @@ namespace clan
 		/// \brief Returns the size of data stream.
 		/** <p>Returns -1 if the size is unknown.</p>
 			\return The size (-1 if size is unknown)*/
-		int get_size() const;
+		int64_t get_size() const;
 
 		/// \brief Returns the position in the data stream.
 		/** <p>Returns -1 if the position is unknown.</p>
 			\return The size (-1 if position is unknown)*/
-		int get_position() const;
+		int64_t get_position() const;
 
 		/// \brief Returns true if the input source is in little endian mode.
 		/** \return true if little endian*/
@@ -127,7 +127,7 @@ namespace clan
 		/// \param position Position to use (usage depends on the seek mode)
 		/// \param mode Seek mode
 		/// \return false = Failed
-		bool seek(int position, SeekMode mode = seek_set);
+		bool seek(int64_t position, SeekMode mode = seek_set);
 
 		/// \brief Alias for receive(data, len, receive_all)
 		///
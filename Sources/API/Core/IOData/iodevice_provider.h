@@ -43,11 +43,11 @@ namespace clan
 
 		/// \brief Returns the size of data stream.
 		/** <p>Returns -1 if the size is unknown.</p>*/
-		virtual int get_size() const { return -1; }
+		virtual int64_t get_size() const { return -1; }
 
 		/// \brief Returns the position in the data stream.
 		/** <p>Returns -1 if the position is unknown.</p>*/
-		virtual int get_position() const { return -1; }
+		virtual int64_t get_position() const { return -1; }
 
 		/// \brief Send data to device.
 		virtual int send(const void *data, int len, bool send_all = true) = 0;
@@ -62,7 +62,7 @@ namespace clan
 		virtual IODeviceProvider *duplicate() = 0;
 
 		/// \brief Seek in data stream.
-		virtual bool seek(int /*position*/, IODevice::SeekMode /*mode*/) { return false; }
+		virtual bool seek(int64_t /*position*/, IODevice::SeekMode /*mode*/) { return false; }
 	};
 
 	/// \}
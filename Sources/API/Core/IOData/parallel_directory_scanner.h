@@ -0,0 +1,120 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <cstdint>
+
+namespace clan
+{
+	/// \addtogroup clanCore_I_O_Data clanCore I/O Data
+	/// \{
+
+	class ParallelDirectoryScanner_Impl;
+
+	/// \brief Recursive directory scanner that lists directories on worker threads.
+	///
+	///    <p>Subdirectories are listed in parallel while the caller consumes the entries found so far with next().
+	///    The order of the entries is not defined, except that a directory is always returned before its contents.
+	///    Symbolic links and junctions to directories are returned but not followed.</p>
+	///    -
+	///    <p>Example that prints all PNG files below a directory:</p>
+	///    <pre>
+	///    ParallelDirectoryScanner scanner;
+	///    if (scanner.scan("Resources", "*.png"))
+	///    {
+	///    		while (scanner.next())
+	///    		{
+	///    				if (!scanner.is_directory())
+	///    						cl_console_write_line(scanner.get_pathname());
+	///    		}
+	///    }
+	///    </pre>
+	class ParallelDirectoryScanner
+	{
+	public:
+		/// \brief Constructs a parallel directory scanner.
+		ParallelDirectoryScanner();
+
+		/// \brief Destructor. Stops a scan in progress.
+		~ParallelDirectoryScanner();
+
+		/// \brief Gets the directory containing the current file.
+		/** \return Directory path (including the trailing slash)*/
+		std::string get_directory_path();
+
+		/// \brief Gets the name of the current file.
+		std::string get_name();
+
+		/// \brief Gets the pathname of the current file.
+		/** \return The name of the current file, including the directory path.*/
+		std::string get_pathname();
+
+		/// \brief Gets the size of the current file.
+		int64_t get_size();
+
+		/// \brief Returns true if the current file is a directory.
+		bool is_directory();
+
+		/// \brief Returns true if the current file is hidden.
+		bool is_hidden();
+
+		/// \brief Starts scanning a directory tree.
+		/** <p>Entries whose name does not match the pattern are skipped before their name is converted or copied.
+			All subdirectories are scanned, whether or not their own name matches.</p>
+			\param pathname Path to the directory to scan (without trailing slash)
+			\param pattern Pattern to match file and directory names against (*, ?)
+			\param num_threads Number of worker threads, or 0 to use one per core
+			\return true if the directory can be accessed.*/
+		bool scan(const std::string &pathname, const std::string &pattern = "*", int num_threads = 0);
+
+		/// \brief Waits for the next entry of the scan.
+		/** \return false if the scan is complete.*/
+		bool next();
+
+		/// \brief Stops the scan in progress.
+		void cancel();
+
+		/// \brief Enables caching of directory listings, shared by all scanners.
+		/** <p>A cached listing is reused as long as the modification time of its directory is unchanged.
+			The modification time of a directory changes when entries are added, removed or renamed,
+			but not when an existing file is written to, so cached file sizes can be out of date.</p>*/
+		static void set_cache_enabled(bool enable);
+
+		/// \brief Removes all cached directory listings.
+		static void clear_cache();
+
+	private:
+		std::shared_ptr<ParallelDirectoryScanner_Impl> impl;
+	};
+
+	/// \}
+}
@@ -71,10 +71,21 @@ namespace clan
 		static JsonValue number(unsigned char value) { return JsonValue::number(static_cast<double>(value)); }
 		static JsonValue boolean(bool value) { JsonValue v; v._type = JsonType::boolean; v._boolean = value; return v; }
 		static JsonValue string(const std::string &value) { JsonValue v; v._type = JsonType::string; v._string = value; return v; }
+		static JsonValue string(std::string &&value) { JsonValue v; v._type = JsonType::string; v._string = std::move(value); return v; }
 
 		static JsonValue parse(const std::string &json);
+
+		/// \brief Parses JSON in situ
+		///
+		/// Strings containing escapes are decoded in place, so the contents of the buffer are modified.
+		/// The buffer does not need to be null terminated.
+		static JsonValue parse(char *json, size_t length);
+
 		std::string to_json() const;
 
+		/// \brief Writes the JSON text into json, replacing its contents but keeping its capacity
+		void to_json(std::string &json) const;
+
 		const JsonValue &prop(const std::string &name) const { auto it = _properties.find(name); if (it != _properties.end()) return it->second; static JsonValue undef; return undef; }
 		const JsonValue &prop(const char *name) const { auto it = _properties.find(name); if (it != _properties.end()) return it->second; static JsonValue undef; return undef; }
 		JsonValue &prop(const std::string &name) { return _properties[name]; }
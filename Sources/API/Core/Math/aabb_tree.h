@@ -0,0 +1,125 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include "aabb.h"
+#include "broadphase_pair.h"
+#include <vector>
+
+namespace clan
+{
+	/// \addtogroup clanCore_Math clanCore Math
+	/// \{
+
+	class FrustumPlanes;
+	class WorkQueue;
+
+	/// \brief Dynamic bounding volume hierarchy of axis aligned boxes
+	///
+	/// <p>Each proxy is stored with a box enlarged by a margin, so small movements do not touch the tree.
+	///    Inserts pick the sibling that grows the surface area the least and rotations keep the tree balanced.
+	///    Suited for scenes where objects of very different sizes move independently.</p>
+	/// <p>Queries and pair generation only read the tree, so they may run on several threads at once.
+	///    Changes must not overlap with queries.</p>
+	class AxisAlignedBoundingBoxTree
+	{
+	public:
+		/// \brief Constructs a tree
+		///
+		/// \param margin Distance the stored boxes are enlarged by on every side
+		AxisAlignedBoundingBoxTree(float margin = 0.1f);
+
+		/// \brief Adds a proxy and returns its id
+		int insert(const AxisAlignedBoundingBox &box);
+
+		/// \brief Moves a proxy to a new box
+		///
+		/// \return true if the proxy left its enlarged box and was reinserted
+		bool update(int id, const AxisAlignedBoundingBox &box);
+
+		/// \brief Removes a proxy. The id may be returned by a later insert.
+		void remove(int id);
+
+		/// \brief Removes all proxies
+		void clear();
+
+		/// \brief Returns the box last given for a proxy
+		const AxisAlignedBoundingBox &get_box(int id) const { return nodes[id].box; }
+
+		/// \brief Returns the number of proxies
+		int get_count() const { return count; }
+
+		/// \brief Returns the height of the tree, 0 for an empty tree
+		int get_height() const;
+
+		/// \brief Appends the ids of the proxies overlapping a box
+		void query(const AxisAlignedBoundingBox &box, std::vector<int> &out_ids) const;
+
+		/// \brief Appends the ids of the proxies hit by the line segment from ray_start to ray_end
+		void query_ray(const Vec3f &ray_start, const Vec3f &ray_end, std::vector<int> &out_ids) const;
+
+		/// \brief Appends the ids of the proxies that are not fully outside a frustum
+		void query_frustum(const FrustumPlanes &frustum, std::vector<int> &out_ids) const;
+
+		/// \brief Appends every overlapping pair of proxies, sorted
+		void find_pairs(std::vector<BroadphasePair> &out_pairs) const;
+
+		/// \brief Appends every overlapping pair of proxies, sorted, searching from the worker threads of a work queue
+		void find_pairs(WorkQueue &queue, std::vector<BroadphasePair> &out_pairs) const;
+
+	private:
+		struct Node
+		{
+			AxisAlignedBoundingBox fat_box;	// Enlarged box of a leaf, or the union of the children
+			AxisAlignedBoundingBox box;	// Exact box of a leaf
+			int parent;	// Next free node when unused
+			int child1;
+			int child2;
+			int height;	// 0 for leaves, -1 for unused nodes
+
+			bool is_leaf() const { return child1 == -1; }
+		};
+
+		int allocate_node();
+		void free_node(int index);
+		void insert_leaf(int leaf);
+		void remove_leaf(int leaf);
+		int balance(int index);
+		void find_leaf_pairs(int first_node, int last_node, std::vector<BroadphasePair> &out_pairs) const;
+
+		std::vector<Node> nodes;	// Proxy ids are the indices of their leaf nodes
+		int root = -1;
+		int free_list = -1;
+		int count = 0;
+		float margin;
+	};
+
+	/// \}
+}
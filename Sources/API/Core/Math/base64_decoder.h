@@ -54,6 +54,16 @@ namespace clan
 		/// \brief Feeds the decoder with base64 encoded data.
 		void feed(const void *data, int size, bool append_result = true);
 
+		/// \brief Returns the largest number of bytes base64 decoding size characters can produce.
+		static int get_decoded_size(int size);
+
+		/// \brief Decodes base64 data into a caller provided buffer.
+		///
+		/// Trailing characters not forming a complete block of four are ignored, like decode() does.
+		/// \param out_buffer = Buffer with room for get_decoded_size(size) bytes.
+		/// \return Number of bytes written, excluding any padding.
+		static int decode(const void *data, int size, void *out_buffer);
+
 		/// \brief Decode base64 data and return it in a buffer.
 		static DataBuffer decode(const void *data, int size);
 
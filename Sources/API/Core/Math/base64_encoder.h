@@ -58,6 +58,15 @@ namespace clan
 		/// \brief Ends the base64 encoding.
 		void finalize(bool append_result = true);
 
+		/// \brief Returns the number of characters base64 encoding size bytes produces, including padding.
+		static int get_encoded_size(int size);
+
+		/// \brief Base64 encodes data into a caller provided buffer.
+		///
+		/// \param out_buffer = Buffer with room for get_encoded_size(size) characters. No null terminator is written.
+		/// \return Number of characters written.
+		static int encode(const void *data, int size, char *out_buffer);
+
 		/// \brief Base64 encodes data and returns it as an 8 bit string.
 		static std::string encode(const void *data, int size);
 
@@ -0,0 +1,116 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "vec3.h"
+#include "vec4.h"
+#include "mat4.h"
+#include "aabb.h"
+#include "point.h"
+#include <vector>
+
+namespace clan
+{
+	/// \addtogroup clanCore_Math clanCore Math
+	/// \{
+
+	class FrustumPlanes;
+	class OrientedBoundingBox;
+	class WorkQueue;
+
+	/// \brief Math operations on arrays of vectors.
+	///
+	/// These functions use SSE, AVX or NEON when available, which is several times faster than
+	/// transforming one vector at a time. Input and output arrays may be the same.
+	class BatchMath
+	{
+	public:
+		/// \brief Transforms points by a matrix, treating them as (x, y, z, 1) and dropping w
+		static void transform_points(const Mat4f &matrix, const Vec3f *in, Vec3f *out, size_t count);
+
+		/// \brief Transforms points by a matrix, treating them as (x, y, z, 1) and keeping w for perspective projections
+		static void transform_points(const Mat4f &matrix, const Vec3f *in, Vec4f *out, size_t count);
+
+		/// \brief Transforms points stored as separate x, y and z arrays, treating them as (x, y, z, 1) and dropping w
+		static void transform_points(const Mat4f &matrix, const float *in_x, const float *in_y, const float *in_z, float *out_x, float *out_y, float *out_z, size_t count);
+
+		/// \brief Multiplies each vector by the matrix (matrix * vector)
+		static void transform_vectors(const Mat4f &matrix, const Vec4f *in, Vec4f *out, size_t count);
+
+		/// \brief Transforms normals for a matrix and normalizes them
+		///
+		/// The normals are transformed by the inverse transpose of the matrix, so non-uniform scaling is handled correctly.
+		/// Zero length normals stay zero.
+		static void transform_normals(const Mat4f &matrix, const Vec3f *in, Vec3f *out, size_t count);
+
+		/// \brief Returns the bounding box of the points, or an empty box at the origin if count is 0
+		static AxisAlignedBoundingBox bounding_box(const Vec3f *points, size_t count);
+
+		/// \brief Returns the bounding box of points stored as separate x, y and z arrays, or an empty box at the origin if count is 0
+		static AxisAlignedBoundingBox bounding_box(const float *x, const float *y, const float *z, size_t count);
+
+		/// \brief Tests boxes against a frustum and writes a visibility bit mask
+		///
+		/// Bit (i % 32) of out_visible_mask[i / 32] is set for every box that is not fully outside the frustum.
+		/// \param out_visible_mask Array of (count + 31) / 32 words
+		/// \return The number of visible boxes
+		static size_t frustum_cull(const FrustumPlanes &frustum, const AxisAlignedBoundingBox *boxes, size_t count, uint32_t *out_visible_mask);
+		static size_t frustum_cull(const FrustumPlanes &frustum, const OrientedBoundingBox *boxes, size_t count, uint32_t *out_visible_mask);
+
+		/// \brief Tests boxes against a frustum on the worker threads of a work queue and writes a visibility bit mask
+		static size_t frustum_cull(WorkQueue &queue, const FrustumPlanes &frustum, const AxisAlignedBoundingBox *boxes, size_t count, uint32_t *out_visible_mask);
+		static size_t frustum_cull(WorkQueue &queue, const FrustumPlanes &frustum, const OrientedBoundingBox *boxes, size_t count, uint32_t *out_visible_mask);
+
+		/// \brief Tests boxes against a frustum and writes the indices of the boxes that are not fully outside, in ascending order
+		///
+		/// \param out_visible_indices Array of count indices
+		/// \return The number of visible boxes
+		static size_t frustum_cull_indices(const FrustumPlanes &frustum, const AxisAlignedBoundingBox *boxes, size_t count, unsigned int *out_visible_indices);
+		static size_t frustum_cull_indices(const FrustumPlanes &frustum, const OrientedBoundingBox *boxes, size_t count, unsigned int *out_visible_indices);
+
+		/// \brief Writes the indices of the set bits in a visibility mask, in ascending order, and returns how many there are
+		static size_t mask_to_indices(const uint32_t *visible_mask, size_t count, unsigned int *out_indices);
+
+		/// \brief Returns how many line segments keep a cubic bezier within tolerance of its polyline
+		///
+		/// The count follows from the second differences of the four control points (Wang's formula) and is clamped to 1 - max_bezier_segments.
+		static int get_cubic_bezier_segments(const Pointf *control_points, float tolerance);
+
+		/// \brief Flattens cubic bezier curves into polylines by forward differencing
+		///
+		/// Each curve is given by four control points. The end points of its segments, excluding the start point
+		/// of the curve, are appended to out_points and the number of points added is appended to out_segment_counts.
+		/// Both vectors can be reused between calls to avoid allocations.
+		static void flatten_cubic_beziers(const Pointf *control_points, size_t count, float tolerance, std::vector<Pointf> &out_points, std::vector<int> &out_segment_counts);
+
+		static const int max_bezier_segments = 1024;
+	};
+
+	/// \}
+}
@@ -61,6 +61,12 @@ namespace clan
 		/// \brief Generates points on the bezier curve.
 		std::vector<Pointf> generate_curve_points(const Angle &split_angle);
 
+		/// \brief Generates points on the bezier curve, keeping the polyline within tolerance of the curve.
+		///
+		/// The points are appended to out_points, so a vector can be reused as a scratch buffer between curves.
+		/// Cubic curves are flattened by forward differencing (see BatchMath::flatten_cubic_beziers).
+		void generate_curve_points(float tolerance, std::vector<Pointf> &out_points) const;
+
 		/// \brief Get a point on the bezier curve.
 		Pointf get_point_relative(float pos_0_to_1) const;
 
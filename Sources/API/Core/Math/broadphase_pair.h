@@ -0,0 +1,55 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+namespace clan
+{
+	/// \addtogroup clanCore_Math clanCore Math
+	/// \{
+
+	/// \brief Two proxies whose boxes overlap, as reported by the broadphase structures
+	///
+	/// The proxy with the lower id is always first, and every overlapping pair is reported once.
+	class BroadphasePair
+	{
+	public:
+		BroadphasePair() : first(0), second(0) { }
+		BroadphasePair(int first, int second) : first(first), second(second) { }
+
+		bool operator==(const BroadphasePair &other) const { return first == other.first && second == other.second; }
+		bool operator!=(const BroadphasePair &other) const { return !(*this == other); }
+		bool operator<(const BroadphasePair &other) const { return first < other.first || (first == other.first && second < other.second); }
+
+		int first;
+		int second;
+	};
+
+	/// \}
+}
@@ -71,6 +71,9 @@ namespace clan
 	///    <p>This class uses the <a href="http://astronomy.swin.edu.au/~pbourke/terrain/triangulate/">
 	///    delauney triangulation algorithm</a> to produce
 	///    triangles between a list of points.</p>
+	///
+	///    <p>Points are inserted in z-order and located by walking the triangle neighbours, so large
+	///    point sets triangulate in O(n log n) time. Duplicated points are only used once.</p>
 	class DelauneyTriangulator
 	{
 	public:
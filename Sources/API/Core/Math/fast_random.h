@@ -0,0 +1,136 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "../System/cl_platform.h"
+
+namespace clan
+{
+	/// \addtogroup clanCore_Math clanCore Math
+	/// \{
+
+	/// \brief Fast seedable pseudorandom number generator (xoshiro256++)
+	///
+	/// Intended for gameplay, particles and procedural content. The output is predictable and must not be used
+	/// for anything security related; use clan::Random for that.
+	class FastRandom
+	{
+	public:
+		/// \brief Constructs a generator seeded from the operating system random number generator
+		FastRandom();
+
+		/// \brief Constructs a generator with a fixed seed, giving a reproducible sequence
+		explicit FastRandom(uint64_t seed) { set_seed(seed); }
+
+		/// \brief Restarts the sequence from a seed
+		void set_seed(uint64_t seed)
+		{
+			// Expand the seed with splitmix64, which never produces the all zero state
+			for (auto &s : state)
+			{
+				seed += 0x9e3779b97f4a7c15ULL;
+				uint64_t z = seed;
+				z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+				z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+				s = z ^ (z >> 31);
+			}
+		}
+
+		/// \brief Returns 64 random bits
+		uint64_t next_uint64()
+		{
+			uint64_t result = rotl(state[0] + state[3], 23) + state[0];
+			uint64_t t = state[1] << 17;
+			state[2] ^= state[0];
+			state[3] ^= state[1];
+			state[1] ^= state[2];
+			state[0] ^= state[3];
+			state[2] ^= t;
+			state[3] = rotl(state[3], 45);
+			return result;
+		}
+
+		/// \brief Returns 32 random bits
+		uint32_t next_uint32() { return (uint32_t)(next_uint64() >> 32); }
+
+		/// \brief Returns true or false with equal probability
+		bool next_bool() { return (int64_t)next_uint64() < 0; }
+
+		/// \brief Returns a uniform float in the range [0, 1)
+		float next_float() { return (next_uint64() >> 40) * (1.0f / 16777216.0f); }
+
+		/// \brief Returns a uniform float in the range [min_value, max_value)
+		float next_float(float min_value, float max_value) { return min_value + (max_value - min_value) * next_float(); }
+
+		/// \brief Returns a uniform double in the range [0, 1)
+		double next_double() { return (next_uint64() >> 11) * (1.0 / 9007199254740992.0); }
+
+		/// \brief Returns a uniform integer in the range [min_value, max_value], both inclusive
+		int next_int(int min_value, int max_value)
+		{
+			uint32_t range = (uint32_t)max_value - (uint32_t)min_value + 1;
+			if (range == 0)
+				return (int)next_uint32();	// Full 32 bit range
+
+			// Lemire's nearly divisionless method, rejecting the few values that would bias the result
+			uint64_t m = (uint64_t)next_uint32() * range;
+			if ((uint32_t)m < range)
+			{
+				uint32_t threshold = (0 - range) % range;
+				while ((uint32_t)m < threshold)
+					m = (uint64_t)next_uint32() * range;
+			}
+			return (int)((uint32_t)min_value + (uint32_t)(m >> 32));
+		}
+
+		/// \brief Advances the generator by 2^128 steps
+		///
+		/// Calling jump() on copies of a generator gives non-overlapping sequences for parallel use.
+		void jump();
+
+		/// \brief Fills a buffer with random bytes
+		///
+		/// Large buffers are filled using four interleaved streams with SSE2. The bytes produced are
+		/// therefore not the same as calling next_uint64() repeatedly, but are reproducible for a given seed.
+		void fill(void *dest, size_t num_bytes);
+
+		/// \brief Fills an array with uniform floats in the range [0, 1)
+		void fill(float *dest, size_t count);
+
+		/// \brief Fills an array with uniform floats in the range [min_value, max_value)
+		void fill(float *dest, size_t count, float min_value, float max_value);
+
+	private:
+		static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+		uint64_t state[4];
+	};
+
+	/// \}
+}
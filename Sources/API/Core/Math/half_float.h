@@ -28,6 +28,8 @@
 
 #pragma once
 
+#include <cstddef>
+
 namespace clan
 {
 	/// \addtogroup clanCore_Math clanCore Math
@@ -105,6 +107,17 @@ namespace clan
 			return base_table[(f >> 23) & 0x1ff] + ((f & 0x007fffff) >> shift_table[(f >> 23) & 0x1ff]);
 		}
 
+		/// \brief Converts an array of half-floats to floats
+		///
+		/// Uses F16C or NEON instructions when available.
+		static void half_to_float(const unsigned short *input, float *output, size_t count);
+
+		/// \brief Converts an array of floats to half-floats
+		///
+		/// Uses F16C or NEON instructions when available. Unlike float_to_half(float), which truncates,
+		/// the values are rounded to nearest even, the same way on all CPUs.
+		static void float_to_half(const float *input, unsigned short *output, size_t count);
+
 	private:
 		unsigned short value;
 
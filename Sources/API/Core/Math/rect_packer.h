@@ -29,6 +29,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 #include "rect.h"
 
 namespace clan
@@ -51,6 +52,19 @@ namespace clan
 			fail_if_full
 		};
 
+		/// \brief Packing algorithm.
+		enum PackingMethod
+		{
+			/// \brief Splits the free space as a binary tree. Fast, but wastes space when the sizes vary a lot.
+			binary_tree,
+
+			/// \brief Keeps a list of the largest free rects and picks the best fit for each rect. Packs the tightest.
+			max_rects,
+
+			/// \brief Places each rect as low as possible on the top edge of the used area. Fast, and packs well when heights are similar, such as glyphs.
+			skyline
+		};
+
 		struct AllocatedRect
 		{
 		public:
@@ -63,7 +77,7 @@ namespace clan
 		RectPacker();
 
 		/// \brief Constructs a rect group.
-		RectPacker(const Size &max_group_size, AllocationPolicy policy = create_new_group);
+		RectPacker(const Size &max_group_size, AllocationPolicy policy = create_new_group, PackingMethod method = binary_tree);
 
 		~RectPacker();
 
@@ -76,9 +90,15 @@ namespace clan
 		/// \brief Returns the allocation policy.
 		AllocationPolicy get_allocation_policy() const;
 
+		/// \brief Returns the packing algorithm.
+		PackingMethod get_packing_method() const;
+
 		/// \brief Returns the max group size.
 		Size get_max_group_size() const;
 
+		/// \brief Returns the block size rects are aligned to.
+		Size get_block_size() const;
+
 		/// \brief Returns the total amount of rects.
 		int get_total_rect_count() const;
 
@@ -91,9 +111,21 @@ namespace clan
 		/// \brief Set the allocation policy.
 		void set_allocation_policy(AllocationPolicy policy);
 
+		/// \brief Align rects to a block size, such as 4x4 for block compressed textures.
+		///
+		/// Rect positions become multiples of the block size, and the space reserved for each rect is rounded up to whole blocks.
+		/// Must be set before any rects are added.
+		void set_block_size(const Size &block_size);
+
 		/// \brief Allocate space for another rect.
 		AllocatedRect add(const Size &size);
 
+		/// \brief Allocate space for many rects.
+		///
+		/// The rects are placed largest first, by area and then by perimeter, which packs much tighter than adding them in arbitrary order.
+		/// \return The allocated rects, in the same order as sizes
+		std::vector<AllocatedRect> add_batch(const std::vector<Size> &sizes);
+
 	private:
 		std::shared_ptr<RectPacker_Impl> impl;
 	};
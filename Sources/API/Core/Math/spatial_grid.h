@@ -0,0 +1,135 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include "aabb.h"
+#include "broadphase_pair.h"
+#include <vector>
+
+namespace clan
+{
+	/// \addtogroup clanCore_Math clanCore Math
+	/// \{
+
+	class FrustumPlanes;
+	class WorkQueue;
+
+	/// \brief Uniform grid of axis aligned boxes
+	///
+	/// <p>Space inside the bounds is divided into cubic cells and each proxy is listed in every cell its box touches.
+	///    Boxes reaching outside the bounds are listed in the border cells. Updates only touch the cell lists when a box
+	///    moves into other cells. Suited for many objects of similar size, ideally not much larger than a cell.</p>
+	/// <p>Queries and pair generation only read the grid, so they may run on several threads at once.
+	///    Changes must not overlap with queries.</p>
+	class SpatialGrid
+	{
+	public:
+		/// \brief Constructs a grid
+		///
+		/// \param bounds Area covered by the cells
+		/// \param cell_size Width, height and depth of a cell
+		SpatialGrid(const AxisAlignedBoundingBox &bounds, float cell_size);
+
+		/// \brief Adds a proxy and returns its id
+		int insert(const AxisAlignedBoundingBox &box);
+
+		/// \brief Moves a proxy to a new box
+		void update(int id, const AxisAlignedBoundingBox &box);
+
+		/// \brief Removes a proxy. The id may be returned by a later insert.
+		void remove(int id);
+
+		/// \brief Removes all proxies
+		void clear();
+
+		/// \brief Returns the box last given for a proxy
+		const AxisAlignedBoundingBox &get_box(int id) const { return proxies[id].box; }
+
+		/// \brief Returns the number of proxies
+		int get_count() const { return count; }
+
+		/// \brief Appends the ids of the proxies overlapping a box
+		void query(const AxisAlignedBoundingBox &box, std::vector<int> &out_ids) const;
+
+		/// \brief Appends the ids of the proxies hit by the line segment from ray_start to ray_end
+		void query_ray(const Vec3f &ray_start, const Vec3f &ray_end, std::vector<int> &out_ids) const;
+
+		/// \brief Appends the ids of the proxies that are not fully outside a frustum, in ascending order
+		void query_frustum(const FrustumPlanes &frustum, std::vector<int> &out_ids) const;
+
+		/// \brief Appends every overlapping pair of proxies
+		void find_pairs(std::vector<BroadphasePair> &out_pairs) const;
+
+		/// \brief Appends every overlapping pair of proxies, searching the cells on the worker threads of a work queue
+		///
+		/// The pairs are appended in the same order as by the single threaded version.
+		void find_pairs(WorkQueue &queue, std::vector<BroadphasePair> &out_pairs) const;
+
+	private:
+		struct CellRange
+		{
+			int min_x, min_y, min_z;
+			int max_x, max_y, max_z;
+
+			bool operator==(const CellRange &other) const
+			{
+				return min_x == other.min_x && min_y == other.min_y && min_z == other.min_z && max_x == other.max_x && max_y == other.max_y && max_z == other.max_z;
+			}
+		};
+
+		struct Proxy
+		{
+			AxisAlignedBoundingBox box;
+			CellRange cells;
+			int outside_index;	// Position in outside_ids, or -1 if the box is inside the bounds
+			bool alive;
+		};
+
+		CellRange get_cell_range(const AxisAlignedBoundingBox &box) const;
+		int get_cell_index(int x, int y, int z) const { return (z * size_y + y) * size_x + x; }
+		void add_to_cells(int id);
+		void remove_from_cells(int id);
+		void find_cell_pairs(int first_cell, int last_cell, std::vector<BroadphasePair> &out_pairs) const;
+
+		AxisAlignedBoundingBox bounds;
+		float cell_size;
+		float rcp_cell_size;
+		int size_x, size_y, size_z;
+		std::vector<std::vector<int>> cells;
+
+		std::vector<Proxy> proxies;	// Indexed by proxy id
+		std::vector<AxisAlignedBoundingBox> boxes;	// Copy of the proxy boxes for the batched frustum test
+		std::vector<int> free_ids;
+		std::vector<int> outside_ids;	// Proxies reaching outside the bounds, which rays can hit outside the cells
+		int count = 0;
+	};
+
+	/// \}
+}
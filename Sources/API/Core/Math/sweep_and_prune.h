@@ -0,0 +1,109 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include "aabb.h"
+#include "broadphase_pair.h"
+#include <vector>
+
+namespace clan
+{
+	/// \addtogroup clanCore_Math clanCore Math
+	/// \{
+
+	class FrustumPlanes;
+	class WorkQueue;
+
+	/// \brief Sort and sweep broadphase over axis aligned boxes
+	///
+	/// <p>Proxies are kept sorted by the lower x bound of their boxes. The order is kept between calls and
+	///    repaired with an insertion sort, which is close to linear when objects move a little every frame.
+	///    Boxes are then tested four at a time with SSE or NEON.
+	///    Suited for many objects of similar size that move coherently.</p>
+	/// <p>Queries bring the sort order up to date first, so unlike AxisAlignedBoundingBoxTree they are not const and
+	///    must not run on several threads at once. find_pairs with a WorkQueue splits the sweep across worker threads.</p>
+	class SweepAndPrune
+	{
+	public:
+		/// \brief Adds a proxy and returns its id
+		int insert(const AxisAlignedBoundingBox &box);
+
+		/// \brief Moves a proxy to a new box
+		void update(int id, const AxisAlignedBoundingBox &box);
+
+		/// \brief Removes a proxy. The id may be returned by a later insert.
+		void remove(int id);
+
+		/// \brief Removes all proxies
+		void clear();
+
+		/// \brief Returns the box last given for a proxy
+		const AxisAlignedBoundingBox &get_box(int id) const { return boxes[id]; }
+
+		/// \brief Returns the number of proxies
+		int get_count() const { return count; }
+
+		/// \brief Appends the ids of the proxies overlapping a box
+		void query(const AxisAlignedBoundingBox &box, std::vector<int> &out_ids);
+
+		/// \brief Appends the ids of the proxies hit by the line segment from ray_start to ray_end
+		void query_ray(const Vec3f &ray_start, const Vec3f &ray_end, std::vector<int> &out_ids);
+
+		/// \brief Appends the ids of the proxies that are not fully outside a frustum
+		void query_frustum(const FrustumPlanes &frustum, std::vector<int> &out_ids);
+
+		/// \brief Appends every overlapping pair of proxies
+		void find_pairs(std::vector<BroadphasePair> &out_pairs);
+
+		/// \brief Appends every overlapping pair of proxies, sweeping on the worker threads of a work queue
+		///
+		/// The pairs are appended in the same order as by the single threaded version.
+		void find_pairs(WorkQueue &queue, std::vector<BroadphasePair> &out_pairs);
+
+	private:
+		void sort();
+		void sweep(int first, int last, std::vector<BroadphasePair> &out_pairs) const;
+
+		std::vector<AxisAlignedBoundingBox> boxes;	// Indexed by proxy id
+		std::vector<unsigned char> alive;
+		std::vector<int> free_ids;
+		int count = 0;
+
+		std::vector<int> order;	// Proxy ids sorted by lower x bound, kept between sorts
+		bool order_dirty = false;	// Boxes changed, or proxies were added or removed, since the last sort
+		bool order_membership_dirty = false;	// Proxies were added or removed since the last sort
+
+		// Boxes in sorted order as separate arrays, followed by padding that ends every sweep
+		std::vector<float> min_x, max_x, min_y, max_y, min_z, max_z;
+		std::vector<int> sorted_ids;
+	};
+
+	/// \}
+}
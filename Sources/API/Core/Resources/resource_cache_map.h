@@ -0,0 +1,176 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include "resource.h"
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace clan
+{
+	/// \addtogroup clanCore_Resources clanCore Resources
+	/// \{
+
+	/// \brief Map of cached resources that can evict the ones nobody else uses any more
+	///
+	/// A resource is considered unused when the cache holds the only reference to it. Unused resources
+	/// are evicted least recently used first, either explicitly with trim() or automatically when an
+	/// insert brings the estimated size above the budget. Pinned resources are never evicted.
+	template<typename Type>
+	class ResourceCacheMap
+	{
+	public:
+		typedef std::function<size_t(const Type &)> SizeFunction;
+
+		/// \brief Constructs a cache map
+		///
+		/// \param size_func = Estimates the memory used by a resource in bytes. Without one, every resource counts as one byte.
+		ResourceCacheMap(const SizeFunction &size_func = SizeFunction()) : size_func(size_func), use_counter(0), budget(0)
+		{
+		}
+
+		/// \brief Looks up a resource and marks it as recently used
+		bool find(const std::string &id, Resource<Type> &out_resource)
+		{
+			auto it = entries.find(id);
+			if (it == entries.end())
+				return false;
+
+			it->second.last_use = ++use_counter;
+			out_resource = it->second.resource;
+			return true;
+		}
+
+		/// \brief Adds or replaces a resource. Trims the map if a budget is set.
+		void insert(const std::string &id, const Resource<Type> &resource)
+		{
+			Entry &entry = entries[id];
+			entry.resource = resource;
+			entry.last_use = ++use_counter;
+
+			if (budget != 0)
+				trim(budget);
+		}
+
+		/// \brief Protects a resource from eviction
+		void set_pinned(const std::string &id, bool pinned)
+		{
+			auto it = entries.find(id);
+			if (it != entries.end())
+				it->second.pinned = pinned;
+		}
+
+		/// \brief Sets the estimated size the map is trimmed to after each insert. 0 disables automatic trimming.
+		void set_budget(size_t bytes)
+		{
+			budget = bytes;
+			if (budget != 0)
+				trim(budget);
+		}
+
+		size_t get_budget() const { return budget; }
+
+		/// \brief Returns the estimated memory used by all resources in the map
+		size_t get_used_bytes() const
+		{
+			size_t used = 0;
+			for (const auto &it : entries)
+				used += get_size(it.second.resource);
+			return used;
+		}
+
+		/// \brief Evicts unused resources until the estimated size is at most max_bytes
+		///
+		/// \param max_bytes = Target size. 0 evicts all unused resources.
+		/// \return The estimated number of bytes freed
+		size_t trim(size_t max_bytes = 0)
+		{
+			size_t used = 0;
+			std::vector<typename EntryMap::iterator> candidates;
+			for (auto it = entries.begin(); it != entries.end(); ++it)
+			{
+				used += get_size(it->second.resource);
+				if (!it->second.pinned && it->second.resource.handle().use_count() == 1)
+					candidates.push_back(it);
+			}
+
+			std::sort(candidates.begin(), candidates.end(), [](const typename EntryMap::iterator &a, const typename EntryMap::iterator &b)
+			{
+				return a->second.last_use < b->second.last_use;
+			});
+
+			size_t freed = 0;
+			for (auto &it : candidates)
+			{
+				if (max_bytes != 0 && used - freed <= max_bytes)
+					break;
+
+				freed += get_size(it->second.resource);
+				if (evicted_callback)
+					evicted_callback(it->first, it->second.resource);
+				entries.erase(it);
+			}
+			return freed;
+		}
+
+		/// \brief Removes all resources, including pinned and used ones
+		void clear() { entries.clear(); }
+
+		/// \brief Called for each resource just before it is evicted by trim()
+		std::function<void(const std::string &, Resource<Type> &)> &func_evicted() { return evicted_callback; }
+
+	private:
+		struct Entry
+		{
+			Entry() : last_use(0), pinned(false) { }
+			Resource<Type> resource;
+			unsigned long long last_use;
+			bool pinned;
+		};
+		typedef std::map<std::string, Entry> EntryMap;
+
+		size_t get_size(const Resource<Type> &resource) const
+		{
+			return size_func ? size_func(resource.get()) : 1;
+		}
+
+		EntryMap entries;
+		SizeFunction size_func;
+		std::function<void(const std::string &, Resource<Type> &)> evicted_callback;
+		unsigned long long use_counter;
+		size_t budget;
+	};
+
+	/// \}
+}
@@ -32,6 +32,7 @@
 #include <memory>
 #include <functional>
 #include <vector>
+#include <algorithm>
 
 namespace clan
 {
@@ -63,37 +64,99 @@ namespace clan
 		virtual ~SlotImpl() { }
 	};
 
+	/// \brief Slot storage shared between a signal and its slots
+	///
+	/// Emission iterates the slot array in place. Slots disconnected while an emit is in progress are
+	/// cleared from the array and deleted once the outermost emit has finished, so callbacks may freely
+	/// disconnect themselves or other slots.
 	template<typename SlotImplType>
 	class SignalImpl
 	{
 	public:
-		std::vector<std::weak_ptr<SlotImplType>> slots;
-	};
+		SignalImpl() { }
+		SignalImpl(const SignalImpl &) = delete;
+		SignalImpl &operator=(const SignalImpl &) = delete;
 
-	template<typename FuncType>
-	class SlotImplT : public SlotImpl
-	{
-	public:
-		SlotImplT(const std::weak_ptr<SignalImpl<SlotImplT>> &signal, const std::function<FuncType> &callback) : signal(signal), callback(callback)
+		~SignalImpl()
 		{
+			for (SlotImplType *slot : deferred_deletes)
+				delete slot;
 		}
 
-		~SlotImplT()
+		/// \brief Removes a slot. Returns true if the slot must be deleted later because an emit is in progress.
+		bool disconnect(SlotImplType *slot)
 		{
-			std::shared_ptr<SignalImpl<SlotImplT>> sig = signal.lock();
-			if (sig)
+			for (auto it = slots.begin(); it != slots.end(); ++it)
 			{
-				for (auto it = sig->slots.begin(); it != sig->slots.end(); ++it)
+				if (*it == slot)
 				{
-					// todo: investigate if "it->lock().get() == this" is required
-					if (it->expired() || it->lock().get() == this)
+					if (emit_depth > 0)
 					{
-						it = sig->slots.erase(it);
-						if (it == sig->slots.end())
-							break;
+						*it = nullptr;
+						has_empty_slots = true;
 					}
+					else
+					{
+						slots.erase(it);
+					}
+					break;
 				}
 			}
+
+			if (emit_depth > 0)
+			{
+				deferred_deletes.push_back(slot);
+				return true;
+			}
+			return false;
+		}
+
+		void begin_emit()
+		{
+			emit_depth++;
+		}
+
+		void end_emit()
+		{
+			if (--emit_depth > 0)
+				return;
+
+			if (has_empty_slots)
+			{
+				slots.erase(std::remove(slots.begin(), slots.end(), nullptr), slots.end());
+				has_empty_slots = false;
+			}
+
+			if (!deferred_deletes.empty())
+			{
+				std::vector<SlotImplType *> deletes;
+				deletes.swap(deferred_deletes);
+				for (SlotImplType *slot : deletes)
+					delete slot;
+			}
+		}
+
+		std::vector<SlotImplType *> slots;
+		std::vector<SlotImplType *> deferred_deletes;
+		int emit_depth = 0;
+		bool has_empty_slots = false;
+	};
+
+	template<typename FuncType>
+	class SlotImplT : public SlotImpl
+	{
+	public:
+		SlotImplT(const std::weak_ptr<SignalImpl<SlotImplT>> &signal, const std::function<FuncType> &callback) : signal(signal), callback(callback)
+		{
+		}
+
+		/// \brief Deleter used by the shared pointer owning the slot
+		static void release(SlotImplT *slot)
+		{
+			std::shared_ptr<SignalImpl<SlotImplT>> sig = slot->signal.lock();
+			if (sig && sig->disconnect(slot))
+				return;
+			delete slot;
 		}
 
 		std::weak_ptr<SignalImpl<SlotImplT>> signal;
@@ -109,21 +172,24 @@ namespace clan
 		template<typename... Args>
 		void operator()(Args... args)
 		{
-			std::vector<std::weak_ptr<SlotImplT<FuncType>>> slots = impl->slots;
-			for (std::weak_ptr<SlotImplT<FuncType>> &weak_slot : slots)
+			// Keep the slot storage alive in case a callback destroys the signal
+			std::shared_ptr<SignalImpl<SlotImplT<FuncType>>> signal = impl;
+			EmitScope scope(signal.get());
+
+			// Slots connected during the emit are not called until the next one
+			size_t count = signal->slots.size();
+			for (size_t i = 0; i < count; i++)
 			{
-				std::shared_ptr<SlotImplT<FuncType>> slot = weak_slot.lock();
+				SlotImplT<FuncType> *slot = signal->slots[i];
 				if (slot)
-				{
 					slot->callback(args...);
-				}
 			}
 		}
 
 		Slot connect(const std::function<FuncType> &func)
 		{
-			auto slot_impl = std::make_shared<SlotImplT<FuncType>>(impl, func);
-			impl->slots.push_back(slot_impl);
+			std::shared_ptr<SlotImplT<FuncType>> slot_impl(new SlotImplT<FuncType>(impl, func), &SlotImplT<FuncType>::release);
+			impl->slots.push_back(slot_impl.get());
 			return Slot(slot_impl);
 		}
 
@@ -134,6 +200,16 @@ namespace clan
 		}
 
 	private:
+		class EmitScope
+		{
+		public:
+			EmitScope(SignalImpl<SlotImplT<FuncType>> *signal) : signal(signal) { signal->begin_emit(); }
+			~EmitScope() { signal->end_emit(); }
+
+		private:
+			SignalImpl<SlotImplT<FuncType>> *signal;
+		};
+
 		std::shared_ptr<SignalImpl<SlotImplT<FuncType>>> impl;
 	};
 
@@ -0,0 +1,146 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace clan
+{
+	/// \addtogroup clanCore_System clanCore System
+	/// \{
+
+	/// \brief Subsystems that report their allocations to AllocationTracker
+	enum AllocationTag
+	{
+		allocation_tag_other,
+		allocation_tag_block_allocator,
+		allocation_tag_data_buffer,
+		allocation_tag_xml,
+		allocation_tag_pixel_buffer,
+		allocation_tag_json,
+		allocation_tag_gpu,
+		num_allocation_tags
+	};
+
+	/// \brief Allocation counters at one point in time
+	///
+	/// Subtract an earlier snapshot to get the allocations made in between.
+	struct AllocationSnapshot
+	{
+		/// \brief Bytes currently allocated per tag
+		int64_t bytes[num_allocation_tags] = {};
+
+		/// \brief Live allocations per tag
+		int64_t allocations[num_allocation_tags] = {};
+
+		/// \brief Allocations made per tag since tracking was enabled, including freed ones
+		uint64_t total_allocations[num_allocation_tags] = {};
+
+		/// \brief Bytes allocated per tag since tracking was enabled, including freed ones
+		uint64_t total_bytes[num_allocation_tags] = {};
+
+		/// \brief Returns the bytes currently allocated in all tags
+		int64_t get_total_bytes() const;
+
+		/// \brief Returns the allocations made in all tags
+		uint64_t get_total_allocations() const;
+
+		/// \brief Returns the difference between this snapshot and an earlier one
+		AllocationSnapshot operator-(const AllocationSnapshot &earlier) const;
+	};
+
+	/// \brief Receives every allocation reported to AllocationTracker
+	///
+	/// Hooks are called on the allocating thread and must be thread safe. They must not allocate through
+	/// any of the tracked subsystems.
+	class AllocationHook
+	{
+	public:
+		virtual ~AllocationHook() { }
+		virtual void on_allocate(AllocationTag tag, const void *ptr, size_t bytes) = 0;
+		virtual void on_free(AllocationTag tag, const void *ptr, size_t bytes) = 0;
+	};
+
+	/// \brief Attributes memory to the ClanLib subsystems that allocated it
+	///
+	/// <p>DataBuffer, BlockAllocator, the XML DOM, PixelBuffer, JsonValue and the GPU target providers report
+	///    their allocations here with a tag. Tracking is disabled by default and a disabled report costs a
+	///    single flag test.</p>
+	///    <p>Enable tracking before creating the objects to be measured. Objects allocated while tracking
+	///    was disabled are still reported when freed, which makes the live counters go below zero.</p>
+	///    <p>JsonValue stores its members in standard containers, so it only reports how many allocations
+	///    parse() and to_json() made. Those show up in the totals and the frame counter but not in the
+	///    live counters.</p>
+	class AllocationTracker
+	{
+	public:
+		/// \brief Starts or stops tracking allocations
+		static void set_enabled(bool enable);
+
+		/// \brief Returns true if allocations are being tracked
+		static bool is_enabled() { return enabled; }
+
+		/// \brief Sets a hook receiving every tracked allocation, or nullptr to remove it
+		///
+		/// The hook must stay alive until it has been removed.
+		static void set_hook(AllocationHook *hook);
+
+		/// \brief Returns the current counters
+		static AllocationSnapshot get_snapshot();
+
+		/// \brief Marks the end of a frame and returns the number of allocations made during it
+		static uint64_t frame_mark();
+
+		/// \brief Returns the number of allocations made since the last frame_mark()
+		static uint64_t get_frame_allocations();
+
+		/// \brief Returns the name of a tag
+		static const char *get_tag_name(AllocationTag tag);
+
+		/// \brief Report an allocation
+		static void allocate(AllocationTag tag, const void *ptr, size_t bytes) { if (enabled) record_allocate(tag, ptr, bytes); }
+
+		/// \brief Report that an allocation was freed
+		static void free(AllocationTag tag, const void *ptr, size_t bytes) { if (enabled) record_free(tag, ptr, bytes); }
+
+		/// \brief Report allocations whose lifetime is not tracked
+		static void count(AllocationTag tag, uint64_t allocations, size_t bytes) { if (enabled) record_count(tag, allocations, bytes); }
+
+	private:
+		static void record_allocate(AllocationTag tag, const void *ptr, size_t bytes);
+		static void record_free(AllocationTag tag, const void *ptr, size_t bytes);
+		static void record_count(AllocationTag tag, uint64_t allocations, size_t bytes);
+
+		static bool enabled;
+	};
+
+	/// \}
+}
@@ -55,6 +55,8 @@ namespace clan
 		BlockAllocator();
 
 		/// \brief Allocate memory (See note on this class for the allocation method)
+		///
+		/// The returned memory is 16 byte aligned.
 		/**
 			param: size = Size to allocate (in bytes)
 			\return The memory*/
@@ -64,6 +66,12 @@ namespace clan
 		/** If required, use delete_obj() to call the destructor before using this function*/
 		void free();
 
+		/// \brief Makes all allocated memory available again without returning it to the heap
+		/** <p>Keeps the largest block and starts allocating from its beginning. This makes
+			the allocator usable as a per-frame arena: allocate during the frame and call
+			reset() at the end of it. The same destructor rules as for free() apply.</p>*/
+		void reset();
+
 	private:
 		std::shared_ptr<BlockAllocator_Impl> impl;
 	};
@@ -87,5 +95,39 @@ namespace clan
 		void operator delete(void *data, BlockAllocator *allocator);
 	};
 
+	/// \brief STL allocator using a BlockAllocator
+	///
+	///    <p>Deallocation does nothing. The memory is reclaimed when the BlockAllocator is reset or freed,
+	///    so this is best suited for short lived containers such as those built during a frame.</p>
+	template<typename T>
+	class BlockStlAllocator
+	{
+	public:
+		typedef T value_type;
+		typedef T *pointer;
+		typedef const T *const_pointer;
+		typedef T &reference;
+		typedef const T &const_reference;
+		typedef size_t size_type;
+		typedef ptrdiff_t difference_type;
+
+		template<typename U>
+		struct rebind { typedef BlockStlAllocator<U> other; };
+
+		BlockStlAllocator(BlockAllocator *allocator) : allocator(allocator) { }
+		template<typename U>
+		BlockStlAllocator(const BlockStlAllocator<U> &other) : allocator(other.allocator) { }
+
+		T *allocate(size_t count) { return static_cast<T*>(allocator->allocate((int)(count * sizeof(T)))); }
+		void deallocate(T *, size_t) { }
+
+		template<typename U>
+		bool operator==(const BlockStlAllocator<U> &other) const { return allocator == other.allocator; }
+		template<typename U>
+		bool operator!=(const BlockStlAllocator<U> &other) const { return allocator != other.allocator; }
+
+		BlockAllocator *allocator;
+	};
+
 	/// \}
 }
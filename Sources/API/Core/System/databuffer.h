@@ -29,6 +29,8 @@
 #pragma once
 
 #include <memory>
+#include <functional>
+#include "allocation_tracker.h"
 
 namespace clan
 {
@@ -48,6 +50,12 @@ namespace clan
 		DataBuffer(const DataBuffer &data, unsigned int pos, unsigned int size);
 		~DataBuffer();
 
+		/// \brief Wraps memory owned elsewhere, for example a memory mapped file, without copying it.
+		///
+		/// \param release = Called when the last buffer referring to the memory is destroyed.
+		/// <p>Growing the buffer past its size copies the data into memory owned by the buffer and releases the wrapped memory.</p>
+		static DataBuffer wrap(void *data, unsigned int size, const std::function<void()> &release);
+
 		/// \brief Returns a pointer to the data.
 		char *get_data();
 
@@ -82,6 +90,9 @@ namespace clan
 		/// \brief Preallocate enough memory.
 		void set_capacity(unsigned int capacity);
 
+		/// \brief Set the tag the buffer's memory is reported to AllocationTracker with. Defaults to allocation_tag_data_buffer.
+		void set_allocation_tag(AllocationTag tag);
+
 	private:
 		std::shared_ptr<DataBuffer_Impl> impl;
 	};
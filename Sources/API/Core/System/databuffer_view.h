@@ -0,0 +1,116 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "databuffer.h"
+#include "exception.h"
+
+namespace clan
+{
+	/// \addtogroup clanCore_System clanCore System
+	/// \{
+
+	/// \brief A range of bytes inside a DataBuffer.
+	///
+	/// <p>The view shares the storage of the buffer it was created from, so passing a sub range
+	///    of a buffer on to the next stage does not copy any bytes. The view keeps the storage
+	///    alive, but resizing the buffer past its capacity moves the data and shrinking it may
+	///    leave the view pointing past the end. Do not resize a buffer while views into it are in use.</p>
+	class DataBufferView
+	{
+	public:
+		/// \brief Constructs an empty view
+		DataBufferView() : offset(0), size(0) { }
+
+		/// \brief Constructs a view of the entire buffer
+		DataBufferView(const DataBuffer &buffer) : buffer(buffer), offset(0), size(buffer.get_size()) { }
+
+		/// \brief Constructs a view of size bytes starting at offset
+		DataBufferView(const DataBuffer &buffer, unsigned int offset, unsigned int size) : buffer(buffer), offset(offset), size(size)
+		{
+			if (offset > buffer.get_size() || size > buffer.get_size() - offset)
+				throw Exception("DataBufferView range is outside the buffer");
+		}
+
+		/// \brief Returns a pointer to the first byte of the view
+		char *get_data() { return buffer.get_data() + offset; }
+		const char *get_data() const { return buffer.get_data() + offset; }
+
+		template<typename Type>
+		Type *get_data() { return reinterpret_cast<Type*>(get_data()); }
+
+		template<typename Type>
+		const Type *get_data() const { return reinterpret_cast<const Type*>(get_data()); }
+
+		/// \brief Returns the size of the view
+		unsigned int get_size() const { return size; }
+
+		/// \brief Returns the position of the view in the underlying buffer
+		unsigned int get_offset() const { return offset; }
+
+		/// \brief Returns the buffer the view points into
+		const DataBuffer &get_buffer() const { return buffer; }
+
+		/// \brief Returns true if the view is 0 in size
+		bool is_null() const { return size == 0; }
+
+		/// \brief Returns a char in the view
+		char &operator[](unsigned int i) { return get_data()[i]; }
+		const char &operator[](unsigned int i) const { return get_data()[i]; }
+
+		/// \brief Returns a view of a sub range of this view
+		DataBufferView slice(unsigned int slice_offset, unsigned int slice_size) const
+		{
+			if (slice_offset > size || slice_size > size - slice_offset)
+				throw Exception("DataBufferView slice is outside the view");
+			return DataBufferView(buffer, offset + slice_offset, slice_size);
+		}
+
+		/// \brief Returns a view with the first count bytes removed
+		DataBufferView skip(unsigned int count) const
+		{
+			return slice(count, size - (count < size ? count : size));
+		}
+
+		/// \brief Copies the bytes of the view into a new buffer
+		DataBuffer copy() const
+		{
+			if (offset == 0 && size == buffer.get_size())
+				return DataBuffer(buffer, 0, size);
+			return DataBuffer(get_data(), size);
+		}
+
+	private:
+		DataBuffer buffer;
+		unsigned int offset;
+		unsigned int size;
+	};
+
+	/// \}
+}
@@ -0,0 +1,110 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+namespace clan
+{
+	/// \addtogroup clanCore_System clanCore System
+	/// \{
+
+	/// \brief Thread safe small object allocator with size classes.
+	///
+	/// <p>Allocations up to max_pooled_size bytes are rounded up to a multiple of 16 bytes and
+	///    served from a free list for that size class. Freeing a block is O(1) and makes it
+	///    available for reuse straight away. Each thread keeps a small cache per size class, so
+	///    the shared free lists are only locked when a cache needs to be refilled or drained.
+	///    Larger allocations are passed on to the heap.</p>
+	///    <p>Memory used by the pool is never returned to the operating system.</p>
+	class PoolAllocator
+	{
+	public:
+		/// \brief Largest allocation size served by the size classes
+		static const size_t max_pooled_size = 1024;
+
+		/// \brief Allocate memory. The returned memory is 16 byte aligned.
+		static void *allocate(size_t size);
+
+		/// \brief Free memory previously returned by allocate
+		/** param: size = Same size as passed to allocate*/
+		static void free(void *data, size_t size);
+
+		/// \brief Returns the blocks cached by the calling thread to the shared free lists
+		///
+		/// Call this before a thread exits to avoid losing the memory held by its cache.
+		static void flush_thread_cache();
+	};
+
+	/// \brief Class with operator new/delete overloads for PoolAllocator.
+	///
+	///    <p>Derive your class from PoolAllocated to have new and delete use the pool.
+	///    Classes deriving further from a PoolAllocated class must have a virtual
+	///    destructor for delete to free the right size class.</p>
+	class PoolAllocated
+	{
+	public:
+		void *operator new(size_t size) { return PoolAllocator::allocate(size); }
+		void operator delete(void *data, size_t size) { PoolAllocator::free(data, size); }
+	};
+
+	/// \brief STL allocator using PoolAllocator
+	///
+	///    <p>Example: <tt>std::map<int, Foo, std::less<int>, PoolStlAllocator<std::pair<const int, Foo>>></tt></p>
+	template<typename T>
+	class PoolStlAllocator
+	{
+	public:
+		typedef T value_type;
+		typedef T *pointer;
+		typedef const T *const_pointer;
+		typedef T &reference;
+		typedef const T &const_reference;
+		typedef size_t size_type;
+		typedef ptrdiff_t difference_type;
+
+		template<typename U>
+		struct rebind { typedef PoolStlAllocator<U> other; };
+
+		PoolStlAllocator() { }
+		template<typename U>
+		PoolStlAllocator(const PoolStlAllocator<U> &) { }
+
+		T *allocate(size_t count) { return static_cast<T*>(PoolAllocator::allocate(count * sizeof(T))); }
+		void deallocate(T *data, size_t count) { PoolAllocator::free(data, count * sizeof(T)); }
+
+		template<typename U>
+		bool operator==(const PoolStlAllocator<U> &) const { return true; }
+		template<typename U>
+		bool operator!=(const PoolStlAllocator<U> &) const { return false; }
+	};
+
+	/// \}
+}
@@ -0,0 +1,112 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace clan
+{
+	/// \addtogroup clanCore_System clanCore System
+	/// \{
+
+	class JsonValue;
+
+	/// \brief Hierarchical CPU profiler with per-thread event buffers.
+	///
+	/// <p>Zones are recorded as begin and end events with a microsecond timestamp into a
+	///    buffer owned by the calling thread, so recording never takes a lock. Nesting follows
+	///    from the order of the events. The profiler is disabled by default and a disabled
+	///    zone costs a single flag test.</p>
+	///    <p>Zone names are stored by pointer and must stay valid until the trace has been
+	///    exported. Use string literals or other static strings.</p>
+	///    <p>The recorded events can be exported in the Chrome trace event format, which can
+	///    be viewed in chrome://tracing.</p>
+	class Profiler
+	{
+	public:
+		/// \brief Starts or stops recording zones
+		static void set_enabled(bool enable);
+
+		/// \brief Returns true if zones are being recorded
+		static bool is_enabled() { return enabled; }
+
+		/// \brief Begins a zone on the calling thread
+		static void begin_zone(const char *name);
+
+		/// \brief Ends the innermost zone on the calling thread
+		static void end_zone();
+
+		/// \brief Records a zone measured elsewhere, such as a GPU timestamp query
+		///
+		/// The timestamps must be in the System::get_microseconds() time base.
+		/** param: track = Name of the timeline the zone is shown on*/
+		static void add_zone(const char *track, const char *name, uint64_t start_microseconds, uint64_t end_microseconds);
+
+		/// \brief Records an instant event marking the start of a new frame
+		static void frame_mark();
+
+		/// \brief Sets the name shown for the calling thread in the exported trace
+		static void set_thread_name(const std::string &name);
+
+		/// \brief Discards all events recorded so far
+		static void clear();
+
+		/// \brief Returns the recorded events in the Chrome trace event format
+		static JsonValue to_chrome_trace();
+
+		/// \brief Saves the recorded events in the Chrome trace event format
+		static void save_chrome_trace(const std::string &filename);
+
+	private:
+		static bool enabled;
+	};
+
+	/// \brief Profiles the lifetime of a scope
+	class ProfilerZone
+	{
+	public:
+		ProfilerZone(const char *name) : active(Profiler::is_enabled()) { if (active) Profiler::begin_zone(name); }
+		~ProfilerZone() { if (active) Profiler::end_zone(); }
+
+	private:
+		ProfilerZone(const ProfilerZone &) = delete;
+		ProfilerZone &operator=(const ProfilerZone &) = delete;
+
+		bool active;
+	};
+
+	#define cl_profile_zone_concat2(a, b) a##b
+	#define cl_profile_zone_concat(a, b) cl_profile_zone_concat2(a, b)
+
+	/// \brief Profiles the rest of the current scope. The name must be a string literal.
+	#define cl_profile_zone(name) clan::ProfilerZone cl_profile_zone_concat(cl_profile_zone_, __LINE__)(name)
+
+	/// \}
+}
@@ -0,0 +1,104 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <memory>
+#include <functional>
+#include <vector>
+
+namespace clan
+{
+	/// \addtogroup clanCore_System clanCore System
+	/// \{
+
+	class WorkQueue;
+	class Task_Impl;
+
+	/// \brief Handle to a node in a TaskGraph
+	///
+	/// A task runs once all the tasks it depends on have finished.
+	class Task
+	{
+	public:
+		/// \brief Constructs a null instance
+		Task();
+
+		/// \brief Returns true if this object is invalid
+		bool is_null() const { return !impl; }
+
+		/// \brief Returns true if the task has finished running
+		bool is_done() const;
+
+		/// \brief Adds a continuation that runs on a worker thread when this task has finished
+		Task then(const std::function<void()> &func) const;
+
+		/// \brief Adds a continuation that runs on the main WorkQueue thread when this task has finished
+		///
+		/// The continuation is run by WorkQueue::process_work_completed.
+		Task then_main(const std::function<void()> &func) const;
+
+	private:
+		Task(const std::shared_ptr<Task_Impl> &impl);
+
+		std::shared_ptr<Task_Impl> impl;
+		friend class Task_Impl;
+		friend class TaskGraph;
+	};
+
+	/// \brief Schedules tasks with dependencies on the threads of a WorkQueue
+	///
+	/// Independent tasks run in parallel on the worker threads. Only tasks created with
+	/// run_main or Task::then_main are run on the main WorkQueue thread.
+	class TaskGraph
+	{
+	public:
+		/// \brief Constructs a task graph running on the specified work queue
+		TaskGraph(const WorkQueue &queue);
+
+		/// \brief Runs a task on a worker thread once all dependencies have finished
+		Task run(const std::function<void()> &func, const std::vector<Task> &dependencies = std::vector<Task>()) const;
+
+		/// \brief Runs a task on the main WorkQueue thread once all dependencies have finished
+		Task run_main(const std::function<void()> &func, const std::vector<Task> &dependencies = std::vector<Task>()) const;
+
+		/// \brief Returns a task that finishes when all the specified tasks have finished
+		Task when_all(const std::vector<Task> &tasks) const;
+
+		/// \brief Waits for a task to finish
+		///
+		/// The calling thread executes other queued work while it waits. Do not wait on a
+		/// task that depends on a main thread task from anywhere but the main thread.
+		void wait(const Task &task) const;
+
+	private:
+		std::shared_ptr<WorkQueue> queue;
+	};
+
+	/// \}
+}
@@ -29,6 +29,7 @@
 #pragma once
 
 #include <memory>
+#include <string>
 
 #if defined(_MSC_VER)
 #define cl_tls_variable _declspec(thread)
@@ -67,10 +68,55 @@ namespace clan
 		/// \brief Set a variable.
 		static void set_variable(const std::string &name, std::shared_ptr<ThreadLocalStorageData> ptr);
 
+		/// \brief Maximum number of slots that can be registered.
+		enum { max_slots = 64 };
+
+		/// \brief Registers a slot and returns its key.
+		///
+		/// Registering the same name again returns the same key. Keys stay valid for the lifetime of the process.
+		static int register_slot(const std::string &name);
+
+		/// \brief Get the value of a slot for the calling thread, or nullptr if it has not been set.
+		///
+		/// This is a plain thread local read with no name lookup or reference counting.
+		static ThreadLocalStorageData *get_slot(int key) { return slot_values[key]; }
+
+		/// \brief Set the value of a slot for the calling thread.
+		///
+		/// The value is kept alive until it is replaced or the thread local storage of the thread is destroyed.
+		static void set_slot(int key, std::shared_ptr<ThreadLocalStorageData> ptr);
+
 	private:
 		static void init_core();
+		static ThreadLocalStorage_Impl *get_tls_impl();
 		static ThreadLocalStorage_Instance *instance;
+		static cl_tls_variable ThreadLocalStorageData *slot_values[max_slots];
 		friend class ThreadLocalStorage_Instance;
+		friend class ThreadLocalStorage_Impl;
+	};
+
+	/// \brief Typed thread local storage slot.
+	///
+	/// Registers its name once on construction and then accesses the value through the cached key.
+	/// Type must derive from ThreadLocalStorageData.
+	template<typename Type>
+	class ThreadLocalSlot
+	{
+	public:
+		/// \brief Registers the slot.
+		explicit ThreadLocalSlot(const std::string &name) : key(ThreadLocalStorage::register_slot(name)) { }
+
+		/// \brief Returns the key of the slot.
+		int get_key() const { return key; }
+
+		/// \brief Get the value for the calling thread, or nullptr if it has not been set.
+		Type *get() const { return static_cast<Type *>(ThreadLocalStorage::get_slot(key)); }
+
+		/// \brief Set the value for the calling thread.
+		void set(std::shared_ptr<Type> ptr) const { ThreadLocalStorage::set_slot(key, std::move(ptr)); }
+
+	private:
+		int key;
 	};
 
 	/// \}
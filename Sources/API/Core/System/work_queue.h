@@ -1,87 +1,300 @@
-/*
-**  ClanLib SDK
-**  Copyright (c) 1997-2015 The ClanLib Team
-**
-**  This software is provided 'as-is', without any express or implied
-**  warranty.  In no event will the authors be held liable for any damages
-**  arising from the use of this software.
-**
-**  Permission is granted to anyone to use this software for any purpose,
-**  including commercial applications, and to alter it and redistribute it
-**  freely, subject to the following restrictions:
-**
-**  1. The origin of this software must not be misrepresented; you must not
-**     claim that you wrote the original software. If you use this software
-**     in a product, an acknowledgment in the product documentation would be
-**     appreciated but is not required.
-**  2. Altered source versions must be plainly marked as such, and must not be
-**     misrepresented as being the original software.
-**  3. This notice may not be removed or altered from any source distribution.
-**
-**  Note: Some of the libraries ClanLib may link to may have additional
-**  requirements or restrictions.
-**
-**  File Author(s):
-**
-**    Magnus Norddahl
-*/
-
-#pragma once
-
-#include <memory>
-#include <functional>
-
-namespace clan
-{
-	/// \addtogroup clanCore_System clanCore System
-	/// \{
-
-	/// \brief Interface for executing work on a worker thread
-	class WorkItem
-	{
-	public:
-		virtual ~WorkItem() { }
-
-		/// \brief Called by a worker thread to process work
-		virtual void process_work() = 0;
-
-		/// \brief Called by the WorkQueue thread to complete the work
-		virtual void work_completed() { }
-	};
-
-	class WorkQueue_Impl;
-
-	/// \brief Thread pool for worker threads
-	class WorkQueue
-	{
-	public:
-		/// \brief Constructs a work queue
-		/// \param serial_queue If true, executes items in the order they are queued, one at a time
-		WorkQueue(bool serial_queue = false);
-		~WorkQueue();
-
-		/// \brief Queue some work to be executed on a worker thread
-		///
-		/// Transfers ownership of the item queued. WorkQueue will delete the item.
-		void queue(WorkItem *item);
-
-		/// \brief Queue some work to be executed on a worker thread
-		void queue(const std::function<void()> &func);
-
-		/// \brief Queue some work to be executed on the main WorkQueue thread
-		void work_completed(const std::function<void()> &func);
-
-		/// \brief Returns the number of items currently queued
-		int get_items_queued() const;
-
-		/// \brief Process work completed queue
-		///
-		/// Needs to be called on the main WorkQueue thread periodically to finish queued work
-		void process_work_completed();
-
-	private:
-		std::shared_ptr<WorkQueue_Impl> impl;
-	};
-
-	/// \}
-}
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <memory>
+#include <functional>
+#include <atomic>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace clan
+{
+	/// \addtogroup clanCore_System clanCore System
+	/// \{
+
+	/// \brief Interface for executing work on a worker thread
+	class WorkItem
+	{
+	public:
+		virtual ~WorkItem() { }
+
+		/// \brief Called by a worker thread to process work
+		virtual void process_work() = 0;
+
+		/// \brief Called by the WorkQueue thread to complete the work
+		virtual void work_completed() { }
+
+	private:
+		/// \brief Returns false if the item can be released by the worker thread right after process_work
+		virtual bool has_work_completed() const { return true; }
+
+		/// \brief Disposes the item once the WorkQueue is done with it
+		virtual void release() { delete this; }
+
+		friend class WorkQueue_Impl;
+	};
+
+	/// \brief Move-only callable used for queueing work
+	///
+	/// Functors up to inline_size bytes are stored inside the object itself, so wrapping a typical
+	/// lambda does not allocate. Larger functors fall back to the heap.
+	class WorkFunction
+	{
+	public:
+		static const size_t inline_size = 48;
+
+		/// \brief Constructs an empty function
+		WorkFunction() { }
+
+		/// \brief Constructs a function from any callable object
+		template<typename Func, typename = typename std::enable_if<!std::is_same<typename std::decay<Func>::type, WorkFunction>::value>::type>
+		WorkFunction(Func &&func)
+		{
+			typedef typename std::decay<Func>::type FuncType;
+			if (fits_inline<FuncType>::value)
+			{
+				new (&storage) FuncType(std::forward<Func>(func));
+				manager = &inline_manager<FuncType>;
+			}
+			else
+			{
+				*reinterpret_cast<FuncType**>(&storage) = new FuncType(std::forward<Func>(func));
+				manager = &heap_manager<FuncType>;
+			}
+		}
+
+		WorkFunction(WorkFunction &&other) { move_from(other); }
+		~WorkFunction() { clear(); }
+
+		WorkFunction &operator=(WorkFunction &&other)
+		{
+			if (this != &other)
+			{
+				clear();
+				move_from(other);
+			}
+			return *this;
+		}
+
+		/// \brief Returns true if the function holds a callable
+		explicit operator bool() const { return manager != nullptr; }
+
+		/// \brief Invokes the callable
+		void operator()() { manager(op_invoke, this, nullptr); }
+
+		/// \brief Destroys the held callable
+		void clear()
+		{
+			if (manager)
+			{
+				manager(op_destroy, this, nullptr);
+				manager = nullptr;
+			}
+		}
+
+	private:
+		WorkFunction(const WorkFunction &) = delete;
+		WorkFunction &operator=(const WorkFunction &) = delete;
+
+		enum Operation { op_invoke, op_move, op_destroy };
+		typedef void(*ManagerFunc)(Operation op, WorkFunction *self, WorkFunction *dest);
+		typedef std::aligned_storage<inline_size>::type Storage;
+
+		template<typename FuncType>
+		struct fits_inline
+		{
+			static const bool value = sizeof(FuncType) <= inline_size && std::alignment_of<FuncType>::value <= std::alignment_of<Storage>::value && std::is_nothrow_move_constructible<FuncType>::value;
+		};
+
+		template<typename FuncType>
+		static void inline_manager(Operation op, WorkFunction *self, WorkFunction *dest)
+		{
+			FuncType *func = reinterpret_cast<FuncType*>(&self->storage);
+			switch (op)
+			{
+			case op_invoke:
+				(*func)();
+				break;
+			case op_move:
+				new (&dest->storage) FuncType(std::move(*func));
+				func->~FuncType();
+				break;
+			case op_destroy:
+				func->~FuncType();
+				break;
+			}
+		}
+
+		template<typename FuncType>
+		static void heap_manager(Operation op, WorkFunction *self, WorkFunction *dest)
+		{
+			FuncType *func = *reinterpret_cast<FuncType**>(&self->storage);
+			switch (op)
+			{
+			case op_invoke:
+				(*func)();
+				break;
+			case op_move:
+				*reinterpret_cast<FuncType**>(&dest->storage) = func;
+				break;
+			case op_destroy:
+				delete func;
+				break;
+			}
+		}
+
+		void move_from(WorkFunction &other)
+		{
+			if (other.manager)
+			{
+				other.manager(op_move, &other, this);
+				manager = other.manager;
+				other.manager = nullptr;
+			}
+		}
+
+		Storage storage;
+		ManagerFunc manager = nullptr;
+	};
+
+	/// \brief Tracks a set of child work items queued on a WorkQueue
+	///
+	/// A work item can queue child work into a group and then call WorkQueue::wait to have its thread
+	/// help execute queued work until all children in the group have finished.
+	class WorkGroup
+	{
+	public:
+		WorkGroup() : pending(0) { }
+
+		/// \brief Returns true if all work queued in the group has been processed
+		bool is_done() const { return pending.load(std::memory_order_acquire) == 0; }
+
+	private:
+		WorkGroup(const WorkGroup &) = delete;
+		WorkGroup &operator=(const WorkGroup &) = delete;
+
+		std::atomic_int pending;
+		friend class WorkQueue_Impl;
+	};
+
+	class WorkQueue_Impl;
+
+	/// \brief Thread pool for worker threads
+	class WorkQueue
+	{
+	public:
+		/// \brief Constructs a work queue
+		/// \param serial_queue If true, executes items in the order they are queued, one at a time
+		/// \param work_stealing If true, each worker thread gets its own deque and idle workers steal from the others. Ignored for serial queues.
+		WorkQueue(bool serial_queue = false, bool work_stealing = false);
+		~WorkQueue();
+
+		/// \brief Queue some work to be executed on a worker thread
+		///
+		/// Transfers ownership of the item queued. WorkQueue will delete the item.
+		void queue(WorkItem *item);
+
+		/// \brief Queue some work to be executed on a worker thread
+		///
+		/// Work items for functions are pooled, so queueing a small functor does not allocate in steady state.
+		void queue(WorkFunction func);
+
+		/// \brief Queue child work to be executed on a worker thread as part of a group
+		void queue(WorkGroup &group, WorkFunction func);
+
+		/// \brief Waits for all work in a group to finish
+		///
+		/// The calling thread executes other queued work while it waits instead of blocking.
+		/// Can be called from inside a work item to wait on child work it queued.
+		void wait(WorkGroup &group);
+
+		/// \brief Executes other queued work on the calling thread until the condition returns true
+		void wait_until(const std::function<bool()> &condition);
+
+		/// \brief Calls func(first, last) for sub ranges of [begin, end) on the worker threads
+		///
+		/// The calling thread processes sub ranges as well and returns when the whole range has been processed.
+		/// \param grain Minimum number of indices per sub range. Zero or less picks a size based on the number of worker threads.
+		void parallel_for(int begin, int end, int grain, const std::function<void(int first, int last)> &func);
+
+		/// \brief Maps sub ranges of [begin, end) to values on the worker threads and combines them
+		///
+		/// The results of map(first, last) are combined with reduce in range order, so the result is deterministic
+		/// for any associative reduce function.
+		template<typename T, typename MapFunc, typename ReduceFunc>
+		T parallel_reduce(int begin, int end, int grain, const T &identity, MapFunc map, ReduceFunc reduce)
+		{
+			if (end <= begin)
+				return identity;
+
+			int grain_size = get_grain_size(end - begin, grain);
+			int num_chunks = (end - begin + grain_size - 1) / grain_size;
+			std::vector<T> results(num_chunks, identity);
+			parallel_for(0, num_chunks, 1, [&](int first, int last)
+			{
+				for (int chunk = first; chunk < last; chunk++)
+				{
+					int chunk_begin = begin + chunk * grain_size;
+					int chunk_end = (end - chunk_begin > grain_size) ? chunk_begin + grain_size : end;
+					results[chunk] = map(chunk_begin, chunk_end);
+				}
+			});
+
+			T result = identity;
+			for (const auto &value : results)
+				result = reduce(result, value);
+			return result;
+		}
+
+		/// \brief Returns the number of worker threads
+		int get_worker_count() const;
+
+		/// \brief Returns the sub range size parallel_for uses for a range of count indices
+		int get_grain_size(int count, int grain = 0) const;
+
+		/// \brief Queue some work to be executed on the main WorkQueue thread
+		void work_completed(WorkFunction func);
+
+		/// \brief Returns the number of items currently queued
+		int get_items_queued() const;
+
+		/// \brief Process work completed queue
+		///
+		/// Needs to be called on the main WorkQueue thread periodically to finish queued work
+		void process_work_completed();
+
+	private:
+		std::shared_ptr<WorkQueue_Impl> impl;
+	};
+
+	/// \}
+}
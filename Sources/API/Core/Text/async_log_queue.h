@@ -0,0 +1,81 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <memory>
+
+namespace clan
+{
+	/// \addtogroup clanCore_Text clanCore Text
+	/// \{
+
+	class AsyncLogQueue_Impl;
+
+	/// \brief Moves log output to a background thread.
+	///
+	/// <p>While an AsyncLogQueue object exists, log_event places records into a lock-free bounded
+	///    queue and returns immediately. A background thread takes the records off the queue in
+	///    batches and passes them to the enabled Logger instances, which is where the time stamp
+	///    formatting and any file or console writes happen.</p>
+	///    <p>The time stamp of a record is the time log_event was called, not the time it was written.
+	///    Only one AsyncLogQueue can be active at a time.</p>
+	class AsyncLogQueue
+	{
+	public:
+		/// \brief What log_event does when the queue is full
+		enum OverflowPolicy
+		{
+			/// \brief Discard the record and count it as dropped. log_event never waits.
+			overflow_drop,
+
+			/// \brief Wait until the background thread has made room for the record
+			overflow_wait
+		};
+
+		/// \brief Starts routing log_event through a background thread
+		/// \param capacity Maximum number of queued records. Rounded up to a power of two.
+		/// \param policy What to do when the queue is full
+		/// \param flush_interval_ms How often the background thread checks the queue when it is not filling up
+		AsyncLogQueue(int capacity = 4096, OverflowPolicy policy = overflow_drop, int flush_interval_ms = 10);
+
+		/// \brief Writes all queued records and returns log_event to logging on the calling thread
+		~AsyncLogQueue();
+
+		/// \brief Blocks until all records queued so far have been written
+		void flush();
+
+		/// \brief Returns the number of records dropped because the queue was full
+		int get_dropped_count() const;
+
+	private:
+		std::shared_ptr<AsyncLogQueue_Impl> impl;
+	};
+
+	/// \}
+}
@@ -62,9 +62,7 @@ namespace clan
 		template <class Arg1>
 		static void write(const std::string &format, Arg1 arg1)
 		{
-			StringFormat f(format);
-			f.set_arg(1, arg1);
-			write(f.get_result());
+			write(string_format(format, arg1));
 		}
 
 		/// \brief Write
@@ -75,10 +73,7 @@ namespace clan
 		template <class Arg1, class Arg2>
 		static void write(const std::string &format, Arg1 arg1, Arg2 arg2)
 		{
-			StringFormat f(format);
-			f.set_arg(1, arg1);
-			f.set_arg(2, arg2);
-			write(f.get_result());
+			write(string_format(format, arg1, arg2));
 		}
 
 		/// \brief Write
@@ -90,11 +85,7 @@ namespace clan
 		template <class Arg1, class Arg2, class Arg3>
 		static void write(const std::string &format, Arg1 arg1, Arg2 arg2, Arg3 arg3)
 		{
-			StringFormat f(format);
-			f.set_arg(1, arg1);
-			f.set_arg(2, arg2);
-			f.set_arg(3, arg3);
-			write(f.get_result());
+			write(string_format(format, arg1, arg2, arg3));
 		}
 
 		/// \brief Write
@@ -107,12 +98,7 @@ namespace clan
 		template <class Arg1, class Arg2, class Arg3, class Arg4>
 		static void write(const std::string &format, Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4)
 		{
-			StringFormat f(format);
-			f.set_arg(1, arg1);
-			f.set_arg(2, arg2);
-			f.set_arg(3, arg3);
-			f.set_arg(4, arg4);
-			write(f.get_result());
+			write(string_format(format, arg1, arg2, arg3, arg4));
 		}
 
 		/// \brief Write
@@ -126,13 +112,7 @@ namespace clan
 		template <class Arg1, class Arg2, class Arg3, class Arg4, class Arg5>
 		static void write(const std::string &format, Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4, Arg5 arg5)
 		{
-			StringFormat f(format);
-			f.set_arg(1, arg1);
-			f.set_arg(2, arg2);
-			f.set_arg(3, arg3);
-			f.set_arg(4, arg4);
-			f.set_arg(arg5);
-			write(f.get_result());
+			write(string_format(format, arg1, arg2, arg3, arg4, arg5));
 		}
 
 		/// \brief Write
@@ -147,14 +127,7 @@ namespace clan
 		template <class Arg1, class Arg2, class Arg3, class Arg4, class Arg5, class Arg6>
 		static void write(const std::string &format, Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4, Arg5 arg5, Arg6 arg6)
 		{
-			StringFormat f(format);
-			f.set_arg(1, arg1);
-			f.set_arg(2, arg2);
-			f.set_arg(3, arg3);
-			f.set_arg(4, arg4);
-			f.set_arg(arg5);
-			f.set_arg(arg6);
-			write(f.get_result());
+			write(string_format(format, arg1, arg2, arg3, arg4, arg5, arg6));
 		}
 
 		/// \brief Write
@@ -170,15 +143,7 @@ namespace clan
 		template <class Arg1, class Arg2, class Arg3, class Arg4, class Arg5, class Arg6, class Arg7>
 		static void write(const std::string &format, Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4, Arg5 arg5, Arg6 arg6, Arg7 arg7)
 		{
-			StringFormat f(format);
-			f.set_arg(1, arg1);
-			f.set_arg(2, arg2);
-			f.set_arg(3, arg3);
-			f.set_arg(4, arg4);
-			f.set_arg(arg5);
-			f.set_arg(arg6);
-			f.set_arg(arg7);
-			write(f.get_result());
+			write(string_format(format, arg1, arg2, arg3, arg4, arg5, arg6, arg7));
 		}
 
 		/// \brief Writes text to the console window and then advances to a new line.
@@ -199,9 +164,7 @@ namespace clan
 		template <class Arg1>
 		static void write_line(const std::string &format, Arg1 arg1)
 		{
-			StringFormat f(format);
-			f.set_arg(1, arg1);
-			write_line(f.get_result());
+			write_line(string_format(format, arg1));
 		}
 
 		/// \brief Write line
@@ -212,10 +175,7 @@ namespace clan
 		template <class Arg1, class Arg2>
 		static void write_line(const std::string &format, Arg1 arg1, Arg2 arg2)
 		{
-			StringFormat f(format);
-			f.set_arg(1, arg1);
-			f.set_arg(2, arg2);
-			write_line(f.get_result());
+			write_line(string_format(format, arg1, arg2));
 		}
 
 		/// \brief Write line
@@ -227,11 +187,7 @@ namespace clan
 		template <class Arg1, class Arg2, class Arg3>
 		static void write_line(const std::string &format, Arg1 arg1, Arg2 arg2, Arg3 arg3)
 		{
-			StringFormat f(format);
-			f.set_arg(1, arg1);
-			f.set_arg(2, arg2);
-			f.set_arg(3, arg3);
-			write_line(f.get_result());
+			write_line(string_format(format, arg1, arg2, arg3));
 		}
 
 		/// \brief Write line
@@ -244,12 +200,7 @@ namespace clan
 		template <class Arg1, class Arg2, class Arg3, class Arg4>
 		static void write_line(const std::string &format, Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4)
 		{
-			StringFormat f(format);
-			f.set_arg(1, arg1);
-			f.set_arg(2, arg2);
-			f.set_arg(3, arg3);
-			f.set_arg(4, arg4);
-			write_line(f.get_result());
+			write_line(string_format(format, arg1, arg2, arg3, arg4));
 		}
 
 		/// \brief Write line
@@ -263,13 +214,7 @@ namespace clan
 		template <class Arg1, class Arg2, class Arg3, class Arg4, class Arg5>
 		static void write_line(const std::string &format, Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4, Arg5 arg5)
 		{
-			StringFormat f(format);
-			f.set_arg(1, arg1);
-			f.set_arg(2, arg2);
-			f.set_arg(3, arg3);
-			f.set_arg(4, arg4);
-			f.set_arg(5, arg5);
-			write_line(f.get_result());
+			write_line(string_format(format, arg1, arg2, arg3, arg4, arg5));
 		}
 
 		/// \brief Write line
@@ -284,14 +229,7 @@ namespace clan
 		template <class Arg1, class Arg2, class Arg3, class Arg4, class Arg5, class Arg6>
 		static void write_line(const std::string &format, Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4, Arg5 arg5, Arg6 arg6)
 		{
-			StringFormat f(format);
-			f.set_arg(1, arg1);
-			f.set_arg(2, arg2);
-			f.set_arg(3, arg3);
-			f.set_arg(4, arg4);
-			f.set_arg(5, arg5);
-			f.set_arg(6, arg6);
-			write_line(f.get_result());
+			write_line(string_format(format, arg1, arg2, arg3, arg4, arg5, arg6));
 		}
 
 		/// \brief Write line
@@ -307,15 +245,7 @@ namespace clan
 		template <class Arg1, class Arg2, class Arg3, class Arg4, class Arg5, class Arg6, class Arg7>
 		static void write_line(const std::string &format, Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4, Arg5 arg5, Arg6 arg6, Arg7 arg7)
 		{
-			StringFormat f(format);
-			f.set_arg(1, arg1);
-			f.set_arg(2, arg2);
-			f.set_arg(3, arg3);
-			f.set_arg(4, arg4);
-			f.set_arg(5, arg5);
-			f.set_arg(6, arg6);
-			f.set_arg(7, arg7);
-			write_line(f.get_result());
+			write_line(string_format(format, arg1, arg2, arg3, arg4, arg5, arg6, arg7));
 		}
 
 		/// \brief Block until a key is pressed in the console window.
@@ -61,7 +61,13 @@ namespace clan
 		virtual void log(const std::string &type, const std::string &text) = 0;
 
 	protected:
+		/// \brief Formats a log line with a time stamp for the record being logged
 		static StringFormat get_log_string(const std::string &type, const std::string &text);
+
+	private:
+		/// \brief Time stamp of the record being written by AsyncLogQueue, or 0 for the current time
+		static int64_t record_ticks;
+		friend class AsyncLogQueue_Impl;
 	};
 
 	/// \brief Log text to logger.
@@ -71,43 +77,43 @@ namespace clan
 	template <class Arg1>
 	void log_event(const std::string &type, const std::string &format, Arg1 arg1)
 	{
-		StringFormat f(format); f.set_arg(1, arg1); log_event(type, f.get_result());
+		log_event(type, string_format(format, arg1));
 	}
 
 	template <class Arg1, class Arg2>
 	void log_event(const std::string &type, const std::string &format, Arg1 arg1, Arg2 arg2)
 	{
-		StringFormat f(format); f.set_arg(1, arg1); f.set_arg(2, arg2); log_event(type, f.get_result());
+		log_event(type, string_format(format, arg1, arg2));
 	}
 
 	template <class Arg1, class Arg2, class Arg3>
 	void log_event(const std::string &type, const std::string &format, Arg1 arg1, Arg2 arg2, Arg3 arg3)
 	{
-		StringFormat f(format); f.set_arg(1, arg1); f.set_arg(2, arg2); f.set_arg(3, arg3); log_event(type, f.get_result());
+		log_event(type, string_format(format, arg1, arg2, arg3));
 	}
 
 	template <class Arg1, class Arg2, class Arg3, class Arg4>
 	void log_event(const std::string &type, const std::string &format, Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4)
 	{
-		StringFormat f(format); f.set_arg(1, arg1); f.set_arg(2, arg2); f.set_arg(3, arg3); f.set_arg(4, arg4); log_event(type, f.get_result());
+		log_event(type, string_format(format, arg1, arg2, arg3, arg4));
 	}
 
 	template <class Arg1, class Arg2, class Arg3, class Arg4, class Arg5>
 	void log_event(const std::string &type, const std::string &format, Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4, Arg5 arg5)
 	{
-		StringFormat f(format); f.set_arg(1, arg1); f.set_arg(2, arg2); f.set_arg(3, arg3); f.set_arg(4, arg4); f.set_arg(5, arg5); log_event(type, f.get_result());
+		log_event(type, string_format(format, arg1, arg2, arg3, arg4, arg5));
 	}
 
 	template <class Arg1, class Arg2, class Arg3, class Arg4, class Arg5, class Arg6>
 	void log_event(const std::string &type, const std::string &format, Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4, Arg5 arg5, Arg6 arg6)
 	{
-		StringFormat f(format); f.set_arg(1, arg1); f.set_arg(2, arg2); f.set_arg(3, arg3); f.set_arg(4, arg4); f.set_arg(5, arg5); f.set_arg(6, arg6); log_event(type, f.get_result());
+		log_event(type, string_format(format, arg1, arg2, arg3, arg4, arg5, arg6));
 	}
 
 	template <class Arg1, class Arg2, class Arg3, class Arg4, class Arg5, class Arg6, class Arg7>
 	void log_event(const std::string &type, const std::string &format, Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4, Arg5 arg5, Arg6 arg6, Arg7 arg7)
 	{
-		StringFormat f(format); f.set_arg(1, arg1); f.set_arg(2, arg2); f.set_arg(3, arg3); f.set_arg(4, arg4); f.set_arg(5, arg5); f.set_arg(6, arg6); f.set_arg(7, arg7); log_event(type, f.get_result());
+		log_event(type, string_format(format, arg1, arg2, arg3, arg4, arg5, arg6, arg7));
 	}
 
 	/// \}
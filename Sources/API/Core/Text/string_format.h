@@ -29,6 +29,8 @@
 #pragma once
 
 #include <vector>
+#include <string>
+#include <cstring>
 
 namespace clan
 {
@@ -153,59 +155,139 @@ namespace clan
 		std::vector<ArgPosition> args;
 	};
 
-	/// \brief See clan::StringFormat for details.
-	inline std::string string_format(const std::string &format)
+	/// \brief Type erased argument for string_format_to
+	///
+	/// Holds a reference to string arguments, so it must not outlive the value it was constructed from.
+	class StringFormatArg
 	{
-		return format;
-	}
+	public:
+		StringFormatArg() : type(type_none) { }
+		StringFormatArg(int value) : type(type_int) { data.int_value = value; }
+		StringFormatArg(long value) : type(type_int) { data.int_value = value; }
+		StringFormatArg(long long value) : type(type_int) { data.int_value = value; }
+		StringFormatArg(unsigned int value) : type(type_uint) { data.uint_value = value; }
+		StringFormatArg(unsigned long value) : type(type_uint) { data.uint_value = value; }
+		StringFormatArg(unsigned long long value) : type(type_uint) { data.uint_value = value; }
+		StringFormatArg(float value) : type(type_float) { data.float_value = value; }
+		StringFormatArg(double value) : type(type_double) { data.float_value = value; }
+		StringFormatArg(const char *text) : type(type_text) { data.text.str = text ? text : ""; data.text.length = text ? strlen(text) : 0; }
+		StringFormatArg(const std::string &text) : type(type_text) { data.text.str = text.data(); data.text.length = text.size(); }
 
-	/// \brief See clan::StringFormat for details.
-	template <class Arg1>
-	std::string string_format(const std::string &format, Arg1 arg1)
-	{
-		StringFormat f(format); f.set_arg(1, arg1); return f.get_result();
-	}
+	private:
+		enum Type { type_none, type_int, type_uint, type_float, type_double, type_text };
+		Type type;
+		union
+		{
+			long long int_value;
+			unsigned long long uint_value;
+			double float_value;
+			struct { const char *str; size_t length; } text;
+		} data;
 
-	/// \brief See clan::StringFormat for details.
-	template <class Arg1, class Arg2>
-	std::string string_format(const std::string &format, Arg1 arg1, Arg2 arg2)
-	{
-		StringFormat f(format); f.set_arg(1, arg1); f.set_arg(2, arg2); return f.get_result();
-	}
+		friend size_t string_format_to(char *buffer, size_t size, const char *format, size_t format_length, const StringFormatArg *args, int num_args);
+	};
 
-	/// \brief See clan::StringFormat for details.
-	template <class Arg1, class Arg2, class Arg3>
-	std::string string_format(const std::string &format, Arg1 arg1, Arg2 arg2, Arg3 arg3)
+	/// \brief Formats into a caller provided buffer without allocating memory
+	///
+	/// Placeholders follow the clan::StringFormat rules, with %1 referring to args[0]. Floats use 6 decimals
+	/// with trailing zeros removed and doubles use 6 decimals, same as StringFormat::set_arg.
+	///
+	/// At most size - 1 characters are written, followed by a null terminator if size is not zero.
+	///
+	/// \return Length of the full formatted string, excluding the null terminator. If this is size or larger the output was truncated.
+	size_t string_format_to(char *buffer, size_t size, const char *format, size_t format_length, const StringFormatArg *args, int num_args);
+
+	/// \brief See clan::string_format_to for details.
+	template <class... Args>
+	size_t string_format_to(char *buffer, size_t size, const char *format, const Args &... args)
 	{
-		StringFormat f(format); f.set_arg(1, arg1); f.set_arg(2, arg2); f.set_arg(3, arg3); return f.get_result();
+		const StringFormatArg format_args[] = { StringFormatArg(), StringFormatArg(args)... };
+		return string_format_to(buffer, size, format, strlen(format), format_args + 1, (int)sizeof...(Args));
 	}
 
-	/// \brief See clan::StringFormat for details.
-	template <class Arg1, class Arg2, class Arg3, class Arg4>
-	std::string string_format(const std::string &format, Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4)
+	/// \brief See clan::string_format_to for details.
+	template <class... Args>
+	size_t string_format_to(char *buffer, size_t size, const std::string &format, const Args &... args)
 	{
-		StringFormat f(format); f.set_arg(1, arg1); f.set_arg(2, arg2); f.set_arg(3, arg3); f.set_arg(4, arg4); return f.get_result();
+		const StringFormatArg format_args[] = { StringFormatArg(), StringFormatArg(args)... };
+		return string_format_to(buffer, size, format.data(), format.size(), format_args + 1, (int)sizeof...(Args));
 	}
 
-	/// \brief See clan::StringFormat for details.
-	template <class Arg1, class Arg2, class Arg3, class Arg4, class Arg5>
-	std::string string_format(const std::string &format, Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4, Arg5 arg5)
+	/// \brief String with inline storage for formatting text without heap allocations
+	///
+	/// Results longer than InlineSize - 1 characters fall back to a heap buffer, which is kept and
+	/// reused by later calls to format. Arguments must not refer to the SmallString being formatted.
+	///
+	/// Example:
+	///
+	/// \code{.cpp}
+	/// clan::SmallString<> fps_text;
+	/// font.draw_text(canvas, 10, 20, fps_text.format("FPS: %1", fps));
+	/// \endcode
+	template <size_t InlineSize = 256>
+	class SmallString
 	{
-		StringFormat f(format); f.set_arg(1, arg1); f.set_arg(2, arg2); f.set_arg(3, arg3); f.set_arg(4, arg4); f.set_arg(5, arg5); return f.get_result();
-	}
+	public:
+		SmallString() : length(0) { inline_buffer[0] = 0; }
+		SmallString(const SmallString &) = delete;
+		SmallString &operator=(const SmallString &) = delete;
+
+		/// \brief Replaces the contents with a formatted string
+		///
+		/// \return The formatted string, valid until the next call to format
+		template <class... Args>
+		const char *format(const char *format_string, const Args &... args)
+		{
+			const StringFormatArg format_args[] = { StringFormatArg(), StringFormatArg(args)... };
+			size_t format_length = strlen(format_string);
+			length = string_format_to(data(), capacity(), format_string, format_length, format_args + 1, (int)sizeof...(Args));
+			if (length >= capacity())
+			{
+				heap_buffer.resize(length + 1);
+				string_format_to(data(), capacity(), format_string, format_length, format_args + 1, (int)sizeof...(Args));
+			}
+			return c_str();
+		}
+
+		const char *c_str() const { return heap_buffer.empty() ? inline_buffer : heap_buffer.data(); }
+		size_t size() const { return length; }
+		bool empty() const { return length == 0; }
+
+		std::string to_string() const { return std::string(c_str(), length); }
+		operator std::string() const { return to_string(); }
+
+	private:
+		char *data() { return heap_buffer.empty() ? inline_buffer : heap_buffer.data(); }
+		size_t capacity() const { return heap_buffer.empty() ? InlineSize : heap_buffer.size(); }
+
+		char inline_buffer[InlineSize];
+		std::vector<char> heap_buffer;
+		size_t length;
+	};
 
 	/// \brief See clan::StringFormat for details.
-	template <class Arg1, class Arg2, class Arg3, class Arg4, class Arg5, class Arg6>
-	std::string string_format(const std::string &format, Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4, Arg5 arg5, Arg6 arg6)
+	inline std::string string_format(const std::string &format)
 	{
-		StringFormat f(format); f.set_arg(1, arg1); f.set_arg(2, arg2); f.set_arg(3, arg3); f.set_arg(4, arg4); f.set_arg(5, arg5); f.set_arg(6, arg6); return f.get_result();
+		return format;
 	}
 
 	/// \brief See clan::StringFormat for details.
-	template <class Arg1, class Arg2, class Arg3, class Arg4, class Arg5, class Arg6, class Arg7>
-	std::string string_format(const std::string &format, Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4, Arg5 arg5, Arg6 arg6, Arg7 arg7)
+	///
+	/// Formats into a stack buffer first, so only the returned string is allocated.
+	template <class Arg1, class... Args>
+	std::string string_format(const std::string &format, const Arg1 &arg1, const Args &... args)
 	{
-		StringFormat f(format); f.set_arg(1, arg1); f.set_arg(2, arg2); f.set_arg(3, arg3); f.set_arg(4, arg4); f.set_arg(5, arg5); f.set_arg(6, arg6); f.set_arg(7, arg7); return f.get_result();
+		const StringFormatArg format_args[] = { StringFormatArg(arg1), StringFormatArg(args)... };
+		const int num_args = 1 + (int)sizeof...(Args);
+
+		char buffer[256];
+		size_t length = string_format_to(buffer, sizeof(buffer), format.data(), format.size(), format_args, num_args);
+		if (length < sizeof(buffer))
+			return std::string(buffer, length);
+
+		std::string result(length, 0);
+		string_format_to(&result[0], length + 1, format.data(), format.size(), format_args, num_args);
+		return result;
 	}
 
 	/// \}
@@ -76,6 +76,22 @@ namespace clan
 		static std::string remove_trailing_zeros(std::string text);
 		static std::wstring remove_trailing_zeros(std::wstring text);
 
+		/// \brief Writes the decimal representation of an integer into a buffer
+		///
+		/// The buffer must have room for at least 20 characters. No null terminator is written.
+		///
+		/// \return Number of characters written
+		static int int_to_chars(char *buffer, long long value);
+		static int uint_to_chars(char *buffer, unsigned long long value);
+
+		/// \brief Writes a fixed point representation of a floating point number into a buffer
+		///
+		/// Produces the same output as printf("%.*f") followed by an optional remove_trailing_zeros, but
+		/// without allocating. At most size characters are written and no null terminator is added.
+		///
+		/// \return Number of characters needed for the full representation
+		static int float_to_chars(char *buffer, int size, double value, int num_decimal_places = 6, bool remove_trailing_zeros = true);
+
 		/// \brief Compare
 		///
 		/// \param a = String Ref8
@@ -101,6 +117,11 @@ namespace clan
 		/// \return Temp String
 		static std::string text_to_upper(const std::string &s);
 
+		/// \brief Converts the ASCII letters of a string to upper case in place
+		///
+		/// Other bytes are left unchanged, so UTF-8 text stays valid.
+		static void ascii_to_upper(char *text, std::string::size_type length);
+
 		/// \brief Local8 to upper
 		///
 		/// \param s = String Ref8
@@ -122,6 +143,11 @@ namespace clan
 		/// \return Temp String
 		static std::string text_to_lower(const std::string &s);
 
+		/// \brief Converts the ASCII letters of a string to lower case in place
+		///
+		/// Other bytes are left unchanged, so UTF-8 text stays valid.
+		static void ascii_to_lower(char *text, std::string::size_type length);
+
 		/// \brief Local8 to lower
 		///
 		/// \param s = String Ref8
@@ -68,6 +68,21 @@ namespace clan
 		/// \brief Set the current position of the reader
 		void set_position(std::string::size_type position);
 
+		/// \brief Returns true if the text is well-formed UTF-8
+		///
+		/// Overlong forms, surrogates and code points above U+10FFFF are rejected.
+		static bool is_valid(const std::string::value_type *text, std::string::size_type length);
+
+		/// \brief Returns the number of bytes at the start of the text that are ASCII
+		static std::string::size_type ascii_length(const std::string::value_type *text, std::string::size_type length);
+
+		/// \brief Decodes text into a buffer of characters
+		///
+		/// The output must have room for length characters. Invalid sequences decode to '?' the same way get_char() and next() step over them.
+		///
+		/// \return Number of characters written
+		static std::string::size_type decode(const std::string::value_type *text, std::string::size_type length, char32_t *output);
+
 	private:
 		std::string::size_type current_position = 0;
 		std::string::size_type length = 0;
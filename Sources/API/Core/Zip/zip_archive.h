@@ -31,6 +31,7 @@
 
 #include <memory>
 #include "zip_file_entry.h"
+#include "../System/databuffer_view.h"
 #include <vector>
 
 namespace clan
@@ -58,7 +59,9 @@ namespace clan
 		/// \brief Constructs a ZipArchive
 		///
 		/// \param filename = String Ref
-		ZipArchive(const std::string &filename);
+		/// \param memory_map = Map the archive into memory instead of reading it through file calls.
+		///                     Stored entries can then be read with read_file() without copying them.
+		ZipArchive(const std::string &filename, bool memory_map = false);
 
 		/// \brief Constructs a ZipArchive
 		///
@@ -75,6 +78,22 @@ namespace clan
 		/// \brief Opens a file in the archive.
 		IODevice open_file(const std::string &filename);
 
+		/// \brief Returns the contents of a file in the archive.
+		///
+		/// For stored entries of a memory mapped archive, the view points into the mapping and no bytes are copied.
+		/// Other entries are decompressed into a new buffer.
+		DataBufferView read_file(const std::string &filename);
+
+		/// \brief Sets whether open_file and get_file_list ignore the case of ASCII letters in filenames.
+		void set_case_insensitive(bool enable);
+
+		/// \brief Sets how far apart inflate checkpoints are saved in compressed files opened by open_file
+		///
+		/// A file starts saving checkpoints after its first backward seek. Seeks then only decompress from the
+		/// closest checkpoint instead of the start of the file. Each checkpoint takes about 45 KB.
+		/// \param bytes = Uncompressed bytes between checkpoints. 0 disables checkpoints. The default is 256 KB.
+		void set_seek_checkpoint_interval(int bytes);
+
 		/// \brief Get full path to source:
 		std::string get_pathname(const std::string &filename);
 
@@ -50,6 +50,33 @@ namespace clan
 		/// \param storeFilenamesAsUTF8 = bool
 		ZipWriter(IODevice &output, bool storeFilenamesAsUTF8 = false);
 
+		/// \brief Compression methods for compressed file entries
+		enum CompressionMethod
+		{
+			compression_deflate,
+			compression_zstd,	///< Zip compression method 93. Requires ClanLib built with libzstd.
+			compression_lz4	///< Not part of the zip specification, so only ClanLib can read these entries. Requires ClanLib built with liblz4.
+		};
+
+		/// \brief Sets the compression method used by files begun with compress set to true
+		///
+		/// Zstandard decompresses several times faster than deflate at a similar ratio. LZ4 decompresses faster still at a lower ratio.
+		///
+		/// \param method = Compression method
+		/// \param level = Compression level of the method. -1 uses the default level of the method.
+		void set_compression_method(CompressionMethod method, int level = -1);
+
+		/// \brief Compresses file data on worker threads
+		///
+		/// File data is split into blocks that are deflated independently and in parallel. The blocks are
+		/// written in order, so the archive is the same no matter how the work is scheduled. Each block
+		/// starts without the history of the previous block, which costs a little compression ratio.
+		/// Must be called before the first begin_file.
+		///
+		/// \param enable = Enables parallel compression
+		/// \param block_size = Number of uncompressed bytes compressed by each worker task
+		void set_parallel_compression(bool enable, int block_size = 1024 * 1024);
+
 		/// \brief Begins file entry in the zip file.
 		void begin_file(const std::string &filename, bool compress);
 
@@ -28,12 +28,16 @@
 
 #pragma once
 
+#include <memory>
+
 namespace clan
 {
 	/// \addtogroup clanCore_I_O_Data clanCore I/O Data
 	/// \{
 
 	class DataBuffer;
+	class ZLibCompressor_Impl;
+	class ZLibDecompressor_Impl;
 
 	/// \brief Deflate compressor
 	class ZLibCompression
@@ -61,5 +65,78 @@ namespace clan
 		static DataBuffer decompress(const DataBuffer &data, bool raw = true);
 	};
 
+	/// \brief Reusable deflate compressor for chunked input and output
+	///
+	/// The deflate state is allocated once and kept by reset(), so one compressor can encode many streams.
+	/// Sync flushing keeps the dictionary between calls, so a long lived stream can be sent in pieces that
+	/// the receiving ZLibDecompressor can decompress as they arrive.
+	class ZLibCompressor
+	{
+	public:
+		enum FlushMode
+		{
+			no_flush,	// Deflate may hold back output until more input arrives
+			sync_flush,	// All output so far is written, ending on a byte boundary
+			finish	// The input ends the stream
+		};
+
+		// \param raw Skips header if true
+		// \param compression_level Compression level in range 0-9
+		// \param mode Compression strategy
+		ZLibCompressor(bool raw = true, int compression_level = 6, ZLibCompression::CompressionMode mode = ZLibCompression::default_strategy);
+		~ZLibCompressor();
+
+		// \brief Starts a new stream without reallocating the deflate state
+		void reset();
+
+		// \brief Sets a preset dictionary for the stream
+		// Must be called before any data is compressed, and the decompressor must be given the same dictionary.
+		// Only raw streams support a dictionary.
+		void set_dictionary(const void *data, unsigned int size);
+
+		// \brief Compresses from input into a caller provided output buffer
+		// \param input_used Receives the number of input bytes consumed
+		// \param output_used Receives the number of bytes written to output
+		// \param flush Flush mode. A sync flush is complete when all input was used and output was not filled.
+		// \return True when the end of the stream has been written
+		bool compress(const void *input, unsigned int input_size, unsigned int &input_used, void *output, unsigned int output_size, unsigned int &output_used, FlushMode flush);
+
+		// \brief Compresses data and appends the result to the end of output
+		// \param flush Flush mode. With no_flush some output may be held back until the next call.
+		void compress(const void *data, unsigned int size, DataBuffer &output, FlushMode flush);
+
+	private:
+		std::shared_ptr<ZLibCompressor_Impl> impl;
+	};
+
+	/// \brief Reusable inflater for chunked input and output
+	class ZLibDecompressor
+	{
+	public:
+		// \param raw Skips header if true
+		ZLibDecompressor(bool raw = true);
+		~ZLibDecompressor();
+
+		// \brief Starts a new stream without reallocating the inflate state
+		void reset();
+
+		// \brief Sets the preset dictionary the stream was compressed with
+		// Must be called before any data is decompressed. Only raw streams support a dictionary.
+		void set_dictionary(const void *data, unsigned int size);
+
+		// \brief Decompresses from input into a caller provided output buffer
+		// \param input_used Receives the number of input bytes consumed
+		// \param output_used Receives the number of bytes written to output
+		// \return True when the end of the stream has been reached and all of its output was written
+		bool decompress(const void *input, unsigned int input_size, unsigned int &input_used, void *output, unsigned int output_size, unsigned int &output_used);
+
+		// \brief Decompresses data and appends the result to the end of output
+		// \return True when the end of the stream has been reached
+		bool decompress(const void *data, unsigned int size, DataBuffer &output);
+
+	private:
+		std::shared_ptr<ZLibDecompressor_Impl> impl;
+	};
+
 	/// \}
 }
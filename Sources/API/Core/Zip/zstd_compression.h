@@ -0,0 +1,106 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include <memory>
+
+namespace clan
+{
+	/// \addtogroup clanCore_I_O_Data clanCore I/O Data
+	/// \{
+
+	class DataBuffer;
+	class ZstdCompressor_Impl;
+	class ZstdDecompressor_Impl;
+
+	/// \brief Zstandard compressor
+	///
+	/// Zstandard decompresses several times faster than deflate at a similar compression ratio.
+	/// The codec is only available if ClanLib was built with libzstd. Otherwise all functions throw an exception.
+	class ZstdCompression
+	{
+	public:
+		// \brief Returns true if ClanLib was built with Zstandard support
+		static bool is_supported();
+
+		// \brief Compress data into a single Zstandard frame
+		// \param compression_level Compression level in range 1-22. 3 is the default.
+		static DataBuffer compress(const DataBuffer &data, int compression_level = 3);
+
+		// \brief Decompress data
+		// The data may consist of several concatenated frames.
+		static DataBuffer decompress(const DataBuffer &data);
+	};
+
+	/// \brief Reusable Zstandard compressor for chunked input
+	class ZstdCompressor
+	{
+	public:
+		// \param compression_level Compression level in range 1-22
+		ZstdCompressor(int compression_level = 3);
+		~ZstdCompressor();
+
+		// \brief Starts a new frame without reallocating the compression context
+		void reset();
+
+		// \brief Compresses data and appends the result to the end of output
+		// \param finish True if the data ends the frame. Otherwise some output may be held back until the next call.
+		void compress(const void *data, unsigned int size, DataBuffer &output, bool finish);
+
+	private:
+		std::shared_ptr<ZstdCompressor_Impl> impl;
+	};
+
+	/// \brief Reusable Zstandard decompressor for chunked input and output
+	class ZstdDecompressor
+	{
+	public:
+		ZstdDecompressor();
+		~ZstdDecompressor();
+
+		// \brief Starts a new stream without reallocating the decompression context
+		void reset();
+
+		// \brief Decompresses from input into a caller provided output buffer
+		// \param input_used Receives the number of input bytes consumed
+		// \param output_used Receives the number of bytes written to output
+		// \return True when the end of a frame has been reached and all of its output was written. A following frame is decompressed by the next call.
+		bool decompress(const void *input, unsigned int input_size, unsigned int &input_used, void *output, unsigned int output_size, unsigned int &output_used);
+
+		// \brief Decompresses data and appends the result to the end of output
+		// \return True when the data ended at the end of a frame
+		bool decompress(const void *data, unsigned int size, DataBuffer &output);
+
+	private:
+		std::shared_ptr<ZstdDecompressor_Impl> impl;
+	};
+
+	/// \}
+}
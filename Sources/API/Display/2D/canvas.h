@@ -32,6 +32,8 @@
 #pragma once
 
 #include "../Render/graphic_context.h"
+#include <vector>
+#include <cstdint>
 
 namespace clan
 {
@@ -67,6 +69,31 @@ namespace clan
 		map_user_projection
 	};
 
+	/// \brief Draw batching counters collected by a canvas
+	class CanvasBatchStats
+	{
+	public:
+		/// \brief Flushes because a batch needed more textures than a draw call can bind
+		int flushes_texture_limit = 0;
+
+		/// \brief Flushes because the next draw used a different batcher
+		int flushes_batcher_switch = 0;
+
+		/// \brief Flushes because of state changes, such as clip rectangles, programs or explicit flush() calls
+		int flushes_state_change = 0;
+
+		/// \brief Flushes because a batch ran out of vertex or instance space
+		int flushes_buffer_full = 0;
+
+		/// \brief Vertices and sprite instances handed to the GPU
+		uint64_t vertices = 0;
+
+		/// \brief Bytes uploaded to vertex and instance buffers
+		uint64_t bytes_uploaded = 0;
+
+		int get_flushes() const { return flushes_texture_limit + flushes_batcher_switch + flushes_state_change + flushes_buffer_full; }
+	};
+
 	/// \brief 2D Graphics Canvas
 	class Canvas
 	{
@@ -209,6 +236,52 @@ namespace clan
 		/// \brief Flushes the render batcher currently active.
 		void flush();
 
+		/// \brief Starts recording draw commands instead of drawing them right away
+		///
+		/// Recorded commands are reordered so that commands using the same render batcher are drawn
+		/// together, as long as this does not change the result where commands overlap. Points, lines,
+		/// boxes, rectangles and images are recorded. Any other drawing, a flush or a change of render
+		/// state first draws everything recorded so far.
+		void begin_deferred();
+
+		/// \brief Draws the recorded commands and stops recording
+		void end_deferred();
+
+		/// \brief Returns true between begin_deferred() and end_deferred()
+		bool is_deferred() const;
+
+		/// \brief Marks an area that changed since the last presented frame
+		///
+		/// The rectangle is in canvas coordinates and the current transform is applied to it.
+		void invalidate(const Rectf &rect);
+
+		/// \brief Marks the whole canvas as changed
+		void invalidate();
+
+		/// \brief Returns the changed areas, in the untransformed coordinates used by clip rectangles
+		///
+		/// Overlapping areas are merged. To redraw only what changed, draw the frame with each area
+		/// pushed as clip rectangle, then present it with DisplayWindow::flip(canvas.get_damage())
+		/// followed by clear_damage().
+		const std::vector<Rectf> &get_damage() const;
+
+		/// \brief Forgets the changed areas
+		void clear_damage();
+
+		/// \brief Returns the batching counters collected since the last reset_batch_stats()
+		///
+		/// The counters are shared with canvases constructed from this one, as they draw through the same batchers.
+		const CanvasBatchStats &get_batch_stats() const;
+
+		/// \brief Sets all batching counters to zero
+		void reset_batch_stats();
+
+		/// \brief Draws batching debug information on top of deferred drawing
+		///
+		/// When enabled, every command drawn between begin_deferred() and end_deferred() is shaded with a translucent
+		/// red, so areas drawn many times light up, and each batch gets an outline in alternating colors.
+		void set_batch_overlay(bool enable);
+
 		/// \brief Draw a point.
 		void draw_point(float x1, float y1, const Colorf &color);
 
@@ -307,6 +380,22 @@ namespace clan
 		/// \param gradient = Gradient
 		void fill_rect(const Rectf &rect, const Gradient &gradient);
 
+		/// \brief Brush fill
+		///
+		/// Solid and linear gradient brushes are drawn with triangles, like the other fill_rect functions. The stops of a
+		/// gradient are baked once into an atlas texture shared by all gradients. Other brushes are filled as a path.
+		/// \param rect = Rectf
+		/// \param brush = Brush
+		void fill_rect(const Rectf &rect, const Brush &brush);
+
+		/// \brief Brush fill of a rectangle with rounded corners
+		///
+		/// Drawn like fill_rect with a brush. The corners are not anti-aliased unless the brush is filled as a path.
+		/// \param rect = Rectf
+		/// \param corner = Horizontal and vertical radius of the corners
+		/// \param brush = Brush
+		void fill_rounded_rect(const Rectf &rect, const Sizef &corner, const Brush &brush);
+
 		/// \brief Draw a circle.
 		void fill_circle(float center_x, float center_y, float radius, const Colorf &color = Colorf::white);
 
@@ -401,6 +490,21 @@ namespace clan
 		/// \brief Draw a gradient filled ellipse.
 		void fill_ellipse(const Pointf &center, float radius_x, float radius_y, const Gradient &gradient);
 
+		/// \brief Draw a filled box with rounded corners and a border.
+		///
+		/// Boxes are anti-aliased by the shader and consecutive boxes are drawn in a single batch.
+		/// \param box = Outer edge of the border
+		/// \param radii = Corner radii in the order top left, top right, bottom right, bottom left
+		/// \param border_widths = Left, top, right and bottom border widths
+		/// \return false, without drawing anything, if the render target has no program for it
+		bool fill_rounded_box(const Rectf &box, const Vec4f &radii, const Vec4f &border_widths, const Colorf &fill_color, const Colorf &border_color);
+
+		/// \brief Draw the blurred shadow outside a box with rounded corners.
+		///
+		/// The shadow fades out over blur_radius and leaves the box itself uncovered.
+		/// \return false, without drawing anything, if the render target has no program for it
+		bool fill_box_shadow(const Rectf &box, const Vec4f &radii, float blur_radius, const Colorf &color);
+
 		/// \brief Snaps the point to the nearest pixel corner
 		Pointf grid_fit(const Pointf &pos);
 
@@ -408,12 +512,16 @@ namespace clan
 		std::shared_ptr<Canvas_Impl> impl;
 
 		friend class Sprite_Impl;
+		friend class SpriteBatch_Impl;
 		friend class Image;
 		friend class Font_Impl;
 		friend class Font_DrawSubPixel;
 		friend class Font_DrawFlat;
 		friend class Font_DrawScaled;
 		friend class Path;
+		friend class Canvas_Impl;
+		friend class CanvasStaticBatch;
+		friend class RenderBatchTriangle;
 	};
 
 	/// \}
@@ -0,0 +1,83 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Kenneth Gangstoe
+*/
+
+#pragma once
+
+#include <memory>
+#include "color.h"
+
+namespace clan
+{
+	/// \addtogroup clanDisplay_2D clanDisplay 2D
+	/// \{
+
+	class Canvas;
+	class CanvasStaticBatch_Impl;
+
+	/// \brief Retained geometry recorded once from a canvas and drawn again without rebuilding it.
+	///
+	/// Everything drawn between begin() and end() is stored in vertex buffers on the GPU rather than
+	/// on screen. Drawing the batch later only changes the transform and the color modulation, which
+	/// makes it a good fit for static UI chrome, tile maps and other scenery that rarely changes.
+	///
+	/// Only images, sprites, text and fills can be captured. Lines, points and paths throw an exception from
+	/// within the capture, and clip rectangles are applied when the batch is drawn rather than when it is recorded.
+	/// Requires a display target with support for static batches.
+	class CanvasStaticBatch
+	{
+	public:
+		/// \brief Constructs an empty batch.
+		CanvasStaticBatch();
+		~CanvasStaticBatch();
+
+		/// \brief Returns true if the batch holds no geometry.
+		bool is_empty() const;
+
+		/// \brief Starts capturing the drawing of the canvas into this batch.
+		///
+		/// Geometry captured earlier is kept; call clear() to start over.
+		void begin(Canvas &canvas);
+
+		/// \brief Stops capturing.
+		void end(Canvas &canvas);
+
+		/// \brief Removes all captured geometry.
+		void clear();
+
+		/// \brief Draws the batch.
+		///
+		/// The current canvas transform is applied on top of the transform that was active while capturing.
+		/// \param color = Color multiplied with the captured colors
+		void draw(Canvas &canvas, const Colorf &color = Colorf::white) const;
+
+	private:
+		std::shared_ptr<CanvasStaticBatch_Impl> impl;
+	};
+
+	/// \}
+}
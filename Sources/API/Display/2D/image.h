@@ -47,6 +47,7 @@ namespace clan
 	class Rectf;
 	class Image_Impl;
 	class Texture2D;
+	class Texture2DArray;
 	class Subtexture;
 	class PixelBuffer;
 	class ResourceManager;
@@ -67,6 +68,15 @@ namespace clan
 		/// \param rect = Position and size in texture to get image data from
 		Image(Texture2D texture, const Rect &rect);
 
+		/// \brief Constructs an image from a layer of a texture array.
+		///
+		/// Images sharing a texture array are drawn in the same batch, no matter how many of its layers they use.
+		/// Requires a display target with texture array support.
+		/// \param texture = Texture array to get image data from
+		/// \param layer = Layer in the array
+		/// \param rect = Position and size in the layer to get image data from
+		Image(Texture2DArray texture, int layer, const Rect &rect);
+
 		/// \brief Constructs an image from a subtexture.
 		///
 		/// \param sub_texture = Subtexture to get image data from
@@ -132,6 +142,8 @@ namespace clan
 		void get_alignment(Origin &origin, float &x, float &y) const;
 
 		/// \brief Return the texture of the image
+		///
+		/// The texture is null for an image using a layer of a texture array.
 		Subtexture get_texture() const;
 
 		/// \brief Return the size of the image.
@@ -229,6 +241,12 @@ namespace clan
 		/// \brief Sets translation hotspot.
 		void set_alignment(Origin origin, float x = 0, float y = 0);
 
+		/// \brief Draws the image as one compact instance record instead of six vertices
+		///
+		/// Pays off when the same few textures are drawn many times in a row, such as particles. Falls back to regular
+		/// drawing when the display target cannot instance, or the transform or destination quad does not allow it.
+		void set_instanced(bool enable = true);
+
 		void set_wrap_mode(
 			TextureWrapMode wrap_s,
 			TextureWrapMode wrap_t);
@@ -254,6 +272,8 @@ namespace clan
 			int level = 0);
 
 	private:
+		void draw_texture(Canvas &canvas, const Rectf &src, const Quadf &dest) const;
+
 		std::shared_ptr<Image_Impl> impl;
 	};
 
@@ -110,6 +110,9 @@ namespace clan
 
 		/// \brief Layout
 		///
+		/// Text added since the previous layout with the same max_width and alignment is laid out
+		/// incrementally, starting from the last paragraph. Lines before it are kept.
+		///
 		/// \param canvas = Canvas
 		/// \param max_width = value
 		void layout(Canvas &canvas, int max_width);
@@ -147,6 +150,12 @@ namespace clan
 		/// \param canvas = Canvas
 		void draw_layout(Canvas &canvas);
 
+		/// \brief Draw the lines of the layout that intersect an area
+		///
+		/// \param canvas = Canvas
+		/// \param visible_rect = Visible area, in the same coordinates as the layout position
+		void draw_layout(Canvas &canvas, const Rect &visible_rect);
+
 		/// \brief Draw layout generating ellipsis for clipped text
 		///
 		/// \param canvas = Canvas
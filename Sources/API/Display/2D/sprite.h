@@ -286,6 +286,12 @@ namespace clan
 		/// \brief Set to true if a linear filter should be used for scaling up and down, false if a nearest-point filter should be used.
 		void set_linear_filter(bool linear_filter = true);
 
+		/// \brief Draws the sprite as one compact instance record instead of six vertices
+		///
+		/// Pays off for many sprites drawn in a row, such as particles. Falls back to regular drawing when
+		/// the display target cannot instance or the transform does not allow it.
+		void set_instanced(bool enable = true);
+
 		/// \brief Sets translation hotspot.
 		void set_alignment(Origin origin, int x = 0, int y = 0);
 
@@ -423,6 +429,7 @@ namespace clan
 		std::shared_ptr<Sprite_Impl> impl;
 
 		friend class FontFamily_Impl;
+		friend class SpriteBatch_Impl;
 	};
 
 	/// \}
@@ -0,0 +1,132 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include <memory>
+#include "../../Core/Math/point.h"
+#include "color.h"
+
+namespace clan
+{
+	/// \addtogroup clanDisplay_2D clanDisplay 2D
+	/// \{
+
+	class Canvas;
+	class Sprite;
+	class SpriteBatch_Impl;
+
+	/// \brief Animates and draws many instances of one sprite
+	///
+	/// All instances share the frames, alignment, scale, angle and play mode of the sprite the batch was created from.
+	/// Only the animation state, position and color are kept per instance, each in its own contiguous array, so
+	/// update() advances every animation in a single pass. draw() calculates each frame's quad once and submits the
+	/// instances to the instanced sprite batcher when the display target supports it.
+	class SpriteBatch
+	{
+	public:
+		/// \brief Constructs a null instance.
+		SpriteBatch();
+
+		/// \brief Constructs a batch of instances of a sprite
+		///
+		/// The sprite is shared, not copied. Changes to its frames or settings apply to all instances.
+		SpriteBatch(const Sprite &sprite);
+
+		/// \brief Returns true if this object is invalid.
+		bool is_null() const { return !impl; }
+
+		/// \brief Throw an exception if this object is invalid.
+		void throw_if_null() const;
+
+		/// \brief Returns the sprite the instances are drawn with
+		Sprite get_sprite() const;
+
+		/// \brief Returns the number of instances
+		int get_count() const;
+
+		/// \brief Adds an instance drawn with the color of the sprite, starting at the first frame of the animation
+		///
+		/// \return The index of the instance
+		int add(const Pointf &position);
+
+		/// \brief Adds an instance drawn with its own color, starting at the first frame of the animation
+		///
+		/// \return The index of the instance
+		int add(const Pointf &position, const Colorf &color);
+
+		/// \brief Removes an instance
+		///
+		/// The last instance is moved into the freed index, so its index changes to the removed one.
+		void remove(int index);
+
+		/// \brief Removes all instances
+		void clear();
+
+		/// \brief Returns the position of an instance
+		Pointf get_position(int index) const;
+
+		/// \brief Returns the color of an instance
+		Colorf get_color(int index) const;
+
+		/// \brief Returns the current frame of an instance. 0 is first frame.
+		int get_current_frame(int index) const;
+
+		/// \brief Returns true if the animation of an instance is finished
+		bool is_finished(int index) const;
+
+		/// \brief Returns true if the animation of an instance has looped in the last update
+		bool is_looping(int index) const;
+
+		/// \brief Sets the position of an instance
+		void set_position(int index, const Pointf &position);
+
+		/// \brief Sets the color of an instance
+		void set_color(int index, const Colorf &color);
+
+		/// \brief Sets the current frame of an instance. 0 is first frame.
+		void set_frame(int index, int frame);
+
+		/// \brief Restarts the animation of an instance
+		void restart(int index);
+
+		/// \brief Advances the animation of all instances
+		///
+		/// \param time_elapsed_ms Time in milliseconds since the last update
+		void update(int time_elapsed_ms);
+
+		/// \brief Draws all visible instances
+		void draw(Canvas &canvas);
+
+	private:
+		std::shared_ptr<SpriteBatch_Impl> impl;
+	};
+
+	/// \}
+}
@@ -67,7 +67,12 @@ namespace clan
 		Rect get_geometry() const;
 
 	private:
+		/// \brief Moves the subtexture, for every copy of this object
+		void set_location(const Texture2D &texture, const Rect &geometry);
+
 		std::shared_ptr<Subtexture_Impl> impl;
+
+		friend class TextureGroup_Impl;
 	};
 
 	/// \}
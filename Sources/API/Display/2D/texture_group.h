@@ -89,13 +89,32 @@ namespace clan
 		/// \brief Allocate space for another sub texture.
 		Subtexture add(GraphicContext &context, const Size &size);
 
+		/// \brief Allocate space for several sub textures at once.
+		///
+		/// The sizes are inserted largest first, which packs tighter than adding them one by one in arbitrary order.
+		/// The returned sub textures are in the same order as the sizes.
+		std::vector<Subtexture> add(GraphicContext &context, const std::vector<Size> &sizes);
+
 		/// \brief Deallocate space, from a previously allocated texture
 		///
-		/// Warning - It is advised to set TextureAllocationPolicy to search_previous_textures
-		/// if using this function.  Also be aware of texture fragmentation.
-		/// Empty textures are not removed.
+		/// Free space is merged with free neighbours, so it can hold larger sub textures again.
+		/// It is advised to set TextureAllocationPolicy to search_previous_textures if using this function.
+		/// Textures left empty are removed.
 		void remove(Subtexture &subtexture);
 
+		/// \brief Deallocate a texture, and all sub textures allocated from it
+		void remove_texture(const Texture2D &texture);
+
+		/// \brief Move the sub textures of the emptiest texture into the other textures, and remove it
+		///
+		/// The pixels are copied on the GPU. Subtexture objects returned by add() are updated to the new location,
+		/// but a texture or geometry obtained from them earlier must be obtained again. Only one texture is repacked
+		/// per call, so the work can be spread over several frames.
+		///
+		/// \param max_fill = Only repack a texture if less than this fraction of it is in use
+		/// \return The number of sub textures moved
+		int repack(GraphicContext &context, float max_fill = 0.5f);
+
 		/// \brief Set the texture allocation policy.
 		void set_texture_allocation_policy(TextureAllocationPolicy policy);
 
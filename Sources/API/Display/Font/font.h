@@ -122,6 +122,17 @@ namespace clan
 		/// All font sizes are scalable when using sprite fonts
 		void set_scalable(float height_threshold = 64.0f);
 
+		/// \brief Sets if glyphs missing from the glyph cache are rasterized on a background thread
+		///
+		/// While a glyph is being rasterized, draw_text() leaves a gap for it instead of waiting.
+		/// Measuring functions, such as get_metrics() and measure_text(), still rasterize right away.
+		void set_async_rasterization(bool enable);
+
+		/// \brief Adds the glyphs of a text to the glyph cache ahead of drawing it
+		///
+		/// With asynchronous rasterization the glyphs are queued, otherwise they are rasterized immediately.
+		void prefetch(Canvas &canvas, const std::string &text);
+
 		/// \brief Print text
 		///
 		/// \param canvas = Canvas
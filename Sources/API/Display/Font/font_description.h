@@ -133,6 +133,9 @@ namespace clan
 		/// \brief Get the font subpixel rendering setting (defaults to true)
 		bool get_subpixel() const;
 
+		/// \brief Get the font distance field rendering setting (defaults to false)
+		bool get_distance_field() const;
+
 		/// \biref Get the font charset
 		Charset get_charset() const;
 
@@ -181,6 +184,13 @@ namespace clan
 		/// \brief Sets the font subpixel rendering setting (defaults to true)
 		void set_subpixel(bool setting = true);
 
+		/// \brief Sets the font distance field rendering setting (defaults to false)
+		///
+		/// Glyphs are rasterized once at a base size and stored as a signed distance field.
+		/// Every font height then renders sharply from the same glyph cache.
+		/// Targets without a distance field program render normal glyphs instead.
+		void set_distance_field(bool setting = false);
+
 		/// \brief Sets the font charset (defaults to charset_default)
 		///
 		/// \param new_charset = The charset. charset_default = Use operating systems default
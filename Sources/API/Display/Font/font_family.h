@@ -29,6 +29,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include "../Render/graphic_context.h"
 #include "../Image/pixel_buffer.h"
@@ -88,6 +89,32 @@ namespace clan
 		/// \param metrics = Font metrics for the sprite font
 		void add(Canvas &canvas, Sprite &sprite, const std::string &glyph_list, float spacelen, bool monospace, const FontMetrics &metrics);
 
+		/// \brief Persist rasterized glyphs in a directory between runs
+		///
+		/// Fonts created from this family afterwards add the glyphs saved for them by save_glyph_caches(),
+		/// instead of rasterizing them again. Cache files are keyed by a hash of the font data, the font description
+		/// and the pixel ratio. Files that do not match are ignored.
+		///
+		/// \param directory = Directory holding the cache files. Empty = Do not persist glyphs (default)
+		void set_glyph_cache_directory(const std::string &directory);
+
+		/// \brief Save the glyphs rasterized so far by the fonts of this family
+		///
+		/// Sprite fonts are not saved. Requires set_glyph_cache_directory().
+		void save_glyph_caches(Canvas &canvas);
+
+		/// \brief Set the video memory available to the glyph atlas shared by all fonts
+		///
+		/// Fonts of every family and window share their rasterized glyphs, which requires the graphic contexts
+		/// to share objects. Once the atlas exceeds the budget, its least recently used pages are freed and
+		/// their glyphs rasterized again when drawn. Sprite fonts and loaded glyph caches are not counted.
+		///
+		/// \param bytes = Budget in bytes (default 64 MB)
+		static void set_glyph_atlas_budget(uint64_t bytes);
+
+		/// \brief Returns the video memory used by the glyph atlas, in bytes
+		static uint64_t get_glyph_atlas_usage();
+
 	private:
 		std::shared_ptr<FontFamily_Impl> impl;
 
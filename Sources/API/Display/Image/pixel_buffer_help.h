@@ -35,12 +35,40 @@ namespace clan
 	/// \addtogroup clanDisplay_Display clanDisplay Display
 	/// \{
 
+	class PixelBufferSet;
+
+	/// \brief Filter kernels used when resampling pixel buffers
+	enum ResampleFilter
+	{
+		/// \brief Averages the covered source pixels. Fast, but soft.
+		resample_box,
+		/// \brief Lanczos windowed sinc with three lobes. Sharp, with slight ringing.
+		resample_lanczos,
+		/// \brief Kaiser windowed sinc with three lobes. Sharp, with less ringing than Lanczos.
+		resample_kaiser
+	};
+
 	/// \brief Pixel data helper class
 	class PixelBufferHelp
 	{
 	public:
 		/// \brief Add a border around a pixelbuffer, duplicating the edge pixels
 		static PixelBuffer add_border(const PixelBuffer &pb, int border_size, const Rect &rect);
+
+		/// \brief Resizes a pixel buffer using a separable filter
+		///
+		/// Filtering is done in linear light on premultiplied alpha, so edges of transparent areas do not darken.
+		/// The color channels are treated as sRGB encoded if srgb is true or the format is tf_srgb8 or tf_srgb8_alpha8.
+		/// Rows are filtered in parallel. Compressed formats are not supported.
+		static PixelBuffer resample(const PixelBuffer &pb, int new_width, int new_height, ResampleFilter filter = resample_lanczos, bool srgb = false);
+
+		/// \brief Returns the next mip level of a pixel buffer, which is half the size rounded down
+		static PixelBuffer downsample(const PixelBuffer &pb, ResampleFilter filter = resample_box, bool srgb = false);
+
+		/// \brief Builds a complete mip chain down to 1x1 from the base level of each slice in the set
+		///
+		/// Each level is filtered from the unquantized previous level. Slices are filtered independently.
+		static PixelBufferSet generate_mipmaps(PixelBufferSet set, ResampleFilter filter = resample_kaiser, bool srgb = false);
 	};
 
 	/// \}
@@ -66,6 +66,9 @@ namespace clan
 		/// \brief Returns the JPEG JFIF YCrCb output setting
 		bool get_output_is_ycrcb() const;
 
+		/// \brief Returns the multithreaded setting
+		bool get_multithreaded() const;
+
 		/// \brief Set the premultiply alpha setting
 		///
 		/// This defaults to off.
@@ -93,6 +96,11 @@ namespace clan
 		/// \brief Converts to JPEG JFIF YCrCb
 		void set_output_is_ycrcb(bool enable);
 
+		/// \brief Set if large images are converted in bands of rows on worker threads
+		///
+		/// This defaults to off.
+		void set_multithreaded(bool enable);
+
 		/// \brief Convert some pixel data
 		void convert(void *output, int output_pitch, TextureFormat output_format, const void *input, int input_pitch, TextureFormat input_format, int width, int height);
 
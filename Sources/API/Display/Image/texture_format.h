@@ -134,7 +134,15 @@ namespace clan
 		tf_compressed_srgb_s3tc_dxt1,
 		tf_compressed_srgb_alpha_s3tc_dxt1,
 		tf_compressed_srgb_alpha_s3tc_dxt3,
-		tf_compressed_srgb_alpha_s3tc_dxt5
+		tf_compressed_srgb_alpha_s3tc_dxt5,
+		tf_compressed_rgba_bptc_unorm,
+		tf_compressed_srgb_alpha_bptc_unorm,
+		tf_compressed_rgb8_etc2,
+		tf_compressed_srgb8_etc2,
+		tf_compressed_rgba8_etc2_eac,
+		tf_compressed_srgb8_alpha8_etc2_eac,
+		tf_compressed_rgba_astc_4x4,
+		tf_compressed_srgb8_alpha8_astc_4x4
 	};
 
 	/// \}
@@ -37,6 +37,7 @@ namespace clan
 	/// \{
 
 	class FileSystem;
+	class GraphicContext;
 
 	/// \brief Image provider that can load Direct3D texture (.dds) files.
 	class DDSProvider
@@ -49,6 +50,16 @@ namespace clan
 		static PixelBufferSet load(const std::string &filename, const FileSystem &file_system);
 		static PixelBufferSet load(const std::string &fullname);
 		static PixelBufferSet load(IODevice &file);
+
+		/// \brief Loads the image into transfer textures of the graphic context
+		///
+		/// The pixel data is read from the file straight into the mapped transfer buffers, without an intermediate
+		/// copy in system memory. Pass the result to Texture(gc, pixelbuffer_set) to upload it from the transfer buffers.
+		static PixelBufferSet load(GraphicContext &gc, const std::string &fullname);
+		static PixelBufferSet load(GraphicContext &gc, IODevice &file);
+
+	private:
+		static PixelBufferSet load(IODevice &file, GraphicContext *gc);
 	};
 
 	/// \}
@@ -30,6 +30,7 @@
 
 #include "../Image/pixel_buffer.h"
 #include "../../Core/IOData/file_system.h"
+#include "../../Core/System/databuffer.h"
 
 namespace clan
 {
@@ -59,6 +60,19 @@ namespace clan
 			IODevice &file,
 			bool srgb = false);
 
+		/// \brief Loads an image downscaled while decoding, which is much faster than scaling it afterwards
+		///
+		/// \param scale_denominator 1, 2, 4 or 8. The image is decoded at 1/scale_denominator of its size, rounded up.
+		static PixelBuffer load_scaled(
+			IODevice &file,
+			int scale_denominator,
+			bool srgb = false);
+
+		/// \brief Reads the size of an image from its header without decoding it
+		///
+		/// Reads from the current position of the device. The height is 0 if the file defines it after the first scan.
+		static Size get_size(IODevice &file);
+
 		/// \brief Save the given PixelBuffer into a JPEG
 		///
 		/// \param buffer The PixelBuffer to save, format doesn't matter its converted if needed
@@ -80,6 +94,18 @@ namespace clan
 			PixelBuffer buffer,
 			IODevice &file,
 			int quality = 85);
+
+		/// \brief Encodes the given PixelBuffer into a JPEG file in memory
+		///
+		/// The rows of the image are encoded in parallel. The output buffer is replaced by the file,
+		/// keeping its capacity, so passing the same buffer for every frame avoids reallocating it.
+		/// \param buffer The PixelBuffer to encode, format doesn't matter its converted if needed
+		/// \param output Receives the JPEG file
+		/// \param quality The quality level of the JPEG (1-100), 100 being best quality.
+		static void save(
+			PixelBuffer buffer,
+			DataBuffer &output,
+			int quality = 85);
 	};
 
 	/// \}
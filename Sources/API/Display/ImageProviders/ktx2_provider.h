@@ -0,0 +1,79 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "../Image/pixel_buffer_set.h"
+#include "../../Core/IOData/file_system.h"
+
+namespace clan
+{
+	/// \addtogroup clanDisplay_Image_Providers clanDisplay Image Providers
+	/// \{
+
+	class FileSystem;
+	class GraphicContext;
+
+	/// \brief Image provider that can load Khronos texture (.ktx2) files.
+	///
+	/// All mip levels, array layers and cube faces are loaded, so the result can be uploaded directly with
+	/// Texture(gc, pixelbuffer_set). Files without supercompression or with zlib supercompression are supported.
+	/// Basis Universal (BasisLZ and UASTC) payloads need a transcoder and are rejected.
+	class KTX2Provider
+	{
+	public:
+		/// \brief Called to load an image with this provider type.
+		///
+		/// \param filename Name of the file to load.
+		/// \param directory Directory that file name is relative to.
+		static PixelBufferSet load(const std::string &filename, const FileSystem &file_system);
+		static PixelBufferSet load(const std::string &fullname);
+		static PixelBufferSet load(IODevice &file);
+
+		/// \brief Loads the image into transfer textures of the graphic context
+		///
+		/// Unless the file is supercompressed, the pixel data is read straight into the mapped transfer buffers.
+		/// Pass the result to Texture(gc, pixelbuffer_set) to upload it from the transfer buffers.
+		static PixelBufferSet load(GraphicContext &gc, const std::string &fullname);
+		static PixelBufferSet load(GraphicContext &gc, IODevice &file);
+
+		/// \brief Returns the best block compressed format that textures can be created with on the graphic context
+		///
+		/// Use this to pick which of several encoded variants of an asset to load.
+		/// BC7 is preferred over ASTC, ETC2 and S3TC. Returns tf_srgb8_alpha8 or tf_rgba8 if no format is supported.
+		static TextureFormat get_preferred_format(const GraphicContext &gc, bool srgb, bool alpha);
+
+		/// \brief Returns the texture format of a Vulkan format number, or false if it is not supported
+		static bool from_vk_format(unsigned int vk_format, TextureFormat &out_format);
+
+	private:
+		static PixelBufferSet load(IODevice &file, GraphicContext *gc);
+	};
+
+	/// \}
+}
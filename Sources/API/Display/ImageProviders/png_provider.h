@@ -30,6 +30,7 @@
 
 #include "../Image/pixel_buffer.h"
 #include "../../Core/IOData/file_system.h"
+#include <future>
 
 namespace clan
 {
@@ -42,6 +43,15 @@ namespace clan
 	class PNGProvider
 	{
 	public:
+		/// \brief Row filter used when saving
+		enum FilterMode
+		{
+			filter_none,
+			filter_sub,
+			filter_up,
+			filter_adaptive	///< Picks the filter with the smallest sum of absolute differences for each row
+		};
+
 		/// \brief Called to load an image with this provider type.
 		///
 		/// \param name Name of the file to load.
@@ -74,6 +84,21 @@ namespace clan
 
 		/// \brief Save the given PixelBuffer to an output device.
 		static void save(PixelBuffer buffer, IODevice &iodev);
+
+		/// \brief Save the given PixelBuffer to an output device with the given deflate level and row filter
+		///
+		/// \param compression_level Deflate level in range 0-9. Level 1 with filter_sub or filter_up is the fast mode.
+		static void save(PixelBuffer buffer, IODevice &iodev, int compression_level, FilterMode filter);
+
+		/// \brief Saves the given PixelBuffer to a file on a worker thread
+		///
+		/// The pixels are copied before returning, so the buffer can be changed right away.
+		/// \return Future that is ready when the file has been written, and rethrows any error
+		static std::future<void> save_async(
+			PixelBuffer buffer,
+			const std::string &fullname,
+			int compression_level = 1,
+			FilterMode filter = filter_sub);
 	};
 
 	/// \}
@@ -0,0 +1,92 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <memory>
+#include <functional>
+#include "../../Core/Math/rect.h"
+#include "../Image/texture_format.h"
+
+namespace clan
+{
+	/// \addtogroup clanDisplay_Display clanDisplay Display
+	/// \{
+
+	class GraphicContext;
+	class PixelBuffer;
+	class AsyncReadback_Impl;
+
+	/// \brief Reads pixels back from the GPU without stalling the pipeline
+	///
+	/// Each read is copied into a GPU transfer texture and fenced. poll() hands the finished reads to their
+	/// callbacks, usually a frame or two later. Transfer textures are recycled between reads of the same size.
+	/// When more reads than max_pending are in flight, the oldest one is waited for.
+	class AsyncReadback
+	{
+	public:
+		/// \brief Constructs a null instance.
+		AsyncReadback();
+
+		/// \brief Constructs a readback queue
+		///
+		/// \param gc = Graphic Context
+		/// \param max_pending = Number of reads that can be in flight at the same time
+		AsyncReadback(GraphicContext &gc, int max_pending = 3);
+
+		/// \brief Returns true if this object is invalid.
+		bool is_null() const { return !impl; }
+
+		/// \brief Throw an exception if this object is invalid.
+		void throw_if_null() const;
+
+		/// \brief Returns the number of reads that have not yet been handed to their callback
+		int get_pending_count() const;
+
+		/// \brief Queue a read of the current draw buffer
+		///
+		/// \param gc = Graphic Context
+		/// \param rect = Area to read
+		/// \param texture_format = Format of the returned pixels
+		/// \param callback = Called from poll() or finish() with the pixels, top row first
+		void read_pixels(GraphicContext &gc, const Rect &rect, TextureFormat texture_format, const std::function<void(PixelBuffer &)> &callback);
+
+		/// \brief Run the callbacks of all reads the GPU has finished. Never blocks.
+		///
+		/// \return Number of callbacks run
+		int poll(GraphicContext &gc);
+
+		/// \brief Wait for all pending reads and run their callbacks
+		void finish(GraphicContext &gc);
+
+	private:
+		std::shared_ptr<AsyncReadback_Impl> impl;
+	};
+
+	/// \}
+}
@@ -57,8 +57,12 @@ namespace clan
 
 		BlendStateProvider *get_provider() const;
 
+		/// \brief Returns a copy of the description the state was created from
+		BlendStateDescription get_description() const;
+
 	private:
 		std::shared_ptr<BlendStateProvider> provider;
+		std::shared_ptr<BlendStateDescription> description;
 	};
 
 	/// \}
@@ -0,0 +1,190 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <memory>
+#include "vertex_array_buffer.h"
+#include "element_array_buffer.h"
+
+namespace clan
+{
+	/// \addtogroup clanDisplay_Display clanDisplay Display
+	/// \{
+
+	class BufferHeap_Impl;
+
+	/// \brief Part of a buffer handed out by a buffer heap
+	struct BufferRange
+	{
+		BufferRange() { }
+		BufferRange(int offset, int size) : offset(offset), size(size) { }
+
+		/// \brief Returns true if the range is empty, as returned when a heap is out of space
+		bool is_null() const { return size == 0; }
+
+		int offset = 0;
+		int size = 0;
+	};
+
+	/// \brief Manages the space of one large buffer
+	///
+	/// Sizes are rounded up to the alignment. Freed ranges are merged with their free neighbours.
+	class BufferHeap
+	{
+	public:
+		/// \brief Constructs a null instance.
+		BufferHeap();
+
+		/// \brief Constructs a heap
+		///
+		/// \param size = Size of the managed buffer in bytes
+		/// \param alignment = Alignment of the offsets handed out
+		BufferHeap(int size, int alignment = 16);
+
+		/// \brief Returns true if this object is invalid.
+		bool is_null() const { return !impl; }
+
+		/// \brief Throw an exception if this object is invalid.
+		void throw_if_null() const;
+
+		/// \brief Returns the size of the managed buffer
+		int get_size() const;
+
+		/// \brief Returns the alignment of the offsets handed out
+		int get_alignment() const;
+
+		/// \brief Returns the number of bytes not allocated
+		int get_free_size() const;
+
+		/// \brief Returns the size of the largest range that can currently be allocated
+		int get_largest_free_block() const;
+
+		/// \brief Allocates a range, picking the smallest free block that fits
+		///
+		/// \return The range, or a null range if no free block is large enough
+		BufferRange allocate(int size);
+
+		/// \brief Returns a range to the heap
+		void free(const BufferRange &range);
+
+		/// \brief Frees all ranges
+		void clear();
+
+	private:
+		std::shared_ptr<BufferHeap_Impl> impl;
+	};
+
+	/// \brief Vertex array buffer shared by many meshes
+	///
+	/// Meshes reference their range with the offset parameter of PrimitivesArray::set_attributes.
+	class VertexArrayBufferHeap
+	{
+	public:
+		/// \brief Constructs a null instance.
+		VertexArrayBufferHeap() { }
+
+		/// \brief Constructs a heap backed by a new buffer of the given size
+		VertexArrayBufferHeap(GraphicContext &gc, int size, BufferUsage usage = usage_static_draw, int alignment = 16)
+			: buffer(gc, size, usage), heap(size, alignment)
+		{
+		}
+
+		/// \brief Returns true if this object is invalid.
+		bool is_null() const { return buffer.is_null(); }
+
+		/// \brief Returns the buffer holding all ranges
+		VertexArrayBuffer &get_buffer() { return buffer; }
+
+		/// \brief Returns the heap managing the space of the buffer
+		BufferHeap &get_heap() { return heap; }
+
+		/// \brief Allocates a range and uploads data to it
+		///
+		/// \return The range, or a null range if the buffer is full
+		BufferRange allocate(GraphicContext &gc, const void *data, int size)
+		{
+			BufferRange range = heap.allocate(size);
+			if (!range.is_null() && data)
+				buffer.upload_data(gc, range.offset, data, size);
+			return range;
+		}
+
+		/// \brief Returns a range to the heap
+		void free(const BufferRange &range) { heap.free(range); }
+
+	private:
+		VertexArrayBuffer buffer;
+		BufferHeap heap;
+	};
+
+	/// \brief Element array buffer shared by many meshes
+	///
+	/// Meshes reference their range with the offset parameter of GraphicContext::draw_primitives_elements.
+	class ElementArrayBufferHeap
+	{
+	public:
+		/// \brief Constructs a null instance.
+		ElementArrayBufferHeap() { }
+
+		/// \brief Constructs a heap backed by a new buffer of the given size
+		ElementArrayBufferHeap(GraphicContext &gc, int size, BufferUsage usage = usage_static_draw, int alignment = 16)
+			: buffer(gc, size, usage), heap(size, alignment)
+		{
+		}
+
+		/// \brief Returns true if this object is invalid.
+		bool is_null() const { return buffer.is_null(); }
+
+		/// \brief Returns the buffer holding all ranges
+		ElementArrayBuffer &get_buffer() { return buffer; }
+
+		/// \brief Returns the heap managing the space of the buffer
+		BufferHeap &get_heap() { return heap; }
+
+		/// \brief Allocates a range and uploads data to it
+		///
+		/// \return The range, or a null range if the buffer is full
+		BufferRange allocate(GraphicContext &gc, const void *data, int size)
+		{
+			BufferRange range = heap.allocate(size);
+			if (!range.is_null() && data)
+				buffer.upload_data(gc, range.offset, data, size);
+			return range;
+		}
+
+		/// \brief Returns a range to the heap
+		void free(const BufferRange &range) { heap.free(range); }
+
+	private:
+		ElementArrayBuffer buffer;
+		BufferHeap heap;
+	};
+
+	/// \}
+}
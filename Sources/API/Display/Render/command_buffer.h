@@ -0,0 +1,119 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <memory>
+#include <functional>
+#include "graphic_context.h"
+
+namespace clan
+{
+	/// \addtogroup clanDisplay_Display clanDisplay Display
+	/// \{
+
+	class CommandBuffer_Impl;
+
+	/// \brief List of rendering commands recorded for later execution on a graphic context
+	///
+	/// Recording does not touch the graphic context, so worker threads can each fill their own command buffer
+	/// in parallel while the thread owning the graphic context executes the finished buffers in order.
+	/// A command buffer must only be recorded into by one thread at a time.
+	class CommandBuffer
+	{
+	public:
+		/// \brief Constructs an empty command buffer
+		CommandBuffer();
+
+		/// \brief Returns true if no commands have been recorded
+		bool is_empty() const;
+
+		/// \brief Returns the number of recorded commands
+		size_t get_size() const;
+
+		/// \brief Removes all recorded commands, so the buffer can be recorded again
+		void clear_commands();
+
+		/// \brief Reserves space for a number of commands
+		void reserve(size_t size);
+
+		/// \brief Records a custom command
+		void record(const std::function<void(GraphicContext &)> &command);
+
+		/// \brief Appends the commands of another command buffer
+		void append(const CommandBuffer &commands);
+
+		/// \brief Runs the recorded commands on a graphic context. Must be called from the thread owning the context.
+		void execute(GraphicContext &gc) const;
+
+		// The functions below record the GraphicContext function of the same name.
+		// Resource handles are captured by value and kept alive until the buffer is cleared.
+
+		void set_frame_buffer(const FrameBuffer &write_buffer);
+		void reset_frame_buffer();
+		void set_uniform_buffer(int index, const UniformBuffer &buffer);
+		void set_uniform_buffer(int index, const UniformBuffer &buffer, int offset, int size);
+		void reset_uniform_buffer(int index);
+		void set_storage_buffer(int index, const StorageBuffer &buffer);
+		void reset_storage_buffer(int index);
+		void set_texture(int unit_index, const Texture &texture);
+		void reset_texture(int unit_index);
+		void set_rasterizer_state(const RasterizerState &state);
+		void set_blend_state(const BlendState &state, const Colorf &blend_color = Colorf::white, unsigned int sample_mask = 0xffffffff);
+		void set_depth_stencil_state(const DepthStencilState &state, int stencil_ref = 0);
+		void reset_rasterizer_state();
+		void reset_blend_state();
+		void reset_depth_stencil_state();
+		void set_program_object(const ProgramObject &program);
+		void reset_program_object();
+		void set_primitives_array(const PrimitivesArray &array);
+		void reset_primitives_array();
+		void set_primitives_elements(const ElementArrayBuffer &element_array);
+		void reset_primitives_elements();
+		void set_scissor(const Rect &rect, TextureImageYAxis y_axis);
+		void reset_scissor();
+		void set_viewport(const Rectf &viewport);
+
+		void draw_primitives_array(PrimitivesType type, int offset, int num_vertices);
+		void draw_primitives_array_instanced(PrimitivesType type, int offset, int num_vertices, int instance_count);
+		void draw_primitives_array_indirect(PrimitivesType type, const StorageBuffer &commands, size_t offset = 0, int draw_count = 1, int stride = 0);
+		void draw_primitives_elements(PrimitivesType type, int count, VertexAttributeDataType indices_type, size_t offset = 0);
+		void draw_primitives_elements_instanced(PrimitivesType type, int count, VertexAttributeDataType indices_type, size_t offset, int instance_count);
+		void draw_primitives_elements_indirect(PrimitivesType type, VertexAttributeDataType indices_type, const StorageBuffer &commands, size_t offset = 0, int draw_count = 1, int stride = 0);
+		void dispatch(int x = 1, int y = 1, int z = 1);
+
+		void clear(const Colorf &color);
+		void clear_depth(float value = 0);
+		void clear_stencil(int value = 0);
+
+	private:
+		std::shared_ptr<CommandBuffer_Impl> impl;
+	};
+
+	/// \}
+}
@@ -57,8 +57,12 @@ namespace clan
 
 		DepthStencilStateProvider *get_provider() const;
 
+		/// \brief Returns a copy of the description the state was created from
+		DepthStencilStateDescription get_description() const;
+
 	private:
 		std::shared_ptr<DepthStencilStateProvider> provider;
+		std::shared_ptr<DepthStencilStateDescription> description;
 	};
 
 	/// \}
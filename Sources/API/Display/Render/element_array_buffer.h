@@ -76,6 +76,9 @@ namespace clan
 		/// \return provider
 		ElementArrayBufferProvider *get_provider() const;
 
+		/// \brief Returns the size of the buffer in bytes
+		int get_size() const;
+
 		/// \brief Handle comparison operator.
 		bool operator==(const ElementArrayBuffer &other) const;
 
@@ -84,6 +87,9 @@ namespace clan
 		/// The size specified must match the size of the buffer and is only included to help guard against buffer overruns.
 		void upload_data(GraphicContext &gc, const void *data, int size);
 
+		/// \brief Uploads data to a part of the element array buffer.
+		void upload_data(GraphicContext &gc, int offset, const void *data, int size);
+
 		/// \brief Copies data from transfer buffer
 		void copy_from(GraphicContext &gc, TransferBuffer &buffer, int dest_pos = 0, int src_pos = 0, int size = -1);
 
@@ -67,6 +67,29 @@ namespace clan
 		framebuffer_read
 	};
 
+	/// \brief Attachments selected by load/store actions and FrameBuffer::invalidate_attachments
+	enum FrameBufferAttachmentFlags
+	{
+		attachment_color = 1,
+		attachment_depth = 2,
+		attachment_stencil = 4,
+		attachment_all = attachment_color | attachment_depth | attachment_stencil
+	};
+
+	/// \brief What happens to the contents of an attachment when the frame buffer is bound for drawing
+	enum FrameBufferLoadAction
+	{
+		load_action_load,
+		load_action_dont_care
+	};
+
+	/// \brief What happens to the contents of an attachment when the frame buffer is unbound after drawing
+	enum FrameBufferStoreAction
+	{
+		store_action_store,
+		store_action_dont_care
+	};
+
 	/// \brief Frame-buffer object class.
 	class FrameBuffer
 	{
@@ -188,6 +211,29 @@ namespace clan
 		/// \param target = Target
 		void set_bind_target(FrameBufferBindTarget target);
 
+		/// \brief Set what happens to the attachment contents each time the frame buffer is bound for drawing
+		///
+		/// With load_action_dont_care the previous contents are discarded instead of being read back, which saves
+		/// memory bandwidth on tile based GPUs. Use it for attachments that are cleared or fully overwritten.
+		///
+		/// \param action = Load action
+		/// \param attachments = FrameBufferAttachmentFlags combined
+		void set_load_action(FrameBufferLoadAction action, int attachments = attachment_all);
+
+		/// \brief Set what happens to the attachment contents each time the frame buffer stops being the draw target
+		///
+		/// With store_action_dont_care the contents are discarded instead of being written back to memory. Use it for
+		/// attachments only needed while drawing, such as a depth buffer that is never read afterwards.
+		///
+		/// \param action = Store action
+		/// \param attachments = FrameBufferAttachmentFlags combined
+		void set_store_action(FrameBufferStoreAction action, int attachments = attachment_all);
+
+		/// \brief Discard the contents of the attachments. They are undefined until drawn to again.
+		///
+		/// \param attachments = FrameBufferAttachmentFlags combined
+		void invalidate_attachments(int attachments = attachment_all);
+
 		/** Retrieves the pixel ratio of this texture.
 		*  \return The display pixel ratio set for this texture.
 		*          A zero value implies that no pixel ratio has been set
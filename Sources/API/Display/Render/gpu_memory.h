@@ -0,0 +1,123 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include "../Image/texture_format.h"
+
+namespace clan
+{
+	/// \addtogroup clanDisplay_Display clanDisplay Display
+	/// \{
+
+	/// \brief Kinds of GPU allocations tracked by GPUMemoryTracker
+	enum GPUMemoryCategory
+	{
+		gpu_memory_texture,
+		gpu_memory_render_buffer,
+		gpu_memory_vertex_buffer,
+		gpu_memory_element_buffer,
+		gpu_memory_uniform_buffer,
+		gpu_memory_storage_buffer,
+		gpu_memory_transfer_buffer,
+		gpu_memory_pixel_buffer,
+		num_gpu_memory_categories
+	};
+
+	/// \brief Snapshot of the GPU memory allocated by the display targets
+	struct GPUMemoryStats
+	{
+		/// \brief Bytes allocated per category
+		size_t bytes[num_gpu_memory_categories] = {};
+
+		/// \brief Live allocations per category
+		int allocations[num_gpu_memory_categories] = {};
+
+		/// \brief Returns the bytes allocated in all categories
+		size_t get_total_bytes() const;
+	};
+
+	/// \brief Central record of GPU allocations made by the target providers
+	///
+	/// Sizes are computed from the requested dimensions and formats and do not include driver padding.
+	class GPUMemoryTracker
+	{
+	public:
+		/// \brief Returns the current allocation totals
+		static GPUMemoryStats get_stats();
+
+		/// \brief Sets a budget in bytes, or 0 for none
+		///
+		/// The callback is invoked on the allocating thread whenever an allocation takes the total above the budget
+		/// while it was below, so caches and streaming can evict before the driver starts paging.
+		static void set_budget(size_t bytes, const std::function<void(const GPUMemoryStats &)> &over_budget_callback = std::function<void(const GPUMemoryStats &)>());
+
+		/// \brief Returns the budget in bytes, or 0 if none is set
+		static size_t get_budget();
+
+		/// \brief Record a change in allocated bytes. Used by target providers.
+		static void allocate(GPUMemoryCategory category, size_t bytes);
+		static void free(GPUMemoryCategory category, size_t bytes);
+
+		/// \brief Returns the bytes used by a texture including all its mipmap levels
+		///
+		/// \param levels = Number of mipmap levels, or 0 for a full chain
+		static size_t get_texture_size(TextureFormat texture_format, int width, int height, int depth = 1, int array_size = 1, int levels = 1, int samples = 1);
+	};
+
+	/// \brief Tracks the size of one GPU allocation owned by a target provider
+	class GPUMemoryAllocation
+	{
+	public:
+		GPUMemoryAllocation(GPUMemoryCategory category) : category(category) { }
+		~GPUMemoryAllocation() { set_size(0); }
+
+		/// \brief Set the size of the allocation, replacing any earlier size
+		void set_size(size_t new_size)
+		{
+			if (size)
+				GPUMemoryTracker::free(category, size);
+			size = new_size;
+			if (size)
+				GPUMemoryTracker::allocate(category, size);
+		}
+
+		size_t get_size() const { return size; }
+
+	private:
+		GPUMemoryAllocation(const GPUMemoryAllocation &) = delete;
+		GPUMemoryAllocation &operator=(const GPUMemoryAllocation &) = delete;
+
+		GPUMemoryCategory category;
+		size_t size = 0;
+	};
+
+	/// \}
+}
@@ -39,6 +39,7 @@
 #include "primitives_array.h"
 #include "frame_buffer.h"
 #include "element_array_vector.h"
+#include "gpu_memory.h"
 
 namespace clan
 {
@@ -63,6 +64,7 @@ namespace clan
 	class RasterizerState;
 	class BlendState;
 	class DepthStencilState;
+	class PipelineState;
 
 	/// Polygon culling modes.
 	enum CullMode
@@ -195,7 +197,16 @@ namespace clan
 		blend_constant_alpha,
 
 		/// source or destination (1, 1, 1, 1) - (Ac, Ac, Ac, Ac)
-		blend_one_minus_constant_alpha
+		blend_one_minus_constant_alpha,
+
+		/// source or destination (Rs1, Gs1, Bs1, As1) - the second fragment shader output (dual source blending)
+		blend_src1_color,
+
+		/// source or destination (1, 1, 1, 1) - (Rs1, Gs1, Bs1, As1)
+		blend_one_minus_src1_color,
+
+		/// source or destination (1, 1, 1, 1) - (As1, As1, As1, As1)
+		blend_one_minus_src1_alpha
 	};
 
 	/// Blending equations.
@@ -240,7 +251,14 @@ namespace clan
 		program_color_only,
 		program_single_texture,
 		program_sprite,
-		program_path
+		program_path,
+		program_sprite_array,
+		program_sprite_instanced,
+		program_sprite_static,
+		program_path_coverage,
+		program_sprite_distance_field,
+		program_sprite_dual_source,
+		program_box
 	};
 
 	/// Shader language used
@@ -252,6 +270,46 @@ namespace clan
 		num_shader_languages
 	};
 
+	/// Kinds of access that should see the writes of earlier compute dispatches, used by GraphicContext::memory_barrier
+	enum MemoryBarrierFlags
+	{
+		barrier_vertex_attrib = 1,
+		barrier_element_array = 2,
+		barrier_uniform = 4,
+		barrier_texture_fetch = 8,
+		barrier_image_access = 16,
+		barrier_indirect_command = 32,
+		barrier_pixel_buffer = 64,
+		barrier_texture_update = 128,
+		barrier_buffer_update = 256,
+		barrier_frame_buffer = 512,
+		barrier_storage_buffer = 1024,
+		barrier_all = 2047
+	};
+
+	/// Command layout read by GraphicContext::draw_primitives_array_indirect
+	///
+	/// Matches both DrawArraysIndirectCommand in OpenGL and D3D11_DRAW_INSTANCED_INDIRECT_ARGS.
+	struct DrawArraysIndirectCommand
+	{
+		unsigned int count;
+		unsigned int instance_count;
+		unsigned int first;
+		unsigned int base_instance;
+	};
+
+	/// Command layout read by GraphicContext::draw_primitives_elements_indirect
+	///
+	/// Matches both DrawElementsIndirectCommand in OpenGL and D3D11_DRAW_INDEXED_INSTANCED_INDIRECT_ARGS.
+	struct DrawElementsIndirectCommand
+	{
+		unsigned int count;
+		unsigned int instance_count;
+		unsigned int first_index;
+		int base_vertex;
+		unsigned int base_instance;
+	};
+
 	/// Interface to drawing graphics.
 	class GraphicContext
 	{
@@ -281,6 +339,9 @@ namespace clan
 		/// Returns the shader language used
 		ShaderLanguage get_shader_language() const;
 
+		/// Returns the GPU memory allocated by textures, buffers and render buffers, per category
+		GPUMemoryStats get_memory_stats() const;
+
 		/** Returns the major version / feature level supported by the hardware.
 		 *  For an OpenGL target, this returns the major OpenGL version the driver supports.
 		 *  For a Direct3D target, this returns the major feature level.
@@ -300,6 +361,12 @@ namespace clan
 		 */
 		bool has_compute_shader_support() const;
 
+		/** Returns `true` if textures can be created with a block compressed format.
+		 *  Only the hardware formats (s3tc, rgtc, bptc, etc2 and astc) are checked. The generic
+		 *  compressed formats and uncompressed formats always return false.
+		 */
+		bool is_compressed_format_supported(TextureFormat format) const;
+
 		/** Retrieves the texture selected in this context with an index number.
 		 *  \param index The texture index number to retrieve. [0 to n]
 		 *  \return The texture on the specified index. Use Texture::is_null() to
@@ -357,6 +424,9 @@ namespace clan
 		 */
 		Size get_max_texture_size() const;
 
+		/// Returns the alignment the offset of a uniform buffer range must have
+		int get_uniform_buffer_alignment() const;
+
 		/// Returns the provider for this graphic context.
 		GraphicContextProvider *get_provider();
 
@@ -396,6 +466,11 @@ namespace clan
 		/// Select uniform buffer into index
 		void set_uniform_buffer(int index, const UniformBuffer &buffer);
 
+		/// Select a range of a uniform buffer into index
+		///
+		/// The offset must be a multiple of get_uniform_buffer_alignment().
+		void set_uniform_buffer(int index, const UniformBuffer &buffer, int offset, int size);
+
 		/// Remove uniform buffer from index
 		void reset_uniform_buffer(int index);
 
@@ -476,6 +551,11 @@ namespace clan
 		/// Remove active program object.
 		void reset_program_object();
 
+		/// Set program, primitives array and state blocks in one call.
+		///
+		/// Only the parts that differ from the currently active state are applied.
+		void set_pipeline_state(const PipelineState &pipeline);
+
 		/// Returns true if this primitives array is owned by this graphic context.
 		///
 		/// Primitive array objects cannot be shared between graphic contexts.  This function verifies that the primitives array
@@ -506,6 +586,18 @@ namespace clan
 		/// \param instance_count = number of instances drawn
 		void draw_primitives_array_instanced(PrimitivesType type, int offset, int num_vertices, int instance_count);
 
+		/// Draw primitives array using draw commands stored in a buffer
+		///
+		/// The commands are DrawArraysIndirectCommand structures and may be written by a compute shader,
+		/// letting the GPU decide what to draw without a round trip to the CPU.
+		///
+		/// \param type = Primitives Type
+		/// \param commands = Buffer holding the draw commands
+		/// \param offset = Byte offset of the first command in the buffer
+		/// \param draw_count = Number of commands to execute
+		/// \param stride = Bytes between commands, or 0 if they are tightly packed
+		void draw_primitives_array_indirect(PrimitivesType type, const StorageBuffer &commands, size_t offset = 0, int draw_count = 1, int stride = 0);
+
 		/// Sets current elements array buffer
 		void set_primitives_elements(ElementArrayBuffer &element_array);
 
@@ -533,6 +625,19 @@ namespace clan
 		/// \param instance_count = number of instances drawn
 		void draw_primitives_elements_instanced(PrimitivesType type, int count, VertexAttributeDataType indices_type, size_t offset, int instance_count);
 
+		/// Draw primitives elements using draw commands stored in a buffer
+		///
+		/// The indices are read from the current elements array buffer. The commands are DrawElementsIndirectCommand
+		/// structures and may be written by a compute shader, letting the GPU decide what to draw.
+		///
+		/// \param type = Primitives Type
+		/// \param indices_type = Vertex Attribute Data Type
+		/// \param commands = Buffer holding the draw commands
+		/// \param offset = Byte offset of the first command in the buffer
+		/// \param draw_count = Number of commands to execute
+		/// \param stride = Bytes between commands, or 0 if they are tightly packed
+		void draw_primitives_elements_indirect(PrimitivesType type, VertexAttributeDataType indices_type, const StorageBuffer &commands, size_t offset = 0, int draw_count = 1, int stride = 0);
+
 		/// Resets current elements array buffer
 		void reset_primitives_elements();
 
@@ -634,8 +739,27 @@ namespace clan
 		void reset_primitives_array();
 
 		/// Execute a compute shader.
+		///
+		/// The results are visible to all commands that follow.
 		void dispatch(int x = 1, int y = 1, int z = 1);
 
+		/// Execute a compute shader without making its results visible to later commands
+		///
+		/// Call memory_barrier() before the results are used.
+		void dispatch_no_barrier(int x = 1, int y = 1, int z = 1);
+
+		/// Make the writes of earlier compute dispatches visible to the given kinds of access
+		///
+		/// \param barrier_flags = MemoryBarrierFlags combined
+		void memory_barrier(int barrier_flags = barrier_all);
+
+		/// Discard the contents of the current draw frame buffer, or of the window if none is set
+		///
+		/// Tile based GPUs can then skip writing them back to memory. The contents are undefined until drawn to again.
+		///
+		/// \param attachments = FrameBufferAttachmentFlags combined
+		void invalidate_attachments(int attachments = attachment_all);
+
 		/// Clears the whole context using the specified color.
 		void clear(const Colorf &color = Colorf::black);
 
@@ -685,6 +809,7 @@ namespace clan
 		std::shared_ptr<GraphicContext_Impl> impl;
 
 		friend class OpenGL;
+		friend class GraphicContextCapture_Impl;
 	};
 
 	const float pixelcenter_constant = 0.375f;
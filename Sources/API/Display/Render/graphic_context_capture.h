@@ -0,0 +1,83 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include <memory>
+#include "graphic_context.h"
+
+namespace clan
+{
+	/// \addtogroup clanDisplay_Display clanDisplay Display
+	/// \{
+
+	class GraphicContextCapture_Impl;
+	class IODevice;
+
+	/// \brief Records the commands issued on a graphic context into a binary trace for offline profiling.
+	///
+	/// State changes, buffer and texture uploads, draws, clears and compute dispatches are written to the output
+	/// device for the given number of frames. Frames end when the display window is flipped or end_frame is called.
+	/// Resources are defined in the trace the first time a command uses them, including their current contents,
+	/// so a capture can be started at any point. The trace is replayed with GraphicContextReplay.
+	///
+	/// Only one capture can be active per display window. The capture stops by itself after the last frame.
+	class GraphicContextCapture
+	{
+	public:
+		/// \brief Constructs a null instance.
+		GraphicContextCapture();
+
+		/// \brief Starts recording the commands issued on the graphic context and any context sharing its window.
+		GraphicContextCapture(GraphicContext &gc, IODevice &output, int frame_count);
+
+		/// \brief Returns true if this object is invalid.
+		bool is_null() const { return !impl; }
+
+		/// \brief Throw an exception if this object is invalid.
+		void throw_if_null() const;
+
+		/// \brief Returns true while commands are being recorded.
+		bool is_capturing() const;
+
+		/// \brief Returns the number of frames recorded so far.
+		int get_captured_frames() const;
+
+		/// \brief Ends the current frame, for applications that do not flip a display window.
+		void end_frame();
+
+		/// \brief Stops recording and writes any remaining commands to the output device.
+		void stop();
+
+	private:
+		std::shared_ptr<GraphicContextCapture_Impl> impl;
+	};
+
+	/// \}
+}
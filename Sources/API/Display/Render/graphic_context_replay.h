@@ -0,0 +1,122 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "graphic_context.h"
+
+namespace clan
+{
+	/// \addtogroup clanDisplay_Display clanDisplay Display
+	/// \{
+
+	class GraphicContextReplay_Impl;
+	class IODevice;
+
+	/// \brief Kind of command timed by GraphicContextReplay
+	enum GraphicContextReplayCallType
+	{
+		replay_call_draw,
+		replay_call_dispatch,
+		replay_call_clear,
+		replay_call_upload_buffer,
+		replay_call_upload_texture
+	};
+
+	/// \brief GPU timing of one command of a replayed trace
+	class GraphicContextReplayCall
+	{
+	public:
+		/// \brief Frame the command belongs to
+		int frame = 0;
+
+		/// \brief Position of the command within its frame
+		int command_index = 0;
+
+		GraphicContextReplayCallType type = replay_call_draw;
+
+		/// \brief Name of the GraphicContext function that issued the command, such as "draw_primitives_elements"
+		std::string name;
+
+		/// \brief GPU time spent on the command in nanoseconds
+		uint64_t gpu_time = 0;
+
+		/// \brief Vertices or indices drawn (times the instance count), indirect draws issued, or work groups dispatched
+		int64_t element_count = 0;
+
+		/// \brief Bytes transferred by an upload
+		int upload_size = 0;
+
+		/// \brief True if an upload wrote exactly the same data to the same range as the previous upload did
+		bool redundant = false;
+
+		/// \brief Trace id of the buffer or texture uploaded to, or of the program used by a draw or dispatch
+		int resource_id = -1;
+	};
+
+	/// \brief Re-executes a trace recorded by GraphicContextCapture and measures the GPU time of every command.
+	///
+	/// All resources of the trace are created again when replay is called, so a trace can be replayed several times
+	/// to get stable timings. Shaders are recreated from their source, which means a trace can only be replayed with
+	/// the same display target it was captured with.
+	class GraphicContextReplay
+	{
+	public:
+		/// \brief Constructs a null instance.
+		GraphicContextReplay();
+
+		/// \brief Loads a trace recorded by GraphicContextCapture.
+		GraphicContextReplay(IODevice &trace);
+
+		/// \brief Returns true if this object is invalid.
+		bool is_null() const { return !impl; }
+
+		/// \brief Throw an exception if this object is invalid.
+		void throw_if_null() const;
+
+		/// \brief Returns the shader language of the graphic context the trace was captured on.
+		ShaderLanguage get_shader_language() const;
+
+		/// \brief Returns the size of the graphic context the trace was captured on.
+		Size get_size() const;
+
+		/// \brief Replays all frames of the trace and returns the timings of its draws, dispatches, clears and uploads.
+		///
+		/// Blocks on the GPU after each frame to collect the timings.
+		std::vector<GraphicContextReplayCall> replay(GraphicContext &gc);
+
+	private:
+		std::shared_ptr<GraphicContextReplay_Impl> impl;
+	};
+
+	/// \}
+}
@@ -59,9 +59,13 @@ namespace clan
 		void throw_if_null() const;
 
 		/// \brief Returns the result of the occlusion query.
+		///
+		/// Blocks until the GPU has finished the query. Check is_result_ready first to avoid stalling.
 		int get_result();
 
 		/// \brief Returns true if the GPU is ready to return the result.
+		///
+		/// Never blocks or flushes, so it can be polled every frame. Results typically become ready one or two frames after end().
 		bool is_result_ready();
 
 		/// \brief Get Provider
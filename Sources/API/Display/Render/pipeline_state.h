@@ -0,0 +1,98 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <memory>
+#include "../2D/color.h"
+
+namespace clan
+{
+	/// \addtogroup clanDisplay_Display clanDisplay Display
+	/// \{
+
+	class GraphicContext;
+	class ProgramObject;
+	class PrimitivesArray;
+	class RasterizerState;
+	class BlendState;
+	class DepthStencilState;
+	class RasterizerStateDescription;
+	class BlendStateDescription;
+	class DepthStencilStateDescription;
+	class PipelineState_Impl;
+
+	/// \brief Program, vertex layout and fixed function state applied together with GraphicContext::set_pipeline_state
+	///
+	/// The state blocks are resolved once when the pipeline is created. Applying a pipeline only sends the parts
+	/// that differ from what is currently set on the graphic context.
+	class PipelineState
+	{
+	public:
+		/// \brief Constructs a null instance.
+		PipelineState();
+
+		/// \brief Constructs a pipeline from existing state objects
+		///
+		/// \param program = Program object
+		/// \param vertex_layout = Primitives array to bind, or a null instance to leave the current one
+		/// \param rasterizer_state = Rasterizer state
+		/// \param blend_state = Blend state
+		/// \param depth_stencil_state = Depth stencil state
+		PipelineState(const ProgramObject &program, const PrimitivesArray &vertex_layout, const RasterizerState &rasterizer_state, const BlendState &blend_state, const DepthStencilState &depth_stencil_state, const Colorf &blend_color = Colorf::white, unsigned int sample_mask = 0xffffffff, int stencil_ref = 0);
+
+		/// \brief Constructs a pipeline, creating the state objects from descriptions
+		PipelineState(GraphicContext &gc, const ProgramObject &program, const PrimitivesArray &vertex_layout, const RasterizerStateDescription &rasterizer_desc, const BlendStateDescription &blend_desc, const DepthStencilStateDescription &depth_stencil_desc, const Colorf &blend_color = Colorf::white, unsigned int sample_mask = 0xffffffff, int stencil_ref = 0);
+
+		/// \brief Returns true if this object is invalid.
+		bool is_null() const { return !impl; }
+
+		/// \brief Throw an exception if this object is invalid.
+		void throw_if_null() const;
+
+		const ProgramObject &get_program() const;
+		const PrimitivesArray &get_vertex_layout() const;
+		const RasterizerState &get_rasterizer_state() const;
+		const BlendState &get_blend_state() const;
+		const DepthStencilState &get_depth_stencil_state() const;
+		const Colorf &get_blend_color() const;
+		unsigned int get_sample_mask() const;
+		int get_stencil_ref() const;
+
+		/// \brief Returns a hash of the pipeline contents, computed when the pipeline was created
+		size_t get_hash() const;
+
+		/// \brief Returns true if both pipelines set the same state
+		bool operator==(const PipelineState &other) const;
+
+	private:
+		std::shared_ptr<PipelineState_Impl> impl;
+	};
+
+	/// \}
+}
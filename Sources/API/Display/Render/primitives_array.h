@@ -453,6 +453,8 @@ namespace clan
 
 	private:
 		std::shared_ptr<PrimitivesArray_Impl> impl;
+
+		friend class GraphicContextCapture_Impl;
 	};
 
 	/// \}
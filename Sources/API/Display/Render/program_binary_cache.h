@@ -0,0 +1,77 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <string>
+
+namespace clan
+{
+	/// \addtogroup clanDisplay_Display clanDisplay Display
+	/// \{
+
+	class DataBuffer;
+
+	/// \brief On-disk cache of compiled shader programs
+	///
+	/// When a directory is set, OpenGL programs are stored with glGetProgramBinary and Direct3D shaders are stored
+	/// as bytecode. Entries are keyed by a hash of the shader sources and the driver. An entry the driver rejects is
+	/// compiled again from source and replaced. Set the directory before creating the display window, so the
+	/// standard programs are cached too.
+	class ProgramBinaryCache
+	{
+	public:
+		/// \brief Sets the directory the cache is stored in. An empty path disables the cache, which is the default.
+		static void set_directory(const std::string &path);
+
+		/// \brief Returns the cache directory
+		static std::string get_directory();
+
+		/// \brief Returns true if a cache directory is set
+		static bool is_enabled();
+
+		/// \brief Returns the key for an entry identified by the text
+		static std::string get_key(const std::string &text);
+
+		/// \brief Returns true if there is an entry for the key
+		static bool contains(const std::string &key);
+
+		/// \brief Returns the data stored for a key, or an empty buffer if there is none
+		static DataBuffer load(const std::string &key);
+
+		/// \brief Stores data for a key
+		///
+		/// Errors are ignored, as the cache is only an optimization.
+		static void save(const std::string &key, const DataBuffer &data);
+
+		/// \brief Removes the entry for a key
+		static void remove(const std::string &key);
+	};
+
+	/// \}
+}
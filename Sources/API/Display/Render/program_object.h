@@ -47,6 +47,31 @@ namespace clan
 	class XMLResourceDocument;
 	class ProgramObjectProvider;
 
+	/// \brief Location of a uniform variable, resolved once with ProgramObject::get_uniform_handle()
+	///
+	/// The handle converts to the location, so it can be passed to all set_uniform functions that take a location.
+	/// Setting a uniform through a handle does no string work.
+	class UniformHandle
+	{
+	public:
+		/// \brief Constructs a handle to no uniform
+		UniformHandle() : location(-1) { }
+
+		/// \brief Constructs a handle from a uniform location
+		explicit UniformHandle(int location) : location(location) { }
+
+		/// \brief Returns true if the uniform is active in the program
+		bool is_valid() const { return location >= 0; }
+
+		/// \brief Returns the uniform location, or -1 if the uniform is not active
+		int get_location() const { return location; }
+
+		operator int() const { return location; }
+
+	private:
+		int location;
+	};
+
 	/// \brief Program Object
 	///
 	///    <p>The shader objects that are to be used by programmable stages of
@@ -243,6 +268,11 @@ namespace clan
 		/// Returns -1 when unknown
 		int get_uniform_location(const std::string &name) const;
 
+		/// \brief Returns a handle to a named uniform variable, for setting it without further name lookups
+		///
+		/// The handle is only valid for this program, and only until it is linked again.
+		UniformHandle get_uniform_handle(const std::string &name) const { return UniformHandle(get_uniform_location(name)); }
+
 		/// \brief Get the uniform block size
 		///
 		/// An exception is thrown of block_name was not found
@@ -374,6 +404,8 @@ namespace clan
 
 	private:
 		std::shared_ptr<ProgramObject_Impl> impl;
+
+		friend class GraphicContextCapture_Impl;
 	};
 
 	/// \}
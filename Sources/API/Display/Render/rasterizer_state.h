@@ -57,8 +57,12 @@ namespace clan
 
 		RasterizerStateProvider *get_provider() const;
 
+		/// \brief Returns a copy of the description the state was created from
+		RasterizerStateDescription get_description() const;
+
 	private:
 		std::shared_ptr<RasterizerStateProvider> provider;
+		std::shared_ptr<RasterizerStateDescription> description;
 	};
 
 	/// \}
@@ -0,0 +1,99 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <memory>
+#include "../../Core/Math/size.h"
+#include "../Image/texture_format.h"
+
+namespace clan
+{
+	/// \addtogroup clanDisplay_Display clanDisplay Display
+	/// \{
+
+	class GraphicContext;
+	class Texture2D;
+	class RenderBuffer;
+	class FrameBuffer;
+	class RenderTargetPool_Impl;
+
+	/// \brief Pool of transient render targets reused across frames
+	///
+	/// Objects handed out by acquire functions belong to the caller until release() or end_frame() is called.
+	/// A target released in the middle of a frame can be handed out again to a later pass of the same frame, so
+	/// passes whose lifetimes do not overlap share one allocation. Targets unused for a number of frames are destroyed.
+	class RenderTargetPool
+	{
+	public:
+		/// \brief Constructs a null instance.
+		RenderTargetPool();
+
+		/// \brief Constructs a pool
+		///
+		/// \param max_unused_frames = Frames a target may sit unused in the pool before it is destroyed
+		RenderTargetPool(int max_unused_frames);
+
+		/// \brief Returns true if this object is invalid.
+		bool is_null() const { return !impl; }
+
+		/// \brief Throw an exception if this object is invalid.
+		void throw_if_null() const;
+
+		/// \brief Returns a texture that is not in use, creating one if no free texture matches
+		Texture2D acquire_texture(GraphicContext &gc, const Size &size, TextureFormat texture_format = tf_rgba8, int levels = 1);
+
+		/// \brief Returns a render buffer that is not in use, creating one if no free render buffer matches
+		RenderBuffer acquire_render_buffer(GraphicContext &gc, const Size &size, TextureFormat texture_format = tf_rgba8, int multisample_samples = 0);
+
+		/// \brief Returns a frame buffer that is not in use. Attachments from earlier use are left in place.
+		///
+		/// Load and store actions are reset to load and store. Passes that fully overwrite their targets, or
+		/// use a depth buffer only while drawing, should set dont_care actions to save memory bandwidth.
+		FrameBuffer acquire_frame_buffer(GraphicContext &gc);
+
+		/// \brief Hands a target back to the pool before the end of the frame
+		void release(const Texture2D &texture);
+		void release(const RenderBuffer &render_buffer);
+		void release(const FrameBuffer &frame_buffer);
+
+		/// \brief Returns all targets to the pool and destroys those unused for too long
+		void end_frame();
+
+		/// \brief Destroys all targets not in use
+		void clear();
+
+		/// \brief Returns the number of targets owned by the pool, in use or not
+		int get_target_count() const;
+
+	private:
+		std::shared_ptr<RenderTargetPool_Impl> impl;
+	};
+
+	/// \}
+}
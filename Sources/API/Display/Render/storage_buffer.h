@@ -75,6 +75,12 @@ namespace clan
 		/// \return provider
 		StorageBufferProvider *get_provider() const;
 
+		/// \brief Returns the size of the buffer in bytes
+		int get_size() const;
+
+		/// \brief Returns the size of one element in bytes
+		int get_stride() const;
+
 		/// \brief Handle comparison operator.
 		bool operator==(const StorageBuffer &other) const;
 
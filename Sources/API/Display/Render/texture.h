@@ -178,6 +178,11 @@ namespace clan
 		/// \brief Returns true if texture is resident in texture memory.
 		bool is_resident() const;
 
+		/// \brief Returns the most detailed mip level currently in texture memory.
+		///
+		/// This is always 0 except for textures created by a TextureStreamer, where the finer levels are loaded on demand.
+		int get_resident_mip() const;
+
 		/// \brief Get the texture compare mode.
 		TextureCompareMode get_compare_mode() const;
 
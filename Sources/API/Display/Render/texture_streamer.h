@@ -0,0 +1,91 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include "texture_2d.h"
+
+namespace clan
+{
+	/// \addtogroup clanDisplay_Display clanDisplay Display
+	/// \{
+
+	class GraphicContext;
+	class TextureStreamer_Impl;
+
+	/// \brief Streams the mip levels of 2D textures on demand, within a texture memory budget
+	///
+	/// Textures are created with only their coarse mip levels resident. The finer levels are loaded on worker
+	/// threads when request() reports that a texture covers enough of the screen, and are uploaded by update().
+	/// When the resident levels exceed the budget, the textures that were requested least recently are evicted
+	/// back to their coarse levels. Use Texture::get_resident_mip() to see which levels are currently resident.
+	class TextureStreamer
+	{
+	public:
+		/// \brief Constructs a null instance.
+		TextureStreamer();
+
+		/// \brief Constructs a texture streamer
+		///
+		/// \param memory_budget = Maximum number of bytes the streamed mip levels may use
+		TextureStreamer(size_t memory_budget);
+
+		/// \brief Returns true if this object is invalid.
+		bool is_null() const { return !impl; }
+
+		/// \brief Returns the number of bytes used by the resident mip levels
+		size_t get_memory_usage() const;
+
+		/// \brief Returns the memory budget
+		size_t get_memory_budget() const;
+
+		/// \brief Sets the memory budget. Textures are evicted during the next update() if it is exceeded.
+		void set_memory_budget(size_t memory_budget);
+
+		/// \brief Creates a texture that streams its mip levels from a .dds or .ktx2 file
+		///
+		/// The mip levels of 64x64 pixels or smaller are uploaded before this function returns.
+		/// Texture::get_width() and get_height() return the size of the full resolution image.
+		Texture2D load(GraphicContext &gc, const std::string &fullname);
+
+		/// \brief Reports how many pixels on screen the largest side of the texture covers this frame
+		void request(const Texture &texture, float screen_size);
+
+		/// \brief Uploads the mip levels that finished loading and applies the memory budget
+		///
+		/// Call this once per frame on the rendering thread, after the request() calls for the frame.
+		void update(GraphicContext &gc);
+
+	private:
+		std::shared_ptr<TextureStreamer_Impl> impl;
+	};
+
+	/// \}
+}
@@ -0,0 +1,91 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include <memory>
+#include "graphic_context.h"
+
+namespace clan
+{
+	/// \addtogroup clanDisplay_Display clanDisplay Display
+	/// \{
+
+	class TimerQuery_Impl;
+	class GraphicContext;
+	class TimerQueryProvider;
+
+	/// \brief Measures the GPU time spent on the commands issued between begin() and end().
+	///
+	/// Timer queries cannot be nested, and only one may be active on a graphic context at a time.
+	class TimerQuery
+	{
+	public:
+		/// \brief Constructs a null instance.
+		TimerQuery();
+
+		/// \brief Constructs a timer query object.
+		TimerQuery(GraphicContext &context);
+
+		virtual ~TimerQuery();
+
+		/// \brief Returns true if this object is invalid.
+		bool is_null() const { return !impl; }
+
+		/// \brief Throw an exception if this object is invalid.
+		void throw_if_null() const;
+
+		/// \brief Returns the elapsed GPU time in nanoseconds.
+		///
+		/// Blocks until the GPU has finished the query. Check is_result_ready first to avoid stalling.
+		/// Returns 0 if the GPU clock was unreliable while the query ran.
+		uint64_t get_result();
+
+		/// \brief Returns true if the GPU is ready to return the result.
+		///
+		/// Never blocks or flushes, so it can be polled every frame.
+		bool is_result_ready();
+
+		/// \brief Get Provider
+		///
+		/// \return provider
+		TimerQueryProvider *get_provider() const;
+
+		/// \brief Start timing.
+		void begin();
+
+		/// \brief Stop timing.
+		void end();
+
+	private:
+		std::shared_ptr<TimerQuery_Impl> impl;
+	};
+
+	/// \}
+}
@@ -82,6 +82,9 @@ namespace clan
 		/// \return provider
 		UniformBufferProvider *get_provider() const;
 
+		/// \brief Returns the size of the buffer in bytes
+		int get_size() const;
+
 		/// \brief Handle comparison operator.
 		bool operator==(const UniformBuffer &other) const;
 
@@ -90,6 +93,14 @@ namespace clan
 		/// The size specified must match the size of the buffer and is only included to help guard against buffer overruns.
 		void upload_data(GraphicContext &gc, const void *data, int size);
 
+		/// \brief Uploads data to a part of the uniforms buffer.
+		void upload_data(GraphicContext &gc, int offset, const void *data, int size);
+
+		/// \brief Uploads data to a range no queued draw command reads from, without waiting for the GPU.
+		///
+		/// \param discard = Allow the previous contents of the whole buffer to be lost. Used when a streaming buffer wraps around.
+		void upload_data_unsynchronized(GraphicContext &gc, int offset, const void *data, int size, bool discard = false);
+
 		/// \brief Copies data from transfer buffer
 		void copy_from(GraphicContext &gc, TransferBuffer &buffer, int dest_pos = 0, int src_pos = 0, int size = -1);
 
@@ -0,0 +1,101 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <memory>
+#include "uniform_buffer.h"
+
+namespace clan
+{
+	/// \addtogroup clanDisplay_Display clanDisplay Display
+	/// \{
+
+	class GraphicContext;
+	class UniformBufferAllocator_Impl;
+
+	/// \brief Range of a uniform buffer written by UniformBufferAllocator
+	struct UniformBufferAllocation
+	{
+		/// \brief Returns true if nothing was allocated
+		bool is_null() const { return buffer.is_null(); }
+
+		UniformBuffer buffer;
+		int offset = 0;
+		int size = 0;
+	};
+
+	/// \brief Per-frame linear allocator for dynamic uniform blocks
+	///
+	/// Blocks are packed into a few large uniform buffers at the alignment the graphic context requires and are bound
+	/// with the range version of GraphicContext::set_uniform_buffer. Allocations are valid until the frame ends. The
+	/// buffers of a frame are only written again after frames_in_flight calls to next_frame(), so the GPU is never waited on.
+	class UniformBufferAllocator
+	{
+	public:
+		/// \brief Constructs a null instance.
+		UniformBufferAllocator();
+
+		/// \brief Constructs an allocator
+		///
+		/// \param gc = Graphic Context
+		/// \param page_size = Size of each uniform buffer blocks are packed into. No block can be larger than this.
+		/// \param frames_in_flight = Number of frames the GPU may lag behind the CPU
+		UniformBufferAllocator(GraphicContext &gc, int page_size = 64 * 1024, int frames_in_flight = 3);
+
+		/// \brief Returns true if this object is invalid.
+		bool is_null() const { return !impl; }
+
+		/// \brief Throw an exception if this object is invalid.
+		void throw_if_null() const;
+
+		/// \brief Copies a block into the current frame's buffers
+		UniformBufferAllocation allocate(GraphicContext &gc, const void *data, int size);
+
+		/// \brief Copies a block into the current frame's buffers
+		template<typename Type>
+		UniformBufferAllocation allocate(GraphicContext &gc, const Type &block)
+		{
+			return allocate(gc, &block, sizeof(Type));
+		}
+
+		/// \brief Copies a block into the current frame's buffers and selects it into index
+		UniformBufferAllocation set_uniform_buffer(GraphicContext &gc, int index, const void *data, int size);
+
+		/// \brief Ends the current frame. Its allocations must not be used after this.
+		void next_frame();
+
+		/// \brief Returns the number of uniform buffers created by the allocator
+		int get_page_count() const;
+
+	private:
+		std::shared_ptr<UniformBufferAllocator_Impl> impl;
+	};
+
+	/// \}
+}
@@ -29,7 +29,11 @@
 #pragma once
 
 #include "../../Core/Resources/resource.h"
+#include <cstddef>
+#include <functional>
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace clan
 {
@@ -44,6 +48,17 @@ namespace clan
 	class Texture;
 	class Font;
 	class FontDescription;
+	class FileSystem;
+	class DisplayCacheAsyncLoader;
+	class DisplayCacheFileDependencies;
+
+	/// \brief Kinds of resources a display cache can evict
+	enum DisplayCacheResourceType
+	{
+		display_cache_sprite,
+		display_cache_image,
+		display_cache_texture
+	};
 
 	class DisplayCache
 	{
@@ -54,8 +69,75 @@ namespace clan
 		virtual Resource<Texture> get_texture(GraphicContext &gc, const std::string &id) = 0;
 		virtual Resource<Font> get_font(Canvas &canvas, const std::string &family_name, const FontDescription &desc) = 0;
 
+		/// \brief Returns a texture resource at once and decodes its image on a worker thread
+		///
+		/// The resource holds a null texture until process_async_loads() uploads it, after which
+		/// Resource::updated() returns true. The default implementation loads synchronously.
+		virtual Resource<Texture> get_texture_async(GraphicContext &gc, const std::string &id);
+
+		/// \brief Starts loading a group of textures in the background
+		void prefetch_textures(GraphicContext &gc, const std::vector<std::string> &ids);
+
+		/// \brief Uploads textures decoded in the background. Call once per frame on the rendering thread.
+		///
+		/// \param time_budget_microseconds = Time to spend on uploads. At least one texture is uploaded per call.
+		void process_async_loads(GraphicContext &gc, int time_budget_microseconds = 2000);
+
+		/// \brief Returns the number of textures still being decoded or waiting for upload
+		int get_async_loads_pending() const;
+
+		/// \brief Reloads cached resources whose files changed on disk since they were loaded
+		///
+		/// The resource handles are kept and Resource::updated() returns true once the new version is set.
+		/// Textures are decoded on a worker thread and replaced by process_async_loads(). Sprites and images
+		/// are reloaded at once. A file that fails to load keeps the old version and is retried on the next call.
+		/// Only files in plain directories are watched. Call this periodically during development, for example once per second.
+		///
+		/// \return The number of resources reloaded or queued for reload
+		int reload_changed_files();
+
+		/// \brief Evicts cached resources of a type that are only referenced by the cache, least recently used first
+		///
+		/// \param max_bytes = Estimated size to trim down to. 0 evicts all unused resources of the type.
+		/// \return The estimated number of bytes freed
+		virtual size_t trim(DisplayCacheResourceType type, size_t max_bytes = 0) { return 0; }
+
+		/// \brief Sets the estimated memory a resource type may use before unused resources are evicted. 0 means no limit.
+		virtual void set_memory_budget(DisplayCacheResourceType type, size_t bytes) { }
+
+		/// \brief Returns the estimated memory used by the cached resources of a type
+		virtual size_t get_memory_used(DisplayCacheResourceType type) const { return 0; }
+
+		/// \brief Keeps a cached resource loaded even when it is unused
+		virtual void set_pinned(DisplayCacheResourceType type, const std::string &id, bool pinned) { }
+
+		/// \brief Called when a resource is evicted from the cache
+		std::function<void(DisplayCacheResourceType, const std::string &)> &func_resource_evicted() { return resource_evicted; }
+
 		static DisplayCache &get(const ResourceManager &resources);
 		static void set(ResourceManager &resources, const std::shared_ptr<DisplayCache> &cache);
+
+	protected:
+		/// \brief Decodes an image file on a worker thread and sets it on the texture resource when uploaded
+		void load_texture_async(const Resource<Texture> &texture, const std::string &filename, const FileSystem &fs, bool srgb = false);
+
+		/// \brief Records that a resource was loaded from a file, so reload_changed_files() calls reload when the file changes
+		///
+		/// The resource is only referenced weakly. The dependency is dropped once it is destroyed.
+		void add_file_dependency(const std::weak_ptr<Resource_BaseImpl> &resource, const std::string &filename, const FileSystem &fs, const std::function<void()> &reload);
+
+		/// \brief Records that a texture was loaded from a file. Changes are reloaded with load_texture_async().
+		void add_texture_file_dependency(const Resource<Texture> &texture, const std::string &filename, const FileSystem &fs, bool srgb = false);
+
+		/// \brief Estimates the video memory used by a resource, for memory budgets
+		static size_t estimate_size(const Sprite &sprite);
+		static size_t estimate_size(const Image &image);
+		static size_t estimate_size(const Texture &texture);
+
+	private:
+		std::shared_ptr<DisplayCacheAsyncLoader> async_loader;
+		std::shared_ptr<DisplayCacheFileDependencies> file_dependencies;
+		std::function<void(DisplayCacheResourceType, const std::string &)> resource_evicted;
 	};
 
 	/// \}
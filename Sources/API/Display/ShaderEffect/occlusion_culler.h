@@ -0,0 +1,118 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include <memory>
+#include "../../Core/Math/vec4.h"
+#include "../../Core/Math/mat4.h"
+#include "../Render/graphic_context.h"
+#include "../Render/storage_buffer.h"
+#include "../Render/texture_2d.h"
+
+namespace clan
+{
+	/// \addtogroup clanDisplay_Display clanDisplay Display
+	/// \{
+
+	/// \brief Axis aligned bounding box of an object tested by OcclusionCuller
+	///
+	/// Layout of the entries in the bounds buffer. The w components are not used.
+	struct OcclusionCullerBounds
+	{
+		Vec4f aabb_min;
+		Vec4f aabb_max;
+	};
+
+	class OcclusionCuller_Impl;
+
+	/// \brief GPU occlusion culling against a hierarchical depth pyramid
+	///
+	/// <p>update_depth_pyramid() reduces a depth buffer into a pyramid where every texel holds the farthest depth of the
+	///    area it covers. cull() tests object bounds against the pyramid of the previous frame, reprojected with the view
+	///    projection matrix it was built with, and against the view frustum of the current frame. The results are written
+	///    to a visibility buffer and to a copy of the draw commands where culled objects have an instance count of 0,
+	///    ready for GraphicContext::draw_primitives_elements_indirect. Nothing is read back to the CPU.</p>
+	///    <p>A typical frame calls cull(), draws with get_draw_commands() and then calls update_depth_pyramid() with the
+	///    depth buffer just drawn. Objects uncovered by moving occluders appear one frame late. Call reset_history()
+	///    after camera cuts.</p>
+	///    <p>Depth is expected to increase with distance. Requires GLSL compute shader support.</p>
+	class OcclusionCuller
+	{
+	public:
+		/// \brief Constructs a null instance
+		OcclusionCuller();
+
+		/// \brief Constructs an occlusion culler
+		OcclusionCuller(GraphicContext &gc);
+
+		/// \brief Returns true if this object is invalid
+		bool is_null() const { return !impl; }
+
+		/// \brief Throw an exception if this object is invalid
+		void throw_if_null() const;
+
+		/// \brief Tests objects and writes the visibility and draw commands buffers
+		///
+		/// \param view_projection = Matrix transforming the bounds to clip space this frame
+		/// \param bounds = One OcclusionCullerBounds per object
+		/// \param commands = One draw command per object, DrawElementsIndirectCommand or DrawArraysIndirectCommand
+		/// \param count = Number of objects
+		/// \param command_stride = Bytes between commands
+		void cull(GraphicContext &gc, const Mat4f &view_projection, const StorageBuffer &bounds, const StorageBuffer &commands, int count, int command_stride = sizeof(DrawElementsIndirectCommand));
+
+		/// \brief Returns the draw commands written by cull()
+		///
+		/// The buffer holds a copy of the commands passed to cull(), with the instance count of culled objects set to 0.
+		StorageBuffer get_draw_commands() const;
+
+		/// \brief Returns one unsigned int per object, 1 if the last cull() found it visible and 0 otherwise
+		StorageBuffer get_visibility() const;
+
+		/// \brief Builds the depth pyramid used by the next cull()
+		///
+		/// \param depth_texture = Depth buffer of the frame
+		/// \param view_projection = Matrix the frame was drawn with
+		void update_depth_pyramid(GraphicContext &gc, const Texture2D &depth_texture, const Mat4f &view_projection);
+
+		/// \brief Discards the depth pyramid so the next cull() only tests against the view frustum
+		void reset_history();
+
+		/// \brief Returns true if cull() has a depth pyramid to test against
+		bool has_history() const;
+
+		/// \brief Returns the number of levels in the depth pyramid
+		int get_pyramid_level_count() const;
+
+	private:
+		std::shared_ptr<OcclusionCuller_Impl> impl;
+	};
+
+	/// \}
+}
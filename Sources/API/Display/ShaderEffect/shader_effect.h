@@ -59,7 +59,11 @@ namespace clan
 		void draw(GraphicContext &gc);
 
 	private:
+		void dispatch(GraphicContext &gc, int x, int y, int z, bool barrier);
+
 		std::shared_ptr<ShaderEffect_Impl> impl;
+
+		friend class ShaderEffectGraph;
 	};
 
 	/// \}
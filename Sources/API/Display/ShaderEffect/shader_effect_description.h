@@ -77,6 +77,12 @@ namespace clan
 		void set_stencil_data(RenderBuffer buffer);
 		void set_stencil_data(Texture texture);
 
+		/// \brief Set the load action of the effect frame buffer, applied every time the effect is drawn
+		void set_load_action(FrameBufferLoadAction action, int attachments = attachment_all);
+
+		/// \brief Set the store action of the effect frame buffer, applied every time the effect is drawn
+		void set_store_action(FrameBufferStoreAction action, int attachments = attachment_all);
+
 		void set_texture(std::string name, Resource<Texture> texture);
 		void set_image(std::string name, Resource<Texture> texture);
 
@@ -0,0 +1,108 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include <memory>
+#include "shader_effect.h"
+#include "../Render/texture.h"
+#include "../Render/storage_buffer.h"
+#include "../Render/uniform_buffer.h"
+#include "../../Core/Resources/resource.h"
+
+namespace clan
+{
+	/// \addtogroup clanDisplay_Display clanDisplay Display
+	/// \{
+
+	class ShaderEffectGraph_Impl;
+
+	/// \brief Chain of compute ShaderEffect passes with automatic memory barriers
+	///
+	/// <p>Each pass declares the resources it reads and writes. execute() runs the passes in the order they
+	///    were added and only inserts the memory barriers needed for the writes of earlier passes to be seen
+	///    by later ones.</p>
+	///    <p>Passes that do not contribute to an output resource, directly or through later passes, are skipped.</p>
+	///    <p>Transient images are created by the graph. Transient images with the same size and format whose
+	///    lifetimes do not overlap share one texture, and the textures are kept between calls to execute().</p>
+	class ShaderEffectGraph
+	{
+	public:
+		/// \brief Constructs an empty graph
+		ShaderEffectGraph();
+
+		/// \brief Creates an image owned by the graph
+		///
+		/// The texture is assigned by execute(). Bind the returned resource to the shader effects using the image.
+		Resource<Texture> create_transient_image(int width, int height, TextureFormat format = tf_rgba8);
+
+		/// \brief Adds a compute pass
+		///
+		/// \return Index of the pass, used to declare the resources it accesses
+		int add_pass(const ShaderEffect &effect, int x, int y = 1, int z = 1);
+
+		/// \brief Declares an image the pass loads from
+		void read_image(int pass, const Resource<Texture> &image);
+
+		/// \brief Declares a texture the pass samples
+		void read_texture(int pass, const Resource<Texture> &texture);
+
+		/// \brief Declares a storage buffer the pass reads
+		void read_storage(int pass, const Resource<StorageBuffer> &buffer);
+
+		/// \brief Declares a uniform buffer the pass reads
+		void read_uniforms(int pass, const Resource<UniformBuffer> &buffer);
+
+		/// \brief Declares an image the pass stores to
+		void write_image(int pass, const Resource<Texture> &image);
+
+		/// \brief Declares a storage buffer the pass writes
+		void write_storage(int pass, const Resource<StorageBuffer> &buffer);
+
+		/// \brief Marks a resource as used after the graph has run
+		///
+		/// \param barrier_flags = MemoryBarrierFlags describing how the resource is used afterwards
+		void add_output(const Resource<Texture> &texture, int barrier_flags = barrier_all);
+		void add_output(const Resource<StorageBuffer> &buffer, int barrier_flags = barrier_all);
+
+		/// \brief Runs the passes needed to produce the outputs
+		void execute(GraphicContext &gc);
+
+		/// \brief Returns the number of passes run by the last execute()
+		int get_executed_pass_count() const;
+
+		/// \brief Returns the number of memory barriers issued by the last execute()
+		int get_barrier_count() const;
+
+	private:
+		std::shared_ptr<ShaderEffectGraph_Impl> impl;
+	};
+
+	/// \}
+}
@@ -39,12 +39,26 @@ namespace clan
 	class DetectHang_Impl;
 
 	/// \brief Calls CrashReporter::invoke if the constructing thread does not call RunLoop::process for more than 30 seconds.
+	///
+	/// Optionally also samples the stack of the constructing thread at a fixed interval and reports frames
+	/// that take longer than a threshold, together with the stacks captured while they ran.
 	class DetectHang
 	{
 	public:
 		/// \brief Constructs a hang detector.
 		DetectHang();
 
+		/// \brief Constructs a hang detector that also reports slow frames.
+		///
+		/// The constructing thread's stack is captured every sample_interval_ms using CrashReporter::capture_thread_stack.
+		/// Frames longer than frame_threshold_ms, as measured between calls to end_frame(), are appended to a
+		/// text report in reports_directory. Each report lists the distinct stacks seen during the frame with
+		/// their sample counts, most frequent first.
+		DetectHang(const std::string &reports_directory, int frame_threshold_ms = 50, int sample_interval_ms = 5);
+
+		/// \brief Marks the end of a frame. Must be called from the constructing thread.
+		void end_frame();
+
 	private:
 		std::shared_ptr<DetectHang_Impl> impl;
 	};
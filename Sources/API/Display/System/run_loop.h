@@ -52,6 +52,16 @@ namespace clan
 		/// This provides a thread-safe way to execute some code on the main thread
 		/// as part of the message processing step.
 		static void main_thread_async(std::function<void()> func);
+
+		/// \brief Limits how long each message processing step may spend executing main_thread_async work
+		///
+		/// Work left over when the budget runs out is executed during the next processing step, in
+		/// the order it was posted. At least one function is always executed per step.
+		/// \param microseconds Time budget per step, or 0 for no limit (the default)
+		static void set_async_work_budget(int microseconds);
+
+		/// \brief Returns the time budget set by set_async_work_budget
+		static int get_async_work_budget();
 		
 		/// \brief Executes a task on the main thread with a future result
 		///
@@ -33,6 +33,7 @@
 #include "../../Core/Signals/signal.h"
 #include "../Window/display_window.h"
 #include <memory>
+#include <vector>
 
 namespace clan
 {
@@ -258,6 +259,21 @@ namespace clan
 		/// Flip the window display buffers.
 		virtual void flip(int interval) = 0;
 
+		/// Flip the window display buffers, presenting only the damaged areas (in pixels) if supported.
+		virtual void flip(const std::vector<Rect> &damage, int interval) = 0;
+
+		/// Sets the maximum number of flipped frames waiting for the display. 0 restores the default.
+		virtual void set_max_frame_latency(int frames) { }
+
+		/// Enables tearing for frames that miss the vertical blank. Returns false if not supported.
+		virtual bool set_adaptive_vsync(bool enable) { return false; }
+
+		/// Blocks until fewer than the maximum frame latency of frames are waiting for the display.
+		virtual void wait_for_frame_slot() { }
+
+		/// Returns presentation timing of recent frames.
+		virtual FrameTiming get_frame_timing() const { return FrameTiming(); }
+
 		/// Stores text in the clipboard.
 		virtual void set_clipboard_text(const std::string &text) = 0;
 
@@ -0,0 +1,55 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+namespace clan
+{
+	/// \addtogroup clanDisplay_Display clanDisplay Display
+	/// \{
+
+	/// \brief GPU fence provider.
+	///
+	/// A fence is signaled once the GPU has finished all commands issued before it was inserted.
+	class FenceProvider
+	{
+	public:
+		virtual ~FenceProvider() { }
+
+		/// \brief Insert the fence after the commands issued so far, replacing any earlier insertion.
+		virtual void insert() = 0;
+
+		/// \brief Returns true if the GPU has passed the fence. Never blocks.
+		virtual bool is_signaled() = 0;
+
+		/// \brief Blocks until the GPU has passed the fence.
+		virtual void wait() = 0;
+	};
+
+	/// \}
+}
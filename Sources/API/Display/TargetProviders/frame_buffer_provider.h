@@ -127,6 +127,15 @@ namespace clan
 		virtual void detach_depth_stencil() = 0;
 
 		virtual void set_bind_target(FrameBufferBindTarget target) = 0;
+
+		/// \brief Set the load action of the attachments. Targets without tile memory may ignore it.
+		virtual void set_load_action(FrameBufferLoadAction action, int attachments) { }
+
+		/// \brief Set the store action of the attachments. Targets without tile memory may ignore it.
+		virtual void set_store_action(FrameBufferStoreAction action, int attachments) { }
+
+		/// \brief Discard the contents of the attachments
+		virtual void invalidate_attachments(int attachments) { }
 	};
 
 	/// \}
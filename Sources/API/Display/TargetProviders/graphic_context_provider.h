@@ -47,6 +47,7 @@ namespace clan
 	class FontProvider;
 	class Font;
 	class OcclusionQueryProvider;
+	class TimerQueryProvider;
 	class ProgramObjectProvider;
 	class ShaderObjectProvider;
 	class FrameBufferProvider;
@@ -58,6 +59,7 @@ namespace clan
 	class PixelBufferProvider;
 	class UniformBufferProvider;
 	class StorageBufferProvider;
+	class FenceProvider;
 	class PrimitivesArrayProvider;
 	class RasterizerStateDescription;
 	class BlendStateDescription;
@@ -90,6 +92,9 @@ namespace clan
 		/// \brief Returns the maximum amount of attributes available.
 		virtual int get_max_attributes() = 0;
 
+		/// \brief Returns the alignment the offset of a uniform buffer range must have.
+		virtual int get_uniform_buffer_alignment() const = 0;
+
 		/// \brief Returns the maximum size of a texture this graphic context supports.
 		/** <p>It returns Size(0,0) if there is no known limitation to the max
 			texture size.</p>*/
@@ -134,15 +139,27 @@ namespace clan
 		/// For Direct3D 10.0 and 10.1 the support for compute shaders is optional.
 		virtual bool has_compute_shader_support() const = 0;
 
+		/// \brief Returns true if textures can be created with the block compressed format
+		virtual bool is_compressed_format_supported(TextureFormat format) const = 0;
+
 		/// \brief Return the content of the draw buffer into a pixel buffer.
 		virtual PixelBuffer get_pixeldata(const Rect& rect, TextureFormat texture_format, bool clamp) const = 0;
 
+		/// \brief Queue a copy of the draw buffer into a GPU pixel buffer created with data_from_gpu. Does not wait for the copy.
+		virtual void read_pixels(const Rect& rect, PixelBufferProvider *destination) = 0;
+
 		/// \brief Allocate texture provider for this gc.
 		virtual TextureProvider *alloc_texture(TextureDimensions texture_dimensions) = 0;
 
 		/// \brief Allocate occlusion query provider of this gc.
 		virtual OcclusionQueryProvider *alloc_occlusion_query() = 0;
 
+		/// \brief Allocate timer query provider of this gc.
+		virtual TimerQueryProvider *alloc_timer_query() = 0;
+
+		/// \brief Allocate fence provider of this gc.
+		virtual FenceProvider *alloc_fence() = 0;
+
 		/// \brief Allocate program object provider of this gc.
 		virtual ProgramObjectProvider *alloc_program_object() = 0;
 
@@ -208,6 +225,11 @@ namespace clan
 		/// \brief Select uniform buffer into index
 		virtual void set_uniform_buffer(int index, const UniformBuffer &buffer) = 0;
 
+		/// \brief Select a range of a uniform buffer into index
+		///
+		/// The offset is a multiple of get_uniform_buffer_alignment().
+		virtual void set_uniform_buffer_range(int index, const UniformBuffer &buffer, int offset, int size) = 0;
+
 		/// \brief Remove uniform buffer from index
 		virtual void reset_uniform_buffer(int index) = 0;
 
@@ -255,6 +277,9 @@ namespace clan
 		/// \brief Draws instanced primitives from the current assigned primitives array.
 		virtual void draw_primitives_array_instanced(PrimitivesType type, int offset, int num_vertices, int instance_count) = 0;
 
+		/// \brief Draws primitives from the current assigned primitives array using DrawArraysIndirectCommand structures in a buffer.
+		virtual void draw_primitives_array_indirect(PrimitivesType type, const StorageBuffer &commands, size_t offset, int draw_count, int stride) = 0;
+
 		/// \brief Sets current elements array buffer
 		virtual void set_primitives_elements(ElementArrayBufferProvider *array_provider) = 0;
 
@@ -275,6 +300,16 @@ namespace clan
 		/// \param instance_count = number of instances drawn
 		virtual void draw_primitives_elements_instanced(PrimitivesType type, int count, VertexAttributeDataType indices_type, size_t offset, int instance_count) = 0;
 
+		/// \brief Draw primitives elements using DrawElementsIndirectCommand structures in a buffer
+		///
+		/// \param type = Primitives Type
+		/// \param indices_type = Vertex Attribute Data Type
+		/// \param commands = Buffer holding the draw commands
+		/// \param offset = Byte offset of the first command
+		/// \param draw_count = Number of commands
+		/// \param stride = Bytes between commands, or 0 if they are tightly packed
+		virtual void draw_primitives_elements_indirect(PrimitivesType type, VertexAttributeDataType indices_type, const StorageBuffer &commands, size_t offset, int draw_count, int stride) = 0;
+
 		/// \brief Resets current elements array buffer
 		virtual void reset_primitives_elements() = 0;
 
@@ -308,6 +343,15 @@ namespace clan
 		/// \brief Execute a compute shader.
 		virtual void dispatch(int x, int y, int z) = 0;
 
+		/// \brief Execute a compute shader without a memory barrier.
+		virtual void dispatch_no_barrier(int x, int y, int z) { dispatch(x, y, z); }
+
+		/// \brief Make the writes of earlier compute dispatches visible to the given kinds of access.
+		virtual void memory_barrier(int barrier_flags) { }
+
+		/// \brief Discard the contents of the given attachments of the current draw frame buffer or window.
+		virtual void invalidate_attachments(int attachments) { }
+
 		/// \brief Clears the whole context using the specified color.
 		virtual void clear(const Colorf &color) = 0;
 
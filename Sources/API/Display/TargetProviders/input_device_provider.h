@@ -101,6 +101,9 @@ namespace clan
 
 		/// \brief Sets the actual position of the device. (Pointing devices only)
 		virtual void set_device_position(int x, int y) { }
+
+		/// \brief Enables unaccelerated relative motion events. Returns false if not supported.
+		virtual bool set_raw_input(bool /* enable */) { return false; }
 	};
 
 	/// \}
@@ -56,6 +56,14 @@ namespace clan
 		/// The size specified must match the size of the buffer and is only included to help guard against buffer overruns.
 		virtual void upload_data(GraphicContext &gc, const void *data, int size) = 0;
 
+		/// \brief Uploads data to a part of the uniforms buffer.
+		virtual void upload_data(GraphicContext &gc, int offset, const void *data, int size) = 0;
+
+		/// \brief Uploads data to a range no queued draw command reads from
+		///
+		/// Providers that can skip synchronizing with the GPU override this. With discard set the previous contents of the whole buffer may be lost.
+		virtual void upload_data_unsynchronized(GraphicContext &gc, int offset, const void *data, int size, bool discard) { upload_data(gc, offset, data, size); }
+
 		/// \brief Copies data from transfer buffer
 		virtual void copy_from(GraphicContext &gc, TransferBuffer &buffer, int dest_pos, int src_pos, int size) = 0;
 
@@ -32,7 +32,9 @@
 
 #include "../../Core/Signals/signal.h"
 #include "../display_target.h"
+#include "frame_timing.h"
 #include <memory>
+#include <vector>
 
 #if !defined(WIN32) && !defined(__ANDROID__) && !defined(__APPLE__)
 // We prefer not to include Xlib.h in clanlib (to prevent namespace issues when "using namespace clan")
@@ -338,6 +340,37 @@ namespace clan
 		/// \param interval = See note
 		void flip(int interval = -1);
 
+		/// \brief Flip back buffer to front, telling the system that only the damaged areas changed.
+		///
+		/// <p>The areas are in the same coordinates as Canvas::get_damage(). Where the platform supports
+		/// it, only these areas are presented and the rest of the back buffer is preserved for the next frame.
+		/// Otherwise this is the same as flip(interval).</p>
+		///
+		/// \param damage = Changed areas since the previous flip
+		/// \param interval = See flip(int interval)
+		void flip(const std::vector<Rectf> &damage, int interval = -1);
+
+		/// \brief Limits how many flipped frames may be queued ahead of the display
+		///
+		/// Lower values reduce the delay between reading input and the frame showing up on screen, at the
+		/// cost of less overlap between the CPU and the GPU. 0 restores the default of the target.
+		void set_max_frame_latency(int frames);
+
+		/// \brief Lets a frame that missed the vertical blank tear instead of waiting a full refresh
+		///
+		/// Only affects flip intervals above 0. Uses EXT_swap_control_tear on OpenGL.
+		/// \return False if the target does not support adaptive vsync.
+		bool set_adaptive_vsync(bool enable);
+
+		/// \brief Blocks until another frame can be flipped without exceeding the maximum frame latency
+		///
+		/// Call this before reading input for a new frame. The wait then happens before the input is sampled
+		/// instead of inside flip(), so the frame is built from the most recent input.
+		void wait_for_frame_slot();
+
+		/// \brief Returns when recent frames reached the display
+		FrameTiming get_frame_timing() const;
+
 		/// \brief Shows the mouse cursor.
 		void show_cursor();
 
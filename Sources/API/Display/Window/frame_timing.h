@@ -0,0 +1,69 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include <cstdint>
+
+namespace clan
+{
+	/// \addtogroup clanDisplay_Window clanDisplay Window
+	/// \{
+
+	/// \brief Presentation timing of a display window, as returned by DisplayWindow::get_frame_timing()
+	///
+	/// Frames are numbered from 1 in the order they were flipped. Times are in microseconds on the
+	/// System::get_microseconds clock.
+	class FrameTiming
+	{
+	public:
+		/// \brief Number of frames flipped so far
+		uint64_t frames_presented = 0;
+
+		/// \brief Newest frame known to have been displayed, or 0 if none is known yet
+		uint64_t last_displayed_frame = 0;
+
+		/// \brief Time last_displayed_frame was displayed
+		uint64_t display_time = 0;
+
+		/// \brief Time between the two most recently displayed frames
+		uint64_t frame_interval = 0;
+
+		/// \brief Frames flipped but not yet displayed
+		int frames_in_flight = 0;
+
+		/// \brief True if display_time is the vertical blank the frame was shown at
+		///
+		/// When false, display_time is when the GPU finished the frame. With vsync enabled the frame
+		/// becomes visible at the following vertical blank.
+		bool display_time_exact = false;
+	};
+
+	/// \}
+}
@@ -32,6 +32,7 @@
 #include "../../Core/Signals/signal.h"
 #include "../../Core/Math/point.h"
 #include <memory>
+#include <vector>
 
 namespace clan
 {
@@ -135,6 +136,23 @@ namespace clan
 		/// \brief Sets the actual position of the device. (Pointing devices only)
 		void set_device_position(int x, int y);
 
+		/// \brief Enables unaccelerated relative motion events from the device. (Pointing devices only)
+		///
+		/// Raw motion is reported through sig_pointer_raw_move() as InputEvent::pointer_raw_moved events, in
+		/// addition to the regular events. It uses Raw Input on Windows and XInput2 raw events on X11.
+		/// \return False if raw input is not available for this device.
+		bool set_raw_input(bool enable);
+
+		/// \brief Queues events instead of only emitting them one at a time
+		///
+		/// While enabled, every event is also appended to a queue that take_events() returns. This lets a game
+		/// read all input of a frame, with timestamps, in one call instead of connecting to each signal.
+		/// At most 4096 events are kept; older events are discarded if the queue is not drained.
+		void set_event_batching(bool enable);
+
+		/// \brief Returns and clears the events queued since the last call, oldest first.
+		std::vector<InputEvent> take_events();
+
 		/// \brief Signal emitted when key is pressed.
 		Signal<void(const InputEvent &)> &sig_key_down();
 
@@ -144,6 +162,9 @@ namespace clan
 		/// \brief Signal emitted when pointer is moved (absolute movement).
 		Signal<void(const InputEvent &)> &sig_pointer_move();
 
+		/// \brief Signal emitted for unaccelerated relative movement when raw input is enabled.
+		Signal<void(const InputEvent &)> &sig_pointer_raw_move();
+
 		/// \brief Signal emitted when axis is moved.
 		Signal<void(const InputEvent &)> &sig_axis_move();
 
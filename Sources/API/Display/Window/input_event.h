@@ -51,7 +51,8 @@ namespace clan
 			doubleclick = 3,
 			pointer_moved = 4,
 			axis_moved = 5,
-			proximity_change = 6
+			proximity_change = 6,
+			pointer_raw_moved = 7
 		};
 
 		/// \brief Constructs a 'NoKey' key.
@@ -84,6 +85,9 @@ namespace clan
 		/// \brief Mouse actual position at event time.
 		Point mouse_device_pos;
 
+		/// \brief Unaccelerated relative movement in device units. (pointer_raw_moved events only)
+		Pointf raw_delta;
+
 		/// \brief Axis position.
 		double axis_pos;
 
@@ -96,6 +100,9 @@ namespace clan
 		bool alt;
 		bool shift;
 		bool ctrl;
+
+		/// \brief Time the event was received from the system, in microseconds. Same clock as System::get_microseconds.
+		uint64_t timestamp;
 	};
 
 	/// \}
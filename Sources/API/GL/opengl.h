@@ -69,6 +69,40 @@ namespace clan
 
 	} MessageLog_GL;
 
+	/// \brief Number of state changes a graphic context passed on to OpenGL, and dropped because they would have no effect
+	struct OpenGLStateChangeCount
+	{
+		unsigned int issued = 0;
+		unsigned int dropped = 0;
+	};
+
+	/// \brief State change counters of an OpenGL graphic context
+	struct OpenGLStateCounters
+	{
+		OpenGLStateChangeCount texture_units;
+		OpenGLStateChangeCount textures;
+		OpenGLStateChangeCount uniform_buffers;
+		OpenGLStateChangeCount storage_buffers;
+		OpenGLStateChangeCount programs;
+		OpenGLStateChangeCount vertex_arrays;
+		OpenGLStateChangeCount frame_buffers;
+		OpenGLStateChangeCount blend_states;
+		OpenGLStateChangeCount rasterizer_states;
+		OpenGLStateChangeCount depth_stencil_states;
+	};
+
+	/// \brief Time spent creating OpenGL contexts and resolving their function tables
+	///
+	/// Contexts using the same driver share one function table, so only the first of them pays for resolving the entry points.
+	struct OpenGLSetupTimings
+	{
+		uint64_t context_creation_microseconds = 0;
+		uint64_t function_binding_microseconds = 0;
+		unsigned int contexts_created = 0;
+		unsigned int function_tables_created = 0;
+		unsigned int function_tables_shared = 0;
+	};
+
 	/// \brief OpenGL utility class.
 	class OpenGL
 	{
@@ -116,6 +150,20 @@ namespace clan
 		/// The returned object takes ownership of the texture handle (it calls glDeleteTextures when destroyed)
 		static Texture from_texture_handle(GLuint type, GLuint handle);
 
+		/// \brief Returns how many state changes the graphic context issued and dropped as redundant
+		///
+		/// Only OpenGL 3 graphic contexts filter state changes. Other contexts return zero counters.
+		static OpenGLStateCounters get_state_counters(GraphicContext &gc);
+
+		/// \brief Sets the state change counters of the graphic context to zero
+		static void reset_state_counters(GraphicContext &gc);
+
+		/// \brief Returns the time spent creating contexts and binding their functions since startup or the last reset
+		static OpenGLSetupTimings get_setup_timings();
+
+		/// \brief Sets the setup timings to zero
+		static void reset_setup_timings();
+
 		static GLenum to_enum(DrawBuffer buf);
 		static GLenum to_enum(CompareFunction func);
 		static GLenum to_enum(StencilOp op);
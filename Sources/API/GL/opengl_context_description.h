@@ -73,6 +73,15 @@ namespace clan
 		/// \brief Returns the layer plane value
 		int get_layer_plane() const;
 
+		/// \brief Returns true if windows are created without a window system
+		bool get_headless() const;
+
+		/// \brief Returns the index of the GPU used for headless rendering
+		int get_headless_device() const;
+
+		/// \brief Returns true if headless rendering is forced onto a CPU rasterizer
+		bool get_headless_software() const;
+
 		/// \brief Select the OpenGL version number
 		///
 		/// Defaults to OpenGL 3.2 with lower versions (will drop to Legacy OpenGL without shader support if lower)
@@ -122,6 +131,33 @@ namespace clan
 		/// \param value = The layer plane. (Default is 0 - the main plane)
 		void set_layer_plane(int value);
 
+		/// \brief Sets the headless flag
+		///
+		/// If true, display windows are created as offscreen EGL contexts that need no
+		/// X11 display. The window description size selects the size of the pbuffer
+		/// backing the default frame buffer. A zero size creates a surfaceless context,
+		/// where all rendering must go to FrameBuffer objects.
+		/// Only supported on Linux, and only for OpenGL 3 or newer.
+		///
+		/// \param enable = true - Enable this option (Default is false)
+		void set_headless(bool enable);
+
+		/// \brief Sets the GPU used for headless rendering
+		///
+		/// \param index = EGL device index, less than OpenGLTarget::get_headless_device_count() (Default is 0)
+		void set_headless_device(int index);
+
+		/// \brief Forces headless rendering onto the first CPU rasterizer device
+		///
+		/// Mesa's llvmpipe bins primitives into tiles and shades them on all cores
+		/// with SIMD, and produces the same pixels on every machine. This makes it
+		/// suitable for CPU-only servers and for reference images in automated tests,
+		/// even on hosts that also have a GPU. Overrides set_headless_device().
+		/// Thread count is controlled by the driver (LP_NUM_THREADS for llvmpipe).
+		///
+		/// \param enable = true - Enable this option (Default is false)
+		void set_headless_software(bool enable);
+
 	private:
 		std::shared_ptr<OpenGLContextDescription_Impl> impl;
 	};
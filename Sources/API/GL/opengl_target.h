@@ -90,6 +90,14 @@ namespace clan
 
 		/// \brief Set OpenGL context used by this GraphicContext to be active
 		static void set_active_context(const GraphicContext &gc);
+
+		/// \brief Returns the number of GPUs available for headless rendering
+		///
+		/// Returns 0 on platforms without headless support.
+		static int get_headless_device_count();
+
+		/// \brief Returns true if the headless device at index rasterizes on the CPU
+		static bool is_headless_device_software(int index);
 	};
 
 	/// \}
@@ -0,0 +1,98 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include <memory>
+
+namespace clan
+{
+	/// \addtogroup clanGL_Display clanGL Display
+	/// \{
+
+	class Canvas;
+	class DisplayWindow;
+	class OpenGLWindowPresenter_Impl;
+
+	/// \brief Renders several display windows on the context of one window and presents them together.
+	///
+	/// Every window normally renders with its own OpenGL context, so drawing and flipping N windows makes the
+	/// contexts current many times per frame. The presenter instead gives each additional window a canvas that
+	/// renders into a frame buffer object on the context of the main window. present() then copies the frame
+	/// buffers to the windows and swaps them all during one activation of that context.
+	///
+	/// Where the platform allows it (GLX, WGL and EGL with windows of the same pixel format), the main context is
+	/// bound to the surface of each window in turn, so no other context is ever made current. Otherwise each
+	/// window costs one context switch in present(), where it copies the shared texture and flips.
+	///
+	/// Windows presented through the main context skip the frame latency limiting and frame timing of their own flip.
+	class OpenGLWindowPresenter
+	{
+	public:
+		/// \brief Constructs a null instance.
+		OpenGLWindowPresenter();
+
+		/// \brief Constructs a presenter rendering on the context of the main window.
+		OpenGLWindowPresenter(DisplayWindow &main_window);
+
+		/// \brief Returns true if this object is invalid.
+		bool is_null() const { return !impl; }
+
+		/// \brief Throw an exception if this object is invalid.
+		void throw_if_null() const;
+
+		/// \brief Adds a window to present with the main window.
+		void add_window(DisplayWindow &window);
+
+		/// \brief Stops presenting a window. Its own context is used for rendering again.
+		void remove_window(DisplayWindow &window);
+
+		/// \brief Returns the canvas to draw the next frame of a window with.
+		///
+		/// Call this every frame. The frame buffer behind the canvas is recreated when the window has been resized.
+		/// For the main window this is a regular canvas of the window.
+		Canvas get_canvas(DisplayWindow &window);
+
+		/// \brief Copies the frames of all windows to their windows and flips them.
+		///
+		/// \param interval = Swap interval of the main window. See DisplayWindow::flip.
+		void present(int interval = -1);
+
+		/// \brief Returns how many times another context had to be made current in the last present.
+		int get_context_switches() const;
+
+		/// \brief Returns how many times the main context was bound to the surface of another window in the last present.
+		int get_surface_switches() const;
+
+	private:
+		std::shared_ptr<OpenGLWindowPresenter_Impl> impl;
+	};
+
+	/// \}
+}
@@ -31,6 +31,7 @@
 
 #include "connection_site.h"	// TODO: Remove
 #include "../../Core/Signals/signal.h"
+#include "connection_stats.h"
 
 namespace clan
 {
@@ -40,6 +41,7 @@ namespace clan
 	class NetGameEvent;
 	class NetGameConnection;
 	class NetGameClient_Impl;
+	enum class NetGameReliability;
 
 	/// \brief NetGameClient
 	class NetGameClient : NetGameConnectionSite
@@ -54,9 +56,37 @@ namespace clan
 		/// \param port = String
 		void connect(const std::string &server, const std::string &port);
 
+		/// \brief Connect using the UDP transport
+		///
+		/// \param server = String
+		/// \param port = String
+		void connect_udp(const std::string &server, const std::string &port);
+
 		/// \brief Disconnect
 		void disconnect();
 
+		/// \brief Sets the number of I/O threads shared by all clients in the process
+		///
+		/// With the default of 0 every client gets its own connection thread. Otherwise TCP connections
+		/// are served by a shared pool of threads waiting on epoll or kqueue, which lets one process run
+		/// thousands of clients. connect() then establishes the connection before it returns and throws
+		/// if that fails. The pool is only available on platforms where NetworkPoller is supported;
+		/// elsewhere the setting is ignored. Takes effect the next time a client connects.
+		static void set_shared_io_thread_count(int count);
+
+		/// \brief Sets the flush delay of the TCP connection
+		///
+		/// \see NetGameConnection::set_flush_delay
+		void set_flush_delay(int milliseconds);
+
+		/// \brief Enables compression on the TCP connection
+		///
+		/// \see NetGameConnection::set_compression
+		void set_compression(bool enable, int threshold = 256);
+
+		/// \brief Returns the statistics of the current connection
+		NetGameConnectionStats get_stats();
+
 		/// \brief Process events
 		void process_events();
 
@@ -64,6 +94,12 @@ namespace clan
 		///
 		/// \param game_event = Net Game Event
 		void send_event(const NetGameEvent &game_event);
+
+		/// \brief Send event with a delivery guarantee
+		///
+		/// \param game_event = Net Game Event
+		/// \param reliability = Delivery guarantee. Ignored by the TCP transport.
+		void send_event(const NetGameEvent &game_event, NetGameReliability reliability);
 		Signal<void(const NetGameEvent &)> &sig_event_received();
 
 		/// \brief Sig connected
@@ -30,6 +30,7 @@
 
 #include <vector>
 #include <string>
+#include <memory>
 #include "event.h"
 
 namespace clan
@@ -41,6 +42,26 @@ namespace clan
 	class NetGameConnection_Impl;
 	class SocketName;
 	class TCPConnection;
+	class NetGameReactor;
+	class NetGameUDPTransport;
+	class NetGameUDPPeer;
+	class NetGameConnectionStats;
+	class NetGameLoadLimits;
+
+	/// \brief Delivery guarantee for an event sent over the UDP transport
+	///
+	/// The TCP transport always delivers events reliably and in order.
+	enum class NetGameReliability
+	{
+		/// \brief Sent once. May be lost or arrive out of order.
+		unreliable,
+
+		/// \brief Sent until acknowledged. May arrive out of order.
+		reliable_unordered,
+
+		/// \brief Sent until acknowledged and delivered in the order it was sent
+		reliable_ordered
+	};
 
 	/// \brief NetGameConnection
 	class NetGameConnection
@@ -53,6 +74,12 @@ namespace clan
 		NetGameConnection(NetGameConnectionSite *site, const TCPConnection &connection);
 		NetGameConnection(NetGameConnectionSite *site, const SocketName &socket_name);
 
+		/// \internal Constructs a connection served by the I/O threads of a reactor, optionally pinned to one of them
+		NetGameConnection(NetGameConnectionSite *site, const TCPConnection &connection, NetGameReactor *reactor, int io_thread_index = -1);
+
+		/// \internal Constructs a connection to a peer of the UDP transport
+		NetGameConnection(NetGameConnectionSite *site, NetGameUDPTransport *transport, const std::shared_ptr<NetGameUDPPeer> &peer);
+
 		~NetGameConnection();
 
 		/// \brief Set data
@@ -73,9 +100,41 @@ namespace clan
 		/// \param game_event = Net Game Event
 		void send_event(const NetGameEvent &game_event);
 
+		/// \brief Send event with a delivery guarantee
+		///
+		/// \param game_event = Net Game Event
+		/// \param reliability = Delivery guarantee. Ignored by the TCP transport.
+		void send_event(const NetGameEvent &game_event, NetGameReliability reliability);
+
 		/// \brief Disconnects a client
 		void disconnect();
 
+		/// \brief Sets how long small writes may be held back to coalesce with later events
+		///
+		/// With the default of 0 queued events are written as soon as the connection thread sees them.
+		/// Otherwise events are collected until a full frame is buffered or the delay has passed.
+		/// Ignored by the UDP transport, which already packs events into packets.
+		void set_flush_delay(int milliseconds);
+
+		/// \brief Enables deflate compression of large events
+		///
+		/// Compression is negotiated: events are only compressed once the peer has enabled it too.
+		/// Events smaller than the threshold skip the compressor to keep their latency.
+		/// The compressor keeps its dictionary for the lifetime of the connection. Ignored by the UDP transport.
+		void set_compression(bool enable, int threshold = 256);
+
+		/// \brief Limits the rate and queue lengths of the events of this connection
+		///
+		/// Received events over the rate or receive queue limit, and sent events over the send queue limit,
+		/// are dropped when their priority allows it. Otherwise the connection is disconnected.
+		/// The connection limits of NetGameLoadLimits only apply to NetGameServer. Ignored by the UDP transport.
+		void set_load_limits(const NetGameLoadLimits &limits);
+
+		/// \brief Returns traffic counters, queue state and per event type statistics
+		///
+		/// May be called from any thread.
+		NetGameConnectionStats get_stats() const;
+
 		/// \brief Get Remote name
 		///
 		/// \return remote_name
@@ -0,0 +1,185 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace clan
+{
+	/// \addtogroup clanNetwork_NetGame clanNetwork NetGame
+	/// \{
+
+	/// \brief Histogram with power of two buckets
+	///
+	/// Bucket 0 counts zeros, bucket i counts values in [2^(i-1), 2^i). The last bucket also counts everything larger.
+	class NetGameHistogram
+	{
+	public:
+		enum { bucket_count = 32 };
+
+		NetGameHistogram() : buckets(), count(0) { }
+
+		void add(uint64_t value)
+		{
+			int bucket = 0;
+			while (value != 0 && bucket < bucket_count - 1)
+			{
+				value >>= 1;
+				bucket++;
+			}
+			buckets[bucket]++;
+			count++;
+		}
+
+		void merge(const NetGameHistogram &other)
+		{
+			for (int i = 0; i < bucket_count; i++)
+				buckets[i] += other.buckets[i];
+			count += other.count;
+		}
+
+		uint64_t get_count() const { return count; }
+		uint64_t get_bucket(int index) const { return buckets[index]; }
+
+		/// \brief Upper bound of the bucket holding the given percentile (0-100)
+		uint64_t get_percentile(float percentile) const
+		{
+			uint64_t target = (uint64_t)(count * percentile / 100.0f);
+			uint64_t seen = 0;
+			for (int i = 0; i < bucket_count; i++)
+			{
+				seen += buckets[i];
+				if (seen > target || (seen == count && seen != 0))
+					return i == 0 ? 0 : ((uint64_t)1 << i) - 1;
+			}
+			return 0;
+		}
+
+	private:
+		uint64_t buckets[bucket_count];
+		uint64_t count;
+	};
+
+	/// \brief Traffic statistics for one event name
+	class NetGameEventTypeStats
+	{
+	public:
+		uint64_t events_sent = 0;
+		uint64_t events_received = 0;
+
+		/// \brief Events discarded by the load limits
+		uint64_t events_dropped = 0;
+
+		/// \brief Encoded size of the events, before compression and transport framing
+		uint64_t bytes_sent = 0;
+		uint64_t bytes_received = 0;
+
+		uint64_t encode_microseconds = 0;
+		uint64_t decode_microseconds = 0;
+
+		/// \brief Encoded sizes of sent and received events
+		NetGameHistogram size_histogram;
+
+		void merge(const NetGameEventTypeStats &other)
+		{
+			events_sent += other.events_sent;
+			events_received += other.events_received;
+			events_dropped += other.events_dropped;
+			bytes_sent += other.bytes_sent;
+			bytes_received += other.bytes_received;
+			encode_microseconds += other.encode_microseconds;
+			decode_microseconds += other.decode_microseconds;
+			size_histogram.merge(other.size_histogram);
+		}
+	};
+
+	/// \brief Statistics for a NetGameConnection, or for all connections of a server
+	class NetGameConnectionStats
+	{
+	public:
+		/// \brief Bytes written to and read from the socket, including framing, compression and resends
+		uint64_t bytes_sent = 0;
+		uint64_t bytes_received = 0;
+
+		uint64_t events_sent = 0;
+		uint64_t events_received = 0;
+
+		/// \brief Events discarded by the load limits, including queued events replaced by a newer latest_only event
+		uint64_t events_dropped = 0;
+
+		/// \brief Socket throughput over the last second
+		float bytes_sent_per_second = 0.0f;
+		float bytes_received_per_second = 0.0f;
+
+		/// \brief Reliable messages sent again by the UDP transport
+		uint64_t resends = 0;
+
+		/// \brief Events queued but not yet written, or not yet acknowledged for the UDP transport
+		int send_queue_length = 0;
+
+		/// \brief Milliseconds the oldest queued event has been waiting
+		int send_queue_age = 0;
+
+		/// \brief Round trip time in milliseconds, or -1 if the transport does not measure it
+		float round_trip_time = -1.0f;
+
+		/// \brief Round trip time samples in milliseconds
+		NetGameHistogram round_trip_histogram;
+
+		/// \brief Statistics per event name
+		std::map<std::string, NetGameEventTypeStats> event_types;
+
+		/// \brief Adds the counters of another connection
+		///
+		/// Queue lengths are summed, the queue age and round trip time become the worst of the two.
+		void merge(const NetGameConnectionStats &other)
+		{
+			bytes_sent += other.bytes_sent;
+			bytes_received += other.bytes_received;
+			events_sent += other.events_sent;
+			events_received += other.events_received;
+			events_dropped += other.events_dropped;
+			bytes_sent_per_second += other.bytes_sent_per_second;
+			bytes_received_per_second += other.bytes_received_per_second;
+			resends += other.resends;
+			send_queue_length += other.send_queue_length;
+			if (other.send_queue_age > send_queue_age)
+				send_queue_age = other.send_queue_age;
+			if (other.round_trip_time > round_trip_time)
+				round_trip_time = other.round_trip_time;
+			round_trip_histogram.merge(other.round_trip_histogram);
+			for (const auto &it : other.event_types)
+				event_types[it.first].merge(it.second);
+		}
+	};
+
+	/// \}
+}
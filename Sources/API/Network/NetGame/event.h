@@ -43,7 +43,14 @@ namespace clan
 		NetGameEvent(const std::string &name, std::vector<NetGameEventValue> arg = {});
 
 		/// \return The name of this event.
-		std::string get_name() const { return name; };
+		const std::string &get_name() const { return name; }
+
+		/// \return The hash of the name of this event. See hash_name().
+		unsigned int get_name_id() const { return name_id; }
+
+		/// \brief Hashes an event name into the integer id used by NetGameEventDispatcher
+		static constexpr unsigned int hash_name(const char *name, unsigned int value = 2166136261U) { return *name ? hash_name(name + 1, (value ^ (unsigned char)*name) * 16777619U) : value; }
+		static unsigned int hash_name(const std::string &name);
 
 		/// \return The number of arguments stored in this event.
 		unsigned int get_argument_count() const;
@@ -51,17 +58,22 @@ namespace clan
 		/// Retrieves an argument in this event.
 		/// \param index Index number of the argument to retrieve.
 		/// \return A NetGameEventValue object containing the argument value.
-		NetGameEventValue get_argument(unsigned int index) const;
+		const NetGameEventValue &get_argument(unsigned int index) const;
 
 		/// Adds an argument into this event.
 		/// \param value The argument to store inside this event.
 		void add_argument(const NetGameEventValue &value);
 
+		/// Moves an argument into this event.
+		/// \param value The argument to store inside this event.
+		void add_argument(NetGameEventValue &&value);
+
 		/// \return A string representation of this event, including all of its arguments.
 		std::string to_string() const;
 
 	private:
 		std::string name;
+		unsigned int name_id;
 		std::vector<NetGameEventValue> arguments;
 	};
 
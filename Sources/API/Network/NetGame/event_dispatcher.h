@@ -30,7 +30,8 @@
 #pragma once
 
 #include "event.h"
-#include <map>
+#include "../../Core/System/exception.h"
+#include <unordered_map>
 
 namespace clan
 {
@@ -40,7 +41,16 @@ namespace clan
 	public:
 		typedef std::function< void(const NetGameEvent &, Params...) > CallbackClass;
 
-		CallbackClass &func_event(const std::string &name) { return event_handlers[name]; }
+		/// \brief Returns the handler for events with the given name
+		///
+		/// Handlers are keyed by NetGameEvent::hash_name. Two names with the same hash cannot both have handlers.
+		CallbackClass &func_event(const std::string &name)
+		{
+			auto result = event_handlers.emplace(NetGameEvent::hash_name(name), Handler{ name, CallbackClass() });
+			if (result.first->second.name != name)
+				throw Exception("Event names " + name + " and " + result.first->second.name + " have the same hash");
+			return result.first->second.callback;
+		}
 
 		/** \brief Dispatches the event object.
 		 *  \return true if the event handler is invoked and false if the
@@ -48,10 +58,10 @@ namespace clan
 		 */
 		bool dispatch(const NetGameEvent &game_event, Params... params)
 		{
-			auto it = event_handlers.find(game_event.get_name());
-			if (it != event_handlers.end() && (bool)it->second)
+			auto it = event_handlers.find(game_event.get_name_id());
+			if (it != event_handlers.end() && (bool)it->second.callback && it->second.name == game_event.get_name())
 			{
-				it->second(game_event, params...);
+				it->second.callback(game_event, params...);
 				return true;
 			}
 			else
@@ -61,7 +71,13 @@ namespace clan
 		}
 
 	private:
-		std::map<std::string, CallbackClass> event_handlers;
+		struct Handler
+		{
+			std::string name;
+			CallbackClass callback;
+		};
+
+		std::unordered_map<unsigned int, Handler> event_handlers;
 
 	};
 }
@@ -0,0 +1,116 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+
+namespace clan
+{
+	/// \addtogroup clanNetwork_NetGame clanNetwork NetGame
+	/// \{
+
+	/// \brief Fixed argument layout for a NetGameEvent
+	///
+	/// Events with a registered schema are sent as a small schema id followed by bit-packed
+	/// arguments instead of the event name and a type tag per argument.
+	/// Both sides must register the same schemas in the same order before connecting.
+	class NetGameEventSchema
+	{
+	public:
+		enum FieldType
+		{
+			field_boolean,
+			field_uinteger,
+			field_integer,
+			field_bits,
+			field_number,
+			field_quantized_number,
+			field_string,
+			field_binary
+		};
+
+		struct Field
+		{
+			FieldType type;
+			int bits;
+			float min_value;
+			float max_value;
+		};
+
+		/// Constructs a schema for events with the given name
+		NetGameEventSchema(const std::string &event_name);
+
+		/// \brief Boolean argument, sent as a single bit
+		NetGameEventSchema &add_boolean();
+
+		/// \brief Unsigned integer argument, sent as a varint
+		NetGameEventSchema &add_uinteger();
+
+		/// \brief Integer argument, sent as a zigzag encoded varint
+		NetGameEventSchema &add_integer();
+
+		/// \brief Unsigned integer argument that always fits in the given number of bits (1-32)
+		NetGameEventSchema &add_bits(int bits);
+
+		/// \brief Floating point argument, sent at full precision
+		NetGameEventSchema &add_number();
+
+		/// \brief Floating point argument clamped to [min_value, max_value] and quantized to the given number of bits (1-32)
+		NetGameEventSchema &add_quantized_number(float min_value, float max_value, int bits);
+
+		/// \brief String argument
+		NetGameEventSchema &add_string();
+
+		/// \brief Binary argument
+		NetGameEventSchema &add_binary();
+
+		/// \return The name of the events this schema describes
+		const std::string &get_event_name() const { return event_name; }
+
+		/// \return The argument fields
+		const std::vector<Field> &get_fields() const { return fields; }
+
+		/// \brief Registers a schema
+		///
+		/// Schema ids are assigned in registration order, so registration must happen in the same order on all peers.
+		/// Registering a second schema for an event name already registered throws an exception.
+		static void register_schema(const NetGameEventSchema &schema);
+
+		/// \brief Removes all registered schemas
+		static void clear_schemas();
+
+	private:
+		std::string event_name;
+		std::vector<Field> fields;
+	};
+
+	/// \}
+}
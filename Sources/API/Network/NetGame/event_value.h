@@ -85,6 +85,11 @@ namespace clan
 		/// \param value = String
 		NetGameEventValue(const std::string &value);
 
+		/// \brief Constructs a NetGameEventValue
+		///
+		/// \param value = String
+		NetGameEventValue(std::string &&value);
+
 		/// \brief Constructs a NetGameEventValue
 		///
 		/// \param str = char
@@ -110,6 +115,13 @@ namespace clan
 		/// \param type = Type
 		NetGameEventValue(Type type);
 
+		NetGameEventValue(const NetGameEventValue &other);
+		NetGameEventValue(NetGameEventValue &&other) noexcept;
+		~NetGameEventValue();
+
+		NetGameEventValue &operator=(const NetGameEventValue &other);
+		NetGameEventValue &operator=(NetGameEventValue &&other) noexcept;
+
 		/// \brief Get Type
 		///
 		/// \return type
@@ -173,6 +185,11 @@ namespace clan
 		/// \param value = Net Game Event Value
 		void add_member(const NetGameEventValue &value);
 
+		/// \brief Add member
+		///
+		/// \param value = Net Game Event Value
+		void add_member(NetGameEventValue &&value);
+
 		/// \brief Set member
 		///
 		/// \param index = value
@@ -207,7 +224,7 @@ namespace clan
 		/// \brief To string
 		///
 		/// \return String
-		std::string get_string() const;
+		const std::string &get_string() const;
 
 		/// \brief To boolean
 		///
@@ -217,7 +234,7 @@ namespace clan
 		/// \brief To binary
 		///
 		/// \return binary
-		DataBuffer get_binary() const;
+		const DataBuffer &get_binary() const;
 
 		inline operator unsigned int() const { return get_uinteger(); }
 		inline operator int() const { return get_integer(); }
@@ -234,6 +251,11 @@ namespace clan
 		/// \brief Throw if not complex
 		void throw_if_not_complex() const;
 
+		void construct_from(const NetGameEventValue &other);
+		void construct_from(NetGameEventValue &&other);
+		void destroy();
+
+		// Only the member selected by type is alive, so scalar values never construct heap owning members
 		Type type;
 		union
 		{
@@ -243,10 +265,10 @@ namespace clan
 			unsigned char value_uchar;
 			float value_float;
 			bool value_bool;
+			std::string value_string;
+			DataBuffer value_binary;
+			std::vector<NetGameEventValue> value_complex;
 		};
-		std::string value_string;
-		DataBuffer value_binary;
-		std::vector<NetGameEventValue> value_complex;
 	};
 
 	/// \}
@@ -0,0 +1,105 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <map>
+#include <string>
+
+namespace clan
+{
+	/// \addtogroup clanNetwork_NetGame clanNetwork NetGame
+	/// \{
+
+	/// \brief How an event is treated when a load limit is reached
+	enum class NetGameEventPriority
+	{
+		/// \brief Never dropped. A connection exceeding a limit with it is disconnected.
+		normal,
+
+		/// \brief Dropped when a limit is reached
+		low,
+
+		/// \brief Only the newest matters. A queued event with the same name is replaced, and it is dropped when a limit is reached.
+		latest_only
+	};
+
+	/// \brief Limits that keep a NetGameServer responsive when flooded with clients or events
+	///
+	/// A value of 0 disables the limit. Rates are refilled continuously, the burst is the bucket size.
+	class NetGameLoadLimits
+	{
+	public:
+		/// \brief Connections the server accepts at most. Further clients are closed right after accept.
+		int max_connections = 0;
+
+		/// \brief Accepted connections whose sig_client_connected has not yet been emitted by process_events
+		int max_pending_connections = 0;
+
+		/// \brief Backlog of the listen socket. Takes effect the next time the server is started.
+		int listen_backlog = 5;
+
+		/// \brief New connections per second accepted from one address
+		float connect_rate_per_address = 0.0f;
+		int connect_burst_per_address = 0;
+
+		/// \brief Events per second received from one connection
+		float event_rate = 0.0f;
+		int event_burst = 0;
+
+		/// \brief Encoded event bytes per second received from one connection
+		float byte_rate = 0.0f;
+		int byte_burst = 0;
+
+		/// \brief Received events of one connection waiting for process_events
+		int max_receive_queue = 0;
+
+		/// \brief Events of one connection waiting to be written to the socket
+		int max_send_queue = 0;
+
+		/// \brief Sets the priority of events with the given name. Events default to normal.
+		void set_priority(const std::string &event_name, NetGameEventPriority priority)
+		{
+			if (priority == NetGameEventPriority::normal)
+				priorities.erase(event_name);
+			else
+				priorities[event_name] = priority;
+		}
+
+		NetGameEventPriority get_priority(const std::string &event_name) const
+		{
+			auto it = priorities.find(event_name);
+			return it != priorities.end() ? it->second : NetGameEventPriority::normal;
+		}
+
+	private:
+		std::map<std::string, NetGameEventPriority> priorities;
+	};
+
+	/// \}
+}
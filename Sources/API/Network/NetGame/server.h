@@ -32,6 +32,9 @@
 
 #include "connection_site.h"	// TODO: Remove
 #include "../../Core/Signals/signal.h"
+#include "connection_stats.h"
+#include "load_limits.h"
+#include <vector>
 
 namespace clan
 {
@@ -41,6 +44,8 @@ namespace clan
 	class NetGameEvent;
 	class NetGameConnection;
 	class NetGameServer_Impl;
+	class SocketName;
+	enum class NetGameReliability;
 
 	/// \brief NetGameServer
 	class NetGameServer : NetGameConnectionSite
@@ -60,6 +65,56 @@ namespace clan
 		/// \param port = String
 		void start(const std::string &address, const std::string &port);
 
+		/// \brief Start listening for UDP transport clients
+		///
+		/// \param port = String
+		void start_udp(const std::string &port);
+
+		/// \brief Start listening for UDP transport clients
+		///
+		/// \param address = String
+		/// \param port = String
+		void start_udp(const std::string &address, const std::string &port);
+
+		/// \brief Sets the number of I/O threads serving the connections
+		///
+		/// With the default of 0 every connection gets its own thread. Otherwise all connections
+		/// are served by a fixed pool of threads waiting on epoll or kqueue. The pool is only
+		/// available on platforms where NetworkPoller is supported; elsewhere the setting is ignored.
+		/// Takes effect the next time the server is started.
+		void set_io_thread_count(int count);
+
+		/// \brief Sets the number of TCP listeners accepting new clients
+		///
+		/// With a count above one the server opens that many listeners on the same port using SO_REUSEPORT,
+		/// each with its own accept thread, and lets the kernel spread incoming clients between them.
+		/// When an I/O thread pool is used, the clients accepted by a listener are served by the matching I/O thread.
+		/// Only available where TCPListen::is_reuse_port_supported() is true; elsewhere one listener is used.
+		/// Takes effect the next time the server is started.
+		void set_listener_count(int count);
+
+		/// \brief Sets the flush delay of new TCP connections
+		///
+		/// \see NetGameConnection::set_flush_delay
+		void set_flush_delay(int milliseconds);
+
+		/// \brief Enables compression on new TCP connections
+		///
+		/// \see NetGameConnection::set_compression
+		void set_compression(bool enable, int threshold = 256);
+
+		/// \brief Sets the limits that shed load when the server is flooded
+		///
+		/// Connection limits are checked when a client is accepted, event limits are applied to every new TCP connection.
+		/// \see NetGameConnection::set_load_limits
+		void set_load_limits(const NetGameLoadLimits &limits);
+
+		/// \brief Returns the statistics of all connections added together
+		NetGameConnectionStats get_stats();
+
+		/// \brief Returns the statistics of every connection, for finding slow clients
+		std::vector<std::pair<NetGameConnection *, NetGameConnectionStats>> get_client_stats();
+
 		/// \brief Process events
 		void process_events();
 
@@ -71,14 +126,25 @@ namespace clan
 		/// \param game_event = Net Game Event
 		void send_event(const NetGameEvent &game_event);
 
+		/// \brief Send event to all clients with a delivery guarantee
+		///
+		/// \param game_event = Net Game Event
+		/// \param reliability = Delivery guarantee. Ignored by the TCP transport.
+		void send_event(const NetGameEvent &game_event, NetGameReliability reliability);
+
 		Signal<void(NetGameConnection *)> &sig_client_connected();
 		Signal<void(NetGameConnection *, const std::string &)> &sig_client_disconnected();
 		Signal<void(NetGameConnection *, const NetGameEvent &)> &sig_event_received();
 
 	private:
 
+		/// \brief Opens the TCP listeners and starts their accept threads
+		void start_listen(const SocketName &endpoint);
+
 		/// \brief Listen thread main
-		void listen_thread_main();
+		///
+		/// \param index = Index of the listener served by the thread
+		void listen_thread_main(int index);
 
 		/// \brief Add network event
 		///
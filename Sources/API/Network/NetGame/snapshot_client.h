@@ -0,0 +1,83 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "../../Core/Signals/signal.h"
+#include <memory>
+#include <vector>
+
+namespace clan
+{
+	/// \addtogroup clanNetwork_NetGame clanNetwork NetGame
+	/// \{
+
+	class NetGameEvent;
+	class NetGameEventValue;
+	class NetGameClient;
+	class NetGameSnapshotClient_Impl;
+
+	/// \brief Reconstructs entity state from the snapshots sent by a NetGameSnapshotServer
+	class NetGameSnapshotClient
+	{
+	public:
+		NetGameSnapshotClient();
+		~NetGameSnapshotClient();
+
+		/// \brief Applies a snapshot and acknowledges it to the server
+		///
+		/// \return true if the event was a snapshot
+		bool process_event(NetGameClient &client, const NetGameEvent &e);
+
+		/// \brief Forgets all entities, for example after reconnecting
+		void reset();
+
+		/// \return The id of the most recently applied snapshot, or 0 if none
+		unsigned int get_snapshot_id() const;
+
+		/// \return The ids of all known entities
+		std::vector<unsigned int> get_entity_ids() const;
+
+		/// \return true if the entity is known
+		bool has_entity(unsigned int id) const;
+
+		/// \return The fields of an entity
+		std::vector<NetGameEventValue> get_entity(unsigned int id) const;
+
+		/// \brief Emitted for every entity created or changed by a snapshot
+		Signal<void(unsigned int)> &sig_entity_updated();
+
+		/// \brief Emitted for every entity removed by a snapshot
+		Signal<void(unsigned int)> &sig_entity_removed();
+
+	private:
+		std::shared_ptr<NetGameSnapshotClient_Impl> impl;
+	};
+
+	/// \}
+}
@@ -0,0 +1,91 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+namespace clan
+{
+	/// \addtogroup clanNetwork_NetGame clanNetwork NetGame
+	/// \{
+
+	class NetGameEvent;
+	class NetGameEventValue;
+	class NetGameConnection;
+	class NetGameSnapshotServer_Impl;
+
+	/// \brief Replicates entity state to clients as delta compressed snapshots
+	///
+	/// Every snapshot is encoded against the last snapshot the client acknowledged and only
+	/// carries the entities and fields that changed since then. When the changes do not fit
+	/// in the byte budget, a priority accumulator decides which entities are sent this tick.
+	/// Snapshots are sent unreliably; a lost snapshot is repaired by the next one.
+	class NetGameSnapshotServer
+	{
+	public:
+		/// \brief Constructs a snapshot server
+		///
+		/// \param max_snapshot_bytes = Approximate encoded size limit of a single snapshot
+		NetGameSnapshotServer(int max_snapshot_bytes = 1000);
+		~NetGameSnapshotServer();
+
+		/// \brief Creates or updates an entity
+		///
+		/// \param id = Entity id
+		/// \param fields = Entity state. At most 32 fields.
+		/// \param priority = Amount added to the entity's accumulator each tick it has changes waiting
+		void set_entity(unsigned int id, const std::vector<NetGameEventValue> &fields, float priority = 1.0f);
+
+		/// \brief Removes an entity
+		void remove_entity(unsigned int id);
+
+		/// \brief Starts replicating to a client
+		void add_client(NetGameConnection *connection);
+
+		/// \brief Stops replicating to a client
+		void remove_client(NetGameConnection *connection);
+
+		/// \brief Sends the next snapshot to every client. Call once per tick.
+		void send_snapshots();
+
+		/// \brief Builds the next snapshot for a client without sending it
+		NetGameEvent create_snapshot(NetGameConnection *connection);
+
+		/// \brief Handles snapshot acknowledgements from a client
+		///
+		/// \return true if the event was a snapshot acknowledgement
+		bool process_event(NetGameConnection *connection, const NetGameEvent &e);
+
+	private:
+		std::shared_ptr<NetGameSnapshotServer_Impl> impl;
+	};
+
+	/// \}
+}
@@ -17,6 +17,7 @@ namespace clan
 		virtual SocketHandle *get_socket_handle() = 0;
 
 		friend class NetworkConditionVariable;
+		friend class NetworkPoller;
 	};
 
 	/// \brief Condition variable that also awaken on network events
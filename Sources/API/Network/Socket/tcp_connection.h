@@ -55,6 +55,8 @@ namespace clan
 
 	private:
 		std::shared_ptr<TCPSocket> impl;
+
+		friend class TLSConnection;
 	};
 
 	// To do: QOSAddSocketToFlow
@@ -19,7 +19,13 @@ namespace clan
 		TCPListen();
 
 		/// \brief Create a listening socket for the specified end point
-		TCPListen(const SocketName &endpoint, int backlog = 5, bool reuse_address = true);
+		///
+		/// With reuse_port several listening sockets can bind the same end point and the kernel spreads new
+		/// connections over them. Throws if the platform does not support it, see is_reuse_port_supported().
+		TCPListen(const SocketName &endpoint, int backlog = 5, bool reuse_address = true, bool reuse_port = false);
+
+		/// \brief Returns true if listening sockets sharing an end point get their connections load balanced
+		static bool is_reuse_port_supported();
 
 		~TCPListen();
 
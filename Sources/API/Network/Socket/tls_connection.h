@@ -0,0 +1,76 @@
+
+#pragma once
+
+#include "network_condition_variable.h"
+
+#include <memory>
+
+namespace clan
+{
+	class SocketName;
+	class Secret;
+	class TCPConnection;
+	class TLSConnection_Impl;
+
+	/// \brief TLS client connection over a non-blocking TCP/IP socket
+	///
+	/// The handshake runs as part of read and write, so the connection can be waited on like any other
+	/// network event. Read until it returns -1 before waiting again, as decrypted data may be buffered.
+	class TLSConnection : public NetworkEvent
+	{
+	public:
+		/// \brief Create null object
+		TLSConnection();
+
+		/// \brief Blocking connect to end point, followed by a non-blocking handshake
+		///
+		/// \param endpoint = Server end point
+		/// \param session = Session of an earlier connection to resume, or an empty secret
+		TLSConnection(const SocketName &endpoint, const Secret &session);
+		TLSConnection(const SocketName &endpoint);
+
+		/// \brief Starts a handshake on an already connected socket
+		TLSConnection(const TCPConnection &connection, const Secret &session);
+
+		~TLSConnection();
+
+		/// \brief Returns true if it is a null object
+		bool is_null() const { return !impl; }
+
+		/// \brief Returns true when the handshake has completed
+		bool is_connected() const;
+
+		/// \brief Returns true if the server resumed the session passed to the constructor
+		bool is_session_resumed() const;
+
+		/// \brief Returns the session for resuming a later connection to the same server
+		/** \return The session, or an empty secret if the handshake is incomplete or the server does not support resumption*/
+		Secret get_session() const;
+
+		/// \brief Returns true if encrypted data is waiting for the socket to become writable
+		bool is_write_pending() const;
+
+		/// \brief Returns the socket name of the local end point
+		SocketName get_local_name();
+
+		/// \brief Returns the socket name of the peer end point
+		SocketName get_remote_name();
+
+		/// \brief Close connection
+		void close();
+
+		/// \brief Encrypt and write data to the TCP socket
+		/// \return Bytes accepted, or -1 if buffer is full
+		int write(const void *data, int size);
+
+		/// \brief Read and decrypt data from the TCP socket
+		/// \return Bytes read, 0 if remote closed connection, or -1 if no decrypted data is available
+		int read(void *data, int size);
+
+	protected:
+		SocketHandle *get_socket_handle() override;
+
+	private:
+		std::shared_ptr<TLSConnection_Impl> impl;
+	};
+}
@@ -2,14 +2,25 @@
 #pragma once
 
 #include "network_condition_variable.h"
+#include "socket_name.h"
 #include <memory>
 #include <vector>
 
 namespace clan
 {
-	class SocketName;
 	class UDPSocketImpl;
 
+	/// \brief Datagram sent or received by UDPSocket::send_batch and UDPSocket::read_batch
+	///
+	/// The data buffer is owned by the caller and must stay valid for the duration of the call.
+	struct UDPPacket
+	{
+		void *data = nullptr;
+		int capacity = 0;	///< Size of the data buffer, used by read_batch
+		int size = 0;		///< Bytes to send, or bytes received
+		SocketName endpoint;
+	};
+
 	/// \brief UDP/IP socket class
 	class UDPSocket : public NetworkEvent
 	{
@@ -32,6 +43,16 @@ namespace clan
 		/// \return Bytes read or 0 if no packet was available
 		int read(void *data, int size, SocketName &endpoint);
 
+		/// \brief Send several UDP packets, using as few system calls as the platform allows
+		///
+		/// Like send(), a packet the network stack cannot take is dropped.
+		/// \return Number of packets handed to the network stack
+		int send_batch(const UDPPacket *packets, int count);
+
+		/// \brief Read several received UDP packets, using as few system calls as the platform allows
+		/// \return Number of packets read, 0 if no packet was available
+		int read_batch(UDPPacket *packets, int count);
+
 	protected:
 		SocketHandle *get_socket_handle() override;
 
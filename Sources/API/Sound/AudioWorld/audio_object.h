@@ -52,16 +52,24 @@ namespace clan
 		float get_attenuation_begin() const;
 		float get_attenuation_end() const;
 		float get_volume() const;
+
+		float get_priority() const;
 		bool is_looping() const;
 		bool is_ambience() const;
 		bool is_playing() const;
 
+		/// \brief True if the object is playing, but only advances its position because it ranked below AudioWorld::get_max_voices()
+		bool is_virtual() const;
+
 		void set_position(const Vec3f &position);
 
 		void set_attenuation_begin(float distance);
 		void set_attenuation_end(float distance);
 		void set_volume(float volume);
 
+		/// \brief Sets the priority (default 1). Voices are ranked by priority multiplied by attenuated volume.
+		void set_priority(float priority);
+
 		void set_sound(const std::string &id);
 		void set_sound(const SoundBuffer &buffer);
 
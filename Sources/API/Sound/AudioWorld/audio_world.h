@@ -53,6 +53,10 @@ namespace clan
 		void enable_reverse_stereo(bool enable);
 		bool is_reverse_stereo_enabled() const;
 
+		/// \brief Number of playing objects given a real voice (default 32). The rest are virtual until they rank high enough.
+		void set_max_voices(int max_voices);
+		int get_max_voices() const;
+
 	private:
 		std::shared_ptr<AudioWorld_Impl> impl;
 
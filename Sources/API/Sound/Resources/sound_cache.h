@@ -31,7 +31,10 @@
 #pragma once
 
 #include "../../Core/Resources/resource.h"
+#include <cstddef>
+#include <functional>
 #include <memory>
+#include <string>
 
 namespace clan
 {
@@ -47,8 +50,33 @@ namespace clan
 		virtual ~SoundCache() { }
 		virtual Resource<SoundBuffer> get_sound(const std::string &id) = 0;
 
+		/// \brief Evicts cached sounds that are only referenced by the cache, least recently used first
+		///
+		/// \param max_bytes = Estimated size to trim down to. 0 evicts all unused sounds.
+		/// \return The estimated number of bytes freed
+		virtual size_t trim(size_t max_bytes = 0) { return 0; }
+
+		/// \brief Sets the memory cached sounds may use before unused ones are evicted. 0 means no limit.
+		virtual void set_memory_budget(size_t bytes) { }
+
+		/// \brief Returns the memory used by cached sounds, as reported by their providers
+		virtual size_t get_memory_used() const { return 0; }
+
+		/// \brief Keeps a cached sound loaded even when it is unused
+		virtual void set_pinned(const std::string &id, bool pinned) { }
+
+		/// \brief Called when a sound is evicted from the cache
+		std::function<void(const std::string &)> &func_sound_evicted() { return sound_evicted; }
+
 		static SoundCache &get(const ResourceManager &resources);
 		static void set(ResourceManager &resources, const std::shared_ptr<SoundCache> &cache);
+
+	protected:
+		/// \brief Returns the memory held by the sound's provider, for memory budgets
+		static size_t estimate_size(const SoundBuffer &sound);
+
+	private:
+		std::function<void(const std::string &)> sound_evicted;
 	};
 
 	/// \}
@@ -29,6 +29,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <memory>
 
 namespace clan
@@ -57,6 +58,16 @@ namespace clan
 			here (and in most cases should be delete here).</p>*/
 		virtual void end_session(SoundProvider_Session *session) = 0;
 
+		/// \brief Name the decode time of the provider is reported under in SoundOutputStats
+		///
+		/// The returned string must stay valid for the lifetime of the program.
+		virtual const char *get_name() const { return "Custom"; }
+
+		/// \brief Returns the memory held by the provider in bytes, or 0 if unknown
+		///
+		/// Used by sound caches to enforce memory budgets.
+		virtual size_t get_memory_size() const { return 0; }
+
 	private:
 		std::shared_ptr<SoundProvider_Impl> impl;
 	};
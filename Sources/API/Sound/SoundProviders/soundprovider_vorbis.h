@@ -63,6 +63,14 @@ namespace clan
 
 		virtual ~SoundProvider_Vorbis();
 
+		/// \brief Sets how far ahead of playback sessions are decoded on the background streaming thread
+		/** <p>Applies to sessions started afterwards. The default is 500 milliseconds.</p>*/
+		void set_read_ahead(int milliseconds);
+
+		/// \brief Sets the streaming priority of sessions started afterwards
+		/** <p>When several streams run low on decoded data, the ones with higher priority are decoded first. The default is 0.</p>*/
+		void set_stream_priority(int priority);
+
 		/// \brief Called by SoundBuffer when a new session starts.
 		/** \return The soundbuffer session to be attached to the newly started session.*/
 		virtual SoundProvider_Session *begin_session() override;
@@ -72,6 +80,12 @@ namespace clan
 			here (and in most cases should be delete here).</p>*/
 		virtual void end_session(SoundProvider_Session *session) override;
 
+		/// \brief Returns the name decode times are reported under in SoundOutputStats.
+		virtual const char *get_name() const override { return "Vorbis"; }
+
+		/// \brief Returns the size of the compressed file data held in memory.
+		virtual size_t get_memory_size() const override;
+
 	private:
 		std::shared_ptr<SoundProvider_Vorbis_Impl> impl;
 
@@ -72,6 +72,12 @@ namespace clan
 			here (and in most cases should be delete here).</p>*/
 		virtual void end_session(SoundProvider_Session *session) override;
 
+		/// \brief Returns the name decode times are reported under in SoundOutputStats.
+		virtual const char *get_name() const override { return "Wave"; }
+
+		/// \brief Returns the size of the decoded wave data.
+		virtual size_t get_memory_size() const override;
+
 	private:
 		std::shared_ptr<SoundProvider_Wave_Impl> impl;
 
@@ -0,0 +1,88 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include <memory>
+
+namespace clan
+{
+	/// \addtogroup clanSound_Audio_Mixing clanSound Audio Mixing
+	/// \{
+
+	class SoundOutput;
+	class SoundFilter;
+	class SoundMixBus_Impl;
+
+	/// \brief Submix that sessions are mixed into before it is mixed into the output
+	///
+	/// <p>Filters added to a bus run once per fragment on the sum of all sessions routed or sent to it, instead
+	/// of once per session. A typical use is a bus with a reverb or echo filter that many sessions send a part of
+	/// their signal to (see SoundBuffer_Session::set_send), or a bus per sound category with its own volume.</p>
+	/// <p>Buses stay registered with the output for as long as the output exists.</p>
+	class SoundMixBus
+	{
+	public:
+		/// \brief Constructs a null instance
+		SoundMixBus();
+
+		/// \brief Constructs a bus mixed into the output
+		SoundMixBus(SoundOutput &output);
+
+		~SoundMixBus();
+
+		/// \brief Returns true if this object is invalid.
+		bool is_null() const { return !impl; }
+
+		/// \brief Throw an exception if this object is invalid.
+		void throw_if_null() const;
+
+		/// \brief Returns the volume the bus is mixed into the output with
+		float get_volume() const;
+
+		/// \brief Sets the volume the bus is mixed into the output with
+		void set_volume(float volume);
+
+		/// \brief Adds a filter processing the mixed signal of the bus
+		void add_filter(SoundFilter &filter);
+
+		/// \brief Removes a filter from the bus
+		void remove_filter(SoundFilter &filter);
+
+		bool operator==(const SoundMixBus &other) const { return impl == other.impl; }
+		bool operator!=(const SoundMixBus &other) const { return impl != other.impl; }
+
+	private:
+		std::shared_ptr<SoundMixBus_Impl> impl;
+
+		friend class SoundBuffer_Session;
+	};
+
+	/// \}
+}
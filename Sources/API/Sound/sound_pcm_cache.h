@@ -0,0 +1,93 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+namespace clan
+{
+	/// \addtogroup clanSound_Audio_Mixing clanSound Audio Mixing
+	/// \{
+
+	class SoundBuffer;
+	class SoundPCMCache_Impl;
+
+	/// \brief Shared cache of decoded sample data
+	///
+	/// <p>Sound buffers returned by get_sound() decode their clip the first time they are played and keep the samples
+	/// in the cache. Later sessions, including overlapping ones, play the decoded samples without decoding again.
+	/// This is meant for short effects that are played often. When the cache is over its budget, the least recently
+	/// played clips are dropped. Sessions still playing a dropped clip keep it alive until they end.</p>
+	class SoundPCMCache
+	{
+	public:
+		/// \brief Constructs a null instance
+		SoundPCMCache();
+
+		/// \brief Constructs a cache
+		///
+		/// \param max_bytes Memory budget for the decoded samples
+		/// \param store_16bit Stores samples as 16 bit integers instead of floats, which halves the memory used
+		/// \param max_clip_length Clips longer than this (in milliseconds) are not cached and play from their source
+		SoundPCMCache(size_t max_bytes, bool store_16bit = false, int max_clip_length = 10000);
+
+		~SoundPCMCache();
+
+		/// \brief Returns true if this object is invalid.
+		bool is_null() const { return !impl; }
+
+		/// \brief Throw an exception if this object is invalid.
+		void throw_if_null() const;
+
+		/// \brief Returns the number of bytes used by cached clips
+		size_t get_used_bytes() const;
+
+		/// \brief Returns the memory budget
+		size_t get_max_bytes() const;
+
+		/// \brief Sets the memory budget. Drops clips if the cache is over the new budget.
+		void set_max_bytes(size_t max_bytes);
+
+		/// \brief Returns a sound buffer playing the source from decoded samples kept in this cache
+		///
+		/// \param key Identifies the clip. Sound buffers returned for the same key share the decoded samples.
+		/// \param source Sound buffer to decode. Its volume and pan are copied to the returned buffer.
+		SoundBuffer get_sound(const std::string &key, const SoundBuffer &source);
+
+		/// \brief Drops all cached clips
+		void clear();
+
+	private:
+		std::shared_ptr<SoundPCMCache_Impl> impl;
+	};
+
+	/// \}
+}
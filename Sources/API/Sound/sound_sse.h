@@ -34,6 +34,8 @@ namespace clan
 	/// \{
 
 	/// \brief Sound related functions implemented as SIMD using SSE
+	///
+	/// The mixing, ramping, clamping and packing functions use AVX when the CPU has it, and NEON on ARM.
 	class SoundSSE
 	{
 	public:
@@ -61,7 +63,7 @@ namespace clan
 		/// \brief Unpacks float stereo samples into separate float channels
 		static void unpack_float_stereo(float *input, int size, float *output[2]);
 
-		/// \brief Packs two float channels into a single 16 bit samples stream
+		/// \brief Packs two float channels into a single 16 bit samples stream. Samples outside -1 to 1 saturate.
 		static void pack_16bit_stereo(float *input[2], int size, short *output);
 
 		/// \brief Packs two float channels into a single float samples stream
@@ -73,6 +75,12 @@ namespace clan
 		/// \brief Multiplies floats with a float
 		static void multiply_float(float *channel, int size, float volume);
 
+		/// \brief Multiplies floats with a volume going linearly from start_volume to end_volume
+		static void multiply_float_ramp(float *channel, int size, float start_volume, float end_volume);
+
+		/// \brief Limits floats to the range min_value to max_value
+		static void clamp_float(float *channel, int size, float min_value, float max_value);
+
 		/// \brief Sets floats to a specific value
 		static void set_float(float *channel, int size, float value);
 
@@ -82,6 +90,14 @@ namespace clan
 		/// \brief Mixes one float channel into many float channels with individual volumes for each channel
 		static void mix_one_to_many(float *input, int size, float **output, float *volume, int channels);
 
+		/// \brief Mixes one float channel into another with a volume going linearly from start_volume to end_volume
+		///
+		/// Ramping the volume over a fragment avoids clicks when the volume or panning of a voice changes.
+		static void mix_one_to_one_ramp(float *input, int size, float *output, float start_volume, float end_volume);
+
+		/// \brief Mixes one float channel into many float channels with a volume ramp for each channel
+		static void mix_one_to_many_ramp(float *input, int size, float **output, float *start_volume, float *end_volume, int channels);
+
 		/// \brief Mixes many float channels into one float channel with individual volumes for each channel
 		static void mix_many_to_one(float **input, float *volume, int channels, int size, float *output);
 	};
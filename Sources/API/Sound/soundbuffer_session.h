@@ -40,6 +40,20 @@ namespace clan
 	class SoundBuffer;
 	class SoundBuffer_Session_Impl;
 	class SoundOutput;
+	class SoundMixBus;
+
+	/// \brief Interpolation used when a session plays at another frequency than the mixer
+	enum ResampleQuality
+	{
+		/// \brief Straight line between neighbouring samples. Cheapest.
+		resample_linear,
+
+		/// \brief Catmull-Rom spline through four samples
+		resample_cubic,
+
+		/// \brief Windowed sinc filter over sixteen samples. Also filters out aliasing when pitching up.
+		resample_sinc
+	};
 
 	/// \brief SoundBuffer_Session provides control over a playing soundeffect.
 	///
@@ -79,6 +93,9 @@ namespace clan
 		/// \brief Returns the frequency of the session.
 		int get_frequency() const;
 
+		/// \brief Returns the interpolation used to convert the session to the mixer frequency.
+		ResampleQuality get_resample_quality() const;
+
 		/// \brief Returns the linear relative volume of the soundeffect.
 		///
 		/// 0 means the soundeffect is muted, 1 means the soundeffect
@@ -127,6 +144,11 @@ namespace clan
 		/// \param new_freq New frequency of session.
 		void set_frequency(int new_freq);
 
+		/// \brief Sets the interpolation used to convert the session to the mixer frequency.
+		///
+		/// \param quality New interpolation. Defaults to resample_linear.
+		void set_resample_quality(ResampleQuality quality);
+
 		/// \brief Sets the volume of the session in a relative measure (0->1)
 		///
 		/// A value of 0 will effectively mute the sound (although it will
@@ -165,12 +187,24 @@ namespace clan
 		/// \brief Remove the sound filter from the session. See SoundFilter for details.
 		void remove_filter(SoundFilter &filter);
 
+		/// \brief Routes the session into a mix bus instead of directly into the output
+		///
+		/// \param bus Bus to mix the session into. A null bus routes the session back to the output.
+		void set_bus(const SoundMixBus &bus);
+
+		/// \brief Sends a copy of the session to a second mix bus, in addition to its regular route
+		///
+		/// \param bus Bus receiving the copy. A null bus removes the send.
+		/// \param level Volume of the copy relative to the session volume.
+		void set_send(const SoundMixBus &bus, float level);
+
 	private:
 		SoundBuffer_Session(SoundBuffer &soundbuffer, bool looping, SoundOutput &output);
 		std::shared_ptr<SoundBuffer_Session_Impl> impl;
 
 		friend class SoundBuffer;
 		friend class SoundOutput_Impl;
+		friend class SoundMixerPool;
 	};
 
 	/// \}
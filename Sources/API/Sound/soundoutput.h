@@ -39,6 +39,7 @@ namespace clan
 	class SoundBuffer;
 	class SoundOutput_Description;
 	class SoundOutput_Impl;
+	class SoundOutputStats;
 
 	/// \brief SoundOutput interface in ClanLib.
 	///
@@ -101,6 +102,11 @@ namespace clan
 		/// \brief Remove the sound filter from the session.
 		void remove_filter(SoundFilter &filter);
 
+		/// \brief Returns mix times, underruns, voice counts and decode times of the mixer
+		///
+		/// The mixer collects the statistics with atomic counters, so polling them does not disturb mixing.
+		SoundOutputStats get_stats() const;
+
 	private:
 		SoundOutput(const std::weak_ptr<SoundOutput_Impl> impl);
 
@@ -109,6 +115,7 @@ namespace clan
 		friend class SoundBuffer;
 		friend class Sound;
 		friend class SoundBuffer_Session;
+		friend class SoundMixBus;
 	};
 
 	/// \}
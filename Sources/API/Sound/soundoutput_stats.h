@@ -0,0 +1,120 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace clan
+{
+	/// \addtogroup clanSound_Audio_Mixing clanSound Audio Mixing
+	/// \{
+
+	/// \brief A fragment that was mixed too late, or a buffer underrun reported by the device
+	class SoundOutputUnderrun
+	{
+	public:
+		enum Source
+		{
+			/// \brief Mixing the fragment took longer than the fragment plays
+			deadline_missed,
+
+			/// \brief The device ran out of data
+			device_reported
+		};
+
+		/// \brief System::get_microseconds() when the underrun was recorded
+		uint64_t timestamp = 0;
+
+		Source source = deadline_missed;
+
+		/// \brief Time spent mixing the last fragment before the underrun
+		int mix_microseconds = 0;
+
+		/// \brief Playing time of one fragment
+		int deadline_microseconds = 0;
+	};
+
+	/// \brief Decoding statistics for one type of sound provider
+	class SoundProviderStats
+	{
+	public:
+		/// \brief Number of times sessions of the provider were asked for data
+		uint64_t decode_calls = 0;
+
+		/// \brief Time spent in the provider sessions producing data
+		uint64_t decode_microseconds = 0;
+
+		/// \brief Number of samples produced, per channel
+		uint64_t decoded_samples = 0;
+	};
+
+	/// \brief Mixer statistics of a SoundOutput
+	///
+	/// The mixer collects these with atomic counters only, so taking a snapshot never blocks it.
+	class SoundOutputStats
+	{
+	public:
+		uint64_t fragments_mixed = 0;
+
+		/// \brief Time spent mixing the last fragment, and the longest and average time since the output was created
+		int mix_microseconds = 0;
+		int max_mix_microseconds = 0;
+		int average_mix_microseconds = 0;
+
+		/// \brief Playing time of one fragment. A fragment mixed slower than this cannot keep up with the device.
+		int deadline_microseconds = 0;
+
+		/// \brief Deadline minus the mix time of the last fragment, and the smallest headroom seen
+		int headroom_microseconds = 0;
+		int min_headroom_microseconds = 0;
+
+		/// \brief Underruns of all sources, and the counts per source
+		uint64_t underruns = 0;
+		uint64_t deadline_misses = 0;
+		uint64_t device_underruns = 0;
+
+		/// \brief Sessions mixed in the last fragment
+		int active_voices = 0;
+
+		/// \brief Voices AudioWorld keeps track of without mixing them
+		int virtual_voices = 0;
+
+		/// \brief Decoding statistics by SoundProvider::get_name()
+		std::map<std::string, SoundProviderStats> providers;
+
+		/// \brief The most recent underruns, oldest first
+		std::vector<SoundOutputUnderrun> underrun_log;
+	};
+
+	/// \}
+}
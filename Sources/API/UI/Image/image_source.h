@@ -28,6 +28,12 @@
 
 #pragma once
 
+#include <memory>
+#include <functional>
+#include <string>
+#include "../../Core/Math/size.h"
+#include "../../Core/Signals/signal.h"
+
 namespace clan
 {
 	class Canvas;
@@ -37,12 +43,35 @@ namespace clan
 	{
 	public:
 		virtual Image get_image(Canvas &canvas) = 0;
+
+		/// \brief Returns the image for display at the given size in pixels
+		///
+		/// Sources may return a smaller image than their full resolution, but never smaller than display_size allows
+		/// while keeping the aspect ratio. An empty size requests the full resolution.
+		/// Asynchronous sources return a null image until the decode is done, and then emit sig_image_ready.
+		virtual Image get_image(Canvas &canvas, const Size &display_size);
+
+		/// \brief Returns true if get_image(canvas, display_size) decodes in the background
+		virtual bool is_async() const { return false; }
+
+		/// \brief Emitted on the UI thread when an image requested from an asynchronous source is ready
+		Signal<void()> &sig_image_ready() { return image_ready; }
+
 		static std::shared_ptr<ImageSource> from_resource(const std::string &resource_name);
 		static std::shared_ptr<ImageSource> from_callback(const std::function<Image(Canvas &)> &get_image_callback);
 		static std::shared_ptr<ImageSource> from_image(const Image &image);
+
+		/// \brief Image file decoded on a worker thread the first time it is displayed
+		///
+		/// JPEG files are decoded with IDCT scaling and other formats are resampled down to the display size.
+		/// Decoded images are shared between sources for the same file and size.
+		static std::shared_ptr<ImageSource> from_file(const std::string &filename);
+
 	protected:
 		virtual ~ImageSource() { }
 
+	private:
+		Signal<void()> image_ready;
 	};
 
 }
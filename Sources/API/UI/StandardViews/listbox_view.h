@@ -35,6 +35,28 @@ namespace clan
 {
 	class ListBoxViewImpl;
 
+	/// Supplies the rows of a virtualized ListBoxView
+	///
+	/// Only the visible rows and a few rows of overscan get a view. Views are recycled for other rows while scrolling,
+	/// so create_item_view is called about as many times as rows fit in the list box.
+	class ListBoxDataSource
+	{
+	public:
+		virtual ~ListBoxDataSource() { }
+
+		/// Number of rows in the list
+		virtual int item_count() const = 0;
+
+		/// Creates a view able to show any row
+		virtual std::shared_ptr<View> create_item_view() = 0;
+
+		/// Updates a created view to show the row at index
+		virtual void bind_item_view(View *view, int index) = 0;
+
+		/// Height assumed for rows that have not been measured yet. Zero uses the height of the first measured row.
+		virtual float estimated_item_height() const { return 0.0f; }
+	};
+
 	class ListBoxView : public ScrollView
 	{
 	public:
@@ -42,6 +64,18 @@ namespace clan
 		~ListBoxView();
 		
 		void set_items(const std::vector<std::shared_ptr<View>> &items);
+
+		/// Switches the list box to virtualized rows supplied by a data source. Replaces any items set with set_items.
+		void set_data_source(const std::shared_ptr<ListBoxDataSource> &data_source);
+
+		/// Rereads the row count from the data source and rebinds the visible rows
+		void reload_data();
+
+		/// Sets how many rows above and below the visible area get a view, so short scrolls do not bind rows
+		void set_overscan(int rows);
+
+		/// Number of items, from set_items or the data source
+		int item_count() const;
 		
 		template<typename T>
 		void set_items(const std::vector<T> &items, const std::function<std::shared_ptr<View>(const T &item)> &map_function)
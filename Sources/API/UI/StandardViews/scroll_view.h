@@ -61,6 +61,9 @@ namespace clan
 		
 		Pointf content_offset() const;
 		void set_content_offset(const Pointf &offset, bool animated = false);
+
+		/// Emitted when the content offset changes, either by the scroll bars or by set_content_offset
+		Signal<void()> &sig_content_offset_changed();
 		
 		void layout_subviews(Canvas &canvas) override;
 
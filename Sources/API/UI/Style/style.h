@@ -31,6 +31,7 @@
 #include "../../Core/Text/string_format.h"
 #include "../../Display/2D/color.h"
 #include "style_get_value.h"
+#include "style_property_id.h"
 
 namespace clan
 {
@@ -65,6 +66,7 @@ namespace clan
 		/// Retrieve the declared value for a property
 		StyleGetValue declared_value(const char *property_name) const;
 		StyleGetValue declared_value(const std::string &property_name) const { return declared_value(property_name.c_str()); }
+		StyleGetValue declared_value(StylePropertyId id) const;
 
 		/// Static helper that generates a "rgba(%1,%2,%3,%4)" string for the given color.
 		static std::string to_rgba(const Colorf &c)
@@ -32,6 +32,7 @@
 #include <string>
 #include <vector>
 #include "style_get_value.h"
+#include "style_property_id.h"
 
 namespace clan
 {
@@ -40,6 +41,7 @@ namespace clan
 	class Canvas;
 	class Font;
 	class ViewGeometry;
+	class StyleComputedCache;
 
 #if defined(MICROSOFT_FINALLY_IMPLEMENTED_CONSTEXPR_TEN_YEARS_AFTER_EVERYONE_ELSE)
 	/// Allows property name hashes to be evaluated at compile time
@@ -65,8 +67,12 @@ namespace clan
 	class StyleCascade
 	{
 	public:
-		StyleCascade() { }
-		StyleCascade(std::vector<Style *> cascade, const StyleCascade *parent = nullptr) : cascade(std::move(cascade)), parent(parent) { }
+		StyleCascade();
+		StyleCascade(std::vector<Style *> cascade, const StyleCascade *parent = nullptr);
+		StyleCascade(const StyleCascade &that);
+		~StyleCascade();
+
+		StyleCascade &operator=(const StyleCascade &that);
 
 		/// Property sets to be examined
 		std::vector<Style *> cascade;
@@ -77,16 +83,20 @@ namespace clan
 		/// Find the first declared value in the cascade for the specified property
 		StyleGetValue cascade_value(const char *property_name) const;
 		StyleGetValue cascade_value(const std::string &property_name) const { return cascade_value(property_name.c_str()); }
+		StyleGetValue cascade_value(StylePropertyId id) const;
 
 		/// Resolve any inheritance or initial values for the cascade value
 		StyleGetValue specified_value(const char *property_name) const;
 		StyleGetValue specified_value(const std::string &property_name) const { return specified_value(property_name.c_str()); }
+		StyleGetValue specified_value(StylePropertyId id) const;
 
 		/// Find the computed value for the specified value
 		///
 		/// The computed value is a simplified value for the property. Lengths are resolved to device independent pixels and so on.
+		/// Values of the properties read during layout and rendering are cached until invalidate_computed_values is called.
 		StyleGetValue computed_value(const char *property_name) const;
 		StyleGetValue computed_value(const std::string &property_name) const { return computed_value(property_name.c_str()); }
+		StyleGetValue computed_value(StylePropertyId id) const;
 		
 		/// Convert length into px (device independent pixel) units
 		StyleGetValue compute_length(const StyleGetValue &length) const;
@@ -115,5 +125,15 @@ namespace clan
 		
 		/// Font used by this style cascade
 		Font get_font(Canvas &canvas) const;
+
+		/// Discard the cached computed values of all cascades
+		///
+		/// Must be called whenever a style property is set or the cascade or parent of a StyleCascade is changed.
+		static void invalidate_computed_values();
+
+	private:
+		StyleGetValue uncached_computed_value(StylePropertyId id) const;
+
+		mutable std::unique_ptr<StyleComputedCache> computed_cache;
 	};
 }
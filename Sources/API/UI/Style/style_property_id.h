@@ -0,0 +1,142 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+namespace clan
+{
+	/// Interned style property identifier
+	///
+	/// Properties known by the style parsers have compile-time identifiers, which allows values to be
+	/// looked up without hashing or comparing property names. Other names, such as value array elements,
+	/// are assigned identifiers at runtime by StyleProperty::intern_id.
+	///
+	/// The properties read for every view during layout and rendering are listed first.
+	enum class StylePropertyId : int
+	{
+		invalid = -1,
+		width,
+		height,
+		min_width,
+		min_height,
+		max_width,
+		max_height,
+		margin_left,
+		margin_top,
+		margin_right,
+		margin_bottom,
+		padding_left,
+		padding_top,
+		padding_right,
+		padding_bottom,
+		border_left_width,
+		border_top_width,
+		border_right_width,
+		border_bottom_width,
+		flex_basis,
+		flex_grow,
+		flex_shrink,
+		flex_direction,
+		layout,
+		position,
+		left,
+		top,
+		right,
+		bottom,
+		font_size,
+		color,
+		background_color,
+		align_content,
+		align_items,
+		align_self,
+		background_attachment,
+		background_clip,
+		background_image,
+		background_origin,
+		background_position,
+		background_repeat,
+		background_size,
+		border_bottom_color,
+		border_bottom_left_radius_x,
+		border_bottom_left_radius_y,
+		border_bottom_right_radius_x,
+		border_bottom_right_radius_y,
+		border_bottom_style,
+		border_image_outset_bottom,
+		border_image_outset_left,
+		border_image_outset_right,
+		border_image_outset_top,
+		border_image_repeat_x,
+		border_image_repeat_y,
+		border_image_slice_bottom,
+		border_image_slice_center,
+		border_image_slice_left,
+		border_image_slice_right,
+		border_image_slice_top,
+		border_image_source,
+		border_image_width_bottom,
+		border_image_width_left,
+		border_image_width_right,
+		border_image_width_top,
+		border_left_color,
+		border_left_style,
+		border_right_color,
+		border_right_style,
+		border_top_color,
+		border_top_left_radius_x,
+		border_top_left_radius_y,
+		border_top_right_radius_x,
+		border_top_right_radius_y,
+		border_top_style,
+		box_shadow,
+		clan_font_rendering,
+		flex_wrap,
+		font_family,
+		font_style,
+		font_variant,
+		font_weight,
+		justify_content,
+		letter_spacing,
+		line_height,
+		order,
+		outline_color,
+		outline_style,
+		outline_width,
+		text_align,
+		text_decoration_blink,
+		text_decoration_line_through,
+		text_decoration_overline,
+		text_decoration_underline,
+		text_indent,
+		text_transform,
+		word_spacing,
+		z_index,
+		num_known_properties
+	};
+}
@@ -37,6 +37,7 @@
 #include "style_set_image.h"
 #include "style_token.h"
 #include "style_tokenizer.h"
+#include "style_property_id.h"
 
 namespace clan
 {
@@ -121,12 +122,25 @@ namespace clan
 	{
 	public:
 		/// Gets the default value for a given property
-		static const StyleGetValue &default_value(const char *name);
-		static const StyleGetValue &default_value(const std::string &name);
+		static const StyleGetValue &default_value(StylePropertyId id);
+		static const StyleGetValue &default_value(const char *name) { return default_value(find_id(name)); }
+		static const StyleGetValue &default_value(const std::string &name) { return default_value(find_id(name.c_str())); }
 
 		/// Indicates if this an inherited property or not
-		static bool is_inherited(const char *name);
-		static bool is_inherited(const std::string &name);
+		static bool is_inherited(StylePropertyId id);
+		static bool is_inherited(const char *name) { return is_inherited(find_id(name)); }
+		static bool is_inherited(const std::string &name) { return is_inherited(find_id(name.c_str())); }
+
+		/// Finds the identifier for a property name
+		///
+		/// Returns StylePropertyId::invalid if the name is neither a known property nor has been interned.
+		static StylePropertyId find_id(const char *name);
+
+		/// Finds the identifier for a property name, assigning a new one if the name has not been seen before
+		static StylePropertyId intern_id(const std::string &name);
+
+		/// Name of the property with the specified identifier
+		static const char *name(StylePropertyId id);
 
 		/// Parses a string of styles and sets the values
 		static void parse(StylePropertySetter *setter, const std::string &styles);
@@ -36,6 +36,7 @@ namespace clan
 	class DisplayWindow;
 	class Canvas;
 	class ViewTreeImpl;
+	class RenderTargetPool;
 
 	/// Base class for managing a tree of views
 	class ViewTree
@@ -103,6 +104,8 @@ namespace clan
 		ViewTree(const ViewTree &) = delete;
 		ViewTree &operator=(const ViewTree &) = delete;
 
+		RenderTargetPool &layer_pool();
+
 		std::unique_ptr<ViewTreeImpl> impl;
 
 		friend class View;
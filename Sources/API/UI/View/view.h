@@ -121,6 +121,9 @@ namespace clan
 		bool needs_layout() const;
 
 		/// Forces recalculation of view geometry before next rendering
+		///
+		/// The superview is always laid out again. Further ancestors are only laid out again up to the first
+		/// view with a fixed width and height, as the preferred size of such a view does not depend on its content.
 		void set_needs_layout();
 
 		/// Actual view position and size after layout
@@ -159,6 +162,35 @@ namespace clan
 		/// Specifies if content should be clipped during rendering
 		void set_content_clipped(bool clipped);
 
+		/// Layer caching flag
+		bool layer_cached() const;
+
+		/// Specifies if the view and its subviews should be rendered into a cached offscreen layer
+		///
+		/// The layer is only rendered again after set_needs_render has been called for the view or one of its
+		/// descendants. Anything drawn outside the border box of the view is clipped away. The view transform
+		/// applies to the whole layer, including the background and border.
+		void set_layer_cached(bool enable);
+
+		/// Tiled layer flag
+		bool layer_tiled() const;
+
+		/// Specifies if the view should be rendered into a cache of fixed size tiles
+		///
+		/// Meant for views much larger than the part of them that is visible, such as the content of a scroll view.
+		/// Only the tiles covering the visible part are rendered, plus tiles ahead of the direction the view is scrolling
+		/// in. Changing the view transform moves the tiles without rendering them again. All tiles are rendered again
+		/// after set_needs_render has been called for the view or one of its descendants.
+		void set_layer_tiled(bool enable);
+
+		/// Opacity of the view layer
+		float layer_opacity() const;
+
+		/// Sets the opacity used when the view layer is composited
+		///
+		/// An opacity below one renders the view through a layer even if layer caching is not enabled.
+		void set_layer_opacity(float opacity);
+
 		/// Calculates the preferred width of this view
 		float get_preferred_width(Canvas &canvas);
 
@@ -174,6 +206,11 @@ namespace clan
 		/// Sets the view geometry for all subviews of this view
 		virtual void layout_subviews(Canvas &canvas);
 
+		/// Lays out this view if it needs layout, or else the descendants that need it
+		///
+		/// Layout implementations call this for each subview after setting its geometry.
+		void layout_subviews_if_needed(Canvas &canvas);
+
 		/// Tree in view hierachy
 		const ViewTree *view_tree() const;
 		ViewTree *view_tree();
@@ -184,6 +221,15 @@ namespace clan
 		/// Find descendant view at the specified content relative position
 		std::shared_ptr<View> find_view_at(const Pointf &pos) const;
 
+		/// Test if find_view_at uses a grid to look up the subviews
+		bool subview_hit_grid() const;
+
+		/// Enables a grid over the border boxes of the subviews for find_view_at
+		///
+		/// Views with many subviews, such as the nodes of a graph editor, then only test the subviews near
+		/// the pointer. The grid is updated as subviews are added, removed or given a new geometry.
+		void set_subview_hit_grid(bool enable);
+
 		/// Focus policy active for this view
 		FocusPolicy focus_policy() const;
 
@@ -39,6 +39,7 @@ namespace clan
 	/// \{
 
 	class IODevice;
+	class DataBuffer;
 	class XMLResourceNode;
 	class FileSystem;
 	class XMLResourceDocument_Impl;
@@ -98,6 +99,16 @@ namespace clan
 		XMLResourceNode get_resource(
 			const std::string &resource_id) const;
 
+		/// \brief Returns a handle for a resource that can be cached and passed to get_resource_by_handle()
+		///
+		/// Resource names are put in a perfect hash table when the document is loaded. Handles stay valid
+		/// until the document is loaded again.
+		/// \return The handle, or -1 if the resource does not exist.
+		int get_resource_handle(const std::string &resource_id) const;
+
+		/// \brief Returns the resource for a handle returned by get_resource_handle()
+		XMLResourceNode get_resource_by_handle(int handle) const;
+
 		/// \brief Returns the value of a boolean resource. (using the value attribute)
 		bool get_boolean_resource(
 			const std::string &resource_id,
@@ -145,6 +156,17 @@ namespace clan
 		/// \param file = IODevice
 		void save(IODevice file);
 
+		/// \brief Save the resource tree and its resource index in the compiled binary format
+		///
+		/// load() detects compiled documents and reads them without parsing XML, which makes them
+		/// suited for shipping builds. The XML document stays the editable source.
+		void save_compiled(const std::string &filename);
+
+		/// \brief Save the resource tree and its resource index in the compiled binary format
+		///
+		/// \param file = IODevice
+		void save_compiled(IODevice file);
+
 		/// \brief Load resource XML tree from file.
 		void load(const std::string &filename);
 
@@ -166,6 +188,8 @@ namespace clan
 		/// \param XMLResourceDocument_Impl = Weak Ptr
 		XMLResourceDocument(std::weak_ptr<XMLResourceDocument_Impl> &impl);
 
+		void load_compiled(const DataBuffer &data, const std::string &base_path, const FileSystem &file_system);
+
 		std::shared_ptr<XMLResourceDocument_Impl> impl;
 
 		friend class XMLResourceNode;
@@ -0,0 +1,119 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace clan
+{
+	/// \addtogroup clanXML_Resources clanXML Resources
+	/// \{
+
+	class ResourceManager;
+	class Canvas;
+	class ShaderObject;
+	class XMLResourcePreloader_Impl;
+
+	/// \brief Loads a list of resources of an XML resource manager in parallel
+	///
+	/// Files are read and decoded on worker threads, all at once. The resources are then created in the caches
+	/// of the resource manager by process(), in time budgeted slices on the rendering thread:
+	///
+	/// - textures are loaded with DisplayCache::get_texture_async
+	/// - sprites and images are created from their decoded image files
+	/// - fonts are created after the sprite holding their glyphs
+	/// - vertex and fragment shaders are compiled from their preloaded source
+	/// - sounds (sample or sound elements) are decoded into sound buffers, except for streamed sounds
+	///
+	/// Getting a resource from the caches afterwards returns the preloaded version. A file that fails to decode
+	/// is loaded again on the rendering thread, so process() throws the same exception as loading it directly.
+	class XMLResourcePreloader
+	{
+	public:
+		/// \brief Constructs a null instance.
+		XMLResourcePreloader();
+
+		/// \brief Constructs a preloader for a resource manager created by XMLResourceManager
+		XMLResourcePreloader(const ResourceManager &resources);
+
+		~XMLResourcePreloader();
+
+		/// \brief Returns true if this object is invalid.
+		bool is_null() const { return !impl; }
+
+		/// \brief Throw an exception if this object is invalid.
+		void throw_if_null() const;
+
+		/// \brief Adds a resource to the manifest
+		void add(const std::string &resource_id);
+
+		/// \brief Adds all resources of a section of the resource document
+		void add_section(const std::string &section);
+
+		/// \brief Starts reading and decoding the files of all resources added
+		void start(Canvas &canvas);
+
+		/// \brief Creates the resources whose files have been decoded. Call once per frame on the rendering thread.
+		///
+		/// \param time_budget_microseconds = Time to spend. At least one resource is created per call.
+		/// \return true when all resources have been loaded
+		bool process(Canvas &canvas, int time_budget_microseconds = 4000);
+
+		/// \brief Calls process() until all resources have been loaded
+		void finish(Canvas &canvas);
+
+		/// \brief Returns true when all resources have been loaded
+		bool is_done() const;
+
+		/// \brief Returns the number of resources added
+		int get_total() const;
+
+		/// \brief Returns the number of resources loaded
+		int get_loaded() const;
+
+		/// \brief Returns the loaded fraction of the resources, between 0 and 1
+		float get_progress() const;
+
+		/// \brief Returns a shader compiled by the preloader, or a null shader if it has not been loaded yet
+		ShaderObject get_shader_object(const std::string &resource_id) const;
+
+		/// \brief Called on the rendering thread each time a resource has been loaded
+		///
+		/// The parameters are the resource id, the number of resources loaded and the total number of resources.
+		std::function<void(const std::string &, int, int)> &func_progress();
+
+	private:
+		std::shared_ptr<XMLResourcePreloader_Impl> impl;
+	};
+
+	/// \}
+}
@@ -0,0 +1,91 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include <memory>
+#include <functional>
+
+namespace clan
+{
+	/// \addtogroup clanXML_XML clanXML XML
+	/// \{
+
+	class IODevice;
+	class DataBuffer;
+	class XMLToken;
+	class XMLTokenizer;
+	class XMLReader_Impl;
+
+	/// \brief Streaming XML reader that reports elements and text through callbacks
+	///
+	/// No document tree is built. All callbacks receive the same token object, which is only valid for the
+	/// duration of the call, so memory use does not grow with the size of the document.
+	class XMLReader
+	{
+	public:
+		XMLReader();
+
+		/// \brief Constructs a XMLReader
+		///
+		/// \param input = IODevice
+		XMLReader(IODevice &input);
+
+		/// \brief Constructs a XMLReader that reads directly from a data buffer
+		XMLReader(const DataBuffer &buffer);
+
+		/// \brief Constructs a XMLReader that reads the tokens of an existing tokenizer
+		XMLReader(const XMLTokenizer &tokenizer);
+
+		virtual ~XMLReader();
+
+		/// \brief Called for the start of an element, including elements without content. The token holds the name and attributes.
+		std::function<void(const XMLToken &)> &func_begin_element();
+
+		/// \brief Called for the end of an element, including elements without content
+		std::function<void(const XMLToken &)> &func_end_element();
+
+		/// \brief Called for text and CDATA sections
+		std::function<void(const XMLToken &)> &func_text();
+
+		/// \brief Called for comments and processing instructions
+		std::function<void(const XMLToken &)> &func_other();
+
+		/// \brief Reads the document until its end or until stop() is called from a callback
+		void parse();
+
+		/// \brief Makes parse() return after the current callback
+		void stop();
+
+	private:
+		std::shared_ptr<XMLReader_Impl> impl;
+	};
+
+	/// \}
+}
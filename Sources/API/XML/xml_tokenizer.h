@@ -30,6 +30,7 @@
 #pragma once
 
 #include <memory>
+#include <string>
 
 namespace clan
 {
@@ -37,6 +38,7 @@ namespace clan
 	/// \{
 
 	class IODevice;
+	class DataBuffer;
 	class XMLToken;
 	class XMLTokenizer_Impl;
 
@@ -56,6 +58,16 @@ namespace clan
 		/// \param input = IODevice
 		XMLTokenizer(IODevice &input);
 
+		/// \brief Constructs a XMLTokenizer that reads the tokens directly from a data buffer
+		///
+		/// The buffer is shared, not copied, and must not be modified while tokenizing.
+		XMLTokenizer(const DataBuffer &buffer);
+
+		/// \brief Constructs a XMLTokenizer that reads the tokens directly from memory, such as a memory mapped file
+		///
+		/// The memory is not copied and must stay valid and unmodified for the lifetime of the tokenizer.
+		XMLTokenizer(const char *data, std::string::size_type size);
+
 		virtual ~XMLTokenizer();
 
 		/// \brief Returns true if eat whitespace flag is set.
@@ -57,11 +57,16 @@
 #include "Core/Text/console.h"
 #include "Core/Text/console_logger.h"
 #include "Core/Text/logger.h"
+#include "Core/Text/async_log_queue.h"
 #include "Core/Text/string_format.h"
 #include "Core/Text/string_help.h"
 #include "Core/Text/utf8_reader.h"
 #include "Core/System/databuffer.h"
+#include "Core/System/databuffer_view.h"
 #include "Core/System/block_allocator.h"
+#include "Core/System/pool_allocator.h"
+#include "Core/System/profiler.h"
+#include "Core/System/allocation_tracker.h"
 #include "Core/System/console_window.h"
 #include "Core/System/datetime.h"
 #include "Core/System/disposable_object.h"
@@ -73,11 +78,13 @@
 #include "Core/System/userdata.h"
 #include "Core/System/game_time.h"
 #include "Core/System/work_queue.h"
+#include "Core/System/task_graph.h"
 #include "Core/ErrorReporting/crash_reporter.h"
 #include "Core/ErrorReporting/exception_dialog.h"
 #include "Core/Signals/signal.h"
 #include "Core/Resources/resource.h"
 #include "Core/Resources/resource_container.h"
+#include "Core/Resources/resource_cache_map.h"
 #include "Core/Resources/resource_object.h"
 #include "Core/Resources/resource_manager.h"
 #include "Core/Resources/file_resource_document.h"
@@ -91,16 +98,21 @@
 #include "Core/IOData/directory.h"
 #include "Core/IOData/cl_endian.h"
 #include "Core/IOData/directory_scanner.h"
+#include "Core/IOData/parallel_directory_scanner.h"
 #include "Core/IOData/file_system.h"
 #include "Core/IOData/file_system_provider.h"
 #include "Core/IOData/directory_listing.h"
 #include "Core/IOData/memory_device.h"
+#include "Core/IOData/buffered_device.h"
 #include "Core/IOData/html_url.h"
+#include "Core/IOData/async_file_reader.h"
 #include "Core/Zip/zip_archive.h"
 #include "Core/Zip/zip_writer.h"
 #include "Core/Zip/zip_reader.h"
 #include "Core/Zip/zip_file_entry.h"
 #include "Core/Zip/zlib_compression.h"
+#include "Core/Zip/zstd_compression.h"
+#include "Core/Zip/lz4_compression.h"
 #include "Core/Math/angle.h"
 #include "Core/Math/base64_encoder.h"
 #include "Core/Math/base64_decoder.h"
@@ -132,7 +144,13 @@
 #include "Core/Math/intersection_test.h"
 #include "Core/Math/aabb.h"
 #include "Core/Math/obb.h"
+#include "Core/Math/batch_math.h"
+#include "Core/Math/broadphase_pair.h"
+#include "Core/Math/aabb_tree.h"
+#include "Core/Math/sweep_and_prune.h"
+#include "Core/Math/spatial_grid.h"
 #include "Core/Math/easing.h"
+#include "Core/Math/fast_random.h"
 #include "Core/Crypto/random.h"
 #include "Core/Crypto/secret.h"
 #include "Core/Crypto/sha1.h"
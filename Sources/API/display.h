@@ -41,12 +41,14 @@
 #include "Display/screen_info.h"
 #include "Display/Resources/display_cache.h"
 #include "Display/2D/canvas.h"
+#include "Display/2D/canvas_static_batch.h"
 #include "Display/2D/color.h"
 #include "Display/2D/color_hsv.h"
 #include "Display/2D/color_hsl.h"
 #include "Display/2D/gradient.h"
 #include "Display/2D/image.h"
 #include "Display/2D/sprite.h"
+#include "Display/2D/sprite_batch.h"
 #include "Display/2D/path.h"
 #include "Display/2D/pen.h"
 #include "Display/2D/brush.h"
@@ -76,27 +78,38 @@
 #include "Display/ImageProviders/provider_type_register.h"
 #include "Display/ImageProviders/targa_provider.h"
 #include "Display/ImageProviders/dds_provider.h"
+#include "Display/ImageProviders/ktx2_provider.h"
+#include "Display/Render/async_readback.h"
 #include "Display/Render/blend_state.h"
+#include "Display/Render/command_buffer.h"
 #include "Display/Render/blend_state_description.h"
 #include "Display/Render/depth_stencil_state.h"
 #include "Display/Render/depth_stencil_state_description.h"
 #include "Display/Render/rasterizer_state.h"
 #include "Display/Render/rasterizer_state_description.h"
+#include "Display/Render/buffer_heap.h"
 #include "Display/Render/element_array_buffer.h"
 #include "Display/Render/element_array_vector.h"
 #include "Display/Render/transfer_buffer.h"
 #include "Display/Render/transfer_vector.h"
 #include "Display/Render/frame_buffer.h"
 #include "Display/Render/graphic_context.h"
+#include "Display/Render/graphic_context_capture.h"
+#include "Display/Render/graphic_context_replay.h"
+#include "Display/Render/gpu_memory.h"
 #include "Display/Render/occlusion_query.h"
+#include "Display/Render/pipeline_state.h"
 #include "Display/Render/primitives_array.h"
 #include "Display/Render/program_object.h"
+#include "Display/Render/program_binary_cache.h"
 #include "Display/Render/uniform_buffer.h"
+#include "Display/Render/uniform_buffer_allocator.h"
 #include "Display/Render/uniform_vector.h"
 #include "Display/Render/storage_buffer.h"
 #include "Display/Render/storage_vector.h"
 #include "Display/Render/render_batcher.h"
 #include "Display/Render/render_buffer.h"
+#include "Display/Render/render_target_pool.h"
 #include "Display/Render/shader_object.h"
 #include "Display/Render/shared_gc_data.h"
 #include "Display/Render/texture.h"
@@ -108,10 +121,14 @@
 #include "Display/Render/texture_3d.h"
 #include "Display/Render/texture_cube.h"
 #include "Display/Render/texture_cube_array.h"
+#include "Display/Render/texture_streamer.h"
+#include "Display/Render/timer_query.h"
 #include "Display/Render/vertex_array_buffer.h"
 #include "Display/Render/vertex_array_vector.h"
 #include "Display/ShaderEffect/shader_effect.h"
 #include "Display/ShaderEffect/shader_effect_description.h"
+#include "Display/ShaderEffect/shader_effect_graph.h"
+#include "Display/ShaderEffect/occlusion_culler.h"
 #include "Display/TargetProviders/cursor_provider.h"
 #include "Display/TargetProviders/display_target_provider.h"
 #include "Display/TargetProviders/display_window_provider.h"
@@ -122,10 +139,12 @@
 #include "Display/TargetProviders/graphic_context_provider.h"
 #include "Display/TargetProviders/input_device_provider.h"
 #include "Display/TargetProviders/occlusion_query_provider.h"
+#include "Display/TargetProviders/fence_provider.h"
 #include "Display/TargetProviders/program_object_provider.h"
 #include "Display/TargetProviders/render_buffer_provider.h"
 #include "Display/TargetProviders/shader_object_provider.h"
 #include "Display/TargetProviders/texture_provider.h"
+#include "Display/TargetProviders/timer_query_provider.h"
 #include "Display/TargetProviders/uniform_buffer_provider.h"
 #include "Display/TargetProviders/storage_buffer_provider.h"
 #include "Display/TargetProviders/vertex_array_buffer_provider.h"
@@ -134,6 +153,7 @@
 #include "Display/Window/cursor_description.h"
 #include "Display/Window/display_window.h"
 #include "Display/Window/display_window_description.h"
+#include "Display/Window/frame_timing.h"
 #include "Display/Window/input_code.h"
 #include "Display/Window/input_device.h"
 #include "Display/Window/input_event.h"
@@ -41,6 +41,7 @@
 #include "GL/opengl_target.h"
 #include "GL/opengl_context_description.h"
 #include "GL/opengl_wrap.h"
+#include "GL/opengl_window_presenter.h"
 
 #ifdef __cplusplus_cli
 #pragma managed(pop)
@@ -45,13 +45,19 @@
 #include "Network/Socket/tcp_connection.h"
 #include "Network/Socket/tcp_listen.h"
 #include "Network/Socket/udp_socket.h"
+#include "Network/Socket/tls_connection.h"
 
 #include "Network/NetGame/client.h"
 #include "Network/NetGame/connection.h"
+#include "Network/NetGame/connection_stats.h"
 #include "Network/NetGame/event.h"
 #include "Network/NetGame/event_dispatcher.h"
+#include "Network/NetGame/event_schema.h"
 #include "Network/NetGame/event_value.h"
+#include "Network/NetGame/load_limits.h"
 #include "Network/NetGame/server.h"
+#include "Network/NetGame/snapshot_client.h"
+#include "Network/NetGame/snapshot_server.h"
 
 #ifdef __cplusplus_cli
 #pragma managed(pop)
@@ -42,6 +42,7 @@
 #include "Sound/sound.h"
 #include "Sound/soundoutput.h"
 #include "Sound/soundoutput_description.h"
+#include "Sound/soundoutput_stats.h"
 #include "Sound/soundformat.h"
 #include "Sound/SoundProviders/soundprovider.h"
 #include "Sound/SoundProviders/soundprovider_session.h"
@@ -50,6 +51,8 @@
 #include "Sound/soundbuffer_session.h"
 #include "Sound/soundfilter.h"
 #include "Sound/sound_sse.h"
+#include "Sound/sound_pcm_cache.h"
+#include "Sound/sound_mix_bus.h"
 
 #include "Sound/SoundProviders/soundprovider_wave.h"
 #include "Sound/SoundProviders/soundprovider_raw.h"
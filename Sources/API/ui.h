@@ -68,6 +68,7 @@
 #include "UI/Style/style_cascade.h"
 #include "UI/Style/style_dimension.h"
 #include "UI/Style/style_get_value.h"
+#include "UI/Style/style_property_id.h"
 #include "UI/Style/style_property_parser.h"
 #include "UI/Style/style_set_image.h"
 #include "UI/Style/style_set_value.h"
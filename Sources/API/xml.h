@@ -60,6 +60,7 @@
 #include "XML/dom_string.h"
 #include "XML/xml_tokenizer.h"
 #include "XML/xml_writer.h"
+#include "XML/xml_reader.h"
 #include "XML/xml_token.h"
 #include "XML/xpath_evaluator.h"
 #include "XML/xpath_object.h"
@@ -67,6 +68,7 @@
 #include "XML/Resources/xml_resource_node.h"
 #include "XML/Resources/xml_resource_document.h"
 #include "XML/Resources/xml_resource_manager.h"
+#include "XML/Resources/xml_resource_preloader.h"
 
 #ifdef __cplusplus_cli
 #pragma managed(pop)
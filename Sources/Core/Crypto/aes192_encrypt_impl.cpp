@@ -28,6 +28,7 @@
 
 #include "Core/precomp.h"
 #include "aes192_encrypt_impl.h"
+#include "crypto_x86.h"
 #include "API/Core/Math/cl_math.h"
 
 #ifndef WIN32
@@ -77,6 +78,8 @@ namespace clan
 	{
 		cipher_key_set = true;
 		extract_encrypt_key192(key, key_expanded);
+		if (Crypto_X86::is_aes_supported())
+			create_round_keys(key_expanded, aes192_num_rounds_nr, round_keys);
 	}
 
 	void AES192_Encrypt_Impl::add(const void *_data, int size)
@@ -94,6 +97,18 @@ namespace clan
 		int pos = 0;
 		while (pos < size)
 		{
+			// Whole blocks are encrypted straight from the input when the AES instructions are available
+			if (chunk_filled == 0 && Crypto_X86::is_aes_supported())
+			{
+				int num_blocks = (size - pos) / aes192_block_size_bytes;
+				if (num_blocks > 0)
+				{
+					process_blocks_x86(false, round_keys, aes192_num_rounds_nr, initialisation_vector_1, initialisation_vector_2, initialisation_vector_3, initialisation_vector_4, data + pos, num_blocks, databuffer);
+					pos += num_blocks * aes192_block_size_bytes;
+					continue;
+				}
+			}
+
 			int data_left = size - pos;
 			int buffer_space = aes192_block_size_bytes - chunk_filled;
 			int data_used = min(buffer_space, data_left);
@@ -144,10 +159,17 @@ namespace clan
 		initialisation_vector_set = false;	// Force to reset after each call
 		cipher_key_set = false;				// Force to reset after each call (to avoid keeping the cipher key in memory)
 		memset(key_expanded, 0, sizeof(key_expanded));	// Remove the key from memory
+		memset(round_keys, 0, sizeof(round_keys));
 	}
 
 	void AES192_Encrypt_Impl::process_chunk()
 	{
+		if (Crypto_X86::is_aes_supported())
+		{
+			process_blocks_x86(false, round_keys, aes192_num_rounds_nr, initialisation_vector_1, initialisation_vector_2, initialisation_vector_3, initialisation_vector_4, chunk, 1, databuffer);
+			return;
+		}
+
 		const uint32_t *key_expanded_ptr = key_expanded;
 
 		/* Electronic Codebook Mode
@@ -82,6 +82,7 @@ namespace clan
 		void process_chunk();
 
 		uint32_t key_expanded[aes192_nb_mult_nr_plus1];
+		unsigned char round_keys[aes192_nb_mult_nr_plus1 * 4];
 
 		unsigned char chunk[aes192_block_size_bytes];
 		uint32_t initialisation_vector_1;
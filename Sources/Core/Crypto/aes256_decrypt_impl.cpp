@@ -28,6 +28,7 @@
 
 #include "Core/precomp.h"
 #include "aes256_decrypt_impl.h"
+#include "crypto_x86.h"
 #include "API/Core/Math/cl_math.h"
 
 #ifndef WIN32
@@ -74,6 +75,13 @@ namespace clan
 	{
 		cipher_key_set = true;
 		extract_encrypt_key256(key, key_expanded);
+		if (Crypto_X86::is_aes_supported())
+		{
+			unsigned char encrypt_round_keys[sizeof(round_keys)];
+			create_round_keys(key_expanded, aes256_num_rounds_nr, encrypt_round_keys);
+			Crypto_X86::aes_create_decrypt_keys(encrypt_round_keys, aes256_num_rounds_nr, round_keys);
+			memset(encrypt_round_keys, 0, sizeof(encrypt_round_keys));
+		}
 		extract_decrypt_key(key_expanded, aes256_num_rounds_nr);
 	}
 
@@ -92,6 +100,21 @@ namespace clan
 		int pos = 0;
 		while (pos < size)
 		{
+			// Whole blocks are decrypted straight from the input when the AES instructions are available,
+			// except for a final block that calculate() must remove the padding from
+			if (chunk_filled == 0 && Crypto_X86::is_aes_supported())
+			{
+				int num_blocks = (size - pos) / aes256_block_size_bytes;
+				if (padding_enabled && pos + num_blocks * aes256_block_size_bytes == size)
+					num_blocks--;
+				if (num_blocks > 0)
+				{
+					process_blocks_x86(true, round_keys, aes256_num_rounds_nr, initialisation_vector_1, initialisation_vector_2, initialisation_vector_3, initialisation_vector_4, data + pos, num_blocks, databuffer);
+					pos += num_blocks * aes256_block_size_bytes;
+					continue;
+				}
+			}
+
 			int data_left = size - pos;
 			int buffer_space = aes256_block_size_bytes - chunk_filled;
 			int data_used = min(buffer_space, data_left);
@@ -173,6 +196,7 @@ namespace clan
 		initialisation_vector_set = false;	// Force to reset after each call
 		cipher_key_set = false;				// Force to reset after each call (to avoid keeping the cipher key in memory)
 		memset(key_expanded, 0, sizeof(key_expanded));
+		memset(round_keys, 0, sizeof(round_keys));
 
 		return true;
 
@@ -180,6 +204,12 @@ namespace clan
 
 	void AES256_Decrypt_Impl::process_chunk()
 	{
+		if (Crypto_X86::is_aes_supported())
+		{
+			process_blocks_x86(true, round_keys, aes256_num_rounds_nr, initialisation_vector_1, initialisation_vector_2, initialisation_vector_3, initialisation_vector_4, chunk, 1, databuffer);
+			return;
+		}
+
 		const uint32_t *key_expanded_ptr = key_expanded;
 
 		uint32_t chunk1 = get_word(chunk);
@@ -0,0 +1,222 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "Core/precomp.h"
+#include "API/Core/System/databuffer.h"
+#include "aes_gcm.h"
+#include <cstring>
+
+namespace clan
+{
+	AES_GCM::AES_GCM(const unsigned char *key, int key_size)
+	{
+		if (key_size == aes128_key_length_bytes)
+		{
+			extract_encrypt_key128(key, key_expanded);
+			num_rounds = aes128_num_rounds_nr;
+		}
+		else if (key_size == aes256_key_length_bytes)
+		{
+			extract_encrypt_key256(key, key_expanded);
+			num_rounds = aes256_num_rounds_nr;
+		}
+		else
+		{
+			throw Exception("Unsupported AES-GCM key size");
+		}
+
+		// Hash subkey H = E(K, 0^128)
+		unsigned char zero[16] = { 0 };
+		unsigned char h[16];
+		encrypt_block(key_expanded, num_rounds, zero, h);
+
+		uint64_t vh = 0;
+		uint64_t vl = 0;
+		for (int i = 0; i < 8; i++)
+		{
+			vh = (vh << 8) | h[i];
+			vl = (vl << 8) | h[i + 8];
+		}
+
+		// 4 bit table method (Shoup). Bit order in GCM is reflected, so index 8 holds H itself
+		h_high[0] = 0;
+		h_low[0] = 0;
+		h_high[8] = vh;
+		h_low[8] = vl;
+		for (int i = 4; i > 0; i >>= 1)
+		{
+			uint64_t reduce = (vl & 1) ? 0xe100000000000000ULL : 0;
+			vl = (vh << 63) | (vl >> 1);
+			vh = (vh >> 1) ^ reduce;
+			h_high[i] = vh;
+			h_low[i] = vl;
+		}
+		for (int i = 2; i <= 8; i *= 2)
+		{
+			for (int j = 1; j < i; j++)
+			{
+				h_high[i + j] = h_high[i] ^ h_high[j];
+				h_low[i + j] = h_low[i] ^ h_low[j];
+			}
+		}
+
+		memset(h, 0, sizeof(h));
+	}
+
+	AES_GCM::~AES_GCM()
+	{
+		memset(key_expanded, 0, sizeof(key_expanded));
+		memset(h_high, 0, sizeof(h_high));
+		memset(h_low, 0, sizeof(h_low));
+	}
+
+	void AES_GCM::encrypt(const unsigned char nonce[nonce_size], const void *aad, int aad_size, const void *input, int size, void *output, unsigned char out_tag[tag_size])
+	{
+		crypt_counter(nonce, (const unsigned char *)input, size, (unsigned char *)output);
+		calculate_tag(nonce, (const unsigned char *)aad, aad_size, (const unsigned char *)output, size, out_tag);
+	}
+
+	bool AES_GCM::decrypt(const unsigned char nonce[nonce_size], const void *aad, int aad_size, const void *input, int size, void *output, const unsigned char tag[tag_size])
+	{
+		unsigned char expected_tag[tag_size];
+		calculate_tag(nonce, (const unsigned char *)aad, aad_size, (const unsigned char *)input, size, expected_tag);
+
+		// Compare in constant time
+		unsigned char difference = 0;
+		for (int i = 0; i < tag_size; i++)
+			difference |= expected_tag[i] ^ tag[i];
+		if (difference != 0)
+			return false;
+
+		crypt_counter(nonce, (const unsigned char *)input, size, (unsigned char *)output);
+		return true;
+	}
+
+	void AES_GCM::crypt_counter(const unsigned char nonce[nonce_size], const unsigned char *input, int size, unsigned char *output)
+	{
+		// The first counter block (J0 = nonce || 1) is reserved for the tag
+		unsigned char counter[16];
+		memcpy(counter, nonce, nonce_size);
+		uint32_t counter_value = 2;
+
+		unsigned char key_stream[16];
+		for (int pos = 0; pos < size; pos += 16)
+		{
+			put_word(counter_value++, counter + 12);
+			encrypt_block(key_expanded, num_rounds, counter, key_stream);
+
+			int block_size = size - pos < 16 ? size - pos : 16;
+			for (int i = 0; i < block_size; i++)
+				output[pos + i] = input[pos + i] ^ key_stream[i];
+		}
+	}
+
+	void AES_GCM::calculate_tag(const unsigned char nonce[nonce_size], const unsigned char *aad, int aad_size, const unsigned char *ciphertext, int size, unsigned char out_tag[tag_size])
+	{
+		uint64_t x_high = 0;
+		uint64_t x_low = 0;
+		ghash_update(x_high, x_low, aad, aad_size);
+		ghash_update(x_high, x_low, ciphertext, size);
+
+		x_high ^= (uint64_t)aad_size * 8;
+		x_low ^= (uint64_t)size * 8;
+		ghash_multiply(x_high, x_low);
+
+		unsigned char counter[16];
+		memcpy(counter, nonce, nonce_size);
+		put_word(1, counter + 12);
+		encrypt_block(key_expanded, num_rounds, counter, out_tag);
+
+		for (int i = 0; i < 8; i++)
+		{
+			out_tag[i] ^= (unsigned char)(x_high >> (56 - i * 8));
+			out_tag[i + 8] ^= (unsigned char)(x_low >> (56 - i * 8));
+		}
+	}
+
+	void AES_GCM::ghash_update(uint64_t &x_high, uint64_t &x_low, const unsigned char *data, int size)
+	{
+		for (int pos = 0; pos < size; pos += 16)
+		{
+			unsigned char block[16] = { 0 };
+			memcpy(block, data + pos, size - pos < 16 ? size - pos : 16);
+
+			for (int i = 0; i < 8; i++)
+			{
+				x_high ^= (uint64_t)block[i] << (56 - i * 8);
+				x_low ^= (uint64_t)block[i + 8] << (56 - i * 8);
+			}
+			ghash_multiply(x_high, x_low);
+		}
+	}
+
+	void AES_GCM::ghash_multiply(uint64_t &x_high, uint64_t &x_low)
+	{
+		static const uint64_t last4[16] =
+		{
+			0x0000, 0x1c20, 0x3840, 0x2460, 0x7080, 0x6ca0, 0x48c0, 0x54e0,
+			0xe100, 0xfd20, 0xd940, 0xc560, 0x9180, 0x8da0, 0xa9c0, 0xb5e0
+		};
+
+		unsigned char x[16];
+		for (int i = 0; i < 8; i++)
+		{
+			x[i] = (unsigned char)(x_high >> (56 - i * 8));
+			x[i + 8] = (unsigned char)(x_low >> (56 - i * 8));
+		}
+
+		int low_nibble = x[15] & 0xf;
+		uint64_t zh = h_high[low_nibble];
+		uint64_t zl = h_low[low_nibble];
+
+		for (int i = 15; i >= 0; i--)
+		{
+			low_nibble = x[i] & 0xf;
+			int high_nibble = x[i] >> 4;
+
+			if (i != 15)
+			{
+				int rem = (int)(zl & 0xf);
+				zl = (zh << 60) | (zl >> 4);
+				zh = (zh >> 4) ^ (last4[rem] << 48);
+				zh ^= h_high[low_nibble];
+				zl ^= h_low[low_nibble];
+			}
+
+			int rem = (int)(zl & 0xf);
+			zl = (zh << 60) | (zl >> 4);
+			zh = (zh >> 4) ^ (last4[rem] << 48);
+			zh ^= h_high[high_nibble];
+			zl ^= h_low[high_nibble];
+		}
+
+		x_high = zh;
+		x_low = zl;
+	}
+}
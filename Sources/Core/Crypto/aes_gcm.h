@@ -0,0 +1,69 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include "aes_impl.h"
+
+namespace clan
+{
+	/// \brief AES in Galois/Counter Mode (NIST SP 800-38D), as used by the TLS AEAD cipher suites
+	class AES_GCM : public AES_Impl
+	{
+	public:
+		/// \brief Constructs the cipher
+		///
+		/// \param key = Cipher key
+		/// \param key_size = Size of the key in bytes (16 or 32)
+		AES_GCM(const unsigned char *key, int key_size);
+		~AES_GCM();
+
+		static const int nonce_size = 12;
+		static const int tag_size = 16;
+
+		/// \brief Encrypts input into output and writes the authentication tag of the additional data and ciphertext
+		void encrypt(const unsigned char nonce[nonce_size], const void *aad, int aad_size, const void *input, int size, void *output, unsigned char out_tag[tag_size]);
+
+		/// \brief Decrypts input into output, returning false if the authentication tag does not match
+		bool decrypt(const unsigned char nonce[nonce_size], const void *aad, int aad_size, const void *input, int size, void *output, const unsigned char tag[tag_size]);
+
+	private:
+		void crypt_counter(const unsigned char nonce[nonce_size], const unsigned char *input, int size, unsigned char *output);
+		void calculate_tag(const unsigned char nonce[nonce_size], const unsigned char *aad, int aad_size, const unsigned char *ciphertext, int size, unsigned char out_tag[tag_size]);
+		void ghash_update(uint64_t &x_high, uint64_t &x_low, const unsigned char *data, int size);
+		void ghash_multiply(uint64_t &x_high, uint64_t &x_low);
+
+		uint32_t key_expanded[aes256_nb_mult_nr_plus1];
+		int num_rounds;
+
+		// Multiples of the hash subkey H for every 4 bit value, split into high and low halves
+		uint64_t h_high[16];
+		uint64_t h_low[16];
+	};
+}
@@ -32,6 +32,7 @@
 #include "API/Core/System/databuffer.h"
 #include "API/Core/Math/cl_math.h"
 #include "aes_impl.h"
+#include "crypto_x86.h"
 
 #ifndef WIN32
 #include <cstring>
@@ -180,6 +181,66 @@ namespace clan
 		put_word(s3, dest_ptr + 12);
 	}
 
+	void AES_Impl::encrypt_block(const uint32_t *key_expanded, int num_rounds, const unsigned char input[16], unsigned char output[16]) const
+	{
+		uint32_t s0 = get_word(input) ^ key_expanded[0];
+		uint32_t s1 = get_word(input + 4) ^ key_expanded[1];
+		uint32_t s2 = get_word(input + 8) ^ key_expanded[2];
+		uint32_t s3 = get_word(input + 12) ^ key_expanded[3];
+
+		for (int round = 1; round < num_rounds; round++)
+		{
+			key_expanded += 4;
+			uint32_t t0 = table_e0[s0 >> 24] ^ table_e1[(s1 >> 16) & 0xff] ^ table_e2[(s2 >> 8) & 0xff] ^ table_e3[s3 & 0xff] ^ key_expanded[0];
+			uint32_t t1 = table_e0[s1 >> 24] ^ table_e1[(s2 >> 16) & 0xff] ^ table_e2[(s3 >> 8) & 0xff] ^ table_e3[s0 & 0xff] ^ key_expanded[1];
+			uint32_t t2 = table_e0[s2 >> 24] ^ table_e1[(s3 >> 16) & 0xff] ^ table_e2[(s0 >> 8) & 0xff] ^ table_e3[s1 & 0xff] ^ key_expanded[2];
+			uint32_t t3 = table_e0[s3 >> 24] ^ table_e1[(s0 >> 16) & 0xff] ^ table_e2[(s1 >> 8) & 0xff] ^ table_e3[s2 & 0xff] ^ key_expanded[3];
+			s0 = t0;
+			s1 = t1;
+			s2 = t2;
+			s3 = t3;
+		}
+		key_expanded += 4;
+
+		// Apply last round
+		put_word((sbox_substitution_values[(s0 >> 24)] & 0xff000000) ^ (sbox_substitution_values[(s1 >> 16) & 0xff] & 0x00ff0000) ^ (sbox_substitution_values[(s2 >> 8) & 0xff] & 0x0000ff00) ^ (sbox_substitution_values[(s3)& 0xff] & 0x000000ff) ^ key_expanded[0], output);
+		put_word((sbox_substitution_values[(s1 >> 24)] & 0xff000000) ^ (sbox_substitution_values[(s2 >> 16) & 0xff] & 0x00ff0000) ^ (sbox_substitution_values[(s3 >> 8) & 0xff] & 0x0000ff00) ^ (sbox_substitution_values[(s0)& 0xff] & 0x000000ff) ^ key_expanded[1], output + 4);
+		put_word((sbox_substitution_values[(s2 >> 24)] & 0xff000000) ^ (sbox_substitution_values[(s3 >> 16) & 0xff] & 0x00ff0000) ^ (sbox_substitution_values[(s0 >> 8) & 0xff] & 0x0000ff00) ^ (sbox_substitution_values[(s1)& 0xff] & 0x000000ff) ^ key_expanded[2], output + 8);
+		put_word((sbox_substitution_values[(s3 >> 24)] & 0xff000000) ^ (sbox_substitution_values[(s0 >> 16) & 0xff] & 0x00ff0000) ^ (sbox_substitution_values[(s1 >> 8) & 0xff] & 0x0000ff00) ^ (sbox_substitution_values[(s2)& 0xff] & 0x000000ff) ^ key_expanded[3], output + 12);
+	}
+
+	void AES_Impl::create_round_keys(const uint32_t *key_expanded, int num_rounds, unsigned char *out_round_keys)
+	{
+		for (int cnt = 0; cnt < (num_rounds + 1) * 4; cnt++)
+			put_word(key_expanded[cnt], out_round_keys + cnt * 4);
+	}
+
+	void AES_Impl::process_blocks_x86(bool decrypt, const unsigned char *round_keys, int num_rounds, uint32_t &iv1, uint32_t &iv2, uint32_t &iv3, uint32_t &iv4, const unsigned char *data, int num_blocks, DataBuffer &databuffer)
+	{
+		unsigned int current_size = databuffer.get_size();
+		unsigned int needed = current_size + num_blocks * aes128_block_size_bytes;
+		if (needed > databuffer.get_capacity())
+			databuffer.set_capacity(max(needed, databuffer.get_capacity() * 2));
+		databuffer.set_size(needed);
+		unsigned char *dest_ptr = (unsigned char *)databuffer.get_data() + current_size;
+
+		unsigned char iv[16];
+		put_word(iv1, iv);
+		put_word(iv2, iv + 4);
+		put_word(iv3, iv + 8);
+		put_word(iv4, iv + 12);
+
+		if (decrypt)
+			Crypto_X86::aes_decrypt_cbc(round_keys, num_rounds, iv, data, dest_ptr, num_blocks);
+		else
+			Crypto_X86::aes_encrypt_cbc(round_keys, num_rounds, iv, data, dest_ptr, num_blocks);
+
+		iv1 = get_word(iv);
+		iv2 = get_word(iv + 4);
+		iv3 = get_word(iv + 8);
+		iv4 = get_word(iv + 12);
+	}
+
 	void AES_Impl::extract_decrypt_key(uint32_t *key_expanded, int num_rounds)
 	{
 		// Invert the order of the round keys
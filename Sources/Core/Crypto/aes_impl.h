@@ -77,6 +77,15 @@ namespace clan
 		void extract_decrypt_key(uint32_t *key_expanded, int num_rounds);
 		void store_block(uint32_t s0, uint32_t s1, uint32_t s2, uint32_t s3, DataBuffer &databuffer);
 
+		/// \brief Encrypts a single block in electronic codebook mode, used by the counter mode ciphers
+		void encrypt_block(const uint32_t *key_expanded, int num_rounds, const unsigned char input[16], unsigned char output[16]) const;
+
+		/// \brief Converts expanded key words to the byte order used by the AES instructions
+		void create_round_keys(const uint32_t *key_expanded, int num_rounds, unsigned char *out_round_keys);
+
+		/// \brief Encrypts or decrypts whole blocks in CBC mode with the AES instructions, appending the result to databuffer
+		void process_blocks_x86(bool decrypt, const unsigned char *round_keys, int num_rounds, uint32_t &iv1, uint32_t &iv2, uint32_t &iv3, uint32_t &iv4, const unsigned char *data, int num_blocks, DataBuffer &databuffer);
+
 		inline uint32_t get_word(const unsigned char *data) const
 		{
 			return ((data[0] << 24) | (data[1] << 16) | (data[2] << 8) | (data[3]));
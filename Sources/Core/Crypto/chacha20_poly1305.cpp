@@ -0,0 +1,270 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "Core/precomp.h"
+#include "chacha20_poly1305.h"
+#include <cstring>
+
+namespace clan
+{
+	namespace
+	{
+		inline uint32_t load_le32(const unsigned char *data)
+		{
+			return data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24);
+		}
+
+		inline void store_le32(uint32_t value, unsigned char *data)
+		{
+			data[0] = (unsigned char)value;
+			data[1] = (unsigned char)(value >> 8);
+			data[2] = (unsigned char)(value >> 16);
+			data[3] = (unsigned char)(value >> 24);
+		}
+
+		inline uint32_t rotate_left(uint32_t value, int bits)
+		{
+			return (value << bits) | (value >> (32 - bits));
+		}
+
+		inline void quarter_round(uint32_t &a, uint32_t &b, uint32_t &c, uint32_t &d)
+		{
+			a += b; d ^= a; d = rotate_left(d, 16);
+			c += d; b ^= c; b = rotate_left(b, 12);
+			a += b; d ^= a; d = rotate_left(d, 8);
+			c += d; b ^= c; b = rotate_left(b, 7);
+		}
+
+		/// \brief Poly1305 one-time authenticator using 26 bit limbs
+		class Poly1305
+		{
+		public:
+			Poly1305(const unsigned char key[32])
+			{
+				r[0] = (load_le32(key + 0)) & 0x3ffffff;
+				r[1] = (load_le32(key + 3) >> 2) & 0x3ffff03;
+				r[2] = (load_le32(key + 6) >> 4) & 0x3ffc0ff;
+				r[3] = (load_le32(key + 9) >> 6) & 0x3f03fff;
+				r[4] = (load_le32(key + 12) >> 8) & 0x00fffff;
+				for (int i = 0; i < 4; i++)
+					pad[i] = load_le32(key + 16 + i * 4);
+			}
+
+			~Poly1305()
+			{
+				memset(r, 0, sizeof(r));
+				memset(pad, 0, sizeof(pad));
+				memset(h, 0, sizeof(h));
+			}
+
+			/// \brief Adds data zero padded to a multiple of 16 bytes
+			void add_padded(const unsigned char *data, int size)
+			{
+				int whole_size = size & ~15;
+				blocks(data, whole_size, 1 << 24);
+				if (whole_size != size)
+				{
+					unsigned char block[16] = { 0 };
+					memcpy(block, data + whole_size, size - whole_size);
+					blocks(block, 16, 1 << 24);
+				}
+			}
+
+			void blocks(const unsigned char *data, int size, uint32_t hibit)
+			{
+				const uint32_t s1 = r[1] * 5, s2 = r[2] * 5, s3 = r[3] * 5, s4 = r[4] * 5;
+				uint32_t h0 = h[0], h1 = h[1], h2 = h[2], h3 = h[3], h4 = h[4];
+
+				for (int pos = 0; pos + 16 <= size; pos += 16)
+				{
+					const unsigned char *m = data + pos;
+					h0 += (load_le32(m + 0)) & 0x3ffffff;
+					h1 += (load_le32(m + 3) >> 2) & 0x3ffffff;
+					h2 += (load_le32(m + 6) >> 4) & 0x3ffffff;
+					h3 += (load_le32(m + 9) >> 6) & 0x3ffffff;
+					h4 += (load_le32(m + 12) >> 8) | hibit;
+
+					uint64_t d0 = (uint64_t)h0 * r[0] + (uint64_t)h1 * s4 + (uint64_t)h2 * s3 + (uint64_t)h3 * s2 + (uint64_t)h4 * s1;
+					uint64_t d1 = (uint64_t)h0 * r[1] + (uint64_t)h1 * r[0] + (uint64_t)h2 * s4 + (uint64_t)h3 * s3 + (uint64_t)h4 * s2;
+					uint64_t d2 = (uint64_t)h0 * r[2] + (uint64_t)h1 * r[1] + (uint64_t)h2 * r[0] + (uint64_t)h3 * s4 + (uint64_t)h4 * s3;
+					uint64_t d3 = (uint64_t)h0 * r[3] + (uint64_t)h1 * r[2] + (uint64_t)h2 * r[1] + (uint64_t)h3 * r[0] + (uint64_t)h4 * s4;
+					uint64_t d4 = (uint64_t)h0 * r[4] + (uint64_t)h1 * r[3] + (uint64_t)h2 * r[2] + (uint64_t)h3 * r[1] + (uint64_t)h4 * r[0];
+
+					uint32_t c = (uint32_t)(d0 >> 26); h0 = (uint32_t)d0 & 0x3ffffff;
+					d1 += c; c = (uint32_t)(d1 >> 26); h1 = (uint32_t)d1 & 0x3ffffff;
+					d2 += c; c = (uint32_t)(d2 >> 26); h2 = (uint32_t)d2 & 0x3ffffff;
+					d3 += c; c = (uint32_t)(d3 >> 26); h3 = (uint32_t)d3 & 0x3ffffff;
+					d4 += c; c = (uint32_t)(d4 >> 26); h4 = (uint32_t)d4 & 0x3ffffff;
+					h0 += c * 5; c = h0 >> 26; h0 &= 0x3ffffff;
+					h1 += c;
+				}
+
+				h[0] = h0; h[1] = h1; h[2] = h2; h[3] = h3; h[4] = h4;
+			}
+
+			void finish(unsigned char out_tag[16])
+			{
+				uint32_t h0 = h[0], h1 = h[1], h2 = h[2], h3 = h[3], h4 = h[4];
+
+				uint32_t c = h1 >> 26; h1 &= 0x3ffffff;
+				h2 += c; c = h2 >> 26; h2 &= 0x3ffffff;
+				h3 += c; c = h3 >> 26; h3 &= 0x3ffffff;
+				h4 += c; c = h4 >> 26; h4 &= 0x3ffffff;
+				h0 += c * 5; c = h0 >> 26; h0 &= 0x3ffffff;
+				h1 += c;
+
+				// Compute h - p and select it when h >= p
+				uint32_t g0 = h0 + 5; c = g0 >> 26; g0 &= 0x3ffffff;
+				uint32_t g1 = h1 + c; c = g1 >> 26; g1 &= 0x3ffffff;
+				uint32_t g2 = h2 + c; c = g2 >> 26; g2 &= 0x3ffffff;
+				uint32_t g3 = h3 + c; c = g3 >> 26; g3 &= 0x3ffffff;
+				uint32_t g4 = h4 + c - (1 << 26);
+
+				uint32_t mask = (g4 >> 31) - 1;
+				h0 = (h0 & ~mask) | (g0 & mask);
+				h1 = (h1 & ~mask) | (g1 & mask);
+				h2 = (h2 & ~mask) | (g2 & mask);
+				h3 = (h3 & ~mask) | (g3 & mask);
+				h4 = (h4 & ~mask) | (g4 & mask);
+
+				h0 = h0 | (h1 << 26);
+				h1 = (h1 >> 6) | (h2 << 20);
+				h2 = (h2 >> 12) | (h3 << 14);
+				h3 = (h3 >> 18) | (h4 << 8);
+
+				uint64_t f = (uint64_t)h0 + pad[0]; store_le32((uint32_t)f, out_tag);
+				f = (uint64_t)h1 + pad[1] + (f >> 32); store_le32((uint32_t)f, out_tag + 4);
+				f = (uint64_t)h2 + pad[2] + (f >> 32); store_le32((uint32_t)f, out_tag + 8);
+				f = (uint64_t)h3 + pad[3] + (f >> 32); store_le32((uint32_t)f, out_tag + 12);
+			}
+
+		private:
+			uint32_t r[5];
+			uint32_t pad[4];
+			uint32_t h[5] = { 0 };
+		};
+	}
+
+	ChaCha20_Poly1305::ChaCha20_Poly1305(const unsigned char key[32])
+	{
+		for (int i = 0; i < 8; i++)
+			key_words[i] = load_le32(key + i * 4);
+	}
+
+	ChaCha20_Poly1305::~ChaCha20_Poly1305()
+	{
+		memset(key_words, 0, sizeof(key_words));
+	}
+
+	void ChaCha20_Poly1305::encrypt(const unsigned char nonce[nonce_size], const void *aad, int aad_size, const void *input, int size, void *output, unsigned char out_tag[tag_size])
+	{
+		crypt(nonce, (const unsigned char *)input, size, (unsigned char *)output);
+		calculate_tag(nonce, (const unsigned char *)aad, aad_size, (const unsigned char *)output, size, out_tag);
+	}
+
+	bool ChaCha20_Poly1305::decrypt(const unsigned char nonce[nonce_size], const void *aad, int aad_size, const void *input, int size, void *output, const unsigned char tag[tag_size])
+	{
+		unsigned char expected_tag[tag_size];
+		calculate_tag(nonce, (const unsigned char *)aad, aad_size, (const unsigned char *)input, size, expected_tag);
+
+		// Compare in constant time
+		unsigned char difference = 0;
+		for (int i = 0; i < tag_size; i++)
+			difference |= expected_tag[i] ^ tag[i];
+		if (difference != 0)
+			return false;
+
+		crypt(nonce, (const unsigned char *)input, size, (unsigned char *)output);
+		return true;
+	}
+
+	void ChaCha20_Poly1305::chacha20_block(const unsigned char nonce[nonce_size], uint32_t counter, unsigned char out_block[64]) const
+	{
+		uint32_t state[16] =
+		{
+			0x61707865, 0x3320646e, 0x79622d32, 0x6b206574,
+			key_words[0], key_words[1], key_words[2], key_words[3],
+			key_words[4], key_words[5], key_words[6], key_words[7],
+			counter, load_le32(nonce), load_le32(nonce + 4), load_le32(nonce + 8)
+		};
+
+		uint32_t x[16];
+		memcpy(x, state, sizeof(x));
+		for (int i = 0; i < 10; i++)
+		{
+			quarter_round(x[0], x[4], x[8], x[12]);
+			quarter_round(x[1], x[5], x[9], x[13]);
+			quarter_round(x[2], x[6], x[10], x[14]);
+			quarter_round(x[3], x[7], x[11], x[15]);
+			quarter_round(x[0], x[5], x[10], x[15]);
+			quarter_round(x[1], x[6], x[11], x[12]);
+			quarter_round(x[2], x[7], x[8], x[13]);
+			quarter_round(x[3], x[4], x[9], x[14]);
+		}
+
+		for (int i = 0; i < 16; i++)
+			store_le32(x[i] + state[i], out_block + i * 4);
+	}
+
+	void ChaCha20_Poly1305::crypt(const unsigned char nonce[nonce_size], const unsigned char *input, int size, unsigned char *output) const
+	{
+		// Block 0 provides the Poly1305 key, the payload starts at block 1
+		uint32_t counter = 1;
+		unsigned char key_stream[64];
+		for (int pos = 0; pos < size; pos += 64)
+		{
+			chacha20_block(nonce, counter++, key_stream);
+
+			int block_size = size - pos < 64 ? size - pos : 64;
+			for (int i = 0; i < block_size; i++)
+				output[pos + i] = input[pos + i] ^ key_stream[i];
+		}
+		memset(key_stream, 0, sizeof(key_stream));
+	}
+
+	void ChaCha20_Poly1305::calculate_tag(const unsigned char nonce[nonce_size], const unsigned char *aad, int aad_size, const unsigned char *ciphertext, int size, unsigned char out_tag[tag_size]) const
+	{
+		unsigned char poly_key[64];
+		chacha20_block(nonce, 0, poly_key);
+		Poly1305 poly1305(poly_key);
+		memset(poly_key, 0, sizeof(poly_key));
+
+		poly1305.add_padded(aad, aad_size);
+		poly1305.add_padded(ciphertext, size);
+
+		unsigned char lengths[16];
+		store_le32((uint32_t)aad_size, lengths);
+		store_le32(0, lengths + 4);
+		store_le32((uint32_t)size, lengths + 8);
+		store_le32(0, lengths + 12);
+		poly1305.blocks(lengths, 16, 1 << 24);
+
+		poly1305.finish(out_tag);
+	}
+}
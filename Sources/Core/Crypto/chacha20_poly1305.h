@@ -0,0 +1,63 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+namespace clan
+{
+	/// \brief ChaCha20 stream cipher with Poly1305 authenticator (RFC 8439), as used by the TLS AEAD cipher suites
+	///
+	/// Runs at full speed on CPUs without AES instructions.
+	class ChaCha20_Poly1305
+	{
+	public:
+		/// \brief Constructs the cipher
+		///
+		/// \param key = 32 byte cipher key
+		ChaCha20_Poly1305(const unsigned char key[32]);
+		~ChaCha20_Poly1305();
+
+		static const int key_size = 32;
+		static const int nonce_size = 12;
+		static const int tag_size = 16;
+
+		/// \brief Encrypts input into output and writes the authentication tag of the additional data and ciphertext
+		void encrypt(const unsigned char nonce[nonce_size], const void *aad, int aad_size, const void *input, int size, void *output, unsigned char out_tag[tag_size]);
+
+		/// \brief Decrypts input into output, returning false if the authentication tag does not match
+		bool decrypt(const unsigned char nonce[nonce_size], const void *aad, int aad_size, const void *input, int size, void *output, const unsigned char tag[tag_size]);
+
+	private:
+		void chacha20_block(const unsigned char nonce[nonce_size], uint32_t counter, unsigned char out_block[64]) const;
+		void crypt(const unsigned char nonce[nonce_size], const unsigned char *input, int size, unsigned char *output) const;
+		void calculate_tag(const unsigned char nonce[nonce_size], const unsigned char *aad, int aad_size, const unsigned char *ciphertext, int size, unsigned char out_tag[tag_size]) const;
+
+		uint32_t key_words[8];
+	};
+}
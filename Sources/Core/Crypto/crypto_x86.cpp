@@ -0,0 +1,493 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+*/
+
+
+#include "Core/precomp.h"
+#include "crypto_x86.h"
+#include "API/Core/System/system.h"
+#include <cstring>
+
+#if !defined __ANDROID__ && !defined CL_DISABLE_SSE2 && (defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64))
+#include <immintrin.h>
+#define CL_CRYPTO_X86
+#if defined(__GNUC__)
+// The kernels are compiled for their instruction set only, and selected at runtime
+#define CL_TARGET_SHA __attribute__((target("sha,sse4.1")))
+#define CL_TARGET_AES __attribute__((target("aes,sse2")))
+#define CL_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define CL_TARGET_SHA
+#define CL_TARGET_AES
+#define CL_TARGET_AVX2
+#endif
+#endif
+
+namespace clan
+{
+#ifdef CL_CRYPTO_X86
+
+	bool Crypto_X86::is_sha_supported()
+	{
+		static const bool supported = System::detect_cpu_extension(System::sha) && System::detect_cpu_extension(System::sse4_1);
+		return supported;
+	}
+
+	bool Crypto_X86::is_aes_supported()
+	{
+		static const bool supported = System::detect_cpu_extension(System::aes) && System::detect_cpu_extension(System::sse2);
+		return supported;
+	}
+
+	bool Crypto_X86::is_avx2_supported()
+	{
+		static const bool supported = System::detect_cpu_extension(System::avx2);
+		return supported;
+	}
+
+	// Constants defined in FIPS 180-3, section 4.2.2
+	alignas(16) static const uint32_t sha256_constant_K[64] = {
+		0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+		0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+		0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+		0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+		0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+		0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+		0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+		0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+	};
+
+	template<int bits>
+	CL_TARGET_AVX2 static inline __m256i sha256_rotr_x8(__m256i value)
+	{
+		return _mm256_or_si256(_mm256_srli_epi32(value, bits), _mm256_slli_epi32(value, 32 - bits));
+	}
+
+	CL_TARGET_AVX2 static inline uint32_t sha256_load_be(const unsigned char *data)
+	{
+		return ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) | data[3];
+	}
+
+	// One 64 byte block for each of eight lanes. The state is word major, state[word * 8 + lane].
+	CL_TARGET_AVX2 static void sha256_block_x8(uint32_t state[64], const unsigned char *const blocks[8])
+	{
+		__m256i w[16];
+		for (int t = 0; t < 16; t++)
+		{
+			w[t] = _mm256_set_epi32(
+				sha256_load_be(blocks[7] + t * 4), sha256_load_be(blocks[6] + t * 4), sha256_load_be(blocks[5] + t * 4), sha256_load_be(blocks[4] + t * 4),
+				sha256_load_be(blocks[3] + t * 4), sha256_load_be(blocks[2] + t * 4), sha256_load_be(blocks[1] + t * 4), sha256_load_be(blocks[0] + t * 4));
+		}
+
+		__m256i a = _mm256_loadu_si256((const __m256i *)(state + 0));
+		__m256i b = _mm256_loadu_si256((const __m256i *)(state + 8));
+		__m256i c = _mm256_loadu_si256((const __m256i *)(state + 16));
+		__m256i d = _mm256_loadu_si256((const __m256i *)(state + 24));
+		__m256i e = _mm256_loadu_si256((const __m256i *)(state + 32));
+		__m256i f = _mm256_loadu_si256((const __m256i *)(state + 40));
+		__m256i g = _mm256_loadu_si256((const __m256i *)(state + 48));
+		__m256i h = _mm256_loadu_si256((const __m256i *)(state + 56));
+
+		for (int t = 0; t < 64; t++)
+		{
+			if (t >= 16)
+			{
+				__m256i w2 = w[(t - 2) & 15];
+				__m256i w15 = w[(t - 15) & 15];
+				__m256i s0 = _mm256_xor_si256(_mm256_xor_si256(sha256_rotr_x8<7>(w15), sha256_rotr_x8<18>(w15)), _mm256_srli_epi32(w15, 3));
+				__m256i s1 = _mm256_xor_si256(_mm256_xor_si256(sha256_rotr_x8<17>(w2), sha256_rotr_x8<19>(w2)), _mm256_srli_epi32(w2, 10));
+				w[t & 15] = _mm256_add_epi32(_mm256_add_epi32(w[t & 15], s0), _mm256_add_epi32(w[(t - 7) & 15], s1));
+			}
+
+			__m256i sum1 = _mm256_xor_si256(_mm256_xor_si256(sha256_rotr_x8<6>(e), sha256_rotr_x8<11>(e)), sha256_rotr_x8<25>(e));
+			__m256i ch = _mm256_xor_si256(_mm256_and_si256(e, _mm256_xor_si256(f, g)), g);
+			__m256i t1 = _mm256_add_epi32(_mm256_add_epi32(h, sum1), _mm256_add_epi32(ch, _mm256_add_epi32(w[t & 15], _mm256_set1_epi32(sha256_constant_K[t]))));
+			__m256i sum0 = _mm256_xor_si256(_mm256_xor_si256(sha256_rotr_x8<2>(a), sha256_rotr_x8<13>(a)), sha256_rotr_x8<22>(a));
+			__m256i maj = _mm256_or_si256(_mm256_and_si256(a, _mm256_or_si256(b, c)), _mm256_and_si256(b, c));
+			__m256i t2 = _mm256_add_epi32(sum0, maj);
+
+			h = g;
+			g = f;
+			f = e;
+			e = _mm256_add_epi32(d, t1);
+			d = c;
+			c = b;
+			b = a;
+			a = _mm256_add_epi32(t1, t2);
+		}
+
+		__m256i *out = (__m256i *)state;
+		_mm256_storeu_si256(out + 0, _mm256_add_epi32(_mm256_loadu_si256(out + 0), a));
+		_mm256_storeu_si256(out + 1, _mm256_add_epi32(_mm256_loadu_si256(out + 1), b));
+		_mm256_storeu_si256(out + 2, _mm256_add_epi32(_mm256_loadu_si256(out + 2), c));
+		_mm256_storeu_si256(out + 3, _mm256_add_epi32(_mm256_loadu_si256(out + 3), d));
+		_mm256_storeu_si256(out + 4, _mm256_add_epi32(_mm256_loadu_si256(out + 4), e));
+		_mm256_storeu_si256(out + 5, _mm256_add_epi32(_mm256_loadu_si256(out + 5), f));
+		_mm256_storeu_si256(out + 6, _mm256_add_epi32(_mm256_loadu_si256(out + 6), g));
+		_mm256_storeu_si256(out + 7, _mm256_add_epi32(_mm256_loadu_si256(out + 7), h));
+	}
+
+	void Crypto_X86::sha256_multi_buffer(const void *const *data, const int *sizes, int count, unsigned char *out_hashes)
+	{
+		static const uint32_t initial_state[8] = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+		static const unsigned char idle_block[64] = { 0 };
+
+		struct Lane
+		{
+			int index = -1;
+			const unsigned char *next = nullptr;
+			int full_blocks = 0;
+			int tail_blocks = 0;
+			int tail_pos = 0;
+			unsigned char tail[128];
+		};
+
+		uint32_t state[64];
+		Lane lanes[8];
+		int next_index = 0;
+		int active = 0;
+
+		auto start_lane = [&](int lane_index)
+		{
+			Lane &lane = lanes[lane_index];
+			if (next_index == count)
+			{
+				lane.index = -1;
+				return;
+			}
+
+			// The padding and length are written to one or two tail blocks after the whole blocks of the buffer
+			int index = next_index++;
+			int size = sizes[index];
+			int remaining = size % 64;
+			lane.index = index;
+			lane.next = (const unsigned char *)data[index];
+			lane.full_blocks = size / 64;
+			lane.tail_blocks = remaining < 56 ? 1 : 2;
+			lane.tail_pos = 0;
+			memset(lane.tail, 0, sizeof(lane.tail));
+			memcpy(lane.tail, lane.next + lane.full_blocks * 64, remaining);
+			lane.tail[remaining] = 0x80;
+			uint64_t length_bits = (uint64_t)size * 8;
+			for (int i = 0; i < 8; i++)
+				lane.tail[lane.tail_blocks * 64 - 1 - i] = (unsigned char)(length_bits >> (i * 8));
+
+			for (int word = 0; word < 8; word++)
+				state[word * 8 + lane_index] = initial_state[word];
+			active++;
+		};
+
+		for (int i = 0; i < 8; i++)
+			start_lane(i);
+
+		while (active > 0)
+		{
+			const unsigned char *blocks[8];
+			for (int i = 0; i < 8; i++)
+			{
+				Lane &lane = lanes[i];
+				if (lane.index == -1)
+				{
+					blocks[i] = idle_block;
+				}
+				else if (lane.full_blocks > 0)
+				{
+					blocks[i] = lane.next;
+					lane.next += 64;
+					lane.full_blocks--;
+				}
+				else
+				{
+					blocks[i] = lane.tail + lane.tail_pos * 64;
+					lane.tail_pos++;
+				}
+			}
+
+			sha256_block_x8(state, blocks);
+
+			for (int i = 0; i < 8; i++)
+			{
+				Lane &lane = lanes[i];
+				if (lane.index != -1 && lane.full_blocks == 0 && lane.tail_pos == lane.tail_blocks)
+				{
+					unsigned char *out_hash = out_hashes + lane.index * 32;
+					for (int word = 0; word < 8; word++)
+					{
+						uint32_t value = state[word * 8 + i];
+						out_hash[word * 4] = (unsigned char)(value >> 24);
+						out_hash[word * 4 + 1] = (unsigned char)(value >> 16);
+						out_hash[word * 4 + 2] = (unsigned char)(value >> 8);
+						out_hash[word * 4 + 3] = (unsigned char)value;
+					}
+					active--;
+					start_lane(i);
+				}
+			}
+		}
+	}
+
+	// Four rounds of SHA-1, group being the index of the rounds divided by four. The message schedule is kept in
+	// four registers, and e_next receives the ABCD value that the next group derives its E from.
+	template<int func>
+	CL_TARGET_SHA static inline void sha1_group(int group, __m128i &abcd, __m128i &e, __m128i &e_next, __m128i msg[4])
+	{
+		if (group == 0)
+			e = _mm_add_epi32(e, msg[0]);
+		else
+			e = _mm_sha1nexte_epu32(e, msg[group & 3]);
+		e_next = abcd;
+		if (group >= 3 && group <= 18)
+			msg[(group + 1) & 3] = _mm_sha1msg2_epu32(msg[(group + 1) & 3], msg[group & 3]);
+		abcd = _mm_sha1rnds4_epu32(abcd, e, func);
+		if (group >= 1 && group <= 16)
+			msg[(group + 3) & 3] = _mm_sha1msg1_epu32(msg[(group + 3) & 3], msg[group & 3]);
+		if (group >= 2 && group <= 17)
+			msg[(group + 2) & 3] = _mm_xor_si128(msg[(group + 2) & 3], msg[group & 3]);
+	}
+
+	CL_TARGET_SHA void Crypto_X86::sha1_blocks(uint32_t state[5], const unsigned char *data, int num_blocks)
+	{
+		const __m128i shuffle_mask = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+
+		__m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)state), 0x1B);
+		__m128i e0 = _mm_set_epi32(state[4], 0, 0, 0);
+		__m128i e1;
+
+		for (int block = 0; block < num_blocks; block++, data += 64)
+		{
+			__m128i abcd_save = abcd;
+			__m128i e0_save = e0;
+
+			__m128i msg[4];
+			for (int i = 0; i < 4; i++)
+				msg[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + i * 16)), shuffle_mask);
+
+			for (int group = 0; group < 5; group += 2)
+			{
+				sha1_group<0>(group, abcd, e0, e1, msg);
+				if (group + 1 < 5)
+					sha1_group<0>(group + 1, abcd, e1, e0, msg);
+			}
+			for (int group = 5; group < 10; group += 2)
+			{
+				sha1_group<1>(group, abcd, e1, e0, msg);
+				if (group + 1 < 10)
+					sha1_group<1>(group + 1, abcd, e0, e1, msg);
+			}
+			for (int group = 10; group < 15; group += 2)
+			{
+				sha1_group<2>(group, abcd, e0, e1, msg);
+				if (group + 1 < 15)
+					sha1_group<2>(group + 1, abcd, e1, e0, msg);
+			}
+			for (int group = 15; group < 20; group += 2)
+			{
+				sha1_group<3>(group, abcd, e1, e0, msg);
+				if (group + 1 < 20)
+					sha1_group<3>(group + 1, abcd, e0, e1, msg);
+			}
+
+			e0 = _mm_sha1nexte_epu32(e0, e0_save);
+			abcd = _mm_add_epi32(abcd, abcd_save);
+		}
+
+		_mm_storeu_si128((__m128i *)state, _mm_shuffle_epi32(abcd, 0x1B));
+		state[4] = _mm_extract_epi32(e0, 3);
+	}
+
+	CL_TARGET_SHA void Crypto_X86::sha256_blocks(uint32_t state[8], const unsigned char *data, int num_blocks)
+	{
+		const __m128i shuffle_mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+		// The round instructions work on the state rearranged as ABEF and CDGH
+		__m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)state), 0xB1);
+		__m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)(state + 4)), 0x1B);
+		__m128i state0 = _mm_alignr_epi8(tmp, state1, 8);
+		state1 = _mm_blend_epi16(state1, tmp, 0xF0);
+
+		for (int block = 0; block < num_blocks; block++, data += 64)
+		{
+			__m128i abef_save = state0;
+			__m128i cdgh_save = state1;
+
+			__m128i msg[4];
+			for (int i = 0; i < 4; i++)
+				msg[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + i * 16)), shuffle_mask);
+
+			for (int group = 0; group < 16; group++)
+			{
+				__m128i wk = _mm_add_epi32(msg[group & 3], _mm_load_si128((const __m128i *)(sha256_constant_K + group * 4)));
+				state1 = _mm_sha256rnds2_epu32(state1, state0, wk);
+				state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(wk, 0x0E));
+
+				// Replace the words just used with the words needed four groups later
+				if (group < 12)
+				{
+					__m128i w = _mm_sha256msg1_epu32(msg[group & 3], msg[(group + 1) & 3]);
+					w = _mm_add_epi32(w, _mm_alignr_epi8(msg[(group + 3) & 3], msg[(group + 2) & 3], 4));
+					msg[group & 3] = _mm_sha256msg2_epu32(w, msg[(group + 3) & 3]);
+				}
+			}
+
+			state0 = _mm_add_epi32(state0, abef_save);
+			state1 = _mm_add_epi32(state1, cdgh_save);
+		}
+
+		tmp = _mm_shuffle_epi32(state0, 0x1B);
+		state1 = _mm_shuffle_epi32(state1, 0xB1);
+		_mm_storeu_si128((__m128i *)state, _mm_blend_epi16(tmp, state1, 0xF0));
+		_mm_storeu_si128((__m128i *)(state + 4), _mm_alignr_epi8(state1, tmp, 8));
+	}
+
+	CL_TARGET_AES void Crypto_X86::aes_create_decrypt_keys(const unsigned char *encrypt_round_keys, int num_rounds, unsigned char *out_decrypt_round_keys)
+	{
+		// Equivalent inverse cipher, FIPS 197 section 5.3.5
+		const __m128i *encrypt_keys = (const __m128i *)encrypt_round_keys;
+		__m128i *decrypt_keys = (__m128i *)out_decrypt_round_keys;
+		_mm_storeu_si128(decrypt_keys, _mm_loadu_si128(encrypt_keys + num_rounds));
+		for (int i = 1; i < num_rounds; i++)
+			_mm_storeu_si128(decrypt_keys + i, _mm_aesimc_si128(_mm_loadu_si128(encrypt_keys + num_rounds - i)));
+		_mm_storeu_si128(decrypt_keys + num_rounds, _mm_loadu_si128(encrypt_keys));
+	}
+
+	CL_TARGET_AES void Crypto_X86::aes_encrypt_cbc(const unsigned char *round_keys, int num_rounds, unsigned char iv[16], const unsigned char *input, unsigned char *output, int num_blocks)
+	{
+		__m128i keys[15];
+		for (int i = 0; i <= num_rounds; i++)
+			keys[i] = _mm_loadu_si128((const __m128i *)round_keys + i);
+
+		// Each block depends on the previous ciphertext, so CBC encryption cannot be interleaved
+		__m128i feedback = _mm_loadu_si128((const __m128i *)iv);
+		for (int block = 0; block < num_blocks; block++)
+		{
+			__m128i state = _mm_xor_si128(_mm_loadu_si128((const __m128i *)input + block), feedback);
+			state = _mm_xor_si128(state, keys[0]);
+			for (int round = 1; round < num_rounds; round++)
+				state = _mm_aesenc_si128(state, keys[round]);
+			feedback = _mm_aesenclast_si128(state, keys[num_rounds]);
+			_mm_storeu_si128((__m128i *)output + block, feedback);
+		}
+		_mm_storeu_si128((__m128i *)iv, feedback);
+	}
+
+	CL_TARGET_AES void Crypto_X86::aes_decrypt_cbc(const unsigned char *decrypt_round_keys, int num_rounds, unsigned char iv[16], const unsigned char *input, unsigned char *output, int num_blocks)
+	{
+		__m128i keys[15];
+		for (int i = 0; i <= num_rounds; i++)
+			keys[i] = _mm_loadu_si128((const __m128i *)decrypt_round_keys + i);
+
+		const __m128i *in = (const __m128i *)input;
+		__m128i *out = (__m128i *)output;
+		__m128i feedback = _mm_loadu_si128((const __m128i *)iv);
+
+		// The blocks decrypt independently, so eight are kept in flight to hide the latency of the round instructions
+		const int lanes = 8;
+		int block = 0;
+		for (; block + lanes <= num_blocks; block += lanes)
+		{
+			__m128i cipher[lanes];
+			__m128i state[lanes];
+			for (int i = 0; i < lanes; i++)
+			{
+				cipher[i] = _mm_loadu_si128(in + block + i);
+				state[i] = _mm_xor_si128(cipher[i], keys[0]);
+			}
+			for (int round = 1; round < num_rounds; round++)
+			{
+				for (int i = 0; i < lanes; i++)
+					state[i] = _mm_aesdec_si128(state[i], keys[round]);
+			}
+			for (int i = 0; i < lanes; i++)
+			{
+				state[i] = _mm_aesdeclast_si128(state[i], keys[num_rounds]);
+				_mm_storeu_si128(out + block + i, _mm_xor_si128(state[i], i == 0 ? feedback : cipher[i - 1]));
+			}
+			feedback = cipher[lanes - 1];
+		}
+
+		for (; block < num_blocks; block++)
+		{
+			__m128i cipher = _mm_loadu_si128(in + block);
+			__m128i state = _mm_xor_si128(cipher, keys[0]);
+			for (int round = 1; round < num_rounds; round++)
+				state = _mm_aesdec_si128(state, keys[round]);
+			state = _mm_aesdeclast_si128(state, keys[num_rounds]);
+			_mm_storeu_si128(out + block, _mm_xor_si128(state, feedback));
+			feedback = cipher;
+		}
+		_mm_storeu_si128((__m128i *)iv, feedback);
+	}
+
+#else
+
+	bool Crypto_X86::is_sha_supported()
+	{
+		return false;
+	}
+
+	bool Crypto_X86::is_aes_supported()
+	{
+		return false;
+	}
+
+	void Crypto_X86::sha1_blocks(uint32_t state[5], const unsigned char *data, int num_blocks)
+	{
+		throw Exception("SHA instructions are not available");
+	}
+
+	void Crypto_X86::sha256_blocks(uint32_t state[8], const unsigned char *data, int num_blocks)
+	{
+		throw Exception("SHA instructions are not available");
+	}
+
+	bool Crypto_X86::is_avx2_supported()
+	{
+		return false;
+	}
+
+	void Crypto_X86::sha256_multi_buffer(const void *const *data, const int *sizes, int count, unsigned char *out_hashes)
+	{
+		throw Exception("AVX2 instructions are not available");
+	}
+
+	void Crypto_X86::aes_create_decrypt_keys(const unsigned char *encrypt_round_keys, int num_rounds, unsigned char *out_decrypt_round_keys)
+	{
+		throw Exception("AES instructions are not available");
+	}
+
+	void Crypto_X86::aes_encrypt_cbc(const unsigned char *round_keys, int num_rounds, unsigned char iv[16], const unsigned char *input, unsigned char *output, int num_blocks)
+	{
+		throw Exception("AES instructions are not available");
+	}
+
+	void Crypto_X86::aes_decrypt_cbc(const unsigned char *decrypt_round_keys, int num_rounds, unsigned char iv[16], const unsigned char *input, unsigned char *output, int num_blocks)
+	{
+		throw Exception("AES instructions are not available");
+	}
+
+#endif
+}
@@ -0,0 +1,67 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+*/
+
+
+#pragma once
+
+namespace clan
+{
+	/// \brief SHA-NI and AES-NI kernels, selected at runtime by the hash and cipher implementations
+	class Crypto_X86
+	{
+	public:
+		/// \brief Returns true if the CPU supports the SHA-1 and SHA-256 instructions
+		static bool is_sha_supported();
+
+		/// \brief Returns true if the CPU supports the AES instructions
+		static bool is_aes_supported();
+
+		/// \brief Hashes 64 byte blocks into the state h0 to h4
+		static void sha1_blocks(uint32_t state[5], const unsigned char *data, int num_blocks);
+
+		/// \brief Hashes 64 byte blocks into the state h0 to h7
+		static void sha256_blocks(uint32_t state[8], const unsigned char *data, int num_blocks);
+
+		/// \brief Returns true if the CPU supports AVX2, used by the multi-buffer kernels
+		static bool is_avx2_supported();
+
+		/// \brief Hashes independent buffers with SHA-256 eight at a time using AVX2
+		///
+		/// Each of the eight lanes takes the next buffer when its current one is finished.
+		static void sha256_multi_buffer(const void *const *data, const int *sizes, int count, unsigned char *out_hashes);
+
+		/// \brief Converts the decryption round keys from the encryption round keys
+		static void aes_create_decrypt_keys(const unsigned char *encrypt_round_keys, int num_rounds, unsigned char *out_decrypt_round_keys);
+
+		/// \brief Encrypts 16 byte blocks in CBC mode, updating the initialisation vector
+		static void aes_encrypt_cbc(const unsigned char *round_keys, int num_rounds, unsigned char iv[16], const unsigned char *input, unsigned char *output, int num_blocks);
+
+		/// \brief Decrypts 16 byte blocks in CBC mode, updating the initialisation vector
+		static void aes_decrypt_cbc(const unsigned char *decrypt_round_keys, int num_rounds, unsigned char iv[16], const unsigned char *input, unsigned char *output, int num_blocks);
+	};
+}
@@ -29,7 +29,13 @@
 #include "Core/precomp.h"
 #include "API/Core/Crypto/hash_functions.h"
 #include "API/Core/System/databuffer.h"
+#include "API/Core/Math/cl_math.h"
+#include "API/Core/System/work_queue.h"
+#include "API/Core/IOData/async_file_reader.h"
 #include "Core/Zip/miniz.h"
+#include "crypto_x86.h"
+#include <atomic>
+#include <cstring>
 
 namespace clan
 {
@@ -196,6 +202,111 @@ namespace clan
 		sha256(data.data(), data.length(), out_hash);
 	}
 
+	void HashFunctions::sha256_multi(const void *const *data, const int *sizes, int count, unsigned char *out_hashes)
+	{
+		// A single buffer with the SHA instructions is faster than eight AVX2 lanes
+		if (count > 1 && !Crypto_X86::is_sha_supported() && Crypto_X86::is_avx2_supported())
+		{
+			Crypto_X86::sha256_multi_buffer(data, sizes, count, out_hashes);
+			return;
+		}
+
+		for (int i = 0; i < count; i++)
+			sha256(data[i], sizes[i], out_hashes + i * SHA256::hash_size);
+	}
+
+	void HashFunctions::sha256_multi(WorkQueue &work_queue, const void *const *data, const int *sizes, int count, unsigned char *out_hashes)
+	{
+		// Sub ranges are multiples of eight buffers, so the AVX2 lanes stay full
+		int grain = (work_queue.get_grain_size(count) + 7) / 8 * 8;
+		work_queue.parallel_for(0, count, grain, [&](int first, int last)
+		{
+			sha256_multi(data + first, sizes + first, last - first, out_hashes + first * SHA256::hash_size);
+		});
+	}
+
+	std::vector<bool> HashFunctions::sha256_files(WorkQueue &work_queue, const std::vector<std::string> &filenames, unsigned char *out_hashes, int max_files_in_flight)
+	{
+		const int chunk_size = 1024 * 1024;
+
+		struct FileHash
+		{
+			SHA256 sha256;
+			int64_t offset = 0;
+		};
+
+		int count = (int)filenames.size();
+		std::vector<FileHash> files(count);
+		std::vector<char> success(count, 0);
+		std::atomic_int next_file(0);
+		std::atomic_int callbacks_pending(0);
+		AsyncFileReader reader(work_queue);
+
+		// Each chunk is hashed in its completion callback, which then requests the next chunk of the same file,
+		// or starts the next file. A callback always requests its follow up read before it counts itself as done.
+		std::function<void(int)> read_next_chunk;
+		auto start_next_file = [&]()
+		{
+			int index = next_file++;
+			if (index < count)
+				read_next_chunk(index);
+		};
+
+		read_next_chunk = [&](int index)
+		{
+			callbacks_pending++;
+			reader.read(filenames[index], files[index].offset, chunk_size, [&, index](bool read_success, DataBuffer &data)
+			{
+				FileHash &file = files[index];
+				if (read_success)
+				{
+					file.sha256.add(data);
+					file.offset += data.get_size();
+				}
+
+				if (read_success && (int)data.get_size() == chunk_size)
+				{
+					read_next_chunk(index);
+				}
+				else
+				{
+					if (read_success)
+					{
+						file.sha256.calculate();
+						file.sha256.get_hash(out_hashes + index * SHA256::hash_size);
+						success[index] = 1;
+					}
+					start_next_file();
+				}
+				reader.submit();
+
+				// Must be the last access to local state, as the calling thread returns once no callbacks are pending
+				callbacks_pending--;
+			});
+		};
+
+		for (int i = 0; i < max(max_files_in_flight, 1) && i < count; i++)
+			start_next_file();
+		reader.submit();
+
+		work_queue.wait_until([&]() { return callbacks_pending.load() == 0; });
+		return std::vector<bool>(success.begin(), success.end());
+	}
+
+	std::vector<int> HashFunctions::sha256_verify_files(WorkQueue &work_queue, const std::vector<std::string> &filenames, const unsigned char *expected_hashes, int max_files_in_flight)
+	{
+		std::vector<unsigned char> hashes(filenames.size() * SHA256::hash_size);
+		std::vector<bool> success = sha256_files(work_queue, filenames, hashes.data(), max_files_in_flight);
+
+		std::vector<int> failed;
+		for (size_t i = 0; i < filenames.size(); i++)
+		{
+			if (!success[i] || memcmp(hashes.data() + i * SHA256::hash_size, expected_hashes + i * SHA256::hash_size, SHA256::hash_size) != 0)
+				failed.push_back((int)i);
+		}
+		return failed;
+	}
+
 
 	std::string HashFunctions::sha384(const void *data, int size, bool uppercase)
 	{
@@ -158,6 +158,13 @@ namespace clan
 		//p->to_unsigned_octets(rsa_private_key.prime1);
 		//q->to_unsigned_octets(rsa_private_key.prime2);
 
+		// Pairwise consistency test, which also checks the CRT parameters
+		BigInt test_msg((uint32_t)2), test_cipher, test_result;
+		rsaep(&test_msg, e, &n, &test_cipher);
+		rsadp_crt(&test_cipher, rsa_private_key, &test_result);
+		if (test_result.cmp(&test_msg) != 0)
+			return false;
+
 		return true;
 	}
 
@@ -208,6 +215,28 @@ namespace clan
 		cipher->exptmod(d, modulus, msg);
 	}
 
+	void RSA_Impl::rsadp_crt(BigInt *cipher, const RSAPrivateKey &key, BigInt *msg)
+	{
+		// Insure that ciphertext representative is in range of modulus
+		if ((cipher->cmp_z() < 0) || (cipher->cmp(&key.modulus) >= 0))
+		{
+			throw Exception("ciphertext is out of range of modulus");
+		}
+
+		// Two half size exponentiations, recombined using Garner's formula
+		BigInt m1, m2, h;
+		cipher->exptmod(&key.exponent1, &key.prime1, &m1);
+		cipher->exptmod(&key.exponent2, &key.prime2, &m2);
+
+		// h = coefficient * (m1 - m2) mod p
+		h = m1 - m2;
+		h = h * key.coefficient;
+		h.mod(&key.prime1, &h);
+
+		// msg = m2 + h * q
+		*msg = m2 + h * key.prime2;
+	}
+
 	void RSA_Impl::pkcs1v15_encode(int block_type, Random &random, const char *msg, int mlen, char *emsg, int emlen)
 	{
 		if (mlen > emlen - 11)
@@ -98,6 +98,9 @@ namespace clan
 		static void rsaep(BigInt *msg, const BigInt *e, const BigInt *modulus, BigInt *cipher);
 		static void rsadp(BigInt *cipher, const BigInt *d, const BigInt *modulus, BigInt *msg);
 
+		// Private key operation using the Chinese Remainder Theorem, about 3 times faster than rsadp
+		static void rsadp_crt(BigInt *cipher, const RSAPrivateKey &key, BigInt *msg);
+
 		// PKCS#1 v.1.5 message padding and encoding
 		// msg       - input message
 		// mlen      - length of input message, in bytes
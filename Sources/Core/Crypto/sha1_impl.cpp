@@ -28,6 +28,7 @@
 
 #include "Core/precomp.h"
 #include "sha1_impl.h"
+#include "crypto_x86.h"
 #include "API/Core/Math/cl_math.h"
 #include "API/Core/Crypto/sha1.h"
 
@@ -109,6 +110,15 @@ namespace clan
 		int pos = 0;
 		while (pos < size)
 		{
+			// Whole blocks are hashed straight from the input when the SHA instructions are available
+			if (chunk_filled == 0 && size - pos >= block_size && Crypto_X86::is_sha_supported())
+			{
+				int num_blocks = (size - pos) / block_size;
+				process_blocks_x86(data + pos, num_blocks);
+				pos += num_blocks * block_size;
+				continue;
+			}
+
 			int data_left = size - pos;
 			int buffer_space = block_size - chunk_filled;
 			int data_used = min(buffer_space, data_left);
@@ -207,8 +217,25 @@ namespace clan
 		}
 	}
 
+	void SHA1_Impl::process_blocks_x86(const unsigned char *data, int num_blocks)
+	{
+		uint32_t state[5] = { h0, h1, h2, h3, h4 };
+		Crypto_X86::sha1_blocks(state, data, num_blocks);
+		h0 = state[0];
+		h1 = state[1];
+		h2 = state[2];
+		h3 = state[3];
+		h4 = state[4];
+	}
+
 	void SHA1_Impl::process_chunk()
 	{
+		if (Crypto_X86::is_sha_supported())
+		{
+			process_blocks_x86(chunk, 1);
+			return;
+		}
+
 		int i;
 		unsigned int w[80];
 
@@ -47,6 +47,7 @@ namespace clan
 
 	private:
 		void process_chunk();
+		void process_blocks_x86(const unsigned char *data, int num_blocks);
 
 		inline unsigned int leftrotate_uint32(unsigned int value, int shift) const
 		{
@@ -28,6 +28,7 @@
 
 #include "Core/precomp.h"
 #include "sha256_impl.h"
+#include "crypto_x86.h"
 #include "API/Core/Math/cl_math.h"
 #include "API/Core/Crypto/sha224.h"
 #include "API/Core/Crypto/sha256.h"
@@ -159,6 +160,15 @@ namespace clan
 		int pos = 0;
 		while (pos < size)
 		{
+			// Whole blocks are hashed straight from the input when the SHA instructions are available
+			if (chunk_filled == 0 && size - pos >= block_size && Crypto_X86::is_sha_supported())
+			{
+				int num_blocks = (size - pos) / block_size;
+				process_blocks_x86(data + pos, num_blocks);
+				pos += num_blocks * block_size;
+				continue;
+			}
+
 			int data_left = size - pos;
 			int buffer_space = block_size - chunk_filled;
 			int data_used = min(buffer_space, data_left);
@@ -286,8 +296,28 @@ namespace clan
 		}
 	}
 
+	void SHA256_Impl::process_blocks_x86(const unsigned char *data, int num_blocks)
+	{
+		uint32_t state[8] = { h0, h1, h2, h3, h4, h5, h6, h7 };
+		Crypto_X86::sha256_blocks(state, data, num_blocks);
+		h0 = state[0];
+		h1 = state[1];
+		h2 = state[2];
+		h3 = state[3];
+		h4 = state[4];
+		h5 = state[5];
+		h6 = state[6];
+		h7 = state[7];
+	}
+
 	void SHA256_Impl::process_chunk()
 	{
+		if (Crypto_X86::is_sha_supported())
+		{
+			process_blocks_x86(chunk, 1);
+			return;
+		}
+
 		// Constants defined in FIPS 180-3, section 4.2.2
 		static const uint32_t constant_K[64] = {
 			0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b,
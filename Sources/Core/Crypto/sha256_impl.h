@@ -77,6 +77,7 @@ namespace clan
 		}
 
 		void process_chunk();
+		void process_blocks_x86(const unsigned char *data, int num_blocks);
 
 		uint32_t h0, h1, h2, h3, h4, h5, h6, h7;
 		const static int block_size = 64;
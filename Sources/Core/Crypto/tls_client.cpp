@@ -76,4 +76,24 @@ namespace clan
 	{
 		impl->encrypted_data_consumed(size);
 	}
+
+	bool TLSClient::is_connected() const
+	{
+		return impl->is_connected();
+	}
+
+	void TLSClient::set_session(const Secret &session)
+	{
+		impl->set_session(session);
+	}
+
+	Secret TLSClient::get_session() const
+	{
+		return impl->get_session();
+	}
+
+	bool TLSClient::is_session_resumed() const
+	{
+		return impl->is_session_resumed();
+	}
 }
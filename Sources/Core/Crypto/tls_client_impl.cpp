@@ -39,17 +39,20 @@
 #include <ctime>
 #include <algorithm>
 #include "x509.h"
+#include "x25519.h"
 #include "API/Core/Math/cl_math.h"
+#include "API/Core/Math/big_int.h"
 
 namespace clan
 {
 	TLSClient_Impl::TLSClient_Impl() :
 		recv_in_data_read_pos(0), recv_out_data_read_pos(0), send_in_data_read_pos(0), send_out_data_read_pos(0), handshake_in_read_pos(0),
-		conversation_state(cl_tls_state_send_client_hello), security_parameters(), protocol(), is_protocol_chosen()
+		conversation_state(cl_tls_state_send_client_hello), security_parameters(), protocol(), client_hello_protocol(), is_protocol_chosen(), cipher_suite(), resume_cipher_suite(), session_resumed(false)
 	{
-		// Set TLS 3.1
+		// Offer TLS 1.2 (3.3). The server may choose down to TLS 1.0 (3.1)
 		protocol.major = 3;
-		protocol.minor = 1;
+		protocol.minor = 3;
+		client_hello_protocol = protocol;
 		is_protocol_chosen = false;
 
 		create_security_parameters_client_random();
@@ -82,7 +85,10 @@ namespace clan
 	int TLSClient_Impl::encrypt(const void *data, int size)
 	{
 		if (size == 0)
+		{
+			progress_conversation();
 			return 0;
+		}
 
 		int insert_pos = send_in_data.get_size();
 		int buffer_space_available = desired_buffer_size - insert_pos;
@@ -99,7 +105,10 @@ namespace clan
 	int TLSClient_Impl::decrypt(const void *data, int size)
 	{
 		if (size == 0)
+		{
+			progress_conversation();
 			return 0;
+		}
 
 		int insert_pos = recv_in_data.get_size();
 		int buffer_space_available = desired_buffer_size - insert_pos;
@@ -151,6 +160,41 @@ namespace clan
 		progress_conversation();
 	}
 
+	void TLSClient_Impl::set_session(const Secret &session)
+	{
+		if (conversation_state != cl_tls_state_send_client_hello)
+			throw Exception("TLSClient::set_session must be called before the handshake starts");
+
+		// Layout written by get_session: cipher suite, session id length, session id, master secret
+		const unsigned char *session_ptr = session.get_data();
+		unsigned int session_size = session.get_size();
+		if (session_size < 3 || session_ptr[2] == 0 || session_ptr[2] > max_session_id_length || session_size != 3 + session_ptr[2] + security_parameters.master_secret.get_size())
+			throw Exception("Invalid TLS session");
+
+		resume_cipher_suite[0] = session_ptr[0];
+		resume_cipher_suite[1] = session_ptr[1];
+		resume_session_id = Secret(session_ptr[2]);
+		memcpy(resume_session_id.get_data(), session_ptr + 3, resume_session_id.get_size());
+		resume_master_secret = Secret(security_parameters.master_secret.get_size());
+		memcpy(resume_master_secret.get_data(), session_ptr + 3 + resume_session_id.get_size(), resume_master_secret.get_size());
+	}
+
+	Secret TLSClient_Impl::get_session() const
+	{
+		// A session can only be resumed once both sides verified the finished messages
+		if (conversation_state != cl_tls_state_connected || session_id.get_size() == 0)
+			return Secret();
+
+		Secret session(3 + session_id.get_size() + security_parameters.master_secret.get_size());
+		unsigned char *session_ptr = session.get_data();
+		session_ptr[0] = cipher_suite[0];
+		session_ptr[1] = cipher_suite[1];
+		session_ptr[2] = session_id.get_size();
+		memcpy(session_ptr + 3, session_id.get_data(), session_id.get_size());
+		memcpy(session_ptr + 3 + session_id.get_size(), security_parameters.master_secret.get_data(), security_parameters.master_secret.get_size());
+		return session;
+	}
+
 	void TLSClient_Impl::progress_conversation()
 	{
 		try
@@ -168,7 +212,8 @@ namespace clan
 					break;
 				case cl_tls_state_receive_certificate:
 					break;
-				//FIXME: Implement "7.4.3. Server key exchange message"
+				case cl_tls_state_receive_server_key_exchange:
+					break;
 				case cl_tls_state_receive_server_hello_done:
 					break;
 				// FIXME: Should be send a "client certificate message" ?
@@ -280,23 +325,14 @@ namespace clan
 			// We set the protocol version in ServerHello
 		}
 
-		record_data_buffer.set_size(record_length);
-		memcpy(record_data_buffer.get_data(), recv_in_data.get_data() + recv_in_data_read_pos + sizeof(TLS_Record), record_length);
-
-		recv_in_data_read_pos += sizeof(TLS_Record) + record_length;
-		if (recv_in_data_read_pos > desired_buffer_size / 2)
-		{
-			int available = recv_in_data.get_size() - recv_in_data_read_pos;
-			memmove(recv_in_data.get_data(), recv_in_data.get_data() + recv_in_data_read_pos, available);
-			recv_in_data.set_size(available);
-			recv_in_data_read_pos = 0;
-		}
+		// The record is processed in place in the receive buffer. The buffer must not be compacted until the handlers are done with it.
+		DataBufferView record_data(recv_in_data, recv_in_data_read_pos + sizeof(TLS_Record), record_length);
 
-		DataBuffer plaintext;
+		DataBufferView plaintext;
 		if (security_parameters.is_receive_encrypted)
-			plaintext = decrypt_record(record, record_data_buffer);
+			plaintext = decrypt_record(record, record_data);
 		else
-			plaintext = record_data_buffer;
+			plaintext = record_data;
 
 		security_parameters.read_sequence_number++;
 		if (security_parameters.read_sequence_number == 0)
@@ -326,10 +362,19 @@ namespace clan
 			break;
 		}
 
+		recv_in_data_read_pos += sizeof(TLS_Record) + record_length;
+		if (recv_in_data_read_pos > desired_buffer_size / 2)
+		{
+			int available = recv_in_data.get_size() - recv_in_data_read_pos;
+			memmove(recv_in_data.get_data(), recv_in_data.get_data() + recv_in_data_read_pos, available);
+			recv_in_data.set_size(available);
+			recv_in_data_read_pos = 0;
+		}
+
 		return true;
 	}
 
-	void TLSClient_Impl::change_cipher_spec_data(DataBuffer record_plaintext)
+	void TLSClient_Impl::change_cipher_spec_data(const DataBufferView &record_plaintext)
 	{
 		if (conversation_state != cl_tls_state_receive_change_cipher_spec)
 			throw Exception("Unexpected TLS change cipher record received");
@@ -348,12 +393,12 @@ namespace clan
 		conversation_state = cl_tls_state_receive_finished;
 	}
 
-	void TLSClient_Impl::alert_data(DataBuffer record_plaintext)
+	void TLSClient_Impl::alert_data(const DataBufferView &record_plaintext)
 	{
 		if (record_plaintext.get_size() != 2) // To do: theoretically this is not safe - it could be split into two 1 byte records.
 			throw Exception("Invalid TLS content alert message");
 
-		uint8_t *alert_data = record_plaintext.get_data<uint8_t>();
+		const uint8_t *alert_data = record_plaintext.get_data<uint8_t>();
 
 		if (alert_data[0] == cl_tls_warning)
 			return;
@@ -459,7 +504,7 @@ namespace clan
 		throw Exception(string);
 	}
 
-	void TLSClient_Impl::handshake_data(DataBuffer record_plaintext)
+	void TLSClient_Impl::handshake_data(const DataBufferView &record_plaintext)
 	{
 		// Copy handshake data into input buffer for easier processing:
 		// "RFC 2246 (5.2.1) multiple client messages of the same ContentType may be coalesced into a single TLSPlaintext record"
@@ -487,6 +532,13 @@ namespace clan
 		{
 			hash_handshake(&handshake, length + sizeof(TLS_Handshake));
 		}
+		else if (session_resumed)
+		{
+			// In an abbreviated handshake the server finished comes first and is part of the client finished hash
+			client_handshake_md5_hash.add(&handshake, length + sizeof(TLS_Handshake));
+			client_handshake_sha1_hash.add(&handshake, length + sizeof(TLS_Handshake));
+			client_handshake_sha256_hash.add(&handshake, length + sizeof(TLS_Handshake));
+		}
 
 		// Dispatch message for further parsing:
 		switch (handshake.msg_type)
@@ -535,7 +587,7 @@ namespace clan
 		}
 	}
 
-	void TLSClient_Impl::application_data(DataBuffer record_plaintext)
+	void TLSClient_Impl::application_data(const DataBufferView &record_plaintext)
 	{
 		if (conversation_state != cl_tls_state_connected)
 			throw Exception("Unexpected application data record received");
@@ -616,16 +668,39 @@ namespace clan
 
 		uint8_t session_id_length;
 		copy_data(&session_id_length, 1, data, size);
-		Secret session_id(session_id_length);
+		if (session_id_length > max_session_id_length)
+			throw Exception("TLS server hello session id too long");
+		session_id = Secret(session_id_length);
 		copy_data(session_id.get_data(), session_id_length, data, size);
 
-		int8_t buffer[3];
+		uint8_t buffer[3];
 		copy_data(buffer, 3, data, size);
 
 		select_cipher_suite(buffer[0], buffer[1]);
 		select_compression_method(buffer[2]);
 
-		conversation_state = cl_tls_state_receive_certificate;
+		if (!is_tls12() && (security_parameters.cipher_type == cl_tls_cipher_type_aead || security_parameters.key_exchange_algorithm != cl_tls_key_exchange_rsa))
+			throw Exception("TLS server chose a cipher suite that requires TLS 1.2");
+
+		// Any extensions in the server hello are ignored. We only offer extensions that need no reply
+
+		// The server echoes the offered session id when it agrees to resume the session
+		session_resumed = session_id_length > 0 && session_id_length == resume_session_id.get_size() &&
+			!memcmp(session_id.get_data(), resume_session_id.get_data(), session_id_length);
+
+		if (session_resumed)
+		{
+			if (buffer[0] != resume_cipher_suite[0] || buffer[1] != resume_cipher_suite[1])
+				throw Exception("TLS server changed cipher suite of resumed session");
+
+			memcpy(security_parameters.master_secret.get_data(), resume_master_secret.get_data(), security_parameters.master_secret.get_size());
+			create_keys();
+			conversation_state = cl_tls_state_receive_change_cipher_spec;
+		}
+		else
+		{
+			conversation_state = cl_tls_state_receive_certificate;
+		}
 	}
 
 	void TLSClient_Impl::handshake_certificate_received(const void *data, int size)
@@ -660,12 +735,44 @@ namespace clan
 			certificate_list_size -= certificate_size;
 		}
 
-		conversation_state = cl_tls_state_receive_server_hello_done;
+		if (security_parameters.key_exchange_algorithm == cl_tls_key_exchange_ecdhe_rsa)
+			conversation_state = cl_tls_state_receive_server_key_exchange;
+		else
+			conversation_state = cl_tls_state_receive_server_hello_done;
 	}
 
 	void TLSClient_Impl::handshake_server_key_exchange_received(const void *data, int size)
 	{
-		throw Exception("Unexpected server key exchange handshake message received");
+		if (conversation_state != cl_tls_state_receive_server_key_exchange)
+			throw Exception("Unexpected server key exchange handshake message received");
+
+		// RFC 4492 (5.4): ServerECDHParams followed by a signature over both randoms and the params
+		const void *params_ptr = data;
+
+		uint8_t curve_params[4];
+		copy_data(curve_params, 4, data, size);
+		if (curve_params[0] != 3 || (curve_params[1] << 8 | curve_params[2]) != cl_tls_named_curve_x25519)	// named_curve
+			throw Exception("TLS server chose an unsupported elliptic curve");
+		if (curve_params[3] != X25519::key_size)
+			throw Exception("Invalid TLS server key exchange public key");
+
+		ecdhe_server_public_key = Secret(X25519::key_size);
+		copy_data(ecdhe_server_public_key.get_data(), X25519::key_size, data, size);
+		unsigned int params_size = 4 + X25519::key_size;
+
+		uint8_t buffer[4];
+		copy_data(buffer, 4, data, size);
+		unsigned int signature_size = buffer[2] << 8 | buffer[3];
+		if (signature_size == 0 || (int)signature_size > size)
+			throw Exception("Invalid TLS server key exchange signature size");
+
+		std::vector<unsigned char> signature(signature_size);
+		copy_data(&signature[0], signature_size, data, size);
+
+		set_server_public_key();
+		verify_server_key_exchange_signature(buffer[0], buffer[1], params_ptr, params_size, signature);
+
+		conversation_state = cl_tls_state_receive_server_hello_done;
 	}
 
 	void TLSClient_Impl::handshake_certificate_request_received(const void *data, int size)
@@ -704,21 +811,13 @@ namespace clan
 
 		Secret client_verify_data(verify_data_size);
 
-		Secret md5_handshake_messages(16);
-		Secret sha1_handshake_messages(20);
-
-		server_handshake_md5_hash.calculate();
-		server_handshake_sha1_hash.calculate();
-
-		server_handshake_md5_hash.get_hash(md5_handshake_messages.get_data());
-		server_handshake_sha1_hash.get_hash(sha1_handshake_messages.get_data());
-
-		PRF(client_verify_data.get_data(), verify_data_size, security_parameters.master_secret, "server finished", md5_handshake_messages, sha1_handshake_messages);
+		Secret handshake_messages = get_handshake_hash(true);
+		PRF(client_verify_data.get_data(), verify_data_size, security_parameters.master_secret, "server finished", handshake_messages, Secret());
 
 		if (memcmp(client_verify_data.get_data(), server_verify_data.get_data(), verify_data_size))
 			throw Exception("TLS server finished verify data failed");
 
-		conversation_state = cl_tls_state_connected;
+		conversation_state = session_resumed ? cl_tls_state_send_change_cipher_spec : cl_tls_state_connected;
 	}
 
 	bool TLSClient_Impl::can_send_record() const
@@ -745,8 +844,16 @@ namespace clan
 			// "the encryption and MAC functions convert TLSCompressed.fragment structures to and from block TLSCiphertext.fragment structures."
 			const unsigned char *input_ptr = (const unsigned char *) data_ptr + sizeof(TLS_Record);
 			unsigned int input_size = data_size - sizeof(TLS_Record);
-			Secret mac = calculate_mac(data_ptr, data_size, nullptr, 0, security_parameters.write_sequence_number, security_parameters.client_write_mac_secret);	// MAC includes the header and sequence number
-			DataBuffer encrypted = encrypt_data(input_ptr , input_size, mac.get_data(), mac.get_size());
+			DataBuffer encrypted;
+			if (security_parameters.cipher_type == cl_tls_cipher_type_aead)
+			{
+				encrypted = encrypt_aead(*record_ptr, input_ptr, input_size);
+			}
+			else
+			{
+				Secret mac = calculate_mac(data_ptr, data_size, nullptr, 0, security_parameters.write_sequence_number, security_parameters.client_write_mac_secret);	// MAC includes the header and sequence number
+				encrypted = encrypt_data(input_ptr, input_size, mac.get_data(), mac.get_size());
+			}
 
 			// Update the length
 			int new_length = encrypted.get_size();
@@ -776,8 +883,10 @@ namespace clan
 
 		client_handshake_md5_hash.reset();
 		client_handshake_sha1_hash.reset();
+		client_handshake_sha256_hash.reset();
 		server_handshake_md5_hash.reset();
 		server_handshake_sha1_hash.reset();
+		server_handshake_sha256_hash.reset();
 	}
 
 	void TLSClient_Impl::copy_data(void *out_data, int size, const void *&data, int &data_left)
@@ -846,14 +955,14 @@ namespace clan
 
 	int TLSClient_Impl::get_session_id_length() const
 	{
-		// Enough to write single NUL
-		return 1;
+		// SessionID session_id<0..32>;
+		return 1 + resume_session_id.get_size();
 	}
 
 	void TLSClient_Impl::set_session_id(unsigned char *dest_ptr) const
 	{
-		// Session id's are not supported
-		*dest_ptr = 0;
+		*(dest_ptr++) = resume_session_id.get_size();
+		memcpy(dest_ptr, resume_session_id.get_data(), resume_session_id.get_size());
 	}
 
 	int TLSClient_Impl::get_compression_methods_length() const
@@ -886,27 +995,91 @@ namespace clan
 	int TLSClient_Impl::get_cipher_suites_length() const
 	{
 		// CipherSuite cipher_suites<2..2^16-1>;
-		return 2 + (4*2);	// We support 4 cipher suites, each id contains 2 bytes
+		return 2 + (7*2);	// We support 7 cipher suites, each id contains 2 bytes
 	}
 
 	void TLSClient_Impl::set_cipher_suites(unsigned char *dest_ptr) const
 	{
-		const int num_ciphers = 4;	// If changing, you MUST change get_cipher_suites_length
+		const int num_ciphers = 7;	// If changing, you MUST change get_cipher_suites_length
 		int length = num_ciphers * 2;
 		*(dest_ptr++) = length >> 8;
 		*(dest_ptr++) = length;
 
-		// Strongest first ... maybe that should be controlled by the user, strong and fast first
+		// Forward secret AEAD suites first. ChaCha20-Poly1305 leads as it is fast on CPUs without AES instructions
+		*(dest_ptr++) = 0xCC;	*(dest_ptr++) = 0xA8;	// TLS_ECDHE_RSA_WITH_CHACHA20_POLY1305_SHA256
+		*(dest_ptr++) = 0xC0;	*(dest_ptr++) = 0x2F;	// TLS_ECDHE_RSA_WITH_AES_128_GCM_SHA256
+		*(dest_ptr++) = 0x00;	*(dest_ptr++) = 0x9C;	// TLS_RSA_WITH_AES_128_GCM_SHA256
 		*(dest_ptr++) = 0x00;	*(dest_ptr++) = 0x3D;	// TLS_RSA_WITH_AES_256_CBC_SHA256
 		*(dest_ptr++) = 0x00;	*(dest_ptr++) = 0x3C;	// TLS_RSA_WITH_AES_128_CBC_SHA256
 		*(dest_ptr++) = 0x00;	*(dest_ptr++) = 0x35;	// TLS_RSA_WITH_AES_256_CBC_SHA
 		*(dest_ptr++) = 0x00;	*(dest_ptr++) = 0x2F;	// TLS_RSA_WITH_AES_128_CBC_SHA
 	}
 
+	int TLSClient_Impl::get_extensions_length() const
+	{
+		// Extension extensions<0..2^16-1>;
+		return 2 + (4 + 4) + (4 + 2) + (4 + 2 + 4*2);
+	}
+
+	void TLSClient_Impl::set_extensions(unsigned char *dest_ptr) const
+	{
+		int length = get_extensions_length() - 2;	// If changing, you MUST change get_extensions_length
+		*(dest_ptr++) = length >> 8;
+		*(dest_ptr++) = length;
+
+		// RFC 4492 (5.1.1): the curves we can do ECDHE with
+		*(dest_ptr++) = 0x00;	*(dest_ptr++) = cl_tls_extension_supported_groups;
+		*(dest_ptr++) = 0x00;	*(dest_ptr++) = 4;
+		*(dest_ptr++) = 0x00;	*(dest_ptr++) = 2;
+		*(dest_ptr++) = 0x00;	*(dest_ptr++) = cl_tls_named_curve_x25519;
+
+		// RFC 4492 (5.1.2): uncompressed points only
+		*(dest_ptr++) = 0x00;	*(dest_ptr++) = cl_tls_extension_ec_point_formats;
+		*(dest_ptr++) = 0x00;	*(dest_ptr++) = 2;
+		*(dest_ptr++) = 1;
+		*(dest_ptr++) = 0;
+
+		// RFC 5246 (7.4.1.4.1): the signatures we can verify in the server key exchange
+		*(dest_ptr++) = 0x00;	*(dest_ptr++) = cl_tls_extension_signature_algorithms;
+		*(dest_ptr++) = 0x00;	*(dest_ptr++) = 2 + 4*2;
+		*(dest_ptr++) = 0x00;	*(dest_ptr++) = 4*2;
+		*(dest_ptr++) = cl_tls_hash_algorithm_sha256;	*(dest_ptr++) = cl_tls_signature_algorithm_rsa;
+		*(dest_ptr++) = cl_tls_hash_algorithm_sha384;	*(dest_ptr++) = cl_tls_signature_algorithm_rsa;
+		*(dest_ptr++) = cl_tls_hash_algorithm_sha512;	*(dest_ptr++) = cl_tls_signature_algorithm_rsa;
+		*(dest_ptr++) = cl_tls_hash_algorithm_sha1;	*(dest_ptr++) = cl_tls_signature_algorithm_rsa;
+	}
+
 	void TLSClient_Impl::select_cipher_suite(uint8_t value1, uint8_t value2)
 	{
-		if (value1 == 0)
+		cipher_suite[0] = value1;
+		cipher_suite[1] = value2;
+
+		if (value1 == 0xCC && value2 == 0xA8)	// TLS_ECDHE_RSA_WITH_CHACHA20_POLY1305_SHA256
+		{
+			security_parameters.key_exchange_algorithm = cl_tls_key_exchange_ecdhe_rsa;
+			security_parameters.cipher_type = cl_tls_cipher_type_aead;
+			security_parameters.mac_algorithm = cl_tls_mac_algorithm_null;
+			security_parameters.bulk_cipher_algorithm = cl_tls_cipher_algorithm_chacha20_poly1305;
+			security_parameters.hash_size = 0;
+			security_parameters.iv_size = ChaCha20_Poly1305::nonce_size;
+			security_parameters.record_iv_size = 0;
+			security_parameters.key_material_length = ChaCha20_Poly1305::key_size;
+		}
+		else if ((value1 == 0xC0 && value2 == 0x2F) || (value1 == 0x00 && value2 == 0x9C))	// TLS_ECDHE_RSA_WITH_AES_128_GCM_SHA256, TLS_RSA_WITH_AES_128_GCM_SHA256
 		{
+			security_parameters.key_exchange_algorithm = value1 == 0xC0 ? cl_tls_key_exchange_ecdhe_rsa : cl_tls_key_exchange_rsa;
+			security_parameters.cipher_type = cl_tls_cipher_type_aead;
+			security_parameters.mac_algorithm = cl_tls_mac_algorithm_null;
+			security_parameters.bulk_cipher_algorithm = cl_tls_cipher_algorithm_aes128_gcm;
+			security_parameters.hash_size = 0;
+			security_parameters.iv_size = 4;	// RFC 5288 (3): the salt part of the nonce
+			security_parameters.record_iv_size = 8;
+			security_parameters.key_material_length = AES128_Encrypt::key_size;
+		}
+		else if (value1 == 0)
+		{
+			security_parameters.key_exchange_algorithm = cl_tls_key_exchange_rsa;
+			security_parameters.cipher_type = cl_tls_cipher_type_block;
 			switch (value2)
 			{
 				case 0x3D:	// TLS_RSA_WITH_AES_256_CBC_SHA256
@@ -949,6 +1122,7 @@ namespace clan
 				default:
 					throw Exception("TLS unsupported cipher suite");
 			}
+			security_parameters.record_iv_size = is_explicit_iv() ? security_parameters.iv_size : 0;
 		}
 		else
 		{
@@ -969,6 +1143,7 @@ namespace clan
 		int offset_tls_session_id = offset;				offset += get_session_id_length();
 		int offset_tls_cipher_suites = offset;			offset += get_cipher_suites_length();
 		int offset_tls_compression_methods = offset;	offset += get_compression_methods_length();
+		int offset_tls_extensions = offset;				offset += get_extensions_length();
 
 		Secret message(offset);	// keep data secure
 		unsigned char *message_ptr = message.get_data();
@@ -980,6 +1155,7 @@ namespace clan
 		set_session_id(message_ptr + offset_tls_session_id);
 		set_cipher_suites(message_ptr + offset_tls_cipher_suites);
 		set_compression_methods(message_ptr + offset_tls_compression_methods);
+		set_extensions(message_ptr + offset_tls_extensions);
 
 		hash_handshake( message_ptr + offset_tls_handshake, offset - offset_tls_handshake);
 
@@ -1000,23 +1176,81 @@ namespace clan
 		if (!can_send_record())
 			return false;
 
-		// If RSA is being used for key agreement and authentication, the
-		// client generates a 48-byte premaster secret, encrypts it using
-		// the public key from the server's certificate or the temporary RSA
-		// key provided in a server key exchange message, and sends the
-		// result in an encrypted premaster secret message. This structure
-		// is a variant of the client key exchange message, not a message in
-		// itself.
-		Secret pre_master_secret(48);
-		unsigned char *pms_ptr = pre_master_secret.get_data();
-		m_Random.get_random_bytes(pms_ptr + 2, 46);
-		pms_ptr[0] = protocol.major;	// Version number
-		pms_ptr[1] = protocol.minor;
-
-		DataBuffer wrapped_pre_master_secret = RSA::encrypt(2, m_Random, server_public_exponent,  server_public_modulus, pre_master_secret);
+		Secret pre_master_secret;
+		DataBuffer exchange_keys;
+		int exchange_keys_length_size;
+
+		if (security_parameters.key_exchange_algorithm == cl_tls_key_exchange_ecdhe_rsa)
+		{
+			// RFC 4492 (5.7): send our ephemeral public key, the premaster secret is the shared secret
+			Secret private_key(X25519::key_size);
+			m_Random.get_random_bytes(private_key.get_data(), private_key.get_size());
+
+			exchange_keys = DataBuffer(X25519::key_size);
+			X25519::public_key(private_key.get_data(), (unsigned char *)exchange_keys.get_data());
+
+			pre_master_secret = Secret(X25519::key_size);
+			if (!X25519::shared_secret(private_key.get_data(), ecdhe_server_public_key.get_data(), pre_master_secret.get_data()))
+				throw Exception("Invalid TLS server key exchange public key");
+
+			exchange_keys_length_size = 1;
+		}
+		else
+		{
+			// If RSA is being used for key agreement and authentication, the
+			// client generates a 48-byte premaster secret, encrypts it using
+			// the public key from the server's certificate or the temporary RSA
+			// key provided in a server key exchange message, and sends the
+			// result in an encrypted premaster secret message. This structure
+			// is a variant of the client key exchange message, not a message in
+			// itself.
+			pre_master_secret = Secret(48);
+			unsigned char *pms_ptr = pre_master_secret.get_data();
+			m_Random.get_random_bytes(pms_ptr + 2, 46);
+			pms_ptr[0] = client_hello_protocol.major;	// Version number offered in the client hello
+			pms_ptr[1] = client_hello_protocol.minor;
+
+			exchange_keys = RSA::encrypt(2, m_Random, server_public_exponent,  server_public_modulus, pre_master_secret);
+			exchange_keys_length_size = 2;
+		}
 
 		PRF(security_parameters.master_secret.get_data(), security_parameters.master_secret.get_size(), pre_master_secret, "master secret", security_parameters.client_random, security_parameters.server_random);
+		create_keys();
 
+		const int exchange_keys_length = exchange_keys.get_size();
+
+		int offset = 0;
+		int offset_tls_record = offset;					offset += sizeof(TLS_Record);
+		int offset_tls_handshake = offset;				offset += sizeof(TLS_Handshake);
+		int offset_tls_exchange_keys_length = offset;	offset+= exchange_keys_length_size;
+		int offset_tls_exchange_keys = offset;			offset+= exchange_keys_length;
+
+		Secret message(offset);	// keep data secure
+		unsigned char *message_ptr = message.get_data();
+		set_tls_record(message_ptr + offset_tls_record, cl_tls_content_handshake, offset - offset_tls_record);
+		set_tls_handshake(message_ptr + offset_tls_handshake, cl_tls_handshake_client_key_exchange, offset - offset_tls_handshake);
+
+		memcpy(message_ptr + offset_tls_exchange_keys, exchange_keys.get_data(), exchange_keys_length);
+		if (exchange_keys_length_size == 2)
+		{
+			message_ptr[offset_tls_exchange_keys_length] = exchange_keys_length >> 8;
+			message_ptr[offset_tls_exchange_keys_length+1] = exchange_keys_length;
+		}
+		else
+		{
+			message_ptr[offset_tls_exchange_keys_length] = exchange_keys_length;
+		}
+
+		hash_handshake( message_ptr + offset_tls_handshake, offset - offset_tls_handshake);
+
+		send_record(message_ptr, offset);
+
+		conversation_state = cl_tls_state_send_change_cipher_spec;
+		return true;
+	}
+
+	void TLSClient_Impl::create_keys()
+	{
 		Secret key_block( 2 * (security_parameters.hash_size + security_parameters.key_material_length + security_parameters.iv_size ) );
 		PRF(key_block.get_data(), key_block.get_size(), security_parameters.master_secret, "key expansion", security_parameters.server_random, security_parameters.client_random);
 
@@ -1047,33 +1281,27 @@ namespace clan
 		memcpy(security_parameters.server_write_iv.get_data(), key_block_ptr, security_parameters.server_write_iv.get_size());
 		key_block_ptr+=security_parameters.server_write_iv.get_size();
 
-		const int wrapped_pre_master_secret_length = wrapped_pre_master_secret.get_size();
-
-		int offset = 0;
-		int offset_tls_record = offset;					offset += sizeof(TLS_Record);
-		int offset_tls_handshake = offset;				offset += sizeof(TLS_Handshake);
-		int offset_tls_encrypted_pre_master_secret_length = offset;	offset+= 2;
-		int offset_tls_encrypted_pre_master_secret = offset;	offset+= wrapped_pre_master_secret_length;
-
-		Secret message(offset);	// keep data secure
-		unsigned char *message_ptr = message.get_data();
-		set_tls_record(message_ptr + offset_tls_record, cl_tls_content_handshake, offset - offset_tls_record);
-		set_tls_handshake(message_ptr + offset_tls_handshake, cl_tls_handshake_client_key_exchange, offset - offset_tls_handshake);
-
-		memcpy(message_ptr + offset_tls_encrypted_pre_master_secret, wrapped_pre_master_secret.get_data(), wrapped_pre_master_secret_length);
-		message_ptr[offset_tls_encrypted_pre_master_secret_length] = wrapped_pre_master_secret_length >> 8;
-		message_ptr[offset_tls_encrypted_pre_master_secret_length+1] = wrapped_pre_master_secret_length;
-
-		hash_handshake( message_ptr + offset_tls_handshake, offset - offset_tls_handshake);
-
-		send_record(message_ptr, offset);
-
-		conversation_state = cl_tls_state_send_change_cipher_spec;
-		return true;
+		// The AEAD ciphers are keyed once here instead of for every record
+		if (security_parameters.bulk_cipher_algorithm == cl_tls_cipher_algorithm_aes128_gcm || security_parameters.bulk_cipher_algorithm == cl_tls_cipher_algorithm_aes256_gcm)
+		{
+			security_parameters.client_write_gcm.reset(new AES_GCM(security_parameters.client_write_key.get_data(), security_parameters.client_write_key.get_size()));
+			security_parameters.server_write_gcm.reset(new AES_GCM(security_parameters.server_write_key.get_data(), security_parameters.server_write_key.get_size()));
+		}
+		else if (security_parameters.bulk_cipher_algorithm == cl_tls_cipher_algorithm_chacha20_poly1305)
+		{
+			security_parameters.client_write_chacha.reset(new ChaCha20_Poly1305(security_parameters.client_write_key.get_data()));
+			security_parameters.server_write_chacha.reset(new ChaCha20_Poly1305(security_parameters.server_write_key.get_data()));
+		}
 	}
 
 	void TLSClient_Impl::PRF(void *output_ptr, unsigned int output_size, const Secret &secret, const char *label_ptr, const Secret &seed_part1, const Secret &seed_part2)
 	{
+		if (is_tls12())
+		{
+			PRF_SHA256(output_ptr, output_size, secret, label_ptr, seed_part1, seed_part2);
+			return;
+		}
+
 		const uint8_t *secret_part1 = secret.get_data();
 		int secret_length = secret.get_size();
 		int split_length = secret_length / 2;
@@ -1160,6 +1388,63 @@ namespace clan
 
 	}
 
+	void TLSClient_Impl::PRF_SHA256(void *output_ptr, unsigned int output_size, const Secret &secret, const char *label_ptr, const Secret &seed_part1, const Secret &seed_part2)
+	{
+		// RFC 5246 (5): P_SHA256(secret, label + seed)
+		int label_length = strlen(label_ptr);
+
+		Secret output_a(SHA256::hash_size);
+		Secret output_b(SHA256::hash_size);
+
+		SHA256 sha256;
+		sha256.set_hmac(secret.get_data(), secret.get_size());
+		sha256.add(label_ptr, label_length);
+		sha256.add(seed_part1.get_data(), seed_part1.get_size());
+		sha256.add(seed_part2.get_data(), seed_part2.get_size());
+		sha256.calculate();
+		sha256.get_hash(output_a.get_data());
+
+		unsigned char *out_ptr = (unsigned char *) output_ptr;
+		for (unsigned int pos = 0; pos < output_size; pos += SHA256::hash_size)
+		{
+			sha256.set_hmac(secret.get_data(), secret.get_size());
+			sha256.add(output_a.get_data(), output_a.get_size());
+			sha256.add(label_ptr, label_length);
+			sha256.add(seed_part1.get_data(), seed_part1.get_size());
+			sha256.add(seed_part2.get_data(), seed_part2.get_size());
+			sha256.calculate();
+			sha256.get_hash(output_b.get_data());
+
+			memcpy(out_ptr + pos, output_b.get_data(), clan::min(output_size - pos, (unsigned int)SHA256::hash_size));
+
+			sha256.set_hmac(secret.get_data(), secret.get_size());
+			sha256.add(output_a.get_data(), output_a.get_size());
+			sha256.calculate();
+			sha256.get_hash(output_a.get_data());
+		}
+	}
+
+	Secret TLSClient_Impl::get_handshake_hash(bool server_finished)
+	{
+		if (is_tls12())
+		{
+			SHA256 &sha256 = server_finished ? server_handshake_sha256_hash : client_handshake_sha256_hash;
+			Secret handshake_messages(SHA256::hash_size);
+			sha256.calculate();
+			sha256.get_hash(handshake_messages.get_data());
+			return handshake_messages;
+		}
+
+		MD5 &md5 = server_finished ? server_handshake_md5_hash : client_handshake_md5_hash;
+		SHA1 &sha1 = server_finished ? server_handshake_sha1_hash : client_handshake_sha1_hash;
+		Secret handshake_messages(MD5::hash_size + SHA1::hash_size);
+		md5.calculate();
+		sha1.calculate();
+		md5.get_hash(handshake_messages.get_data());
+		sha1.get_hash(handshake_messages.get_data() + MD5::hash_size);
+		return handshake_messages;
+	}
+
 	void TLSClient_Impl::set_server_public_key()
 	{
 		if (certificate_chain.empty())
@@ -1209,21 +1494,13 @@ namespace clan
 		set_tls_record(message_ptr + offset_tls_record, cl_tls_content_handshake, offset - offset_tls_record);
 		set_tls_handshake(message_ptr + offset_tls_handshake, cl_tls_handshake_finished, offset - offset_tls_handshake);
 
-		Secret md5_handshake_messages(MD5::hash_size);
-		Secret sha1_handshake_messages(SHA1::hash_size);
-
-		client_handshake_md5_hash.calculate();
-		client_handshake_sha1_hash.calculate();
-
-		client_handshake_md5_hash.get_hash(md5_handshake_messages.get_data());
-		client_handshake_sha1_hash.get_hash(sha1_handshake_messages.get_data());
-
-		PRF(message_ptr + offset_tls_finished, verify_data_size, security_parameters.master_secret, "client finished", md5_handshake_messages, sha1_handshake_messages);
+		Secret handshake_messages = get_handshake_hash(false);
+		PRF(message_ptr + offset_tls_finished, verify_data_size, security_parameters.master_secret, "client finished", handshake_messages, Secret());
 
 		hash_handshake( message_ptr + offset_tls_handshake, offset - offset_tls_handshake);
 		send_record(message_ptr, offset);
 
-		conversation_state = cl_tls_state_receive_change_cipher_spec;
+		conversation_state = session_resumed ? cl_tls_state_connected : cl_tls_state_receive_change_cipher_spec;
 		return true;
 	}
 
@@ -1232,6 +1509,10 @@ namespace clan
 		int additional_unpadded_blocks;
 		m_Random.get_random_bool() ? additional_unpadded_blocks = 1 : additional_unpadded_blocks = 0;
 
+		// TLS 1.1 and later use a fresh random IV for every record, sent in front of the ciphertext
+		if (security_parameters.record_iv_size > 0)
+			m_Random.get_random_bytes(security_parameters.client_write_iv.get_data(), security_parameters.client_write_iv.get_size());
+
 		DataBuffer buffer;
 		if (security_parameters.bulk_cipher_algorithm == cl_tls_cipher_algorithm_aes128)
 		{
@@ -1259,6 +1540,14 @@ namespace clan
 		{
 			throw Exception("Unsupported cipher");
 		}
+		if (security_parameters.record_iv_size > 0)
+		{
+			DataBuffer record(security_parameters.record_iv_size + buffer.get_size());
+			memcpy(record.get_data(), security_parameters.client_write_iv.get_data(), security_parameters.record_iv_size);
+			memcpy(record.get_data() + security_parameters.record_iv_size, buffer.get_data(), buffer.get_size());
+			return record;
+		}
+
 		memcpy(security_parameters.client_write_iv.get_data(), buffer.get_data() + buffer.get_size() - security_parameters.client_write_iv.get_size(), security_parameters.client_write_iv.get_size());
 		return buffer;
 
@@ -1315,12 +1604,23 @@ namespace clan
 	{
 		client_handshake_md5_hash.add(data_ptr, data_size);
 		client_handshake_sha1_hash.add(data_ptr, data_size);
+		client_handshake_sha256_hash.add(data_ptr, data_size);
 		server_handshake_md5_hash.add(data_ptr, data_size);
 		server_handshake_sha1_hash.add(data_ptr, data_size);
+		server_handshake_sha256_hash.add(data_ptr, data_size);
 	}
 
 	DataBuffer TLSClient_Impl::decrypt_data(const void *data_ptr, unsigned int data_size)
 	{
+		if (security_parameters.record_iv_size > 0)
+		{
+			if (data_size <= security_parameters.record_iv_size)
+				throw Exception("Invalid TLS record size");
+			memcpy(security_parameters.server_write_iv.get_data(), data_ptr, security_parameters.record_iv_size);
+			data_ptr = (const unsigned char *) data_ptr + security_parameters.record_iv_size;
+			data_size -= security_parameters.record_iv_size;
+		}
+
 		DataBuffer buffer;
 		if (security_parameters.bulk_cipher_algorithm == cl_tls_cipher_algorithm_aes128)
 		{
@@ -1353,8 +1653,11 @@ namespace clan
 
 	}
 
-	DataBuffer TLSClient_Impl::decrypt_record(TLS_Record &record, const DataBuffer &record_data)
+	DataBuffer TLSClient_Impl::decrypt_record(TLS_Record &record, const DataBufferView &record_data)
 	{
+		if (security_parameters.cipher_type == cl_tls_cipher_type_aead)
+			return decrypt_aead(record, record_data);
+
 		DataBuffer decrypted = decrypt_data(record_data.get_data(), record_data.get_size());
 
 		unsigned char *decrypted_data = (unsigned char *) decrypted.get_data();
@@ -1375,4 +1678,185 @@ namespace clan
 		decrypted.set_size(decoded_size);
 		return decrypted;
 	}
+
+	void TLSClient_Impl::create_aead_nonce(const Secret &write_iv, uint64_t sequence_number, unsigned char *out_nonce) const
+	{
+		if (security_parameters.record_iv_size > 0)
+		{
+			// RFC 5288 (3): implicit salt followed by the explicit nonce. We use the sequence number as explicit nonce
+			memcpy(out_nonce, write_iv.get_data(), write_iv.get_size());
+			for (int i = 0; i < 8; i++)
+				out_nonce[write_iv.get_size() + i] = (unsigned char)(sequence_number >> (56 - i * 8));
+		}
+		else
+		{
+			// RFC 7905 (2): the IV XOR the padded sequence number
+			memcpy(out_nonce, write_iv.get_data(), write_iv.get_size());
+			for (int i = 0; i < 8; i++)
+				out_nonce[write_iv.get_size() - 8 + i] ^= (unsigned char)(sequence_number >> (56 - i * 8));
+		}
+	}
+
+	void TLSClient_Impl::create_aead_additional_data(const TLS_Record &record, unsigned int plaintext_size, uint64_t sequence_number, unsigned char *out_additional_data) const
+	{
+		// RFC 5246 (6.2.3.3): seq_num + TLSCompressed.type + TLSCompressed.version + TLSCompressed.length
+		for (int i = 0; i < 8; i++)
+			out_additional_data[i] = (unsigned char)(sequence_number >> (56 - i * 8));
+		out_additional_data[8] = record.type;
+		out_additional_data[9] = record.version.major;
+		out_additional_data[10] = record.version.minor;
+		out_additional_data[11] = plaintext_size >> 8;
+		out_additional_data[12] = plaintext_size;
+	}
+
+	DataBuffer TLSClient_Impl::encrypt_aead(const TLS_Record &record, const void *data_ptr, unsigned int data_size)
+	{
+		const int tag_size = 16;
+		unsigned char nonce[12];
+		unsigned char additional_data[13];
+		create_aead_nonce(security_parameters.client_write_iv, security_parameters.write_sequence_number, nonce);
+		create_aead_additional_data(record, data_size, security_parameters.write_sequence_number, additional_data);
+
+		DataBuffer buffer(security_parameters.record_iv_size + data_size + tag_size);
+		unsigned char *buffer_ptr = (unsigned char *) buffer.get_data();
+		memcpy(buffer_ptr, nonce + security_parameters.iv_size, security_parameters.record_iv_size);
+		unsigned char *ciphertext_ptr = buffer_ptr + security_parameters.record_iv_size;
+
+		if (security_parameters.client_write_gcm)
+			security_parameters.client_write_gcm->encrypt(nonce, additional_data, sizeof(additional_data), data_ptr, data_size, ciphertext_ptr, ciphertext_ptr + data_size);
+		else if (security_parameters.client_write_chacha)
+			security_parameters.client_write_chacha->encrypt(nonce, additional_data, sizeof(additional_data), data_ptr, data_size, ciphertext_ptr, ciphertext_ptr + data_size);
+		else
+			throw Exception("Unsupported cipher");
+
+		return buffer;
+	}
+
+	DataBuffer TLSClient_Impl::decrypt_aead(TLS_Record &record, const DataBufferView &record_data)
+	{
+		const int tag_size = 16;
+		int decoded_size = record_data.get_size() - security_parameters.record_iv_size - tag_size;
+		if (decoded_size < 0)
+			throw Exception("Invalid decoded_size");
+
+		const unsigned char *record_ptr = record_data.get_data<unsigned char>();
+		const unsigned char *ciphertext_ptr = record_ptr + security_parameters.record_iv_size;
+
+		unsigned char nonce[12];
+		unsigned char additional_data[13];
+		create_aead_nonce(security_parameters.server_write_iv, security_parameters.read_sequence_number, nonce);
+		memcpy(nonce + security_parameters.iv_size, record_ptr, security_parameters.record_iv_size);	// Explicit nonce chosen by the server
+		create_aead_additional_data(record, decoded_size, security_parameters.read_sequence_number, additional_data);
+
+		DataBuffer decrypted(decoded_size);
+		bool authentic;
+		if (security_parameters.server_write_gcm)
+			authentic = security_parameters.server_write_gcm->decrypt(nonce, additional_data, sizeof(additional_data), ciphertext_ptr, decoded_size, decrypted.get_data(), ciphertext_ptr + decoded_size);
+		else if (security_parameters.server_write_chacha)
+			authentic = security_parameters.server_write_chacha->decrypt(nonce, additional_data, sizeof(additional_data), ciphertext_ptr, decoded_size, decrypted.get_data(), ciphertext_ptr + decoded_size);
+		else
+			throw Exception("Unsupported cipher");
+
+		if (!authentic)
+			throw Exception("AEAD authentication failed");
+
+		record.length[0] = decoded_size >> 8;
+		record.length[1] = decoded_size;
+		return decrypted;
+	}
+
+	void TLSClient_Impl::verify_server_key_exchange_signature(uint8_t hash_algorithm, uint8_t signature_algorithm, const void *params_ptr, unsigned int params_size, const std::vector<unsigned char> &signature)
+	{
+		if (signature_algorithm != cl_tls_signature_algorithm_rsa)
+			throw Exception("TLS server key exchange uses an unsupported signature algorithm");
+
+		// RFC 3447 (9.2): DER encoded DigestInfo prefixes
+		static const unsigned char sha1_prefix[] = { 0x30, 0x21, 0x30, 0x09, 0x06, 0x05, 0x2b, 0x0e, 0x03, 0x02, 0x1a, 0x05, 0x00, 0x04, 0x14 };
+		static const unsigned char sha256_prefix[] = { 0x30, 0x31, 0x30, 0x0d, 0x06, 0x09, 0x60, 0x86, 0x48, 0x01, 0x65, 0x03, 0x04, 0x02, 0x01, 0x05, 0x00, 0x04, 0x20 };
+		static const unsigned char sha384_prefix[] = { 0x30, 0x41, 0x30, 0x0d, 0x06, 0x09, 0x60, 0x86, 0x48, 0x01, 0x65, 0x03, 0x04, 0x02, 0x02, 0x05, 0x00, 0x04, 0x30 };
+		static const unsigned char sha512_prefix[] = { 0x30, 0x51, 0x30, 0x0d, 0x06, 0x09, 0x60, 0x86, 0x48, 0x01, 0x65, 0x03, 0x04, 0x02, 0x03, 0x05, 0x00, 0x04, 0x40 };
+
+		// The signature covers ClientHello.random + ServerHello.random + ServerECDHParams
+		std::vector<unsigned char> digest_info;
+		switch (hash_algorithm)
+		{
+			case cl_tls_hash_algorithm_sha1:
+			{
+				SHA1 sha1;
+				sha1.add(security_parameters.client_random.get_data(), security_parameters.client_random.get_size());
+				sha1.add(security_parameters.server_random.get_data(), security_parameters.server_random.get_size());
+				sha1.add(params_ptr, params_size);
+				sha1.calculate();
+				digest_info.assign(sha1_prefix, sha1_prefix + sizeof(sha1_prefix));
+				digest_info.resize(sizeof(sha1_prefix) + SHA1::hash_size);
+				sha1.get_hash(&digest_info[sizeof(sha1_prefix)]);
+				break;
+			}
+			case cl_tls_hash_algorithm_sha256:
+			{
+				SHA256 sha256;
+				sha256.add(security_parameters.client_random.get_data(), security_parameters.client_random.get_size());
+				sha256.add(security_parameters.server_random.get_data(), security_parameters.server_random.get_size());
+				sha256.add(params_ptr, params_size);
+				sha256.calculate();
+				digest_info.assign(sha256_prefix, sha256_prefix + sizeof(sha256_prefix));
+				digest_info.resize(sizeof(sha256_prefix) + SHA256::hash_size);
+				sha256.get_hash(&digest_info[sizeof(sha256_prefix)]);
+				break;
+			}
+			case cl_tls_hash_algorithm_sha384:
+			{
+				SHA384 sha384;
+				sha384.add(security_parameters.client_random.get_data(), security_parameters.client_random.get_size());
+				sha384.add(security_parameters.server_random.get_data(), security_parameters.server_random.get_size());
+				sha384.add(params_ptr, params_size);
+				sha384.calculate();
+				digest_info.assign(sha384_prefix, sha384_prefix + sizeof(sha384_prefix));
+				digest_info.resize(sizeof(sha384_prefix) + SHA384::hash_size);
+				sha384.get_hash(&digest_info[sizeof(sha384_prefix)]);
+				break;
+			}
+			case cl_tls_hash_algorithm_sha512:
+			{
+				SHA512 sha512;
+				sha512.add(security_parameters.client_random.get_data(), security_parameters.client_random.get_size());
+				sha512.add(security_parameters.server_random.get_data(), security_parameters.server_random.get_size());
+				sha512.add(params_ptr, params_size);
+				sha512.calculate();
+				digest_info.assign(sha512_prefix, sha512_prefix + sizeof(sha512_prefix));
+				digest_info.resize(sizeof(sha512_prefix) + SHA512::hash_size);
+				sha512.get_hash(&digest_info[sizeof(sha512_prefix)]);
+				break;
+			}
+			default:
+				throw Exception("TLS server key exchange uses an unsupported hash algorithm");
+		}
+
+		BigInt modulus;
+		modulus.read_unsigned_octets((const unsigned char *)server_public_modulus.get_data(), server_public_modulus.get_size());
+		BigInt exponent;
+		exponent.read_unsigned_octets((const unsigned char *)server_public_exponent.get_data(), server_public_exponent.get_size());
+
+		unsigned int k = modulus.unsigned_octet_size();
+		if (signature.size() != k || k < digest_info.size() + 11)
+			throw Exception("Invalid TLS server key exchange signature size");
+
+		BigInt signature_value;
+		signature_value.read_unsigned_octets(&signature[0], signature.size());
+		BigInt message;
+		signature_value.exptmod(&exponent, &modulus, &message);
+
+		std::vector<unsigned char> encoded_message(k);
+		message.to_unsigned_octets(&encoded_message[0], k);
+
+		// RFC 3447 (8.2.2): compare against EMSA-PKCS1-v1_5 encoding 0x00 0x01 0xFF... 0x00 DigestInfo
+		std::vector<unsigned char> expected_message(k, 0xff);
+		expected_message[0] = 0x00;
+		expected_message[1] = 0x01;
+		expected_message[k - digest_info.size() - 1] = 0x00;
+		memcpy(&expected_message[k - digest_info.size()], &digest_info[0], digest_info.size());
+
+		if (encoded_message != expected_message)
+			throw Exception("TLS server key exchange signature verification failed");
+	}
 }
@@ -29,6 +29,7 @@
 #pragma once
 
 #include "API/Core/System/databuffer.h"
+#include "API/Core/System/databuffer_view.h"
 #include "API/Core/IOData/iodevice.h"
 #include "API/Core/IOData/iodevice_provider.h"
 #include "API/Core/Crypto/secret.h"
@@ -36,6 +37,9 @@
 #include "API/Core/Crypto/rsa.h"
 #include "API/Core/Crypto/hash_functions.h"
 #include "x509.h"
+#include "aes_gcm.h"
+#include "chacha20_poly1305.h"
+#include <memory>
 
 namespace clan
 {
@@ -54,13 +58,23 @@ namespace clan
 		cl_tls_cipher_algorithm_3des,
 		cl_tls_cipher_algorithm_des40,
 		cl_tls_cipher_algorithm_aes128,
-		cl_tls_cipher_algorithm_aes256
+		cl_tls_cipher_algorithm_aes256,
+		cl_tls_cipher_algorithm_aes128_gcm,
+		cl_tls_cipher_algorithm_aes256_gcm,
+		cl_tls_cipher_algorithm_chacha20_poly1305
 	};
 
 	enum TLS_CipherType
 	{
 		cl_tls_cipher_type_stream,
-		cl_tls_cipher_type_block
+		cl_tls_cipher_type_block,
+		cl_tls_cipher_type_aead
+	};
+
+	enum TLS_KeyExchangeAlgorithm
+	{
+		cl_tls_key_exchange_rsa,
+		cl_tls_key_exchange_ecdhe_rsa
 	};
 
 	enum TLS_MACAlgorithm
@@ -71,6 +85,31 @@ namespace clan
 		cl_tls_mac_algorithm_sha256
 	};
 
+	enum TLS_HashAlgorithm
+	{
+		cl_tls_hash_algorithm_sha1 = 2,
+		cl_tls_hash_algorithm_sha256 = 4,
+		cl_tls_hash_algorithm_sha384 = 5,
+		cl_tls_hash_algorithm_sha512 = 6
+	};
+
+	enum TLS_SignatureAlgorithm
+	{
+		cl_tls_signature_algorithm_rsa = 1
+	};
+
+	enum TLS_ExtensionType
+	{
+		cl_tls_extension_supported_groups = 10,
+		cl_tls_extension_ec_point_formats = 11,
+		cl_tls_extension_signature_algorithms = 13
+	};
+
+	enum TLS_NamedCurve
+	{
+		cl_tls_named_curve_x25519 = 29
+	};
+
 	enum TLS_CompressionMethod
 	{
 		cl_tls_compression_null = 0
@@ -165,9 +204,11 @@ namespace clan
 			entity = cl_tls_connection_client;
 			bulk_cipher_algorithm = cl_tls_cipher_algorithm_null;
 			cipher_type = cl_tls_cipher_type_block;
+			key_exchange_algorithm = cl_tls_key_exchange_rsa;
 			key_size = 0;
 			key_material_length = 0;
 			iv_size = 0;
+			record_iv_size = 0;
 			is_exportable = false;
 			mac_algorithm = cl_tls_mac_algorithm_null;
 			hash_size = 0;
@@ -184,6 +225,10 @@ namespace clan
 			server_write_key = Secret();
 			client_write_iv = Secret();
 			server_write_iv = Secret();
+			client_write_gcm.reset();
+			server_write_gcm.reset();
+			client_write_chacha.reset();
+			server_write_chacha.reset();
 			read_sequence_number = 0;
 			write_sequence_number = 0;
 		}
@@ -191,9 +236,11 @@ namespace clan
 		TLS_ConnectionEnd entity;
 		TLS_BulkCipherAlgorithm bulk_cipher_algorithm;
 		TLS_CipherType cipher_type;
+		TLS_KeyExchangeAlgorithm key_exchange_algorithm;
 		uint8_t key_size;
 		uint8_t key_material_length;
-		uint8_t iv_size;
+		uint8_t iv_size;		// Block cipher IV, or the implicit part of the AEAD nonce
+		uint8_t record_iv_size;	// Explicit IV or nonce sent in front of every record
 		bool is_exportable;
 		TLS_MACAlgorithm mac_algorithm;
 		uint8_t hash_size;
@@ -208,6 +255,10 @@ namespace clan
 		Secret server_write_key;
 		Secret client_write_iv;
 		Secret server_write_iv;
+		std::unique_ptr<AES_GCM> client_write_gcm;
+		std::unique_ptr<AES_GCM> server_write_gcm;
+		std::unique_ptr<ChaCha20_Poly1305> client_write_chacha;
+		std::unique_ptr<ChaCha20_Poly1305> server_write_chacha;
 		uint64_t read_sequence_number;
 		uint64_t write_sequence_number;
 
@@ -221,6 +272,7 @@ namespace clan
 		cl_tls_state_send_client_hello,
 		cl_tls_state_receive_server_hello,
 		cl_tls_state_receive_certificate,
+		cl_tls_state_receive_server_key_exchange,
 		cl_tls_state_receive_server_hello_done,
 		cl_tls_state_send_client_key_exchange,
 		cl_tls_state_send_change_cipher_spec,
@@ -249,6 +301,11 @@ namespace clan
 		void decrypted_data_consumed(int size);
 		void encrypted_data_consumed(int size);
 
+		void set_session(const Secret &session);
+		Secret get_session() const;
+		bool is_session_resumed() const { return session_resumed; }
+		bool is_connected() const { return conversation_state == cl_tls_state_connected; }
+
 	private:
 		void progress_conversation();
 
@@ -257,10 +314,10 @@ namespace clan
 
 		bool receive_record();
 
-		void change_cipher_spec_data(DataBuffer record_plaintext);
-		void alert_data(DataBuffer record_plaintext);
-		void handshake_data(DataBuffer record_plaintext);
-		void application_data(DataBuffer record_plaintext);
+		void change_cipher_spec_data(const DataBufferView &record_plaintext);
+		void alert_data(const DataBufferView &record_plaintext);
+		void handshake_data(const DataBufferView &record_plaintext);
+		void application_data(const DataBufferView &record_plaintext);
 
 		void handshake_hello_request_received(const void *data, int size);
 		void handshake_client_hello_received(const void *data, int size);
@@ -294,16 +351,33 @@ namespace clan
 		void set_compression_methods(unsigned char *dest_ptr) const;
 		int get_cipher_suites_length() const;
 		void set_cipher_suites(unsigned char *dest_ptr) const;
+		int get_extensions_length() const;
+		void set_extensions(unsigned char *dest_ptr) const;
 		void select_cipher_suite(uint8_t value1, uint8_t value2);
 		void select_compression_method(uint8_t value);
 		void inspect_certificate(std::vector<unsigned char> &cert);
 		void set_server_public_key();
+		void verify_server_key_exchange_signature(uint8_t hash_algorithm, uint8_t signature_algorithm, const void *params_ptr, unsigned int params_size, const std::vector<unsigned char> &signature);
+		void create_keys();
 		void PRF(void *output_ptr, unsigned int output_size, const Secret &secret, const char *label_ptr, const Secret &seed_part1, const Secret &seed_part2);
+		void PRF_SHA256(void *output_ptr, unsigned int output_size, const Secret &secret, const char *label_ptr, const Secret &seed_part1, const Secret &seed_part2);
 		void hash_handshake(const void *data_ptr, unsigned int data_size);
+		Secret get_handshake_hash(bool server_finished);
 
-		DataBuffer decrypt_record(TLS_Record &record, const DataBuffer &record_data);
+		/// \brief TLS 1.1 and later send the CBC initialisation vector with every record
+		bool is_explicit_iv() const { return protocol.major > 3 || (protocol.major == 3 && protocol.minor >= 2); }
+
+		/// \brief TLS 1.2 uses the SHA-256 PRF and allows the AEAD cipher suites
+		bool is_tls12() const { return protocol.major > 3 || (protocol.major == 3 && protocol.minor >= 3); }
+
+		DataBuffer decrypt_record(TLS_Record &record, const DataBufferView &record_data);
 		DataBuffer decrypt_data(const void *data_ptr, unsigned int data_size);
 
+		void create_aead_nonce(const Secret &write_iv, uint64_t sequence_number, unsigned char *out_nonce) const;
+		void create_aead_additional_data(const TLS_Record &record, unsigned int plaintext_size, uint64_t sequence_number, unsigned char *out_additional_data) const;
+		DataBuffer encrypt_aead(const TLS_Record &record, const void *data_ptr, unsigned int data_size);
+		DataBuffer decrypt_aead(TLS_Record &record, const DataBufferView &record_data);
+
 		Secret calculate_mac(const void *data_ptr, unsigned int data_size, const void *data2_ptr, unsigned int data2_size, uint64_t sequence_number, const Secret &mac_secret);
 		DataBuffer encrypt_data(const void *data_ptr, unsigned int data_size, const void *mac_ptr, unsigned int mac_size);
 
@@ -311,6 +385,7 @@ namespace clan
 		static const unsigned int max_handshake_length = 2 << 24;	// RFC 2246 (implied by length in7.4)
 
 		static const int desired_buffer_size = 64 * 1024;
+		static const int max_session_id_length = 32;	// RFC 2246 (7.4.1.2)
 
 		DataBuffer recv_in_data;
 		int recv_in_data_read_pos;
@@ -329,14 +404,16 @@ namespace clan
 
 		TLS_ConversationState conversation_state;
 
-		DataBuffer record_data_buffer; // local variable of receive_record(). Placed here to avoid allocating memory each time a record is processed
 
 		TLS_SecurityParameters security_parameters;
 		TLS_ProtocolVersion protocol;
+		TLS_ProtocolVersion client_hello_protocol;	// Highest version offered, also used in the RSA pre-master secret
 
 		DataBuffer server_public_exponent;
 		DataBuffer server_public_modulus;
 
+		Secret ecdhe_server_public_key;
+
 		bool is_protocol_chosen;	// Set by the server hello response
 
 		Random m_Random;
@@ -345,7 +422,16 @@ namespace clan
 		SHA1 client_handshake_sha1_hash;
 		MD5 server_handshake_md5_hash;
 		SHA1 server_handshake_sha1_hash;
+		SHA256 client_handshake_sha256_hash;
+		SHA256 server_handshake_sha256_hash;
 
 		std::vector<X509> certificate_chain;
+
+		uint8_t cipher_suite[2];
+		Secret session_id;			// Session id given by the server hello
+		Secret resume_session_id;		// Session id offered in the client hello
+		Secret resume_master_secret;
+		uint8_t resume_cipher_suite[2];
+		bool session_resumed;
 	};
 }
@@ -0,0 +1,222 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "Core/precomp.h"
+#include "x25519.h"
+#include <cstring>
+
+// Field arithmetic modulo 2^255 - 19 with sixteen 16 bit limbs, after the public domain TweetNaCl.
+// All operations run in constant time.
+
+namespace clan
+{
+	namespace
+	{
+		typedef int64_t FieldElement[16];
+
+		void carry(FieldElement o)
+		{
+			for (int i = 0; i < 16; i++)
+			{
+				o[i] += (int64_t)1 << 16;
+				int64_t c = o[i] >> 16;
+				if (i < 15)
+					o[i + 1] += c - 1;
+				else
+					o[0] += 38 * (c - 1);
+				o[i] -= c * 65536;
+			}
+		}
+
+		void select(FieldElement p, FieldElement q, int b)
+		{
+			int64_t mask = ~(int64_t)(b - 1);
+			for (int i = 0; i < 16; i++)
+			{
+				int64_t t = mask & (p[i] ^ q[i]);
+				p[i] ^= t;
+				q[i] ^= t;
+			}
+		}
+
+		void pack(unsigned char *o, const FieldElement n)
+		{
+			FieldElement m, t;
+			for (int i = 0; i < 16; i++)
+				t[i] = n[i];
+			carry(t);
+			carry(t);
+			carry(t);
+			for (int j = 0; j < 2; j++)
+			{
+				m[0] = t[0] - 0xffed;
+				for (int i = 1; i < 15; i++)
+				{
+					m[i] = t[i] - 0xffff - ((m[i - 1] >> 16) & 1);
+					m[i - 1] &= 0xffff;
+				}
+				m[15] = t[15] - 0x7fff - ((m[14] >> 16) & 1);
+				int b = (int)((m[15] >> 16) & 1);
+				m[14] &= 0xffff;
+				select(t, m, 1 - b);
+			}
+			for (int i = 0; i < 16; i++)
+			{
+				o[2 * i] = (unsigned char)(t[i] & 0xff);
+				o[2 * i + 1] = (unsigned char)(t[i] >> 8);
+			}
+		}
+
+		void unpack(FieldElement o, const unsigned char *n)
+		{
+			for (int i = 0; i < 16; i++)
+				o[i] = n[2 * i] + ((int64_t)n[2 * i + 1] << 8);
+			o[15] &= 0x7fff;
+		}
+
+		void add(FieldElement o, const FieldElement a, const FieldElement b)
+		{
+			for (int i = 0; i < 16; i++)
+				o[i] = a[i] + b[i];
+		}
+
+		void subtract(FieldElement o, const FieldElement a, const FieldElement b)
+		{
+			for (int i = 0; i < 16; i++)
+				o[i] = a[i] - b[i];
+		}
+
+		void multiply(FieldElement o, const FieldElement a, const FieldElement b)
+		{
+			int64_t t[31] = { 0 };
+			for (int i = 0; i < 16; i++)
+			{
+				for (int j = 0; j < 16; j++)
+					t[i + j] += a[i] * b[j];
+			}
+			for (int i = 0; i < 15; i++)
+				t[i] += 38 * t[i + 16];
+			for (int i = 0; i < 16; i++)
+				o[i] = t[i];
+			carry(o);
+			carry(o);
+		}
+
+		void square(FieldElement o, const FieldElement a)
+		{
+			multiply(o, a, a);
+		}
+
+		void invert(FieldElement o, const FieldElement i)
+		{
+			// i^(p-2) by Fermat's little theorem
+			FieldElement c;
+			for (int a = 0; a < 16; a++)
+				c[a] = i[a];
+			for (int a = 253; a >= 0; a--)
+			{
+				square(c, c);
+				if (a != 2 && a != 4)
+					multiply(c, c, i);
+			}
+			for (int a = 0; a < 16; a++)
+				o[a] = c[a];
+		}
+	}
+
+	void X25519::public_key(const unsigned char private_key[key_size], unsigned char out_public_key[key_size])
+	{
+		unsigned char base_point[key_size] = { 9 };
+		scalar_multiply(private_key, base_point, out_public_key);
+	}
+
+	bool X25519::shared_secret(const unsigned char private_key[key_size], const unsigned char peer_public_key[key_size], unsigned char out_shared_secret[key_size])
+	{
+		scalar_multiply(private_key, peer_public_key, out_shared_secret);
+
+		unsigned char bits = 0;
+		for (int i = 0; i < key_size; i++)
+			bits |= out_shared_secret[i];
+		return bits != 0;
+	}
+
+	void X25519::scalar_multiply(const unsigned char scalar[key_size], const unsigned char point[key_size], unsigned char out_point[key_size])
+	{
+		static const FieldElement a24 = { 0xDB41, 1 };	// (486662 - 2) / 4
+
+		// Clamp the scalar
+		unsigned char z[key_size];
+		memcpy(z, scalar, key_size);
+		z[31] = (z[31] & 127) | 64;
+		z[0] &= 248;
+
+		FieldElement x, a, b, c, d, e, f;
+		unpack(x, point);
+		for (int i = 0; i < 16; i++)
+		{
+			b[i] = x[i];
+			a[i] = c[i] = d[i] = 0;
+		}
+		a[0] = d[0] = 1;
+
+		// Montgomery ladder
+		for (int i = 254; i >= 0; i--)
+		{
+			int bit = (z[i >> 3] >> (i & 7)) & 1;
+			select(a, b, bit);
+			select(c, d, bit);
+			add(e, a, c);
+			subtract(a, a, c);
+			add(c, b, d);
+			subtract(b, b, d);
+			square(d, e);
+			square(f, a);
+			multiply(a, c, a);
+			multiply(c, b, e);
+			add(e, a, c);
+			subtract(a, a, c);
+			square(b, a);
+			subtract(c, d, f);
+			multiply(a, c, a24);
+			add(a, a, d);
+			multiply(c, c, a);
+			multiply(a, d, f);
+			multiply(d, b, x);
+			square(b, e);
+			select(a, b, bit);
+			select(c, d, bit);
+		}
+
+		invert(c, c);
+		multiply(a, a, c);
+		pack(out_point, a);
+
+		memset(z, 0, sizeof(z));
+	}
+}
@@ -0,0 +1,51 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+namespace clan
+{
+	/// \brief Elliptic curve Diffie-Hellman over Curve25519 (RFC 7748)
+	class X25519
+	{
+	public:
+		static const int key_size = 32;
+
+		/// \brief Calculates the public key belonging to a private key
+		static void public_key(const unsigned char private_key[key_size], unsigned char out_public_key[key_size]);
+
+		/// \brief Calculates the shared secret of our private key and the peer's public key
+		///
+		/// \return false if the result is all zeros, meaning the peer sent a point of small order
+		static bool shared_secret(const unsigned char private_key[key_size], const unsigned char peer_public_key[key_size], unsigned char out_shared_secret[key_size]);
+
+	private:
+		static void scalar_multiply(const unsigned char scalar[key_size], const unsigned char point[key_size], unsigned char out_point[key_size]);
+	};
+}
@@ -29,7 +29,15 @@
 #include "Core/precomp.h"
 #include "API/Core/ErrorReporting/crash_reporter.h"
 #include "API/Core/Text/string_help.h"
+#include "API/Core/System/system.h"
 #include "crash_reporter_impl.h"
+#if !defined(WIN32) && !defined(__APPLE__) && !defined(__ANDROID__)
+#include <execinfo.h>
+#include <pthread.h>
+#include <signal.h>
+#include <atomic>
+#include <thread>
+#endif
 
 namespace clan
 {
@@ -57,6 +65,16 @@ namespace clan
 		CrashReporter_Impl::generate_report();
 	}
 
+	uint64_t CrashReporter::get_current_thread_id()
+	{
+		return CrashReporter_Impl::get_current_thread_id();
+	}
+
+	int CrashReporter::capture_thread_stack(uint64_t thread_id, int max_frames, void **out_frames)
+	{
+		return CrashReporter_Impl::capture_thread_stack(thread_id, max_frames, out_frames);
+	}
+
 	/////////////////////////////////////////////////////////////////////////////
 
 #ifdef _MSC_VER
@@ -221,6 +239,64 @@ namespace clan
 		return EXCEPTION_EXECUTE_HANDLER;
 	}
 
+	int CrashReporter_Impl::capture_thread_stack(uint64_t thread_id, int max_frames, void **out_frames)
+	{
+		if ((DWORD)thread_id == GetCurrentThreadId())
+			return System::capture_stack_trace(1, max_frames, out_frames);
+
+		HANDLE thread = OpenThread(THREAD_SUSPEND_RESUME | THREAD_GET_CONTEXT | THREAD_QUERY_INFORMATION, FALSE, (DWORD)thread_id);
+		if (thread == 0)
+			return 0;
+
+		// Only functions that do not take locks can be used while the thread is suspended.
+		// StackWalk64 allocates memory and could deadlock on a heap lock held by the thread.
+		int num_frames = 0;
+		if (SuspendThread(thread) != (DWORD)-1)
+		{
+			CONTEXT context;
+			memset(&context, 0, sizeof(CONTEXT));
+			context.ContextFlags = CONTEXT_FULL;
+			if (GetThreadContext(thread, &context))
+			{
+#if defined(_M_X64)
+				while (num_frames < max_frames && context.Rip != 0)
+				{
+					out_frames[num_frames++] = (void*)context.Rip;
+
+					DWORD64 image_base = 0;
+					PRUNTIME_FUNCTION function_entry = RtlLookupFunctionEntry(context.Rip, &image_base, 0);
+					if (function_entry)
+					{
+						void *handler_data = 0;
+						DWORD64 establisher_frame = 0;
+						RtlVirtualUnwind(UNW_FLAG_NHANDLER, image_base, context.Rip, function_entry, &context, &handler_data, &establisher_frame, 0);
+					}
+					else
+					{
+						// Leaf function without unwind info
+						context.Rip = *(DWORD64*)context.Rsp;
+						context.Rsp += 8;
+					}
+				}
+#elif defined(_M_IX86)
+				out_frames[num_frames++] = (void*)context.Eip;
+				DWORD *frame_pointer = (DWORD*)context.Ebp;
+				while (num_frames < max_frames && frame_pointer && !IsBadReadPtr(frame_pointer, sizeof(DWORD) * 2) && frame_pointer[1] != 0)
+				{
+					out_frames[num_frames++] = (void*)frame_pointer[1];
+					DWORD *next_frame_pointer = (DWORD*)frame_pointer[0];
+					if (next_frame_pointer <= frame_pointer)
+						break;
+					frame_pointer = next_frame_pointer;
+				}
+#endif
+			}
+			ResumeThread(thread);
+		}
+		CloseHandle(thread);
+		return num_frames;
+	}
+
 	DWORD WINAPI CrashReporter_Impl::create_dump_main(LPVOID thread_parameter)
 	{
 		create_dump(reinterpret_cast<DumpParams *>(thread_parameter), true);
@@ -340,6 +416,101 @@ namespace clan
 	{
 	}
 
+#if defined(WIN32) || defined(__APPLE__) || defined(__ANDROID__)
+
+	uint64_t CrashReporter_Impl::get_current_thread_id()
+	{
+		return 0;
+	}
+
+	int CrashReporter_Impl::capture_thread_stack(uint64_t thread_id, int max_frames, void **out_frames)
+	{
+		return 0;
+	}
+
+#else
+
+	// The target thread captures its own stack in a signal handler. The request lives in static
+	// storage so a handler that runs after the caller gave up never writes to a dead stack frame.
+	namespace
+	{
+		enum { sample_idle, sample_requested, sample_running, sample_done };
+		const int max_sample_frames = 64;
+
+		std::mutex sample_mutex;
+		std::atomic<int> sample_state(sample_idle);
+		void *sample_frames[max_sample_frames];
+		int sample_num_frames = 0;
+
+		void on_stack_sample_signal(int)
+		{
+			int expected = sample_requested;
+			if (sample_state.compare_exchange_strong(expected, sample_running))
+			{
+				sample_num_frames = backtrace(sample_frames, max_sample_frames);
+				sample_state.store(sample_done);
+			}
+		}
+
+		int stack_sample_signal()
+		{
+			static int signal_number = 0;
+			if (signal_number == 0)
+			{
+				// backtrace loads libgcc on first use, which is not safe from a signal handler
+				void *frame;
+				backtrace(&frame, 1);
+
+				struct sigaction action;
+				memset(&action, 0, sizeof(action));
+				action.sa_handler = &on_stack_sample_signal;
+				action.sa_flags = SA_RESTART;
+				sigemptyset(&action.sa_mask);
+				signal_number = SIGRTMIN + 7;
+				sigaction(signal_number, &action, 0);
+			}
+			return signal_number;
+		}
+	}
+
+	uint64_t CrashReporter_Impl::get_current_thread_id()
+	{
+		return (uint64_t)pthread_self();
+	}
+
+	int CrashReporter_Impl::capture_thread_stack(uint64_t thread_id, int max_frames, void **out_frames)
+	{
+		std::unique_lock<std::mutex> lock(sample_mutex);
+
+		sample_state.store(sample_requested);
+		if (pthread_kill((pthread_t)thread_id, stack_sample_signal()) != 0)
+		{
+			sample_state.store(sample_idle);
+			return 0;
+		}
+
+		for (int i = 0; i < 1000 && sample_state.load() != sample_done; i++)
+			std::this_thread::sleep_for(std::chrono::microseconds(50));
+
+		// Withdraw the request if the handler has not started yet; wait for it if it has.
+		int expected = sample_requested;
+		if (sample_state.compare_exchange_strong(expected, sample_idle))
+			return 0;
+		while (sample_state.load() != sample_done)
+			std::this_thread::yield();
+
+		// Skip the signal handler and the signal trampoline
+		int skip = 2;
+		int num_frames = 0;
+		for (int i = skip; i < sample_num_frames && num_frames < max_frames; i++)
+			out_frames[num_frames++] = sample_frames[i];
+
+		sample_state.store(sample_idle);
+		return num_frames;
+	}
+
+#endif
+
 #endif
 
 }
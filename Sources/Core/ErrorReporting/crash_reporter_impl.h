@@ -51,6 +51,9 @@ namespace clan
 		static void invoke();
 		static void generate_report();
 
+		static uint64_t get_current_thread_id() { return GetCurrentThreadId(); }
+		static int capture_thread_stack(uint64_t thread_id, int max_frames, void **out_frames);
+
 	private:
 		struct DumpParams
 		{
@@ -101,6 +104,9 @@ namespace clan
 		static void hook_thread() {}
 		static void invoke() { }
 		static void generate_report() { }
+
+		static uint64_t get_current_thread_id();
+		static int capture_thread_stack(uint64_t thread_id, int max_frames, void **out_frames);
 	};
 
 #endif
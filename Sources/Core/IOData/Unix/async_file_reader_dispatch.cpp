@@ -0,0 +1,112 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "Core/precomp.h"
+#include "async_file_reader_dispatch.h"
+
+#ifdef __APPLE__
+
+namespace clan
+{
+	AsyncFileReaderBackend_Dispatch::AsyncFileReaderBackend_Dispatch()
+	{
+		queue = dispatch_queue_create("org.clanlib.asyncfilereader", DISPATCH_QUEUE_CONCURRENT);
+	}
+
+	AsyncFileReaderBackend_Dispatch::~AsyncFileReaderBackend_Dispatch()
+	{
+		dispatch_release(queue);
+	}
+
+	bool AsyncFileReaderBackend_Dispatch::open_file(AsyncFileRead &read)
+	{
+		if (!AsyncFileReaderBackend::open_file(read))
+			return false;
+
+		// The channel does not own the descriptor, it is closed by close_file once the channel is closed
+		dispatch_io_t channel = dispatch_io_create(DISPATCH_IO_RANDOM, read.fd, queue, ^(int error) { });
+		if (!channel)
+		{
+			AsyncFileReaderBackend::close_file(read);
+			return false;
+		}
+		read.backend_data = channel;
+		return true;
+	}
+
+	void AsyncFileReaderBackend_Dispatch::close_file(AsyncFileRead &read)
+	{
+		if (read.backend_data)
+		{
+			dispatch_io_t channel = (dispatch_io_t)read.backend_data;
+			dispatch_io_close(channel, 0);
+			dispatch_release(channel);
+			read.backend_data = nullptr;
+		}
+		AsyncFileReaderBackend::close_file(read);
+	}
+
+	bool AsyncFileReaderBackend_Dispatch::start_read(AsyncFileRead &read)
+	{
+		AsyncFileRead *read_ptr = &read;
+		__block int transferred = 0;
+		dispatch_io_read((dispatch_io_t)read.backend_data, read.offset + read.received, read.size - read.received, queue, ^(bool done, dispatch_data_t data, int error)
+		{
+			if (data)
+			{
+				dispatch_data_apply(data, ^(dispatch_data_t region, size_t region_offset, const void *buffer, size_t size)
+				{
+					memcpy(read_ptr->data.get_data() + read_ptr->received + transferred, buffer, size);
+					transferred += (int)size;
+					return (bool)true;
+				});
+			}
+
+			if (done)
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				read_ptr->result = error ? -error : transferred;
+				read_ptr->received += transferred;
+				finished_reads.push_back(read_ptr);
+				finished_event.notify_one();
+			}
+		});
+		return true;
+	}
+
+	void AsyncFileReaderBackend_Dispatch::wait(std::vector<AsyncFileRead *> &finished)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		finished_event.wait(lock, [this]() { return !finished_reads.empty(); });
+		finished.insert(finished.end(), finished_reads.begin(), finished_reads.end());
+		finished_reads.clear();
+	}
+}
+
+#endif
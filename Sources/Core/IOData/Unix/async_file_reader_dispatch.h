@@ -0,0 +1,63 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#ifdef __APPLE__
+
+#include "../async_file_reader_impl.h"
+#include <condition_variable>
+#include <mutex>
+#include <dispatch/dispatch.h>
+
+namespace clan
+{
+	/// \brief Executes reads with random access dispatch_io channels
+	class AsyncFileReaderBackend_Dispatch : public AsyncFileReaderBackend
+	{
+	public:
+		AsyncFileReaderBackend_Dispatch();
+		~AsyncFileReaderBackend_Dispatch();
+
+		const char *get_name() const override { return "dispatch_io"; }
+		bool open_file(AsyncFileRead &read) override;
+		void close_file(AsyncFileRead &read) override;
+		bool start_read(AsyncFileRead &read) override;
+		void wait(std::vector<AsyncFileRead *> &finished) override;
+
+	private:
+		dispatch_queue_t queue;
+
+		std::mutex mutex;
+		std::condition_variable finished_event;
+		std::vector<AsyncFileRead *> finished_reads;
+	};
+}
+
+#endif
@@ -0,0 +1,198 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "Core/precomp.h"
+#include "async_file_reader_uring.h"
+
+#ifdef CL_HAVE_IO_URING
+
+#include <algorithm>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <cerrno>
+
+namespace clan
+{
+	AsyncFileReaderBackend_Uring::AsyncFileReaderBackend_Uring()
+	{
+	}
+
+	AsyncFileReaderBackend_Uring::~AsyncFileReaderBackend_Uring()
+	{
+		if (sqes)
+			munmap(sqes, sqes_size);
+		if (cq_ring && cq_ring != sq_ring)
+			munmap(cq_ring, cq_ring_size);
+		if (sq_ring)
+			munmap(sq_ring, sq_ring_size);
+		if (ring_fd != -1)
+			close(ring_fd);
+	}
+
+	AsyncFileReaderBackend_Uring *AsyncFileReaderBackend_Uring::create(unsigned int entries)
+	{
+		AsyncFileReaderBackend_Uring *backend = new AsyncFileReaderBackend_Uring();
+		if (!backend->init(entries))
+		{
+			delete backend;
+			return nullptr;
+		}
+		return backend;
+	}
+
+	bool AsyncFileReaderBackend_Uring::init(unsigned int entries)
+	{
+		io_uring_params params;
+		memset(&params, 0, sizeof(params));
+		ring_fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+		if (ring_fd < 0)
+		{
+			ring_fd = -1;
+			return false;
+		}
+
+		// IORING_OP_READ needs the kernel that introduced IORING_FEAT_NODROP as well (5.5/5.6)
+		if (!(params.features & IORING_FEAT_NODROP))
+			return false;
+
+		sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+		cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+		bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+		if (single_mmap)
+			sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size);
+
+		sq_ring = mmap(nullptr, sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+		if (sq_ring == MAP_FAILED)
+		{
+			sq_ring = nullptr;
+			return false;
+		}
+
+		if (single_mmap)
+		{
+			cq_ring = sq_ring;
+		}
+		else
+		{
+			cq_ring = mmap(nullptr, cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+			if (cq_ring == MAP_FAILED)
+			{
+				cq_ring = nullptr;
+				return false;
+			}
+		}
+
+		sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+		void *sqes_ptr = mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+		if (sqes_ptr == MAP_FAILED)
+			return false;
+		sqes = (io_uring_sqe *)sqes_ptr;
+
+		char *sq = (char *)sq_ring;
+		sq_head = (unsigned int *)(sq + params.sq_off.head);
+		sq_tail = (unsigned int *)(sq + params.sq_off.tail);
+		sq_mask = (unsigned int *)(sq + params.sq_off.ring_mask);
+		sq_entries = (unsigned int *)(sq + params.sq_off.ring_entries);
+		sq_array = (unsigned int *)(sq + params.sq_off.array);
+
+		char *cq = (char *)cq_ring;
+		cq_head = (unsigned int *)(cq + params.cq_off.head);
+		cq_tail = (unsigned int *)(cq + params.cq_off.tail);
+		cq_mask = (unsigned int *)(cq + params.cq_off.ring_mask);
+		cqes = (io_uring_cqe *)(cq + params.cq_off.cqes);
+		return true;
+	}
+
+	bool AsyncFileReaderBackend_Uring::start_read(AsyncFileRead &read)
+	{
+		// This thread is the only producer of the submission queue, while the kernel advances its head
+		unsigned int tail = *sq_tail;
+		unsigned int head = __atomic_load_n(sq_head, __ATOMIC_ACQUIRE);
+		if (tail - head >= *sq_entries)
+			return false;
+
+		unsigned int index = tail & *sq_mask;
+		io_uring_sqe *sqe = &sqes[index];
+		memset(sqe, 0, sizeof(io_uring_sqe));
+		sqe->opcode = IORING_OP_READ;
+		sqe->fd = read.fd;
+		sqe->addr = (uint64_t)(uintptr_t)(read.data.get_data() + read.received);
+		sqe->len = read.size - read.received;
+		sqe->off = read.offset + read.received;
+		sqe->user_data = (uint64_t)(uintptr_t)&read;
+		sq_array[index] = index;
+
+		__atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+		to_submit++;
+		return true;
+	}
+
+	void AsyncFileReaderBackend_Uring::submit()
+	{
+		while (to_submit > 0)
+		{
+			int submitted = (int)syscall(__NR_io_uring_enter, ring_fd, to_submit, 0, 0, nullptr, 0);
+			if (submitted < 0)
+			{
+				if (errno == EINTR || errno == EAGAIN || errno == EBUSY)
+					continue;
+				throw Exception("io_uring_enter failed to submit reads");
+			}
+			to_submit -= submitted;
+		}
+	}
+
+	void AsyncFileReaderBackend_Uring::wait(std::vector<AsyncFileRead *> &finished)
+	{
+		unsigned int head = *cq_head;
+		if (head == __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE))
+		{
+			while (syscall(__NR_io_uring_enter, ring_fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0)
+			{
+				if (errno != EINTR)
+					throw Exception("io_uring_enter failed to wait for reads");
+			}
+		}
+
+		unsigned int tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+		while (head != tail)
+		{
+			const io_uring_cqe &cqe = cqes[head & *cq_mask];
+			AsyncFileRead *read = (AsyncFileRead *)(uintptr_t)cqe.user_data;
+			read->result = cqe.res;
+			if (cqe.res > 0)
+				read->received += cqe.res;
+			finished.push_back(read);
+			head++;
+		}
+		__atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+	}
+}
+
+#endif
@@ -0,0 +1,87 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define CL_HAVE_IO_URING
+#endif
+#endif
+
+#ifdef CL_HAVE_IO_URING
+
+#include "../async_file_reader_impl.h"
+#include <linux/io_uring.h>
+
+namespace clan
+{
+	/// \brief Executes reads with io_uring, using the system calls directly
+	///
+	/// Reads are started by the thread submitting them, while completions are only reaped by the I/O thread.
+	class AsyncFileReaderBackend_Uring : public AsyncFileReaderBackend
+	{
+	public:
+		~AsyncFileReaderBackend_Uring();
+
+		/// \brief Returns nullptr if io_uring is not available, for example when blocked by a seccomp filter
+		static AsyncFileReaderBackend_Uring *create(unsigned int entries = 64);
+
+		const char *get_name() const override { return "io_uring"; }
+		bool start_read(AsyncFileRead &read) override;
+		void submit() override;
+		void wait(std::vector<AsyncFileRead *> &finished) override;
+
+	private:
+		AsyncFileReaderBackend_Uring();
+		bool init(unsigned int entries);
+
+		int ring_fd = -1;
+		unsigned int to_submit = 0;
+
+		void *sq_ring = nullptr;
+		size_t sq_ring_size = 0;
+		void *cq_ring = nullptr;
+		size_t cq_ring_size = 0;
+		io_uring_sqe *sqes = nullptr;
+		size_t sqes_size = 0;
+
+		unsigned int *sq_head = nullptr;
+		unsigned int *sq_tail = nullptr;
+		unsigned int *sq_mask = nullptr;
+		unsigned int *sq_entries = nullptr;
+		unsigned int *sq_array = nullptr;
+		unsigned int *cq_head = nullptr;
+		unsigned int *cq_tail = nullptr;
+		unsigned int *cq_mask = nullptr;
+		io_uring_cqe *cqes = nullptr;
+	};
+}
+
+#endif
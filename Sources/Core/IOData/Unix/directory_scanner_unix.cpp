@@ -134,25 +134,20 @@ bool DirectoryScanner_Unix::next()
 	if(!dir_temp)
 		throw Exception("Directory scanner not initialized");
 
-	entry = readdir(dir_temp);
-
-	if( entry == nullptr )
-		return false;
+	// Match the pattern before the name is copied and stat is called
+	do
+	{
+		entry = readdir(dir_temp);
+		if( entry == nullptr )
+			return false;
+	} while (use_pattern && fnmatch(file_pattern.c_str(), entry->d_name, FNM_PATHNAME) != 0);
 
 	file_name = entry->d_name;
 
 	if (stat((path_name + "/" + file_name).c_str(), &statbuf) == -1)
 		memset(&statbuf, 0, sizeof(statbuf));
 
-	if (use_pattern)
-	{
-		if (fnmatch(file_pattern.c_str(), file_name.c_str(), FNM_PATHNAME) == 0)
-			return true;
-		else
-			return next();
-	} else {
-		return true;
-	}
+	return true;
 }
 
 }
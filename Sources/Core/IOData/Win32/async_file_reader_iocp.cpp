@@ -0,0 +1,119 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "Core/precomp.h"
+#include "async_file_reader_iocp.h"
+
+namespace clan
+{
+	AsyncFileReaderBackend_IOCP::AsyncFileReaderBackend_IOCP(HANDLE port) : port(port)
+	{
+	}
+
+	AsyncFileReaderBackend_IOCP::~AsyncFileReaderBackend_IOCP()
+	{
+		CloseHandle(port);
+	}
+
+	AsyncFileReaderBackend_IOCP *AsyncFileReaderBackend_IOCP::create()
+	{
+		HANDLE port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1);
+		if (port == nullptr)
+			return nullptr;
+		return new AsyncFileReaderBackend_IOCP(port);
+	}
+
+	bool AsyncFileReaderBackend_IOCP::open_file(AsyncFileRead &read)
+	{
+		if (!AsyncFileReaderBackend::open_file(read))
+			return false;
+
+		if (CreateIoCompletionPort(read.handle, port, 0, 0) == nullptr)
+		{
+			close_file(read);
+			return false;
+		}
+		return true;
+	}
+
+	bool AsyncFileReaderBackend_IOCP::start_read(AsyncFileRead &read)
+	{
+		uint64_t position = read.offset + read.received;
+		memset(&read.overlapped, 0, sizeof(OVERLAPPED));
+		read.overlapped.Offset = (DWORD)position;
+		read.overlapped.OffsetHigh = (DWORD)(position >> 32);
+
+		// A read that completes at once still posts its completion to the port
+		if (ReadFile(read.handle, read.data.get_data() + read.received, read.size - read.received, nullptr, &read.overlapped) == FALSE)
+		{
+			DWORD error = GetLastError();
+			if (error != ERROR_IO_PENDING)
+			{
+				read.result = (error == ERROR_HANDLE_EOF) ? 0 : -1;
+				PostQueuedCompletionStatus(port, 0, (ULONG_PTR)&read, nullptr);
+			}
+		}
+		return true;
+	}
+
+	void AsyncFileReaderBackend_IOCP::wait(std::vector<AsyncFileRead *> &finished)
+	{
+		DWORD timeout = INFINITE;
+		while (true)
+		{
+			DWORD bytes = 0;
+			ULONG_PTR key = 0;
+			OVERLAPPED *overlapped = nullptr;
+			BOOL result = GetQueuedCompletionStatus(port, &bytes, &key, &overlapped, timeout);
+			if (overlapped == nullptr && key == 0)
+				break;	// Timed out after collecting the completions already queued
+
+			if (overlapped == nullptr)
+			{
+				// Posted by start_read for a read that failed to start
+				finished.push_back((AsyncFileRead *)key);
+			}
+			else
+			{
+				AsyncFileRead *read = CONTAINING_RECORD(overlapped, AsyncFileRead, overlapped);
+				if (result)
+				{
+					read->result = (int)bytes;
+					read->received += (int)bytes;
+				}
+				else
+				{
+					read->result = (GetLastError() == ERROR_HANDLE_EOF) ? 0 : -1;
+				}
+				finished.push_back(read);
+			}
+			timeout = 0;
+		}
+	}
+}
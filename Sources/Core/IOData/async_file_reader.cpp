@@ -0,0 +1,405 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "Core/precomp.h"
+#include "API/Core/IOData/async_file_reader.h"
+#include "API/Core/System/work_queue.h"
+#include "API/Core/Text/string_help.h"
+#include "async_file_reader_impl.h"
+#include <atomic>
+#include <climits>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#ifdef WIN32
+#include "Win32/async_file_reader_iocp.h"
+#else
+#include "Unix/async_file_reader_uring.h"
+#include "Unix/async_file_reader_dispatch.h"
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <cerrno>
+#endif
+
+namespace clan
+{
+#ifndef WIN32
+	namespace
+	{
+		/// \brief Only opens and closes files, for reads done with pread on the work queue
+		class AsyncFileReaderBackend_Blocking : public AsyncFileReaderBackend
+		{
+		public:
+			const char *get_name() const override { return "pread"; }
+			bool start_read(AsyncFileRead &read) override { return false; }
+			void wait(std::vector<AsyncFileRead *> &finished) override { }
+		};
+	}
+#endif
+
+	class AsyncFileReader_Impl
+	{
+	public:
+		AsyncFileReader_Impl(const WorkQueue &completion_queue);
+		~AsyncFileReader_Impl();
+
+		void submit();
+
+		WorkQueue completion_queue;
+		std::unique_ptr<AsyncFileReaderBackend> backend;
+		std::atomic_int pending;
+
+		std::mutex mutex;
+		std::vector<std::shared_ptr<AsyncFileRead>> batch;
+
+	private:
+		void start_queued_reads();
+		void finish(const std::shared_ptr<AsyncFileRead> &read, bool success);
+		void io_thread_main();
+
+		static AsyncFileReaderBackend *create_backend();
+		static void read_blocking(AsyncFileRead &read);
+
+		std::deque<std::shared_ptr<AsyncFileRead>> queued;
+		std::unordered_map<AsyncFileRead *, std::shared_ptr<AsyncFileRead>> in_flight;
+		std::condition_variable io_event;
+		bool stop = false;
+		std::thread io_thread;
+	};
+
+	AsyncFileReader::AsyncFileReader()
+	{
+	}
+
+	AsyncFileReader::AsyncFileReader(const WorkQueue &completion_queue)
+		: impl(std::make_shared<AsyncFileReader_Impl>(completion_queue))
+	{
+	}
+
+	AsyncFileReader::~AsyncFileReader()
+	{
+	}
+
+	std::string AsyncFileReader::get_backend_name() const
+	{
+		return impl->backend ? impl->backend->get_name() : "pread";
+	}
+
+	int AsyncFileReader::get_reads_pending() const
+	{
+		return impl->pending.load();
+	}
+
+	void AsyncFileReader::read(const std::string &filename, int64_t offset, int size, const Callback &completed)
+	{
+		if (offset < 0 || size < 0)
+			throw Exception("Invalid AsyncFileReader read range");
+
+		auto read = std::make_shared<AsyncFileRead>();
+		read->filename = filename;
+		read->offset = offset;
+		read->size = size;
+		read->completed = completed;
+
+		std::unique_lock<std::mutex> lock(impl->mutex);
+		impl->batch.push_back(read);
+		impl->pending++;
+	}
+
+	void AsyncFileReader::read_file(const std::string &filename, const Callback &completed)
+	{
+		auto read = std::make_shared<AsyncFileRead>();
+		read->filename = filename;
+		read->size = -1;
+		read->completed = completed;
+
+		std::unique_lock<std::mutex> lock(impl->mutex);
+		impl->batch.push_back(read);
+		impl->pending++;
+	}
+
+	void AsyncFileReader::submit()
+	{
+		impl->submit();
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	AsyncFileReader_Impl::AsyncFileReader_Impl(const WorkQueue &completion_queue)
+		: completion_queue(completion_queue), backend(create_backend()), pending(0)
+	{
+		if (backend)
+			io_thread = std::thread(&AsyncFileReader_Impl::io_thread_main, this);
+	}
+
+	AsyncFileReader_Impl::~AsyncFileReader_Impl()
+	{
+		if (io_thread.joinable())
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			stop = true;
+			for (const auto &read : queued)
+				backend->close_file(*read);
+			queued.clear();
+			io_event.notify_all();
+			lock.unlock();
+			io_thread.join();
+		}
+	}
+
+	AsyncFileReaderBackend *AsyncFileReader_Impl::create_backend()
+	{
+#if defined(WIN32)
+		return AsyncFileReaderBackend_IOCP::create();
+#elif defined(__APPLE__)
+		return new AsyncFileReaderBackend_Dispatch();
+#elif defined(CL_HAVE_IO_URING)
+		return AsyncFileReaderBackend_Uring::create();	// Null if the kernel does not allow io_uring
+#else
+		return nullptr;
+#endif
+	}
+
+	void AsyncFileReader_Impl::submit()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		std::vector<std::shared_ptr<AsyncFileRead>> reads;
+		reads.swap(batch);
+
+		if (!backend)
+		{
+			lock.unlock();
+			for (const auto &read : reads)
+			{
+				std::atomic_int *reads_pending = &pending;
+				completion_queue.queue([read, reads_pending]()
+				{
+					read_blocking(*read);
+					(*reads_pending)--;
+					read->completed(read->result >= 0, read->data);
+				});
+			}
+			return;
+		}
+
+		queued.insert(queued.end(), reads.begin(), reads.end());
+		start_queued_reads();
+		backend->submit();
+		io_event.notify_one();
+	}
+
+	void AsyncFileReader_Impl::start_queued_reads()
+	{
+		while (!queued.empty())
+		{
+			std::shared_ptr<AsyncFileRead> read = queued.front();
+			if (read->data.is_null())
+			{
+				if (!backend->open_file(*read))
+				{
+					queued.pop_front();
+					finish(read, false);
+					continue;
+				}
+
+				read->data = DataBuffer(read->size);
+				if (read->size == 0)
+				{
+					queued.pop_front();
+					finish(read, true);
+					continue;
+				}
+			}
+
+			if (!backend->start_read(*read))
+				break;
+
+			queued.pop_front();
+			in_flight[read.get()] = read;
+		}
+	}
+
+	void AsyncFileReader_Impl::finish(const std::shared_ptr<AsyncFileRead> &read, bool success)
+	{
+		backend->close_file(*read);
+		if (success)
+			read->data.set_size(read->received);
+		else
+			read->data = DataBuffer();
+		read->result = success ? read->received : -1;
+
+		pending--;
+		completion_queue.queue([read]()
+		{
+			read->completed(read->result >= 0, read->data);
+		});
+	}
+
+	void AsyncFileReader_Impl::io_thread_main()
+	{
+		std::vector<AsyncFileRead *> finished;
+		std::unique_lock<std::mutex> lock(mutex);
+		while (true)
+		{
+			io_event.wait(lock, [this]() { return stop || !in_flight.empty(); });
+			if (in_flight.empty())
+				break;
+
+			lock.unlock();
+			finished.clear();
+			backend->wait(finished);
+			lock.lock();
+
+			for (AsyncFileRead *finished_read : finished)
+			{
+				auto it = in_flight.find(finished_read);
+				if (it == in_flight.end())
+					continue;
+				std::shared_ptr<AsyncFileRead> read = it->second;
+				in_flight.erase(it);
+
+				if (read->result > 0 && read->received < read->size)
+				{
+					// Short read. Continue with the rest of the range.
+					queued.push_front(read);
+				}
+				else
+				{
+					finish(read, read->result >= 0);
+				}
+			}
+
+			start_queued_reads();
+			backend->submit();
+		}
+	}
+
+#ifdef WIN32
+
+	bool AsyncFileReaderBackend::open_file(AsyncFileRead &read)
+	{
+		read.handle = CreateFile(StringHelp::utf8_to_ucs2(read.filename).c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_FLAG_OVERLAPPED, nullptr);
+		if (read.handle == INVALID_HANDLE_VALUE)
+			return false;
+
+		if (read.size < 0)
+		{
+			LARGE_INTEGER file_size;
+			if (GetFileSizeEx(read.handle, &file_size) == FALSE || file_size.QuadPart > INT_MAX)
+			{
+				close_file(read);
+				return false;
+			}
+			read.size = (int)file_size.QuadPart;
+		}
+		return true;
+	}
+
+	void AsyncFileReaderBackend::close_file(AsyncFileRead &read)
+	{
+		if (read.handle != INVALID_HANDLE_VALUE)
+		{
+			CloseHandle(read.handle);
+			read.handle = INVALID_HANDLE_VALUE;
+		}
+	}
+
+	void AsyncFileReader_Impl::read_blocking(AsyncFileRead &read)
+	{
+		// Windows always has a completion port backend
+		read.result = -1;
+	}
+
+#else
+
+	bool AsyncFileReaderBackend::open_file(AsyncFileRead &read)
+	{
+		read.fd = ::open(read.filename.c_str(), O_RDONLY | O_CLOEXEC);
+		if (read.fd == -1)
+			return false;
+
+		if (read.size < 0)
+		{
+			struct stat file_stat;
+			if (fstat(read.fd, &file_stat) != 0 || file_stat.st_size > INT_MAX)
+			{
+				close_file(read);
+				return false;
+			}
+			read.size = (int)file_stat.st_size;
+		}
+		return true;
+	}
+
+	void AsyncFileReaderBackend::close_file(AsyncFileRead &read)
+	{
+		if (read.fd != -1)
+		{
+			::close(read.fd);
+			read.fd = -1;
+		}
+	}
+
+	void AsyncFileReader_Impl::read_blocking(AsyncFileRead &read)
+	{
+		AsyncFileReaderBackend_Blocking backend;
+		if (!backend.open_file(read))
+		{
+			read.result = -1;
+			return;
+		}
+
+		read.data = DataBuffer(read.size);
+		read.result = 0;
+		while (read.received < read.size)
+		{
+			ssize_t bytes = pread(read.fd, read.data.get_data() + read.received, read.size - read.received, read.offset + read.received);
+			if (bytes < 0 && errno == EINTR)
+				continue;
+			if (bytes <= 0)
+			{
+				if (bytes < 0)
+					read.result = -1;
+				break;
+			}
+			read.received += (int)bytes;
+		}
+		backend.close_file(read);
+
+		if (read.result >= 0)
+			read.data.set_size(read.received);
+		else
+			read.data = DataBuffer();
+	}
+
+#endif
+}
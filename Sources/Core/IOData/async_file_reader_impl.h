@@ -0,0 +1,86 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include "API/Core/IOData/async_file_reader.h"
+#include "API/Core/System/databuffer.h"
+#include <vector>
+
+namespace clan
+{
+	/// \brief State of a single read
+	class AsyncFileRead
+	{
+	public:
+		std::string filename;
+		int64_t offset = 0;
+		int size = 0;	// -1 until the size of a whole file read is known
+		AsyncFileReader::Callback completed;
+
+		DataBuffer data;
+		int received = 0;
+
+		/// \brief Bytes transferred by the last operation started, 0 at the end of the file or negative on failure
+		int result = 0;
+
+#ifdef WIN32
+		HANDLE handle = INVALID_HANDLE_VALUE;
+		OVERLAPPED overlapped;
+#else
+		int fd = -1;
+#endif
+		void *backend_data = nullptr;
+	};
+
+	/// \brief Operating system mechanism executing the reads of an AsyncFileReader
+	///
+	/// start_read and submit are called with the reader locked. wait is only called from the I/O thread
+	/// while reads are in flight, without the lock held.
+	class AsyncFileReaderBackend
+	{
+	public:
+		virtual ~AsyncFileReaderBackend() { }
+
+		virtual const char *get_name() const = 0;
+
+		/// \brief Opens the file and sets read.size for whole file reads
+		virtual bool open_file(AsyncFileRead &read);
+		virtual void close_file(AsyncFileRead &read);
+
+		/// \brief Queues a read of the remaining part of read.data. Returns false if no more reads fit in the queue.
+		virtual bool start_read(AsyncFileRead &read) = 0;
+
+		/// \brief Hands the reads started since the last call to the operating system
+		virtual void submit() { }
+
+		/// \brief Blocks until at least one read has finished an operation, setting read.result and read.received
+		virtual void wait(std::vector<AsyncFileRead *> &finished) = 0;
+	};
+}
@@ -0,0 +1,53 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "Core/precomp.h"
+#include "API/Core/IOData/buffered_device.h"
+#include "iodevice_impl.h"
+#include "iodevice_provider_buffered.h"
+
+namespace clan
+{
+	BufferedDevice::BufferedDevice(IODevice device, int buffer_size)
+		: IODevice(new IODeviceProvider_Buffered(device, buffer_size))
+	{
+	}
+
+	IODevice BufferedDevice::get_device()
+	{
+		IODeviceProvider_Buffered *provider = dynamic_cast<IODeviceProvider_Buffered*>(impl->provider);
+		return provider->get_device();
+	}
+
+	int BufferedDevice::get_buffer_size() const
+	{
+		const IODeviceProvider_Buffered *provider = dynamic_cast<const IODeviceProvider_Buffered*>(impl->provider);
+		return provider->get_buffer_size();
+	}
+}
@@ -33,6 +33,13 @@
 #include "API/Core/Text/string_help.h"
 #include "iodevice_impl.h"
 #include "iodevice_provider_file.h"
+#include <climits>
+#ifndef WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 namespace clan
 {
@@ -61,6 +68,63 @@ namespace clan
 		return buffer;
 	}
 
+	DataBuffer File::map_bytes(const std::string &filename)
+	{
+#ifdef WIN32
+		HANDLE file = CreateFile(StringHelp::utf8_to_ucs2(filename).c_str(), GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+		if (file == INVALID_HANDLE_VALUE)
+			throw Exception("Unable to open file " + filename);
+
+		LARGE_INTEGER file_size;
+		if (GetFileSizeEx(file, &file_size) == FALSE || file_size.QuadPart > UINT_MAX)
+		{
+			CloseHandle(file);
+			throw Exception("Unable to map file " + filename);
+		}
+		if (file_size.QuadPart == 0)
+		{
+			CloseHandle(file);
+			return DataBuffer();
+		}
+
+		// The view keeps the mapping alive after its handle is closed
+		HANDLE mapping = CreateFileMapping(file, 0, PAGE_WRITECOPY, 0, 0, 0);
+		CloseHandle(file);
+		if (mapping == 0)
+			throw Exception("Unable to map file " + filename);
+		void *data = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+		CloseHandle(mapping);
+		if (data == nullptr)
+			throw Exception("Unable to map file " + filename);
+
+		return DataBuffer::wrap(data, (unsigned int)file_size.QuadPart, [data]() { UnmapViewOfFile(data); });
+#else
+		int fd = ::open(StringHelp::text_to_local8(filename).c_str(), O_RDONLY);
+		if (fd == -1)
+			throw Exception("Unable to open file " + filename);
+
+		struct stat file_stat;
+		if (fstat(fd, &file_stat) == -1 || (uint64_t)file_stat.st_size > UINT_MAX)
+		{
+			::close(fd);
+			throw Exception("Unable to map file " + filename);
+		}
+		if (file_stat.st_size == 0)
+		{
+			::close(fd);
+			return DataBuffer();
+		}
+
+		size_t size = file_stat.st_size;
+		void *data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+		::close(fd);
+		if (data == MAP_FAILED)
+			throw Exception("Unable to map file " + filename);
+
+		return DataBuffer::wrap(data, (unsigned int)size, [data, size]() { munmap(data, size); });
+#endif
+	}
+
 	void File::write_text(const std::string &filename, const std::string &text, bool write_bom)
 	{
 		File file(filename, create_always, access_write);
@@ -113,6 +113,25 @@ namespace clan
 #else
 		struct stat stFileInfo;
 		return (stat(filename.c_str(), &stFileInfo) == 0);
+#endif
+	}
+
+	uint64_t FileHelp::get_last_write_time(const std::string &filename)
+	{
+#ifdef WIN32
+		WIN32_FILE_ATTRIBUTE_DATA attributes;
+		if (GetFileAttributesEx(StringHelp::utf8_to_ucs2(filename).c_str(), GetFileExInfoStandard, &attributes) == FALSE)
+			return 0;
+		return (((uint64_t)attributes.ftLastWriteTime.dwHighDateTime) << 32) | attributes.ftLastWriteTime.dwLowDateTime;
+#else
+		struct stat stFileInfo;
+		if (stat(filename.c_str(), &stFileInfo) != 0)
+			return 0;
+#ifdef __linux__
+		return (uint64_t)stFileInfo.st_mtim.tv_sec * 1000000000 + stFileInfo.st_mtim.tv_nsec;
+#else
+		return (uint64_t)stFileInfo.st_mtime * 1000000000;
+#endif
 #endif
 	}
 }
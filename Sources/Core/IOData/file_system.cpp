@@ -37,13 +37,36 @@
 #include "file_system_provider_file.h"
 #include "file_system_provider_zip.h"
 
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
 namespace clan
 {
+	class FileSystem_Mount
+	{
+	public:
+		FileSystem_Mount(const std::string &mount_point, FileSystem fs, int serial) : mount_point(mount_point), fs(fs), serial(serial), listed(false)
+		{
+		}
+
+		std::string mount_point;
+		FileSystem fs;
+
+		/// \brief Mounts with higher serials override files of mounts with lower ones
+		int serial;
+
+		bool listed;
+
+		/// \brief Absolute virtual path to is_directory for everything found in the mount when it was listed
+		std::unordered_map<std::string, bool> entries;
+	};
+
 	class FileSystem_Impl
 	{
 		//! Construction:
 	public:
-		FileSystem_Impl() : provider(nullptr)
+		FileSystem_Impl() : provider(nullptr), next_mount_serial(0)
 		{
 		}
 
@@ -54,9 +77,33 @@ namespace clan
 
 		//! Attributes:
 	public:
+		struct IndexEntry
+		{
+			FileSystem_Mount *mount;
+			bool is_directory;
+		};
+
 		FileSystemProvider *provider;
 
-		std::vector< std::pair<std::string, FileSystem> > mounts;
+		std::vector<std::shared_ptr<FileSystem_Mount>> mounts;
+		int next_mount_serial;
+
+		/// \brief Merged index of all mounts, keyed by absolute virtual path
+		std::unordered_map<std::string, IndexEntry> index;
+
+		/// \brief Absolute virtual paths that could not be opened for reading
+		std::unordered_set<std::string> missing_files;
+
+		std::recursive_mutex mutex;
+
+		//! Operations:
+	public:
+		const IndexEntry *find_indexed(const std::string &path);
+		void update_index();
+		void remove_from_index(FileSystem_Mount *mount);
+
+	private:
+		void list_directory(FileSystem_Mount *mount, const std::string &path);
 	};
 
 	FileSystem::FileSystem()
@@ -91,11 +138,12 @@ namespace clan
 	bool FileSystem::is_mount(const std::string &mount_point)
 	{
 		std::string mount_point_slash = PathHelp::add_trailing_slash(mount_point, PathHelp::path_type_virtual);
+		std::unique_lock<std::recursive_mutex> lock(impl->mutex);
 		int index, size;
 		size = (int)impl->mounts.size();
 		for (index = 0; index < size; index++)
 		{
-			if (impl->mounts[index].first == mount_point_slash)
+			if (impl->mounts[index]->mount_point == mount_point_slash)
 			{
 				return true;
 			}
@@ -111,15 +159,20 @@ namespace clan
 			PathHelp::path_type_virtual);
 
 		// First see if its a mount point:
+		std::unique_lock<std::recursive_mutex> lock(impl->mutex);
 		int index, size;
 		size = (int)impl->mounts.size();
 		for (index = 0; index < size; index++)
 		{
-			if (impl->mounts[index].first == path.substr(0, impl->mounts[index].first.length()))
+			if (impl->mounts[index]->mount_point == path.substr(0, impl->mounts[index]->mount_point.length()))
 			{
-				return impl->mounts[index].second.get_directory_listing(path.substr(impl->mounts[index].first.length(), path.length()));
+				FileSystem fs = impl->mounts[index]->fs;
+				std::string mount_point = impl->mounts[index]->mount_point;
+				lock.unlock();
+				return fs.get_directory_listing(path.substr(mount_point.length(), path.length()));
 			}
 		}
+		lock.unlock();
 
 		// Try open locally, if we got a file provider attached
 		if (impl->provider)
@@ -153,13 +206,15 @@ namespace clan
 		std::string internal_name = "/";
 
 		// Add on the mount point names
+		std::unique_lock<std::recursive_mutex> lock(impl->mutex);
 		int index, size;
 		size = (int)impl->mounts.size();
 		for (index = 0; index < size; index++)
 		{
-			internal_name += impl->mounts[index].first;
-			internal_name += impl->mounts[index].second.get_identifier();
+			internal_name += impl->mounts[index]->mount_point;
+			internal_name += impl->mounts[index]->fs.get_identifier();
 		}
+		lock.unlock();
 
 		if (impl->provider)
 			internal_name = internal_name + impl->provider->get_identifier();
@@ -178,29 +233,65 @@ namespace clan
 			filename_rel,
 			PathHelp::path_type_virtual);
 
-		// First see if its a file for one of our mount points:
-		int index, size;
-		size = (int)impl->mounts.size();
-		for (index = 0; index < size; index++)
+		bool read_existing = (mode == File::open_existing) && !(access & File::access_write);
+
+		std::unique_lock<std::recursive_mutex> lock(impl->mutex);
+		if (read_existing)
 		{
-			if (impl->mounts[index].first == filename.substr(0, impl->mounts[index].first.length()))
+			// Use the mount that provides the file in the merged index, so later mounts override earlier ones
+			const FileSystem_Impl::IndexEntry *entry = impl->find_indexed(filename);
+			if (entry && !entry->is_directory)
 			{
-				return impl->mounts[index].second.open_file(filename.substr(impl->mounts[index].first.length(), filename.length()));
+				FileSystem fs = entry->mount->fs;
+				std::string mount_point = entry->mount->mount_point;
+				lock.unlock();
+				return fs.open_file(filename.substr(mount_point.length(), filename.length()));
 			}
+
+			if (impl->missing_files.find(filename) != impl->missing_files.end())
+				throw Exception(string_format("Unable to open file: %1", filename));
 		}
 
-		// Try open locally, if we got a file provider attached
-		if (impl->provider)
+		try
 		{
-			return impl->provider->open_file(
-				PathHelp::make_relative(
-				"/",
-				filename,
-				PathHelp::path_type_virtual), mode, access, share, flags);
+			// First see if its a file for one of our mount points:
+			int index, size;
+			size = (int)impl->mounts.size();
+			for (index = 0; index < size; index++)
+			{
+				if (impl->mounts[index]->mount_point == filename.substr(0, impl->mounts[index]->mount_point.length()))
+				{
+					FileSystem fs = impl->mounts[index]->fs;
+					std::string mount_point = impl->mounts[index]->mount_point;
+					lock.unlock();
+					return fs.open_file(filename.substr(mount_point.length(), filename.length()));
+				}
+			}
+			lock.unlock();
+
+			// Try open locally, if we got a file provider attached
+			if (impl->provider)
+			{
+				return impl->provider->open_file(
+					PathHelp::make_relative(
+					"/",
+					filename,
+					PathHelp::path_type_virtual), mode, access, share, flags);
+			}
+			else
+			{
+				throw Exception(string_format("Unable to open file: %1", filename));
+			}
 		}
-		else
+		catch (const Exception &)
 		{
-			throw Exception(string_format("Unable to open file: %1", filename));
+			if (read_existing)
+			{
+				if (!lock.owns_lock())
+					lock.lock();
+				impl->missing_files.insert(filename);
+			}
+			throw;
 		}
 	}
 
@@ -212,7 +303,11 @@ namespace clan
 			mount_point,
 			PathHelp::path_type_virtual),
 			PathHelp::path_type_virtual);
-		impl->mounts.push_back(std::pair<std::string, FileSystem>(mount_point_slash, fs));
+
+		// The new mount is listed and merged into the index on the next lookup
+		std::unique_lock<std::recursive_mutex> lock(impl->mutex);
+		impl->mounts.push_back(std::make_shared<FileSystem_Mount>(mount_point_slash, fs, impl->next_mount_serial++));
+		impl->missing_files.clear();
 	}
 
 	void FileSystem::mount(const std::string &mount_point, const std::string &path, bool is_zip_file)
@@ -231,21 +326,58 @@ namespace clan
 			mount_point,
 			PathHelp::path_type_virtual),
 			PathHelp::path_type_virtual);
+		std::unique_lock<std::recursive_mutex> lock(impl->mutex);
 		int index, size;
 		size = (int)impl->mounts.size();
 		for (index = 0; index < size; index++)
 		{
-			if (impl->mounts[index].first == mount_point_slash)
+			if (impl->mounts[index]->mount_point == mount_point_slash)
 			{
+				std::shared_ptr<FileSystem_Mount> mount = impl->mounts[index];
 				impl->mounts.erase(impl->mounts.begin() + index);
+				impl->remove_from_index(mount.get());
 				size--;
 				index--;
 			}
 		}
+		impl->missing_files.clear();
+	}
+
+	void FileSystem::refresh_index(const std::string &mount_point)
+	{
+		std::string mount_point_slash;
+		if (!mount_point.empty())
+		{
+			mount_point_slash = PathHelp::add_trailing_slash(
+				PathHelp::make_absolute(
+				"/",
+				mount_point,
+				PathHelp::path_type_virtual),
+				PathHelp::path_type_virtual);
+		}
+
+		std::unique_lock<std::recursive_mutex> lock(impl->mutex);
+		for (auto &mount : impl->mounts)
+		{
+			if (mount_point_slash.empty() || mount->mount_point == mount_point_slash)
+			{
+				impl->remove_from_index(mount.get());
+				mount->entries.clear();
+				mount->listed = false;
+			}
+		}
+		impl->missing_files.clear();
 	}
 
 	bool FileSystem::has_directory(const std::string &directory)
 	{
+		std::string path = PathHelp::remove_trailing_slash(PathHelp::make_absolute("/", directory, PathHelp::path_type_virtual));
+		std::unique_lock<std::recursive_mutex> lock(impl->mutex);
+		const FileSystem_Impl::IndexEntry *entry = impl->find_indexed(path);
+		if (entry)
+			return entry->is_directory;
+		lock.unlock();
+
 		DirectoryListing list = get_directory_listing(PathHelp::get_basepath(directory, PathHelp::path_type_virtual));
 		std::string dir_name = PathHelp::get_filename(PathHelp::remove_trailing_slash(directory));
 		while (list.next())
@@ -259,6 +391,13 @@ namespace clan
 
 	bool FileSystem::has_file(const std::string &filename)
 	{
+		std::string path = PathHelp::make_absolute("/", filename, PathHelp::path_type_virtual);
+		std::unique_lock<std::recursive_mutex> lock(impl->mutex);
+		const FileSystem_Impl::IndexEntry *entry = impl->find_indexed(path);
+		if (entry)
+			return !entry->is_directory;
+		lock.unlock();
+
 		DirectoryListing list = get_directory_listing(PathHelp::get_basepath(filename, PathHelp::path_type_virtual));
 		std::string fil_name = PathHelp::get_filename(filename);
 		while (list.next())
@@ -269,4 +408,97 @@ namespace clan
 
 		return false;
 	}
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	const FileSystem_Impl::IndexEntry *FileSystem_Impl::find_indexed(const std::string &path)
+	{
+		update_index();
+		auto it = index.find(path);
+		if (it != index.end())
+			return &it->second;
+		return nullptr;
+	}
+
+	void FileSystem_Impl::update_index()
+	{
+		for (auto &mount : mounts)
+		{
+			if (mount->listed)
+				continue;
+
+			mount->listed = true;
+			try
+			{
+				list_directory(mount.get(), std::string());
+			}
+			catch (const Exception &)
+			{
+				// A mount that cannot be listed is still reachable by prefix, it just does not take part in the index
+			}
+
+			for (const auto &entry : mount->entries)
+			{
+				auto it = index.find(entry.first);
+				if (it == index.end() || it->second.mount->serial < mount->serial)
+				{
+					IndexEntry &index_entry = index[entry.first];
+					index_entry.mount = mount.get();
+					index_entry.is_directory = entry.second;
+				}
+			}
+		}
+	}
+
+	void FileSystem_Impl::remove_from_index(FileSystem_Mount *mount)
+	{
+		for (const auto &entry : mount->entries)
+		{
+			auto it = index.find(entry.first);
+			if (it == index.end() || it->second.mount != mount)
+				continue;
+
+			// Fall back to the newest other mount that provides the same path
+			FileSystem_Mount *replacement = nullptr;
+			bool is_directory = false;
+			for (auto &other : mounts)
+			{
+				if (other.get() == mount || !other->listed || (replacement && replacement->serial > other->serial))
+					continue;
+
+				auto other_entry = other->entries.find(entry.first);
+				if (other_entry != other->entries.end())
+				{
+					replacement = other.get();
+					is_directory = other_entry->second;
+				}
+			}
+
+			if (replacement)
+			{
+				it->second.mount = replacement;
+				it->second.is_directory = is_directory;
+			}
+			else
+			{
+				index.erase(it);
+			}
+		}
+	}
+
+	void FileSystem_Impl::list_directory(FileSystem_Mount *mount, const std::string &path)
+	{
+		DirectoryListing listing = mount->fs.get_directory_listing(path);
+		while (listing.next())
+		{
+			std::string filename = listing.get_filename();
+			if (filename.empty() || filename == "." || filename == "..")
+				continue;
+
+			bool is_directory = listing.is_directory();
+			mount->entries[mount->mount_point + path + filename] = is_directory;
+			if (is_directory)
+				list_directory(mount, path + filename + "/");
+		}
+	}
 }
@@ -55,14 +55,14 @@ namespace clan
 			throw Exception("IODevice is null");
 	}
 
-	int IODevice::get_size() const
+	int64_t IODevice::get_size() const
 	{
 		if (impl)
 			return impl->provider->get_size();
 		return -1;
 	}
 
-	int IODevice::get_position() const
+	int64_t IODevice::get_position() const
 	{
 		if (impl)
 			return impl->provider->get_position();
@@ -107,7 +107,7 @@ namespace clan
 		return -1;
 	}
 
-	bool IODevice::seek(int position, SeekMode mode)
+	bool IODevice::seek(int64_t position, SeekMode mode)
 	{
 		if (impl)
 			return impl->provider->seek(position, mode);
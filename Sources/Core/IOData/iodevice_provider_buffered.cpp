@@ -0,0 +1,189 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "Core/precomp.h"
+#include "iodevice_provider_buffered.h"
+#include <algorithm>
+
+namespace clan
+{
+	IODeviceProvider_Buffered::IODeviceProvider_Buffered(IODevice device, int buffer_size)
+		: device(device), buffer(buffer_size > 0 ? buffer_size : 1)
+	{
+	}
+
+	IODeviceProvider_Buffered::~IODeviceProvider_Buffered()
+	{
+		try
+		{
+			discard_buffer();
+		}
+		catch (const Exception &)
+		{
+		}
+	}
+
+	int64_t IODeviceProvider_Buffered::get_size() const
+	{
+		return device.get_size();
+	}
+
+	int64_t IODeviceProvider_Buffered::get_position() const
+	{
+		int64_t position = device.get_position();
+		if (position < 0)
+			return position;
+		return position - get_buffered();
+	}
+
+	int IODeviceProvider_Buffered::send(const void *data, int len, bool send_all)
+	{
+		discard_buffer();
+		return device.send(data, len, send_all);
+	}
+
+	int IODeviceProvider_Buffered::receive(void *data, int len, bool receive_all)
+	{
+		char *dest = (char *)data;
+		int received = 0;
+		while (received < len)
+		{
+			int buffered = get_buffered();
+			if (buffered > 0)
+			{
+				int copy_size = std::min(buffered, len - received);
+				memcpy(dest + received, buffer.get_data() + buffer_pos, copy_size);
+				buffer_pos += copy_size;
+				received += copy_size;
+				continue;
+			}
+
+			int remaining = len - received;
+			int result;
+			if (remaining >= (int)buffer.get_size())
+			{
+				// Large reads go straight to the device instead of through the buffer
+				buffer_pos = 0;
+				buffer_end = 0;
+				result = device.receive(dest + received, remaining, receive_all);
+				if (result > 0)
+					received += result;
+			}
+			else
+			{
+				result = fill_buffer(1);
+			}
+
+			if (result <= 0 || (!receive_all && received > 0))
+				break;
+		}
+		return received;
+	}
+
+	int IODeviceProvider_Buffered::peek(void *data, int len)
+	{
+		if (len > (int)buffer.get_size())
+		{
+			discard_buffer();
+			return device.peek(data, len);
+		}
+
+		if (get_buffered() < len)
+			fill_buffer(len);
+
+		int peek_size = std::min(get_buffered(), len);
+		memcpy(data, buffer.get_data() + buffer_pos, peek_size);
+		return peek_size;
+	}
+
+	bool IODeviceProvider_Buffered::seek(int64_t position, IODevice::SeekMode mode)
+	{
+		// Seeks inside the buffered data only move the buffer position
+		int64_t offset = -1;
+		if (mode == IODevice::seek_cur)
+		{
+			offset = buffer_pos + position;
+		}
+		else if (mode == IODevice::seek_set && buffer_end > 0)
+		{
+			int64_t device_position = device.get_position();
+			if (device_position >= 0)
+				offset = position - (device_position - buffer_end);
+		}
+
+		if (offset >= 0 && offset <= buffer_end)
+		{
+			buffer_pos = (int)offset;
+			return true;
+		}
+
+		if (mode == IODevice::seek_cur)
+			position -= get_buffered();
+		buffer_pos = 0;
+		buffer_end = 0;
+		return device.seek(position, mode);
+	}
+
+	IODeviceProvider *IODeviceProvider_Buffered::duplicate()
+	{
+		return new IODeviceProvider_Buffered(device.duplicate(), buffer.get_size());
+	}
+
+	void IODeviceProvider_Buffered::discard_buffer()
+	{
+		int buffered = get_buffered();
+		buffer_pos = 0;
+		buffer_end = 0;
+		if (buffered > 0)
+			device.seek(-buffered, IODevice::seek_cur);
+	}
+
+	int IODeviceProvider_Buffered::fill_buffer(int min_size)
+	{
+		// Keep the unread data, moved to the start of the buffer
+		int buffered = get_buffered();
+		if (buffer_pos > 0)
+		{
+			memmove(buffer.get_data(), buffer.get_data() + buffer_pos, buffered);
+			buffer_pos = 0;
+			buffer_end = buffered;
+		}
+
+		int total = 0;
+		while (buffer_end < min_size)
+		{
+			int result = device.receive(buffer.get_data() + buffer_end, buffer.get_size() - buffer_end, false);
+			if (result <= 0)
+				break;
+			buffer_end += result;
+			total += result;
+		}
+		return total;
+	}
+}
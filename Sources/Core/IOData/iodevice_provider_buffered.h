@@ -0,0 +1,65 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include "API/Core/IOData/iodevice_provider.h"
+#include "API/Core/System/databuffer.h"
+
+namespace clan
+{
+	class IODeviceProvider_Buffered : public IODeviceProvider
+	{
+	public:
+		IODeviceProvider_Buffered(IODevice device, int buffer_size);
+		~IODeviceProvider_Buffered();
+
+		int64_t get_size() const override;
+		int64_t get_position() const override;
+
+		IODevice &get_device() { return device; }
+		int get_buffer_size() const { return buffer.get_size(); }
+
+		int send(const void *data, int len, bool send_all) override;
+		int receive(void *data, int len, bool receive_all) override;
+		int peek(void *data, int len) override;
+		bool seek(int64_t position, IODevice::SeekMode mode) override;
+		IODeviceProvider *duplicate() override;
+
+	private:
+		int get_buffered() const { return buffer_end - buffer_pos; }
+		void discard_buffer();
+		int fill_buffer(int min_size);
+
+		IODevice device;
+		DataBuffer buffer;
+		int buffer_pos = 0;
+		int buffer_end = 0;
+	};
+}
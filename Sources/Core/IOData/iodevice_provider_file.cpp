@@ -72,17 +72,17 @@ namespace clan
 		close();
 	}
 
-	int IODeviceProvider_File::get_size() const
+	int64_t IODeviceProvider_File::get_size() const
 	{
 #ifdef WIN32
 		if (handle == invalid_handle)
 			throw Exception("IODeviceProvider_File::get_size(): Unable to get file size, no file open");
 
-		DWORD size = GetFileSize(handle, 0);
-		if (size == INVALID_FILE_SIZE)
+		LARGE_INTEGER size;
+		if (GetFileSizeEx(handle, &size) == FALSE)
 			throw Exception("IODeviceProvider_File::get_size(): Unable to get file size");
 
-		return size;
+		return size.QuadPart;
 #else
 		if (handle == invalid_handle)
 			throw Exception("IODeviceProvider_File::get_size(): Unable to get file size, no file open");
@@ -96,21 +96,22 @@ namespace clan
 		if (size == (off_t) -1)
 			throw Exception("IODeviceProvider_File::get_size(): Unable to get file size");
 
-		return (int) size;
+		return size;
 #endif
 	}
 
-	int IODeviceProvider_File::get_position() const
+	int64_t IODeviceProvider_File::get_position() const
 	{
 #ifdef WIN32
 		if (handle == invalid_handle)
 			throw Exception("IODeviceProvider_File::get_position(): Unable to get file position pointer, no file open");
 
-		DWORD pos = SetFilePointer(handle, 0, 0, FILE_CURRENT);
-		if (pos == INVALID_SET_FILE_POINTER)
+		LARGE_INTEGER distance, pos;
+		distance.QuadPart = 0;
+		if (SetFilePointerEx(handle, distance, &pos, FILE_CURRENT) == FALSE)
 			throw Exception("IODeviceProvider_File::get_position(): Unable to get file position pointer");
 
-		return (int)pos;
+		return pos.QuadPart;
 #else
 		if (handle == invalid_handle)
 			throw Exception("Unable to get file position pointer, no file open");
@@ -214,6 +215,19 @@ namespace clan
 		if (handle == -1)
 			return false;
 
+		// Read-ahead hints are advisory, so failures are ignored
+#if defined(__APPLE__)
+		if (flags & File::flag_sequential_scan)
+			fcntl(handle, F_RDAHEAD, 1);
+		else if (flags & File::flag_random_access)
+			fcntl(handle, F_RDAHEAD, 0);
+#elif defined(POSIX_FADV_SEQUENTIAL)
+		if (flags & File::flag_sequential_scan)
+			posix_fadvise(handle, 0, 0, POSIX_FADV_SEQUENTIAL);
+		else if (flags & File::flag_random_access)
+			posix_fadvise(handle, 0, 0, POSIX_FADV_RANDOM);
+#endif
+
 		return true;
 #endif
 	}
@@ -301,7 +315,7 @@ namespace clan
 		}
 	}
 
-	bool IODeviceProvider_File::seek(int position, IODevice::SeekMode seek_mode)
+	bool IODeviceProvider_File::seek(int64_t position, IODevice::SeekMode seek_mode)
 	{
 		if (handle == invalid_handle)
 			throw Exception("IODeviceProvider_File::seek(): Unable to get file position pointer, no file open");
@@ -315,8 +329,9 @@ namespace clan
 		case IODevice::seek_end: moveMethod = FILE_END; break;
 		}
 
-		DWORD new_pos = SetFilePointer(handle, position, 0, moveMethod);
-		return (new_pos != INVALID_FILE_SIZE);
+		LARGE_INTEGER distance;
+		distance.QuadPart = position;
+		return SetFilePointerEx(handle, distance, 0, moveMethod) != FALSE;
 #else
 		int mode = SEEK_SET;
 		if (seek_mode == File::seek_set)
@@ -326,7 +341,10 @@ namespace clan
 		else if (seek_mode == File::seek_end)
 			mode = SEEK_END;
 
-		off_t new_pos = lseek(handle, position, mode);
+		if ((off_t)position != position)
+			return false;
+
+		off_t new_pos = lseek(handle, (off_t)position, mode);
 		if (new_pos == (off_t) -1)
 			return false;
 		else
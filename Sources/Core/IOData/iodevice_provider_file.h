@@ -48,8 +48,8 @@ namespace clan
 
 		~IODeviceProvider_File();
 
-		int get_size() const override;
-		int get_position() const override;
+		int64_t get_size() const override;
+		int64_t get_position() const override;
 
 		bool open(
 			const std::string &filename,
@@ -66,7 +66,7 @@ namespace clan
 		int receive(void *data, int len, bool receive_all) override;
 		int peek(void *data, int len) override;
 
-		bool seek(int position, IODevice::SeekMode mode) override;
+		bool seek(int64_t position, IODevice::SeekMode mode) override;
 
 		IODeviceProvider *duplicate() override;
 
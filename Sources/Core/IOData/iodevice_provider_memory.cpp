@@ -43,12 +43,12 @@ namespace clan
 	{
 	}
 
-	int IODeviceProvider_Memory::get_size() const
+	int64_t IODeviceProvider_Memory::get_size() const
 	{
 		return data.get_size();
 	}
 
-	int IODeviceProvider_Memory::get_position() const
+	int64_t IODeviceProvider_Memory::get_position() const
 	{
 		validate_position();
 		return position;
@@ -104,10 +104,10 @@ namespace clan
 		return len;
 	}
 
-	bool IODeviceProvider_Memory::seek(int requested_position, IODevice::SeekMode mode)
+	bool IODeviceProvider_Memory::seek(int64_t requested_position, IODevice::SeekMode mode)
 	{
 		validate_position();
-		int new_position = position;
+		int64_t new_position = position;
 		switch (mode)
 		{
 		case IODevice::seek_set:
@@ -117,15 +117,15 @@ namespace clan
 			new_position += requested_position;
 			break;
 		case IODevice::seek_end:
-			new_position = data.get_size() + requested_position;
+			new_position = (int64_t)data.get_size() + requested_position;
 			break;
 		default:
 			return false;
 		}
 
-		if (new_position >= 0 && new_position <= data.get_size())
+		if (new_position >= 0 && new_position <= (int64_t)data.get_size())
 		{
-			position = new_position;
+			position = (int)new_position;
 			return true;
 		}
 		else
@@ -39,8 +39,8 @@ namespace clan
 		IODeviceProvider_Memory();
 		IODeviceProvider_Memory(DataBuffer &data);
 
-		virtual int get_size() const override;
-		virtual int get_position() const override;
+		virtual int64_t get_size() const override;
+		virtual int64_t get_position() const override;
 
 		const DataBuffer &get_data() const;
 		DataBuffer &get_data();
@@ -48,7 +48,7 @@ namespace clan
 		virtual int send(const void *data, int len, bool send_all = true) override;
 		virtual int receive(void *data, int len, bool receive_all = true) override;
 		virtual int peek(void *data, int len) override;
-		virtual bool seek(int position, IODevice::SeekMode mode) override;
+		virtual bool seek(int64_t position, IODevice::SeekMode mode) override;
 		IODeviceProvider *duplicate() override;
 
 	private:
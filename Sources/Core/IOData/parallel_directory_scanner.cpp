@@ -0,0 +1,553 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "Core/precomp.h"
+#include "API/Core/IOData/parallel_directory_scanner.h"
+#include "API/Core/IOData/path_help.h"
+#include "API/Core/System/system.h"
+#include "API/Core/Text/string_help.h"
+#include <atomic>
+#include <condition_variable>
+#include <ctime>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#ifndef WIN32
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <fnmatch.h>
+#endif
+
+namespace clan
+{
+	class ParallelDirectoryScanner_Entry
+	{
+	public:
+		std::string name;
+		int64_t size = 0;
+		bool directory = false;
+		bool hidden = false;
+		bool link = false;
+		bool matches = false;
+	};
+
+	class ParallelDirectoryScanner_Batch
+	{
+	public:
+		std::shared_ptr<const std::string> directory_path;
+		std::vector<ParallelDirectoryScanner_Entry> entries;
+	};
+
+	class ParallelDirectoryScanner_CachedListing
+	{
+	public:
+		int64_t modified = 0;
+		std::vector<ParallelDirectoryScanner_Entry> entries;
+	};
+
+	class ParallelDirectoryScanner_Cache
+	{
+	public:
+		static ParallelDirectoryScanner_Cache &instance()
+		{
+			static ParallelDirectoryScanner_Cache cache;
+			return cache;
+		}
+
+		std::atomic<bool> enabled { false };
+		std::mutex mutex;
+		std::unordered_map<std::string, ParallelDirectoryScanner_CachedListing> listings;
+	};
+
+	class ParallelDirectoryScanner_Impl
+	{
+	public:
+		~ParallelDirectoryScanner_Impl()
+		{
+			stop();
+		}
+
+		bool start(const std::string &pathname, const std::string &pattern, int num_threads);
+		bool next();
+		void stop();
+
+		ParallelDirectoryScanner_Batch current;
+		size_t current_index = 0;
+
+	private:
+		void worker_main();
+		void scan_directory(const std::string &directory_path, ParallelDirectoryScanner_Batch &batch, std::vector<std::string> &subdirectories);
+		bool list_directory(const std::string &directory_path, bool match_all, std::vector<ParallelDirectoryScanner_Entry> &entries);
+		bool match_name(const std::string &name) const;
+		static bool get_modified_time(const std::string &directory_path, int64_t &out_modified);
+
+#ifdef WIN32
+		static bool match_wildcard(const wchar_t *pattern, const wchar_t *name);
+		std::wstring native_pattern;
+#else
+		std::string native_pattern;
+#endif
+		bool use_pattern = false;
+
+		std::mutex mutex;
+		std::condition_variable directory_event;
+		std::condition_variable result_event;
+		std::deque<std::string> directories;
+		std::deque<ParallelDirectoryScanner_Batch> results;
+		int active_workers = 0;
+		bool finished = true;
+		bool cancelled = false;
+		std::vector<std::thread> threads;
+	};
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	ParallelDirectoryScanner::ParallelDirectoryScanner() : impl(std::make_shared<ParallelDirectoryScanner_Impl>())
+	{
+	}
+
+	ParallelDirectoryScanner::~ParallelDirectoryScanner()
+	{
+	}
+
+	std::string ParallelDirectoryScanner::get_directory_path()
+	{
+		if (!impl->current.directory_path)
+			return std::string();
+		return *impl->current.directory_path;
+	}
+
+	std::string ParallelDirectoryScanner::get_name()
+	{
+		if (impl->current_index >= impl->current.entries.size())
+			return std::string();
+		return impl->current.entries[impl->current_index].name;
+	}
+
+	std::string ParallelDirectoryScanner::get_pathname()
+	{
+		if (impl->current_index >= impl->current.entries.size())
+			return std::string();
+		return *impl->current.directory_path + impl->current.entries[impl->current_index].name;
+	}
+
+	int64_t ParallelDirectoryScanner::get_size()
+	{
+		if (impl->current_index >= impl->current.entries.size())
+			return 0;
+		return impl->current.entries[impl->current_index].size;
+	}
+
+	bool ParallelDirectoryScanner::is_directory()
+	{
+		if (impl->current_index >= impl->current.entries.size())
+			return false;
+		return impl->current.entries[impl->current_index].directory;
+	}
+
+	bool ParallelDirectoryScanner::is_hidden()
+	{
+		if (impl->current_index >= impl->current.entries.size())
+			return false;
+		return impl->current.entries[impl->current_index].hidden;
+	}
+
+	bool ParallelDirectoryScanner::scan(const std::string &pathname, const std::string &pattern, int num_threads)
+	{
+		return impl->start(pathname, pattern, num_threads);
+	}
+
+	bool ParallelDirectoryScanner::next()
+	{
+		return impl->next();
+	}
+
+	void ParallelDirectoryScanner::cancel()
+	{
+		impl->stop();
+	}
+
+	void ParallelDirectoryScanner::set_cache_enabled(bool enable)
+	{
+		ParallelDirectoryScanner_Cache::instance().enabled = enable;
+		if (!enable)
+			clear_cache();
+	}
+
+	void ParallelDirectoryScanner::clear_cache()
+	{
+		ParallelDirectoryScanner_Cache &cache = ParallelDirectoryScanner_Cache::instance();
+		std::unique_lock<std::mutex> lock(cache.mutex);
+		cache.listings.clear();
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	bool ParallelDirectoryScanner_Impl::start(const std::string &pathname, const std::string &pattern, int num_threads)
+	{
+		stop();
+
+		std::string root = pathname.empty() ? std::string(".") : pathname;
+		root = PathHelp::add_trailing_slash(root, PathHelp::path_type_file);
+
+		int64_t modified = 0;
+		if (!get_modified_time(root, modified))
+			return false;
+
+		use_pattern = !pattern.empty() && pattern != "*";
+#ifdef WIN32
+		native_pattern = StringHelp::utf8_to_ucs2(pattern);
+#else
+		native_pattern = pattern;
+#endif
+
+		if (num_threads <= 0)
+			num_threads = System::get_num_cores();
+
+		directories.push_back(root);
+		active_workers = 0;
+		finished = false;
+		cancelled = false;
+
+		for (int i = 0; i < num_threads; i++)
+			threads.push_back(std::thread(&ParallelDirectoryScanner_Impl::worker_main, this));
+		return true;
+	}
+
+	bool ParallelDirectoryScanner_Impl::next()
+	{
+		if (current_index + 1 < current.entries.size())
+		{
+			current_index++;
+			return true;
+		}
+
+		std::unique_lock<std::mutex> lock(mutex);
+		result_event.wait(lock, [&]() { return !results.empty() || finished || cancelled; });
+		if (results.empty())
+		{
+			current = ParallelDirectoryScanner_Batch();
+			current_index = 0;
+			return false;
+		}
+
+		current = std::move(results.front());
+		results.pop_front();
+		current_index = 0;
+		return true;
+	}
+
+	void ParallelDirectoryScanner_Impl::stop()
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			cancelled = true;
+		}
+		directory_event.notify_all();
+		result_event.notify_all();
+
+		for (auto &thread : threads)
+			thread.join();
+		threads.clear();
+
+		directories.clear();
+		results.clear();
+		current = ParallelDirectoryScanner_Batch();
+		current_index = 0;
+		finished = true;
+	}
+
+	void ParallelDirectoryScanner_Impl::worker_main()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		while (true)
+		{
+			directory_event.wait(lock, [&]() { return cancelled || finished || !directories.empty(); });
+			if (cancelled || finished)
+				break;
+
+			std::string directory_path = std::move(directories.front());
+			directories.pop_front();
+			active_workers++;
+			lock.unlock();
+
+			ParallelDirectoryScanner_Batch batch;
+			std::vector<std::string> subdirectories;
+			scan_directory(directory_path, batch, subdirectories);
+
+			lock.lock();
+			active_workers--;
+
+			// Results are queued before the subdirectories, so a directory is always returned before its contents
+			if (!batch.entries.empty())
+				results.push_back(std::move(batch));
+			for (auto &subdirectory : subdirectories)
+				directories.push_back(std::move(subdirectory));
+			if (directories.empty() && active_workers == 0)
+				finished = true;
+
+			result_event.notify_all();
+			if (!subdirectories.empty() || finished)
+				directory_event.notify_all();
+		}
+	}
+
+	void ParallelDirectoryScanner_Impl::scan_directory(const std::string &directory_path, ParallelDirectoryScanner_Batch &batch, std::vector<std::string> &subdirectories)
+	{
+		ParallelDirectoryScanner_Cache &cache = ParallelDirectoryScanner_Cache::instance();
+		if (cache.enabled)
+		{
+			int64_t modified = 0;
+			bool found = false;
+			if (get_modified_time(directory_path, modified))
+			{
+				std::unique_lock<std::mutex> lock(cache.mutex);
+				auto it = cache.listings.find(directory_path);
+				if (it != cache.listings.end() && it->second.modified == modified)
+				{
+					batch.entries = it->second.entries;
+					found = true;
+				}
+			}
+
+			if (!found)
+			{
+				if (!list_directory(directory_path, true, batch.entries))
+					return;
+
+				// A directory changed in the last couple of seconds could change again without a new modification
+				// time, as some file systems store it with a resolution of one or two seconds
+				if (modified != 0 && modified + 2 < (int64_t)time(nullptr))
+				{
+					std::unique_lock<std::mutex> lock(cache.mutex);
+					ParallelDirectoryScanner_CachedListing &listing = cache.listings[directory_path];
+					listing.modified = modified;
+					listing.entries = batch.entries;
+				}
+			}
+
+			for (auto &entry : batch.entries)
+				entry.matches = !use_pattern || match_name(entry.name);
+		}
+		else
+		{
+			if (!list_directory(directory_path, false, batch.entries))
+				return;
+		}
+
+		size_t matched = 0;
+		for (size_t i = 0; i < batch.entries.size(); i++)
+		{
+			ParallelDirectoryScanner_Entry &entry = batch.entries[i];
+			if (entry.directory && !entry.link)
+				subdirectories.push_back(directory_path + entry.name + "/");
+			if (entry.matches)
+			{
+				if (matched != i)
+					batch.entries[matched] = std::move(entry);
+				matched++;
+			}
+		}
+		batch.entries.resize(matched);
+		batch.directory_path = std::make_shared<std::string>(directory_path);
+	}
+
+#ifdef WIN32
+
+	bool ParallelDirectoryScanner_Impl::list_directory(const std::string &directory_path, bool match_all, std::vector<ParallelDirectoryScanner_Entry> &entries)
+	{
+		WIN32_FIND_DATAW data;
+		HANDLE handle = FindFirstFileExW(StringHelp::utf8_to_ucs2(directory_path + "*").c_str(), FindExInfoBasic, &data, FindExSearchNameMatch, nullptr, FIND_FIRST_EX_LARGE_FETCH);
+		if (handle == INVALID_HANDLE_VALUE)
+			return false;
+
+		do
+		{
+			const wchar_t *name = data.cFileName;
+			if (name[0] == L'.' && (name[1] == 0 || (name[1] == L'.' && name[2] == 0)))
+				continue;
+
+			// Files are matched before their name is converted
+			bool directory = (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+			bool matches = match_all || !use_pattern || match_wildcard(native_pattern.c_str(), name);
+			if (!matches && !directory)
+				continue;
+
+			ParallelDirectoryScanner_Entry entry;
+			entry.name = StringHelp::ucs2_to_utf8(name);
+			entry.size = directory ? 0 : (((int64_t)data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+			entry.directory = directory;
+			entry.hidden = (data.dwFileAttributes & FILE_ATTRIBUTE_HIDDEN) != 0;
+			entry.link = (data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) != 0;
+			entry.matches = matches;
+			entries.push_back(std::move(entry));
+		} while (FindNextFileW(handle, &data));
+
+		FindClose(handle);
+		return true;
+	}
+
+	bool ParallelDirectoryScanner_Impl::match_name(const std::string &name) const
+	{
+		return match_wildcard(native_pattern.c_str(), StringHelp::utf8_to_ucs2(name).c_str());
+	}
+
+	bool ParallelDirectoryScanner_Impl::match_wildcard(const wchar_t *pattern, const wchar_t *name)
+	{
+		// Case insensitive match of '*' and '?', backtracking to the last '*' on a mismatch
+		const wchar_t *star_pattern = nullptr;
+		const wchar_t *star_name = nullptr;
+		while (*name)
+		{
+			if (*pattern == L'*')
+			{
+				star_pattern = ++pattern;
+				star_name = name;
+			}
+			else if (*pattern == L'?' || towlower(*pattern) == towlower(*name))
+			{
+				pattern++;
+				name++;
+			}
+			else if (star_pattern)
+			{
+				pattern = star_pattern;
+				name = ++star_name;
+			}
+			else
+			{
+				return false;
+			}
+		}
+		while (*pattern == L'*')
+			pattern++;
+		return *pattern == 0;
+	}
+
+	bool ParallelDirectoryScanner_Impl::get_modified_time(const std::string &directory_path, int64_t &out_modified)
+	{
+		WIN32_FILE_ATTRIBUTE_DATA attributes;
+		if (!GetFileAttributesExW(StringHelp::utf8_to_ucs2(directory_path).c_str(), GetFileExInfoStandard, &attributes))
+			return false;
+		if ((attributes.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0)
+			return false;
+
+		// Convert from 100 nanosecond units since 1601 to seconds since 1970
+		int64_t filetime = (((int64_t)attributes.ftLastWriteTime.dwHighDateTime) << 32) | attributes.ftLastWriteTime.dwLowDateTime;
+		out_modified = (filetime - 116444736000000000LL) / 10000000;
+		return true;
+	}
+
+#else
+
+	bool ParallelDirectoryScanner_Impl::list_directory(const std::string &directory_path, bool match_all, std::vector<ParallelDirectoryScanner_Entry> &entries)
+	{
+		DIR *dir = opendir(directory_path.c_str());
+		if (dir == nullptr)
+			return false;
+
+		int dir_fd = dirfd(dir);
+		while (dirent *dir_entry = readdir(dir))
+		{
+			const char *name = dir_entry->d_name;
+			if (name[0] == '.' && (name[1] == 0 || (name[1] == '.' && name[2] == 0)))
+				continue;
+
+			bool type_known = false;
+			bool directory = false;
+			bool link = false;
+#ifdef DT_DIR
+			if (dir_entry->d_type == DT_DIR || dir_entry->d_type == DT_REG)
+			{
+				type_known = true;
+				directory = dir_entry->d_type == DT_DIR;
+			}
+			link = dir_entry->d_type == DT_LNK;
+#endif
+
+			// Files are matched before their name is copied or stat is called on them
+			bool matches = match_all || !use_pattern || fnmatch(native_pattern.c_str(), name, FNM_PATHNAME) == 0;
+			if (!matches && type_known && !directory)
+				continue;
+
+			struct stat statbuf;
+			if (!type_known)
+			{
+				if (fstatat(dir_fd, name, &statbuf, AT_SYMLINK_NOFOLLOW) == -1)
+					continue;
+				link = S_ISLNK(statbuf.st_mode);
+			}
+
+			int64_t size = 0;
+			if (!type_known || link || (matches && !directory))
+			{
+				if (fstatat(dir_fd, name, &statbuf, 0) == 0)
+				{
+					directory = S_ISDIR(statbuf.st_mode);
+					size = directory ? 0 : (int64_t)statbuf.st_size;
+				}
+			}
+
+			if (!matches && !directory)
+				continue;
+
+			ParallelDirectoryScanner_Entry entry;
+			entry.name = name;
+			entry.size = size;
+			entry.directory = directory;
+			entry.hidden = name[0] == '.';
+			entry.link = link;
+			entry.matches = matches;
+			entries.push_back(std::move(entry));
+		}
+
+		closedir(dir);
+		return true;
+	}
+
+	bool ParallelDirectoryScanner_Impl::match_name(const std::string &name) const
+	{
+		return fnmatch(native_pattern.c_str(), name.c_str(), FNM_PATHNAME) == 0;
+	}
+
+	bool ParallelDirectoryScanner_Impl::get_modified_time(const std::string &directory_path, int64_t &out_modified)
+	{
+		struct stat statbuf;
+		if (stat(directory_path.c_str(), &statbuf) == -1 || !S_ISDIR(statbuf.st_mode))
+			return false;
+		out_modified = (int64_t)statbuf.st_mtime;
+		return true;
+	}
+
+#endif
+}
@@ -29,9 +29,44 @@
 #include "Core/precomp.h"
 #include "API/Core/JSON/json_value.h"
 #include "API/Core/Text/string_help.h"
+#include "API/Core/System/allocation_tracker.h"
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+
+#if !defined CL_DISABLE_SSE2 && !defined __ANDROID__
+#include <emmintrin.h>
+#define CL_JSON_SSE
+#endif
+
+#if defined CL_DISABLE_SSE2 && (defined __ARM_NEON || defined __ARM_NEON__)
+#include <arm_neon.h>
+#define CL_JSON_NEON
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 namespace clan
 {
+	/// \brief Parser state for one JSON text
+	class JsonReader
+	{
+	public:
+		JsonReader(const char *data, size_t length, char *in_situ_data) : data(data), length(length), in_situ_data(in_situ_data) { }
+
+		const char *data;
+		size_t length;
+		size_t pos = 0;
+
+		// Writable alias of data when parsing in situ, nullptr otherwise
+		char *in_situ_data;
+
+		// Decoded strings with escapes are built here when not parsing in situ, reusing the capacity
+		std::string scratch;
+	};
+
 	class JsonValueImpl
 	{
 	public:
@@ -41,30 +76,136 @@ namespace clan
 		static void write_string(const std::string &str, std::string &json);
 		static void write_number(const JsonValue &value, std::string &json);
 
-		static JsonValue read(const std::string &json, size_t &pos);
-		static JsonValue read_object(const std::string &json, size_t &pos);
-		static JsonValue read_array(const std::string &json, size_t &pos);
-		static std::string read_string(const std::string &json, size_t &pos);
-		static JsonValue read_number(const std::string &json, size_t &pos);
-		static JsonValue read_boolean(const std::string &json, size_t &pos);
-		static void read_whitespace(const std::string &json, size_t &pos);
+		static JsonValue parse(JsonReader &reader);
+		static JsonValue read(JsonReader &reader);
+		static JsonValue read_object(JsonReader &reader);
+		static JsonValue read_array(JsonReader &reader);
+		static std::string read_string(JsonReader &reader);
+		static int read_escape(JsonReader &reader, size_t &pos, char *output);
+		static unsigned int read_hex4(JsonReader &reader, size_t &pos);
+		static JsonValue read_number(JsonReader &reader);
+		static JsonValue read_boolean(JsonReader &reader);
+		static JsonValue read_null(JsonReader &reader);
+		static void read_whitespace(JsonReader &reader);
+
+		/// \brief Returns the position of the first quote or backslash at or after pos, or length if there is none
+		static size_t scan_string(const char *data, size_t pos, size_t length);
+
+		/// \brief Returns the position of the first non whitespace character at or after pos
+		static size_t skip_whitespace(const char *data, size_t pos, size_t length);
+
+		static bool is_whitespace(char c) { return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\f'; }
+
+		static int count_trailing_zeros(unsigned int value)
+		{
+#if defined(__GNUC__)
+			return __builtin_ctz(value);
+#elif defined(_MSC_VER)
+			unsigned long index;
+			_BitScanForward(&index, value);
+			return (int)index;
+#else
+			int bits = 0;
+			while ((value & 1) == 0)
+			{
+				bits++;
+				value >>= 1;
+			}
+			return bits;
+#endif
+		}
+
+		static void count_allocations(const JsonValue &value, uint64_t &allocations, size_t &bytes);
 	};
 
 	std::string JsonValue::to_json() const
 	{
 		std::string result;
 		JsonValueImpl::write(*this, result);
+		if (result.capacity() >= sizeof(std::string))
+			AllocationTracker::count(allocation_tag_json, 1, result.capacity());
 		return result;
 	}
 
+	void JsonValue::to_json(std::string &json) const
+	{
+		json.clear();
+		size_t capacity = json.capacity();
+		JsonValueImpl::write(*this, json);
+		if (json.capacity() != capacity)
+			AllocationTracker::count(allocation_tag_json, 1, json.capacity());
+	}
+
 	JsonValue JsonValue::parse(const std::string &json)
 	{
-		size_t pos = 0;
-		return JsonValueImpl::read(json, pos);
+		JsonReader reader(json.data(), json.length(), nullptr);
+		return JsonValueImpl::parse(reader);
+	}
+
+	JsonValue JsonValue::parse(char *json, size_t length)
+	{
+		JsonReader reader(json, length, json);
+		return JsonValueImpl::parse(reader);
 	}
 
 	/////////////////////////////////////////////////////////////////////////
 
+	JsonValue JsonValueImpl::parse(JsonReader &reader)
+	{
+		JsonValue value = read(reader);
+
+		if (AllocationTracker::is_enabled())
+		{
+			uint64_t allocations = 0;
+			size_t bytes = 0;
+			count_allocations(value, allocations, bytes);
+			AllocationTracker::count(allocation_tag_json, allocations, bytes);
+		}
+
+		return value;
+	}
+
+	void JsonValueImpl::count_allocations(const JsonValue &value, uint64_t &allocations, size_t &bytes)
+	{
+		// Counts the heap blocks held by the final tree. Strings short enough for the small string buffer need none.
+		const size_t small_string = sizeof(std::string);
+
+		switch (value.type())
+		{
+		case JsonType::string:
+			if (value.to_string().capacity() >= small_string)
+			{
+				allocations++;
+				bytes += value.to_string().capacity() + 1;
+			}
+			break;
+		case JsonType::object:
+			for (const auto &it : value.properties())
+			{
+				allocations++;
+				bytes += sizeof(std::pair<const std::string, JsonValue>);
+				if (it.first.capacity() >= small_string)
+				{
+					allocations++;
+					bytes += it.first.capacity() + 1;
+				}
+				count_allocations(it.second, allocations, bytes);
+			}
+			break;
+		case JsonType::array:
+			if (value.items().capacity() > 0)
+			{
+				allocations++;
+				bytes += value.items().capacity() * sizeof(JsonValue);
+			}
+			for (const auto &item : value.items())
+				count_allocations(item, allocations, bytes);
+			break;
+		default:
+			break;
+		}
+	}
+
 	void JsonValueImpl::write(const JsonValue &value, std::string &json)
 	{
 		switch (value.type())
@@ -123,112 +264,139 @@ namespace clan
 	{
 		json.push_back('"');
 
-		for (auto c : str)
+		// Copy the runs of characters that need no escaping in one go
+		size_t run_start = 0;
+		for (size_t i = 0; i < str.length(); i++)
 		{
-			if (c == '"' || c == '\\')
-			{
-				json.push_back('\\');
-				json.push_back(c);
-			}
-			else if (c == '\b')
-			{
-				json.push_back('\\');
-				json.push_back('b');
-			}
-			else if (c == '\f')
-			{
-				json.push_back('\\');
-				json.push_back('f');
-			}
-			else if (c == '\n')
-			{
-				json.push_back('\\');
-				json.push_back('n');
-			}
-			else if (c == '\r')
-			{
-				json.push_back('\\');
-				json.push_back('r');
-			}
-			else if (c == '\t')
-			{
-				json.push_back('\\');
-				json.push_back('t');
-			}
-			else if (c < 32)
-			{
-				json.push_back('\\');
-				json.push_back('u');
-				json.push_back('0');
-				json.push_back('0');
+			unsigned char c = str[i];
+			if (c >= 32 && c != '"' && c != '\\')
+				continue;
 
-				if (c >= 16)
-				{
-					json.push_back('1');
-					c -= 16;
-				}
-				else
-				{
-					json.push_back('0');
-				}
+			json.append(str, run_start, i - run_start);
+			run_start = i + 1;
 
-				if (c < 10)
-				{
-					json.push_back('0' + c);
-				}
-				else
+			json.push_back('\\');
+			switch (c)
+			{
+			case '"': json.push_back('"'); break;
+			case '\\': json.push_back('\\'); break;
+			case '\b': json.push_back('b'); break;
+			case '\f': json.push_back('f'); break;
+			case '\n': json.push_back('n'); break;
+			case '\r': json.push_back('r'); break;
+			case '\t': json.push_back('t'); break;
+			default:
 				{
-					json.push_back('a' + (c - 10));
-				}
+					static const char hex[] = "0123456789abcdef";
+					json.append("u00");
+					json.push_back(hex[c >> 4]);
+					json.push_back(hex[c & 15]);
 				}
-			else
-			{
-				json.push_back(c);
-			}
+				break;
 			}
+		}
+		json.append(str, run_start, std::string::npos);
 
 		json.push_back('"');
-		}
+	}
 
 	void JsonValueImpl::write_number(const JsonValue &value, std::string &json)
 	{
+		double number = value.to_number();
 		char buf[64];
-		buf[0] = 0;
-		if (static_cast<double>(static_cast<int>(value.to_number())) == value.to_number())
+		if (number != number || number - number != 0.0)
 		{
+			json += "null"; // JSON has no representation for NaN and infinity
+			return;
+		}
+
+		// Use the shortest precision that parses back to the same value
 #ifdef WIN32
-			_snprintf(buf, 63, "%d", (int)value.to_number());
+		_snprintf(buf, 63, "%.15g", number);
+		if (strtod(buf, nullptr) != number)
+			_snprintf(buf, 63, "%.17g", number);
 #else
-			snprintf(buf, 63, "%d", (int)value.to_number());
+		snprintf(buf, 63, "%.15g", number);
+		if (strtod(buf, nullptr) != number)
+			snprintf(buf, 63, "%.17g", number);
 #endif
+		buf[63] = 0;
+		json += buf;
+	}
+
+	/////////////////////////////////////////////////////////////////////////
+
+	size_t JsonValueImpl::scan_string(const char *data, size_t pos, size_t length)
+	{
+#if defined CL_JSON_SSE
+		const __m128i quote = _mm_set1_epi8('"');
+		const __m128i backslash = _mm_set1_epi8('\\');
+		for (; pos + 16 <= length; pos += 16)
+		{
+			__m128i chars = _mm_loadu_si128((const __m128i*)(data + pos));
+			int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chars, quote), _mm_cmpeq_epi8(chars, backslash)));
+			if (mask != 0)
+				return pos + count_trailing_zeros(mask);
 		}
-		else
+#elif defined CL_JSON_NEON
+		const uint8x16_t quote = vdupq_n_u8('"');
+		const uint8x16_t backslash = vdupq_n_u8('\\');
+		for (; pos + 16 <= length; pos += 16)
 		{
-#ifdef WIN32
-			_snprintf(buf, 63, "%f", value.to_number());
-#else
-			snprintf(buf, 63, "%f", value.to_number());
+			uint8x16_t chars = vld1q_u8((const uint8_t*)(data + pos));
+			uint64x2_t found = vreinterpretq_u64_u8(vorrq_u8(vceqq_u8(chars, quote), vceqq_u8(chars, backslash)));
+			if ((vgetq_lane_u64(found, 0) | vgetq_lane_u64(found, 1)) != 0)
+				break;
+		}
 #endif
+		while (pos < length && data[pos] != '"' && data[pos] != '\\')
+			pos++;
+		return pos;
+	}
+
+	size_t JsonValueImpl::skip_whitespace(const char *data, size_t pos, size_t length)
+	{
+		// Most tokens are separated by at most one space, so check the first character before using vectors
+		if (pos == length || !is_whitespace(data[pos]))
+			return pos;
+
+#if defined CL_JSON_SSE
+		const __m128i space = _mm_set1_epi8(' ');
+		const __m128i tab = _mm_set1_epi8('\t');
+		const __m128i newline = _mm_set1_epi8('\n');
+		const __m128i carriage_return = _mm_set1_epi8('\r');
+		const __m128i form_feed = _mm_set1_epi8('\f');
+		for (; pos + 16 <= length; pos += 16)
+		{
+			__m128i chars = _mm_loadu_si128((const __m128i*)(data + pos));
+			__m128i whitespace = _mm_or_si128(
+				_mm_or_si128(_mm_cmpeq_epi8(chars, space), _mm_cmpeq_epi8(chars, tab)),
+				_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chars, newline), _mm_cmpeq_epi8(chars, carriage_return)), _mm_cmpeq_epi8(chars, form_feed)));
+			int mask = ~_mm_movemask_epi8(whitespace) & 0xffff;
+			if (mask != 0)
+				return pos + count_trailing_zeros(mask);
 		}
-		buf[63] = 0;
-		json += buf;
+#endif
+		while (pos < length && is_whitespace(data[pos]))
+			pos++;
+		return pos;
 	}
 
-	JsonValue JsonValueImpl::read(const std::string &json, size_t &pos)
+	JsonValue JsonValueImpl::read(JsonReader &reader)
 	{
-		read_whitespace(json, pos);
+		read_whitespace(reader);
 
-		if (pos == json.length())
+		if (reader.pos == reader.length)
 			throw JsonException("Unexpected end of JSON data");
 
-		switch (json[pos])
+		switch (reader.data[reader.pos])
 		{
 		case '{':
-			return read_object(json, pos);
+			return read_object(reader);
 		case '[':
-			return read_array(json, pos);
+			return read_array(reader);
 		case '"':
-			return JsonValue::string(read_string(json, pos));
+			return JsonValue::string(read_string(reader));
 		case '-':
 		case '0':
 		case '1':
@@ -240,57 +408,59 @@ namespace clan
 		case '7':
 		case '8':
 		case '9':
-			return read_number(json, pos);
+			return read_number(reader);
 		case 'f':
 		case 't':
-			return read_boolean(json, pos);
+			return read_boolean(reader);
+		case 'n':
+			return read_null(reader);
 		default:
 			throw JsonException("Unexpected character in JSON data");
 		}
 	}
 
-	JsonValue JsonValueImpl::read_object(const std::string &json, size_t &pos)
+	JsonValue JsonValueImpl::read_object(JsonReader &reader)
 	{
 		JsonValue result = JsonValue::object();
+		std::map<std::string, JsonValue> &properties = result.properties();
 
-		pos++;
+		reader.pos++;
 
-		read_whitespace(json, pos);
+		read_whitespace(reader);
 
-		if (pos == json.length())
+		if (reader.pos == reader.length)
 			throw JsonException("Unexpected end of JSON data");
 
-		while (pos != json.length() && json[pos] != '}')
+		while (reader.pos != reader.length && reader.data[reader.pos] != '}')
 		{
-			std::string key = read_string(json, pos);
+			if (reader.data[reader.pos] != '"')
+				throw JsonException("Unexpected character in JSON data");
+			std::string key = read_string(reader);
 
-			read_whitespace(json, pos);
+			read_whitespace(reader);
 
-			if (pos == json.length())
+			if (reader.pos == reader.length)
 				throw JsonException("Unexpected end of JSON data");
-			else if (json[pos] != ':')
+			else if (reader.data[reader.pos] != ':')
 				throw JsonException("Unexpected character in JSON data");
-			pos++;
-
-			read_whitespace(json, pos);
+			reader.pos++;
 
-			result.prop(key) = read(json, pos);
+			properties[std::move(key)] = read(reader);
 
-			read_whitespace(json, pos);
+			read_whitespace(reader);
 
-			if (pos == json.length())
+			if (reader.pos == reader.length)
 			{
 				throw JsonException("Unexpected end of JSON data");
 			}
-			else if (json[pos] == '}')
+			else if (reader.data[reader.pos] == '}')
 			{
-				pos++;
 				break;
 			}
-			else if (json[pos] == ',')
+			else if (reader.data[reader.pos] == ',')
 			{
-				pos++;
-				read_whitespace(json, pos);
+				reader.pos++;
+				read_whitespace(reader);
 			}
 			else
 			{
@@ -298,199 +468,270 @@ namespace clan
 			}
 		}
 
+		if (reader.pos == reader.length)
+			throw JsonException("Unexpected end of JSON data");
+		reader.pos++;
+
 		return result;
 	}
 
-	JsonValue JsonValueImpl::read_array(const std::string &json, size_t &pos)
+	JsonValue JsonValueImpl::read_array(JsonReader &reader)
 	{
 		JsonValue result = JsonValue::array();
+		std::vector<JsonValue> &items = result.items();
 
-		pos++;
+		reader.pos++;
 
-		read_whitespace(json, pos);
+		read_whitespace(reader);
 
-		if (pos == json.length())
+		if (reader.pos == reader.length)
 			throw JsonException("Unexpected end of JSON data");
 
-		while (json[pos] != ']')
+		while (reader.data[reader.pos] != ']')
 		{
-			read_whitespace(json, pos);
-			result.items().push_back(read(json, pos));
-			read_whitespace(json, pos);
+			items.push_back(read(reader));
+			read_whitespace(reader);
 
-			if (pos == json.length())
+			if (reader.pos == reader.length)
 			{
 				throw JsonException("Unexpected end of JSON data");
 			}
-			else if (json[pos] == ']')
+			else if (reader.data[reader.pos] == ']')
 			{
 				break;
 			}
-			else if (json[pos] == ',')
+			else if (reader.data[reader.pos] == ',')
 			{
-				pos++;
-				read_whitespace(json, pos);
+				reader.pos++;
+				read_whitespace(reader);
+				if (reader.pos == reader.length)
+					throw JsonException("Unexpected end of JSON data");
 			}
 			else
 			{
 				throw JsonException("Unexpected character in JSON data");
 			}
 		}
-		pos++;
+		reader.pos++;
 
 		return result;
 	}
 
-	std::string JsonValueImpl::read_string(const std::string &json, size_t &pos)
+	std::string JsonValueImpl::read_string(JsonReader &reader)
 	{
-		pos++;
-		if (pos == json.length())
+		const char *data = reader.data;
+		size_t length = reader.length;
+
+		size_t start = ++reader.pos;
+		size_t pos = scan_string(data, start, length);
+		if (pos == length)
 			throw JsonException("Unexpected end of JSON data");
 
-		std::string result;
-		while (true)
+		// Strings without escapes are copied straight from the input
+		if (data[pos] == '"')
+		{
+			reader.pos = pos + 1;
+			return std::string(data + start, pos - start);
+		}
+
+		// In situ parsing decodes the escapes into the input buffer itself. Otherwise the decoded string is built in the reader's scratch buffer.
+		char *output = reader.in_situ_data ? reader.in_situ_data + pos : nullptr;
+		if (!output)
+			reader.scratch.assign(data + start, pos - start);
+
+		while (data[pos] == '\\')
 		{
-			if (pos == json.length())
+			char decoded[4];
+			int decoded_length = read_escape(reader, pos, decoded);
+			if (output)
 			{
-				throw JsonException("Unexpected end of JSON data");
+				memcpy(output, decoded, decoded_length);
+				output += decoded_length;
 			}
-			else if (json[pos] == '"')
+			else
 			{
-				break;
+				reader.scratch.append(decoded, decoded_length);
 			}
-			else if (json[pos] == '\\')
-			{
-				pos++;
-				if (pos == json.length())
-					throw JsonException("Unexpected end of JSON data");
 
-				unsigned codepoint;
-				switch (json[pos])
-				{
-				case '"':
-					result.push_back('"');
-					break;
-				case '\\':
-					result.push_back('\\');
-					break;
-				case '/':
-					result.push_back('/');
-					break;
-				case 'b':
-					result.push_back('\b');
-					break;
-				case 'f':
-					result.push_back('\f');
-					break;
-				case 'n':
-					result.push_back('\n');
-					break;
-				case 'r':
-					result.push_back('\r');
-					break;
-				case 't':
-					result.push_back('\t');
-					break;
-				case 'u':
-					if (pos + 5 > json.length())
-						throw JsonException("Unexpected end of JSON data");
-
-					codepoint = 0;
-					for (int i = 0; i < 4; i++)
-					{
-						char c = json[pos + 1 + i];
-						if (c >= '0' && c <= '9')
-						{
-							codepoint <<= 4;
-							codepoint |= c - '0';
-						}
-						else if (c >= 'a' && c <= 'f')
-						{
-							codepoint <<= 4;
-							codepoint |= c - 'a' + 10;
-						}
-						else if (c >= 'A' && c <= 'F')
-						{
-							codepoint <<= 4;
-							codepoint |= c - 'A' + 10;
-						}
-						else
-						{
-							throw JsonException("Invalid unicode escape");
-						}
-					}
-					result += StringHelp::unicode_to_utf8(codepoint);
-					pos += 4;
-					break;
-				}
-				pos++;
+			size_t run_end = scan_string(data, pos, length);
+			if (run_end == length)
+				throw JsonException("Unexpected end of JSON data");
+			if (output)
+			{
+				memmove(output, data + pos, run_end - pos);
+				output += run_end - pos;
 			}
 			else
 			{
-				result.push_back(json[pos]);
-				pos++;
+				reader.scratch.append(data + pos, run_end - pos);
 			}
+			pos = run_end;
 		}
 
+		reader.pos = pos + 1;
+		if (output)
+			return std::string(reader.in_situ_data + start, output);
+		else
+			return reader.scratch;
+	}
+
+	int JsonValueImpl::read_escape(JsonReader &reader, size_t &pos, char *output)
+	{
+		const char *data = reader.data;
 		pos++;
+		if (pos == reader.length)
+			throw JsonException("Unexpected end of JSON data");
 
-		return result;
+		switch (data[pos++])
+		{
+		case '"': output[0] = '"'; return 1;
+		case '\\': output[0] = '\\'; return 1;
+		case '/': output[0] = '/'; return 1;
+		case 'b': output[0] = '\b'; return 1;
+		case 'f': output[0] = '\f'; return 1;
+		case 'n': output[0] = '\n'; return 1;
+		case 'r': output[0] = '\r'; return 1;
+		case 't': output[0] = '\t'; return 1;
+		case 'u':
+			break;
+		default:
+			throw JsonException("Invalid escape sequence");
+		}
+
+		unsigned int codepoint = read_hex4(reader, pos);
+
+		// Characters outside the basic multilingual plane are escaped as UTF-16 surrogate pairs
+		if (codepoint >= 0xd800 && codepoint < 0xdc00 && pos + 6 <= reader.length && data[pos] == '\\' && data[pos + 1] == 'u')
+		{
+			size_t low_pos = pos + 2;
+			unsigned int low_surrogate = read_hex4(reader, low_pos);
+			if (low_surrogate >= 0xdc00 && low_surrogate < 0xe000)
+			{
+				codepoint = 0x10000 + ((codepoint - 0xd800) << 10) + (low_surrogate - 0xdc00);
+				pos = low_pos;
+			}
+		}
+
+		if (codepoint < 0x80)
+		{
+			output[0] = (char)codepoint;
+			return 1;
+		}
+		else if (codepoint < 0x800)
+		{
+			output[0] = (char)(0xc0 | (codepoint >> 6));
+			output[1] = (char)(0x80 | (codepoint & 0x3f));
+			return 2;
+		}
+		else if (codepoint < 0x10000)
+		{
+			output[0] = (char)(0xe0 | (codepoint >> 12));
+			output[1] = (char)(0x80 | ((codepoint >> 6) & 0x3f));
+			output[2] = (char)(0x80 | (codepoint & 0x3f));
+			return 3;
+		}
+		else
+		{
+			output[0] = (char)(0xf0 | (codepoint >> 18));
+			output[1] = (char)(0x80 | ((codepoint >> 12) & 0x3f));
+			output[2] = (char)(0x80 | ((codepoint >> 6) & 0x3f));
+			output[3] = (char)(0x80 | (codepoint & 0x3f));
+			return 4;
+		}
+	}
+
+	unsigned int JsonValueImpl::read_hex4(JsonReader &reader, size_t &pos)
+	{
+		if (pos + 4 > reader.length)
+			throw JsonException("Unexpected end of JSON data");
+
+		unsigned int codepoint = 0;
+		for (int i = 0; i < 4; i++)
+		{
+			char c = reader.data[pos++];
+			codepoint <<= 4;
+			if (c >= '0' && c <= '9')
+				codepoint |= c - '0';
+			else if (c >= 'a' && c <= 'f')
+				codepoint |= c - 'a' + 10;
+			else if (c >= 'A' && c <= 'F')
+				codepoint |= c - 'A' + 10;
+			else
+				throw JsonException("Invalid unicode escape");
+		}
+		return codepoint;
 	}
 
-	JsonValue JsonValueImpl::read_number(const std::string &json, size_t &pos)
+	JsonValue JsonValueImpl::read_number(JsonReader &reader)
 	{
-		int start_pos = pos;
-		if (json[pos] == '-')
+		const char *data = reader.data;
+		size_t length = reader.length;
+		size_t pos = reader.pos;
+
+		size_t start_pos = pos;
+		if (data[pos] == '-')
 			pos++;
-		while (pos < json.length() && json[pos] >= '0' && json[pos] <= '9')
+		if (pos == length || data[pos] < '0' || data[pos] > '9')
+			throw JsonException("Unexpected character in JSON data");
+		while (pos < length && data[pos] >= '0' && data[pos] <= '9')
 			pos++;
-		if (pos != json.length() && json[pos] == '.')
+		if (pos != length && data[pos] == '.')
 			pos++;
-		while (pos < json.length() && json[pos] >= '0' && json[pos] <= '9')
+		while (pos < length && data[pos] >= '0' && data[pos] <= '9')
 			pos++;
-		if (pos != json.length() && (json[pos] == 'e' || json[pos] == 'E'))
+		if (pos != length && (data[pos] == 'e' || data[pos] == 'E'))
 		{
 			pos++;
-			if (pos != json.length() && (json[pos] == '+' || json[pos] == '-'))
+			if (pos != length && (data[pos] == '+' || data[pos] == '-'))
 				pos++;
-			while (pos < json.length() && json[pos] >= '0' && json[pos] <= '9')
+			while (pos < length && data[pos] >= '0' && data[pos] <= '9')
 				pos++;
 		}
-		int end_pos = pos;
+		reader.pos = pos;
 
-		std::string number_string = json.substr(start_pos, end_pos - start_pos);
-		if (number_string.empty())
-			throw JsonException("Unexpected character in JSON data");
-
-		double result = 0.0;
-		sscanf(number_string.c_str(), "%lf", &result);
-		return JsonValue::number(result);
+		// The input does not have to be null terminated, so strtod gets a terminated copy of the number
+		char buf[64];
+		size_t number_length = pos - start_pos;
+		if (number_length < sizeof(buf))
+		{
+			memcpy(buf, data + start_pos, number_length);
+			buf[number_length] = 0;
+			return JsonValue::number(strtod(buf, nullptr));
+		}
+		else
+		{
+			return JsonValue::number(strtod(std::string(data + start_pos, number_length).c_str(), nullptr));
+		}
 	}
 
-	JsonValue JsonValueImpl::read_boolean(const std::string &json, size_t &pos)
+	JsonValue JsonValueImpl::read_boolean(JsonReader &reader)
 	{
-		if (json[pos] == 't')
+		if (reader.data[reader.pos] == 't')
 		{
-			if (pos + 4 > json.length() || memcmp(&json[pos], "true", 4) != 0)
+			if (reader.pos + 4 > reader.length || memcmp(reader.data + reader.pos, "true", 4) != 0)
 				throw JsonException("Unexpected character in JSON data");
-			pos += 4;
+			reader.pos += 4;
 			return JsonValue::boolean(true);
 		}
 		else
 		{
-			if (pos + 5 > json.length() || memcmp(&json[pos], "false", 5) != 0)
+			if (reader.pos + 5 > reader.length || memcmp(reader.data + reader.pos, "false", 5) != 0)
 				throw JsonException("Unexpected character in JSON data");
-			pos += 5;
+			reader.pos += 5;
 			return JsonValue::boolean(false);
 		}
 	}
 
-	void JsonValueImpl::read_whitespace(const std::string &json, size_t &pos)
+	JsonValue JsonValueImpl::read_null(JsonReader &reader)
 	{
-		while (pos != json.length() && (json[pos] == ' ' || json[pos] == '\r' || json[pos] == '\n' || json[pos] == '\t' || json[pos] == '\f'))
-			pos++;
+		if (reader.pos + 4 > reader.length || memcmp(reader.data + reader.pos, "null", 4) != 0)
+			throw JsonException("Unexpected character in JSON data");
+		reader.pos += 4;
+		return JsonValue::null();
 	}
-	
-}
-
 
+	void JsonValueImpl::read_whitespace(JsonReader &reader)
+	{
+		reader.pos = skip_whitespace(reader.data, reader.pos, reader.length);
+	}
+}
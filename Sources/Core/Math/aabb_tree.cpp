@@ -0,0 +1,419 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "Core/precomp.h"
+#include "API/Core/Math/aabb_tree.h"
+#include "API/Core/Math/frustum_planes.h"
+#include "API/Core/Math/intersection_test.h"
+#include "API/Core/System/work_queue.h"
+#include "broadphase_helpers.h"
+#include <algorithm>
+
+namespace clan
+{
+	AxisAlignedBoundingBoxTree::AxisAlignedBoundingBoxTree(float margin)
+		: margin(margin)
+	{
+	}
+
+	int AxisAlignedBoundingBoxTree::insert(const AxisAlignedBoundingBox &box)
+	{
+		int leaf = allocate_node();
+		Node &node = nodes[leaf];
+		node.box = box;
+		node.fat_box = broadphase_grow(box, margin);
+		node.height = 0;
+		insert_leaf(leaf);
+		count++;
+		return leaf;
+	}
+
+	bool AxisAlignedBoundingBoxTree::update(int id, const AxisAlignedBoundingBox &box)
+	{
+		Node &node = nodes[id];
+		node.box = box;
+		if (broadphase_contains(node.fat_box, box))
+			return false;
+
+		remove_leaf(id);
+		nodes[id].fat_box = broadphase_grow(box, margin);
+		insert_leaf(id);
+		return true;
+	}
+
+	void AxisAlignedBoundingBoxTree::remove(int id)
+	{
+		remove_leaf(id);
+		free_node(id);
+		count--;
+	}
+
+	void AxisAlignedBoundingBoxTree::clear()
+	{
+		nodes.clear();
+		root = -1;
+		free_list = -1;
+		count = 0;
+	}
+
+	int AxisAlignedBoundingBoxTree::get_height() const
+	{
+		return root == -1 ? 0 : nodes[root].height + 1;
+	}
+
+	void AxisAlignedBoundingBoxTree::query(const AxisAlignedBoundingBox &box, std::vector<int> &out_ids) const
+	{
+		BroadphaseStack stack;
+		if (root != -1)
+			stack.push(root);
+
+		while (!stack.empty())
+		{
+			const Node &node = nodes[stack.pop()];
+			if (!broadphase_overlap(node.fat_box, box))
+				continue;
+
+			if (node.is_leaf())
+			{
+				if (broadphase_overlap(node.box, box))
+					out_ids.push_back((int)(&node - nodes.data()));
+			}
+			else
+			{
+				stack.push(node.child1);
+				stack.push(node.child2);
+			}
+		}
+	}
+
+	void AxisAlignedBoundingBoxTree::query_ray(const Vec3f &ray_start, const Vec3f &ray_end, std::vector<int> &out_ids) const
+	{
+		BroadphaseStack stack;
+		if (root != -1)
+			stack.push(root);
+
+		while (!stack.empty())
+		{
+			const Node &node = nodes[stack.pop()];
+			if (IntersectionTest::ray_aabb(ray_start, ray_end, node.fat_box) == IntersectionTest::disjoint)
+				continue;
+
+			if (node.is_leaf())
+			{
+				if (IntersectionTest::ray_aabb(ray_start, ray_end, node.box) == IntersectionTest::overlap)
+					out_ids.push_back((int)(&node - nodes.data()));
+			}
+			else
+			{
+				stack.push(node.child1);
+				stack.push(node.child2);
+			}
+		}
+	}
+
+	void AxisAlignedBoundingBoxTree::query_frustum(const FrustumPlanes &frustum, std::vector<int> &out_ids) const
+	{
+		BroadphaseStack stack;
+		if (root != -1)
+			stack.push(root);
+
+		while (!stack.empty())
+		{
+			const Node &node = nodes[stack.pop()];
+			if (node.is_leaf())
+			{
+				if (IntersectionTest::frustum_aabb(frustum, node.box) != IntersectionTest::outside)
+					out_ids.push_back((int)(&node - nodes.data()));
+				continue;
+			}
+
+			IntersectionTest::Result result = IntersectionTest::frustum_aabb(frustum, node.fat_box);
+			if (result == IntersectionTest::outside)
+				continue;
+
+			if (result == IntersectionTest::inside)
+			{
+				// Everything below is inside as well, so the leaves are collected without further tests
+				BroadphaseStack subtree;
+				subtree.push(node.child1);
+				subtree.push(node.child2);
+				while (!subtree.empty())
+				{
+					const Node &child = nodes[subtree.pop()];
+					if (child.is_leaf())
+					{
+						out_ids.push_back((int)(&child - nodes.data()));
+					}
+					else
+					{
+						subtree.push(child.child1);
+						subtree.push(child.child2);
+					}
+				}
+			}
+			else
+			{
+				stack.push(node.child1);
+				stack.push(node.child2);
+			}
+		}
+	}
+
+	void AxisAlignedBoundingBoxTree::find_pairs(std::vector<BroadphasePair> &out_pairs) const
+	{
+		find_leaf_pairs(0, (int)nodes.size(), out_pairs);
+	}
+
+	void AxisAlignedBoundingBoxTree::find_pairs(WorkQueue &queue, std::vector<BroadphasePair> &out_pairs) const
+	{
+		broadphase_parallel_pairs(queue, (int)nodes.size(), out_pairs, [this](int first, int last, std::vector<BroadphasePair> &pairs)
+		{
+			find_leaf_pairs(first, last, pairs);
+		});
+	}
+
+	void AxisAlignedBoundingBoxTree::find_leaf_pairs(int first_node, int last_node, std::vector<BroadphasePair> &out_pairs) const
+	{
+		BroadphaseStack stack;
+		for (int leaf = first_node; leaf < last_node; leaf++)
+		{
+			const Node &leaf_node = nodes[leaf];
+			if (leaf_node.height != 0)
+				continue;
+
+			// Each leaf only reports partners with a higher id, so every pair is found once
+			size_t first_pair = out_pairs.size();
+			stack.push(root);
+			while (!stack.empty())
+			{
+				int index = stack.pop();
+				const Node &node = nodes[index];
+				if (!broadphase_overlap(node.fat_box, leaf_node.box))
+					continue;
+
+				if (node.is_leaf())
+				{
+					if (index > leaf && broadphase_overlap(node.box, leaf_node.box))
+						out_pairs.push_back(BroadphasePair(leaf, index));
+				}
+				else
+				{
+					stack.push(node.child1);
+					stack.push(node.child2);
+				}
+			}
+			std::sort(out_pairs.begin() + first_pair, out_pairs.end());
+		}
+	}
+
+	int AxisAlignedBoundingBoxTree::allocate_node()
+	{
+		int index;
+		if (free_list == -1)
+		{
+			index = (int)nodes.size();
+			nodes.push_back(Node());
+		}
+		else
+		{
+			index = free_list;
+			free_list = nodes[index].parent;
+		}
+
+		Node &node = nodes[index];
+		node.parent = -1;
+		node.child1 = -1;
+		node.child2 = -1;
+		node.height = 0;
+		return index;
+	}
+
+	void AxisAlignedBoundingBoxTree::free_node(int index)
+	{
+		nodes[index].parent = free_list;
+		nodes[index].height = -1;
+		free_list = index;
+	}
+
+	void AxisAlignedBoundingBoxTree::insert_leaf(int leaf)
+	{
+		if (root == -1)
+		{
+			root = leaf;
+			nodes[root].parent = -1;
+			return;
+		}
+
+		// Descend towards the sibling that grows the surface area of the tree the least
+		AxisAlignedBoundingBox leaf_box = nodes[leaf].fat_box;
+		int index = root;
+		while (!nodes[index].is_leaf())
+		{
+			const Node &node = nodes[index];
+			float area = broadphase_area(node.fat_box);
+			float combined_area = broadphase_area(broadphase_union(node.fat_box, leaf_box));
+
+			// Cost of making a new parent for this node and the leaf, and the cost of pushing the leaf further down
+			float cost = 2.0f * combined_area;
+			float inheritance_cost = 2.0f * (combined_area - area);
+
+			float child_costs[2];
+			int children[2] = { node.child1, node.child2 };
+			for (int i = 0; i < 2; i++)
+			{
+				const Node &child = nodes[children[i]];
+				float child_area = broadphase_area(broadphase_union(child.fat_box, leaf_box));
+				child_costs[i] = (child.is_leaf() ? child_area : child_area - broadphase_area(child.fat_box)) + inheritance_cost;
+			}
+
+			if (cost < child_costs[0] && cost < child_costs[1])
+				break;
+			index = child_costs[0] < child_costs[1] ? children[0] : children[1];
+		}
+
+		int sibling = index;
+		int old_parent = nodes[sibling].parent;
+		int new_parent = allocate_node();
+		Node &parent = nodes[new_parent];
+		parent.parent = old_parent;
+		parent.fat_box = broadphase_union(leaf_box, nodes[sibling].fat_box);
+		parent.height = nodes[sibling].height + 1;
+		parent.child1 = sibling;
+		parent.child2 = leaf;
+
+		if (old_parent != -1)
+		{
+			if (nodes[old_parent].child1 == sibling)
+				nodes[old_parent].child1 = new_parent;
+			else
+				nodes[old_parent].child2 = new_parent;
+		}
+		else
+		{
+			root = new_parent;
+		}
+		nodes[sibling].parent = new_parent;
+		nodes[leaf].parent = new_parent;
+
+		for (index = new_parent; index != -1; index = nodes[index].parent)
+		{
+			index = balance(index);
+			Node &node = nodes[index];
+			node.height = 1 + std::max(nodes[node.child1].height, nodes[node.child2].height);
+			node.fat_box = broadphase_union(nodes[node.child1].fat_box, nodes[node.child2].fat_box);
+		}
+	}
+
+	void AxisAlignedBoundingBoxTree::remove_leaf(int leaf)
+	{
+		if (leaf == root)
+		{
+			root = -1;
+			return;
+		}
+
+		int parent = nodes[leaf].parent;
+		int grand_parent = nodes[parent].parent;
+		int sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+		if (grand_parent == -1)
+		{
+			root = sibling;
+			nodes[sibling].parent = -1;
+			free_node(parent);
+			return;
+		}
+
+		if (nodes[grand_parent].child1 == parent)
+			nodes[grand_parent].child1 = sibling;
+		else
+			nodes[grand_parent].child2 = sibling;
+		nodes[sibling].parent = grand_parent;
+		free_node(parent);
+
+		for (int index = grand_parent; index != -1; index = nodes[index].parent)
+		{
+			index = balance(index);
+			Node &node = nodes[index];
+			node.height = 1 + std::max(nodes[node.child1].height, nodes[node.child2].height);
+			node.fat_box = broadphase_union(nodes[node.child1].fat_box, nodes[node.child2].fat_box);
+		}
+	}
+
+	// Rotates the taller grandchild up when the children of a node differ in height by more than one
+	int AxisAlignedBoundingBoxTree::balance(int a)
+	{
+		if (nodes[a].is_leaf() || nodes[a].height < 2)
+			return a;
+
+		int b = nodes[a].child1;
+		int c = nodes[a].child2;
+		int height_difference = nodes[c].height - nodes[b].height;
+		if (height_difference >= -1 && height_difference <= 1)
+			return a;
+
+		// The taller child takes the place of a, and a keeps the other child and the shorter grandchild
+		bool c_taller = height_difference > 0;
+		int up = c_taller ? c : b;
+		int other = c_taller ? b : c;
+		int f = nodes[up].child1;
+		int g = nodes[up].child2;
+
+		nodes[up].child1 = a;
+		nodes[up].parent = nodes[a].parent;
+		nodes[a].parent = up;
+
+		if (nodes[up].parent != -1)
+		{
+			if (nodes[nodes[up].parent].child1 == a)
+				nodes[nodes[up].parent].child1 = up;
+			else
+				nodes[nodes[up].parent].child2 = up;
+		}
+		else
+		{
+			root = up;
+		}
+
+		int keep = nodes[f].height > nodes[g].height ? f : g;
+		int move = keep == f ? g : f;
+		nodes[up].child2 = keep;
+		if (c_taller)
+			nodes[a].child2 = move;
+		else
+			nodes[a].child1 = move;
+		nodes[move].parent = a;
+
+		nodes[a].fat_box = broadphase_union(nodes[other].fat_box, nodes[move].fat_box);
+		nodes[a].height = 1 + std::max(nodes[other].height, nodes[move].height);
+		nodes[up].fat_box = broadphase_union(nodes[a].fat_box, nodes[keep].fat_box);
+		nodes[up].height = 1 + std::max(nodes[a].height, nodes[keep].height);
+		return up;
+	}
+}
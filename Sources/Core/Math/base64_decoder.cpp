@@ -29,6 +29,20 @@
 #include "Core/precomp.h"
 #include "API/Core/Math/base64_decoder.h"
 #include "API/Core/System/databuffer.h"
+#include "API/Core/System/system.h"
+
+#if !defined CL_DISABLE_SSE2 && !defined __ANDROID__
+#include <immintrin.h>
+#define CL_BASE64_SIMD
+#if defined(__GNUC__)
+// The SSSE3 and AVX2 kernels are compiled for their instruction sets only, and selected at runtime
+#define CL_TARGET_SSSE3 __attribute__((target("ssse3")))
+#define CL_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define CL_TARGET_SSSE3
+#define CL_TARGET_AVX2
+#endif
+#endif
 
 namespace clan
 {
@@ -80,6 +94,21 @@ namespace clan
 		//! Operations:
 	public:
 		static void decode(unsigned char *output, const unsigned char *input, int size_input)
+		{
+			int i = 0, o = 0;
+#ifdef CL_BASE64_SIMD
+			static const bool use_avx2 = System::detect_cpu_extension(System::avx2);
+			static const bool use_ssse3 = System::detect_cpu_extension(System::ssse3);
+			if (use_avx2)
+				i = decode_avx2(output, input, size_input);
+			else if (use_ssse3)
+				i = decode_ssse3(output, input, size_input);
+			o = i / 4 * 3;
+#endif
+			decode_scalar(output + o, input + i, size_input - i);
+		}
+
+		static void decode_scalar(unsigned char *output, const unsigned char *input, int size_input)
 		{
 			int i, o;
 			for (i = 0, o = 0; i < size_input; i += 4, o += 3)
@@ -95,6 +124,100 @@ namespace clan
 				output[o + 2] = value & 255;
 			}
 		}
+
+		/// Returns the number of bytes decoded from size complete 4 character blocks, excluding padding
+		static int get_decoded_size(const unsigned char *input, int size)
+		{
+			int decoded_size = size / 4 * 3;
+			if (decoded_size > 0)
+			{
+				if (input[size - 2] == '=')
+					decoded_size -= 2;
+				else if (input[size - 1] == '=')
+					decoded_size -= 1;
+			}
+			return decoded_size;
+		}
+
+#ifdef CL_BASE64_SIMD
+		// Vectorized decoding as described by Wojciech Mula in "Base64 decoding with SIMD instructions".
+		// The nibbles of each character select bit masks that only overlap for characters outside the
+		// alphabet. Blocks containing those, including the '=' padding, are left to decode_scalar so
+		// they decode exactly like before.
+
+		CL_TARGET_SSSE3 static int decode_ssse3(unsigned char *output, const unsigned char *input, int size_input)
+		{
+			const __m128i lut_lo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+			const __m128i lut_hi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+			const __m128i lut_roll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+			const __m128i nibble_mask = _mm_set1_epi8(0x0f);
+
+			// Stores 16 bytes to produce 12, so stops while the output has room for the extra 4
+			int i = 0, o = 0;
+			for (; i + 24 <= size_input; i += 16, o += 12)
+			{
+				__m128i in = _mm_loadu_si128((const __m128i*)(input + i));
+				__m128i hi_nibbles = _mm_and_si128(_mm_srli_epi32(in, 4), nibble_mask);
+				__m128i lo_nibbles = _mm_and_si128(in, nibble_mask);
+				__m128i lo = _mm_shuffle_epi8(lut_lo, lo_nibbles);
+				__m128i hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+				if (_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128())) != 0)
+				{
+					decode_scalar(output + o, input + i, 16);
+					continue;
+				}
+
+				__m128i eq_2f = _mm_cmpeq_epi8(in, _mm_set1_epi8(0x2f));
+				__m128i values = _mm_add_epi8(in, _mm_shuffle_epi8(lut_roll, _mm_add_epi8(eq_2f, hi_nibbles)));
+
+				__m128i merged = _mm_madd_epi16(_mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140)), _mm_set1_epi32(0x00011000));
+				merged = _mm_shuffle_epi8(merged, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+				_mm_storeu_si128((__m128i*)(output + o), merged);
+			}
+			return i;
+		}
+
+		CL_TARGET_AVX2 static int decode_avx2(unsigned char *output, const unsigned char *input, int size_input)
+		{
+			const __m256i lut_lo = _mm256_setr_epi8(
+				0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a,
+				0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+			const __m256i lut_hi = _mm256_setr_epi8(
+				0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+				0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+			const __m256i lut_roll = _mm256_setr_epi8(
+				0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+				0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+			const __m256i nibble_mask = _mm256_set1_epi8(0x0f);
+
+			// Stores 32 bytes to produce 24, so stops while the output has room for the extra 8
+			int i = 0, o = 0;
+			for (; i + 48 <= size_input; i += 32, o += 24)
+			{
+				__m256i in = _mm256_loadu_si256((const __m256i*)(input + i));
+				__m256i hi_nibbles = _mm256_and_si256(_mm256_srli_epi32(in, 4), nibble_mask);
+				__m256i lo_nibbles = _mm256_and_si256(in, nibble_mask);
+				__m256i lo = _mm256_shuffle_epi8(lut_lo, lo_nibbles);
+				__m256i hi = _mm256_shuffle_epi8(lut_hi, hi_nibbles);
+				if (!_mm256_testz_si256(lo, hi))
+				{
+					decode_scalar(output + o, input + i, 32);
+					continue;
+				}
+
+				__m256i eq_2f = _mm256_cmpeq_epi8(in, _mm256_set1_epi8(0x2f));
+				__m256i values = _mm256_add_epi8(in, _mm256_shuffle_epi8(lut_roll, _mm256_add_epi8(eq_2f, hi_nibbles)));
+
+				__m256i merged = _mm256_madd_epi16(_mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140)), _mm256_set1_epi32(0x00011000));
+				merged = _mm256_shuffle_epi8(merged, _mm256_setr_epi8(
+					2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+					2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+				merged = _mm256_permutevar8x32_epi32(merged, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+				_mm256_storeu_si256((__m256i*)(output + o), merged);
+			}
+			return i;
+		}
+#endif
 	};
 
 	Base64Decoder::Base64Decoder()
@@ -162,13 +285,7 @@ namespace clan
 
 		// Shorten result if we got an end of base64 data marker:
 
-		if (blocks > 0)
-		{
-			if (data[pos - 2] == '=')
-				impl->result.set_size(impl->result.get_size() - 2);
-			else if (data[pos - 1] == '=')
-				impl->result.set_size(impl->result.get_size() - 1);
-		}
+		impl->result.set_size(out_pos + Base64Decoder_Impl::get_decoded_size(data + pos - blocks * 4, blocks * 4));
 
 		// Save data for last incomplete block:
 
@@ -179,11 +296,24 @@ namespace clan
 		memcpy(impl->chunk, data + pos, leftover);
 	}
 
+	int Base64Decoder::get_decoded_size(int size)
+	{
+		return size / 4 * 3;
+	}
+
+	int Base64Decoder::decode(const void *_data, int size, void *out_buffer)
+	{
+		const unsigned char *data = (const unsigned char *)_data;
+		int blocks = size / 4;
+		Base64Decoder_Impl::decode((unsigned char *)out_buffer, data, blocks * 4);
+		return Base64Decoder_Impl::get_decoded_size(data, blocks * 4);
+	}
+
 	DataBuffer Base64Decoder::decode(const void *data, int size)
 	{
-		Base64Decoder decoder;
-		decoder.feed(data, size);
-		return decoder.get_result();
+		DataBuffer result(get_decoded_size(size));
+		result.set_size(decode(data, size, result.get_data()));
+		return result;
 	}
 
 	DataBuffer Base64Decoder::decode(const std::string &data)
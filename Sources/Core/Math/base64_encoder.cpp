@@ -29,6 +29,20 @@
 #include "Core/precomp.h"
 #include "API/Core/Math/base64_encoder.h"
 #include "API/Core/System/databuffer.h"
+#include "API/Core/System/system.h"
+
+#if !defined CL_DISABLE_SSE2 && !defined __ANDROID__
+#include <immintrin.h>
+#define CL_BASE64_SIMD
+#if defined(__GNUC__)
+// The SSSE3 and AVX2 kernels are compiled for their instruction sets only, and selected at runtime
+#define CL_TARGET_SSSE3 __attribute__((target("ssse3")))
+#define CL_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define CL_TARGET_SSSE3
+#define CL_TARGET_AVX2
+#endif
+#endif
 
 namespace clan
 {
@@ -61,8 +75,17 @@ namespace clan
 	public:
 		static void encode(unsigned char *output, const unsigned char *input, int size_input)
 		{
-			int i, o;
-			for (i = 0, o = 0; i < size_input; i += 3, o += 4)
+			int i = 0, o = 0;
+#ifdef CL_BASE64_SIMD
+			static const bool use_avx2 = System::detect_cpu_extension(System::avx2);
+			static const bool use_ssse3 = System::detect_cpu_extension(System::ssse3);
+			if (use_avx2)
+				i = encode_avx2(output, input, size_input);
+			else if (use_ssse3)
+				i = encode_ssse3(output, input, size_input);
+			o = i / 3 * 4;
+#endif
+			for (; i < size_input; i += 3, o += 4)
 			{
 				unsigned int v1 = input[i + 0];
 				unsigned int v2 = input[i + 1];
@@ -75,6 +98,71 @@ namespace clan
 				output[o + 3] = cl_base64char[value & 63];
 			}
 		}
+
+		/// Encodes the last 1 or 2 bytes, with padding
+		static void encode_final(unsigned char *output, const unsigned char *input, int size_input)
+		{
+			unsigned int v1 = input[0];
+			unsigned int v2 = size_input > 1 ? input[1] : 0;
+			unsigned int value = (v1 << 16) + (v2 << 8);
+
+			output[0] = cl_base64char[(value >> 18) & 63];
+			output[1] = cl_base64char[(value >> 12) & 63];
+			output[2] = size_input > 1 ? cl_base64char[(value >> 6) & 63] : '=';
+			output[3] = '=';
+		}
+
+#ifdef CL_BASE64_SIMD
+		// Vectorized encoding as described by Wojciech Mula in "Base64 encoding with SIMD instructions".
+		// Each 32 bit lane gets three input bytes, which are split into four 6 bit indices with two
+		// multiplies, and the indices are turned into characters by adding an offset picked with pshufb.
+
+		CL_TARGET_SSSE3 static inline __m128i encode_ssse3_lanes(__m128i in)
+		{
+			in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+			__m128i t0 = _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+			__m128i t1 = _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+			__m128i indices = _mm_or_si128(t0, t1);
+
+			__m128i offset_index = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+			__m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+			offset_index = _mm_or_si128(offset_index, _mm_and_si128(less, _mm_set1_epi8(13)));
+			const __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+			return _mm_add_epi8(_mm_shuffle_epi8(offsets, offset_index), indices);
+		}
+
+		CL_TARGET_SSSE3 static int encode_ssse3(unsigned char *output, const unsigned char *input, int size_input)
+		{
+			// Loads 16 bytes to consume 12
+			int i = 0, o = 0;
+			for (; i + 16 <= size_input; i += 12, o += 16)
+				_mm_storeu_si128((__m128i*)(output + o), encode_ssse3_lanes(_mm_loadu_si128((const __m128i*)(input + i))));
+			return i;
+		}
+
+		CL_TARGET_AVX2 static int encode_avx2(unsigned char *output, const unsigned char *input, int size_input)
+		{
+			int i = 0, o = 0;
+			for (; i + 28 <= size_input; i += 24, o += 32)
+			{
+				__m256i in = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(input + i))), _mm_loadu_si128((const __m128i*)(input + i + 12)), 1);
+
+				in = _mm256_shuffle_epi8(in, _mm256_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1, 10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+				__m256i t0 = _mm256_mulhi_epu16(_mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00)), _mm256_set1_epi32(0x04000040));
+				__m256i t1 = _mm256_mullo_epi16(_mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0)), _mm256_set1_epi32(0x01000010));
+				__m256i indices = _mm256_or_si256(t0, t1);
+
+				__m256i offset_index = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+				__m256i less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+				offset_index = _mm256_or_si256(offset_index, _mm256_and_si256(less, _mm256_set1_epi8(13)));
+				const __m256i offsets = _mm256_setr_epi8(
+					'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+					'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+				_mm256_storeu_si256((__m256i*)(output + o), _mm256_add_epi8(_mm256_shuffle_epi8(offsets, offset_index), indices));
+			}
+			return i;
+		}
+#endif
 	};
 
 	Base64Encoder::Base64Encoder()
@@ -147,45 +235,36 @@ namespace clan
 		if (impl->chunk_filled == 0)
 			return;
 
-		// Allocate memory for last block:
+		// Base64 last block:
 
 		int pos = impl->result.get_size();
 		impl->result.set_size(pos + 4);
-		unsigned char *output = (unsigned char *)impl->result.get_data() + pos;
-		unsigned char *input = impl->chunk;
-		int size = impl->chunk_filled;
-
-		// Base64 last block:
-
-		memset(input + size, 0, 3 - size);
+		Base64Encoder_Impl::encode_final((unsigned char *)impl->result.get_data() + pos, impl->chunk, impl->chunk_filled);
+	}
 
-		unsigned int v1 = input[0];
-		unsigned int v2 = input[1];
-		unsigned int v3 = input[2];
-		unsigned int value = (v1 << 16) + (v2 << 8) + v3;
+	int Base64Encoder::get_encoded_size(int size)
+	{
+		return (size + 2) / 3 * 4;
+	}
 
-		output[0] = cl_base64char[(value >> 18) & 63];
-		output[1] = cl_base64char[(value >> 12) & 63];
-		output[2] = cl_base64char[(value >> 6) & 63];
-		output[3] = cl_base64char[value & 63];
+	int Base64Encoder::encode(const void *_data, int size, char *out_buffer)
+	{
+		const unsigned char *data = (const unsigned char *)_data;
+		unsigned char *output = (unsigned char *)out_buffer;
 
-		if (impl->chunk_filled == 1)
-		{
-			output[2] = '=';
-			output[3] = '=';
-		}
-		else if (impl->chunk_filled == 2)
-		{
-			output[3] = '=';
-		}
+		int blocks = size / 3;
+		Base64Encoder_Impl::encode(output, data, blocks * 3);
+		if (size > blocks * 3)
+			Base64Encoder_Impl::encode_final(output + blocks * 4, data + blocks * 3, size - blocks * 3);
+		return get_encoded_size(size);
 	}
 
 	std::string Base64Encoder::encode(const void *data, int size)
 	{
-		Base64Encoder encoder;
-		encoder.feed(data, size);
-		encoder.finalize(true);
-		return std::string(encoder.get_result().get_data(), encoder.get_result().get_size());
+		std::string result(get_encoded_size(size), '\0');
+		if (!result.empty())
+			encode(data, size, &result[0]);
+		return result;
 	}
 
 	std::string Base64Encoder::encode(const std::string &data)
@@ -0,0 +1,1197 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Core/precomp.h"
+#include "API/Core/Math/batch_math.h"
+#include "API/Core/Math/frustum_planes.h"
+#include "API/Core/Math/obb.h"
+#include "API/Core/System/system.h"
+#include "API/Core/System/work_queue.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#ifndef CL_DISABLE_SSE2
+#include <emmintrin.h>
+#endif
+
+#if !defined CL_DISABLE_SSE2 && !defined __ANDROID__
+#include <immintrin.h>
+#define CL_BATCH_MATH_AVX
+#if defined(__GNUC__)
+// The AVX kernels are compiled for AVX only, and selected at runtime
+#define CL_TARGET_AVX __attribute__((target("avx")))
+#else
+#define CL_TARGET_AVX
+#endif
+#endif
+
+#if defined CL_DISABLE_SSE2 && (defined __ARM_NEON || defined __ARM_NEON__)
+#include <arm_neon.h>
+#define CL_BATCH_MATH_NEON
+#endif
+
+namespace clan
+{
+	static_assert(sizeof(Vec3f) == 3 * sizeof(float), "The kernels treat Vec3f arrays as packed floats");
+	static_assert(sizeof(Vec4f) == 4 * sizeof(float), "The kernels treat Vec4f arrays as packed floats");
+	static_assert(sizeof(AxisAlignedBoundingBox) == 6 * sizeof(float), "The kernels treat AxisAlignedBoundingBox arrays as packed floats");
+	static_assert(sizeof(Pointf) == 2 * sizeof(float), "The kernels treat Pointf arrays as packed floats");
+
+	static inline Vec3f batch_transform_point(const float *m, const Vec3f &p)
+	{
+		return Vec3f(
+			m[0] * p.x + m[4] * p.y + m[8] * p.z + m[12],
+			m[1] * p.x + m[5] * p.y + m[9] * p.z + m[13],
+			m[2] * p.x + m[6] * p.y + m[10] * p.z + m[14]);
+	}
+
+	static inline Vec3f batch_normalize(const Vec3f &v)
+	{
+		float length2 = v.x * v.x + v.y * v.y + v.z * v.z;
+		if (length2 <= 0.0f)
+			return Vec3f();
+		float scale = 1.0f / std::sqrt(length2);
+		return Vec3f(v.x * scale, v.y * scale, v.z * scale);
+	}
+
+#ifndef CL_DISABLE_SSE2
+
+	// Four Vec3f are loaded as a = (x0 y0 z0 x1), b = (y1 z1 x2 y2), c = (z2 x3 y3 z3) and shuffled into x, y and z registers
+	static inline void batch_sse_load_vec3(const Vec3f *p, __m128 &x, __m128 &y, __m128 &z)
+	{
+		const float *f = &p->x;
+		__m128 a = _mm_loadu_ps(f);
+		__m128 b = _mm_loadu_ps(f + 4);
+		__m128 c = _mm_loadu_ps(f + 8);
+
+		x = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+		y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+		z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+	}
+
+	static inline void batch_sse_store_vec3(Vec3f *p, __m128 x, __m128 y, __m128 z)
+	{
+		float *f = &p->x;
+		_mm_storeu_ps(f, _mm_shuffle_ps(_mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 0, 0, 0)), _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0)));
+		_mm_storeu_ps(f + 4, _mm_shuffle_ps(_mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1)), _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 2, 2, 2)), _MM_SHUFFLE(2, 0, 2, 0)));
+		_mm_storeu_ps(f + 8, _mm_shuffle_ps(_mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2)), _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0)));
+	}
+
+	// m holds the upper 3x4 part of the matrix with every element broadcast, in matrix order
+	static inline void batch_sse_transform(const __m128 *m, __m128 &x, __m128 &y, __m128 &z)
+	{
+		__m128 tx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[0], x), _mm_mul_ps(m[3], y)), _mm_add_ps(_mm_mul_ps(m[6], z), m[9]));
+		__m128 ty = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[1], x), _mm_mul_ps(m[4], y)), _mm_add_ps(_mm_mul_ps(m[7], z), m[10]));
+		__m128 tz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[2], x), _mm_mul_ps(m[5], y)), _mm_add_ps(_mm_mul_ps(m[8], z), m[11]));
+		x = tx;
+		y = ty;
+		z = tz;
+	}
+
+	static inline void batch_sse_normalize(__m128 &x, __m128 &y, __m128 &z)
+	{
+		__m128 length2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+		__m128 scale = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(_mm_max_ps(length2, _mm_set1_ps(FLT_MIN))));
+		x = _mm_mul_ps(x, scale);
+		y = _mm_mul_ps(y, scale);
+		z = _mm_mul_ps(z, scale);
+	}
+
+	static void batch_sse_load_matrix(const float *matrix, __m128 *m)
+	{
+		for (int col = 0; col < 4; col++)
+		{
+			for (int row = 0; row < 3; row++)
+				m[col * 3 + row] = _mm_set1_ps(matrix[col * 4 + row]);
+		}
+	}
+
+	static size_t batch_sse_transform_points(const float *matrix, const Vec3f *in, Vec3f *out, size_t count, bool normalize)
+	{
+		__m128 m[12];
+		batch_sse_load_matrix(matrix, m);
+
+		size_t i;
+		for (i = 0; i + 4 <= count; i += 4)
+		{
+			__m128 x, y, z;
+			batch_sse_load_vec3(in + i, x, y, z);
+			batch_sse_transform(m, x, y, z);
+			if (normalize)
+				batch_sse_normalize(x, y, z);
+			batch_sse_store_vec3(out + i, x, y, z);
+		}
+		return i;
+	}
+
+	static size_t batch_sse_transform_points(const float *matrix, const float *in_x, const float *in_y, const float *in_z, float *out_x, float *out_y, float *out_z, size_t count)
+	{
+		__m128 m[12];
+		batch_sse_load_matrix(matrix, m);
+
+		size_t i;
+		for (i = 0; i + 4 <= count; i += 4)
+		{
+			__m128 x = _mm_loadu_ps(in_x + i);
+			__m128 y = _mm_loadu_ps(in_y + i);
+			__m128 z = _mm_loadu_ps(in_z + i);
+			batch_sse_transform(m, x, y, z);
+			_mm_storeu_ps(out_x + i, x);
+			_mm_storeu_ps(out_y + i, y);
+			_mm_storeu_ps(out_z + i, z);
+		}
+		return i;
+	}
+
+	static size_t batch_sse_bounding_box(const Vec3f *points, size_t count, Vec3f &out_min, Vec3f &out_max)
+	{
+		if (count < 4)
+			return 0;
+
+		// Each register position always holds the same component, so no shuffles are needed in the loop
+		const float *f = &points->x;
+		__m128 min_a = _mm_loadu_ps(f), min_b = _mm_loadu_ps(f + 4), min_c = _mm_loadu_ps(f + 8);
+		__m128 max_a = min_a, max_b = min_b, max_c = min_c;
+
+		size_t i;
+		for (i = 4; i + 4 <= count; i += 4)
+		{
+			f = &points[i].x;
+			__m128 a = _mm_loadu_ps(f), b = _mm_loadu_ps(f + 4), c = _mm_loadu_ps(f + 8);
+			min_a = _mm_min_ps(min_a, a);
+			min_b = _mm_min_ps(min_b, b);
+			min_c = _mm_min_ps(min_c, c);
+			max_a = _mm_max_ps(max_a, a);
+			max_b = _mm_max_ps(max_b, b);
+			max_c = _mm_max_ps(max_c, c);
+		}
+
+		float mins[12], maxs[12];
+		_mm_storeu_ps(mins, min_a);
+		_mm_storeu_ps(mins + 4, min_b);
+		_mm_storeu_ps(mins + 8, min_c);
+		_mm_storeu_ps(maxs, max_a);
+		_mm_storeu_ps(maxs + 4, max_b);
+		_mm_storeu_ps(maxs + 8, max_c);
+
+		out_min = Vec3f(mins[0], mins[1], mins[2]);
+		out_max = Vec3f(maxs[0], maxs[1], maxs[2]);
+		for (int j = 3; j < 12; j++)
+		{
+			(&out_min.x)[j % 3] = min((&out_min.x)[j % 3], mins[j]);
+			(&out_max.x)[j % 3] = max((&out_max.x)[j % 3], maxs[j]);
+		}
+		return i;
+	}
+
+	static size_t batch_sse_bounding_box(const float *x, const float *y, const float *z, size_t count, Vec3f &out_min, Vec3f &out_max)
+	{
+		if (count < 4)
+			return 0;
+
+		__m128 min_x = _mm_loadu_ps(x), min_y = _mm_loadu_ps(y), min_z = _mm_loadu_ps(z);
+		__m128 max_x = min_x, max_y = min_y, max_z = min_z;
+
+		size_t i;
+		for (i = 4; i + 4 <= count; i += 4)
+		{
+			__m128 vx = _mm_loadu_ps(x + i), vy = _mm_loadu_ps(y + i), vz = _mm_loadu_ps(z + i);
+			min_x = _mm_min_ps(min_x, vx);
+			min_y = _mm_min_ps(min_y, vy);
+			min_z = _mm_min_ps(min_z, vz);
+			max_x = _mm_max_ps(max_x, vx);
+			max_y = _mm_max_ps(max_y, vy);
+			max_z = _mm_max_ps(max_z, vz);
+		}
+
+		float mins[12], maxs[12];
+		_mm_storeu_ps(mins, min_x);
+		_mm_storeu_ps(mins + 4, min_y);
+		_mm_storeu_ps(mins + 8, min_z);
+		_mm_storeu_ps(maxs, max_x);
+		_mm_storeu_ps(maxs + 4, max_y);
+		_mm_storeu_ps(maxs + 8, max_z);
+
+		for (int c = 0; c < 3; c++)
+		{
+			const float *cmin = mins + c * 4;
+			const float *cmax = maxs + c * 4;
+			(&out_min.x)[c] = min(min(cmin[0], cmin[1]), min(cmin[2], cmin[3]));
+			(&out_max.x)[c] = max(max(cmax[0], cmax[1]), max(cmax[2], cmax[3]));
+		}
+		return i;
+	}
+
+#endif
+
+#ifdef CL_BATCH_MATH_AVX
+
+	static bool batch_math_use_avx()
+	{
+		static const bool supported = System::detect_cpu_extension(System::avx);
+		return supported;
+	}
+
+	// Eight Vec3f are loaded with the first four in the low lanes and the last four in the high lanes.
+	// The shuffles are the same as for SSE, since AVX shuffles work within each 128 bit lane.
+	CL_TARGET_AVX static inline __m256 batch_avx_load_lanes(const float *f)
+	{
+		return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(f)), _mm_loadu_ps(f + 12), 1);
+	}
+
+	CL_TARGET_AVX static inline void batch_avx_store_lanes(float *f, __m256 v)
+	{
+		_mm_storeu_ps(f, _mm256_castps256_ps128(v));
+		_mm_storeu_ps(f + 12, _mm256_extractf128_ps(v, 1));
+	}
+
+	CL_TARGET_AVX static inline void batch_avx_load_vec3(const Vec3f *p, __m256 &x, __m256 &y, __m256 &z)
+	{
+		const float *f = &p->x;
+		__m256 a = batch_avx_load_lanes(f);
+		__m256 b = batch_avx_load_lanes(f + 4);
+		__m256 c = batch_avx_load_lanes(f + 8);
+
+		x = _mm256_shuffle_ps(a, _mm256_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+		y = _mm256_shuffle_ps(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)), _mm256_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+		z = _mm256_shuffle_ps(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), _mm256_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+	}
+
+	CL_TARGET_AVX static inline void batch_avx_store_vec3(Vec3f *p, __m256 x, __m256 y, __m256 z)
+	{
+		float *f = &p->x;
+		batch_avx_store_lanes(f, _mm256_shuffle_ps(_mm256_shuffle_ps(x, y, _MM_SHUFFLE(0, 0, 0, 0)), _mm256_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0)));
+		batch_avx_store_lanes(f + 4, _mm256_shuffle_ps(_mm256_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1)), _mm256_shuffle_ps(x, y, _MM_SHUFFLE(2, 2, 2, 2)), _MM_SHUFFLE(2, 0, 2, 0)));
+		batch_avx_store_lanes(f + 8, _mm256_shuffle_ps(_mm256_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2)), _mm256_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0)));
+	}
+
+	CL_TARGET_AVX static inline void batch_avx_transform(const __m256 *m, __m256 &x, __m256 &y, __m256 &z)
+	{
+		__m256 tx = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m[0], x), _mm256_mul_ps(m[3], y)), _mm256_add_ps(_mm256_mul_ps(m[6], z), m[9]));
+		__m256 ty = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m[1], x), _mm256_mul_ps(m[4], y)), _mm256_add_ps(_mm256_mul_ps(m[7], z), m[10]));
+		__m256 tz = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m[2], x), _mm256_mul_ps(m[5], y)), _mm256_add_ps(_mm256_mul_ps(m[8], z), m[11]));
+		x = tx;
+		y = ty;
+		z = tz;
+	}
+
+	CL_TARGET_AVX static inline void batch_avx_normalize(__m256 &x, __m256 &y, __m256 &z)
+	{
+		__m256 length2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)), _mm256_mul_ps(z, z));
+		__m256 scale = _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(_mm256_max_ps(length2, _mm256_set1_ps(FLT_MIN))));
+		x = _mm256_mul_ps(x, scale);
+		y = _mm256_mul_ps(y, scale);
+		z = _mm256_mul_ps(z, scale);
+	}
+
+	CL_TARGET_AVX static void batch_avx_load_matrix(const float *matrix, __m256 *m)
+	{
+		for (int col = 0; col < 4; col++)
+		{
+			for (int row = 0; row < 3; row++)
+				m[col * 3 + row] = _mm256_set1_ps(matrix[col * 4 + row]);
+		}
+	}
+
+	CL_TARGET_AVX static size_t batch_avx_transform_points(const float *matrix, const Vec3f *in, Vec3f *out, size_t count, bool normalize)
+	{
+		__m256 m[12];
+		batch_avx_load_matrix(matrix, m);
+
+		size_t i;
+		for (i = 0; i + 8 <= count; i += 8)
+		{
+			__m256 x, y, z;
+			batch_avx_load_vec3(in + i, x, y, z);
+			batch_avx_transform(m, x, y, z);
+			if (normalize)
+				batch_avx_normalize(x, y, z);
+			batch_avx_store_vec3(out + i, x, y, z);
+		}
+		return i;
+	}
+
+	CL_TARGET_AVX static size_t batch_avx_transform_points(const float *matrix, const float *in_x, const float *in_y, const float *in_z, float *out_x, float *out_y, float *out_z, size_t count)
+	{
+		__m256 m[12];
+		batch_avx_load_matrix(matrix, m);
+
+		size_t i;
+		for (i = 0; i + 8 <= count; i += 8)
+		{
+			__m256 x = _mm256_loadu_ps(in_x + i);
+			__m256 y = _mm256_loadu_ps(in_y + i);
+			__m256 z = _mm256_loadu_ps(in_z + i);
+			batch_avx_transform(m, x, y, z);
+			_mm256_storeu_ps(out_x + i, x);
+			_mm256_storeu_ps(out_y + i, y);
+			_mm256_storeu_ps(out_z + i, z);
+		}
+		return i;
+	}
+
+	CL_TARGET_AVX static size_t batch_avx_bounding_box(const float *x, const float *y, const float *z, size_t count, Vec3f &out_min, Vec3f &out_max)
+	{
+		if (count < 8)
+			return 0;
+
+		__m256 min_x = _mm256_loadu_ps(x), min_y = _mm256_loadu_ps(y), min_z = _mm256_loadu_ps(z);
+		__m256 max_x = min_x, max_y = min_y, max_z = min_z;
+
+		size_t i;
+		for (i = 8; i + 8 <= count; i += 8)
+		{
+			__m256 vx = _mm256_loadu_ps(x + i), vy = _mm256_loadu_ps(y + i), vz = _mm256_loadu_ps(z + i);
+			min_x = _mm256_min_ps(min_x, vx);
+			min_y = _mm256_min_ps(min_y, vy);
+			min_z = _mm256_min_ps(min_z, vz);
+			max_x = _mm256_max_ps(max_x, vx);
+			max_y = _mm256_max_ps(max_y, vy);
+			max_z = _mm256_max_ps(max_z, vz);
+		}
+
+		float mins[24], maxs[24];
+		_mm256_storeu_ps(mins, min_x);
+		_mm256_storeu_ps(mins + 8, min_y);
+		_mm256_storeu_ps(mins + 16, min_z);
+		_mm256_storeu_ps(maxs, max_x);
+		_mm256_storeu_ps(maxs + 8, max_y);
+		_mm256_storeu_ps(maxs + 16, max_z);
+
+		for (int c = 0; c < 3; c++)
+		{
+			float cmin = mins[c * 8];
+			float cmax = maxs[c * 8];
+			for (int j = 1; j < 8; j++)
+			{
+				cmin = min(cmin, mins[c * 8 + j]);
+				cmax = max(cmax, maxs[c * 8 + j]);
+			}
+			(&out_min.x)[c] = cmin;
+			(&out_max.x)[c] = cmax;
+		}
+		return i;
+	}
+
+#endif
+
+#ifdef CL_BATCH_MATH_NEON
+
+	static inline void batch_neon_transform(const float *m, float32x4x3_t &v)
+	{
+		float32x4_t x = v.val[0], y = v.val[1], z = v.val[2];
+		v.val[0] = vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(vdupq_n_f32(m[12]), x, m[0]), y, m[4]), z, m[8]);
+		v.val[1] = vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(vdupq_n_f32(m[13]), x, m[1]), y, m[5]), z, m[9]);
+		v.val[2] = vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(vdupq_n_f32(m[14]), x, m[2]), y, m[6]), z, m[10]);
+	}
+
+	static inline void batch_neon_normalize(float32x4x3_t &v)
+	{
+		float32x4_t length2 = vmlaq_f32(vmlaq_f32(vmulq_f32(v.val[0], v.val[0]), v.val[1], v.val[1]), v.val[2], v.val[2]);
+		length2 = vmaxq_f32(length2, vdupq_n_f32(FLT_MIN));
+
+		// Reciprocal square root estimate refined with two Newton-Raphson steps
+		float32x4_t scale = vrsqrteq_f32(length2);
+		scale = vmulq_f32(scale, vrsqrtsq_f32(vmulq_f32(length2, scale), scale));
+		scale = vmulq_f32(scale, vrsqrtsq_f32(vmulq_f32(length2, scale), scale));
+
+		v.val[0] = vmulq_f32(v.val[0], scale);
+		v.val[1] = vmulq_f32(v.val[1], scale);
+		v.val[2] = vmulq_f32(v.val[2], scale);
+	}
+
+	static size_t batch_neon_transform_points(const float *matrix, const Vec3f *in, Vec3f *out, size_t count, bool normalize)
+	{
+		size_t i;
+		for (i = 0; i + 4 <= count; i += 4)
+		{
+			float32x4x3_t v = vld3q_f32(&in[i].x);
+			batch_neon_transform(matrix, v);
+			if (normalize)
+				batch_neon_normalize(v);
+			vst3q_f32(&out[i].x, v);
+		}
+		return i;
+	}
+
+	static size_t batch_neon_transform_points(const float *matrix, const float *in_x, const float *in_y, const float *in_z, float *out_x, float *out_y, float *out_z, size_t count)
+	{
+		size_t i;
+		for (i = 0; i + 4 <= count; i += 4)
+		{
+			float32x4x3_t v;
+			v.val[0] = vld1q_f32(in_x + i);
+			v.val[1] = vld1q_f32(in_y + i);
+			v.val[2] = vld1q_f32(in_z + i);
+			batch_neon_transform(matrix, v);
+			vst1q_f32(out_x + i, v.val[0]);
+			vst1q_f32(out_y + i, v.val[1]);
+			vst1q_f32(out_z + i, v.val[2]);
+		}
+		return i;
+	}
+
+	static size_t batch_neon_bounding_box(const float32x4x3_t &first, size_t count, Vec3f &out_min, Vec3f &out_max, const Vec3f *points, const float *x, const float *y, const float *z)
+	{
+		float32x4x3_t vmin = first, vmax = first;
+
+		size_t i;
+		for (i = 4; i + 4 <= count; i += 4)
+		{
+			float32x4x3_t v;
+			if (points)
+			{
+				v = vld3q_f32(&points[i].x);
+			}
+			else
+			{
+				v.val[0] = vld1q_f32(x + i);
+				v.val[1] = vld1q_f32(y + i);
+				v.val[2] = vld1q_f32(z + i);
+			}
+			for (int c = 0; c < 3; c++)
+			{
+				vmin.val[c] = vminq_f32(vmin.val[c], v.val[c]);
+				vmax.val[c] = vmaxq_f32(vmax.val[c], v.val[c]);
+			}
+		}
+
+		for (int c = 0; c < 3; c++)
+		{
+			float mins[4], maxs[4];
+			vst1q_f32(mins, vmin.val[c]);
+			vst1q_f32(maxs, vmax.val[c]);
+			(&out_min.x)[c] = min(min(mins[0], mins[1]), min(mins[2], mins[3]));
+			(&out_max.x)[c] = max(max(maxs[0], maxs[1]), max(maxs[2], maxs[3]));
+		}
+		return i;
+	}
+
+#endif
+
+	static void batch_transform_points(const float *matrix, const Vec3f *in, Vec3f *out, size_t count, bool normalize)
+	{
+		size_t i = 0;
+
+#ifdef CL_BATCH_MATH_AVX
+		if (batch_math_use_avx())
+			i = batch_avx_transform_points(matrix, in, out, count, normalize);
+#endif
+#ifndef CL_DISABLE_SSE2
+		i += batch_sse_transform_points(matrix, in + i, out + i, count - i, normalize);
+#elif defined CL_BATCH_MATH_NEON
+		i = batch_neon_transform_points(matrix, in, out, count, normalize);
+#endif
+
+		for (; i < count; i++)
+		{
+			Vec3f p = batch_transform_point(matrix, in[i]);
+			out[i] = normalize ? batch_normalize(p) : p;
+		}
+	}
+
+	void BatchMath::transform_points(const Mat4f &matrix, const Vec3f *in, Vec3f *out, size_t count)
+	{
+		batch_transform_points(matrix.matrix, in, out, count, false);
+	}
+
+	void BatchMath::transform_points(const Mat4f &matrix, const Vec3f *in, Vec4f *out, size_t count)
+	{
+		const float *m = matrix.matrix;
+		size_t i = 0;
+
+#ifndef CL_DISABLE_SSE2
+		__m128 col0 = _mm_loadu_ps(m), col1 = _mm_loadu_ps(m + 4), col2 = _mm_loadu_ps(m + 8), col3 = _mm_loadu_ps(m + 12);
+		if ((const void *)in != (const void *)out)
+		{
+			for (; i < count; i++)
+			{
+				const Vec3f &p = in[i];
+				__m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(col0, _mm_set1_ps(p.x)), _mm_mul_ps(col1, _mm_set1_ps(p.y))), _mm_add_ps(_mm_mul_ps(col2, _mm_set1_ps(p.z)), col3));
+				_mm_storeu_ps(&out[i].x, r);
+			}
+		}
+#elif defined CL_BATCH_MATH_NEON
+		float32x4_t col0 = vld1q_f32(m), col1 = vld1q_f32(m + 4), col2 = vld1q_f32(m + 8), col3 = vld1q_f32(m + 12);
+		if ((const void *)in != (const void *)out)
+		{
+			for (; i < count; i++)
+			{
+				const Vec3f &p = in[i];
+				vst1q_f32(&out[i].x, vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(col3, col0, p.x), col1, p.y), col2, p.z));
+			}
+		}
+#endif
+
+		// In place use writes 16 bytes for every 12 read, so it must run backwards
+		for (size_t j = count; j > i; j--)
+		{
+			Vec3f p = in[j - 1];
+			out[j - 1] = Vec4f(
+				m[0] * p.x + m[4] * p.y + m[8] * p.z + m[12],
+				m[1] * p.x + m[5] * p.y + m[9] * p.z + m[13],
+				m[2] * p.x + m[6] * p.y + m[10] * p.z + m[14],
+				m[3] * p.x + m[7] * p.y + m[11] * p.z + m[15]);
+		}
+	}
+
+	void BatchMath::transform_points(const Mat4f &matrix, const float *in_x, const float *in_y, const float *in_z, float *out_x, float *out_y, float *out_z, size_t count)
+	{
+		const float *m = matrix.matrix;
+		size_t i = 0;
+
+#ifdef CL_BATCH_MATH_AVX
+		if (batch_math_use_avx())
+			i = batch_avx_transform_points(m, in_x, in_y, in_z, out_x, out_y, out_z, count);
+#endif
+#ifndef CL_DISABLE_SSE2
+		i += batch_sse_transform_points(m, in_x + i, in_y + i, in_z + i, out_x + i, out_y + i, out_z + i, count - i);
+#elif defined CL_BATCH_MATH_NEON
+		i = batch_neon_transform_points(m, in_x, in_y, in_z, out_x, out_y, out_z, count);
+#endif
+
+		for (; i < count; i++)
+		{
+			Vec3f p = batch_transform_point(m, Vec3f(in_x[i], in_y[i], in_z[i]));
+			out_x[i] = p.x;
+			out_y[i] = p.y;
+			out_z[i] = p.z;
+		}
+	}
+
+	void BatchMath::transform_vectors(const Mat4f &matrix, const Vec4f *in, Vec4f *out, size_t count)
+	{
+		const float *m = matrix.matrix;
+
+#ifndef CL_DISABLE_SSE2
+		__m128 col0 = _mm_loadu_ps(m), col1 = _mm_loadu_ps(m + 4), col2 = _mm_loadu_ps(m + 8), col3 = _mm_loadu_ps(m + 12);
+		for (size_t i = 0; i < count; i++)
+		{
+			__m128 v = _mm_loadu_ps(&in[i].x);
+			__m128 r = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(col0, _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0))), _mm_mul_ps(col1, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)))),
+				_mm_add_ps(_mm_mul_ps(col2, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2))), _mm_mul_ps(col3, _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)))));
+			_mm_storeu_ps(&out[i].x, r);
+		}
+#elif defined CL_BATCH_MATH_NEON
+		float32x4_t col0 = vld1q_f32(m), col1 = vld1q_f32(m + 4), col2 = vld1q_f32(m + 8), col3 = vld1q_f32(m + 12);
+		for (size_t i = 0; i < count; i++)
+		{
+			Vec4f v = in[i];
+			vst1q_f32(&out[i].x, vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(vmulq_n_f32(col0, v.x), col1, v.y), col2, v.z), col3, v.w));
+		}
+#else
+		for (size_t i = 0; i < count; i++)
+		{
+			Vec4f v = in[i];
+			out[i] = Vec4f(
+				m[0] * v.x + m[4] * v.y + m[8] * v.z + m[12] * v.w,
+				m[1] * v.x + m[5] * v.y + m[9] * v.z + m[13] * v.w,
+				m[2] * v.x + m[6] * v.y + m[10] * v.z + m[14] * v.w,
+				m[3] * v.x + m[7] * v.y + m[11] * v.z + m[15] * v.w);
+		}
+#endif
+	}
+
+	void BatchMath::transform_normals(const Mat4f &matrix, const Vec3f *in, Vec3f *out, size_t count)
+	{
+		Mat4f normal_matrix = Mat4f::transpose(Mat4f::inverse(matrix));
+		normal_matrix.matrix[12] = 0.0f;
+		normal_matrix.matrix[13] = 0.0f;
+		normal_matrix.matrix[14] = 0.0f;
+		batch_transform_points(normal_matrix.matrix, in, out, count, true);
+	}
+
+	AxisAlignedBoundingBox BatchMath::bounding_box(const Vec3f *points, size_t count)
+	{
+		if (count == 0)
+			return AxisAlignedBoundingBox();
+
+		Vec3f box_min = points[0], box_max = points[0];
+		size_t i = 0;
+
+#ifndef CL_DISABLE_SSE2
+		i = batch_sse_bounding_box(points, count, box_min, box_max);
+#elif defined CL_BATCH_MATH_NEON
+		if (count >= 4)
+			i = batch_neon_bounding_box(vld3q_f32(&points->x), count, box_min, box_max, points, nullptr, nullptr, nullptr);
+#endif
+
+		for (; i < count; i++)
+		{
+			box_min = min(box_min, points[i]);
+			box_max = max(box_max, points[i]);
+		}
+		return AxisAlignedBoundingBox(box_min, box_max);
+	}
+
+	AxisAlignedBoundingBox BatchMath::bounding_box(const float *x, const float *y, const float *z, size_t count)
+	{
+		if (count == 0)
+			return AxisAlignedBoundingBox();
+
+		Vec3f box_min(x[0], y[0], z[0]), box_max = box_min;
+		size_t i = 0;
+
+#ifdef CL_BATCH_MATH_AVX
+		if (batch_math_use_avx())
+			i = batch_avx_bounding_box(x, y, z, count, box_min, box_max);
+#endif
+#ifndef CL_DISABLE_SSE2
+		if (i == 0)
+			i = batch_sse_bounding_box(x, y, z, count, box_min, box_max);
+#elif defined CL_BATCH_MATH_NEON
+		if (count >= 4)
+		{
+			float32x4x3_t first;
+			first.val[0] = vld1q_f32(x);
+			first.val[1] = vld1q_f32(y);
+			first.val[2] = vld1q_f32(z);
+			i = batch_neon_bounding_box(first, count, box_min, box_max, nullptr, x, y, z);
+		}
+#endif
+
+		for (; i < count; i++)
+		{
+			Vec3f p(x[i], y[i], z[i]);
+			box_min = min(box_min, p);
+			box_max = max(box_max, p);
+		}
+		return AxisAlignedBoundingBox(box_min, box_max);
+	}
+
+	// Frustum culling.
+	// A box is outside when it is fully behind one of the planes. For an AABB the distance of the corner furthest
+	// along the plane normal is the sum of max(n * min, n * max) over the axes, which needs no branches.
+
+	static inline bool batch_aabb_outside(const float *planes, const AxisAlignedBoundingBox &box)
+	{
+		for (int i = 0; i < 6; i++)
+		{
+			const float *p = planes + i * 4;
+			float d = (max(p[0] * box.aabb_min.x, p[0] * box.aabb_max.x) + max(p[1] * box.aabb_min.y, p[1] * box.aabb_max.y)) + (max(p[2] * box.aabb_min.z, p[2] * box.aabb_max.z) + p[3]);
+			if (d < 0.0f)
+				return true;
+		}
+		return false;
+	}
+
+	static inline bool batch_obb_outside(const float *planes, const OrientedBoundingBox &box)
+	{
+		for (int i = 0; i < 6; i++)
+		{
+			const float *p = planes + i * 4;
+			Vec3f n(p[0], p[1], p[2]);
+			float s = Vec3f::dot(box.center, n) + p[3];
+			float e = box.extents.x * std::abs(Vec3f::dot(box.axis_x, n)) + box.extents.y * std::abs(Vec3f::dot(box.axis_y, n)) + box.extents.z * std::abs(Vec3f::dot(box.axis_z, n));
+			if (s + e < 0.0f)
+				return true;
+		}
+		return false;
+	}
+
+#ifndef CL_DISABLE_SSE2
+
+	// Returns the outside bits of up to 32 boxes, four at a time, and the number of boxes processed
+	static size_t batch_sse_cull(const float *planes, const AxisAlignedBoundingBox *boxes, size_t count, uint32_t &outside)
+	{
+		__m128 p[24];
+		for (int i = 0; i < 24; i++)
+			p[i] = _mm_set1_ps(planes[i]);
+
+		size_t i;
+		for (i = 0; i + 4 <= count; i += 4)
+		{
+			// Two overlapping loads per box give (min.x, min.y, min.z, max.x) and (min.z, max.x, max.y, max.z)
+			const float *f = &boxes[i].aabb_min.x;
+			__m128 min_x = _mm_loadu_ps(f), min_y = _mm_loadu_ps(f + 6), min_z = _mm_loadu_ps(f + 12), max_x = _mm_loadu_ps(f + 18);
+			__m128 unused_z = _mm_loadu_ps(f + 2), unused_x = _mm_loadu_ps(f + 8), max_y = _mm_loadu_ps(f + 14), max_z = _mm_loadu_ps(f + 20);
+			_MM_TRANSPOSE4_PS(min_x, min_y, min_z, max_x);
+			_MM_TRANSPOSE4_PS(unused_z, unused_x, max_y, max_z);
+
+			__m128 is_outside = _mm_setzero_ps();
+			for (int plane = 0; plane < 6; plane++)
+			{
+				const __m128 *n = p + plane * 4;
+				__m128 d = _mm_add_ps(
+					_mm_add_ps(_mm_max_ps(_mm_mul_ps(n[0], min_x), _mm_mul_ps(n[0], max_x)), _mm_max_ps(_mm_mul_ps(n[1], min_y), _mm_mul_ps(n[1], max_y))),
+					_mm_add_ps(_mm_max_ps(_mm_mul_ps(n[2], min_z), _mm_mul_ps(n[2], max_z)), n[3]));
+				is_outside = _mm_or_ps(is_outside, _mm_cmplt_ps(d, _mm_setzero_ps()));
+			}
+			outside |= ((uint32_t)_mm_movemask_ps(is_outside)) << i;
+		}
+		return i;
+	}
+
+	static size_t batch_sse_cull(const float *planes, const OrientedBoundingBox *boxes, size_t count, uint32_t &outside)
+	{
+		const __m128 sign_mask = _mm_set1_ps(-0.0f);
+
+		size_t i;
+		for (i = 0; i + 4 <= count; i += 4)
+		{
+			// Gather the 15 floats of each box into one register per field
+			const float *b0 = &boxes[i].center.x, *b1 = &boxes[i + 1].center.x, *b2 = &boxes[i + 2].center.x, *b3 = &boxes[i + 3].center.x;
+			__m128 field[15];
+			for (int f = 0; f < 15; f++)
+				field[f] = _mm_set_ps(b3[f], b2[f], b1[f], b0[f]);
+
+			__m128 is_outside = _mm_setzero_ps();
+			for (int plane = 0; plane < 6; plane++)
+			{
+				__m128 nx = _mm_set1_ps(planes[plane * 4]), ny = _mm_set1_ps(planes[plane * 4 + 1]), nz = _mm_set1_ps(planes[plane * 4 + 2]);
+				__m128 s = _mm_add_ps(_mm_add_ps(_mm_mul_ps(field[0], nx), _mm_mul_ps(field[1], ny)), _mm_add_ps(_mm_mul_ps(field[2], nz), _mm_set1_ps(planes[plane * 4 + 3])));
+				__m128 e = _mm_setzero_ps();
+				for (int axis = 0; axis < 3; axis++)
+				{
+					const __m128 *a = field + 6 + axis * 3;
+					__m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a[0], nx), _mm_mul_ps(a[1], ny)), _mm_mul_ps(a[2], nz));
+					e = _mm_add_ps(e, _mm_mul_ps(field[3 + axis], _mm_andnot_ps(sign_mask, dot)));
+				}
+				is_outside = _mm_or_ps(is_outside, _mm_cmplt_ps(_mm_add_ps(s, e), _mm_setzero_ps()));
+			}
+			outside |= ((uint32_t)_mm_movemask_ps(is_outside)) << i;
+		}
+		return i;
+	}
+
+#endif
+
+#ifdef CL_BATCH_MATH_AVX
+
+	// 4x4 transpose within each 128 bit lane
+	CL_TARGET_AVX static inline void batch_avx_transpose(__m256 &r0, __m256 &r1, __m256 &r2, __m256 &r3)
+	{
+		__m256 t0 = _mm256_unpacklo_ps(r0, r1);
+		__m256 t1 = _mm256_unpackhi_ps(r0, r1);
+		__m256 t2 = _mm256_unpacklo_ps(r2, r3);
+		__m256 t3 = _mm256_unpackhi_ps(r2, r3);
+		r0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+		r1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+		r2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+		r3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+	}
+
+	// Boxes 0-3 go in the low lanes and boxes 4-7 in the high lanes, so the movemask bits are in box order
+	CL_TARGET_AVX static inline __m256 batch_avx_load_box_pair(const float *f)
+	{
+		return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(f)), _mm_loadu_ps(f + 24), 1);
+	}
+
+	CL_TARGET_AVX static size_t batch_avx_cull(const float *planes, const AxisAlignedBoundingBox *boxes, size_t count, uint32_t &outside)
+	{
+		__m256 p[24];
+		for (int i = 0; i < 24; i++)
+			p[i] = _mm256_set1_ps(planes[i]);
+
+		size_t i;
+		for (i = 0; i + 8 <= count; i += 8)
+		{
+			const float *f = &boxes[i].aabb_min.x;
+			__m256 min_x = batch_avx_load_box_pair(f), min_y = batch_avx_load_box_pair(f + 6), min_z = batch_avx_load_box_pair(f + 12), max_x = batch_avx_load_box_pair(f + 18);
+			__m256 unused_z = batch_avx_load_box_pair(f + 2), unused_x = batch_avx_load_box_pair(f + 8), max_y = batch_avx_load_box_pair(f + 14), max_z = batch_avx_load_box_pair(f + 20);
+			batch_avx_transpose(min_x, min_y, min_z, max_x);
+			batch_avx_transpose(unused_z, unused_x, max_y, max_z);
+
+			__m256 is_outside = _mm256_setzero_ps();
+			for (int plane = 0; plane < 6; plane++)
+			{
+				const __m256 *n = p + plane * 4;
+				__m256 d = _mm256_add_ps(
+					_mm256_add_ps(_mm256_max_ps(_mm256_mul_ps(n[0], min_x), _mm256_mul_ps(n[0], max_x)), _mm256_max_ps(_mm256_mul_ps(n[1], min_y), _mm256_mul_ps(n[1], max_y))),
+					_mm256_add_ps(_mm256_max_ps(_mm256_mul_ps(n[2], min_z), _mm256_mul_ps(n[2], max_z)), n[3]));
+				is_outside = _mm256_or_ps(is_outside, _mm256_cmp_ps(d, _mm256_setzero_ps(), _CMP_LT_OQ));
+			}
+			outside |= ((uint32_t)_mm256_movemask_ps(is_outside)) << i;
+		}
+		return i;
+	}
+
+#endif
+
+	static uint32_t batch_cull_word(const float *planes, const AxisAlignedBoundingBox *boxes, size_t count)
+	{
+		uint32_t outside = 0;
+		size_t i = 0;
+
+#ifdef CL_BATCH_MATH_AVX
+		if (batch_math_use_avx())
+			i = batch_avx_cull(planes, boxes, count, outside);
+#endif
+#ifndef CL_DISABLE_SSE2
+		if (i == 0)
+			i = batch_sse_cull(planes, boxes, count, outside);
+#endif
+
+		for (; i < count; i++)
+		{
+			if (batch_aabb_outside(planes, boxes[i]))
+				outside |= 1u << i;
+		}
+		return count == 32 ? ~outside : ~outside & ((1u << count) - 1);
+	}
+
+	static uint32_t batch_cull_word(const float *planes, const OrientedBoundingBox *boxes, size_t count)
+	{
+		uint32_t outside = 0;
+		size_t i = 0;
+
+#ifndef CL_DISABLE_SSE2
+		i = batch_sse_cull(planes, boxes, count, outside);
+#endif
+
+		for (; i < count; i++)
+		{
+			if (batch_obb_outside(planes, boxes[i]))
+				outside |= 1u << i;
+		}
+		return count == 32 ? ~outside : ~outside & ((1u << count) - 1);
+	}
+
+	static inline size_t batch_count_bits(uint32_t v)
+	{
+		v = v - ((v >> 1) & 0x55555555);
+		v = (v & 0x33333333) + ((v >> 2) & 0x33333333);
+		return (((v + (v >> 4)) & 0x0f0f0f0f) * 0x01010101) >> 24;
+	}
+
+	template<typename BoxType>
+	static size_t batch_frustum_cull(const FrustumPlanes &frustum, const BoxType *boxes, size_t first_word, size_t last_word, size_t count, uint32_t *out_visible_mask)
+	{
+		const float *planes = &frustum.planes[0].x;
+		size_t visible = 0;
+		for (size_t word = first_word; word < last_word; word++)
+		{
+			size_t begin = word * 32;
+			size_t length = min(count - begin, (size_t)32);
+			uint32_t bits = batch_cull_word(planes, boxes + begin, length);
+			out_visible_mask[word] = bits;
+			visible += batch_count_bits(bits);
+		}
+		return visible;
+	}
+
+	template<typename BoxType>
+	static size_t batch_frustum_cull(WorkQueue &queue, const FrustumPlanes &frustum, const BoxType *boxes, size_t count, uint32_t *out_visible_mask)
+	{
+		// Each sub range covers whole mask words, so no two threads write the same word
+		int num_words = (int)((count + 31) / 32);
+		return queue.parallel_reduce(0, num_words, 0, (size_t)0,
+			[&](int first, int last) { return batch_frustum_cull(frustum, boxes, first, last, count, out_visible_mask); },
+			[](size_t a, size_t b) { return a + b; });
+	}
+
+	template<typename BoxType>
+	static size_t batch_frustum_cull_indices(const FrustumPlanes &frustum, const BoxType *boxes, size_t count, unsigned int *out_visible_indices)
+	{
+		const float *planes = &frustum.planes[0].x;
+		size_t visible = 0;
+		for (size_t begin = 0; begin < count; begin += 32)
+		{
+			uint32_t bits = batch_cull_word(planes, boxes + begin, min(count - begin, (size_t)32));
+			for (unsigned int index = (unsigned int)begin; bits; index++, bits >>= 1)
+			{
+				if (bits & 1)
+					out_visible_indices[visible++] = index;
+			}
+		}
+		return visible;
+	}
+
+	size_t BatchMath::frustum_cull(const FrustumPlanes &frustum, const AxisAlignedBoundingBox *boxes, size_t count, uint32_t *out_visible_mask)
+	{
+		return batch_frustum_cull(frustum, boxes, 0, (count + 31) / 32, count, out_visible_mask);
+	}
+
+	size_t BatchMath::frustum_cull(const FrustumPlanes &frustum, const OrientedBoundingBox *boxes, size_t count, uint32_t *out_visible_mask)
+	{
+		return batch_frustum_cull(frustum, boxes, 0, (count + 31) / 32, count, out_visible_mask);
+	}
+
+	size_t BatchMath::frustum_cull(WorkQueue &queue, const FrustumPlanes &frustum, const AxisAlignedBoundingBox *boxes, size_t count, uint32_t *out_visible_mask)
+	{
+		return batch_frustum_cull(queue, frustum, boxes, count, out_visible_mask);
+	}
+
+	size_t BatchMath::frustum_cull(WorkQueue &queue, const FrustumPlanes &frustum, const OrientedBoundingBox *boxes, size_t count, uint32_t *out_visible_mask)
+	{
+		return batch_frustum_cull(queue, frustum, boxes, count, out_visible_mask);
+	}
+
+	size_t BatchMath::frustum_cull_indices(const FrustumPlanes &frustum, const AxisAlignedBoundingBox *boxes, size_t count, unsigned int *out_visible_indices)
+	{
+		return batch_frustum_cull_indices(frustum, boxes, count, out_visible_indices);
+	}
+
+	size_t BatchMath::frustum_cull_indices(const FrustumPlanes &frustum, const OrientedBoundingBox *boxes, size_t count, unsigned int *out_visible_indices)
+	{
+		return batch_frustum_cull_indices(frustum, boxes, count, out_visible_indices);
+	}
+
+	size_t BatchMath::mask_to_indices(const uint32_t *visible_mask, size_t count, unsigned int *out_indices)
+	{
+		size_t written = 0;
+		for (size_t word = 0; word * 32 < count; word++)
+		{
+			uint32_t bits = visible_mask[word];
+			if (word * 32 + 32 > count)
+				bits &= (1u << (count - word * 32)) - 1;
+			for (unsigned int index = (unsigned int)(word * 32); bits; index++, bits >>= 1)
+			{
+				if (bits & 1)
+					out_indices[written++] = index;
+			}
+		}
+		return written;
+	}
+
+	// Forward differences of one axis of a cubic bezier stepped by h: the position and its first, second and third differences
+	struct BatchBezierDifferences
+	{
+		float f, df, ddf, dddf;
+	};
+
+	static inline BatchBezierDifferences batch_bezier_differences(float p0, float p1, float p2, float p3, float h)
+	{
+		float a = (p3 - p0) + 3.0f * (p1 - p2);
+		float b = 3.0f * ((p0 + p2) - 2.0f * p1);
+		float c = 3.0f * (p1 - p0);
+		float a6h = 6.0f * a * h;
+		float hh = h * h;
+
+		BatchBezierDifferences d;
+		d.f = p0;
+		d.df = ((a * h + b) * h + c) * h;
+		d.ddf = (a6h + 2.0f * b) * hh;
+		d.dddf = a6h * hh;
+		return d;
+	}
+
+	static void batch_flatten_cubic_bezier(const Pointf *cp, int segments, Pointf *out)
+	{
+		float h = 1.0f / segments;
+		BatchBezierDifferences x = batch_bezier_differences(cp[0].x, cp[1].x, cp[2].x, cp[3].x, h);
+		BatchBezierDifferences y = batch_bezier_differences(cp[0].y, cp[1].y, cp[2].y, cp[3].y, h);
+		for (int i = 1; i < segments; i++)
+		{
+			x.f += x.df;
+			y.f += y.df;
+			out[i - 1] = Pointf(x.f, y.f);
+			x.df += x.ddf;
+			y.df += y.ddf;
+			x.ddf += x.dddf;
+			y.ddf += y.dddf;
+		}
+
+		// The last point is exact, so consecutive curves join without cracks
+		out[segments - 1] = cp[3];
+	}
+
+#ifndef CL_DISABLE_SSE2
+
+	// Same arithmetic as batch_bezier_differences, for one axis of four curves
+	static inline void batch_sse_bezier_differences(__m128 p0, __m128 p1, __m128 p2, __m128 p3, __m128 h, __m128 &f, __m128 &df, __m128 &ddf, __m128 &dddf)
+	{
+		__m128 three = _mm_set1_ps(3.0f);
+		__m128 a = _mm_add_ps(_mm_sub_ps(p3, p0), _mm_mul_ps(three, _mm_sub_ps(p1, p2)));
+		__m128 b = _mm_mul_ps(three, _mm_sub_ps(_mm_add_ps(p0, p2), _mm_mul_ps(_mm_set1_ps(2.0f), p1)));
+		__m128 c = _mm_mul_ps(three, _mm_sub_ps(p1, p0));
+		__m128 a6h = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(6.0f), a), h);
+		__m128 hh = _mm_mul_ps(h, h);
+
+		f = p0;
+		df = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(a, h), b), h), c), h);
+		ddf = _mm_mul_ps(_mm_add_ps(a6h, _mm_mul_ps(_mm_set1_ps(2.0f), b)), hh);
+		dddf = _mm_mul_ps(a6h, hh);
+	}
+
+	// Steps four curves at once. Curves with fewer segments stop storing while the others continue.
+	static void batch_sse_flatten_cubic_beziers(const Pointf *cp, const int *segments, Pointf *const *out)
+	{
+		__m128 h = _mm_setr_ps(1.0f / segments[0], 1.0f / segments[1], 1.0f / segments[2], 1.0f / segments[3]);
+
+		__m128 fx, dfx, ddfx, dddfx, fy, dfy, ddfy, dddfy;
+		batch_sse_bezier_differences(
+			_mm_setr_ps(cp[0].x, cp[4].x, cp[8].x, cp[12].x), _mm_setr_ps(cp[1].x, cp[5].x, cp[9].x, cp[13].x),
+			_mm_setr_ps(cp[2].x, cp[6].x, cp[10].x, cp[14].x), _mm_setr_ps(cp[3].x, cp[7].x, cp[11].x, cp[15].x),
+			h, fx, dfx, ddfx, dddfx);
+		batch_sse_bezier_differences(
+			_mm_setr_ps(cp[0].y, cp[4].y, cp[8].y, cp[12].y), _mm_setr_ps(cp[1].y, cp[5].y, cp[9].y, cp[13].y),
+			_mm_setr_ps(cp[2].y, cp[6].y, cp[10].y, cp[14].y), _mm_setr_ps(cp[3].y, cp[7].y, cp[11].y, cp[15].y),
+			h, fy, dfy, ddfy, dddfy);
+
+		int max_segments = std::max(std::max(segments[0], segments[1]), std::max(segments[2], segments[3]));
+		for (int i = 1; i < max_segments; i++)
+		{
+			fx = _mm_add_ps(fx, dfx);
+			fy = _mm_add_ps(fy, dfy);
+
+			__m128 xy01 = _mm_unpacklo_ps(fx, fy);
+			__m128 xy23 = _mm_unpackhi_ps(fx, fy);
+			if (i < segments[0])
+				_mm_storel_pi(reinterpret_cast<__m64 *>(out[0] + i - 1), xy01);
+			if (i < segments[1])
+				_mm_storeh_pi(reinterpret_cast<__m64 *>(out[1] + i - 1), xy01);
+			if (i < segments[2])
+				_mm_storel_pi(reinterpret_cast<__m64 *>(out[2] + i - 1), xy23);
+			if (i < segments[3])
+				_mm_storeh_pi(reinterpret_cast<__m64 *>(out[3] + i - 1), xy23);
+
+			dfx = _mm_add_ps(dfx, ddfx);
+			dfy = _mm_add_ps(dfy, ddfy);
+			ddfx = _mm_add_ps(ddfx, dddfx);
+			ddfy = _mm_add_ps(ddfy, dddfy);
+		}
+
+		for (int lane = 0; lane < 4; lane++)
+			out[lane][segments[lane] - 1] = cp[lane * 4 + 3];
+	}
+
+#endif
+
+#ifdef CL_BATCH_MATH_NEON
+
+	// Same arithmetic as batch_bezier_differences, for one axis of four curves
+	static inline void batch_neon_bezier_differences(float32x4_t p0, float32x4_t p1, float32x4_t p2, float32x4_t p3, float32x4_t h, float32x4_t &f, float32x4_t &df, float32x4_t &ddf, float32x4_t &dddf)
+	{
+		float32x4_t a = vaddq_f32(vsubq_f32(p3, p0), vmulq_n_f32(vsubq_f32(p1, p2), 3.0f));
+		float32x4_t b = vmulq_n_f32(vsubq_f32(vaddq_f32(p0, p2), vmulq_n_f32(p1, 2.0f)), 3.0f);
+		float32x4_t c = vmulq_n_f32(vsubq_f32(p1, p0), 3.0f);
+		float32x4_t a6h = vmulq_f32(vmulq_n_f32(a, 6.0f), h);
+		float32x4_t hh = vmulq_f32(h, h);
+
+		f = p0;
+		df = vmulq_f32(vaddq_f32(vmulq_f32(vaddq_f32(vmulq_f32(a, h), b), h), c), h);
+		ddf = vmulq_f32(vaddq_f32(a6h, vmulq_n_f32(b, 2.0f)), hh);
+		dddf = vmulq_f32(a6h, hh);
+	}
+
+	static void batch_neon_flatten_cubic_beziers(const Pointf *cp, const int *segments, Pointf *const *out)
+	{
+		float h_lanes[4] = { 1.0f / segments[0], 1.0f / segments[1], 1.0f / segments[2], 1.0f / segments[3] };
+		float lanes[2][4][4];
+		for (int lane = 0; lane < 4; lane++)
+		{
+			for (int point = 0; point < 4; point++)
+			{
+				lanes[0][point][lane] = cp[lane * 4 + point].x;
+				lanes[1][point][lane] = cp[lane * 4 + point].y;
+			}
+		}
+
+		float32x4_t h = vld1q_f32(h_lanes);
+		float32x4_t fx, dfx, ddfx, dddfx, fy, dfy, ddfy, dddfy;
+		batch_neon_bezier_differences(vld1q_f32(lanes[0][0]), vld1q_f32(lanes[0][1]), vld1q_f32(lanes[0][2]), vld1q_f32(lanes[0][3]), h, fx, dfx, ddfx, dddfx);
+		batch_neon_bezier_differences(vld1q_f32(lanes[1][0]), vld1q_f32(lanes[1][1]), vld1q_f32(lanes[1][2]), vld1q_f32(lanes[1][3]), h, fy, dfy, ddfy, dddfy);
+
+		int max_segments = std::max(std::max(segments[0], segments[1]), std::max(segments[2], segments[3]));
+		for (int i = 1; i < max_segments; i++)
+		{
+			fx = vaddq_f32(fx, dfx);
+			fy = vaddq_f32(fy, dfy);
+
+			float32x4x2_t xy = vzipq_f32(fx, fy);
+			if (i < segments[0])
+				vst1_f32(&out[0][i - 1].x, vget_low_f32(xy.val[0]));
+			if (i < segments[1])
+				vst1_f32(&out[1][i - 1].x, vget_high_f32(xy.val[0]));
+			if (i < segments[2])
+				vst1_f32(&out[2][i - 1].x, vget_low_f32(xy.val[1]));
+			if (i < segments[3])
+				vst1_f32(&out[3][i - 1].x, vget_high_f32(xy.val[1]));
+
+			dfx = vaddq_f32(dfx, ddfx);
+			dfy = vaddq_f32(dfy, ddfy);
+			ddfx = vaddq_f32(ddfx, dddfx);
+			ddfy = vaddq_f32(ddfy, dddfy);
+		}
+
+		for (int lane = 0; lane < 4; lane++)
+			out[lane][segments[lane] - 1] = cp[lane * 4 + 3];
+	}
+
+#endif
+
+	int BatchMath::get_cubic_bezier_segments(const Pointf *cp, float tolerance)
+	{
+		// Wang's formula for degree 3: the polyline of n uniform steps stays within 3 * 2 / 8 * max|second difference| / n^2
+		float ddx0 = (cp[0].x + cp[2].x) - 2.0f * cp[1].x;
+		float ddy0 = (cp[0].y + cp[2].y) - 2.0f * cp[1].y;
+		float ddx1 = (cp[1].x + cp[3].x) - 2.0f * cp[2].x;
+		float ddy1 = (cp[1].y + cp[3].y) - 2.0f * cp[2].y;
+		float dd = std::sqrt(std::max(ddx0 * ddx0 + ddy0 * ddy0, ddx1 * ddx1 + ddy1 * ddy1));
+
+		float segments = std::ceil(std::sqrt(0.75f * dd / tolerance));
+		if (!(segments >= 1.0f))
+			return 1;
+		return segments < (float)max_bezier_segments ? (int)segments : max_bezier_segments;
+	}
+
+	void BatchMath::flatten_cubic_beziers(const Pointf *control_points, size_t count, float tolerance, std::vector<Pointf> &out_points, std::vector<int> &out_segment_counts)
+	{
+		size_t first_segment_count = out_segment_counts.size();
+		out_segment_counts.resize(first_segment_count + count);
+		int *segments = out_segment_counts.data() + first_segment_count;
+
+		size_t total_points = 0;
+		for (size_t i = 0; i < count; i++)
+		{
+			segments[i] = get_cubic_bezier_segments(control_points + i * 4, tolerance);
+			total_points += segments[i];
+		}
+
+		size_t first_point = out_points.size();
+		out_points.resize(first_point + total_points);
+		Pointf *out = out_points.data() + first_point;
+
+		size_t i = 0;
+#if !defined CL_DISABLE_SSE2 || defined CL_BATCH_MATH_NEON
+		for (; i + 4 <= count; i += 4)
+		{
+			Pointf *lane_out[4];
+			for (int lane = 0; lane < 4; lane++)
+			{
+				lane_out[lane] = out;
+				out += segments[i + lane];
+			}
+#ifndef CL_DISABLE_SSE2
+			batch_sse_flatten_cubic_beziers(control_points + i * 4, segments + i, lane_out);
+#else
+			batch_neon_flatten_cubic_beziers(control_points + i * 4, segments + i, lane_out);
+#endif
+		}
+#endif
+
+		for (; i < count; i++)
+		{
+			batch_flatten_cubic_bezier(control_points + i * 4, segments[i], out);
+			out += segments[i];
+		}
+	}
+}
@@ -63,6 +63,11 @@ namespace clan
 		return impl->generate_curve_points(split_angle);
 	}
 
+	void BezierCurve::generate_curve_points(float tolerance, std::vector<Pointf> &out_points) const
+	{
+		impl->generate_curve_points(tolerance, out_points);
+	}
+
 	Pointf BezierCurve::get_point_relative(float pos_0_to_1) const
 	{
 		return impl->get_point_relative(pos_0_to_1);
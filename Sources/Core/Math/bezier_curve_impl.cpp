@@ -31,7 +31,8 @@
 #include "bezier_curve_impl.h"
 #include "API/Core/Math/angle.h"
 #include "API/Core/Math/vec3.h"
-#include "API/Core/Math/angle.h"
+#include "API/Core/Math/batch_math.h"
+#include <algorithm>
 
 namespace clan
 {
@@ -43,10 +44,8 @@ namespace clan
 	{
 	}
 
-	std::vector<Pointf> BezierCurve_Impl::subdivide_bezier(float t_start, float t_end) const
+	void BezierCurve_Impl::subdivide_bezier(float t_start, float t_end, std::vector<Pointf> &points) const
 	{
-		std::vector<Pointf> points;
-
 		float t_center = (t_start + t_end) / 2.0f;
 
 		Pointf sp = get_point_relative(t_start);
@@ -58,17 +57,14 @@ namespace clan
 
 		if (sp2cp.angle3(cp2ep).to_radians() > split_angle_rad)
 		{
-			points = subdivide_bezier(t_start, t_center);
-			std::vector<Pointf> subpoints = subdivide_bezier(t_center, t_end);
-			points.insert(points.end(), subpoints.begin(), subpoints.end());
+			subdivide_bezier(t_start, t_center, points);
+			subdivide_bezier(t_center, t_end, points);
 		}
 		else
 		{
 			points.push_back(cp);
 			points.push_back(ep);
 		}
-
-		return points;
 	}
 
 	Pointf BezierCurve_Impl::get_point_relative(float pos) const
@@ -107,13 +103,44 @@ namespace clan
 		split_angle_rad = split_angle.to_radians();
 
 		points.push_back(get_point_relative(0.0));
+		subdivide_bezier(0.0, 0.5, points);
+		subdivide_bezier(0.5, 1.0, points);
+
+		return points;
+	}
+
+	void BezierCurve_Impl::generate_curve_points(float tolerance, std::vector<Pointf> &points) const
+	{
+		std::vector<Pointf>::size_type N = control_points.size();
+		if (N == 0)
+			return;
 
-		std::vector<Pointf> sub_points = subdivide_bezier(0.0, 0.5);
-		points.insert(points.end(), sub_points.begin(), sub_points.end());
+		points.push_back(control_points.front());
+		if (N == 1)
+			return;
 
-		sub_points = subdivide_bezier(0.5, 1.0);
-		points.insert(points.end(), sub_points.begin(), sub_points.end());
+		if (N == 4)
+		{
+			BatchMath::flatten_cubic_beziers(control_points.data(), 1, tolerance, points, segment_counts);
+			segment_counts.clear();
+			return;
+		}
 
-		return points;
+		// Wang's formula: n uniform steps keep a degree d curve within d * (d - 1) / 8 * max|second difference| / n^2 of its polyline
+		float degree = (float)(N - 1);
+		float dd2 = 0.0f;
+		for (std::vector<Pointf>::size_type i = 0; i + 2 < N; i++)
+		{
+			float ddx = (control_points[i].x + control_points[i + 2].x) - 2.0f * control_points[i + 1].x;
+			float ddy = (control_points[i].y + control_points[i + 2].y) - 2.0f * control_points[i + 1].y;
+			dd2 = std::max(dd2, ddx * ddx + ddy * ddy);
+		}
+
+		float steps = std::ceil(std::sqrt(degree * (degree - 1.0f) / 8.0f * std::sqrt(dd2) / tolerance));
+		int segments = (steps >= 1.0f) ? (int)std::min(steps, (float)BatchMath::max_bezier_segments) : 1;
+
+		for (int i = 1; i < segments; i++)
+			points.push_back(get_point_relative(i / (float)segments));
+		points.push_back(control_points.back());
 	}
 }
@@ -42,11 +42,13 @@ namespace clan
 		~BezierCurve_Impl();
 
 		std::vector<Pointf> generate_curve_points(const Angle &split_angle);
-		std::vector<Pointf> subdivide_bezier(float start_pos, float end_pos)  const;
+		void generate_curve_points(float tolerance, std::vector<Pointf> &points) const;
+		void subdivide_bezier(float start_pos, float end_pos, std::vector<Pointf> &points) const;
 		Pointf get_point_relative(float) const;
 
 		std::vector<Pointf> control_points;
 		mutable std::vector<Pointf> P;
+		mutable std::vector<int> segment_counts;
 
 		float split_angle_rad;
 	};
@@ -49,6 +49,11 @@
 #include "big_int_impl.h"
 #include "API/Core/Math/big_int.h"
 #include <cstdlib>
+#include <vector>
+
+#if !defined(__SIZEOF_INT128__) && defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
 
 namespace clan
 {
@@ -1599,6 +1604,201 @@ namespace clan
 		tmp_impl.internal_exch(this);
 	}
 
+	// Montgomery arithmetic works on machine word limbs, independent of the 32 bit digits used elsewhere
+#if defined(__SIZEOF_INT128__)
+	typedef uint64_t BigIntLimb;
+
+	static inline BigIntLimb bigint_limb_muladd(BigIntLimb a, BigIntLimb b, BigIntLimb c, BigIntLimb &carry)
+	{
+		unsigned __int128 w = (unsigned __int128) a * b + c + carry;
+		carry = (BigIntLimb)(w >> 64);
+		return (BigIntLimb)w;
+	}
+#elif defined(_MSC_VER) && defined(_M_X64)
+	typedef uint64_t BigIntLimb;
+
+	static inline BigIntLimb bigint_limb_muladd(BigIntLimb a, BigIntLimb b, BigIntLimb c, BigIntLimb &carry)
+	{
+		BigIntLimb high;
+		BigIntLimb low = _umul128(a, b, &high);
+		low += c;
+		high += (low < c);
+		low += carry;
+		high += (low < carry);
+		carry = high;
+		return low;
+	}
+#else
+	typedef uint32_t BigIntLimb;
+
+	static inline BigIntLimb bigint_limb_muladd(BigIntLimb a, BigIntLimb b, BigIntLimb c, BigIntLimb &carry)
+	{
+		uint64_t w = (uint64_t) a * b + c + carry;
+		carry = (BigIntLimb)(w >> 32);
+		return (BigIntLimb)w;
+	}
+#endif
+
+	static const unsigned int bigint_digits_per_limb = sizeof(BigIntLimb) / sizeof(uint32_t);
+
+	static void bigint_digits_to_limbs(const uint32_t *digits, unsigned int digits_used, BigIntLimb *limbs, unsigned int size)
+	{
+		memset(limbs, 0, size * sizeof(BigIntLimb));
+		for (unsigned int ix = 0; ix < digits_used; ix++)
+			limbs[ix / bigint_digits_per_limb] |= ((BigIntLimb)digits[ix]) << (32 * (ix % bigint_digits_per_limb));
+	}
+
+	// Returns -n^-1 mod limb radix, for odd n
+	static BigIntLimb bigint_limb_negative_inverse(BigIntLimb n)
+	{
+		// Newton iteration; n * n = 1 mod 8 for odd n and every step doubles the correct bits
+		BigIntLimb inverse = n;
+		for (int cnt = 0; cnt < 5; cnt++)
+			inverse *= 2 - n * inverse;
+		return (BigIntLimb)0 - inverse;
+	}
+
+	// Computes out = a * b / R mod n, where R = limb radix ^ size (CIOS method, Koc, Acar and Kaliski)
+	// temp must hold size + 2 limbs. out may be identical to a or b.
+	static void bigint_montgomery_mul(const BigIntLimb *a, const BigIntLimb *b, const BigIntLimb *n, BigIntLimb n_inverse, unsigned int size, BigIntLimb *temp, BigIntLimb *out)
+	{
+		memset(temp, 0, (size + 2) * sizeof(BigIntLimb));
+
+		for (unsigned int ix = 0; ix < size; ix++)
+		{
+			BigIntLimb carry = 0;
+			BigIntLimb digit = b[ix];
+			for (unsigned int jx = 0; jx < size; jx++)
+				temp[jx] = bigint_limb_muladd(a[jx], digit, temp[jx], carry);
+			BigIntLimb sum = temp[size] + carry;
+			temp[size + 1] = (sum < carry);
+			temp[size] = sum;
+
+			// Add a multiple of n that clears the lowest limb, then shift down by one limb
+			BigIntLimb q = temp[0] * n_inverse;
+			carry = 0;
+			bigint_limb_muladd(q, n[0], temp[0], carry);
+			for (unsigned int jx = 1; jx < size; jx++)
+				temp[jx - 1] = bigint_limb_muladd(q, n[jx], temp[jx], carry);
+			sum = temp[size] + carry;
+			temp[size - 1] = sum;
+			temp[size] = temp[size + 1] + (sum < carry);
+		}
+
+		// The result is below 2n, so at most one subtraction is needed
+		BigIntLimb borrow = 0;
+		for (unsigned int jx = 0; jx < size; jx++)
+		{
+			BigIntLimb t = temp[jx];
+			BigIntLimb d = t - n[jx];
+			BigIntLimb next_borrow = (t < n[jx]);
+			next_borrow |= (d < borrow);
+			out[jx] = d - borrow;
+			borrow = next_borrow;
+		}
+		if (borrow > temp[size])
+			memcpy(out, temp, size * sizeof(BigIntLimb));
+	}
+
+	void BigInt_Impl::internal_exptmod_montgomery(const BigInt_Impl *b, const BigInt_Impl *m, BigInt_Impl *c) const
+	{
+		// Sliding window exponentiation in the Montgomery domain. Requires an odd modulus above 1.
+
+		unsigned int size = (m->digits_used + bigint_digits_per_limb - 1) / bigint_digits_per_limb;
+
+		std::vector<BigIntLimb> modulus(size), temp(size + 2), one(size), r2(size), acc(size);
+		bigint_digits_to_limbs(m->digits, m->digits_used, &modulus[0], size);
+		BigIntLimb n_inverse = bigint_limb_negative_inverse(modulus[0]);
+		one[0] = 1;
+
+		// R^2 mod m converts values into the Montgomery domain
+		BigInt_Impl r2_impl;
+		r2_impl.set((uint32_t)1);
+		r2_impl.internal_lshd(2 * size * bigint_digits_per_limb);
+		r2_impl.mod(m, &r2_impl);
+		bigint_digits_to_limbs(r2_impl.digits, r2_impl.digits_used, &r2[0], size);
+
+		BigInt_Impl x(*this);
+		x.mod(m, &x);
+		bigint_digits_to_limbs(x.digits, x.digits_used, &acc[0], size);
+
+		int exponent_bits = b->significant_bits();
+		int window_bits = 1;
+		if (exponent_bits > 671)
+			window_bits = 6;
+		else if (exponent_bits > 239)
+			window_bits = 5;
+		else if (exponent_bits > 79)
+			window_bits = 4;
+		else if (exponent_bits > 23)
+			window_bits = 3;
+
+		// Odd powers x^1, x^3, x^5, ... in the Montgomery domain
+		unsigned int table_size = 1 << (window_bits - 1);
+		std::vector<BigIntLimb> table(table_size * size);
+		bigint_montgomery_mul(&acc[0], &r2[0], &modulus[0], n_inverse, size, &temp[0], &table[0]);
+		if (table_size > 1)
+		{
+			std::vector<BigIntLimb> x2(size);
+			bigint_montgomery_mul(&table[0], &table[0], &modulus[0], n_inverse, size, &temp[0], &x2[0]);
+			for (unsigned int ix = 1; ix < table_size; ix++)
+				bigint_montgomery_mul(&table[(ix - 1) * size], &x2[0], &modulus[0], n_inverse, size, &temp[0], &table[ix * size]);
+		}
+
+		const uint32_t *db = b->digits;
+		auto exponent_bit = [db](int bit) -> unsigned int { return (db[bit / num_bits_in_digit] >> (bit % num_bits_in_digit)) & 1; };
+
+		// acc = 1 in the Montgomery domain (R mod m)
+		bigint_montgomery_mul(&r2[0], &one[0], &modulus[0], n_inverse, size, &temp[0], &acc[0]);
+		bool acc_is_one = true;
+
+		int bit = exponent_bits - 1;
+		while (bit >= 0)
+		{
+			if (!exponent_bit(bit))
+			{
+				if (!acc_is_one)
+					bigint_montgomery_mul(&acc[0], &acc[0], &modulus[0], n_inverse, size, &temp[0], &acc[0]);
+				bit--;
+				continue;
+			}
+
+			// Longest window of at most window_bits bits that ends with a set bit
+			int low = bit - window_bits + 1;
+			if (low < 0)
+				low = 0;
+			while (!exponent_bit(low))
+				low++;
+
+			unsigned int value = 0;
+			for (int ix = bit; ix >= low; ix--)
+			{
+				value = (value << 1) | exponent_bit(ix);
+				if (!acc_is_one)
+					bigint_montgomery_mul(&acc[0], &acc[0], &modulus[0], n_inverse, size, &temp[0], &acc[0]);
+			}
+
+			const BigIntLimb *power = &table[(value >> 1) * size];
+			if (acc_is_one)
+				memcpy(&acc[0], power, size * sizeof(BigIntLimb));
+			else
+				bigint_montgomery_mul(&acc[0], power, &modulus[0], n_inverse, size, &temp[0], &acc[0]);
+			acc_is_one = false;
+			bit = low - 1;
+		}
+
+		// Leave the Montgomery domain
+		bigint_montgomery_mul(&acc[0], &one[0], &modulus[0], n_inverse, size, &temp[0], &acc[0]);
+
+		BigInt_Impl s(size * bigint_digits_per_limb);
+		s.digits_used = size * bigint_digits_per_limb;
+		for (unsigned int ix = 0; ix < s.digits_used; ix++)
+			s.digits[ix] = (uint32_t)(acc[ix / bigint_digits_per_limb] >> (32 * (ix % bigint_digits_per_limb)));
+		s.internal_clamp();
+
+		s.internal_exch(c);
+	}
+
 	void BigInt_Impl::exptmod(const BigInt_Impl *b, const BigInt_Impl *m, BigInt_Impl *c) const
 	{
 		BigInt_Impl s, mu;
@@ -1611,6 +1811,14 @@ namespace clan
 		if (b->cmp_z() < 0 || m->cmp_z() <= 0)
 			throw Exception("Divide by zero");
 
+		// Montgomery reduction needs an odd modulus, which covers RSA and the prime tests.
+		// Even moduli use Barrett reduction below.
+		if (m->isodd() && m->cmp_d(1) > 0)
+		{
+			internal_exptmod_montgomery(b, m, c);
+			return;
+		}
+
 		BigInt_Impl x(*this);
 
 		x.mod(m, &x);
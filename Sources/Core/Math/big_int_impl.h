@@ -166,6 +166,7 @@ namespace clan
 		void internal_mul_2();
 
 		void internal_reduce(const BigInt_Impl *m, BigInt_Impl *mu);
+		void internal_exptmod_montgomery(const BigInt_Impl *b, const BigInt_Impl *m, BigInt_Impl *c) const;
 		void internal_sqr();
 
 		bool digits_negative;	// True if the value is negative
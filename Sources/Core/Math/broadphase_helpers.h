@@ -0,0 +1,130 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include "API/Core/Math/aabb.h"
+#include "API/Core/Math/broadphase_pair.h"
+#include "API/Core/System/work_queue.h"
+#include <algorithm>
+#include <vector>
+
+namespace clan
+{
+	inline bool broadphase_overlap(const AxisAlignedBoundingBox &a, const AxisAlignedBoundingBox &b)
+	{
+		return a.aabb_min.x <= b.aabb_max.x && b.aabb_min.x <= a.aabb_max.x &&
+			a.aabb_min.y <= b.aabb_max.y && b.aabb_min.y <= a.aabb_max.y &&
+			a.aabb_min.z <= b.aabb_max.z && b.aabb_min.z <= a.aabb_max.z;
+	}
+
+	inline bool broadphase_contains(const AxisAlignedBoundingBox &outer, const AxisAlignedBoundingBox &inner)
+	{
+		return outer.aabb_min.x <= inner.aabb_min.x && outer.aabb_min.y <= inner.aabb_min.y && outer.aabb_min.z <= inner.aabb_min.z &&
+			inner.aabb_max.x <= outer.aabb_max.x && inner.aabb_max.y <= outer.aabb_max.y && inner.aabb_max.z <= outer.aabb_max.z;
+	}
+
+	inline AxisAlignedBoundingBox broadphase_union(const AxisAlignedBoundingBox &a, const AxisAlignedBoundingBox &b)
+	{
+		return AxisAlignedBoundingBox(
+			Vec3f(std::min(a.aabb_min.x, b.aabb_min.x), std::min(a.aabb_min.y, b.aabb_min.y), std::min(a.aabb_min.z, b.aabb_min.z)),
+			Vec3f(std::max(a.aabb_max.x, b.aabb_max.x), std::max(a.aabb_max.y, b.aabb_max.y), std::max(a.aabb_max.z, b.aabb_max.z)));
+	}
+
+	inline AxisAlignedBoundingBox broadphase_grow(const AxisAlignedBoundingBox &box, float margin)
+	{
+		return AxisAlignedBoundingBox(box.aabb_min - margin, box.aabb_max + margin);
+	}
+
+	inline float broadphase_area(const AxisAlignedBoundingBox &box)
+	{
+		Vec3f size = box.aabb_max - box.aabb_min;
+		return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+	}
+
+	/// \brief Traversal stack that only allocates for unusually deep trees
+	class BroadphaseStack
+	{
+	public:
+		bool empty() const { return size == 0; }
+
+		void push(int value)
+		{
+			if (size < inline_capacity)
+				inline_items[size] = value;
+			else
+				overflow.push_back(value);
+			size++;
+		}
+
+		int pop()
+		{
+			size--;
+			if (size < inline_capacity)
+				return inline_items[size];
+			int value = overflow.back();
+			overflow.pop_back();
+			return value;
+		}
+
+	private:
+		static const int inline_capacity = 128;
+		int inline_items[inline_capacity];
+		std::vector<int> overflow;
+		int size = 0;
+	};
+
+	/// \brief Splits [0, count) into ranges, calls find(first, last, pairs) for each on the worker threads and appends the results in range order
+	template<typename FindFunc>
+	void broadphase_parallel_pairs(WorkQueue &queue, int count, std::vector<BroadphasePair> &out_pairs, FindFunc find)
+	{
+		if (count <= 0)
+			return;
+
+		// More ranges than threads, so ranges with many overlaps do not hold up the others
+		int grain = std::max(queue.get_grain_size(count) / 4, 1);
+		int num_ranges = (count + grain - 1) / grain;
+		std::vector<std::vector<BroadphasePair>> range_pairs(num_ranges);
+		queue.parallel_for(0, num_ranges, 1, [&](int first_range, int last_range)
+		{
+			for (int range = first_range; range < last_range; range++)
+			{
+				int first = range * grain;
+				find(first, std::min(first + grain, count), range_pairs[range]);
+			}
+		});
+
+		size_t total = out_pairs.size();
+		for (const auto &pairs : range_pairs)
+			total += pairs.size();
+		out_pairs.reserve(total);
+		for (const auto &pairs : range_pairs)
+			out_pairs.insert(out_pairs.end(), pairs.begin(), pairs.end());
+	}
+}
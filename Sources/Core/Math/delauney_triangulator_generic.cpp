@@ -27,6 +27,7 @@
 */
 
 #include "Core/precomp.h"
+#include "API/Core/Math/cl_math.h"
 #include "delauney_triangulator_generic.h"
 #include <algorithm>
 
@@ -47,296 +48,314 @@ namespace clan
 		std::vector<DelauneyTriangulator_Vertex *> vertices;
 		create_ordered_vertex_list(vertices);
 
-		// Calculate super triangle:
-
-		DelauneyTriangulator_Vertex super_A;
-		DelauneyTriangulator_Vertex super_B;
-		DelauneyTriangulator_Vertex super_C;
-		DelauneyTriangulator_Triangle super_triangle;
-		super_triangle.vertex_A = &super_A;
-		super_triangle.vertex_B = &super_B;
-		super_triangle.vertex_C = &super_C;
-		calculate_supertriangle(vertices, super_triangle);
-
 		// Perform delauney triangulation:
 
-		perform_delauney_triangulation(vertices, super_triangle, triangles);
+		perform_delauney_triangulation(vertices, triangles);
 	}
 
-	struct CompareVertices
+	namespace
 	{
-		bool operator()(DelauneyTriangulator_Vertex *a, DelauneyTriangulator_Vertex *b) const
+		// Spreads the lower 16 bits so there is a zero bit between each of them
+		inline unsigned int delauney_spread_bits(unsigned int v)
 		{
-			if (a->x == b->x) return a->y < b->y;
-			return a->x < b->x;
+			v = (v | (v << 8)) & 0x00ff00ff;
+			v = (v | (v << 4)) & 0x0f0f0f0f;
+			v = (v | (v << 2)) & 0x33333333;
+			v = (v | (v << 1)) & 0x55555555;
+			return v;
 		}
-	};
+	}
 
 	void DelauneyTriangulator_Impl::create_ordered_vertex_list(std::vector<DelauneyTriangulator_Vertex *> &vertices)
 	{
 		std::vector<DelauneyTriangulator_Vertex>::size_type index_vertices, num_vertices;
 		num_vertices = input_vertices.size();
-		for (index_vertices = 0; index_vertices < num_vertices; index_vertices++)
-		{
-			vertices.push_back(&input_vertices[index_vertices]);
-		}
-
-		// Sort list:
-		std::sort(vertices.begin(), vertices.end(), CompareVertices());
+		if (num_vertices == 0) return;
 
-		// Remove duplicates:
-		auto it = vertices.begin();
-		if (it == vertices.end()) return;
-		float last_x = (*it)->x;
-		float last_y = (*it)->y;
-		++it;
-		while (it != vertices.end())
+		float min_x = input_vertices[0].x;
+		float max_x = input_vertices[0].x;
+		float min_y = input_vertices[0].y;
+		float max_y = input_vertices[0].y;
+		for (index_vertices = 1; index_vertices < num_vertices; index_vertices++)
 		{
-			if (last_x == (*it)->x && last_y == (*it)->y)
-			{
-				it = vertices.erase(it);
-			}
-			else
-			{
-				last_x = (*it)->x;
-				last_y = (*it)->y;
-				++it;
-			}
+			min_x = min(min_x, input_vertices[index_vertices].x);
+			max_x = max(max_x, input_vertices[index_vertices].x);
+			min_y = min(min_y, input_vertices[index_vertices].y);
+			max_y = max(max_y, input_vertices[index_vertices].y);
 		}
-	}
 
-	void DelauneyTriangulator_Impl::calculate_supertriangle(std::vector<DelauneyTriangulator_Vertex *> &vertices, DelauneyTriangulator_Triangle &super_triangle)
-	{
-		// Find min and max values:
+		// Sort along a z-order curve, so each vertex is inserted next to the previous one and
+		// the point location walk in perform_delauney_triangulation stays short
+		float scale_x = max_x > min_x ? 65535.0f / (max_x - min_x) : 0.0f;
+		float scale_y = max_y > min_y ? 65535.0f / (max_y - min_y) : 0.0f;
 
-		float min_x = 0.0;
-		float max_x = 0.0;
-		float min_y = 0.0;
-		float max_y = 0.0;
-		bool first_point = true;
-
-		std::vector<DelauneyTriangulator_Vertex *>::size_type index_vertices, num_vertices;
-		num_vertices = vertices.size();
+		std::vector<std::pair<unsigned int, DelauneyTriangulator_Vertex *> > keys;
+		keys.reserve(num_vertices);
 		for (index_vertices = 0; index_vertices < num_vertices; index_vertices++)
 		{
-			DelauneyTriangulator_Vertex *cur_vertex = vertices[index_vertices];
-
-			if (!first_point)
-			{
-				if (min_x > cur_vertex->x) min_x = cur_vertex->x;
-				if (max_x < cur_vertex->x) max_x = cur_vertex->x;
-				if (min_y > cur_vertex->y) min_y = cur_vertex->y;
-				if (max_y < cur_vertex->y) max_y = cur_vertex->y;
-			}
-			else
-			{
-				first_point = false;
-				min_x = cur_vertex->x;
-				max_x = cur_vertex->x;
-				min_y = cur_vertex->y;
-				max_y = cur_vertex->y;
-			}
+			DelauneyTriangulator_Vertex *vertex = &input_vertices[index_vertices];
+			unsigned int qx = (unsigned int)((vertex->x - min_x) * scale_x);
+			unsigned int qy = (unsigned int)((vertex->y - min_y) * scale_y);
+			keys.push_back(std::make_pair(delauney_spread_bits(qx) | (delauney_spread_bits(qy) << 1), vertex));
 		}
 
-		// Setup super triangle based on min/max values:
-
-		super_triangle.vertex_A->x = min_x - 1;
-		super_triangle.vertex_A->y = min_y - 1;
-		super_triangle.vertex_A->data = nullptr;
-
-		super_triangle.vertex_B->x = max_x + (max_x - min_x) + 1;
-		super_triangle.vertex_B->y = min_y - 1;
-		super_triangle.vertex_B->data = nullptr;
+		// Sort list, keeping duplicates next to each other:
+		std::sort(keys.begin(), keys.end(), [](const std::pair<unsigned int, DelauneyTriangulator_Vertex *> &a, const std::pair<unsigned int, DelauneyTriangulator_Vertex *> &b)
+		{
+			if (a.first != b.first) return a.first < b.first;
+			if (a.second->x != b.second->x) return a.second->x < b.second->x;
+			return a.second->y < b.second->y;
+		});
 
-		super_triangle.vertex_C->x = min_x - 1;
-		super_triangle.vertex_C->y = max_y + (max_y - min_y) + 1;
-		super_triangle.vertex_C->data = nullptr;
+		// Remove duplicates:
+		vertices.reserve(num_vertices);
+		for (auto &key : keys)
+		{
+			if (vertices.empty() || vertices.back()->x != key.second->x || vertices.back()->y != key.second->y)
+				vertices.push_back(key.second);
+		}
 	}
 
 	void DelauneyTriangulator_Impl::perform_delauney_triangulation(
 		const std::vector<DelauneyTriangulator_Vertex *> &vertices,
-		const DelauneyTriangulator_Triangle &super_triangle,
 		std::vector<DelauneyTriangulator_Triangle> &triangles)
 	{
 		/*
-			delauney triangulation algorithm:
-
-			subroutine triangulate
-			input : vertex list
-			output : triangle list
-			initialize the triangle list
-			determine the supertriangle
-			add supertriangle vertices to the end of the vertex list
-			add the supertriangle to the triangle list
-			for each sample point in the vertex list
-			initialize the edge buffer
-			for each triangle currently in the triangle list
-			calculate the triangle circumcircle center and radius
-			if the point lies in the triangle circumcircle then
-			add the three triangle edges to the edge buffer
-			remove the triangle from the triangle list
-			endif
-			endfor
-			delete all doubly specified edges from the edge buffer
-			this leaves the edges of the enclosing polygon only
-			add to the triangle list all triangles formed between the point
-			and the edges of the enclosing polygon
-			endfor
-			remove any triangles from the triangle list that use the supertriangle vertices
-			remove the supertriangle vertices from the vertex list
-			end
-
-			See http://astronomy.swin.edu.au/~pbourke/terrain/triangulate/ for more info
-			*/
+			Incremental Bowyer-Watson delauney triangulation:
+
+			Start with a super triangle containing all the vertices. For each vertex, walk through the
+			triangle neighbours to the triangle containing it, grow the cavity of triangles whose
+			circumcircle contains the vertex by flooding through the neighbours, and connect the vertex
+			to the edges around the cavity. Finally remove the triangles using super triangle vertices.
+
+			Inserting the vertices in z-order keeps both the walk and the cavity small, giving
+			O(n log n) behaviour in practice instead of testing every triangle for every vertex.
+		*/
 
 		// Reset triangle list.
 		triangles.clear();
 
-		// add supertriangle vertices to the end of the vertex list
-		triangles.push_back(super_triangle);
+		int num_vertices = (int)vertices.size();
+		if (num_vertices < 3)
+			return;
 
-		// for each sample point in the vertex list:
-		std::vector<DelauneyTriangulator_Vertex *>::size_type index_vertices, num_vertices;
-		num_vertices = vertices.size();
-		for (index_vertices = 0; index_vertices < num_vertices; index_vertices++)
+		mesh_x.resize(num_vertices + 3);
+		mesh_y.resize(num_vertices + 3);
+		double min_x = vertices[0]->x, max_x = vertices[0]->x;
+		double min_y = vertices[0]->y, max_y = vertices[0]->y;
+		for (int i = 0; i < num_vertices; i++)
+		{
+			mesh_x[i] = vertices[i]->x;
+			mesh_y[i] = vertices[i]->y;
+			min_x = min(min_x, mesh_x[i]);
+			max_x = max(max_x, mesh_x[i]);
+			min_y = min(min_y, mesh_y[i]);
+			max_y = max(max_y, mesh_y[i]);
+		}
+
+		// Super triangle far enough out that its vertices do not bend the hull triangles
+		double center_x = (min_x + max_x) * 0.5;
+		double center_y = (min_y + max_y) * 0.5;
+		double extent = max(max(max_x - min_x, max_y - min_y), 1.0) * 64.0;
+		mesh_x[num_vertices + 0] = center_x - extent * 2.0;
+		mesh_y[num_vertices + 0] = center_y - extent;
+		mesh_x[num_vertices + 1] = center_x + extent * 2.0;
+		mesh_y[num_vertices + 1] = center_y - extent;
+		mesh_x[num_vertices + 2] = center_x;
+		mesh_y[num_vertices + 2] = center_y + extent * 2.0;
+
+		mesh.clear();
+		free_triangles.clear();
+		visit_mark.clear();
+		mesh.reserve(num_vertices * 2 + 1);
+		visit_mark.reserve(num_vertices * 2 + 1);
+
+		int last_triangle = create_triangle(num_vertices + 0, num_vertices + 1, num_vertices + 2);
+		for (int i = 0; i < 3; i++)
+			mesh[last_triangle].neighbour[i] = -1;
+
+		for (int i = 0; i < num_vertices; i++)
+			insert_vertex(i, last_triangle);
+
+		// Output the triangles not using the supertriangle vertices
+		triangles.reserve(num_vertices * 2);
+		for (auto &cur_triangle : mesh)
 		{
-			DelauneyTriangulator_Vertex *insertion_point = vertices[index_vertices];
+			if (!cur_triangle.alive || cur_triangle.vertex[0] >= num_vertices || cur_triangle.vertex[1] >= num_vertices || cur_triangle.vertex[2] >= num_vertices)
+				continue;
+
+			DelauneyTriangulator_Triangle triangle;
+			triangle.vertex_A = vertices[cur_triangle.vertex[0]];
+			triangle.vertex_B = vertices[cur_triangle.vertex[1]];
+			triangle.vertex_C = vertices[cur_triangle.vertex[2]];
+			triangles.push_back(triangle);
+		}
+	}
+
+	void DelauneyTriangulator_Impl::insert_vertex(int vertex_index, int &last_triangle)
+	{
+		double x = mesh_x[vertex_index];
+		double y = mesh_y[vertex_index];
 
-			// Init edge buffer
-			typedef std::pair<DelauneyTriangulator_Vertex *, DelauneyTriangulator_Vertex *> DelauneyTriangulator_Triangle_Edge;
-			std::vector<DelauneyTriangulator_Triangle_Edge> edges;
+		// Find the cavity, the connected triangles whose circumcircle contains the vertex
+		int start_triangle = locate(x, y, last_triangle);
 
-			// For each triangle currently in the triangle list
-			std::vector<DelauneyTriangulator_Triangle>::size_type index_triangles, num_triangles;
-			num_triangles = triangles.size();
-			for (index_triangles = 0; index_triangles < num_triangles; index_triangles++)
+		if (++visit_counter == 0)
+		{
+			std::fill(visit_mark.begin(), visit_mark.end(), 0);
+			visit_counter = 1;
+		}
+
+		cavity.clear();
+		boundary.clear();
+		cavity.push_back(start_triangle);
+		visit_mark[start_triangle] = visit_counter;
+		for (size_t cavity_index = 0; cavity_index < cavity.size(); cavity_index++)
+		{
+			const MeshTriangle &cur_triangle = mesh[cavity[cavity_index]];
+			for (int i = 0; i < 3; i++)
 			{
-				DelauneyTriangulator_Triangle &cur_triangle = triangles[index_triangles];
-
-				// todo: cache circumcenter in triangle?
-				DelauneyTriangulator_Vertex circumcenter = find_circumcenter(cur_triangle);
-				float radius_x = cur_triangle.vertex_A->x - circumcenter.x;
-				float radius_y = cur_triangle.vertex_A->y - circumcenter.y;
-				float radius2 = radius_x*radius_x + radius_y*radius_y;
-
-				// Check if the point lies in the triangle circumcircle:
-				float dist_x = insertion_point->x - circumcenter.x;
-				float dist_y = insertion_point->y - circumcenter.y;
-				float dist2 = dist_x*dist_x + dist_y*dist_y;
-				if (dist2 < radius2)
+				int neighbour = cur_triangle.neighbour[i];
+				if (neighbour != -1 && visit_mark[neighbour] == visit_counter)
+					continue;	// Also in the cavity
+
+				if (neighbour != -1 && in_circumcircle(mesh[neighbour], x, y))
 				{
-					// Add triangle edges to edge buffer:
-					edges.push_back(DelauneyTriangulator_Triangle_Edge(cur_triangle.vertex_A, cur_triangle.vertex_B));
-					edges.push_back(DelauneyTriangulator_Triangle_Edge(cur_triangle.vertex_B, cur_triangle.vertex_C));
-					edges.push_back(DelauneyTriangulator_Triangle_Edge(cur_triangle.vertex_C, cur_triangle.vertex_A));
-
-					// Remove triange from triangle list:
-					triangles.erase(triangles.begin() + index_triangles);
-					index_triangles--;
-					num_triangles--;
+					visit_mark[neighbour] = visit_counter;
+					cavity.push_back(neighbour);
+				}
+				else
+				{
+					BoundaryEdge edge;
+					edge.start = cur_triangle.vertex[(i + 1) % 3];
+					edge.end = cur_triangle.vertex[(i + 2) % 3];
+					edge.outside = neighbour;
+					boundary.push_back(edge);
 				}
 			}
+		}
+
+		for (int index : cavity)
+		{
+			mesh[index].alive = false;
+			free_triangles.push_back(index);
+		}
 
-			// Delete all doubly specified edges from the edge buffer
-			// this leaves the edges of the enclosing polygon only
-			int index_edges1, index_edges2, num_edges; // intentionally integer to allow index to be negative when deleting index.
-			num_edges = (int)edges.size();
-			for (index_edges1 = 0; index_edges1 < num_edges; index_edges1++)
+		// Connect the vertex to each cavity edge
+		new_triangles.clear();
+		for (auto &edge : boundary)
+		{
+			int index = create_triangle(edge.start, edge.end, vertex_index);
+			MeshTriangle &triangle = mesh[index];
+			triangle.neighbour[2] = edge.outside;
+			if (edge.outside != -1)
 			{
-				DelauneyTriangulator_Triangle_Edge &edge1 = edges[index_edges1];
-				for (index_edges2 = 0/*index_edges1+1*/; index_edges2 < num_edges; index_edges2++)
+				MeshTriangle &outside = mesh[edge.outside];
+				for (int i = 0; i < 3; i++)
 				{
-					if (index_edges1 == index_edges2) continue;
-					DelauneyTriangulator_Triangle_Edge &edge2 = edges[index_edges2];
-					if ((edge1.first == edge2.first && edge1.second == edge2.second) ||
-						(edge1.second == edge2.first && edge1.first == edge2.second))
-					{
-						// Same edges, delete both:
-						if (index_edges1 < index_edges2)
-						{
-							edges.erase(edges.begin() + index_edges2);
-							edges.erase(edges.begin() + index_edges1);
-						}
-						else
-						{
-							edges.erase(edges.begin() + index_edges1);
-							edges.erase(edges.begin() + index_edges2);
-						}
-						num_edges -= 2;
-						index_edges1--;
-						break;
-					}
+					if (outside.vertex[i] != edge.start && outside.vertex[i] != edge.end)
+						outside.neighbour[i] = index;
 				}
 			}
+			new_triangles.push_back(index);
+		}
 
-			// add to the triangle list all triangles formed between the point 
-			// and the edges of the enclosing polygon
-			for (index_edges1 = 0; index_edges1 < num_edges; index_edges1++)
+		// The new triangles form a fan around the vertex; link each to the ones sharing its spokes
+		for (int index : new_triangles)
+		{
+			MeshTriangle &triangle = mesh[index];
+			for (int other : new_triangles)
 			{
-				DelauneyTriangulator_Triangle triangle;
-				triangle.vertex_A = edges[index_edges1].first;
-				triangle.vertex_B = edges[index_edges1].second;
-				triangle.vertex_C = insertion_point;
-				triangles.push_back(triangle);
+				if (mesh[other].vertex[0] == triangle.vertex[1])
+					triangle.neighbour[0] = other;
+				if (mesh[other].vertex[1] == triangle.vertex[0])
+					triangle.neighbour[1] = other;
 			}
 		}
 
-		// remove any triangles from the triangle list that use the supertriangle vertices
-		std::vector<DelauneyTriangulator_Triangle>::size_type index_triangles, num_triangles;
-		num_triangles = triangles.size();
-		for (index_triangles = 0; index_triangles < num_triangles; index_triangles++)
+		last_triangle = new_triangles.back();
+	}
+
+	int DelauneyTriangulator_Impl::locate(double x, double y, int start_triangle) const
+	{
+		int current = start_triangle;
+		int rotation = 0;
+		for (size_t steps = 0; steps < mesh.size(); steps++)
 		{
-			DelauneyTriangulator_Triangle &cur_triangle = triangles[index_triangles];
-
-			if (
-				cur_triangle.vertex_A == super_triangle.vertex_A ||
-				cur_triangle.vertex_A == super_triangle.vertex_B ||
-				cur_triangle.vertex_A == super_triangle.vertex_C ||
-				cur_triangle.vertex_B == super_triangle.vertex_A ||
-				cur_triangle.vertex_B == super_triangle.vertex_B ||
-				cur_triangle.vertex_B == super_triangle.vertex_C ||
-				cur_triangle.vertex_C == super_triangle.vertex_A ||
-				cur_triangle.vertex_C == super_triangle.vertex_B ||
-				cur_triangle.vertex_C == super_triangle.vertex_C)
+			const MeshTriangle &triangle = mesh[current];
+
+			// Rotating the first edge tested prevents walking in circles on degenerate input
+			int next = -1;
+			for (int j = 0; j < 3; j++)
 			{
-				// triangle share one or more points with supertriangle, remove it:
-				triangles.erase(triangles.begin() + index_triangles);
-				index_triangles--;
-				num_triangles--;
+				int i = (j + rotation) % 3;
+				if (triangle.neighbour[i] != -1 && orient(triangle.vertex[(i + 1) % 3], triangle.vertex[(i + 2) % 3], x, y) < 0.0)
+				{
+					next = triangle.neighbour[i];
+					break;
+				}
 			}
+			if (next == -1)
+				return current;
+
+			current = next;
+			rotation = (rotation + 1) % 3;
 		}
+
+		// Walk did not converge, fall back to a full search
+		for (size_t i = 0; i < mesh.size(); i++)
+		{
+			if (mesh[i].alive && in_circumcircle(mesh[i], x, y))
+				return (int)i;
+		}
+		return current;
+	}
+
+	double DelauneyTriangulator_Impl::orient(int a, int b, double x, double y) const
+	{
+		return (mesh_x[b] - mesh_x[a]) * (y - mesh_y[a]) - (mesh_y[b] - mesh_y[a]) * (x - mesh_x[a]);
 	}
 
-	DelauneyTriangulator_Vertex DelauneyTriangulator_Impl::find_circumcenter(
-		const DelauneyTriangulator_Triangle &triangle)
+	bool DelauneyTriangulator_Impl::in_circumcircle(const MeshTriangle &triangle, double x, double y) const
 	{
-		// Subject 1.04: How do I generate a circle through three points?
-		// http://www.faqs.org/faqs/graphics/algorithms-faq/
-
-		float a_0 = triangle.vertex_A->x;
-		float a_1 = triangle.vertex_A->y;
-		float b_0 = triangle.vertex_B->x;
-		float b_1 = triangle.vertex_B->y;
-		float c_0 = triangle.vertex_C->x;
-		float c_1 = triangle.vertex_C->y;
-
-		float A = b_0 - a_0;
-		float B = b_1 - a_1;
-		float C = c_0 - a_0;
-		float D = c_1 - a_1;
-
-		float E = A*(a_0 + b_0) + B*(a_1 + b_1);
-		float F = C*(a_0 + c_0) + D*(a_1 + c_1);
-
-		float G = 2.0f*(A*(c_1 - b_1) - B*(c_0 - b_0));
-
-		float p_0 = (D*E - B*F) / G;
-		float p_1 = (A*F - C*E) / G;
-
-		DelauneyTriangulator_Vertex circumcenter;
-		circumcenter.data = nullptr;
-		circumcenter.x = p_0;
-		circumcenter.y = p_1;
-		return circumcenter;
+		double ax = mesh_x[triangle.vertex[0]] - x;
+		double ay = mesh_y[triangle.vertex[0]] - y;
+		double bx = mesh_x[triangle.vertex[1]] - x;
+		double by = mesh_y[triangle.vertex[1]] - y;
+		double cx = mesh_x[triangle.vertex[2]] - x;
+		double cy = mesh_y[triangle.vertex[2]] - y;
+
+		double a2 = ax * ax + ay * ay;
+		double b2 = bx * bx + by * by;
+		double c2 = cx * cx + cy * cy;
+
+		// Positive for a point inside the circumcircle of a counter clockwise triangle
+		return ax * (by * c2 - b2 * cy) - ay * (bx * c2 - b2 * cx) + a2 * (bx * cy - by * cx) > 0.0;
+	}
+
+	int DelauneyTriangulator_Impl::create_triangle(int a, int b, int c)
+	{
+		int index;
+		if (!free_triangles.empty())
+		{
+			index = free_triangles.back();
+			free_triangles.pop_back();
+		}
+		else
+		{
+			index = (int)mesh.size();
+			mesh.push_back(MeshTriangle());
+			visit_mark.push_back(0);
+		}
+
+		MeshTriangle &triangle = mesh[index];
+		triangle.vertex[0] = a;
+		triangle.vertex[1] = b;
+		triangle.vertex[2] = c;
+		triangle.neighbour[0] = -1;
+		triangle.neighbour[1] = -1;
+		triangle.neighbour[2] = -1;
+		triangle.alive = true;
+		return index;
 	}
 }
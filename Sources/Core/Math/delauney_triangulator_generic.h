@@ -46,16 +46,41 @@ namespace clan
 		void create_ordered_vertex_list(
 			std::vector<DelauneyTriangulator_Vertex *> &vertices);
 
-		void calculate_supertriangle(
-			std::vector<DelauneyTriangulator_Vertex *> &vertices,
-			DelauneyTriangulator_Triangle &super_triangle);
-
 		void perform_delauney_triangulation(
 			const std::vector<DelauneyTriangulator_Vertex *> &vertices,
-			const DelauneyTriangulator_Triangle &super_triangle,
 			std::vector<DelauneyTriangulator_Triangle> &triangles);
 
-		DelauneyTriangulator_Vertex find_circumcenter(
-			const DelauneyTriangulator_Triangle &triangle);
+	private:
+		/// \brief Triangle in the working mesh.
+		///
+		/// Vertices are counter clockwise. neighbour[i] is the triangle across the edge opposite vertex[i], or -1.
+		struct MeshTriangle
+		{
+			int vertex[3];
+			int neighbour[3];
+			bool alive;
+		};
+
+		struct BoundaryEdge
+		{
+			int start, end;
+			int outside;
+		};
+
+		int locate(double x, double y, int start_triangle) const;
+		bool in_circumcircle(const MeshTriangle &triangle, double x, double y) const;
+		double orient(int a, int b, double x, double y) const;
+		int create_triangle(int a, int b, int c);
+		void insert_vertex(int vertex_index, int &last_triangle);
+
+		// Working state, kept between calls so repeated triangulations reuse the allocations
+		std::vector<double> mesh_x, mesh_y;
+		std::vector<MeshTriangle> mesh;
+		std::vector<int> free_triangles;
+		std::vector<int> cavity;
+		std::vector<BoundaryEdge> boundary;
+		std::vector<int> new_triangles;
+		std::vector<unsigned int> visit_mark;
+		unsigned int visit_counter = 0;
 	};
 }
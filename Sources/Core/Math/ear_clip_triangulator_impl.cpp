@@ -32,28 +32,21 @@
 #include "API/Core/Math/point.h"
 #include "API/Core/Math/triangle_math.h"
 #include "API/Core/Math/line_math.h"
+#include "API/Core/Math/cl_math.h"
 #include "ear_clip_triangulator_impl.h"
 #include <cfloat>
+#include <algorithm>
 
 namespace clan
 {
 	EarClipTriangulator_Impl::EarClipTriangulator_Impl()
-		: orientation(cl_clockwise), vertex_count(0)
+		: orientation(cl_clockwise), vertice_block_used(vertice_block_size), z_min_x(0.0f), z_min_y(0.0f), z_scale(0.0f), vertex_count(0)
 	{
 		target_array = &vertices;
 	}
 
 	EarClipTriangulator_Impl::~EarClipTriangulator_Impl()
 	{
-		for (auto & elem : vertices)
-		{
-			delete elem;
-		}
-
-		for (auto & elem : hole)
-		{
-			delete elem;
-		}
 	}
 
 	std::vector<Pointf> EarClipTriangulator_Impl::get_vertices()
@@ -85,23 +78,38 @@ namespace clan
 				return;	// Ignore this vertice
 			}
 		}
-		target_array->push_back(new LinkedVertice(x, y));
+		target_array->push_back(allocate_vertice(x, y));
 		vertex_count++;
 	}
 
 	void EarClipTriangulator_Impl::clear()
 	{
-		for (auto & elem : vertices)
-		{
-			delete elem;
-		}
-
 		vertices.clear();
 		hole.clear();
 		ear_list.clear();
+		vertice_blocks.clear();
+		vertice_block_used = vertice_block_size;
 		vertex_count = 0;
 	}
 
+	LinkedVertice *EarClipTriangulator_Impl::allocate_vertice()
+	{
+		if (vertice_block_used == vertice_block_size)
+		{
+			vertice_blocks.push_back(std::unique_ptr<LinkedVertice[]>(new LinkedVertice[vertice_block_size]));
+			vertice_block_used = 0;
+		}
+		return &vertice_blocks.back()[vertice_block_used++];
+	}
+
+	LinkedVertice *EarClipTriangulator_Impl::allocate_vertice(float x, float y)
+	{
+		LinkedVertice *v = allocate_vertice();
+		v->x = x;
+		v->y = y;
+		return v;
+	}
+
 	EarClipResult EarClipTriangulator_Impl::triangulate()
 	{
 		create_lists(true);
@@ -111,13 +119,19 @@ namespace clan
 
 		EarClipResult result(num_triangles);
 
+		// Ears are clipped in the order they were found. Clipping the newest ear first builds a fan of
+		// ever larger triangles around one vertex, which makes each is_ear test scan more vertices.
+		size_t ear_list_pos = 0;
 		while (tri_count < num_triangles)
 		{
-			if (ear_list.empty()) // something went wrong, but lets not crash anyway. 
+			if (ear_list_pos == ear_list.size()) // something went wrong, but lets not crash anyway. 
 				break;
 
-			LinkedVertice *v = ear_list.back();
-			ear_list.pop_back();
+			LinkedVertice *v = ear_list[ear_list_pos++];
+
+			// Vertices that stopped being ears are left in the list, rather than searched for and erased
+			if (v->is_clipped || !v->is_ear)
+				continue;
 
 			EarClipTriangulator_Triangle tri;
 
@@ -135,76 +149,43 @@ namespace clan
 			v->next->previous = v->previous;
 			v->previous->next = v->next;
 
-			if (is_ear(*v->next))
-			{
-				if (v->next->is_ear == false) // not marked as an ear yet. Mark it, and add to the list.
-				{
-					v->next->is_ear = true;
-					ear_list.push_back(v->next);
-				}
-			}
-			else
-			{
-				if (v->next->is_ear == true) // Not an ear any more. Delete from ear list.
-				{
-					v->next->is_ear = false;
-
-					std::vector<LinkedVertice*>::iterator it;
-					for (it = ear_list.begin(); it != ear_list.end(); ++it)
-					{
-						if ((*it) == v->next)
-						{
-							ear_list.erase(it);
-							break;
-						}
-					}
-				}
-			}
-
-			if (is_ear(*v->previous))
-			{
-				if (v->previous->is_ear == false) // not marked as an ear yet. Mark it, and add to the list.
-				{
-					v->previous->is_ear = true;
-					ear_list.push_back(v->previous);
-				}
-			}
-			else
-			{
-				if (v->previous->is_ear == true) // Not an ear any more. Delete from ear list.
-				{
-					v->previous->is_ear = false;
-
-					std::vector<LinkedVertice*>::iterator it;
-					for (it = ear_list.begin(); it != ear_list.end(); ++it)
-					{
-						if ((*it) == v->previous)
-						{
-							ear_list.erase(it);
-							break;
-						}
-					}
-				}
-			}
+			if (v->previous_z)
+				v->previous_z->next_z = v->next_z;
+			if (v->next_z)
+				v->next_z->previous_z = v->previous_z;
+			v->is_clipped = true;
 
-			/*		cl_write_console_line("Ear list:");
-					for( std::vector<LinkedVertice*>::iterator it = ear_list.begin(); it != ear_list.end(); ++it )
-					{
-					cl_write_console_line("    (%1,%2)", (*it)->x, (*it)->y );
-					}
-					cl_write_console_line("");
-					*/
+			update_ear(v->next);
+			update_ear(v->previous);
 
 			tri_count++;
 
 		}
 
+		ear_list.clear();
+
 		// cl_write_console_line("num triangles - final: %1", tri_count ); 
 
 		return result;
 	}
 
 
+	void EarClipTriangulator_Impl::update_ear(LinkedVertice *v)
+	{
+		if (is_ear(*v))
+		{
+			if (v->is_ear == false) // not marked as an ear yet. Mark it, and add to the list.
+			{
+				v->is_ear = true;
+				ear_list.push_back(v);
+			}
+		}
+		else
+		{
+			v->is_ear = false; // Not an ear any more. Skipped when it comes up in the ear list.
+		}
+	}
+
 	void EarClipTriangulator_Impl::begin_hole()
 	{
 		target_array = &hole;
@@ -258,10 +239,10 @@ namespace clan
 			}
 		}
 
-		auto outer_bridge_start = new LinkedVertice();
-		auto outer_bridge_end = new LinkedVertice();
-		auto inner_bridge_start = new LinkedVertice();
-		auto inner_bridge_end = new LinkedVertice();
+		auto outer_bridge_start = allocate_vertice();
+		auto outer_bridge_end = allocate_vertice();
+		auto inner_bridge_start = allocate_vertice();
+		auto inner_bridge_end = allocate_vertice();
 
 		//  offset new points along old edges
 		Pointf outer_point(outer_vertice->x, outer_vertice->y);
@@ -285,19 +266,16 @@ namespace clan
 		inner_bridge_start->next = segment_end;
 		segment_start->next = inner_bridge_end;
 
-		delete outer_vertice;
 		outer_vertice = nullptr;
 
 		if (inner_point_rel == 0.0) // if split point is at line end, remove inner vertex
 		{
 			segment_start->previous->next = inner_bridge_end;
-			delete segment_start;
 			segment_start = nullptr;
 		}
 		if (inner_point_rel == 1.0) // if split point is at line end, remove inner vertex
 		{
 			inner_bridge_start->next = segment_end->next;
-			delete segment_end;
 			segment_end = nullptr;
 		}
 
@@ -360,6 +338,9 @@ namespace clan
 				v->next = vertices.front();
 			else
 				v->next = vertices[i + 1];
+
+			v->is_ear = false;
+			v->is_clipped = false;
 		}
 
 		unsigned int hole_size = hole.size();
@@ -379,6 +360,8 @@ namespace clan
 
 		if (create_ear_list)
 		{
+			create_z_order_list();
+
 			//		cl_write_console_line("Ear list:");
 
 			for (auto & elem : vertices)
@@ -395,26 +378,85 @@ namespace clan
 		}
 	}
 
+	void EarClipTriangulator_Impl::create_z_order_list()
+	{
+		if (vertices.empty())
+			return;
+
+		float min_x = vertices[0]->x, max_x = vertices[0]->x;
+		float min_y = vertices[0]->y, max_y = vertices[0]->y;
+		for (auto & elem : vertices)
+		{
+			min_x = min(min_x, elem->x);
+			max_x = max(max_x, elem->x);
+			min_y = min(min_y, elem->y);
+			max_y = max(max_y, elem->y);
+		}
+
+		float size = max(max_x - min_x, max_y - min_y);
+		z_min_x = min_x;
+		z_min_y = min_y;
+		z_scale = size > 0.0f ? 65535.0f / size : 0.0f;
+
+		std::vector<LinkedVertice *> sorted = vertices;
+		for (auto & elem : sorted)
+			elem->z = calc_z_order(elem->x, elem->y);
+		std::sort(sorted.begin(), sorted.end(), [](const LinkedVertice *a, const LinkedVertice *b) { return a->z < b->z; });
+
+		for (size_t i = 0; i < sorted.size(); i++)
+		{
+			sorted[i]->previous_z = i > 0 ? sorted[i - 1] : nullptr;
+			sorted[i]->next_z = i + 1 < sorted.size() ? sorted[i + 1] : nullptr;
+		}
+	}
+
+	unsigned int EarClipTriangulator_Impl::calc_z_order(float x, float y) const
+	{
+		unsigned int qx = (unsigned int)clamp((x - z_min_x) * z_scale, 0.0f, 65535.0f);
+		unsigned int qy = (unsigned int)clamp((y - z_min_y) * z_scale, 0.0f, 65535.0f);
+
+		qx = (qx | (qx << 8)) & 0x00ff00ff;
+		qx = (qx | (qx << 4)) & 0x0f0f0f0f;
+		qx = (qx | (qx << 2)) & 0x33333333;
+		qx = (qx | (qx << 1)) & 0x55555555;
+
+		qy = (qy | (qy << 8)) & 0x00ff00ff;
+		qy = (qy | (qy << 4)) & 0x0f0f0f0f;
+		qy = (qy | (qy << 2)) & 0x33333333;
+		qy = (qy | (qy << 1)) & 0x55555555;
+
+		return qx | (qy << 1);
+	}
+
 	bool EarClipTriangulator_Impl::is_ear(const LinkedVertice &v)
 	{
 		if (is_reflex(v)) return false;
 
 		Trianglef triangle(Pointf(v.x, v.y), Pointf(v.next->x, v.next->y), Pointf(v.previous->x, v.previous->y));
 
-		LinkedVertice *v_check = v.next->next;
+		float min_x = min(v.x, min(v.next->x, v.previous->x));
+		float min_y = min(v.y, min(v.next->y, v.previous->y));
+		float max_x = max(v.x, max(v.next->x, v.previous->x));
+		float max_y = max(v.y, max(v.next->y, v.previous->y));
+
+		// Only the remaining vertices within the z-order range of the triangle bounds can be inside it
+		unsigned int min_z = calc_z_order(min_x, min_y);
+		unsigned int max_z = calc_z_order(max_x, max_y);
 
-		while (v_check != v.previous)
+		for (int direction = 0; direction < 2; direction++)
 		{
-			if (v_check == v.next || v_check == v.previous)
+			LinkedVertice *v_check = direction == 0 ? v.previous_z : v.next_z;
+			while (v_check && v_check->z >= min_z && v_check->z <= max_z)
 			{
-				v_check = v_check->next;
-				continue;
-			}
-
-			if (triangle.point_inside(Pointf(v_check->x, v_check->y)))
-				return false;
+				if (v_check != v.next && v_check != v.previous &&
+					v_check->x >= min_x && v_check->x <= max_x && v_check->y >= min_y && v_check->y <= max_y &&
+					triangle.point_inside(Pointf(v_check->x, v_check->y)))
+				{
+					return false;
+				}
 
-			v_check = v_check->next;
+				v_check = direction == 0 ? v_check->previous_z : v_check->next_z;
+			}
 		}
 
 		return true;
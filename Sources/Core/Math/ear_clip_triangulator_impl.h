@@ -29,26 +29,31 @@
 #pragma once
 
 #include <vector>
+#include <memory>
 
 namespace clan
 {
 	class LinkedVertice
 	{
 	public:
-		LinkedVertice() : x(0), y(0), is_ear(0), previous(nullptr), next(nullptr)
+		LinkedVertice() : x(0), y(0), is_ear(0), is_clipped(0), z(0), previous(nullptr), next(nullptr), previous_z(nullptr), next_z(nullptr)
 		{
 			return;
 		}
 
-		LinkedVertice(float x, float y) : x(x), y(y), is_ear(0), previous(nullptr), next(nullptr)
+		LinkedVertice(float x, float y) : x(x), y(y), is_ear(0), is_clipped(0), z(0), previous(nullptr), next(nullptr), previous_z(nullptr), next_z(nullptr)
 		{
 			return;
 		}
 
 		float x, y;
 		bool is_ear;
+		bool is_clipped;
+		unsigned int z;	// Position on the z-order curve
 		LinkedVertice *previous;
 		LinkedVertice *next;
+		LinkedVertice *previous_z;	// Remaining vertices sorted by z
+		LinkedVertice *next_z;
 	};
 
 	class EarClipTriangulator_Impl
@@ -78,6 +83,12 @@ namespace clan
 		bool is_reflex(const LinkedVertice &v);
 		bool is_ear(const LinkedVertice &v);
 		void create_lists(bool create_ear_list);
+		void create_z_order_list();
+		void update_ear(LinkedVertice *v);
+		unsigned int calc_z_order(float x, float y) const;
+
+		LinkedVertice *allocate_vertice();
+		LinkedVertice *allocate_vertice(float x, float y);
 
 		void set_bridge_vertice_offset(
 			LinkedVertice *target,
@@ -93,6 +104,13 @@ namespace clan
 
 		std::vector<LinkedVertice *> ear_list;
 
+		// Vertices are allocated from blocks, which are only freed by clear() and the destructor
+		enum { vertice_block_size = 1024 };
+		std::vector<std::unique_ptr<LinkedVertice[]> > vertice_blocks;
+		int vertice_block_used;
+
+		float z_min_x, z_min_y, z_scale;
+
 		int vertex_count;
 	};
 }
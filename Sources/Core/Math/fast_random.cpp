@@ -0,0 +1,173 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Core/precomp.h"
+#include "API/Core/Math/fast_random.h"
+#include "API/Core/Crypto/random.h"
+
+#if !defined __ANDROID__ && !defined CL_DISABLE_SSE2 && (defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64))
+#include <emmintrin.h>
+#define CL_FAST_RANDOM_SSE2
+#endif
+
+namespace clan
+{
+	FastRandom::FastRandom()
+	{
+		Random random;
+		random.get_random_bytes(reinterpret_cast<unsigned char*>(state), sizeof(state));
+		if ((state[0] | state[1] | state[2] | state[3]) == 0)
+			set_seed(0);
+	}
+
+	void FastRandom::jump()
+	{
+		static const uint64_t jump_table[4] = { 0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+
+		uint64_t s[4] = { 0, 0, 0, 0 };
+		for (auto jump_bits : jump_table)
+		{
+			for (int b = 0; b < 64; b++)
+			{
+				if (jump_bits & (1ULL << b))
+				{
+					for (int i = 0; i < 4; i++)
+						s[i] ^= state[i];
+				}
+				next_uint64();
+			}
+		}
+		for (int i = 0; i < 4; i++)
+			state[i] = s[i];
+	}
+
+#ifdef CL_FAST_RANDOM_SSE2
+	static inline __m128i fast_random_rotl(__m128i x, int k)
+	{
+		return _mm_or_si128(_mm_slli_epi64(x, k), _mm_srli_epi64(x, 64 - k));
+	}
+#endif
+
+	void FastRandom::fill(void *dest, size_t num_bytes)
+	{
+		unsigned char *d = static_cast<unsigned char*>(dest);
+
+#ifdef CL_FAST_RANDOM_SSE2
+		// Setting up the streams costs three jumps, which only pays off for larger buffers
+		if (num_bytes >= 1024)
+		{
+			// Stream n continues where stream n of the previous fill stopped, so fills never repeat output
+			FastRandom lanes[4] = { *this, *this, *this, *this };
+			for (int i = 1; i < 4; i++)
+			{
+				lanes[i] = lanes[i - 1];
+				lanes[i].jump();
+			}
+
+			__m128i s_lo[4], s_hi[4];	// Streams 0-1 and 2-3 of each state word
+			for (int i = 0; i < 4; i++)
+			{
+				s_lo[i] = _mm_set_epi64x((long long)lanes[1].state[i], (long long)lanes[0].state[i]);
+				s_hi[i] = _mm_set_epi64x((long long)lanes[3].state[i], (long long)lanes[2].state[i]);
+			}
+
+			size_t blocks = num_bytes / 32;
+			for (size_t block = 0; block < blocks; block++)
+			{
+				__m128i *s = s_lo;
+				for (int half = 0; half < 2; half++, s = s_hi)
+				{
+					__m128i result = _mm_add_epi64(fast_random_rotl(_mm_add_epi64(s[0], s[3]), 23), s[0]);
+					__m128i t = _mm_slli_epi64(s[1], 17);
+					s[2] = _mm_xor_si128(s[2], s[0]);
+					s[3] = _mm_xor_si128(s[3], s[1]);
+					s[1] = _mm_xor_si128(s[1], s[2]);
+					s[0] = _mm_xor_si128(s[0], s[3]);
+					s[2] = _mm_xor_si128(s[2], t);
+					s[3] = fast_random_rotl(s[3], 45);
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(d + half * 16), result);
+				}
+				d += 32;
+			}
+
+			// Stream 0 is the generator itself
+			for (int i = 0; i < 4; i++)
+			{
+				uint64_t lanes_lo[2];
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(lanes_lo), s_lo[i]);
+				state[i] = lanes_lo[0];
+			}
+			num_bytes -= blocks * 32;
+		}
+#endif
+
+		while (num_bytes >= 8)
+		{
+			uint64_t value = next_uint64();
+			memcpy(d, &value, 8);
+			d += 8;
+			num_bytes -= 8;
+		}
+		if (num_bytes > 0)
+		{
+			uint64_t value = next_uint64();
+			memcpy(d, &value, num_bytes);
+		}
+	}
+
+	void FastRandom::fill(float *dest, size_t count)
+	{
+		fill(dest, count, 0.0f, 1.0f);
+	}
+
+	void FastRandom::fill(float *dest, size_t count, float min_value, float max_value)
+	{
+		// Generate 32 random bits per float, then convert the top 24 bits in place
+		fill(static_cast<void*>(dest), count * sizeof(float));
+
+		float scale = (max_value - min_value) * (1.0f / 16777216.0f);
+		size_t i = 0;
+
+#ifdef CL_FAST_RANDOM_SSE2
+		__m128 scale4 = _mm_set1_ps(scale);
+		__m128 min4 = _mm_set1_ps(min_value);
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128i value = _mm_srli_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(dest + i)), 8);
+			_mm_storeu_ps(dest + i, _mm_add_ps(min4, _mm_mul_ps(_mm_cvtepi32_ps(value), scale4)));
+		}
+#endif
+
+		for (; i < count; i++)
+		{
+			uint32_t value;
+			memcpy(&value, dest + i, sizeof(uint32_t));
+			dest[i] = min_value + (float)(value >> 8) * scale;
+		}
+	}
+}
@@ -28,6 +28,24 @@
 
 #include "Core/precomp.h"
 #include "API/Core/Math/half_float.h"
+#include "API/Core/System/system.h"
+#include <cstring>
+
+#if !defined CL_DISABLE_SSE2 && !defined __ANDROID__
+#include <immintrin.h>
+#define CL_HALF_FLOAT_F16C
+#if defined(__GNUC__)
+// The F16C kernels are compiled for F16C only, and selected at runtime
+#define CL_TARGET_F16C __attribute__((target("avx,f16c")))
+#else
+#define CL_TARGET_F16C
+#endif
+#endif
+
+#if defined CL_DISABLE_SSE2 && (defined __ARM_NEON || defined __ARM_NEON__) && defined __ARM_FP && (__ARM_FP & 2)
+#include <arm_neon.h>
+#define CL_HALF_FLOAT_NEON
+#endif
 
 namespace clan
 {
@@ -2186,37 +2204,37 @@ namespace clan
 		1024,
 		1024,
 		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
-		0,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
+		1024,
 	};
 
 	unsigned short HalfFloat::base_table[512] =
@@ -3251,6 +3269,94 @@ namespace clan
 		13,
 	};
 
+	// Round to nearest even version of float_to_half, used for the elements the vector kernels leave over
+	static unsigned short half_float_round_nearest(float float_value)
+	{
+		unsigned int f;
+		memcpy(&f, &float_value, sizeof(float));
+		unsigned int sign = f & 0x80000000;
+		f ^= sign;
+
+		unsigned short h;
+		if (f >= 0x47800000) // Inf or NaN, or too large for a half
+		{
+			h = (f > 0x7f800000) ? 0x7e00 : 0x7c00;
+		}
+		else if (f < 0x38800000) // Denormal or zero. Adding 0.5 lets the FPU do the rounding shift
+		{
+			const unsigned int denormal_magic_bits = ((127 - 15) + (23 - 10) + 1) << 23;
+			float denormal_magic, value;
+			memcpy(&denormal_magic, &denormal_magic_bits, sizeof(float));
+			memcpy(&value, &f, sizeof(float));
+			value += denormal_magic;
+			memcpy(&f, &value, sizeof(float));
+			h = (unsigned short)(f - denormal_magic_bits);
+		}
+		else
+		{
+			unsigned int mantissa_odd = (f >> 13) & 1;
+			f += ((unsigned int)(15 - 127) << 23) + 0xfff;
+			f += mantissa_odd;
+			h = (unsigned short)(f >> 13);
+		}
+
+		return h | (unsigned short)(sign >> 16);
+	}
+
+#ifdef CL_HALF_FLOAT_F16C
+
+	static bool half_float_use_f16c()
+	{
+		static const bool supported = System::detect_cpu_extension(System::avx) && System::detect_cpu_extension(System::f16c);
+		return supported;
+	}
+
+	CL_TARGET_F16C static size_t half_float_f16c_to_float(const unsigned short *input, float *output, size_t count)
+	{
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+			_mm256_storeu_ps(output + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(input + i))));
+		return i;
+	}
+
+	CL_TARGET_F16C static size_t half_float_f16c_to_half(const float *input, unsigned short *output, size_t count)
+	{
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+			_mm_storeu_si128((__m128i*)(output + i), _mm256_cvtps_ph(_mm256_loadu_ps(input + i), 0));
+		return i;
+	}
+
+#endif
+
+	void HalfFloat::half_to_float(const unsigned short *input, float *output, size_t count)
+	{
+		size_t i = 0;
+#if defined CL_HALF_FLOAT_F16C
+		if (half_float_use_f16c())
+			i = half_float_f16c_to_float(input, output, count);
+#elif defined CL_HALF_FLOAT_NEON
+		for (; i + 4 <= count; i += 4)
+			vst1q_f32(output + i, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(input + i))));
+#endif
+		for (; i < count; i++)
+			output[i] = half_to_float(input[i]);
+	}
+
+	void HalfFloat::float_to_half(const float *input, unsigned short *output, size_t count)
+	{
+		size_t i = 0;
+#if defined CL_HALF_FLOAT_F16C
+		if (half_float_use_f16c())
+			i = half_float_f16c_to_half(input, output, count);
+#elif defined CL_HALF_FLOAT_NEON
+		for (; i + 4 <= count; i += 4)
+			vst1_u16(output + i, vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(input + i))));
+#endif
+		for (; i < count; i++)
+			output[i] = half_float_round_nearest(input[i]);
+	}
+
 	/*
 
 	void generate_tables()
@@ -3295,6 +3401,8 @@ namespace clan
 		offset_table[32] = 0;
 		for (int i = 1; i < 32; i++)
 			offset_table[i] = 1024;
+		for (int i = 33; i < 64; i++)
+			offset_table[i] = 1024;
 
 		for(unsigned int i=0; i<256; ++i)
 		{
@@ -36,8 +36,8 @@ namespace clan
 	{
 	}
 
-	RectPacker::RectPacker(const Size &max_group_size, AllocationPolicy policy)
-		: impl(std::make_shared<RectPacker_Impl>(max_group_size))
+	RectPacker::RectPacker(const Size &max_group_size, AllocationPolicy policy, PackingMethod method)
+		: impl(std::make_shared<RectPacker_Impl>(max_group_size, method))
 	{
 		set_allocation_policy(policy);
 	}
@@ -57,11 +57,21 @@ namespace clan
 		return impl->allocation_policy;
 	}
 
+	RectPacker::PackingMethod RectPacker::get_packing_method() const
+	{
+		return impl->packing_method;
+	}
+
 	Size RectPacker::get_max_group_size() const
 	{
 		return impl->max_group_size;
 	}
 
+	Size RectPacker::get_block_size() const
+	{
+		return impl->block_size;
+	}
+
 	int RectPacker::get_total_rect_count() const
 	{
 		return impl->get_total_rect_count();
@@ -82,8 +92,22 @@ namespace clan
 		impl->allocation_policy = policy;
 	}
 
+	void RectPacker::set_block_size(const Size &block_size)
+	{
+		if (block_size.width <= 0 || block_size.height <= 0)
+			throw Exception("RectPacker block size must be positive");
+		if (!impl->root_nodes.empty())
+			throw Exception("RectPacker block size must be set before adding rects");
+		impl->block_size = block_size;
+	}
+
 	RectPacker::AllocatedRect RectPacker::add(const Size &size)
 	{
 		return impl->add_new_node(size);
 	}
+
+	std::vector<RectPacker::AllocatedRect> RectPacker::add_batch(const std::vector<Size> &sizes)
+	{
+		return impl->add_batch(sizes);
+	}
 }
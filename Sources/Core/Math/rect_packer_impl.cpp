@@ -29,11 +29,12 @@
 #include "Core/precomp.h"
 #include "API/Core/Math/rect.h"
 #include "rect_packer_impl.h"
+#include <algorithm>
 
 namespace clan
 {
-	RectPacker_Impl::RectPacker_Impl(const Size &max_group_size)
-		: active_root_node(nullptr), next_node_id(0), max_group_size(max_group_size)
+	RectPacker_Impl::RectPacker_Impl(const Size &max_group_size, RectPacker::PackingMethod packing_method)
+		: active_root_node(nullptr), next_node_id(0), packing_method(packing_method), max_group_size(max_group_size), block_size(1, 1)
 	{
 	}
 
@@ -55,7 +56,7 @@ namespace clan
 		std::vector<RootNode *>::size_type index, size;
 		size = root_nodes.size();
 		for (index = 0; index < size; ++index)
-			count += root_nodes[index]->node.get_rect_count();
+			count += root_nodes[index]->rect_count;
 
 		return count;
 	}
@@ -65,79 +66,297 @@ namespace clan
 		int count = 0;
 
 		if (group_index < root_nodes.size())
-			count = root_nodes[group_index]->node.get_rect_count();
+			count = root_nodes[group_index]->rect_count;
 
 		return count;
 	}
 
 	RectPacker::AllocatedRect RectPacker_Impl::add_new_node(const Size &rect_size)
 	{
-		// Try inserting in current active group
-		Node *node;
+		// Reserve whole blocks, so every position stays a multiple of the block size
+		Size reserved_size(
+			(rect_size.width + block_size.width - 1) / block_size.width * block_size.width,
+			(rect_size.height + block_size.height - 1) / block_size.height * block_size.height);
+
 		if (!active_root_node)
 		{
 			// Create an initial root, if it does not exist
-			node = nullptr;
 			next_node_id = 1;
 		}
-		else
-		{
-			node = active_root_node->node.insert(rect_size, next_node_id);
-		}
 
-		if (node == nullptr) // Couldn't find a fit in current active group
+		// Try inserting in current active group
+		Rect rect;
+		RootNode *root = active_root_node;
+		if (!root || !insert(root, reserved_size, rect)) // Couldn't find a fit in current active group
 		{
 			if (allocation_policy == RectPacker::fail_if_full && root_nodes.size() > 0)
 			{
 				throw Exception("Unable to pack rect into group: full");
 			}
 
+			root = nullptr;
 			if (allocation_policy == RectPacker::search_previous_groups)
 			{
 				std::vector<RootNode *>::size_type index, size;
 				size = root_nodes.size();
 				for (index = 0; index < size; ++index)
 				{
-					node = root_nodes[index]->node.insert(rect_size, next_node_id);
-					if (node)	// We found space in a previous group
+					if (root_nodes[index] != active_root_node && insert(root_nodes[index], reserved_size, rect))
+					{
+						root = root_nodes[index];	// We found space in a previous group
 						break;
+					}
 				}
 			}
 
-			if (node == nullptr) // Couldn't find a fit, so create a new group
+			if (root == nullptr) // Couldn't find a fit, so create a new group
 			{
-				if (rect_size.width <= max_group_size.width && rect_size.height <= max_group_size.height)
+				Size group_size = get_group_size();
+				if (reserved_size.width <= group_size.width && reserved_size.height <= group_size.height)
 				{
-					node = add_new_root()->node.insert(rect_size, next_node_id);
+					root = add_new_root();
+					if (!insert(root, reserved_size, rect))
+						throw Exception("Unable to pack rect into group: Unknown reason");
 				}
 				else
 				{
 					throw Exception("Unable to pack rect into group: Larger than max_group_size");
 				}
 			}
-
-			if (node == nullptr)
-				throw Exception("Unable to pack rect into group: Unknown reason");
 		}
 
 		next_node_id++;
+		root->rect_count++;
 
-		return RectPacker::AllocatedRect(active_root_node->group_id, node->node_rect);
+		return RectPacker::AllocatedRect(root->group_id, Rect(rect.get_top_left(), rect_size));
+	}
+
+	std::vector<RectPacker::AllocatedRect> RectPacker_Impl::add_batch(const std::vector<Size> &sizes)
+	{
+		// Largest first leaves the small rects to fill the gaps between the large ones
+		std::vector<size_t> order(sizes.size());
+		for (size_t i = 0; i < order.size(); i++)
+			order[i] = i;
+		std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b)
+		{
+			int area_a = sizes[a].width * sizes[a].height;
+			int area_b = sizes[b].width * sizes[b].height;
+			if (area_a != area_b)
+				return area_a > area_b;
+			return sizes[a].width + sizes[a].height > sizes[b].width + sizes[b].height;
+		});
+
+		std::vector<RectPacker::AllocatedRect> results(sizes.size(), RectPacker::AllocatedRect(-1, Rect()));
+		for (size_t index : order)
+			results[index] = add_new_node(sizes[index]);
+		return results;
 	}
 
 	RectPacker_Impl::RootNode *RectPacker_Impl::add_new_root()
 	{
-		Node node(Rect(Point(0, 0), max_group_size));
+		Size group_size = get_group_size();
+		Node node(Rect(Point(0, 0), group_size));
 
 		active_root_node = new RootNode();
 		active_root_node->group_id = (int)root_nodes.size();
+		active_root_node->rect_count = 0;
 		active_root_node->node = node;
+		if (packing_method == RectPacker::max_rects)
+			active_root_node->free_rects.push_back(Rect(Point(0, 0), group_size));
+		else if (packing_method == RectPacker::skyline)
+			active_root_node->skyline.push_back(SkylineSegment(0, 0, group_size.width));
 
 		root_nodes.push_back(active_root_node);
 
 		return active_root_node;
 	}
 
+	Size RectPacker_Impl::get_group_size() const
+	{
+		// Round down, so rects at the right and bottom edges still cover whole blocks
+		return Size(max_group_size.width / block_size.width * block_size.width, max_group_size.height / block_size.height * block_size.height);
+	}
+
+	bool RectPacker_Impl::insert(RootNode *root, const Size &size, Rect &out_rect)
+	{
+		switch (packing_method)
+		{
+		case RectPacker::max_rects:
+			return insert_max_rects(root, size, out_rect);
+		case RectPacker::skyline:
+			return insert_skyline(root, size, get_group_size(), out_rect);
+		case RectPacker::binary_tree:
+		default:
+			{
+				Node *node = root->node.insert(size, next_node_id);
+				if (!node)
+					return false;
+				out_rect = node->node_rect;
+				return true;
+			}
+		}
+	}
+
+	bool RectPacker_Impl::insert_max_rects(RootNode *root, const Size &size, Rect &out_rect)
+	{
+		// MaxRects with best short side fit, as described by Jukka Jylanki in
+		// "A Thousand Ways to Pack the Bin - A Practical Approach to Two-Dimensional Rectangle Bin Packing"
+
+		std::vector<Rect> &free_rects = root->free_rects;
+
+		int best_index = -1;
+		int best_short_side = 0;
+		int best_long_side = 0;
+		for (size_t i = 0; i < free_rects.size(); i++)
+		{
+			int leftover_x = free_rects[i].get_width() - size.width;
+			int leftover_y = free_rects[i].get_height() - size.height;
+			if (leftover_x < 0 || leftover_y < 0)
+				continue;
+
+			int short_side = min(leftover_x, leftover_y);
+			int long_side = max(leftover_x, leftover_y);
+			if (best_index == -1 || short_side < best_short_side || (short_side == best_short_side && long_side < best_long_side))
+			{
+				best_index = (int)i;
+				best_short_side = short_side;
+				best_long_side = long_side;
+			}
+		}
+
+		if (best_index == -1)
+			return false;
+
+		Rect placed(free_rects[best_index].get_top_left(), size);
+
+		// Split every free rect that overlaps the placed rect into the up to four maximal rects around it
+		std::vector<Rect> new_rects;
+		for (size_t i = 0; i < free_rects.size(); )
+		{
+			Rect free_rect = free_rects[i];
+			if (!free_rect.is_overlapped(placed))
+			{
+				i++;
+				continue;
+			}
+
+			if (placed.left > free_rect.left)
+				new_rects.push_back(Rect(free_rect.left, free_rect.top, placed.left, free_rect.bottom));
+			if (placed.right < free_rect.right)
+				new_rects.push_back(Rect(placed.right, free_rect.top, free_rect.right, free_rect.bottom));
+			if (placed.top > free_rect.top)
+				new_rects.push_back(Rect(free_rect.left, free_rect.top, free_rect.right, placed.top));
+			if (placed.bottom < free_rect.bottom)
+				new_rects.push_back(Rect(free_rect.left, placed.bottom, free_rect.right, free_rect.bottom));
+
+			free_rects[i] = free_rects.back();
+			free_rects.pop_back();
+		}
+
+		// Drop the new rects contained in another free rect. The untouched free rects were already
+		// pruned against each other and can only be contained in the larger ones they were split from.
+		for (size_t i = 0; i < new_rects.size(); )
+		{
+			bool contained = false;
+			for (size_t j = 0; j < new_rects.size() && !contained; j++)
+				contained = j != i && new_rects[j].is_inside(new_rects[i]) && (new_rects[i] != new_rects[j] || j < i);
+			for (size_t j = 0; j < free_rects.size() && !contained; j++)
+				contained = free_rects[j].is_inside(new_rects[i]);
+
+			if (contained)
+			{
+				new_rects[i] = new_rects.back();
+				new_rects.pop_back();
+			}
+			else
+			{
+				i++;
+			}
+		}
+		free_rects.insert(free_rects.end(), new_rects.begin(), new_rects.end());
+
+		out_rect = placed;
+		return true;
+	}
+
+	bool RectPacker_Impl::insert_skyline(RootNode *root, const Size &size, const Size &group_size, Rect &out_rect)
+	{
+		// Skyline bottom-left: place the rect where its bottom edge ends up lowest, preferring the least wasted width
+
+		std::vector<SkylineSegment> &skyline = root->skyline;
+
+		int best_index = -1;
+		int best_bottom = 0;
+		int best_width = 0;
+		int best_y = 0;
+		for (size_t i = 0; i < skyline.size(); i++)
+		{
+			int x = skyline[i].x;
+			if (x + size.width > group_size.width)
+				break;
+
+			// The rect rests on the highest segment below it
+			int y = 0;
+			int width_left = size.width;
+			for (size_t j = i; width_left > 0; j++)
+			{
+				y = max(y, skyline[j].y);
+				width_left -= skyline[j].width;
+			}
+
+			int bottom = y + size.height;
+			if (bottom > group_size.height)
+				continue;
+
+			if (best_index == -1 || bottom < best_bottom || (bottom == best_bottom && skyline[i].width < best_width))
+			{
+				best_index = (int)i;
+				best_bottom = bottom;
+				best_width = skyline[i].width;
+				best_y = y;
+			}
+		}
+
+		if (best_index == -1)
+			return false;
+
+		int x = skyline[best_index].x;
+		skyline.insert(skyline.begin() + best_index, SkylineSegment(x, best_bottom, size.width));
+
+		// Shrink or remove the segments now covered by the rect
+		for (size_t i = best_index + 1; i < skyline.size(); )
+		{
+			int covered = x + size.width - skyline[i].x;
+			if (covered <= 0)
+				break;
+
+			if (covered < skyline[i].width)
+			{
+				skyline[i].x += covered;
+				skyline[i].width -= covered;
+				break;
+			}
+			skyline.erase(skyline.begin() + i);
+		}
+
+		// Merge neighbours at the same height
+		for (size_t i = 0; i + 1 < skyline.size(); )
+		{
+			if (skyline[i].y == skyline[i + 1].y)
+			{
+				skyline[i].width += skyline[i + 1].width;
+				skyline.erase(skyline.begin() + i + 1);
+			}
+			else
+			{
+				i++;
+			}
+		}
+
+		out_rect = Rect(Point(x, best_y), size);
+		return true;
+	}
+
 	/////////////////////////////////////////////////////////////////////////////
 	// RectPacker_Impl::Node:
 
@@ -54,21 +54,31 @@ namespace clan
 			int id;
 		};
 
+		struct SkylineSegment
+		{
+			SkylineSegment(int x, int y, int width) : x(x), y(y), width(width) {}
+			int x, y, width;
+		};
+
 		struct RootNode
 		{
 		public:
 			int group_id;
-			Node node;
+			int rect_count;
+			Node node;	// Used by binary_tree
+			std::vector<Rect> free_rects;	// Used by max_rects
+			std::vector<SkylineSegment> skyline;	// Used by skyline
 		};
 
 	public:
-		RectPacker_Impl(const Size &max_group_size);
+		RectPacker_Impl(const Size &max_group_size, RectPacker::PackingMethod packing_method);
 		~RectPacker_Impl();
 
 		int get_total_rect_count() const;
 		int get_rect_count(unsigned int group_index) const;
 
 		RectPacker::AllocatedRect add_new_node(const Size &rect_size);
+		std::vector<RectPacker::AllocatedRect> add_batch(const std::vector<Size> &sizes);
 		RootNode *add_new_root();
 
 		std::vector<RootNode *> root_nodes;
@@ -78,6 +88,15 @@ namespace clan
 
 		RectPacker::AllocationPolicy allocation_policy;
 
+		RectPacker::PackingMethod packing_method;
+
 		Size max_group_size;
+		Size block_size;
+
+	private:
+		bool insert(RootNode *root, const Size &size, Rect &out_rect);
+		static bool insert_max_rects(RootNode *root, const Size &size, Rect &out_rect);
+		static bool insert_skyline(RootNode *root, const Size &size, const Size &group_size, Rect &out_rect);
+		Size get_group_size() const;
 	};
 }
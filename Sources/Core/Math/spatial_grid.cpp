@@ -0,0 +1,360 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "Core/precomp.h"
+#include "API/Core/Math/spatial_grid.h"
+#include "API/Core/Math/batch_math.h"
+#include "API/Core/Math/frustum_planes.h"
+#include "API/Core/Math/intersection_test.h"
+#include "API/Core/System/work_queue.h"
+#include "API/Core/System/exception.h"
+#include "broadphase_helpers.h"
+#include <algorithm>
+#include <cmath>
+
+namespace clan
+{
+	SpatialGrid::SpatialGrid(const AxisAlignedBoundingBox &bounds, float cell_size)
+		: bounds(bounds), cell_size(cell_size), rcp_cell_size(1.0f / cell_size)
+	{
+		if (!(cell_size > 0.0f))
+			throw Exception("Spatial grid cell size must be positive");
+
+		Vec3f size = bounds.aabb_max - bounds.aabb_min;
+		size_x = std::max((int)std::ceil(size.x * rcp_cell_size), 1);
+		size_y = std::max((int)std::ceil(size.y * rcp_cell_size), 1);
+		size_z = std::max((int)std::ceil(size.z * rcp_cell_size), 1);
+		if ((double)size_x * size_y * size_z > (1 << 24))
+			throw Exception("Spatial grid has too many cells");
+
+		cells.resize(size_x * size_y * size_z);
+	}
+
+	int SpatialGrid::insert(const AxisAlignedBoundingBox &box)
+	{
+		int id;
+		if (!free_ids.empty())
+		{
+			id = free_ids.back();
+			free_ids.pop_back();
+		}
+		else
+		{
+			id = (int)proxies.size();
+			proxies.push_back(Proxy());
+			boxes.push_back(box);
+		}
+
+		Proxy &proxy = proxies[id];
+		proxy.box = box;
+		proxy.cells = get_cell_range(box);
+		proxy.outside_index = -1;
+		proxy.alive = true;
+		boxes[id] = box;
+		add_to_cells(id);
+		count++;
+		return id;
+	}
+
+	void SpatialGrid::update(int id, const AxisAlignedBoundingBox &box)
+	{
+		CellRange range = get_cell_range(box);
+		if (range == proxies[id].cells)
+		{
+			proxies[id].box = box;
+			boxes[id] = box;
+
+			// Border cells also hold boxes reaching outside, so the outside list may still change
+			bool outside = !broadphase_contains(bounds, box);
+			if (outside != (proxies[id].outside_index != -1))
+			{
+				remove_from_cells(id);
+				add_to_cells(id);
+			}
+		}
+		else
+		{
+			remove_from_cells(id);
+			proxies[id].box = box;
+			proxies[id].cells = range;
+			boxes[id] = box;
+			add_to_cells(id);
+		}
+	}
+
+	void SpatialGrid::remove(int id)
+	{
+		remove_from_cells(id);
+		proxies[id].alive = false;
+		free_ids.push_back(id);
+		count--;
+	}
+
+	void SpatialGrid::clear()
+	{
+		for (auto &cell : cells)
+			cell.clear();
+		proxies.clear();
+		boxes.clear();
+		free_ids.clear();
+		outside_ids.clear();
+		count = 0;
+	}
+
+	void SpatialGrid::query(const AxisAlignedBoundingBox &box, std::vector<int> &out_ids) const
+	{
+		CellRange range = get_cell_range(box);
+		for (int z = range.min_z; z <= range.max_z; z++)
+		{
+			for (int y = range.min_y; y <= range.max_y; y++)
+			{
+				for (int x = range.min_x; x <= range.max_x; x++)
+				{
+					for (int id : cells[get_cell_index(x, y, z)])
+					{
+						// A proxy spanning several cells is only reported from the first cell it shares with the query
+						const CellRange &cells = proxies[id].cells;
+						if (x == std::max(cells.min_x, range.min_x) && y == std::max(cells.min_y, range.min_y) && z == std::max(cells.min_z, range.min_z) &&
+							broadphase_overlap(proxies[id].box, box))
+						{
+							out_ids.push_back(id);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	void SpatialGrid::query_ray(const Vec3f &ray_start, const Vec3f &ray_end, std::vector<int> &out_ids) const
+	{
+		size_t first = out_ids.size();
+
+		// Clip the segment to the bounds, then walk the cells it passes through
+		float start[3] = { ray_start.x, ray_start.y, ray_start.z };
+		float delta[3] = { ray_end.x - ray_start.x, ray_end.y - ray_start.y, ray_end.z - ray_start.z };
+		float lower[3] = { bounds.aabb_min.x, bounds.aabb_min.y, bounds.aabb_min.z };
+		float upper[3] = { bounds.aabb_max.x, bounds.aabb_max.y, bounds.aabb_max.z };
+		float t_enter = 0.0f, t_exit = 1.0f;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			float d = delta[axis];
+			if (d == 0.0f)
+			{
+				if (start[axis] < lower[axis] || start[axis] > upper[axis])
+					t_enter = 2.0f;
+			}
+			else
+			{
+				float t0 = (lower[axis] - start[axis]) / d, t1 = (upper[axis] - start[axis]) / d;
+				t_enter = std::max(t_enter, std::min(t0, t1));
+				t_exit = std::min(t_exit, std::max(t0, t1));
+			}
+		}
+
+		if (t_enter <= t_exit)
+		{
+			int cell[3], last_cell[3], step[3];
+			float t_next[3], t_step[3];
+			int cell_limit[3] = { size_x - 1, size_y - 1, size_z - 1 };
+			for (int axis = 0; axis < 3; axis++)
+			{
+				float entry = start[axis] + delta[axis] * t_enter;
+				float exit = start[axis] + delta[axis] * t_exit;
+				cell[axis] = clamp((int)std::floor((entry - lower[axis]) * rcp_cell_size), 0, cell_limit[axis]);
+				last_cell[axis] = clamp((int)std::floor((exit - lower[axis]) * rcp_cell_size), 0, cell_limit[axis]);
+				if (delta[axis] > 0.0f)
+				{
+					step[axis] = 1;
+					t_next[axis] = (lower[axis] + (cell[axis] + 1) * cell_size - start[axis]) / delta[axis];
+					t_step[axis] = cell_size / delta[axis];
+				}
+				else if (delta[axis] < 0.0f)
+				{
+					step[axis] = -1;
+					t_next[axis] = (lower[axis] + cell[axis] * cell_size - start[axis]) / delta[axis];
+					t_step[axis] = -cell_size / delta[axis];
+				}
+				else
+				{
+					step[axis] = 0;
+					t_next[axis] = 2.0f;
+					t_step[axis] = 0.0f;
+				}
+			}
+
+			int max_steps = size_x + size_y + size_z;
+			for (int i = 0; i <= max_steps; i++)
+			{
+				for (int id : cells[get_cell_index(cell[0], cell[1], cell[2])])
+				{
+					if (IntersectionTest::ray_aabb(ray_start, ray_end, proxies[id].box) == IntersectionTest::overlap)
+						out_ids.push_back(id);
+				}
+
+				if (cell[0] == last_cell[0] && cell[1] == last_cell[1] && cell[2] == last_cell[2])
+					break;
+
+				int axis = (t_next[0] < t_next[1]) ? (t_next[0] < t_next[2] ? 0 : 2) : (t_next[1] < t_next[2] ? 1 : 2);
+				if (t_next[axis] > t_exit)
+					break;
+				cell[axis] += step[axis];
+				if (cell[axis] < 0 || cell[axis] > cell_limit[axis])
+					break;
+				t_next[axis] += t_step[axis];
+			}
+		}
+
+		// Boxes reaching outside the bounds can be hit where there are no cells
+		for (int id : outside_ids)
+		{
+			if (IntersectionTest::ray_aabb(ray_start, ray_end, proxies[id].box) == IntersectionTest::overlap)
+				out_ids.push_back(id);
+		}
+
+		// A proxy is found once for every cell it shares with the ray
+		std::sort(out_ids.begin() + first, out_ids.end());
+		out_ids.erase(std::unique(out_ids.begin() + first, out_ids.end()), out_ids.end());
+	}
+
+	void SpatialGrid::query_frustum(const FrustumPlanes &frustum, std::vector<int> &out_ids) const
+	{
+		// Every proxy is tested, which the batched plane tests do faster than walking the cells
+		std::vector<unsigned int> visible(boxes.size());
+		size_t visible_count = BatchMath::frustum_cull_indices(frustum, boxes.data(), boxes.size(), visible.data());
+		for (size_t i = 0; i < visible_count; i++)
+		{
+			if (proxies[visible[i]].alive)
+				out_ids.push_back(visible[i]);
+		}
+	}
+
+	void SpatialGrid::find_pairs(std::vector<BroadphasePair> &out_pairs) const
+	{
+		find_cell_pairs(0, (int)cells.size(), out_pairs);
+	}
+
+	void SpatialGrid::find_pairs(WorkQueue &queue, std::vector<BroadphasePair> &out_pairs) const
+	{
+		broadphase_parallel_pairs(queue, (int)cells.size(), out_pairs, [this](int first, int last, std::vector<BroadphasePair> &pairs)
+		{
+			find_cell_pairs(first, last, pairs);
+		});
+	}
+
+	void SpatialGrid::find_cell_pairs(int first_cell, int last_cell, std::vector<BroadphasePair> &out_pairs) const
+	{
+		for (int index = first_cell; index < last_cell; index++)
+		{
+			const std::vector<int> &cell = cells[index];
+			if (cell.size() < 2)
+				continue;
+
+			int x = index % size_x;
+			int y = (index / size_x) % size_y;
+			int z = index / (size_x * size_y);
+			for (size_t i = 0; i < cell.size(); i++)
+			{
+				const Proxy &a = proxies[cell[i]];
+				for (size_t j = i + 1; j < cell.size(); j++)
+				{
+					// Two proxies sharing several cells are only paired in the first of them
+					const Proxy &b = proxies[cell[j]];
+					if (x == std::max(a.cells.min_x, b.cells.min_x) && y == std::max(a.cells.min_y, b.cells.min_y) && z == std::max(a.cells.min_z, b.cells.min_z) &&
+						broadphase_overlap(a.box, b.box))
+					{
+						out_pairs.push_back(cell[i] < cell[j] ? BroadphasePair(cell[i], cell[j]) : BroadphasePair(cell[j], cell[i]));
+					}
+				}
+			}
+		}
+	}
+
+	SpatialGrid::CellRange SpatialGrid::get_cell_range(const AxisAlignedBoundingBox &box) const
+	{
+		// Boxes are clamped to the border cells, which keeps overlapping boxes in overlapping ranges
+		Vec3f min_cell = (box.aabb_min - bounds.aabb_min) * rcp_cell_size;
+		Vec3f max_cell = (box.aabb_max - bounds.aabb_min) * rcp_cell_size;
+		CellRange range;
+		range.min_x = (int)std::floor(clamp(min_cell.x, 0.0f, (float)(size_x - 1)));
+		range.min_y = (int)std::floor(clamp(min_cell.y, 0.0f, (float)(size_y - 1)));
+		range.min_z = (int)std::floor(clamp(min_cell.z, 0.0f, (float)(size_z - 1)));
+		range.max_x = (int)std::floor(clamp(max_cell.x, 0.0f, (float)(size_x - 1)));
+		range.max_y = (int)std::floor(clamp(max_cell.y, 0.0f, (float)(size_y - 1)));
+		range.max_z = (int)std::floor(clamp(max_cell.z, 0.0f, (float)(size_z - 1)));
+		return range;
+	}
+
+	void SpatialGrid::add_to_cells(int id)
+	{
+		Proxy &proxy = proxies[id];
+		const CellRange &range = proxy.cells;
+		for (int z = range.min_z; z <= range.max_z; z++)
+		{
+			for (int y = range.min_y; y <= range.max_y; y++)
+			{
+				for (int x = range.min_x; x <= range.max_x; x++)
+					cells[get_cell_index(x, y, z)].push_back(id);
+			}
+		}
+
+		if (!broadphase_contains(bounds, proxy.box))
+		{
+			proxy.outside_index = (int)outside_ids.size();
+			outside_ids.push_back(id);
+		}
+	}
+
+	void SpatialGrid::remove_from_cells(int id)
+	{
+		Proxy &proxy = proxies[id];
+		const CellRange &range = proxy.cells;
+		for (int z = range.min_z; z <= range.max_z; z++)
+		{
+			for (int y = range.min_y; y <= range.max_y; y++)
+			{
+				for (int x = range.min_x; x <= range.max_x; x++)
+				{
+					std::vector<int> &cell = cells[get_cell_index(x, y, z)];
+					auto it = std::find(cell.begin(), cell.end(), id);
+					*it = cell.back();
+					cell.pop_back();
+				}
+			}
+		}
+
+		if (proxy.outside_index != -1)
+		{
+			int moved_id = outside_ids.back();
+			outside_ids[proxy.outside_index] = moved_id;
+			proxies[moved_id].outside_index = proxy.outside_index;
+			outside_ids.pop_back();
+			proxy.outside_index = -1;
+		}
+	}
+}
@@ -0,0 +1,394 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "Core/precomp.h"
+#include "API/Core/Math/sweep_and_prune.h"
+#include "API/Core/Math/frustum_planes.h"
+#include "API/Core/Math/intersection_test.h"
+#include "API/Core/System/work_queue.h"
+#include "broadphase_helpers.h"
+#include <algorithm>
+
+#ifndef CL_DISABLE_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined CL_DISABLE_SSE2 && (defined __ARM_NEON || defined __ARM_NEON__)
+#include <arm_neon.h>
+#define CL_SWEEP_AND_PRUNE_NEON
+#endif
+
+namespace clan
+{
+	// Boxes in sorted order. Every array has sweep_padding extra entries so four can always be loaded.
+	struct SweepArrays
+	{
+		const float *min_x, *max_x, *min_y, *max_y, *min_z, *max_z;
+		int count;
+	};
+
+	static const int sweep_padding = 4;
+
+#ifdef CL_SWEEP_AND_PRUNE_NEON
+	static inline unsigned int sweep_neon_movemask(uint32x4_t mask)
+	{
+		static const uint32_t lane_bits[4] = { 1, 2, 4, 8 };
+		uint32x4_t bits = vandq_u32(mask, vld1q_u32(lane_bits));
+		uint32x2_t bits2 = vorr_u32(vget_low_u32(bits), vget_high_u32(bits));
+		return vget_lane_u32(bits2, 0) | vget_lane_u32(bits2, 1);
+	}
+#endif
+
+	// Tests the four boxes starting at index against a box.
+	// Returns a bit per overlapping box and sets x_mask to the boxes that still start before the end of the box.
+	static inline unsigned int sweep_overlap_mask(const SweepArrays &arrays, int index, const AxisAlignedBoundingBox &box, unsigned int &x_mask)
+	{
+		unsigned int mask;
+#ifndef CL_DISABLE_SSE2
+		__m128 in_x = _mm_cmple_ps(_mm_loadu_ps(arrays.min_x + index), _mm_set1_ps(box.aabb_max.x));
+		__m128 in_y = _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(arrays.min_y + index), _mm_set1_ps(box.aabb_max.y)), _mm_cmple_ps(_mm_set1_ps(box.aabb_min.y), _mm_loadu_ps(arrays.max_y + index)));
+		__m128 in_z = _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(arrays.min_z + index), _mm_set1_ps(box.aabb_max.z)), _mm_cmple_ps(_mm_set1_ps(box.aabb_min.z), _mm_loadu_ps(arrays.max_z + index)));
+		__m128 in_max_x = _mm_cmple_ps(_mm_set1_ps(box.aabb_min.x), _mm_loadu_ps(arrays.max_x + index));
+		x_mask = _mm_movemask_ps(in_x);
+		mask = _mm_movemask_ps(_mm_and_ps(_mm_and_ps(in_x, in_max_x), _mm_and_ps(in_y, in_z)));
+#elif defined CL_SWEEP_AND_PRUNE_NEON
+		uint32x4_t in_x = vcleq_f32(vld1q_f32(arrays.min_x + index), vdupq_n_f32(box.aabb_max.x));
+		uint32x4_t in_y = vandq_u32(vcleq_f32(vld1q_f32(arrays.min_y + index), vdupq_n_f32(box.aabb_max.y)), vcleq_f32(vdupq_n_f32(box.aabb_min.y), vld1q_f32(arrays.max_y + index)));
+		uint32x4_t in_z = vandq_u32(vcleq_f32(vld1q_f32(arrays.min_z + index), vdupq_n_f32(box.aabb_max.z)), vcleq_f32(vdupq_n_f32(box.aabb_min.z), vld1q_f32(arrays.max_z + index)));
+		uint32x4_t in_max_x = vcleq_f32(vdupq_n_f32(box.aabb_min.x), vld1q_f32(arrays.max_x + index));
+		x_mask = sweep_neon_movemask(in_x);
+		mask = sweep_neon_movemask(vandq_u32(vandq_u32(in_x, in_max_x), vandq_u32(in_y, in_z)));
+#else
+		x_mask = 0;
+		mask = 0;
+		for (int lane = 0; lane < 4; lane++)
+		{
+			int i = index + lane;
+			bool in_x = arrays.min_x[i] <= box.aabb_max.x;
+			bool overlap = in_x && box.aabb_min.x <= arrays.max_x[i] &&
+				arrays.min_y[i] <= box.aabb_max.y && box.aabb_min.y <= arrays.max_y[i] &&
+				arrays.min_z[i] <= box.aabb_max.z && box.aabb_min.z <= arrays.max_z[i];
+			x_mask |= (in_x ? 1 : 0) << lane;
+			mask |= (overlap ? 1 : 0) << lane;
+		}
+#endif
+
+		// Leave out the padding past the last box
+		if (index + 4 > arrays.count)
+		{
+			unsigned int valid = (1 << (arrays.count - index)) - 1;
+			x_mask &= valid;
+			mask &= valid;
+		}
+		return mask;
+	}
+
+	// Returns a bit for each of the four boxes starting at index that is not fully outside the frustum.
+	// Matches the plane test used by IntersectionTest::frustum_aabb.
+	static inline unsigned int sweep_frustum_mask(const SweepArrays &arrays, int index, const FrustumPlanes &frustum)
+	{
+		unsigned int outside;
+#ifndef CL_DISABLE_SSE2
+		__m128 min_x = _mm_loadu_ps(arrays.min_x + index), max_x = _mm_loadu_ps(arrays.max_x + index);
+		__m128 min_y = _mm_loadu_ps(arrays.min_y + index), max_y = _mm_loadu_ps(arrays.max_y + index);
+		__m128 min_z = _mm_loadu_ps(arrays.min_z + index), max_z = _mm_loadu_ps(arrays.max_z + index);
+		__m128 outside_mask = _mm_setzero_ps();
+		for (const Vec4f &plane : frustum.planes)
+		{
+			__m128 a = _mm_set1_ps(plane.x), b = _mm_set1_ps(plane.y), c = _mm_set1_ps(plane.z);
+			__m128 distance = _mm_add_ps(
+				_mm_add_ps(_mm_max_ps(_mm_mul_ps(a, min_x), _mm_mul_ps(a, max_x)), _mm_max_ps(_mm_mul_ps(b, min_y), _mm_mul_ps(b, max_y))),
+				_mm_add_ps(_mm_max_ps(_mm_mul_ps(c, min_z), _mm_mul_ps(c, max_z)), _mm_set1_ps(plane.w)));
+			outside_mask = _mm_or_ps(outside_mask, _mm_cmplt_ps(distance, _mm_setzero_ps()));
+		}
+		outside = _mm_movemask_ps(outside_mask);
+#elif defined CL_SWEEP_AND_PRUNE_NEON
+		float32x4_t min_x = vld1q_f32(arrays.min_x + index), max_x = vld1q_f32(arrays.max_x + index);
+		float32x4_t min_y = vld1q_f32(arrays.min_y + index), max_y = vld1q_f32(arrays.max_y + index);
+		float32x4_t min_z = vld1q_f32(arrays.min_z + index), max_z = vld1q_f32(arrays.max_z + index);
+		uint32x4_t outside_mask = vdupq_n_u32(0);
+		for (const Vec4f &plane : frustum.planes)
+		{
+			float32x4_t distance = vaddq_f32(
+				vaddq_f32(vmaxq_f32(vmulq_n_f32(min_x, plane.x), vmulq_n_f32(max_x, plane.x)), vmaxq_f32(vmulq_n_f32(min_y, plane.y), vmulq_n_f32(max_y, plane.y))),
+				vaddq_f32(vmaxq_f32(vmulq_n_f32(min_z, plane.z), vmulq_n_f32(max_z, plane.z)), vdupq_n_f32(plane.w)));
+			outside_mask = vorrq_u32(outside_mask, vcltq_f32(distance, vdupq_n_f32(0.0f)));
+		}
+		outside = sweep_neon_movemask(outside_mask);
+#else
+		outside = 0;
+		for (int lane = 0; lane < 4; lane++)
+		{
+			int i = index + lane;
+			for (const Vec4f &plane : frustum.planes)
+			{
+				float distance =
+					(std::max(plane.x * arrays.min_x[i], plane.x * arrays.max_x[i]) + std::max(plane.y * arrays.min_y[i], plane.y * arrays.max_y[i])) +
+					(std::max(plane.z * arrays.min_z[i], plane.z * arrays.max_z[i]) + plane.w);
+				if (distance < 0.0f)
+					outside |= 1 << lane;
+			}
+		}
+#endif
+
+		unsigned int mask = ~outside & 15;
+		if (index + 4 > arrays.count)
+			mask &= (1 << (arrays.count - index)) - 1;
+		return mask;
+	}
+
+	static inline int sweep_lowest_bit(unsigned int mask)
+	{
+		int bit = 0;
+		while (!(mask & (1 << bit)))
+			bit++;
+		return bit;
+	}
+
+	int SweepAndPrune::insert(const AxisAlignedBoundingBox &box)
+	{
+		int id;
+		if (!free_ids.empty())
+		{
+			id = free_ids.back();
+			free_ids.pop_back();
+			boxes[id] = box;
+			alive[id] = 1;
+		}
+		else
+		{
+			id = (int)boxes.size();
+			boxes.push_back(box);
+			alive.push_back(1);
+		}
+
+		// The new proxy goes at the end and is moved into place by the next sort
+		order.push_back(id);
+		order_dirty = true;
+		order_membership_dirty = true;
+		count++;
+		return id;
+	}
+
+	void SweepAndPrune::update(int id, const AxisAlignedBoundingBox &box)
+	{
+		boxes[id] = box;
+		order_dirty = true;
+	}
+
+	void SweepAndPrune::remove(int id)
+	{
+		// The id is dropped from the order by the next sort
+		alive[id] = 0;
+		free_ids.push_back(id);
+		order_dirty = true;
+		order_membership_dirty = true;
+		count--;
+	}
+
+	void SweepAndPrune::clear()
+	{
+		boxes.clear();
+		alive.clear();
+		free_ids.clear();
+		order.clear();
+		sorted_ids.clear();
+		count = 0;
+		order_dirty = true;
+		order_membership_dirty = false;
+	}
+
+	void SweepAndPrune::query(const AxisAlignedBoundingBox &box, std::vector<int> &out_ids)
+	{
+		sort();
+
+		SweepArrays arrays = { min_x.data(), max_x.data(), min_y.data(), max_y.data(), min_z.data(), max_z.data(), count };
+		for (int index = 0; index < count; index += 4)
+		{
+			unsigned int x_mask;
+			unsigned int mask = sweep_overlap_mask(arrays, index, box, x_mask);
+			while (mask)
+			{
+				int lane = sweep_lowest_bit(mask);
+				out_ids.push_back(sorted_ids[index + lane]);
+				mask &= mask - 1;
+			}
+
+			// Everything after a box starting past the end of the query box starts even later
+			if (x_mask != 15)
+				break;
+		}
+	}
+
+	void SweepAndPrune::query_ray(const Vec3f &ray_start, const Vec3f &ray_end, std::vector<int> &out_ids)
+	{
+		size_t first = out_ids.size();
+		AxisAlignedBoundingBox ray_box(
+			Vec3f(std::min(ray_start.x, ray_end.x), std::min(ray_start.y, ray_end.y), std::min(ray_start.z, ray_end.z)),
+			Vec3f(std::max(ray_start.x, ray_end.x), std::max(ray_start.y, ray_end.y), std::max(ray_start.z, ray_end.z)));
+		query(ray_box, out_ids);
+
+		auto it = std::remove_if(out_ids.begin() + first, out_ids.end(), [&](int id)
+		{
+			return IntersectionTest::ray_aabb(ray_start, ray_end, boxes[id]) == IntersectionTest::disjoint;
+		});
+		out_ids.erase(it, out_ids.end());
+	}
+
+	void SweepAndPrune::query_frustum(const FrustumPlanes &frustum, std::vector<int> &out_ids)
+	{
+		sort();
+
+		SweepArrays arrays = { min_x.data(), max_x.data(), min_y.data(), max_y.data(), min_z.data(), max_z.data(), count };
+		for (int index = 0; index < count; index += 4)
+		{
+			unsigned int mask = sweep_frustum_mask(arrays, index, frustum);
+			while (mask)
+			{
+				int lane = sweep_lowest_bit(mask);
+				out_ids.push_back(sorted_ids[index + lane]);
+				mask &= mask - 1;
+			}
+		}
+	}
+
+	void SweepAndPrune::find_pairs(std::vector<BroadphasePair> &out_pairs)
+	{
+		sort();
+		sweep(0, count, out_pairs);
+	}
+
+	void SweepAndPrune::find_pairs(WorkQueue &queue, std::vector<BroadphasePair> &out_pairs)
+	{
+		sort();
+		broadphase_parallel_pairs(queue, count, out_pairs, [this](int first, int last, std::vector<BroadphasePair> &pairs)
+		{
+			sweep(first, last, pairs);
+		});
+	}
+
+	void SweepAndPrune::sweep(int first, int last, std::vector<BroadphasePair> &out_pairs) const
+	{
+		SweepArrays arrays = { min_x.data(), max_x.data(), min_y.data(), max_y.data(), min_z.data(), max_z.data(), count };
+		for (int i = first; i < last; i++)
+		{
+			AxisAlignedBoundingBox box(Vec3f(min_x[i], min_y[i], min_z[i]), Vec3f(max_x[i], max_y[i], max_z[i]));
+			int id = sorted_ids[i];
+
+			// Only boxes later in the order are tested, so every pair is found once
+			for (int index = i + 1; index < count; index += 4)
+			{
+				unsigned int x_mask;
+				unsigned int mask = sweep_overlap_mask(arrays, index, box, x_mask);
+				while (mask)
+				{
+					int other_id = sorted_ids[index + sweep_lowest_bit(mask)];
+					out_pairs.push_back(id < other_id ? BroadphasePair(id, other_id) : BroadphasePair(other_id, id));
+					mask &= mask - 1;
+				}
+
+				if (x_mask != 15)
+					break;
+			}
+		}
+	}
+
+	void SweepAndPrune::sort()
+	{
+		if (!order_dirty)
+			return;
+
+		if (order_membership_dirty)
+		{
+			// Drop removed proxies, and the older entry of any id that was removed and inserted again
+			std::vector<unsigned char> seen(boxes.size());
+			size_t size = 0;
+			for (int id : order)
+			{
+				if (alive[id] && !seen[id])
+				{
+					seen[id] = 1;
+					order[size++] = id;
+				}
+			}
+			order.resize(size);
+		}
+
+		// Insertion sort is close to linear when the boxes moved a little since the last sort.
+		// Give up and sort from scratch if it turns out not to be.
+		size_t max_moves = order.size() * 8 + 64;
+		size_t moves = 0;
+		for (size_t i = 1; i < order.size() && moves <= max_moves; i++)
+		{
+			int id = order[i];
+			float key = boxes[id].aabb_min.x;
+			size_t j = i;
+			while (j > 0 && boxes[order[j - 1]].aabb_min.x > key)
+			{
+				order[j] = order[j - 1];
+				j--;
+			}
+			order[j] = id;
+			moves += i - j;
+		}
+		if (moves > max_moves)
+		{
+			std::sort(order.begin(), order.end(), [this](int a, int b) { return boxes[a].aabb_min.x < boxes[b].aabb_min.x; });
+		}
+
+		size_t padded_size = order.size() + sweep_padding;
+		min_x.resize(padded_size);
+		max_x.resize(padded_size);
+		min_y.resize(padded_size);
+		max_y.resize(padded_size);
+		min_z.resize(padded_size);
+		max_z.resize(padded_size);
+		sorted_ids.resize(padded_size);
+		for (size_t i = 0; i < order.size(); i++)
+		{
+			int id = order[i];
+			const AxisAlignedBoundingBox &box = boxes[id];
+			min_x[i] = box.aabb_min.x;
+			max_x[i] = box.aabb_max.x;
+			min_y[i] = box.aabb_min.y;
+			max_y[i] = box.aabb_max.y;
+			min_z[i] = box.aabb_min.z;
+			max_z[i] = box.aabb_max.z;
+			sorted_ids[i] = id;
+		}
+		for (size_t i = order.size(); i < padded_size; i++)
+		{
+			min_x[i] = max_x[i] = min_y[i] = max_y[i] = min_z[i] = max_z[i] = 0.0f;
+			sorted_ids[i] = -1;
+		}
+
+		order_dirty = false;
+		order_membership_dirty = false;
+	}
+}
@@ -0,0 +1,162 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "Core/precomp.h"
+#include "API/Core/System/allocation_tracker.h"
+#include <atomic>
+
+namespace clan
+{
+	namespace
+	{
+		struct AllocationCounters
+		{
+			std::atomic<int64_t> bytes;
+			std::atomic<int64_t> allocations;
+			std::atomic<uint64_t> total_allocations;
+			std::atomic<uint64_t> total_bytes;
+		};
+
+		AllocationCounters counters[num_allocation_tags];
+		std::atomic<uint64_t> frame_allocations;
+		std::atomic<AllocationHook *> hook;
+	}
+
+	int64_t AllocationSnapshot::get_total_bytes() const
+	{
+		int64_t total = 0;
+		for (int64_t bytes_in_tag : bytes)
+			total += bytes_in_tag;
+		return total;
+	}
+
+	uint64_t AllocationSnapshot::get_total_allocations() const
+	{
+		uint64_t total = 0;
+		for (uint64_t allocations_in_tag : total_allocations)
+			total += allocations_in_tag;
+		return total;
+	}
+
+	AllocationSnapshot AllocationSnapshot::operator-(const AllocationSnapshot &earlier) const
+	{
+		AllocationSnapshot diff;
+		for (int i = 0; i < num_allocation_tags; i++)
+		{
+			diff.bytes[i] = bytes[i] - earlier.bytes[i];
+			diff.allocations[i] = allocations[i] - earlier.allocations[i];
+			diff.total_allocations[i] = total_allocations[i] - earlier.total_allocations[i];
+			diff.total_bytes[i] = total_bytes[i] - earlier.total_bytes[i];
+		}
+		return diff;
+	}
+
+	bool AllocationTracker::enabled = false;
+
+	void AllocationTracker::set_enabled(bool enable)
+	{
+		enabled = enable;
+	}
+
+	void AllocationTracker::set_hook(AllocationHook *new_hook)
+	{
+		hook.store(new_hook);
+	}
+
+	AllocationSnapshot AllocationTracker::get_snapshot()
+	{
+		AllocationSnapshot snapshot;
+		for (int i = 0; i < num_allocation_tags; i++)
+		{
+			snapshot.bytes[i] = counters[i].bytes.load(std::memory_order_relaxed);
+			snapshot.allocations[i] = counters[i].allocations.load(std::memory_order_relaxed);
+			snapshot.total_allocations[i] = counters[i].total_allocations.load(std::memory_order_relaxed);
+			snapshot.total_bytes[i] = counters[i].total_bytes.load(std::memory_order_relaxed);
+		}
+		return snapshot;
+	}
+
+	uint64_t AllocationTracker::frame_mark()
+	{
+		return frame_allocations.exchange(0, std::memory_order_relaxed);
+	}
+
+	uint64_t AllocationTracker::get_frame_allocations()
+	{
+		return frame_allocations.load(std::memory_order_relaxed);
+	}
+
+	const char *AllocationTracker::get_tag_name(AllocationTag tag)
+	{
+		switch (tag)
+		{
+		case allocation_tag_other: return "other";
+		case allocation_tag_block_allocator: return "block_allocator";
+		case allocation_tag_data_buffer: return "data_buffer";
+		case allocation_tag_xml: return "xml";
+		case allocation_tag_pixel_buffer: return "pixel_buffer";
+		case allocation_tag_json: return "json";
+		case allocation_tag_gpu: return "gpu";
+		default: return "unknown";
+		}
+	}
+
+	void AllocationTracker::record_allocate(AllocationTag tag, const void *ptr, size_t bytes)
+	{
+		AllocationCounters &c = counters[tag];
+		c.bytes.fetch_add((int64_t)bytes, std::memory_order_relaxed);
+		c.allocations.fetch_add(1, std::memory_order_relaxed);
+		c.total_allocations.fetch_add(1, std::memory_order_relaxed);
+		c.total_bytes.fetch_add(bytes, std::memory_order_relaxed);
+		frame_allocations.fetch_add(1, std::memory_order_relaxed);
+
+		AllocationHook *current_hook = hook.load();
+		if (current_hook)
+			current_hook->on_allocate(tag, ptr, bytes);
+	}
+
+	void AllocationTracker::record_free(AllocationTag tag, const void *ptr, size_t bytes)
+	{
+		AllocationCounters &c = counters[tag];
+		c.bytes.fetch_sub((int64_t)bytes, std::memory_order_relaxed);
+		c.allocations.fetch_sub(1, std::memory_order_relaxed);
+
+		AllocationHook *current_hook = hook.load();
+		if (current_hook)
+			current_hook->on_free(tag, ptr, bytes);
+	}
+
+	void AllocationTracker::record_count(AllocationTag tag, uint64_t allocations, size_t bytes)
+	{
+		AllocationCounters &c = counters[tag];
+		c.total_allocations.fetch_add(allocations, std::memory_order_relaxed);
+		c.total_bytes.fetch_add(bytes, std::memory_order_relaxed);
+		frame_allocations.fetch_add(allocations, std::memory_order_relaxed);
+	}
+}
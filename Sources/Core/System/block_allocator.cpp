@@ -31,13 +31,32 @@
 #include "API/Core/System/databuffer.h"
 #include "API/Core/Math/cl_math.h"
 #include <vector>
+#include <cstdint>
 
 namespace clan
 {
 	class BlockAllocator_Impl
 	{
 	public:
-		std::vector<DataBuffer> blocks;
+		struct Block
+		{
+			DataBuffer buffer;
+			char *data;		// Start of the block, 16 byte aligned
+			unsigned int size;
+		};
+
+		void add_block(unsigned int size)
+		{
+			// The heap only guarantees 8 byte alignment on some platforms, so the start of the block is aligned by hand
+			Block block;
+			block.buffer.set_allocation_tag(allocation_tag_block_allocator);
+			block.buffer.set_size(size + 15);
+			block.data = reinterpret_cast<char *>((reinterpret_cast<uintptr_t>(block.buffer.get_data()) + 15) & ~static_cast<uintptr_t>(15));
+			block.size = size;
+			blocks.push_back(block);
+		}
+
+		std::vector<Block> blocks;
 		int block_pos = 0;
 	};
 
@@ -48,18 +67,20 @@ namespace clan
 
 	void *BlockAllocator::allocate(int size)
 	{
+		size = (size + 15) & ~15; // Keep all allocations 16 byte aligned
+
 		if (impl->blocks.empty())
-			impl->blocks.push_back(DataBuffer(size * 10));
-		DataBuffer &cur = impl->blocks.back();
-		if (impl->block_pos + size <= cur.get_size())
+			impl->add_block(size * 10);
+		BlockAllocator_Impl::Block &cur = impl->blocks.back();
+		if (impl->block_pos + size <= (int)cur.size)
 		{
-			void *data = cur.get_data() + impl->block_pos;
+			void *data = cur.data + impl->block_pos;
 			impl->block_pos += size;
 			return data;
 		}
-		impl->blocks.push_back(DataBuffer(max(cur.get_size() * 2, size)));
+		impl->add_block(max(cur.size * 2, (unsigned int)size));
 		impl->block_pos = size;
-		return impl->blocks.back().get_data();
+		return impl->blocks.back().data;
 	}
 
 	void BlockAllocator::free()
@@ -68,6 +89,14 @@ namespace clan
 		impl->block_pos = 0;
 	}
 
+	void BlockAllocator::reset()
+	{
+		// The last block is always the largest one
+		if (impl->blocks.size() > 1)
+			impl->blocks.erase(impl->blocks.begin(), impl->blocks.end() - 1);
+		impl->block_pos = 0;
+	}
+
 	void *BlockAllocated::operator new(size_t size, BlockAllocator *allocator)
 	{
 		return allocator->allocate(size);
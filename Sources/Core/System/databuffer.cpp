@@ -41,13 +41,36 @@ namespace clan
 
 		~DataBuffer_Impl()
 		{
-			delete[] data;
+			free_data(data);
+		}
+
+		void free_data(char *old_data)
+		{
+			if (release)
+			{
+				release();
+				release = std::function<void()>();
+			}
+			else if (old_data)
+			{
+				AllocationTracker::free(tag, old_data, allocated_size);
+				delete[] old_data;
+			}
+		}
+
+		char *allocate_data(unsigned int new_size)
+		{
+			char *new_data = new char[new_size];
+			AllocationTracker::allocate(tag, new_data, new_size);
+			return new_data;
 		}
 
 	public:
 		char *data;
 		unsigned int size;
 		unsigned int allocated_size;
+		std::function<void()> release;	// Set when data is wrapped memory not allocated by the buffer
+		AllocationTag tag = allocation_tag_data_buffer;
 	};
 
 	DataBuffer::DataBuffer()
@@ -79,6 +102,16 @@ namespace clan
 	{
 	}
 
+	DataBuffer DataBuffer::wrap(void *data, unsigned int size, const std::function<void()> &release)
+	{
+		DataBuffer buffer;
+		buffer.impl->data = static_cast<char*>(data);
+		buffer.impl->size = size;
+		buffer.impl->allocated_size = size;
+		buffer.impl->release = release;
+		return buffer;
+	}
+
 	char *DataBuffer::get_data()
 	{
 		return impl->data;
@@ -130,9 +163,9 @@ namespace clan
 		if (new_size > impl->allocated_size)
 		{
 			char *old_data = impl->data;
-			impl->data = new char[new_size];
+			impl->data = impl->allocate_data(new_size);
 			memcpy(impl->data, old_data, impl->size);
-			delete[] old_data;
+			impl->free_data(old_data);
 			memset(impl->data + impl->size, 0, new_size - impl->size);
 			impl->size = new_size;
 			impl->allocated_size = new_size;
@@ -148,14 +181,24 @@ namespace clan
 		if (new_capacity > impl->allocated_size)
 		{
 			char *old_data = impl->data;
-			impl->data = new char[new_capacity];
+			impl->data = impl->allocate_data(new_capacity);
 			memcpy(impl->data, old_data, impl->size);
-			delete[] old_data;
+			impl->free_data(old_data);
 			memset(impl->data + impl->size, 0, new_capacity - impl->size);
 			impl->allocated_size = new_capacity;
 		}
 	}
 
+	void DataBuffer::set_allocation_tag(AllocationTag tag)
+	{
+		if (impl->data && !impl->release)
+		{
+			AllocationTracker::free(impl->tag, impl->data, impl->allocated_size);
+			AllocationTracker::allocate(tag, impl->data, impl->allocated_size);
+		}
+		impl->tag = tag;
+	}
+
 	bool DataBuffer::is_null() const
 	{
 		return impl->size == 0;
@@ -42,7 +42,7 @@
 namespace clan
 {
 #ifndef WIN32
-	const int64_t DateTime::ticks_from_1601_to_1900 = 94354848000000000LL;
+	const int64_t DateTime::ticks_from_1601_to_1900 = 116444736000000000LL; // Despite the name, this is the offset to the Unix epoch (1970)
 #endif
 
 	DateTime::DateTime()
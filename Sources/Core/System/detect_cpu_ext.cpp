@@ -54,6 +54,8 @@ namespace clan
 
 #define __cpuid(out, infoType)\
 	asm("cpuid": "=a" ((out)[0]), "=b" ((out)[1]), "=c" ((out)[2]), "=d" ((out)[3]): "a" (infoType));
+#define __cpuidex(out, infoType, subType)\
+	asm("cpuid": "=a" ((out)[0]), "=b" ((out)[1]), "=c" ((out)[2]), "=d" ((out)[3]): "a" (infoType), "c" (subType));
 #else
 
 #define __cpuid(out, infoType) \
@@ -63,6 +65,13 @@ namespace clan
 			"popl %%ebx" \
 		: "=a" ((out)[0]), "=r" ((out)[1]), "=c" ((out)[2]), "=d" ((out)[3]): "a" (infoType));
 
+#define __cpuidex(out, infoType, subType) \
+	asm volatile(	"pushl %%ebx \n" \
+			"cpuid \n" \
+			"movl %%ebx, %1 \n" \
+			"popl %%ebx" \
+		: "=a" ((out)[0]), "=r" ((out)[1]), "=c" ((out)[2]), "=d" ((out)[3]): "a" (infoType), "c" (subType));
+
 #endif
 
 #endif
@@ -181,6 +190,29 @@ namespace clan
 			__cpuid((int*)cpuinfo, 0x80000001);
 			return ((cpuinfo[2] & (1 << 16)) != 0);
 		}
+		else if (ext == avx2)
+		{
+			__cpuid((int*)cpuinfo, 0x0);
+			if (cpuinfo[0] < 0x7)
+				return false;
+
+			__cpuidex((int*)cpuinfo, 0x7, 0x0);
+			return ((cpuinfo[1] & (1 << 5)) != 0);
+		}
+		else if (ext == sha)
+		{
+			__cpuid((int*)cpuinfo, 0x0);
+			if (cpuinfo[0] < 0x7)
+				return false;
+
+			__cpuidex((int*)cpuinfo, 0x7, 0x0);
+			return ((cpuinfo[1] & (1 << 29)) != 0);
+		}
+		else if (ext == f16c)
+		{
+			__cpuid((int*)cpuinfo, 0x1);
+			return ((cpuinfo[2] & (1 << 29)) != 0);
+		}
 		return false;
 	}
 
@@ -0,0 +1,196 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Core/precomp.h"
+#include "API/Core/System/pool_allocator.h"
+#include "API/Core/System/system.h"
+#include "API/Core/System/thread_local_storage.h"
+#include "API/Core/Math/cl_math.h"
+#include <mutex>
+#include <vector>
+
+namespace clan
+{
+	class PoolAllocator_Impl
+	{
+	public:
+		enum
+		{
+			granularity = 16,
+			num_size_classes = PoolAllocator::max_pooled_size / granularity,
+			batch_size = 32,
+			chunk_size = 64 * 1024
+		};
+
+		struct FreeBlock
+		{
+			FreeBlock *next;
+		};
+
+		struct Batch
+		{
+			Batch(FreeBlock *head, int count) : head(head), count(count) { }
+			FreeBlock *head;
+			int count;
+		};
+
+		struct SizeClass
+		{
+			std::mutex mutex;
+			std::vector<Batch> free_batches;
+		};
+
+		static PoolAllocator_Impl *get();
+
+		static int get_size_class(size_t size) { return (int)((size + granularity - 1) / granularity) - 1; }
+		static size_t get_class_size(int size_class) { return (size_class + 1) * granularity; }
+
+		void refill(int size_class);
+		void drain(int size_class, int count);
+
+		SizeClass size_classes[num_size_classes];
+		std::mutex chunks_mutex;
+		std::vector<void *> chunks;
+
+		static cl_tls_variable FreeBlock *cache_heads[num_size_classes];
+		static cl_tls_variable int cache_counts[num_size_classes];
+	};
+
+	cl_tls_variable PoolAllocator_Impl::FreeBlock *PoolAllocator_Impl::cache_heads[PoolAllocator_Impl::num_size_classes];
+	cl_tls_variable int PoolAllocator_Impl::cache_counts[PoolAllocator_Impl::num_size_classes];
+
+	void *PoolAllocator::allocate(size_t size)
+	{
+		if (size == 0)
+			size = 1;
+		if (size > max_pooled_size)
+			return System::aligned_alloc(size, PoolAllocator_Impl::granularity);
+
+		int size_class = PoolAllocator_Impl::get_size_class(size);
+		if (!PoolAllocator_Impl::cache_heads[size_class])
+			PoolAllocator_Impl::get()->refill(size_class);
+
+		PoolAllocator_Impl::FreeBlock *block = PoolAllocator_Impl::cache_heads[size_class];
+		PoolAllocator_Impl::cache_heads[size_class] = block->next;
+		PoolAllocator_Impl::cache_counts[size_class]--;
+		return block;
+	}
+
+	void PoolAllocator::free(void *data, size_t size)
+	{
+		if (!data)
+			return;
+		if (size == 0)
+			size = 1;
+		if (size > max_pooled_size)
+		{
+			System::aligned_free(data);
+			return;
+		}
+
+		int size_class = PoolAllocator_Impl::get_size_class(size);
+		PoolAllocator_Impl::FreeBlock *block = static_cast<PoolAllocator_Impl::FreeBlock*>(data);
+		block->next = PoolAllocator_Impl::cache_heads[size_class];
+		PoolAllocator_Impl::cache_heads[size_class] = block;
+
+		if (++PoolAllocator_Impl::cache_counts[size_class] >= PoolAllocator_Impl::batch_size * 2)
+			PoolAllocator_Impl::get()->drain(size_class, PoolAllocator_Impl::batch_size);
+	}
+
+	void PoolAllocator::flush_thread_cache()
+	{
+		PoolAllocator_Impl *impl = PoolAllocator_Impl::get();
+		for (int i = 0; i < PoolAllocator_Impl::num_size_classes; i++)
+		{
+			if (PoolAllocator_Impl::cache_counts[i] > 0)
+				impl->drain(i, PoolAllocator_Impl::cache_counts[i]);
+		}
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	PoolAllocator_Impl *PoolAllocator_Impl::get()
+	{
+		// Intentionally never freed. Blocks may be released during static destruction.
+		static PoolAllocator_Impl *impl = new PoolAllocator_Impl();
+		return impl;
+	}
+
+	void PoolAllocator_Impl::refill(int size_class)
+	{
+		SizeClass &sc = size_classes[size_class];
+		std::unique_lock<std::mutex> lock(sc.mutex);
+		if (sc.free_batches.empty())
+		{
+			lock.unlock();
+
+			// Carve a new chunk into batches for this size class
+			char *chunk = static_cast<char*>(System::aligned_alloc(chunk_size, granularity));
+			std::unique_lock<std::mutex> chunks_lock(chunks_mutex);
+			chunks.push_back(chunk);
+			chunks_lock.unlock();
+
+			size_t block_size = get_class_size(size_class);
+			int num_blocks = (int)(chunk_size / block_size);
+			std::vector<Batch> batches;
+			for (int start = 0; start < num_blocks; start += batch_size)
+			{
+				int count = clan::min((int)batch_size, num_blocks - start);
+				for (int i = 0; i < count - 1; i++)
+					reinterpret_cast<FreeBlock*>(chunk + (start + i) * block_size)->next = reinterpret_cast<FreeBlock*>(chunk + (start + i + 1) * block_size);
+				reinterpret_cast<FreeBlock*>(chunk + (start + count - 1) * block_size)->next = nullptr;
+				batches.push_back(Batch(reinterpret_cast<FreeBlock*>(chunk + start * block_size), count));
+			}
+
+			lock.lock();
+			sc.free_batches.insert(sc.free_batches.end(), batches.begin(), batches.end());
+		}
+
+		Batch batch = sc.free_batches.back();
+		sc.free_batches.pop_back();
+		lock.unlock();
+
+		cache_heads[size_class] = batch.head;
+		cache_counts[size_class] = batch.count;
+	}
+
+	void PoolAllocator_Impl::drain(int size_class, int count)
+	{
+		FreeBlock *head = cache_heads[size_class];
+		FreeBlock *tail = head;
+		for (int i = 1; i < count; i++)
+			tail = tail->next;
+		cache_heads[size_class] = tail->next;
+		cache_counts[size_class] -= count;
+		tail->next = nullptr;
+
+		SizeClass &sc = size_classes[size_class];
+		std::unique_lock<std::mutex> lock(sc.mutex);
+		sc.free_batches.push_back(Batch(head, count));
+	}
+}
@@ -0,0 +1,302 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "Core/precomp.h"
+#include "API/Core/System/profiler.h"
+#include "API/Core/System/system.h"
+#include "API/Core/System/thread_local_storage.h"
+#include "API/Core/JSON/json_value.h"
+#include "API/Core/IOData/file.h"
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace clan
+{
+	class Profiler_Impl
+	{
+	public:
+		enum { chunk_size = 1024 };
+
+		enum EventType
+		{
+			type_begin,
+			type_end,
+			type_instant,
+			type_complete
+		};
+
+		struct Event
+		{
+			const char *name;
+			const char *track;
+			uint64_t start;
+			uint64_t end;
+			EventType type;
+		};
+
+		// Only the owning thread appends events. Readers see events up to the published count.
+		struct Chunk
+		{
+			Chunk() : count(0), next(nullptr) { }
+
+			Event events[chunk_size];
+			std::atomic_int count;
+			std::atomic<Chunk*> next;
+		};
+
+		struct ThreadBuffer
+		{
+			ThreadBuffer(int thread_index) : thread_index(thread_index), first(nullptr), first_skip(0), last(nullptr) { }
+
+			int thread_index;
+			std::string name;
+
+			// Read side state, protected by Profiler_Impl::mutex
+			Chunk *first;
+			int first_skip;
+
+			// Write side state, only touched by the owning thread
+			Chunk *last;
+		};
+
+		static Profiler_Impl *get()
+		{
+			// Intentionally leaked so threads still running at exit can keep recording
+			static Profiler_Impl *instance = new Profiler_Impl();
+			return instance;
+		}
+
+		ThreadBuffer *get_thread_buffer()
+		{
+			if (!current_buffer)
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				buffers.push_back(new ThreadBuffer((int)buffers.size() + 1));
+				current_buffer = buffers.back();
+			}
+			return current_buffer;
+		}
+
+		void add_event(const char *name, const char *track, uint64_t start, uint64_t end, EventType type)
+		{
+			ThreadBuffer *buffer = get_thread_buffer();
+			Chunk *chunk = buffer->last;
+			if (!chunk)
+			{
+				// The first chunk is allocated on the first event so naming a thread does not cost a chunk
+				std::unique_lock<std::mutex> lock(mutex);
+				chunk = new Chunk();
+				buffer->first = chunk;
+				buffer->last = chunk;
+			}
+
+			int count = chunk->count.load(std::memory_order_relaxed);
+			if (count == chunk_size)
+			{
+				Chunk *new_chunk = new Chunk();
+				chunk->next.store(new_chunk, std::memory_order_release);
+				buffer->last = new_chunk;
+				chunk = new_chunk;
+				count = 0;
+			}
+
+			Event &e = chunk->events[count];
+			e.name = name;
+			e.track = track;
+			e.start = start;
+			e.end = end;
+			e.type = type;
+			chunk->count.store(count + 1, std::memory_order_release);
+		}
+
+		void clear()
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			for (auto buffer : buffers)
+			{
+				if (!buffer->first)
+					continue;
+
+				// Chunks that have a successor are full and no longer referenced by the writer
+				while (true)
+				{
+					Chunk *next = buffer->first->next.load(std::memory_order_acquire);
+					if (!next)
+						break;
+					delete buffer->first;
+					buffer->first = next;
+				}
+				buffer->first_skip = buffer->first->count.load(std::memory_order_acquire);
+			}
+		}
+
+		JsonValue to_chrome_trace()
+		{
+			JsonValue events = JsonValue::array();
+			std::map<std::string, int> tracks;
+
+			std::unique_lock<std::mutex> lock(mutex);
+			for (auto buffer : buffers)
+			{
+				JsonValue thread_name = JsonValue::object();
+				thread_name.prop("name") = JsonValue::string("thread_name");
+				thread_name.prop("ph") = JsonValue::string("M");
+				thread_name.prop("pid") = JsonValue::number(0);
+				thread_name.prop("tid") = JsonValue::number(buffer->thread_index);
+				JsonValue args = JsonValue::object();
+				args.prop("name") = JsonValue::string(buffer->name.empty() ? "Thread " + std::to_string(buffer->thread_index) : buffer->name);
+				thread_name.prop("args") = args;
+				events.items().push_back(thread_name);
+
+				int skip = buffer->first_skip;
+				for (Chunk *chunk = buffer->first; chunk; chunk = chunk->next.load(std::memory_order_acquire))
+				{
+					int count = chunk->count.load(std::memory_order_acquire);
+					for (int i = skip; i < count; i++)
+					{
+						const Event &e = chunk->events[i];
+
+						JsonValue item = JsonValue::object();
+						item.prop("pid") = JsonValue::number(0);
+						item.prop("tid") = JsonValue::number(buffer->thread_index);
+						item.prop("ts") = JsonValue::number((double)e.start);
+						switch (e.type)
+						{
+						case type_begin:
+							item.prop("name") = JsonValue::string(e.name);
+							item.prop("ph") = JsonValue::string("B");
+							break;
+						case type_end:
+							item.prop("ph") = JsonValue::string("E");
+							break;
+						case type_instant:
+							item.prop("name") = JsonValue::string(e.name);
+							item.prop("ph") = JsonValue::string("i");
+							item.prop("s") = JsonValue::string("p");
+							break;
+						case type_complete:
+						{
+							auto it = tracks.find(e.track);
+							if (it == tracks.end())
+								it = tracks.insert(std::make_pair(std::string(e.track), (int)(-1 - tracks.size()))).first;
+							item.prop("tid") = JsonValue::number(it->second);
+							item.prop("name") = JsonValue::string(e.name);
+							item.prop("ph") = JsonValue::string("X");
+							item.prop("dur") = JsonValue::number((double)(e.end - e.start));
+							break;
+						}
+						}
+						events.items().push_back(item);
+					}
+					skip = 0;
+				}
+			}
+			lock.unlock();
+
+			for (auto &track : tracks)
+			{
+				JsonValue track_name = JsonValue::object();
+				track_name.prop("name") = JsonValue::string("thread_name");
+				track_name.prop("ph") = JsonValue::string("M");
+				track_name.prop("pid") = JsonValue::number(0);
+				track_name.prop("tid") = JsonValue::number(track.second);
+				JsonValue args = JsonValue::object();
+				args.prop("name") = JsonValue::string(track.first);
+				track_name.prop("args") = args;
+				events.items().push_back(track_name);
+			}
+
+			JsonValue trace = JsonValue::object();
+			trace.prop("traceEvents") = events;
+			trace.prop("displayTimeUnit") = JsonValue::string("ms");
+			return trace;
+		}
+
+		std::mutex mutex;
+		std::vector<ThreadBuffer *> buffers;
+
+		static cl_tls_variable ThreadBuffer *current_buffer;
+	};
+
+	cl_tls_variable Profiler_Impl::ThreadBuffer *Profiler_Impl::current_buffer = nullptr;
+
+	bool Profiler::enabled = false;
+
+	void Profiler::set_enabled(bool enable)
+	{
+		enabled = enable;
+	}
+
+	void Profiler::begin_zone(const char *name)
+	{
+		Profiler_Impl::get()->add_event(name, nullptr, System::get_microseconds(), 0, Profiler_Impl::type_begin);
+	}
+
+	void Profiler::end_zone()
+	{
+		Profiler_Impl::get()->add_event(nullptr, nullptr, System::get_microseconds(), 0, Profiler_Impl::type_end);
+	}
+
+	void Profiler::add_zone(const char *track, const char *name, uint64_t start_microseconds, uint64_t end_microseconds)
+	{
+		if (enabled)
+			Profiler_Impl::get()->add_event(name, track, start_microseconds, end_microseconds, Profiler_Impl::type_complete);
+	}
+
+	void Profiler::frame_mark()
+	{
+		if (enabled)
+			Profiler_Impl::get()->add_event("Frame", nullptr, System::get_microseconds(), 0, Profiler_Impl::type_instant);
+	}
+
+	void Profiler::set_thread_name(const std::string &name)
+	{
+		Profiler_Impl *impl = Profiler_Impl::get();
+		Profiler_Impl::ThreadBuffer *buffer = impl->get_thread_buffer();
+		std::unique_lock<std::mutex> lock(impl->mutex);
+		buffer->name = name;
+	}
+
+	void Profiler::clear()
+	{
+		Profiler_Impl::get()->clear();
+	}
+
+	JsonValue Profiler::to_chrome_trace()
+	{
+		return Profiler_Impl::get()->to_chrome_trace();
+	}
+
+	void Profiler::save_chrome_trace(const std::string &filename)
+	{
+		File::write_text(filename, to_chrome_trace().to_json());
+	}
+}
@@ -0,0 +1,176 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Core/precomp.h"
+#include "API/Core/System/task_graph.h"
+#include "API/Core/System/work_queue.h"
+#include <atomic>
+#include <mutex>
+
+namespace clan
+{
+	class Task_Impl : public std::enable_shared_from_this<Task_Impl>
+	{
+	public:
+		Task_Impl(const std::shared_ptr<WorkQueue> &queue, const std::function<void()> &func, bool main_thread)
+			: queue(queue), func(func), main_thread(main_thread), unfinished_dependencies(1), finished(false)
+		{
+		}
+
+		static Task create(const std::shared_ptr<WorkQueue> &queue, const std::function<void()> &func, bool main_thread, const std::vector<Task> &dependencies);
+
+		void add_dependency(const std::shared_ptr<Task_Impl> &dependency);
+		void dependency_finished();
+		void run();
+		void finish();
+
+		std::shared_ptr<WorkQueue> queue;
+		std::function<void()> func;
+		bool main_thread;
+
+		std::atomic_int unfinished_dependencies;
+		std::atomic_bool finished;
+
+		std::mutex mutex;
+		std::vector<std::shared_ptr<Task_Impl>> dependents;
+	};
+
+	Task::Task()
+	{
+	}
+
+	Task::Task(const std::shared_ptr<Task_Impl> &impl) : impl(impl)
+	{
+	}
+
+	bool Task::is_done() const
+	{
+		return !impl || impl->finished.load(std::memory_order_acquire);
+	}
+
+	Task Task::then(const std::function<void()> &func) const
+	{
+		return Task_Impl::create(impl->queue, func, false, { *this });
+	}
+
+	Task Task::then_main(const std::function<void()> &func) const
+	{
+		return Task_Impl::create(impl->queue, func, true, { *this });
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	TaskGraph::TaskGraph(const WorkQueue &queue) : queue(std::make_shared<WorkQueue>(queue))
+	{
+	}
+
+	Task TaskGraph::run(const std::function<void()> &func, const std::vector<Task> &dependencies) const
+	{
+		return Task_Impl::create(queue, func, false, dependencies);
+	}
+
+	Task TaskGraph::run_main(const std::function<void()> &func, const std::vector<Task> &dependencies) const
+	{
+		return Task_Impl::create(queue, func, true, dependencies);
+	}
+
+	Task TaskGraph::when_all(const std::vector<Task> &tasks) const
+	{
+		return Task_Impl::create(queue, std::function<void()>(), false, tasks);
+	}
+
+	void TaskGraph::wait(const Task &task) const
+	{
+		queue->wait_until([&]() { return task.is_done(); });
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	Task Task_Impl::create(const std::shared_ptr<WorkQueue> &queue, const std::function<void()> &func, bool main_thread, const std::vector<Task> &dependencies)
+	{
+		auto task = std::make_shared<Task_Impl>(queue, func, main_thread);
+
+		// The initial count of one keeps the task from starting before all dependencies have been added
+		for (const auto &dependency : dependencies)
+		{
+			if (!dependency.is_null())
+				task->add_dependency(dependency.impl);
+		}
+		task->dependency_finished();
+
+		return Task(task);
+	}
+
+	void Task_Impl::add_dependency(const std::shared_ptr<Task_Impl> &dependency)
+	{
+		std::unique_lock<std::mutex> lock(dependency->mutex);
+		if (!dependency->finished.load(std::memory_order_relaxed))
+		{
+			unfinished_dependencies.fetch_add(1, std::memory_order_relaxed);
+			dependency->dependents.push_back(shared_from_this());
+		}
+	}
+
+	void Task_Impl::dependency_finished()
+	{
+		if (unfinished_dependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			run();
+	}
+
+	void Task_Impl::run()
+	{
+		auto self = shared_from_this();
+		if (!func)
+		{
+			// when_all join nodes have no work of their own
+			finish();
+		}
+		else if (main_thread)
+		{
+			queue->work_completed([self]() { self->func(); self->finish(); });
+		}
+		else
+		{
+			queue->queue([self]() { self->func(); self->finish(); });
+		}
+	}
+
+	void Task_Impl::finish()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		finished.store(true, std::memory_order_release);
+		std::vector<std::shared_ptr<Task_Impl>> ready;
+		ready.swap(dependents);
+		lock.unlock();
+
+		func = std::function<void()>(); // Release anything captured by the task
+
+		for (auto &dependent : ready)
+			dependent->dependency_finished();
+	}
+}
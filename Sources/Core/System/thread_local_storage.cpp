@@ -31,10 +31,13 @@
 #include "thread_local_storage_impl.h"
 #include "setup_core.h"
 #include "tls_instance.h"
+#include <mutex>
+#include <vector>
 
 namespace clan
 {
 	ThreadLocalStorage_Instance *ThreadLocalStorage::instance = nullptr;
+	cl_tls_variable ThreadLocalStorageData *ThreadLocalStorage::slot_values[ThreadLocalStorage::max_slots];
 
 	ThreadLocalStorage::ThreadLocalStorage()
 	{
@@ -121,42 +124,59 @@ namespace clan
 			throw Exception("No ThreadLocalStorage instance");
 	}
 
-	std::shared_ptr<ThreadLocalStorageData> ThreadLocalStorage::get_variable(const std::string &name)
+	ThreadLocalStorage_Impl *ThreadLocalStorage::get_tls_impl()
 	{
 		init_core();
 
 #ifdef WIN32
 		if (instance->cl_tls_index == TLS_OUT_OF_INDEXES)
 			throw Exception("No ThreadLocalStorage object created for this thread.");
-		ThreadLocalStorage_Impl *tls_impl = (ThreadLocalStorage_Impl *)TlsGetValue(instance->cl_tls_index);
+		ThreadLocalStorage_Impl *tls_impl = static_cast<ThreadLocalStorage_Impl *>(TlsGetValue(instance->cl_tls_index));
 #elif !defined(HAVE_TLS)
 		if (!instance->cl_tls_index_created)
 			throw Exception("No ThreadLocalStorage object created for this thread.");
-		ThreadLocalStorage_Impl *tls_impl = (ThreadLocalStorage_Impl *) pthread_getspecific(instance->cl_tls_index);
+		ThreadLocalStorage_Impl *tls_impl = static_cast<ThreadLocalStorage_Impl *>(pthread_getspecific(instance->cl_tls_index));
 #else
 		ThreadLocalStorage_Impl *tls_impl = instance->cl_tls_impl;
 #endif
 		if (tls_impl == nullptr)
 			throw Exception("No ThreadLocalStorage object created for this thread.");
-		return tls_impl->get_variable(name);
+		return tls_impl;
+	}
+
+	std::shared_ptr<ThreadLocalStorageData> ThreadLocalStorage::get_variable(const std::string &name)
+	{
+		return get_tls_impl()->get_variable(name);
 	}
 
 	void ThreadLocalStorage::set_variable(const std::string &name, std::shared_ptr<ThreadLocalStorageData> ptr)
 	{
-		init_core();
-#ifdef WIN32
-		if (instance->cl_tls_index == TLS_OUT_OF_INDEXES)
-			throw Exception("No ThreadLocalStorage object created for this thread.");
-		ThreadLocalStorage_Impl *tls_impl = static_cast<ThreadLocalStorage_Impl *>(TlsGetValue(instance->cl_tls_index));
-#elif !defined(HAVE_TLS)
-		if (!instance->cl_tls_index_created)
-			throw Exception("No ThreadLocalStorage object created for this thread.");
-		ThreadLocalStorage_Impl *tls_impl = static_cast<ThreadLocalStorage_Impl *>(pthread_getspecific(instance->cl_tls_index));
-#else
-		ThreadLocalStorage_Impl *tls_impl = instance->cl_tls_impl;
-#endif
-		if (tls_impl == nullptr)
-			throw Exception("No ThreadLocalStorage object created for this thread.");
-		tls_impl->set_variable(name, ptr);
+		get_tls_impl()->set_variable(name, ptr);
+	}
+
+	int ThreadLocalStorage::register_slot(const std::string &name)
+	{
+		static std::mutex mutex;
+		static std::vector<std::string> names;
+
+		std::unique_lock<std::mutex> lock(mutex);
+		for (size_t i = 0; i < names.size(); i++)
+		{
+			if (names[i] == name)
+				return (int)i;
+		}
+
+		if (names.size() == max_slots)
+			throw Exception("Too many ThreadLocalStorage slots registered");
+
+		names.push_back(name);
+		return (int)names.size() - 1;
+	}
+
+	void ThreadLocalStorage::set_slot(int key, std::shared_ptr<ThreadLocalStorageData> ptr)
+	{
+		if (key < 0 || key >= max_slots)
+			throw Exception("Invalid ThreadLocalStorage slot");
+		get_tls_impl()->set_slot(key, std::move(ptr));
 	}
 }
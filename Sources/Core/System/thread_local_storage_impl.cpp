@@ -38,6 +38,9 @@ namespace clan
 
 	ThreadLocalStorage_Impl::~ThreadLocalStorage_Impl()
 	{
+		// The last reference is released by the thread owning the storage
+		for (int i = 0; i < ThreadLocalStorage::max_slots; i++)
+			ThreadLocalStorage::slot_values[i] = nullptr;
 	}
 
 	std::shared_ptr<ThreadLocalStorageData> ThreadLocalStorage_Impl::get_variable(const std::string &name)
@@ -54,6 +57,12 @@ namespace clan
 		data[name] = ptr;
 	}
 
+	void ThreadLocalStorage_Impl::set_slot(int key, std::shared_ptr<ThreadLocalStorageData> ptr)
+	{
+		ThreadLocalStorage::slot_values[key] = ptr.get();
+		slots[key] = std::move(ptr);
+	}
+
 	void ThreadLocalStorage_Impl::add_reference()
 	{
 		reference_count++;
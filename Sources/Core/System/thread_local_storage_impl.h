@@ -46,11 +46,13 @@ namespace clan
 		std::shared_ptr<ThreadLocalStorageData> get_variable(const std::string &name);
 
 		void set_variable(const std::string &name, std::shared_ptr<ThreadLocalStorageData> ptr);
+		void set_slot(int key, std::shared_ptr<ThreadLocalStorageData> ptr);
 		void add_reference();
 		void release_reference();
 
 	protected:
 		int reference_count;
 		std::map<std::string, std::shared_ptr<ThreadLocalStorageData> > data;
+		std::shared_ptr<ThreadLocalStorageData> slots[ThreadLocalStorage::max_slots];
 	};
 }
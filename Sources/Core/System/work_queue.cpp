@@ -1,214 +1,643 @@
-/*
-**  ClanLib SDK
-**  Copyright (c) 1997-2015 The ClanLib Team
-**
-**  This software is provided 'as-is', without any express or implied
-**  warranty.  In no event will the authors be held liable for any damages
-**  arising from the use of this software.
-**
-**  Permission is granted to anyone to use this software for any purpose,
-**  including commercial applications, and to alter it and redistribute it
-**  freely, subject to the following restrictions:
-**
-**  1. The origin of this software must not be misrepresented; you must not
-**     claim that you wrote the original software. If you use this software
-**     in a product, an acknowledgment in the product documentation would be
-**     appreciated but is not required.
-**  2. Altered source versions must be plainly marked as such, and must not be
-**     misrepresented as being the original software.
-**  3. This notice may not be removed or altered from any source distribution.
-**
-**  Note: Some of the libraries ClanLib may link to may have additional
-**  requirements or restrictions.
-**
-**  File Author(s):
-**
-**    Magnus Norddahl
-*/
-
-#include "Core/precomp.h"
-#include "API/Core/System/work_queue.h"
-#include "API/Core/System/system.h"
-#include <algorithm>
-#include "API/Core/Math/cl_math.h"
-#include <atomic>
-#include <thread>
-#include <condition_variable>
-
-namespace clan
-{
-	class WorkItemProcess : public WorkItem
-	{
-	public:
-		WorkItemProcess(const std::function<void()> &func) : func(func) { }
-
-		void process_work() override { func(); }
-
-	private:
-		std::function<void()> func;
-	};
-
-	class WorkItemWorkCompleted : public WorkItem
-	{
-	public:
-		WorkItemWorkCompleted(const std::function<void()> &func) : func(func) { }
-
-		void process_work() override { }
-		void work_completed() override { func(); }
-
-	private:
-		std::function<void()> func;
-	};
-
-	class WorkQueue_Impl
-	{
-	public:
-		WorkQueue_Impl(bool serial_queue);
-		~WorkQueue_Impl();
-
-		void queue(WorkItem *item); // transfers ownership
-		void work_completed(WorkItem *item); // transfers ownership
-
-		int get_items_queued() const { return items_queued; }
-
-		void process_work_completed();
-
-	private:
-		void worker_main();
-
-		bool serial_queue = false;
-		std::vector<std::thread> threads;
-		std::mutex mutex;
-		std::condition_variable worker_event;
-		bool stop_flag = false;
-		std::vector<WorkItem *> queued_items;
-		std::vector<WorkItem *> finished_items;
-		std::atomic_int items_queued;
-	};
-
-	WorkQueue::WorkQueue(bool serial_queue)
-		: impl(std::make_shared<WorkQueue_Impl>(serial_queue))
-	{
-	}
-
-	WorkQueue::~WorkQueue()
-	{
-	}
-
-	void WorkQueue::queue(WorkItem *item) // transfers ownership
-	{
-		impl->queue(item);
-	}
-
-	void WorkQueue::queue(const std::function<void()> &func)
-	{
-		impl->queue(new WorkItemProcess(func));
-	}
-
-	void WorkQueue::work_completed(const std::function<void()> &func)
-	{
-		impl->work_completed(new WorkItemWorkCompleted(func));
-	}
-
-	int WorkQueue::get_items_queued() const
-	{
-		return impl->get_items_queued();
-	}
-
-	void WorkQueue::process_work_completed()
-	{
-		impl->process_work_completed();
-	}
-
-	/////////////////////////////////////////////////////////////////////////////
-
-	WorkQueue_Impl::WorkQueue_Impl(bool serial_queue)
-		: serial_queue(serial_queue)
-	{
-	}
-
-	WorkQueue_Impl::~WorkQueue_Impl()
-	{
-		std::unique_lock<std::mutex> mutex_lock(mutex);
-		stop_flag = true;
-		mutex_lock.unlock();
-		worker_event.notify_all();
-
-		for (auto & elem : threads)
-			elem.join();
-		for (auto & elem : queued_items)
-			delete elem;
-		for (auto & elem : finished_items)
-			delete elem;
-	}
-
-	void WorkQueue_Impl::queue(WorkItem *item) // transfers ownership
-	{
-		if (threads.empty())
-		{
-			int num_cores = serial_queue ? 1 : clan::max(System::get_num_cores() - 1, 1);
-			for (int i = 0; i < num_cores; i++)
-			{
-				threads.push_back(std::thread(&WorkQueue_Impl::worker_main, this));
-			}
-		}
-
-		std::unique_lock<std::mutex> mutex_lock(mutex);
-		queued_items.push_back(item);
-		++items_queued;
-		mutex_lock.unlock();
-		worker_event.notify_one();
-	}
-
-	void WorkQueue_Impl::work_completed(WorkItem *item) // transfers ownership
-	{
-		std::unique_lock<std::mutex> mutex_lock(mutex);
-		finished_items.push_back(item);
-		++items_queued;
-	}
-
-	void WorkQueue_Impl::process_work_completed()
-	{
-		std::unique_lock<std::mutex> mutex_lock(mutex);
-		std::vector<WorkItem *> items;
-		items.swap(finished_items);
-		mutex_lock.unlock();
-		for (size_t i = 0; i < items.size(); i++)
-		{
-			try
-			{
-				items[i]->work_completed();
-			}
-			catch (...)
-			{
-				mutex_lock.lock();
-				finished_items.insert(finished_items.begin(), items.begin() + i, items.end());
-				throw;
-			}
-			delete items[i];
-			--items_queued;
-		}
-	}
-
-	void WorkQueue_Impl::worker_main()
-	{
-		while (true)
-		{
-			std::unique_lock<std::mutex> mutex_lock(mutex);
-			worker_event.wait(mutex_lock, [&]() { return stop_flag || !queued_items.empty(); });
-
-			if (stop_flag)
-				break;
-
-			WorkItem *item = queued_items.front();
-			queued_items.erase(queued_items.begin());
-			mutex_lock.unlock();
-
-			item->process_work();
-
-			mutex_lock.lock();
-			finished_items.push_back(item);
-			mutex_lock.unlock();
-		}
-	}
-}
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Core/precomp.h"
+#include "API/Core/System/work_queue.h"
+#include "API/Core/System/system.h"
+#include "API/Core/System/thread_local_storage.h"
+#include "API/Core/System/pool_allocator.h"
+#include <algorithm>
+#include "API/Core/Math/cl_math.h"
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include "work_stealing_deque.h"
+
+namespace clan
+{
+	class WorkItemFunction : public WorkItem
+	{
+	public:
+		void process_work() override;
+
+		void work_completed() override
+		{
+			if (completion)
+				func();
+		}
+
+		WorkFunction func;
+		WorkGroup *group = nullptr;
+		bool completion = false;
+		WorkItemFunction *next_free = nullptr;
+
+	private:
+		bool has_work_completed() const override { return completion; }
+		void release() override;
+	};
+
+	/// \brief Recycles function work items through thread local caches
+	///
+	/// Items are allocated in slabs and moved between the thread caches and a global free list in batches,
+	/// so the global lock is only taken once per batch_size items.
+	class WorkItemPool
+	{
+	public:
+		static WorkItemFunction *alloc();
+		static void free(WorkItemFunction *item);
+
+		/// \brief Returns the items cached by the calling thread to the global free list
+		static void flush_thread_cache();
+
+	private:
+		enum { batch_size = 64 };
+
+		struct Batch
+		{
+			Batch(WorkItemFunction *head, int count) : head(head), count(count) { }
+			WorkItemFunction *head;
+			int count;
+		};
+
+		struct Global
+		{
+			std::mutex mutex;
+			std::vector<Batch> free_batches;
+			std::vector<std::unique_ptr<WorkItemFunction[]>> slabs;
+		};
+
+		static Global *get_global();
+
+		static cl_tls_variable WorkItemFunction *cache_head;
+		static cl_tls_variable int cache_count;
+	};
+
+	class WorkQueue_Impl
+	{
+	public:
+		WorkQueue_Impl(bool serial_queue, bool work_stealing);
+		~WorkQueue_Impl();
+
+		void queue(WorkItem *item); // transfers ownership
+		void queue(WorkGroup &group, WorkFunction &&func);
+		void wait(WorkGroup &group);
+		void wait_until(const std::function<bool()> &condition);
+		void work_completed(WorkItem *item); // transfers ownership
+
+		int get_items_queued() const { return items_queued; }
+		int get_worker_count();
+		int get_grain_size(int count, int grain);
+		void parallel_for(int begin, int end, int grain, const std::function<void(int first, int last)> &func);
+
+		void process_work_completed();
+
+		static void leave_group(WorkGroup &group) { group.pending.fetch_sub(1, std::memory_order_acq_rel); }
+
+	private:
+		void start_threads();
+		void worker_main(int worker_index);
+		bool is_worker_thread() const { return current_queue == this; }
+
+		WorkItem *find_work();
+		WorkItem *find_work_shared();
+		WorkItem *find_work_stealing();
+		void process_item(WorkItem *item);
+		WorkItem *pop_queued_item();
+
+		bool serial_queue = false;
+		bool work_stealing = false;
+		std::once_flag threads_started;
+		std::vector<std::thread> threads;
+		std::mutex mutex;
+		std::condition_variable worker_event;
+		bool stop_flag = false;
+		std::vector<WorkItem *> queued_items;
+		size_t queued_items_head = 0;
+		std::atomic_int items_queued;
+
+		std::mutex finished_mutex;
+		std::vector<WorkItem *> finished_items;
+		std::vector<WorkItem *> completing_items;
+
+		// Work stealing mode: one deque per worker. Items queued from other threads go into queued_items.
+		std::vector<std::unique_ptr<WorkStealingDeque<WorkItem>>> deques;
+		std::atomic_int items_pending;
+		std::atomic_int workers_sleeping;
+
+		static cl_tls_variable WorkQueue_Impl *current_queue;
+		static cl_tls_variable int current_worker;
+	};
+
+	cl_tls_variable WorkQueue_Impl *WorkQueue_Impl::current_queue = nullptr;
+	cl_tls_variable int WorkQueue_Impl::current_worker = -1;
+
+	cl_tls_variable WorkItemFunction *WorkItemPool::cache_head = nullptr;
+	cl_tls_variable int WorkItemPool::cache_count = 0;
+
+	void WorkItemFunction::process_work()
+	{
+		if (!completion)
+		{
+			func();
+			if (group)
+				WorkQueue_Impl::leave_group(*group);
+		}
+	}
+
+	void WorkItemFunction::release()
+	{
+		func.clear();
+		group = nullptr;
+		completion = false;
+		WorkItemPool::free(this);
+	}
+
+	WorkQueue::WorkQueue(bool serial_queue, bool work_stealing)
+		: impl(std::make_shared<WorkQueue_Impl>(serial_queue, work_stealing))
+	{
+	}
+
+	WorkQueue::~WorkQueue()
+	{
+	}
+
+	void WorkQueue::queue(WorkItem *item) // transfers ownership
+	{
+		impl->queue(item);
+	}
+
+	void WorkQueue::queue(WorkFunction func)
+	{
+		WorkItemFunction *item = WorkItemPool::alloc();
+		item->func = std::move(func);
+		impl->queue(item);
+	}
+
+	void WorkQueue::queue(WorkGroup &group, WorkFunction func)
+	{
+		impl->queue(group, std::move(func));
+	}
+
+	void WorkQueue::wait(WorkGroup &group)
+	{
+		impl->wait(group);
+	}
+
+	void WorkQueue::wait_until(const std::function<bool()> &condition)
+	{
+		impl->wait_until(condition);
+	}
+
+	void WorkQueue::work_completed(WorkFunction func)
+	{
+		WorkItemFunction *item = WorkItemPool::alloc();
+		item->func = std::move(func);
+		item->completion = true;
+		impl->work_completed(item);
+	}
+
+	void WorkQueue::parallel_for(int begin, int end, int grain, const std::function<void(int first, int last)> &func)
+	{
+		impl->parallel_for(begin, end, grain, func);
+	}
+
+	int WorkQueue::get_worker_count() const
+	{
+		return impl->get_worker_count();
+	}
+
+	int WorkQueue::get_grain_size(int count, int grain) const
+	{
+		return impl->get_grain_size(count, grain);
+	}
+
+	int WorkQueue::get_items_queued() const
+	{
+		return impl->get_items_queued();
+	}
+
+	void WorkQueue::process_work_completed()
+	{
+		impl->process_work_completed();
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	WorkQueue_Impl::WorkQueue_Impl(bool serial_queue, bool work_stealing)
+		: serial_queue(serial_queue), work_stealing(work_stealing && !serial_queue), items_queued(0), items_pending(0), workers_sleeping(0)
+	{
+	}
+
+	WorkQueue_Impl::~WorkQueue_Impl()
+	{
+		std::unique_lock<std::mutex> mutex_lock(mutex);
+		stop_flag = true;
+		mutex_lock.unlock();
+		worker_event.notify_all();
+
+		for (auto & elem : threads)
+			elem.join();
+		for (size_t i = queued_items_head; i < queued_items.size(); i++)
+			queued_items[i]->release();
+		for (auto & deque : deques)
+		{
+			while (WorkItem *item = deque->pop())
+				item->release();
+		}
+		for (auto & elem : finished_items)
+			elem->release();
+	}
+
+	void WorkQueue_Impl::start_threads()
+	{
+		std::call_once(threads_started, [&]()
+		{
+			int num_cores = serial_queue ? 1 : clan::max(System::get_num_cores() - 1, 1);
+			if (work_stealing)
+			{
+				for (int i = 0; i < num_cores; i++)
+					deques.push_back(std::unique_ptr<WorkStealingDeque<WorkItem>>(new WorkStealingDeque<WorkItem>()));
+			}
+			for (int i = 0; i < num_cores; i++)
+			{
+				threads.push_back(std::thread(&WorkQueue_Impl::worker_main, this, i));
+			}
+		});
+	}
+
+	void WorkQueue_Impl::queue(WorkItem *item) // transfers ownership
+	{
+		start_threads();
+
+		++items_queued;
+
+		if (work_stealing)
+		{
+			if (is_worker_thread())
+			{
+				deques[current_worker]->push(item);
+			}
+			else
+			{
+				std::unique_lock<std::mutex> mutex_lock(mutex);
+				queued_items.push_back(item);
+			}
+
+			items_pending.fetch_add(1, std::memory_order_seq_cst);
+			if (workers_sleeping.load(std::memory_order_seq_cst) > 0)
+			{
+				// Taking the mutex guarantees the sleeping worker is inside wait() before we notify it
+				std::unique_lock<std::mutex> mutex_lock(mutex);
+				mutex_lock.unlock();
+				worker_event.notify_one();
+			}
+		}
+		else
+		{
+			std::unique_lock<std::mutex> mutex_lock(mutex);
+			queued_items.push_back(item);
+			mutex_lock.unlock();
+			worker_event.notify_one();
+		}
+	}
+
+	void WorkQueue_Impl::queue(WorkGroup &group, WorkFunction &&func)
+	{
+		WorkItemFunction *item = WorkItemPool::alloc();
+		item->func = std::move(func);
+		item->group = &group;
+		group.pending.fetch_add(1, std::memory_order_acq_rel);
+		queue(item);
+	}
+
+	void WorkQueue_Impl::wait(WorkGroup &group)
+	{
+		wait_until([&]() { return group.is_done(); });
+	}
+
+	void WorkQueue_Impl::wait_until(const std::function<bool()> &condition)
+	{
+		// A serial queue only allows its own worker to execute items
+		bool can_help = !serial_queue || is_worker_thread();
+
+		while (!condition())
+		{
+			WorkItem *item = can_help ? find_work() : nullptr;
+			if (item)
+				process_item(item);
+			else
+				std::this_thread::yield();
+		}
+	}
+
+	int WorkQueue_Impl::get_worker_count()
+	{
+		start_threads();
+		return (int)threads.size();
+	}
+
+	int WorkQueue_Impl::get_grain_size(int count, int grain)
+	{
+		if (grain > 0)
+			return grain;
+
+		// Aim for a few sub ranges per thread so faster threads can pick up the slack of slower ones
+		int num_threads = get_worker_count() + 1;
+		return clan::max(count / (num_threads * 4), 1);
+	}
+
+	void WorkQueue_Impl::parallel_for(int begin, int end, int grain, const std::function<void(int first, int last)> &func)
+	{
+		if (end <= begin)
+			return;
+
+		int grain_size = get_grain_size(end - begin, grain);
+		int num_chunks = (end - begin + grain_size - 1) / grain_size;
+		if (num_chunks == 1)
+		{
+			func(begin, end);
+			return;
+		}
+
+		// Sub ranges are claimed from a shared counter, so only one helper item per worker needs to be queued
+		std::atomic_int next_chunk(0);
+		auto process_chunks = [&]()
+		{
+			while (true)
+			{
+				int chunk = next_chunk.fetch_add(1, std::memory_order_relaxed);
+				if (chunk >= num_chunks)
+					break;
+				int first = begin + chunk * grain_size;
+				int last = (end - first > grain_size) ? first + grain_size : end;
+				func(first, last);
+			}
+		};
+
+		WorkGroup group;
+		int num_helpers = clan::min(get_worker_count(), num_chunks - 1);
+		for (int i = 0; i < num_helpers; i++)
+			queue(group, WorkFunction([&]() { process_chunks(); }));
+
+		process_chunks();
+		wait(group);
+	}
+
+	void WorkQueue_Impl::work_completed(WorkItem *item) // transfers ownership
+	{
+		std::unique_lock<std::mutex> mutex_lock(finished_mutex);
+		finished_items.push_back(item);
+		++items_queued;
+	}
+
+	void WorkQueue_Impl::process_work_completed()
+	{
+		// completing_items keeps its capacity between calls to avoid reallocating every frame
+		std::vector<WorkItem *> &items = completing_items;
+		std::unique_lock<std::mutex> mutex_lock(finished_mutex);
+		items.swap(finished_items);
+		mutex_lock.unlock();
+		for (size_t i = 0; i < items.size(); i++)
+		{
+			try
+			{
+				items[i]->work_completed();
+			}
+			catch (...)
+			{
+				mutex_lock.lock();
+				finished_items.insert(finished_items.begin(), items.begin() + i, items.end());
+				mutex_lock.unlock();
+				items.clear();
+				throw;
+			}
+			items[i]->release();
+			--items_queued;
+		}
+		items.clear();
+	}
+
+	WorkItem *WorkQueue_Impl::find_work()
+	{
+		return work_stealing ? find_work_stealing() : find_work_shared();
+	}
+
+	WorkItem *WorkQueue_Impl::find_work_shared()
+	{
+		std::unique_lock<std::mutex> mutex_lock(mutex);
+		return pop_queued_item();
+	}
+
+	WorkItem *WorkQueue_Impl::pop_queued_item()
+	{
+		// Must be called with the mutex locked
+		if (queued_items_head == queued_items.size())
+			return nullptr;
+
+		WorkItem *item = queued_items[queued_items_head++];
+		if (queued_items_head == queued_items.size())
+		{
+			queued_items.clear();
+			queued_items_head = 0;
+		}
+		return item;
+	}
+
+	WorkItem *WorkQueue_Impl::find_work_stealing()
+	{
+		if (items_pending.load(std::memory_order_acquire) == 0)
+			return nullptr;
+
+		WorkItem *item = nullptr;
+
+		int self = is_worker_thread() ? current_worker : -1;
+		if (self != -1)
+			item = deques[self]->pop();
+
+		if (!item)
+		{
+			std::unique_lock<std::mutex> mutex_lock(mutex);
+			item = pop_queued_item();
+		}
+
+		if (!item)
+		{
+			int count = (int)deques.size();
+			int start = self != -1 ? self + 1 : 0;
+			for (int i = 0; i < count && !item; i++)
+			{
+				int victim = (start + i) % count;
+				if (victim != self)
+					item = deques[victim]->steal();
+			}
+		}
+
+		if (item)
+			items_pending.fetch_sub(1, std::memory_order_acq_rel);
+		return item;
+	}
+
+	void WorkQueue_Impl::process_item(WorkItem *item)
+	{
+		item->process_work();
+
+		if (item->has_work_completed())
+		{
+			std::unique_lock<std::mutex> mutex_lock(finished_mutex);
+			finished_items.push_back(item);
+		}
+		else
+		{
+			item->release();
+			--items_queued;
+		}
+	}
+
+	void WorkQueue_Impl::worker_main(int worker_index)
+	{
+		current_queue = this;
+		current_worker = worker_index;
+
+		while (true)
+		{
+			if (work_stealing)
+			{
+				WorkItem *item = find_work_stealing();
+				if (item)
+				{
+					process_item(item);
+					continue;
+				}
+
+				std::unique_lock<std::mutex> mutex_lock(mutex);
+				workers_sleeping.fetch_add(1, std::memory_order_seq_cst);
+				worker_event.wait(mutex_lock, [&]() { return stop_flag || items_pending.load(std::memory_order_seq_cst) > 0; });
+				workers_sleeping.fetch_sub(1, std::memory_order_seq_cst);
+
+				if (stop_flag)
+					break;
+			}
+			else
+			{
+				std::unique_lock<std::mutex> mutex_lock(mutex);
+				worker_event.wait(mutex_lock, [&]() { return stop_flag || queued_items_head != queued_items.size(); });
+
+				if (stop_flag)
+					break;
+
+				WorkItem *item = pop_queued_item();
+				mutex_lock.unlock();
+
+				process_item(item);
+			}
+		}
+
+		WorkItemPool::flush_thread_cache();
+		PoolAllocator::flush_thread_cache();
+		current_queue = nullptr;
+		current_worker = -1;
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	WorkItemPool::Global *WorkItemPool::get_global()
+	{
+		// Intentionally never freed so that WorkQueues destroyed during static destruction can still return items
+		static Global *global = new Global();
+		return global;
+	}
+
+	WorkItemFunction *WorkItemPool::alloc()
+	{
+		if (!cache_head)
+		{
+			Global *global = get_global();
+			std::unique_lock<std::mutex> lock(global->mutex);
+			if (!global->free_batches.empty())
+			{
+				Batch batch = global->free_batches.back();
+				global->free_batches.pop_back();
+				cache_head = batch.head;
+				cache_count = batch.count;
+			}
+			else
+			{
+				WorkItemFunction *slab = new WorkItemFunction[batch_size];
+				global->slabs.push_back(std::unique_ptr<WorkItemFunction[]>(slab));
+				lock.unlock();
+
+				for (int i = 0; i < batch_size - 1; i++)
+					slab[i].next_free = &slab[i + 1];
+				slab[batch_size - 1].next_free = nullptr;
+				cache_head = slab;
+				cache_count = batch_size;
+			}
+		}
+
+		WorkItemFunction *item = cache_head;
+		cache_head = item->next_free;
+		cache_count--;
+		item->next_free = nullptr;
+		return item;
+	}
+
+	void WorkItemPool::free(WorkItemFunction *item)
+	{
+		item->next_free = cache_head;
+		cache_head = item;
+		cache_count++;
+
+		// Items tend to be allocated on one thread and freed on another. Hand a batch back once the cache grows too large.
+		if (cache_count >= batch_size * 2)
+		{
+			WorkItemFunction *batch_head = cache_head;
+			WorkItemFunction *batch_tail = cache_head;
+			for (int i = 1; i < batch_size; i++)
+				batch_tail = batch_tail->next_free;
+			cache_head = batch_tail->next_free;
+			cache_count -= batch_size;
+			batch_tail->next_free = nullptr;
+
+			Global *global = get_global();
+			std::unique_lock<std::mutex> lock(global->mutex);
+			global->free_batches.push_back(Batch(batch_head, batch_size));
+		}
+	}
+
+	void WorkItemPool::flush_thread_cache()
+	{
+		if (cache_head)
+		{
+			Global *global = get_global();
+			std::unique_lock<std::mutex> lock(global->mutex);
+			global->free_batches.push_back(Batch(cache_head, cache_count));
+			cache_head = nullptr;
+			cache_count = 0;
+		}
+	}
+}
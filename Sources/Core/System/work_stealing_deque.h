@@ -0,0 +1,149 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+namespace clan
+{
+	/// \brief Lock-free Chase-Lev work stealing deque
+	///
+	/// The owning thread pushes and pops at the bottom, any other thread may steal from the top.
+	template<typename T>
+	class WorkStealingDeque
+	{
+	public:
+		WorkStealingDeque(int initial_capacity = 256) : top(0), bottom(0)
+		{
+			arrays.push_back(std::unique_ptr<Array>(new Array(initial_capacity)));
+			array.store(arrays.back().get(), std::memory_order_relaxed);
+		}
+
+		/// \brief Push an item at the bottom. Must only be called by the owner thread.
+		void push(T *item)
+		{
+			int64_t b = bottom.load(std::memory_order_relaxed);
+			int64_t t = top.load(std::memory_order_acquire);
+			Array *a = array.load(std::memory_order_relaxed);
+			if (b - t > a->capacity - 1)
+				a = grow(a, b, t);
+			a->put(b, item);
+			std::atomic_thread_fence(std::memory_order_release);
+			bottom.store(b + 1, std::memory_order_relaxed);
+		}
+
+		/// \brief Pop an item from the bottom. Must only be called by the owner thread.
+		T *pop()
+		{
+			int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+			Array *a = array.load(std::memory_order_relaxed);
+			bottom.store(b, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			int64_t t = top.load(std::memory_order_relaxed);
+
+			T *item = nullptr;
+			if (t <= b)
+			{
+				item = a->get(b);
+				if (t == b)
+				{
+					// Last item - race against thieves
+					if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+						item = nullptr;
+					bottom.store(b + 1, std::memory_order_relaxed);
+				}
+			}
+			else
+			{
+				bottom.store(b + 1, std::memory_order_relaxed);
+			}
+			return item;
+		}
+
+		/// \brief Steal an item from the top. May be called by any thread.
+		T *steal()
+		{
+			int64_t t = top.load(std::memory_order_acquire);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			int64_t b = bottom.load(std::memory_order_acquire);
+
+			if (t < b)
+			{
+				Array *a = array.load(std::memory_order_acquire);
+				T *item = a->get(t);
+				if (top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+					return item;
+			}
+			return nullptr;
+		}
+
+		/// \brief Approximate number of items in the deque
+		int64_t size() const
+		{
+			int64_t b = bottom.load(std::memory_order_relaxed);
+			int64_t t = top.load(std::memory_order_relaxed);
+			return b > t ? b - t : 0;
+		}
+
+	private:
+		struct Array
+		{
+			Array(int64_t capacity) : capacity(capacity), mask(capacity - 1), items(new std::atomic<T*>[capacity]) { }
+
+			T *get(int64_t index) const { return items[index & mask].load(std::memory_order_relaxed); }
+			void put(int64_t index, T *item) { items[index & mask].store(item, std::memory_order_relaxed); }
+
+			int64_t capacity;
+			int64_t mask;
+			std::unique_ptr<std::atomic<T*>[]> items;
+		};
+
+		Array *grow(Array *a, int64_t b, int64_t t)
+		{
+			// Old arrays are kept alive until the deque is destroyed since thieves may still be reading from them
+			arrays.push_back(std::unique_ptr<Array>(new Array(a->capacity * 2)));
+			Array *new_array = arrays.back().get();
+			for (int64_t i = t; i < b; i++)
+				new_array->put(i, a->get(i));
+			array.store(new_array, std::memory_order_release);
+			return new_array;
+		}
+
+		std::atomic<int64_t> top;
+		std::atomic<int64_t> bottom;
+		std::atomic<Array*> array;
+		std::vector<std::unique_ptr<Array>> arrays;
+
+		WorkStealingDeque(const WorkStealingDeque &) = delete;
+		WorkStealingDeque &operator=(const WorkStealingDeque &) = delete;
+	};
+}
@@ -0,0 +1,235 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Core/precomp.h"
+#include "API/Core/Text/async_log_queue.h"
+#include "API/Core/Text/logger.h"
+#include "API/Core/System/system.h"
+#include "API/Core/System/datetime.h"
+#include "API/Core/System/exception.h"
+#include "async_log_queue_impl.h"
+#include <thread>
+#include <condition_variable>
+
+namespace clan
+{
+	std::atomic<AsyncLogQueue_Impl *> AsyncLogQueue_Impl::active(nullptr);
+	std::atomic_int AsyncLogQueue_Impl::active_producers(0);
+
+	AsyncLogQueue::AsyncLogQueue(int capacity, OverflowPolicy policy, int flush_interval_ms)
+		: impl(std::make_shared<AsyncLogQueue_Impl>(capacity, policy, flush_interval_ms))
+	{
+		AsyncLogQueue_Impl *expected = nullptr;
+		if (!AsyncLogQueue_Impl::active.compare_exchange_strong(expected, impl.get()))
+		{
+			impl->stop();
+			throw Exception("Only one AsyncLogQueue can be active at a time");
+		}
+	}
+
+	AsyncLogQueue::~AsyncLogQueue()
+	{
+		AsyncLogQueue_Impl::active.store(nullptr);
+
+		// Wait for threads still inside log_event to finish pushing their records
+		while (AsyncLogQueue_Impl::active_producers.load() != 0)
+			std::this_thread::yield();
+
+		impl->stop();
+	}
+
+	void AsyncLogQueue::flush()
+	{
+		impl->flush();
+	}
+
+	int AsyncLogQueue::get_dropped_count() const
+	{
+		return impl->dropped.load(std::memory_order_relaxed);
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	AsyncLogQueue_Impl::AsyncLogQueue_Impl(int capacity, AsyncLogQueue::OverflowPolicy policy, int flush_interval_ms)
+		: dropped(0), policy(policy), flush_interval_ms(flush_interval_ms), enqueue_pos(0), dequeue_pos(0), reported_dropped(0)
+	{
+		size_t size = 2;
+		while (size < (size_t)capacity)
+			size <<= 1;
+		cells = std::vector<Cell>(size);
+		mask = size - 1;
+		for (size_t i = 0; i < size; i++)
+			cells[i].sequence.store(i, std::memory_order_relaxed);
+
+		thread = std::thread(&AsyncLogQueue_Impl::thread_main, this);
+	}
+
+	AsyncLogQueue_Impl::~AsyncLogQueue_Impl()
+	{
+		stop();
+	}
+
+	bool AsyncLogQueue_Impl::try_push(const std::string &type, const std::string &text, uint64_t timestamp)
+	{
+		size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+		while (true)
+		{
+			Cell &cell = cells[pos & mask];
+			size_t sequence = cell.sequence.load(std::memory_order_acquire);
+			intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+			if (diff == 0)
+			{
+				if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				{
+					// The strings keep their capacity between uses of the cell, so this rarely allocates
+					cell.type.assign(type);
+					cell.text.assign(text);
+					cell.timestamp = timestamp;
+					cell.sequence.store(pos + 1, std::memory_order_release);
+
+					if (((pos + 1) & (mask >> 1)) == 0)
+						wakeup_event.notify_one(); // Half a queue since the last wakeup - don't wait for the flush interval
+					return true;
+				}
+			}
+			else if (diff < 0)
+			{
+				return false; // Queue is full
+			}
+			else
+			{
+				pos = enqueue_pos.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	void AsyncLogQueue_Impl::push(const std::string &type, const std::string &text)
+	{
+		uint64_t timestamp = System::get_microseconds();
+		while (!try_push(type, text, timestamp))
+		{
+			if (policy == AsyncLogQueue::overflow_drop)
+			{
+				dropped.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+			wakeup_event.notify_one();
+			std::this_thread::yield();
+		}
+	}
+
+	int AsyncLogQueue_Impl::write_batch()
+	{
+		int count = 0;
+
+		// Convert the monotonic record time stamps to wall clock time
+		int64_t now_ticks = DateTime::get_current_utc_time().to_ticks();
+		uint64_t now_microseconds = System::get_microseconds();
+
+		std::unique_lock<std::recursive_mutex> mutex_lock(Logger::mutex);
+		while (count < max_batch_size)
+		{
+			size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+			Cell &cell = cells[pos & mask];
+			size_t sequence = cell.sequence.load(std::memory_order_acquire);
+			if ((intptr_t)sequence - (intptr_t)(pos + 1) < 0)
+				break; // Queue is empty
+
+			int64_t age_ticks = (int64_t)(now_microseconds - cell.timestamp) * 10;
+			Logger::record_ticks = now_ticks - age_ticks;
+			for (auto &instance : Logger::instances)
+				instance->log(cell.type, cell.text);
+
+			dequeue_pos.store(pos + 1, std::memory_order_relaxed);
+			cell.sequence.store(pos + mask + 1, std::memory_order_release);
+			count++;
+		}
+
+		int total_dropped = dropped.load(std::memory_order_relaxed);
+		if (total_dropped != reported_dropped)
+		{
+			Logger::record_ticks = now_ticks;
+			std::string text = StringHelp::int_to_text(total_dropped - reported_dropped) + " log records dropped";
+			for (auto &instance : Logger::instances)
+				instance->log("log", text);
+			reported_dropped = total_dropped;
+		}
+		Logger::record_ticks = 0;
+
+		return count;
+	}
+
+	void AsyncLogQueue_Impl::thread_main()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		while (true)
+		{
+			lock.unlock();
+			int written = write_batch();
+			lock.lock();
+
+			if (written > 0)
+			{
+				flushed_event.notify_all();
+				if (written == max_batch_size)
+					continue;
+			}
+
+			if (stop_flag)
+				break;
+
+			wakeup_event.wait_for(lock, std::chrono::milliseconds(flush_interval_ms));
+		}
+	}
+
+	void AsyncLogQueue_Impl::flush()
+	{
+		size_t target = enqueue_pos.load();
+		std::unique_lock<std::mutex> lock(mutex);
+		wakeup_event.notify_one();
+		while (dequeue_pos.load() < target && thread.joinable())
+			flushed_event.wait_for(lock, std::chrono::milliseconds(flush_interval_ms));
+	}
+
+	void AsyncLogQueue_Impl::stop()
+	{
+		if (!thread.joinable())
+			return;
+
+		std::unique_lock<std::mutex> lock(mutex);
+		stop_flag = true;
+		lock.unlock();
+		wakeup_event.notify_one();
+		thread.join();
+
+		// Pick up anything pushed after the thread's last pass
+		while (write_batch() > 0)
+		{
+		}
+	}
+}
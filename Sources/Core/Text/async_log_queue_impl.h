@@ -0,0 +1,97 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "API/Core/Text/async_log_queue.h"
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace clan
+{
+	class AsyncLogQueue_Impl
+	{
+	public:
+		AsyncLogQueue_Impl(int capacity, AsyncLogQueue::OverflowPolicy policy, int flush_interval_ms);
+		~AsyncLogQueue_Impl();
+
+		/// \brief Push a record. Safe to call from any thread.
+		void push(const std::string &type, const std::string &text);
+
+		void flush();
+		void stop();
+
+		/// \brief The queue log_event currently pushes to, if any
+		static std::atomic<AsyncLogQueue_Impl *> active;
+
+		/// \brief Number of threads currently inside push for the active queue
+		static std::atomic_int active_producers;
+
+		std::atomic_int dropped;
+
+	private:
+		enum { max_batch_size = 256 };
+
+		struct Cell
+		{
+			Cell() : sequence(0), timestamp(0) { }
+			Cell(const Cell &) : sequence(0), timestamp(0) { }
+
+			std::atomic<size_t> sequence;
+			std::string type;
+			std::string text;
+			uint64_t timestamp;
+		};
+
+		bool try_push(const std::string &type, const std::string &text, uint64_t timestamp);
+		int write_batch();
+		void thread_main();
+
+		AsyncLogQueue::OverflowPolicy policy;
+		int flush_interval_ms;
+
+		// Bounded MPSC queue with a sequence number per cell (Vyukov)
+		std::vector<Cell> cells;
+		size_t mask = 0;
+		std::atomic<size_t> enqueue_pos;
+		std::atomic<size_t> dequeue_pos;
+
+		int reported_dropped;
+
+		std::thread thread;
+		std::mutex mutex;
+		std::condition_variable wakeup_event;
+		std::condition_variable flushed_event;
+		bool stop_flag = false;
+	};
+}
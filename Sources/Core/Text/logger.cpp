@@ -30,6 +30,7 @@
 #include "API/Core/System/datetime.h"
 #include "API/Core/Text/logger.h"
 #include "API/Core/Text/string_format.h"
+#include "async_log_queue_impl.h"
 #include <algorithm>
 #include <mutex>
 
@@ -47,6 +48,7 @@ namespace clan
 
 	std::vector<Logger*> Logger::instances;
 	std::recursive_mutex Logger::mutex;
+	int64_t Logger::record_ticks = 0;
 
 	void Logger::enable()
 	{
@@ -93,7 +95,7 @@ namespace clan
 		};
 
 		// Tue Nov 16 11:34:15 CET 2004
-		DateTime cur_time = DateTime::get_current_utc_time();
+		DateTime cur_time = record_ticks ? DateTime::get_utc_time_from_ticks(record_ticks) : DateTime::get_current_utc_time();
 
 #ifdef WIN32
 		StringFormat format("%1 %2 %3 %4:%5:%6 %7 UTC [%8] %9\r\n");
@@ -115,6 +117,15 @@ namespace clan
 
 	void log_event(const std::string &type, const std::string &text)
 	{
+		// The producer count lets ~AsyncLogQueue wait for pushes in progress before it stops the queue
+		AsyncLogQueue_Impl::active_producers.fetch_add(1);
+		AsyncLogQueue_Impl *queue = AsyncLogQueue_Impl::active.load();
+		if (queue)
+			queue->push(type, text);
+		AsyncLogQueue_Impl::active_producers.fetch_sub(1);
+		if (queue)
+			return;
+
 		std::unique_lock<std::recursive_mutex> mutex_lock(Logger::mutex);
 		if (Logger::instances.empty())
 			return;
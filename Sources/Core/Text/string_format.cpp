@@ -30,6 +30,7 @@
 #include "API/Core/Text/string_format.h"
 #include "API/Core/Text/string_help.h"
 #include "API/Core/System/exception.h"
+#include "API/Core/Math/cl_math.h"
 
 namespace clan
 {
@@ -178,6 +179,83 @@ namespace clan
 		set_arg(index, StringHelp::double_to_text(value));
 	}
 
+	size_t string_format_to(char *buffer, size_t size, const char *format, size_t format_length, const StringFormatArg *args, int num_args)
+	{
+		size_t capacity = size > 0 ? size - 1 : 0;
+		size_t length = 0;
+		auto append = [&](const char *text, size_t text_length)
+		{
+			if (length < capacity)
+				memcpy(buffer + length, text, min(text_length, capacity - length));
+			length += text_length;
+		};
+
+		char number[512];
+		size_t index = 0;
+		while (index < format_length)
+		{
+			if (format[index] != '%')
+			{
+				size_t text_start = index;
+				while (index < format_length && format[index] != '%')
+					index++;
+				append(format + text_start, index - text_start);
+				continue;
+			}
+
+			if (index + 1 < format_length && format[index + 1] == '%')
+			{
+				append("%", 1);
+				index += 2;
+				continue;
+			}
+
+			size_t arg_start = index++;
+			int arg_index = 0;
+			while (index < format_length && format[index] >= '0' && format[index] <= '9')
+			{
+				arg_index = min(arg_index * 10 + (format[index] - '0'), 1000);
+				index++;
+			}
+
+			if (index == arg_start + 1)
+			{
+				append("%", 1);
+				continue;
+			}
+
+			if (arg_index > 256)
+				throw Exception("Encountered more than 256 indexes in a formatted string!");
+
+			const StringFormatArg *arg = (arg_index >= 1 && arg_index <= num_args) ? &args[arg_index - 1] : nullptr;
+			switch (arg ? arg->type : StringFormatArg::type_none)
+			{
+			case StringFormatArg::type_none:
+				append(format + arg_start, index - arg_start);
+				break;
+			case StringFormatArg::type_int:
+				append(number, StringHelp::int_to_chars(number, arg->data.int_value));
+				break;
+			case StringFormatArg::type_uint:
+				append(number, StringHelp::uint_to_chars(number, arg->data.uint_value));
+				break;
+			case StringFormatArg::type_float:
+				append(number, StringHelp::float_to_chars(number, sizeof(number), arg->data.float_value, 6, true));
+				break;
+			case StringFormatArg::type_double:
+				append(number, StringHelp::float_to_chars(number, sizeof(number), arg->data.float_value, 6, false));
+				break;
+			case StringFormatArg::type_text:
+				append(arg->data.text.str, arg->data.text.length);
+				break;
+			}
+		}
+
+		if (size > 0)
+			buffer[min(length, capacity)] = 0;
+		return length;
+	}
+
 	void StringFormat::create_arg(int index, int start, int length)
 	{
 		if (index > 256)
@@ -32,6 +32,8 @@
 #include "API/Core/Text/utf8_reader.h"
 #include "API/Core/System/exception.h"
 #include "API/Core/System/databuffer.h"
+#include "API/Core/Math/cl_math.h"
+#include "API/Core/System/system.h"
 #ifndef WIN32
 #include <wchar.h>
 #include <wctype.h>
@@ -48,6 +50,7 @@
 #endif
 
 #include <sstream>
+#include <cmath>
 
 #ifdef __MINGW32__
 #include <cstdio>
@@ -55,6 +58,22 @@
 
 // This function or variable may be unsafe. Consider using xxxx instead.
 // To disable deprecation, use _CRT_SECURE_NO_DEPRECATE. See online help for details.
+#if !defined CL_DISABLE_SSE2 && !defined __ANDROID__
+#include <immintrin.h>
+#define CL_STRING_HELP_SSE
+#if defined(__GNUC__)
+// The AVX2 kernels are compiled for AVX2 only, and selected at runtime
+#define CL_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define CL_TARGET_AVX2
+#endif
+#endif
+
+#if defined CL_DISABLE_SSE2 && (defined __ARM_NEON || defined __ARM_NEON__)
+#include <arm_neon.h>
+#define CL_STRING_HELP_NEON
+#endif
+
 #ifdef WIN32
 #pragma warning(disable: 4996)
 #endif
@@ -140,7 +159,91 @@ namespace clan
 
 	std::string StringHelp::text_to_upper(const std::string &s)
 	{
-		return local8_to_upper(s);
+		std::string result = s;
+		ascii_to_upper(&result[0], result.length());
+		return result;
+	}
+
+	namespace
+	{
+		// Flips the case bit of every byte in the range first to last
+#ifdef CL_STRING_HELP_SSE
+		CL_TARGET_AVX2 std::string::size_type change_ascii_case_avx2(char *text, std::string::size_type length, char first, char last)
+		{
+			const __m256i above = _mm256_set1_epi8(first - 1);
+			const __m256i below = _mm256_set1_epi8(last + 1);
+			const __m256i case_bit = _mm256_set1_epi8(0x20);
+			std::string::size_type pos = 0;
+			for (; pos + 32 <= length; pos += 32)
+			{
+				__m256i chars = _mm256_loadu_si256((const __m256i*)(text + pos));
+				__m256i in_range = _mm256_and_si256(_mm256_cmpgt_epi8(chars, above), _mm256_cmpgt_epi8(below, chars));
+				_mm256_storeu_si256((__m256i*)(text + pos), _mm256_xor_si256(chars, _mm256_and_si256(in_range, case_bit)));
+			}
+			return pos;
+		}
+
+		std::string::size_type change_ascii_case_sse2(char *text, std::string::size_type length, char first, char last)
+		{
+			// Bytes above 0x7f compare as negative, so they are never in range
+			const __m128i above = _mm_set1_epi8(first - 1);
+			const __m128i below = _mm_set1_epi8(last + 1);
+			const __m128i case_bit = _mm_set1_epi8(0x20);
+			std::string::size_type pos = 0;
+			for (; pos + 16 <= length; pos += 16)
+			{
+				__m128i chars = _mm_loadu_si128((const __m128i*)(text + pos));
+				__m128i in_range = _mm_and_si128(_mm_cmpgt_epi8(chars, above), _mm_cmplt_epi8(chars, below));
+				_mm_storeu_si128((__m128i*)(text + pos), _mm_xor_si128(chars, _mm_and_si128(in_range, case_bit)));
+			}
+			return pos;
+		}
+#endif
+
+#ifdef CL_STRING_HELP_NEON
+		std::string::size_type change_ascii_case_neon(char *text, std::string::size_type length, char first, char last)
+		{
+			const uint8x16_t lower_bound = vdupq_n_u8((unsigned char)first);
+			const uint8x16_t upper_bound = vdupq_n_u8((unsigned char)last);
+			const uint8x16_t case_bit = vdupq_n_u8(0x20);
+			std::string::size_type pos = 0;
+			for (; pos + 16 <= length; pos += 16)
+			{
+				uint8x16_t chars = vld1q_u8((const uint8_t *)(text + pos));
+				uint8x16_t in_range = vandq_u8(vcgeq_u8(chars, lower_bound), vcleq_u8(chars, upper_bound));
+				vst1q_u8((uint8_t *)(text + pos), veorq_u8(chars, vandq_u8(in_range, case_bit)));
+			}
+			return pos;
+		}
+#endif
+
+		void change_ascii_case(char *text, std::string::size_type length, char first, char last)
+		{
+			std::string::size_type pos = 0;
+#if defined CL_STRING_HELP_SSE
+			static const bool use_avx2 = System::detect_cpu_extension(System::avx2);
+			if (use_avx2)
+				pos = change_ascii_case_avx2(text, length, first, last);
+			pos += change_ascii_case_sse2(text + pos, length - pos, first, last);
+#elif defined CL_STRING_HELP_NEON
+			pos = change_ascii_case_neon(text, length, first, last);
+#endif
+			for (; pos < length; pos++)
+			{
+				if (text[pos] >= first && text[pos] <= last)
+					text[pos] ^= 0x20;
+			}
+		}
+	}
+
+	void StringHelp::ascii_to_upper(char *text, std::string::size_type length)
+	{
+		change_ascii_case(text, length, 'a', 'z');
+	}
+
+	void StringHelp::ascii_to_lower(char *text, std::string::size_type length)
+	{
+		change_ascii_case(text, length, 'A', 'Z');
 	}
 	
 	std::string StringHelp::wchar_to_utf8(wchar_t value)
@@ -233,7 +336,9 @@ namespace clan
 	
 	std::string StringHelp::text_to_lower(const std::string &s)
 	{
-		return local8_to_lower(s);
+		std::string result = s;
+		ascii_to_lower(&result[0], result.length());
+		return result;
 	}
 	
 	std::string StringHelp::local8_to_lower(const std::string &s)
@@ -280,27 +385,126 @@ namespace clan
 		return text;
 	}
 
-	std::string StringHelp::float_to_text(float value, int num_decimal_places, bool remove_zeros)
+	namespace
 	{
-		if (remove_zeros)
-			return remove_trailing_zeros(float_to_local8(value, num_decimal_places));
+		const char digit_pairs[] =
+			"00010203040506070809"
+			"10111213141516171819"
+			"20212223242526272829"
+			"30313233343536373839"
+			"40414243444546474849"
+			"50515253545556575859"
+			"60616263646566676869"
+			"70717273747576777879"
+			"80818283848586878889"
+			"90919293949596979899";
+
+		const unsigned long long powers_of_ten[] =
+		{
+			1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL
+		};
+	}
+
+	int StringHelp::uint_to_chars(char *buffer, unsigned long long value)
+	{
+		char digits[20];
+		char *pos = digits + 20;
+		while (value >= 100)
+		{
+			unsigned int index = (unsigned int)(value % 100) * 2;
+			value /= 100;
+			*(--pos) = digit_pairs[index + 1];
+			*(--pos) = digit_pairs[index];
+		}
+		if (value >= 10)
+		{
+			unsigned int index = (unsigned int)value * 2;
+			*(--pos) = digit_pairs[index + 1];
+			*(--pos) = digit_pairs[index];
+		}
 		else
-			return float_to_local8(value, num_decimal_places);
+		{
+			*(--pos) = (char)('0' + value);
+		}
+
+		int length = (int)(digits + 20 - pos);
+		memcpy(buffer, pos, length);
+		return length;
 	}
 
-	std::string StringHelp::float_to_local8(float value, int num_decimals, bool remove_zeros)
+	int StringHelp::int_to_chars(char *buffer, long long value)
+	{
+		if (value < 0)
+		{
+			buffer[0] = '-';
+			return 1 + uint_to_chars(buffer + 1, 0ULL - (unsigned long long)value);
+		}
+		return uint_to_chars(buffer, (unsigned long long)value);
+	}
+
+	int StringHelp::float_to_chars(char *buffer, int size, double value, int num_decimals, bool remove_zeros)
 	{
-		char buf[64];
-		memset(buf, 0, 64);
+		num_decimals = clamp(num_decimals, 0, 100);
+
+		char text[512];
+		int length = 0;
+
+		// Values that scale into a 53 bit integer are rounded with integer arithmetic. The scaling multiplication
+		// can be off by one ulp, so values close to a rounding midpoint, huge values, many decimals, inf and nan
+		// are left to the C library to keep the output identical to printf.
+		double scaled = std::fabs(value) * (double)powers_of_ten[min(num_decimals, 9)];
+		double midpoint_distance = std::fabs(scaled - std::floor(scaled) - 0.5);
+		if (num_decimals <= 9 && scaled < 9.0e15 && midpoint_distance > scaled * 2.3e-16)
+		{
+			unsigned long long fixed = (unsigned long long)std::nearbyint(scaled);
+			unsigned long long integer_part = fixed / powers_of_ten[num_decimals];
+			unsigned long long fraction = fixed % powers_of_ten[num_decimals];
+
+			if (std::signbit(value))
+				text[length++] = '-';
+			length += uint_to_chars(text + length, integer_part);
+
+			if (num_decimals > 0)
+			{
+				text[length++] = '.';
+				for (int i = num_decimals - 1; i >= 0; i--)
+				{
+					text[length + i] = (char)('0' + fraction % 10);
+					fraction /= 10;
+				}
+				length += num_decimals;
+			}
+		}
+		else
+		{
 	#ifdef WIN32
-		_snprintf(buf, 63, ("%." + StringHelp::int_to_local8(num_decimals) + "f").c_str(), value);
+			length = _snprintf(text, sizeof(text) - 1, "%.*f", num_decimals, value);
 	#else
-		snprintf(buf, 63, ("%." + StringHelp::int_to_local8(num_decimals) + "f").c_str(), value);
+			length = snprintf(text, sizeof(text), "%.*f", num_decimals, value);
 	#endif
-		if (remove_zeros)
-			return remove_trailing_zeros(std::string(buf));
-		else
-			return std::string(buf);
+			length = clamp(length, 0, (int)sizeof(text) - 1);
+		}
+
+		if (remove_zeros && memchr(text, '.', length))
+		{
+			while (length > 0 && text[length - 1] == '0') length--;
+			if (length > 0 && text[length - 1] == '.') length--;
+		}
+
+		memcpy(buffer, text, min(length, max(size, 0)));
+		return length;
+	}
+
+	std::string StringHelp::float_to_text(float value, int num_decimal_places, bool remove_zeros)
+	{
+		return float_to_local8(value, num_decimal_places, remove_zeros);
+	}
+
+	std::string StringHelp::float_to_local8(float value, int num_decimals, bool remove_zeros)
+	{
+		char buf[512];
+		int length = float_to_chars(buf, 512, value, num_decimals, remove_zeros);
+		return std::string(buf, min(length, 512));
 	}
 	
 	std::wstring StringHelp::float_to_ucs2(float value, int num_decimals, bool remove_zeros)
@@ -350,14 +554,9 @@ namespace clan
 
 	std::string StringHelp::double_to_local8(double value, int num_decimals)
 	{
-		char buf[64];
-		memset(buf, 0, 64);
-	#ifdef WIN32
-		_snprintf(buf, 63, ("%." + StringHelp::int_to_local8(num_decimals) + "f").c_str(), value);
-	#else
-		snprintf(buf, 63, ("%." + StringHelp::int_to_local8(num_decimals) + "f").c_str(), value);
-	#endif
-		return std::string(buf);
+		char buf[512];
+		int length = float_to_chars(buf, 512, value, num_decimals, false);
+		return std::string(buf, min(length, 512));
 	}
 	
 	std::wstring StringHelp::double_to_ucs2(double value, int num_decimals)
@@ -402,13 +601,7 @@ namespace clan
 	std::string StringHelp::int_to_local8(int value)
 	{
 		char buf[32];
-		memset(buf, 0, 32);
-	#ifdef WIN32
-		_snprintf(buf, 31, "%d", value);
-	#else
-		snprintf(buf, 31, "%d", value);
-	#endif
-		return std::string(buf);
+		return std::string(buf, int_to_chars(buf, value));
 	}
 	
 	std::wstring StringHelp::int_to_ucs2(int value)
@@ -522,13 +715,7 @@ namespace clan
 	std::string StringHelp::uint_to_local8(unsigned int value)
 	{
 		char buf[32];
-		memset(buf, 0, 32);
-	#ifdef WIN32
-		_snprintf(buf, 31, "%u", value);
-	#else
-		snprintf(buf, 31, "%u", value);
-	#endif
-		return std::string(buf);
+		return std::string(buf, uint_to_chars(buf, value));
 	}
 	
 	std::wstring StringHelp::uint_to_ucs2(unsigned int value)
@@ -548,15 +735,13 @@ namespace clan
 
 	std::string StringHelp::ull_to_text(unsigned long long value)
 	{
-		return uint_to_local8(value);
+		return ull_to_local8(value);
 	}
 
 	std::string StringHelp::ull_to_local8(unsigned long long value)
 	{
-		std::ostringstream stream;
-		stream << value;
-	
-		return std::string(stream.str().c_str());
+		char buf[32];
+		return std::string(buf, uint_to_chars(buf, value));
 	}
 	
 	std::wstring StringHelp::ull_to_ucs2(unsigned long long value)
@@ -569,15 +754,13 @@ namespace clan
 
 	std::string StringHelp::ll_to_text(long long value)
 	{
-		return uint_to_local8(value);
+		return ll_to_local8(value);
 	}
 
 	std::string StringHelp::ll_to_local8(long long value)
 	{
-		std::ostringstream stream;
-		stream << value;
-	
-		return std::string(stream.str().c_str());
+		char buf[32];
+		return std::string(buf, int_to_chars(buf, value));
 	}
 	
 	std::wstring StringHelp::ll_to_ucs2(long long value)
@@ -943,6 +1126,14 @@ namespace clan
 			else
 				length_utf8 += 3;
 		}
+
+		if (length_utf8 == length_ucs2)
+		{
+			std::string ascii(length_utf8, ' ');
+			for (pos = 0; pos < length_ucs2; pos++)
+				ascii[pos] = (char)ucs2[pos];
+			return ascii;
+		}
 	
 		// Perform conversion:
 	
@@ -1005,11 +1196,22 @@ namespace clan
 
 	std::wstring StringHelp::utf8_to_ucs2(const std::string &utf8)
 	{
-		// Calculate length:
+		// Text that is all ASCII only needs widening:
 
-		std::wstring::size_type length_ucs2 = 0;
 		std::string::size_type length_utf8 = utf8.length();
-		std::string::size_type pos = 0;
+		std::string::size_type length_ascii = UTF8_Reader::ascii_length(utf8.data(), length_utf8);
+		if (length_ascii == length_utf8)
+		{
+			std::wstring ucs2(length_utf8, L' ');
+			for (std::string::size_type i = 0; i < length_utf8; i++)
+				ucs2[i] = utf8[i];
+			return ucs2;
+		}
+
+		// Calculate length:
+
+		std::wstring::size_type length_ucs2 = length_ascii;
+		std::string::size_type pos = length_ascii;
 		while (pos < length_utf8)
 		{
 			unsigned char c = utf8[pos++];
@@ -1028,8 +1230,9 @@ namespace clan
 		// Perform conversion:
 	
 		std::wstring ucs2(length_ucs2, L'?');
-		pos = 0;
-		std::wstring::size_type ucs2_pos = 0;
+		for (pos = 0; pos < length_ascii; pos++)
+			ucs2[pos] = utf8[pos];
+		std::wstring::size_type ucs2_pos = length_ascii;
 		while (pos < length_utf8 && ucs2_pos < length_ucs2)
 		{
 			unsigned char c = utf8[pos++];
@@ -1300,8 +1503,18 @@ namespace clan
 		UTF8_Reader utf8_reader(str.data(), str.length());
 		while(!utf8_reader.is_end())
 		{
-			len++;
-			utf8_reader.next();
+			std::string::size_type pos = utf8_reader.get_position();
+			std::string::size_type ascii = UTF8_Reader::ascii_length(str.data() + pos, str.length() - pos);
+			if (ascii > 0)
+			{
+				len += ascii;
+				utf8_reader.set_position(pos + ascii);
+			}
+			else
+			{
+				len++;
+				utf8_reader.next();
+			}
 		}
 
 		return len;
@@ -28,12 +28,52 @@
 
 #include "Core/precomp.h"
 #include "API/Core/Text/utf8_reader.h"
+#include "API/Core/System/system.h"
+
+#if !defined CL_DISABLE_SSE2 && !defined __ANDROID__
+#include <immintrin.h>
+#define CL_UTF8_SSE
+#if defined(__GNUC__)
+// The AVX2 validator is compiled for AVX2 only, and selected at runtime
+#define CL_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define CL_TARGET_AVX2
+#endif
+#endif
+
+#if defined CL_DISABLE_SSE2 && (defined __ARM_NEON || defined __ARM_NEON__)
+#include <arm_neon.h>
+#define CL_UTF8_NEON
+#endif
 
 namespace clan
 {
 	class UTF8_Reader_Impl
 	{
 	public:
+		/// \brief Decodes the character at pos, returning '?' for invalid sequences like UTF8_Reader::get_char
+		static unsigned int decode_char(const unsigned char *data, std::string::size_type pos, std::string::size_type length, std::string::size_type &char_length);
+
+		static bool is_valid_scalar(const unsigned char *data, std::string::size_type length);
+#ifdef CL_UTF8_SSE
+		static bool is_valid_avx2(const unsigned char *data, std::string::size_type length);
+#endif
+
+		static int count_trailing_zeros(unsigned int value)
+		{
+#if defined(__GNUC__)
+			return __builtin_ctz(value);
+#else
+			int bits = 0;
+			while ((value & 1) == 0)
+			{
+				bits++;
+				value >>= 1;
+			}
+			return bits;
+#endif
+		}
+
 		static const char trailing_bytes_for_utf8[256];
 		static const unsigned char bitmask_leadbyte_for_utf8[6];
 	};
@@ -51,6 +91,8 @@ namespace clan
 	{
 		if (current_position >= length)
 			return 0;
+		if (data[current_position] < 0x80)
+			return data[current_position];
 
 		int trailing_bytes = UTF8_Reader_Impl::trailing_bytes_for_utf8[data[current_position]];
 		if (trailing_bytes == 0 && (data[current_position] & 0x80) == 0x80)
@@ -83,6 +125,8 @@ namespace clan
 		if (current_position < length)
 		{
 			int trailing_bytes = UTF8_Reader_Impl::trailing_bytes_for_utf8[data[current_position]];
+			if (trailing_bytes == 0)
+				return 1;
 			if (current_position + 1 + trailing_bytes > length)
 				return 1;
 
@@ -144,6 +188,277 @@ namespace clan
 		current_position = position;
 	}
 
+	bool UTF8_Reader::is_valid(const std::string::value_type *text, std::string::size_type length)
+	{
+#ifdef CL_UTF8_SSE
+		static const bool use_avx2 = System::detect_cpu_extension(System::avx2);
+		if (use_avx2)
+			return UTF8_Reader_Impl::is_valid_avx2((const unsigned char *)text, length);
+#endif
+		return UTF8_Reader_Impl::is_valid_scalar((const unsigned char *)text, length);
+	}
+
+	std::string::size_type UTF8_Reader::ascii_length(const std::string::value_type *text, std::string::size_type length)
+	{
+		const unsigned char *data = (const unsigned char *)text;
+		std::string::size_type pos = 0;
+#if defined CL_UTF8_SSE
+		for (; pos + 16 <= length; pos += 16)
+		{
+			int mask = _mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(data + pos)));
+			if (mask != 0)
+				return pos + UTF8_Reader_Impl::count_trailing_zeros(mask);
+		}
+#elif defined CL_UTF8_NEON
+		for (; pos + 16 <= length; pos += 16)
+		{
+			uint64x2_t high_bits = vreinterpretq_u64_u8(vandq_u8(vld1q_u8(data + pos), vdupq_n_u8(0x80)));
+			if ((vgetq_lane_u64(high_bits, 0) | vgetq_lane_u64(high_bits, 1)) != 0)
+				break;
+		}
+#endif
+		while (pos < length && data[pos] < 0x80)
+			pos++;
+		return pos;
+	}
+
+	std::string::size_type UTF8_Reader::decode(const std::string::value_type *text, std::string::size_type length, char32_t *output)
+	{
+		const unsigned char *data = (const unsigned char *)text;
+		std::string::size_type pos = 0;
+		std::string::size_type count = 0;
+		while (pos < length)
+		{
+			// Widen runs of ASCII directly, then fall back to decoding a single character
+#if defined CL_UTF8_SSE
+			while (pos + 16 <= length)
+			{
+				__m128i bytes = _mm_loadu_si128((const __m128i*)(data + pos));
+				if (_mm_movemask_epi8(bytes) != 0)
+					break;
+				__m128i low = _mm_unpacklo_epi8(bytes, _mm_setzero_si128());
+				__m128i high = _mm_unpackhi_epi8(bytes, _mm_setzero_si128());
+				_mm_storeu_si128((__m128i*)(output + count), _mm_unpacklo_epi16(low, _mm_setzero_si128()));
+				_mm_storeu_si128((__m128i*)(output + count + 4), _mm_unpackhi_epi16(low, _mm_setzero_si128()));
+				_mm_storeu_si128((__m128i*)(output + count + 8), _mm_unpacklo_epi16(high, _mm_setzero_si128()));
+				_mm_storeu_si128((__m128i*)(output + count + 12), _mm_unpackhi_epi16(high, _mm_setzero_si128()));
+				pos += 16;
+				count += 16;
+			}
+#elif defined CL_UTF8_NEON
+			while (pos + 16 <= length)
+			{
+				uint8x16_t bytes = vld1q_u8(data + pos);
+				uint64x2_t high_bits = vreinterpretq_u64_u8(vandq_u8(bytes, vdupq_n_u8(0x80)));
+				if ((vgetq_lane_u64(high_bits, 0) | vgetq_lane_u64(high_bits, 1)) != 0)
+					break;
+				uint16x8_t low = vmovl_u8(vget_low_u8(bytes));
+				uint16x8_t high = vmovl_u8(vget_high_u8(bytes));
+				vst1q_u32((uint32_t *)(output + count), vmovl_u16(vget_low_u16(low)));
+				vst1q_u32((uint32_t *)(output + count + 4), vmovl_u16(vget_high_u16(low)));
+				vst1q_u32((uint32_t *)(output + count + 8), vmovl_u16(vget_low_u16(high)));
+				vst1q_u32((uint32_t *)(output + count + 12), vmovl_u16(vget_high_u16(high)));
+				pos += 16;
+				count += 16;
+			}
+#endif
+			if (pos >= length)
+				break;
+
+			if (data[pos] < 0x80)
+			{
+				output[count++] = data[pos++];
+			}
+			else
+			{
+				std::string::size_type char_length = 1;
+				output[count++] = UTF8_Reader_Impl::decode_char(data, pos, length, char_length);
+				pos += char_length;
+			}
+		}
+		return count;
+	}
+
+	unsigned int UTF8_Reader_Impl::decode_char(const unsigned char *data, std::string::size_type pos, std::string::size_type length, std::string::size_type &char_length)
+	{
+		char_length = 1;
+
+		int trailing_bytes = trailing_bytes_for_utf8[data[pos]];
+		if (trailing_bytes == 0)
+			return (data[pos] & 0x80) ? '?' : data[pos];
+		if (pos + 1 + trailing_bytes > length)
+			return '?';
+
+		unsigned int ucs4 = (data[pos] & bitmask_leadbyte_for_utf8[trailing_bytes]);
+		for (int i = 0; i < trailing_bytes; i++)
+		{
+			if ((data[pos + 1 + i] & 0xC0) != 0x80)
+				return '?';
+			ucs4 = (ucs4 << 6) + (data[pos + 1 + i] & 0x3f);
+		}
+
+		char_length = 1 + trailing_bytes;
+		return ucs4;
+	}
+
+	bool UTF8_Reader_Impl::is_valid_scalar(const unsigned char *data, std::string::size_type length)
+	{
+		std::string::size_type pos = 0;
+		while (pos < length)
+		{
+			pos += UTF8_Reader::ascii_length((const char *)data + pos, length - pos);
+			if (pos >= length)
+				break;
+
+			// Ranges of the second byte are restricted to exclude overlong forms, surrogates and values above U+10FFFF
+			unsigned char lead = data[pos];
+			int trailing_bytes;
+			unsigned char second_min = 0x80, second_max = 0xbf;
+			if (lead >= 0xc2 && lead <= 0xdf)
+			{
+				trailing_bytes = 1;
+			}
+			else if (lead >= 0xe0 && lead <= 0xef)
+			{
+				trailing_bytes = 2;
+				if (lead == 0xe0)
+					second_min = 0xa0;
+				else if (lead == 0xed)
+					second_max = 0x9f;
+			}
+			else if (lead >= 0xf0 && lead <= 0xf4)
+			{
+				trailing_bytes = 3;
+				if (lead == 0xf0)
+					second_min = 0x90;
+				else if (lead == 0xf4)
+					second_max = 0x8f;
+			}
+			else
+			{
+				return false;
+			}
+
+			if (pos + 1 + trailing_bytes > length)
+				return false;
+			if (data[pos + 1] < second_min || data[pos + 1] > second_max)
+				return false;
+			for (int i = 2; i <= trailing_bytes; i++)
+			{
+				if ((data[pos + i] & 0xc0) != 0x80)
+					return false;
+			}
+			pos += 1 + trailing_bytes;
+		}
+		return true;
+	}
+
+#ifdef CL_UTF8_SSE
+	// Validates 32 bytes at a time by classifying each pair of adjacent bytes with nibble lookup tables,
+	// as described in "Validating UTF-8 In Less Than One Instruction Per Byte" by Keiser and Lemire.
+	CL_TARGET_AVX2 bool UTF8_Reader_Impl::is_valid_avx2(const unsigned char *data, std::string::size_type length)
+	{
+		// Error classes of a byte pair. Each table marks the classes its nibble can be part of.
+		const char too_short = 1 << 0; // Lead byte followed by a lead byte or ASCII
+		const char too_long = 1 << 1; // ASCII followed by a continuation byte
+		const char overlong_3 = 1 << 2;
+		const char too_large = 1 << 3;
+		const char surrogate = 1 << 4;
+		const char overlong_2 = 1 << 5;
+		const char too_large_1000 = 1 << 6;
+		const char overlong_4 = 1 << 6;
+		const char two_conts = (char)(1 << 7); // Two continuation bytes, only valid inside a 3 or 4 byte sequence
+		const char carry = too_short | too_long | two_conts;
+
+		const __m256i byte_1_high_table = _mm256_setr_epi8(
+			too_long, too_long, too_long, too_long, too_long, too_long, too_long, too_long,
+			two_conts, two_conts, two_conts, two_conts,
+			too_short | overlong_2, too_short, too_short | overlong_3 | surrogate, too_short | too_large | too_large_1000 | overlong_4,
+			too_long, too_long, too_long, too_long, too_long, too_long, too_long, too_long,
+			two_conts, two_conts, two_conts, two_conts,
+			too_short | overlong_2, too_short, too_short | overlong_3 | surrogate, too_short | too_large | too_large_1000 | overlong_4);
+
+		const __m256i byte_1_low_table = _mm256_setr_epi8(
+			carry | overlong_3 | overlong_2 | overlong_4, carry | overlong_2, carry, carry,
+			carry | too_large, carry | too_large | too_large_1000, carry | too_large | too_large_1000, carry | too_large | too_large_1000,
+			carry | too_large | too_large_1000, carry | too_large | too_large_1000, carry | too_large | too_large_1000, carry | too_large | too_large_1000,
+			carry | too_large | too_large_1000, carry | too_large | too_large_1000 | surrogate, carry | too_large | too_large_1000, carry | too_large | too_large_1000,
+			carry | overlong_3 | overlong_2 | overlong_4, carry | overlong_2, carry, carry,
+			carry | too_large, carry | too_large | too_large_1000, carry | too_large | too_large_1000, carry | too_large | too_large_1000,
+			carry | too_large | too_large_1000, carry | too_large | too_large_1000, carry | too_large | too_large_1000, carry | too_large | too_large_1000,
+			carry | too_large | too_large_1000, carry | too_large | too_large_1000 | surrogate, carry | too_large | too_large_1000, carry | too_large | too_large_1000);
+
+		const __m256i byte_2_high_table = _mm256_setr_epi8(
+			too_short, too_short, too_short, too_short, too_short, too_short, too_short, too_short,
+			too_long | overlong_2 | two_conts | overlong_3 | too_large_1000 | overlong_4,
+			too_long | overlong_2 | two_conts | overlong_3 | too_large,
+			too_long | overlong_2 | two_conts | surrogate | too_large,
+			too_long | overlong_2 | two_conts | surrogate | too_large,
+			too_short, too_short, too_short, too_short,
+			too_short, too_short, too_short, too_short, too_short, too_short, too_short, too_short,
+			too_long | overlong_2 | two_conts | overlong_3 | too_large_1000 | overlong_4,
+			too_long | overlong_2 | two_conts | overlong_3 | too_large,
+			too_long | overlong_2 | two_conts | surrogate | too_large,
+			too_long | overlong_2 | two_conts | surrogate | too_large,
+			too_short, too_short, too_short, too_short);
+
+		// Bytes in the last three positions that start a sequence not finished within the block
+		const __m256i incomplete_limit = _mm256_setr_epi8(
+			-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+			-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, (char)0xef, (char)0xdf, (char)0xbf);
+
+		const __m256i nibble_mask = _mm256_set1_epi8(0x0f);
+		__m256i error = _mm256_setzero_si256();
+		__m256i prev_input = _mm256_setzero_si256();
+		__m256i prev_incomplete = _mm256_setzero_si256();
+
+		unsigned char tail[32];
+		for (std::string::size_type pos = 0; pos < length; pos += 32)
+		{
+			__m256i input;
+			if (pos + 32 <= length)
+			{
+				input = _mm256_loadu_si256((const __m256i*)(data + pos));
+			}
+			else
+			{
+				// Zero padding is ASCII, so a truncated sequence at the end is reported as too short
+				memset(tail, 0, 32);
+				memcpy(tail, data + pos, length - pos);
+				input = _mm256_loadu_si256((const __m256i*)tail);
+			}
+
+			if (_mm256_movemask_epi8(input) == 0)
+			{
+				error = _mm256_or_si256(error, prev_incomplete);
+			}
+			else
+			{
+				__m256i shifted_prev = _mm256_permute2x128_si256(prev_input, input, 0x21);
+				__m256i prev1 = _mm256_alignr_epi8(input, shifted_prev, 15);
+				__m256i prev2 = _mm256_alignr_epi8(input, shifted_prev, 14);
+				__m256i prev3 = _mm256_alignr_epi8(input, shifted_prev, 13);
+
+				__m256i byte_1_high = _mm256_shuffle_epi8(byte_1_high_table, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble_mask));
+				__m256i byte_1_low = _mm256_shuffle_epi8(byte_1_low_table, _mm256_and_si256(prev1, nibble_mask));
+				__m256i byte_2_high = _mm256_shuffle_epi8(byte_2_high_table, _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble_mask));
+				__m256i special_cases = _mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low), byte_2_high);
+
+				// Two continuation bytes are required exactly when the byte two or three back is a 3 or 4 byte lead
+				__m256i is_third_byte = _mm256_subs_epu8(prev2, _mm256_set1_epi8(0xe0 - 0x80));
+				__m256i is_fourth_byte = _mm256_subs_epu8(prev3, _mm256_set1_epi8(0xf0 - 0x80));
+				__m256i must_be_continuation = _mm256_and_si256(_mm256_or_si256(is_third_byte, is_fourth_byte), _mm256_set1_epi8(two_conts));
+
+				error = _mm256_or_si256(error, _mm256_xor_si256(must_be_continuation, special_cases));
+				prev_incomplete = _mm256_subs_epu8(input, incomplete_limit);
+			}
+			prev_input = input;
+		}
+		error = _mm256_or_si256(error, prev_incomplete);
+		return _mm256_testz_si256(error, error) != 0;
+	}
+#endif
+
 	const char UTF8_Reader_Impl::trailing_bytes_for_utf8[256] =
 	{
 		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
@@ -0,0 +1,292 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "Core/precomp.h"
+#include "API/Core/Zip/lz4_compression.h"
+#include "API/Core/System/databuffer.h"
+#include "API/Core/Text/string_format.h"
+
+#ifdef HAVE_LZ4FRAME_H
+#include <lz4frame.h>
+#endif
+
+namespace clan
+{
+	bool LZ4Compression::is_supported()
+	{
+#ifdef HAVE_LZ4FRAME_H
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	DataBuffer LZ4Compression::compress(const DataBuffer &data, int compression_level)
+	{
+		DataBuffer output;
+		LZ4Compressor compressor(compression_level);
+		compressor.compress(data.get_data(), data.get_size(), output, true);
+		return output;
+	}
+
+	DataBuffer LZ4Compression::decompress(const DataBuffer &data)
+	{
+		DataBuffer output;
+		LZ4Decompressor decompressor;
+		if (!decompressor.decompress(data.get_data(), data.get_size(), output))
+			throw Exception("LZ4 data ended in the middle of a frame");
+		return output;
+	}
+
+#ifdef HAVE_LZ4FRAME_H
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	class LZ4Compressor_Impl
+	{
+	public:
+		LZ4Compressor_Impl(int compression_level)
+		{
+			LZ4F_errorCode_t result = LZ4F_createCompressionContext(&cctx, LZ4F_VERSION);
+			if (LZ4F_isError(result))
+				throw Exception("LZ4F_createCompressionContext failed");
+
+			memset(&preferences, 0, sizeof(LZ4F_preferences_t));
+			preferences.frameInfo.blockSizeID = LZ4F_max64KB;
+			preferences.compressionLevel = compression_level;
+		}
+
+		~LZ4Compressor_Impl()
+		{
+			LZ4F_freeCompressionContext(cctx);
+		}
+
+		// Grows output geometrically to fit size more bytes and returns where they start
+		static unsigned char *reserve(DataBuffer &output, size_t size)
+		{
+			unsigned int pos = output.get_size();
+			unsigned int needed = pos + (unsigned int)size;
+			if (needed > output.get_capacity())
+				output.set_capacity(needed > output.get_capacity() * 2 ? needed : output.get_capacity() * 2);
+			output.set_size(needed);
+			return (unsigned char *)output.get_data() + pos;
+		}
+
+		LZ4F_cctx *cctx = nullptr;
+		LZ4F_preferences_t preferences;
+		bool started = false;
+	};
+
+	LZ4Compressor::LZ4Compressor(int compression_level) : impl(std::make_shared<LZ4Compressor_Impl>(compression_level))
+	{
+	}
+
+	LZ4Compressor::~LZ4Compressor()
+	{
+	}
+
+	void LZ4Compressor::reset()
+	{
+		// Beginning a frame resets the compression context
+		impl->started = false;
+	}
+
+	void LZ4Compressor::compress(const void *data, unsigned int size, DataBuffer &output, bool finish)
+	{
+		if (!impl->started)
+		{
+			unsigned int pos = output.get_size();
+			size_t result = LZ4F_compressBegin(impl->cctx, LZ4Compressor_Impl::reserve(output, LZ4F_HEADER_SIZE_MAX), LZ4F_HEADER_SIZE_MAX, &impl->preferences);
+			if (LZ4F_isError(result))
+				throw Exception(string_format("LZ4 compression failed: %1", LZ4F_getErrorName(result)));
+			output.set_size(pos + (unsigned int)result);
+			impl->started = true;
+		}
+
+		// The output must fit the worst case of each update, so the input is fed one block at a time to keep the bound small
+		const unsigned char *input = (const unsigned char *)data;
+		while (size > 0)
+		{
+			unsigned int block_size = size < 64 * 1024 ? size : 64 * 1024;
+			size_t bound = LZ4F_compressBound(block_size, &impl->preferences);
+
+			unsigned int pos = output.get_size();
+			size_t result = LZ4F_compressUpdate(impl->cctx, LZ4Compressor_Impl::reserve(output, bound), bound, input, block_size, nullptr);
+			if (LZ4F_isError(result))
+				throw Exception(string_format("LZ4 compression failed: %1", LZ4F_getErrorName(result)));
+			output.set_size(pos + (unsigned int)result);
+
+			input += block_size;
+			size -= block_size;
+		}
+
+		if (finish)
+		{
+			size_t bound = LZ4F_compressBound(0, &impl->preferences);
+
+			unsigned int pos = output.get_size();
+			size_t result = LZ4F_compressEnd(impl->cctx, LZ4Compressor_Impl::reserve(output, bound), bound, nullptr);
+			if (LZ4F_isError(result))
+				throw Exception(string_format("LZ4 compression failed: %1", LZ4F_getErrorName(result)));
+			output.set_size(pos + (unsigned int)result);
+			impl->started = false;
+		}
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	class LZ4Decompressor_Impl
+	{
+	public:
+		LZ4Decompressor_Impl()
+		{
+			LZ4F_errorCode_t result = LZ4F_createDecompressionContext(&dctx, LZ4F_VERSION);
+			if (LZ4F_isError(result))
+				throw Exception("LZ4F_createDecompressionContext failed");
+		}
+
+		~LZ4Decompressor_Impl()
+		{
+			LZ4F_freeDecompressionContext(dctx);
+		}
+
+		LZ4F_dctx *dctx = nullptr;
+	};
+
+	LZ4Decompressor::LZ4Decompressor() : impl(std::make_shared<LZ4Decompressor_Impl>())
+	{
+	}
+
+	LZ4Decompressor::~LZ4Decompressor()
+	{
+	}
+
+	void LZ4Decompressor::reset()
+	{
+		LZ4F_resetDecompressionContext(impl->dctx);
+	}
+
+	bool LZ4Decompressor::decompress(const void *input, unsigned int input_size, unsigned int &input_used, void *output, unsigned int output_size, unsigned int &output_used)
+	{
+		size_t src_size = input_size;
+		size_t dest_size = output_size;
+
+		// Decompression stops at the end of each frame and returns 0 once the frame is fully flushed
+		size_t result = LZ4F_decompress(impl->dctx, output, &dest_size, input, &src_size, nullptr);
+		if (LZ4F_isError(result))
+			throw Exception(string_format("LZ4 data stream is corrupted: %1", LZ4F_getErrorName(result)));
+
+		input_used = (unsigned int)src_size;
+		output_used = (unsigned int)dest_size;
+		return result == 0;
+	}
+
+#else
+
+	class LZ4Compressor_Impl
+	{
+	public:
+		LZ4Compressor_Impl(int compression_level)
+		{
+			throw Exception("ClanLib was built without LZ4 support");
+		}
+	};
+
+	LZ4Compressor::LZ4Compressor(int compression_level) : impl(std::make_shared<LZ4Compressor_Impl>(compression_level))
+	{
+	}
+
+	LZ4Compressor::~LZ4Compressor()
+	{
+	}
+
+	void LZ4Compressor::reset()
+	{
+	}
+
+	void LZ4Compressor::compress(const void *data, unsigned int size, DataBuffer &output, bool finish)
+	{
+	}
+
+	class LZ4Decompressor_Impl
+	{
+	public:
+		LZ4Decompressor_Impl()
+		{
+			throw Exception("ClanLib was built without LZ4 support");
+		}
+	};
+
+	LZ4Decompressor::LZ4Decompressor() : impl(std::make_shared<LZ4Decompressor_Impl>())
+	{
+	}
+
+	LZ4Decompressor::~LZ4Decompressor()
+	{
+	}
+
+	void LZ4Decompressor::reset()
+	{
+	}
+
+	bool LZ4Decompressor::decompress(const void *input, unsigned int input_size, unsigned int &input_used, void *output, unsigned int output_size, unsigned int &output_used)
+	{
+		input_used = 0;
+		output_used = 0;
+		return false;
+	}
+
+#endif
+
+	bool LZ4Decompressor::decompress(const void *data, unsigned int size, DataBuffer &output)
+	{
+		const unsigned char *input = (const unsigned char *)data;
+		while (true)
+		{
+			unsigned int pos = output.get_size();
+			unsigned int needed = pos + (size * 4 > 4096 ? size * 4 : 4096);
+			if (needed > output.get_capacity())
+				output.set_capacity(needed > output.get_capacity() * 2 ? needed : output.get_capacity() * 2);
+			output.set_size(output.get_capacity());
+
+			unsigned int input_used = 0, output_used = 0;
+			bool frame_end = decompress(input, size, input_used, output.get_data() + pos, output.get_size() - pos, output_used);
+			output.set_size(pos + output_used);
+			input += input_used;
+			size -= input_used;
+
+			// More output may be pending when the output buffer was filled, and more frames may follow a frame end
+			bool output_full = output_used == output.get_capacity() - pos;
+			if (size == 0 && (frame_end || !output_full))
+				return frame_end;
+			if (input_used == 0 && output_used == 0 && !frame_end)
+				return false;
+		}
+	}
+}
@@ -0,0 +1,84 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "Core/precomp.h"
+#include "zip_64_extended_information.h"
+
+namespace clan
+{
+	void Zip64ExtendedInformation::apply(const DataBuffer &extra_field, int64_t &uncompressed_size, int64_t &compressed_size, int64_t *relative_offset_of_local_header)
+	{
+		const unsigned char *data = (const unsigned char *)extra_field.get_data();
+		unsigned int size = extra_field.get_size();
+
+		unsigned int pos = 0;
+		while (pos + 4 <= size)
+		{
+			unsigned int header_id = data[pos] | (data[pos + 1] << 8);
+			unsigned int data_size = data[pos + 2] | (data[pos + 3] << 8);
+			pos += 4;
+			if (pos + data_size > size)
+				break;
+
+			if (header_id == 0x0001)
+			{
+				unsigned int field_pos = pos;
+				unsigned int field_end = pos + data_size;
+				auto read_field = [&](int64_t &value)
+				{
+					if (value != overflow)
+						return;
+					if (field_pos + 8 > field_end)
+						throw Exception("Zip64 extended information is truncated");
+
+					uint64_t result = 0;
+					for (int i = 7; i >= 0; i--)
+						result = (result << 8) | data[field_pos + i];
+					value = (int64_t)result;
+					field_pos += 8;
+				};
+
+				read_field(uncompressed_size);
+				read_field(compressed_size);
+				if (relative_offset_of_local_header)
+					read_field(*relative_offset_of_local_header);
+				return;
+			}
+
+			pos += data_size;
+		}
+	}
+
+	uint32_t Zip64ExtendedInformation::to_uint32(int64_t value)
+	{
+		if (value < 0 || value >= overflow)
+			throw Exception("Zip entry is too large to be written without Zip64 records");
+		return (uint32_t)value;
+	}
+}
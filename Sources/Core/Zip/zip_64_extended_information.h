@@ -0,0 +1,57 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include "API/Core/System/cl_platform.h"
+#include "API/Core/System/databuffer.h"
+
+namespace clan
+{
+	/// \brief Zip64 extended information extra field (0x0001)
+	///
+	/// Holds the 64 bit values of the header fields that are set to 0xffffffff. Only the fields
+	/// that overflowed are present, in the order uncompressed size, compressed size, local header offset.
+	class Zip64ExtendedInformation
+	{
+	public:
+		/// \brief Replaces overflowed header fields with the values in the extra field
+		///
+		/// \param relative_offset_of_local_header = Offset field of a central directory header, or nullptr for a local header
+		static void apply(const DataBuffer &extra_field, int64_t &uncompressed_size, int64_t &compressed_size, int64_t *relative_offset_of_local_header);
+
+		/// \brief Returns a header field read as an unsigned 32 bit value
+		static int64_t from_uint32(uint32_t value) { return value; }
+
+		/// \brief Throws if a value does not fit a 32 bit header field, since the writers do not produce Zip64 records
+		static uint32_t to_uint32(int64_t value);
+
+		static const uint32_t overflow = 0xffffffff;
+	};
+}
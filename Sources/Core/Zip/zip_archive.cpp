@@ -43,6 +43,7 @@
 #include "zip_iodevice_fileentry.h"
 #include "zip_compression_method.h"
 #include "zip_digital_signature.h"
+#include <algorithm>
 #include <ctime>
 #include <mutex>
 
@@ -53,10 +54,19 @@ namespace clan
 	{
 	}
 
-	ZipArchive::ZipArchive(const std::string &filename)
+	ZipArchive::ZipArchive(const std::string &filename, bool memory_map)
 		: impl(std::make_shared<ZipArchive_Impl>())
 	{
-		IODevice input = File(filename);
+		IODevice input;
+		if (memory_map)
+		{
+			impl->mapping = File::map_bytes(filename);
+			input = MemoryDevice(impl->mapping);
+		}
+		else
+		{
+			input = File(filename);
+		}
 		impl->input = input;
 		load(input);
 	}
@@ -89,52 +99,44 @@ namespace clan
 		// Zip files expect the folders to be in the form of "/Folder/"
 		path = PathHelp::make_absolute("/", path, PathHelp::path_type_virtual);
 		path = PathHelp::add_trailing_slash(path, PathHelp::path_type_virtual);
+		std::string normalized_path = "/" + impl->normalize_filename(path);
 
 		std::vector<ZipFileEntry> files;
-		std::vector<std::string> added_directories;
+		std::string last_directory;
 
-		for (auto & elem : impl->files)
+		// Entries below the path are next to each other in the sorted index, as are entries in the same subdirectory
+		const std::vector<std::pair<std::string, size_t> > &sorted_index = impl->get_sorted_index();
+		auto it = std::lower_bound(sorted_index.begin(), sorted_index.end(), std::make_pair(normalized_path, (size_t)0));
+		for (; it != sorted_index.end() && it->first.compare(0, normalized_path.size(), normalized_path) == 0; ++it)
 		{
-			std::string filename = elem.get_archive_filename();
+			if (it->first.size() == normalized_path.size())
+				continue;
+
+			// Folding only changes ASCII letters, so positions in the normalized name match the original
+			std::string filename = impl->files[it->second].get_archive_filename();
 			if (filename[0] != '/')
-			{
 				filename.insert(filename.begin(), '/');
-				elem.set_archive_filename(filename);
-			}
 
-			if (filename.substr(0, path.size()) == path)
+			std::string::size_type subdir_slash_pos = it->first.find('/', normalized_path.size());
+			if (subdir_slash_pos != std::string::npos) // subdirectory or files in a subdirectory
 			{
-				std::string::size_type subdir_slash_pos = filename.find('/', path.size());
-
-				if (subdir_slash_pos != std::string::npos) // subdirectory or files in a subdirectory
-				{
-					bool dir_added = false;
-					std::string directory_name = filename.substr(path.size(), subdir_slash_pos - path.size());
-
-					for (auto & added_directory : added_directories)
-					{
-						if (added_directory == directory_name)
-							dir_added = true;
-					}
-
-					if (!dir_added)
-					{
-						ZipFileEntry dir_entry;
-						dir_entry.set_archive_filename(directory_name);
-						dir_entry.set_directory(true);
-						files.push_back(dir_entry);
-
-						added_directories.push_back(directory_name);
-					}
-				}
-				else if (elem.get_archive_filename() != path)
+				// Compared by normalized name, so directories differing only in case are listed once when case insensitive
+				std::string directory_key = it->first.substr(normalized_path.size(), subdir_slash_pos - normalized_path.size());
+				if (last_directory.empty() || directory_key != last_directory)
 				{
-					std::string file_name = filename.substr(path.size(), std::string::npos);
-					ZipFileEntry file_entry;
-					file_entry.set_archive_filename(file_name);
-					files.push_back(file_entry);
+					ZipFileEntry dir_entry;
+					dir_entry.set_archive_filename(filename.substr(normalized_path.size(), subdir_slash_pos - normalized_path.size()));
+					dir_entry.set_directory(true);
+					files.push_back(dir_entry);
+					last_directory = directory_key;
 				}
 			}
+			else
+			{
+				ZipFileEntry file_entry;
+				file_entry.set_archive_filename(filename.substr(normalized_path.size(), std::string::npos));
+				files.push_back(file_entry);
+			}
 		}
 
 		return files;
@@ -142,39 +144,63 @@ namespace clan
 
 	IODevice ZipArchive::open_file(const std::string &filename)
 	{
-		int size = impl->files.size();
-		for (int i = 0; i < size; i++)
+		int index = impl->find_file(filename);
+		if (index == -1)
+			throw Exception(string_format("Unable to find zip index %1", filename));
+
+		ZipFileEntry &entry = impl->files[index];
+		switch (entry.impl->type)
+		{
+		case ZipFileEntry_Impl::type_file:
 		{
-			ZipFileEntry &entry = impl->files[i];
+			IODevice dupe = impl->input.duplicate();
+			DataBufferView mapped_data;
+			if (!impl->mapping.is_null())
+				mapped_data = impl->get_mapped_data(entry.impl->record.relative_offset_of_local_header, entry.impl->record.compressed_size);
+			return IODevice(new ZipIODevice_FileEntry(dupe, entry, impl->checkpoint_interval, mapped_data));
+		}
 
-			std::string entry_filename = entry.impl->record.filename;
-			if (entry_filename[0] == '/')
-				entry_filename = entry_filename.substr(1, std::string::npos);
+		case ZipFileEntry_Impl::type_removed:
+			throw Exception(string_format("Unable to zip open file entry %1. The entry has been removed!", filename));
+			break;
 
-			if (entry_filename == filename)
-			{
-				switch (entry.impl->type)
-				{
-				case ZipFileEntry_Impl::type_file:
-				{
-					IODevice dupe = impl->input.duplicate();
-					return IODevice(new ZipIODevice_FileEntry(dupe, entry));
-				}
+		case ZipFileEntry_Impl::type_added_memory:
+			return MemoryDevice(entry.impl->data);
 
-				case ZipFileEntry_Impl::type_removed:
-					throw Exception(string_format("Unable to zip open file entry %1. The entry has been removed!", filename));
-					break;
+		case ZipFileEntry_Impl::type_added_file:
+			return File(entry.impl->filename);
+		}
+		throw Exception(string_format("Unknown zip file entry type %1", filename));
+	}
+
+	DataBufferView ZipArchive::read_file(const std::string &filename)
+	{
+		int index = impl->find_file(filename);
+		if (index != -1 && !impl->mapping.is_null())
+		{
+			ZipFileEntry &entry = impl->files[index];
+			if (entry.impl->type == ZipFileEntry_Impl::type_file && entry.impl->record.compression_method == zip_compress_store)
+				return impl->get_mapped_data(entry.impl->record.relative_offset_of_local_header, entry.impl->record.compressed_size);
+		}
 
-				case ZipFileEntry_Impl::type_added_memory:
-					return MemoryDevice(entry.impl->data);
+		IODevice file = open_file(filename);
+		DataBuffer data(file.get_size());
+		file.read(data.get_data(), data.get_size());
+		return DataBufferView(data);
+	}
 
-				case ZipFileEntry_Impl::type_added_file:
-					return File(entry.impl->filename);
-				}
-				throw Exception(string_format("Unknown zip file entry type %1", filename));
-			}
+	void ZipArchive::set_case_insensitive(bool enable)
+	{
+		if (impl->case_insensitive != enable)
+		{
+			impl->case_insensitive = enable;
+			impl->index_dirty = true;
 		}
-		throw Exception(string_format("Unable to find zip index %1", filename));
+	}
+
+	void ZipArchive::set_seek_checkpoint_interval(int bytes)
+	{
+		impl->checkpoint_interval = bytes;
 	}
 
 	std::string ZipArchive::get_pathname(const std::string &filename)
@@ -193,6 +219,7 @@ namespace clan
 		file_entry.set_input_filename(input_filename);
 		file_entry.set_archive_filename(archive_filename);
 		impl->files.push_back(file_entry);
+		impl->index_dirty = true;
 	}
 
 	void ZipArchive::save()
@@ -204,7 +231,7 @@ namespace clan
 	{
 		File output(filename, File::create_always, File::access_read_write);
 
-		std::vector<int> local_header_offsets;
+		std::vector<int64_t> local_header_offsets;
 		std::vector<uint32_t> crc32_codes;
 
 		int16_t dos_date = 0, dos_time = 0;
@@ -246,7 +273,7 @@ namespace clan
 		}
 
 		int index = 0;
-		int offset_start_central_dir = output.get_position();
+		int64_t offset_start_central_dir = output.get_position();
 
 		// write central directory entries.
 		for (it = impl->files.begin(); it != impl->files.end(); ++it)
@@ -281,7 +308,7 @@ namespace clan
 			digi_sign.size_of_data = 0;
 			digi_sign.save(output);*/
 
-		int central_dir_size = output.get_position() - offset_start_central_dir;
+		int64_t central_dir_size = output.get_position() - offset_start_central_dir;
 
 		ZipEndOfCentralDirectoryRecord central_dir_end;
 
@@ -306,13 +333,13 @@ namespace clan
 
 		// Find end of central directory record:
 
-		int size_file = input.get_size();
+		int64_t size_file = input.get_size();
 
 		char buffer[32 * 1024];
 		if (size_file > 32 * 1024) input.seek(-32 * 1024, IODevice::seek_end);
 		int size_buffer = input.read(buffer, 32 * 1024);
 
-		int end_record_pos = -1;
+		int64_t end_record_pos = -1;
 		for (int pos = size_buffer - 4; pos >= 0; pos--)
 		{
 #ifdef USE_BIG_ENDIAN
@@ -342,7 +369,7 @@ namespace clan
 		Zip64EndOfCentralDirectoryLocator zip64_locator;
 		Zip64EndOfCentralDirectoryRecord zip64_end_of_directory;
 
-		int end64_locator = end_record_pos - 20;
+		int64_t end64_locator = end_record_pos - 20;
 		input.seek(end64_locator, IODevice::seek_set);
 		if (input.read_uint32() == 0x07064b50)
 		{
@@ -351,7 +378,7 @@ namespace clan
 			input.seek(end64_locator, IODevice::seek_set);
 			zip64_locator.load(input);
 
-			input.seek(int(end64_locator + zip64_locator.relative_offset_of_zip64_end_of_central_directory), IODevice::seek_set);
+			input.seek(zip64_locator.relative_offset_of_zip64_end_of_central_directory, IODevice::seek_set);
 			zip64_end_of_directory.load(input);
 
 			zip64 = true;
@@ -359,22 +386,88 @@ namespace clan
 
 		// Load central directory records:
 
-		if (zip64) input.seek(int(zip64_end_of_directory.offset_to_start_of_central_directory), IODevice::seek_set);
-		else input.seek(int(end_of_directory.offset_to_start_of_central_directory), IODevice::seek_set);
+		if (zip64) input.seek(zip64_end_of_directory.offset_to_start_of_central_directory, IODevice::seek_set);
+		else input.seek((uint32_t)end_of_directory.offset_to_start_of_central_directory, IODevice::seek_set);
 
 		int64_t num_entries = end_of_directory.number_of_entries_in_central_directory;
 		if (zip64) num_entries = zip64_end_of_directory.number_of_entries_in_central_directory;
 
-		for (int i = 0; i < num_entries; i++)
+		for (int64_t i = 0; i < num_entries; i++)
 		{
 			ZipFileEntry entry;
 			entry.impl->record.load(input);
 			impl->files.push_back(entry);
 		}
+		impl->index_dirty = true;
 	}
 
 	/////////////////////////////////////////////////////////////////////////////
 
+	DataBufferView ZipArchive_Impl::get_mapped_data(int64_t header_offset, int64_t compressed_size) const
+	{
+		// The local header repeats the name and has its own extra field, so its size must be read from it
+		const unsigned char *data = mapping.get_data<unsigned char>();
+		if (header_offset < 0 || compressed_size < 0 || (uint64_t)header_offset + 30 > mapping.get_size() || data[header_offset] != 'P' || data[header_offset + 1] != 'K' || data[header_offset + 2] != 3 || data[header_offset + 3] != 4)
+			throw Exception("Invalid zip local file header");
+
+		uint32_t file_name_length = data[header_offset + 26] | (data[header_offset + 27] << 8);
+		uint32_t extra_field_length = data[header_offset + 28] | (data[header_offset + 29] << 8);
+		uint64_t data_offset = (uint64_t)header_offset + 30 + file_name_length + extra_field_length;
+		uint64_t size = compressed_size;
+		if (data_offset + size > mapping.get_size())
+			throw Exception("Zip file entry data is outside the archive");
+
+		return DataBufferView(mapping, (unsigned int)data_offset, (unsigned int)size);
+	}
+
+	int ZipArchive_Impl::find_file(const std::string &filename)
+	{
+		if (index_dirty)
+			build_index();
+
+		auto it = file_index.find(normalize_filename(filename));
+		return it != file_index.end() ? (int)it->second : -1;
+	}
+
+	const std::vector<std::pair<std::string, size_t> > &ZipArchive_Impl::get_sorted_index()
+	{
+		if (index_dirty)
+			build_index();
+		return sorted_index;
+	}
+
+	std::string ZipArchive_Impl::normalize_filename(const std::string &filename) const
+	{
+		std::string normalized = (!filename.empty() && filename[0] == '/') ? filename.substr(1) : filename;
+		if (case_insensitive)
+		{
+			for (auto &c : normalized)
+			{
+				if (c >= 'A' && c <= 'Z')
+					c += 'a' - 'A';
+			}
+		}
+		return normalized;
+	}
+
+	void ZipArchive_Impl::build_index()
+	{
+		file_index.clear();
+		file_index.reserve(files.size());
+		sorted_index.clear();
+		sorted_index.reserve(files.size());
+
+		for (size_t i = 0; i < files.size(); i++)
+		{
+			std::string name = normalize_filename(files[i].get_archive_filename());
+			file_index.emplace(name, i);	// The first entry wins when names repeat, as in the linear search it replaces
+			sorted_index.push_back(std::make_pair("/" + name, i));
+		}
+		std::sort(sorted_index.begin(), sorted_index.end());
+
+		index_dirty = false;
+	}
+
 	void ZipArchive_Impl::calc_time_and_date(int16_t &out_date, int16_t &out_time)
 	{
 		uint32_t day_of_month = 0;
@@ -426,6 +519,66 @@ namespace clan
 			return crc;
 	}
 
+	namespace
+	{
+		uint32_t gf2_matrix_times(const uint32_t *matrix, uint32_t vector)
+		{
+			uint32_t sum = 0;
+			for (int i = 0; vector; i++, vector >>= 1)
+			{
+				if (vector & 1)
+					sum ^= matrix[i];
+			}
+			return sum;
+		}
+
+		void gf2_matrix_square(uint32_t *square, const uint32_t *matrix)
+		{
+			for (int i = 0; i < 32; i++)
+				square[i] = gf2_matrix_times(matrix, matrix[i]);
+		}
+	}
+
+	uint32_t ZipArchive_Impl::combine_crc32(uint32_t crc1, uint32_t crc2, int64_t length2)
+	{
+		// Appending length2 zero bytes to the first block is a linear operation on its CRC. It is applied
+		// with an operator matrix that is squared for each bit of the length, as done by zlib's crc32_combine.
+		if (length2 <= 0)
+			return crc1;
+
+		uint32_t even[32];
+		uint32_t odd[32];
+
+		// Operator for one zero bit
+		odd[0] = 0xedb88320;
+		uint32_t row = 1;
+		for (int i = 1; i < 32; i++)
+		{
+			odd[i] = row;
+			row <<= 1;
+		}
+
+		gf2_matrix_square(even, odd);	// Two zero bits
+		gf2_matrix_square(odd, even);	// Four zero bits
+
+		do
+		{
+			gf2_matrix_square(even, odd);
+			if (length2 & 1)
+				crc1 = gf2_matrix_times(even, crc1);
+			length2 >>= 1;
+			if (length2 == 0)
+				break;
+
+			gf2_matrix_square(odd, even);
+			if (length2 & 1)
+				crc1 = gf2_matrix_times(odd, crc1);
+			length2 >>= 1;
+		} while (length2 != 0);
+
+		return crc1 ^ crc2;
+	}
+
 	uint32_t ZipArchive_Impl::crc32_table[256] =
 	{
 		0x00000000, 0x77073096, 0xee0e612c, 0x990951ba,
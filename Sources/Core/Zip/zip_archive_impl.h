@@ -30,7 +30,12 @@
 
 #include "API/Core/Zip/zip_file_entry.h"
 #include "API/Core/IOData/iodevice.h"
+#include "API/Core/System/databuffer_view.h"
 #include "zip_flags.h"
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace clan
 {
@@ -40,10 +45,39 @@ namespace clan
 		std::vector<ZipFileEntry> files;
 		IODevice input;
 
+		/// \brief The whole archive, when it was memory mapped
+		DataBuffer mapping;
+
+		/// \brief Returns the compressed data of an entry in the mapped archive
+		DataBufferView get_mapped_data(int64_t local_header_offset, int64_t compressed_size) const;
+
+		/// \brief Returns the index in files of an entry, or -1 if not found
+		int find_file(const std::string &filename);
+
+		/// \brief Returns the entries sorted by their normalized name, for prefix searches
+		const std::vector<std::pair<std::string, size_t> > &get_sorted_index();
+
+		/// \brief Returns the name an entry is indexed by: without a leading slash and case folded if requested
+		std::string normalize_filename(const std::string &filename) const;
+
+		bool case_insensitive = false;
+		int checkpoint_interval = 256 * 1024;
+
+		/// \brief Set when files has changed and the indexes need to be rebuilt
+		bool index_dirty = true;
+
 		static uint32_t calc_crc32(const void *data, int64_t size, uint32_t crc = ZIP_CRC_START_VALUE, bool last_block = true);
+
+		/// \brief Returns the CRC-32 of two concatenated blocks from the CRC-32 of each block and the length of the second
+		static uint32_t combine_crc32(uint32_t crc1, uint32_t crc2, int64_t length2);
 		static void calc_time_and_date(int16_t &out_date, int16_t &out_time);
 
 	private:
+		void build_index();
+
+		std::unordered_map<std::string, size_t> file_index;
+		std::vector<std::pair<std::string, size_t> > sorted_index;
+
 		// crc32_table_quotient = 0xdebb20e3
 		static uint32_t crc32_table[256];
 	};
@@ -42,6 +42,8 @@ namespace clan
 		zip_compress_tokenize,
 		zip_compress_deflate,
 		zip_compress_deflate64,
-		zip_compress_pkware_implode
+		zip_compress_pkware_implode,
+		zip_compress_zstd = 93,
+		zip_compress_lz4 = 0x4c34 // Not assigned by the zip specification, only read by ClanLib
 	};
 }
@@ -31,6 +31,7 @@
 #include "API/Core/IOData/iodevice.h"
 #include "API/Core/Text/string_help.h"
 #include "zip_flags.h"
+#include "zip_64_extended_information.h"
 
 namespace clan
 {
@@ -57,15 +58,15 @@ namespace clan
 		last_mod_file_time = input.read_int16();
 		last_mod_file_date = input.read_int16();
 		crc32 = input.read_uint32();
-		compressed_size = input.read_int32();
-		uncompressed_size = input.read_int32();
+		compressed_size = Zip64ExtendedInformation::from_uint32(input.read_uint32());
+		uncompressed_size = Zip64ExtendedInformation::from_uint32(input.read_uint32());
 		file_name_length = input.read_int16();
 		extra_field_length = input.read_int16();
 		file_comment_length = input.read_int16();
 		disk_number_start = input.read_int16();
 		internal_file_attributes = input.read_int16();
 		external_file_attributes = input.read_int32();
-		relative_offset_of_local_header = input.read_int32();
+		relative_offset_of_local_header = Zip64ExtendedInformation::from_uint32(input.read_uint32());
 		filename.resize(file_name_length);
 
 		auto str1 = new char[file_name_length];
@@ -88,6 +89,7 @@ namespace clan
 			}
 
 			extra_field = DataBuffer(str2, extra_field_length);
+			Zip64ExtendedInformation::apply(extra_field, uncompressed_size, compressed_size, &relative_offset_of_local_header);
 
 			delete[] str1;
 			delete[] str2;
@@ -128,15 +130,15 @@ namespace clan
 		output.write_int16(last_mod_file_time);
 		output.write_int16(last_mod_file_date);
 		output.write_uint32(crc32);
-		output.write_int32(compressed_size);
-		output.write_int32(uncompressed_size);
+		output.write_uint32(Zip64ExtendedInformation::to_uint32(compressed_size));
+		output.write_uint32(Zip64ExtendedInformation::to_uint32(uncompressed_size));
 		output.write_int16(file_name_length);
 		output.write_int16(extra_field_length);
 		output.write_int16(file_comment_length);
 		output.write_int16(disk_number_start);
 		output.write_int16(internal_file_attributes);
 		output.write_int32(external_file_attributes);
-		output.write_int32(relative_offset_of_local_header);
+		output.write_uint32(Zip64ExtendedInformation::to_uint32(relative_offset_of_local_header));
 		output.write(str_filename.data(), file_name_length);
 		output.write(extra_field.get_data(), extra_field_length);
 		output.write(file_comment.data(), file_comment_length);
@@ -49,15 +49,15 @@ namespace clan
 		int16_t last_mod_file_time;
 		int16_t last_mod_file_date;
 		uint32_t crc32;
-		int32_t compressed_size;
-		int32_t uncompressed_size;
+		int64_t compressed_size;
+		int64_t uncompressed_size;
 		int16_t file_name_length;
 		int16_t extra_field_length;
 		int16_t file_comment_length;
 		int16_t disk_number_start;
 		int16_t internal_file_attributes;
 		int32_t external_file_attributes;
-		int32_t relative_offset_of_local_header;
+		int64_t relative_offset_of_local_header;
 		std::string filename;
 		DataBuffer extra_field;
 		std::string file_comment;
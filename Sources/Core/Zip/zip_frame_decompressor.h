@@ -0,0 +1,79 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include "API/Core/Zip/zstd_compression.h"
+#include "API/Core/Zip/lz4_compression.h"
+#include "zip_compression_method.h"
+
+namespace clan
+{
+	/// \brief Decompresses file entries stored with the Zstandard or LZ4 methods
+	///
+	/// The compressed data of an entry may be several concatenated frames, which are decompressed as one stream.
+	class ZipFrameDecompressor
+	{
+	public:
+		ZipFrameDecompressor(int compression_method)
+		{
+			if (compression_method == zip_compress_zstd)
+				zstd.reset(new ZstdDecompressor());
+			else if (compression_method == zip_compress_lz4)
+				lz4.reset(new LZ4Decompressor());
+			else
+				throw Exception("Unsupported zip frame compression method");
+		}
+
+		void reset()
+		{
+			if (zstd)
+				zstd->reset();
+			else
+				lz4->reset();
+		}
+
+		void decompress(const void *input, unsigned int input_size, unsigned int &input_used, void *output, unsigned int output_size, unsigned int &output_used)
+		{
+			if (zstd)
+				zstd->decompress(input, input_size, input_used, output, output_size, output_used);
+			else
+				lz4->decompress(input, input_size, input_used, output, output_size, output_used);
+		}
+
+		static bool is_frame_method(int compression_method)
+		{
+			return compression_method == zip_compress_zstd || compression_method == zip_compress_lz4;
+		}
+
+	private:
+		std::unique_ptr<ZstdDecompressor> zstd;
+		std::unique_ptr<LZ4Decompressor> lz4;
+	};
+}
@@ -37,8 +37,9 @@
 
 namespace clan
 {
-	ZipIODevice_FileEntry::ZipIODevice_FileEntry(IODevice iodevice, const ZipFileEntry &entry)
-		: iodevice(iodevice), file_entry(entry), zstream_open(false), peeked_data(0)
+	ZipIODevice_FileEntry::ZipIODevice_FileEntry(IODevice iodevice, const ZipFileEntry &entry, int checkpoint_interval, const DataBufferView &mapped_data)
+		: iodevice(iodevice), file_entry(entry), zstream_open(false), frame_next_in(nullptr), frame_avail_in(0), peeked_data(0), peeked_pos(0), data_offset(0), mapped_data(mapped_data),
+		checkpoint_interval(checkpoint_interval), record_checkpoints(false), inflate_state(nullptr), inflate_state_size(0)
 	{
 		init();
 	}
@@ -48,14 +49,14 @@ namespace clan
 		deinit();
 	}
 
-	int ZipIODevice_FileEntry::get_size() const
+	int64_t ZipIODevice_FileEntry::get_size() const
 	{
 		return file_header.uncompressed_size;
 	}
 
-	int ZipIODevice_FileEntry::get_position() const
+	int64_t ZipIODevice_FileEntry::get_position() const
 	{
-		return (int)pos;
+		return pos;
 	}
 
 	int ZipIODevice_FileEntry::send(const void *data, int len, bool send_all)
@@ -67,14 +68,21 @@ namespace clan
 	{
 		if (size == 0)
 			return 0;
-		if (peeked_data.get_size() > 0)
+		int peeked_available = peeked_data.get_size() - peeked_pos;
+		if (peeked_available > 0)
 		{
-			int peek_amount = min(size, peeked_data.get_size());
-			memcpy(buffer, peeked_data.get_data(), peek_amount);
-			memmove(peeked_data.get_data(), peeked_data.get_data() + peek_amount, peeked_data.get_size() - peek_amount);
-			peeked_data.set_size(peeked_data.get_size() - peek_amount);
-			if (peek_amount <= size)
+			// Consume the peeked bytes by advancing the read offset. The buffer is only compacted when more data is peeked.
+			int peek_amount = min(size, peeked_available);
+			memcpy(buffer, peeked_data.get_data() + peeked_pos, peek_amount);
+			peeked_pos += peek_amount;
+			if (peeked_pos == (int)peeked_data.get_size())
+			{
+				peeked_data.set_size(0);
+				peeked_pos = 0;
+			}
+			if (peek_amount < size)
 				return peek_amount + receive((char*)buffer + peek_amount, size - peek_amount, receive_all);
+			return peek_amount;
 		}
 
 		return lowlevel_read(buffer, size, receive_all);
@@ -82,13 +90,21 @@ namespace clan
 
 	int ZipIODevice_FileEntry::peek(void *data, int len)
 	{
-		if (peeked_data.get_size() >= len)
+		int peeked_available = peeked_data.get_size() - peeked_pos;
+		if (peeked_available >= len)
 		{
-			memcpy(data, peeked_data.get_data(), len);
+			memcpy(data, peeked_data.get_data() + peeked_pos, len);
 			return len;
 		}
 		else
 		{
+			if (peeked_pos > 0)
+			{
+				memmove(peeked_data.get_data(), peeked_data.get_data() + peeked_pos, peeked_available);
+				peeked_data.set_size(peeked_available);
+				peeked_pos = 0;
+			}
+
 			int old_size = peeked_data.get_size();
 			try
 			{
@@ -106,7 +122,7 @@ namespace clan
 		}
 	}
 
-	bool ZipIODevice_FileEntry::seek(int seek_pos, IODevice::SeekMode mode)
+	bool ZipIODevice_FileEntry::seek(int64_t seek_pos, IODevice::SeekMode mode)
 	{
 		int64_t absolute_pos = 0;
 		switch (mode)
@@ -124,27 +140,66 @@ namespace clan
 			break;
 		}
 
+		if (absolute_pos < 0 || absolute_pos > file_header.uncompressed_size)
+			return false;
+
 		switch (file_header.compression_method)
 		{
 		case zip_compress_store: // no compression
-			iodevice.seek(int(absolute_pos - pos), IODevice::seek_cur);
+			if (!iodevice.seek(data_offset + absolute_pos, IODevice::seek_set))
+				return false;
+			pos = absolute_pos;
+			peeked_data.set_size(0);
+			peeked_pos = 0;
 			break;
 
 		case zip_compress_deflate:
-			// if backward seeking, restart at beginning of stream.
+		{
+			// Continue from the closest checkpoint before the position, unless the stream is already closer
+			const InflateCheckpoint *checkpoint = find_checkpoint(absolute_pos);
+			if (checkpoint && (absolute_pos < pos || checkpoint->pos > pos))
+			{
+				restore_checkpoint(*checkpoint);
+			}
+			else if (absolute_pos < pos)
+			{
+				// Restart at beginning of stream. Seeking backwards suggests random access, so save checkpoints from now on.
+				deinit();
+				init();
+				peeked_data.set_size(0);
+				peeked_pos = 0;
+				record_checkpoints = checkpoint_interval > 0;
+			}
+
+			char buffer[16 * 1024];
+			while (absolute_pos > pos)
+			{
+				int received = receive(buffer, int(min(absolute_pos - pos, (int64_t)sizeof(buffer))), true);
+				if (received == 0) break;
+			}
+			break;
+		}
+
+		case zip_compress_zstd:
+		case zip_compress_lz4:
+		{
+			// Frames are not checkpointed, so seeking backwards restarts the stream
 			if (absolute_pos < pos)
 			{
 				deinit();
 				init();
+				peeked_data.set_size(0);
+				peeked_pos = 0;
 			}
 
-			char buffer[1024];
+			char buffer[16 * 1024];
 			while (absolute_pos > pos)
 			{
-				int received = receive(buffer, int(min(absolute_pos - pos, (int64_t)1024)), true);
+				int received = receive(buffer, int(min(absolute_pos - pos, (int64_t)sizeof(buffer))), true);
 				if (received == 0) break;
 			}
 			break;
+		}
 
 		case zip_compress_shrunk:
 		case zip_compress_expand_factor_1:
@@ -162,7 +217,7 @@ namespace clan
 
 	IODeviceProvider *ZipIODevice_FileEntry::duplicate()
 	{
-		ZipIODevice_FileEntry *new_provider = new ZipIODevice_FileEntry(this, file_entry);
+		ZipIODevice_FileEntry *new_provider = new ZipIODevice_FileEntry(this, file_entry, checkpoint_interval, mapped_data);
 		return new_provider;
 	}
 
@@ -171,6 +226,7 @@ namespace clan
 	{
 		iodevice.seek(file_entry.impl->record.relative_offset_of_local_header, IODevice::seek_set);
 		file_header.load(iodevice);
+		data_offset = iodevice.get_position();
 
 		//This fix allows OS X created .zips to be opened - SAR
 		if (file_header.general_purpose_bit_flag  & ZIP_CRC32_IN_FILE_DESCRIPTOR) //if this bit is set, it means the local header data for sizes was not
@@ -194,15 +250,26 @@ namespace clan
 			memset(&zs, 0, sizeof(mz_stream));
 			zs.next_in = nullptr;
 			zs.avail_in = 0;
-			zs.zalloc = nullptr;
-			zs.zfree = nullptr;
-			zs.opaque = nullptr;
+			zs.zalloc = &ZipIODevice_FileEntry::inflate_alloc;
+			zs.zfree = &ZipIODevice_FileEntry::inflate_free;
+			zs.opaque = this;
 			//result = inflateInit(&zs);
 			result = mz_inflateInit2(&zs, -15); // Undocumented: if wbits is negative, zlib skips header check
 			if (result != MZ_OK) throw Exception("Zlib inflateInit failed for zip index!");
 			zstream_open = true;
 			break;
 
+		case zip_compress_zstd:
+		case zip_compress_lz4:
+			// The decompressor is kept when the stream restarts
+			if (frame_decompressor)
+				frame_decompressor->reset();
+			else
+				frame_decompressor.reset(new ZipFrameDecompressor(file_header.compression_method));
+			frame_next_in = nullptr;
+			frame_avail_in = 0;
+			break;
+
 		case zip_compress_shrunk:
 		case zip_compress_expand_factor_1:
 		case zip_compress_expand_factor_2:
@@ -231,6 +298,10 @@ namespace clan
 			zstream_open = false;
 			break;
 
+		case zip_compress_zstd:
+		case zip_compress_lz4:
+			break;
+
 		case zip_compress_shrunk:
 		case zip_compress_expand_factor_1:
 		case zip_compress_expand_factor_2:
@@ -263,20 +334,8 @@ namespace clan
 			while (zs.avail_out > 0)
 			{
 				// zlib needs more data:
-				if (zs.avail_in == 0 && compressed_pos < file_header.compressed_size)
-				{
-					// Read some compressed data:
-					int received_input = 0;
-					while (received_input < 16 * 1024)
-					{
-						received_input += iodevice.receive(zbuffer, int(min((int64_t)16 * 1024, file_header.compressed_size - compressed_pos)), true);
-						if (compressed_pos + received_input == file_header.compressed_size) break;
-					}
-					compressed_pos += received_input;
-
-					zs.next_in = (unsigned char *)zbuffer;
-					zs.avail_in = received_input;
-				}
+				if (zs.avail_in == 0)
+					read_compressed_input(zs.next_in, zs.avail_in);
 
 				// Decompress data:
 				int result = mz_inflate(&zs, 0);
@@ -289,8 +348,14 @@ namespace clan
 				if (result != MZ_OK) throw Exception("Zlib inflate failed while decompressing zip file!");
 			}
 			pos += size - zs.avail_out;
+			if (record_checkpoints && pos >= (checkpoints.empty() ? 0 : checkpoints.back().pos) + checkpoint_interval)
+				add_checkpoint();
 			return size - zs.avail_out;
 
+		case zip_compress_zstd:
+		case zip_compress_lz4:
+			return frame_read(data, size);
+
 		case zip_compress_shrunk:
 		case zip_compress_expand_factor_1:
 		case zip_compress_expand_factor_2:
@@ -305,4 +370,121 @@ namespace clan
 
 		return 0;
 	}
+
+	int ZipIODevice_FileEntry::frame_read(void *data, int size)
+	{
+		int received = 0;
+		while (received < size)
+		{
+			if (frame_avail_in == 0)
+				read_compressed_input(frame_next_in, frame_avail_in);
+
+			unsigned int input_used = 0, output_used = 0;
+			frame_decompressor->decompress(frame_next_in, frame_avail_in, input_used, (char *)data + received, size - received, output_used);
+			frame_next_in += input_used;
+			frame_avail_in -= input_used;
+			received += output_used;
+
+			// Stop when the input is used up and nothing more comes out, at the end of the entry or if the input ends early
+			if (input_used == 0 && output_used == 0 && frame_avail_in == 0)
+				break;
+		}
+		pos += received;
+		return received;
+	}
+
+	void ZipIODevice_FileEntry::read_compressed_input(const unsigned char *&next_in, unsigned int &avail_in)
+	{
+		if (compressed_pos >= file_header.compressed_size)
+			return;
+
+		if (!mapped_data.is_null())
+		{
+			// Decompress straight from the mapped archive
+			next_in = mapped_data.get_data<unsigned char>() + compressed_pos;
+			avail_in = (unsigned int)(mapped_data.get_size() - compressed_pos);
+			compressed_pos = mapped_data.get_size();
+		}
+		else
+		{
+			// Read some compressed data:
+			int received_input = 0;
+			while (received_input < 16 * 1024)
+			{
+				received_input += iodevice.receive(zbuffer, int(min((int64_t)16 * 1024, file_header.compressed_size - compressed_pos)), true);
+				if (compressed_pos + received_input == file_header.compressed_size) break;
+			}
+			compressed_pos += received_input;
+
+			next_in = (unsigned char *)zbuffer;
+			avail_in = received_input;
+		}
+	}
+
+	void ZipIODevice_FileEntry::add_checkpoint()
+	{
+		if (!inflate_state)
+			return;
+
+		InflateCheckpoint checkpoint;
+		checkpoint.pos = pos;
+		checkpoint.compressed_pos = compressed_pos - zs.avail_in;
+		checkpoint.stream = zs;
+		checkpoint.state = DataBuffer(inflate_state, inflate_state_size);
+		checkpoints.push_back(checkpoint);
+	}
+
+	void ZipIODevice_FileEntry::restore_checkpoint(const InflateCheckpoint &checkpoint)
+	{
+		if (!inflate_state || checkpoint.state.get_size() != inflate_state_size)
+			throw Exception("Zip inflate checkpoint does not match the stream");
+
+		mz_internal_state *state = zs.state;
+		zs = checkpoint.stream;
+		zs.state = state;
+		memcpy(inflate_state, checkpoint.state.get_data(), inflate_state_size);
+
+		// Compressed input buffered at the time of the checkpoint is read again
+		zs.next_in = (unsigned char *)zbuffer;
+		zs.avail_in = 0;
+		iodevice.seek(data_offset + checkpoint.compressed_pos, IODevice::seek_set);
+		compressed_pos = checkpoint.compressed_pos;
+		pos = checkpoint.pos;
+
+		peeked_data.set_size(0);
+		peeked_pos = 0;
+	}
+
+	const ZipIODevice_FileEntry::InflateCheckpoint *ZipIODevice_FileEntry::find_checkpoint(int64_t position) const
+	{
+		// Checkpoints are added in increasing position order
+		const InflateCheckpoint *found = nullptr;
+		for (const auto &checkpoint : checkpoints)
+		{
+			if (checkpoint.pos > position)
+				break;
+			found = &checkpoint;
+		}
+		return found;
+	}
+
+	void *ZipIODevice_FileEntry::inflate_alloc(void *opaque, size_t items, size_t size)
+	{
+		ZipIODevice_FileEntry *self = static_cast<ZipIODevice_FileEntry *>(opaque);
+		void *address = malloc(items * size);
+		self->inflate_state = address;
+		self->inflate_state_size = address ? items * size : 0;
+		return address;
+	}
+
+	void ZipIODevice_FileEntry::inflate_free(void *opaque, void *address)
+	{
+		ZipIODevice_FileEntry *self = static_cast<ZipIODevice_FileEntry *>(opaque);
+		if (self->inflate_state == address)
+		{
+			self->inflate_state = nullptr;
+			self->inflate_state_size = 0;
+		}
+		free(address);
+	}
 }
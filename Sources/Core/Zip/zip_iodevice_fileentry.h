@@ -31,8 +31,11 @@
 #include "API/Core/IOData/iodevice_provider.h"
 #include "API/Core/Zip/zip_file_entry.h"
 #include "API/Core/System/databuffer.h"
+#include "API/Core/System/databuffer_view.h"
 #include "zip_local_file_header.h"
+#include "zip_frame_decompressor.h"
 #include <stack>
+#include <vector>
 #include "Core/Zip/miniz.h"
 
 namespace clan
@@ -40,24 +43,46 @@ namespace clan
 	class ZipIODevice_FileEntry : public IODeviceProvider
 	{
 	public:
-		ZipIODevice_FileEntry(IODevice iodevice, const ZipFileEntry &entry);
+		/// \brief Constructs the device
+		///
+		/// \param checkpoint_interval = Uncompressed bytes between saved inflate states, used to seek in deflated entries. 0 disables them.
+		/// \param mapped_data = Compressed data of the entry in a memory mapped archive. Inflated from directly when set.
+		ZipIODevice_FileEntry(IODevice iodevice, const ZipFileEntry &entry, int checkpoint_interval = 0, const DataBufferView &mapped_data = DataBufferView());
 		~ZipIODevice_FileEntry();
 
-		virtual int get_size() const override;
-		virtual int get_position() const override;
+		virtual int64_t get_size() const override;
+		virtual int64_t get_position() const override;
 
 		virtual int send(const void *data, int len, bool send_all) override;
 		virtual int receive(void *data, int len, bool receive_all) override;
 		virtual int peek(void *data, int len) override;
 
-		virtual bool seek(int position, IODevice::SeekMode mode) override;
+		virtual bool seek(int64_t position, IODevice::SeekMode mode) override;
 
 		IODeviceProvider *duplicate() override;
 
 	private:
+		/// \brief Copy of the inflate stream, taken while reading forward
+		struct InflateCheckpoint
+		{
+			int64_t pos;
+			int64_t compressed_pos;	// Compressed bytes consumed by the stream
+			mz_stream stream;
+			DataBuffer state;
+		};
+
 		void init();
 		void deinit();
 		int lowlevel_read(void *buffer, int size, bool read_all);
+		int frame_read(void *buffer, int size);
+		void read_compressed_input(const unsigned char *&next_in, unsigned int &avail_in);
+
+		void add_checkpoint();
+		void restore_checkpoint(const InflateCheckpoint &checkpoint);
+		const InflateCheckpoint *find_checkpoint(int64_t position) const;
+
+		static void *inflate_alloc(void *opaque, size_t items, size_t size);
+		static void inflate_free(void *opaque, void *address);
 
 		IODevice iodevice;
 		ZipFileEntry file_entry;
@@ -66,6 +91,20 @@ namespace clan
 		mz_stream zs;
 		char zbuffer[16 * 1024];
 		bool zstream_open;
+		std::unique_ptr<ZipFrameDecompressor> frame_decompressor;
+		const unsigned char *frame_next_in;
+		unsigned int frame_avail_in;
 		DataBuffer peeked_data;
+		int peeked_pos;
+
+		int64_t data_offset;
+		DataBufferView mapped_data;
+		int checkpoint_interval;
+		bool record_checkpoints;
+		std::vector<InflateCheckpoint> checkpoints;
+
+		// The inflate state is allocated through inflate_alloc, so checkpoints can copy it without knowing its layout
+		void *inflate_state;
+		size_t inflate_state_size;
 	};
 }
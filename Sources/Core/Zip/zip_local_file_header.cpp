@@ -31,6 +31,7 @@
 #include "API/Core/IOData/iodevice.h"
 #include "API/Core/Text/string_help.h"
 #include "zip_flags.h"
+#include "zip_64_extended_information.h"
 
 namespace clan
 {
@@ -56,8 +57,8 @@ namespace clan
 		last_mod_file_time = input.read_int16();
 		last_mod_file_date = input.read_int16();
 		crc32 = input.read_uint32();
-		compressed_size = input.read_int32();
-		uncompressed_size = input.read_int32();
+		compressed_size = Zip64ExtendedInformation::from_uint32(input.read_uint32());
+		uncompressed_size = Zip64ExtendedInformation::from_uint32(input.read_uint32());
 		file_name_length = input.read_int16();
 		extra_field_length = input.read_int16();
 		auto str1 = new char[file_name_length];
@@ -72,6 +73,7 @@ namespace clan
 				filename = StringHelp::cp437_to_text(std::string(str1, file_name_length));
 
 			extra_field = DataBuffer(str2, extra_field_length);
+			Zip64ExtendedInformation::apply(extra_field, uncompressed_size, compressed_size, nullptr);
 
 			delete[] str1;
 			delete[] str2;
@@ -101,8 +103,8 @@ namespace clan
 		output.write_int16(last_mod_file_time);
 		output.write_int16(last_mod_file_date);
 		output.write_uint32(crc32);
-		output.write_int32(compressed_size);
-		output.write_int32(uncompressed_size);
+		output.write_uint32(Zip64ExtendedInformation::to_uint32(compressed_size));
+		output.write_uint32(Zip64ExtendedInformation::to_uint32(uncompressed_size));
 		output.write_int16(file_name_length);
 		output.write_int16(extra_field_length);
 
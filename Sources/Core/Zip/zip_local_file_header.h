@@ -48,8 +48,8 @@ namespace clan
 		int16_t last_mod_file_time;
 		int16_t last_mod_file_date;
 		uint32_t crc32;
-		int32_t compressed_size;
-		int32_t uncompressed_size;
+		int64_t compressed_size;
+		int64_t uncompressed_size;
 		int16_t file_name_length;
 		int16_t extra_field_length;
 		std::string filename;
@@ -31,6 +31,7 @@
 #include "zip_archive_impl.h"
 #include "zip_local_file_header.h"
 #include "zip_compression_method.h"
+#include "zip_frame_decompressor.h"
 #include "API/Core/Math/cl_math.h"
 #include "Core/Zip/miniz.h"
 
@@ -51,6 +52,7 @@ namespace clan
 		}
 
 		int64_t deflate_read(void *data, int64_t size, bool read_all);
+		int64_t frame_read(void *data, int64_t size);
 
 		IODevice input;
 		ZipLocalFileHeader local_header;
@@ -58,6 +60,10 @@ namespace clan
 		char zbuffer[16 * 1024];
 		bool zstream_open;
 		int64_t compressed_pos;
+		std::unique_ptr<ZipFrameDecompressor> frame_decompressor;
+		int frame_compression_method = 0;
+		const unsigned char *frame_next_in = nullptr;
+		unsigned int frame_avail_in = 0;
 	};
 
 	ZipReader::ZipReader(IODevice &input)
@@ -85,6 +91,8 @@ namespace clan
 		if (impl->zstream_open)
 			mz_inflateEnd(&impl->zs);
 		impl->zstream_open = false;
+		impl->frame_next_in = nullptr;
+		impl->frame_avail_in = 0;
 
 		if (impl->local_header.compression_method == zip_compress_deflate)
 		{
@@ -95,6 +103,20 @@ namespace clan
 			impl->zstream_open = true;
 			impl->compressed_pos = 0;
 		}
+		else if (ZipFrameDecompressor::is_frame_method(impl->local_header.compression_method))
+		{
+			// The decompressor is reused by following entries compressed with the same method
+			if (impl->frame_decompressor && impl->frame_compression_method == impl->local_header.compression_method)
+			{
+				impl->frame_decompressor->reset();
+			}
+			else
+			{
+				impl->frame_decompressor.reset(new ZipFrameDecompressor(impl->local_header.compression_method));
+				impl->frame_compression_method = impl->local_header.compression_method;
+			}
+			impl->compressed_pos = 0;
+		}
 		else if (impl->local_header.compression_method != zip_compress_store)
 		{
 			throw Exception("Zip file entry is compressed with an unsupported compression method");
@@ -136,6 +158,10 @@ namespace clan
 		{
 			return impl->deflate_read(data, size, read_all);
 		}
+		else if (ZipFrameDecompressor::is_frame_method(impl->local_header.compression_method))
+		{
+			return impl->frame_read(data, size);
+		}
 		else
 		{
 			return impl->input.read(data, size, read_all);
@@ -179,4 +205,32 @@ namespace clan
 		}
 		return size - zs.avail_out;
 	}
+
+	int64_t ZipReader_Impl::frame_read(void *data, int64_t size)
+	{
+		int64_t received = 0;
+		while (received < size)
+		{
+			if (frame_avail_in == 0 && compressed_pos < local_header.compressed_size)
+			{
+				// Read some compressed data:
+				int received_input = input.receive(zbuffer, int(min((int64_t)16 * 1024, local_header.compressed_size - compressed_pos)), true);
+				compressed_pos += received_input;
+
+				frame_next_in = (unsigned char *)zbuffer;
+				frame_avail_in = received_input;
+			}
+
+			unsigned int input_used = 0, output_used = 0;
+			frame_decompressor->decompress(frame_next_in, frame_avail_in, input_used, (char *)data + received, (unsigned int)min(size - received, (int64_t)16 * 1024 * 1024), output_used);
+			frame_next_in += input_used;
+			frame_avail_in -= input_used;
+			received += output_used;
+
+			// Stop when the input is used up and nothing more comes out, at the end of the entry or if the input ends early
+			if (input_used == 0 && output_used == 0 && frame_avail_in == 0)
+				break;
+		}
+		return received;
+	}
 }
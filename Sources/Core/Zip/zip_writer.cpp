@@ -29,6 +29,9 @@
 #include "Core/precomp.h"
 #include "API/Core/Zip/zip_writer.h"
 #include "API/Core/Text/string_help.h"
+#include "API/Core/System/work_queue.h"
+#include "API/Core/Zip/zstd_compression.h"
+#include "API/Core/Zip/lz4_compression.h"
 #include "zip_archive_impl.h"
 #include "zip_local_file_header.h"
 #include "zip_compression_method.h"
@@ -36,6 +39,9 @@
 #include "zip_end_of_central_directory_record.h"
 #include "zip_flags.h"
 #include "Core/Zip/miniz.h"
+#include <algorithm>
+#include <atomic>
+#include <deque>
 
 namespace clan
 {
@@ -44,13 +50,14 @@ namespace clan
 	public:
 		ZipWriter_Impl(IODevice &output, bool storeFilenamesAsUTF8)
 			: output(output), storeFilenamesAsUTF8(storeFilenamesAsUTF8), file_begun(false),
-			local_header_offset(0), uncompressed_length(0), compressed_length(0), compress(false)
+			local_header_offset(0), uncompressed_length(0), compressed_length(0), compress(false),
+			method(ZipWriter::compression_deflate), level(-1), block_size(0), block_used(0), blocks_in_flight(0)
 		{
 		}
 
 		~ZipWriter_Impl()
 		{
-			if (file_begun && compress)
+			if (file_begun && compress && method == ZipWriter::compression_deflate && !work_queue)
 			{
 				mz_deflateEnd(&zs);
 			}
@@ -62,6 +69,43 @@ namespace clan
 			int64_t local_header_offset;
 		};
 
+		struct CompressBlock
+		{
+			CompressBlock() : compress(false), method(ZipWriter::compression_deflate), level(-1), last_block(false), crc32(0), done(false) { }
+
+			DataBuffer input;
+			DataBuffer output;
+			bool compress;
+			ZipWriter::CompressionMethod method;
+			int level;
+			bool last_block;
+			uint32_t crc32;
+			std::string error;
+			std::atomic<bool> done;
+		};
+
+		struct PendingFile
+		{
+			PendingFile() : local_header_offset(0), header_written(false), ended(false), next_block(0), uncompressed_length(0), compressed_length(0), crc32(0) { }
+
+			ZipLocalFileHeader local_header;
+			int64_t local_header_offset;
+			bool header_written;
+			bool ended;
+			std::vector<std::shared_ptr<CompressBlock>> blocks;
+			size_t next_block;
+			int64_t uncompressed_length;
+			int64_t compressed_length;
+			uint32_t crc32;
+		};
+
+		void create_local_header(const std::string &filename, bool compress);
+		void write_frame_data(const void *data, int64_t size, bool finish);
+
+		void submit_block(bool last_block);
+		void write_completed_blocks(size_t max_pending_blocks);
+		static void compress_block(CompressBlock &block);
+
 		IODevice output;
 		bool storeFilenamesAsUTF8;
 		bool file_begun;
@@ -71,9 +115,23 @@ namespace clan
 		int64_t compressed_length;
 		uint32_t crc32;
 		bool compress;
+		ZipWriter::CompressionMethod method;
+		int level;
 		mz_stream zs;
 		char zbuffer[16 * 1024];
+		std::unique_ptr<ZstdCompressor> zstd;
+		std::unique_ptr<LZ4Compressor> lz4;
+		DataBuffer frame_buffer;
 		std::vector<FileEntry> written_files;
+
+		std::unique_ptr<WorkQueue> work_queue;
+		int block_size;
+		DataBuffer block_buffer;
+		int block_used;
+		std::deque<PendingFile> pending_files;
+		size_t blocks_in_flight;
+
+		static const size_t max_blocks_in_flight = 64;
 	};
 
 	ZipWriter::ZipWriter(IODevice &output, bool storeFilenamesAsUTF8)
@@ -81,6 +139,53 @@ namespace clan
 	{
 	}
 
+	void ZipWriter::set_parallel_compression(bool enable, int block_size)
+	{
+		if (impl->file_begun || !impl->written_files.empty() || !impl->pending_files.empty())
+			throw Exception("ZipWriter parallel compression must be set before the first file is written");
+
+		if (enable)
+		{
+			if (block_size <= 0)
+				throw Exception("Invalid ZipWriter compression block size");
+			if (!impl->work_queue)
+				impl->work_queue.reset(new WorkQueue());
+			impl->block_size = block_size;
+		}
+		else
+		{
+			impl->work_queue.reset();
+			impl->block_size = 0;
+		}
+	}
+
+	void ZipWriter::set_compression_method(CompressionMethod method, int level)
+	{
+		if (impl->file_begun)
+			throw Exception("ZipWriter compression method cannot change while writing a file");
+
+		if (level < 0)
+		{
+			switch (method)
+			{
+			case compression_deflate: level = MZ_DEFAULT_COMPRESSION; break;
+			case compression_zstd: level = 3; break;
+			case compression_lz4: level = 0; break;
+			}
+		}
+
+		// Fail early if ClanLib was built without the codec
+		if (method == compression_zstd && !ZstdCompression::is_supported())
+			throw Exception("ClanLib was built without Zstandard support");
+		if (method == compression_lz4 && !LZ4Compression::is_supported())
+			throw Exception("ClanLib was built without LZ4 support");
+
+		impl->method = method;
+		impl->level = level;
+		impl->zstd.reset();
+		impl->lz4.reset();
+	}
+
 	void ZipWriter::begin_file(const std::string &filename, bool compress)
 	{
 		if (impl->file_begun)
@@ -92,48 +197,40 @@ namespace clan
 		impl->compress = compress;
 		impl->crc32 = ZIP_CRC_START_VALUE;
 
-		impl->local_header_offset = impl->output.get_position();
-		impl->local_header = ZipLocalFileHeader();
-		impl->local_header.version_needed_to_extract = 20;
-		if (impl->storeFilenamesAsUTF8)
-			impl->local_header.general_purpose_bit_flag = ZIP_USE_UTF8;
-		else
-			impl->local_header.general_purpose_bit_flag = 0;
-		impl->local_header.compression_method = compress ? zip_compress_deflate : zip_compress_store;
-		ZipArchive_Impl::calc_time_and_date(
-			impl->local_header.last_mod_file_date,
-			impl->local_header.last_mod_file_time);
-		impl->local_header.crc32 = 0;
-		impl->local_header.uncompressed_size = 0;
-		impl->local_header.compressed_size = 0;
-		impl->local_header.file_name_length = filename.length();
-		impl->local_header.filename = filename;
-
-		if (!impl->storeFilenamesAsUTF8) // Add UTF-8 as extra field if we aren't storing normal UTF-8 filenames
+		impl->create_local_header(filename, compress);
+
+		if (impl->work_queue)
 		{
-			// -Info-ZIP Unicode Path Extra Field (0x7075)
-			std::string filename_cp437 = StringHelp::text_to_cp437(filename);
-			std::string filename_utf8 = StringHelp::text_to_utf8(filename);
-			DataBuffer unicode_path(9 + filename_utf8.length());
-			uint16_t *extra_id = (uint16_t *)(unicode_path.get_data());
-			uint16_t *extra_len = (uint16_t *)(unicode_path.get_data() + 2);
-			uint8_t *extra_version = (uint8_t *)(unicode_path.get_data() + 4);
-			uint32_t *extra_crc32 = (uint32_t *)(unicode_path.get_data() + 5);
-			*extra_id = 0x7075;
-			*extra_len = 5 + filename_utf8.length();
-			*extra_version = 1;
-			*extra_crc32 = ZipArchive_Impl::calc_crc32(filename_cp437.data(), filename_cp437.size());
-			memcpy(unicode_path.get_data() + 9, filename_utf8.data(), filename_utf8.length());
-			impl->local_header.extra_field_length = unicode_path.get_size();
-			impl->local_header.extra_field = unicode_path;
+			ZipWriter_Impl::PendingFile file;
+			file.local_header = impl->local_header;
+			impl->pending_files.push_back(file);
+			impl->block_buffer = DataBuffer(impl->block_size);
+			impl->block_used = 0;
+			return;
 		}
 
+		impl->local_header_offset = impl->output.get_position();
 		impl->local_header.save(impl->output);
 
-		if (compress)
+		if (compress && impl->method == compression_zstd)
+		{
+			// The compression context is kept for the following files
+			if (impl->zstd)
+				impl->zstd->reset();
+			else
+				impl->zstd.reset(new ZstdCompressor(impl->level));
+		}
+		else if (compress && impl->method == compression_lz4)
+		{
+			if (impl->lz4)
+				impl->lz4->reset();
+			else
+				impl->lz4.reset(new LZ4Compressor(impl->level));
+		}
+		else if (compress)
 		{
 			memset(&impl->zs, 0, sizeof(mz_stream));
-			int result = mz_deflateInit2(&impl->zs, MZ_DEFAULT_COMPRESSION, MZ_DEFLATED, -15, 8, MZ_DEFAULT_STRATEGY); // Undocumented: if wbits is negative, zlib skips header check
+			int result = mz_deflateInit2(&impl->zs, impl->level, MZ_DEFLATED, -15, 8, MZ_DEFAULT_STRATEGY); // Undocumented: if wbits is negative, zlib skips header check
 			if (result != MZ_OK)
 				throw Exception("Zlib deflateInit failed for zip index!");
 		}
@@ -144,9 +241,30 @@ namespace clan
 		if (!impl->file_begun)
 			throw Exception("ZipWriter::begin_file not called prior ZipWriter::write_file_data");
 
+		if (impl->work_queue)
+		{
+			const char *src = (const char *)data;
+			while (size > 0)
+			{
+				int copy_size = (int)std::min(size, (int64_t)(impl->block_size - impl->block_used));
+				memcpy(impl->block_buffer.get_data() + impl->block_used, src, copy_size);
+				impl->block_used += copy_size;
+				src += copy_size;
+				size -= copy_size;
+
+				if (impl->block_used == impl->block_size)
+					impl->submit_block(false);
+			}
+			return;
+		}
+
 		impl->uncompressed_length += size;
 
-		if (impl->compress)
+		if (impl->compress && impl->method != compression_deflate)
+		{
+			impl->write_frame_data(data, size, false);
+		}
+		else if (impl->compress)
 		{
 			impl->zs.next_in = (unsigned char *)data;
 			impl->zs.avail_in = size;
@@ -185,7 +303,23 @@ namespace clan
 		if (!impl->file_begun)
 			return;
 
-		if (impl->compress)
+		if (impl->work_queue)
+		{
+			// The last block is submitted even when empty, as it carries the final deflate block
+			impl->submit_block(true);
+			impl->block_buffer = DataBuffer();
+			impl->pending_files.back().ended = true;
+			impl->file_begun = false;
+			impl->write_completed_blocks(ZipWriter_Impl::max_blocks_in_flight);
+			return;
+		}
+
+		if (impl->compress && impl->method != compression_deflate)
+		{
+			impl->write_frame_data(nullptr, 0, true);
+			impl->compress = false;
+		}
+		else if (impl->compress)
 		{
 			impl->zs.next_in = nullptr;
 			impl->zs.avail_in = 0;
@@ -237,6 +371,9 @@ namespace clan
 		if (impl->file_begun)
 			throw Exception("Cannot write zip TOC when already writing a file entry");
 
+		if (impl->work_queue)
+			impl->write_completed_blocks(0);
+
 		int64_t offset_start_central_dir = impl->output.get_position();
 
 		// write central directory entries.
@@ -282,4 +419,216 @@ namespace clan
 		central_dir_end.file_comment = "";
 		central_dir_end.save(impl->output);
 	}
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	void ZipWriter_Impl::create_local_header(const std::string &filename, bool compress)
+	{
+		local_header = ZipLocalFileHeader();
+		local_header.version_needed_to_extract = (compress && method != ZipWriter::compression_deflate) ? 63 : 20;
+		if (storeFilenamesAsUTF8)
+			local_header.general_purpose_bit_flag = ZIP_USE_UTF8;
+		else
+			local_header.general_purpose_bit_flag = 0;
+		if (!compress)
+			local_header.compression_method = zip_compress_store;
+		else if (method == ZipWriter::compression_zstd)
+			local_header.compression_method = zip_compress_zstd;
+		else if (method == ZipWriter::compression_lz4)
+			local_header.compression_method = zip_compress_lz4;
+		else
+			local_header.compression_method = zip_compress_deflate;
+		ZipArchive_Impl::calc_time_and_date(
+			local_header.last_mod_file_date,
+			local_header.last_mod_file_time);
+		local_header.crc32 = 0;
+		local_header.uncompressed_size = 0;
+		local_header.compressed_size = 0;
+		local_header.file_name_length = filename.length();
+		local_header.filename = filename;
+		local_header.extra_field_length = 0;
+
+		if (!storeFilenamesAsUTF8) // Add UTF-8 as extra field if we aren't storing normal UTF-8 filenames
+		{
+			// -Info-ZIP Unicode Path Extra Field (0x7075)
+			std::string filename_cp437 = StringHelp::text_to_cp437(filename);
+			std::string filename_utf8 = StringHelp::text_to_utf8(filename);
+			DataBuffer unicode_path(9 + filename_utf8.length());
+			uint16_t *extra_id = (uint16_t *)(unicode_path.get_data());
+			uint16_t *extra_len = (uint16_t *)(unicode_path.get_data() + 2);
+			uint8_t *extra_version = (uint8_t *)(unicode_path.get_data() + 4);
+			uint32_t *extra_crc32 = (uint32_t *)(unicode_path.get_data() + 5);
+			*extra_id = 0x7075;
+			*extra_len = 5 + filename_utf8.length();
+			*extra_version = 1;
+			*extra_crc32 = ZipArchive_Impl::calc_crc32(filename_cp437.data(), filename_cp437.size());
+			memcpy(unicode_path.get_data() + 9, filename_utf8.data(), filename_utf8.length());
+			local_header.extra_field_length = unicode_path.get_size();
+			local_header.extra_field = unicode_path;
+		}
+	}
+
+	void ZipWriter_Impl::write_frame_data(const void *data, int64_t size, bool finish)
+	{
+		// Compress in slices so the output buffer stays small
+		const char *input = (const char *)data;
+		do
+		{
+			unsigned int slice_size = (unsigned int)std::min(size, (int64_t)1024 * 1024);
+			bool last_slice = finish && slice_size == size;
+
+			frame_buffer.set_size(0);
+			if (zstd)
+				zstd->compress(input, slice_size, frame_buffer, last_slice);
+			else
+				lz4->compress(input, slice_size, frame_buffer, last_slice);
+
+			if (frame_buffer.get_size() > 0)
+			{
+				output.write(frame_buffer.get_data(), frame_buffer.get_size());
+				compressed_length += frame_buffer.get_size();
+			}
+
+			input += slice_size;
+			size -= slice_size;
+		} while (size > 0);
+	}
+
+	void ZipWriter_Impl::submit_block(bool last_block)
+	{
+		block_buffer.set_size(block_used);
+
+		std::shared_ptr<CompressBlock> block = std::make_shared<CompressBlock>();
+		block->input = block_buffer;
+		block->compress = compress;
+		block->method = method;
+		block->level = level;
+		block->last_block = last_block;
+		pending_files.back().blocks.push_back(block);
+		blocks_in_flight++;
+
+		work_queue->queue([block]()
+		{
+			try
+			{
+				ZipWriter_Impl::compress_block(*block);
+			}
+			catch (const Exception &e)
+			{
+				block->error = e.message;
+			}
+			block->done.store(true, std::memory_order_release);
+		});
+
+		if (!last_block)
+		{
+			block_buffer = DataBuffer(block_size);
+			block_used = 0;
+		}
+
+		write_completed_blocks(max_blocks_in_flight);
+	}
+
+	void ZipWriter_Impl::compress_block(CompressBlock &block)
+	{
+		block.crc32 = ZipArchive_Impl::calc_crc32(block.input.get_data(), block.input.get_size());
+
+		if (!block.compress)
+		{
+			block.output = block.input;
+			return;
+		}
+
+		// Each block is a separate frame. The frames are concatenated and decompressed as one stream.
+		if (block.method == ZipWriter::compression_zstd)
+		{
+			block.output = ZstdCompression::compress(block.input, block.level);
+			return;
+		}
+		else if (block.method == ZipWriter::compression_lz4)
+		{
+			block.output = LZ4Compression::compress(block.input, block.level);
+			return;
+		}
+
+		mz_stream stream;
+		memset(&stream, 0, sizeof(mz_stream));
+		int result = mz_deflateInit2(&stream, block.level, MZ_DEFLATED, -15, 8, MZ_DEFAULT_STRATEGY);
+		if (result != MZ_OK)
+			throw Exception("Zlib deflateInit failed for zip index!");
+
+		// Blocks other than the last end with a sync flush, which byte aligns the output so the blocks can be concatenated
+		unsigned int output_size = mz_deflateBound(&stream, block.input.get_size()) + 16;
+		block.output = DataBuffer(output_size);
+
+		stream.next_in = (const unsigned char *)block.input.get_data();
+		stream.avail_in = block.input.get_size();
+		stream.next_out = (unsigned char *)block.output.get_data();
+		stream.avail_out = output_size;
+		result = mz_deflate(&stream, block.last_block ? MZ_FINISH : MZ_SYNC_FLUSH);
+		bool complete = block.last_block ? (result == MZ_STREAM_END) : (result == MZ_OK && stream.avail_in == 0 && stream.avail_out > 0);
+		unsigned int compressed_size = output_size - stream.avail_out;
+		mz_deflateEnd(&stream);
+
+		if (!complete)
+			throw Exception("Zlib deflate failed while compressing zip file!");
+
+		block.output.set_size(compressed_size);
+	}
+
+	void ZipWriter_Impl::write_completed_blocks(size_t max_pending_blocks)
+	{
+		while (!pending_files.empty())
+		{
+			PendingFile &file = pending_files.front();
+			if (!file.header_written)
+			{
+				file.local_header_offset = output.get_position();
+				file.local_header.save(output);
+				file.header_written = true;
+			}
+
+			while (file.next_block < file.blocks.size())
+			{
+				std::shared_ptr<CompressBlock> block = file.blocks[file.next_block];
+				if (!block->done.load(std::memory_order_acquire))
+				{
+					if (blocks_in_flight <= max_pending_blocks)
+						return;
+					work_queue->wait_until([&]() { return block->done.load(std::memory_order_acquire); });
+				}
+
+				if (!block->error.empty())
+					throw Exception(block->error);
+
+				output.write(block->output.get_data(), block->output.get_size());
+				file.crc32 = ZipArchive_Impl::combine_crc32(file.crc32, block->crc32, block->input.get_size());
+				file.uncompressed_length += block->input.get_size();
+				file.compressed_length += block->output.get_size();
+
+				file.blocks[file.next_block].reset();
+				file.next_block++;
+				blocks_in_flight--;
+			}
+
+			if (!file.ended)
+				return;
+
+			file.local_header.uncompressed_size = file.uncompressed_length;
+			file.local_header.compressed_size = file.compressed_length;
+			file.local_header.crc32 = file.crc32;
+
+			int64_t current_offset = output.get_position();
+			output.seek(file.local_header_offset);
+			file.local_header.save(output);
+			output.seek(current_offset);
+
+			FileEntry file_entry;
+			file_entry.local_header = file.local_header;
+			file_entry.local_header_offset = file.local_header_offset;
+			written_files.push_back(file_entry);
+
+			pending_files.pop_front();
+		}
+	}
 }
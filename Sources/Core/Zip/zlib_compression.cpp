@@ -38,98 +38,270 @@ namespace clan
 {
 	DataBuffer ZLibCompression::compress(const DataBuffer &data, bool raw, int compression_level, CompressionMode mode)
 	{
-		const int window_bits = 15;
-
-		DataBuffer zbuffer(1024 * 1024);
-		MemoryDevice output;
+		DataBuffer output;
+		ZLibCompressor compressor(raw, compression_level, mode);
+		compressor.compress(data.get_data(), data.get_size(), output, ZLibCompressor::finish);
+		return output;
+	}
 
-		int strategy = MZ_DEFAULT_STRATEGY;
-		switch (mode)
-		{
-		case default_strategy: strategy = MZ_DEFAULT_STRATEGY; break;
-		case filtered: strategy = MZ_FILTERED; break;
-		case huffman_only: strategy = MZ_HUFFMAN_ONLY; break;
-		case rle: strategy = MZ_RLE; break;
-		case fixed: strategy = MZ_FIXED; break;
-		}
+	DataBuffer ZLibCompression::decompress(const DataBuffer &data, bool raw)
+	{
+		DataBuffer output;
+		ZLibDecompressor decompressor(raw);
+		if (!decompressor.decompress(data.get_data(), data.get_size(), output))
+			throw Exception("Not enough data in buffer when Z_FINISH was used");
+		return output;
+	}
 
-		mz_stream zs = { nullptr };
-		int result = mz_deflateInit2(&zs, compression_level, MZ_DEFLATED, raw ? -window_bits : window_bits, 8, strategy); // Undocumented: if wbits is negative, zlib skips header check
-		if (result != MZ_OK)
-			throw Exception("Zlib deflateInit failed");
+	/////////////////////////////////////////////////////////////////////////////
 
-		try
+	class ZLibCompressor_Impl
+	{
+	public:
+		ZLibCompressor_Impl(bool raw, int compression_level, ZLibCompression::CompressionMode mode) : raw(raw)
 		{
-			zs.next_in = (unsigned char *)data.get_data();
-			zs.avail_in = data.get_size();
-			while (true)
+			const int window_bits = 15;
+
+			int strategy = MZ_DEFAULT_STRATEGY;
+			switch (mode)
 			{
-				zs.next_out = (unsigned char *)zbuffer.get_data();
-				zs.avail_out = zbuffer.get_size();
-
-				int result = mz_deflate(&zs, MZ_FINISH);
-				if (result == MZ_NEED_DICT) throw Exception("Zlib deflate wants a dictionary!");
-				if (result == MZ_DATA_ERROR) throw Exception("Zip data stream is corrupted");
-				if (result == MZ_STREAM_ERROR) throw Exception("Zip stream structure was inconsistent!");
-				if (result == MZ_MEM_ERROR) throw Exception("Zlib did not have enough memory to compress file!");
-				if (result == MZ_BUF_ERROR) throw Exception("Not enough data in buffer when Z_FINISH was used");
-				if (result != MZ_OK && result != MZ_STREAM_END) throw Exception("Zlib deflate failed while compressing zip file!");
-				int zsize = zbuffer.get_size() - zs.avail_out;
-				if (zsize == 0)
-					break;
-				output.write(zbuffer.get_data(), zsize);
-				if (result == MZ_STREAM_END)
-					break;
+			case ZLibCompression::default_strategy: strategy = MZ_DEFAULT_STRATEGY; break;
+			case ZLibCompression::filtered: strategy = MZ_FILTERED; break;
+			case ZLibCompression::huffman_only: strategy = MZ_HUFFMAN_ONLY; break;
+			case ZLibCompression::rle: strategy = MZ_RLE; break;
+			case ZLibCompression::fixed: strategy = MZ_FIXED; break;
 			}
-			mz_deflateEnd(&zs);
+
+			int result = mz_deflateInit2(&zs, compression_level, MZ_DEFLATED, raw ? -window_bits : window_bits, 8, strategy); // Undocumented: if wbits is negative, zlib skips header check
+			if (result != MZ_OK)
+				throw Exception("Zlib deflateInit failed");
 		}
-		catch (...)
+
+		~ZLibCompressor_Impl()
 		{
 			mz_deflateEnd(&zs);
-			throw;
 		}
 
-		return output.get_data();
-	}
+		mz_stream zs = { nullptr };
+		bool raw;
+		bool started = false;
+		bool finished = false;
+	};
 
-	DataBuffer ZLibCompression::decompress(const DataBuffer &data, bool raw)
+	ZLibCompressor::ZLibCompressor(bool raw, int compression_level, ZLibCompression::CompressionMode mode) : impl(std::make_shared<ZLibCompressor_Impl>(raw, compression_level, mode))
 	{
-		const int window_bits = 15;
+	}
 
-		DataBuffer zbuffer(1024 * 1024);
-		MemoryDevice output;
+	ZLibCompressor::~ZLibCompressor()
+	{
+	}
 
-		mz_stream zs = { nullptr };
-		int result = mz_inflateInit2(&zs, raw ? -window_bits : window_bits);
-		if (result != MZ_OK)
-			throw Exception("Zlib inflateInit failed");
+	void ZLibCompressor::reset()
+	{
+		mz_deflateReset(&impl->zs);
+		impl->started = false;
+		impl->finished = false;
+	}
 
+	void ZLibCompressor::set_dictionary(const void *data, unsigned int size)
+	{
+		if (!impl->raw)
+			throw Exception("Zlib preset dictionaries are only supported for raw streams");
+		if (impl->started)
+			throw Exception("Zlib dictionary must be set before compressing");
 
-		zs.next_in = (unsigned char *)data.get_data();
-		zs.avail_in = data.get_size();
+		// miniz has no deflateSetDictionary. Compressing the dictionary and discarding the output leaves it
+		// in the sliding window, and the sync flush makes the real data start on a byte aligned block boundary.
+		const unsigned int window_size = 32768;
+		if (size > window_size)
+		{
+			data = (const char *)data + size - window_size;
+			size = window_size;
+		}
 
-		// Continue feeding zlib data until we get our data:
+		mz_stream &zs = impl->zs;
+		unsigned char discard[4096];
+		zs.next_in = (const unsigned char *)data;
+		zs.avail_in = size;
 		while (true)
 		{
-			zs.next_out = (unsigned char *)zbuffer.get_data();
-			zs.avail_out = zbuffer.get_size();
+			zs.next_out = discard;
+			zs.avail_out = sizeof(discard);
+			int result = mz_deflate(&zs, MZ_SYNC_FLUSH);
+			if (result != MZ_OK && result != MZ_BUF_ERROR)
+				throw Exception("Zlib deflate failed");
+			if (zs.avail_in == 0 && zs.avail_out != 0)
+				break;
+		}
+		zs.total_in = 0;
+		zs.total_out = 0;
+		impl->started = true;
+	}
 
-			// Decompress data:
-			int result = mz_inflate(&zs, 0);
-			if (result == MZ_NEED_DICT) throw Exception("Zlib inflate wants a dictionary!");
-			if (result == MZ_DATA_ERROR) throw Exception("Zip data stream is corrupted");
-			if (result == MZ_STREAM_ERROR) throw Exception("Zip stream structure was inconsistent!");
-			if (result == MZ_MEM_ERROR) throw Exception("Zlib did not have enough memory to decompress file!");
-			if (result == MZ_BUF_ERROR) throw Exception("Not enough data in buffer when Z_FINISH was used");
-			if (result != MZ_OK && result != MZ_STREAM_END) throw Exception("Zlib inflate failed while decompressing zip file!");
+	bool ZLibCompressor::compress(const void *input, unsigned int input_size, unsigned int &input_used, void *output, unsigned int output_size, unsigned int &output_used, FlushMode flush)
+	{
+		input_used = 0;
+		output_used = 0;
+		if (impl->finished)
+			return true;
 
-			output.write(zbuffer.get_data(), zbuffer.get_size() - zs.avail_out);
+		mz_stream &zs = impl->zs;
+		zs.next_in = (const unsigned char *)input;
+		zs.avail_in = input_size;
+		zs.next_out = (unsigned char *)output;
+		zs.avail_out = output_size;
 
-			if (result == MZ_STREAM_END)
+		int result = mz_deflate(&zs, flush == finish ? MZ_FINISH : flush == sync_flush ? MZ_SYNC_FLUSH : MZ_NO_FLUSH);
+		if (result != MZ_OK && result != MZ_STREAM_END && result != MZ_BUF_ERROR)
+			throw Exception("Zlib deflate failed");
+
+		input_used = input_size - zs.avail_in;
+		output_used = output_size - zs.avail_out;
+		impl->started = true;
+		impl->finished = (result == MZ_STREAM_END);
+		return impl->finished;
+	}
+
+	void ZLibCompressor::compress(const void *data, unsigned int size, DataBuffer &output, FlushMode flush)
+	{
+		const unsigned char *input = (const unsigned char *)data;
+		while (true)
+		{
+			// Grow geometrically and leave room for at least the deflate bound of the remaining input
+			unsigned int pos = output.get_size();
+			unsigned int needed = pos + (unsigned int)mz_deflateBound(&impl->zs, size) + 16;
+			if (needed > output.get_capacity())
+				output.set_capacity(needed > output.get_capacity() * 2 ? needed : output.get_capacity() * 2);
+			output.set_size(output.get_capacity());
+
+			unsigned int input_used = 0, output_used = 0;
+			unsigned int output_available = output.get_size() - pos;
+			bool done = compress(input, size, input_used, output.get_data() + pos, output_available, output_used, flush);
+			output.set_size(pos + output_used);
+			input += input_used;
+			size -= input_used;
+
+			// A sync flush is complete when deflate did not fill the output buffer
+			if (flush == finish ? done : size == 0 && (flush == no_flush || output_used < output_available))
 				break;
 		}
-		mz_inflateEnd(&zs);
+	}
 
-		return output.get_data();
+	/////////////////////////////////////////////////////////////////////////////
+
+	class ZLibDecompressor_Impl
+	{
+	public:
+		ZLibDecompressor_Impl(bool raw) : raw(raw)
+		{
+			const int window_bits = 15;
+			if (mz_inflateInit2(&zs, raw ? -window_bits : window_bits) != MZ_OK)
+				throw Exception("Zlib inflateInit failed");
+		}
+
+		~ZLibDecompressor_Impl()
+		{
+			mz_inflateEnd(&zs);
+		}
+
+		mz_stream zs = { nullptr };
+		bool raw;
+		bool started = false;
+		bool finished = false;
+	};
+
+	ZLibDecompressor::ZLibDecompressor(bool raw) : impl(std::make_shared<ZLibDecompressor_Impl>(raw))
+	{
+	}
+
+	ZLibDecompressor::~ZLibDecompressor()
+	{
+	}
+
+	void ZLibDecompressor::reset()
+	{
+		// miniz has no inflateReset, so this repeats the state setup of mz_inflateInit2 on the existing allocation
+		mz_stream &zs = impl->zs;
+		inflate_state *state = (inflate_state *)zs.state;
+		tinfl_init(&state->m_decomp);
+		state->m_dict_ofs = 0;
+		state->m_dict_avail = 0;
+		state->m_last_status = TINFL_STATUS_NEEDS_MORE_INPUT;
+		state->m_first_call = 1;
+		state->m_has_flushed = 0;
+		zs.adler = 0;
+		zs.total_in = 0;
+		zs.total_out = 0;
+		impl->started = false;
+		impl->finished = false;
+	}
+
+	void ZLibDecompressor::set_dictionary(const void *data, unsigned int size)
+	{
+		if (!impl->raw)
+			throw Exception("Zlib preset dictionaries are only supported for raw streams");
+		if (impl->started)
+			throw Exception("Zlib dictionary must be set before decompressing");
+
+		// The inflate window wraps around, so a dictionary placed at its end is what distances before the
+		// start of the stream refer to. The first call fast path decompresses straight into the caller's buffer,
+		// bypassing the window, and must be disabled.
+		inflate_state *state = (inflate_state *)impl->zs.state;
+		if (size > TINFL_LZ_DICT_SIZE)
+		{
+			data = (const char *)data + size - TINFL_LZ_DICT_SIZE;
+			size = TINFL_LZ_DICT_SIZE;
+		}
+		memcpy(state->m_dict + TINFL_LZ_DICT_SIZE - size, data, size);
+		state->m_first_call = 0;
+		impl->started = true;
+	}
+
+	bool ZLibDecompressor::decompress(const void *input, unsigned int input_size, unsigned int &input_used, void *output, unsigned int output_size, unsigned int &output_used)
+	{
+		input_used = 0;
+		output_used = 0;
+		if (impl->finished)
+			return true;
+
+		mz_stream &zs = impl->zs;
+		zs.next_in = (const unsigned char *)input;
+		zs.avail_in = input_size;
+		zs.next_out = (unsigned char *)output;
+		zs.avail_out = output_size;
+
+		int result = mz_inflate(&zs, MZ_NO_FLUSH);
+		if (result == MZ_DATA_ERROR) throw Exception("Zlib data stream is corrupted");
+		if (result != MZ_OK && result != MZ_STREAM_END && result != MZ_BUF_ERROR)
+			throw Exception("Zlib inflate failed");
+
+		input_used = input_size - zs.avail_in;
+		output_used = output_size - zs.avail_out;
+		impl->started = true;
+		impl->finished = (result == MZ_STREAM_END);
+		return impl->finished;
+	}
+
+	bool ZLibDecompressor::decompress(const void *data, unsigned int size, DataBuffer &output)
+	{
+		const unsigned char *input = (const unsigned char *)data;
+		while (true)
+		{
+			unsigned int pos = output.get_size();
+			unsigned int needed = pos + (size * 4 > 4096 ? size * 4 : 4096);
+			if (needed > output.get_capacity())
+				output.set_capacity(needed > output.get_capacity() * 2 ? needed : output.get_capacity() * 2);
+			output.set_size(output.get_capacity());
+
+			unsigned int input_used = 0, output_used = 0;
+			bool done = decompress(input, size, input_used, output.get_data() + pos, output.get_size() - pos, output_used);
+			output.set_size(pos + output_used);
+			input += input_used;
+			size -= input_used;
+
+			// Inflate stops early only when the output buffer is full
+			if (done || (output_used < output.get_capacity() - pos && size == 0) || (input_used == 0 && output_used == 0))
+				return done;
+		}
 	}
 }
@@ -0,0 +1,262 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "Core/precomp.h"
+#include "API/Core/Zip/zstd_compression.h"
+#include "API/Core/System/databuffer.h"
+#include "API/Core/Text/string_format.h"
+
+#ifdef HAVE_ZSTD_H
+#include <zstd.h>
+#endif
+
+namespace clan
+{
+	bool ZstdCompression::is_supported()
+	{
+#ifdef HAVE_ZSTD_H
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	DataBuffer ZstdCompression::compress(const DataBuffer &data, int compression_level)
+	{
+		DataBuffer output;
+		ZstdCompressor compressor(compression_level);
+		compressor.compress(data.get_data(), data.get_size(), output, true);
+		return output;
+	}
+
+	DataBuffer ZstdCompression::decompress(const DataBuffer &data)
+	{
+		DataBuffer output;
+		ZstdDecompressor decompressor;
+		if (!decompressor.decompress(data.get_data(), data.get_size(), output))
+			throw Exception("Zstandard data ended in the middle of a frame");
+		return output;
+	}
+
+#ifdef HAVE_ZSTD_H
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	class ZstdCompressor_Impl
+	{
+	public:
+		ZstdCompressor_Impl(int compression_level)
+		{
+			cctx = ZSTD_createCCtx();
+			if (!cctx)
+				throw Exception("ZSTD_createCCtx failed");
+
+			size_t result = ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, compression_level);
+			if (ZSTD_isError(result))
+			{
+				ZSTD_freeCCtx(cctx);
+				throw Exception(string_format("Invalid Zstandard compression level %1", compression_level));
+			}
+		}
+
+		~ZstdCompressor_Impl()
+		{
+			ZSTD_freeCCtx(cctx);
+		}
+
+		ZSTD_CCtx *cctx = nullptr;
+	};
+
+	ZstdCompressor::ZstdCompressor(int compression_level) : impl(std::make_shared<ZstdCompressor_Impl>(compression_level))
+	{
+	}
+
+	ZstdCompressor::~ZstdCompressor()
+	{
+	}
+
+	void ZstdCompressor::reset()
+	{
+		ZSTD_CCtx_reset(impl->cctx, ZSTD_reset_session_only);
+	}
+
+	void ZstdCompressor::compress(const void *data, unsigned int size, DataBuffer &output, bool finish)
+	{
+		ZSTD_inBuffer input = { data, size, 0 };
+		while (true)
+		{
+			// Grow geometrically and leave room for at least the compress bound of the remaining input
+			unsigned int pos = output.get_size();
+			unsigned int needed = pos + (unsigned int)ZSTD_compressBound(input.size - input.pos) + 16;
+			if (needed > output.get_capacity())
+				output.set_capacity(needed > output.get_capacity() * 2 ? needed : output.get_capacity() * 2);
+			output.set_size(output.get_capacity());
+
+			ZSTD_outBuffer out = { output.get_data() + pos, output.get_size() - pos, 0 };
+			size_t remaining = ZSTD_compressStream2(impl->cctx, &out, &input, finish ? ZSTD_e_end : ZSTD_e_continue);
+			output.set_size(pos + (unsigned int)out.pos);
+			if (ZSTD_isError(remaining))
+				throw Exception(string_format("Zstandard compression failed: %1", ZSTD_getErrorName(remaining)));
+
+			if (finish ? remaining == 0 : input.pos == input.size)
+				break;
+		}
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	class ZstdDecompressor_Impl
+	{
+	public:
+		ZstdDecompressor_Impl()
+		{
+			dctx = ZSTD_createDCtx();
+			if (!dctx)
+				throw Exception("ZSTD_createDCtx failed");
+		}
+
+		~ZstdDecompressor_Impl()
+		{
+			ZSTD_freeDCtx(dctx);
+		}
+
+		ZSTD_DCtx *dctx = nullptr;
+	};
+
+	ZstdDecompressor::ZstdDecompressor() : impl(std::make_shared<ZstdDecompressor_Impl>())
+	{
+	}
+
+	ZstdDecompressor::~ZstdDecompressor()
+	{
+	}
+
+	void ZstdDecompressor::reset()
+	{
+		ZSTD_DCtx_reset(impl->dctx, ZSTD_reset_session_only);
+	}
+
+	bool ZstdDecompressor::decompress(const void *input, unsigned int input_size, unsigned int &input_used, void *output, unsigned int output_size, unsigned int &output_used)
+	{
+		ZSTD_inBuffer in = { input, input_size, 0 };
+		ZSTD_outBuffer out = { output, output_size, 0 };
+
+		// Decompression stops at the end of each frame and returns 0 once the frame is fully flushed
+		size_t result = ZSTD_decompressStream(impl->dctx, &out, &in);
+		if (ZSTD_isError(result))
+			throw Exception(string_format("Zstandard data stream is corrupted: %1", ZSTD_getErrorName(result)));
+
+		input_used = (unsigned int)in.pos;
+		output_used = (unsigned int)out.pos;
+		return result == 0;
+	}
+
+#else
+
+	class ZstdCompressor_Impl
+	{
+	public:
+		ZstdCompressor_Impl(int compression_level)
+		{
+			throw Exception("ClanLib was built without Zstandard support");
+		}
+	};
+
+	ZstdCompressor::ZstdCompressor(int compression_level) : impl(std::make_shared<ZstdCompressor_Impl>(compression_level))
+	{
+	}
+
+	ZstdCompressor::~ZstdCompressor()
+	{
+	}
+
+	void ZstdCompressor::reset()
+	{
+	}
+
+	void ZstdCompressor::compress(const void *data, unsigned int size, DataBuffer &output, bool finish)
+	{
+	}
+
+	class ZstdDecompressor_Impl
+	{
+	public:
+		ZstdDecompressor_Impl()
+		{
+			throw Exception("ClanLib was built without Zstandard support");
+		}
+	};
+
+	ZstdDecompressor::ZstdDecompressor() : impl(std::make_shared<ZstdDecompressor_Impl>())
+	{
+	}
+
+	ZstdDecompressor::~ZstdDecompressor()
+	{
+	}
+
+	void ZstdDecompressor::reset()
+	{
+	}
+
+	bool ZstdDecompressor::decompress(const void *input, unsigned int input_size, unsigned int &input_used, void *output, unsigned int output_size, unsigned int &output_used)
+	{
+		input_used = 0;
+		output_used = 0;
+		return false;
+	}
+
+#endif
+
+	bool ZstdDecompressor::decompress(const void *data, unsigned int size, DataBuffer &output)
+	{
+		const unsigned char *input = (const unsigned char *)data;
+		while (true)
+		{
+			unsigned int pos = output.get_size();
+			unsigned int needed = pos + (size * 4 > 4096 ? size * 4 : 4096);
+			if (needed > output.get_capacity())
+				output.set_capacity(needed > output.get_capacity() * 2 ? needed : output.get_capacity() * 2);
+			output.set_size(output.get_capacity());
+
+			unsigned int input_used = 0, output_used = 0;
+			bool frame_end = decompress(input, size, input_used, output.get_data() + pos, output.get_size() - pos, output_used);
+			output.set_size(pos + output_used);
+			input += input_used;
+			size -= input_used;
+
+			// More output may be pending when the output buffer was filled, and more frames may follow a frame end
+			bool output_full = output_used == output.get_capacity() - pos;
+			if (size == 0 && (frame_end || !output_full))
+				return frame_end;
+			if (input_used == 0 && output_used == 0 && !frame_end)
+				return false;
+		}
+	}
+}
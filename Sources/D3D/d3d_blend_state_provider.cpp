@@ -111,6 +111,9 @@ namespace clan
 		case blend_one_minus_constant_color: return D3D11_BLEND_INV_BLEND_FACTOR;
 		case blend_constant_alpha: break;
 		case blend_one_minus_constant_alpha: break;
+		case blend_src1_color: return D3D11_BLEND_SRC1_COLOR;
+		case blend_one_minus_src1_color: return D3D11_BLEND_INV_SRC1_COLOR;
+		case blend_one_minus_src1_alpha: return D3D11_BLEND_INV_SRC1_ALPHA;
 		}
 		throw Exception("Unsupported blend func");
 	}
@@ -33,6 +33,7 @@
 #include "d3d_graphic_context_provider.h"
 #include "API/Core/Math/rect.h"
 #include "API/Core/Text/logger.h"
+#include "API/Core/System/system.h"
 #include "API/Display/Render/graphic_context.h"
 #include "API/Display/Window/display_window_description.h"
 #include "API/D3D/d3d_target.h"
@@ -151,12 +152,14 @@ namespace clan
 
 		if (device)
 			D3DShareList::device_destroyed(device);
+		upload_ring.reset();
 		info_queue.clear();
 		debug.clear();
 		back_buffer_rtv.clear();
 		fake_front_buffer.clear();
 		back_buffer.clear();
 		swap_chain.clear();
+		pending_frames.clear();
 		device_context.clear();
 		device.clear();
 
@@ -224,6 +227,14 @@ namespace clan
 			device_context.output_variable());
 		D3DTarget::throw_if_failed("D3D11CreateDeviceAndSwapChain failed", result);
 
+		// Worker threads create textures and map upload pages while this thread renders
+		ComPtr<ID3D10Multithread> multithread;
+		result = device_context->QueryInterface(__uuidof(ID3D10Multithread), (void**)multithread.output_variable());
+		if (SUCCEEDED(result))
+			multithread->SetMultithreadProtected(TRUE);
+
+		upload_ring.reset(new D3DUploadRing(device, device_context));
+
 		if (debug_mode)
 		{
 			result = device->QueryInterface(__uuidof(ID3D11Debug), (void**)debug.output_variable());
@@ -238,7 +249,7 @@ namespace clan
 		ComPtr<IDXGIDevice1> dxgi_device;
 		result = swap_chain->GetDevice(__uuidof(IDXGIDevice1), (void**)dxgi_device.output_variable());
 		D3DTarget::throw_if_failed("Unable to retrieve IDXGIDevice1 from swap chain", result);
-		dxgi_device->SetMaximumFrameLatency(1);
+		dxgi_device->SetMaximumFrameLatency(max_frame_latency > 0 ? max_frame_latency : 1);
 
 		create_swap_chain_buffers();
 
@@ -362,6 +373,8 @@ namespace clan
 
 	void D3DDisplayWindowProvider::flip(int interval)
 	{
+		upload_ring->flush();
+
 		if (use_fake_front_buffer)
 			device_context->CopyResource(fake_front_buffer, back_buffer);
 
@@ -369,9 +382,100 @@ namespace clan
 		if (interval != -1)
 			current_interval_setting = interval;
 		swap_chain->Present(current_interval_setting, 0);
+
+		// An event query issued after Present completes when the GPU is done with the frame
+		PendingFrame pending;
+		pending.frame = ++timing.frames_presented;
+		D3D11_QUERY_DESC query_desc = { D3D11_QUERY_EVENT, 0 };
+		if (SUCCEEDED(device->CreateQuery(&query_desc, pending.query.output_variable())))
+		{
+			device_context->End(pending.query);
+			pending_frames.push_back(pending);
+		}
+		retire_frames(-1);
+		upload_ring->end_frame(timing.frames_presented, timing.last_displayed_frame);
+
 		log_debug_messages();
 	}
 
+	void D3DDisplayWindowProvider::flip(const std::vector<Rect> &damage, int interval)
+	{
+		// Present1 dirty rects are ignored for DXGI_SWAP_EFFECT_DISCARD swap chains
+		flip(interval);
+	}
+
+	void D3DDisplayWindowProvider::set_max_frame_latency(int frames)
+	{
+		max_frame_latency = frames;
+
+		// DXGI blocks in Present when more frames than this are queued
+		ComPtr<IDXGIDevice1> dxgi_device;
+		if (swap_chain && SUCCEEDED(swap_chain->GetDevice(__uuidof(IDXGIDevice1), (void**)dxgi_device.output_variable())))
+			dxgi_device->SetMaximumFrameLatency(frames > 0 ? frames : 1);
+	}
+
+	void D3DDisplayWindowProvider::wait_for_frame_slot()
+	{
+		if (max_frame_latency > 0)
+			retire_frames(max_frame_latency - 1);
+	}
+
+	void D3DDisplayWindowProvider::retire_frames(int max_pending)
+	{
+		while (!pending_frames.empty())
+		{
+			PendingFrame &pending = pending_frames.front();
+
+			BOOL done = FALSE;
+			HRESULT result = device_context->GetData(pending.query, &done, sizeof(BOOL), (max_pending < 0) ? D3D11_ASYNC_GETDATA_DONOTFLUSH : 0);
+			if (result == S_FALSE || (SUCCEEDED(result) && !done))
+			{
+				if (max_pending < 0 || (int)pending_frames.size() <= max_pending)
+					break;
+				Sleep(0);
+				continue;
+			}
+
+			if (SUCCEEDED(result))
+			{
+				uint64_t now = System::get_microseconds();
+				if (timing.last_displayed_frame != 0)
+					timing.frame_interval = (now - timing.display_time) / (pending.frame - timing.last_displayed_frame);
+				timing.last_displayed_frame = pending.frame;
+				timing.display_time = now;
+			}
+			pending_frames.pop_front();
+		}
+
+		timing.frames_in_flight = (int)(timing.frames_presented - timing.last_displayed_frame);
+	}
+
+	FrameTiming D3DDisplayWindowProvider::get_frame_timing() const
+	{
+		FrameTiming result = timing;
+
+		// Fullscreen swap chains report the vertical blank of the last present
+		DXGI_FRAME_STATISTICS stats;
+		UINT last_present_count = 0;
+		LARGE_INTEGER frequency;
+		if (swap_chain &&
+			SUCCEEDED(swap_chain->GetFrameStatistics(&stats)) &&
+			SUCCEEDED(swap_chain->GetLastPresentCount(&last_present_count)) &&
+			QueryPerformanceFrequency(&frequency) && frequency.QuadPart != 0)
+		{
+			uint64_t frames_behind = last_present_count - stats.PresentCount;
+			if (frames_behind < result.frames_presented)
+			{
+				result.last_displayed_frame = result.frames_presented - frames_behind;
+				result.display_time = (uint64_t)(stats.SyncQPCTime.QuadPart / frequency.QuadPart) * 1000000 + (uint64_t)(stats.SyncQPCTime.QuadPart % frequency.QuadPart) * 1000000 / frequency.QuadPart;
+				result.frames_in_flight = (int)frames_behind;
+				result.display_time_exact = true;
+			}
+		}
+
+		return result;
+	}
+
 	void D3DDisplayWindowProvider::update(const Rect &rect)
 	{
 		if (use_fake_front_buffer)
@@ -437,6 +541,9 @@ namespace clan
 
 	void D3DDisplayWindowProvider::validate_context()
 	{
+		// Queued texture uploads must land before the draw samples them
+		upload_ring->flush();
+
 		if (debug)
 		{
 			HRESULT result = debug->ValidateContext(device_context);
@@ -30,8 +30,11 @@
 
 #include "API/Display/TargetProviders/display_window_provider.h"
 #include "API/Display/Render/graphic_context.h"
+#include "API/Display/Window/frame_timing.h"
 #include "Display/Platform/Win32/win32_window.h"
+#include "d3d_upload_ring.h"
 #include <mutex>
+#include <deque>
 
 namespace clan
 {
@@ -75,6 +78,7 @@ namespace clan
 		const ComPtr<ID3D11RenderTargetView> &get_back_buffer_rtv() const { return back_buffer_rtv; }
 		const ComPtr<ID3D11Debug> &get_debug() const { return debug; }
 		const ComPtr<ID3D11InfoQueue> &get_info_queue() const { return info_queue; }
+		D3DUploadRing &get_upload_ring() { return *upload_ring; }
 
 		Point client_to_screen(const Point &client);
 		Point screen_to_client(const Point &screen);
@@ -108,6 +112,12 @@ namespace clan
 		void bring_to_front();
 
 		void flip(int interval);
+		void flip(const std::vector<Rect> &damage, int interval);
+
+		void set_max_frame_latency(int frames) override;
+		bool set_adaptive_vsync(bool enable) override { return !enable; } // DXGI_SWAP_EFFECT_DISCARD swap chains cannot tear
+		void wait_for_frame_slot() override;
+		FrameTiming get_frame_timing() const override;
 
 		void update(const Rect &rect);
 
@@ -131,6 +141,13 @@ namespace clan
 		void release_swap_chain_buffers();
 		void on_window_resized();
 		void log_debug_messages();
+		void retire_frames(int max_pending);
+
+		struct PendingFrame
+		{
+			uint64_t frame;
+			ComPtr<ID3D11Query> query;
+		};
 
 		Win32Window window;
 
@@ -145,12 +162,17 @@ namespace clan
 		ComPtr<ID3D11InfoQueue> info_queue;
 		ComPtr<ID3D11Texture2D> back_buffer;
 		ComPtr<ID3D11RenderTargetView> back_buffer_rtv;
+		std::unique_ptr<D3DUploadRing> upload_ring;
 
 		bool use_fake_front_buffer;
 		ComPtr<ID3D11Texture2D> fake_front_buffer;
 
 		int current_interval_setting;
 
+		std::deque<PendingFrame> pending_frames;
+		int max_frame_latency = 0;
+		FrameTiming timing;
+
 		typedef HRESULT(WINAPI *FuncD3D11CreateDeviceAndSwapChain)(
 			__in_opt IDXGIAdapter* pAdapter,
 			D3D_DRIVER_TYPE DriverType,
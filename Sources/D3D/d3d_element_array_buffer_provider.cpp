@@ -58,6 +58,7 @@ namespace clan
 		desc.StructureByteStride = 0;
 		HRESULT result = handles.front()->device->CreateBuffer(&desc, 0, handles.front()->buffer.output_variable());
 		D3DTarget::throw_if_failed("Unable to create element array buffer", result);
+		memory.set_size(size);
 	}
 
 	void D3DElementArrayBufferProvider::create(void *data, int new_size, BufferUsage usage)
@@ -78,6 +79,7 @@ namespace clan
 		desc.StructureByteStride = 0;
 		HRESULT result = handles.front()->device->CreateBuffer(&desc, &resource_data, handles.front()->buffer.output_variable());
 		D3DTarget::throw_if_failed("Unable to create element array buffer", result);
+		memory.set_size(size);
 	}
 
 	ComPtr<ID3D11Buffer> &D3DElementArrayBufferProvider::get_buffer(const ComPtr<ID3D11Device> &device)
@@ -99,6 +101,26 @@ namespace clan
 		device_context->UpdateSubresource(get_handles(device).buffer, 0, 0, data, 0, 0);
 	}
 
+	void D3DElementArrayBufferProvider::upload_data(GraphicContext &gc, int offset, const void *data, int data_size)
+	{
+		if ((offset < 0) || (data_size < 0) || ((data_size + offset) > size))
+			throw Exception("Element array buffer, invalid size");
+
+		const ComPtr<ID3D11Device> &device = static_cast<D3DGraphicContextProvider*>(gc.get_provider())->get_window()->get_device();
+		ComPtr<ID3D11DeviceContext> device_context;
+		device->GetImmediateContext(device_context.output_variable());
+
+		D3D11_BOX box;
+		box.left = offset;
+		box.right = offset + data_size;
+		box.top = 0;
+		box.bottom = 1;
+		box.front = 0;
+		box.back = 1;
+
+		device_context->UpdateSubresource(get_handles(device).buffer, 0, &box, data, 0, 0);
+	}
+
 	void D3DElementArrayBufferProvider::copy_from(GraphicContext &gc, TransferBuffer &buffer, int dest_pos, int src_pos, int copy_size)
 	{
 		const ComPtr<ID3D11Device> &device = static_cast<D3DGraphicContextProvider*>(gc.get_provider())->get_window()->get_device();
@@ -0,0 +1,72 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "D3D/precomp.h"
+#include "d3d_fence_provider.h"
+#include "API/D3D/d3d_target.h"
+
+namespace clan
+{
+	D3DFenceProvider::D3DFenceProvider(const ComPtr<ID3D11Device> &device, const ComPtr<ID3D11DeviceContext> &device_context)
+		: device(device), device_context(device_context), inserted(false)
+	{
+		D3D11_QUERY_DESC desc;
+		desc.Query = D3D11_QUERY_EVENT;
+		desc.MiscFlags = 0;
+		HRESULT result = device->CreateQuery(&desc, query.output_variable());
+		D3DTarget::throw_if_failed("ID3D11Device.CreateQuery failed", result);
+	}
+
+	D3DFenceProvider::~D3DFenceProvider()
+	{
+	}
+
+	void D3DFenceProvider::insert()
+	{
+		device_context->End(query);
+		device_context->Flush();
+		inserted = true;
+	}
+
+	bool D3DFenceProvider::is_signaled()
+	{
+		if (!inserted)
+			return true;
+
+		BOOL done = FALSE;
+		HRESULT result = device_context->GetData(query, &done, sizeof(BOOL), D3D11_ASYNC_GETDATA_DONOTFLUSH);
+		D3DTarget::throw_if_failed("ID3D11DeviceContext.GetData failed", result);
+		return result == S_OK && done;
+	}
+
+	void D3DFenceProvider::wait()
+	{
+		while (!is_signaled())
+			Sleep(0);
+	}
+}
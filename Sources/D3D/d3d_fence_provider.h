@@ -24,48 +24,28 @@
 **  File Author(s):
 **
 **    Magnus Norddahl
-**    Mark Page
 */
 
-#include "precomp.h"
-#include "utils.h"
+#pragma once
 
-Utils::Utils()
-{
-	string_hello_world = "Hello World";
-	five = 5;
-}
-
-
-void Utils::test_empty()
-{
-}
-
-int Utils::test_return_int()
-{
-	return five;
-}
+#include "API/Display/TargetProviders/fence_provider.h"
 
-std::string Utils::test_return_string()
+namespace clan
 {
-	return string_hello_world;
-}
+	class D3DFenceProvider : public FenceProvider
+	{
+	public:
+		D3DFenceProvider(const ComPtr<ID3D11Device> &device, const ComPtr<ID3D11DeviceContext> &device_context);
+		~D3DFenceProvider();
 
-std::string &Utils::test_return_string2()
-{
-	return string_hello_world;
-}
+		void insert();
+		bool is_signaled();
+		void wait();
 
-std::string Utils::test_return_string3()
-{
-	return "Hello World";
-}
-void Utils::test_get_string(std::string &out_string)
-{
-	out_string = string_hello_world;
-}
-
-int Utils::test_string_v8(const std::string &s)
-{
-	return s.length();
+	private:
+		ComPtr<ID3D11Device> device;
+		ComPtr<ID3D11DeviceContext> device_context;
+		ComPtr<ID3D11Query> query;
+		bool inserted;
+	};
 }
@@ -34,6 +34,8 @@
 #include "d3d_pixel_buffer_provider.h"
 #include "d3d_frame_buffer_provider.h"
 #include "d3d_occlusion_query_provider.h"
+#include "d3d_timer_query_provider.h"
+#include "d3d_fence_provider.h"
 #include "d3d_program_object_provider.h"
 #include "d3d_render_buffer_provider.h"
 #include "d3d_shader_object_provider.h"
@@ -128,6 +130,11 @@ namespace clan
 		return 16; // To do: this is the D3D10 limit - is it still the same for D3D11?
 	}
 
+	int D3DGraphicContextProvider::get_uniform_buffer_alignment() const
+	{
+		return 256; // Constant buffer ranges start at multiples of 16 constants
+	}
+
 	Size D3DGraphicContextProvider::get_max_texture_size() const
 	{
 		switch (window->get_feature_level())
@@ -179,6 +186,23 @@ namespace clan
 		return pixels;
 	}
 
+	void D3DGraphicContextProvider::read_pixels(const Rect& rect, PixelBufferProvider *destination)
+	{
+		// To do: window->get_back_buffer() is only correct when no frame buffer is bound
+		D3DPixelBufferProvider *pb_provider = static_cast<D3DPixelBufferProvider *>(destination);
+		if (pb_provider->get_size() != rect.get_size())
+			throw Exception("GraphicContext::read_pixels rectangle does not match the pixel buffer size");
+
+		D3D11_BOX box;
+		box.left = rect.left;
+		box.top = rect.top;
+		box.right = rect.right;
+		box.bottom = rect.bottom;
+		box.front = 0;
+		box.back = 1;
+		window->get_device_context()->CopySubresourceRegion(pb_provider->get_texture_2d(window->get_device()), 0, 0, 0, 0, window->get_back_buffer(), 0, &box);
+	}
+
 	TextureProvider *D3DGraphicContextProvider::alloc_texture(TextureDimensions texture_dimensions)
 	{
 		return new D3DTextureProvider(window->get_device(), window->get_feature_level(), texture_dimensions);
@@ -186,7 +210,17 @@ namespace clan
 
 	OcclusionQueryProvider *D3DGraphicContextProvider::alloc_occlusion_query()
 	{
-		return new D3DOcclusionQueryProvider;
+		return new D3DOcclusionQueryProvider(window->get_device(), window->get_device_context());
+	}
+
+	TimerQueryProvider *D3DGraphicContextProvider::alloc_timer_query()
+	{
+		return new D3DTimerQueryProvider(window->get_device(), window->get_device_context());
+	}
+
+	FenceProvider *D3DGraphicContextProvider::alloc_fence()
+	{
+		return new D3DFenceProvider(window->get_device(), window->get_device_context());
 	}
 
 	ProgramObjectProvider *D3DGraphicContextProvider::alloc_program_object()
@@ -401,6 +435,11 @@ namespace clan
 		unit_map.set_uniform_buffer(this, index, buffer);
 	}
 
+	void D3DGraphicContextProvider::set_uniform_buffer_range(int index, const UniformBuffer &buffer, int offset, int size)
+	{
+		unit_map.set_uniform_buffer(this, index, buffer, offset, size);
+	}
+
 	void D3DGraphicContextProvider::reset_uniform_buffer(int index)
 	{
 		unit_map.set_uniform_buffer(this, index, UniformBuffer());
@@ -542,6 +581,19 @@ namespace clan
 		window->get_device_context()->DrawInstanced(num_vertices, instance_count, offset, 0);
 	}
 
+	void D3DGraphicContextProvider::draw_primitives_array_indirect(PrimitivesType type, const StorageBuffer &commands, size_t offset, int draw_count, int stride)
+	{
+		if (stride == 0)
+			stride = sizeof(DrawArraysIndirectCommand);
+
+		ComPtr<ID3D11Buffer> &args = static_cast<D3DStorageBufferProvider*>(commands.get_provider())->get_indirect_args(window->get_device(), window->get_device_context());
+		apply_input_layout();
+		window->get_device_context()->IASetPrimitiveTopology(to_d3d_primitive_topology(type));
+		window->validate_context();
+		for (int i = 0; i < draw_count; i++)
+			window->get_device_context()->DrawInstancedIndirect(args, (UINT)(offset + i * stride));
+	}
+
 	void D3DGraphicContextProvider::set_primitives_elements(ElementArrayBufferProvider *array_provider)
 	{
 		current_element_array_provider = static_cast<D3DElementArrayBufferProvider*>(array_provider);
@@ -571,6 +623,20 @@ namespace clan
 		window->get_device_context()->DrawIndexedInstanced(count, instance_count, to_d3d_index_location(indices_type, offset), 0, 0);
 	}
 
+	void D3DGraphicContextProvider::draw_primitives_elements_indirect(PrimitivesType type, VertexAttributeDataType indices_type, const StorageBuffer &commands, size_t offset, int draw_count, int stride)
+	{
+		if (stride == 0)
+			stride = sizeof(DrawElementsIndirectCommand);
+
+		ComPtr<ID3D11Buffer> &args = static_cast<D3DStorageBufferProvider*>(commands.get_provider())->get_indirect_args(window->get_device(), window->get_device_context());
+		apply_input_layout();
+		window->get_device_context()->IASetPrimitiveTopology(to_d3d_primitive_topology(type));
+		window->get_device_context()->IASetIndexBuffer(current_element_array_provider->get_buffer(window->get_device()), to_d3d_format(indices_type), 0);
+		window->validate_context();
+		for (int i = 0; i < draw_count; i++)
+			window->get_device_context()->DrawIndexedInstancedIndirect(args, (UINT)(offset + i * stride));
+	}
+
 	void D3DGraphicContextProvider::draw_primitives_elements(PrimitivesType type, int count, ElementArrayBufferProvider *array_provider, VertexAttributeDataType indices_type, void *offset)
 	{
 		set_primitives_elements(array_provider);
@@ -614,6 +680,7 @@ namespace clan
 
 	void D3DGraphicContextProvider::dispatch(int x, int y, int z)
 	{
+		window->get_upload_ring().flush();
 		window->get_device_context()->Dispatch(x, y, z);
 	}
 
@@ -757,6 +824,26 @@ namespace clan
 		return options.ComputeShaders_Plus_RawAndStructuredBuffers_Via_Shader_4_x != FALSE;
 	}
 
+	bool D3DGraphicContextProvider::is_compressed_format_supported(TextureFormat format) const
+	{
+		if (format < tf_compressed_red_rgtc1)
+			return false;
+
+		DXGI_FORMAT d3d_format;
+		try
+		{
+			d3d_format = D3DTextureProvider::to_d3d_format(format);
+		}
+		catch (const Exception &)
+		{
+			return false;
+		}
+
+		UINT support = 0;
+		HRESULT result = window->get_device()->CheckFormatSupport(d3d_format, &support);
+		return SUCCEEDED(result) && (support & D3D11_FORMAT_SUPPORT_TEXTURE2D) != 0;
+	}
+
 	D3D11_PRIMITIVE_TOPOLOGY D3DGraphicContextProvider::to_d3d_primitive_topology(PrimitivesType type)
 	{
 		switch (type)
@@ -58,6 +58,7 @@ namespace clan
 		~D3DGraphicContextProvider();
 
 		int get_max_attributes();
+		int get_uniform_buffer_alignment() const;
 		Size get_max_texture_size() const;
 		Size get_display_window_size() const;
 		float get_pixel_ratio() const override;
@@ -78,9 +79,13 @@ namespace clan
 		int get_major_version() const;
 		int get_minor_version() const;
 		bool has_compute_shader_support() const;
+		bool is_compressed_format_supported(TextureFormat format) const;
 		PixelBuffer get_pixeldata(const Rect& rect, TextureFormat texture_format, bool clamp) const;
+		void read_pixels(const Rect& rect, PixelBufferProvider *destination);
 		TextureProvider *alloc_texture(TextureDimensions texture_dimensions);
 		OcclusionQueryProvider *alloc_occlusion_query();
+		TimerQueryProvider *alloc_timer_query();
+		FenceProvider *alloc_fence();
 		ProgramObjectProvider *alloc_program_object();
 		ShaderObjectProvider *alloc_shader_object();
 		FrameBufferProvider *alloc_frame_buffer();
@@ -102,6 +107,7 @@ namespace clan
 		void set_program_object(const ProgramObject &program);
 		void reset_program_object();
 		void set_uniform_buffer(int index, const UniformBuffer &buffer);
+		void set_uniform_buffer_range(int index, const UniformBuffer &buffer, int offset, int size);
 		void reset_uniform_buffer(int index);
 		void set_storage_buffer(int index, const StorageBuffer &buffer);
 		void reset_storage_buffer(int index);
@@ -119,9 +125,11 @@ namespace clan
 		void set_primitives_array(const PrimitivesArray &primitives_array);
 		void draw_primitives_array(PrimitivesType type, int offset, int num_vertices);
 		void draw_primitives_array_instanced(PrimitivesType type, int offset, int num_vertices, int instance_count);
+		void draw_primitives_array_indirect(PrimitivesType type, const StorageBuffer &commands, size_t offset, int draw_count, int stride);
 		void set_primitives_elements(ElementArrayBufferProvider *array_provider);
 		void draw_primitives_elements(PrimitivesType type, int count, VertexAttributeDataType indices_type, size_t offset = 0);
 		void draw_primitives_elements_instanced(PrimitivesType type, int count, VertexAttributeDataType indices_type, size_t offset, int instance_count);
+		void draw_primitives_elements_indirect(PrimitivesType type, VertexAttributeDataType indices_type, const StorageBuffer &commands, size_t offset, int draw_count, int stride);
 		void reset_primitives_elements();
 		void draw_primitives_elements(PrimitivesType type, int count, ElementArrayBufferProvider *array_provider, VertexAttributeDataType indices_type, void *offset);
 		void draw_primitives_elements_instanced(PrimitivesType type, int count, ElementArrayBufferProvider *array_provider, VertexAttributeDataType indices_type, void *offset, int instance_count);
@@ -28,11 +28,14 @@
 
 #include "D3D/precomp.h"
 #include "d3d_occlusion_query_provider.h"
+#include "API/D3D/d3d_target.h"
 
 namespace clan
 {
-	D3DOcclusionQueryProvider::D3DOcclusionQueryProvider()
+	D3DOcclusionQueryProvider::D3DOcclusionQueryProvider(const ComPtr<ID3D11Device> &device, const ComPtr<ID3D11DeviceContext> &device_context)
+		: device(device), device_context(device_context)
 	{
+		create();
 	}
 
 	D3DOcclusionQueryProvider::~D3DOcclusionQueryProvider()
@@ -41,23 +44,41 @@ namespace clan
 
 	bool D3DOcclusionQueryProvider::is_result_ready() const
 	{
-		return false;
+		// Polling must not flush, or asking every frame would stall like get_result does
+		UINT64 samples = 0;
+		return device_context->GetData(query, &samples, sizeof(UINT64), D3D11_ASYNC_GETDATA_DONOTFLUSH) == S_OK;
 	}
 
 	int D3DOcclusionQueryProvider::get_result() const
 	{
-		return 0;
+		UINT64 samples = 0;
+		while (true)
+		{
+			HRESULT result = device_context->GetData(query, &samples, sizeof(UINT64), 0);
+			D3DTarget::throw_if_failed("ID3D11DeviceContext.GetData failed", result);
+			if (result == S_OK)
+				break;
+			Sleep(0);
+		}
+		return (int)samples;
 	}
 
 	void D3DOcclusionQueryProvider::begin()
 	{
+		device_context->Begin(query);
 	}
 
 	void D3DOcclusionQueryProvider::end()
 	{
+		device_context->End(query);
 	}
 
 	void D3DOcclusionQueryProvider::create()
 	{
+		D3D11_QUERY_DESC desc;
+		desc.Query = D3D11_QUERY_OCCLUSION;
+		desc.MiscFlags = 0;
+		HRESULT result = device->CreateQuery(&desc, query.output_variable());
+		D3DTarget::throw_if_failed("ID3D11Device.CreateQuery failed", result);
 	}
 }
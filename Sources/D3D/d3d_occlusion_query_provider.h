@@ -35,7 +35,7 @@ namespace clan
 	class D3DOcclusionQueryProvider : public OcclusionQueryProvider
 	{
 	public:
-		D3DOcclusionQueryProvider();
+		D3DOcclusionQueryProvider(const ComPtr<ID3D11Device> &device, const ComPtr<ID3D11DeviceContext> &device_context);
 		~D3DOcclusionQueryProvider();
 
 		bool is_result_ready() const;
@@ -44,5 +44,10 @@ namespace clan
 		void begin();
 		void end();
 		void create();
+
+	private:
+		ComPtr<ID3D11Device> device;
+		ComPtr<ID3D11DeviceContext> device_context;
+		ComPtr<ID3D11Query> query;
 	};
 }
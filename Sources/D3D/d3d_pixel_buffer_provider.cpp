@@ -80,6 +80,7 @@ namespace clan
 
 		HRESULT result = handles.front()->device->CreateTexture2D(&texture_desc, 0, handles.front()->texture.output_variable());
 		D3DTarget::throw_if_failed("ID3D11Device.CreateTexture2D failed", result);
+		memory.set_size(GPUMemoryTracker::get_texture_size(format, size.width, size.height));
 	}
 
 	void *D3DPixelBufferProvider::get_data()
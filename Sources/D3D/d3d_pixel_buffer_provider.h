@@ -29,6 +29,7 @@
 #pragma once
 
 #include "API/Display/TargetProviders/pixel_buffer_provider.h"
+#include "API/Display/Render/gpu_memory.h"
 #include "d3d_share_list.h"
 
 namespace clan
@@ -75,6 +76,7 @@ namespace clan
 		D3DGraphicContextProvider *map_gc_provider;
 
 		Size size;
+		GPUMemoryAllocation memory{gpu_memory_pixel_buffer};
 		TextureFormat texture_format;
 		bool data_locked;	// lock() has been called
 	};
@@ -100,6 +100,7 @@ namespace clan
 
 		HRESULT result = handles.front()->device->CreateTexture2D(&texture_desc, 0, handles.front()->texture.output_variable());
 		D3DTarget::throw_if_failed("ID3D11Device.CreateTexture2D failed", result);
+		memory.set_size(GPUMemoryTracker::get_texture_size(texture_format, width, height, 1, 1, 1, max(multisample_samples, 1)));
 	}
 
 	void D3DRenderBufferProvider::device_destroyed(ID3D11Device *device)
@@ -29,6 +29,7 @@
 #pragma once
 
 #include "API/Display/TargetProviders/render_buffer_provider.h"
+#include "API/Display/Render/gpu_memory.h"
 #include "API/Display/Image/pixel_buffer.h"
 
 namespace clan
@@ -58,5 +59,6 @@ namespace clan
 		DeviceHandles &get_handles(const ComPtr<ID3D11Device> &device);
 
 		std::vector<std::shared_ptr<DeviceHandles> > handles;
+		GPUMemoryAllocation memory{gpu_memory_render_buffer};
 	};
 }
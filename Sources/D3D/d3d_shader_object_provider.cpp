@@ -30,6 +30,7 @@
 #include "d3d_shader_object_provider.h"
 #include "API/D3D/d3d_target.h"
 #include "API/Core/Text/string_format.h"
+#include "API/Display/Render/program_binary_cache.h"
 
 namespace clan
 {
@@ -56,6 +57,8 @@ namespace clan
 		std::vector<D3D11_SHADER_INPUT_BIND_DESC> binding;
 	};
 
+	const UINT D3DShaderObjectProvider::compile_flags = D3D10_SHADER_ENABLE_STRICTNESS | D3D10_SHADER_OPTIMIZATION_LEVEL3;
+
 	D3DShaderObjectProvider::D3DShaderObjectProvider(const ComPtr<ID3D11Device> &device, D3D_FEATURE_LEVEL feature_level)
 		: device(device), compile_status(false), feature_level(feature_level)
 	{
@@ -120,39 +123,72 @@ namespace clan
 		shader.clear();
 		info_log.clear();
 
+		std::string cache_key;
+		bool from_cache = false;
 		if (!bytecode.get_size())
 		{
 			load_compiler_dll();
 
-			std::string entry_point = "main";
-			std::string shader_model = get_shader_model();
-
-			ComPtr<ID3DBlob> blob;
-			ComPtr<ID3DBlob> log;
-			HRESULT result = d3dcompile(
-				shader_source.data(),
-				shader_source.length(),
-				0,
-				0,
-				0,
-				entry_point.c_str(),
-				shader_model.c_str(),
-				D3D10_SHADER_ENABLE_STRICTNESS | D3D10_SHADER_OPTIMIZATION_LEVEL3,
-				0,
-				blob.output_variable(),
-				log.output_variable());
-
-			if (log)
-				info_log = std::string(reinterpret_cast<char*>(log->GetBufferPointer()), log->GetBufferSize());
-
-			if (SUCCEEDED(result))
+			if (ProgramBinaryCache::is_enabled())
+			{
+				cache_key = ProgramBinaryCache::get_key(string_format("hlsl %1 %2\n", get_shader_model(), (int)compile_flags) + shader_source);
+				bytecode = ProgramBinaryCache::load(cache_key);
+				from_cache = bytecode.get_size() != 0;
+			}
+
+			if (!from_cache)
+			{
+				if (!compile_source())
+					return;
+				if (!cache_key.empty())
+					ProgramBinaryCache::save(cache_key, bytecode);
+			}
+		}
+
+		if (!create_from_bytecode() && from_cache)
+		{
+			// Bytecode from the cache that the device rejects is compiled again from source
+			info_log.clear();
+			if (compile_source())
 			{
-				bytecode = DataBuffer(blob->GetBufferPointer(), blob->GetBufferSize());
+				ProgramBinaryCache::save(cache_key, bytecode);
+				create_from_bytecode();
 			}
-			else
-				return;
 		}
+	}
+
+	bool D3DShaderObjectProvider::compile_source()
+	{
+		std::string entry_point = "main";
+		std::string shader_model = get_shader_model();
+
+		ComPtr<ID3DBlob> blob;
+		ComPtr<ID3DBlob> log;
+		HRESULT result = d3dcompile(
+			shader_source.data(),
+			shader_source.length(),
+			0,
+			0,
+			0,
+			entry_point.c_str(),
+			shader_model.c_str(),
+			compile_flags,
+			0,
+			blob.output_variable(),
+			log.output_variable());
+
+		if (log)
+			info_log = std::string(reinterpret_cast<char*>(log->GetBufferPointer()), log->GetBufferSize());
+
+		if (FAILED(result))
+			return false;
+
+		bytecode = DataBuffer(blob->GetBufferPointer(), blob->GetBufferSize());
+		return true;
+	}
 
+	bool D3DShaderObjectProvider::create_from_bytecode()
+	{
 		try
 		{
 			create_shader();
@@ -165,7 +201,7 @@ namespace clan
 				info_log += "\r\n";
 			info_log += e.message;
 		}
-
+		return compile_status;
 	}
 
 	std::recursive_mutex D3DShaderObjectProvider::d3dcompiler_mutex;
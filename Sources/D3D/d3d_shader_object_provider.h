@@ -72,11 +72,15 @@ namespace clan
 
 	private:
 		void set_binding(D3D11_SHADER_INPUT_BIND_DESC &binding);
+		bool compile_source();
+		bool create_from_bytecode();
 		void create_shader();
 		void find_locations();
 		std::string get_shader_model() const;
 		void load_compiler_dll();
 
+		static const UINT compile_flags;
+
 		std::string info_log;
 		bool compile_status;
 		std::string shader_source;
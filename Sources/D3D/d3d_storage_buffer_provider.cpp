@@ -58,6 +58,7 @@ namespace clan
 		desc.StructureByteStride = new_stride;
 		HRESULT result = handles.front()->device->CreateBuffer(&desc, 0, handles.front()->buffer.output_variable());
 		D3DTarget::throw_if_failed("Unable to create program storage block", result);
+		memory.set_size(size);
 	}
 
 	void D3DStorageBufferProvider::create(const void *data, int new_size, int new_stride, BufferUsage usage)
@@ -78,6 +79,7 @@ namespace clan
 		desc.StructureByteStride = new_stride;
 		HRESULT result = handles.front()->device->CreateBuffer(&desc, &resource_data, handles.front()->buffer.output_variable());
 		D3DTarget::throw_if_failed("Unable to create program storage block", result);
+		memory.set_size(size);
 	}
 
 	ComPtr<ID3D11Buffer> &D3DStorageBufferProvider::get_buffer(const ComPtr<ID3D11Device> &device)
@@ -120,6 +122,33 @@ namespace clan
 		return handles.uav;
 	}
 
+	ComPtr<ID3D11Buffer> &D3DStorageBufferProvider::get_indirect_args(const ComPtr<ID3D11Device> &device, const ComPtr<ID3D11DeviceContext> &device_context)
+	{
+		DeviceHandles &handles = get_handles(device);
+		if (!handles.indirect_args)
+		{
+			D3D11_BUFFER_DESC desc;
+			desc.ByteWidth = size;
+			desc.Usage = D3D11_USAGE_DEFAULT;
+			desc.BindFlags = 0;
+			desc.CPUAccessFlags = 0;
+			desc.MiscFlags = D3D11_RESOURCE_MISC_DRAWINDIRECT_ARGS;
+			desc.StructureByteStride = 0;
+			HRESULT result = device->CreateBuffer(&desc, 0, handles.indirect_args.output_variable());
+			D3DTarget::throw_if_failed("Unable to create indirect arguments buffer", result);
+		}
+
+		D3D11_BOX box;
+		box.left = 0;
+		box.right = size;
+		box.top = 0;
+		box.bottom = 1;
+		box.front = 0;
+		box.back = 1;
+		device_context->CopySubresourceRegion(handles.indirect_args, 0, 0, 0, 0, handles.buffer, 0, &box);
+		return handles.indirect_args;
+	}
+
 	void D3DStorageBufferProvider::upload_data(GraphicContext &gc, const void *data, int data_size)
 	{
 		if (data_size != size)
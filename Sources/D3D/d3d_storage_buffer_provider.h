@@ -29,6 +29,7 @@
 #pragma once
 
 #include "API/Display/TargetProviders/storage_buffer_provider.h"
+#include "API/Display/Render/gpu_memory.h"
 
 namespace clan
 {
@@ -44,6 +45,11 @@ namespace clan
 		ComPtr<ID3D11UnorderedAccessView> &get_uav(const ComPtr<ID3D11Device> &device);
 		ComPtr<ID3D11ShaderResourceView> &get_srv(const ComPtr<ID3D11Device> &device);
 
+		/// \brief Returns a copy of the buffer usable as draw indirect arguments
+		///
+		/// Direct3D does not allow structured buffers to hold indirect arguments, so the contents are copied on the GPU.
+		ComPtr<ID3D11Buffer> &get_indirect_args(const ComPtr<ID3D11Device> &device, const ComPtr<ID3D11DeviceContext> &device_context);
+
 		void upload_data(GraphicContext &gc, const void *data, int size);
 		void copy_from(GraphicContext &gc, TransferBuffer &buffer, int dest_pos, int src_pos, int size);
 		void copy_to(GraphicContext &gc, TransferBuffer &buffer, int dest_pos, int src_pos, int size);
@@ -56,6 +62,7 @@ namespace clan
 			ComPtr<ID3D11Buffer> buffer;
 			ComPtr<ID3D11ShaderResourceView> srv;
 			ComPtr<ID3D11UnorderedAccessView> uav;
+			ComPtr<ID3D11Buffer> indirect_args;
 		};
 
 		void device_destroyed(ID3D11Device *device);
@@ -65,5 +72,6 @@ namespace clan
 
 		std::vector<std::shared_ptr<DeviceHandles> > handles;
 		int size;
+		GPUMemoryAllocation memory{gpu_memory_storage_buffer};
 	};
 }
@@ -30,6 +30,7 @@
 
 #include "d3d_share_list.h"
 #include "API/Display/TargetProviders/texture_provider.h"
+#include "API/Display/Render/gpu_memory.h"
 
 namespace clan
 {
@@ -84,5 +85,6 @@ namespace clan
 		mutable std::vector<std::shared_ptr<DeviceHandles> > handles;
 		D3D_FEATURE_LEVEL feature_level;
 		TextureDimensions texture_dimensions;
+		GPUMemoryAllocation memory{gpu_memory_texture};
 	};
 }
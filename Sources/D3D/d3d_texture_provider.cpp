@@ -31,6 +31,7 @@
 #include "d3d_pixel_buffer_provider.h"
 #include "d3d_graphic_context_provider.h"
 #include "d3d_display_window_provider.h"
+#include "d3d_upload_ring.h"
 #include "API/Display/Image/pixel_buffer.h"
 #include "API/Display/Render/transfer_texture.h"
 #include "API/D3D/d3d_target.h"
@@ -517,6 +518,10 @@ namespace clan
 	{
 		// To do: maybe change function to take a gc parameter to make it clear which context the operation should be executed on
 
+		D3DUploadRing *upload_ring = D3DUploadRing::find(view_handles.front()->device);
+		if (upload_ring)
+			upload_ring->flush();
+
 		ComPtr<ID3D11DeviceContext> device_context;
 		view_handles.front()->device->GetImmediateContext(device_context.output_variable());
 		device_context->GenerateMips(get_srv(view_handles.front()->device));
@@ -540,6 +545,14 @@ namespace clan
 		{
 			throw Exception("Unknown texture dimensions type");
 		}
+
+		int layers = max(array_size, 1);
+		if (data->texture_dimensions == texture_cube)
+			layers = 6;
+		else if (data->texture_dimensions == texture_cube_array)
+			layers = 6 * array_size;
+		int texture_depth = (data->texture_dimensions == texture_3d) ? depth : 1;
+		data->memory.set_size(GPUMemoryTracker::get_texture_size(texture_format, width, height, texture_depth, layers, levels));
 	}
 
 	void D3DTextureProvider::create_1d(int width, int height, int depth, int array_size, TextureFormat texture_format, int levels)
@@ -729,6 +742,7 @@ namespace clan
 		box.bottom = height;
 		box.front = 0;
 		box.back = 1;
+		gc_provider->get_window()->get_upload_ring().flush();
 		gc_provider->get_window()->get_device_context()->CopySubresourceRegion(pb_provider->get_texture_2d(gc_provider->get_window()->get_device()), level, 0, 0, 0, data_handles.texture, 0, &box);
 		return pixels;
 	}
@@ -784,9 +798,13 @@ namespace clan
 
 		int dest_subresource = D3D11CalcSubresource(level, array_slice, mip_levels);
 
+		D3DUploadRing &upload_ring = gc_provider->get_window()->get_upload_ring();
+
 		D3DPixelBufferProvider *pb_provider = dynamic_cast<D3DPixelBufferProvider*>(source_image.get_provider());
 		if (pb_provider)
 		{
+			upload_ring.flush();
+
 			int src_subresource = D3D11CalcSubresource(0, 0, 1);
 
 			D3D11_BOX box;
@@ -830,6 +848,7 @@ namespace clan
 				const unsigned char *src_data = src_image_converted.get_data_uint8();
 				//src_data += (block_x + block_y * blocks_per_row) * bytes_per_block;
 
+				upload_ring.flush();
 				device_context->UpdateSubresource(data_handles.texture, dest_subresource, &box, src_data, row_pitch, slice_pitch);
 			}
 			else
@@ -840,6 +859,14 @@ namespace clan
 				const unsigned char *src_data = src_image_converted.get_data_uint8();
 				//src_data += src_rect.left * src_image_converted.get_bytes_per_pixel() + src_rect.top * src_image_converted.get_pitch();
 
+				// 2D uploads are batched through staging pages and copied on the GPU timeline
+				if (data_handles.texture_type == D3DTextureData::DeviceTextureType::ID3D11Texture2D &&
+					upload_ring.upload(data_handles.texture, dest_subresource, x, y, format, src_image_converted.get_bytes_per_pixel(), src_data, row_pitch, src_rect.get_width(), src_rect.get_height()))
+				{
+					return;
+				}
+
+				upload_ring.flush();
 				device_context->UpdateSubresource(data_handles.texture, dest_subresource, &box, src_data, row_pitch, slice_pitch);
 			}
 		}
@@ -1081,6 +1108,14 @@ namespace clan
 		case tf_compressed_srgb_alpha_s3tc_dxt1: return DXGI_FORMAT_BC1_UNORM_SRGB;
 		case tf_compressed_srgb_alpha_s3tc_dxt3: return DXGI_FORMAT_BC2_UNORM_SRGB;
 		case tf_compressed_srgb_alpha_s3tc_dxt5: return DXGI_FORMAT_BC3_UNORM_SRGB;
+		case tf_compressed_rgba_bptc_unorm: return DXGI_FORMAT_BC7_UNORM;
+		case tf_compressed_srgb_alpha_bptc_unorm: return DXGI_FORMAT_BC7_UNORM_SRGB;
+		case tf_compressed_rgb8_etc2: break;
+		case tf_compressed_srgb8_etc2: break;
+		case tf_compressed_rgba8_etc2_eac: break;
+		case tf_compressed_srgb8_alpha8_etc2_eac: break;
+		case tf_compressed_rgba_astc_4x4: break;
+		case tf_compressed_srgb8_alpha8_astc_4x4: break;
 		}
 		throw Exception("Unsupported format");
 	}
@@ -0,0 +1,107 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "D3D/precomp.h"
+#include "d3d_timer_query_provider.h"
+#include "API/D3D/d3d_target.h"
+
+namespace clan
+{
+	D3DTimerQueryProvider::D3DTimerQueryProvider(const ComPtr<ID3D11Device> &device, const ComPtr<ID3D11DeviceContext> &device_context)
+		: device(device), device_context(device_context)
+	{
+		create();
+	}
+
+	D3DTimerQueryProvider::~D3DTimerQueryProvider()
+	{
+	}
+
+	bool D3DTimerQueryProvider::is_result_ready() const
+	{
+		// The disjoint query ends last, so it completes after both timestamps
+		D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjoint;
+		return device_context->GetData(disjoint_query, &disjoint, sizeof(disjoint), D3D11_ASYNC_GETDATA_DONOTFLUSH) == S_OK;
+	}
+
+	uint64_t D3DTimerQueryProvider::get_result() const
+	{
+		D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjoint;
+		wait_for_data(disjoint_query, &disjoint, sizeof(disjoint));
+
+		UINT64 start_time = 0, end_time = 0;
+		wait_for_data(start_query, &start_time, sizeof(UINT64));
+		wait_for_data(end_query, &end_time, sizeof(UINT64));
+
+		if (disjoint.Disjoint || disjoint.Frequency == 0 || end_time < start_time)
+			return 0;
+
+		UINT64 ticks = end_time - start_time;
+		return (ticks / disjoint.Frequency) * 1000000000 + (ticks % disjoint.Frequency) * 1000000000 / disjoint.Frequency;
+	}
+
+	void D3DTimerQueryProvider::begin()
+	{
+		device_context->Begin(disjoint_query);
+		device_context->End(start_query);
+	}
+
+	void D3DTimerQueryProvider::end()
+	{
+		device_context->End(end_query);
+		device_context->End(disjoint_query);
+	}
+
+	void D3DTimerQueryProvider::create()
+	{
+		D3D11_QUERY_DESC desc;
+		desc.Query = D3D11_QUERY_TIMESTAMP_DISJOINT;
+		desc.MiscFlags = 0;
+		HRESULT result = device->CreateQuery(&desc, disjoint_query.output_variable());
+		D3DTarget::throw_if_failed("ID3D11Device.CreateQuery failed", result);
+
+		desc.Query = D3D11_QUERY_TIMESTAMP;
+		result = device->CreateQuery(&desc, start_query.output_variable());
+		D3DTarget::throw_if_failed("ID3D11Device.CreateQuery failed", result);
+		result = device->CreateQuery(&desc, end_query.output_variable());
+		D3DTarget::throw_if_failed("ID3D11Device.CreateQuery failed", result);
+	}
+
+	void D3DTimerQueryProvider::wait_for_data(const ComPtr<ID3D11Query> &query, void *data, UINT size) const
+	{
+		while (true)
+		{
+			HRESULT result = device_context->GetData(query, data, size, 0);
+			D3DTarget::throw_if_failed("ID3D11DeviceContext.GetData failed", result);
+			if (result == S_OK)
+				break;
+			Sleep(0);
+		}
+	}
+}
@@ -0,0 +1,60 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include "API/Display/TargetProviders/timer_query_provider.h"
+
+namespace clan
+{
+	class D3DTimerQueryProvider : public TimerQueryProvider
+	{
+	public:
+		D3DTimerQueryProvider(const ComPtr<ID3D11Device> &device, const ComPtr<ID3D11DeviceContext> &device_context);
+		~D3DTimerQueryProvider();
+
+		bool is_result_ready() const;
+		uint64_t get_result() const;
+
+		void begin();
+		void end();
+		void create();
+
+	private:
+		void wait_for_data(const ComPtr<ID3D11Query> &query, void *data, UINT size) const;
+
+		ComPtr<ID3D11Device> device;
+		ComPtr<ID3D11DeviceContext> device_context;
+
+		// D3D11 has no elapsed time query, so two timestamps are taken inside a disjoint query that supplies the tick frequency
+		ComPtr<ID3D11Query> disjoint_query;
+		ComPtr<ID3D11Query> start_query;
+		ComPtr<ID3D11Query> end_query;
+	};
+}
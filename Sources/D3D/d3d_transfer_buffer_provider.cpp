@@ -69,6 +69,7 @@ namespace clan
 
 		HRESULT result = handles.front()->device->CreateBuffer(&desc, 0, handles.front()->buffer.output_variable());
 		D3DTarget::throw_if_failed("Unable to create transfer buffer", result);
+		memory.set_size(size);
 	}
 
 	void D3DTransferBufferProvider::create(void *data, int new_size, BufferUsage usage)
@@ -98,6 +99,7 @@ namespace clan
 
 		HRESULT result = handles.front()->device->CreateBuffer(&desc, &resource_data, handles.front()->buffer.output_variable());
 		D3DTarget::throw_if_failed("Unable to create transfer buffer", result);
+		memory.set_size(size);
 	}
 
 	void *D3DTransferBufferProvider::get_data()
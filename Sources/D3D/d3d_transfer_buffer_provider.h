@@ -29,6 +29,7 @@
 #pragma once
 
 #include "API/Display/TargetProviders/transfer_buffer_provider.h"
+#include "API/Display/Render/gpu_memory.h"
 
 namespace clan
 {
@@ -66,5 +67,6 @@ namespace clan
 		D3D11_MAPPED_SUBRESOURCE map_data;
 		ComPtr<ID3D11Device> map_device;
 		int size;
+		GPUMemoryAllocation memory{gpu_memory_transfer_buffer};
 	};
 }
@@ -29,6 +29,7 @@
 #pragma once
 
 #include "API/Display/TargetProviders/uniform_buffer_provider.h"
+#include "API/Display/Render/gpu_memory.h"
 
 namespace clan
 {
@@ -43,6 +44,8 @@ namespace clan
 		ComPtr<ID3D11Buffer> &get_buffer(const ComPtr<ID3D11Device> &device);
 
 		void upload_data(GraphicContext &gc, const void *data, int size);
+		void upload_data(GraphicContext &gc, int offset, const void *data, int size);
+		void upload_data_unsynchronized(GraphicContext &gc, int offset, const void *data, int size, bool discard);
 		void copy_from(GraphicContext &gc, TransferBuffer &buffer, int dest_pos, int src_pos, int size);
 		void copy_to(GraphicContext &gc, TransferBuffer &buffer, int dest_pos, int src_pos, int size);
 
@@ -54,6 +57,7 @@ namespace clan
 			ComPtr<ID3D11Buffer> buffer;
 		};
 
+		void upload_data_range(GraphicContext &gc, int offset, const void *data, int size, UINT copy_flags);
 		void device_destroyed(ID3D11Device *device);
 		DeviceHandles &get_handles(const ComPtr<ID3D11Device> &device);
 
@@ -61,5 +65,6 @@ namespace clan
 
 		std::vector<std::shared_ptr<DeviceHandles> > handles;
 		int size;
+		GPUMemoryAllocation memory{gpu_memory_uniform_buffer};
 	};
 }
@@ -34,6 +34,7 @@
 #include "d3d_storage_buffer_provider.h"
 #include "d3d_display_window_provider.h"
 #include "d3d_texture_provider.h"
+#include "API/D3D/d3d_target.h"
 
 namespace clan
 {
@@ -157,11 +158,13 @@ namespace clan
 		bind_image(gc, index);
 	}
 
-	void D3DUnitMap::set_uniform_buffer(D3DGraphicContextProvider *gc, int index, const UniformBuffer &buffer)
+	void D3DUnitMap::set_uniform_buffer(D3DGraphicContextProvider *gc, int index, const UniformBuffer &buffer, int offset, int size)
 	{
 		if (uniform_units.size() < index + 1)
 			uniform_units.resize(index + 1);
 		uniform_units[index].object = buffer;
+		uniform_units[index].offset = offset;
+		uniform_units[index].size = size;
 		bind_uniform_buffer(gc, index);
 	}
 
@@ -267,6 +270,12 @@ namespace clan
 	{
 		if (uniform_units.size() > index)
 		{
+			if (uniform_units[index].size != 0 && !uniform_units[index].object.is_null())
+			{
+				bind_uniform_buffer_range(gc, index);
+				return;
+			}
+
 			for (int j = 0; j < shadertype_num_types; j++)
 			{
 				if (uniform_units[index].shader_index[j] != -1)
@@ -300,6 +309,49 @@ namespace clan
 		}
 	}
 
+
+	void D3DUnitMap::bind_uniform_buffer_range(D3DGraphicContextProvider *gc, int index)
+	{
+		// Binding part of a constant buffer needs the Direct3D 11.1 runtime
+		ComPtr<ID3D11DeviceContext1> device_context1;
+		HRESULT result = gc->get_window()->get_device_context()->QueryInterface(__uuidof(ID3D11DeviceContext1), (void**)device_context1.output_variable());
+		D3DTarget::throw_if_failed("Binding a uniform buffer range requires Direct3D 11.1", result);
+
+		// Ranges are counted in 16 byte constants and the count must be a multiple of 16
+		UINT first_constant = uniform_units[index].offset / 16;
+		UINT num_constants = ((uniform_units[index].size + 255) / 256) * 16;
+
+		ID3D11Buffer *d3d_buffer = static_cast<D3DUniformBufferProvider*>(uniform_units[index].object.get_provider())->get_buffer(gc->get_window()->get_device());
+		for (int j = 0; j < shadertype_num_types; j++)
+		{
+			if (uniform_units[index].shader_index[j] != -1)
+			{
+				UINT slot = uniform_units[index].shader_index[j];
+				switch (j)
+				{
+				case shadertype_vertex:
+					device_context1->VSSetConstantBuffers1(slot, 1, &d3d_buffer, &first_constant, &num_constants);
+					break;
+				case shadertype_tess_control:
+					device_context1->HSSetConstantBuffers1(slot, 1, &d3d_buffer, &first_constant, &num_constants);
+					break;
+				case shadertype_tess_evaluation:
+					device_context1->DSSetConstantBuffers1(slot, 1, &d3d_buffer, &first_constant, &num_constants);
+					break;
+				case shadertype_geometry:
+					device_context1->GSSetConstantBuffers1(slot, 1, &d3d_buffer, &first_constant, &num_constants);
+					break;
+				case shadertype_fragment:
+					device_context1->PSSetConstantBuffers1(slot, 1, &d3d_buffer, &first_constant, &num_constants);
+					break;
+				case shadertype_compute:
+					device_context1->CSSetConstantBuffers1(slot, 1, &d3d_buffer, &first_constant, &num_constants);
+					break;
+				}
+			}
+		}
+	}
+
 	void D3DUnitMap::bind_storage_buffer(D3DGraphicContextProvider *gc, int index)
 	{
 		if (storage_units.size() > index)
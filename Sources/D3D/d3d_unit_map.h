@@ -50,7 +50,16 @@ namespace clan
 	typedef D3DUnit<Texture> D3DSamplerUnit;
 	typedef D3DUnit<Texture> D3DTextureUnit;
 	typedef D3DUnit<Texture> D3DImageUnit;
-	typedef D3DUnit<UniformBuffer> D3DUniformUnit;
+
+	class D3DUniformUnit
+	{
+	public:
+		D3DUniformUnit() : offset(0), size(0) { for (int i = 0; i < shadertype_num_types; i++) shader_index[i] = -1; }
+		int shader_index[shadertype_num_types];
+		UniformBuffer object;
+		int offset;
+		int size;	// Zero binds the whole buffer
+	};
 
 	class D3DStorageUnit
 	{
@@ -69,7 +78,7 @@ namespace clan
 		void set_sampler(D3DGraphicContextProvider *gc, int index, const Texture &texture);
 		void set_texture(D3DGraphicContextProvider *gc, int index, const Texture &texture);
 		void set_image(D3DGraphicContextProvider *gc, int index, const Texture &texture);
-		void set_uniform_buffer(D3DGraphicContextProvider *gc, int index, const UniformBuffer &buffer);
+		void set_uniform_buffer(D3DGraphicContextProvider *gc, int index, const UniformBuffer &buffer, int offset = 0, int size = 0);
 		void set_storage_buffer(D3DGraphicContextProvider *gc, int index, const StorageBuffer &buffer);
 
 	private:
@@ -77,6 +86,7 @@ namespace clan
 		void bind_texture(D3DGraphicContextProvider *gc, int index);
 		void bind_image(D3DGraphicContextProvider *gc, int index);
 		void bind_uniform_buffer(D3DGraphicContextProvider *gc, int index);
+		void bind_uniform_buffer_range(D3DGraphicContextProvider *gc, int index);
 		void bind_storage_buffer(D3DGraphicContextProvider *gc, int index);
 		void unbind_sampler(D3DGraphicContextProvider *gc, int index);
 		void unbind_texture(D3DGraphicContextProvider *gc, int index);
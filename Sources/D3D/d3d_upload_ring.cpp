@@ -0,0 +1,218 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "D3D/precomp.h"
+#include "d3d_upload_ring.h"
+#include <algorithm>
+
+namespace clan
+{
+	std::mutex D3DUploadRing::rings_mutex;
+	std::vector<D3DUploadRing *> D3DUploadRing::rings;
+
+	D3DUploadRing::D3DUploadRing(const ComPtr<ID3D11Device> &device, const ComPtr<ID3D11DeviceContext> &device_context)
+		: device(device), device_context(device_context)
+	{
+		std::unique_lock<std::mutex> lock(rings_mutex);
+		rings.push_back(this);
+	}
+
+	D3DUploadRing::~D3DUploadRing()
+	{
+		{
+			std::unique_lock<std::mutex> lock(rings_mutex);
+			rings.erase(std::find(rings.begin(), rings.end(), this));
+		}
+
+		for (auto &page : pages)
+		{
+			if (page->mapped)
+				device_context->Unmap(page->texture, 0);
+		}
+	}
+
+	D3DUploadRing *D3DUploadRing::find(ID3D11Device *device)
+	{
+		std::unique_lock<std::mutex> lock(rings_mutex);
+		for (D3DUploadRing *ring : rings)
+		{
+			if (ring->device.get() == device)
+				return ring;
+		}
+		return nullptr;
+	}
+
+	bool D3DUploadRing::upload(const ComPtr<ID3D11Resource> &texture, UINT subresource, int x, int y, DXGI_FORMAT format, int bytes_per_pixel, const unsigned char *data, int pitch, int width, int height)
+	{
+		if (width <= 0 || height <= 0 || width > page_size || height > page_size)
+			return false;
+
+		std::unique_lock<std::mutex> lock(mutex);
+
+		int page_x, page_y;
+		Page *page = open_page(format, width, height, page_x, page_y);
+		if (!page)
+			return false;
+
+		unsigned char *dest = static_cast<unsigned char *>(page->mapping.pData) + page_y * page->mapping.RowPitch + page_x * bytes_per_pixel;
+		int row_size = width * bytes_per_pixel;
+		for (int row = 0; row < height; row++)
+			memcpy(dest + row * page->mapping.RowPitch, data + row * pitch, row_size);
+
+		PendingCopy copy;
+		copy.texture = texture;
+		copy.subresource = subresource;
+		copy.x = x;
+		copy.y = y;
+		copy.page = page;
+		copy.box.left = page_x;
+		copy.box.top = page_y;
+		copy.box.right = page_x + width;
+		copy.box.bottom = page_y + height;
+		copy.box.front = 0;
+		copy.box.back = 1;
+		pending.push_back(copy);
+		has_pending = true;
+		return true;
+	}
+
+	void D3DUploadRing::flush()
+	{
+		if (!has_pending)
+			return;
+
+		std::unique_lock<std::mutex> lock(mutex);
+
+		// A staging resource cannot be the source of a copy while it is mapped
+		for (auto &page : pages)
+		{
+			if (page->mapped)
+			{
+				device_context->Unmap(page->texture, 0);
+				page->mapped = false;
+				page->frame = current_frame;
+			}
+		}
+
+		for (PendingCopy &copy : pending)
+			device_context->CopySubresourceRegion(copy.texture, copy.subresource, copy.x, copy.y, 0, copy.page->texture, 0, &copy.box);
+
+		pending.clear();
+		has_pending = false;
+	}
+
+	void D3DUploadRing::end_frame(uint64_t presented_frame, uint64_t new_completed_frame)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		current_frame = presented_frame + 1;
+		completed_frame = new_completed_frame;
+	}
+
+	D3DUploadRing::Page *D3DUploadRing::open_page(DXGI_FORMAT format, int width, int height, int &page_x, int &page_y)
+	{
+		int num_format_pages = 0;
+		Page *free_page = nullptr;
+		for (auto &page : pages)
+		{
+			if (page->format != format)
+				continue;
+
+			num_format_pages++;
+			if (page->mapped)
+			{
+				if (allocate(page.get(), width, height, page_x, page_y))
+					return page.get();
+			}
+			else if (!free_page && page->frame <= completed_frame)
+			{
+				free_page = page.get();
+			}
+		}
+
+		if (!free_page)
+		{
+			if (num_format_pages >= max_pages_per_format)
+				return nullptr;
+
+			D3D11_TEXTURE2D_DESC texture_desc;
+			texture_desc.Width = page_size;
+			texture_desc.Height = page_size;
+			texture_desc.MipLevels = 1;
+			texture_desc.ArraySize = 1;
+			texture_desc.Format = format;
+			texture_desc.SampleDesc.Count = 1;
+			texture_desc.SampleDesc.Quality = 0;
+			texture_desc.Usage = D3D11_USAGE_STAGING;
+			texture_desc.BindFlags = 0;
+			texture_desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+			texture_desc.MiscFlags = 0;
+
+			std::unique_ptr<Page> page(new Page());
+			page->format = format;
+			HRESULT result = device->CreateTexture2D(&texture_desc, 0, page->texture.output_variable());
+			if (FAILED(result))
+				return nullptr;
+
+			free_page = page.get();
+			pages.push_back(std::move(page));
+		}
+
+		// The GPU is done with the page, so mapping it does not stall
+		HRESULT result = device_context->Map(free_page->texture, 0, D3D11_MAP_WRITE, 0, &free_page->mapping);
+		if (FAILED(result))
+			return nullptr;
+
+		free_page->mapped = true;
+		free_page->shelf_x = 0;
+		free_page->shelf_y = 0;
+		free_page->shelf_height = 0;
+
+		allocate(free_page, width, height, page_x, page_y);
+		return free_page;
+	}
+
+	bool D3DUploadRing::allocate(Page *page, int width, int height, int &page_x, int &page_y)
+	{
+		if (page->shelf_x + width > page_size)
+		{
+			page->shelf_x = 0;
+			page->shelf_y += page->shelf_height;
+			page->shelf_height = 0;
+		}
+
+		if (page->shelf_y + height > page_size)
+			return false;
+
+		page_x = page->shelf_x;
+		page_y = page->shelf_y;
+		page->shelf_x += width;
+		page->shelf_height = std::max(page->shelf_height, height);
+		return true;
+	}
+}
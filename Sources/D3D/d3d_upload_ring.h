@@ -0,0 +1,105 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace clan
+{
+	/// \brief Batches texture uploads through a ring of mapped staging textures
+	///
+	/// Pixels are written into mapped staging pages on the calling thread, which may be a worker thread.
+	/// The copies into the destination textures are issued with CopySubresourceRegion by flush() on the
+	/// rendering thread. A page is reused once the GPU has retired the frame that last read from it.
+	class D3DUploadRing
+	{
+	public:
+		D3DUploadRing(const ComPtr<ID3D11Device> &device, const ComPtr<ID3D11DeviceContext> &device_context);
+		~D3DUploadRing();
+
+		/// \brief Returns the upload ring created for a device, or null if there is none
+		static D3DUploadRing *find(ID3D11Device *device);
+
+		/// \brief Copies pixels into a staging page and queues a copy into a 2D texture
+		///
+		/// Returns false if the region does not fit into a page or all pages are in flight. The caller must then flush and upload directly.
+		bool upload(const ComPtr<ID3D11Resource> &texture, UINT subresource, int x, int y, DXGI_FORMAT format, int bytes_per_pixel, const unsigned char *data, int pitch, int width, int height);
+
+		/// \brief Issues all queued copies on the immediate context
+		void flush();
+
+		/// \brief Advances the frame counters used to recycle pages
+		void end_frame(uint64_t presented_frame, uint64_t completed_frame);
+
+		static const int page_size = 1024;
+		static const int max_pages_per_format = 8;
+
+	private:
+		struct Page
+		{
+			ComPtr<ID3D11Texture2D> texture;
+			DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+			bool mapped = false;
+			D3D11_MAPPED_SUBRESOURCE mapping;
+			uint64_t frame = 0;
+			int shelf_x = 0;
+			int shelf_y = 0;
+			int shelf_height = 0;
+		};
+
+		struct PendingCopy
+		{
+			ComPtr<ID3D11Resource> texture;
+			UINT subresource;
+			int x, y;
+			Page *page;
+			D3D11_BOX box;
+		};
+
+		Page *open_page(DXGI_FORMAT format, int width, int height, int &page_x, int &page_y);
+		static bool allocate(Page *page, int width, int height, int &page_x, int &page_y);
+
+		ComPtr<ID3D11Device> device;
+		ComPtr<ID3D11DeviceContext> device_context;
+
+		std::mutex mutex;
+		std::vector<std::unique_ptr<Page>> pages;
+		std::vector<PendingCopy> pending;
+		std::atomic<bool> has_pending{false};
+		uint64_t current_frame = 1;
+		uint64_t completed_frame = 0;
+
+		static std::mutex rings_mutex;
+		static std::vector<D3DUploadRing *> rings;
+	};
+}
@@ -58,6 +58,7 @@ namespace clan
 		desc.StructureByteStride = 0;
 		HRESULT result = handles.front()->device->CreateBuffer(&desc, 0, handles.front()->buffer.output_variable());
 		D3DTarget::throw_if_failed("Unable to create vertex array buffer", result);
+		memory.set_size(size);
 	}
 
 	void D3DVertexArrayBufferProvider::create(void *init_data, int new_size, BufferUsage usage)
@@ -78,6 +79,7 @@ namespace clan
 		desc.StructureByteStride = 0;
 		HRESULT result = handles.front()->device->CreateBuffer(&desc, &resource_data, handles.front()->buffer.output_variable());
 		D3DTarget::throw_if_failed("Unable to create vertex array buffer", result);
+		memory.set_size(size);
 	}
 
 	ComPtr<ID3D11Buffer> &D3DVertexArrayBufferProvider::get_buffer(const ComPtr<ID3D11Device> &device)
@@ -108,6 +110,35 @@ namespace clan
 		device_context->UpdateSubresource(get_handles(device).buffer, 0, &box, data, 0, 0);
 	}
 
+	void D3DVertexArrayBufferProvider::upload_data_unsynchronized(GraphicContext &gc, int offset, const void *data, int data_size, bool discard)
+	{
+		if ((offset < 0) || (data_size < 0) || ((data_size + offset) > size))
+			throw Exception("Vertex array buffer, invalid size");
+
+		const ComPtr<ID3D11Device> &device = static_cast<D3DGraphicContextProvider*>(gc.get_provider())->get_window()->get_device();
+		ComPtr<ID3D11DeviceContext> device_context;
+		device->GetImmediateContext(device_context.output_variable());
+
+		// Copy flags need the Direct3D 11.1 runtime
+		ComPtr<ID3D11DeviceContext1> device_context1;
+		HRESULT result = device_context->QueryInterface(__uuidof(ID3D11DeviceContext1), (void**)device_context1.output_variable());
+		if (FAILED(result))
+		{
+			upload_data(gc, offset, data, data_size);
+			return;
+		}
+
+		D3D11_BOX box;
+		box.left = offset;
+		box.right = offset + data_size;
+		box.top = 0;
+		box.bottom = 1;
+		box.front = 0;
+		box.back = 1;
+
+		device_context1->UpdateSubresource1(get_handles(device).buffer, 0, &box, data, 0, 0, discard ? D3D11_COPY_DISCARD : D3D11_COPY_NO_OVERWRITE);
+	}
+
 	void D3DVertexArrayBufferProvider::copy_from(GraphicContext &gc, TransferBuffer &buffer, int dest_pos, int src_pos, int copy_size)
 	{
 		const ComPtr<ID3D11Device> &device = static_cast<D3DGraphicContextProvider*>(gc.get_provider())->get_window()->get_device();
@@ -29,6 +29,7 @@
 #pragma once
 
 #include "API/Display/TargetProviders/vertex_array_buffer_provider.h"
+#include "API/Display/Render/gpu_memory.h"
 #include "API/Core/System/databuffer.h"
 #include "d3d_share_list.h"
 
@@ -45,6 +46,7 @@ namespace clan
 		ComPtr<ID3D11Buffer> &get_buffer(const ComPtr<ID3D11Device> &device);
 
 		void upload_data(GraphicContext &gc, int offset, const void *data, int size);
+		void upload_data_unsynchronized(GraphicContext &gc, int offset, const void *data, int size, bool discard);
 		void copy_from(GraphicContext &gc, TransferBuffer &buffer, int dest_pos, int src_pos, int size);
 		void copy_to(GraphicContext &gc, TransferBuffer &buffer, int dest_pos, int src_pos, int size);
 
@@ -63,5 +65,6 @@ namespace clan
 
 		std::vector<std::shared_ptr<DeviceHandles> > handles;
 		int size;
+		GPUMemoryAllocation memory{gpu_memory_vertex_buffer};
 	};
 }
@@ -44,3 +44,4 @@
 
 #include <cstring>
 #include <d3d11.h>
+#include <d3d11_1.h>
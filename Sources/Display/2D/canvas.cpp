@@ -33,6 +33,8 @@
 #include "API/Display/Render/graphic_context.h"
 #include "API/Display/2D/canvas.h"
 #include "API/Display/2D/gradient.h"
+#include "API/Display/2D/brush.h"
+#include "API/Display/2D/path.h"
 #include "API/Display/Image/pixel_buffer.h"
 #include "API/Display/Render/primitives_array.h"
 #include "API/Display/Window/display_window.h"
@@ -40,8 +42,11 @@
 #include "API/Core/Math/quad.h"
 #include "API/Core/Math/triangle_math.h"
 #include "render_batch_triangle.h"
+#include "render_batch_box.h"
+#include "render_batch_path.h"
 #include "canvas_impl.h"
 #include "API/Display/Font/font.h"
+#include <algorithm>
 
 namespace clan
 {
@@ -130,6 +135,7 @@ namespace clan
 	{
 		flush();
 		get_gc().set_blend_state(state, blend_color, sample_mask);
+		impl->custom_blend_state = true;
 	}
 
 	void Canvas::set_depth_stencil_state(const DepthStencilState &state, int stencil_ref)
@@ -148,6 +154,7 @@ namespace clan
 	{
 		flush();
 		get_gc().reset_blend_state();
+		impl->custom_blend_state = false;
 	}
 
 	void Canvas::reset_depth_stencil_state()
@@ -222,6 +229,76 @@ namespace clan
 		impl->set_viewport(viewport);
 	}
 
+	static Rectf get_vertex_bounds(const Vec2f *positions, int num_vertices)
+	{
+		if (num_vertices <= 0)
+			return Rectf();
+		Rectf bounds(positions[0].x, positions[0].y, positions[0].x, positions[0].y);
+		for (int i = 1; i < num_vertices; i++)
+		{
+			bounds.left = std::min(bounds.left, positions[i].x);
+			bounds.top = std::min(bounds.top, positions[i].y);
+			bounds.right = std::max(bounds.right, positions[i].x);
+			bounds.bottom = std::max(bounds.bottom, positions[i].y);
+		}
+		return bounds;
+	}
+
+	static Rectf get_normalized_bounds(float x1, float y1, float x2, float y2)
+	{
+		return Rectf(std::min(x1, x2), std::min(y1, y2), std::max(x1, x2), std::max(y1, y2));
+	}
+
+	void Canvas::begin_deferred()
+	{
+		impl->begin_deferred();
+	}
+
+	void Canvas::end_deferred()
+	{
+		impl->end_deferred();
+	}
+
+	bool Canvas::is_deferred() const
+	{
+		return impl->is_deferred();
+	}
+
+	void Canvas::invalidate(const Rectf &rect)
+	{
+		impl->invalidate(CanvasCommandRecorder::transform_bounds(rect, get_transform()));
+	}
+
+	void Canvas::invalidate()
+	{
+		impl->invalidate(Rectf(Pointf(), get_size()));
+	}
+
+	const std::vector<Rectf> &Canvas::get_damage() const
+	{
+		return impl->damage;
+	}
+
+	void Canvas::clear_damage()
+	{
+		impl->damage.clear();
+	}
+
+	const CanvasBatchStats &Canvas::get_batch_stats() const
+	{
+		return impl->batcher.get_stats();
+	}
+
+	void Canvas::reset_batch_stats()
+	{
+		impl->batcher.reset_stats();
+	}
+
+	void Canvas::set_batch_overlay(bool enable)
+	{
+		impl->recorder.set_overlay(enable);
+	}
+
 	void Canvas::set_projection(const Mat4f &matrix)
 	{
 		impl->set_user_projection(matrix);
@@ -249,6 +326,12 @@ namespace clan
 
 	void Canvas::draw_point(float x1, float y1, const Colorf &color)
 	{
+		if (impl->is_deferred())
+		{
+			impl->record(impl->batcher.get_point_batcher(), Rectf(x1, y1, x1, y1), [=](Canvas &canvas) { canvas.draw_point(x1, y1, color); });
+			return;
+		}
+
 		Vec2f positions[1] =
 		{
 			Vec2f(x1, y1)
@@ -265,6 +348,12 @@ namespace clan
 
 	void Canvas::draw_line(float x1, float y1, float x2, float y2, const Colorf &color)
 	{
+		if (impl->is_deferred())
+		{
+			impl->record(impl->batcher.get_line_batcher(), get_normalized_bounds(x1, y1, x2, y2), [=](Canvas &canvas) { canvas.draw_line(x1, y1, x2, y2, color); });
+			return;
+		}
+
 		Vec2f positions[2] =
 		{
 			Vec2f(x1, y1),
@@ -287,24 +376,52 @@ namespace clan
 
 	void Canvas::draw_lines(const Vec2f *positions, int num_vertices, const Colorf &color)
 	{
+		if (impl->is_deferred())
+		{
+			std::vector<Vec2f> copy(positions, positions + num_vertices);
+			impl->record(impl->batcher.get_line_batcher(), get_vertex_bounds(positions, num_vertices), [=](Canvas &canvas) { canvas.draw_lines(copy.data(), num_vertices, color); });
+			return;
+		}
+
 		RenderBatchLine *batcher = impl->batcher.get_line_batcher();
 		batcher->draw_lines(*this, positions, color, num_vertices);
 	}
 
 	void Canvas::draw_lines(const Vec2f *line_positions, const Vec2f *texture_positions, int num_vertices, const Texture2D &texture, const Colorf &line_color)
 	{
+		if (impl->is_deferred())
+		{
+			std::vector<Vec2f> line_copy(line_positions, line_positions + num_vertices);
+			std::vector<Vec2f> texture_copy(texture_positions, texture_positions + num_vertices);
+			impl->record(impl->batcher.get_line_texture_batcher(), get_vertex_bounds(line_positions, num_vertices), [=](Canvas &canvas) { canvas.draw_lines(line_copy.data(), texture_copy.data(), num_vertices, texture, line_color); });
+			return;
+		}
+
 		RenderBatchLineTexture *batcher = impl->batcher.get_line_texture_batcher();
 		batcher->draw_lines(*this, line_positions, texture_positions, num_vertices, texture, line_color);
 	}
 
 	void Canvas::draw_line_strip(const Vec2f *line_positions, int num_vertices, const Colorf &line_color)
 	{
+		if (impl->is_deferred())
+		{
+			std::vector<Vec2f> copy(line_positions, line_positions + num_vertices);
+			impl->record(impl->batcher.get_line_batcher(), get_vertex_bounds(line_positions, num_vertices), [=](Canvas &canvas) { canvas.draw_line_strip(copy.data(), num_vertices, line_color); });
+			return;
+		}
+
 		RenderBatchLine *batcher = impl->batcher.get_line_batcher();
 		batcher->draw_line_strip(*this, line_positions, line_color, num_vertices);
 	}
 
 	void Canvas::draw_box(float x1, float y1, float x2, float y2, const Colorf &color)
 	{
+		if (impl->is_deferred())
+		{
+			impl->record(impl->batcher.get_line_batcher(), get_normalized_bounds(x1, y1, x2, y2), [=](Canvas &canvas) { canvas.draw_box(x1, y1, x2, y2, color); });
+			return;
+		}
+
 		Vec2f positions[5] =
 		{
 			Vec2f(x1, y1),
@@ -331,6 +448,12 @@ namespace clan
 
 	void Canvas::fill_rect(float x1, float y1, float x2, float y2, const Colorf &color)
 	{
+		if (impl->is_deferred())
+		{
+			impl->record(impl->batcher.get_triangle_batcher(), get_normalized_bounds(x1, y1, x2, y2), [=](Canvas &canvas) { canvas.fill_rect(x1, y1, x2, y2, color); });
+			return;
+		}
+
 		RenderBatchTriangle *batcher = impl->batcher.get_triangle_batcher();
 		batcher->fill(*this, x1, y1, x2, y2, color);
 	}
@@ -347,6 +470,12 @@ namespace clan
 
 	void Canvas::fill_rect(float x1, float y1, float x2, float y2, const Gradient &gradient)
 	{
+		if (impl->is_deferred())
+		{
+			impl->record(impl->batcher.get_triangle_batcher(), get_normalized_bounds(x1, y1, x2, y2), [=](Canvas &canvas) { canvas.fill_rect(x1, y1, x2, y2, gradient); });
+			return;
+		}
+
 		Vec2f positions[6] =
 		{
 			Vec2f(x1, y1),
@@ -382,6 +511,89 @@ namespace clan
 		fill_rect(rect.left, rect.top, rect.right, rect.bottom, gradient);
 	}
 
+	void Canvas::fill_rect(const Rectf &rect, const Brush &brush)
+	{
+		if (impl->is_deferred())
+		{
+			RenderBatcher *batcher = brush.type == BrushType::solid || brush.type == BrushType::linear ? static_cast<RenderBatcher*>(impl->batcher.get_triangle_batcher()) : impl->batcher.get_path_batcher();
+			impl->record(batcher, get_normalized_bounds(rect.left, rect.top, rect.right, rect.bottom), [=](Canvas &canvas) { canvas.fill_rect(rect, brush); });
+			return;
+		}
+
+		Vec2f positions[6] =
+		{
+			Vec2f(rect.left, rect.top),
+			Vec2f(rect.right, rect.top),
+			Vec2f(rect.left, rect.bottom),
+			Vec2f(rect.right, rect.top),
+			Vec2f(rect.left, rect.bottom),
+			Vec2f(rect.right, rect.bottom)
+		};
+
+		if (!impl->batcher.get_triangle_batcher()->fill_triangles(*this, positions, 6, brush))
+			Path::rect(rect).fill(*this, brush);
+	}
+
+	void Canvas::fill_rounded_rect(const Rectf &rect, const Sizef &corner, const Brush &brush)
+	{
+		float radius_x = std::min(corner.width, rect.get_width() * 0.5f);
+		float radius_y = std::min(corner.height, rect.get_height() * 0.5f);
+		if (radius_x <= 0.0f || radius_y <= 0.0f)
+		{
+			fill_rect(rect, brush);
+			return;
+		}
+
+		if (impl->is_deferred())
+		{
+			RenderBatcher *batcher = brush.type == BrushType::solid || brush.type == BrushType::linear ? static_cast<RenderBatcher*>(impl->batcher.get_triangle_batcher()) : impl->batcher.get_path_batcher();
+			impl->record(batcher, get_normalized_bounds(rect.left, rect.top, rect.right, rect.bottom), [=](Canvas &canvas) { canvas.fill_rounded_rect(rect, corner, brush); });
+			return;
+		}
+
+		// Enough segments per corner to stay within a quarter pixel of the curve
+		const Mat4f &transform = get_transform();
+		float scale = std::sqrt(std::abs(transform.matrix[0] * transform.matrix[5] - transform.matrix[1] * transform.matrix[4])) * get_pixel_ratio();
+		float radius = std::max(radius_x, radius_y) * scale;
+		int segments = 1;
+		if (radius > 0.25f)
+			segments = clamp((int)std::ceil(PI * 0.5f / std::acos(1.0f - 0.25f / radius)), 1, 32);
+
+		Pointf centers[4] =
+		{
+			Pointf(rect.left + radius_x, rect.top + radius_y),
+			Pointf(rect.right - radius_x, rect.top + radius_y),
+			Pointf(rect.right - radius_x, rect.bottom - radius_y),
+			Pointf(rect.left + radius_x, rect.bottom - radius_y)
+		};
+
+		std::vector<Vec2f> outline;
+		outline.reserve(4 * (segments + 1));
+		for (int i = 0; i < 4; i++)
+		{
+			float start_angle = PI * (i + 2) * 0.5f;
+			for (int j = 0; j <= segments; j++)
+			{
+				float angle = start_angle + PI * 0.5f * j / segments;
+				outline.push_back(Vec2f(centers[i].x + std::cos(angle) * radius_x, centers[i].y + std::sin(angle) * radius_y));
+			}
+		}
+
+		// The outline is convex, so it can be drawn as a fan around the center
+		Vec2f center = rect.get_center();
+		std::vector<Vec2f> positions;
+		positions.reserve(outline.size() * 3);
+		for (size_t i = 0; i < outline.size(); i++)
+		{
+			positions.push_back(center);
+			positions.push_back(outline[i]);
+			positions.push_back(outline[(i + 1) % outline.size()]);
+		}
+
+		if (!impl->batcher.get_triangle_batcher()->fill_triangles(*this, positions.data(), positions.size(), brush))
+			Path::rect(rect, Sizef(radius_x, radius_y)).fill(*this, brush);
+	}
+
 	void Canvas::fill_circle(float center_x, float center_y, float radius, const Colorf &color)
 	{
 		fill_circle(Pointf(center_x, center_y), Pointf(center_x, center_y), radius, Gradient(color, color));
@@ -668,6 +880,37 @@ namespace clan
 		set_transform(original_transform);
 	}
 
+	bool Canvas::fill_rounded_box(const Rectf &box, const Vec4f &radii, const Vec4f &border_widths, const Colorf &fill_color, const Colorf &border_color)
+	{
+		if (!RenderBatchBox::supported || impl->batcher.get_triangle_batcher()->is_capturing())
+			return false;
+
+		if (impl->is_deferred())
+		{
+			impl->record(impl->batcher.get_box_batcher(), get_normalized_bounds(box.left, box.top, box.right, box.bottom), [=](Canvas &canvas) { canvas.fill_rounded_box(box, radii, border_widths, fill_color, border_color); });
+			return true;
+		}
+
+		impl->batcher.get_box_batcher()->fill_box(*this, box, radii, border_widths, fill_color, border_color);
+		return true;
+	}
+
+	bool Canvas::fill_box_shadow(const Rectf &box, const Vec4f &radii, float blur_radius, const Colorf &color)
+	{
+		if (!RenderBatchBox::supported || impl->batcher.get_triangle_batcher()->is_capturing())
+			return false;
+
+		if (impl->is_deferred())
+		{
+			Rectf bounds = get_normalized_bounds(box.left - blur_radius, box.top - blur_radius, box.right + blur_radius, box.bottom + blur_radius);
+			impl->record(impl->batcher.get_box_batcher(), bounds, [=](Canvas &canvas) { canvas.fill_box_shadow(box, radii, blur_radius, color); });
+			return true;
+		}
+
+		impl->batcher.get_box_batcher()->fill_shadow(*this, box, radii, blur_radius, color);
+		return true;
+	}
+
 	Pointf Canvas::grid_fit(const Pointf &pos)
 	{
 		float pixel_ratio = get_gc().get_pixel_ratio();
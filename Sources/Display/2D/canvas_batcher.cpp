@@ -41,7 +41,7 @@ namespace clan
 		CanvasBatcher_Impl(GraphicContext &gc);
 		~CanvasBatcher_Impl();
 
-		void flush();
+		void flush(BatchFlushCause cause = batch_flush_state_change);
 		bool set_batcher(GraphicContext &gc, RenderBatcher *batcher);
 		void update_batcher_matrix(GraphicContext &gc, const Mat4f &modelview, const Mat4f &projection, TextureImageYAxis image_yaxis);
 
@@ -51,19 +51,23 @@ namespace clan
 		RenderBatchBuffer render_batcher_buffer;
 
 		RenderBatchTriangle render_batcher_triangle;
+		RenderBatchSpriteInstanced render_batcher_sprite_instanced;
 		RenderBatchLine render_batcher_line;
 		RenderBatchLineTexture render_batcher_line_texture;
 		RenderBatchPoint render_batcher_point;
 		RenderBatchPath render_batcher_path;
+		RenderBatchBox render_batcher_box;
 	};
 
 	CanvasBatcher_Impl::CanvasBatcher_Impl(GraphicContext &gc) : active_batcher(nullptr),
 		render_batcher_buffer(gc),
 		render_batcher_triangle(gc, &render_batcher_buffer),
+		render_batcher_sprite_instanced(gc, &render_batcher_buffer),
 		render_batcher_line(gc, &render_batcher_buffer),
 		render_batcher_line_texture(gc, &render_batcher_buffer),
 		render_batcher_point(gc, &render_batcher_buffer),
-		render_batcher_path(gc, &render_batcher_buffer)
+		render_batcher_path(gc, &render_batcher_buffer),
+		render_batcher_box(gc, &render_batcher_buffer)
 	{
 
 	}
@@ -89,11 +93,21 @@ namespace clan
 		return &impl->render_batcher_triangle;
 	}
 
+	RenderBatchSpriteInstanced *CanvasBatcher::get_sprite_instanced_batcher()
+	{
+		return &impl->render_batcher_sprite_instanced;
+	}
+
 	RenderBatchPath *CanvasBatcher::get_path_batcher()
 	{
 		return &impl->render_batcher_path;
 	}
 
+	RenderBatchBox *CanvasBatcher::get_box_batcher()
+	{
+		return &impl->render_batcher_box;
+	}
+
 	RenderBatchLine *CanvasBatcher::get_line_batcher()
 	{
 		return &impl->render_batcher_line;
@@ -109,14 +123,29 @@ namespace clan
 		return &impl->render_batcher_point;
 	}
 
-	void CanvasBatcher_Impl::flush()
+	const CanvasBatchStats &CanvasBatcher::get_stats() const
+	{
+		return impl->render_batcher_buffer.stats;
+	}
+
+	void CanvasBatcher::reset_stats()
+	{
+		impl->render_batcher_buffer.stats = CanvasBatchStats();
+	}
+
+	void CanvasBatcher_Impl::flush(BatchFlushCause cause)
 	{
 		if (active_batcher)
 		{
+			render_batcher_buffer.count_flush(cause);
 			RenderBatcher *batcher = active_batcher;
 			active_batcher = nullptr;
 			batcher->flush(current_gc);
 		}
+		else
+		{
+			render_batcher_buffer.clear_flush_cause();
+		}
 	}
 
 	void CanvasBatcher_Impl::update_batcher_matrix(GraphicContext &gc, const Mat4f &modelview, const Mat4f &projection, TextureImageYAxis image_yaxis)
@@ -137,7 +166,7 @@ namespace clan
 	{
 		if ((active_batcher != batcher) || (gc != current_gc))
 		{
-			flush();
+			flush(active_batcher != batcher ? batch_flush_batcher_switch : batch_flush_state_change);
 			current_gc = gc;
 			active_batcher = batcher;
 			return true;
@@ -32,10 +32,12 @@
 #include "API/Display/Render/graphic_context.h"
 #include "Display/2D/render_batch_buffer.h"
 #include "Display/2D/render_batch_triangle.h"
+#include "Display/2D/render_batch_sprite_instanced.h"
 #include "Display/2D/render_batch_line.h"
 #include "Display/2D/render_batch_line_texture.h"
 #include "Display/2D/render_batch_point.h"
 #include "Display/2D/render_batch_path.h"
+#include "Display/2D/render_batch_box.h"
 #include "API/Display/2D/canvas.h"
 #include "API/Display/Window/display_window.h"
 
@@ -58,10 +60,15 @@ namespace clan
 		void update_batcher_matrix(GraphicContext &gc, const Mat4f &modelview, const Mat4f &projection, TextureImageYAxis image_yaxis);
 
 		RenderBatchTriangle *get_triangle_batcher();
+		RenderBatchSpriteInstanced *get_sprite_instanced_batcher();
 		RenderBatchLine *get_line_batcher();
 		RenderBatchLineTexture *get_line_texture_batcher();
 		RenderBatchPoint *get_point_batcher();
 		RenderBatchPath *get_path_batcher();
+		RenderBatchBox *get_box_batcher();
+
+		const CanvasBatchStats &get_stats() const;
+		void reset_stats();
 
 	private:
 		std::shared_ptr<CanvasBatcher_Impl> impl;
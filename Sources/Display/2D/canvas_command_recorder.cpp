@@ -0,0 +1,167 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+**    Mark Page
+*/
+
+#include "Display/precomp.h"
+#include "canvas_command_recorder.h"
+#include "API/Display/2D/canvas.h"
+#include <algorithm>
+
+namespace clan
+{
+	void CanvasCommandRecorder::record(RenderBatcher *batcher, const Rectf &bounds, const Mat4f &transform, const DrawFunc &draw)
+	{
+		Command command;
+		command.batcher = batcher;
+		command.bounds = transform_bounds(bounds, transform);
+		command.transform = transform;
+		command.draw = draw;
+		commands.push_back(std::move(command));
+	}
+
+	void CanvasCommandRecorder::replay(Canvas &canvas)
+	{
+		if (commands.empty() || replaying)
+			return;
+
+		batches.clear();
+		for (int index = 0; index < (int)commands.size(); index++)
+		{
+			const Command &command = commands[index];
+
+			// Search backwards for a batch to join, stopping at the first batch the command would be drawn below
+			int target = -1;
+			int first_batch = std::max((int)batches.size() - max_batch_search, 0);
+			for (int i = (int)batches.size() - 1; i >= first_batch; i--)
+			{
+				if (batches[i].batcher == command.batcher)
+				{
+					target = i;
+					break;
+				}
+				if (batches[i].bounds.is_overlapped(command.bounds))
+					break;
+			}
+
+			if (target == -1)
+			{
+				Batch batch;
+				batch.batcher = command.batcher;
+				batch.bounds = command.bounds;
+				batches.push_back(std::move(batch));
+				target = (int)batches.size() - 1;
+			}
+			else
+			{
+				batches[target].bounds.bounding_rect(command.bounds);
+			}
+			batches[target].commands.push_back(index);
+		}
+
+		Mat4f saved_transform = canvas.get_transform();
+		replaying = true;
+		try
+		{
+			for (const auto &batch : batches)
+			{
+				for (int index : batch.commands)
+				{
+					const Command &command = commands[index];
+					if (!(command.transform == canvas.get_transform()))
+						canvas.set_transform(command.transform);
+					command.draw(canvas);
+				}
+			}
+
+			if (overlay)
+				draw_overlay(canvas);
+		}
+		catch (...)
+		{
+			replaying = false;
+			commands.clear();
+			throw;
+		}
+		replaying = false;
+		commands.clear();
+
+		if (!(saved_transform == canvas.get_transform()))
+			canvas.set_transform(saved_transform);
+	}
+
+	void CanvasCommandRecorder::draw_overlay(Canvas &canvas)
+	{
+		// The bounds already have the command transforms applied
+		canvas.set_transform(Mat4f::identity());
+
+		// Translucent fills add up, so the most overdrawn areas are the most red
+		for (const auto &batch : batches)
+		{
+			for (int index : batch.commands)
+				canvas.fill_rect(commands[index].bounds, Colorf(1.0f, 0.0f, 0.0f, 0.15f));
+		}
+
+		const Colorf batch_colors[] = { Colorf::yellow, Colorf::cyan, Colorf::magenta, Colorf::lime };
+		for (size_t i = 0; i < batches.size(); i++)
+			canvas.draw_box(batches[i].bounds, batch_colors[i % 4]);
+	}
+
+	Rectf CanvasCommandRecorder::transform_bounds(const Rectf &bounds, const Mat4f &transform)
+	{
+		Vec2f corners[4] =
+		{
+			Vec2f(bounds.left, bounds.top),
+			Vec2f(bounds.right, bounds.top),
+			Vec2f(bounds.left, bounds.bottom),
+			Vec2f(bounds.right, bounds.bottom)
+		};
+
+		Rectf result;
+		for (int i = 0; i < 4; i++)
+		{
+			const float *m = transform.matrix;
+			float x = m[0 * 4 + 0] * corners[i].x + m[1 * 4 + 0] * corners[i].y + m[3 * 4 + 0];
+			float y = m[0 * 4 + 1] * corners[i].x + m[1 * 4 + 1] * corners[i].y + m[3 * 4 + 1];
+			if (i == 0)
+			{
+				result = Rectf(x, y, x, y);
+			}
+			else
+			{
+				result.left = std::min(result.left, x);
+				result.top = std::min(result.top, y);
+				result.right = std::max(result.right, x);
+				result.bottom = std::max(result.bottom, y);
+			}
+		}
+
+		// Lines and points cover a pixel beyond their end points, so they overlap whatever touches them
+		result.expand(1.0f, 1.0f);
+		return result;
+	}
+}
@@ -0,0 +1,101 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+**    Mark Page
+*/
+
+#pragma once
+
+#include "API/Core/Math/mat4.h"
+#include "API/Core/Math/rect.h"
+#include <functional>
+#include <vector>
+
+namespace clan
+{
+	class Canvas;
+	class RenderBatcher;
+
+	/// \brief Records canvas draw commands and replays them with as few batcher switches as possible
+	///
+	/// A command is moved back to join an earlier command of the same batcher, as long as it does not
+	/// overlap any command drawn in between. Overlapping commands therefore keep their painter order.
+	class CanvasCommandRecorder
+	{
+	public:
+		typedef std::function<void(Canvas &)> DrawFunc;
+
+		bool is_recording() const { return recording && !replaying; }
+		bool is_replaying() const { return replaying; }
+		bool is_empty() const { return commands.empty(); }
+
+		void begin() { recording = true; }
+		void end() { recording = false; }
+
+		/// \brief Adds a command
+		///
+		/// \param bounds = Area touched by the command, in canvas coordinates before the transform is applied
+		void record(RenderBatcher *batcher, const Rectf &bounds, const Mat4f &transform, const DrawFunc &draw);
+
+		/// \brief Draws the recorded commands in batch order and removes them
+		void replay(Canvas &canvas);
+
+		void clear() { commands.clear(); }
+
+		/// \brief Draws command bounds and batch outlines after each replay
+		void set_overlay(bool enable) { overlay = enable; }
+
+		/// \brief Returns the axis aligned box around bounds after the transform is applied
+		static Rectf transform_bounds(const Rectf &bounds, const Mat4f &transform);
+
+	private:
+		void draw_overlay(Canvas &canvas);
+
+		struct Command
+		{
+			RenderBatcher *batcher;
+			Rectf bounds;
+			Mat4f transform;
+			DrawFunc draw;
+		};
+
+		struct Batch
+		{
+			RenderBatcher *batcher;
+			Rectf bounds;
+			std::vector<int> commands;
+		};
+
+		/// \brief How many batches back a command may move. Limits the cost of recording long command lists.
+		enum { max_batch_search = 32 };
+
+		std::vector<Command> commands;
+		std::vector<Batch> batches;
+		bool recording = false;
+		bool replaying = false;
+		bool overlay = false;
+	};
+}
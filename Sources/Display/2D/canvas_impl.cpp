@@ -33,6 +33,7 @@
 #include "API/Display/Render/shared_gc_data.h"
 #include "API/Display/TargetProviders/graphic_context_provider.h"
 #include "API/Display/2D/gradient.h"
+#include "API/Core/System/profiler.h"
 
 namespace clan
 {
@@ -103,15 +104,40 @@ namespace clan
 
 	Canvas_Impl::~Canvas_Impl()
 	{
+		// Deferred commands need a canvas to replay with, which no longer exists
+		recorder.clear();
 		if (!gc.is_null())
 			flush();
 	}
 
 	void Canvas_Impl::flush()
 	{
+		cl_profile_zone("Canvas flush");
+		replay_deferred();
 		batcher.flush();
 	}
 
+	void Canvas_Impl::begin_deferred()
+	{
+		recorder.begin();
+	}
+
+	void Canvas_Impl::end_deferred()
+	{
+		replay_deferred();
+		recorder.end();
+	}
+
+	void Canvas_Impl::replay_deferred()
+	{
+		if (recorder.is_empty() || recorder.is_replaying())
+			return;
+
+		Canvas canvas;
+		canvas.impl = shared_from_this();
+		recorder.replay(canvas);
+	}
+
 	void Canvas_Impl::update_batcher_matrix()
 	{
 		batcher.update_batcher_matrix(gc, canvas_transform, canvas_projection, canvas_y_axis);
@@ -119,6 +145,14 @@ namespace clan
 
 	void Canvas_Impl::set_batcher(Canvas &canvas, RenderBatcher *new_batcher)
 	{
+		// Drawing that is not recorded must come after everything recorded before it
+		if (!recorder.is_replaying() && !recorder.is_empty())
+			recorder.replay(canvas);
+
+		RenderBatchTriangle *triangle_batcher = batcher.get_triangle_batcher();
+		if (triangle_batcher->is_capturing() && new_batcher != triangle_batcher)
+			throw Exception("Only images, sprites, text and fills can be captured into a CanvasStaticBatch");
+
 		if (batcher.set_batcher(canvas, new_batcher))
 			update_batcher_matrix();
 	}
@@ -145,6 +179,8 @@ namespace clan
 
 		if (matrix != canvas_projection)
 		{
+			// Recorded commands are drawn with the projection they were recorded with
+			replay_deferred();
 			canvas_projection = matrix;
 			update_batcher_matrix();
 		}
@@ -398,8 +434,59 @@ namespace clan
 		return bounding_box;
 	}
 
+	void Canvas_Impl::invalidate(Rectf rect)
+	{
+		rect.clip(Rectf(Pointf(), gc.get_dip_size()));
+		if (rect.get_width() <= 0.0f || rect.get_height() <= 0.0f)
+			return;
+
+		// Absorb every area the new one touches, as the result may touch more
+		for (size_t i = 0; i < damage.size();)
+		{
+			if (damage[i].is_overlapped(rect))
+			{
+				rect.bounding_rect(damage[i]);
+				damage.erase(damage.begin() + i);
+				i = 0;
+			}
+			else
+			{
+				i++;
+			}
+		}
+		damage.push_back(rect);
+
+		while (damage.size() > max_damage_rects)
+		{
+			// Merge the pair that adds the least area not already damaged
+			size_t best_a = 0, best_b = 1;
+			float best_cost = 0.0f;
+			for (size_t a = 0; a < damage.size(); a++)
+			{
+				for (size_t b = a + 1; b < damage.size(); b++)
+				{
+					Rectf merged = damage[a];
+					merged.bounding_rect(damage[b]);
+					float cost = merged.get_width() * merged.get_height() - damage[a].get_width() * damage[a].get_height() - damage[b].get_width() * damage[b].get_height();
+					if ((a == 0 && b == 1) || cost < best_cost)
+					{
+						best_a = a;
+						best_b = b;
+						best_cost = cost;
+					}
+				}
+			}
+			damage[best_a].bounding_rect(damage[best_b]);
+			damage.erase(damage.begin() + best_b);
+		}
+	}
+
 	void Canvas_Impl::on_window_flip()
 	{
 		flush();
+
+		// Window depth and stencil contents are undefined after the flip, so tile based GPUs need not write them back
+		if (gc.get_write_frame_buffer().is_null())
+			gc.invalidate_attachments(attachment_depth | attachment_stencil);
 	}
 }
@@ -38,13 +38,15 @@
 #include "API/Display/2D/canvas.h"
 #include "API/Display/Window/display_window.h"
 #include "canvas_batcher.h"
+#include "canvas_command_recorder.h"
+#include <memory>
 
 namespace clan
 {
 	class RenderBatcher;
 	class RenderBatchTriangle;
 
-	class Canvas_Impl
+	class Canvas_Impl : public std::enable_shared_from_this<Canvas_Impl>
 	{
 	public:
 		Canvas_Impl();
@@ -59,6 +61,18 @@ namespace clan
 		void flush();
 		void set_batcher(Canvas &canvas, RenderBatcher *batcher);
 
+		void begin_deferred();
+		void end_deferred();
+		bool is_deferred() const { return recorder.is_recording(); }
+
+		/// \brief Records a draw command for later. Only valid while is_deferred() is true.
+		///
+		/// \param bounds = Area touched by the command, in canvas coordinates
+		void record(RenderBatcher *batcher, const Rectf &bounds, const CanvasCommandRecorder::DrawFunc &func) { recorder.record(batcher, bounds, canvas_transform, func); }
+
+		/// \brief Adds an area to the damage, in untransformed canvas coordinates
+		void invalidate(Rectf rect);
+
 		void set_cliprect(const Rectf &rect);
 		void push_cliprect(const Rectf &rect);
 		void push_cliprect();
@@ -84,6 +98,9 @@ namespace clan
 
 		std::vector<Rectf> cliprects;
 		CanvasBatcher batcher;
+		CanvasCommandRecorder recorder;
+		std::vector<Rectf> damage;
+		bool custom_blend_state = false;	// Set while a blend state other than the default is selected
 
 	private:
 		void setup(GraphicContext &new_gc);
@@ -93,6 +110,9 @@ namespace clan
 		void update_batcher_matrix();
 		void write_cliprect(const Rectf &rect);
 		void on_window_flip();
+		void replay_deferred();
+
+		static const size_t max_damage_rects = 8;	// Beyond this, redrawing the frame once per area costs more than the pixels saved
 
 		GraphicContext gc;
 		SlotContainer sc;
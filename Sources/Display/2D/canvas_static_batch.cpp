@@ -0,0 +1,111 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Kenneth Gangstoe
+*/
+
+#include "Display/precomp.h"
+#include "API/Display/2D/canvas_static_batch.h"
+#include "API/Display/2D/canvas.h"
+#include "API/Display/Render/program_object.h"
+#include "canvas_static_batch_impl.h"
+#include "canvas_impl.h"
+
+namespace clan
+{
+	CanvasStaticBatch::CanvasStaticBatch() : impl(std::make_shared<CanvasStaticBatch_Impl>())
+	{
+	}
+
+	CanvasStaticBatch::~CanvasStaticBatch()
+	{
+	}
+
+	bool CanvasStaticBatch::is_empty() const
+	{
+		return impl->segments.empty();
+	}
+
+	void CanvasStaticBatch::begin(Canvas &canvas)
+	{
+		if (!RenderBatchTriangle::static_batches_supported)
+			throw Exception("CanvasStaticBatch is not supported by this display target");
+
+		RenderBatchTriangle *batcher = canvas.impl->batcher.get_triangle_batcher();
+		if (batcher->is_capturing())
+			throw Exception("The canvas is already capturing into a CanvasStaticBatch");
+
+		// Flushing deactivates the batchers, so the triangle batcher picks up the capture matrix when it is used next
+		canvas.flush();
+		batcher->begin_capture(impl.get());
+	}
+
+	void CanvasStaticBatch::end(Canvas &canvas)
+	{
+		canvas.flush();
+		canvas.impl->batcher.get_triangle_batcher()->end_capture();
+	}
+
+	void CanvasStaticBatch::clear()
+	{
+		impl->segments.clear();
+	}
+
+	void CanvasStaticBatch::draw(Canvas &canvas, const Colorf &color) const
+	{
+		if (impl->segments.empty())
+			return;
+
+		canvas.flush();
+
+		GraphicContext &gc = canvas.get_gc();
+		gc.set_program_object(program_sprite_static);
+		ProgramObject program = gc.get_program_object();
+		program.set_uniform_matrix("Transform", canvas.impl->get_projection() * canvas.impl->get_transform());
+		program.set_uniform4f("ColorModulate", color);
+
+		for (const auto &segment : impl->segments)
+		{
+			for (size_t i = 0; i < segment.textures.size(); i++)
+				gc.set_texture(i, segment.textures[i]);
+
+			// Subpixel text gets its color from the blend constant
+			if (segment.glyph_program)
+				gc.set_blend_state(impl->glyph_blend, Colorf(segment.constant_color.r * color.r, segment.constant_color.g * color.g, segment.constant_color.b * color.b, segment.constant_color.a * color.a));
+
+			gc.set_primitives_array(segment.prim_array);
+			gc.draw_primitives_array(type_triangles, 0, segment.num_vertices);
+			gc.reset_primitives_array();
+
+			if (segment.glyph_program)
+				gc.reset_blend_state();
+
+			for (size_t i = 0; i < segment.textures.size(); i++)
+				gc.reset_texture(i);
+		}
+
+		gc.reset_program_object();
+	}
+}
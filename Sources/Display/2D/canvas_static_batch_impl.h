@@ -0,0 +1,57 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Kenneth Gangstoe
+*/
+
+#pragma once
+
+#include "API/Display/2D/color.h"
+#include "API/Display/Render/primitives_array.h"
+#include "API/Display/Render/vertex_array_buffer.h"
+#include "API/Display/Render/texture_2d.h"
+#include "API/Display/Render/blend_state.h"
+#include <vector>
+
+namespace clan
+{
+	class CanvasStaticBatch_Impl
+	{
+	public:
+		/// \brief Triangles captured from a single flush of the triangle batcher
+		struct Segment
+		{
+			VertexArrayBuffer vertices;
+			PrimitivesArray prim_array;
+			int num_vertices = 0;
+			std::vector<Texture2D> textures;
+			bool glyph_program = false;
+			Colorf constant_color;
+		};
+
+		std::vector<Segment> segments;
+		BlendState glyph_blend;
+	};
+}
@@ -0,0 +1,135 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "Display/precomp.h"
+#include "gradient_atlas.h"
+#include "API/Display/Render/graphic_context.h"
+#include <functional>
+
+namespace clan
+{
+	int GradientAtlas::get_row(GraphicContext &gc, const std::vector<BrushGradientStop> &stops)
+	{
+		std::size_t hash = get_hash(stops);
+		auto range = rows.equal_range(hash);
+		for (auto it = range.first; it != range.second; ++it)
+		{
+			if (is_same(row_stops[it->second], stops))
+				return it->second;
+		}
+
+		if (is_full())
+			return -1;
+
+		if (texture.is_null())
+		{
+			texture = Texture2D(gc, width, height, tf_rgba8);
+			texture.set_min_filter(filter_linear);
+			texture.set_mag_filter(filter_linear);
+			texture.set_wrap_mode(wrap_clamp_to_edge, wrap_clamp_to_edge);
+			row_pixels = PixelBuffer(width, 1, tf_rgba8);
+		}
+
+		int row = next_row++;
+		bake(stops);
+		texture.set_subimage(gc, 0, row, row_pixels, Rect(0, 0, width, 1));
+
+		rows.insert(std::make_pair(hash, row));
+		row_stops.push_back(stops);
+		return row;
+	}
+
+	void GradientAtlas::clear()
+	{
+		rows.clear();
+		row_stops.clear();
+		next_row = 0;
+	}
+
+	void GradientAtlas::bake(const std::vector<BrushGradientStop> &stops)
+	{
+		unsigned char *pixels = row_pixels.get_data_uint8();
+		for (int x = 0; x < width; x++)
+		{
+			// Same piecewise interpolation the path shader uses, with premultiplied colors
+			float t = x / (float)(width - 1);
+			Vec4f color;
+			if (!stops.empty())
+			{
+				const Colorf &first = stops.front().color;
+				color = Vec4f(first.r * first.a, first.g * first.a, first.b * first.a, first.a);
+				float last_position = stops.front().position;
+				for (const auto &stop : stops)
+				{
+					float tt;
+					if (stop.position > last_position)
+						tt = clamp((t - last_position) / (stop.position - last_position), 0.0f, 1.0f);
+					else
+						tt = t >= stop.position ? 1.0f : 0.0f;
+
+					Vec4f stop_color(stop.color.r * stop.color.a, stop.color.g * stop.color.a, stop.color.b * stop.color.a, stop.color.a);
+					color = color + (stop_color - color) * tt;
+					last_position = stop.position;
+				}
+			}
+
+			float rcp_alpha = color.w > 0.0f ? 1.0f / color.w : 0.0f;
+			pixels[x * 4 + 0] = (unsigned char)(clamp(color.x * rcp_alpha, 0.0f, 1.0f) * 255.0f + 0.5f);
+			pixels[x * 4 + 1] = (unsigned char)(clamp(color.y * rcp_alpha, 0.0f, 1.0f) * 255.0f + 0.5f);
+			pixels[x * 4 + 2] = (unsigned char)(clamp(color.z * rcp_alpha, 0.0f, 1.0f) * 255.0f + 0.5f);
+			pixels[x * 4 + 3] = (unsigned char)(clamp(color.w, 0.0f, 1.0f) * 255.0f + 0.5f);
+		}
+	}
+
+	std::size_t GradientAtlas::get_hash(const std::vector<BrushGradientStop> &stops)
+	{
+		std::hash<float> hash_float;
+		std::size_t hash = stops.size();
+		for (const auto &stop : stops)
+		{
+			const float values[5] = { stop.color.r, stop.color.g, stop.color.b, stop.color.a, stop.position };
+			for (float value : values)
+				hash ^= hash_float(value) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		}
+		return hash;
+	}
+
+	bool GradientAtlas::is_same(const std::vector<BrushGradientStop> &a, const std::vector<BrushGradientStop> &b)
+	{
+		if (a.size() != b.size())
+			return false;
+
+		for (size_t i = 0; i < a.size(); i++)
+		{
+			if (a[i].color != b[i].color || a[i].position != b[i].position)
+				return false;
+		}
+		return true;
+	}
+}
@@ -0,0 +1,81 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include "API/Display/Render/texture_2d.h"
+#include "API/Display/Image/pixel_buffer.h"
+#include "API/Display/2D/brush.h"
+#include <unordered_map>
+#include <vector>
+
+namespace clan
+{
+	/// \brief Gradients baked into the rows of a texture shared by the batchers, one row per set of stops
+	///
+	/// Each row holds the colors of the gradient from t=0 at the center of the first texel to t=1 at the center
+	/// of the last. The colors are interpolated premultiplied, like the path shader did with the stops, and stored
+	/// unpremultiplied so the sprite program can draw them with the default blend state.
+	class GradientAtlas
+	{
+	public:
+		/// \brief Returns the row holding the stops, baking and uploading it if they were not seen before
+		///
+		/// \return -1 when the atlas is full. Flush, call clear() and try again.
+		int get_row(GraphicContext &gc, const std::vector<BrushGradientStop> &stops);
+
+		/// \brief Forgets all rows. Only call when no batched draw refers to them anymore.
+		void clear();
+
+		bool is_full() const { return next_row == height; }
+
+		Texture2D get_texture() const { return texture; }
+
+		/// \brief Texture coordinate of the center of a row
+		static float get_v(int row) { return (row + 0.5f) / height; }
+
+		/// \brief Texture x coordinate for a gradient position is t * get_u_scale() + get_u_offset()
+		static float get_u_scale() { return (width - 1) / (float)width; }
+		static float get_u_offset() { return 0.5f / width; }
+
+		static const int width = 256;
+		static const int height = 256;
+
+	private:
+		static std::size_t get_hash(const std::vector<BrushGradientStop> &stops);
+		static bool is_same(const std::vector<BrushGradientStop> &a, const std::vector<BrushGradientStop> &b);
+		void bake(const std::vector<BrushGradientStop> &stops);
+
+		Texture2D texture;
+		PixelBuffer row_pixels;
+		std::unordered_multimap<std::size_t, int> rows;	// Row indices by hash of their stops
+		std::vector<std::vector<BrushGradientStop>> row_stops;
+		int next_row = 0;
+	};
+}
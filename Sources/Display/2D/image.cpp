@@ -34,6 +34,7 @@
 #include "API/Display/2D/subtexture.h"
 #include "API/Display/Render/graphic_context.h"
 #include "API/Display/Render/texture_2d.h"
+#include "API/Display/Render/texture_2d_array.h"
 #include "API/Display/Resources/display_cache.h"
 #include "API/Core/Text/string_help.h"
 #include "API/Core/Math/quad.h"
@@ -41,6 +42,7 @@
 #include "../Render/graphic_context_impl.h"
 #include "canvas_impl.h"
 #include "API/Display/Resources/display_cache.h"
+#include <algorithm>
 
 namespace clan
 {
@@ -67,8 +69,13 @@ namespace clan
 
 		Pointf translated_hotspot;	// Precalculated from calc_hotspot()
 
+		float get_pixel_ratio() const { return texture_array.is_null() ? texture.get_pixel_ratio() : texture_array.get_pixel_ratio(); }
+
 		Texture2D texture;
+		Texture2DArray texture_array;	// Used instead of texture when the image is a layer of an array
+		int texture_layer = 0;
 		Rect texture_rect;
+		bool instanced = false;
 	};
 
 	void Image_Impl::calc_hotspot()
@@ -105,13 +112,32 @@ namespace clan
 			break;
 		}
 
-		if (texture.get_pixel_ratio() != 0.0f)
+		if (get_pixel_ratio() != 0.0f)
 		{
-			translated_hotspot.x /= texture.get_pixel_ratio();
-			translated_hotspot.y /= texture.get_pixel_ratio();
+			translated_hotspot.x /= get_pixel_ratio();
+			translated_hotspot.y /= get_pixel_ratio();
 		}
 	}
 
+	static Rectf get_quad_bounds(const Quadf &quad)
+	{
+		return Rectf(
+			std::min(std::min(quad.p.x, quad.q.x), std::min(quad.r.x, quad.s.x)),
+			std::min(std::min(quad.p.y, quad.q.y), std::min(quad.r.y, quad.s.y)),
+			std::max(std::max(quad.p.x, quad.q.x), std::max(quad.r.x, quad.s.x)),
+			std::max(std::max(quad.p.y, quad.q.y), std::max(quad.r.y, quad.s.y)));
+	}
+
+	static void draw_image_batched(Canvas &canvas, RenderBatchTriangle *batcher, RenderBatchSpriteInstanced *instanced_batcher, const Rectf &src, const Quadf &dest, const Colorf &color, const Texture2D &texture, const Texture2DArray &texture_array, int layer)
+	{
+		if (instanced_batcher)
+			instanced_batcher->draw_image(canvas, src, dest, color, texture);
+		else if (texture_array.is_null())
+			batcher->draw_image(canvas, src, dest, color, texture);
+		else
+			batcher->draw_image(canvas, src, dest, color, texture_array, layer);
+	}
+
 	Image::Image()
 	{
 	}
@@ -131,6 +157,14 @@ namespace clan
 		impl->texture_rect = rect;
 	}
 
+	Image::Image(Texture2DArray texture, int layer, const Rect &rect)
+		: impl(std::make_shared<Image_Impl>())
+	{
+		impl->texture_array = texture;
+		impl->texture_layer = layer;
+		impl->texture_rect = rect;
+	}
+
 	Image::Image(Subtexture &sub_texture)
 		: impl(std::make_shared<Image_Impl>())
 	{
@@ -214,16 +248,16 @@ namespace clan
 
 	float Image::get_width() const
 	{
-		if (impl->texture.get_pixel_ratio() != 0.0f)
-			return impl->texture_rect.get_width() / impl->texture.get_pixel_ratio();
+		if (impl->get_pixel_ratio() != 0.0f)
+			return impl->texture_rect.get_width() / impl->get_pixel_ratio();
 		else
 			return impl->texture_rect.get_width();
 	}
 
 	float Image::get_height() const
 	{
-		if (impl->texture.get_pixel_ratio() != 0.0f)
-			return impl->texture_rect.get_height() / impl->texture.get_pixel_ratio();
+		if (impl->get_pixel_ratio() != 0.0f)
+			return impl->texture_rect.get_height() / impl->get_pixel_ratio();
 		else
 			return impl->texture_rect.get_height();
 	}
@@ -239,8 +273,7 @@ namespace clan
 			x + impl->translated_hotspot.x, y + impl->translated_hotspot.y,
 			Sizef(get_width() * impl->scale_x, get_height() * impl->scale_y));
 
-		RenderBatchTriangle *batcher = canvas.impl->batcher.get_triangle_batcher();
-		batcher->draw_image(canvas, impl->texture_rect, dest, impl->color, impl->texture);
+		draw_texture(canvas, impl->texture_rect, dest);
 	}
 
 	void Image::draw(Canvas &canvas, const Rectf &src, const Rectf &dest) const
@@ -251,8 +284,7 @@ namespace clan
 		Rectf new_dest = dest;
 		new_dest.translate(impl->translated_hotspot);
 
-		RenderBatchTriangle *batcher = canvas.impl->batcher.get_triangle_batcher();
-		batcher->draw_image(canvas, new_src, new_dest, impl->color, impl->texture);
+		draw_texture(canvas, new_src, new_dest);
 	}
 
 	void Image::draw(Canvas &canvas, const Rectf &dest) const
@@ -260,8 +292,7 @@ namespace clan
 		Rectf new_dest = dest;
 		new_dest.translate(impl->translated_hotspot);
 
-		RenderBatchTriangle *batcher = canvas.impl->batcher.get_triangle_batcher();
-		batcher->draw_image(canvas, impl->texture_rect, new_dest, impl->color, impl->texture);
+		draw_texture(canvas, impl->texture_rect, new_dest);
 	}
 
 	void Image::draw(Canvas &canvas, const Rectf &src, const Quadf &dest) const
@@ -275,8 +306,7 @@ namespace clan
 		new_dest.r += impl->translated_hotspot;
 		new_dest.s += impl->translated_hotspot;
 
-		RenderBatchTriangle *batcher = canvas.impl->batcher.get_triangle_batcher();
-		batcher->draw_image(canvas, new_src, new_dest, impl->color, impl->texture);
+		draw_texture(canvas, new_src, new_dest);
 	}
 
 	void Image::draw(Canvas &canvas, const Quadf &dest) const
@@ -287,8 +317,27 @@ namespace clan
 		new_dest.r += impl->translated_hotspot;
 		new_dest.s += impl->translated_hotspot;
 
+		draw_texture(canvas, impl->texture_rect, new_dest);
+	}
+
+	void Image::draw_texture(Canvas &canvas, const Rectf &src, const Quadf &dest) const
+	{
+		bool instanced = impl->instanced && impl->texture_array.is_null() && RenderBatchSpriteInstanced::is_parallelogram(dest) &&
+			!canvas.impl->batcher.get_triangle_batcher()->is_capturing() && RenderBatchSpriteInstanced::is_supported(canvas.impl->get_projection() * canvas.impl->get_transform());
+
 		RenderBatchTriangle *batcher = canvas.impl->batcher.get_triangle_batcher();
-		batcher->draw_image(canvas, impl->texture_rect, new_dest, impl->color, impl->texture);
+		RenderBatchSpriteInstanced *instanced_batcher = instanced ? canvas.impl->batcher.get_sprite_instanced_batcher() : nullptr;
+		if (canvas.impl->is_deferred())
+		{
+			Colorf color = impl->color;
+			Texture2D texture = impl->texture;
+			Texture2DArray texture_array = impl->texture_array;
+			int layer = impl->texture_layer;
+			RenderBatcher *sort_batcher = instanced_batcher ? static_cast<RenderBatcher *>(instanced_batcher) : batcher;
+			canvas.impl->record(sort_batcher, get_quad_bounds(dest), [=](Canvas &target) { draw_image_batched(target, batcher, instanced_batcher, src, dest, color, texture, texture_array, layer); });
+			return;
+		}
+		draw_image_batched(canvas, batcher, instanced_batcher, src, dest, impl->color, impl->texture, impl->texture_array, impl->texture_layer);
 	}
 
 	void Image::set_scale(float x, float y)
@@ -316,17 +365,26 @@ namespace clan
 		impl->calc_hotspot();
 	}
 
+	void Image::set_instanced(bool enable)
+	{
+		impl->instanced = enable;
+	}
+
 	void Image::set_wrap_mode(
 		TextureWrapMode wrap_s,
 		TextureWrapMode wrap_t)
 	{
-		impl->texture.set_wrap_mode(wrap_s, wrap_t);
+		if (impl->texture_array.is_null())
+			impl->texture.set_wrap_mode(wrap_s, wrap_t);
+		else
+			impl->texture_array.set_wrap_mode(wrap_s, wrap_t);
 	}
 
 	void Image::set_linear_filter(bool linear_filter)
 	{
-		impl->texture.set_mag_filter(linear_filter ? filter_linear : filter_nearest);
-		impl->texture.set_min_filter(linear_filter ? filter_linear : filter_nearest);
+		Texture texture = impl->texture_array.is_null() ? Texture(impl->texture) : Texture(impl->texture_array);
+		texture.set_mag_filter(linear_filter ? filter_linear : filter_nearest);
+		texture.set_min_filter(linear_filter ? filter_linear : filter_nearest);
 	}
 
 	void Image::set_subimage(
@@ -337,6 +395,9 @@ namespace clan
 		const Rect &src_rect,
 		int level)
 	{
-		impl->texture.set_subimage(canvas, x, y, image, src_rect, level);
+		if (impl->texture_array.is_null())
+			impl->texture.set_subimage(canvas, x, y, image, src_rect, level);
+		else
+			impl->texture_array.set_subimage(canvas, impl->texture_layer, x, y, image, src_rect, level);
 	}
 }
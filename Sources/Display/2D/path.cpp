@@ -52,12 +52,14 @@ namespace clan
 			impl->subpaths.push_back(CanvasSubpath());
 
 		impl->subpaths.back().points.front() = point;
+		impl->version++;
 	}
 
 	void Path::line_to(const Pointf &point)
 	{
 		impl->subpaths.back().points.push_back(point);
 		impl->subpaths.back().commands.push_back(PathCommand::line);
+		impl->version++;
 	}
 
 	void Path::bezier_to(const Pointf &control, const Pointf &point)
@@ -65,6 +67,7 @@ namespace clan
 		impl->subpaths.back().points.push_back(control);
 		impl->subpaths.back().points.push_back(point);
 		impl->subpaths.back().commands.push_back(PathCommand::quadradic);
+		impl->version++;
 	}
 
 	void Path::bezier_to(const Pointf &control1, const Pointf &control2, const Pointf &point)
@@ -73,6 +76,7 @@ namespace clan
 		impl->subpaths.back().points.push_back(control2);
 		impl->subpaths.back().points.push_back(point);
 		impl->subpaths.back().commands.push_back(PathCommand::cubic);
+		impl->version++;
 	}
 
 	void Path::close()
@@ -81,6 +85,7 @@ namespace clan
 		{
 			impl->subpaths.back().closed = true;
 			impl->subpaths.push_back(CanvasSubpath());
+			impl->version++;
 		}
 	}
 
@@ -175,6 +180,7 @@ namespace clan
 		{
 			impl->subpaths.reserve(impl->subpaths.size() + path.impl->subpaths.size());
 			impl->subpaths.insert(impl->subpaths.end(), path.impl->subpaths.begin(), path.impl->subpaths.end());
+			impl->version++;
 		}
 	}
 
@@ -188,6 +194,7 @@ namespace clan
 				point = transform * point;
 			}
 		}
+		impl->version++;
 		return *this;
 	}
 	Path Path::clone() const
@@ -38,10 +38,18 @@
 #include <xmmintrin.h>
 #endif
 
+#if !defined __SSE2__ && (defined __ARM_NEON || defined __ARM_NEON__)
+#include <arm_neon.h>
+#define CL_PATH_NEON
+#endif
+
 using namespace clan::PathConstants;
 
 namespace clan
 {
+	bool PathFillRenderer::gpu_coverage_supported = false;
+	bool PathFillRenderer::gradient_atlas_supported = false;
+
 	PathFillRenderer::PathFillRenderer(GraphicContext &gc, RenderBatchBuffer *batch_buffer) : batch_buffer(batch_buffer)
 	{
 		BlendStateDescription blend_desc;
@@ -137,7 +145,12 @@ namespace clan
 		current_instance_offset = instances.push(canvas, brush, transform);
 		if (!current_instance_offset)
 		{
+			bool texture_changed = brush.type == BrushType::image && !instances.get_texture().is_null() && brush.image.get_texture().get_texture() != instances.get_texture();
+			bool atlas_full = batch_buffer->gradient_atlas.is_full();
+			batch_buffer->count_flush(texture_changed || atlas_full ? batch_flush_texture_limit : batch_flush_buffer_full);
 			flush(canvas);
+			if (atlas_full)
+				batch_buffer->gradient_atlas.clear();
 			initialise_buffers(canvas);
 			current_instance_offset = instances.push(canvas, brush, transform);
 		}
@@ -147,21 +160,42 @@ namespace clan
 		int start_y = first_scanline / scanline_block_size * scanline_block_size;
 		int end_y = (last_scanline + scanline_block_size - 1) / scanline_block_size * scanline_block_size;
 
+		if (!use_gpu_coverage && (end_y - start_y) / scanline_block_size >= parallel_min_rows)
+		{
+			if (!work_queue)
+				work_queue.reset(new WorkQueue());
+
+			if (work_queue->get_worker_count() > 1)
+			{
+				fill_parallel(canvas, mode, brush, transform, start_y, end_y, max_width);
+				return;
+			}
+		}
+
 		for (size_t y = start_y; y < end_y; y += scanline_block_size)
 		{
-			mask_blocks.begin_row(&scanlines[y], mode);
+			if (use_gpu_coverage)
+				coverage_blocks.begin_row(&scanlines[y], mode);
+			else
+				mask_blocks.begin_row(&scanlines[y], mode);
 			Extent extent = find_extent(&scanlines[y], max_width);
 
 			for (int xpos = extent.left; xpos < extent.right; xpos += scanline_block_size)
 			{
-				if (vertices.is_full() || mask_blocks.is_full())
+				if (vertices.is_full() || (use_gpu_coverage ? coverage_blocks.is_full() : mask_blocks.is_full()))
 				{
+					batch_buffer->count_flush(batch_flush_buffer_full);
 					flush(canvas);
 					initialise_buffers(canvas);
 					current_instance_offset = instances.push(canvas, brush, transform);
 				}
 
-				if (mask_blocks.fill_block(xpos))
+				if (use_gpu_coverage)
+				{
+					if (coverage_blocks.fill_block(xpos))
+						vertices.push(xpos / antialias_level, y / antialias_level, current_instance_offset, coverage_blocks.block_index);
+				}
+				else if (mask_blocks.fill_block(xpos))
 				{
 					vertices.push(xpos / antialias_level, y / antialias_level, current_instance_offset, mask_blocks.block_index);
 				}
@@ -169,6 +203,62 @@ namespace clan
 		}
 	}
 
+	void PathFillRenderer::fill_parallel(Canvas &canvas, PathFillMode mode, const Brush &brush, const Mat4f &transform, int start_y, int end_y, int max_width)
+	{
+		int num_rows = (end_y - start_y) / scanline_block_size;
+		if (row_blocks.size() < (size_t)num_rows)
+			row_blocks.resize(num_rows);
+
+		// Every row of blocks only reads its own scanlines, so the coverage can be computed in parallel
+		work_queue->parallel_for(0, num_rows, 1, [&](int first, int last)
+		{
+			PathRasterRange range[scanline_block_size];
+			for (int row = first; row < last; row++)
+			{
+				PathScanline *row_scanlines = &scanlines[start_y + row * scanline_block_size];
+				std::vector<RasterBlock> &blocks = row_blocks[row];
+				blocks.clear();
+
+				for (unsigned int cnt = 0; cnt < scanline_block_size; cnt++)
+					range[cnt].begin(&row_scanlines[cnt], mode);
+
+				Extent extent = find_extent(row_scanlines, max_width);
+				for (int xpos = extent.left; xpos < extent.right; xpos += scanline_block_size)
+				{
+					blocks.emplace_back();
+					RasterBlock &block = blocks.back();
+					block.xpos = xpos;
+					block.full = PathRasterRange::is_full_block(range, xpos);
+					if (!block.full && !PathMaskBuffer::rasterize_block(range, xpos, block.coverage))
+						blocks.pop_back();
+				}
+			}
+		});
+
+		// Blocks are added to the mask in the same order as the serial fill
+		for (int row = 0; row < num_rows; row++)
+		{
+			int y = start_y + row * scanline_block_size;
+			for (const RasterBlock &block : row_blocks[row])
+			{
+				if (vertices.is_full() || mask_blocks.is_full())
+				{
+					batch_buffer->count_flush(batch_flush_buffer_full);
+					flush(canvas);
+					initialise_buffers(canvas);
+					current_instance_offset = instances.push(canvas, brush, transform);
+				}
+
+				if (block.full)
+					mask_blocks.fill_full_block();
+				else
+					mask_blocks.store_block(block.coverage);
+
+				vertices.push(block.xpos / antialias_level, y / antialias_level, current_instance_offset, mask_blocks.block_index);
+			}
+		}
+	}
+
 	PathFillRenderer::Extent PathFillRenderer::find_extent(const PathScanline *scanline, int max_width)
 	{
 		// Find scanline extents
@@ -194,26 +284,34 @@ namespace clan
 
 	void PathFillRenderer::flush(GraphicContext &gc)
 	{
-		if (mask_blocks.next_block == 0) // Nothing to flush
+		if ((use_gpu_coverage ? coverage_blocks.next_block : mask_blocks.next_block) == 0) // Nothing to flush
 			return;
 
-		mask_blocks.flush_block();
-		mask_buffer.unlock();
+		if (use_gpu_coverage)
+		{
+			coverage_blocks.rasterize(gc, mask_texture);
+		}
+		else
+		{
+			mask_blocks.flush_block();
+			mask_buffer.unlock();
+		}
 		instance_buffer.unlock();
 
-		int gpu_index;
-		VertexArrayVector<Vec4i> gpu_vertices(batch_buffer->get_vertex_buffer(gc, gpu_index));
-
-		if (prim_array[gpu_index].is_null())
+		if (prim_array.is_null())
 		{
-			prim_array[gpu_index] = PrimitivesArray(gc);
-			prim_array[gpu_index].set_attributes(0, gpu_vertices);
+			VertexArrayVector<Vec4i> gpu_vertices(batch_buffer->get_vertex_buffer());
+			prim_array = PrimitivesArray(gc);
+			prim_array.set_attributes(0, gpu_vertices);
 		}
 
-		gpu_vertices.upload_data(gc, 0, vertices.get_vertices(), vertices.get_position());
+		int first_vertex = batch_buffer->upload_vertices(gc, vertices.get_vertices(), sizeof(Vec4i), vertices.get_position());
 
-		int block_y = (((mask_blocks.next_block-1) * mask_block_size) / mask_texture_size)* mask_block_size;
-		mask_texture.set_subimage(gc, 0, 0, mask_buffer, Rect(Point(0, 0), Size(mask_texture_size, block_y + mask_block_size)));
+		if (!use_gpu_coverage)
+		{
+			int block_y = (((mask_blocks.next_block-1) * mask_block_size) / mask_texture_size)* mask_block_size;
+			mask_texture.set_subimage(gc, 0, 0, mask_buffer, Rect(Point(0, 0), Size(mask_texture_size, block_y + mask_block_size)));
+		}
 
 		instance_texture.set_subimage(gc, 0, 0, instance_buffer, Rect(Point(0, 0), Size(instance_buffer_width, (instances.get_position() + instance_buffer_width - 1) / instance_buffer_width)));
 
@@ -230,7 +328,15 @@ namespace clan
 
 		if (!current_texture.is_null())
 			gc.set_texture(2, current_texture);
-		gc.draw_primitives(type_triangles, vertices.get_position(), prim_array[gpu_index]);
+		if (instances.uses_gradient_atlas())
+			gc.set_texture(3, batch_buffer->gradient_atlas.get_texture());
+		gc.set_primitives_array(prim_array);
+		gc.draw_primitives_array(type_triangles, first_vertex, vertices.get_position());
+		gc.reset_primitives_array();
+		if (instances.uses_gradient_atlas())
+		{
+			gc.reset_texture(3);
+		}
 		if (!current_texture.is_null())
 		{
 			gc.reset_texture(2);
@@ -243,6 +349,7 @@ namespace clan
 		// Set nothing more to flush.
 		// Although this is cleared in PathMaskBuffer::reset() called by initialise_buffers(), It is still possible for this function to be called without reinitialising the buffers
 		mask_blocks.next_block = 0;
+		coverage_blocks.next_block = 0;
 
 		// Finished with the buffers
 		mask_buffer = TransferTexture();
@@ -256,18 +363,27 @@ namespace clan
 		if (mask_texture.is_null())
 		{
 			GraphicContext gc = canvas.get_gc();
+			use_gpu_coverage = gpu_coverage_supported && gc.has_compute_shader_support();
+
 			mask_texture = batch_buffer->get_texture_r8(gc);
-			mask_buffer = batch_buffer->get_transfer_r8(gc, mask_buffer_id);
 			instance_texture = batch_buffer->get_texture_rgba32f(gc);
 			instance_buffer = batch_buffer->get_transfer_rgba32f(gc);
 
-			mask_buffer.lock(gc, access_write_discard);
 			instance_buffer.lock(gc, access_write_discard);
 
-			instances.reset(gc, instance_buffer.get_data<Vec4f>(), instance_buffer_width * instance_buffer_height);
+			instances.reset(gc, instance_buffer.get_data<Vec4f>(), instance_buffer_width * instance_buffer_height, &batch_buffer->gradient_atlas);
 			vertices.reset((Vec4i *)batch_buffer->buffer, max_vertices);
 
-			mask_blocks.reset(mask_buffer.get_data_uint8(), mask_buffer.get_pitch());
+			if (use_gpu_coverage)
+			{
+				coverage_blocks.reset();
+			}
+			else
+			{
+				mask_buffer = batch_buffer->get_transfer_r8(gc, mask_buffer_id);
+				mask_buffer.lock(gc, access_write_discard);
+				mask_blocks.reset(mask_buffer.get_data_uint8(), mask_buffer.get_pitch());
+			}
 		}
 	}
 
@@ -379,7 +495,6 @@ namespace clan
 		}
 	}
 
-#ifdef __SSE2__
 	bool PathMaskBuffer::fill_block(int xpos)
 	{
 		if (is_full_block(xpos))
@@ -388,6 +503,17 @@ namespace clan
 			return true;
 		}
 
+		alignas(16) unsigned char coverage[mask_block_size * mask_block_size];
+		if (!rasterize_block(range, xpos, coverage))
+			return false;
+
+		store_block(coverage);
+		return true;
+	}
+
+#ifdef __SSE2__
+	bool PathMaskBuffer::rasterize_block(PathRasterRange *range, int xpos, unsigned char *coverage)
+	{
 		const int block_size = mask_block_size / 16 * mask_block_size;
 		__m128i block[block_size];
 
@@ -443,23 +569,29 @@ namespace clan
 		bool empty_block = _mm_movemask_epi8(_mm_cmpeq_epi32(empty_status, _mm_setzero_si128())) == 0xffff;
 		if (empty_block) return false;
 
+		__m128i *output = (__m128i*)coverage;
+		for (int i = 0; i < block_size; i++)
+			_mm_store_si128(&output[i], block[i]);
+		return true;
+	}
+
+	void PathMaskBuffer::store_block(const unsigned char *coverage)
+	{
 		int block_x = (next_block * mask_block_size) % mask_texture_size;
-		int block_y = ((next_block * mask_block_size) / mask_texture_size)* mask_block_size;
 
 		for (unsigned int cnt = 0; cnt < mask_block_size; cnt++)
 		{
-			__m128i *input = &block[mask_block_size / 16 * cnt];
+			const __m128i *input = (const __m128i*)(coverage + mask_block_size * cnt);
 			__m128i *output = (__m128i*)(mask_row_block_data + cnt * mask_texture_size + block_x);
 
 			for (int sse_block = 0; sse_block < mask_block_size / 16; sse_block++)
-				_mm_store_si128(&output[sse_block], input[sse_block]);
+				_mm_store_si128(&output[sse_block], _mm_load_si128(&input[sse_block]));
 		}
 
 		if (((next_block + 1) % (mask_texture_size / mask_block_size) == 0))
 			flush_block();
 
 		block_index = next_block++;
-		return true;
 	}
 
 	void PathMaskBuffer::fill_full_block()
@@ -487,27 +619,81 @@ namespace clan
 	}
 
 #else
-	bool PathMaskBuffer::fill_block(int xpos)
+
+#ifdef CL_PATH_NEON
+	bool PathMaskBuffer::rasterize_block(PathRasterRange *range, int xpos, unsigned char *coverage)
 	{
-		if (is_full_block(xpos))
-		{
-			fill_full_block();
-			return true;
-		}
+		const int block_size = mask_block_size / 16 * mask_block_size;
+		uint8x16_t block[block_size];
 
-		int block_x = (next_block * mask_block_size) % mask_texture_size;
-		int block_y = ((next_block * mask_block_size) / mask_texture_size)* mask_block_size;
+		for (auto & elem : block)
+			elem = vdupq_n_u8(0);
 
-		for (unsigned int cnt = 0; cnt < mask_block_size; cnt++)
+		static const int8_t lane_positions[16] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 };
+		const int8x16_t x = vld1q_s8(lane_positions);
+		const uint8x16_t coverage_step = vdupq_n_u8(256 / (antialias_level*antialias_level));
+
+		for (unsigned int cnt = 0; cnt < scanline_block_size; cnt++)
 		{
-			unsigned char *line = mask_buffer_data + mask_buffer_pitch * (block_y + cnt) + block_x;
-			memset(line, 0, mask_block_size);
+			uint8x16_t *line = &block[mask_block_size / 16 * (cnt / antialias_level)];
+
+			while (range[cnt].found)
+			{
+				int x0 = range[cnt].x0;
+				if (x0 >= xpos + scanline_block_size)
+					break;
+				int x1 = range[cnt].x1;
+
+				x0 = max(x0, xpos);
+				x1 = min(x1, xpos + scanline_block_size);
+
+				if (x0 >= x1)	// Done segment
+				{
+					range[cnt].next();
+				}
+				else
+				{
+					for (int neon_block = 0; neon_block < mask_block_size / 16; neon_block++)
+					{
+						for (int alias_cnt = 0; alias_cnt < (antialias_level); alias_cnt++)
+						{
+							int8x16_t start = vdupq_n_s8((x0 + alias_cnt - xpos) / antialias_level - 16 * neon_block);
+							int8x16_t end = vdupq_n_s8((x1 + alias_cnt - xpos) / antialias_level - 16 * neon_block);
+
+							uint8x16_t left = vcltq_s8(x, start);
+							uint8x16_t right = vcltq_s8(x, end);
+							uint8x16_t add_value = vandq_u8(vbicq_u8(right, left), coverage_step);
+
+							line[neon_block] = vqaddq_u8(line[neon_block], add_value);
+						}
+					}
+
+					range[cnt].x0 = x1;	// For next time
+				}
+			}
 		}
 
+		uint8x16_t empty_status = vdupq_n_u8(0);
+		for (auto & elem : block)
+			empty_status = vorrq_u8(empty_status, elem);
+
+		uint64x2_t empty_lanes = vreinterpretq_u64_u8(empty_status);
+		if ((vgetq_lane_u64(empty_lanes, 0) | vgetq_lane_u64(empty_lanes, 1)) == 0)
+			return false;
+
+		for (int i = 0; i < block_size; i++)
+			vst1q_u8(coverage + 16 * i, block[i]);
+		return true;
+	}
+#else
+	bool PathMaskBuffer::rasterize_block(PathRasterRange *range, int xpos, unsigned char *coverage)
+	{
+		memset(coverage, 0, mask_block_size * mask_block_size);
+
 		bool empty_block = true;
 		for (unsigned int cnt = 0; cnt < scanline_block_size; cnt++)
 		{
-			unsigned char *line = mask_buffer_data + mask_buffer_pitch * (block_y + cnt / antialias_level) + block_x;
+			unsigned char *line = coverage + mask_block_size * (cnt / antialias_level);
 			while (range[cnt].found)
 			{
 				int x0 = range[cnt].x0;
@@ -536,10 +722,23 @@ namespace clan
 			}
 		}
 
-		if (!empty_block)
-			block_index = next_block++;
 		return !empty_block;
 	}
+#endif
+
+	void PathMaskBuffer::store_block(const unsigned char *coverage)
+	{
+		int block_x = (next_block * mask_block_size) % mask_texture_size;
+		int block_y = ((next_block * mask_block_size) / mask_texture_size)* mask_block_size;
+
+		for (unsigned int cnt = 0; cnt < mask_block_size; cnt++)
+		{
+			unsigned char *line = mask_buffer_data + mask_buffer_pitch * (block_y + cnt) + block_x;
+			memcpy(line, coverage + mask_block_size * cnt, mask_block_size);
+		}
+
+		block_index = next_block++;
+	}
 
 	void PathMaskBuffer::fill_full_block()
 	{
@@ -565,8 +764,14 @@ namespace clan
 
 	bool PathMaskBuffer::is_full_block(int xpos) const
 	{
-		for (auto & elem : range)
+		return PathRasterRange::is_full_block(range, xpos);
+	}
+
+	bool PathRasterRange::is_full_block(const PathRasterRange *ranges, int xpos)
+	{
+		for (int cnt = 0; cnt < scanline_block_size; cnt++)
 		{
+			const PathRasterRange &elem = ranges[cnt];
 			if (!elem.found)
 			{
 				return false;
@@ -581,11 +786,138 @@ namespace clan
 
 	/////////////////////////////////////////////////////////////////////////
 
-	void PathInstanceBuffer::reset(GraphicContext &gc, Vec4f *new_buffer, int new_max_entries)
+	bool PathCoverageBuffer::is_full() const
+	{
+		return next_block == max_blocks;
+	}
+
+	void PathCoverageBuffer::reset()
+	{
+		found_filled_block = false;
+		filled_block_index = 0;
+		block_index = 0;
+		next_block = 0;
+		blocks.clear();
+		spans.clear();
+	}
+
+	void PathCoverageBuffer::begin_row(PathScanline *scanlines, PathFillMode mode)
+	{
+		for (unsigned int cnt = 0; cnt < scanline_block_size; cnt++)
+		{
+			range[cnt].begin(&scanlines[cnt], mode);
+		}
+	}
+
+	bool PathCoverageBuffer::fill_block(int xpos)
+	{
+		if (PathRasterRange::is_full_block(range, xpos))
+		{
+			if (!found_filled_block)
+			{
+				add_full_block();
+				found_filled_block = true;
+				filled_block_index = next_block++;
+			}
+			block_index = filled_block_index;
+			return true;
+		}
+
+		size_t first_entry = blocks.size();
+		size_t first_span = spans.size();
+
+		blocks.push_back(next_block);
+		for (unsigned int cnt = 0; cnt < scanline_block_size; cnt++)
+		{
+			blocks.push_back(spans.size());
+			while (range[cnt].found)
+			{
+				int x0 = range[cnt].x0;
+				if (x0 >= xpos + scanline_block_size)
+					break;
+				int x1 = range[cnt].x1;
+
+				x0 = max(x0, xpos);
+				x1 = min(x1, xpos + scanline_block_size);
+
+				if (x0 >= x1)	// Done segment
+				{
+					range[cnt].next();
+				}
+				else
+				{
+					spans.push_back(Vec2i(x0 - xpos, x1 - xpos));
+					range[cnt].x0 = x1;	// For next time
+				}
+			}
+		}
+		blocks.push_back(spans.size());
+
+		if (spans.size() == first_span)	// Empty block
+		{
+			blocks.resize(first_entry);
+			return false;
+		}
+
+		block_index = next_block++;
+		return true;
+	}
+
+	void PathCoverageBuffer::add_full_block()
+	{
+		blocks.push_back(next_block);
+		for (unsigned int cnt = 0; cnt < scanline_block_size; cnt++)
+		{
+			blocks.push_back(spans.size());
+			spans.push_back(Vec2i(0, scanline_block_size));
+		}
+		blocks.push_back(spans.size());
+	}
+
+	void PathCoverageBuffer::rasterize(GraphicContext &gc, Texture2D &mask_texture)
+	{
+		if (blocks.empty())
+			return;
+
+		// Grow the GPU buffers in steps, so they are not recreated for every flush
+		if (gpu_blocks_size < (int)blocks.size())
+		{
+			gpu_blocks_size = max((int)blocks.size(), gpu_blocks_size * 2);
+			gpu_blocks = StorageVector<int>(gc, gpu_blocks_size, usage_stream_draw);
+		}
+		if (gpu_spans_size < (int)spans.size())
+		{
+			gpu_spans_size = max((int)spans.size(), gpu_spans_size * 2);
+			gpu_spans = StorageVector<Vec2i>(gc, gpu_spans_size, usage_stream_draw);
+		}
+		gpu_blocks.upload_data(gc, blocks);
+		gpu_spans.upload_data(gc, spans);
+
+		gc.set_program_object(program_path_coverage);
+		gc.set_storage_buffer(0, gpu_blocks);
+		gc.set_storage_buffer(1, gpu_spans);
+		gc.set_image_texture(0, mask_texture);
+
+		// One work group of mask_block_size * mask_block_size threads per block
+		gc.dispatch(blocks.size() / block_entries);
+
+		gc.reset_image_texture(0);
+		gc.reset_storage_buffer(1);
+		gc.reset_storage_buffer(0);
+		gc.reset_program_object();
+
+		reset();
+	}
+
+	/////////////////////////////////////////////////////////////////////////
+
+	void PathInstanceBuffer::reset(GraphicContext &gc, Vec4f *new_buffer, int new_max_entries, GradientAtlas *new_gradient_atlas)
 	{
 		buffer = new_buffer;
 		max_entries = new_max_entries;
 		current_texture = Texture2D();
+		gradient_atlas = new_gradient_atlas;
+		gradients_in_atlas = false;
 
 		buffer[0] = Vec4f(gc.get_width(), gc.get_height(), 0, 0);
 		end_position = 1;
@@ -637,23 +969,26 @@ namespace clan
 
 	int PathInstanceBuffer::store_linear(Canvas &canvas, const Brush &brush, const Mat4f &transform)
 	{
-		int num_stops = brush.stops.size();
-		int instance_position = next_position(num_stops * 2 + 3);
-		if (!instance_position)
-			return 0;
-		int position = instance_position;
-
 		Pointf end_point = transform_point(brush.end_point, brush.transform, transform);
 		Pointf start_point = transform_point(brush.start_point, brush.transform, transform);
 		Pointf dir = end_point - start_point;
 		Pointf dir_normed = Pointf::normalize(dir);
 
 		Vec4f brush_data1;
-		Vec4f brush_data2;
-		Vec4f brush_data3;
 		brush_data1.x = (float)PathShaderDrawMode::linear;
 		brush_data1.set_zw(dir_normed);
 
+		if (PathFillRenderer::gradient_atlas_supported)
+			return store_gradient(canvas, brush, brush_data1, 1.0f / dir.length(), start_point);
+
+		int num_stops = brush.stops.size();
+		int instance_position = next_position(num_stops * 2 + 3);
+		if (!instance_position)
+			return 0;
+		int position = instance_position;
+
+		Vec4f brush_data2;
+		Vec4f brush_data3;
 		brush_data2.x = 1.0f / dir.length();
 		brush_data2.y = 3;
 		brush_data2.z = 3 + num_stops * 2;
@@ -674,19 +1009,23 @@ namespace clan
 
 	int PathInstanceBuffer::store_radial(Canvas &canvas, const Brush &brush, const Mat4f &transform)
 	{
+		Pointf center_point = transform_point(brush.center_point, brush.transform, transform);
+		//Pointf radius = transform_point(Pointf(brush.radius_x, brush.radius_y), brush.transform, transform) - transform_point(Pointf(), brush.transform, transform);
+
+		Vec4f brush_data1;
+		brush_data1.x = (float)PathShaderDrawMode::radial;
+
+		if (PathFillRenderer::gradient_atlas_supported)
+			return store_gradient(canvas, brush, brush_data1, 1.0f / brush.radius_x, center_point);
+
 		int num_stops = brush.stops.size();
 		int instance_position = next_position(num_stops * 2 + 3);
 		if (!instance_position)
 			return 0;
 		int position = instance_position;
 
-		Pointf center_point = transform_point(brush.center_point, brush.transform, transform);
-		//Pointf radius = transform_point(Pointf(brush.radius_x, brush.radius_y), brush.transform, transform) - transform_point(Pointf(), brush.transform, transform);
-
-		Vec4f brush_data1;
 		Vec4f brush_data2;
 		Vec4f brush_data3;
-		brush_data1.x = (float)PathShaderDrawMode::radial;
 		brush_data2.x = 1.0f / brush.radius_x;
 		brush_data2.y = 3;
 		brush_data2.z = 3 + num_stops * 2;
@@ -705,6 +1044,25 @@ namespace clan
 		return instance_position;
 	}
 
+	// The stops are baked into a row of the gradient atlas, so a gradient takes three entries however many stops it has
+	int PathInstanceBuffer::store_gradient(Canvas &canvas, const Brush &brush, const Vec4f &brush_data1, float rcp_length, const Pointf &origin)
+	{
+		int row = gradient_atlas->get_row(canvas.get_gc(), brush.stops);
+		if (row == -1)
+			return 0;		// Atlas full, must flush and clear it
+
+		int instance_position = next_position(3);
+		if (!instance_position)
+			return 0;
+		int position = instance_position;
+
+		gradients_in_atlas = true;
+		buffer[position++] = brush_data1;
+		buffer[position++] = Vec4f(rcp_length, GradientAtlas::get_v(row), GradientAtlas::get_u_scale(), GradientAtlas::get_u_offset());
+		buffer[position++] = Vec4f(origin.x, origin.y, 0.0f, 0.0f);
+		return instance_position;
+	}
+
 	int PathInstanceBuffer::store_image(Canvas &canvas, const Brush &brush, const Mat4f &transform)
 	{
 		Subtexture subtexture = brush.image.get_texture();
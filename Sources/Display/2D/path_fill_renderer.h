@@ -41,6 +41,8 @@
 #include "API/Display/Render/transfer_texture.h"
 #include "API/Display/Image/pixel_buffer.h"
 #include "API/Display/Render/program_object.h"
+#include "API/Display/Render/storage_vector.h"
+#include "API/Core/System/work_queue.h"
 #include "render_batch_buffer.h"
 #include "path_renderer.h"
 
@@ -83,13 +85,14 @@ namespace clan
 	class PathInstanceBuffer
 	{
 	public:
-		void reset(GraphicContext &gc, Vec4f *buffer, int max_entries);
+		void reset(GraphicContext &gc, Vec4f *buffer, int max_entries, GradientAtlas *gradient_atlas);
 		int push(Canvas &canvas, const Brush &brush, const Mat4f &transform);
 
 		Vec4f *get_buffer() const { return buffer; }
 		int get_position() const { return end_position; }
 
 		Texture2D get_texture() const { return current_texture; }
+		bool uses_gradient_atlas() const { return gradients_in_atlas; }
 
 	private:
 		static Pointf transform_point(Pointf point, const Mat3f &brush_transform, const Mat4f &fill_transform);
@@ -100,12 +103,15 @@ namespace clan
 		int store_linear(Canvas &canvas, const Brush &brush, const Mat4f &transform);
 		int store_radial(Canvas &canvas, const Brush &brush, const Mat4f &transform);
 		int store_image(Canvas &canvas, const Brush &brush, const Mat4f &transform);
+		int store_gradient(Canvas &canvas, const Brush &brush, const Vec4f &brush_data1, float rcp_length, const Pointf &origin);
 
 		Vec4f *buffer = nullptr;
 		int max_entries = 0;
 		int end_position = 0;		// The next free position
 
 		Texture2D current_texture;
+		GradientAtlas *gradient_atlas = nullptr;
+		bool gradients_in_atlas = false;	// A gradient brush refers to a row of the gradient atlas
 	};
 
 	class PathVertexBuffer
@@ -149,6 +155,9 @@ namespace clan
 		void begin(const PathScanline *scanline, PathFillMode mode);
 		void next();
 
+		/// \brief Returns true if the ranges of a scanline block cover every pixel of the mask block at xpos
+		static bool is_full_block(const PathRasterRange *ranges, int xpos);
+
 		bool found = false;
 		int x0;
 		int x1;
@@ -176,12 +185,22 @@ namespace clan
 		void begin_row(PathScanline *scanlines, PathFillMode mode);
 		bool fill_block(int xpos);
 
+		/// \brief Computes the coverage of the mask block at xpos. Returns false if the block is empty
+		///
+		/// Only touches the ranges and the output, so rows of blocks can be rasterized on several threads.
+		static bool rasterize_block(PathRasterRange *range, int xpos, unsigned char *coverage);
+
+		/// \brief Adds a block rasterized by rasterize_block to the mask
+		void store_block(const unsigned char *coverage);
+
+		/// \brief Adds a block that is fully covered, sharing it with the other full blocks of the mask
+		void fill_full_block();
+
 		int block_index = 0;
 		int next_block = 0;
 
 	private:
 		bool is_full_block(int xpos) const;
-		void fill_full_block();
 
 		PathRasterRange range[PathConstants::scanline_block_size];
 
@@ -194,6 +213,41 @@ namespace clan
 		int filled_block_index = 0;
 	};
 
+	/// \brief Collects the spans of every mask block, so program_path_coverage can rasterize the mask on the GPU
+	class PathCoverageBuffer
+	{
+	public:
+		bool is_full() const;
+
+		void reset();
+		void rasterize(GraphicContext &gc, Texture2D &mask_texture);
+
+		void begin_row(PathScanline *scanlines, PathFillMode mode);
+		bool fill_block(int xpos);
+
+		int block_index = 0;
+		int next_block = 0;
+
+		// *** If changing this, remember to modify the path coverage shader ***
+		static const int block_entries = PathConstants::scanline_block_size + 2;	// Mask block index, followed by the first span of every scanline and the end of the last one
+
+	private:
+		void add_full_block();
+
+		PathRasterRange range[PathConstants::scanline_block_size];
+
+		std::vector<int> blocks;
+		std::vector<Vec2i> spans;		// Start and end of the covered sub-pixels, relative to the block
+
+		StorageVector<int> gpu_blocks;
+		StorageVector<Vec2i> gpu_spans;
+		int gpu_blocks_size = 0;
+		int gpu_spans_size = 0;
+
+		bool found_filled_block = false;
+		int filled_block_index = 0;
+	};
+
 	class PathFillRenderer : public PathRenderer
 	{
 	public:
@@ -212,6 +266,9 @@ namespace clan
 
 		const float rcp_mask_texture_size = 1.0f / (float)PathConstants::mask_texture_size;
 
+		static bool gpu_coverage_supported;	// Set by targets providing program_path_coverage
+		static bool gradient_atlas_supported;	// Set by targets whose program_path samples gradients from the gradient atlas, instead of the stops in the instance data
+
 	private:
 		void insert_sorted(PathScanline &scanline, const PathScanlineEdge &edge);
 
@@ -228,6 +285,20 @@ namespace clan
 
 		Extent find_extent(const PathScanline *scanline, int max_width);
 
+		void fill_parallel(Canvas &canvas, PathFillMode mode, const Brush &brush, const Mat4f &transform, int start_y, int end_y, int max_width);
+
+		/// \brief Mask block rasterized by a worker thread
+		struct RasterBlock
+		{
+			int xpos;
+			bool full;
+			alignas(16) unsigned char coverage[PathConstants::mask_block_size * PathConstants::mask_block_size];
+		};
+
+		static const int parallel_min_rows = 4;	// Fills covering fewer rows of blocks are not worth spreading over the workers
+		std::unique_ptr<WorkQueue> work_queue;
+		std::vector<std::vector<RasterBlock>> row_blocks;
+
 		int first_scanline = 0;
 		int last_scanline = 0;
 
@@ -247,6 +318,8 @@ namespace clan
 		PathInstanceBuffer instances;
 		PathVertexBuffer vertices;
 		PathMaskBuffer mask_blocks;
+		PathCoverageBuffer coverage_blocks;
+		bool use_gpu_coverage = false;	// Coverage is rasterized by a compute shader into mask_texture, instead of by mask_blocks
 
 		int current_instance_offset = 0;
 
@@ -257,7 +330,7 @@ namespace clan
 		Texture2D mask_texture;
 		TransferTexture instance_buffer;
 		Texture2D instance_texture;
-		PrimitivesArray prim_array[RenderBatchBuffer::num_vertex_buffers];
+		PrimitivesArray prim_array;
 		BlendState blend_state;
 	};
 }
@@ -0,0 +1,165 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Kenneth Gangstoe
+*/
+
+#include "Display/precomp.h"
+#include "path_flatten_cache.h"
+#include "path_impl.h"
+#include "API/Core/Math/batch_math.h"
+
+namespace clan
+{
+	const float PathFlattenCache::scale_tolerance = 1.25f;
+	const float PathFlattenCache::flatten_tolerance = 0.25f;
+
+	void PathFlattenCache::update(const PathImpl &path, const Mat4f &transform)
+	{
+		float new_scale = get_scale(transform);
+		if (version != path.version || new_scale > scale * scale_tolerance || new_scale * scale_tolerance < scale)
+		{
+			flatten(path, new_scale);
+			version = path.version;
+			scale = new_scale;
+			base_valid = false;
+		}
+
+		if (base_valid && is_same_linear_part(base_transform, transform))
+		{
+			// Offsetting from the base points keeps rounding errors from adding up while scrolling
+			Pointf new_offset(transform.matrix[3 * 4 + 0] - base_transform.matrix[3 * 4 + 0], transform.matrix[3 * 4 + 1] - base_transform.matrix[3 * 4 + 1]);
+			if (new_offset != offset)
+			{
+				offset = new_offset;
+				for (size_t i = 0; i < base_points.size(); i++)
+					transformed_points[i] = base_points[i] + offset;
+			}
+			return;
+		}
+
+		base_points.resize(points.size());
+		for (size_t i = 0; i < points.size(); i++)
+		{
+			const Pointf &point = points[i];
+			base_points[i] = Pointf(
+				transform.matrix[0 * 4 + 0] * point.x + transform.matrix[1 * 4 + 0] * point.y + transform.matrix[3 * 4 + 0],
+				transform.matrix[0 * 4 + 1] * point.x + transform.matrix[1 * 4 + 1] * point.y + transform.matrix[3 * 4 + 1]);
+		}
+		transformed_points = base_points;
+		base_transform = transform;
+		offset = Pointf();
+		base_valid = true;
+	}
+
+	void PathFlattenCache::flatten(const PathImpl &path, float flatten_scale)
+	{
+		polylines.clear();
+		points.clear();
+
+		// Gather all curves as cubics first, so they are flattened four at a time
+		curve_control_points.clear();
+		for (const auto &subpath : path.subpaths)
+		{
+			size_t i = 1;
+			for (PathCommand command : subpath.commands)
+			{
+				if (command == PathCommand::line)
+				{
+					i++;
+				}
+				else if (command == PathCommand::quadradic)
+				{
+					const Pointf &start = subpath.points[i - 1];
+					const Pointf &control = subpath.points[i];
+					const Pointf &next_point = subpath.points[i + 1];
+					i += 2;
+
+					curve_control_points.push_back(start);
+					curve_control_points.push_back(start + (control - start) * (2.0f / 3.0f));
+					curve_control_points.push_back(control + (next_point - control) * (1.0f / 3.0f));
+					curve_control_points.push_back(next_point);
+				}
+				else if (command == PathCommand::cubic)
+				{
+					curve_control_points.push_back(subpath.points[i - 1]);
+					curve_control_points.push_back(subpath.points[i]);
+					curve_control_points.push_back(subpath.points[i + 1]);
+					curve_control_points.push_back(subpath.points[i + 2]);
+					i += 3;
+				}
+			}
+		}
+
+		// The segment count scales linearly with the curve, so flattening in path coordinates with a scaled down tolerance matches flattening at the drawing scale
+		curve_points.clear();
+		curve_segment_counts.clear();
+		BatchMath::flatten_cubic_beziers(curve_control_points.data(), curve_control_points.size() / 4, flatten_tolerance / flatten_scale, curve_points, curve_segment_counts);
+
+		size_t curve_index = 0;
+		const Pointf *curve_point = curve_points.data();
+		for (const auto &subpath : path.subpaths)
+		{
+			Polyline polyline;
+			polyline.first_point = points.size();
+			polyline.closed = subpath.closed;
+			points.push_back(subpath.points[0]);
+
+			size_t i = 1;
+			for (PathCommand command : subpath.commands)
+			{
+				if (command == PathCommand::line)
+				{
+					points.push_back(subpath.points[i]);
+					i++;
+				}
+				else
+				{
+					int segments = curve_segment_counts[curve_index++];
+					points.insert(points.end(), curve_point, curve_point + segments);
+					curve_point += segments;
+					i += (command == PathCommand::cubic) ? 3 : 2;
+				}
+			}
+
+			polyline.num_points = points.size() - polyline.first_point;
+			polylines.push_back(polyline);
+		}
+	}
+
+	float PathFlattenCache::get_scale(const Mat4f &transform)
+	{
+		// Geometric mean of the axis scales, which is exact for uniform scaling and rotation
+		float determinant = transform.matrix[0 * 4 + 0] * transform.matrix[1 * 4 + 1] - transform.matrix[0 * 4 + 1] * transform.matrix[1 * 4 + 0];
+		float scale = std::sqrt(std::abs(determinant));
+		return scale > 0.0f ? scale : 1.0f;
+	}
+
+	bool PathFlattenCache::is_same_linear_part(const Mat4f &a, const Mat4f &b)
+	{
+		return a.matrix[0 * 4 + 0] == b.matrix[0 * 4 + 0] && a.matrix[0 * 4 + 1] == b.matrix[0 * 4 + 1] &&
+			a.matrix[1 * 4 + 0] == b.matrix[1 * 4 + 0] && a.matrix[1 * 4 + 1] == b.matrix[1 * 4 + 1];
+	}
+}
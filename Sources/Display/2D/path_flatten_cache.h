@@ -0,0 +1,81 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Kenneth Gangstoe
+*/
+
+#pragma once
+
+#include "API/Core/Math/point.h"
+#include "API/Core/Math/mat4.h"
+#include <vector>
+
+namespace clan
+{
+	class PathImpl;
+
+	/// \brief Curves of a path flattened into polylines, reused until the path changes or is drawn at a different scale
+	class PathFlattenCache
+	{
+	public:
+		struct Polyline
+		{
+			int first_point;
+			int num_points;
+			bool closed;
+		};
+
+		/// \brief Brings transformed_points up to date for drawing the path with the transform
+		///
+		/// The curves are only flattened again when the path changed or the scale moved past scale_tolerance.
+		/// A transform that only differs by a translation offsets the points of the previous transform.
+		void update(const PathImpl &path, const Mat4f &transform);
+
+		std::vector<Polyline> polylines;
+		std::vector<Pointf> transformed_points;
+
+		static const float scale_tolerance;	// Largest ratio between the drawn and the flattened scale
+		static const float flatten_tolerance;	// Largest distance in pixels between a curve and its polyline
+
+	private:
+		void flatten(const PathImpl &path, float scale);
+		static float get_scale(const Mat4f &transform);
+		static bool is_same_linear_part(const Mat4f &a, const Mat4f &b);
+
+		int version = -1;		// Path version the polylines were flattened from
+		float scale = 0.0f;		// Scale the curves were flattened for
+		std::vector<Pointf> points;	// Path coordinates
+
+		// Scratch buffers for flattening, kept to avoid allocations when the path changes
+		std::vector<Pointf> curve_control_points;
+		std::vector<Pointf> curve_points;
+		std::vector<int> curve_segment_counts;
+
+		bool base_valid = false;
+		Mat4f base_transform;		// Transform the base points were computed with
+		std::vector<Pointf> base_points;
+		Pointf offset;			// Translation of transformed_points relative to base_points
+	};
+}
@@ -27,7 +27,10 @@
 **    Mark Page
 */
 
+#pragma once
+
 #include "API/Display/2D/path.h"
+#include "path_flatten_cache.h"
 #include <vector>
 
 namespace clan
@@ -54,5 +57,8 @@ namespace clan
 	public:
 		PathFillMode fill_mode = PathFillMode::alternate;
 		std::vector<CanvasSubpath> subpaths;
+
+		int version = 0;	// Incremented whenever the subpaths change
+		PathFlattenCache flatten_cache;
 	};
 }
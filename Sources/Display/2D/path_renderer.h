@@ -30,6 +30,7 @@
 #pragma once
 
 #include "API/Core/Math/point.h"
+#include <vector>
 
 namespace clan
 {
@@ -52,8 +53,10 @@ namespace clan
 		float last_x = 0.0f;
 		float last_y = 0.0f;
 
+		static const float curve_tolerance;	// Largest distance between a curve and the lines it is drawn with
+
 	private:
-		void subdivide_bezier(int level, float cp0_x, float cp0_y, float cp1_x, float cp1_y, float cp2_x, float cp2_y, float cp3_x, float cp3_y, float t0, float t1);
-		static clan::Pointf point_on_bezier(float cp0_x, float cp0_y, float cp1_x, float cp1_y, float cp2_x, float cp2_y, float cp3_x, float cp3_y, float t);
+		std::vector<Pointf> curve_points;
+		std::vector<int> curve_segment_counts;
 	};
 }
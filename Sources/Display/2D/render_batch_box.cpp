@@ -0,0 +1,175 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+*/
+
+
+#include "Display/precomp.h"
+#include "render_batch_box.h"
+#include "API/Display/2D/canvas.h"
+#include "API/Display/Render/vertex_array_vector.h"
+#include <algorithm>
+
+namespace clan
+{
+	bool RenderBatchBox::supported = false;
+
+	RenderBatchBox::RenderBatchBox(GraphicContext &gc, RenderBatchBuffer *batch_buffer)
+		: batch_buffer(batch_buffer)
+	{
+		vertices = (BoxVertex *)batch_buffer->buffer;
+	}
+
+	inline Vec4f RenderBatchBox::to_position(float x, float y) const
+	{
+		return Vec4f(
+			modelview_projection_matrix.matrix[0 * 4 + 0] * x + modelview_projection_matrix.matrix[1 * 4 + 0] * y + modelview_projection_matrix.matrix[3 * 4 + 0],
+			modelview_projection_matrix.matrix[0 * 4 + 1] * x + modelview_projection_matrix.matrix[1 * 4 + 1] * y + modelview_projection_matrix.matrix[3 * 4 + 1],
+			modelview_projection_matrix.matrix[0 * 4 + 2] * x + modelview_projection_matrix.matrix[1 * 4 + 2] * y + modelview_projection_matrix.matrix[3 * 4 + 2],
+			modelview_projection_matrix.matrix[0 * 4 + 3] * x + modelview_projection_matrix.matrix[1 * 4 + 3] * y + modelview_projection_matrix.matrix[3 * 4 + 3]);
+	}
+
+	Vec4f RenderBatchBox::clamp_radii(const Vec4f &radii, const Vec2f &half_size)
+	{
+		// The distance function needs each corner to fit inside its quarter of the box
+		float max_radius = std::max(std::min(half_size.x, half_size.y), 0.0f);
+		return Vec4f(
+			clan::clamp(radii.x, 0.0f, max_radius),
+			clan::clamp(radii.y, 0.0f, max_radius),
+			clan::clamp(radii.z, 0.0f, max_radius),
+			clan::clamp(radii.w, 0.0f, max_radius));
+	}
+
+	void RenderBatchBox::fill_box(Canvas &canvas, const Rectf &box, const Vec4f &radii, const Vec4f &border_widths, const Colorf &fill_color, const Colorf &border_color)
+	{
+		Rectf padding_box(box.left + border_widths.x, box.top + border_widths.y, box.right - border_widths.z, box.bottom - border_widths.w);
+		Pointf center = box.get_center();
+
+		BoxVertex box_vertex;
+		box_vertex.half_size = Vec2f(box.get_width() * 0.5f, box.get_height() * 0.5f);
+		box_vertex.radii = clamp_radii(radii, box_vertex.half_size);
+
+		Vec2f inner_half_size(padding_box.get_width() * 0.5f, padding_box.get_height() * 0.5f);
+		Pointf inner_center = padding_box.get_center() - center;
+		box_vertex.inner = Vec4f(inner_center.x, inner_center.y, inner_half_size.x, inner_half_size.y);
+
+		// The inner edge follows the outer curve, as described by CSS for the padding edge
+		Vec4f inner_radii(
+			box_vertex.radii.x - std::max(border_widths.x, border_widths.y),
+			box_vertex.radii.y - std::max(border_widths.z, border_widths.y),
+			box_vertex.radii.z - std::max(border_widths.z, border_widths.w),
+			box_vertex.radii.w - std::max(border_widths.x, border_widths.w));
+		box_vertex.inner_radii = clamp_radii(inner_radii, inner_half_size);
+
+		box_vertex.fill_color = fill_color;
+		box_vertex.border_color = border_color;
+		box_vertex.blur_radius = 0.0f;
+
+		// One unit of margin gives the anti-aliased edge room outside the box
+		add_quad(canvas, Rectf(box.left - 1.0f, box.top - 1.0f, box.right + 1.0f, box.bottom + 1.0f), box_vertex);
+	}
+
+	void RenderBatchBox::fill_shadow(Canvas &canvas, const Rectf &box, const Vec4f &radii, float blur_radius, const Colorf &color)
+	{
+		BoxVertex box_vertex;
+		box_vertex.half_size = Vec2f(box.get_width() * 0.5f, box.get_height() * 0.5f);
+		box_vertex.radii = clamp_radii(radii, box_vertex.half_size);
+		box_vertex.inner = Vec4f(0.0f, 0.0f, box_vertex.half_size.x, box_vertex.half_size.y);
+		box_vertex.inner_radii = box_vertex.radii;
+		box_vertex.fill_color = color;
+		box_vertex.border_color = Vec4f(0.0f);
+		box_vertex.blur_radius = blur_radius;
+
+		add_quad(canvas, Rectf(box.left - blur_radius, box.top - blur_radius, box.right + blur_radius, box.bottom + blur_radius), box_vertex);
+	}
+
+	void RenderBatchBox::add_quad(Canvas &canvas, const Rectf &quad, const BoxVertex &box_vertex)
+	{
+		if (position + 6 > max_vertices)
+		{
+			batch_buffer->set_flush_cause(batch_flush_buffer_full);
+			canvas.flush();
+		}
+		canvas.set_batcher(this);
+
+		Pointf center = Pointf((quad.left + quad.right) * 0.5f, (quad.top + quad.bottom) * 0.5f);
+		Vec2f corners[6] =
+		{
+			Vec2f(quad.left, quad.top),
+			Vec2f(quad.right, quad.top),
+			Vec2f(quad.left, quad.bottom),
+			Vec2f(quad.right, quad.top),
+			Vec2f(quad.right, quad.bottom),
+			Vec2f(quad.left, quad.bottom)
+		};
+
+		for (const Vec2f &corner : corners)
+		{
+			BoxVertex &v = vertices[position++];
+			v = box_vertex;
+			v.position = to_position(corner.x, corner.y);
+			v.local = Vec2f(corner.x - center.x, corner.y - center.y);
+		}
+	}
+
+	void RenderBatchBox::flush(GraphicContext &gc)
+	{
+		if (position > 0)
+		{
+			gc.set_program_object(program_box);
+
+			if (prim_array.is_null())
+			{
+				VertexArrayVector<BoxVertex> gpu_vertices(batch_buffer->get_vertex_buffer());
+				prim_array = PrimitivesArray(gc);
+				prim_array.set_attributes(0, gpu_vertices, cl_offsetof(BoxVertex, position));
+				prim_array.set_attributes(1, gpu_vertices, cl_offsetof(BoxVertex, local));
+				prim_array.set_attributes(2, gpu_vertices, cl_offsetof(BoxVertex, half_size));
+				prim_array.set_attributes(3, gpu_vertices, cl_offsetof(BoxVertex, radii));
+				prim_array.set_attributes(4, gpu_vertices, cl_offsetof(BoxVertex, inner));
+				prim_array.set_attributes(5, gpu_vertices, cl_offsetof(BoxVertex, inner_radii));
+				prim_array.set_attributes(6, gpu_vertices, cl_offsetof(BoxVertex, fill_color));
+				prim_array.set_attributes(7, gpu_vertices, cl_offsetof(BoxVertex, border_color));
+				prim_array.set_attributes(8, gpu_vertices, cl_offsetof(BoxVertex, blur_radius));
+			}
+
+			int first_vertex = batch_buffer->upload_vertices(gc, vertices, sizeof(BoxVertex), position);
+
+			gc.set_primitives_array(prim_array);
+			gc.draw_primitives_array(type_triangles, first_vertex, position);
+			gc.reset_primitives_array();
+
+			gc.reset_program_object();
+
+			position = 0;
+		}
+	}
+
+	void RenderBatchBox::matrix_changed(const Mat4f &new_modelview, const Mat4f &new_projection, TextureImageYAxis image_yaxis, float pixel_ratio)
+	{
+		modelview_projection_matrix = new_projection * new_modelview;
+	}
+}
@@ -0,0 +1,84 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+*/
+
+
+#pragma once
+
+#include "API/Display/Render/render_batcher.h"
+#include "API/Display/Render/graphic_context.h"
+#include "API/Display/Render/primitives_array.h"
+#include "render_batch_buffer.h"
+
+namespace clan
+{
+	class RenderBatchBuffer;
+
+	/// \brief Draws boxes with rounded corners, borders and blurred shadows as one quad each
+	///
+	/// The fragment program computes the coverage from a signed distance function, so any number of boxes
+	/// with different sizes, radii and colors share a single draw call.
+	class RenderBatchBox : public RenderBatcher
+	{
+	public:
+		RenderBatchBox(GraphicContext &gc, RenderBatchBuffer *batch_buffer);
+
+		/// \param radii = Corner radii in the order top left, top right, bottom right, bottom left
+		/// \param border_widths = Left, top, right and bottom border widths
+		void fill_box(Canvas &canvas, const Rectf &box, const Vec4f &radii, const Vec4f &border_widths, const Colorf &fill_color, const Colorf &border_color);
+		void fill_shadow(Canvas &canvas, const Rectf &box, const Vec4f &radii, float blur_radius, const Colorf &color);
+
+		static bool supported;	// Set by targets providing program_box
+
+	private:
+		struct BoxVertex
+		{
+			Vec4f position;
+			Vec2f local;	// Relative to the center of the box
+			Vec2f half_size;
+			Vec4f radii;
+			Vec4f inner;	// Center of the padding box relative to the center of the box (xy) and its half size (zw)
+			Vec4f inner_radii;
+			Vec4f fill_color;
+			Vec4f border_color;
+			float blur_radius;	// Shadows have a blur radius above zero
+		};
+
+		void add_quad(Canvas &canvas, const Rectf &quad, const BoxVertex &box_vertex);
+		inline Vec4f to_position(float x, float y) const;
+		static Vec4f clamp_radii(const Vec4f &radii, const Vec2f &half_size);
+		void flush(GraphicContext &gc) override;
+		void matrix_changed(const Mat4f &modelview, const Mat4f &projection, TextureImageYAxis image_yaxis, float pixel_ratio) override;
+
+		enum { max_vertices = RenderBatchBuffer::vertex_buffer_size / sizeof(BoxVertex) };
+		BoxVertex *vertices;
+		RenderBatchBuffer *batch_buffer;
+		PrimitivesArray prim_array;
+		int position = 0;
+		Mat4f modelview_projection_matrix;
+	};
+}
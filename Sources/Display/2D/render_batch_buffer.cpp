@@ -36,22 +36,45 @@
 namespace clan
 {
 	RenderBatchBuffer::RenderBatchBuffer(GraphicContext &gc)
+		: vertex_ring(gc, vertex_ring_size, usage_stream_draw)
 	{
-		for (auto & elem : vertex_buffers)
+	}
+
+	int RenderBatchBuffer::upload_vertices(GraphicContext &gc, const void *vertices, int vertex_size, int num_vertices)
+	{
+		int size = vertex_size * num_vertices;
+		if (size > vertex_buffer_size)
+			throw Exception("Too many vertices for RenderBatchBuffer");
+
+		// Vertices are addressed by index, so the offset must be a multiple of the vertex size
+		int first_vertex = (vertex_ring_position + vertex_size - 1) / vertex_size;
+		bool discard = false;
+		if ((first_vertex + num_vertices) * vertex_size > vertex_ring_size)
 		{
-			elem = VertexArrayBuffer(gc, vertex_buffer_size, usage_stream_draw);
+			first_vertex = 0;
+			discard = true;
 		}
+
+		int offset = first_vertex * vertex_size;
+		vertex_ring.upload_data_unsynchronized(gc, offset, vertices, size, discard);
+		vertex_ring_position = offset + size;
+		count_upload(num_vertices, size);
+		return first_vertex;
 	}
 
-	VertexArrayBuffer RenderBatchBuffer::get_vertex_buffer(GraphicContext &gc, int &out_index)
+	void RenderBatchBuffer::count_flush(BatchFlushCause cause)
 	{
-		out_index = current_vertex_buffer;
+		if (flush_cause != batch_flush_state_change)
+			cause = flush_cause;
+		flush_cause = batch_flush_state_change;
 
-		current_vertex_buffer++;
-		if (current_vertex_buffer == num_vertex_buffers)
-			current_vertex_buffer = 0;
-
-		return vertex_buffers[out_index];
+		switch (cause)
+		{
+		case batch_flush_state_change: stats.flushes_state_change++; break;
+		case batch_flush_batcher_switch: stats.flushes_batcher_switch++; break;
+		case batch_flush_texture_limit: stats.flushes_texture_limit++; break;
+		case batch_flush_buffer_full: stats.flushes_buffer_full++; break;
+		}
 	}
 
 	Texture2D RenderBatchBuffer::get_texture_rgba32f(GraphicContext &gc)
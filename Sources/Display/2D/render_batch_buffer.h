@@ -35,22 +35,59 @@
 #include "API/Display/Render/render_batcher.h"
 #include "API/Display/Render/texture_2d.h"
 #include "API/Display/Render/transfer_texture.h"
+#include "API/Display/2D/canvas.h"
+#include "gradient_atlas.h"
 
 namespace clan
 {
+	/// \brief Why the active batcher was flushed, for CanvasBatchStats
+	enum BatchFlushCause
+	{
+		batch_flush_state_change,
+		batch_flush_batcher_switch,
+		batch_flush_texture_limit,
+		batch_flush_buffer_full
+	};
+
 	class RenderBatchBuffer
 	{
 	public:
 		RenderBatchBuffer(GraphicContext &gc);
 
-		VertexArrayBuffer get_vertex_buffer(GraphicContext &gc, int &out_index);
+		/// \brief Returns the streaming vertex buffer all batchers draw from
+		VertexArrayBuffer get_vertex_buffer() const { return vertex_ring; }
+
+		/// \brief Copies vertices into the next free part of the streaming vertex buffer
+		///
+		/// The buffer is used as a ring. Uploads never touch a part queued draw commands may still read,
+		/// so the driver does not have to wait for the GPU.
+		/// \return Index of the first uploaded vertex
+		int upload_vertices(GraphicContext &gc, const void *vertices, int vertex_size, int num_vertices);
+
+		/// \brief Tells the next flush of the active batcher why it happens. Call right before Canvas::flush().
+		void set_flush_cause(BatchFlushCause cause) { flush_cause = cause; }
+
+		/// \brief Counts a flush. A cause set by set_flush_cause() takes precedence over the given one.
+		void count_flush(BatchFlushCause cause);
+
+		/// \brief Forgets a cause set by set_flush_cause() when the flush had nothing to draw
+		void clear_flush_cause() { flush_cause = batch_flush_state_change; }
+
+		/// \brief Counts data sent to the GPU outside upload_vertices()
+		void count_upload(int num_vertices, int bytes) { stats.vertices += num_vertices; stats.bytes_uploaded += bytes; }
+
+		CanvasBatchStats stats;
+
+		/// \brief Gradient stops baked by the triangle and path batchers
+		GradientAtlas gradient_atlas;
+
 		Texture2D get_texture_rgba32f(GraphicContext &gc);
 		Texture2D get_texture_r8(GraphicContext &gc);
 		TransferTexture get_transfer_rgba32f(GraphicContext &gc);
 
 		TransferTexture get_transfer_r8(GraphicContext &gc, int &out_index);
-		static const int num_vertex_buffers = 4;
 		enum { vertex_buffer_size = 1024 * 1024 };
+		enum { vertex_ring_size = 3 * vertex_buffer_size };
 		char buffer[vertex_buffer_size];
 
 		static const int rgba32f_width = 512;	// *** If changing this, remember to modify the path shaders ***
@@ -60,8 +97,10 @@ namespace clan
 		static const int num_r8_buffers = 2;
 
 	private:
-		VertexArrayBuffer vertex_buffers[num_vertex_buffers];
-		int current_vertex_buffer = 0;
+		BatchFlushCause flush_cause = batch_flush_state_change;
+
+		VertexArrayBuffer vertex_ring;
+		int vertex_ring_position = 0;
 
 		Texture2D textures_rgba32f[num_rgba32f_buffers];
 		int current_rgba32f_texture = 0;
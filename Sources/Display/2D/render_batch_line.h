@@ -60,7 +60,7 @@ namespace clan
 		enum { max_vertices = RenderBatchBuffer::vertex_buffer_size / sizeof(LineVertex) };
 		LineVertex *vertices;
 		RenderBatchBuffer *batch_buffer;
-		PrimitivesArray prim_array[RenderBatchBuffer::num_vertex_buffers];
+		PrimitivesArray prim_array;
 		int position;
 		Mat4f modelview_projection_matrix;
 	};
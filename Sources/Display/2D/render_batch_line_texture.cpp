@@ -76,7 +76,10 @@ namespace clan
 	void RenderBatchLineTexture::set_batcher_active(Canvas &canvas, int num_vertices, const Texture2D &texture)
 	{
 		if (position + num_vertices > max_vertices)
+		{
+			batch_buffer->set_flush_cause(batch_flush_buffer_full);
 			canvas.flush();
+		}
 
 		if (num_vertices > max_vertices)
 			throw Exception("Too many vertices for RenderBatchLineTexture");
@@ -85,7 +88,10 @@ namespace clan
 		if (!current_texture.is_null())
 		{
 			if (current_texture != texture)
+			{
+				batch_buffer->set_flush_cause(batch_flush_texture_limit);
 				canvas.flush();
+			}
 		}
 
 		current_texture = texture;
@@ -99,23 +105,23 @@ namespace clan
 		{
 			gc.set_program_object(program_single_texture);
 
-			int gpu_index;
-			VertexArrayVector<LineTextureVertex> gpu_vertices(batch_buffer->get_vertex_buffer(gc, gpu_index));
-
-			if (prim_array[gpu_index].is_null())
+			if (prim_array.is_null())
 			{
-				prim_array[gpu_index] = PrimitivesArray(gc);
-				prim_array[gpu_index].set_attributes(0, gpu_vertices, cl_offsetof(LineTextureVertex, position));
-				prim_array[gpu_index].set_attributes(1, gpu_vertices, cl_offsetof(LineTextureVertex, color));
-				prim_array[gpu_index].set_attributes(2, gpu_vertices, cl_offsetof(LineTextureVertex, texcoord));
+				VertexArrayVector<LineTextureVertex> gpu_vertices(batch_buffer->get_vertex_buffer());
+				prim_array = PrimitivesArray(gc);
+				prim_array.set_attributes(0, gpu_vertices, cl_offsetof(LineTextureVertex, position));
+				prim_array.set_attributes(1, gpu_vertices, cl_offsetof(LineTextureVertex, color));
+				prim_array.set_attributes(2, gpu_vertices, cl_offsetof(LineTextureVertex, texcoord));
 			}
 
 
-			gpu_vertices.upload_data(gc, 0, vertices, position);
+			int first_vertex = batch_buffer->upload_vertices(gc, vertices, sizeof(LineTextureVertex), position);
 
 			gc.set_texture(0, current_texture);
 
-			gc.draw_primitives(type_lines, position, prim_array[gpu_index]);
+			gc.set_primitives_array(prim_array);
+			gc.draw_primitives_array(type_lines, first_vertex, position);
+			gc.reset_primitives_array();
 
 			gc.reset_program_object();
 
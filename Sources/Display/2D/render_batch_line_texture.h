@@ -61,7 +61,7 @@ namespace clan
 		LineTextureVertex *vertices;
 		RenderBatchBuffer *batch_buffer;
 
-		PrimitivesArray prim_array[RenderBatchBuffer::num_vertex_buffers];
+		PrimitivesArray prim_array;
 		int position = 0;
 		Mat4f modelview_projection_matrix;
 		Texture2D current_texture;
@@ -42,13 +42,6 @@ namespace clan
 	{
 	}
 
-	inline Pointf RenderBatchPath::to_position(const clan::Pointf &point) const
-	{
-		return Pointf(
-			modelview_matrix.matrix[0 * 4 + 0] * point.x + modelview_matrix.matrix[1 * 4 + 0] * point.y + modelview_matrix.matrix[3 * 4 + 0],
-			modelview_matrix.matrix[0 * 4 + 1] * point.x + modelview_matrix.matrix[1 * 4 + 1] * point.y + modelview_matrix.matrix[3 * 4 + 1]);
-	}
-
 	void RenderBatchPath::fill(Canvas &canvas, const Path &path, const Brush &brush)
 	{
 		canvas.set_batcher(this);
@@ -81,41 +74,16 @@ namespace clan
 
 	void RenderBatchPath::render(const Path &path, PathRenderer *path_renderer)
 	{
-		for (const auto &subpath : path.get_impl()->subpaths)
-		{
-			clan::Pointf start_point = to_position(subpath.points[0]);
-			path_renderer->begin(start_point.x, start_point.y);
-
-			size_t i = 1;
-			for (PathCommand command : subpath.commands)
-			{
-				if (command == PathCommand::line)
-				{
-					clan::Pointf next_point = to_position(subpath.points[i]);
-					i++;
+		PathFlattenCache &cache = path.get_impl()->flatten_cache;
+		cache.update(*path.get_impl(), modelview_matrix);
 
-					path_renderer->line(next_point.x, next_point.y);
-				}
-				else if (command == PathCommand::quadradic)
-				{
-					clan::Pointf control = to_position(subpath.points[i]);
-					clan::Pointf next_point = to_position(subpath.points[i + 1]);
-					i += 2;
-
-					path_renderer->quadratic_bezier(control.x, control.y, next_point.x, next_point.y);
-				}
-				else if (command == PathCommand::cubic)
-				{
-					clan::Pointf control1 = to_position(subpath.points[i]);
-					clan::Pointf control2 = to_position(subpath.points[i + 1]);
-					clan::Pointf next_point = to_position(subpath.points[i + 2]);
-					i += 3;
-
-					path_renderer->cubic_bezier(control1.x, control1.y, control2.x, control2.y, next_point.x, next_point.y);
-				}
-			}
-
-			path_renderer->end(subpath.closed);
+		for (const auto &polyline : cache.polylines)
+		{
+			const Pointf *points = &cache.transformed_points[polyline.first_point];
+			path_renderer->begin(points[0].x, points[0].y);
+			for (int i = 1; i < polyline.num_points; i++)
+				path_renderer->line(points[i].x, points[i].y);
+			path_renderer->end(polyline.closed);
 		}
 	}
 }
@@ -60,8 +60,6 @@ namespace clan
 		void flush(GraphicContext &gc) override;
 		void matrix_changed(const Mat4f &modelview, const Mat4f &projection, TextureImageYAxis image_yaxis, float pixel_ratio) override;
 
-		inline Pointf to_position(const clan::Pointf &point) const;
-
 		Mat4f modelview_matrix;
 		RenderBatchBuffer *batch_buffer;
 
@@ -65,7 +65,10 @@ namespace clan
 	void RenderBatchPoint::set_batcher_active(Canvas &canvas, int num_vertices)
 	{
 		if (position + num_vertices > max_vertices)
+		{
+			batch_buffer->set_flush_cause(batch_flush_buffer_full);
 			canvas.flush();
+		}
 
 		if (num_vertices > max_vertices)
 			throw Exception("Too many vertices for RenderBatchPoint");
@@ -79,19 +82,19 @@ namespace clan
 		{
 			gc.set_program_object(program_color_only);
 
-			int gpu_index;
-			VertexArrayVector<PointVertex> gpu_vertices(batch_buffer->get_vertex_buffer(gc, gpu_index));
-
-			if (prim_array[gpu_index].is_null())
+			if (prim_array.is_null())
 			{
-				prim_array[gpu_index] = PrimitivesArray(gc);
-				prim_array[gpu_index].set_attributes(0, gpu_vertices, cl_offsetof(PointVertex, position));
-				prim_array[gpu_index].set_attributes(1, gpu_vertices, cl_offsetof(PointVertex, color));
+				VertexArrayVector<PointVertex> gpu_vertices(batch_buffer->get_vertex_buffer());
+				prim_array = PrimitivesArray(gc);
+				prim_array.set_attributes(0, gpu_vertices, cl_offsetof(PointVertex, position));
+				prim_array.set_attributes(1, gpu_vertices, cl_offsetof(PointVertex, color));
 			}
 
-			gpu_vertices.upload_data(gc, 0, vertices, position);
+			int first_vertex = batch_buffer->upload_vertices(gc, vertices, sizeof(PointVertex), position);
 
-			gc.draw_primitives(type_points, position, prim_array[gpu_index]);
+			gc.set_primitives_array(prim_array);
+			gc.draw_primitives_array(type_points, first_vertex, position);
+			gc.reset_primitives_array();
 
 			gc.reset_program_object();
 
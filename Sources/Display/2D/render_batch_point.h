@@ -59,7 +59,7 @@ namespace clan
 		enum { max_vertices = RenderBatchBuffer::vertex_buffer_size / sizeof(PointVertex) };
 		PointVertex *vertices;
 		RenderBatchBuffer *batch_buffer;
-		PrimitivesArray prim_array[RenderBatchBuffer::num_vertex_buffers];
+		PrimitivesArray prim_array;
 		int position = 0;
 		Mat4f modelview_projection_matrix;
 	};
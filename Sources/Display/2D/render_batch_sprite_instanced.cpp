@@ -0,0 +1,179 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+**    Mark Page
+*/
+
+#include "Display/precomp.h"
+#include "render_batch_sprite_instanced.h"
+#include "API/Display/2D/canvas.h"
+#include "API/Display/Image/pixel_buffer.h"
+#include "API/Core/Math/quad.h"
+#include <cmath>
+
+namespace clan
+{
+	bool RenderBatchSpriteInstanced::instancing_supported = false;
+
+	RenderBatchSpriteInstanced::RenderBatchSpriteInstanced(GraphicContext &gc, RenderBatchBuffer *batch_buffer)
+		: batch_buffer(batch_buffer)
+	{
+		instances = (SpriteInstance *)batch_buffer->buffer;
+	}
+
+	bool RenderBatchSpriteInstanced::is_supported(const Mat4f &modelview_projection)
+	{
+		// The corners are calculated in clip space, which needs w to stay 1 and z to stay constant
+		const float *m = modelview_projection.matrix;
+		return instancing_supported && m[0 * 4 + 3] == 0.0f && m[1 * 4 + 3] == 0.0f && m[3 * 4 + 3] == 1.0f && m[0 * 4 + 2] == 0.0f && m[1 * 4 + 2] == 0.0f;
+	}
+
+	bool RenderBatchSpriteInstanced::is_parallelogram(const Quadf &quad)
+	{
+		const float epsilon = 0.001f;
+		Vec2f r = quad.q + quad.s - quad.p;
+		return std::abs(r.x - quad.r.x) < epsilon && std::abs(r.y - quad.r.y) < epsilon;
+	}
+
+	void RenderBatchSpriteInstanced::draw_sprite(Canvas &canvas, const Pointf texture_position[4], const Pointf dest_position[4], const Texture2D &texture, const Colorf &color)
+	{
+		int texindex = set_batcher_active(canvas, texture);
+		Vec4f texcoords(texture_position[0].x, texture_position[0].y, texture_position[3].x, texture_position[3].y);
+		add_instance(dest_position[0], dest_position[1], dest_position[2], texcoords, texindex, color);
+	}
+
+	void RenderBatchSpriteInstanced::draw_image(Canvas &canvas, const Rectf &src, const Quadf &dest, const Colorf &color, const Texture2D &texture)
+	{
+		int texindex = set_batcher_active(canvas, texture);
+		Vec4f texcoords(
+			src.left / tex_sizes[texindex].width,
+			src.top / tex_sizes[texindex].height,
+			src.right / tex_sizes[texindex].width,
+			src.bottom / tex_sizes[texindex].height);
+		add_instance(dest.p, dest.q, dest.s, texcoords, texindex, color);
+	}
+
+	void RenderBatchSpriteInstanced::add_instance(const Vec2f &p, const Vec2f &q, const Vec2f &s, const Vec4f &texcoords, int texindex, const Colorf &color)
+	{
+		Vec4f clip_p = to_position(p.x, p.y);
+		Vec4f clip_q = to_position(q.x, q.y);
+		Vec4f clip_s = to_position(s.x, s.y);
+
+		SpriteInstance &instance = instances[position++];
+		instance.position = Vec4f(clip_p.x, clip_p.y, clip_p.z, (float)texindex);
+		instance.axes = Vec4f(clip_q.x - clip_p.x, clip_q.y - clip_p.y, clip_s.x - clip_p.x, clip_s.y - clip_p.y);
+		instance.texcoords = texcoords;
+		instance.color = Vec4f(color.r, color.g, color.b, color.a);
+	}
+
+	inline Vec4f RenderBatchSpriteInstanced::to_position(float x, float y) const
+	{
+		return Vec4f(
+			modelview_projection_matrix.matrix[0 * 4 + 0] * x + modelview_projection_matrix.matrix[1 * 4 + 0] * y + modelview_projection_matrix.matrix[3 * 4 + 0],
+			modelview_projection_matrix.matrix[0 * 4 + 1] * x + modelview_projection_matrix.matrix[1 * 4 + 1] * y + modelview_projection_matrix.matrix[3 * 4 + 1],
+			modelview_projection_matrix.matrix[0 * 4 + 2] * x + modelview_projection_matrix.matrix[1 * 4 + 2] * y + modelview_projection_matrix.matrix[3 * 4 + 2],
+			modelview_projection_matrix.matrix[0 * 4 + 3] * x + modelview_projection_matrix.matrix[1 * 4 + 3] * y + modelview_projection_matrix.matrix[3 * 4 + 3]);
+	}
+
+	int RenderBatchSpriteInstanced::set_batcher_active(Canvas &canvas, const Texture2D &texture)
+	{
+		int texindex = -1;
+		for (int i = 0; i < num_current_textures; i++)
+		{
+			if (current_textures[i] == texture)
+			{
+				texindex = i;
+				break;
+			}
+		}
+		if (texindex == -1 && num_current_textures < max_textures)
+		{
+			texindex = num_current_textures;
+			current_textures[num_current_textures++] = texture;
+			tex_sizes[texindex] = Sizef((float)texture.get_width(), (float)texture.get_height());
+		}
+
+		if (position == 0 || position + 1 > max_instances || texindex == -1)
+		{
+			batch_buffer->set_flush_cause(position == 0 ? batch_flush_batcher_switch : texindex == -1 ? batch_flush_texture_limit : batch_flush_buffer_full);
+			canvas.flush();
+			texindex = 0;
+			current_textures[texindex] = texture;
+			num_current_textures = 1;
+			tex_sizes[texindex] = Sizef((float)texture.get_width(), (float)texture.get_height());
+		}
+		canvas.set_batcher(this);
+		return texindex;
+	}
+
+	void RenderBatchSpriteInstanced::flush(GraphicContext &gc)
+	{
+		if (position > 0)
+		{
+			gc.set_program_object(program_sprite_instanced);
+
+			if (prim_array.is_null())
+				prim_array = PrimitivesArray(gc);
+
+			// Alternate between the textures so the upload does not wait for the previous draw
+			current_instance_texture = (current_instance_texture + 1) % num_instance_textures;
+			Texture2D &instance_texture = instance_textures[current_instance_texture];
+			if (instance_texture.is_null())
+			{
+				instance_texture = Texture2D(gc, instance_texture_width, instance_texture_height, tf_rgba32f);
+				instance_texture.set_min_filter(filter_nearest);
+				instance_texture.set_mag_filter(filter_nearest);
+			}
+
+			const int texels_per_instance = sizeof(SpriteInstance) / sizeof(Vec4f);
+			int rows = (position * texels_per_instance + instance_texture_width - 1) / instance_texture_width;
+			PixelBuffer instance_data(instance_texture_width, rows, tf_rgba32f, instances, true);
+			instance_texture.set_subimage(gc, 0, 0, instance_data, Rect(0, 0, instance_texture_width, rows));
+			batch_buffer->count_upload(position * 6, rows * instance_texture_width * sizeof(Vec4f));
+
+			for (int i = 0; i < num_current_textures; i++)
+				gc.set_texture(i, current_textures[i]);
+			gc.set_texture(max_textures, instance_texture);
+
+			gc.set_primitives_array(prim_array);
+			gc.draw_primitives_array_instanced(type_triangles, 0, 6, position);
+			gc.reset_primitives_array();
+
+			for (int i = 0; i < num_current_textures; i++)
+				gc.reset_texture(i);
+			gc.reset_texture(max_textures);
+
+			gc.reset_program_object();
+
+			position = 0;
+		}
+	}
+
+	void RenderBatchSpriteInstanced::matrix_changed(const Mat4f &new_modelview, const Mat4f &new_projection, TextureImageYAxis image_yaxis, float pixel_ratio)
+	{
+		modelview_projection_matrix = new_projection * new_modelview;
+	}
+}
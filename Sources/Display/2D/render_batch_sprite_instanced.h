@@ -0,0 +1,100 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+**    Mark Page
+*/
+
+#pragma once
+
+#include "API/Display/Render/render_batcher.h"
+#include "API/Display/Render/texture.h"
+#include "API/Display/Render/graphic_context.h"
+#include "API/Display/Render/texture_2d.h"
+#include "render_batch_buffer.h"
+
+namespace clan
+{
+	class RenderBatchBuffer;
+	class Quadf;
+
+	/// \brief Draws textured quads as instances, uploading one record per quad instead of six vertices
+	///
+	/// The vertex shader builds each quad from a corner and two edges, so only parallelograms can be drawn.
+	class RenderBatchSpriteInstanced : public RenderBatcher
+	{
+	public:
+		RenderBatchSpriteInstanced(GraphicContext &gc, RenderBatchBuffer *batch_buffer);
+
+		/// \brief Returns true if quads drawn with this transform can be instanced
+		static bool is_supported(const Mat4f &modelview_projection);
+
+		/// \brief Returns true if the quad is a parallelogram
+		static bool is_parallelogram(const Quadf &quad);
+
+		void draw_sprite(Canvas &canvas, const Pointf texture_position[4], const Pointf dest_position[4], const Texture2D &texture, const Colorf &color);
+		void draw_image(Canvas &canvas, const Rectf &src, const Quadf &dest, const Colorf &color, const Texture2D &texture);
+
+		static bool instancing_supported;	// Set by targets providing program_sprite_instanced
+
+	private:
+		struct SpriteInstance
+		{
+			Vec4f position;	// Clip space x, y and z of the first corner, texture index in w
+			Vec4f axes;	// Clip space edges from the first corner to the second and third corner
+			Vec4f texcoords;	// Texture rectangle
+			Vec4f color;
+		};
+
+		int set_batcher_active(Canvas &canvas, const Texture2D &texture);
+		void add_instance(const Vec2f &p, const Vec2f &q, const Vec2f &s, const Vec4f &texcoords, int texindex, const Colorf &color);
+		void flush(GraphicContext &gc) override;
+		void matrix_changed(const Mat4f &modelview, const Mat4f &projection, TextureImageYAxis image_yaxis, float pixel_ratio) override;
+
+		inline Vec4f to_position(float x, float y) const;
+
+		enum { max_instances = RenderBatchBuffer::vertex_buffer_size / sizeof(SpriteInstance) };
+		enum { instance_texture_width = 1024 };	// *** If changing this, remember to modify the instanced sprite shader ***
+		enum { instance_texture_height = RenderBatchBuffer::vertex_buffer_size / (instance_texture_width * sizeof(Vec4f)) };
+		enum { num_instance_textures = 2 };
+
+		// The instance data texture uses the unit of the last sprite texture
+		static const int max_textures = 15;
+
+		Mat4f modelview_projection_matrix;
+		int position = 0;
+		SpriteInstance *instances;
+
+		RenderBatchBuffer *batch_buffer;
+		PrimitivesArray prim_array;
+
+		Texture2D instance_textures[num_instance_textures];
+		int current_instance_texture = 0;
+
+		Texture2D current_textures[max_textures];
+		int num_current_textures = 0;
+		Sizef tex_sizes[max_textures];
+	};
+}
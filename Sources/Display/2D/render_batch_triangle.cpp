@@ -30,6 +30,8 @@
 #include "Display/precomp.h"
 #include "render_batch_triangle.h"
 #include "sprite_impl.h"
+#include "canvas_static_batch_impl.h"
+#include "canvas_impl.h"
 #include "API/Display/Render/blend_state_description.h"
 #include "API/Display/2D/canvas.h"
 #include "API/Core/Math/quad.h"
@@ -39,6 +41,10 @@ namespace clan
 	// For use by the GL1 target, so it can reduce the number of textures. Now also used by the GL3 target to increase the number. Global vars should be banned!
 	// Warning: Ensure this number does not exceed RenderBatchTriangle::max_number_of_texture_coords
 	int RenderBatchTriangle::max_textures = 4;
+	bool RenderBatchTriangle::texture_arrays_supported = false;
+	bool RenderBatchTriangle::static_batches_supported = false;
+	bool RenderBatchTriangle::distance_fields_supported = false;
+	bool RenderBatchTriangle::dual_source_blending_supported = false;
 
 	RenderBatchTriangle::RenderBatchTriangle(GraphicContext &gc, RenderBatchBuffer *batch_buffer)
 		: batch_buffer(batch_buffer)
@@ -65,7 +71,7 @@ namespace clan
 
 		for (; num_vertices > 0; num_vertices--)
 		{
-			vertices[position].color = (*(triangle_colors++));
+			vertices[position].color = to_color(*(triangle_colors++));
 			vertices[position].position = to_position(triangle_positions->x, triangle_positions->y);
 			triangle_positions++;
 			vertices[position].texcoord = Vec2f(0.0f, 0.0f);
@@ -77,11 +83,11 @@ namespace clan
 	void RenderBatchTriangle::fill_triangle(Canvas &canvas, const Vec2f *triangle_positions, const Colorf &color, int num_vertices)
 	{
 		int texindex = set_batcher_active(canvas, num_vertices);
-
+		Vec4ub vertex_color = to_color(color);
 
 		for (; num_vertices > 0; num_vertices--)
 		{
-			vertices[position].color = color;
+			vertices[position].color = vertex_color;
 			vertices[position].position = to_position(triangle_positions->x, triangle_positions->y);
 			triangle_positions++;
 			vertices[position].texcoord = Vec2f(0.0f, 0.0f);
@@ -93,10 +99,11 @@ namespace clan
 	void RenderBatchTriangle::fill_triangles(Canvas &canvas, const Vec2f *positions, const Vec2f *texture_positions, int num_vertices, const Texture2D &texture, const Colorf &color)
 	{
 		int texindex = set_batcher_active(canvas, texture);
+		Vec4ub vertex_color = to_color(color);
 
 		for (; num_vertices > 0; num_vertices--)
 		{
-			vertices[position].color = color;
+			vertices[position].color = vertex_color;
 			vertices[position].position = to_position(positions->x, positions->y);
 			positions++;
 			vertices[position].texcoord = *(texture_positions++);
@@ -112,7 +119,7 @@ namespace clan
 
 		for (; num_vertices > 0; num_vertices--)
 		{
-			vertices[position].color = *(colors++);
+			vertices[position].color = to_color(*(colors++));
 			vertices[position].position = to_position(positions->x, positions->y);
 			positions++;
 			vertices[position].texcoord = *(texture_positions++);
@@ -124,7 +131,7 @@ namespace clan
 	inline void RenderBatchTriangle::to_sprite_vertex(const Pointf &texture_position, const Pointf &dest_position, RenderBatchTriangle::SpriteVertex &v, int texindex, const Colorf &color) const
 	{
 		v.position = to_position(dest_position.x, dest_position.y);
-		v.color = color;
+		v.color = to_color(color);
 		v.texcoord = texture_position;
 		v.texindex = texindex;
 	}
@@ -149,9 +156,10 @@ namespace clan
 		vertices[position + 3].texcoord = Vec2f(src_right, src_top);
 		vertices[position + 4].texcoord = Vec2f(src_right, src_bottom);
 		vertices[position + 5].texcoord = Vec2f(src_left, src_bottom);
+		Vec4ub vertex_color = to_color(color);
 		for (int i = 0; i < 6; i++)
 		{
-			vertices[position + i].color = Vec4f(color.r, color.g, color.b, color.a);
+			vertices[position + i].color = vertex_color;
 			vertices[position + i].texindex = texindex;
 		}
 		position += 6;
@@ -177,9 +185,45 @@ namespace clan
 		vertices[position + 3].texcoord = Vec2f(src_right, src_top);
 		vertices[position + 4].texcoord = Vec2f(src_right, src_bottom);
 		vertices[position + 5].texcoord = Vec2f(src_left, src_bottom);
+		Vec4ub vertex_color = to_color(color);
+		for (int i = 0; i < 6; i++)
+		{
+			vertices[position + i].color = vertex_color;
+			vertices[position + i].texindex = texindex;
+		}
+		position += 6;
+	}
+
+	void RenderBatchTriangle::draw_image(Canvas &canvas, const Rectf &src, const Rectf &dest, const Colorf &color, const Texture2DArray &texture, int layer)
+	{
+		draw_image(canvas, src, Quadf(dest), color, texture, layer);
+	}
+
+	void RenderBatchTriangle::draw_image(Canvas &canvas, const Rectf &src, const Quadf &dest, const Colorf &color, const Texture2DArray &texture, int layer)
+	{
+		int texindex = set_batcher_active(canvas, texture, layer);
+		int slot = texindex % max_number_of_texture_coords;
+
+		vertices[position + 0].position = to_position(dest.p.x, dest.p.y);
+		vertices[position + 1].position = to_position(dest.q.x, dest.q.y);
+		vertices[position + 2].position = to_position(dest.s.x, dest.s.y);
+		vertices[position + 3].position = to_position(dest.q.x, dest.q.y);
+		vertices[position + 4].position = to_position(dest.r.x, dest.r.y);
+		vertices[position + 5].position = to_position(dest.s.x, dest.s.y);
+		float src_left = (src.left) / tex_sizes[slot].width;
+		float src_top = (src.top) / tex_sizes[slot].height;
+		float src_right = (src.right) / tex_sizes[slot].width;
+		float src_bottom = (src.bottom) / tex_sizes[slot].height;
+		vertices[position + 0].texcoord = Vec2f(src_left, src_top);
+		vertices[position + 1].texcoord = Vec2f(src_right, src_top);
+		vertices[position + 2].texcoord = Vec2f(src_left, src_bottom);
+		vertices[position + 3].texcoord = Vec2f(src_right, src_top);
+		vertices[position + 4].texcoord = Vec2f(src_right, src_bottom);
+		vertices[position + 5].texcoord = Vec2f(src_left, src_bottom);
+		Vec4ub vertex_color = to_color(color);
 		for (int i = 0; i < 6; i++)
 		{
-			vertices[position + i].color = Vec4f(color.r, color.g, color.b, color.a);
+			vertices[position + i].color = vertex_color;
 			vertices[position + i].texindex = texindex;
 		}
 		position += 6;
@@ -187,7 +231,38 @@ namespace clan
 
 	void RenderBatchTriangle::draw_glyph_subpixel(Canvas &canvas, const Rectf &src, const Rectf &dest, const Colorf &color, const Texture2D &texture)
 	{
-		int texindex = set_batcher_active(canvas, texture, true, color);
+		// With dual source blending the glyph joins the batch of the surrounding images, unless the blend state was changed
+		bool single_pass = dual_source_blending_supported && !capture && !canvas.impl->custom_blend_state;
+		int texindex = single_pass ? set_batcher_active(canvas, texture, false, Colorf::black, false, true) : set_batcher_active(canvas, texture, true, color);
+
+		vertices[position + 0].position = to_position(dest.left, dest.top);
+		vertices[position + 1].position = to_position(dest.right, dest.top);
+		vertices[position + 2].position = to_position(dest.left, dest.bottom);
+		vertices[position + 3].position = to_position(dest.right, dest.top);
+		vertices[position + 4].position = to_position(dest.right, dest.bottom);
+		vertices[position + 5].position = to_position(dest.left, dest.bottom);
+		float src_left = (src.left) / tex_sizes[texindex].width;
+		float src_top = (src.top) / tex_sizes[texindex].height;
+		float src_right = (src.right) / tex_sizes[texindex].width;
+		float src_bottom = (src.bottom) / tex_sizes[texindex].height;
+		vertices[position + 0].texcoord = Vec2f(src_left, src_top);
+		vertices[position + 1].texcoord = Vec2f(src_right, src_top);
+		vertices[position + 2].texcoord = Vec2f(src_left, src_bottom);
+		vertices[position + 3].texcoord = Vec2f(src_right, src_top);
+		vertices[position + 4].texcoord = Vec2f(src_right, src_bottom);
+		vertices[position + 5].texcoord = Vec2f(src_left, src_bottom);
+		Vec4ub vertex_color = single_pass ? to_color(color) : Vec4ub(255, 255, 255, 255);
+		for (int i = 0; i < 6; i++)
+		{
+			vertices[position + i].color = vertex_color;
+			vertices[position + i].texindex = single_pass ? texindex + dual_source_glyph_flag : texindex;
+		}
+		position += 6;
+	}
+
+	void RenderBatchTriangle::draw_glyph_distance_field(Canvas &canvas, const Rectf &src, const Rectf &dest, const Colorf &color, const Texture2D &texture)
+	{
+		int texindex = set_batcher_active(canvas, texture, false, Colorf::black, true);
 
 		vertices[position + 0].position = to_position(dest.left, dest.top);
 		vertices[position + 1].position = to_position(dest.right, dest.top);
@@ -205,9 +280,10 @@ namespace clan
 		vertices[position + 3].texcoord = Vec2f(src_right, src_top);
 		vertices[position + 4].texcoord = Vec2f(src_right, src_bottom);
 		vertices[position + 5].texcoord = Vec2f(src_left, src_bottom);
+		Vec4ub vertex_color = to_color(color);
 		for (int i = 0; i < 6; i++)
 		{
-			vertices[position + i].color = Vec4f(1.0f, 1.0f, 1.0f, 1.0f);
+			vertices[position + i].color = vertex_color;
 			vertices[position + i].texindex = texindex;
 		}
 		position += 6;
@@ -223,15 +299,71 @@ namespace clan
 		vertices[position + 3].position = to_position(x2, y1);
 		vertices[position + 4].position = to_position(x2, y2);
 		vertices[position + 5].position = to_position(x1, y2);
+		Vec4ub vertex_color = to_color(color);
 		for (int i = 0; i < 6; i++)
 		{
-			vertices[position + i].color = Vec4f(color.r, color.g, color.b, color.a);
+			vertices[position + i].color = vertex_color;
 			vertices[position + i].texcoord = Vec2f(0.0f, 0.0f);
 			vertices[position + i].texindex = texindex;
 		}
 		position += 6;
 	}
 
+	bool RenderBatchTriangle::fill_triangles(Canvas &canvas, const Vec2f *positions, int num_vertices, const Brush &brush)
+	{
+		if (brush.type == BrushType::solid)
+		{
+			fill_triangle(canvas, positions, brush.color, num_vertices);
+			return true;
+		}
+
+		// Atlas rows are replaced once it is full, so a static batch cannot refer to them
+		if (brush.type != BrushType::linear || capture)
+			return false;
+
+		GradientAtlas &atlas = batch_buffer->gradient_atlas;
+		int row = atlas.get_row(canvas.get_gc(), brush.stops);
+		if (row == -1)
+		{
+			batch_buffer->set_flush_cause(batch_flush_texture_limit);
+			canvas.flush();
+			atlas.clear();
+			row = atlas.get_row(canvas.get_gc(), brush.stops);
+		}
+
+		// The gradient position is measured after the canvas transform, like the path renderer does.
+		// It is an affine function of the vertex position, so interpolating it between the vertices is exact.
+		const Mat4f &transform = canvas.get_transform();
+		Vec4f start = transform * Vec4f(brush.transform * brush.start_point, 0.0f, 1.0f);
+		Vec4f end = transform * Vec4f(brush.transform * brush.end_point, 0.0f, 1.0f);
+		Vec2f dir(end.x - start.x, end.y - start.y);
+		float rcp_length2 = 1.0f / Vec2f::dot(dir, dir);
+		float u_scale = GradientAtlas::get_u_scale() * rcp_length2;
+		float u_offset = GradientAtlas::get_u_offset();
+		float v = GradientAtlas::get_v(row);
+
+		Texture2D texture = atlas.get_texture();
+		while (num_vertices > 0)
+		{
+			int texindex = set_batcher_active(canvas, texture);
+			int count = min(num_vertices, 6);
+			for (int i = 0; i < count; i++)
+			{
+				Vec4f pos = transform * Vec4f(positions->x, positions->y, 0.0f, 1.0f);
+				float t = (pos.x - start.x) * dir.x + (pos.y - start.y) * dir.y;
+
+				vertices[position].color = Vec4ub(255, 255, 255, 255);
+				vertices[position].position = to_position(positions->x, positions->y);
+				vertices[position].texcoord = Vec2f(t * u_scale + u_offset, v);
+				vertices[position].texindex = texindex;
+				positions++;
+				position++;
+			}
+			num_vertices -= count;
+		}
+		return true;
+	}
+
 	inline Vec4f RenderBatchTriangle::to_position(float x, float y) const
 	{
 		return Vec4f(
@@ -242,13 +374,25 @@ namespace clan
 	}
 
 
-	int RenderBatchTriangle::set_batcher_active(Canvas &canvas, const Texture2D &texture, bool glyph_program, const Colorf &new_constant_color)
+	inline Vec4ub RenderBatchTriangle::to_color(const Vec4f &color)
 	{
-		if (use_glyph_program != glyph_program || constant_color != new_constant_color)
+		return Vec4ub(
+			(unsigned char)(clamp(color.r, 0.0f, 1.0f) * 255.0f + 0.5f),
+			(unsigned char)(clamp(color.g, 0.0f, 1.0f) * 255.0f + 0.5f),
+			(unsigned char)(clamp(color.b, 0.0f, 1.0f) * 255.0f + 0.5f),
+			(unsigned char)(clamp(color.a, 0.0f, 1.0f) * 255.0f + 0.5f));
+	}
+
+	int RenderBatchTriangle::set_batcher_active(Canvas &canvas, const Texture2D &texture, bool glyph_program, const Colorf &new_constant_color, bool distance_field_program, bool dual_source_program)
+	{
+		// The dual source program also draws plain images, so switching to it does not need a flush
+		if (use_glyph_program != glyph_program || constant_color != new_constant_color || use_array_program || use_distance_field_program != distance_field_program)
 		{
 			canvas.flush();
 			use_glyph_program = glyph_program;
 			constant_color = new_constant_color;
+			use_array_program = false;
+			use_distance_field_program = distance_field_program;
 		}
 
 		int texindex = -1;
@@ -269,16 +413,62 @@ namespace clan
 
 		if (position == 0 || position + 6 > max_vertices || texindex == -1)
 		{
+			batch_buffer->set_flush_cause(position == 0 ? batch_flush_batcher_switch : texindex == -1 ? batch_flush_texture_limit : batch_flush_buffer_full);
 			canvas.flush();
 			texindex = 0;
 			current_textures[texindex] = texture;
 			num_current_textures = 1;
 			tex_sizes[texindex] = Sizef((float)current_textures[texindex].get_width(), (float)current_textures[texindex].get_height());
 		}
+		if (dual_source_program)
+			use_dual_source_program = true;
 		canvas.set_batcher(this);
 		return texindex;
 	}
 
+	int RenderBatchTriangle::set_batcher_active(Canvas &canvas, const Texture2DArray &texture, int layer)
+	{
+		if (!texture_arrays_supported)
+			throw Exception("Texture arrays are not supported by this display target");
+
+		if (use_glyph_program || !use_array_program || use_distance_field_program)
+		{
+			canvas.flush();
+			use_glyph_program = false;
+			use_array_program = true;
+			use_distance_field_program = false;
+		}
+
+		// A whole array only takes one texture unit, so a batch can use any number of its layers
+		int slot = -1;
+		for (int i = 0; i < num_current_textures; i++)
+		{
+			if (current_array_textures[i] == texture)
+			{
+				slot = i;
+				break;
+			}
+		}
+		if (slot == -1 && num_current_textures < max_textures)
+		{
+			slot = num_current_textures;
+			current_array_textures[num_current_textures++] = texture;
+			tex_sizes[slot] = Sizef((float)texture.get_width(), (float)texture.get_height());
+		}
+
+		if (position == 0 || position + 6 > max_vertices || slot == -1)
+		{
+			batch_buffer->set_flush_cause(position == 0 ? batch_flush_batcher_switch : slot == -1 ? batch_flush_texture_limit : batch_flush_buffer_full);
+			canvas.flush();
+			slot = 0;
+			current_array_textures[slot] = texture;
+			num_current_textures = 1;
+			tex_sizes[slot] = Sizef((float)texture.get_width(), (float)texture.get_height());
+		}
+		canvas.set_batcher(this);
+		return slot + layer * max_number_of_texture_coords;
+	}
+
 	int RenderBatchTriangle::set_batcher_active(Canvas &canvas)
 	{
 		if (use_glyph_program != false)
@@ -288,7 +478,10 @@ namespace clan
 		}
 
 		if (position == 0 || position + 6 > max_vertices)
+		{
+			batch_buffer->set_flush_cause(position == 0 ? batch_flush_batcher_switch : batch_flush_buffer_full);
 			canvas.flush();
+		}
 		canvas.set_batcher(this);
 		return RenderBatchTriangle::max_textures;
 	}
@@ -302,7 +495,10 @@ namespace clan
 		}
 
 		if (position + num_vertices > max_vertices)
+		{
+			batch_buffer->set_flush_cause(batch_flush_buffer_full);
 			canvas.flush();
+		}
 
 		if (num_vertices > max_vertices)
 			throw Exception("Too many vertices for RenderBatchTriangle");
@@ -315,58 +511,135 @@ namespace clan
 	{
 		if (position > 0)
 		{
-			gc.set_program_object(program_sprite);
-
-			int gpu_index;
-			VertexArrayVector<SpriteVertex> gpu_vertices(batch_buffer->get_vertex_buffer(gc, gpu_index));
-
-			if (prim_array[gpu_index].is_null())
+			if (capture)
 			{
-				prim_array[gpu_index] = PrimitivesArray(gc);
-				prim_array[gpu_index].set_attributes(0, gpu_vertices, cl_offsetof(SpriteVertex, position));
-				prim_array[gpu_index].set_attributes(1, gpu_vertices, cl_offsetof(SpriteVertex, color));
-				prim_array[gpu_index].set_attributes(2, gpu_vertices, cl_offsetof(SpriteVertex, texcoord));
-				prim_array[gpu_index].set_attributes(3, gpu_vertices, cl_offsetof(SpriteVertex, texindex));
-
-				if (glyph_blend.is_null())
+				capture_segment(gc);
+			}
+			else
+			{
+				if (use_array_program)
+					gc.set_program_object(program_sprite_array);
+				else if (use_distance_field_program)
+					gc.set_program_object(program_sprite_distance_field);
+				else if (use_dual_source_program)
+					gc.set_program_object(program_sprite_dual_source);
+				else
+					gc.set_program_object(program_sprite);
+
+				if (prim_array.is_null())
 				{
-					BlendStateDescription blend_desc;
-					blend_desc.set_blend_function(blend_constant_color, blend_one_minus_src_color, blend_zero, blend_one);
-					glyph_blend = BlendState(gc, blend_desc);
+					VertexArrayVector<SpriteVertex> gpu_vertices(batch_buffer->get_vertex_buffer());
+					prim_array = PrimitivesArray(gc);
+					prim_array.set_attributes(0, gpu_vertices, cl_offsetof(SpriteVertex, position));
+					prim_array.set_attributes(1, gpu_vertices, cl_offsetof(SpriteVertex, color), true);
+					prim_array.set_attributes(2, gpu_vertices, cl_offsetof(SpriteVertex, texcoord));
+					prim_array.set_attributes(3, gpu_vertices, cl_offsetof(SpriteVertex, texindex));
+
+					if (glyph_blend.is_null())
+					{
+						BlendStateDescription blend_desc;
+						blend_desc.set_blend_function(blend_constant_color, blend_one_minus_src_color, blend_zero, blend_one);
+						glyph_blend = BlendState(gc, blend_desc);
+					}
+
+					if (dual_source_blend.is_null() && dual_source_blending_supported)
+					{
+						BlendStateDescription blend_desc;
+						blend_desc.set_blend_function(blend_one, blend_one_minus_src1_color, blend_one, blend_one_minus_src1_alpha);
+						dual_source_blend = BlendState(gc, blend_desc);
+					}
 				}
-			}
 
-			gpu_vertices.upload_data(gc, 0, vertices, position);
+				int first_vertex = batch_buffer->upload_vertices(gc, vertices, sizeof(SpriteVertex), position);
 
-			for (int i = 0; i < num_current_textures; i++)
-				gc.set_texture(i, current_textures[i]);
+				for (int i = 0; i < num_current_textures; i++)
+				{
+					if (use_array_program)
+						gc.set_texture(i, current_array_textures[i]);
+					else
+						gc.set_texture(i, current_textures[i]);
+				}
 
-			if (use_glyph_program)
-			{
-				gc.set_blend_state(glyph_blend, constant_color);
-				gc.draw_primitives(type_triangles, position, prim_array[gpu_index]);
-				gc.reset_blend_state();
-			}
-			else
-			{
-				gc.draw_primitives(type_triangles, position, prim_array[gpu_index]);
-			}
+				if (use_glyph_program)
+				{
+					gc.set_blend_state(glyph_blend, constant_color);
+					gc.set_primitives_array(prim_array);
+					gc.draw_primitives_array(type_triangles, first_vertex, position);
+					gc.reset_primitives_array();
+					gc.reset_blend_state();
+				}
+				else if (use_dual_source_program)
+				{
+					gc.set_blend_state(dual_source_blend);
+					gc.set_primitives_array(prim_array);
+					gc.draw_primitives_array(type_triangles, first_vertex, position);
+					gc.reset_primitives_array();
+					gc.reset_blend_state();
+				}
+				else
+				{
+					gc.set_primitives_array(prim_array);
+					gc.draw_primitives_array(type_triangles, first_vertex, position);
+					gc.reset_primitives_array();
+				}
 
-			for (int i = 0; i < num_current_textures; i++)
-				gc.reset_texture(i);
+				for (int i = 0; i < num_current_textures; i++)
+					gc.reset_texture(i);
 
-			gc.reset_program_object();
+				gc.reset_program_object();
+			}
 
 			position = 0;
 			for (int i = 0; i < num_current_textures; i++)
 				current_textures[i] = Texture2D();
 			num_current_textures = 0;
+			use_dual_source_program = false;
 
 		}
 	}
 
 	void RenderBatchTriangle::matrix_changed(const Mat4f &new_modelview, const Mat4f &new_projection, TextureImageYAxis image_yaxis, float pixel_ratio)
 	{
-		modelview_projection_matrix = new_projection * new_modelview;
+		// Captured vertices stay in canvas coordinates, the static batch applies the projection when it is drawn
+		modelview_projection_matrix = capture ? new_modelview : new_projection * new_modelview;
+	}
+
+	void RenderBatchTriangle::begin_capture(CanvasStaticBatch_Impl *batch)
+	{
+		capture = batch;
+	}
+
+	void RenderBatchTriangle::end_capture()
+	{
+		capture = nullptr;
+	}
+
+	void RenderBatchTriangle::capture_segment(GraphicContext &gc)
+	{
+		if (use_array_program)
+			throw Exception("Images using texture arrays can not be captured into a CanvasStaticBatch");
+		if (use_distance_field_program)
+			throw Exception("Distance field fonts can not be captured into a CanvasStaticBatch");
+
+		CanvasStaticBatch_Impl::Segment segment;
+		VertexArrayVector<SpriteVertex> gpu_vertices(gc, vertices, position, usage_static_draw);
+		segment.vertices = gpu_vertices;
+		segment.prim_array = PrimitivesArray(gc);
+		segment.prim_array.set_attributes(0, gpu_vertices, cl_offsetof(SpriteVertex, position));
+		segment.prim_array.set_attributes(1, gpu_vertices, cl_offsetof(SpriteVertex, color), true);
+		segment.prim_array.set_attributes(2, gpu_vertices, cl_offsetof(SpriteVertex, texcoord));
+		segment.prim_array.set_attributes(3, gpu_vertices, cl_offsetof(SpriteVertex, texindex));
+		segment.num_vertices = position;
+		segment.textures.assign(current_textures, current_textures + num_current_textures);
+		segment.glyph_program = use_glyph_program;
+		segment.constant_color = constant_color;
+		capture->segments.push_back(segment);
+
+		if (use_glyph_program && capture->glyph_blend.is_null())
+		{
+			BlendStateDescription blend_desc;
+			blend_desc.set_blend_function(blend_constant_color, blend_one_minus_src_color, blend_zero, blend_one);
+			capture->glyph_blend = BlendState(gc, blend_desc);
+		}
 	}
 }
@@ -34,6 +34,7 @@
 #include "API/Display/Render/blend_state.h"
 #include "API/Display/Render/render_batcher.h"
 #include "API/Display/Render/texture_2d.h"
+#include "API/Display/Render/texture_2d_array.h"
 #include "render_batch_buffer.h"
 
 namespace clan
@@ -41,6 +42,7 @@ namespace clan
 	struct Surface_DrawParams1;
 	class RenderBatchBuffer;
 	class Quadf;
+	class CanvasStaticBatch_Impl;
 
 	class RenderBatchTriangle : public RenderBatcher
 	{
@@ -49,33 +51,53 @@ namespace clan
 		void draw_sprite(Canvas &canvas, const Pointf texture_position[4], const Pointf dest_position[4], const Texture2D &texture, const Colorf &color);
 		void draw_image(Canvas &canvas, const Rectf &src, const Rectf &dest, const Colorf &color, const Texture2D &texture);
 		void draw_image(Canvas &canvas, const Rectf &src, const Quadf &dest, const Colorf &color, const Texture2D &texture);
+		void draw_image(Canvas &canvas, const Rectf &src, const Rectf &dest, const Colorf &color, const Texture2DArray &texture, int layer);
+		void draw_image(Canvas &canvas, const Rectf &src, const Quadf &dest, const Colorf &color, const Texture2DArray &texture, int layer);
 		void draw_glyph_subpixel(Canvas &canvas, const Rectf &src, const Rectf &dest, const Colorf &color, const Texture2D &texture);
+		void draw_glyph_distance_field(Canvas &canvas, const Rectf &src, const Rectf &dest, const Colorf &color, const Texture2D &texture);
 		void fill_triangle(Canvas &canvas, const Vec2f *triangle_positions, const Vec4f *triangle_colors, int num_vertices);
 		void fill_triangle(Canvas &canvas, const Vec2f *triangle_positions, const Colorf &color, int num_vertices);
 		void fill_triangles(Canvas &canvas, const Vec2f *positions, const Vec2f *texture_positions, int num_vertices, const Texture2D &texture, const Colorf &color);
 		void fill_triangles(Canvas &canvas, const Vec2f *positions, const Vec2f *texture_positions, int num_vertices, const Texture2D &texture, const Colorf *colors);
 		void fill(Canvas &canvas, float x1, float y1, float x2, float y2, const Colorf &color);
 
+		/// \brief Fills triangles with a solid or linear gradient brush, sampling gradients from the gradient atlas
+		///
+		/// \return false for brushes that must be filled as a path instead
+		bool fill_triangles(Canvas &canvas, const Vec2f *positions, int num_vertices, const Brush &brush);
+
 	public:
 		static int max_textures;	// For use by the GL1 target, so it can reduce the number of textures
+		static bool texture_arrays_supported;	// Set by targets providing program_sprite_array
+		static bool static_batches_supported;	// Set by targets providing program_sprite_static
+		static bool distance_fields_supported;	// Set by targets providing program_sprite_distance_field
+		static bool dual_source_blending_supported;	// Set by targets providing program_sprite_dual_source
+
+		/// \brief Stores the flushed triangles in the batch instead of drawing them, until end_capture is called
+		void begin_capture(CanvasStaticBatch_Impl *batch);
+		void end_capture();
+		bool is_capturing() const { return capture != nullptr; }
 
 	private:
 		struct SpriteVertex
 		{
 			Vec4f position;
 			Vec2f texcoord;
-			Vec4f color;
+			Vec4ub color;	// Normalized by the vertex attribute setup, so the shaders still see a vec4 in the 0-1 range
 			int texindex;
 		};
 
-		int set_batcher_active(Canvas &canvas, const Texture2D &texture, bool glyph_program = false, const Colorf &constant_color = Colorf::black);
+		int set_batcher_active(Canvas &canvas, const Texture2D &texture, bool glyph_program = false, const Colorf &constant_color = Colorf::black, bool distance_field_program = false, bool dual_source_program = false);
+		int set_batcher_active(Canvas &canvas, const Texture2DArray &texture, int layer);
 		int set_batcher_active(Canvas &canvas);
 		int set_batcher_active(Canvas &canvas, int num_vertices);
 		void flush(GraphicContext &gc) override;
+		void capture_segment(GraphicContext &gc);
 		void matrix_changed(const Mat4f &modelview, const Mat4f &projection, TextureImageYAxis image_yaxis, float pixel_ratio) override;
 
 		inline void to_sprite_vertex(const Pointf &texture_position, const Pointf &dest_position, RenderBatchTriangle::SpriteVertex &v, int texindex, const Colorf &color) const;
 		inline Vec4f to_position(float x, float y) const;
+		static inline Vec4ub to_color(const Vec4f &color);
 
 		Mat4f modelview_projection_matrix;
 		int position = 0;
@@ -84,15 +106,22 @@ namespace clan
 
 		RenderBatchBuffer *batch_buffer;
 
-		PrimitivesArray prim_array[RenderBatchBuffer::num_vertex_buffers];
+		PrimitivesArray prim_array;
 
 		static const int max_number_of_texture_coords = 32;
+		static const int dual_source_glyph_flag = 64;	// Added to the texture index of subpixel glyphs drawn by the dual source program
 
 		Texture2D current_textures[max_number_of_texture_coords];
+		Texture2DArray current_array_textures[max_number_of_texture_coords];	// Used instead of current_textures by the array program
 		int num_current_textures = 0;
 		Sizef tex_sizes[max_number_of_texture_coords];
 		bool use_glyph_program = false;
+		bool use_array_program = false;	// Texture index is slot + layer * max_number_of_texture_coords
+		bool use_distance_field_program = false;	// Texture alpha holds a distance field instead of coverage
+		bool use_dual_source_program = false;	// Batch contains subpixel glyphs drawn in the same pass as the images
 		Colorf constant_color;
 		BlendState glyph_blend;
+		BlendState dual_source_blend;
+		CanvasStaticBatch_Impl *capture = nullptr;
 	};
 }
@@ -82,6 +82,11 @@ namespace clan
 		impl->draw_layout(canvas);
 	}
 
+	void SpanLayout::draw_layout(Canvas &canvas, const Rect &visible_rect)
+	{
+		impl->draw_layout(canvas, visible_rect);
+	}
+
 	void SpanLayout::draw_layout_ellipsis(Canvas &canvas, const Rect &content_rect)
 	{
 		impl->draw_layout_ellipsis(canvas, content_rect);
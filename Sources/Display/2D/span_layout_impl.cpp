@@ -30,6 +30,7 @@
 #include "API/Core/Math/cl_math.h"
 #include "API/Display/2D/canvas.h"
 #include "span_layout_impl.h"
+#include <algorithm>
 
 namespace clan
 {
@@ -56,6 +57,8 @@ namespace clan
 		objects.clear();
 		text.clear();
 		lines.clear();
+		measured_blocks.clear();
+		invalidate_layout();
 	}
 
 	std::vector<Rect> SpanLayout_Impl::get_rect_by_id(int id) const
@@ -82,12 +85,27 @@ namespace clan
 	}
 
 	void SpanLayout_Impl::draw_layout(Canvas &canvas)
+	{
+		draw_lines(canvas, 0, lines.size());
+	}
+
+	void SpanLayout_Impl::draw_layout(Canvas &canvas, const Rect &visible_rect)
+	{
+		// Lines are sorted by their top position, so the visible lines can be found with binary searches
+		int visible_top = visible_rect.top - position.y;
+		int visible_bottom = visible_rect.bottom - position.y;
+		auto first = std::partition_point(lines.begin(), lines.end(), [&](const Line &line) { return line.top + line.height <= visible_top; });
+		auto end = std::partition_point(first, lines.end(), [&](const Line &line) { return line.top < visible_bottom; });
+		draw_lines(canvas, first - lines.begin(), end - lines.begin());
+	}
+
+	void SpanLayout_Impl::draw_lines(Canvas &canvas, std::vector<Line>::size_type first_line, std::vector<Line>::size_type end_line)
 	{
 		int x = position.x;
-		int y = position.y;
-		for (std::vector<Line>::size_type line_index = 0; line_index < lines.size(); line_index++)
+		for (std::vector<Line>::size_type line_index = first_line; line_index < end_line; line_index++)
 		{
 			Line &line = lines[line_index];
+			int y = position.y + line.top;
 			for (std::vector<LineSegment>::size_type segment_index = 0; segment_index < line.segments.size(); segment_index++)
 			{
 				LineSegment &segment = line.segments[segment_index];
@@ -118,8 +136,6 @@ namespace clan
 					}
 				}
 			}
-
-			y += line.height;
 		}
 	}
 
@@ -356,19 +372,39 @@ namespace clan
 
 	void SpanLayout_Impl::layout(Canvas &canvas, int max_width)
 	{
-		layout_lines(canvas, max_width);
+		std::vector<Line>::size_type first_line = layout_lines(canvas, max_width);
 
 		switch (alignment)
 		{
-		case span_right: align_right(max_width); break;
-		case span_center: align_center(max_width); break;
-		case span_justify: align_justify(max_width); break;
+		case span_right: align_right(max_width, first_line); break;
+		case span_center: align_center(max_width, first_line); break;
+		case span_justify: align_justify(max_width, first_line); break;
 		case span_left:
 		default: break;
 		}
 	}
 
 	SpanLayout_Impl::TextSizeResult SpanLayout_Impl::find_text_size(Canvas &canvas, const TextBlock &block, unsigned int object_index)
+	{
+		float pixel_ratio = canvas.get_gc().get_pixel_ratio();
+		if (measured_pixel_ratio != pixel_ratio)
+		{
+			measured_blocks.clear();
+			measured_pixel_ratio = pixel_ratio;
+		}
+
+		// Appending text can extend the last block, so the end must match too
+		auto it = measured_blocks.find(block.start);
+		if (it != measured_blocks.end() && it->second.size.end == (int)block.end && it->second.object_index == object_index)
+			return it->second.size;
+
+		MeasuredBlock &measured = measured_blocks[block.start];
+		measured.object_index = object_index;
+		measured.size = measure_text_block(canvas, block, object_index);
+		return measured.size;
+	}
+
+	SpanLayout_Impl::TextSizeResult SpanLayout_Impl::measure_text_block(Canvas &canvas, const TextBlock &block, unsigned int object_index)
 	{
 		Font font = objects[object_index].font;
 		if (layout_cache.object_index != object_index)
@@ -425,15 +461,15 @@ namespace clan
 		return result;
 	}
 
-	std::vector<SpanLayout_Impl::TextBlock> SpanLayout_Impl::find_text_blocks()
+	std::vector<SpanLayout_Impl::TextBlock> SpanLayout_Impl::find_text_blocks(std::string::size_type start_pos, std::vector<SpanObject>::size_type start_object)
 	{
 		std::vector<TextBlock> blocks;
 		std::vector<SpanObject>::iterator block_object_it;
 
 		// Find first object that is not text:
-		for (block_object_it = objects.begin(); block_object_it != objects.end() && (*block_object_it).type == object_text; ++block_object_it);
+		for (block_object_it = objects.begin() + start_object; block_object_it != objects.end() && (*block_object_it).type == object_text; ++block_object_it);
 
-		std::string::size_type pos = 0;
+		std::string::size_type pos = start_pos;
 		while (pos < text.size())
 		{
 			// Find end of text block:
@@ -497,28 +533,47 @@ namespace clan
 
 	void SpanLayout_Impl::set_align(SpanAlign align)
 	{
-		alignment = align;
+		if (alignment != align)
+		{
+			alignment = align;
+			invalidate_layout();
+		}
 	}
 
-	void SpanLayout_Impl::layout_lines(Canvas &canvas, int max_width)
+	std::vector<SpanLayout_Impl::Line>::size_type SpanLayout_Impl::layout_lines(Canvas &canvas, int max_width)
 	{
-		lines.clear();
-		if (objects.empty())
-			return;
-
 		layout_cache.metrics = FontMetrics();
 		layout_cache.object_index = -1;
 
-		CurrentLine current_line;
-		std::vector<TextBlock> blocks = find_text_blocks();
+		// Resume from the last paragraph if only text was added since the lines were laid out for this width.
+		// Blocks before the last newline block can not change, as they end before it.
+		if (layout_width != max_width || !floats_left.empty() || !floats_right.empty())
+			layout_checkpoint = LayoutCheckpoint();
+		layout_width = max_width;
+
+		std::vector<Line>::size_type first_line = layout_checkpoint.line_count;
+		lines.resize(first_line);
+		if (objects.empty())
+			return 0;
+
+		CurrentLine current_line = layout_checkpoint.current_line;
+		std::vector<TextBlock> blocks = find_text_blocks(layout_checkpoint.text_pos, current_line.object_index);
 		for (std::vector<TextBlock>::size_type block_index = 0; block_index < blocks.size(); block_index++)
 		{
+			if (is_newline(blocks[block_index]))
+			{
+				layout_checkpoint.text_pos = blocks[block_index].start;
+				layout_checkpoint.line_count = lines.size();
+				layout_checkpoint.current_line = current_line;
+			}
+
 			if (objects[current_line.object_index].type == object_text)
 				layout_text(canvas, blocks, block_index, current_line, max_width);
 			else
 				layout_block(current_line, max_width, blocks, block_index);
 		}
 		next_line(current_line);
+		return first_line;
 	}
 
 	void SpanLayout_Impl::layout_block(CurrentLine &current_line, int max_width, std::vector<TextBlock> &blocks, std::vector<TextBlock>::size_type block_index)
@@ -643,7 +698,7 @@ namespace clan
 		return true;
 	}
 
-	void SpanLayout_Impl::layout_text(Canvas &canvas, std::vector<TextBlock> blocks, std::vector<TextBlock>::size_type block_index, CurrentLine &current_line, int max_width)
+	void SpanLayout_Impl::layout_text(Canvas &canvas, const std::vector<TextBlock> &blocks, std::vector<TextBlock>::size_type block_index, CurrentLine &current_line, int max_width)
 	{
 		TextSizeResult text_size_result = find_text_size(canvas, blocks[block_index], current_line.object_index);
 		current_line.object_index += text_size_result.objects_traversed;
@@ -706,6 +761,7 @@ namespace clan
 		}
 
 		int height = current_line.cur_line.height;
+		current_line.cur_line.top = current_line.y_position;
 		lines.push_back(current_line.cur_line);
 		current_line.cur_line = Line();
 		current_line.x_position = 0;
@@ -754,11 +810,11 @@ namespace clan
 		return text_size_result.width > max_width;
 	}
 
-	void SpanLayout_Impl::align_right(int max_width)
+	void SpanLayout_Impl::align_right(int max_width, std::vector<Line>::size_type first_line)
 	{
-		for (auto & elem : lines)
+		for (auto it = lines.begin() + first_line; it != lines.end(); ++it)
 		{
-			Line &line = elem;
+			Line &line = *it;
 			int offset = max_width - line.width;
 			if (offset < 0) offset = 0;
 
@@ -770,11 +826,11 @@ namespace clan
 		}
 	}
 
-	void SpanLayout_Impl::align_center(int max_width)
+	void SpanLayout_Impl::align_center(int max_width, std::vector<Line>::size_type first_line)
 	{
-		for (auto & elem : lines)
+		for (auto it = lines.begin() + first_line; it != lines.end(); ++it)
 		{
-			Line &line = elem;
+			Line &line = *it;
 			int offset = (max_width - line.width) / 2;
 			if (offset < 0) offset = 0;
 
@@ -786,10 +842,10 @@ namespace clan
 		}
 	}
 
-	void SpanLayout_Impl::align_justify(int max_width)
+	void SpanLayout_Impl::align_justify(int max_width, std::vector<Line>::size_type first_line)
 	{
 		// Note, we do not justify the last line
-		for (std::vector<Line>::size_type line_index = 0; line_index + 1 < lines.size(); line_index++)
+		for (std::vector<Line>::size_type line_index = first_line; line_index + 1 < lines.size(); line_index++)
 		{
 			Line &line = lines[line_index];
 			int offset = max_width - line.width;
@@ -809,7 +865,9 @@ namespace clan
 	Size SpanLayout_Impl::find_preferred_size(Canvas &canvas)
 	{
 		layout_lines(canvas, 0x70000000); // Feed it with a very long length so it ends up on one line
-		return get_rect().get_size();
+		Size size = get_rect().get_size();
+		invalidate_layout();	// The lines are not aligned, so the next layout() must start over
+		return size;
 	}
 
 	void SpanLayout_Impl::set_selection_range(std::string::size_type start, std::string::size_type end)
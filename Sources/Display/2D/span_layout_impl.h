@@ -33,6 +33,7 @@
 #include "API/Display/Font/font_metrics.h"
 #include "API/Display/2D/span_layout.h"
 #include "API/Display/2D/image.h"
+#include <unordered_map>
 
 namespace clan
 {
@@ -105,6 +106,7 @@ namespace clan
 		void layout(Canvas &canvasc, int max_width);
 		SpanLayout::HitTestResult hit_test(Canvas &canvas, const Point &pos);
 		void draw_layout(Canvas &canvas);
+		void draw_layout(Canvas &canvas, const Rect &visible_rect);
 		void draw_layout_ellipsis(Canvas &canvas, const Rect &content_rect);
 		void set_position(const Point &pos) { position = pos; }
 		Rect get_rect() const;
@@ -194,6 +196,7 @@ namespace clan
 		{
 			Line() { }
 
+			int top = 0;	// Relative to the layout position
 			int width = 0;	// Width of the entire line (including spaces)
 			int height = 0;
 			int ascender = 0;
@@ -232,10 +235,23 @@ namespace clan
 			int id = 1;
 		};
 
+		/// \brief Layout state before the last newline block, where layout_lines() can resume when text is added
+		struct LayoutCheckpoint
+		{
+			LayoutCheckpoint() { }
+
+			unsigned int text_pos = 0;
+			std::vector<Line>::size_type line_count = 0;
+			CurrentLine current_line;
+		};
+
 		TextSizeResult find_text_size(Canvas &canvas, const TextBlock &block, unsigned int object_index);
-		std::vector<TextBlock> find_text_blocks();
-		void layout_lines(Canvas &canvas, int max_width);
-		void layout_text(Canvas &canvas, std::vector<TextBlock> blocks, std::vector<TextBlock>::size_type block_index, CurrentLine &current_line, int max_width);
+		TextSizeResult measure_text_block(Canvas &canvas, const TextBlock &block, unsigned int object_index);
+		std::vector<TextBlock> find_text_blocks(std::string::size_type start_pos, std::vector<SpanObject>::size_type start_object);
+		std::vector<Line>::size_type layout_lines(Canvas &canvas, int max_width);
+		void invalidate_layout() { layout_width = -1; }
+		void draw_lines(Canvas &canvas, std::vector<Line>::size_type first_line, std::vector<Line>::size_type end_line);
+		void layout_text(Canvas &canvas, const std::vector<TextBlock> &blocks, std::vector<TextBlock>::size_type block_index, CurrentLine &current_line, int max_width);
 		void layout_block(CurrentLine &current_line, int max_width, std::vector<TextBlock> &blocks, std::vector<TextBlock>::size_type block_index);
 		void layout_float_block(CurrentLine &current_line, int max_width);
 		void layout_inline_block(CurrentLine &current_line, int max_width, std::vector<TextBlock> &blocks, std::vector<TextBlock>::size_type block_index);
@@ -251,9 +267,9 @@ namespace clan
 		bool is_whitespace(const TextBlock &block);
 		bool fits_on_line(int x_position, const TextSizeResult &text_size_result, int max_width);
 		bool larger_than_line(const TextSizeResult &text_size_result, int max_width);
-		void align_justify(int max_width);
-		void align_center(int max_width);
-		void align_right(int max_width);
+		void align_justify(int max_width, std::vector<Line>::size_type first_line);
+		void align_center(int max_width, std::vector<Line>::size_type first_line);
+		void align_right(int max_width, std::vector<Line>::size_type first_line);
 		void draw_layout_image(Canvas &canvas, Line &line, LineSegment &segment, int x, int y);
 		void draw_layout_text(Canvas &canvas, Line &line, LineSegment &segment, int x, int y);
 		std::string::size_type sel_start, sel_end;
@@ -276,6 +292,19 @@ namespace clan
 		};
 		LayoutCache layout_cache;
 
+		/// Measured text blocks by start position. Their size does not depend on the layout width,
+		/// so only the line breaking runs again when the width changes.
+		struct MeasuredBlock
+		{
+			unsigned int object_index = 0;
+			TextSizeResult size;
+		};
+		std::unordered_map<int, MeasuredBlock> measured_blocks;
+		float measured_pixel_ratio = 0.0f;
+
+		int layout_width = -1;	// Width the lines were laid out and aligned for. -1 = Lines must be laid out from the start
+		LayoutCheckpoint layout_checkpoint;
+
 		bool is_ellipsis_draw;
 		Rect ellipsis_content_rect;
 	};
@@ -44,6 +44,7 @@
 #include "render_batch_triangle.h"
 #include "API/Display/Resources/display_cache.h"
 #include "API/Display/2D/subtexture.h"
+#include <algorithm>
 
 namespace clan
 {
@@ -316,13 +317,11 @@ namespace clan
 		if (impl->finished)
 			return;
 
-		Sprite_Impl::SpriteFrame *frame = &impl->frames[impl->current_frame];
-
 		impl->update_time_ms += time_elapsed;
 
-		while (impl->update_time_ms > frame->delay_ms)
+		while (impl->update_time_ms > impl->frames[impl->current_frame].delay_ms)
 		{
-			impl->update_time_ms -= frame->delay_ms;
+			impl->update_time_ms -= impl->frames[impl->current_frame].delay_ms;
 			impl->current_frame += impl->delta_frame;
 
 			// Beginning or end of loop ?
@@ -343,12 +342,12 @@ namespace clan
 					impl->delta_frame = -impl->delta_frame;	// Change direction
 					if (impl->delta_frame > 0)
 					{
-						impl->current_frame = 1;
+						impl->current_frame = std::min(1, total_frames - 1);
 						//during a ping pong, we only count when we re-start in the forward direction as a loop
 						impl->looping = true;
 					}
 					else
-						impl->current_frame = total_frames - 2;
+						impl->current_frame = std::max(total_frames - 2, 0);
 				}
 				else // Restart
 				{
@@ -464,6 +463,11 @@ namespace clan
 		impl->color = color;
 	}
 
+	void Sprite::set_instanced(bool enable)
+	{
+		impl->instanced = enable;
+	}
+
 	void Sprite::set_linear_filter(bool linear_filter)
 	{
 		impl->linear_filter = linear_filter;
@@ -0,0 +1,350 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "Display/precomp.h"
+#include "API/Display/2D/sprite_batch.h"
+#include "API/Display/2D/sprite.h"
+#include "API/Display/2D/canvas.h"
+#include "API/Core/System/exception.h"
+#include "sprite_impl.h"
+#include "render_batch_triangle.h"
+#include "render_batch_sprite_instanced.h"
+#include "canvas_impl.h"
+#include <algorithm>
+#include <vector>
+
+namespace clan
+{
+	class SpriteBatch_Impl
+	{
+	public:
+		SpriteBatch_Impl(const Sprite &sprite) : sprite(sprite)
+		{
+		}
+
+		Sprite_Impl &get_definition() const { return *sprite.impl; }
+
+		int add(const Pointf &position, const Colorf &color);
+		void remove(int index);
+		void restart(int index);
+		void update(int time_elapsed_ms);
+		void draw(Canvas &canvas);
+
+		Sprite sprite;
+
+		// Per instance state, one array per field so update() only touches the animation state
+		std::vector<int> frames;
+		std::vector<int> times_ms;
+		std::vector<signed char> directions;
+		std::vector<unsigned char> finished;
+		std::vector<unsigned char> looping;
+		std::vector<Pointf> positions;
+		std::vector<Colorf> colors;
+
+	private:
+		struct FrameQuad
+		{
+			Pointf texture_position[4];
+			Pointf dest_offset[4];	// Corners relative to the instance position
+		};
+
+		std::vector<FrameQuad> frame_quads;
+	};
+
+	SpriteBatch::SpriteBatch()
+	{
+	}
+
+	SpriteBatch::SpriteBatch(const Sprite &sprite) : impl(std::make_shared<SpriteBatch_Impl>(sprite))
+	{
+		sprite.throw_if_null();
+	}
+
+	void SpriteBatch::throw_if_null() const
+	{
+		if (!impl)
+			throw Exception("SpriteBatch is null");
+	}
+
+	Sprite SpriteBatch::get_sprite() const
+	{
+		return impl->sprite;
+	}
+
+	int SpriteBatch::get_count() const
+	{
+		return impl->frames.size();
+	}
+
+	int SpriteBatch::add(const Pointf &position)
+	{
+		return impl->add(position, impl->get_definition().color);
+	}
+
+	int SpriteBatch::add(const Pointf &position, const Colorf &color)
+	{
+		return impl->add(position, color);
+	}
+
+	void SpriteBatch::remove(int index)
+	{
+		impl->remove(index);
+	}
+
+	void SpriteBatch::clear()
+	{
+		impl->frames.clear();
+		impl->times_ms.clear();
+		impl->directions.clear();
+		impl->finished.clear();
+		impl->looping.clear();
+		impl->positions.clear();
+		impl->colors.clear();
+	}
+
+	Pointf SpriteBatch::get_position(int index) const
+	{
+		return impl->positions[index];
+	}
+
+	Colorf SpriteBatch::get_color(int index) const
+	{
+		return impl->colors[index];
+	}
+
+	int SpriteBatch::get_current_frame(int index) const
+	{
+		return impl->frames[index];
+	}
+
+	bool SpriteBatch::is_finished(int index) const
+	{
+		return impl->finished[index] != 0;
+	}
+
+	bool SpriteBatch::is_looping(int index) const
+	{
+		return impl->looping[index] != 0;
+	}
+
+	void SpriteBatch::set_position(int index, const Pointf &position)
+	{
+		impl->positions[index] = position;
+	}
+
+	void SpriteBatch::set_color(int index, const Colorf &color)
+	{
+		impl->colors[index] = color;
+	}
+
+	void SpriteBatch::set_frame(int index, int frame)
+	{
+		int total_frames = impl->get_definition().frames.size();
+		impl->frames[index] = std::max(std::min(frame, total_frames - 1), 0);
+		impl->times_ms[index] = 0;
+	}
+
+	void SpriteBatch::restart(int index)
+	{
+		impl->restart(index);
+	}
+
+	void SpriteBatch::update(int time_elapsed_ms)
+	{
+		impl->update(time_elapsed_ms);
+	}
+
+	void SpriteBatch::draw(Canvas &canvas)
+	{
+		impl->draw(canvas);
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	int SpriteBatch_Impl::add(const Pointf &position, const Colorf &color)
+	{
+		frames.push_back(0);
+		times_ms.push_back(0);
+		directions.push_back(1);
+		finished.push_back(0);
+		looping.push_back(0);
+		positions.push_back(position);
+		colors.push_back(color);
+
+		int index = frames.size() - 1;
+		restart(index);
+		return index;
+	}
+
+	void SpriteBatch_Impl::remove(int index)
+	{
+		int last = frames.size() - 1;
+		if (index < 0 || index > last)
+			throw Exception("SpriteBatch instance index out of range");
+
+		frames[index] = frames[last];
+		times_ms[index] = times_ms[last];
+		directions[index] = directions[last];
+		finished[index] = finished[last];
+		looping[index] = looping[last];
+		positions[index] = positions[last];
+		colors[index] = colors[last];
+
+		frames.pop_back();
+		times_ms.pop_back();
+		directions.pop_back();
+		finished.pop_back();
+		looping.pop_back();
+		positions.pop_back();
+		colors.pop_back();
+	}
+
+	void SpriteBatch_Impl::restart(int index)
+	{
+		const Sprite_Impl &definition = get_definition();
+		times_ms[index] = 0;
+		finished[index] = 0;
+		looping[index] = 0;
+		frames[index] = definition.play_backward ? std::max((int)definition.frames.size() - 1, 0) : 0;
+		directions[index] = definition.play_backward ? -1 : 1;
+	}
+
+	void SpriteBatch_Impl::update(int time_elapsed_ms)
+	{
+		// Same rules as Sprite::update(), applied to every instance in one pass
+		const Sprite_Impl &definition = get_definition();
+		const int total_frames = definition.frames.size();
+		if (total_frames == 0)
+			return;
+
+		const Sprite_Impl::SpriteFrame *frame_table = definition.frames.data();
+		const bool play_loop = definition.play_loop;
+		const bool play_pingpong = definition.play_pingpong;
+		const bool play_backward = definition.play_backward;
+		const int forward_delta = play_backward ? -1 : 1;
+		const int finished_frame = (definition.show_on_finish == Sprite::show_first_frame) ? 0 : total_frames - 1;
+
+		const size_t count = frames.size();
+		int *frame = frames.data();
+		int *time_ms = times_ms.data();
+		signed char *direction = directions.data();
+		unsigned char *is_finished = finished.data();
+		unsigned char *is_looping = looping.data();
+
+		for (size_t i = 0; i < count; i++)
+		{
+			is_looping[i] = 0;
+			if (is_finished[i])
+				continue;
+
+			int current_frame = std::min(frame[i], total_frames - 1);
+			int delta_frame = direction[i];
+			int update_time_ms = time_ms[i] + time_elapsed_ms;
+
+			while (update_time_ms > frame_table[current_frame].delay_ms)
+			{
+				update_time_ms -= frame_table[current_frame].delay_ms;
+				current_frame += delta_frame;
+
+				// Beginning or end of loop ?
+				if (current_frame >= total_frames || current_frame < 0)
+				{
+					if (!play_loop && (delta_frame != forward_delta || !play_pingpong))
+					{
+						is_finished[i] = 1;
+						current_frame = finished_frame;
+						break;
+					}
+
+					if (play_pingpong)
+					{
+						delta_frame = -delta_frame;	// Change direction
+						if (delta_frame > 0)
+						{
+							current_frame = std::min(1, total_frames - 1);
+							is_looping[i] = 1;
+						}
+						else
+						{
+							current_frame = std::max(total_frames - 2, 0);
+						}
+					}
+					else // Restart
+					{
+						current_frame = play_backward ? total_frames - 1 : 0;
+						is_looping[i] = 1;
+					}
+				}
+			}
+
+			frame[i] = current_frame;
+			direction[i] = delta_frame;
+			time_ms[i] = update_time_ms;
+		}
+	}
+
+	void SpriteBatch_Impl::draw(Canvas &canvas)
+	{
+		Sprite_Impl &definition = get_definition();
+		const int total_frames = definition.frames.size();
+		if (total_frames == 0 || frames.empty())
+			return;
+
+		// All instances share the sprite's transform, so each frame's quad only differs by the instance position
+		frame_quads.resize(total_frames);
+		for (int i = 0; i < total_frames; i++)
+			definition.calc_frame_quad(i, definition.frames[i].position, Pointf(), definition.scale, frame_quads[i].texture_position, frame_quads[i].dest_offset);
+
+		RenderBatchTriangle *batcher = canvas.impl->batcher.get_triangle_batcher();
+		RenderBatchSpriteInstanced *instanced_batcher = nullptr;
+		if (!batcher->is_capturing() && RenderBatchSpriteInstanced::is_supported(canvas.impl->get_projection() * canvas.impl->get_transform()))
+			instanced_batcher = canvas.impl->batcher.get_sprite_instanced_batcher();
+
+		const bool hide_finished = definition.show_on_finish == Sprite::show_blank;
+		const size_t count = frames.size();
+		Pointf dest_position[4];
+
+		for (size_t i = 0; i < count; i++)
+		{
+			if (hide_finished && finished[i])
+				continue;
+
+			int frame = std::min(frames[i], total_frames - 1);
+			const FrameQuad &quad = frame_quads[frame];
+			const Pointf &position = positions[i];
+			for (int corner = 0; corner < 4; corner++)
+				dest_position[corner] = quad.dest_offset[corner] + position;
+
+			if (instanced_batcher)
+				instanced_batcher->draw_sprite(canvas, quad.texture_position, dest_position, definition.frames[frame].texture, colors[i]);
+			else
+				batcher->draw_sprite(canvas, quad.texture_position, dest_position, definition.frames[frame].texture, colors[i]);
+		}
+	}
+}
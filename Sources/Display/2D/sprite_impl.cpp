@@ -138,7 +138,25 @@ namespace clan
 
 	void Sprite_Impl::draw(Canvas &canvas, const Rect &p_src, const Pointf &p_dest, const Pointf &p_scale)
 	{
-		SpriteFrame &frame = frames[current_frame];
+		Pointf texture_position[4];	// Scaled to the range of 0.0f to 1.0f
+		Pointf dest_position[4];
+		calc_frame_quad(current_frame, p_src, p_dest, p_scale, texture_position, dest_position);
+
+		if (instanced && !canvas.impl->batcher.get_triangle_batcher()->is_capturing() && RenderBatchSpriteInstanced::is_supported(canvas.impl->get_projection() * canvas.impl->get_transform()))
+		{
+			RenderBatchSpriteInstanced *batcher = canvas.impl->batcher.get_sprite_instanced_batcher();
+			batcher->draw_sprite(canvas, texture_position, dest_position, frames[current_frame].texture, color);
+			return;
+		}
+
+		RenderBatchTriangle *batcher = canvas.impl->batcher.get_triangle_batcher();
+		batcher->draw_sprite(canvas, texture_position, dest_position, frames[current_frame].texture, color);
+
+	}
+
+	void Sprite_Impl::calc_frame_quad(int frame_index, const Rect &p_src, const Pointf &p_dest, const Pointf &p_scale, Pointf texture_position[4], Pointf dest_position[4]) const
+	{
+		const SpriteFrame &frame = frames[frame_index];
 
 		// Find size of surface:
 		float src_width = (float)p_src.get_width();
@@ -217,13 +235,10 @@ namespace clan
 		}
 
 		// Calculate final source rectangle points for render:
-		const Texture2D &texture = frames[current_frame].texture;
+		const Texture2D &texture = frame.texture;
 		float texture_width = texture.get_width();
 		float texture_height = texture.get_height();
 
-		Pointf texture_position[4];	// Scaled to the range of 0.0f to 1.0f
-		Pointf dest_position[4];
-
 		texture_position[0].x = (((float)p_src.left)) / texture_width;
 		texture_position[1].x = (((float)p_src.left + src_width)) / texture_width;
 		texture_position[2].x = (((float)p_src.left)) / texture_width;
@@ -279,9 +294,6 @@ namespace clan
 			dest_position[2].x = (dest_position[2].x - target_rotation_hotspot.x) * yaw_rad + target_rotation_hotspot.x;
 			dest_position[3].x = (dest_position[3].x - target_rotation_hotspot.x) * yaw_rad + target_rotation_hotspot.x;
 		}
-		RenderBatchTriangle *batcher = canvas.impl->batcher.get_triangle_batcher();
-		batcher->draw_sprite(canvas, texture_position, dest_position, frames[current_frame].texture, color);
-
 	}
 
 	void Sprite_Impl::add_frame(const Texture2D &texture)
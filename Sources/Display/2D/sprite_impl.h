@@ -81,6 +81,7 @@ namespace clan
 		Colorf color;
 
 		bool linear_filter;
+		bool instanced = false;
 
 		Point translation_hotspot;
 		Point rotation_hotspot;
@@ -115,6 +116,9 @@ namespace clan
 
 		void draw(Canvas &canvas, const Rect &p_src, const Pointf &p_dest, const Pointf &p_scale);
 
+		/// \brief Calculates the texture coordinates and destination corners of a frame, as drawn by draw()
+		void calc_frame_quad(int frame_index, const Rect &p_src, const Pointf &p_dest, const Pointf &p_scale, Pointf texture_position[4], Pointf dest_position[4]) const;
+
 		// inlined this function for performance reasons.
 		static inline Pointf calc_hotspot(Origin origin, float hotspot_x, float hotspot_y, float size_width, float size_height)
 		{
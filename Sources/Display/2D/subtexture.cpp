@@ -79,4 +79,10 @@ namespace clan
 	{
 		return impl->geometry;
 	}
+
+	void Subtexture::set_location(const Texture2D &texture, const Rect &geometry)
+	{
+		impl->texture = texture;
+		impl->geometry = geometry;
+	}
 }
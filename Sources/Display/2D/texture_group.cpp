@@ -88,11 +88,26 @@ namespace clan
 		return impl->add_new_node(context, size);
 	}
 
+	std::vector<Subtexture> TextureGroup::add(GraphicContext &context, const std::vector<Size> &sizes)
+	{
+		return impl->add_batch(context, sizes);
+	}
+
 	void TextureGroup::remove(Subtexture &subtexture)
 	{
 		impl->remove(subtexture);
 	}
 
+	void TextureGroup::remove_texture(const Texture2D &texture)
+	{
+		impl->remove_texture(texture);
+	}
+
+	int TextureGroup::repack(GraphicContext &context, float max_fill)
+	{
+		return impl->repack(context, max_fill);
+	}
+
 	void TextureGroup::set_texture_allocation_policy(TextureAllocationPolicy policy)
 	{
 		impl->texture_allocation_policy = policy;
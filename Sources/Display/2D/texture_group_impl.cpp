@@ -28,9 +28,12 @@
 
 #include "Display/precomp.h"
 #include "API/Display/2D/subtexture.h"
+#include "API/Display/Render/frame_buffer.h"
+#include "API/Display/Render/graphic_context.h"
 #include "API/Core/Math/point.h"
 #include "API/Core/Math/rect.h"
 #include "texture_group_impl.h"
+#include <algorithm>
 
 namespace clan
 {
@@ -90,6 +93,7 @@ namespace clan
 	{
 		// Try inserting in current active texture
 		Node *node;
+		RootNode *root = active_root;
 		if (!active_root)
 		{
 			// Create an initial root, if it does not exist
@@ -112,7 +116,10 @@ namespace clan
 				{
 					node = root_nodes[index]->node.insert(texture_size, next_id);
 					if (node)	// We found space in a previous texture
+					{
+						root = root_nodes[index];
 						break;
+					}
 				}
 			}
 
@@ -121,12 +128,13 @@ namespace clan
 				if (texture_size.width > initial_texture_size.width || texture_size.height > initial_texture_size.height)
 				{
 					// If the specified size is greater than the initial size,  then create a texture using the specified size
-					node = add_new_root(context, texture_size)->node.insert(texture_size, next_id);
+					root = add_new_root(context, texture_size);
 				}
 				else
 				{
-					node = add_new_root(context, initial_texture_size)->node.insert(texture_size, next_id);
+					root = add_new_root(context, initial_texture_size);
 				}
+				node = root->node.insert(texture_size, next_id);
 			}
 
 			if (node == nullptr)
@@ -135,7 +143,29 @@ namespace clan
 
 		next_id++;
 
-		return Subtexture(active_root->texture, node->image_rect);
+		node->subtexture = Subtexture(root->texture, node->image_rect);
+		return node->subtexture;
+	}
+
+	std::vector<Subtexture> TextureGroup_Impl::add_batch(GraphicContext &context, const std::vector<Size> &sizes)
+	{
+		// Largest first, like RectPacker::add_batch
+		std::vector<size_t> order(sizes.size());
+		for (size_t i = 0; i < order.size(); i++)
+			order[i] = i;
+		std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b)
+		{
+			int area_a = sizes[a].width * sizes[a].height;
+			int area_b = sizes[b].width * sizes[b].height;
+			if (area_a != area_b)
+				return area_a > area_b;
+			return sizes[a].width + sizes[a].height > sizes[b].width + sizes[b].height;
+		});
+
+		std::vector<Subtexture> subtextures(sizes.size());
+		for (size_t index : order)
+			subtextures[index] = add_new_node(context, sizes[index]);
+		return subtextures;
 	}
 
 	TextureGroup_Impl::RootNode *TextureGroup_Impl::add_new_root(GraphicContext &context, const Size &texture_size)
@@ -165,8 +195,6 @@ namespace clan
 
 	void TextureGroup_Impl::remove(Subtexture &subtexture)
 	{
-		// Find the texture
-		Node *node = nullptr;
 		Texture2D texture = subtexture.get_texture();
 		Rect rect = subtexture.get_geometry();
 
@@ -177,32 +205,142 @@ namespace clan
 			// Find a texture match
 			if (root_nodes[index]->texture == texture)
 			{
-				node = root_nodes[index]->node.find_image_rect(rect);
-				break;
+				if (!root_nodes[index]->node.free_image_rect(rect))
+					break;
+
+				if (root_nodes[index]->node.get_subtexture_count() <= 0)
+					delete_root(index);
+				active_root = root_nodes.empty() ? nullptr : root_nodes.back();
+				return;
 			}
 		}
-		if (node)
+		throw Exception("Cannot find the Subtexture in the TextureGroup");
+	}
+
+	void TextureGroup_Impl::remove_texture(const Texture2D &texture)
+	{
+		for (std::vector<RootNode *>::size_type index = 0; index < root_nodes.size(); ++index)
 		{
-			node->clear();
-			if (root_nodes[index]->node.get_subtexture_count() <= 0)
+			if (root_nodes[index]->texture == texture)
 			{
-				root_nodes[index]->node.clear();
-				delete root_nodes[index];
-				root_nodes.erase(root_nodes.begin() + index);
+				delete_root(index);
+				active_root = root_nodes.empty() ? nullptr : root_nodes.back();
+				return;
 			}
-			if (root_nodes.empty())
+		}
+		throw Exception("Cannot find the Texture in the TextureGroup");
+	}
+
+	int TextureGroup_Impl::repack(GraphicContext &context, float max_fill)
+	{
+		// Only the emptiest texture is repacked, so the work can be spread over several frames
+		RootNode *source = nullptr;
+		float source_fill = max_fill;
+		for (auto root : root_nodes)
+		{
+			int area = root->node.node_rect.get_width() * root->node.node_rect.get_height();
+			if (area <= 0 || root->node.get_subtexture_count() == 0)
+				continue;
+			float fill = root->node.get_used_area() / (float)area;
+			if (fill < source_fill)
 			{
-				active_root = nullptr;
+				source = root;
+				source_fill = fill;
 			}
-			else
+		}
+		if (!source)
+			return 0;
+
+		// Placing the tallest subtextures first packs them tighter
+		std::vector<Node *> nodes;
+		source->node.get_subtextures(nodes);
+		std::sort(nodes.begin(), nodes.end(), [](const Node *a, const Node *b)
+		{
+			if (a->image_rect.get_height() != b->image_rect.get_height())
+				return a->image_rect.get_height() > b->image_rect.get_height();
+			return a->image_rect.get_width() > b->image_rect.get_width();
+		});
+
+		// Allocate space in the other textures, adding one new texture if they are full
+		struct Move
+		{
+			Node *from;
+			RootNode *to_root;
+			Node *to;
+		};
+		std::vector<Move> moves;
+		RootNode *new_root = nullptr;
+		for (Node *node : nodes)
+		{
+			Move move = { node, nullptr, nullptr };
+			for (auto root : root_nodes)
+			{
+				if (root == source)
+					continue;
+				move.to = root->node.insert(node->image_rect.get_size(), next_id);
+				if (move.to)
+				{
+					move.to_root = root;
+					break;
+				}
+			}
+
+			if (!move.to && !new_root)
+			{
+				new_root = add_new_root(context, source->node.node_rect.get_size());
+				move.to_root = new_root;
+				move.to = new_root->node.insert(node->image_rect.get_size(), next_id);
+			}
+
+			if (!move.to)
 			{
-				active_root = root_nodes.back();
+				// The subtextures do not fit elsewhere. Give back the space allocated so far.
+				for (auto &done : moves)
+					done.to_root->node.free_image_rect(done.to->image_rect);
+				if (new_root)
+					delete_root(std::find(root_nodes.begin(), root_nodes.end(), new_root) - root_nodes.begin());
+				active_root = root_nodes.empty() ? nullptr : root_nodes.back();
+				return 0;
 			}
+
+			next_id++;
+			moves.push_back(move);
 		}
-		else
+
+		// Copy the pixels on the GPU, reading from the old texture through a frame buffer
+		FrameBuffer previous_write = context.get_write_frame_buffer();
+		FrameBuffer previous_read = context.get_read_frame_buffer();
+		FrameBuffer source_buffer(context);
+		source_buffer.attach_color(0, source->texture);
+		context.set_frame_buffer(source_buffer);
+
+		for (auto &move : moves)
 		{
-			throw Exception("Cannot find the Subtexture in the TextureGroup");
+			move.to_root->texture.copy_subimage_from(context, Point(move.to->image_rect.left, move.to->image_rect.top), move.from->image_rect);
+
+			// Every copy of the Subtexture returned by add() shares the new location
+			move.to->subtexture = move.from->subtexture;
+			if (move.to->subtexture.is_null())
+				move.to->subtexture = Subtexture(move.to_root->texture, move.to->image_rect);
+			else
+				move.to->subtexture.set_location(move.to_root->texture, move.to->image_rect);
 		}
+
+		if (previous_write.is_null())
+			context.reset_frame_buffer();
+		else
+			context.set_frame_buffer(previous_write, previous_read.is_null() ? previous_write : previous_read);
+
+		delete_root(std::find(root_nodes.begin(), root_nodes.end(), source) - root_nodes.begin());
+		active_root = root_nodes.empty() ? nullptr : root_nodes.back();
+		return (int)moves.size();
+	}
+
+	void TextureGroup_Impl::delete_root(std::vector<RootNode *>::size_type index)
+	{
+		root_nodes[index]->node.clear();
+		delete root_nodes[index];
+		root_nodes.erase(root_nodes.begin() + index);
 	}
 
 	/////////////////////////////////////////////////////////////////////////////
@@ -230,6 +368,32 @@ namespace clan
 		clear();
 	}
 
+	int TextureGroup_Impl::Node::get_used_area() const
+	{
+		int area = 0;
+
+		if (child[0])
+			area += child[0]->get_used_area();
+		if (child[1])
+			area += child[1]->get_used_area();
+
+		if (id)
+			area += image_rect.get_width() * image_rect.get_height();
+
+		return area;
+	}
+
+	void TextureGroup_Impl::Node::get_subtextures(std::vector<Node *> &out_nodes)
+	{
+		if (child[0])
+			child[0]->get_subtextures(out_nodes);
+		if (child[1])
+			child[1]->get_subtextures(out_nodes);
+
+		if (id)
+			out_nodes.push_back(this);
+	}
+
 	int TextureGroup_Impl::Node::get_subtexture_count() const
 	{
 		int count = 0;
@@ -258,6 +422,7 @@ namespace clan
 			child[1] = nullptr;
 		}
 		id = 0;
+		subtexture = Subtexture();
 	}
 
 	TextureGroup_Impl::Node *TextureGroup_Impl::Node::insert(const Size &texture_size, int texture_id)
@@ -311,29 +476,27 @@ namespace clan
 		}
 	}
 
-	TextureGroup_Impl::Node *TextureGroup_Impl::Node::find_image_rect(const Rect &new_rect)
+	bool TextureGroup_Impl::Node::free_image_rect(const Rect &rect)
 	{
-		// Check leaf
-		if (child[0])
-		{
-			Node *node = child[0]->find_image_rect(new_rect);
-			if (node)
-				return node;
-		}
+		if (!node_rect.is_inside(rect))
+			return false;
 
-		if (child[1])
+		if (child[0] && child[1])
 		{
-			Node *node = child[1]->find_image_rect(new_rect);
-			if (node)
-				return node;
-		}
+			if (!child[0]->free_image_rect(rect) && !child[1]->free_image_rect(rect))
+				return false;
 
-		if (id == 0)
-			return nullptr;
+			// Merge the halves once both are free, so the space can hold larger subtextures again
+			if (child[0]->is_free_leaf() && child[1]->is_free_leaf())
+				clear();
+			return true;
+		}
 
-		if (image_rect == new_rect)
-			return this;
+		if (id == 0 || image_rect != rect)
+			return false;
 
-		return nullptr;
+		id = 0;
+		subtexture = Subtexture();
+		return true;
 	}
 }
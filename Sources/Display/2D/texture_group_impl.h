@@ -31,6 +31,7 @@
 #include <list>
 #include "API/Display/Render/texture_2d.h"
 #include "API/Display/2D/texture_group.h"
+#include "API/Display/2D/subtexture.h"
 
 namespace clan
 {
@@ -48,9 +49,17 @@ namespace clan
 			~Node();
 
 			int get_subtexture_count() const;
+			int get_used_area() const;
+			void get_subtextures(std::vector<Node *> &out_nodes);
 
 			Node *insert(const Size &texture_size, int texture_id);
-			Node *find_image_rect(const Rect &new_rect);
+
+			/// \brief Frees the subtexture at rect, merging empty neighbours back into larger free space
+			///
+			/// Returns false if rect is not allocated in this node
+			bool free_image_rect(const Rect &rect);
+
+			bool is_free_leaf() const { return !child[0] && !child[1] && !id; }
 
 			void clear();
 
@@ -59,6 +68,7 @@ namespace clan
 
 			int id;
 			Rect image_rect;
+			Subtexture subtexture;	// The object returned by add(), which is updated when repacked
 		};
 
 		struct RootNode
@@ -75,10 +85,13 @@ namespace clan
 		int get_subtexture_count(unsigned int texture_index) const;
 		void insert_texture(Texture2D &texture, const Rect &texture_rect);
 		void remove(Subtexture &subtexture);
+		void remove_texture(const Texture2D &texture);
+		int repack(GraphicContext &context, float max_fill);
 
 		std::vector<Texture2D> get_textures() const;
 
 		Subtexture add_new_node(GraphicContext &context, const Size &texture_size);
+		std::vector<Subtexture> add_batch(GraphicContext &context, const std::vector<Size> &sizes);
 
 		std::vector<RootNode *> root_nodes;
 
@@ -87,6 +100,7 @@ namespace clan
 
 	private:
 		RootNode *add_new_root(GraphicContext &context, const Size &texture_size);
+		void delete_root(std::vector<RootNode *>::size_type index);
 
 		RootNode *active_root;
 		int next_id;
@@ -30,10 +30,18 @@
 
 namespace clan
 {
+	class TextRun;
+
 	class Font_Draw
 	{
 	public:
 		virtual GlyphMetrics get_metrics(Canvas &canvas, unsigned int glyph) = 0;
 		virtual void draw_text(Canvas &canvas, const Pointf &position, const std::string &text, const Colorf &color, float line_spacing) = 0;
+
+		/// \brief Lays out the glyph quads of text into run, for drawing with draw_run()
+		///
+		/// Returns false if the text can not be cached by this draw method, or while some of its glyphs are pending.
+		virtual bool shape_text(Canvas &canvas, const std::string &text, float line_spacing, TextRun &run) { return false; }
+		virtual void draw_run(Canvas &canvas, const Pointf &position, const TextRun &run, const Colorf &color) { }
 	};
 }
@@ -44,13 +44,15 @@
 #include "font_draw_flat.h"
 #include "Display/Font/glyph_cache.h"
 #include "Display/Font/path_cache.h"
+#include "Display/Font/text_run_cache.h"
 
 namespace clan
 {
-	void Font_DrawFlat::init(GlyphCache *cache, FontEngine *engine)
+	void Font_DrawFlat::init(GlyphCache *cache, FontEngine *engine, bool new_async_rasterization)
 	{
 		glyph_cache = cache;
 		font_engine = engine;
+		async_rasterization = new_async_rasterization;
 	}
 
 	GlyphMetrics Font_DrawFlat::get_metrics(Canvas &canvas, unsigned int glyph)
@@ -77,7 +79,7 @@ namespace clan
 				continue;
 			}
 
-			Font_TextureGlyph *gptr = glyph_cache->get_glyph(canvas, font_engine, glyph);
+			Font_TextureGlyph *gptr = async_rasterization ? glyph_cache->get_glyph_async(canvas, font_engine, glyph) : glyph_cache->get_glyph(canvas, font_engine, glyph);
 			if (gptr)
 			{
 				if (!gptr->texture.is_null())
@@ -92,6 +94,64 @@ namespace clan
 				offset_x += gptr->metrics.advance.width;
 				offset_y += gptr->metrics.advance.height;
 			}
+			else if (async_rasterization && glyph_cache->is_glyph_pending(glyph))
+			{
+				// Leave room for the glyph until it is ready, assuming it is about as wide as the font is high
+				offset_x += font_engine->get_metrics().get_height();
+			}
+		}
+	}
+
+	bool Font_DrawFlat::shape_text(Canvas &canvas, const std::string &text, float line_spacing, TextRun &run)
+	{
+		float offset_x = 0;
+		float offset_y = 0;
+		UTF8_Reader reader(text.data(), text.length());
+		std::vector<TextRunGlyph> glyphs;
+		unsigned int generation = glyph_cache->get_generation();
+
+		while (!reader.is_end())
+		{
+			unsigned int glyph = reader.get_char();
+			reader.next();
+
+			if (glyph == '\n')
+			{
+				offset_x = 0;
+				offset_y += line_spacing;
+				continue;
+			}
+
+			Font_TextureGlyph *gptr = async_rasterization ? glyph_cache->get_glyph_async(canvas, font_engine, glyph) : glyph_cache->get_glyph(canvas, font_engine, glyph);
+			if (gptr)
+			{
+				if (!gptr->texture.is_null())
+					glyphs.push_back(TextRunGlyph(gptr, Pointf(offset_x + gptr->offset.x, offset_y + gptr->offset.y)));
+				offset_x += gptr->metrics.advance.width;
+				offset_y += gptr->metrics.advance.height;
+			}
+			else if (async_rasterization && glyph_cache->is_glyph_pending(glyph))
+			{
+				return false;
+			}
+		}
+
+		run.glyphs.swap(glyphs);
+		run.generation = generation;	// If glyphs were evicted while shaping, the run is shaped again next time
+		run.shaped = true;
+		return true;
+	}
+
+	void Font_DrawFlat::draw_run(Canvas &canvas, const Pointf &position, const TextRun &run, const Colorf &color)
+	{
+		RenderBatchTriangle *batcher = canvas.impl->batcher.get_triangle_batcher();
+		for (const auto &run_glyph : run.glyphs)
+		{
+			const Font_TextureGlyph *gptr = run_glyph.glyph;
+			if (gptr->atlas_page)
+				gptr->atlas_page->touch();
+			Pointf pos = canvas.grid_fit(position + run_glyph.offset);
+			batcher->draw_image(canvas, gptr->geometry, Rectf(pos, gptr->size), color, gptr->texture);
 		}
 	}
 }
@@ -35,13 +35,16 @@ namespace clan
 	class Font_DrawFlat : public Font_Draw
 	{
 	public:
-		void init(GlyphCache *cache, FontEngine *engine);
+		void init(GlyphCache *cache, FontEngine *engine, bool new_async_rasterization);
 
 		GlyphMetrics get_metrics(Canvas &canvas, unsigned int glyph) override;
 		void draw_text(Canvas &canvas, const Pointf &position, const std::string &text, const Colorf &color, float line_spacing) override;
+		bool shape_text(Canvas &canvas, const std::string &text, float line_spacing, TextRun &run) override;
+		void draw_run(Canvas &canvas, const Pointf &position, const TextRun &run, const Colorf &color) override;
 
 	private:
 		GlyphCache *glyph_cache = nullptr;
 		FontEngine *font_engine = nullptr;
+		bool async_rasterization = false;
 	};
 }
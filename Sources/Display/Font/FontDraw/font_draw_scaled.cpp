@@ -47,11 +47,13 @@
 
 namespace clan
 {
-	void Font_DrawScaled::init(GlyphCache *cache, FontEngine *engine, float new_scaled_height)
+	void Font_DrawScaled::init(GlyphCache *cache, FontEngine *engine, float new_scaled_height, bool new_async_rasterization, bool new_distance_field)
 	{
 		glyph_cache = cache;
 		font_engine = engine;
 		scaled_height = new_scaled_height;
+		async_rasterization = new_async_rasterization;
+		distance_field = new_distance_field;
 	}
 
 	GlyphMetrics Font_DrawScaled::get_metrics(Canvas &canvas, unsigned int glyph)
@@ -83,7 +85,7 @@ namespace clan
 			}
 
 			canvas.set_transform(original_transform * Mat4f::translate(position.x + offset_x, position.y + offset_y, 0) * scale_matrix);
-			Font_TextureGlyph *gptr = glyph_cache->get_glyph(canvas, font_engine, glyph);
+			Font_TextureGlyph *gptr = async_rasterization ? glyph_cache->get_glyph_async(canvas, font_engine, glyph) : glyph_cache->get_glyph(canvas, font_engine, glyph);
 			if (gptr)
 			{
 				if (!gptr->texture.is_null())
@@ -92,11 +94,19 @@ namespace clan
 					float yp = gptr->offset.y;
 
 					Rectf dest_size(xp, yp, gptr->size);
-					batcher->draw_image(canvas, gptr->geometry, dest_size, color, gptr->texture);
+					if (distance_field)
+						batcher->draw_glyph_distance_field(canvas, gptr->geometry, dest_size, color, gptr->texture);
+					else
+						batcher->draw_image(canvas, gptr->geometry, dest_size, color, gptr->texture);
 				}
 				offset_x += gptr->metrics.advance.width * scaled_height;
 				offset_y += gptr->metrics.advance.height * scaled_height;
 			}
+			else if (async_rasterization && glyph_cache->is_glyph_pending(glyph))
+			{
+				// Leave room for the glyph until it is ready, assuming it is about as wide as the font is high
+				offset_x += font_engine->get_metrics().get_height() * scaled_height;
+			}
 		}
 		canvas.set_transform(original_transform);
 	}
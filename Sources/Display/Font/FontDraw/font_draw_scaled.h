@@ -35,7 +35,7 @@ namespace clan
 	class Font_DrawScaled : public Font_Draw
 	{
 	public:
-		void init(GlyphCache *cache, FontEngine *engine, float new_scaled_height);
+		void init(GlyphCache *cache, FontEngine *engine, float new_scaled_height, bool new_async_rasterization, bool new_distance_field);
 
 		GlyphMetrics get_metrics(Canvas &canvas, unsigned int glyph) override;
 		void draw_text(Canvas &canvas, const Pointf &position, const std::string &text, const Colorf &color, float line_spacing) override;
@@ -43,6 +43,8 @@ namespace clan
 	private:
 		GlyphCache *glyph_cache = nullptr;
 		FontEngine *font_engine = nullptr;
+		bool async_rasterization = false;
+		bool distance_field = false;	// Glyph cache holds distance fields
 		float scaled_height = 1.0f;
 	};
 }
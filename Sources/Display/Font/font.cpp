@@ -140,6 +140,18 @@ namespace clan
 			impl->set_scalable(height_threshold);
 	}
 
+	void Font::set_async_rasterization(bool enable)
+	{
+		if (impl)
+			impl->set_async_rasterization(enable);
+	}
+
+	void Font::prefetch(Canvas &canvas, const std::string &text)
+	{
+		if (impl)
+			impl->prefetch(canvas, text);
+	}
+
 	GlyphMetrics Font::get_metrics(Canvas &canvas, unsigned int glyph)
 	{
 		if (impl)
@@ -101,6 +101,11 @@ namespace clan
 		return impl->subpixel;
 	}
 
+	bool FontDescription::get_distance_field() const
+	{
+		return impl->distance_field;
+	}
+
 	FontDescription::Charset FontDescription::get_charset() const
 	{
 		return impl->charset;
@@ -108,7 +113,7 @@ namespace clan
 
 	std::string FontDescription::get_unique_id() const
 	{
-		StringFormat format("%1-%2-%3-%4-%5-%6-%7-%8-%9");
+		StringFormat format("%1-%2-%3-%4-%5-%6-%7-%8-%9-%10");
 		format.set_arg(1, impl->anti_alias ? 1 : 0);
 		format.set_arg(2, impl->subpixel ? 1 : 0);
 		format.set_arg(3, static_cast<int>(impl->height * 10.0f + 0.5f));
@@ -118,6 +123,7 @@ namespace clan
 		format.set_arg(7, static_cast<int>(impl->weight));
 		format.set_arg(8, static_cast<int>(impl->style));
 		format.set_arg(9, impl->charset);
+		format.set_arg(10, impl->distance_field ? 1 : 0);
 		return format.get_result();
 	}
 
@@ -125,6 +131,7 @@ namespace clan
 	{
 		return 	impl->anti_alias == other.impl->anti_alias &&
 			impl->subpixel == other.impl->subpixel &&
+			impl->distance_field == other.impl->distance_field &&
 			impl->height == other.impl->height &&
 			impl->average_width == other.impl->average_width &&
 			impl->escapement == other.impl->escapement &&
@@ -192,6 +199,11 @@ namespace clan
 		impl->subpixel = setting;
 	}
 
+	void FontDescription::set_distance_field(bool setting)
+	{
+		impl->distance_field = setting;
+	}
+
 	void FontDescription::set_charset(Charset new_charset)
 	{
 		impl->charset = new_charset;
@@ -42,6 +42,7 @@ namespace clan
 		FontStyle style = FontStyle::normal;
 		bool anti_alias = true;
 		bool subpixel = true;
+		bool distance_field = false;
 		FontDescription::Charset charset = FontDescription::charset_default;
 	};
 }
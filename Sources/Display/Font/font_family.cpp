@@ -38,6 +38,7 @@
 #include "API/Display/2D/canvas.h"
 #include "API/Display/Resources/display_cache.h"
 #include "font_family_impl.h"
+#include "glyph_atlas.h"
 
 namespace clan
 {
@@ -107,6 +108,28 @@ namespace clan
 		impl->font_face_load(canvas, sprite, glyph_list, spacelen, monospace, metrics);
 	}
 
+	void FontFamily::set_glyph_cache_directory(const std::string &directory)
+	{
+		throw_if_null();
+		impl->set_glyph_cache_directory(directory);
+	}
+
+	void FontFamily::save_glyph_caches(Canvas &canvas)
+	{
+		throw_if_null();
+		impl->save_glyph_caches(canvas);
+	}
+
+	void FontFamily::set_glyph_atlas_budget(uint64_t bytes)
+	{
+		GlyphAtlas::instance().set_budget(bytes);
+	}
+
+	uint64_t FontFamily::get_glyph_atlas_usage()
+	{
+		return GlyphAtlas::instance().get_usage();
+	}
+
 	void FontFamily::throw_if_null() const
 	{
 		if (!impl)
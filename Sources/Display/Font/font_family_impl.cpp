@@ -41,6 +41,10 @@
 #include "API/Display/2D/path.h"
 #include "API/Display/Resources/display_cache.h"
 #include "API/Core/IOData/path_help.h"
+#include "API/Core/IOData/file.h"
+#include "API/Core/IOData/file_help.h"
+#include "API/Core/IOData/directory.h"
+#include "API/Core/Crypto/sha1.h"
 #include "Display/2D/canvas_impl.h"
 #include "Display/2D/sprite_impl.h"
 
@@ -76,7 +80,32 @@ namespace clan
 		FontMetrics font_metrics;
 	};
 
-	FontFamily_Impl::FontFamily_Impl(const std::string &family_name) : family_name(family_name), texture_group(Size(256, 256))
+	namespace
+	{
+		// Font caches of every family, so families and windows using the same font share its engine and glyphs
+		class SharedFontCaches
+		{
+		public:
+			class Entry
+			{
+			public:
+				std::weak_ptr<FontEngine> engine;
+				std::weak_ptr<GlyphCache> glyph_cache;
+				std::weak_ptr<PathCache> path_cache;
+			};
+
+			std::mutex mutex;
+			std::map<std::string, Entry> entries;	// Keyed by Font_Cache::persist_key
+		};
+
+		SharedFontCaches &get_shared_font_caches()
+		{
+			static SharedFontCaches shared_caches;
+			return shared_caches;
+		}
+	}
+
+	FontFamily_Impl::FontFamily_Impl(const std::string &family_name) : family_name(family_name)
 	{
 	}
 
@@ -89,6 +118,7 @@ namespace clan
 		FontFamily_Definition definition;
 		definition.desc = desc.clone();
 		definition.font_databuffer = font_databuffer;
+		definition.font_hash = get_font_hash(font_databuffer);
 		font_definitions.push_back(definition);
 	}
 
@@ -100,34 +130,24 @@ namespace clan
 		font_definitions.push_back(definition);
 	}
 
-	void FontFamily_Impl::font_face_load(const FontDescription &desc, DataBuffer &font_databuffer, float pixel_ratio)
+	void FontFamily_Impl::font_face_load(const FontDescription &desc, DataBuffer &font_databuffer, const std::string &font_hash, float pixel_ratio)
 	{
+		std::string persist_key = get_persist_key(desc, font_hash, pixel_ratio);
 #if defined(WIN32)
-		std::shared_ptr<FontEngine> engine = std::make_shared<FontEngine_Win32>(desc, font_databuffer, pixel_ratio);
-		font_cache.push_back(Font_Cache(engine));
+		add_font_cache(persist_key, pixel_ratio, [&]() { return std::make_shared<FontEngine_Win32>(desc, font_databuffer, pixel_ratio); });
 #elif defined(__APPLE__)
-		std::shared_ptr<FontEngine> engine = std::make_shared<FontEngine_Cocoa>(desc, font_databuffer, pixel_ratio);
-		font_cache.push_back(Font_Cache(engine));
+		add_font_cache(persist_key, pixel_ratio, [&]() { return std::make_shared<FontEngine_Cocoa>(desc, font_databuffer, pixel_ratio); });
 #else
-		std::shared_ptr<FontEngine> engine = std::make_shared<FontEngine_Freetype>(desc, font_databuffer, pixel_ratio);
-		font_cache.push_back(Font_Cache(engine));
+		add_font_cache(persist_key, pixel_ratio, [&]() { return std::make_shared<FontEngine_Freetype>(desc, font_databuffer, pixel_ratio); });
 #endif
-		font_cache.back().glyph_cache->set_texture_group(texture_group);
-		font_cache.back().pixel_ratio = pixel_ratio;
 	}
 
 	void FontFamily_Impl::font_face_load(const FontDescription &desc, const std::string &typeface_name, float pixel_ratio)
 	{
 #if defined(WIN32)
-		std::shared_ptr<FontEngine> engine = std::make_shared<FontEngine_Win32>(desc, typeface_name, pixel_ratio);
-		font_cache.push_back(Font_Cache(engine));
-		font_cache.back().glyph_cache->set_texture_group(texture_group);
-		font_cache.back().pixel_ratio = pixel_ratio;
+		add_font_cache(get_persist_key(desc, typeface_name, pixel_ratio), pixel_ratio, [&]() { return std::make_shared<FontEngine_Win32>(desc, typeface_name, pixel_ratio); });
 #elif defined(__APPLE__)
-		std::shared_ptr<FontEngine> engine = std::make_shared<FontEngine_Cocoa>(desc, typeface_name, pixel_ratio);
-		font_cache.push_back(Font_Cache(engine));
-		font_cache.back().glyph_cache->set_texture_group(texture_group);
-		font_cache.back().pixel_ratio = pixel_ratio;
+		add_font_cache(get_persist_key(desc, typeface_name, pixel_ratio), pixel_ratio, [&]() { return std::make_shared<FontEngine_Cocoa>(desc, typeface_name, pixel_ratio); });
 #elif defined(__ANDROID__)
 		throw Exception("automatic typeface to ttf file selection is not supported on android");
 #else
@@ -142,10 +162,41 @@ namespace clan
 		DataBuffer font_databuffer;
 		font_databuffer.set_size(file.get_size());
 		file.read(font_databuffer.get_data(), font_databuffer.get_size());
-		font_face_load(desc, font_databuffer, pixel_ratio);
+		font_face_load(desc, font_databuffer, get_font_hash(font_databuffer), pixel_ratio);
 #endif
 	}
 
+	void FontFamily_Impl::add_font_cache(const std::string &persist_key, float pixel_ratio, const std::function<std::shared_ptr<FontEngine>()> &create_engine)
+	{
+		SharedFontCaches &shared_caches = get_shared_font_caches();
+		std::unique_lock<std::mutex> lock(shared_caches.mutex);
+
+		SharedFontCaches::Entry &entry = shared_caches.entries[persist_key];
+		Font_Cache cache;
+		cache.engine = entry.engine.lock();
+		cache.glyph_cache = entry.glyph_cache.lock();
+		cache.path_cache = entry.path_cache.lock();
+		if (!cache.engine || !cache.glyph_cache || !cache.path_cache)
+		{
+			std::shared_ptr<FontEngine> engine = create_engine();
+			cache = Font_Cache(engine);
+			entry.engine = cache.engine;
+			entry.glyph_cache = cache.glyph_cache;
+			entry.path_cache = cache.path_cache;
+		}
+		cache.pixel_ratio = pixel_ratio;
+		cache.persist_key = persist_key;
+		font_cache.push_back(cache);
+	}
+
+	std::string FontFamily_Impl::get_font_hash(DataBuffer &font_databuffer)
+	{
+		SHA1 sha1;
+		sha1.add(font_databuffer);
+		sha1.calculate();
+		return sha1.get_hash();
+	}
+
 	void FontFamily_Impl::font_face_load(Canvas &canvas, Sprite &sprite, const std::string &glyph_list, float spacelen, bool monospace, const FontMetrics &metrics)
 	{
 		FontMetrics font_metrics = metrics;
@@ -311,6 +362,8 @@ namespace clan
 				continue;
 			if (desc.get_anti_alias() != cache.engine->get_desc().get_anti_alias())
 				continue;
+			if (desc.get_distance_field() != cache.engine->get_desc().get_distance_field())
+				continue;
 
 			if (cache.engine->is_automatic_recreation_allowed())
 			{
@@ -362,7 +415,7 @@ namespace clan
 			if (!font_definition.font_databuffer.is_null())
 			{
 				// Cached font is allocated via a font databuffer
-				font_face_load(desc, font_definition.font_databuffer, pixel_ratio);
+				font_face_load(desc, font_definition.font_databuffer, font_definition.font_hash, pixel_ratio);
 			}
 			else
 			{
@@ -373,4 +426,54 @@ namespace clan
 
 		return font_cache.back();
 	}
+
+	std::string FontFamily_Impl::get_persist_key(const FontDescription &desc, const std::string &font_hash, float pixel_ratio) const
+	{
+		return string_format("%1-%2-%3", font_hash, desc.get_unique_id(), static_cast<int>(pixel_ratio * 100.0f + 0.5f));
+	}
+
+	std::string FontFamily_Impl::get_glyph_cache_filename(const Font_Cache &cache) const
+	{
+		// The key is too long for a filename, and typeface names may contain invalid characters
+		SHA1 sha1;
+		sha1.add(cache.persist_key.data(), cache.persist_key.length());
+		sha1.calculate();
+		return PathHelp::combine(glyph_cache_directory, sha1.get_hash() + ".glyphcache");
+	}
+
+	void FontFamily_Impl::load_glyph_cache(Canvas &canvas, Font_Cache &cache)
+	{
+		if (glyph_cache_directory.empty() || cache.persist_key.empty() || cache.glyph_cache->is_loaded())
+			return;
+
+		std::string filename = get_glyph_cache_filename(cache);
+		if (!FileHelp::file_exists(filename))
+			return;
+
+		try
+		{
+			File file(filename);
+			cache.glyph_cache->load(canvas, file, cache.persist_key);
+		}
+		catch (const Exception &)
+		{
+			// A damaged cache file only costs the time to rasterize the glyphs again
+		}
+	}
+
+	void FontFamily_Impl::save_glyph_caches(Canvas &canvas)
+	{
+		if (glyph_cache_directory.empty())
+			throw Exception("FontFamily glyph cache directory has not been set");
+
+		Directory::create(glyph_cache_directory, true);
+		for (auto &cache : font_cache)
+		{
+			if (cache.persist_key.empty())
+				continue;
+
+			File file(get_glyph_cache_filename(cache), File::create_always, File::access_write);
+			cache.glyph_cache->save(canvas, file, cache.persist_key);
+		}
+	}
 }
@@ -34,6 +34,7 @@
 #include "API/Display/Font/glyph_metrics.h"
 #include "API/Display/Font/font_family.h"
 #include "API/Display/Render/texture_2d.h"
+#include <functional>
 #include <list>
 #include <map>
 #include "glyph_cache.h"
@@ -52,6 +53,7 @@ namespace clan
 		std::shared_ptr<GlyphCache> glyph_cache;
 		std::shared_ptr<PathCache> path_cache;
 		float pixel_ratio = 1.0f;	// The pixel ratio this font was created for.
+		std::string persist_key;	// Identifies the font data, description and pixel ratio. Shared between families and used in glyph cache files. Empty = Sprite font
 	};
 
 	class FontFamily_Definition
@@ -60,6 +62,7 @@ namespace clan
 		FontDescription desc;
 		std::string typeface_name;	// Empty = use font_databuffer instead
 		DataBuffer font_databuffer;	// Empty = use typeface_name instead
+		std::string font_hash;	// Hash of font_databuffer
 	};
 
 	class FontFamily_Impl
@@ -81,13 +84,24 @@ namespace clan
 		// Find font and copy it using the revised description
 		Font_Cache copy_font(const FontDescription &desc, float pixel_ratio);
 
+		void set_glyph_cache_directory(const std::string &directory) { glyph_cache_directory = directory; }
+
+		// Adds the glyphs persisted for this font, if any
+		void load_glyph_cache(Canvas &canvas, Font_Cache &cache);
+
+		void save_glyph_caches(Canvas &canvas);
+
 	private:
 		void font_face_load(const FontDescription &desc, const std::string &typeface_name, float pixel_ratio);
-		void font_face_load(const FontDescription &desc, DataBuffer &font_databuffer, float pixel_ratio);
+		void font_face_load(const FontDescription &desc, DataBuffer &font_databuffer, const std::string &font_hash, float pixel_ratio);
+		void add_font_cache(const std::string &persist_key, float pixel_ratio, const std::function<std::shared_ptr<FontEngine>()> &create_engine);
+		static std::string get_font_hash(DataBuffer &font_databuffer);
+		std::string get_persist_key(const FontDescription &desc, const std::string &font_hash, float pixel_ratio) const;
+		std::string get_glyph_cache_filename(const Font_Cache &cache) const;
 
 		std::string family_name;
-		TextureGroup texture_group;		// Shared texture group between glyph cache's
 		std::vector<Font_Cache> font_cache;
 		std::vector<FontFamily_Definition> font_definitions;
+		std::string glyph_cache_directory;	// Empty = Glyph caches are not persisted
 	};
 }
@@ -67,24 +67,41 @@ namespace clan
 		{
 			// Copy the required font, setting a scalable font size
 			FontDescription new_selected = selected_description.clone();
-			if (selected_description.get_height() >= selected_height_threshold)
-				new_selected.set_height(256.0f);	// A reasonable scalable size
+			bool distance_field = selected_description.get_distance_field() && RenderBatchTriangle::distance_fields_supported;
+			if (distance_field)
+			{
+				// Every size is drawn from one set of glyphs, rasterized at a base size
+				new_selected.set_height(distance_field_base_height);
+				new_selected.set_subpixel(false);
+			}
+			else
+			{
+				new_selected.set_distance_field(false);
+				if (selected_description.get_height() >= selected_height_threshold)
+					new_selected.set_height(256.0f);	// A reasonable scalable size
+			}
 
 			selected_pixel_ratio = pixel_ratio;
+			text_runs.clear();
 
 			Font_Cache font_cache = font_family.impl->get_font(new_selected, pixel_ratio);
 			if (!font_cache.engine)	// Font not found
+			{
 				font_cache = font_family.impl->copy_font(new_selected, pixel_ratio);
+				if (distance_field)
+					font_cache.glyph_cache->set_distance_field(true);
+				font_family.impl->load_glyph_cache(canvas, font_cache);
+			}
 
 			font_engine = font_cache.engine.get();
-			GlyphCache *glyph_cache = font_cache.glyph_cache.get();
-			PathCache *path_cache = font_cache.path_cache.get();
+			glyph_cache = font_cache.glyph_cache.get();
+			path_cache = font_cache.path_cache.get();
 
 			const FontMetrics &metrics = font_engine->get_metrics();
 
 			// Determine if pathfont method is required. TODO: This feels a bit hacky
 			selected_pathfont = font_engine->is_automatic_recreation_allowed();
-			if (selected_description.get_height() < selected_height_threshold)
+			if (selected_description.get_height() < selected_height_threshold || distance_field)
 				selected_pathfont = false;
 
 			// Deterimine if font scaling is required
@@ -101,22 +118,27 @@ namespace clan
 				font_draw_path.init(path_cache, font_engine, scaled_height);
 				font_draw = &font_draw_path;
 			}
+			else if (distance_field)
+			{
+				font_draw_scaled.init(glyph_cache, font_engine, scaled_height, async_rasterization, true);
+				font_draw = &font_draw_scaled;
+			}
 			else if (scaled_height == 1.0f)
 			{
 				if (font_engine->get_desc().get_subpixel())
 				{
-					font_draw_subpixel.init(glyph_cache, font_engine);
+					font_draw_subpixel.init(glyph_cache, font_engine, async_rasterization);
 					font_draw = &font_draw_subpixel;
 				}
 				else
 				{
-					font_draw_flat.init(glyph_cache, font_engine);
+					font_draw_flat.init(glyph_cache, font_engine, async_rasterization);
 					font_draw = &font_draw_flat;
 				}
 			}
 			else
 			{
-				font_draw_scaled.init(glyph_cache, font_engine, scaled_height);
+				font_draw_scaled.init(glyph_cache, font_engine, scaled_height, async_rasterization, false);
 				font_draw = &font_draw_scaled;
 			}
 
@@ -243,6 +265,7 @@ namespace clan
 	void Font_Impl::get_glyph_path(Canvas &canvas, unsigned int glyph_index, Path &out_path, GlyphMetrics &out_metrics)
 	{
 		select_font_family(canvas);
+		std::unique_lock<std::mutex> lock = glyph_cache->lock_engine();
 		return font_engine->load_glyph_path(glyph_index, out_path, out_metrics);
 	}
 
@@ -260,7 +283,14 @@ namespace clan
 
 		float line_spacing = std::round(selected_line_height); // TBD: do we want to round this?
 		Pointf pos = canvas.grid_fit(position);
-		font_draw->draw_text(canvas, pos, text, color, line_spacing);
+
+		glyph_cache->release_evicted_glyphs();	// Runs holding them are shaped again, as the generation has changed
+
+		TextRun &run = text_runs.get_run(text);
+		if ((run.shaped && run.generation == glyph_cache->get_generation()) || font_draw->shape_text(canvas, text, line_spacing, run))
+			font_draw->draw_run(canvas, pos, run, color);
+		else
+			font_draw->draw_text(canvas, pos, text, color, line_spacing);
 	}
 
 	GlyphMetrics Font_Impl::get_metrics(Canvas &canvas, unsigned int glyph)
@@ -277,6 +307,11 @@ namespace clan
 	GlyphMetrics Font_Impl::measure_text(Canvas &canvas, const std::string &string)
 	{
 		select_font_family(canvas);
+
+		TextRun &run = text_runs.get_run(string);
+		if (run.measured)
+			return run.metrics;
+
 		GlyphMetrics total_metrics;
 
 		float line_spacing = std::round(selected_line_height); // TBD: do we want to round this?
@@ -322,6 +357,8 @@ namespace clan
 		total_metrics.bbox_offset *= scaled_height;
 		total_metrics.bbox_size *= scaled_height;
 
+		run.metrics = total_metrics;
+		run.measured = true;
 		return total_metrics;
 	}
 
@@ -345,7 +382,11 @@ namespace clan
 
 	void Font_Impl::set_line_height(float height)
 	{
-		selected_line_height = height;
+		if (selected_line_height != height)
+		{
+			selected_line_height = height;
+			text_runs.clear();
+		}
 		// (Don't need to reset the font engine)
 	}
 
@@ -363,4 +404,35 @@ namespace clan
 		selected_height_threshold = height_threshold;
 		// (Don't need to reset the font engine)
 	}
+
+	void Font_Impl::set_async_rasterization(bool enable)
+	{
+		if (async_rasterization != enable)
+		{
+			async_rasterization = enable;
+			font_engine = nullptr;
+		}
+	}
+
+	void Font_Impl::prefetch(Canvas &canvas, const std::string &text)
+	{
+		select_font_family(canvas);
+
+		UTF8_Reader reader(text.data(), text.length());
+		while (!reader.is_end())
+		{
+			unsigned int glyph = reader.get_char();
+			reader.next();
+
+			if (glyph == '\n')
+				continue;
+
+			if (selected_pathfont)
+				path_cache->get_glyph(canvas, font_engine, glyph);
+			else if (async_rasterization)
+				glyph_cache->queue_glyph(font_engine, glyph);
+			else
+				glyph_cache->get_glyph(canvas, font_engine, glyph);
+		}
+	}
 }
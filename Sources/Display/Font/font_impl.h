@@ -40,6 +40,7 @@
 #include "glyph_cache.h"
 #include "path_cache.h"
 #include "font_family_impl.h"
+#include "text_run_cache.h"
 
 #include "FontDraw/font_draw_subpixel.h"
 #include "FontDraw/font_draw_flat.h"
@@ -76,6 +77,8 @@ namespace clan
 		void set_line_height(float height);
 		void set_style(FontStyle setting);
 		void set_scalable(float height_threshold);
+		void set_async_rasterization(bool enable);
+		void prefetch(Canvas &canvas, const std::string &text);
 		FontHandle *get_handle(Canvas &canvas);
 
 	private:
@@ -87,13 +90,19 @@ namespace clan
 		float scaled_height = 1.0f;
 		float selected_height_threshold = 64.0f;		// Values greater or equal to this value can be drawn scaled
 		bool selected_pathfont = false;
+		bool async_rasterization = false;
+
+		static constexpr float distance_field_base_height = 48.0f;	// Height distance field glyphs are rasterized at
 
 		FontMetrics selected_metrics;
 
 		FontEngine *font_engine = nullptr;	// If null, use select_font_family() to update
+		GlyphCache *glyph_cache = nullptr;
+		PathCache *path_cache = nullptr;
 		FontFamily font_family;
 
 		Font_Draw *font_draw = nullptr;
+		TextRunCache text_runs;	// Cleared when the font is selected again or the line height changes
 
 		Font_DrawSubPixel font_draw_subpixel;
 		Font_DrawFlat font_draw_flat;
@@ -0,0 +1,117 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+*/
+
+#include "Display/precomp.h"
+#include "glyph_atlas.h"
+#include "glyph_cache.h"
+#include "API/Display/Render/graphic_context.h"
+#include <algorithm>
+
+namespace clan
+{
+	uint64_t GlyphAtlasPage::use_counter = 0;
+
+	GlyphAtlas::GlyphAtlas() : texture_group(Size(page_size, page_size))
+	{
+	}
+
+	GlyphAtlas &GlyphAtlas::instance()
+	{
+		static GlyphAtlas atlas;
+		return atlas;
+	}
+
+	Subtexture GlyphAtlas::add(GraphicContext &gc, const Size &size, GlyphCache *cache, GlyphAtlasPage *&out_page)
+	{
+		Subtexture sub_texture = texture_group.add(gc, size);
+
+		auto it = std::find_if(pages.begin(), pages.end(), [&](const std::unique_ptr<GlyphAtlasPage> &page) { return page->texture == sub_texture.get_texture(); });
+		if (it == pages.end())
+		{
+			pages.push_back(std::unique_ptr<GlyphAtlasPage>(new GlyphAtlasPage()));
+			pages.back()->texture = sub_texture.get_texture();
+			it = pages.end() - 1;
+		}
+
+		out_page = it->get();
+		out_page->touch();
+		if (std::find(out_page->caches.begin(), out_page->caches.end(), cache) == out_page->caches.end())
+			out_page->caches.push_back(cache);
+
+		evict_to_budget(out_page);
+		return sub_texture;
+	}
+
+	void GlyphAtlas::remove_cache(GlyphCache *cache)
+	{
+		for (auto &page : pages)
+			page->caches.erase(std::remove(page->caches.begin(), page->caches.end(), cache), page->caches.end());
+	}
+
+	void GlyphAtlas::set_budget(uint64_t bytes)
+	{
+		budget = bytes;
+		evict_to_budget(nullptr);
+	}
+
+	uint64_t GlyphAtlas::get_usage() const
+	{
+		uint64_t usage = 0;
+		for (auto &page : pages)
+			usage += (uint64_t)page->texture.get_width() * page->texture.get_height() * 4;
+		return usage;
+	}
+
+	void GlyphAtlas::evict_to_budget(GlyphAtlasPage *keep)
+	{
+		uint64_t usage = get_usage();
+		while (usage > budget)
+		{
+			auto victim = pages.end();
+			for (auto it = pages.begin(); it != pages.end(); ++it)
+			{
+				if (it->get() == keep)
+					continue;
+
+				// Pages only used by destroyed caches go first
+				if (victim == pages.end() || std::make_pair(!(*it)->caches.empty(), (*it)->last_used) < std::make_pair(!(*victim)->caches.empty(), (*victim)->last_used))
+					victim = it;
+			}
+			if (victim == pages.end())
+				break;
+
+			GlyphAtlasPage *page = victim->get();
+			for (GlyphCache *cache : page->caches)
+				cache->evict_page(page);
+
+			usage -= (uint64_t)page->texture.get_width() * page->texture.get_height() * 4;
+			texture_group.remove_texture(page->texture);
+			pages.erase(victim);
+		}
+	}
+}
@@ -0,0 +1,89 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+*/
+
+#pragma once
+
+#include "API/Display/2D/texture_group.h"
+#include "API/Display/2D/subtexture.h"
+#include "API/Display/Render/texture_2d.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace clan
+{
+	class GlyphCache;
+	class GraphicContext;
+
+	/// \brief Texture of the glyph atlas
+	class GlyphAtlasPage
+	{
+	public:
+		/// \brief Marks the page as used, so it is evicted after pages used less recently
+		void touch() { last_used = ++use_counter; }
+
+		Texture2D texture;
+		uint64_t last_used = 0;
+		std::vector<GlyphCache *> caches;	// Glyph caches with glyphs on this page
+
+	private:
+		static uint64_t use_counter;
+		friend class GlyphAtlas;
+	};
+
+	/// \brief Atlas textures shared by the glyph caches of all fonts
+	///
+	/// The textures are shared by all windows, which requires the graphic contexts to share objects.
+	/// Once the textures exceed the budget, the least recently used page is evicted and its glyphs are
+	/// rasterized again when they are needed.
+	class GlyphAtlas
+	{
+	public:
+		static GlyphAtlas &instance();
+
+		/// \brief Allocates space for a glyph of cache, returning the page it is on
+		Subtexture add(GraphicContext &gc, const Size &size, GlyphCache *cache, GlyphAtlasPage *&out_page);
+
+		/// \brief Forgets a glyph cache that is being destroyed. Its glyphs stay allocated until their pages are evicted.
+		void remove_cache(GlyphCache *cache);
+
+		void set_budget(uint64_t bytes);
+		uint64_t get_budget() const { return budget; }
+		uint64_t get_usage() const;
+
+	private:
+		GlyphAtlas();
+		void evict_to_budget(GlyphAtlasPage *keep);
+
+		TextureGroup texture_group;
+		std::vector<std::unique_ptr<GlyphAtlasPage>> pages;
+		uint64_t budget = 64 * 1024 * 1024;
+
+		static const int page_size = 256;
+	};
+}
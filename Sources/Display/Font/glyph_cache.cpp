@@ -44,48 +44,140 @@
 #include "API/Core/Text/string_format.h"
 #include "API/Core/Text/string_help.h"
 #include "API/Core/Text/utf8_reader.h"
+#include "API/Core/System/work_queue.h"
+#include "API/Core/IOData/iodevice.h"
 #include "Display/2D/render_batch_triangle.h"
 #include "Display/Render/graphic_context_impl.h"
+#include <algorithm>
+#include <cmath>
 
 namespace clan
 {
-	GlyphCache::GlyphCache()
+	namespace
+	{
+		// A single serial worker, so font engines never see two glyph requests at the same time
+		WorkQueue &get_raster_queue()
+		{
+			static WorkQueue queue(true);
+			return queue;
+		}
+	}
+
+	GlyphCache::GlyphCache() : async_state(std::make_shared<AsyncState>())
 	{
 		glyph_list.reserve(256);
 	}
 
 	GlyphCache::~GlyphCache()
 	{
+		// Waits for a glyph being rasterized, as the engine may be destroyed after this cache
+		std::unique_lock<std::mutex> lock(async_state->mutex);
+		async_state->cancelled = true;
+		GlyphAtlas::instance().remove_cache(this);
 	}
 
 	Font_TextureGlyph *GlyphCache::get_glyph(Canvas &canvas, FontEngine *font_engine, unsigned int glyph)
 	{
-		auto size = glyph_list.size();
-		for (int cnt = 0; cnt < size; cnt++)
+		Font_TextureGlyph *font_glyph = glyph_lookup.find(glyph);
+		if (font_glyph)
 		{
-			if (glyph_list[cnt]->glyph == glyph)
-				return &(*glyph_list[cnt]);
+			if (font_glyph->atlas_page)
+				font_glyph->atlas_page->touch();
+			return font_glyph;
+		}
+
+		if (!pending_glyphs.empty())
+		{
+			insert_completed_glyphs(canvas);
+			font_glyph = glyph_lookup.find(glyph);
+			if (font_glyph)
+				return font_glyph;
 		}
 
 		// If glyph does not exist, create one automatically
-		FontPixelBuffer pb = font_engine->get_font_glyph(glyph);
+		FontPixelBuffer pb;
+		{
+			std::unique_lock<std::mutex> lock(async_state->mutex);
+			pb = font_engine->get_font_glyph(glyph);
+		}
 		if (pb.glyph)	// Ignore invalid glyphs
 			insert_glyph(canvas, pb);
 
-		// Search for the glyph again
-		size = glyph_list.size();
-		for (int cnt = 0; cnt < size; cnt++)
+		return glyph_lookup.find(glyph);
+	}
+
+	Font_TextureGlyph *GlyphCache::get_glyph_async(Canvas &canvas, FontEngine *font_engine, unsigned int glyph)
+	{
+		Font_TextureGlyph *font_glyph = glyph_lookup.find(glyph);
+		if (font_glyph)
 		{
-			if (glyph_list[cnt]->glyph == glyph)
-				return &(*glyph_list[cnt]);
+			if (font_glyph->atlas_page)
+				font_glyph->atlas_page->touch();
+			return font_glyph;
 		}
 
+		if (glyph < 256)
+			return get_glyph(canvas, font_engine, glyph);
+
+		if (!pending_glyphs.empty())
+		{
+			insert_completed_glyphs(canvas);
+			font_glyph = glyph_lookup.find(glyph);
+			if (font_glyph)
+				return font_glyph;
+		}
+
+		queue_glyph(font_engine, glyph);
 		return nullptr;
 	}
 
-	void GlyphCache::set_texture_group(TextureGroup &new_texture_group)
+	void GlyphCache::queue_glyph(FontEngine *font_engine, unsigned int glyph)
+	{
+		if (glyph_lookup.find(glyph) || is_glyph_pending(glyph) || invalid_glyphs.find(glyph) != invalid_glyphs.end())
+			return;
+
+		pending_glyphs.insert(glyph);
+		std::shared_ptr<AsyncState> state = async_state;
+		get_raster_queue().queue([state, font_engine, glyph]()
+		{
+			std::unique_lock<std::mutex> lock(state->mutex);
+			if (!state->cancelled)
+				state->completed.push_back(std::make_pair(glyph, font_engine->get_font_glyph(glyph)));
+		});
+	}
+
+	void GlyphCache::insert_completed_glyphs(Canvas &canvas)
+	{
+		std::vector<std::pair<unsigned int, FontPixelBuffer>> completed;
+		{
+			std::unique_lock<std::mutex> lock(async_state->mutex);
+			completed.swap(async_state->completed);
+		}
+
+		for (auto &item : completed)
+		{
+			pending_glyphs.erase(item.first);
+			if (!item.second.glyph)
+				invalid_glyphs.insert(item.first);
+			else if (!glyph_lookup.find(item.first))	// get_glyph() may have needed it first
+				insert_glyph(canvas, item.second);
+		}
+	}
+
+	void GlyphCache::evict_page(GlyphAtlasPage *page)
 	{
-		texture_group = new_texture_group;
+		auto it = std::stable_partition(glyph_list.begin(), glyph_list.end(), [&](const std::unique_ptr<Font_TextureGlyph> &font_glyph) { return font_glyph->atlas_page != page; });
+		if (it == glyph_list.end())
+			return;
+
+		for (auto evicted = it; evicted != glyph_list.end(); ++evicted)
+		{
+			glyph_lookup.erase((*evicted)->glyph);
+			(*evicted)->atlas_page = nullptr;
+			evicted_glyphs.push_back(std::move(*evicted));
+		}
+		glyph_list.erase(it, glyph_list.end());
+		generation++;
 	}
 
 	GlyphMetrics GlyphCache::get_metrics(FontEngine *font_engine, Canvas &canvas, unsigned int glyph)
@@ -108,18 +200,209 @@ namespace clan
 
 		if (!pb.empty_buffer)
 		{
-			PixelBuffer buffer_with_border = PixelBufferHelp::add_border(pb.buffer, glyph_border_size, pb.buffer_rect);
+			PixelBuffer buffer = pb.buffer;
+			Rect buffer_rect = pb.buffer_rect;
+			Sizef size = pb.size;
+			if (distance_field)
+			{
+				float pixel_ratio = canvas.get_gc().get_pixel_ratio();
+				if (pixel_ratio == 0.0f)
+					pixel_ratio = 1.0f;
+
+				buffer = create_distance_field(pb.buffer, pb.buffer_rect, distance_field_spread);
+				buffer_rect = buffer.get_size();
+				size = Sizef(buffer.get_width() / pixel_ratio, buffer.get_height() / pixel_ratio);
+				font_glyph->offset.x -= distance_field_spread / pixel_ratio;
+				font_glyph->offset.y -= distance_field_spread / pixel_ratio;
+			}
+
+			PixelBuffer buffer_with_border = PixelBufferHelp::add_border(buffer, glyph_border_size, buffer_rect);
 			GraphicContext gc = canvas.get_gc();
-			Subtexture sub_texture = texture_group.add(gc, buffer_with_border.get_size());
+			Subtexture sub_texture = GlyphAtlas::instance().add(gc, buffer_with_border.get_size(), this, font_glyph->atlas_page);
 			font_glyph->texture = sub_texture.get_texture();
-			font_glyph->geometry = Rect(sub_texture.get_geometry().left + glyph_border_size, sub_texture.get_geometry().top + glyph_border_size, pb.buffer_rect.get_size());
-			font_glyph->size = pb.size;
+			font_glyph->geometry = Rect(sub_texture.get_geometry().left + glyph_border_size, sub_texture.get_geometry().top + glyph_border_size, buffer_rect.get_size());
+			font_glyph->size = size;
 			sub_texture.get_texture().set_subimage(gc, sub_texture.get_geometry().left, sub_texture.get_geometry().top, buffer_with_border, buffer_with_border.get_size());
 		}
 
+		glyph_lookup.insert(font_glyph.get());
 		glyph_list.push_back(std::move(font_glyph));
 	}
 
+	void GlyphCache::save(Canvas &canvas, IODevice &file, const std::string &key)
+	{
+		// Find the atlas pages used by this cache
+		std::vector<Texture2D> pages;
+		std::vector<int> glyph_pages;
+		for (auto &font_glyph : glyph_list)
+		{
+			int page = -1;
+			if (!font_glyph->texture.is_null())
+			{
+				page = std::find(pages.begin(), pages.end(), font_glyph->texture) - pages.begin();
+				if (page == (int)pages.size())
+					pages.push_back(font_glyph->texture);
+			}
+			glyph_pages.push_back(page);
+		}
+
+		file.write_uint32(persist_magic);
+		file.write_uint32(persist_version);
+		file.write_string_a(key);
+
+		GraphicContext gc = canvas.get_gc();
+		file.write_int32(pages.size());
+		for (auto &page : pages)
+		{
+			PixelBuffer pixels = page.get_pixeldata(gc, tf_rgba8);
+			file.write_int32(pixels.get_width());
+			file.write_int32(pixels.get_height());
+			for (int y = 0; y < pixels.get_height(); y++)
+				file.write(pixels.get_line(y), pixels.get_width() * 4);
+		}
+
+		file.write_int32(glyph_list.size());
+		for (size_t i = 0; i < glyph_list.size(); i++)
+		{
+			const Font_TextureGlyph &font_glyph = *glyph_list[i];
+			file.write_uint32(font_glyph.glyph);
+			file.write_int32(glyph_pages[i]);
+			file.write_int32(font_glyph.geometry.left);
+			file.write_int32(font_glyph.geometry.top);
+			file.write_int32(font_glyph.geometry.right);
+			file.write_int32(font_glyph.geometry.bottom);
+			file.write_float(font_glyph.offset.x);
+			file.write_float(font_glyph.offset.y);
+			file.write_float(font_glyph.size.width);
+			file.write_float(font_glyph.size.height);
+			file.write_float(font_glyph.metrics.bbox_offset.x);
+			file.write_float(font_glyph.metrics.bbox_offset.y);
+			file.write_float(font_glyph.metrics.bbox_size.width);
+			file.write_float(font_glyph.metrics.bbox_size.height);
+			file.write_float(font_glyph.metrics.advance.width);
+			file.write_float(font_glyph.metrics.advance.height);
+		}
+	}
+
+	bool GlyphCache::load(Canvas &canvas, IODevice &file, const std::string &key)
+	{
+		loaded = true;
+		if (file.read_uint32() != persist_magic || file.read_uint32() != persist_version || file.read_string_a() != key)
+			return false;
+
+		GraphicContext gc = canvas.get_gc();
+		int page_count = file.read_int32();
+		if (page_count < 0)
+			throw Exception("Glyph cache file contains an invalid atlas page count");
+		std::vector<Texture2D> pages(page_count);
+		for (auto &page : pages)
+		{
+			int width = file.read_int32();
+			int height = file.read_int32();
+			if (width <= 0 || height <= 0)
+				throw Exception("Glyph cache file contains an invalid atlas page");
+
+			PixelBuffer pixels(width, height, tf_rgba8);
+			for (int y = 0; y < height; y++)
+			{
+				if (file.read(pixels.get_line(y), width * 4) != width * 4)
+					throw Exception("Glyph cache file is truncated");
+			}
+			page = Texture2D(gc, pixels);
+		}
+
+		int glyph_count = file.read_int32();
+		for (int i = 0; i < glyph_count; i++)
+		{
+			auto font_glyph = std::unique_ptr<Font_TextureGlyph>(new Font_TextureGlyph());
+			font_glyph->glyph = file.read_uint32();
+			int page = file.read_int32();
+			font_glyph->geometry.left = file.read_int32();
+			font_glyph->geometry.top = file.read_int32();
+			font_glyph->geometry.right = file.read_int32();
+			font_glyph->geometry.bottom = file.read_int32();
+			font_glyph->offset.x = file.read_float();
+			font_glyph->offset.y = file.read_float();
+			font_glyph->size.width = file.read_float();
+			font_glyph->size.height = file.read_float();
+			font_glyph->metrics.bbox_offset.x = file.read_float();
+			font_glyph->metrics.bbox_offset.y = file.read_float();
+			font_glyph->metrics.bbox_size.width = file.read_float();
+			font_glyph->metrics.bbox_size.height = file.read_float();
+			font_glyph->metrics.advance.width = file.read_float();
+			font_glyph->metrics.advance.height = file.read_float();
+
+			if (page >= (int)pages.size())
+				throw Exception("Glyph cache file refers to a missing atlas page");
+			if (page >= 0)
+				font_glyph->texture = pages[page];
+
+			if (!glyph_lookup.find(font_glyph->glyph))
+			{
+				glyph_lookup.insert(font_glyph.get());
+				glyph_list.push_back(std::move(font_glyph));
+			}
+		}
+		return true;
+	}
+
+	PixelBuffer GlyphCache::create_distance_field(const PixelBuffer &coverage, const Rect &rect, int spread)
+	{
+		PixelBuffer source = coverage.get_format() == tf_rgba8 ? coverage : coverage.to_format(tf_rgba8);
+		const unsigned char *src_data = source.get_data_uint8();
+		int src_pitch = source.get_pitch();
+
+		// A texel is inside the glyph when its coverage is at least half
+		auto is_inside = [&](int x, int y)
+		{
+			if (x < 0 || y < 0 || x >= rect.get_width() || y >= rect.get_height())
+				return false;
+			return src_data[(rect.top + y) * src_pitch + (rect.left + x) * 4 + 3] >= 128;
+		};
+
+		int width = rect.get_width() + spread * 2;
+		int height = rect.get_height() + spread * 2;
+		PixelBuffer field(width, height, tf_rgba8);
+		unsigned char *dest_data = field.get_data_uint8();
+		int dest_pitch = field.get_pitch();
+
+		int max_distance_squared = spread * spread;
+		for (int y = 0; y < height; y++)
+		{
+			for (int x = 0; x < width; x++)
+			{
+				int src_x = x - spread;
+				int src_y = y - spread;
+				bool inside = is_inside(src_x, src_y);
+
+				// Find the nearest texel on the other side of the outline
+				int best_distance_squared = max_distance_squared;
+				for (int dy = -spread; dy <= spread; dy++)
+				{
+					for (int dx = -spread; dx <= spread; dx++)
+					{
+						int distance_squared = dx * dx + dy * dy;
+						if (distance_squared < best_distance_squared && is_inside(src_x + dx, src_y + dy) != inside)
+							best_distance_squared = distance_squared;
+					}
+				}
+
+				// The outline lies half a texel before the nearest texel on the other side
+				float distance = std::sqrt((float)best_distance_squared) - 0.5f;
+				float signed_distance = inside ? distance : -distance;
+				float value = 0.5f + signed_distance / (2.0f * spread);
+				value = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+
+				unsigned char *dest = dest_data + y * dest_pitch + x * 4;
+				dest[0] = 255;
+				dest[1] = 255;
+				dest[2] = 255;
+				dest[3] = (unsigned char)(value * 255.0f + 0.5f);
+			}
+		}
+		return field;
+	}
+
 	void GlyphCache::insert_glyph(Canvas &canvas, unsigned int glyph, Subtexture &sub_texture, const Pointf &offset, const Sizef &size, const GlyphMetrics &glyph_metrics)
 	{
 		auto font_glyph = std::unique_ptr<Font_TextureGlyph>(new Font_TextureGlyph());
@@ -135,6 +418,7 @@ namespace clan
 			font_glyph->geometry = sub_texture.get_geometry();
 		}
 
+		glyph_lookup.insert(font_glyph.get());
 		glyph_list.push_back(std::move(font_glyph));
 	}
 }
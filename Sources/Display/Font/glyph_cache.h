@@ -35,25 +35,29 @@
 #include "API/Display/2D/texture_group.h"
 #include "API/Display/2D/subtexture.h"
 #include "API/Display/Render/texture_2d.h"
+#include "glyph_lookup.h"
+#include "glyph_atlas.h"
+#include "FontEngine/font_engine.h"
 #include <list>
 #include <map>
+#include <mutex>
+#include <unordered_set>
 
 namespace clan
 {
 	class Colorf;
-	class TextureGroup;
 	class FontEngine;
 	class Font_TextureGlyph;
 	class Subtexture;
-	class FontPixelBuffer;
 	class Path;
 	class RenderBatchTriangle;
+	class IODevice;
 
 	/// \brief Font texture format (holds a pixel buffer containing a glyph)
 	class Font_TextureGlyph
 	{
 	public:
-		Font_TextureGlyph() : glyph(0) { };
+		Font_TextureGlyph() : glyph(0), atlas_page(nullptr) { };
 
 		/// \brief Glyph this pixel buffer refers to.
 		unsigned int glyph;
@@ -76,6 +80,9 @@ namespace clan
 		Sizef size;
 
 		GlyphMetrics metrics;
+
+		/// \brief Glyph atlas page holding the texture. NULL if the texture is not in the glyph atlas
+		GlyphAtlasPage *atlas_page;
 	};
 
 	class GlyphCache
@@ -87,17 +94,82 @@ namespace clan
 		/// \brief Get a glyph. Returns NULL if the glyph was not found
 		Font_TextureGlyph *get_glyph(Canvas &canvas, FontEngine *font_engine, unsigned int glyph);
 
+		/// \brief Get a glyph for drawing, rasterizing missing glyphs in the background
+		///
+		/// Returns NULL while the glyph is queued; is_glyph_pending() then returns true. Latin-1 glyphs are
+		/// always rasterized right away, as they are cheap and most text depends on them.
+		Font_TextureGlyph *get_glyph_async(Canvas &canvas, FontEngine *font_engine, unsigned int glyph);
+
+		/// \brief Queues a missing glyph for background rasterization
+		void queue_glyph(FontEngine *font_engine, unsigned int glyph);
+
+		bool is_glyph_pending(unsigned int glyph) const { return pending_glyphs.find(glyph) != pending_glyphs.end(); }
+
+		/// \brief Adds the glyphs finished by the background worker to the cache
+		void insert_completed_glyphs(Canvas &canvas);
+
+		/// \brief Locks the font engine against the background worker. Required for any other use of the engine.
+		std::unique_lock<std::mutex> lock_engine() { return std::unique_lock<std::mutex>(async_state->mutex); }
+
 		GlyphMetrics get_metrics(FontEngine *font_engine, Canvas &canvas, unsigned int glyph);
 
 		void insert_glyph(Canvas &canvas, unsigned int glyph, Subtexture &sub_texture, const Pointf &offset, const Sizef &size, const GlyphMetrics &glyph_metrics);
 		void insert_glyph(Canvas &canvas, FontPixelBuffer &pb);
 
-		void set_texture_group(TextureGroup &new_texture_group);
+		/// \brief Store glyphs inserted from now on as signed distance fields in the alpha channel
+		///
+		/// An alpha of 0.5 lies on the glyph outline. The glyphs are padded by distance_field_spread pixels.
+		void set_distance_field(bool enable) { distance_field = enable; }
+
+		/// \brief Writes the atlas pages and glyphs of this cache, tagged with key
+		void save(Canvas &canvas, IODevice &file, const std::string &key);
+
+		/// \brief Adds the glyphs written by save(), uploading their atlas pages as they are
+		///
+		/// Returns false if the file was written by another version or for another key.
+		bool load(Canvas &canvas, IODevice &file, const std::string &key);
+
+		/// \brief Returns true once load() has been called, so shared caches are only loaded once
+		bool is_loaded() const { return loaded; }
+
+		/// \brief Drops the glyphs on an atlas page that is being evicted. They are rasterized again when needed.
+		///
+		/// The dropped glyphs stay allocated until release_evicted_glyphs(), so glyph pointers obtained earlier remain valid.
+		void evict_page(GlyphAtlasPage *page);
+
+		/// \brief Frees the glyphs dropped by evict_page(). Glyph pointers obtained before the last eviction become invalid.
+		void release_evicted_glyphs() { evicted_glyphs.clear(); }
+
+		/// \brief Incremented whenever glyphs are evicted. Glyph pointers kept from an older generation must be obtained again.
+		unsigned int get_generation() const { return generation; }
 
 	private:
+		/// \brief State shared with the background worker, which may outlive the cache
+		class AsyncState
+		{
+		public:
+			std::mutex mutex;	// Held while the engine is in use
+			bool cancelled = false;
+			std::vector<std::pair<unsigned int, FontPixelBuffer>> completed;
+		};
+
+		static PixelBuffer create_distance_field(const PixelBuffer &coverage, const Rect &rect, int spread);
+
 		std::vector<std::unique_ptr<Font_TextureGlyph>> glyph_list;
-		TextureGroup texture_group;
+		GlyphLookup<Font_TextureGlyph> glyph_lookup;
+		std::vector<std::unique_ptr<Font_TextureGlyph>> evicted_glyphs;
+		unsigned int generation = 0;
+		bool loaded = false;
+
+		std::shared_ptr<AsyncState> async_state;
+		std::unordered_set<unsigned int> pending_glyphs;
+		std::unordered_set<unsigned int> invalid_glyphs;	// Glyphs the worker found not to exist, so they are not queued again
+
+		bool distance_field = false;
 
 		static const int glyph_border_size = 1;
+		static const int distance_field_spread = 6;	// Distance in pixels mapped to the full alpha range
+		static const uint32_t persist_magic = 0x43474c43;	// "CLGC"
+		static const uint32_t persist_version = 1;	// Increase when the file layout or the rasterization changes
 	};
 }
@@ -0,0 +1,143 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace clan
+{
+	/// \brief Maps glyph codes to cached entries in constant time
+	///
+	/// Latin-1 glyphs are stored in a direct table. Other glyphs go in an open addressing hash table
+	/// with linear probing, which is kept at most half full. The entries are not owned by the lookup.
+	template<typename GlyphType>
+	class GlyphLookup
+	{
+	public:
+		GlyphLookup() : direct(), hashed(initial_hash_size), hashed_count(0)
+		{
+		}
+
+		/// \brief Returns the entry for a glyph, or nullptr if it has not been added
+		GlyphType *find(unsigned int glyph) const
+		{
+			if (glyph < direct_size)
+				return direct[glyph];
+
+			size_t mask = hashed.size() - 1;
+			for (size_t index = hash(glyph) & mask; hashed[index]; index = (index + 1) & mask)
+			{
+				if (hashed[index]->glyph == glyph)
+					return hashed[index];
+			}
+			return nullptr;
+		}
+
+		/// \brief Adds an entry for entry->glyph. An entry already added for the same glyph is kept.
+		void insert(GlyphType *entry)
+		{
+			if (entry->glyph < direct_size)
+			{
+				if (!direct[entry->glyph])
+					direct[entry->glyph] = entry;
+				return;
+			}
+
+			if (find(entry->glyph))
+				return;
+
+			if ((hashed_count + 1) * 2 > hashed.size())
+				grow();
+			insert_hashed(entry);
+			hashed_count++;
+		}
+
+		/// \brief Removes the entry for a glyph, if any
+		void erase(unsigned int glyph)
+		{
+			if (glyph < direct_size)
+			{
+				direct[glyph] = nullptr;
+				return;
+			}
+
+			size_t mask = hashed.size() - 1;
+			size_t index = hash(glyph) & mask;
+			while (hashed[index] && hashed[index]->glyph != glyph)
+				index = (index + 1) & mask;
+			if (!hashed[index])
+				return;
+
+			// Move later entries of the probe sequence back, so lookups do not stop at the gap
+			hashed[index] = nullptr;
+			hashed_count--;
+			for (size_t next = (index + 1) & mask; hashed[next]; next = (next + 1) & mask)
+			{
+				GlyphType *entry = hashed[next];
+				hashed[next] = nullptr;
+				insert_hashed(entry);
+			}
+		}
+
+	private:
+		static size_t hash(unsigned int glyph)
+		{
+			// Fibonacci hashing spreads neighbouring code points, which are common in CJK text
+			return (size_t)((glyph * 2654435769u) >> 8);
+		}
+
+		void insert_hashed(GlyphType *entry)
+		{
+			size_t mask = hashed.size() - 1;
+			size_t index = hash(entry->glyph) & mask;
+			while (hashed[index])
+				index = (index + 1) & mask;
+			hashed[index] = entry;
+		}
+
+		void grow()
+		{
+			std::vector<GlyphType *> old_hashed(hashed.size() * 2);
+			old_hashed.swap(hashed);
+			for (GlyphType *entry : old_hashed)
+			{
+				if (entry)
+					insert_hashed(entry);
+			}
+		}
+
+		static const unsigned int direct_size = 256;
+		static const size_t initial_hash_size = 256;	// Must be a power of two
+
+		GlyphType *direct[direct_size];
+		std::vector<GlyphType *> hashed;
+		size_t hashed_count;
+	};
+}
@@ -62,27 +62,17 @@ namespace clan
 
 	Font_PathGlyph *PathCache::get_glyph(Canvas &canvas, FontEngine *font_engine, unsigned int glyph)
 	{
-		std::vector< Font_PathGlyph * >::size_type size = glyph_list.size();
-		for (int cnt = 0; cnt < size; cnt++)
-		{
-			if (glyph_list[cnt]->glyph == glyph)
-				return &(*glyph_list[cnt]);
-		}
+		Font_PathGlyph *found_glyph = glyph_lookup.find(glyph);
+		if (found_glyph)
+			return found_glyph;
 
 		auto font_glyph = new Font_PathGlyph();
 		glyph_list.push_back(font_glyph);
 		font_glyph->glyph = glyph;
 		font_engine->load_glyph_path(glyph, font_glyph->path, font_glyph->metrics);
+		glyph_lookup.insert(font_glyph);
 
-		// Search for the glyph again
-		size = glyph_list.size();
-		for (int cnt = 0; cnt < size; cnt++)
-		{
-			if (glyph_list[cnt]->glyph == glyph)
-				return &(*glyph_list[cnt]);
-		}
-
-		return nullptr;
+		return font_glyph;
 	}
 
 	GlyphMetrics PathCache::get_metrics(FontEngine *font_engine, Canvas &canvas, unsigned int glyph)
@@ -33,6 +33,7 @@
 #include "API/Display/Font/font_metrics.h"
 #include "API/Display/Render/texture.h"
 #include "API/Display/2D/path.h"
+#include "glyph_lookup.h"
 #include <list>
 #include <map>
 
@@ -71,5 +72,6 @@ namespace clan
 
 	private:
 		std::vector<Font_PathGlyph* > glyph_list;
+		GlyphLookup<Font_PathGlyph> glyph_lookup;
 	};
 }
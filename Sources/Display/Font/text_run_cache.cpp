@@ -0,0 +1,59 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+*/
+
+#include "Display/precomp.h"
+#include "text_run_cache.h"
+
+namespace clan
+{
+	TextRun &TextRunCache::get_run(const std::string &text)
+	{
+		auto it = run_lookup.find(text);
+		if (it != run_lookup.end())
+		{
+			runs.splice(runs.begin(), runs, it->second);
+			return it->second->second;
+		}
+
+		if (runs.size() >= max_runs)
+		{
+			run_lookup.erase(runs.back().first);
+			runs.pop_back();
+		}
+
+		runs.emplace_front(text, TextRun());
+		run_lookup[text] = runs.begin();
+		return runs.front().second;
+	}
+
+	void TextRunCache::clear()
+	{
+		runs.clear();
+		run_lookup.clear();
+	}
+}
@@ -0,0 +1,82 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+*/
+
+#pragma once
+
+#include "API/Display/Font/glyph_metrics.h"
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace clan
+{
+	class Font_TextureGlyph;
+
+	/// \brief Glyph quad of a text run
+	class TextRunGlyph
+	{
+	public:
+		TextRunGlyph(Font_TextureGlyph *glyph, const Pointf &offset) : glyph(glyph), offset(offset) { }
+
+		Font_TextureGlyph *glyph;	// Owned by the glyph cache
+		Pointf offset;	// Position relative to the text position, including the glyph offset
+	};
+
+	/// \brief Cached layout of a string drawn or measured by a font
+	class TextRun
+	{
+	public:
+		bool shaped = false;	// Set when glyphs is valid
+		unsigned int generation = 0;	// Glyph cache generation the glyphs were obtained in. The run must be shaped again once it changes.
+		std::vector<TextRunGlyph> glyphs;
+
+		bool measured = false;	// Set when metrics is valid
+		GlyphMetrics metrics;
+	};
+
+	/// \brief Least recently used cache of text runs, keyed by the text
+	///
+	/// A cache belongs to a single font size and line height. clear() it when either changes.
+	class TextRunCache
+	{
+	public:
+		/// \brief Returns the run for text, creating an empty one if required
+		TextRun &get_run(const std::string &text);
+
+		void clear();
+
+	private:
+		typedef std::list<std::pair<std::string, TextRun>> RunList;
+
+		RunList runs;	// Most recently used first
+		std::unordered_map<std::string, RunList::iterator> run_lookup;
+
+		static const size_t max_runs = 256;
+	};
+}
@@ -31,6 +31,7 @@
 #include "cpu_pixel_buffer_provider.h"
 #include "pixel_buffer_impl.h"
 #include "API/Core/System/system.h"
+#include "API/Core/System/allocation_tracker.h"
 
 namespace clan
 {
@@ -41,7 +42,10 @@ namespace clan
 	CPUPixelBufferProvider::~CPUPixelBufferProvider()
 	{
 		if (delete_data)
+		{
+			AllocationTracker::free(allocation_tag_pixel_buffer, data, PixelBuffer::get_data_size(size, texture_format));
 			System::aligned_free(data);
+		}
 	}
 
 	void CPUPixelBufferProvider::create(TextureFormat new_format, const Size &new_size, const void *data_ptr, bool only_reference_data)
@@ -65,12 +69,14 @@ namespace clan
 			{
 				delete_data = true;
 				data = (unsigned char *)System::aligned_alloc(data_size, 16);
+				AllocationTracker::allocate(allocation_tag_pixel_buffer, data, data_size);
 				memcpy(data, data_ptr, data_size);
 			}
 			else
 			{
 				delete_data = true;
 				data = (unsigned char *)System::aligned_alloc(data_size, 16);
+				AllocationTracker::allocate(allocation_tag_pixel_buffer, data, data_size);
 			}
 		}
 	}
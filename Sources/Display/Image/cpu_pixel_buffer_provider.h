@@ -45,7 +45,7 @@ namespace clan
 		void create(const void *data, const Size &new_size, PixelBufferDirection direction, TextureFormat new_format, BufferUsage usage) override;
 
 		void *get_data() override { return data; }
-		int get_pitch() const override { return size.width * PixelBuffer::get_bytes_per_pixel(texture_format); }
+		int get_pitch() const override { return PixelBuffer::is_compressed(texture_format) ? (size.width + 3) / 4 * PixelBuffer::get_bytes_per_block(texture_format) : size.width * PixelBuffer::get_bytes_per_pixel(texture_format); }
 		Size get_size() const override { return size; }
 		bool is_gpu() const override { return false; }
 		TextureFormat get_format() const override { return texture_format; };
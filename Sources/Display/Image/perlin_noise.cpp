@@ -28,7 +28,15 @@
 
 #include "Display/precomp.h"
 #include "API/Display/Image/perlin_noise.h"
+#include "API/Core/System/work_queue.h"
+#include <algorithm>
 #include <cstdlib>
+#include <vector>
+
+#if !defined __ANDROID__ && ! defined CL_DISABLE_SSE2
+#include <emmintrin.h>
+#define CL_PERLIN_NOISE_SSE
+#endif
 
 // This perlin noise code is based from ideas from numerious sources, including
 // The original perlin noise example code
@@ -40,7 +48,6 @@
 // http://mrl.nyu.edu/~perlin/paper445.pdf - 6t5-15t4+10t3
 #define cl_s_curve(t) ( t * t * t * ( t * ( t * 6.0f - 15.0f ) + 10.0f ) )
 
-#define cl_floor_to_int(value) ( ((value)>0.0f) ? ((int)value) : ((int)value-1 ) )
 #define cl_lerp(t, a, b) ((a) + (t)*((b)-(a)))
 
 #define permutation_table_size	256
@@ -53,135 +60,451 @@
 
 namespace clan
 {
-	class PerlinNoise_PixelWriter
+	namespace
+	{
+		WorkQueue &get_noise_queue()
+		{
+			static WorkQueue queue;
+			return queue;
+		}
+	}
+
+	/// \brief Lane operations for evaluating the noise one pixel at a time
+	class PerlinNoise_Scalar
 	{
 	public:
-		virtual void line_end() = 0;
-		virtual void write_pixel(float value) = 0;
+		typedef float Float;
+		typedef int Int;
+		typedef bool Mask;
+		static const int lanes = 1;
+
+		static Float splat(float value) { return value; }
+		static Float ramp(int x) { return (float)x; }
+		static void store(float *output, Float value) { *output = value; }
+		static Int floor_to_int(Float value) { return (value > 0.0f) ? ((int)value) : ((int)value - 1); }
+		static Float to_float(Int value) { return (float)value; }
+		static Int lookup(const unsigned char *table, Int index) { return table[index]; }
+		static Mask test(Int value, int bits) { return (value & bits) != 0; }
+		static Float select(Mask mask, Float a, Float b) { return mask ? a : b; }
 	};
 
-	class PerlinNoise_PixelWriter_RGBA8 : public PerlinNoise_PixelWriter
+#ifdef CL_PERLIN_NOISE_SSE
+	/// \brief Lane operations for evaluating the noise four pixels at a time
+	///
+	/// Every operation is the same IEEE operation as in PerlinNoise_Scalar, so both give identical results.
+	class PerlinNoise_SSE
 	{
 	public:
-		PerlinNoise_PixelWriter_RGBA8(PixelBuffer &pbuff)
-			: pitch(pbuff.get_pitch() / pbuff.get_bytes_per_pixel()),
-			current_ptr((uint32_t *)pbuff.get_data()),
-			line_start_ptr(current_ptr)
+		class Float
 		{
+		public:
+			Float() { }
+			Float(__m128 v) : v(v) { }
+			__m128 v;
+		};
+
+		class Int
+		{
+		public:
+			Int() { }
+			Int(__m128i v) : v(v) { }
+			__m128i v;
+		};
+
+		class Mask
+		{
+		public:
+			Mask(__m128i v) : v(v) { }
+			__m128i v;
+		};
+
+		static const int lanes = 4;
+
+		static Float splat(float value) { return _mm_set1_ps(value); }
+		static Float ramp(int x) { return _mm_cvtepi32_ps(_mm_setr_epi32(x, x + 1, x + 2, x + 3)); }
+		static void store(float *output, Float value) { _mm_storeu_ps(output, value.v); }
+
+		static Int floor_to_int(Float value)
+		{
+			// Truncate, then subtract one where the value is not positive
+			__m128i truncated = _mm_cvttps_epi32(value.v);
+			__m128i positive = _mm_castps_si128(_mm_cmpgt_ps(value.v, _mm_setzero_ps()));
+			return _mm_add_epi32(truncated, _mm_andnot_si128(positive, _mm_set1_epi32(-1)));
 		}
 
-		void line_end() override
+		static Float to_float(Int value) { return _mm_cvtepi32_ps(value.v); }
+
+		static Int lookup(const unsigned char *table, Int index)
 		{
-			line_start_ptr += pitch;
-			current_ptr = line_start_ptr;
+			alignas(16) int indexes[4];
+			_mm_store_si128((__m128i*)indexes, index.v);
+			return _mm_setr_epi32(table[indexes[0]], table[indexes[1]], table[indexes[2]], table[indexes[3]]);
 		}
 
-		void write_pixel(float value) override
+		static Mask test(Int value, int bits)
 		{
-			int color = (int)((value*128.0f) + 128.0f);
-			if (color > 255)
-				color = 255;
-			if (color < 0)
-				color = 0;
+			__m128i zero = _mm_cmpeq_epi32(_mm_and_si128(value.v, _mm_set1_epi32(bits)), _mm_setzero_si128());
+			return _mm_xor_si128(zero, _mm_set1_epi32(-1));
+		}
 
-			*(current_ptr++) = color << 24 | color << 16 | color << 8 | color;
+		static Float select(Mask mask, Float a, Float b)
+		{
+			__m128 m = _mm_castsi128_ps(mask.v);
+			return _mm_or_ps(_mm_and_ps(m, a.v), _mm_andnot_ps(m, b.v));
 		}
-	private:
-		int pitch;
-		uint32_t *current_ptr;
-		uint32_t *line_start_ptr;
 	};
 
-	class PerlinNoise_PixelWriter_RGB8 : public PerlinNoise_PixelWriter
+	inline PerlinNoise_SSE::Float operator+(PerlinNoise_SSE::Float a, PerlinNoise_SSE::Float b) { return _mm_add_ps(a.v, b.v); }
+	inline PerlinNoise_SSE::Float operator-(PerlinNoise_SSE::Float a, PerlinNoise_SSE::Float b) { return _mm_sub_ps(a.v, b.v); }
+	inline PerlinNoise_SSE::Float operator*(PerlinNoise_SSE::Float a, PerlinNoise_SSE::Float b) { return _mm_mul_ps(a.v, b.v); }
+	inline PerlinNoise_SSE::Float operator/(PerlinNoise_SSE::Float a, PerlinNoise_SSE::Float b) { return _mm_div_ps(a.v, b.v); }
+	inline PerlinNoise_SSE::Float operator+(PerlinNoise_SSE::Float a, float b) { return _mm_add_ps(a.v, _mm_set1_ps(b)); }
+	inline PerlinNoise_SSE::Float operator+(float a, PerlinNoise_SSE::Float b) { return _mm_add_ps(_mm_set1_ps(a), b.v); }
+	inline PerlinNoise_SSE::Float operator-(PerlinNoise_SSE::Float a, float b) { return _mm_sub_ps(a.v, _mm_set1_ps(b)); }
+	inline PerlinNoise_SSE::Float operator*(PerlinNoise_SSE::Float a, float b) { return _mm_mul_ps(a.v, _mm_set1_ps(b)); }
+	inline PerlinNoise_SSE::Float operator*(float a, PerlinNoise_SSE::Float b) { return _mm_mul_ps(_mm_set1_ps(a), b.v); }
+	inline PerlinNoise_SSE::Float operator/(PerlinNoise_SSE::Float a, float b) { return _mm_div_ps(a.v, _mm_set1_ps(b)); }
+	inline PerlinNoise_SSE::Float operator-(PerlinNoise_SSE::Float a) { return _mm_xor_ps(a.v, _mm_set1_ps(-0.0f)); }
+	inline PerlinNoise_SSE::Float &operator+=(PerlinNoise_SSE::Float &a, PerlinNoise_SSE::Float b) { a.v = _mm_add_ps(a.v, b.v); return a; }
+	inline PerlinNoise_SSE::Float &operator*=(PerlinNoise_SSE::Float &a, float b) { a.v = _mm_mul_ps(a.v, _mm_set1_ps(b)); return a; }
+	inline PerlinNoise_SSE::Int operator+(PerlinNoise_SSE::Int a, PerlinNoise_SSE::Int b) { return _mm_add_epi32(a.v, b.v); }
+	inline PerlinNoise_SSE::Int operator+(PerlinNoise_SSE::Int a, int b) { return _mm_add_epi32(a.v, _mm_set1_epi32(b)); }
+	inline PerlinNoise_SSE::Int operator&(PerlinNoise_SSE::Int a, int b) { return _mm_and_si128(a.v, _mm_set1_epi32(b)); }
+	inline PerlinNoise_SSE::Mask operator&(PerlinNoise_SSE::Mask a, PerlinNoise_SSE::Mask b) { return _mm_and_si128(a.v, b.v); }
+	inline PerlinNoise_SSE::Mask operator|(PerlinNoise_SSE::Mask a, PerlinNoise_SSE::Mask b) { return _mm_or_si128(a.v, b.v); }
+#endif
+
+	/// \brief Evaluates rows of the noise with the lane operations of T
+	template<typename T>
+	class PerlinNoise_Kernel
 	{
 	public:
-		PerlinNoise_PixelWriter_RGB8(PixelBuffer &pbuff)
-			: pitch(pbuff.get_pitch()),
-			current_ptr((uint8_t *)pbuff.get_data()),
-			line_start_ptr(current_ptr)
+		typedef typename T::Float Float;
+		typedef typename T::Int Int;
+		typedef typename T::Mask Mask;
+
+		PerlinNoise_Kernel(const unsigned char *permutation_table, float amplitude, int octaves) : permutation_table(permutation_table), amplitude(amplitude), octaves(octaves) { }
+
+		/// \brief Writes the noise for pixels [x, x_end) of a row, in steps of T::lanes. Returns the first pixel not written.
+		int row_1d(float *output, int x, int x_end, float start_x, float size_x, float fwidth)
 		{
+			for (; x + T::lanes <= x_end; x += T::lanes)
+			{
+				Float result = T::splat(0.0f);
+				float current_amplitude = amplitude;
+				Float value_x = start_x + (T::ramp(x) * size_x) / fwidth;
+
+				for (int i = 0; i < octaves; i++)
+				{
+					result += current_amplitude * noise_1d(value_x);
+					value_x *= 2.0f;
+					current_amplitude *= 0.5f;
+				}
+
+				T::store(output + x, result);
+			}
+			return x;
 		}
 
-		void line_end() override
+		int row_2d(float *output, int x, int x_end, float start_x, float size_x, float fwidth, float row_y)
 		{
-			line_start_ptr += pitch;
-			current_ptr = line_start_ptr;
+			for (; x + T::lanes <= x_end; x += T::lanes)
+			{
+				Float result = T::splat(0.0f);
+				float current_amplitude = amplitude;
+				Float value_x = start_x + (T::ramp(x) * size_x) / fwidth;
+				Float value_y = T::splat(row_y);
+
+				for (int i = 0; i < octaves; i++)
+				{
+					result += current_amplitude * noise_2d(value_x, value_y);
+					value_x *= 2.0f;
+					value_y *= 2.0f;
+					current_amplitude *= 0.5f;
+				}
+
+				T::store(output + x, result);
+			}
+			return x;
 		}
 
-		void write_pixel(float value) override
+		int row_3d(float *output, int x, int x_end, float start_x, float size_x, float fwidth, float row_y, float z_position)
 		{
-			int color = (int)((value*128.0f) + 128.0f);
-			if (color > 255)
-				color = 255;
-			if (color < 0)
-				color = 0;
+			for (; x + T::lanes <= x_end; x += T::lanes)
+			{
+				Float result = T::splat(0.0f);
+				float current_amplitude = amplitude;
+				Float value_x = start_x + (T::ramp(x) * size_x) / fwidth;
+				Float value_y = T::splat(row_y);
+				Float value_z = T::splat(z_position);
+
+				for (int i = 0; i < octaves; i++)
+				{
+					result += current_amplitude * noise_3d(value_x, value_y, value_z);
+					value_x *= 2.0f;
+					value_y *= 2.0f;
+					value_z *= 2.0f;
+					current_amplitude *= 0.5f;
+				}
 
-			*(current_ptr++) = color;
-			*(current_ptr++) = color;
-			*(current_ptr++) = color;
+				T::store(output + x, result);
+			}
+			return x;
 		}
-	private:
-		int pitch;
-		uint8_t *current_ptr;
-		uint8_t *line_start_ptr;
-	};
 
-	class PerlinNoise_PixelWriter_R8 : public PerlinNoise_PixelWriter
-	{
-	public:
-		PerlinNoise_PixelWriter_R8(PixelBuffer &pbuff)
-			: pitch(pbuff.get_pitch()),
-			current_ptr((uint8_t *)pbuff.get_data()),
-			line_start_ptr(current_ptr)
+		int row_4d(float *output, int x, int x_end, float start_x, float size_x, float fwidth, float row_y, float z_position, float w_position)
 		{
+			for (; x + T::lanes <= x_end; x += T::lanes)
+			{
+				Float result = T::splat(0.0f);
+				float current_amplitude = amplitude;
+				Float value_x = start_x + (T::ramp(x) * size_x) / fwidth;
+				Float value_y = T::splat(row_y);
+				Float value_z = T::splat(z_position);
+				Float value_w = T::splat(w_position);
+
+				for (int i = 0; i < octaves; i++)
+				{
+					result += current_amplitude * noise_4d(value_x, value_y, value_z, value_w);
+					value_x *= 2.0f;
+					value_y *= 2.0f;
+					value_z *= 2.0f;
+					value_w *= 2.0f;
+					current_amplitude *= 0.5f;
+				}
+
+				T::store(output + x, result);
+			}
+			return x;
 		}
 
-		void line_end() override
+	private:
+		Int perm(Int index) const { return T::lookup(permutation_table, index); }
+
+		static Float gradient_1d(Int permutation_value, Float x)
 		{
-			line_start_ptr += pitch;
-			current_ptr = line_start_ptr;
+			// Find gradient between -8.0f and 8.0f (excluding 0.0f)
+			Float gradient = 1.0f + T::to_float(permutation_value & 7);
+			gradient = T::select(T::test(permutation_value, 8), -gradient, gradient);
+			return gradient * x;
 		}
 
-		void write_pixel(float value) override
+		static Float gradient_2d(Int permutation_value, Float x, Float y)
 		{
-			int color = (int)((value*128.0f) + 128.0f);
-			if (color > 255)
-				color = 255;
-			if (color < 0)
-				color = 0;
-
-			*(current_ptr++) = color;
+			Mask swap = T::test(permutation_value, 4);
+			Float u = T::select(swap, y, x);
+			Float v = T::select(swap, x, y);
+			u = T::select(T::test(permutation_value, 1), -u, u);
+			v = T::select(T::test(permutation_value, 2), -v, v);
+			return u + (2.0f * v);
 		}
-	private:
-		int pitch;
-		uint8_t *current_ptr;
-		uint8_t *line_start_ptr;
-	};
 
-	class PerlinNoise_PixelWriter_R32f : public PerlinNoise_PixelWriter
-	{
-	public:
-		PerlinNoise_PixelWriter_R32f(PixelBuffer &pbuff)
-			: pitch(pbuff.get_pitch() / sizeof(float)),
-			current_ptr((float *)pbuff.get_data()),
-			line_start_ptr(current_ptr)
+		static Float gradient_3d(Int permutation_value, Float x, Float y, Float z)
 		{
+			// (1,1,0),(-1,1,0),(1,-1,0),(-1,-1,0),
+			// (1,0,1),(-1,0,1),(1,0,-1),(-1,0,-1),
+			// (0,1,1),(0,-1,1),(0,1,-1),(0,-1,-1)
+			// To  avoid  the  cost  of  dividing  by  12,  we  pad  to  16  gradient 
+			// directions,  adding  an  extra  (1,1,0),(-1,1,0),(0,-1,1)  and  (0,-1,-1). 
+			// These  form  a  regular  tetrahedron,
+
+			// Interested in only 16 permutations (12 + 4 repeated). Values of 12 or more have both bit 8 and 4 set.
+			Mask bit8 = T::test(permutation_value, 8);
+			Mask bit4 = T::test(permutation_value, 4);
+			Float u = T::select(bit8, y, x);
+			Float v = T::select(bit4, T::select(bit8, x, z), y);
+			u = T::select(T::test(permutation_value, 1), -u, u);
+			v = T::select(T::test(permutation_value, 2), -v, v);
+			return u + v;
 		}
 
-		void line_end() override
+		static Float gradient_4d(Int permutation_value, Float x, Float y, Float z, Float t)
 		{
-			line_start_ptr += pitch;
-			current_ptr = line_start_ptr;
+			// Interested in only 31 permutations: values below 24 do not have both bit 16 and 8 set,
+			// values below 16 do not have bit 16 set, and values below 8 have neither
+			Mask bit16 = T::test(permutation_value, 16);
+			Mask bit8 = T::test(permutation_value, 8);
+			Float u = T::select(bit16 & bit8, y, x);
+			Float v = T::select(bit16, z, y);
+			Float w = T::select(bit16 | bit8, t, z);
+			u = T::select(T::test(permutation_value, 1), -u, u);
+			v = T::select(T::test(permutation_value, 2), -v, v);
+			w = T::select(T::test(permutation_value, 4), -w, w);
+			return u + v + w;
 		}
 
-		void write_pixel(float value) override
+		Float noise_1d(Float x) const
 		{
-			*(current_ptr++) = value;
+			Int ix0 = T::floor_to_int(x);
+			Float fx0 = x - T::to_float(ix0);
+			Float fx1 = fx0 - 1.0f;
+			Int ix1 = (ix0 + 1) & cl_period_mask_x;
+			ix0 = ix0 & cl_period_mask_x;
+
+			Float s = cl_s_curve(fx0);
+
+			Float n0 = gradient_1d(perm(ix0), fx0);
+			Float n1 = gradient_1d(perm(ix1), fx1);
+			return (cl_lerp(s, n0, n1));
+		}
+
+		Float noise_2d(Float x, Float y) const
+		{
+			Int ix0 = T::floor_to_int(x);
+			Int iy0 = T::floor_to_int(y);
+			Float fx0 = x - T::to_float(ix0);
+			Float fy0 = y - T::to_float(iy0);
+			Float fx1 = fx0 - 1.0f;
+			Float fy1 = fy0 - 1.0f;
+
+			Int ix1 = (ix0 + 1) & cl_period_mask_x;
+			Int iy1 = (iy0 + 1) & cl_period_mask_y;
+			ix0 = ix0 & cl_period_mask_x;
+			iy0 = iy0 & cl_period_mask_y;
+
+			Float t = cl_s_curve(fy0);
+			Float s = cl_s_curve(fx0);
+
+			Int p0 = perm(iy0);
+			Int p1 = perm(iy1);
+
+			Float nx0 = gradient_2d(perm(ix0 + p0), fx0, fy0);
+			Float nx1 = gradient_2d(perm(ix0 + p1), fx0, fy1);
+			Float n0 = cl_lerp(t, nx0, nx1);
+
+			nx0 = gradient_2d(perm(ix1 + p0), fx1, fy0);
+			nx1 = gradient_2d(perm(ix1 + p1), fx1, fy1);
+			Float n1 = cl_lerp(t, nx0, nx1);
+
+			return (cl_lerp(s, n0, n1));
+		}
+
+		Float noise_3d(Float x, Float y, Float z) const
+		{
+			Int ix0 = T::floor_to_int(x);
+			Int iy0 = T::floor_to_int(y);
+			Int iz0 = T::floor_to_int(z);
+			Float fx0 = x - T::to_float(ix0);
+			Float fy0 = y - T::to_float(iy0);
+			Float fz0 = z - T::to_float(iz0);
+			Float fx1 = fx0 - 1.0f;
+			Float fy1 = fy0 - 1.0f;
+			Float fz1 = fz0 - 1.0f;
+			Int ix1 = (ix0 + 1) & cl_period_mask_x;
+			Int iy1 = (iy0 + 1) & cl_period_mask_y;
+			Int iz1 = (iz0 + 1) & cl_period_mask_z;
+			ix0 = ix0 & cl_period_mask_x;
+			iy0 = iy0 & cl_period_mask_y;
+			iz0 = iz0 & cl_period_mask_z;
+
+			Float r = cl_s_curve(fz0);
+			Float t = cl_s_curve(fy0);
+			Float s = cl_s_curve(fx0);
+
+			Int p0 = perm(iz0);
+			Int p1 = perm(iz1);
+			Int p00 = perm(iy0 + p0);
+			Int p01 = perm(iy0 + p1);
+			Int p10 = perm(iy1 + p0);
+			Int p11 = perm(iy1 + p1);
+
+			Float nxy0 = gradient_3d(perm(ix0 + p00), fx0, fy0, fz0);
+			Float nxy1 = gradient_3d(perm(ix0 + p01), fx0, fy0, fz1);
+			Float nx0 = cl_lerp(r, nxy0, nxy1);
+
+			nxy0 = gradient_3d(perm(ix0 + p10), fx0, fy1, fz0);
+			nxy1 = gradient_3d(perm(ix0 + p11), fx0, fy1, fz1);
+			Float nx1 = cl_lerp(r, nxy0, nxy1);
+
+			Float n0 = cl_lerp(t, nx0, nx1);
+
+			nxy0 = gradient_3d(perm(ix1 + p00), fx1, fy0, fz0);
+			nxy1 = gradient_3d(perm(ix1 + p01), fx1, fy0, fz1);
+			nx0 = cl_lerp(r, nxy0, nxy1);
+
+			nxy0 = gradient_3d(perm(ix1 + p10), fx1, fy1, fz0);
+			nxy1 = gradient_3d(perm(ix1 + p11), fx1, fy1, fz1);
+			nx1 = cl_lerp(r, nxy0, nxy1);
+
+			Float n1 = cl_lerp(t, nx0, nx1);
+
+			return (cl_lerp(s, n0, n1));
+		}
+
+		Float noise_4d(Float x, Float y, Float z, Float w) const
+		{
+			Int ix0 = T::floor_to_int(x);
+			Int iy0 = T::floor_to_int(y);
+			Int iz0 = T::floor_to_int(z);
+			Int iw0 = T::floor_to_int(w);
+			Float fx0 = x - T::to_float(ix0);
+			Float fy0 = y - T::to_float(iy0);
+			Float fz0 = z - T::to_float(iz0);
+			Float fw0 = w - T::to_float(iw0);
+			Float fx1 = fx0 - 1.0f;
+			Float fy1 = fy0 - 1.0f;
+			Float fz1 = fz0 - 1.0f;
+			Float fw1 = fw0 - 1.0f;
+			Int ix1 = (ix0 + 1) & cl_period_mask_x;
+			Int iy1 = (iy0 + 1) & cl_period_mask_y;
+			Int iz1 = (iz0 + 1) & cl_period_mask_z;
+			Int iw1 = (iw0 + 1) & cl_period_mask_w;
+			ix0 = ix0 & cl_period_mask_x;
+			iy0 = iy0 & cl_period_mask_y;
+			iz0 = iz0 & cl_period_mask_z;
+			iw0 = iw0 & cl_period_mask_w;
+
+			Float q = cl_s_curve(fw0);
+			Float r = cl_s_curve(fz0);
+			Float t = cl_s_curve(fy0);
+			Float s = cl_s_curve(fx0);
+
+			// Hash the w, z and y corners once, they are shared by both x corners
+			Int pw0 = perm(iw0);
+			Int pw1 = perm(iw1);
+			Int pz[4] = { perm(iz0 + pw0), perm(iz0 + pw1), perm(iz1 + pw0), perm(iz1 + pw1) };
+			Int py0[4], py1[4];
+			for (int i = 0; i < 4; i++)
+			{
+				py0[i] = perm(iy0 + pz[i]);
+				py1[i] = perm(iy1 + pz[i]);
+			}
+
+			Float n[2];
+			for (int corner_x = 0; corner_x < 2; corner_x++)
+			{
+				Int ix = corner_x ? ix1 : ix0;
+				Float fx = corner_x ? fx1 : fx0;
+
+				Float nxyz0 = gradient_4d(perm(ix + py0[0]), fx, fy0, fz0, fw0);
+				Float nxyz1 = gradient_4d(perm(ix + py0[1]), fx, fy0, fz0, fw1);
+				Float nxy0 = cl_lerp(q, nxyz0, nxyz1);
+
+				nxyz0 = gradient_4d(perm(ix + py0[2]), fx, fy0, fz1, fw0);
+				nxyz1 = gradient_4d(perm(ix + py0[3]), fx, fy0, fz1, fw1);
+				Float nxy1 = cl_lerp(q, nxyz0, nxyz1);
+
+				Float nx0 = cl_lerp(r, nxy0, nxy1);
+
+				nxyz0 = gradient_4d(perm(ix + py1[0]), fx, fy1, fz0, fw0);
+				nxyz1 = gradient_4d(perm(ix + py1[1]), fx, fy1, fz0, fw1);
+				nxy0 = cl_lerp(q, nxyz0, nxyz1);
+
+				nxyz0 = gradient_4d(perm(ix + py1[2]), fx, fy1, fz1, fw0);
+				nxyz1 = gradient_4d(perm(ix + py1[3]), fx, fy1, fz1, fw1);
+				nxy1 = cl_lerp(q, nxyz0, nxyz1);
+
+				Float nx1 = cl_lerp(r, nxy0, nxy1);
+
+				n[corner_x] = cl_lerp(t, nx0, nx1);
+			}
+
+			return (cl_lerp(s, n[0], n[1]));
 		}
-	private:
-		int pitch;
-		float *current_ptr;
-		float *line_start_ptr;
+
+		const unsigned char *permutation_table;
+		float amplitude;
+		int octaves;
 	};
 
 	class PerlinNoise_Impl
@@ -205,21 +528,15 @@ namespace clan
 		int height = 256;
 		int octaves = 1;
 
-	private:
-		void create_noise4d(PerlinNoise_PixelWriter &writer, float start_x, float end_x, float start_y, float end_y, float z_position, float w_position);
-		void create_noise3d(PerlinNoise_PixelWriter &writer, float start_x, float end_x, float start_y, float end_y, float z_position);
-		void create_noise2d(PerlinNoise_PixelWriter &writer, float start_x, float end_x, float start_y, float end_y);
-		void create_noise1d(PerlinNoise_PixelWriter &writer, float start_x, float end_x);
+		/// \brief Smallest number of pixels worth a work item of its own
+		static const int min_band_pixels = 128 * 128;
 
-		inline float gradient_1d(int permutation_value, float x);
-		inline float gradient_2d(int permutation_value, float x, float y);
-		inline float gradient_3d(int permutation_value, float x, float y, float z);
-		inline float gradient_4d(int permutation_value, float x, float y, float z, float t);
+	private:
+		/// \brief Creates the pixel buffer and fills it in bands of rows on the worker threads
+		template<typename RowFunc>
+		PixelBuffer create_noise(RowFunc row_func);
 
-		float noise_1d(float x);
-		float noise_2d(float x, float y);
-		float noise_3d(float x, float y, float z);
-		float noise_4d(float x, float y, float z, float w);
+		static void write_row(PixelBuffer &pbuff, int y, const float *values);
 
 		void setup();
 
@@ -308,325 +625,6 @@ namespace clan
 		impl->octaves = octaves;
 	}
 
-	float PerlinNoise_Impl::gradient_1d(int permutation_value, float x)
-	{
-		// Find gradient between -8.0f and 8.0f (excluding 0.0f)
-		float gradient = 1.0f + (permutation_value & 7);
-		if (permutation_value & 8)
-			gradient = -gradient;
-		return gradient * x;
-	}
-
-	float PerlinNoise_Impl::gradient_2d(int permutation_value, float x, float y)
-	{
-		float u, v;
-		if (permutation_value & 4)
-		{
-			u = y;
-			v = x;
-		}
-		else
-		{
-			u = x;
-			v = y;
-		}
-
-		if (permutation_value & 1)
-		{
-			u = -u;
-		}
-
-		if (permutation_value & 2)
-		{
-			v = -v;
-		}
-
-		return u + (2.0f * v);
-	}
-
-	float PerlinNoise_Impl::gradient_3d(int permutation_value, float x, float y, float z)
-	{
-		// (1,1,0),(-1,1,0),(1,-1,0),(-1,-1,0),
-		// (1,0,1),(-1,0,1),(1,0,-1),(-1,0,-1),
-		// (0,1,1),(0,-1,1),(0,1,-1),(0,-1,-1)
-		// To  avoid  the  cost  of  dividing  by  12,  we  pad  to  16  gradient 
-		// directions,  adding  an  extra  (1,1,0),(-1,1,0),(0,-1,1)  and  (0,-1,-1). 
-		// These  form  a  regular  tetrahedron,
-
-		float u, v;
-		permutation_value = permutation_value & 15;	// Interested in only 16 permutations (12 + 4 repeated)
-
-		if (permutation_value & 8)
-		{
-			u = y;
-		}
-		else
-		{
-			u = x;
-		}
-
-		if (permutation_value & 4)
-		{
-
-			if (permutation_value >= 12)
-			{
-				v = x;
-			}
-			else
-			{
-				v = z;
-			}
-		}
-		else
-		{
-			v = y;
-		}
-
-
-		if (permutation_value & 1)
-		{
-			u = -u;
-		}
-
-		if (permutation_value & 2)
-		{
-			v = -v;
-		}
-
-		return u + v;
-	}
-
-	float PerlinNoise_Impl::gradient_4d(int permutation_value, float x, float y, float z, float t)
-	{
-		float u, v, w;
-		permutation_value = permutation_value & 31;	// Interested in only 31 permutations
-
-		if (permutation_value < 24)
-		{
-			u = x;
-		}
-		else
-		{
-			u = y;
-		}
-
-		if (permutation_value < 16)
-		{
-			v = y;
-		}
-		else
-		{
-			v = z;
-		}
-
-		if (permutation_value < 8)
-		{
-			w = z;
-		}
-		else
-		{
-			w = t;
-		}
-
-		if (permutation_value & 1)
-		{
-			u = -u;
-		}
-
-		if (permutation_value & 2)
-		{
-			v = -v;
-		}
-
-		if (permutation_value & 4)
-		{
-			w = -w;
-		}
-
-		return u + v + w;
-	}
-
-	float PerlinNoise_Impl::noise_1d(float x)
-	{
-		int ix0, ix1;
-		float fx0, fx1;
-		float s, n0, n1;
-
-		ix0 = cl_floor_to_int(x);
-		fx0 = x - ix0;
-		fx1 = fx0 - 1.0f;
-		ix1 = (ix0 + 1) & cl_period_mask_x;
-		ix0 = ix0 & cl_period_mask_x;
-
-		s = cl_s_curve(fx0);
-
-		n0 = gradient_1d(permutation_table[ix0], fx0);
-		n1 = gradient_1d(permutation_table[ix1], fx1);
-		return (cl_lerp(s, n0, n1));
-	}
-
-	float PerlinNoise_Impl::noise_2d(float x, float y)
-	{
-		int ix0, iy0, ix1, iy1;
-		float fx0, fy0, fx1, fy1;
-		float s, t, nx0, nx1, n0, n1;
-
-		ix0 = cl_floor_to_int(x);
-		iy0 = cl_floor_to_int(y);
-		fx0 = x - ix0;
-		fy0 = y - iy0;
-		fx1 = fx0 - 1.0f;
-		fy1 = fy0 - 1.0f;
-
-		ix1 = (ix0 + 1) & cl_period_mask_x;
-		iy1 = (iy0 + 1) & cl_period_mask_y;
-		ix0 = ix0 & cl_period_mask_x;
-		iy0 = iy0 & cl_period_mask_y;
-
-		t = cl_s_curve(fy0);
-		s = cl_s_curve(fx0);
-
-		nx0 = gradient_2d(permutation_table[ix0 + permutation_table[iy0]], fx0, fy0);
-		nx1 = gradient_2d(permutation_table[ix0 + permutation_table[iy1]], fx0, fy1);
-		n0 = cl_lerp(t, nx0, nx1);
-
-		nx0 = gradient_2d(permutation_table[ix1 + permutation_table[iy0]], fx1, fy0);
-		nx1 = gradient_2d(permutation_table[ix1 + permutation_table[iy1]], fx1, fy1);
-		n1 = cl_lerp(t, nx0, nx1);
-
-		return (cl_lerp(s, n0, n1));
-	}
-
-	float PerlinNoise_Impl::noise_3d(float x, float y, float z)
-	{
-		int ix0, iy0, ix1, iy1, iz0, iz1;
-		float fx0, fy0, fz0, fx1, fy1, fz1;
-		float s, t, r;
-		float nxy0, nxy1, nx0, nx1, n0, n1;
-
-		ix0 = cl_floor_to_int(x);
-		iy0 = cl_floor_to_int(y);
-		iz0 = cl_floor_to_int(z);
-		fx0 = x - ix0;
-		fy0 = y - iy0;
-		fz0 = z - iz0;
-		fx1 = fx0 - 1.0f;
-		fy1 = fy0 - 1.0f;
-		fz1 = fz0 - 1.0f;
-		ix1 = (ix0 + 1) & cl_period_mask_x;
-		iy1 = (iy0 + 1) & cl_period_mask_y;
-		iz1 = (iz0 + 1) & cl_period_mask_z;
-		ix0 = ix0 & cl_period_mask_x;
-		iy0 = iy0 & cl_period_mask_y;
-		iz0 = iz0 & cl_period_mask_z;
-
-		r = cl_s_curve(fz0);
-		t = cl_s_curve(fy0);
-		s = cl_s_curve(fx0);
-
-		nxy0 = gradient_3d(permutation_table[ix0 + permutation_table[iy0 + permutation_table[iz0]]], fx0, fy0, fz0);
-		nxy1 = gradient_3d(permutation_table[ix0 + permutation_table[iy0 + permutation_table[iz1]]], fx0, fy0, fz1);
-		nx0 = cl_lerp(r, nxy0, nxy1);
-
-		nxy0 = gradient_3d(permutation_table[ix0 + permutation_table[iy1 + permutation_table[iz0]]], fx0, fy1, fz0);
-		nxy1 = gradient_3d(permutation_table[ix0 + permutation_table[iy1 + permutation_table[iz1]]], fx0, fy1, fz1);
-		nx1 = cl_lerp(r, nxy0, nxy1);
-
-		n0 = cl_lerp(t, nx0, nx1);
-
-		nxy0 = gradient_3d(permutation_table[ix1 + permutation_table[iy0 + permutation_table[iz0]]], fx1, fy0, fz0);
-		nxy1 = gradient_3d(permutation_table[ix1 + permutation_table[iy0 + permutation_table[iz1]]], fx1, fy0, fz1);
-		nx0 = cl_lerp(r, nxy0, nxy1);
-
-		nxy0 = gradient_3d(permutation_table[ix1 + permutation_table[iy1 + permutation_table[iz0]]], fx1, fy1, fz0);
-		nxy1 = gradient_3d(permutation_table[ix1 + permutation_table[iy1 + permutation_table[iz1]]], fx1, fy1, fz1);
-		nx1 = cl_lerp(r, nxy0, nxy1);
-
-		n1 = cl_lerp(t, nx0, nx1);
-
-		return (cl_lerp(s, n0, n1));
-	}
-
-	float PerlinNoise_Impl::noise_4d(float x, float y, float z, float w)
-	{
-		int ix0, iy0, iz0, iw0, ix1, iy1, iz1, iw1;
-		float fx0, fy0, fz0, fw0, fx1, fy1, fz1, fw1;
-		float s, t, r, q;
-		float nxyz0, nxyz1, nxy0, nxy1, nx0, nx1, n0, n1;
-
-		ix0 = cl_floor_to_int(x);
-		iy0 = cl_floor_to_int(y);
-		iz0 = cl_floor_to_int(z);
-		iw0 = cl_floor_to_int(w);
-		fx0 = x - ix0;
-		fy0 = y - iy0;
-		fz0 = z - iz0;
-		fw0 = w - iw0;
-		fx1 = fx0 - 1.0f;
-		fy1 = fy0 - 1.0f;
-		fz1 = fz0 - 1.0f;
-		fw1 = fw0 - 1.0f;
-		ix1 = (ix0 + 1) & cl_period_mask_x;
-		iy1 = (iy0 + 1) & cl_period_mask_y;
-		iz1 = (iz0 + 1) & cl_period_mask_z;
-		iw1 = (iw0 + 1) & cl_period_mask_w;
-		ix0 = ix0 & cl_period_mask_x;
-		iy0 = iy0 & cl_period_mask_y;
-		iz0 = iz0 & cl_period_mask_z;
-		iw0 = iw0 & cl_period_mask_w;
-
-		q = cl_s_curve(fw0);
-		r = cl_s_curve(fz0);
-		t = cl_s_curve(fy0);
-		s = cl_s_curve(fx0);
-
-		nxyz0 = gradient_4d(permutation_table[ix0 + permutation_table[iy0 + permutation_table[iz0 + permutation_table[iw0]]]], fx0, fy0, fz0, fw0);
-		nxyz1 = gradient_4d(permutation_table[ix0 + permutation_table[iy0 + permutation_table[iz0 + permutation_table[iw1]]]], fx0, fy0, fz0, fw1);
-		nxy0 = cl_lerp(q, nxyz0, nxyz1);
-
-		nxyz0 = gradient_4d(permutation_table[ix0 + permutation_table[iy0 + permutation_table[iz1 + permutation_table[iw0]]]], fx0, fy0, fz1, fw0);
-		nxyz1 = gradient_4d(permutation_table[ix0 + permutation_table[iy0 + permutation_table[iz1 + permutation_table[iw1]]]], fx0, fy0, fz1, fw1);
-		nxy1 = cl_lerp(q, nxyz0, nxyz1);
-
-		nx0 = cl_lerp(r, nxy0, nxy1);
-
-		nxyz0 = gradient_4d(permutation_table[ix0 + permutation_table[iy1 + permutation_table[iz0 + permutation_table[iw0]]]], fx0, fy1, fz0, fw0);
-		nxyz1 = gradient_4d(permutation_table[ix0 + permutation_table[iy1 + permutation_table[iz0 + permutation_table[iw1]]]], fx0, fy1, fz0, fw1);
-		nxy0 = cl_lerp(q, nxyz0, nxyz1);
-
-		nxyz0 = gradient_4d(permutation_table[ix0 + permutation_table[iy1 + permutation_table[iz1 + permutation_table[iw0]]]], fx0, fy1, fz1, fw0);
-		nxyz1 = gradient_4d(permutation_table[ix0 + permutation_table[iy1 + permutation_table[iz1 + permutation_table[iw1]]]], fx0, fy1, fz1, fw1);
-		nxy1 = cl_lerp(q, nxyz0, nxyz1);
-
-		nx1 = cl_lerp(r, nxy0, nxy1);
-
-		n0 = cl_lerp(t, nx0, nx1);
-
-		nxyz0 = gradient_4d(permutation_table[ix1 + permutation_table[iy0 + permutation_table[iz0 + permutation_table[iw0]]]], fx1, fy0, fz0, fw0);
-		nxyz1 = gradient_4d(permutation_table[ix1 + permutation_table[iy0 + permutation_table[iz0 + permutation_table[iw1]]]], fx1, fy0, fz0, fw1);
-		nxy0 = cl_lerp(q, nxyz0, nxyz1);
-
-		nxyz0 = gradient_4d(permutation_table[ix1 + permutation_table[iy0 + permutation_table[iz1 + permutation_table[iw0]]]], fx1, fy0, fz1, fw0);
-		nxyz1 = gradient_4d(permutation_table[ix1 + permutation_table[iy0 + permutation_table[iz1 + permutation_table[iw1]]]], fx1, fy0, fz1, fw1);
-		nxy1 = cl_lerp(q, nxyz0, nxyz1);
-
-		nx0 = cl_lerp(r, nxy0, nxy1);
-
-		nxyz0 = gradient_4d(permutation_table[ix1 + permutation_table[iy1 + permutation_table[iz0 + permutation_table[iw0]]]], fx1, fy1, fz0, fw0);
-		nxyz1 = gradient_4d(permutation_table[ix1 + permutation_table[iy1 + permutation_table[iz0 + permutation_table[iw1]]]], fx1, fy1, fz0, fw1);
-		nxy0 = cl_lerp(q, nxyz0, nxyz1);
-
-		nxyz0 = gradient_4d(permutation_table[ix1 + permutation_table[iy1 + permutation_table[iz1 + permutation_table[iw0]]]], fx1, fy1, fz1, fw0);
-		nxyz1 = gradient_4d(permutation_table[ix1 + permutation_table[iy1 + permutation_table[iz1 + permutation_table[iw1]]]], fx1, fy1, fz1, fw1);
-		nxy1 = cl_lerp(q, nxyz0, nxyz1);
-
-		nx1 = cl_lerp(r, nxy0, nxy1);
-
-		n1 = cl_lerp(t, nx0, nx1);
-
-		return (cl_lerp(s, n0, n1));
-	}
-
 	void PerlinNoise_Impl::set_permutations(const unsigned char *table, unsigned int size)
 	{
 		if ((size == 0) || (table == nullptr))
@@ -646,6 +644,7 @@ namespace clan
 
 			memcpy(dest, table, size_to_copy);
 			dest += size_to_copy;
+			dest_size -= size_to_copy;
 		}
 
 		// Mirror the table
@@ -669,273 +668,131 @@ namespace clan
 		}
 	}
 
-	PixelBuffer PerlinNoise_Impl::create_noise2d(float start_x, float end_x, float start_y, float end_y)
+	void PerlinNoise_Impl::write_row(PixelBuffer &pbuff, int y, const float *values)
 	{
-		setup();
+		int width = pbuff.get_width();
+		unsigned char *line = pbuff.get_data<unsigned char>() + y * pbuff.get_pitch();
+		TextureFormat format = pbuff.get_format();
 
-		if (texture_format == tf_rgba8)
-		{
-			PixelBuffer pbuff(width, height, texture_format);
-			PerlinNoise_PixelWriter_RGBA8 writer(pbuff);
-			create_noise2d(writer, start_x, end_x, start_y, end_y);
-			return pbuff;
-		}
-		if (texture_format == tf_rgb8)
+		if (format == tf_r32f)
 		{
-			PixelBuffer pbuff(width, height, texture_format);
-			PerlinNoise_PixelWriter_RGB8 writer(pbuff);
-			create_noise2d(writer, start_x, end_x, start_y, end_y);
-			return pbuff;
-		}
-		if (texture_format == tf_r8)
-		{
-			PixelBuffer pbuff(width, height, texture_format);
-			PerlinNoise_PixelWriter_R8 writer(pbuff);
-			create_noise2d(writer, start_x, end_x, start_y, end_y);
-			return pbuff;
-		}
-		if (texture_format == tf_r32f)
-		{
-			PixelBuffer pbuff(width, height, texture_format);
-			PerlinNoise_PixelWriter_R32f writer(pbuff);
-			create_noise2d(writer, start_x, end_x, start_y, end_y);
-			return pbuff;
+			memcpy(line, values, width * sizeof(float));
+			return;
 		}
 
-		throw Exception("texture format is not supported");
-
-	}
-
-	void PerlinNoise_Impl::create_noise2d(PerlinNoise_PixelWriter &writer, float start_x, float end_x, float start_y, float end_y)
-	{
-		float size_x = end_x - start_x;
-		float size_y = end_y - start_y;
-		float fheight = (float)height;
-		float fwidth = (float)width;
-
-		for (int y = 0; y < height; y++)
+		for (int x = 0; x < width; x++)
 		{
-			for (int x = 0; x < width; x++)
-			{
-				float result = 0.0f;
-				float current_amplitude = amplitude;
-				float value_x = start_x + (((float)x) * size_x) / fwidth;
-				float value_y = start_y + (((float)y) * size_y) / fheight;
-
-				for (int i = 0; i < octaves; i++)
-				{
-					result += current_amplitude * noise_2d(value_x, value_y);
-					value_x *= 2.0f;
-					value_y *= 2.0f;
-					current_amplitude *= 0.5f;
-				}
+			int color = (int)((values[x] * 128.0f) + 128.0f);
+			if (color > 255)
+				color = 255;
+			if (color < 0)
+				color = 0;
 
-				writer.write_pixel(result);
+			if (format == tf_rgba8)
+			{
+				((uint32_t *)line)[x] = color << 24 | color << 16 | color << 8 | color;
+			}
+			else if (format == tf_rgb8)
+			{
+				line[x * 3] = color;
+				line[x * 3 + 1] = color;
+				line[x * 3 + 2] = color;
+			}
+			else
+			{
+				line[x] = color;
 			}
-			writer.line_end();
 		}
 	}
 
-	PixelBuffer PerlinNoise_Impl::create_noise1d(float start_x, float end_x)
+	template<typename RowFunc>
+	PixelBuffer PerlinNoise_Impl::create_noise(RowFunc row_func)
 	{
+		if (texture_format != tf_rgba8 && texture_format != tf_rgb8 && texture_format != tf_r8 && texture_format != tf_r32f)
+			throw Exception("texture format is not supported");
+
 		setup();
 
-		if (texture_format == tf_rgba8)
-		{
-			PixelBuffer pbuff(width, height, texture_format);
-			PerlinNoise_PixelWriter_RGBA8 writer(pbuff);
-			create_noise1d(writer, start_x, end_x);
-			return pbuff;
-		}
-		if (texture_format == tf_rgb8)
-		{
-			PixelBuffer pbuff(width, height, texture_format);
-			PerlinNoise_PixelWriter_RGB8 writer(pbuff);
-			create_noise1d(writer, start_x, end_x);
-			return pbuff;
-		}
-		if (texture_format == tf_r8)
+		PixelBuffer pbuff(width, height, texture_format);
+		int band_rows = std::max(min_band_pixels / std::max(width, 1), 1);
+		get_noise_queue().parallel_for(0, height, band_rows, [&](int first_row, int last_row)
 		{
-			PixelBuffer pbuff(width, height, texture_format);
-			PerlinNoise_PixelWriter_R8 writer(pbuff);
-			create_noise1d(writer, start_x, end_x);
-			return pbuff;
-		}
-		if (texture_format == tf_r32f)
-		{
-			PixelBuffer pbuff(width, height, texture_format);
-			PerlinNoise_PixelWriter_R32f writer(pbuff);
-			create_noise1d(writer, start_x, end_x);
-			return pbuff;
-		}
-
-		throw Exception("texture format is not supported");
-
+			std::vector<float> values(width);
+			for (int y = first_row; y < last_row; y++)
+			{
+				row_func(values.data(), y);
+				write_row(pbuff, y, values.data());
+			}
+		});
+		return pbuff;
 	}
 
-	void PerlinNoise_Impl::create_noise1d(PerlinNoise_PixelWriter &writer, float start_x, float end_x)
+	PixelBuffer PerlinNoise_Impl::create_noise1d(float start_x, float end_x)
 	{
 		float size_x = end_x - start_x;
 		float fwidth = (float)width;
 
-		for (int y = 0; y < height; y++)
+		return create_noise([&](float *values, int y)
 		{
-			for (int x = 0; x < width; x++)
-			{
-				float result = 0.0f;
-				float current_amplitude = amplitude;
-				float value_x = start_x + (((float)x) * size_x) / fwidth;
-
-				for (int i = 0; i < octaves; i++)
-				{
-					result += current_amplitude * noise_1d(value_x);
-					value_x *= 2.0f;
-					current_amplitude *= 0.5f;
-				}
-
-				writer.write_pixel(result);
-			}
-			writer.line_end();
-		}
+			int x = 0;
+#ifdef CL_PERLIN_NOISE_SSE
+			x = PerlinNoise_Kernel<PerlinNoise_SSE>(permutation_table, amplitude, octaves).row_1d(values, x, width, start_x, size_x, fwidth);
+#endif
+			PerlinNoise_Kernel<PerlinNoise_Scalar>(permutation_table, amplitude, octaves).row_1d(values, x, width, start_x, size_x, fwidth);
+		});
 	}
 
-	PixelBuffer PerlinNoise_Impl::create_noise3d(float start_x, float end_x, float start_y, float end_y, float z_position)
+	PixelBuffer PerlinNoise_Impl::create_noise2d(float start_x, float end_x, float start_y, float end_y)
 	{
-		setup();
+		float size_x = end_x - start_x;
+		float size_y = end_y - start_y;
+		float fheight = (float)height;
+		float fwidth = (float)width;
 
-		if (texture_format == tf_rgba8)
-		{
-			PixelBuffer pbuff(width, height, texture_format);
-			PerlinNoise_PixelWriter_RGBA8 writer(pbuff);
-			create_noise3d(writer, start_x, end_x, start_y, end_y, z_position);
-			return pbuff;
-		}
-		if (texture_format == tf_rgb8)
-		{
-			PixelBuffer pbuff(width, height, texture_format);
-			PerlinNoise_PixelWriter_RGB8 writer(pbuff);
-			create_noise3d(writer, start_x, end_x, start_y, end_y, z_position);
-			return pbuff;
-		}
-		if (texture_format == tf_r8)
+		return create_noise([&](float *values, int y)
 		{
-			PixelBuffer pbuff(width, height, texture_format);
-			PerlinNoise_PixelWriter_R8 writer(pbuff);
-			create_noise3d(writer, start_x, end_x, start_y, end_y, z_position);
-			return pbuff;
-		}
-		if (texture_format == tf_r32f)
-		{
-			PixelBuffer pbuff(width, height, texture_format);
-			PerlinNoise_PixelWriter_R32f writer(pbuff);
-			create_noise3d(writer, start_x, end_x, start_y, end_y, z_position);
-			return pbuff;
-		}
-
-		throw Exception("sized format is not supported");
-
+			float value_y = start_y + (((float)y) * size_y) / fheight;
+			int x = 0;
+#ifdef CL_PERLIN_NOISE_SSE
+			x = PerlinNoise_Kernel<PerlinNoise_SSE>(permutation_table, amplitude, octaves).row_2d(values, x, width, start_x, size_x, fwidth, value_y);
+#endif
+			PerlinNoise_Kernel<PerlinNoise_Scalar>(permutation_table, amplitude, octaves).row_2d(values, x, width, start_x, size_x, fwidth, value_y);
+		});
 	}
 
-	void PerlinNoise_Impl::create_noise3d(PerlinNoise_PixelWriter &writer, float start_x, float end_x, float start_y, float end_y, float z_position)
+	PixelBuffer PerlinNoise_Impl::create_noise3d(float start_x, float end_x, float start_y, float end_y, float z_position)
 	{
 		float size_x = end_x - start_x;
 		float size_y = end_y - start_y;
 		float fheight = (float)height;
 		float fwidth = (float)width;
 
-		for (int y = 0; y < height; y++)
+		return create_noise([&](float *values, int y)
 		{
-			for (int x = 0; x < width; x++)
-			{
-				float result = 0.0f;
-				float current_amplitude = amplitude;
-				float value_x = start_x + (((float)x) * size_x) / fwidth;
-				float value_y = start_y + (((float)y) * size_y) / fheight;
-				float value_z = z_position;
-
-				for (int i = 0; i < octaves; i++)
-				{
-					result += current_amplitude * noise_3d(value_x, value_y, value_z);
-					value_x *= 2.0f;
-					value_y *= 2.0f;
-					value_z *= 2.0f;
-					current_amplitude *= 0.5f;
-				}
-
-				writer.write_pixel(result);
-			}
-			writer.line_end();
-		}
+			float value_y = start_y + (((float)y) * size_y) / fheight;
+			int x = 0;
+#ifdef CL_PERLIN_NOISE_SSE
+			x = PerlinNoise_Kernel<PerlinNoise_SSE>(permutation_table, amplitude, octaves).row_3d(values, x, width, start_x, size_x, fwidth, value_y, z_position);
+#endif
+			PerlinNoise_Kernel<PerlinNoise_Scalar>(permutation_table, amplitude, octaves).row_3d(values, x, width, start_x, size_x, fwidth, value_y, z_position);
+		});
 	}
 
 	PixelBuffer PerlinNoise_Impl::create_noise4d(float start_x, float end_x, float start_y, float end_y, float z_position, float w_position)
-	{
-		setup();
-
-		if (texture_format == tf_rgba8)
-		{
-			PixelBuffer pbuff(width, height, texture_format);
-			PerlinNoise_PixelWriter_RGBA8 writer(pbuff);
-			create_noise4d(writer, start_x, end_x, start_y, end_y, z_position, w_position);
-			return pbuff;
-		}
-		if (texture_format == tf_rgb8)
-		{
-			PixelBuffer pbuff(width, height, texture_format);
-			PerlinNoise_PixelWriter_RGB8 writer(pbuff);
-			create_noise4d(writer, start_x, end_x, start_y, end_y, z_position, w_position);
-			return pbuff;
-		}
-		if (texture_format == tf_r8)
-		{
-			PixelBuffer pbuff(width, height, texture_format);
-			PerlinNoise_PixelWriter_R8 writer(pbuff);
-			create_noise4d(writer, start_x, end_x, start_y, end_y, z_position, w_position);
-			return pbuff;
-		}
-		if (texture_format == tf_r32f)
-		{
-			PixelBuffer pbuff(width, height, texture_format);
-			PerlinNoise_PixelWriter_R32f writer(pbuff);
-			create_noise4d(writer, start_x, end_x, start_y, end_y, z_position, w_position);
-			return pbuff;
-		}
-
-		throw Exception("sized format is not supported");
-
-	}
-
-	void PerlinNoise_Impl::create_noise4d(PerlinNoise_PixelWriter &writer, float start_x, float end_x, float start_y, float end_y, float z_position, float w_position)
 	{
 		float size_x = end_x - start_x;
 		float size_y = end_y - start_y;
 		float fheight = (float)height;
 		float fwidth = (float)width;
 
-		for (int y = 0; y < height; y++)
+		return create_noise([&](float *values, int y)
 		{
-			for (int x = 0; x < width; x++)
-			{
-				float result = 0.0f;
-				float current_amplitude = amplitude;
-				float value_x = start_x + (((float)x) * size_x) / fwidth;
-				float value_y = start_y + (((float)y) * size_y) / fheight;
-				float value_z = z_position;
-				float value_w = w_position;
-
-				for (int i = 0; i < octaves; i++)
-				{
-					result += current_amplitude * noise_4d(value_x, value_y, value_z, value_w);
-					value_x *= 2.0f;
-					value_y *= 2.0f;
-					value_z *= 2.0f;
-					value_w *= 2.0f;
-					current_amplitude *= 0.5f;
-				}
-
-				writer.write_pixel(result);
-			}
-			writer.line_end();
-		}
+			float value_y = start_y + (((float)y) * size_y) / fheight;
+			int x = 0;
+#ifdef CL_PERLIN_NOISE_SSE
+			x = PerlinNoise_Kernel<PerlinNoise_SSE>(permutation_table, amplitude, octaves).row_4d(values, x, width, start_x, size_x, fwidth, value_y, z_position, w_position);
+#endif
+			PerlinNoise_Kernel<PerlinNoise_Scalar>(permutation_table, amplitude, octaves).row_4d(values, x, width, start_x, size_x, fwidth, value_y, z_position, w_position);
+		});
 	}
 }
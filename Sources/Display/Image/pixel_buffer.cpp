@@ -150,6 +150,12 @@ namespace clan
 		case tf_compressed_srgb_alpha_s3tc_dxt1:
 		case tf_compressed_srgb_alpha_s3tc_dxt3:
 		case tf_compressed_srgb_alpha_s3tc_dxt5:
+		case tf_compressed_rgba_bptc_unorm:
+		case tf_compressed_srgb_alpha_bptc_unorm:
+		case tf_compressed_rgba8_etc2_eac:
+		case tf_compressed_srgb8_alpha8_etc2_eac:
+		case tf_compressed_rgba_astc_4x4:
+		case tf_compressed_srgb8_alpha8_astc_4x4:
 			return true;
 
 		case tf_rgb8:
@@ -218,6 +224,8 @@ namespace clan
 		case tf_compressed_signed_rg_rgtc2:
 		case tf_compressed_rgb_s3tc_dxt1:
 		case tf_compressed_srgb_s3tc_dxt1:
+		case tf_compressed_rgb8_etc2:
+		case tf_compressed_srgb8_etc2:
 			return false;
 
 		default:
@@ -518,25 +526,20 @@ namespace clan
 				int w = get_width();
 				int h = get_height();
 				unsigned short *p = (unsigned short *)get_data();
+				std::vector<float> line_float(w * 4);
 				for (int y = 0; y < h; y++)
 				{
-					int index = y * w;
+					int index = y * w * 4;
 					unsigned short *line = p + index;
+					HalfFloat::half_to_float(line, line_float.data(), w * 4);
 					for (int x = 0; x < w; x++)
 					{
-						float r = HalfFloat::half_to_float(line[x * 4]);
-						float g = HalfFloat::half_to_float(line[x * 4 + 1]);
-						float b = HalfFloat::half_to_float(line[x * 4 + 2]);
-						float a = HalfFloat::half_to_float(line[x * 4 + 3]);
-
-						r = r * a;
-						g = g * a;
-						b = b * a;
-
-						line[x * 4] = HalfFloat::float_to_half(r);
-						line[x * 4 + 1] = HalfFloat::float_to_half(g);
-						line[x * 4 + 2] = HalfFloat::float_to_half(b);
+						float a = line_float[x * 4 + 3];
+						line_float[x * 4] *= a;
+						line_float[x * 4 + 1] *= a;
+						line_float[x * 4 + 2] *= a;
 					}
+					HalfFloat::float_to_half(line_float.data(), line, w * 4);
 				}
 			}
 			else if (get_format() == tf_rgba32f)
@@ -28,9 +28,314 @@
 
 #include "Display/precomp.h"
 #include "API/Display/Image/pixel_buffer_help.h"
+#include "API/Display/Image/pixel_buffer_set.h"
+#include "API/Core/System/work_queue.h"
+#include <cmath>
+#include <vector>
+
+#if !defined __ANDROID__ && ! defined CL_DISABLE_SSE2
+#include <emmintrin.h>
+#define CL_RESAMPLE_SSE
+#endif
 
 namespace clan
 {
+	namespace
+	{
+		WorkQueue &get_resample_queue()
+		{
+			static WorkQueue queue;
+			return queue;
+		}
+
+		const int min_band_pixels = 64 * 64;
+
+		int band_rows(int width)
+		{
+			return max(min_band_pixels / max(width, 1), 1);
+		}
+
+		/// \brief Lookup tables for sRGB transfer functions, linearly interpolated between entries
+		class SRGBTables
+		{
+		public:
+			static const SRGBTables &get()
+			{
+				static SRGBTables tables;
+				return tables;
+			}
+
+			float to_linear(float v) const { return lookup(decode, v); }
+			float to_srgb(float v) const { return lookup(encode, v); }
+
+		private:
+			SRGBTables()
+			{
+				for (int i = 0; i <= table_size; i++)
+				{
+					float v = i / (float)table_size;
+					decode[i] = v <= 0.04045f ? v / 12.92f : std::pow((v + 0.055f) / 1.055f, 2.4f);
+					encode[i] = v <= 0.0031308f ? v * 12.92f : 1.055f * std::pow(v, 1.0f / 2.4f) - 0.055f;
+				}
+			}
+
+			static float lookup(const float *table, float v)
+			{
+				float pos = clamp(v, 0.0f, 1.0f) * table_size;
+				int index = min((int)pos, table_size - 1);
+				float t = pos - index;
+				return table[index] + t * (table[index + 1] - table[index]);
+			}
+
+			static const int table_size = 4096;
+			float decode[table_size + 1];
+			float encode[table_size + 1];
+		};
+
+		/// \brief Filter weights for one axis. Each destination pixel reads taps consecutive source pixels starting at first.
+		class ResampleWeights
+		{
+		public:
+			ResampleWeights(int src_size, int dest_size, ResampleFilter filter)
+			{
+				float support = filter == resample_box ? 0.5f : 3.0f;
+				float scale = src_size / (float)dest_size;
+				float filter_scale = max(scale, 1.0f);
+				float radius = support * filter_scale;
+
+				int window = (int)std::ceil(radius * 2.0f) + 1;
+				taps = min(window, src_size);
+				first.resize(dest_size);
+				weights.resize(dest_size * taps);
+
+				for (int i = 0; i < dest_size; i++)
+				{
+					float center = (i + 0.5f) * scale;
+					int start = (int)std::floor(center - radius);
+					first[i] = clamp(start, 0, src_size - taps);
+
+					// Taps outside the source are folded onto the edge pixels
+					float *w = &weights[i * taps];
+					float total = 0.0f;
+					for (int j = start; j < start + window; j++)
+					{
+						float weight = evaluate(filter, (j + 0.5f - center) / filter_scale);
+						w[clamp(j, 0, src_size - 1) - first[i]] += weight;
+						total += weight;
+					}
+					if (total != 0.0f)
+					{
+						for (int k = 0; k < taps; k++)
+							w[k] /= total;
+					}
+				}
+			}
+
+			int taps;
+			std::vector<int> first;
+			std::vector<float> weights;
+
+		private:
+			static float evaluate(ResampleFilter filter, float x)
+			{
+				switch (filter)
+				{
+				case resample_box:
+					return (x >= -0.5f && x < 0.5f) ? 1.0f : 0.0f;
+				case resample_lanczos:
+					return (x > -3.0f && x < 3.0f) ? sinc(x) * sinc(x / 3.0f) : 0.0f;
+				case resample_kaiser:
+				default:
+				{
+					const float alpha = 4.0f;
+					float t = x / 3.0f;
+					if (t <= -1.0f || t >= 1.0f)
+						return 0.0f;
+					return sinc(x) * bessel_i0(alpha * std::sqrt(1.0f - t * t)) / bessel_i0(alpha);
+				}
+				}
+			}
+
+			static float sinc(float x)
+			{
+				if (std::abs(x) < 1e-6f)
+					return 1.0f;
+				float px = x * PI;
+				return std::sin(px) / px;
+			}
+
+			static float bessel_i0(float x)
+			{
+				// Power series of the modified Bessel function of the first kind
+				float sum = 1.0f;
+				float term = 1.0f;
+				float half_x_squared = x * x * 0.25f;
+				for (int k = 1; k < 32 && term > sum * 1e-8f; k++)
+				{
+					term *= half_x_squared / (float)(k * k);
+					sum += term;
+				}
+				return sum;
+			}
+		};
+
+		/// \brief Adds weight * src to dest for count pixels
+		inline void accumulate(Vec4f *dest, const Vec4f *src, float weight, int count)
+		{
+#ifdef CL_RESAMPLE_SSE
+			__m128 w = _mm_set1_ps(weight);
+			for (int x = 0; x < count; x++)
+			{
+				__m128 d = _mm_loadu_ps(&dest[x].x);
+				_mm_storeu_ps(&dest[x].x, _mm_add_ps(d, _mm_mul_ps(w, _mm_loadu_ps(&src[x].x))));
+			}
+#else
+			for (int x = 0; x < count; x++)
+				dest[x] += src[x] * weight;
+#endif
+		}
+
+		/// \brief Returns the weighted sum of taps consecutive pixels
+		inline Vec4f convolve(const Vec4f *src, const float *weights, int taps)
+		{
+#ifdef CL_RESAMPLE_SSE
+			__m128 sum = _mm_setzero_ps();
+			for (int k = 0; k < taps; k++)
+				sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[k]), _mm_loadu_ps(&src[k].x)));
+			Vec4f result;
+			_mm_storeu_ps(&result.x, sum);
+			return result;
+#else
+			Vec4f sum;
+			for (int k = 0; k < taps; k++)
+				sum += src[k] * weights[k];
+			return sum;
+#endif
+		}
+
+		/// \brief Image in linear light with premultiplied alpha, used as the working format while filtering
+		class LinearImage
+		{
+		public:
+			LinearImage(int width, int height) : width(width), height(height), pixels(width * height)
+			{
+			}
+
+			static LinearImage decode(const PixelBuffer &pb, bool srgb)
+			{
+				PixelBuffer float_pb = pb.get_format() == tf_rgba32f ? pb : pb.to_format(tf_rgba32f);
+
+				LinearImage image(pb.get_width(), pb.get_height());
+				const SRGBTables &tables = SRGBTables::get();
+				get_resample_queue().parallel_for(0, image.height, band_rows(image.width), [&](int first_row, int last_row)
+				{
+					for (int y = first_row; y < last_row; y++)
+					{
+						const Vec4f *src = static_cast<const Vec4f *>(float_pb.get_line(y));
+						Vec4f *dest = image.line(y);
+						for (int x = 0; x < image.width; x++)
+						{
+							Vec4f c = src[x];
+							if (srgb)
+							{
+								c.x = tables.to_linear(c.x);
+								c.y = tables.to_linear(c.y);
+								c.z = tables.to_linear(c.z);
+							}
+							dest[x] = Vec4f(c.x * c.w, c.y * c.w, c.z * c.w, c.w);
+						}
+					}
+				});
+				return image;
+			}
+
+			PixelBuffer encode(TextureFormat format, bool srgb) const
+			{
+				PixelBuffer float_pb(width, height, tf_rgba32f);
+				const SRGBTables &tables = SRGBTables::get();
+				get_resample_queue().parallel_for(0, height, band_rows(width), [&](int first_row, int last_row)
+				{
+					for (int y = first_row; y < last_row; y++)
+					{
+						const Vec4f *src = line(y);
+						Vec4f *dest = static_cast<Vec4f *>(float_pb.get_line(y));
+						for (int x = 0; x < width; x++)
+						{
+							Vec4f c = src[x];
+							if (c.w > 0.0f)
+							{
+								float inv_alpha = 1.0f / c.w;
+								c.x *= inv_alpha;
+								c.y *= inv_alpha;
+								c.z *= inv_alpha;
+							}
+							else
+							{
+								c = Vec4f(0.0f, 0.0f, 0.0f, 0.0f);
+							}
+							if (srgb)
+							{
+								c.x = tables.to_srgb(c.x);
+								c.y = tables.to_srgb(c.y);
+								c.z = tables.to_srgb(c.z);
+							}
+							dest[x] = c;
+						}
+					}
+				});
+				return format == tf_rgba32f ? float_pb : float_pb.to_format(format);
+			}
+
+			LinearImage resample(int new_width, int new_height, ResampleFilter filter) const
+			{
+				ResampleWeights weights_x(width, new_width, filter);
+				ResampleWeights weights_y(height, new_height, filter);
+
+				// Horizontal pass first, as it shrinks the rows the vertical pass has to read
+				LinearImage columns(new_width, height);
+				get_resample_queue().parallel_for(0, height, band_rows(new_width * weights_x.taps), [&](int first_row, int last_row)
+				{
+					for (int y = first_row; y < last_row; y++)
+					{
+						const Vec4f *src = line(y);
+						Vec4f *dest = columns.line(y);
+						for (int x = 0; x < new_width; x++)
+							dest[x] = convolve(src + weights_x.first[x], &weights_x.weights[x * weights_x.taps], weights_x.taps);
+					}
+				});
+
+				LinearImage result(new_width, new_height);
+				get_resample_queue().parallel_for(0, new_height, band_rows(new_width * weights_y.taps), [&](int first_row, int last_row)
+				{
+					for (int y = first_row; y < last_row; y++)
+					{
+						Vec4f *dest = result.line(y);
+						const float *w = &weights_y.weights[y * weights_y.taps];
+						for (int k = 0; k < weights_y.taps; k++)
+							accumulate(dest, columns.line(weights_y.first[y] + k), w[k], new_width);
+					}
+				});
+				return result;
+			}
+
+			Vec4f *line(int y) { return pixels.data() + y * width; }
+			const Vec4f *line(int y) const { return pixels.data() + y * width; }
+
+			int width;
+			int height;
+			std::vector<Vec4f> pixels;
+		};
+
+		bool is_srgb(const PixelBuffer &pb, bool srgb)
+		{
+			if (pb.is_null())
+				throw Exception("PixelBufferHelp cannot resample a null pixel buffer");
+			if (pb.is_compressed())
+				throw Exception("PixelBufferHelp cannot resample compressed pixel buffers");
+			return srgb || pb.get_format() == tf_srgb8 || pb.get_format() == tf_srgb8_alpha8;
+		}
+	}
+
 	PixelBuffer PixelBufferHelp::add_border(const PixelBuffer &pb, int border_size, const Rect &rect)
 	{
 		if (rect.left < 0 || rect.top < 0 || rect.right > pb.get_width() || rect.bottom > pb.get_height())
@@ -96,4 +401,42 @@ namespace clan
 		}
 		return new_pb;
 	}
+
+	PixelBuffer PixelBufferHelp::resample(const PixelBuffer &pb, int new_width, int new_height, ResampleFilter filter, bool srgb)
+	{
+		if (new_width <= 0 || new_height <= 0)
+			throw Exception("Invalid size passed to PixelBufferHelp::resample()");
+
+		srgb = is_srgb(pb, srgb);
+		return LinearImage::decode(pb, srgb).resample(new_width, new_height, filter).encode(pb.get_format(), srgb);
+	}
+
+	PixelBuffer PixelBufferHelp::downsample(const PixelBuffer &pb, ResampleFilter filter, bool srgb)
+	{
+		return resample(pb, max(pb.get_width() / 2, 1), max(pb.get_height() / 2, 1), filter, srgb);
+	}
+
+	PixelBufferSet PixelBufferHelp::generate_mipmaps(PixelBufferSet set, ResampleFilter filter, bool srgb)
+	{
+		set.throw_if_null();
+		if (set.get_base_level() == -1)
+			throw Exception("PixelBufferSet passed to PixelBufferHelp::generate_mipmaps() has no images");
+
+		PixelBufferSet result(set.get_dimensions(), set.get_format(), set.get_width(), set.get_height(), set.get_slice_count());
+		for (int slice = 0; slice < set.get_slice_count(); slice++)
+		{
+			int level = set.get_base_level();
+			PixelBuffer base = set.get_image(slice, level);
+			bool slice_srgb = is_srgb(base, srgb);
+			result.set_image(slice, level, base);
+
+			LinearImage image = LinearImage::decode(base, slice_srgb);
+			while (image.width > 1 || image.height > 1)
+			{
+				image = image.resample(max(image.width / 2, 1), max(image.height / 2, 1), filter);
+				result.set_image(slice, ++level, image.encode(base.get_format(), slice_srgb));
+			}
+		}
+		return result;
+	}
 }
@@ -96,13 +96,25 @@ namespace clan
 		{
 		case tf_compressed_rgb_s3tc_dxt1:
 		case tf_compressed_rgba_s3tc_dxt1:
-		case tf_compressed_rgba_s3tc_dxt3:
 		case tf_compressed_srgb_s3tc_dxt1:
 		case tf_compressed_srgb_alpha_s3tc_dxt1:
-		case tf_compressed_srgb_alpha_s3tc_dxt3:
+		case tf_compressed_red_rgtc1:
+		case tf_compressed_signed_red_rgtc1:
+		case tf_compressed_rgb8_etc2:
+		case tf_compressed_srgb8_etc2:
 			return 8;
+		case tf_compressed_rgba_s3tc_dxt3:
+		case tf_compressed_srgb_alpha_s3tc_dxt3:
 		case tf_compressed_rgba_s3tc_dxt5:
 		case tf_compressed_srgb_alpha_s3tc_dxt5:
+		case tf_compressed_rg_rgtc2:
+		case tf_compressed_signed_rg_rgtc2:
+		case tf_compressed_rgba_bptc_unorm:
+		case tf_compressed_srgb_alpha_bptc_unorm:
+		case tf_compressed_rgba8_etc2_eac:
+		case tf_compressed_srgb8_alpha8_etc2_eac:
+		case tf_compressed_rgba_astc_4x4:
+		case tf_compressed_srgb8_alpha8_astc_4x4:
 			return 16;
 		default:
 			throw Exception("cannot obtain block count for this TextureFormat");
@@ -121,6 +133,18 @@ namespace clan
 		case tf_compressed_srgb_alpha_s3tc_dxt3:
 		case tf_compressed_rgba_s3tc_dxt5:
 		case tf_compressed_srgb_alpha_s3tc_dxt5:
+		case tf_compressed_red_rgtc1:
+		case tf_compressed_signed_red_rgtc1:
+		case tf_compressed_rg_rgtc2:
+		case tf_compressed_signed_rg_rgtc2:
+		case tf_compressed_rgba_bptc_unorm:
+		case tf_compressed_srgb_alpha_bptc_unorm:
+		case tf_compressed_rgb8_etc2:
+		case tf_compressed_srgb8_etc2:
+		case tf_compressed_rgba8_etc2_eac:
+		case tf_compressed_srgb8_alpha8_etc2_eac:
+		case tf_compressed_rgba_astc_4x4:
+		case tf_compressed_srgb8_alpha8_astc_4x4:
 			return true;
 		default:
 			return false;
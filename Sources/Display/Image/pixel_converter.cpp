@@ -31,6 +31,7 @@
 #include "API/Display/Image/pixel_converter.h"
 #include "API/Core/System/databuffer.h"
 #include "API/Core/System/system.h"
+#include "API/Core/System/work_queue.h"
 #include "pixel_converter_impl.h"
 #include "pixel_reader_cast.h"
 #include "pixel_reader_half_float.h"
@@ -54,9 +55,19 @@
 #include "pixel_filter_premultiply_alpha.h"
 #include "pixel_filter_swizzle.h"
 #include "pixel_filter_rgb_to_ycrcb.h"
+#include "pixel_converter_direct.h"
 
 namespace clan
 {
+	namespace
+	{
+		WorkQueue &get_converter_queue()
+		{
+			static WorkQueue queue;
+			return queue;
+		}
+	}
+
 	PixelConverter::PixelConverter()
 		: impl(std::make_shared<PixelConverter_Impl>())
 	{
@@ -96,6 +107,11 @@ namespace clan
 		return impl->output_is_ycrcb;
 	}
 
+	bool PixelConverter::get_multithreaded() const
+	{
+		return impl->multithreaded;
+	}
+
 	void PixelConverter::set_premultiply_alpha(bool enable)
 	{
 		impl->premultiply_alpha = enable;
@@ -131,27 +147,77 @@ namespace clan
 		impl->output_is_ycrcb = enable;
 	}
 
+	void PixelConverter::set_multithreaded(bool enable)
+	{
+		impl->multithreaded = enable;
+	}
+
 	void PixelConverter::convert(void *output, int output_pitch, TextureFormat output_format, const void *input, int input_pitch, TextureFormat input_format, int width, int height)
+	{
+		// Created here even when converting on worker threads, so unsupported formats throw on the calling thread
+		PixelPipeline pipeline = impl->create_pipeline(output_format, input_format);
+
+		if (!impl->multithreaded || width <= 0 || height <= 1 || (int64_t)width * height < PixelConverter_Impl::min_band_pixels * 2)
+		{
+			impl->convert_rows(pipeline, output, output_pitch, input, input_pitch, width, height, 0, height);
+			return;
+		}
+
+		// Each band gets its own pipeline and a scratch line, so the bands share no state
+		int band_rows = std::max(PixelConverter_Impl::min_band_pixels / width, 1);
+		PixelConverter_Impl *converter = impl.get();
+		get_converter_queue().parallel_for(0, height, band_rows, [&](int first_row, int last_row)
+		{
+			PixelPipeline band_pipeline = converter->create_pipeline(output_format, input_format);
+			converter->convert_rows(band_pipeline, output, output_pitch, input, input_pitch, width, height, first_row, last_row);
+		});
+	}
+
+	PixelPipeline PixelConverter_Impl::create_pipeline(TextureFormat output_format, TextureFormat input_format)
 	{
 		bool sse2 = System::detect_cpu_extension(System::sse2);
 		bool sse4 = System::detect_cpu_extension(System::sse4_1);
+		bool ssse3 = System::detect_cpu_extension(System::ssse3);
+		bool avx2 = System::detect_cpu_extension(System::avx2);
+
+		PixelPipeline pipeline;
+		pipeline.direct = create_direct_converter(input_format, output_format, ssse3, avx2);
+		if (!pipeline.direct)
+		{
+			pipeline.reader = create_reader(input_format, sse2);
+			pipeline.writer = create_writer(output_format, sse2, sse4);
+			pipeline.filters = create_filters(sse2);
+		}
+		return pipeline;
+	}
 
-		std::unique_ptr<PixelReader> reader = impl->create_reader(input_format, sse2);
-		std::unique_ptr<PixelWriter> writer = impl->create_writer(output_format, sse2, sse4);
-		std::vector<std::shared_ptr<PixelFilter> > filters = impl->create_filters(sse2);
+	void PixelConverter_Impl::convert_rows(PixelPipeline &pipeline, void *output, int output_pitch, const void *input, int input_pitch, int width, int height, int first_row, int last_row)
+	{
+		if (pipeline.direct)
+		{
+			for (int input_y = first_row; input_y < last_row; input_y++)
+			{
+				int output_y = flip_vertical ? (height - 1 - input_y) : input_y;
+
+				const char *input_line = static_cast<const char*>(input)+input_pitch * input_y;
+				char *output_line = static_cast<char*>(output)+output_pitch * output_y;
+				pipeline.direct->convert(output_line, input_line, width);
+			}
+			return;
+		}
 
 		DataBuffer work_buffer(width * sizeof(Vec4f));
 		Vec4f *temp = work_buffer.get_data<Vec4f>();
-		for (int input_y = 0; input_y < height; input_y++)
+		for (int input_y = first_row; input_y < last_row; input_y++)
 		{
-			int output_y = impl->flip_vertical ? (height - 1 - input_y) : input_y;
+			int output_y = flip_vertical ? (height - 1 - input_y) : input_y;
 
 			const char *input_line = static_cast<const char*>(input)+input_pitch * input_y;
 			char *output_line = static_cast<char*>(output)+output_pitch * output_y;
-			reader->read(input_line, temp, width);
-			for (auto & filter : filters)
+			pipeline.reader->read(input_line, temp, width);
+			for (auto & filter : pipeline.filters)
 				filter->filter(temp, width);
-			writer->write(output_line, temp, width);
+			pipeline.writer->write(output_line, temp, width);
 		}
 	}
 
@@ -336,6 +402,14 @@ namespace clan
 		case tf_compressed_srgb_alpha_s3tc_dxt1:
 		case tf_compressed_srgb_alpha_s3tc_dxt3:
 		case tf_compressed_srgb_alpha_s3tc_dxt5:
+		case tf_compressed_rgba_bptc_unorm:
+		case tf_compressed_srgb_alpha_bptc_unorm:
+		case tf_compressed_rgb8_etc2:
+		case tf_compressed_srgb8_etc2:
+		case tf_compressed_rgba8_etc2_eac:
+		case tf_compressed_srgb8_alpha8_etc2_eac:
+		case tf_compressed_rgba_astc_4x4:
+		case tf_compressed_srgb8_alpha8_astc_4x4:
 		default:
 			break;
 		};
@@ -525,6 +599,14 @@ namespace clan
 		case tf_compressed_srgb_alpha_s3tc_dxt1:
 		case tf_compressed_srgb_alpha_s3tc_dxt3:
 		case tf_compressed_srgb_alpha_s3tc_dxt5:
+		case tf_compressed_rgba_bptc_unorm:
+		case tf_compressed_srgb_alpha_bptc_unorm:
+		case tf_compressed_rgb8_etc2:
+		case tf_compressed_srgb8_etc2:
+		case tf_compressed_rgba8_etc2_eac:
+		case tf_compressed_srgb8_alpha8_etc2_eac:
+		case tf_compressed_rgba_astc_4x4:
+		case tf_compressed_srgb8_alpha8_astc_4x4:
 		default:
 			break;
 		};
@@ -587,4 +669,84 @@ namespace clan
 
 		return filters;
 	}
+
+	namespace
+	{
+		// Byte count and channel order of the formats with a direct conversion
+		bool get_direct_layout(TextureFormat format, int &bytes, bool &bgr)
+		{
+			switch (format)
+			{
+			case tf_rgba8: bytes = 4; bgr = false; return true;
+			case tf_bgra8: bytes = 4; bgr = true; return true;
+			case tf_rgb8: bytes = 3; bgr = false; return true;
+			case tf_bgr8: bytes = 3; bgr = true; return true;
+			default: return false;
+			}
+		}
+
+		template<int InBytes, int OutBytes, bool Premultiply>
+		std::unique_ptr<PixelConverterDirect> create_direct(const int *channel_map, bool ssse3, bool avx2)
+		{
+#if defined CL_PIXEL_DIRECT_SSE
+			if (InBytes == 4 && OutBytes == 4)
+			{
+				if (avx2)
+					return std::unique_ptr<PixelConverterDirect>(new PixelConverterDirectAVX2_4to4<Premultiply>(channel_map));
+				else if (ssse3)
+					return std::unique_ptr<PixelConverterDirect>(new PixelConverterDirectSSSE3_4to4<Premultiply>(channel_map));
+			}
+			else if (InBytes == 3 && OutBytes == 4 && ssse3)
+			{
+				return std::unique_ptr<PixelConverterDirect>(new PixelConverterDirectSSSE3_3to4(channel_map));
+			}
+			else if (InBytes == 4 && OutBytes == 3 && ssse3)
+			{
+				return std::unique_ptr<PixelConverterDirect>(new PixelConverterDirectSSSE3_4to3<Premultiply>(channel_map));
+			}
+#elif defined CL_PIXEL_DIRECT_NEON
+			return std::unique_ptr<PixelConverterDirect>(new PixelConverterDirectNEON<InBytes, OutBytes, Premultiply>(channel_map));
+#endif
+			return std::unique_ptr<PixelConverterDirect>(new PixelConverterDirect_8bit<InBytes, OutBytes, Premultiply>(channel_map));
+		}
+	}
+
+	std::unique_ptr<PixelConverterDirect> PixelConverter_Impl::create_direct_converter(TextureFormat input_format, TextureFormat output_format, bool ssse3, bool avx2)
+	{
+		if (gamma != 1.0f || input_is_ycrcb || output_is_ycrcb)
+			return nullptr;
+
+		int input_bytes, output_bytes;
+		bool input_bgr, output_bgr;
+		if (!get_direct_layout(input_format, input_bytes, input_bgr) || !get_direct_layout(output_format, output_bytes, output_bgr))
+			return nullptr;
+
+		int swizzle_channels[4] = { swizzle.x, swizzle.y, swizzle.z, swizzle.w };
+		for (int channel : swizzle_channels)
+		{
+			if (channel < 0 || channel > 3)
+				return nullptr;
+		}
+
+		// Output byte i holds a channel which the swizzle takes from another channel, which is stored in input byte channel_map[i]
+		int channel_map[4];
+		for (int i = 0; i < 4; i++)
+		{
+			int output_channel = (output_bgr && i < 3) ? 2 - i : i;
+			int input_channel = swizzle_channels[output_channel];
+			channel_map[i] = (input_bgr && input_channel < 3) ? 2 - input_channel : input_channel;
+		}
+
+		// Premultiplying by the constant alpha of a three channel input changes nothing
+		bool premultiply = premultiply_alpha && input_bytes == 4;
+
+		if (input_bytes == 4 && output_bytes == 4)
+			return premultiply ? create_direct<4, 4, true>(channel_map, ssse3, avx2) : create_direct<4, 4, false>(channel_map, ssse3, avx2);
+		else if (input_bytes == 4 && output_bytes == 3)
+			return premultiply ? create_direct<4, 3, true>(channel_map, ssse3, avx2) : create_direct<4, 3, false>(channel_map, ssse3, avx2);
+		else if (input_bytes == 3 && output_bytes == 4)
+			return create_direct<3, 4, false>(channel_map, ssse3, avx2);
+		else
+			return create_direct<3, 3, false>(channel_map, ssse3, avx2);
+	}
 }
@@ -0,0 +1,367 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+**    Mark Page
+*/
+
+#pragma once
+
+#include "pixel_converter_impl.h"
+
+#if !defined __ANDROID__ && ! defined CL_DISABLE_SSE2
+#include <immintrin.h>
+#define CL_PIXEL_DIRECT_SSE
+#if defined(__GNUC__)
+// The kernels are compiled for their instruction set only, and selected at runtime
+#define CL_TARGET_SSSE3 __attribute__((target("ssse3")))
+#define CL_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define CL_TARGET_SSSE3
+#define CL_TARGET_AVX2
+#endif
+#endif
+
+#if !defined __SSE2__ && (defined __ARM_NEON || defined __ARM_NEON__)
+#include <arm_neon.h>
+#define CL_PIXEL_DIRECT_NEON
+#endif
+
+namespace clan
+{
+	/// \brief Converts between the 8 bit rgb(a) and bgr(a) formats with integer arithmetic
+	///
+	/// channel_map gives the input byte of each output byte. Input byte 3 of a three byte format reads as 255.
+	/// The alpha is premultiplied before the channels are mapped, like PixelFilterPremultiplyAlpha comes before the swizzle.
+	template<int InBytes, int OutBytes, bool Premultiply>
+	class PixelConverterDirect_8bit : public PixelConverterDirect
+	{
+	public:
+		PixelConverterDirect_8bit(const int *channel_map)
+		{
+			for (int i = 0; i < 4; i++)
+				map[i] = channel_map[i];
+		}
+
+		void convert(void *output, const void *input, int num_pixels) override
+		{
+			const unsigned char *s = static_cast<const unsigned char *>(input);
+			unsigned char *d = static_cast<unsigned char *>(output);
+			for (int i = 0; i < num_pixels; i++, s += InBytes, d += OutBytes)
+			{
+				unsigned char pixel[4] = { s[0], s[1], s[2], InBytes == 4 ? s[3] : (unsigned char)255 };
+				if (Premultiply)
+				{
+					pixel[0] = premultiply(pixel[0], pixel[3]);
+					pixel[1] = premultiply(pixel[1], pixel[3]);
+					pixel[2] = premultiply(pixel[2], pixel[3]);
+				}
+				for (int c = 0; c < OutBytes; c++)
+					d[c] = pixel[map[c]];
+			}
+		}
+
+	private:
+		// Rounded c * a / 255
+		static unsigned char premultiply(unsigned int c, unsigned int a)
+		{
+			unsigned int v = c * a + 128;
+			return (unsigned char)((v + (v >> 8)) >> 8);
+		}
+
+		int map[4];
+	};
+
+#ifdef CL_PIXEL_DIRECT_SSE
+
+	template<bool Premultiply>
+	class PixelConverterDirectSSSE3_4to4 : public PixelConverterDirect
+	{
+	public:
+		PixelConverterDirectSSSE3_4to4(const int *channel_map) : scalar(channel_map)
+		{
+			for (int i = 0; i < 16; i++)
+				mask[i] = (char)((i / 4) * 4 + channel_map[i % 4]);
+		}
+
+		CL_TARGET_SSSE3 void convert(void *output, const void *input, int num_pixels) override
+		{
+			const unsigned char *s = static_cast<const unsigned char *>(input);
+			unsigned char *d = static_cast<unsigned char *>(output);
+			__m128i shuffle = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask));
+
+			int sse_length = (num_pixels / 4) * 4;
+			for (int i = 0; i < sse_length; i += 4)
+			{
+				__m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i * 4));
+				if (Premultiply)
+					pixels = premultiply(pixels);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(d + i * 4), _mm_shuffle_epi8(pixels, shuffle));
+			}
+
+			scalar.convert(d + sse_length * 4, s + sse_length * 4, num_pixels - sse_length);
+		}
+
+		// Multiplies the colors of four rgba or bgra pixels by their alpha
+		CL_TARGET_SSSE3 static __m128i premultiply(__m128i pixels)
+		{
+			__m128i zero = _mm_setzero_si128();
+			__m128i color_lanes = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+			__m128i alpha_lanes = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+
+			__m128i lo = _mm_unpacklo_epi8(pixels, zero);
+			__m128i hi = _mm_unpackhi_epi8(pixels, zero);
+			__m128i alpha_lo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+			__m128i alpha_hi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+			alpha_lo = _mm_or_si128(_mm_and_si128(alpha_lo, color_lanes), alpha_lanes);
+			alpha_hi = _mm_or_si128(_mm_and_si128(alpha_hi, color_lanes), alpha_lanes);
+
+			return _mm_packus_epi16(divide_255(_mm_mullo_epi16(lo, alpha_lo)), divide_255(_mm_mullo_epi16(hi, alpha_hi)));
+		}
+
+	private:
+		CL_TARGET_SSSE3 static __m128i divide_255(__m128i v)
+		{
+			v = _mm_add_epi16(v, _mm_set1_epi16(128));
+			return _mm_srli_epi16(_mm_add_epi16(v, _mm_srli_epi16(v, 8)), 8);
+		}
+
+		PixelConverterDirect_8bit<4, 4, Premultiply> scalar;
+		char mask[16];
+	};
+
+	class PixelConverterDirectSSSE3_3to4 : public PixelConverterDirect
+	{
+	public:
+		PixelConverterDirectSSSE3_3to4(const int *channel_map) : scalar(channel_map)
+		{
+			for (int i = 0; i < 16; i++)
+			{
+				int source = channel_map[i % 4];
+				mask[i] = source == 3 ? (char)0x80 : (char)((i / 4) * 3 + source);	// 0x80 clears the byte
+				alpha[i] = source == 3 ? (char)0xff : 0;
+			}
+		}
+
+		CL_TARGET_SSSE3 void convert(void *output, const void *input, int num_pixels) override
+		{
+			const unsigned char *s = static_cast<const unsigned char *>(input);
+			unsigned char *d = static_cast<unsigned char *>(output);
+			__m128i shuffle = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask));
+			__m128i alpha_bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(alpha));
+
+			// Four pixels are 12 bytes, but 16 are loaded
+			int i = 0;
+			for (; (i + 4) * 3 + 4 <= num_pixels * 3; i += 4)
+			{
+				__m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i * 3));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(d + i * 4), _mm_or_si128(_mm_shuffle_epi8(pixels, shuffle), alpha_bytes));
+			}
+
+			scalar.convert(d + i * 4, s + i * 3, num_pixels - i);
+		}
+
+	private:
+		PixelConverterDirect_8bit<3, 4, false> scalar;
+		char mask[16];
+		char alpha[16];
+	};
+
+	template<bool Premultiply>
+	class PixelConverterDirectSSSE3_4to3 : public PixelConverterDirect
+	{
+	public:
+		PixelConverterDirectSSSE3_4to3(const int *channel_map) : scalar(channel_map)
+		{
+			for (int i = 0; i < 16; i++)
+				mask[i] = i < 12 ? (char)((i / 3) * 4 + channel_map[i % 3]) : (char)0x80;
+		}
+
+		CL_TARGET_SSSE3 void convert(void *output, const void *input, int num_pixels) override
+		{
+			const unsigned char *s = static_cast<const unsigned char *>(input);
+			unsigned char *d = static_cast<unsigned char *>(output);
+			__m128i shuffle = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask));
+
+			int sse_length = (num_pixels / 4) * 4;
+			for (int i = 0; i < sse_length; i += 4)
+			{
+				__m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i * 4));
+				if (Premultiply)
+					pixels = PixelConverterDirectSSSE3_4to4<true>::premultiply(pixels);
+				pixels = _mm_shuffle_epi8(pixels, shuffle);
+
+				// Store 12 bytes
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(d + i * 3), pixels);
+				int last = _mm_cvtsi128_si32(_mm_srli_si128(pixels, 8));
+				memcpy(d + i * 3 + 8, &last, 4);
+			}
+
+			scalar.convert(d + sse_length * 3, s + sse_length * 4, num_pixels - sse_length);
+		}
+
+	private:
+		PixelConverterDirect_8bit<4, 3, Premultiply> scalar;
+		char mask[16];
+	};
+
+	template<bool Premultiply>
+	class PixelConverterDirectAVX2_4to4 : public PixelConverterDirect
+	{
+	public:
+		PixelConverterDirectAVX2_4to4(const int *channel_map) : scalar(channel_map)
+		{
+			for (int i = 0; i < 16; i++)
+				mask[i] = (char)((i / 4) * 4 + channel_map[i % 4]);
+		}
+
+		CL_TARGET_AVX2 void convert(void *output, const void *input, int num_pixels) override
+		{
+			const unsigned char *s = static_cast<const unsigned char *>(input);
+			unsigned char *d = static_cast<unsigned char *>(output);
+
+			// The byte shuffle works within each 128 bit lane, which holds four whole pixels
+			__m256i shuffle = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(mask)));
+
+			int avx_length = (num_pixels / 8) * 8;
+			for (int i = 0; i < avx_length; i += 8)
+			{
+				__m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i * 4));
+				if (Premultiply)
+					pixels = premultiply(pixels);
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(d + i * 4), _mm256_shuffle_epi8(pixels, shuffle));
+			}
+
+			scalar.convert(d + avx_length * 4, s + avx_length * 4, num_pixels - avx_length);
+		}
+
+	private:
+		CL_TARGET_AVX2 static __m256i premultiply(__m256i pixels)
+		{
+			__m256i zero = _mm256_setzero_si256();
+			__m256i color_lanes = _mm256_set_epi16(0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1);
+			__m256i alpha_lanes = _mm256_set_epi16(255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0);
+
+			// Unpacking and packing both work per lane, so the pixel order is kept
+			__m256i lo = _mm256_unpacklo_epi8(pixels, zero);
+			__m256i hi = _mm256_unpackhi_epi8(pixels, zero);
+			__m256i alpha_lo = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(lo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+			__m256i alpha_hi = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(hi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+			alpha_lo = _mm256_or_si256(_mm256_and_si256(alpha_lo, color_lanes), alpha_lanes);
+			alpha_hi = _mm256_or_si256(_mm256_and_si256(alpha_hi, color_lanes), alpha_lanes);
+
+			return _mm256_packus_epi16(divide_255(_mm256_mullo_epi16(lo, alpha_lo)), divide_255(_mm256_mullo_epi16(hi, alpha_hi)));
+		}
+
+		CL_TARGET_AVX2 static __m256i divide_255(__m256i v)
+		{
+			v = _mm256_add_epi16(v, _mm256_set1_epi16(128));
+			return _mm256_srli_epi16(_mm256_add_epi16(v, _mm256_srli_epi16(v, 8)), 8);
+		}
+
+		PixelConverterDirect_8bit<4, 4, Premultiply> scalar;
+		char mask[16];
+	};
+
+#endif
+
+#ifdef CL_PIXEL_DIRECT_NEON
+
+	template<int InBytes, int OutBytes, bool Premultiply>
+	class PixelConverterDirectNEON : public PixelConverterDirect
+	{
+	public:
+		PixelConverterDirectNEON(const int *channel_map) : scalar(channel_map)
+		{
+			for (int i = 0; i < 4; i++)
+				map[i] = channel_map[i];
+		}
+
+		void convert(void *output, const void *input, int num_pixels) override
+		{
+			const unsigned char *s = static_cast<const unsigned char *>(input);
+			unsigned char *d = static_cast<unsigned char *>(output);
+
+			// The structured loads and stores split the pixels into one register per channel
+			int neon_length = (num_pixels / 16) * 16;
+			for (int i = 0; i < neon_length; i += 16)
+			{
+				uint8x16_t channels[4];
+				if (InBytes == 4)
+				{
+					uint8x16x4_t pixels = vld4q_u8(s + i * 4);
+					for (int c = 0; c < 4; c++)
+						channels[c] = pixels.val[c];
+				}
+				else
+				{
+					uint8x16x3_t pixels = vld3q_u8(s + i * 3);
+					for (int c = 0; c < 3; c++)
+						channels[c] = pixels.val[c];
+					channels[3] = vdupq_n_u8(255);
+				}
+
+				if (Premultiply)
+				{
+					for (int c = 0; c < 3; c++)
+						channels[c] = premultiply(channels[c], channels[3]);
+				}
+
+				if (OutBytes == 4)
+				{
+					uint8x16x4_t pixels;
+					for (int c = 0; c < 4; c++)
+						pixels.val[c] = channels[map[c]];
+					vst4q_u8(d + i * 4, pixels);
+				}
+				else
+				{
+					uint8x16x3_t pixels;
+					for (int c = 0; c < 3; c++)
+						pixels.val[c] = channels[map[c]];
+					vst3q_u8(d + i * 3, pixels);
+				}
+			}
+
+			scalar.convert(d + neon_length * OutBytes, s + neon_length * InBytes, num_pixels - neon_length);
+		}
+
+	private:
+		static uint8x16_t premultiply(uint8x16_t color, uint8x16_t alpha)
+		{
+			uint16x8_t rounding = vdupq_n_u16(128);
+			uint16x8_t lo = vaddq_u16(vmull_u8(vget_low_u8(color), vget_low_u8(alpha)), rounding);
+			uint16x8_t hi = vaddq_u16(vmull_u8(vget_high_u8(color), vget_high_u8(alpha)), rounding);
+			lo = vaddq_u16(lo, vshrq_n_u16(lo, 8));
+			hi = vaddq_u16(hi, vshrq_n_u16(hi, 8));
+			return vcombine_u8(vshrn_n_u16(lo, 8), vshrn_n_u16(hi, 8));
+		}
+
+		PixelConverterDirect_8bit<InBytes, OutBytes, Premultiply> scalar;
+		int map[4];
+	};
+
+#endif
+}
@@ -57,14 +57,36 @@ namespace clan
 		virtual void filter(Vec4f *pixels, int num_pixels) = 0;
 	};
 
+	/// \brief Converts pixels in one step, without reading them into Vec4f
+	class PixelConverterDirect
+	{
+	public:
+		virtual ~PixelConverterDirect() { }
+		virtual void convert(void *output, const void *input, int num_pixels) = 0;
+	};
+
+	/// \brief The objects converting one band of rows. Either direct or reader, filters and writer are set.
+	class PixelPipeline
+	{
+	public:
+		std::unique_ptr<PixelConverterDirect> direct;
+		std::unique_ptr<PixelReader> reader;
+		std::vector<std::shared_ptr<PixelFilter> > filters;
+		std::unique_ptr<PixelWriter> writer;
+	};
+
 	class PixelConverter_Impl
 	{
 	public:
-		PixelConverter_Impl() : premultiply_alpha(false), flip_vertical(false), gamma(1.0f), swizzle(0, 1, 2, 3), input_is_ycrcb(false), output_is_ycrcb(false) { }
+		PixelConverter_Impl() : premultiply_alpha(false), flip_vertical(false), gamma(1.0f), swizzle(0, 1, 2, 3), input_is_ycrcb(false), output_is_ycrcb(false), multithreaded(false) { }
+
+		PixelPipeline create_pipeline(TextureFormat output_format, TextureFormat input_format);
+		void convert_rows(PixelPipeline &pipeline, void *output, int output_pitch, const void *input, int input_pitch, int width, int height, int first_row, int last_row);
 
 		std::unique_ptr<PixelReader> create_reader(TextureFormat format, bool sse2);
 		std::unique_ptr<PixelWriter> create_writer(TextureFormat format, bool sse2, bool sse4);
 		std::vector<std::shared_ptr<PixelFilter> > create_filters(bool sse2);
+		std::unique_ptr<PixelConverterDirect> create_direct_converter(TextureFormat input_format, TextureFormat output_format, bool ssse3, bool avx2);
 
 		bool premultiply_alpha;
 		bool flip_vertical;
@@ -72,5 +94,9 @@ namespace clan
 		Vec4i swizzle;
 		bool input_is_ycrcb;
 		bool output_is_ycrcb;
+		bool multithreaded;
+
+		// Images smaller than this are converted on the calling thread, and bands are at least this large
+		static const int min_band_pixels = 256 * 256;
 	};
 }
@@ -30,6 +30,7 @@
 #pragma once
 
 #include "pixel_converter_impl.h"
+#include "API/Core/Math/cl_math.h"
 
 namespace clan
 {
@@ -38,11 +39,7 @@ namespace clan
 	public:
 		void read(const void *input, Vec4f *output, int num_pixels) override
 		{
-			const Vec4hf *d = static_cast<const Vec4hf *>(input);
-			for (int i = 0; i < num_pixels; i++)
-			{
-				output[i] = Vec4f(d[i]);
-			}
+			HalfFloat::half_to_float(static_cast<const unsigned short *>(input), &output[0].x, num_pixels * 4);
 		}
 	};
 
@@ -51,10 +48,17 @@ namespace clan
 	public:
 		void read(const void *input, Vec4f *output, int num_pixels) override
 		{
-			const Vec3hf *d = static_cast<const Vec3hf *>(input);
-			for (int i = 0; i < num_pixels; i++)
+			const unsigned short *d = static_cast<const unsigned short *>(input);
+			float buffer[3 * 64];
+			for (int start = 0; start < num_pixels; start += 64)
 			{
-				output[i] = Vec4f(d[i], 1.0f);
+				int count = min(num_pixels - start, 64);
+				HalfFloat::half_to_float(d + start * 3, buffer, count * 3);
+				for (int i = 0; i < count; i++)
+				{
+					const float *f = buffer + i * 3;
+					output[start + i] = Vec4f(f[0], f[1], f[2], 1.0f);
+				}
 			}
 		}
 	};
@@ -64,10 +68,17 @@ namespace clan
 	public:
 		void read(const void *input, Vec4f *output, int num_pixels) override
 		{
-			const Vec2hf *d = static_cast<const Vec2hf *>(input);
-			for (int i = 0; i < num_pixels; i++)
+			const unsigned short *d = static_cast<const unsigned short *>(input);
+			float buffer[2 * 64];
+			for (int start = 0; start < num_pixels; start += 64)
 			{
-				output[i] = Vec4f(d[i], 0.0f, 1.0f);
+				int count = min(num_pixels - start, 64);
+				HalfFloat::half_to_float(d + start * 2, buffer, count * 2);
+				for (int i = 0; i < count; i++)
+				{
+					const float *f = buffer + i * 2;
+					output[start + i] = Vec4f(f[0], f[1], 0.0f, 1.0f);
+				}
 			}
 		}
 	};
@@ -77,10 +88,17 @@ namespace clan
 	public:
 		void read(const void *input, Vec4f *output, int num_pixels) override
 		{
-			const HalfFloat *d = static_cast<const HalfFloat *>(input);
-			for (int i = 0; i < num_pixels; i++)
+			const unsigned short *d = static_cast<const unsigned short *>(input);
+			float buffer[1 * 64];
+			for (int start = 0; start < num_pixels; start += 64)
 			{
-				output[i] = Vec4f(d[i], 0.0f, 0.0f, 1.0f);
+				int count = min(num_pixels - start, 64);
+				HalfFloat::half_to_float(d + start * 1, buffer, count * 1);
+				for (int i = 0; i < count; i++)
+				{
+					const float *f = buffer + i * 1;
+					output[start + i] = Vec4f(f[0], 0.0f, 0.0f, 1.0f);
+				}
 			}
 		}
 	};
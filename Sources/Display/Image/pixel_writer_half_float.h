@@ -30,6 +30,7 @@
 #pragma once
 
 #include "pixel_converter_impl.h"
+#include "API/Core/Math/cl_math.h"
 
 namespace clan
 {
@@ -38,11 +39,7 @@ namespace clan
 	public:
 		void write(void *output, Vec4f *input, int num_pixels) override
 		{
-			Vec4hf *d = static_cast<Vec4hf *>(output);
-			for (int i = 0; i < num_pixels; i++)
-			{
-				d[i] = Vec4hf(input[i]);
-			}
+			HalfFloat::float_to_half(&input[0].x, static_cast<unsigned short *>(output), num_pixels * 4);
 		}
 	};
 
@@ -51,10 +48,19 @@ namespace clan
 	public:
 		void write(void *output, Vec4f *input, int num_pixels) override
 		{
-			Vec3hf *d = static_cast<Vec3hf *>(output);
-			for (int i = 0; i < num_pixels; i++)
+			unsigned short *d = static_cast<unsigned short *>(output);
+			float buffer[3 * 64];
+			for (int start = 0; start < num_pixels; start += 64)
 			{
-				d[i] = Vec3hf(input[i]);
+				int count = min(num_pixels - start, 64);
+				for (int i = 0; i < count; i++)
+				{
+					float *f = buffer + i * 3;
+					f[0] = input[start + i].x;
+					f[1] = input[start + i].y;
+					f[2] = input[start + i].z;
+				}
+				HalfFloat::float_to_half(buffer, d + start * 3, count * 3);
 			}
 		}
 	};
@@ -64,10 +70,18 @@ namespace clan
 	public:
 		void write(void *output, Vec4f *input, int num_pixels) override
 		{
-			Vec2hf *d = static_cast<Vec2hf *>(output);
-			for (int i = 0; i < num_pixels; i++)
+			unsigned short *d = static_cast<unsigned short *>(output);
+			float buffer[2 * 64];
+			for (int start = 0; start < num_pixels; start += 64)
 			{
-				d[i] = Vec2hf(input[i]);
+				int count = min(num_pixels - start, 64);
+				for (int i = 0; i < count; i++)
+				{
+					float *f = buffer + i * 2;
+					f[0] = input[start + i].x;
+					f[1] = input[start + i].y;
+				}
+				HalfFloat::float_to_half(buffer, d + start * 2, count * 2);
 			}
 		}
 	};
@@ -77,10 +91,17 @@ namespace clan
 	public:
 		void write(void *output, Vec4f *input, int num_pixels) override
 		{
-			HalfFloat *d = static_cast<HalfFloat *>(output);
-			for (int i = 0; i < num_pixels; i++)
+			unsigned short *d = static_cast<unsigned short *>(output);
+			float buffer[1 * 64];
+			for (int start = 0; start < num_pixels; start += 64)
 			{
-				d[i] = HalfFloat(input[i].x);
+				int count = min(num_pixels - start, 64);
+				for (int i = 0; i < count; i++)
+				{
+					float *f = buffer + i * 1;
+					f[0] = input[start + i].x;
+				}
+				HalfFloat::float_to_half(buffer, d + start * 1, count * 1);
 			}
 		}
 	};
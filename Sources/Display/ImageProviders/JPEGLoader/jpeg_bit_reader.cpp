@@ -33,11 +33,16 @@
 namespace clan
 {
 	JPEGBitReader::JPEGBitReader(JPEGFileReader *reader)
-		: reader(reader), length(0), pos(0), bitpos(0)
+		: reader(reader), data(nullptr), length(0), pos(0), bitpos(0)
 	{
 		buffer.resize(16 * 1024);
 	}
 
+	JPEGBitReader::JPEGBitReader(const unsigned char *data, int length)
+		: reader(nullptr), data(data), length(length), pos(0), bitpos(0)
+	{
+	}
+
 	void JPEGBitReader::reset()
 	{
 		length = 0;
@@ -55,6 +60,10 @@ namespace clan
 		}
 		if (pos == length)
 		{
+			if (!reader)
+				throw Exception("Premature end of JPEG entropy data");
+
+			data = &buffer[0];
 			length = reader->read_entropy_data(&buffer[0], buffer.size());
 			if (length == 0)
 			{
@@ -64,7 +73,7 @@ namespace clan
 			pos = 0;
 		}
 
-		unsigned int v = (buffer[pos] >> (7 - bitpos)) & 0x01;
+		unsigned int v = (data[pos] >> (7 - bitpos)) & 0x01;
 		bitpos++;
 		return v;
 	}
@@ -37,6 +37,9 @@ namespace clan
 	public:
 		JPEGBitReader(JPEGFileReader *reader);
 
+		/// \brief Reads from entropy data already in memory, such as one restart interval
+		JPEGBitReader(const unsigned char *data, int length);
+
 		void reset();
 		unsigned int get_bit();
 		unsigned int get_bits(int count);
@@ -44,6 +47,7 @@ namespace clan
 	private:
 		JPEGFileReader *reader;
 		std::vector<unsigned char> buffer;
+		const unsigned char *data;
 		int length;
 		int pos;
 		int bitpos;
@@ -33,13 +33,14 @@
 #include "jpeg_start_of_frame.h"
 #include "jpeg_start_of_scan.h"
 #include "jpeg_markers.h"
+#include "API/Core/IOData/buffered_device.h"
 
 namespace clan
 {
 	JPEGFileReader::JPEGFileReader(IODevice iodevice)
-		: iodevice(iodevice)
+		: iodevice(BufferedDevice(iodevice))
 	{
-		iodevice.set_big_endian_mode();
+		this->iodevice.set_big_endian_mode();
 	}
 
 	JPEGMarker JPEGFileReader::read_marker()
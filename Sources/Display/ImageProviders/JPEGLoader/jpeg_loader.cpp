@@ -32,51 +32,117 @@
 #include "jpeg_huffman_decoder.h"
 #include "jpeg_mcu_decoder.h"
 #include "jpeg_rgb_decoder.h"
+#include "API/Core/System/work_queue.h"
+#include <mutex>
 
 namespace clan
 {
-	PixelBuffer JPEGLoader::load(IODevice iodevice, bool srgb)
+	namespace
 	{
+		WorkQueue &get_decode_queue()
+		{
+			static WorkQueue queue;
+			return queue;
+		}
+
+		// Runs func on sub ranges on the worker threads and rethrows the first exception on the calling thread
+		void parallel_for(int begin, int end, const std::function<void(int first, int last)> &func)
+		{
+			std::mutex mutex;
+			std::exception_ptr error;
+			get_decode_queue().parallel_for(begin, end, 0, [&](int first, int last)
+			{
+				try
+				{
+					func(first, last);
+				}
+				catch (...)
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					if (!error)
+						error = std::current_exception();
+				}
+			});
+			if (error)
+				std::rethrow_exception(error);
+		}
+	}
+
+	PixelBuffer JPEGLoader::load(IODevice iodevice, bool srgb, int scale_denominator)
+	{
+		if (scale_denominator != 1 && scale_denominator != 2 && scale_denominator != 4 && scale_denominator != 8)
+			throw Exception("JPEG scale denominator must be 1, 2, 4 or 8");
+		int dct_size = 8 / scale_denominator;
+
 		JPEGLoader loader(iodevice);
-		JPEGMCUDecoder mcu_decoder(&loader);
-		JPEGRGBDecoder rgb_decoder(&loader);
 
-		int image_width = loader.start_of_frame.width;
-		int image_height = loader.start_of_frame.height;
+		int image_width = (loader.start_of_frame.width + scale_denominator - 1) / scale_denominator;
+		int image_height = (loader.start_of_frame.height + scale_denominator - 1) / scale_denominator;
 		PixelBuffer image(image_width, image_height, srgb ? tf_srgb8_alpha8 : tf_rgba8);
 		unsigned int *image_pixels = reinterpret_cast<unsigned int *>(image.get_data());
 
-		const unsigned int *block_pixels = rgb_decoder.get_pixels();
-		int block_width = rgb_decoder.get_width();
-		int block_height = rgb_decoder.get_height();
-
-		for (int curMcuY = 0, y = 0; curMcuY < loader.mcu_height; curMcuY++, y += block_height)
+		// Each band of MCU rows gets its own decoders, which hold the scratch buffers for one MCU
+		parallel_for(0, loader.mcu_height, [&](int first_mcu_y, int last_mcu_y)
 		{
-			for (int curMcuX = 0, x = 0; curMcuX < loader.mcu_width; curMcuX++, x += block_width)
-			{
-				mcu_decoder.decode(curMcuX + curMcuY * loader.mcu_width);
-				rgb_decoder.decode(&mcu_decoder);
+			JPEGMCUDecoder mcu_decoder(&loader, dct_size);
+			JPEGRGBDecoder rgb_decoder(&loader, dct_size);
+
+			const unsigned int *block_pixels = rgb_decoder.get_pixels();
+			int block_width = rgb_decoder.get_width();
+			int block_height = rgb_decoder.get_height();
 
-				int w = min(block_width, image_width - x);
-				int h = min(block_height, image_height - y);
-				for (int yy = 0; yy < h; yy++)
+			for (int curMcuY = first_mcu_y, y = first_mcu_y * block_height; curMcuY < last_mcu_y; curMcuY++, y += block_height)
+			{
+				for (int curMcuX = 0, x = 0; curMcuX < loader.mcu_width; curMcuX++, x += block_width)
 				{
-					for (int xx = 0; xx < w; xx++)
+					mcu_decoder.decode(curMcuX + curMcuY * loader.mcu_width);
+					rgb_decoder.decode(&mcu_decoder);
+
+					int w = min(block_width, image_width - x);
+					int h = min(block_height, image_height - y);
+					for (int yy = 0; yy < h; yy++)
 					{
-						unsigned int p = block_pixels[xx + yy*block_width];
-						unsigned int red = (p >> 16) & 0xff;
-						unsigned int green = (p >> 8) & 0xff;
-						unsigned int blue = p & 0xff;
-						unsigned int alpha = (p >> 24) & 0xff;
-						image_pixels[x + xx + (y + yy)*image_width] = (alpha << 24) | (blue << 16) | (green << 8) | red;
+						for (int xx = 0; xx < w; xx++)
+						{
+							unsigned int p = block_pixels[xx + yy*block_width];
+							unsigned int red = (p >> 16) & 0xff;
+							unsigned int green = (p >> 8) & 0xff;
+							unsigned int blue = p & 0xff;
+							unsigned int alpha = (p >> 24) & 0xff;
+							image_pixels[x + xx + (y + yy)*image_width] = (alpha << 24) | (blue << 16) | (green << 8) | red;
+						}
 					}
 				}
 			}
-		}
+		});
 
 		return image;
 	}
 
+	Size JPEGLoader::get_size(IODevice iodevice)
+	{
+		JPEGFileReader reader(iodevice);
+
+		JPEGMarker marker = reader.read_marker();
+		if (marker != marker_soi)
+			throw Exception("Not a JPEG file");
+
+		marker = reader.read_marker();
+		while (marker != marker_eoi && marker != marker_sos)
+		{
+			if ((marker >= marker_sof0 && marker <= marker_sof3) || (marker >= marker_sof5 && marker <= marker_sof15))
+			{
+				JPEGStartOfFrame header = reader.read_sof();
+				return Size(header.width, header.height);
+			}
+
+			reader.skip_unknown();
+			marker = reader.read_marker();
+		}
+
+		throw Exception("Invalid JPEG Image");
+	}
+
 	JPEGLoader::JPEGLoader(IODevice iodevice)
 		: progressive(false), scan_count(0), mcu_x(0), mcu_y(0), mcu_width(0), mcu_height(0), restart_interval(0), eobrun(0), is_jfif_jpeg(false), is_adobe_jpeg(false), adobe_app14_transform(1)
 	{
@@ -305,65 +371,108 @@ namespace clan
 		verify_dc_table_selector(start_of_scan);
 		verify_ac_table_selector(start_of_scan);
 
+		if (restart_interval != 0)
+		{
+			process_sos_restart_intervals(start_of_scan, component_to_sof, reader);
+			return;
+		}
+
 		JPEGBitReader bit_reader(&reader);
-		int restart_counter = 0;
 		for (int mcu_block = 0; mcu_block < mcu_width*mcu_height; mcu_block++)
+			decode_sequential_mcu(bit_reader, start_of_scan, component_to_sof, mcu_block, last_dc_values);
+	}
+
+	void JPEGLoader::process_sos_restart_intervals(JPEGStartOfScan &start_of_scan, const std::vector<int> &component_to_sof, JPEGFileReader &reader)
+	{
+		// The DC predictions start over at each restart marker, so the intervals can be decoded in parallel
+		int mcu_count = mcu_width*mcu_height;
+		int interval_count = (mcu_count + restart_interval - 1) / restart_interval;
+
+		std::vector<std::vector<unsigned char> > intervals(interval_count);
+		for (int i = 0; i < interval_count; i++)
 		{
-			if (restart_interval != 0 && restart_counter == restart_interval)
+			if (i > 0)
 			{
 				JPEGMarker marker = reader.read_marker();
 				if (marker < marker_rst0 || marker > marker_rst7)
 				{
 					throw Exception("Restart marker missing between JPEG entropy data");
 				}
-				restart_counter = 0;
-				for (auto & elem : last_dc_values)
+			}
+
+			std::vector<unsigned char> &data = intervals[i];
+			while (true)
+			{
+				size_t pos = data.size();
+				data.resize(pos + 16 * 1024);
+				int length = reader.read_entropy_data(&data[pos], 16 * 1024);
+				data.resize(pos + length);
+				if (length == 0)
+					break;
+			}
+		}
+
+		parallel_for(0, interval_count, [&](int first, int last)
+		{
+			std::vector<short> dc_values(last_dc_values.size());
+			for (int i = first; i < last; i++)
+			{
+				for (auto & elem : dc_values)
 					elem = 0;
-				bit_reader.reset();
-				eobrun = 0;
+
+				JPEGBitReader bit_reader(intervals[i].data(), (int)intervals[i].size());
+				int end_block = min((i + 1) * restart_interval, mcu_count);
+				for (int mcu_block = i * restart_interval; mcu_block < end_block; mcu_block++)
+					decode_sequential_mcu(bit_reader, start_of_scan, component_to_sof, mcu_block, dc_values);
 			}
-			restart_counter++;
+		});
 
-			for (size_t c = 0; c < start_of_scan.components.size(); c++)
+		for (auto & elem : last_dc_values)
+			elem = 0;
+		eobrun = 0;
+	}
+
+	void JPEGLoader::decode_sequential_mcu(JPEGBitReader &bit_reader, const JPEGStartOfScan &start_of_scan, const std::vector<int> &component_to_sof, int mcu_block, std::vector<short> &dc_values)
+	{
+		for (size_t c = 0; c < start_of_scan.components.size(); c++)
+		{
+			int c_sof = component_to_sof[c];
+			const JPEGHuffmanTable &dc_table = huffman_dc_tables[start_of_scan.components[c].dc_table_selector];
+			const JPEGHuffmanTable &ac_table = huffman_ac_tables[start_of_scan.components[c].ac_table_selector];
+			int scale_x = start_of_frame.components[c_sof].horz_sampling_factor;
+			int scale_y = start_of_frame.components[c_sof].vert_sampling_factor;
+			for (int i = 0; i < scale_x * scale_y; i++)
 			{
-				int c_sof = component_to_sof[c];
-				const JPEGHuffmanTable &dc_table = huffman_dc_tables[start_of_scan.components[c].dc_table_selector];
-				const JPEGHuffmanTable &ac_table = huffman_ac_tables[start_of_scan.components[c].ac_table_selector];
-				int scale_x = start_of_frame.components[c_sof].horz_sampling_factor;
-				int scale_y = start_of_frame.components[c_sof].vert_sampling_factor;
-				for (int i = 0; i < scale_x * scale_y; i++)
+				short *dct = component_dcts[c_sof].get(mcu_block*scale_x*scale_y + i);
+				for (int j = start_of_scan.start_dct_coefficient; j <= start_of_scan.end_dct_coefficient; j++)
 				{
-					short *dct = component_dcts[c_sof].get(mcu_block*scale_x*scale_y + i);
-					for (int j = start_of_scan.start_dct_coefficient; j <= start_of_scan.end_dct_coefficient; j++)
+					if (j == 0) // DCT DC coefficient
 					{
-						if (j == 0) // DCT DC coefficient
-						{
-							unsigned int code = JPEGHuffmanDecoder::decode(bit_reader, dc_table);
-							if (code != huffman_eob)
-								dct[0] = JPEGHuffmanDecoder::decode_number(bit_reader, code);
-							dct[0] <<= start_of_scan.point_transform;
+						unsigned int code = JPEGHuffmanDecoder::decode(bit_reader, dc_table);
+						if (code != huffman_eob)
+							dct[0] = JPEGHuffmanDecoder::decode_number(bit_reader, code);
+						dct[0] <<= start_of_scan.point_transform;
 
-							dct[0] += last_dc_values[c_sof];
-							last_dc_values[c_sof] = dct[0];
-						}
-						else // DCT AC coefficient
+						dct[0] += dc_values[c_sof];
+						dc_values[c_sof] = dct[0];
+					}
+					else // DCT AC coefficient
+					{
+						unsigned int code = JPEGHuffmanDecoder::decode(bit_reader, ac_table);
+						if (code != huffman_eob)
 						{
-							unsigned int code = JPEGHuffmanDecoder::decode(bit_reader, ac_table);
-							if (code != huffman_eob)
+							unsigned int zeros = (code >> 4);
+							j += zeros;
+							if (j <= start_of_scan.end_dct_coefficient)
 							{
-								unsigned int zeros = (code >> 4);
-								j += zeros;
-								if (j <= start_of_scan.end_dct_coefficient)
-								{
-									dct[zigzag_map[j]] = JPEGHuffmanDecoder::decode_number(bit_reader, code & 0x0f);
-									dct[zigzag_map[j]] <<= start_of_scan.point_transform;
-								}
-							}
-							else
-							{
-								break;
+								dct[zigzag_map[j]] = JPEGHuffmanDecoder::decode_number(bit_reader, code & 0x0f);
+								dct[zigzag_map[j]] <<= start_of_scan.point_transform;
 							}
 						}
+						else
+						{
+							break;
+						}
 					}
 				}
 			}
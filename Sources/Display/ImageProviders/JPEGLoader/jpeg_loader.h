@@ -45,7 +45,11 @@ namespace clan
 	class JPEGLoader
 	{
 	public:
-		static PixelBuffer load(IODevice iodevice, bool srgb);
+		/// \param scale_denominator Decodes the image at 1/1, 1/2, 1/4 or 1/8 of its size
+		static PixelBuffer load(IODevice iodevice, bool srgb, int scale_denominator = 1);
+
+		/// \brief Reads the image size from the frame header without decoding the image
+		static Size get_size(IODevice iodevice);
 
 	private:
 		enum ColorSpace
@@ -64,6 +68,8 @@ namespace clan
 		void process_dnl(JPEGFileReader &reader);
 		void process_sos(JPEGFileReader &reader);
 		void process_sos_sequential(JPEGStartOfScan &start_of_scan, std::vector<int> component_to_sof, JPEGFileReader &reader);
+		void process_sos_restart_intervals(JPEGStartOfScan &start_of_scan, const std::vector<int> &component_to_sof, JPEGFileReader &reader);
+		void decode_sequential_mcu(JPEGBitReader &bit_reader, const JPEGStartOfScan &start_of_scan, const std::vector<int> &component_to_sof, int mcu_block, std::vector<short> &dc_values);
 		void process_sos_progressive(JPEGStartOfScan &start_of_scan, std::vector<int> component_to_sof, JPEGFileReader &reader);
 		void process_dqt(JPEGFileReader &reader);
 		void process_dht(JPEGFileReader &reader);
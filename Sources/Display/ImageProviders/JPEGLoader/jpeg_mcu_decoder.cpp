@@ -40,9 +40,19 @@
 
 namespace clan
 {
-	JPEGMCUDecoder::JPEGMCUDecoder(JPEGLoader *loader)
-		: loader(loader)
+	JPEGMCUDecoder::JPEGMCUDecoder(JPEGLoader *loader, int dct_size)
+		: loader(loader), dct_size(dct_size)
 	{
+		// One dimensional inverse DCT from the first dct_size coefficients to dct_size samples
+		for (int x = 0; x < dct_size; x++)
+		{
+			for (int u = 0; u < dct_size; u++)
+			{
+				float scale = (u == 0) ? 0.5f / std::sqrt(2.0f) : 0.5f;
+				scaled_basis[x * 8 + u] = scale * std::cos((2 * x + 1) * u * PI / (2 * dct_size));
+			}
+		}
+
 		try
 		{
 			for (size_t c = 0; c < loader->start_of_frame.components.size(); c++)
@@ -99,6 +109,13 @@ namespace clan
 				{
 					short *dct = loader->component_dcts[c].get(block * block_size + dct_x + dct_y * scale_x);
 
+					if (dct_size != 8)
+					{
+						const JPEGQuantizationTable &qtable = loader->quantization_tables[loader->start_of_frame.components[c].quantization_table_selector];
+						idct_scaled(dct, channels[c] + (dct_x + dct_y * scale_x * dct_size) * dct_size, scale_x * dct_size, qtable.values);
+						continue;
+					}
+
 #ifdef CL_DISABLE_SSE2
 					idct(dct, channels[c]+dct_x*8+dct_y*scale_x*64, scale_x*8, quant[c]);
 #else
@@ -254,6 +271,34 @@ namespace clan
 		}
 	}
 
+	void JPEGMCUDecoder::idct_scaled(short *inptr, unsigned char *outptr, int pitch, const uint16_t *qtable)
+	{
+		// Only the lowest frequencies contribute to a downscaled block, so the transform is small enough to do directly
+		float workspace[8 * 8];
+		for (int u = 0; u < dct_size; u++)
+		{
+			for (int y = 0; y < dct_size; y++)
+			{
+				float sum = 0.0f;
+				for (int v = 0; v < dct_size; v++)
+					sum += scaled_basis[y * 8 + v] * (float)(inptr[v * 8 + u] * qtable[v * 8 + u]);
+				workspace[y * 8 + u] = sum;
+			}
+		}
+
+		for (int y = 0; y < dct_size; y++)
+		{
+			for (int x = 0; x < dct_size; x++)
+			{
+				float sum = 0.0f;
+				for (int u = 0; u < dct_size; u++)
+					sum += scaled_basis[x * 8 + u] * workspace[y * 8 + u];
+				outptr[x] = float_to_int(sum);
+			}
+			outptr += pitch;
+		}
+	}
+
 #ifndef CL_DISABLE_SSE2
 
 #ifndef ARM_PLATFORM
@@ -35,7 +35,8 @@ namespace clan
 	class JPEGMCUDecoder
 	{
 	public:
-		JPEGMCUDecoder(JPEGLoader *loader);
+		/// \param dct_size Output size of each 8x8 block. 4, 2 and 1 downscale the image while decoding.
+		JPEGMCUDecoder(JPEGLoader *loader, int dct_size = 8);
 		~JPEGMCUDecoder();
 
 		void decode(int block);
@@ -45,9 +46,12 @@ namespace clan
 	private:
 		void idct(short *inptr, unsigned char *outptr, int pitch, float *quantptr);
 		void idct_sse(short *inptr, unsigned char *outptr, int pitch, float *quantptr);
+		void idct_scaled(short *inptr, unsigned char *outptr, int pitch, const uint16_t *qtable);
 		static inline unsigned char float_to_int(float v);
 
 		JPEGLoader *loader;
+		int dct_size;
+		float scaled_basis[8 * 8];
 		std::vector<unsigned char *> channels;
 		std::vector<float *> quant;
 	};
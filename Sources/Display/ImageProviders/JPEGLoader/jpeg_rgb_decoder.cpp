@@ -41,8 +41,8 @@
 
 namespace clan
 {
-	JPEGRGBDecoder::JPEGRGBDecoder(JPEGLoader *loader)
-		: loader(loader), mcu_x(0), mcu_y(0), pixels(nullptr)
+	JPEGRGBDecoder::JPEGRGBDecoder(JPEGLoader *loader, int dct_size)
+		: loader(loader), mcu_x(0), mcu_y(0), dct_size(dct_size), pixels(nullptr)
 	{
 		mcu_x = loader->mcu_x;
 		mcu_y = loader->mcu_y;
@@ -79,7 +79,7 @@ namespace clan
 			break;
 		case JPEGLoader::colorspace_ycrcb:
 #ifndef CL_DISABLE_SSE2
-			if (System::detect_cpu_extension(System::sse2))
+			if (System::detect_cpu_extension(System::sse2) && get_width() % 4 == 0)
 				convert_ycrcb_sse();
 			else
 				convert_ycrcb_float();
@@ -99,8 +99,8 @@ namespace clan
 
 	void JPEGRGBDecoder::upsample(JPEGMCUDecoder *mcu_decoder)
 	{
-		int height = mcu_y * 8;
-		int width = mcu_x * 8;
+		int height = get_height();
+		int width = get_width();
 
 		for (size_t c = 0; c < channels.size(); c++)
 		{
@@ -120,7 +120,7 @@ namespace clan
 				int sy = step_sy >> 1;
 				for (int y = 0; y < height; y++)
 				{
-					const unsigned char *input_line = input + (sy >> 16)*v * 8;
+					const unsigned char *input_line = input + (sy >> 16)*h * dct_size;
 					int sx = step_sx >> 1;
 					for (int x = 0; x < width; x++)
 					{
@@ -135,8 +135,8 @@ namespace clan
 
 	void JPEGRGBDecoder::convert_monochrome()
 	{
-		int height = mcu_y * 8;
-		int width = mcu_x * 8;
+		int height = get_height();
+		int width = get_width();
 
 		for (int y = 0; y < height; y++)
 		{
@@ -164,8 +164,8 @@ namespace clan
 #ifndef ARM_PLATFORM
 	void JPEGRGBDecoder::convert_ycrcb_sse()
 	{
-		int height = mcu_y * 8;
-		int width = mcu_x * 8;
+		int height = get_height();
+		int width = get_width();
 		for (int y = 0; y < height; y++)
 		{
 			unsigned char *c_line[3] =
@@ -211,8 +211,8 @@ namespace clan
 
 	void JPEGRGBDecoder::convert_ycrcb_float()
 	{
-		int height = mcu_y * 8;
-		int width = mcu_x * 8;
+		int height = get_height();
+		int width = get_width();
 		for (int y = 0; y < height; y++)
 		{
 			for (int x = 0; x < width; x++)
@@ -245,8 +245,8 @@ namespace clan
 
 	void JPEGRGBDecoder::convert_rgb()
 	{
-		int height = mcu_y * 8;
-		int width = mcu_x * 8;
+		int height = get_height();
+		int width = get_width();
 		for (int y = 0; y < height; y++)
 		{
 			for (int x = 0; x < width; x++)
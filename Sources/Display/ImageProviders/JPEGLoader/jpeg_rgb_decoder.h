@@ -36,13 +36,13 @@ namespace clan
 	class JPEGRGBDecoder
 	{
 	public:
-		JPEGRGBDecoder(JPEGLoader *loader);
+		JPEGRGBDecoder(JPEGLoader *loader, int dct_size = 8);
 		~JPEGRGBDecoder();
 
 		void decode(JPEGMCUDecoder *mcu_decoder);
 
-		int get_width() const { return mcu_x * 8; }
-		int get_height() const { return mcu_y * 8; }
+		int get_width() const { return mcu_x * dct_size; }
+		int get_height() const { return mcu_y * dct_size; }
 		const unsigned int *get_pixels() const { return pixels; }
 
 	private:
@@ -54,6 +54,7 @@ namespace clan
 
 		JPEGLoader *loader;
 		int mcu_x, mcu_y;
+		int dct_size;
 		unsigned int *pixels;
 		std::vector<unsigned char *> channels;
 	};
@@ -0,0 +1,748 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "Display/precomp.h"
+#include "jpeg_encoder.h"
+#include "../JPEGLoader/jpeg_markers.h"
+#include "API/Core/System/system.h"
+#include "API/Core/System/work_queue.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#if !defined CL_DISABLE_SSE2 && !defined __ANDROID__
+#include <immintrin.h>
+#define CL_JPEG_ENCODER_SSE
+#if defined(__GNUC__)
+// The AVX2 kernels are compiled for AVX2 only, and selected at runtime
+#define CL_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define CL_TARGET_AVX2
+#endif
+#endif
+
+#if defined CL_DISABLE_SSE2 && (defined __ARM_NEON || defined __ARM_NEON__)
+#include <arm_neon.h>
+#define CL_JPEG_ENCODER_NEON
+#endif
+
+namespace clan
+{
+	namespace
+	{
+		WorkQueue &get_encoder_queue()
+		{
+			static WorkQueue queue;
+			return queue;
+		}
+
+		const unsigned char zigzag[64] = { 0, 1, 8, 16, 9, 2, 3, 10, 17, 24, 32, 25, 18, 11, 4, 5, 12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13, 6, 7, 14, 21, 28, 35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51, 58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63 };
+
+		// Quantization tables from annex K of the specification, in zigzag order
+		const unsigned char std_luma_quant[64] = { 16, 11, 12, 14, 12, 10, 16, 14, 13, 14, 18, 17, 16, 19, 24, 40, 26, 24, 22, 22, 24, 49, 35, 37, 29, 40, 58, 51, 61, 60, 57, 51, 56, 55, 64, 72, 92, 78, 64, 68, 87, 69, 55, 56, 80, 109, 81, 87, 95, 98, 103, 104, 103, 62, 77, 113, 121, 112, 100, 120, 92, 101, 103, 99 };
+		const unsigned char std_chroma_quant[64] = { 17, 18, 18, 24, 21, 24, 47, 26, 26, 47, 99, 66, 56, 66, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99 };
+
+		// Huffman tables from annex K. The bit counts are for code lengths 1 to 16.
+		const unsigned char dc_luma_bits[16] = { 0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0 };
+		const unsigned char dc_luma_values[12] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+		const unsigned char ac_luma_bits[16] = { 0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7d };
+		const unsigned char ac_luma_values[162] =
+		{
+			0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07, 0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xa1, 0x08, 0x23, 0x42, 0xb1, 0xc1, 0x15, 0x52, 0xd1, 0xf0,
+			0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0a, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2a, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+			0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+			0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3, 0xc4, 0xc5,
+			0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe1, 0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+			0xf9, 0xfa
+		};
+		const unsigned char dc_chroma_bits[16] = { 0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0 };
+		const unsigned char dc_chroma_values[12] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+		const unsigned char ac_chroma_bits[16] = { 0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77 };
+		const unsigned char ac_chroma_values[162] =
+		{
+			0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71, 0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xa1, 0xb1, 0xc1, 0x09, 0x23, 0x33, 0x52, 0xf0,
+			0x15, 0x62, 0x72, 0xd1, 0x0a, 0x16, 0x24, 0x34, 0xe1, 0x25, 0xf1, 0x17, 0x18, 0x19, 0x1a, 0x26, 0x27, 0x28, 0x29, 0x2a, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+			0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+			0x88, 0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3,
+			0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+			0xf9, 0xfa
+		};
+
+		// Orthonormal 8 point DCT-II basis, which is exactly the scaling of the JPEG forward DCT
+		struct DCTMatrix
+		{
+			DCTMatrix()
+			{
+				const float pi = 3.14159265358979f;
+				for (int u = 0; u < 8; u++)
+				{
+					float c = (u == 0) ? std::sqrt(1.0f / 8.0f) : std::sqrt(2.0f / 8.0f);
+					for (int x = 0; x < 8; x++)
+					{
+						basis[u][x] = c * std::cos((2 * x + 1) * u * pi / 16.0f);
+						transposed[x][u] = basis[u][x];
+					}
+				}
+			}
+
+			float basis[8][8];
+			float transposed[8][8];
+		};
+
+		const DCTMatrix &get_dct_matrix()
+		{
+			static const DCTMatrix matrix;
+			return matrix;
+		}
+
+		inline int bit_length(unsigned int value)
+		{
+#if defined(__GNUC__)
+			return value ? 32 - __builtin_clz(value) : 0;
+#else
+			int bits = 0;
+			while (value)
+			{
+				bits++;
+				value >>= 1;
+			}
+			return bits;
+#endif
+		}
+	}
+
+	class JPEGEncoderTables
+	{
+	public:
+		JPEGEncoderTables(int quality)
+		{
+			// Same scaling of the annex K tables as libjpeg
+			quality = std::min(std::max(quality, 1), 100);
+			int scale = (quality < 50) ? 5000 / quality : 200 - quality * 2;
+			for (int i = 0; i < 64; i++)
+			{
+				quant[0][i] = (unsigned char)std::min(std::max((std_luma_quant[i] * scale + 50) / 100, 1), 255);
+				quant[1][i] = (unsigned char)std::min(std::max((std_chroma_quant[i] * scale + 50) / 100, 1), 255);
+
+				// The DCT output is in natural order
+				scale_natural[0][zigzag[i]] = 1.0f / quant[0][i];
+				scale_natural[1][zigzag[i]] = 1.0f / quant[1][i];
+			}
+
+			build_huffman_table(0, dc_luma_bits, dc_luma_values, dc_codes[0], dc_sizes[0]);
+			build_huffman_table(1, dc_chroma_bits, dc_chroma_values, dc_codes[1], dc_sizes[1]);
+			build_huffman_table(0, ac_luma_bits, ac_luma_values, ac_codes[0], ac_sizes[0]);
+			build_huffman_table(1, ac_chroma_bits, ac_chroma_values, ac_codes[1], ac_sizes[1]);
+		}
+
+		unsigned char quant[2][64];
+		float scale_natural[2][64];
+		unsigned short dc_codes[2][256], ac_codes[2][256];
+		unsigned char dc_sizes[2][256], ac_sizes[2][256];
+
+	private:
+		static void build_huffman_table(int table, const unsigned char *bits, const unsigned char *values, unsigned short *codes, unsigned char *sizes)
+		{
+			// Canonical codes: each length continues counting from the previous one, shifted left by one bit
+			int code = 0;
+			int index = 0;
+			for (int length = 1; length <= 16; length++)
+			{
+				for (int i = 0; i < bits[length - 1]; i++)
+				{
+					codes[values[index]] = code++;
+					sizes[values[index]] = length;
+					index++;
+				}
+				code <<= 1;
+			}
+		}
+	};
+
+	class JPEGBitWriter
+	{
+	public:
+		JPEGBitWriter(DataBuffer &buffer) : buffer(buffer), data((unsigned char *)buffer.get_data()), pos(0), end(buffer.get_size())
+		{
+		}
+
+		~JPEGBitWriter()
+		{
+			buffer.set_size(pos);
+		}
+
+		/// \brief Makes room for size more bytes
+		void reserve(unsigned int size)
+		{
+			if (end - pos < size)
+			{
+				unsigned int capacity = std::max(pos + size, buffer.get_capacity() * 2);
+				buffer.set_size(pos);
+				buffer.set_capacity(capacity);
+				buffer.set_size(capacity);
+				data = (unsigned char *)buffer.get_data();
+				end = capacity;
+			}
+		}
+
+		void write_byte(unsigned int value)
+		{
+			data[pos++] = (unsigned char)value;
+		}
+
+		void write_word(unsigned int value)
+		{
+			data[pos++] = (unsigned char)(value >> 8);
+			data[pos++] = (unsigned char)value;
+		}
+
+		void write_marker(JPEGMarker marker)
+		{
+			data[pos++] = 0xff;
+			data[pos++] = (unsigned char)marker;
+		}
+
+		void write_bytes(const void *bytes, unsigned int size)
+		{
+			memcpy(data + pos, bytes, size);
+			pos += size;
+		}
+
+		/// \brief Appends up to 32 bits of entropy coded data, stuffing a zero after each 0xff byte
+		void write_bits(unsigned int bits, int length)
+		{
+			bit_buffer = (bit_buffer << length) | bits;
+			bit_count += length;
+			while (bit_count >= 8)
+			{
+				bit_count -= 8;
+				unsigned char value = (unsigned char)(bit_buffer >> bit_count);
+				data[pos++] = value;
+				if (value == 0xff)
+					data[pos++] = 0;
+			}
+		}
+
+		/// \brief Pads the entropy coded data to a whole byte with one bits
+		void flush_bits()
+		{
+			if (bit_count > 0)
+				write_bits((1 << (8 - bit_count)) - 1, 8 - bit_count);
+			bit_buffer = 0;
+		}
+
+	private:
+		DataBuffer &buffer;
+		unsigned char *data;
+		unsigned int pos;
+		unsigned int end;
+		uint64_t bit_buffer = 0;
+		int bit_count = 0;
+	};
+
+	void JPEGEncoder::encode(const PixelBuffer &source, int quality, DataBuffer &output)
+	{
+		if (source.is_null() || source.get_width() <= 0 || source.get_height() <= 0)
+			throw Exception("Cannot encode an empty image as JPEG");
+		if (source.get_width() > 65535 || source.get_height() > 65535)
+			throw Exception("Image is too large for JPEG");
+
+		PixelBuffer image = (source.get_format() == tf_rgba8) ? source : source.to_format(tf_rgba8);
+
+		JPEGEncoderTables tables(quality);
+		int width = image.get_width();
+		int height = image.get_height();
+		int mcus_per_row = (width + 15) / 16;
+		int mcu_rows = (height + 15) / 16;
+
+		// Each sub range of rows is entropy coded into its own buffer, indexed by its first row
+		std::vector<DataBuffer> row_output(mcu_rows);
+		get_encoder_queue().parallel_for(0, mcu_rows, 0, [&](int first_row, int last_row)
+		{
+			std::vector<float> planes(mcus_per_row * 16 * 16 * 3 + mcus_per_row * 8 * 8 * 2);
+			DataBuffer buffer(mcus_per_row * (last_row - first_row) * 256);
+			JPEGBitWriter writer(buffer);
+			for (int row = first_row; row < last_row; row++)
+			{
+				encode_mcu_row(writer, tables, image, row, planes.data());
+				writer.flush_bits();
+				if (row + 1 < mcu_rows)
+				{
+					writer.reserve(2);
+					writer.write_marker((JPEGMarker)(marker_rst0 + (row & 7)));
+				}
+			}
+			row_output[first_row] = buffer;
+		});
+
+		output.set_size(0);
+		JPEGBitWriter writer(output);
+		writer.reserve(1024);
+		write_headers(writer, tables, width, height, mcus_per_row);
+		for (const DataBuffer &rows : row_output)
+		{
+			if (!rows.is_null())
+			{
+				writer.reserve(rows.get_size());
+				writer.write_bytes(rows.get_data(), rows.get_size());
+			}
+		}
+		writer.reserve(2);
+		writer.write_marker(marker_eoi);
+	}
+
+	void JPEGEncoder::write_headers(JPEGBitWriter &writer, const JPEGEncoderTables &tables, int width, int height, int mcus_per_row)
+	{
+		writer.write_marker(marker_soi);
+
+		writer.write_marker(marker_app0);
+		writer.write_word(16);
+		writer.write_bytes("JFIF", 5);
+		writer.write_word(0x0101); // Version 1.1
+		writer.write_byte(0); // No density unit, 1:1 aspect ratio
+		writer.write_word(1);
+		writer.write_word(1);
+		writer.write_byte(0); // No thumbnail
+		writer.write_byte(0);
+
+		writer.write_marker(marker_dqt);
+		writer.write_word(2 + 2 * 65);
+		for (int table = 0; table < 2; table++)
+		{
+			writer.write_byte(table);
+			writer.write_bytes(tables.quant[table], 64);
+		}
+
+		// Y is sampled 2x2 and Cb Cr 1x1
+		writer.write_marker(marker_sof0);
+		writer.write_word(8 + 3 * 3);
+		writer.write_byte(8);
+		writer.write_word(height);
+		writer.write_word(width);
+		writer.write_byte(3);
+		writer.write_byte(1); writer.write_byte(0x22); writer.write_byte(0);
+		writer.write_byte(2); writer.write_byte(0x11); writer.write_byte(1);
+		writer.write_byte(3); writer.write_byte(0x11); writer.write_byte(1);
+
+		struct { int id; const unsigned char *bits; const unsigned char *values; int count; } huffman_tables[4] =
+		{
+			{ 0x00, dc_luma_bits, dc_luma_values, sizeof(dc_luma_values) },
+			{ 0x10, ac_luma_bits, ac_luma_values, sizeof(ac_luma_values) },
+			{ 0x01, dc_chroma_bits, dc_chroma_values, sizeof(dc_chroma_values) },
+			{ 0x11, ac_chroma_bits, ac_chroma_values, sizeof(ac_chroma_values) }
+		};
+		for (auto &table : huffman_tables)
+		{
+			writer.write_marker(marker_dht);
+			writer.write_word(2 + 1 + 16 + table.count);
+			writer.write_byte(table.id);
+			writer.write_bytes(table.bits, 16);
+			writer.write_bytes(table.values, table.count);
+		}
+
+		writer.write_marker(marker_dri);
+		writer.write_word(4);
+		writer.write_word(mcus_per_row);
+
+		writer.write_marker(marker_sos);
+		writer.write_word(6 + 2 * 3);
+		writer.write_byte(3);
+		writer.write_byte(1); writer.write_byte(0x00);
+		writer.write_byte(2); writer.write_byte(0x11);
+		writer.write_byte(3); writer.write_byte(0x11);
+		writer.write_byte(0); // Spectral selection 0-63, no successive approximation
+		writer.write_byte(63);
+		writer.write_byte(0);
+	}
+
+	void JPEGEncoder::encode_mcu_row(JPEGBitWriter &writer, const JPEGEncoderTables &tables, const PixelBuffer &image, int mcu_row, float *planes)
+	{
+		int width = image.get_width();
+		int height = image.get_height();
+		int mcus_per_row = (width + 15) / 16;
+		int pitch = mcus_per_row * 16;
+		int chroma_pitch = mcus_per_row * 8;
+
+		float *y_plane = planes;
+		float *cb_full = y_plane + pitch * 16;
+		float *cr_full = cb_full + pitch * 16;
+		float *cb_plane = cr_full + pitch * 16;
+		float *cr_plane = cb_plane + chroma_pitch * 8;
+
+		// Edges are padded by repeating the last row and column
+		for (int y = 0; y < 16; y++)
+		{
+			int source_y = std::min(mcu_row * 16 + y, height - 1);
+			float *y_line = y_plane + y * pitch;
+			float *cb_line = cb_full + y * pitch;
+			float *cr_line = cr_full + y * pitch;
+			convert_row((const unsigned char *)image.get_line(source_y), width, y_line, cb_line, cr_line);
+			for (int x = width; x < pitch; x++)
+			{
+				y_line[x] = y_line[width - 1];
+				cb_line[x] = cb_line[width - 1];
+				cr_line[x] = cr_line[width - 1];
+			}
+		}
+
+		for (int y = 0; y < 8; y++)
+		{
+			const float *cb0 = cb_full + y * 2 * pitch, *cb1 = cb0 + pitch;
+			const float *cr0 = cr_full + y * 2 * pitch, *cr1 = cr0 + pitch;
+			float *cb_line = cb_plane + y * chroma_pitch;
+			float *cr_line = cr_plane + y * chroma_pitch;
+			for (int x = 0; x < chroma_pitch; x++)
+			{
+				cb_line[x] = (cb0[x * 2] + cb0[x * 2 + 1] + cb1[x * 2] + cb1[x * 2 + 1]) * 0.25f;
+				cr_line[x] = (cr0[x * 2] + cr0[x * 2 + 1] + cr1[x * 2] + cr1[x * 2 + 1]) * 0.25f;
+			}
+		}
+
+		// Worst case size of an MCU, with every byte stuffed
+		const unsigned int max_mcu_size = 6 * 2 * 210;
+
+		// Restart markers reset the DC predictors
+		int last_dc[3] = { 0, 0, 0 };
+		short coefficients[64];
+		for (int mcu = 0; mcu < mcus_per_row; mcu++)
+		{
+			writer.reserve(max_mcu_size);
+
+			const float *y_block = y_plane + mcu * 16;
+			fdct_quantize(y_block, pitch, tables.scale_natural[0], coefficients);
+			encode_block(writer, tables, coefficients, last_dc[0], 0);
+			fdct_quantize(y_block + 8, pitch, tables.scale_natural[0], coefficients);
+			encode_block(writer, tables, coefficients, last_dc[0], 0);
+			fdct_quantize(y_block + 8 * pitch, pitch, tables.scale_natural[0], coefficients);
+			encode_block(writer, tables, coefficients, last_dc[0], 0);
+			fdct_quantize(y_block + 8 * pitch + 8, pitch, tables.scale_natural[0], coefficients);
+			encode_block(writer, tables, coefficients, last_dc[0], 0);
+
+			fdct_quantize(cb_plane + mcu * 8, chroma_pitch, tables.scale_natural[1], coefficients);
+			encode_block(writer, tables, coefficients, last_dc[1], 1);
+			fdct_quantize(cr_plane + mcu * 8, chroma_pitch, tables.scale_natural[1], coefficients);
+			encode_block(writer, tables, coefficients, last_dc[2], 1);
+		}
+	}
+
+	void JPEGEncoder::encode_block(JPEGBitWriter &writer, const JPEGEncoderTables &tables, const short *coefficients, int &last_dc, int table)
+	{
+		int diff = coefficients[0] - last_dc;
+		last_dc = coefficients[0];
+
+		// Values are coded as their bit length category followed by the low bits, with negative values offset by one
+		int size = bit_length(std::abs(diff));
+		writer.write_bits(tables.dc_codes[table][size], tables.dc_sizes[table][size]);
+		if (size)
+			writer.write_bits((diff < 0 ? diff - 1 : diff) & ((1 << size) - 1), size);
+
+		int run = 0;
+		for (int k = 1; k < 64; k++)
+		{
+			int value = coefficients[k];
+			if (value == 0)
+			{
+				run++;
+				continue;
+			}
+
+			while (run >= 16)
+			{
+				writer.write_bits(tables.ac_codes[table][0xf0], tables.ac_sizes[table][0xf0]);
+				run -= 16;
+			}
+
+			size = bit_length(std::abs(value));
+			int symbol = (run << 4) | size;
+			writer.write_bits(tables.ac_codes[table][symbol], tables.ac_sizes[table][symbol]);
+			writer.write_bits((value < 0 ? value - 1 : value) & ((1 << size) - 1), size);
+			run = 0;
+		}
+
+		if (run > 0)
+			writer.write_bits(tables.ac_codes[table][0x00], tables.ac_sizes[table][0x00]);
+	}
+
+	namespace
+	{
+		// ITU-R BT.601 full range conversion, as used by JFIF
+		const float y_r = 0.299f, y_g = 0.587f, y_b = 0.114f;
+		const float cb_r = -0.168736f, cb_g = -0.331264f, cb_b = 0.5f;
+		const float cr_r = 0.5f, cr_g = -0.418688f, cr_b = -0.081312f;
+
+		int convert_row_scalar(const unsigned char *input, int start, int width, float *y, float *cb, float *cr)
+		{
+			for (int x = start; x < width; x++)
+			{
+				float r = input[x * 4], g = input[x * 4 + 1], b = input[x * 4 + 2];
+				y[x] = y_r * r + y_g * g + y_b * b - 128.0f;
+				cb[x] = cb_r * r + cb_g * g + cb_b * b;
+				cr[x] = cr_r * r + cr_g * g + cr_b * b;
+			}
+			return width;
+		}
+
+#if !defined CL_JPEG_ENCODER_SSE && !defined CL_JPEG_ENCODER_NEON
+		// The DCT is separable: rows are transformed first, then columns, followed by quantization
+		void fdct_quantize_scalar(const float *input, int pitch, const float *scale, short *output)
+		{
+			const DCTMatrix &dct = get_dct_matrix();
+			float rows[8][8];
+			for (int i = 0; i < 8; i++)
+			{
+				for (int u = 0; u < 8; u++)
+				{
+					float sum = 0.0f;
+					for (int x = 0; x < 8; x++)
+						sum += input[i * pitch + x] * dct.basis[u][x];
+					rows[i][u] = sum;
+				}
+			}
+
+			for (int v = 0; v < 8; v++)
+			{
+				for (int u = 0; u < 8; u++)
+				{
+					float sum = 0.0f;
+					for (int i = 0; i < 8; i++)
+						sum += dct.basis[v][i] * rows[i][u];
+					float value = sum * scale[v * 8 + u];
+					int quantized = (int)(value < 0.0f ? value - 0.5f : value + 0.5f);
+					output[v * 8 + u] = (short)std::min(std::max(quantized, -1023), 1023);
+				}
+			}
+		}
+#endif
+
+		void store_zigzag(const short *natural, short *output)
+		{
+			for (int i = 0; i < 64; i++)
+				output[i] = natural[zigzag[i]];
+		}
+
+#ifdef CL_JPEG_ENCODER_SSE
+		int convert_row_sse2(const unsigned char *input, int width, float *y, float *cb, float *cr)
+		{
+			const __m128i mask = _mm_set1_epi32(0xff);
+			int x = 0;
+			for (; x + 4 <= width; x += 4)
+			{
+				__m128i pixels = _mm_loadu_si128((const __m128i*)(input + x * 4));
+				__m128 r = _mm_cvtepi32_ps(_mm_and_si128(pixels, mask));
+				__m128 g = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(pixels, 8), mask));
+				__m128 b = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(pixels, 16), mask));
+				__m128 luma = _mm_add_ps(_mm_add_ps(_mm_mul_ps(r, _mm_set1_ps(y_r)), _mm_mul_ps(g, _mm_set1_ps(y_g))), _mm_mul_ps(b, _mm_set1_ps(y_b)));
+				_mm_storeu_ps(y + x, _mm_sub_ps(luma, _mm_set1_ps(128.0f)));
+				_mm_storeu_ps(cb + x, _mm_add_ps(_mm_add_ps(_mm_mul_ps(r, _mm_set1_ps(cb_r)), _mm_mul_ps(g, _mm_set1_ps(cb_g))), _mm_mul_ps(b, _mm_set1_ps(cb_b))));
+				_mm_storeu_ps(cr + x, _mm_add_ps(_mm_add_ps(_mm_mul_ps(r, _mm_set1_ps(cr_r)), _mm_mul_ps(g, _mm_set1_ps(cr_g))), _mm_mul_ps(b, _mm_set1_ps(cr_b))));
+			}
+			return x;
+		}
+
+		void fdct_quantize_sse2(const float *input, int pitch, const float *scale, short *output)
+		{
+			const DCTMatrix &dct = get_dct_matrix();
+
+			// Each row is kept as two vectors of four coefficients
+			__m128 rows[8][2];
+			for (int i = 0; i < 8; i++)
+			{
+				__m128 low = _mm_setzero_ps(), high = _mm_setzero_ps();
+				for (int x = 0; x < 8; x++)
+				{
+					__m128 value = _mm_set1_ps(input[i * pitch + x]);
+					low = _mm_add_ps(low, _mm_mul_ps(value, _mm_loadu_ps(dct.transposed[x])));
+					high = _mm_add_ps(high, _mm_mul_ps(value, _mm_loadu_ps(dct.transposed[x] + 4)));
+				}
+				rows[i][0] = low;
+				rows[i][1] = high;
+			}
+
+			const __m128i limit = _mm_set1_epi16(1023);
+			short natural[64];
+			for (int v = 0; v < 8; v++)
+			{
+				__m128 low = _mm_setzero_ps(), high = _mm_setzero_ps();
+				for (int i = 0; i < 8; i++)
+				{
+					__m128 weight = _mm_set1_ps(dct.basis[v][i]);
+					low = _mm_add_ps(low, _mm_mul_ps(weight, rows[i][0]));
+					high = _mm_add_ps(high, _mm_mul_ps(weight, rows[i][1]));
+				}
+				__m128i low_int = _mm_cvtps_epi32(_mm_mul_ps(low, _mm_loadu_ps(scale + v * 8)));
+				__m128i high_int = _mm_cvtps_epi32(_mm_mul_ps(high, _mm_loadu_ps(scale + v * 8 + 4)));
+				__m128i packed = _mm_packs_epi32(low_int, high_int);
+				packed = _mm_max_epi16(_mm_min_epi16(packed, limit), _mm_sub_epi16(_mm_setzero_si128(), limit));
+				_mm_storeu_si128((__m128i*)(natural + v * 8), packed);
+			}
+			store_zigzag(natural, output);
+		}
+
+		CL_TARGET_AVX2 int convert_row_avx2(const unsigned char *input, int width, float *y, float *cb, float *cr)
+		{
+			const __m256i mask = _mm256_set1_epi32(0xff);
+			int x = 0;
+			for (; x + 8 <= width; x += 8)
+			{
+				__m256i pixels = _mm256_loadu_si256((const __m256i*)(input + x * 4));
+				__m256 r = _mm256_cvtepi32_ps(_mm256_and_si256(pixels, mask));
+				__m256 g = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(pixels, 8), mask));
+				__m256 b = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(pixels, 16), mask));
+				__m256 luma = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r, _mm256_set1_ps(y_r)), _mm256_mul_ps(g, _mm256_set1_ps(y_g))), _mm256_mul_ps(b, _mm256_set1_ps(y_b)));
+				_mm256_storeu_ps(y + x, _mm256_sub_ps(luma, _mm256_set1_ps(128.0f)));
+				_mm256_storeu_ps(cb + x, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r, _mm256_set1_ps(cb_r)), _mm256_mul_ps(g, _mm256_set1_ps(cb_g))), _mm256_mul_ps(b, _mm256_set1_ps(cb_b))));
+				_mm256_storeu_ps(cr + x, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r, _mm256_set1_ps(cr_r)), _mm256_mul_ps(g, _mm256_set1_ps(cr_g))), _mm256_mul_ps(b, _mm256_set1_ps(cr_b))));
+			}
+			return x;
+		}
+
+		CL_TARGET_AVX2 void fdct_quantize_avx2(const float *input, int pitch, const float *scale, short *output)
+		{
+			const DCTMatrix &dct = get_dct_matrix();
+
+			__m256 rows[8];
+			for (int i = 0; i < 8; i++)
+			{
+				__m256 sum = _mm256_setzero_ps();
+				for (int x = 0; x < 8; x++)
+					sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set1_ps(input[i * pitch + x]), _mm256_loadu_ps(dct.transposed[x])));
+				rows[i] = sum;
+			}
+
+			const __m256i limit = _mm256_set1_epi32(1023);
+			const __m256i negative_limit = _mm256_set1_epi32(-1023);
+			short natural[64];
+			for (int v = 0; v < 8; v++)
+			{
+				__m256 sum = _mm256_setzero_ps();
+				for (int i = 0; i < 8; i++)
+					sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set1_ps(dct.basis[v][i]), rows[i]));
+				__m256i quantized = _mm256_cvtps_epi32(_mm256_mul_ps(sum, _mm256_loadu_ps(scale + v * 8)));
+				quantized = _mm256_max_epi32(_mm256_min_epi32(quantized, limit), negative_limit);
+				__m128i packed = _mm_packs_epi32(_mm256_castsi256_si128(quantized), _mm256_extracti128_si256(quantized, 1));
+				_mm_storeu_si128((__m128i*)(natural + v * 8), packed);
+			}
+			store_zigzag(natural, output);
+		}
+#endif
+
+#ifdef CL_JPEG_ENCODER_NEON
+		int convert_row_neon(const unsigned char *input, int width, float *y, float *cb, float *cr)
+		{
+			int x = 0;
+			for (; x + 8 <= width; x += 8)
+			{
+				uint8x8x4_t pixels = vld4_u8(input + x * 4);
+				uint16x8_t r16 = vmovl_u8(pixels.val[0]), g16 = vmovl_u8(pixels.val[1]), b16 = vmovl_u8(pixels.val[2]);
+				for (int half = 0; half < 2; half++)
+				{
+					float32x4_t r = vcvtq_f32_u32(vmovl_u16(half ? vget_high_u16(r16) : vget_low_u16(r16)));
+					float32x4_t g = vcvtq_f32_u32(vmovl_u16(half ? vget_high_u16(g16) : vget_low_u16(g16)));
+					float32x4_t b = vcvtq_f32_u32(vmovl_u16(half ? vget_high_u16(b16) : vget_low_u16(b16)));
+					float32x4_t luma = vmlaq_n_f32(vmlaq_n_f32(vmulq_n_f32(r, y_r), g, y_g), b, y_b);
+					vst1q_f32(y + x + half * 4, vsubq_f32(luma, vdupq_n_f32(128.0f)));
+					vst1q_f32(cb + x + half * 4, vmlaq_n_f32(vmlaq_n_f32(vmulq_n_f32(r, cb_r), g, cb_g), b, cb_b));
+					vst1q_f32(cr + x + half * 4, vmlaq_n_f32(vmlaq_n_f32(vmulq_n_f32(r, cr_r), g, cr_g), b, cr_b));
+				}
+			}
+			return x;
+		}
+
+		void fdct_quantize_neon(const float *input, int pitch, const float *scale, short *output)
+		{
+			const DCTMatrix &dct = get_dct_matrix();
+
+			float32x4_t rows[8][2];
+			for (int i = 0; i < 8; i++)
+			{
+				float32x4_t low = vdupq_n_f32(0.0f), high = vdupq_n_f32(0.0f);
+				for (int x = 0; x < 8; x++)
+				{
+					float value = input[i * pitch + x];
+					low = vmlaq_n_f32(low, vld1q_f32(dct.transposed[x]), value);
+					high = vmlaq_n_f32(high, vld1q_f32(dct.transposed[x] + 4), value);
+				}
+				rows[i][0] = low;
+				rows[i][1] = high;
+			}
+
+			short natural[64];
+			for (int v = 0; v < 8; v++)
+			{
+				float32x4_t low = vdupq_n_f32(0.0f), high = vdupq_n_f32(0.0f);
+				for (int i = 0; i < 8; i++)
+				{
+					low = vmlaq_n_f32(low, rows[i][0], dct.basis[v][i]);
+					high = vmlaq_n_f32(high, rows[i][1], dct.basis[v][i]);
+				}
+				low = vmulq_f32(low, vld1q_f32(scale + v * 8));
+				high = vmulq_f32(high, vld1q_f32(scale + v * 8 + 4));
+
+				// vcvtq truncates, so round half away from zero first
+				const float32x4_t half = vdupq_n_f32(0.5f);
+				low = vaddq_f32(low, vbslq_f32(vcltq_f32(low, vdupq_n_f32(0.0f)), vnegq_f32(half), half));
+				high = vaddq_f32(high, vbslq_f32(vcltq_f32(high, vdupq_n_f32(0.0f)), vnegq_f32(half), half));
+				int16x8_t packed = vcombine_s16(vqmovn_s32(vcvtq_s32_f32(low)), vqmovn_s32(vcvtq_s32_f32(high)));
+				packed = vmaxq_s16(vminq_s16(packed, vdupq_n_s16(1023)), vdupq_n_s16(-1023));
+				vst1q_s16(natural + v * 8, packed);
+			}
+			store_zigzag(natural, output);
+		}
+#endif
+	}
+
+	void JPEGEncoder::convert_row(const unsigned char *input, int width, float *y, float *cb, float *cr)
+	{
+		int x = 0;
+#if defined CL_JPEG_ENCODER_SSE
+		static const bool use_avx2 = System::detect_cpu_extension(System::avx2);
+		x = use_avx2 ? convert_row_avx2(input, width, y, cb, cr) : convert_row_sse2(input, width, y, cb, cr);
+#elif defined CL_JPEG_ENCODER_NEON
+		x = convert_row_neon(input, width, y, cb, cr);
+#endif
+		convert_row_scalar(input, x, width, y, cb, cr);
+	}
+
+	void JPEGEncoder::fdct_quantize(const float *input, int pitch, const float *scale, short *output)
+	{
+#if defined CL_JPEG_ENCODER_SSE
+		static const bool use_avx2 = System::detect_cpu_extension(System::avx2);
+		if (use_avx2)
+			fdct_quantize_avx2(input, pitch, scale, output);
+		else
+			fdct_quantize_sse2(input, pitch, scale, output);
+#elif defined CL_JPEG_ENCODER_NEON
+		fdct_quantize_neon(input, pitch, scale, output);
+#else
+		short natural[64];
+		fdct_quantize_scalar(input, pitch, scale, natural);
+		store_zigzag(natural, output);
+#endif
+	}
+}
@@ -0,0 +1,56 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include "API/Display/Image/pixel_buffer.h"
+#include "API/Core/System/databuffer.h"
+
+namespace clan
+{
+	class JPEGBitWriter;
+	class JPEGEncoderTables;
+
+	class JPEGEncoder
+	{
+	public:
+		/// \brief Encodes an image as a baseline JPEG with 4:2:0 chroma subsampling
+		///
+		/// Each row of MCUs is a restart interval, so the rows are encoded in parallel and then joined.
+		/// The output buffer is replaced by the file. Its capacity is kept, so reusing the same buffer does not reallocate.
+		static void encode(const PixelBuffer &image, int quality, DataBuffer &output);
+
+	private:
+		static void write_headers(JPEGBitWriter &writer, const JPEGEncoderTables &tables, int width, int height, int mcus_per_row);
+		static void encode_mcu_row(JPEGBitWriter &writer, const JPEGEncoderTables &tables, const PixelBuffer &image, int mcu_row, float *planes);
+		static void convert_row(const unsigned char *input, int width, float *y, float *cb, float *cr);
+		static void fdct_quantize(const float *input, int pitch, const float *scale, short *output);
+		static void encode_block(JPEGBitWriter &writer, const JPEGEncoderTables &tables, const short *coefficients, int &last_dc, int table);
+	};
+}
@@ -30,6 +30,7 @@
 #include "png_loader.h"
 #include "API/Display/Image/pixel_buffer_lock.h"
 #include "API/Core/Zip/zlib_compression.h"
+#include "API/Core/IOData/buffered_device.h"
 #include "API/Core/System/system.h"
 #include "Display/ImageProviders/PNGWriter/png_writer.h"
 
@@ -42,14 +43,10 @@ namespace clan
 	}
 
 	PNGLoader::PNGLoader(IODevice iodevice, bool force_srgb)
-		: file(iodevice), force_srgb(force_srgb), scanline(nullptr), prev_scanline(nullptr), scanline_4ub(nullptr), scanline_4us(nullptr), palette(nullptr)
+		: file(BufferedDevice(iodevice)), force_srgb(force_srgb), scanline(nullptr), prev_scanline(nullptr), scanline_4ub(nullptr), scanline_4us(nullptr), palette(nullptr), pass(0), row_y(0), row_pixel_length(0)
 	{
 		read_magic();
 		read_chunks();
-		decode_header();
-		decode_palette();
-		decode_colorkey();
-		decode_image();
 	}
 
 	PNGLoader::~PNGLoader()
@@ -75,9 +72,7 @@ namespace clan
 		file.set_big_endian_mode();
 
 		std::map<std::string, DataBuffer> chunks;
-
-		std::vector<DataBuffer> idat_chunks;
-		uint64_t total_idat_size = 0;
+		bool image_started = false;
 
 		while (true)
 		{
@@ -95,10 +90,22 @@ namespace clan
 			if (crc32 != compare_crc32)
 				throw Exception("CRC32 error");
 
-			if (name == std::string("IDAT")) // Concatenate all IDAT chunks to one big
+			if (name == std::string("IDAT"))
 			{
-				total_idat_size += length;
-				idat_chunks.push_back(data);
+				// The header, palette and transparency chunks all come before the image data
+				if (!image_started)
+				{
+					ihdr = chunks["IHDR"];
+					plte = chunks["PLTE"];
+					trns = chunks["tRNS"];
+					if (ihdr.is_null() || ihdr.get_size() != 13)
+						throw Exception("Invalid PNG image file");
+
+					begin_image();
+					image_started = true;
+				}
+
+				decode_idat(data);
 			}
 			else
 			{
@@ -108,28 +115,13 @@ namespace clan
 			}
 		}
 
-		if (total_idat_size >= (1 << 31))
-			throw Exception("PNG image file too big!");
-
-		idat = DataBuffer((int)total_idat_size);
-		int idat_pos = 0;
-		for (auto & idat_chunk : idat_chunks)
-		{
-			memcpy(idat.get_data() + idat_pos, idat_chunk.get_data(), idat_chunk.get_size());
-			idat_pos += idat_chunk.get_size();
-		}
-
-		ihdr = chunks["IHDR"];
-		plte = chunks["PLTE"];
-
-		trns = chunks["tRNS"];
 		chrm = chunks["cHRM"];
 		gama = chunks["gAMA"];
 		iccp = chunks["iCCP"];
 		sbit = chunks["sBIT"];
 		srgb = chunks["sRGB"];
 
-		if (ihdr.is_null() || idat_chunks.empty() || ihdr.get_size() != 13) // Always required chunks
+		if (!image_started || pass != get_pass_count()) // Always required chunks, and all rows decoded
 			throw Exception("Invalid PNG image file");
 	}
 
@@ -217,207 +209,232 @@ namespace clan
 		}
 	}
 
-	void PNGLoader::decode_image()
+	void PNGLoader::begin_image()
 	{
-		DataBuffer image_data = ZLibCompression::decompress(idat, false);
+		decode_header();
+		decode_palette();
+		decode_colorkey();
 
 		create_image();
 		create_scanline_buffers();
 
-		if (interlace_method == 0)
-		{
-			decode_interlace_none(reinterpret_cast<const unsigned char*>(image_data.get_data()), image_data.get_size());
-		}
-		else if (interlace_method == 1)
-		{
-			decode_interlace_adam7(reinterpret_cast<const unsigned char*>(image_data.get_data()), image_data.get_size());
-		}
-		else
-		{
-			throw Exception("Invalid PNG image file");
-		}
+		inflater.reset(new ZLibDecompressor(false));
+		begin_pass(0);
 	}
 
-	void PNGLoader::create_image()
+	void PNGLoader::decode_idat(const DataBuffer &idat)
 	{
-		if (bit_depth <= 8)
-			image = PixelBuffer(image_width, image_height, force_srgb ? tf_srgb8_alpha8 : tf_rgba8);
-		else
-			image = PixelBuffer(image_width, image_height, tf_rgba16);
+		if (pass == get_pass_count())
+			return; // Trailing data after the last row
+
+		inflater->decompress(idat.get_data(), idat.get_size(), inflated);
+
+		// Rows are decoded as soon as they have been inflated. Only an incomplete last row is kept for the next chunk.
+		const unsigned char *data = reinterpret_cast<const unsigned char*>(inflated.get_data());
+		int data_length = inflated.get_size();
+		int data_pos = decode_rows(data, data_length);
+
+		memmove(inflated.get_data(), data + data_pos, data_length - data_pos);
+		inflated.set_size(data_length - data_pos);
 	}
 
-	void PNGLoader::create_scanline_buffers()
+	namespace
 	{
-		int size = (image_width * bit_depth * get_image_data_channels() + 7) / 8;
-		scanline = static_cast<unsigned char *>(System::aligned_alloc(size));
-		prev_scanline = static_cast<unsigned char *>(System::aligned_alloc(size));
-		scanline_4ub = static_cast<Vec4ub *>(System::aligned_alloc(image_width * sizeof(Vec4ub)));
-		scanline_4us = static_cast<Vec4us *>(System::aligned_alloc(image_width * sizeof(Vec4us)));
+		const int adam7_starting_row[7] = { 0, 0, 4, 0, 2, 0, 1 };
+		const int adam7_starting_col[7] = { 0, 4, 0, 2, 0, 1, 0 };
+		const int adam7_row_increment[7] = { 8, 8, 8, 4, 4, 2, 2 };
+		const int adam7_col_increment[7] = { 8, 8, 4, 4, 2, 2, 1 };
 	}
 
-	int PNGLoader::get_image_data_channels()
+	int PNGLoader::get_pass_count() const
 	{
-		switch (color_type)
-		{
-		case 0: return 1; // grayscale
-		case 2: return 3; // truecolor
-		case 3: return 1; // indexed
-		case 4: return 2; // grayscale with alpha
-		case 6: return 4; // truecolor with alpha
-		default: throw Exception("Invalid PNG image file");
-		}
+		return interlace_method == 1 ? 7 : 1;
 	}
 
-	void PNGLoader::decode_interlace_none(const unsigned char *data, int data_length)
+	void PNGLoader::begin_pass(int first_pass)
 	{
 		int scanline_size = (image_width * bit_depth * get_image_data_channels() + 7) / 8;
-		if ((1 + scanline_size) * image_height > data_length)
-			throw Exception("Invalid PNG image file");
-
-		for (size_t i = 0; i < scanline_size; i++)
-			scanline[i] = 0;
 
-		int data_pos = 0;
-		PixelBufferLockAny pixels(image);
-		for (int y = 0; y < image_height; y++)
+		// Skip the passes that have no pixels in small interlaced images
+		for (pass = first_pass; pass < get_pass_count(); pass++)
 		{
-			unsigned char *tmp = scanline;
-			scanline = prev_scanline;
-			prev_scanline = tmp;
-
-			int predictor_type = data[data_pos++];
-			memcpy(scanline, data + data_pos, scanline_size);
-			data_pos += scanline_size;
-
-			filter_scanline(predictor_type, scanline_size);
-
-			if (bit_depth <= 8)
-				convert_scanline_4ub(image_width);
+			if (interlace_method == 0)
+			{
+				row_y = 0;
+				row_pixel_length = image_width;
+			}
 			else
-				convert_scanline_4us(image_width);
+			{
+				row_y = adam7_starting_row[pass];
+				row_pixel_length = ((int)image_width - adam7_starting_col[pass] + adam7_col_increment[pass] - 1) / adam7_col_increment[pass];
+			}
 
-			unsigned char *output_line = pixels.get_row(y);
-			if (bit_depth <= 8)
-				memcpy(output_line, scanline_4ub, image_width * 4);
-			else
-				memcpy(output_line, scanline_4us, image_width * 8);
+			if (row_y < (int)image_height && row_pixel_length > 0)
+				break;
 		}
+
+		// The first row of a pass is filtered against a row of zeros
+		memset(prev_scanline, 0, scanline_size);
 	}
 
-	void PNGLoader::decode_interlace_adam7(const unsigned char *data, int data_length)
+	int PNGLoader::decode_rows(const unsigned char *data, int data_length)
 	{
-		int scanline_size = (image_width * bit_depth * get_image_data_channels() + 7) / 8;
-
-		int data_pos = 0;
 		int channels = get_image_data_channels();
 
-		int starting_row[7] = { 0, 0, 4, 0, 2, 0, 1 };
-		int starting_col[7] = { 0, 4, 0, 2, 0, 1, 0 };
-		int row_increment[7] = { 8, 8, 8, 4, 4, 2, 2 };
-		int col_increment[7] = { 8, 8, 4, 4, 2, 2, 1 };
-		//int block_height[7]  = { 8, 8, 4, 4, 2, 2, 1 };
-		//int block_width[7]   = { 8, 4, 4, 2, 2, 1, 1 };
-
 		PixelBufferLockAny pixels(image);
 		unsigned char *output = pixels.get_data();
 		int output_pitch = pixels.get_pitch();
-		for (int pass = 0; pass < 7; pass++)
+
+		int data_pos = 0;
+		while (pass < get_pass_count())
 		{
-			for (size_t i = 0; i < scanline_size; i++)
-				scanline[i] = 0;
+			int scanline_byte_length = (row_pixel_length * bit_depth * channels + 7) / 8;
+			if (data_pos + 1 + scanline_byte_length > data_length)
+				break;
+
+			int predictor_type = data[data_pos++];
+			filter_scanline(predictor_type, data + data_pos, scanline_byte_length);
+			data_pos += scanline_byte_length;
 
-			for (int y = starting_row[pass]; y < image_height; y += row_increment[pass])
+			unsigned char *output_line = output + row_y * output_pitch;
+			if (interlace_method == 0)
+			{
+				// Convert straight into the image
+				if (bit_depth <= 8)
+					convert_scanline_4ub(row_pixel_length, reinterpret_cast<Vec4ub*>(output_line));
+				else
+					convert_scanline_4us(row_pixel_length, reinterpret_cast<Vec4us*>(output_line));
+			}
+			else
 			{
-				if (starting_col[pass] < image_width)
+				if (bit_depth <= 8)
+					convert_scanline_4ub(row_pixel_length, scanline_4ub);
+				else
+					convert_scanline_4us(row_pixel_length, scanline_4us);
+
+				int scanline_pos = 0;
+				for (int x = adam7_starting_col[pass]; x < (int)image_width; x += adam7_col_increment[pass])
 				{
-					unsigned char *tmp = scanline;
-					scanline = prev_scanline;
-					prev_scanline = tmp;
+					if (bit_depth <= 8)
+						*reinterpret_cast<Vec4ub*>(output_line + x * 4) = scanline_4ub[scanline_pos++];
+					else
+						*reinterpret_cast<Vec4us*>(output_line + x * 8) = scanline_4us[scanline_pos++];
+				}
+			}
 
-					int scanline_pixel_length = (image_width - starting_col[pass] + col_increment[pass] - 1) / col_increment[pass];
-					int scanline_byte_length = (scanline_pixel_length * bit_depth * channels + 7) / 8;
+			unsigned char *tmp = scanline;
+			scanline = prev_scanline;
+			prev_scanline = tmp;
 
-					if (data_pos + scanline_byte_length > data_length)
-						throw Exception("Invalid PNG image file");
+			row_y += (interlace_method == 0) ? 1 : adam7_row_increment[pass];
+			if (row_y >= (int)image_height)
+				begin_pass(pass + 1);
+		}
+		return data_pos;
+	}
 
-					int predictor_type = data[data_pos++];
-					memcpy(scanline, data + data_pos, scanline_byte_length);
-					data_pos += scanline_byte_length;
+	void PNGLoader::create_image()
+	{
+		if (bit_depth <= 8)
+			image = PixelBuffer(image_width, image_height, force_srgb ? tf_srgb8_alpha8 : tf_rgba8);
+		else
+			image = PixelBuffer(image_width, image_height, tf_rgba16);
+	}
 
-					filter_scanline(predictor_type, scanline_byte_length);
+	void PNGLoader::create_scanline_buffers()
+	{
+		int size = (image_width * bit_depth * get_image_data_channels() + 7) / 8;
+		scanline = static_cast<unsigned char *>(System::aligned_alloc(size));
+		prev_scanline = static_cast<unsigned char *>(System::aligned_alloc(size));
+		scanline_4ub = static_cast<Vec4ub *>(System::aligned_alloc(image_width * sizeof(Vec4ub)));
+		scanline_4us = static_cast<Vec4us *>(System::aligned_alloc(image_width * sizeof(Vec4us)));
+	}
 
-					if (bit_depth <= 8)
-						convert_scanline_4ub(scanline_pixel_length);
-					else
-						convert_scanline_4us(scanline_pixel_length);
-
-					int scanline_pos = 0;
-					for (int x = starting_col[pass]; x < image_width; x += col_increment[pass])
-					{
-						if (bit_depth <= 8)
-							*reinterpret_cast<Vec4ub*>(output + y * output_pitch + x * 4) = scanline_4ub[scanline_pos++];
-						else
-							*reinterpret_cast<Vec4us*>(output + y * output_pitch + x * 8) = scanline_4us[scanline_pos++];
-					}
-				}
-			}
+	int PNGLoader::get_image_data_channels()
+	{
+		switch (color_type)
+		{
+		case 0: return 1; // grayscale
+		case 2: return 3; // truecolor
+		case 3: return 1; // indexed
+		case 4: return 2; // grayscale with alpha
+		case 6: return 4; // truecolor with alpha
+		default: throw Exception("Invalid PNG image file");
 		}
 	}
 
-	void PNGLoader::filter_scanline(int predictor_type, int scanline_byte_length)
+	void PNGLoader::filter_scanline(int predictor_type, const unsigned char *input, int scanline_byte_length)
 	{
-		int channels = get_image_data_channels();
+		int bytes_per_pixel = get_image_data_channels() * ((bit_depth + 7) / 8);
 		switch (predictor_type)
 		{
-		case 0: break; // none
-		case 1: predictor_sub(scanline, prev_scanline, scanline_byte_length, channels, bit_depth); break;
-		case 2: predictor_up(scanline, prev_scanline, scanline_byte_length, channels, bit_depth); break;
-		case 3: predictor_average(scanline, prev_scanline, scanline_byte_length, channels, bit_depth); break;
-		case 4: predictor_paeth(scanline, prev_scanline, scanline_byte_length, channels, bit_depth); break;
+		case 0: memcpy(scanline, input, scanline_byte_length); break; // none
+		case 1: predictor_sub(scanline, input, prev_scanline, scanline_byte_length, bytes_per_pixel); break;
+		case 2: predictor_up(scanline, input, prev_scanline, scanline_byte_length, bytes_per_pixel); break;
+		case 3:
+#if !defined __ANDROID__ && ! defined CL_DISABLE_SSE2
+			if ((bytes_per_pixel == 3 || bytes_per_pixel == 4) && System::detect_cpu_extension(System::sse2))
+				predictor_average_sse2(scanline, input, prev_scanline, scanline_byte_length, bytes_per_pixel);
+			else
+#elif defined CL_PNG_NEON
+			if (bytes_per_pixel == 3 || bytes_per_pixel == 4)
+				predictor_average_neon(scanline, input, prev_scanline, scanline_byte_length, bytes_per_pixel);
+			else
+#endif
+				predictor_average(scanline, input, prev_scanline, scanline_byte_length, bytes_per_pixel);
+			break;
+		case 4:
+#if !defined __ANDROID__ && ! defined CL_DISABLE_SSE2
+			if ((bytes_per_pixel == 3 || bytes_per_pixel == 4) && System::detect_cpu_extension(System::sse2))
+				predictor_paeth_sse2(scanline, input, prev_scanline, scanline_byte_length, bytes_per_pixel);
+			else
+#elif defined CL_PNG_NEON
+			if (bytes_per_pixel == 3 || bytes_per_pixel == 4)
+				predictor_paeth_neon(scanline, input, prev_scanline, scanline_byte_length, bytes_per_pixel);
+			else
+#endif
+				predictor_paeth(scanline, input, prev_scanline, scanline_byte_length, bytes_per_pixel);
+			break;
 		default: throw Exception("Invalid PNG image file");
 		}
 	}
 
-	void PNGLoader::predictor_sub(unsigned char *scanline, const unsigned char *prev_scanline, int byte_length, int channels, int bit_depth)
+	void PNGLoader::predictor_sub(unsigned char *scanline, const unsigned char *input, const unsigned char *prev_scanline, int byte_length, int bytes_per_pixel)
 	{
-		int bytes_per_pixel = channels * ((bit_depth + 7) / 8);
 		for (int i = 0; i < byte_length; i++)
 		{
-			int x = scanline[i];
+			int x = input[i];
 			int a = i >= bytes_per_pixel ? scanline[i - bytes_per_pixel] : 0;
 			scanline[i] = x + a;
 		}
 	}
 
-	void PNGLoader::predictor_up(unsigned char *scanline, const unsigned char *prev_scanline, int byte_length, int channels, int bit_depth)
+	void PNGLoader::predictor_up(unsigned char *scanline, const unsigned char *input, const unsigned char *prev_scanline, int byte_length, int bytes_per_pixel)
 	{
-		//int bytes_per_pixel = channels * ((bit_depth + 7) / 8);
 		for (int i = 0; i < byte_length; i++)
 		{
-			int x = scanline[i];
+			int x = input[i];
 			int b = prev_scanline[i];
 			scanline[i] = x + b;
 		}
 	}
 
-	void PNGLoader::predictor_average(unsigned char *scanline, const unsigned char *prev_scanline, int byte_length, int channels, int bit_depth)
+	void PNGLoader::predictor_average(unsigned char *scanline, const unsigned char *input, const unsigned char *prev_scanline, int byte_length, int bytes_per_pixel)
 	{
-		int bytes_per_pixel = channels * ((bit_depth + 7) / 8);
 		for (int i = 0; i < byte_length; i++)
 		{
-			int x = scanline[i];
+			int x = input[i];
 			int a = i >= bytes_per_pixel ? scanline[i - bytes_per_pixel] : 0;
 			int b = prev_scanline[i];
 			scanline[i] = x + (a + b) / 2;
 		}
 	}
 
-	void PNGLoader::predictor_paeth(unsigned char *scanline, const unsigned char *prev_scanline, int byte_length, int channels, int bit_depth)
+	void PNGLoader::predictor_paeth(unsigned char *scanline, const unsigned char *input, const unsigned char *prev_scanline, int byte_length, int bytes_per_pixel)
 	{
-		int bytes_per_pixel = channels * ((bit_depth + 7) / 8);
 		for (int i = 0; i < byte_length; i++)
 		{
-			int x = scanline[i];
+			int x = input[i];
 			int a = i >= bytes_per_pixel ? scanline[i - bytes_per_pixel] : 0;
 			int b = prev_scanline[i];
 			int c = i >= bytes_per_pixel ? prev_scanline[i - bytes_per_pixel] : 0;
@@ -436,32 +453,152 @@ namespace clan
 		}
 	}
 
-	void PNGLoader::convert_scanline_4ub(int scanline_pixel_length)
+	// The average and paeth predictors depend on the pixel to the left, so the vector versions work on one pixel at a time with all its channels in parallel.
+	// Pixels are moved in and out of the registers as 32 bit values, of which only bytes_per_pixel bytes are used.
+
+#if !defined __ANDROID__ && ! defined CL_DISABLE_SSE2
+
+	void PNGLoader::predictor_average_sse2(unsigned char *scanline, const unsigned char *input, const unsigned char *prev_scanline, int byte_length, int bytes_per_pixel)
+	{
+		__m128i one = _mm_set1_epi8(1);
+		__m128i a = _mm_setzero_si128();
+		for (int i = 0; i < byte_length; i += bytes_per_pixel)
+		{
+			__m128i x = load_pixel_sse2(input + i, bytes_per_pixel);
+			__m128i b = load_pixel_sse2(prev_scanline + i, bytes_per_pixel);
+
+			// _mm_avg_epu8 rounds up, while the predictor rounds down
+			__m128i average = _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), one));
+			a = _mm_add_epi8(x, average);
+			store_pixel_sse2(scanline + i, a, bytes_per_pixel);
+		}
+	}
+
+	void PNGLoader::predictor_paeth_sse2(unsigned char *scanline, const unsigned char *input, const unsigned char *prev_scanline, int byte_length, int bytes_per_pixel)
+	{
+		__m128i zero = _mm_setzero_si128();
+		__m128i a = _mm_setzero_si128();
+		__m128i c = _mm_setzero_si128();
+		for (int i = 0; i < byte_length; i += bytes_per_pixel)
+		{
+			__m128i x = load_pixel_sse2(input + i, bytes_per_pixel);
+			__m128i b = _mm_unpacklo_epi8(load_pixel_sse2(prev_scanline + i, bytes_per_pixel), zero);
+
+			// p = a + b - c, so p - a = b - c, p - b = a - c and p - c = (b - c) + (a - c)
+			__m128i pa = _mm_sub_epi16(b, c);
+			__m128i pb = _mm_sub_epi16(a, c);
+			__m128i pc = _mm_add_epi16(pa, pb);
+			pa = _mm_max_epi16(pa, _mm_sub_epi16(zero, pa));
+			pb = _mm_max_epi16(pb, _mm_sub_epi16(zero, pb));
+			pc = _mm_max_epi16(pc, _mm_sub_epi16(zero, pc));
+
+			// Ties go to a, then b
+			__m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+			__m128i use_a = _mm_cmpeq_epi16(smallest, pa);
+			__m128i use_b = _mm_cmpeq_epi16(smallest, pb);
+			__m128i nearest = _mm_or_si128(_mm_and_si128(use_b, b), _mm_andnot_si128(use_b, c));
+			nearest = _mm_or_si128(_mm_and_si128(use_a, a), _mm_andnot_si128(use_a, nearest));
+
+			__m128i result = _mm_add_epi8(x, _mm_packus_epi16(nearest, nearest));
+			store_pixel_sse2(scanline + i, result, bytes_per_pixel);
+
+			a = _mm_unpacklo_epi8(result, zero);
+			c = b;
+		}
+	}
+
+	inline __m128i PNGLoader::load_pixel_sse2(const unsigned char *p, int bytes_per_pixel)
+	{
+		int v = 0;
+		memcpy(&v, p, bytes_per_pixel);
+		return _mm_cvtsi32_si128(v);
+	}
+
+	inline void PNGLoader::store_pixel_sse2(unsigned char *p, __m128i pixel, int bytes_per_pixel)
+	{
+		int v = _mm_cvtsi128_si32(pixel);
+		memcpy(p, &v, bytes_per_pixel);
+	}
+
+#elif defined CL_PNG_NEON
+
+	void PNGLoader::predictor_average_neon(unsigned char *scanline, const unsigned char *input, const unsigned char *prev_scanline, int byte_length, int bytes_per_pixel)
+	{
+		uint8x8_t a = vdup_n_u8(0);
+		for (int i = 0; i < byte_length; i += bytes_per_pixel)
+		{
+			uint8x8_t x = load_pixel_neon(input + i, bytes_per_pixel);
+			uint8x8_t b = load_pixel_neon(prev_scanline + i, bytes_per_pixel);
+			a = vadd_u8(x, vhadd_u8(a, b));
+			store_pixel_neon(scanline + i, a, bytes_per_pixel);
+		}
+	}
+
+	void PNGLoader::predictor_paeth_neon(unsigned char *scanline, const unsigned char *input, const unsigned char *prev_scanline, int byte_length, int bytes_per_pixel)
+	{
+		uint8x8_t a = vdup_n_u8(0);
+		uint8x8_t c = vdup_n_u8(0);
+		for (int i = 0; i < byte_length; i += bytes_per_pixel)
+		{
+			uint8x8_t x = load_pixel_neon(input + i, bytes_per_pixel);
+			uint8x8_t b = load_pixel_neon(prev_scanline + i, bytes_per_pixel);
+
+			uint16x8_t pa = vabdl_u8(b, c);
+			uint16x8_t pb = vabdl_u8(a, c);
+			uint16x8_t pc = vabdq_u16(vaddl_u8(a, b), vaddl_u8(c, c));
+
+			// Ties go to a, then b
+			uint8x8_t use_a = vmovn_u16(vandq_u16(vcleq_u16(pa, pb), vcleq_u16(pa, pc)));
+			uint8x8_t use_b = vmovn_u16(vcleq_u16(pb, pc));
+			uint8x8_t nearest = vbsl_u8(use_a, a, vbsl_u8(use_b, b, c));
+
+			a = vadd_u8(x, nearest);
+			store_pixel_neon(scanline + i, a, bytes_per_pixel);
+			c = b;
+		}
+	}
+
+	inline uint8x8_t PNGLoader::load_pixel_neon(const unsigned char *p, int bytes_per_pixel)
+	{
+		uint32_t v = 0;
+		memcpy(&v, p, bytes_per_pixel);
+		return vreinterpret_u8_u32(vdup_n_u32(v));
+	}
+
+	inline void PNGLoader::store_pixel_neon(unsigned char *p, uint8x8_t pixel, int bytes_per_pixel)
+	{
+		uint32_t v = vget_lane_u32(vreinterpret_u32_u8(pixel), 0);
+		memcpy(p, &v, bytes_per_pixel);
+	}
+
+#endif
+
+	void PNGLoader::convert_scanline_4ub(int scanline_pixel_length, Vec4ub *output)
 	{
 		switch (color_type)
 		{
-		case 0: grayscale_to_4ub(scanline_pixel_length); break;
-		case 2: truecolor_to_4ub(scanline_pixel_length); break;
-		case 3: indexed_to_4ub(scanline_pixel_length); break;
-		case 4: grayscale_alpha_to_4ub(scanline_pixel_length); break;
-		case 6: truecolor_alpha_to_4ub(scanline_pixel_length); break;
+		case 0: grayscale_to_4ub(scanline_pixel_length, output); break;
+		case 2: truecolor_to_4ub(scanline_pixel_length, output); break;
+		case 3: indexed_to_4ub(scanline_pixel_length, output); break;
+		case 4: grayscale_alpha_to_4ub(scanline_pixel_length, output); break;
+		case 6: truecolor_alpha_to_4ub(scanline_pixel_length, output); break;
 		default: throw Exception("Invalid PNG image file");
 		}
 	}
 
-	void PNGLoader::convert_scanline_4us(int scanline_pixel_length)
+	void PNGLoader::convert_scanline_4us(int scanline_pixel_length, Vec4us *output)
 	{
 		switch (color_type)
 		{
-		case 0: grayscale_to_4us(scanline_pixel_length); break;
-		case 2: truecolor_to_4us(scanline_pixel_length); break;
-		case 4: grayscale_alpha_to_4us(scanline_pixel_length); break;
-		case 6: truecolor_alpha_to_4us(scanline_pixel_length); break;
+		case 0: grayscale_to_4us(scanline_pixel_length, output); break;
+		case 2: truecolor_to_4us(scanline_pixel_length, output); break;
+		case 4: grayscale_alpha_to_4us(scanline_pixel_length, output); break;
+		case 6: truecolor_alpha_to_4us(scanline_pixel_length, output); break;
 		default: throw Exception("Invalid PNG image file");
 		}
 	}
 
-	void PNGLoader::grayscale_to_4ub(int count)
+	void PNGLoader::grayscale_to_4ub(int count, Vec4ub *output)
 	{
 		unsigned char *input = scanline;
 		if (bit_depth == 1)
@@ -473,7 +610,7 @@ namespace clan
 					int shift = i % 8;
 					unsigned char value = (input[i / 8] >> shift) & 1;
 					value = static_cast<int>(value)* 255;
-					scanline_4ub[i] = Vec4ub(value, value, value, 255);
+					output[i] = Vec4ub(value, value, value, 255);
 				}
 			}
 			else
@@ -484,7 +621,7 @@ namespace clan
 					unsigned char value = (input[i / 8] >> shift) & 1;
 					unsigned char alpha = (value != colorkey.r) ? 255 : 0;
 					value = static_cast<int>(value)* 255;
-					scanline_4ub[i] = Vec4ub(value, value, value, alpha);
+					output[i] = Vec4ub(value, value, value, alpha);
 				}
 			}
 		}
@@ -497,7 +634,7 @@ namespace clan
 					int shift = (i % 4) * 2;
 					unsigned char value = (input[i / 4] >> shift) & 3;
 					value = (static_cast<int>(value)* 255 + 1) / 2;
-					scanline_4ub[i] = Vec4ub(value, value, value, 255);
+					output[i] = Vec4ub(value, value, value, 255);
 				}
 			}
 			else
@@ -508,7 +645,7 @@ namespace clan
 					unsigned char value = (input[i / 4] >> shift) & 3;
 					unsigned char alpha = (value != colorkey.r) ? 255 : 0;
 					value = (static_cast<int>(value)* 255 + 1) / 2;
-					scanline_4ub[i] = Vec4ub(value, value, value, alpha);
+					output[i] = Vec4ub(value, value, value, alpha);
 				}
 			}
 		}
@@ -521,7 +658,7 @@ namespace clan
 					int shift = (i % 2) * 4;
 					unsigned char value = (input[i / 4] >> shift) & 15;
 					value = (static_cast<int>(value)* 255 + 8) / 16;
-					scanline_4ub[i] = Vec4ub(value, value, value, 255);
+					output[i] = Vec4ub(value, value, value, 255);
 				}
 			}
 			else
@@ -532,7 +669,7 @@ namespace clan
 					unsigned char value = (input[i / 4] >> shift) & 15;
 					unsigned char alpha = (value != colorkey.r) ? 255 : 0;
 					value = (static_cast<int>(value)* 255 + 8) / 16;
-					scanline_4ub[i] = Vec4ub(value, value, value, alpha);
+					output[i] = Vec4ub(value, value, value, alpha);
 				}
 			}
 		}
@@ -543,7 +680,7 @@ namespace clan
 				for (int i = 0; i < count; i++)
 				{
 					unsigned char value = input[i];
-					scanline_4ub[i] = Vec4ub(value, value, value, 255);
+					output[i] = Vec4ub(value, value, value, 255);
 				}
 			}
 			else
@@ -552,7 +689,7 @@ namespace clan
 				{
 					unsigned char value = input[i];
 					unsigned char alpha = (value != colorkey.r) ? 255 : 0;
-					scanline_4ub[i] = Vec4ub(value, value, value, alpha);
+					output[i] = Vec4ub(value, value, value, alpha);
 				}
 			}
 		}
@@ -562,7 +699,7 @@ namespace clan
 		}
 	}
 
-	void PNGLoader::truecolor_to_4ub(int count)
+	void PNGLoader::truecolor_to_4ub(int count, Vec4ub *output)
 	{
 		if (bit_depth != 8)
 			throw Exception("Invalid PNG image file");
@@ -576,7 +713,7 @@ namespace clan
 				unsigned char red = input[i * 3 + 0];
 				unsigned char green = input[i * 3 + 1];
 				unsigned char blue = input[i * 3 + 2];
-				scanline_4ub[i] = Vec4ub(red, green, blue, 255);
+				output[i] = Vec4ub(red, green, blue, 255);
 			}
 		}
 		else
@@ -589,12 +726,12 @@ namespace clan
 				unsigned char alpha = 255;
 				if (red == colorkey.r && green == colorkey.g && blue == colorkey.b)
 					alpha = 0;
-				scanline_4ub[i] = Vec4ub(red, green, blue, alpha);
+				output[i] = Vec4ub(red, green, blue, alpha);
 			}
 		}
 	}
 
-	void PNGLoader::indexed_to_4ub(int count)
+	void PNGLoader::indexed_to_4ub(int count, Vec4ub *output)
 	{
 		unsigned char *input = scanline;
 		if (bit_depth == 1)
@@ -603,7 +740,7 @@ namespace clan
 			{
 				int shift = i % 8;
 				unsigned char value = (input[i / 8] >> shift) & 1;
-				scanline_4ub[i] = palette[value];
+				output[i] = palette[value];
 			}
 		}
 		else if (bit_depth == 2)
@@ -612,7 +749,7 @@ namespace clan
 			{
 				int shift = (i % 4) * 2;
 				unsigned char value = (input[i / 4] >> shift) & 3;
-				scanline_4ub[i] = palette[value];
+				output[i] = palette[value];
 			}
 		}
 		else if (bit_depth == 4)
@@ -621,7 +758,7 @@ namespace clan
 			{
 				int shift = (i % 2) * 4;
 				unsigned char value = (input[i / 4] >> shift) & 15;
-				scanline_4ub[i] = palette[value];
+				output[i] = palette[value];
 			}
 		}
 		else if (bit_depth == 8)
@@ -629,7 +766,7 @@ namespace clan
 			for (int i = 0; i < count; i++)
 			{
 				unsigned char value = input[i];
-				scanline_4ub[i] = palette[value];
+				output[i] = palette[value];
 			}
 		}
 		else
@@ -638,7 +775,7 @@ namespace clan
 		}
 	}
 
-	void PNGLoader::grayscale_alpha_to_4ub(int count)
+	void PNGLoader::grayscale_alpha_to_4ub(int count, Vec4ub *output)
 	{
 		if (bit_depth != 8)
 			throw Exception("Invalid PNG image file");
@@ -648,11 +785,11 @@ namespace clan
 		{
 			unsigned char value = input[i * 2];
 			unsigned char alpha = input[i * 2 + 1];
-			scanline_4ub[i] = Vec4ub(value, value, value, alpha);
+			output[i] = Vec4ub(value, value, value, alpha);
 		}
 	}
 
-	void PNGLoader::truecolor_alpha_to_4ub(int count)
+	void PNGLoader::truecolor_alpha_to_4ub(int count, Vec4ub *output)
 	{
 		if (bit_depth != 8)
 			throw Exception("Invalid PNG image file");
@@ -664,11 +801,11 @@ namespace clan
 			unsigned char green = input[i * 4 + 1];
 			unsigned char blue = input[i * 4 + 2];
 			unsigned char alpha = input[i * 4 + 3];
-			scanline_4ub[i] = Vec4ub(red, green, blue, alpha);
+			output[i] = Vec4ub(red, green, blue, alpha);
 		}
 	}
 
-	void PNGLoader::grayscale_to_4us(int count)
+	void PNGLoader::grayscale_to_4us(int count, Vec4us *output)
 	{
 		if (bit_depth != 16)
 			throw Exception("Invalid PNG image file");
@@ -679,7 +816,7 @@ namespace clan
 			for (int i = 0; i < count; i++)
 			{
 				unsigned short value = from_network_order(input[i]);
-				scanline_4us[i] = Vec4us(value, value, value, 65535);
+				output[i] = Vec4us(value, value, value, 65535);
 			}
 		}
 		else
@@ -688,12 +825,12 @@ namespace clan
 			{
 				unsigned short value = from_network_order(input[i]);
 				unsigned short alpha = (value != colorkey.r) ? 65535 : 0;
-				scanline_4us[i] = Vec4us(value, value, value, alpha);
+				output[i] = Vec4us(value, value, value, alpha);
 			}
 		}
 	}
 
-	void PNGLoader::truecolor_to_4us(int count)
+	void PNGLoader::truecolor_to_4us(int count, Vec4us *output)
 	{
 		if (bit_depth != 16)
 			throw Exception("Invalid PNG image file");
@@ -706,7 +843,7 @@ namespace clan
 				unsigned short red = from_network_order(input[i * 3 + 0]);
 				unsigned short green = from_network_order(input[i * 3 + 1]);
 				unsigned short blue = from_network_order(input[i * 3 + 2]);
-				scanline_4us[i] = Vec4us(red, green, blue, 65535);
+				output[i] = Vec4us(red, green, blue, 65535);
 			}
 		}
 		else
@@ -719,12 +856,12 @@ namespace clan
 				unsigned short alpha = 65535;
 				if (red == colorkey.r && green == colorkey.g && blue == colorkey.b)
 					alpha = 0;
-				scanline_4us[i] = Vec4us(red, green, blue, alpha);
+				output[i] = Vec4us(red, green, blue, alpha);
 			}
 		}
 	}
 
-	void PNGLoader::grayscale_alpha_to_4us(int count)
+	void PNGLoader::grayscale_alpha_to_4us(int count, Vec4us *output)
 	{
 		if (bit_depth != 16)
 			throw Exception("Invalid PNG image file");
@@ -734,11 +871,11 @@ namespace clan
 		{
 			unsigned short value = from_network_order(input[i * 2]);
 			unsigned short alpha = from_network_order(input[i * 2 + 1]);
-			scanline_4us[i] = Vec4us(value, value, value, alpha);
+			output[i] = Vec4us(value, value, value, alpha);
 		}
 	}
 
-	void PNGLoader::truecolor_alpha_to_4us(int count)
+	void PNGLoader::truecolor_alpha_to_4us(int count, Vec4us *output)
 	{
 		if (bit_depth != 16)
 			throw Exception("Invalid PNG image file");
@@ -750,7 +887,7 @@ namespace clan
 			unsigned short green = from_network_order(input[i * 4 + 1]);
 			unsigned short blue = from_network_order(input[i * 4 + 2]);
 			unsigned short alpha = from_network_order(input[i * 4 + 3]);
-			scanline_4us[i] = Vec4us(red, green, blue, alpha);
+			output[i] = Vec4us(red, green, blue, alpha);
 		}
 	}
 }
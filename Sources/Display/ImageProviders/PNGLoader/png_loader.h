@@ -31,8 +31,16 @@
 #include "API/Core/IOData/iodevice.h"
 #include "API/Display/Image/pixel_buffer.h"
 #include "API/Core/System/databuffer.h"
+#include "API/Core/Zip/zlib_compression.h"
 #include <map>
 
+#if !defined __ANDROID__ && ! defined CL_DISABLE_SSE2
+#include <emmintrin.h>
+#elif defined __ARM_NEON || defined __ARM_NEON__
+#include <arm_neon.h>
+#define CL_PNG_NEON
+#endif
+
 namespace clan
 {
 	class PNGLoader
@@ -48,33 +56,47 @@ namespace clan
 		void decode_header();
 		void decode_palette();
 		void decode_colorkey();
-		void decode_image();
-		void decode_interlace_none(const unsigned char *data, int data_length);
-		void decode_interlace_adam7(const unsigned char *data, int data_length);
+		void begin_image();
+		void decode_idat(const DataBuffer &idat);
+		int decode_rows(const unsigned char *data, int data_length);
+		void begin_pass(int first_pass);
+		int get_pass_count() const;
 
 		void create_image();
 		void create_scanline_buffers();
 		int get_image_data_channels();
 
-		void filter_scanline(int predictor_type, int scanline_byte_length);
-		static void predictor_sub(unsigned char *scanline, const unsigned char *prev_scanline, int byte_length, int channels, int bit_depth);
-		static void predictor_up(unsigned char *scanline, const unsigned char *prev_scanline, int byte_length, int channels, int bit_depth);
-		static void predictor_average(unsigned char *scanline, const unsigned char *prev_scanline, int byte_length, int channels, int bit_depth);
-		static void predictor_paeth(unsigned char *scanline, const unsigned char *prev_scanline, int byte_length, int channels, int bit_depth);
-
-		void convert_scanline_4ub(int scanline_pixel_length);
-		void convert_scanline_4us(int scanline_pixel_length);
-
-		void grayscale_to_4ub(int count);
-		void truecolor_to_4ub(int count);
-		void indexed_to_4ub(int count);
-		void grayscale_alpha_to_4ub(int count);
-		void truecolor_alpha_to_4ub(int count);
-
-		void grayscale_to_4us(int count);
-		void truecolor_to_4us(int count);
-		void grayscale_alpha_to_4us(int count);
-		void truecolor_alpha_to_4us(int count);
+		void filter_scanline(int predictor_type, const unsigned char *input, int scanline_byte_length);
+		static void predictor_sub(unsigned char *scanline, const unsigned char *input, const unsigned char *prev_scanline, int byte_length, int bytes_per_pixel);
+		static void predictor_up(unsigned char *scanline, const unsigned char *input, const unsigned char *prev_scanline, int byte_length, int bytes_per_pixel);
+		static void predictor_average(unsigned char *scanline, const unsigned char *input, const unsigned char *prev_scanline, int byte_length, int bytes_per_pixel);
+		static void predictor_paeth(unsigned char *scanline, const unsigned char *input, const unsigned char *prev_scanline, int byte_length, int bytes_per_pixel);
+
+#if !defined __ANDROID__ && ! defined CL_DISABLE_SSE2
+		static void predictor_average_sse2(unsigned char *scanline, const unsigned char *input, const unsigned char *prev_scanline, int byte_length, int bytes_per_pixel);
+		static void predictor_paeth_sse2(unsigned char *scanline, const unsigned char *input, const unsigned char *prev_scanline, int byte_length, int bytes_per_pixel);
+		static __m128i load_pixel_sse2(const unsigned char *p, int bytes_per_pixel);
+		static void store_pixel_sse2(unsigned char *p, __m128i pixel, int bytes_per_pixel);
+#elif defined CL_PNG_NEON
+		static void predictor_average_neon(unsigned char *scanline, const unsigned char *input, const unsigned char *prev_scanline, int byte_length, int bytes_per_pixel);
+		static void predictor_paeth_neon(unsigned char *scanline, const unsigned char *input, const unsigned char *prev_scanline, int byte_length, int bytes_per_pixel);
+		static uint8x8_t load_pixel_neon(const unsigned char *p, int bytes_per_pixel);
+		static void store_pixel_neon(unsigned char *p, uint8x8_t pixel, int bytes_per_pixel);
+#endif
+
+		void convert_scanline_4ub(int scanline_pixel_length, Vec4ub *output);
+		void convert_scanline_4us(int scanline_pixel_length, Vec4us *output);
+
+		void grayscale_to_4ub(int count, Vec4ub *output);
+		void truecolor_to_4ub(int count, Vec4ub *output);
+		void indexed_to_4ub(int count, Vec4ub *output);
+		void grayscale_alpha_to_4ub(int count, Vec4ub *output);
+		void truecolor_alpha_to_4ub(int count, Vec4ub *output);
+
+		void grayscale_to_4us(int count, Vec4us *output);
+		void truecolor_to_4us(int count, Vec4us *output);
+		void grayscale_alpha_to_4us(int count, Vec4us *output);
+		void truecolor_alpha_to_4us(int count, Vec4us *output);
 
 		static int abs(int a) { return a >= 0 ? a : -a; }
 
@@ -97,7 +119,8 @@ namespace clan
 
 		DataBuffer ihdr; // image header, which is the first chunk in a PNG datastream.
 		DataBuffer plte; // palette table associated with indexed PNG images.
-		DataBuffer idat; // image data chunks.
+		std::unique_ptr<ZLibDecompressor> inflater; // inflates the image data chunks as they are read
+		DataBuffer inflated; // inflated image data not yet decoded
 
 		DataBuffer trns; // Transparency information
 		DataBuffer chrm; // Colour space information (5 chunks)
@@ -120,6 +143,11 @@ namespace clan
 		Vec4us *scanline_4us;
 
 		Vec4ub *palette;
+
+		int pass;
+		int row_y;
+		int row_pixel_length;
+
 		Vec3us colorkey;
 		bool has_colorkey;
 	};
@@ -29,16 +29,18 @@
 #include "Display/precomp.h"
 #include "png_writer.h"
 #include "API/Core/Zip/zlib_compression.h"
+#include "API/Core/System/work_queue.h"
+#include <mutex>
 
 namespace clan
 {
-	void PNGWriter::save(IODevice iodevice, PixelBuffer image)
+	void PNGWriter::save(IODevice iodevice, PixelBuffer image, int compression_level, PNGProvider::FilterMode filter)
 	{
-		PNGWriter writer(iodevice, image);
+		PNGWriter writer(iodevice, image, compression_level, filter);
 		writer.save();
 	}
 	
-	PNGWriter::PNGWriter(IODevice iodevice, PixelBuffer src_image) : device(iodevice)
+	PNGWriter::PNGWriter(IODevice iodevice, PixelBuffer src_image, int compression_level, PNGProvider::FilterMode filter) : device(iodevice), compression_level(compression_level), filter(filter)
 	{
 		// This writer only supports RGBA format
 		if (src_image.get_bytes_per_pixel() < 8)
@@ -112,58 +114,229 @@ namespace clan
 		//write_chunk("sRGB", srgb, 1);
 	}
 	
+	namespace
+	{
+		WorkQueue &get_compress_queue()
+		{
+			static WorkQueue queue;
+			return queue;
+		}
+	}
+
 	void PNGWriter::write_data()
 	{
-		//int width = image.get_width();
 		int height = image.get_height();
+		int row_size = image.get_width() * image.get_bytes_per_pixel() + 1;
+		int rows_per_block = max(block_size / row_size, 1);
+		int block_count = (height + rows_per_block - 1) / rows_per_block;
+
+		// Each block is deflated on its own and ends with a sync flush on a byte boundary, so the raw deflate streams can be concatenated
+		std::vector<DataBuffer> blocks(block_count);
+		std::vector<unsigned int> block_adler32(block_count);
+		std::mutex mutex;
+		std::exception_ptr error;
+		get_compress_queue().parallel_for(0, block_count, 1, [&](int first, int last)
+		{
+			for (int i = first; i < last; i++)
+			{
+				try
+				{
+					blocks[i] = compress_rows(i * rows_per_block, min((i + 1) * rows_per_block, height), block_adler32[i]);
+				}
+				catch (...)
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					if (!error)
+						error = std::current_exception();
+				}
+			}
+		});
+		if (error)
+			std::rethrow_exception(error);
+
+		unsigned int adler = 1;
+		size_t idat_size = 2 + 2 + 4;
+		for (int i = 0; i < block_count; i++)
+		{
+			int first_row = i * rows_per_block;
+			int last_row = min((i + 1) * rows_per_block, height);
+			adler = adler32_combine(adler, block_adler32[i], (size_t)(last_row - first_row) * row_size);
+			idat_size += blocks[i].get_size();
+		}
+
+		DataBuffer idat((unsigned int)idat_size);
+		unsigned char *output = idat.get_data<unsigned char>();
+
+		// zlib header: deflate with a 32K window, and the level in the check byte
+		*(output++) = 0x78;
+		*(output++) = compression_level <= 1 ? 0x01 : compression_level < 6 ? 0x5e : compression_level == 6 ? 0x9c : 0xda;
+
+		for (auto & block : blocks)
+		{
+			memcpy(output, block.get_data(), block.get_size());
+			output += block.get_size();
+		}
+
+		// Empty final block with fixed codes
+		*(output++) = 0x03;
+		*(output++) = 0x00;
+
+		*(output++) = (adler >> 24) & 0xff;
+		*(output++) = (adler >> 16) & 0xff;
+		*(output++) = (adler >> 8) & 0xff;
+		*(output++) = adler & 0xff;
+
+		write_chunk("IDAT", idat.get_data(), idat.get_size());
+	}
+
+	DataBuffer PNGWriter::compress_rows(int first_row, int last_row, unsigned int &out_adler32)
+	{
 		int bytes_per_pixel = image.get_bytes_per_pixel();
-		
-		std::vector<unsigned char> scanline_orig;
-		std::vector<unsigned char> scanline_filtered;
-		scanline_orig.resize((image.get_width() + 1) * bytes_per_pixel);
-		scanline_filtered.resize(image.get_width() * bytes_per_pixel + 1);
-		
-		DataBuffer idat_uncompressed(height * scanline_filtered.size());
-		
-		for (int y = 0; y < height; y++)
+		int length = image.get_width() * bytes_per_pixel;
+		int row_size = length + 1;
+
+		// The rows are preceded by one pixel of zeros, so the filters need no special case for the first pixel
+		std::vector<unsigned char> row(bytes_per_pixel + length);
+		std::vector<unsigned char> prev_row(bytes_per_pixel + length);
+		std::vector<unsigned char> trial(length);
+
+		if (first_row > 0)
+			read_row(first_row - 1, prev_row.data() + bytes_per_pixel);
+
+		DataBuffer filtered((last_row - first_row) * row_size);
+		for (int y = first_row; y < last_row; y++)
 		{
-			// Grab scanline
-			memcpy(scanline_orig.data() + bytes_per_pixel, image.get_line(y), scanline_orig.size() - bytes_per_pixel);
+			read_row(y, row.data() + bytes_per_pixel);
+			unsigned char *output = filtered.get_data<unsigned char>() + (y - first_row) * row_size;
 
-			// Convert to big endian for 16 bit
-			if (bytes_per_pixel == 8)
+			switch (filter)
 			{
-				for (size_t x = 0; x < scanline_orig.size(); x+=2)
+			case PNGProvider::filter_none: output[0] = 0; break;
+			case PNGProvider::filter_sub: output[0] = 1; break;
+			case PNGProvider::filter_up: output[0] = 2; break;
+			case PNGProvider::filter_adaptive:
+			default:
 				{
-					std::swap(scanline_orig[x], scanline_orig[x + 1]);
+					unsigned int best_cost = 0xffffffff;
+					for (int filter_type = 0; filter_type < 5; filter_type++)
+					{
+						filter_row(filter_type, trial.data(), row.data() + bytes_per_pixel, prev_row.data() + bytes_per_pixel, length, bytes_per_pixel);
+						unsigned int cost = get_filter_cost(trial.data(), length);
+						if (cost < best_cost)
+						{
+							best_cost = cost;
+							output[0] = filter_type;
+						}
+					}
 				}
+				break;
 			}
 
-			// Filter scanline
-			/*
-			scanline_filtered[0] = 0; // None filter type
-			for (int i = bytes_per_pixel; i < scanline_orig.size(); i++)
+			filter_row(output[0], output + 1, row.data() + bytes_per_pixel, prev_row.data() + bytes_per_pixel, length, bytes_per_pixel);
+			row.swap(prev_row);
+		}
+
+		out_adler32 = adler32(1, filtered.get_data<unsigned char>(), filtered.get_size());
+
+		DataBuffer compressed;
+		ZLibCompressor compressor(true, compression_level);
+		compressor.compress(filtered.get_data(), filtered.get_size(), compressed, ZLibCompressor::sync_flush);
+		return compressed;
+	}
+
+	void PNGWriter::read_row(int y, unsigned char *row)
+	{
+		int length = image.get_width() * image.get_bytes_per_pixel();
+		memcpy(row, image.get_line(y), length);
+
+		// Convert to big endian for 16 bit
+		if (image.get_bytes_per_pixel() == 8)
+		{
+			for (int x = 0; x < length; x += 2)
+				std::swap(row[x], row[x + 1]);
+		}
+	}
+
+	void PNGWriter::filter_row(int filter_type, unsigned char *output, const unsigned char *row, const unsigned char *prev_row, int length, int bytes_per_pixel)
+	{
+		switch (filter_type)
+		{
+		case 0: // None
+			memcpy(output, row, length);
+			break;
+		case 1: // Sub
+			for (int i = 0; i < length; i++)
+				output[i] = row[i] - row[i - bytes_per_pixel];
+			break;
+		case 2: // Up
+			for (int i = 0; i < length; i++)
+				output[i] = row[i] - prev_row[i];
+			break;
+		case 3: // Average
+			for (int i = 0; i < length; i++)
+				output[i] = row[i] - (row[i - bytes_per_pixel] + prev_row[i]) / 2;
+			break;
+		case 4: // Paeth
+			for (int i = 0; i < length; i++)
 			{
-				scanline_filtered[i - bytes_per_pixel + 1] = scanline_orig[i];
+				int a = row[i - bytes_per_pixel];
+				int b = prev_row[i];
+				int c = prev_row[i - bytes_per_pixel];
+				int p = a + b - c;
+				int pa = std::abs(p - a);
+				int pb = std::abs(p - b);
+				int pc = std::abs(p - c);
+				int pr = (pa <= pb && pa <= pc) ? a : (pb <= pc) ? b : c;
+				output[i] = row[i] - pr;
 			}
-			*/
-			scanline_filtered[0] = 1; // Sub filter type
-			for (int i = bytes_per_pixel; i < scanline_orig.size(); i++)
+			break;
+		}
+	}
+
+	unsigned int PNGWriter::get_filter_cost(const unsigned char *filtered, int length)
+	{
+		// Sum of the absolute values when read as signed bytes
+		unsigned int cost = 0;
+		for (int i = 0; i < length; i++)
+			cost += filtered[i] < 128 ? filtered[i] : 256 - filtered[i];
+		return cost;
+	}
+
+	unsigned int PNGWriter::adler32(unsigned int adler, const unsigned char *data, size_t length)
+	{
+		const unsigned int base = 65521;
+		unsigned int s1 = adler & 0xffff;
+		unsigned int s2 = (adler >> 16) & 0xffff;
+		while (length > 0)
+		{
+			// 5552 is the most bytes that can be summed before s2 may overflow
+			size_t count = min(length, (size_t)5552);
+			length -= count;
+			for (size_t i = 0; i < count; i++)
 			{
-				unsigned char a = scanline_orig[i - bytes_per_pixel];
-				unsigned char x = scanline_orig[i];
-				scanline_filtered[i - bytes_per_pixel + 1] = x - a;
+				s1 += data[i];
+				s2 += s1;
 			}
-			
-			// Output scanline
-			memcpy(idat_uncompressed.get_data<unsigned char>() + y * scanline_filtered.size(), scanline_filtered.data(), scanline_filtered.size());
+			data += count;
+			s1 %= base;
+			s2 %= base;
 		}
-		
-		DataBuffer idat = ZLibCompression::compress(idat_uncompressed, false);
-		
-		write_chunk("IDAT", idat.get_data(), idat.get_size());
+		return (s2 << 16) | s1;
 	}
-	
+
+	unsigned int PNGWriter::adler32_combine(unsigned int adler1, unsigned int adler2, size_t length2)
+	{
+		const uint64_t base = 65521;
+		uint64_t remainder = length2 % base;
+		uint64_t sum1 = adler1 & 0xffff;
+		uint64_t sum2 = (remainder * sum1) % base;
+		sum1 += (adler2 & 0xffff) + base - 1;
+		sum2 += ((adler1 >> 16) & 0xffff) + ((adler2 >> 16) & 0xffff) + base - remainder;
+		sum1 %= base;
+		sum2 %= base;
+		return (unsigned int)((sum2 << 16) | sum1);
+	}
+
 	void PNGWriter::write_chunk(const char name[4], const void *data, int size)
 	{
 		unsigned char size_data[4];
@@ -31,26 +31,38 @@
 #include "API/Core/IOData/iodevice.h"
 #include "API/Display/Image/pixel_buffer.h"
 #include "API/Core/System/databuffer.h"
+#include "API/Display/ImageProviders/png_provider.h"
 
 namespace clan
 {
 	class PNGWriter
 	{
 	public:
-		static void save(IODevice iodevice, PixelBuffer image);
+		static void save(IODevice iodevice, PixelBuffer image, int compression_level = 6, PNGProvider::FilterMode filter = PNGProvider::filter_adaptive);
 		
 	private:
-		PNGWriter(IODevice iodevice, PixelBuffer image);
+		PNGWriter(IODevice iodevice, PixelBuffer image, int compression_level, PNGProvider::FilterMode filter);
 		void save();
 
 		void write_magic();
 		void write_headers();
 		void write_data();
+		DataBuffer compress_rows(int first_row, int last_row, unsigned int &out_adler32);
+		void read_row(int y, unsigned char *row);
+		static void filter_row(int filter_type, unsigned char *output, const unsigned char *row, const unsigned char *prev_row, int length, int bytes_per_pixel);
+		static unsigned int get_filter_cost(const unsigned char *filtered, int length);
+		static unsigned int adler32(unsigned int adler, const unsigned char *data, size_t length);
+		static unsigned int adler32_combine(unsigned int adler1, unsigned int adler2, size_t length2);
 		
 		void write_chunk(const char name[4], const void *data, int size);
 		
 		IODevice device;
 		PixelBuffer image;
+		int compression_level;
+		PNGProvider::FilterMode filter;
+
+		// Rows are filtered and deflated in blocks of about this many bytes, which are compressed in parallel
+		static const int block_size = 256 * 1024;
 	};
 	
 	class PNGCRC32
@@ -32,6 +32,7 @@
 #include "API/Core/IOData/path_help.h"
 #include "API/Display/ImageProviders/dds_provider.h"
 #include "API/Display/Image/pixel_buffer.h"
+#include "API/Display/Render/transfer_texture.h"
 #include "API/Core/System/exception.h"
 #include "API/Core/Text/string_help.h"
 
@@ -52,6 +53,25 @@ namespace clan
 	}
 
 	PixelBufferSet DDSProvider::load(IODevice &file)
+	{
+		return load(file, nullptr);
+	}
+
+	PixelBufferSet DDSProvider::load(GraphicContext &gc, const std::string &fullname)
+	{
+		std::string path = PathHelp::get_fullpath(fullname, PathHelp::path_type_file);
+		std::string filename = PathHelp::get_filename(fullname, PathHelp::path_type_file);
+		FileSystem vfs(path);
+		IODevice file = vfs.open_file(filename);
+		return load(file, &gc);
+	}
+
+	PixelBufferSet DDSProvider::load(GraphicContext &gc, IODevice &file)
+	{
+		return load(file, &gc);
+	}
+
+	PixelBufferSet DDSProvider::load(IODevice &file, GraphicContext *gc)
 	{
 #define fourccvalue(a,b,c,d) ((static_cast<unsigned int>(a)) | (static_cast<unsigned int>(b) << 8) | (static_cast<unsigned int>(c) << 16) | (static_cast<unsigned int>(d) << 24))
 #define isbitmask(r,g,b,a) (format_red_bit_mask == (r) && format_green_bit_mask == (g) && format_blue_bit_mask == (b) && format_alpha_bit_mask == (a))
@@ -310,18 +330,36 @@ namespace clan
 				int mip_width = max(texture_width >> level, 1);
 				int mip_height = max(texture_height >> level, 1);
 
-				PixelBuffer buffer(mip_width, mip_height, original_format);
+				int row_size = bytes_per_block ? bytes_per_block * ((mip_width + 3) / 4) : bytes_per_pixel * mip_width;
+				int row_count = bytes_per_block ? (mip_height + 3) / 4 : mip_height;
 
-				if (bytes_per_block)
+				// Formats that need no conversion are read straight into the mapped transfer buffer
+				bool transfer = gc && texture_format == original_format;
+				PixelBuffer buffer;
+				if (transfer)
 				{
-					int blocks_width = (mip_width + 3) / 4;
-					int blocks_height = (mip_height + 3) / 4;
-					file.read(buffer.get_data(), bytes_per_block * blocks_width * blocks_height);
+					buffer = TransferTexture(*gc, mip_width, mip_height, data_to_gpu, original_format);
+					buffer.lock(*gc, access_write_discard);
 				}
 				else
 				{
-					file.read(buffer.get_data(), bytes_per_pixel * mip_width * mip_height);
+					buffer = PixelBuffer(mip_width, mip_height, original_format);
+				}
+
+				unsigned char *dest = buffer.get_data<unsigned char>();
+				int dest_pitch = buffer.get_pitch();
+				if (dest_pitch == row_size)
+				{
+					file.read(dest, row_size * row_count);
 				}
+				else
+				{
+					for (int y = 0; y < row_count; y++)
+						file.read(dest + y * dest_pitch, row_size);
+				}
+
+				if (transfer)
+					buffer.unlock();
 
 				if (texture_format != original_format)
 					buffer = buffer.to_format(texture_format);
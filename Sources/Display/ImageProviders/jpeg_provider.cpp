@@ -35,7 +35,7 @@
 #include "API/Core/System/exception.h"
 #include "API/Core/Text/string_help.h"
 #include "JPEGLoader/jpeg_loader.h"
-#include "JPEGWriter/jpge.h"
+#include "JPEGWriter/jpeg_encoder.h"
 
 namespace clan
 {
@@ -54,6 +54,19 @@ namespace clan
 		return JPEGLoader::load(file, srgb);
 	}
 
+	PixelBuffer JPEGProvider::load_scaled(
+		IODevice &file,
+		int scale_denominator,
+		bool srgb)
+	{
+		return JPEGLoader::load(file, srgb, scale_denominator);
+	}
+
+	Size JPEGProvider::get_size(IODevice &file)
+	{
+		return JPEGLoader::get_size(file);
+	}
+
 	PixelBuffer JPEGProvider::load(
 		const std::string &fullname,
 		bool srgb)
@@ -80,23 +93,17 @@ namespace clan
 		IODevice &file,
 		int quality)
 	{
-		if (buffer.get_format() != tf_rgb8)
-		{
-			PixelBuffer newbuf(buffer.get_width(), buffer.get_height(), tf_rgb8);
-			newbuf.set_image(buffer);
-			buffer = newbuf;
-		}
-
-		DataBuffer output(buffer.get_width() * buffer.get_height() * 5);
-		int size = output.get_size();
-
-		clan_jpge::params desc;
-		desc.m_quality = quality;
-		bool result = clan_jpge::compress_image_to_jpeg_file_in_memory(output.get_data(), size, buffer.get_width(), buffer.get_height(), 3, output.get_data<clan_jpge::uint8>(), desc);
-		if (!result)
-			throw Exception("Unable to compress JPEG image");
+		DataBuffer output;
+		JPEGEncoder::encode(buffer, quality, output);
+		file.write(output.get_data(), output.get_size());
+	}
 
-		file.write(output.get_data(), size);
+	void JPEGProvider::save(
+		PixelBuffer buffer,
+		DataBuffer &output,
+		int quality)
+	{
+		JPEGEncoder::encode(buffer, quality, output);
 	}
 
 	void JPEGProvider::save(
@@ -0,0 +1,292 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Display/precomp.h"
+#include "API/Core/IOData/file_system.h"
+#include "API/Core/IOData/path_help.h"
+#include "API/Core/Math/cl_math.h"
+#include "API/Core/System/databuffer.h"
+#include "API/Core/System/exception.h"
+#include "API/Core/Zip/zlib_compression.h"
+#include "API/Display/ImageProviders/ktx2_provider.h"
+#include "API/Display/Image/pixel_buffer.h"
+#include "API/Display/Render/graphic_context.h"
+#include "API/Display/Render/transfer_texture.h"
+#include <cstring>
+#include <vector>
+
+namespace clan
+{
+	PixelBufferSet KTX2Provider::load(const std::string &filename, const FileSystem &fs)
+	{
+		IODevice file = fs.open_file(filename);
+		return load(file);
+	}
+
+	PixelBufferSet KTX2Provider::load(const std::string &fullname)
+	{
+		std::string path = PathHelp::get_fullpath(fullname, PathHelp::path_type_file);
+		std::string filename = PathHelp::get_filename(fullname, PathHelp::path_type_file);
+		FileSystem vfs(path);
+		return load(filename, vfs);
+	}
+
+	PixelBufferSet KTX2Provider::load(IODevice &file)
+	{
+		return load(file, nullptr);
+	}
+
+	PixelBufferSet KTX2Provider::load(GraphicContext &gc, const std::string &fullname)
+	{
+		std::string path = PathHelp::get_fullpath(fullname, PathHelp::path_type_file);
+		std::string filename = PathHelp::get_filename(fullname, PathHelp::path_type_file);
+		FileSystem vfs(path);
+		IODevice file = vfs.open_file(filename);
+		return load(file, &gc);
+	}
+
+	PixelBufferSet KTX2Provider::load(GraphicContext &gc, IODevice &file)
+	{
+		return load(file, &gc);
+	}
+
+	PixelBufferSet KTX2Provider::load(IODevice &file, GraphicContext *gc)
+	{
+		const unsigned char ktx2_identifier[12] = { 0xab, 'K', 'T', 'X', ' ', '2', '0', 0xbb, '\r', '\n', 0x1a, '\n' };
+
+		const unsigned int supercompression_none = 0;
+		const unsigned int supercompression_basislz = 1;
+		const unsigned int supercompression_zstd = 2;
+		const unsigned int supercompression_zlib = 3;
+
+		file.set_little_endian_mode();
+
+		unsigned char identifier[12];
+		if (file.read(identifier, 12) != 12 || memcmp(identifier, ktx2_identifier, 12) != 0)
+			throw Exception("Not a KTX2 file");
+
+		unsigned int vk_format = file.read_uint32();
+		file.read_uint32(); // typeSize
+		int width = file.read_uint32();
+		int height = file.read_uint32();
+		int depth = file.read_uint32();
+		int layer_count = file.read_uint32();
+		int face_count = file.read_uint32();
+		int level_count = file.read_uint32();
+		unsigned int supercompression = file.read_uint32();
+
+		file.read_uint32(); // dfdByteOffset
+		file.read_uint32(); // dfdByteLength
+		file.read_uint32(); // kvdByteOffset
+		file.read_uint32(); // kvdByteLength
+		file.read_uint64(); // sgdByteOffset
+		file.read_uint64(); // sgdByteLength
+
+		if (vk_format == 0 || supercompression == supercompression_basislz)
+			throw Exception("KTX2 file contains Basis Universal data, which must be transcoded before it can be loaded");
+		if (supercompression == supercompression_zstd)
+			throw Exception("Zstandard supercompressed KTX2 files are not supported");
+		if (supercompression != supercompression_none && supercompression != supercompression_zlib)
+			throw Exception("Unsupported KTX2 supercompression scheme");
+		if (width <= 0 || depth > 0)
+			throw Exception("Unsupported KTX2 texture dimensions");
+		if (face_count != 1 && face_count != 6)
+			throw Exception("Unsupported KTX2 cube map face count");
+
+		TextureFormat texture_format;
+		if (!from_vk_format(vk_format, texture_format))
+			throw Exception("Unsupported pixel format used by KTX2 file");
+
+		// A level count of zero means the file only contains the base level
+		int texture_levels = max(level_count, 1);
+		std::vector<uint64_t> level_offsets(texture_levels);
+		std::vector<uint64_t> level_lengths(texture_levels);
+		std::vector<uint64_t> level_uncompressed_lengths(texture_levels);
+		for (int level = 0; level < texture_levels; level++)
+		{
+			level_offsets[level] = file.read_uint64();
+			level_lengths[level] = file.read_uint64();
+			level_uncompressed_lengths[level] = file.read_uint64();
+		}
+
+		TextureDimensions texture_dimensions;
+		int texture_layers = max(layer_count, 1);
+		int texture_slices = texture_layers * face_count;
+		if (face_count == 6)
+			texture_dimensions = layer_count > 0 ? texture_cube_array : texture_cube;
+		else if (height == 0)
+			texture_dimensions = layer_count > 0 ? texture_1d_array : texture_1d;
+		else
+			texture_dimensions = layer_count > 0 ? texture_2d_array : texture_2d;
+		int texture_height = max(height, 1);
+
+		TextureFormat original_format = texture_format;
+		if (texture_format == tf_bgra8 || texture_format == tf_rgb8 || texture_format == tf_bgr8)
+			texture_format = tf_rgba8;
+
+		bool compressed = PixelBuffer::is_compressed(original_format);
+		int bytes_per_block = compressed ? PixelBuffer::get_bytes_per_block(original_format) : 0;
+		int bytes_per_pixel = compressed ? 0 : PixelBuffer::get_bytes_per_pixel(original_format);
+
+		PixelBufferSet set(texture_dimensions, texture_format, width, texture_height, texture_slices);
+		for (int level = 0; level < texture_levels; level++)
+		{
+			int mip_width = max(width >> level, 1);
+			int mip_height = max(texture_height >> level, 1);
+			int row_size = compressed ? (mip_width + 3) / 4 * bytes_per_block : mip_width * bytes_per_pixel;
+			int row_count = compressed ? (mip_height + 3) / 4 : mip_height;
+			unsigned int image_size = row_size * row_count;
+
+			uint64_t level_size = supercompression == supercompression_none ? level_lengths[level] : level_uncompressed_lengths[level];
+			if (level_size < (uint64_t)image_size * texture_slices)
+				throw Exception("KTX2 file has too little data for a mip level");
+
+			// Supercompressed levels are inflated as a whole. Other levels are read image by image from the file.
+			DataBuffer level_data;
+			if (supercompression == supercompression_zlib)
+			{
+				DataBuffer compressed_data(level_lengths[level]);
+				file.seek((int)level_offsets[level]);
+				if (file.read(compressed_data.get_data(), compressed_data.get_size()) != (int)compressed_data.get_size())
+					throw Exception("Premature end of KTX2 file");
+				level_data = ZLibCompression::decompress(compressed_data, false);
+				if (level_data.get_size() < image_size * texture_slices)
+					throw Exception("KTX2 file has too little data for a mip level");
+			}
+			else
+			{
+				file.seek((int)level_offsets[level]);
+			}
+
+			for (int slice = 0; slice < texture_slices; slice++)
+			{
+				// Formats that need no conversion are written straight into the mapped transfer buffer
+				bool transfer = gc && texture_format == original_format;
+				PixelBuffer buffer;
+				if (transfer)
+				{
+					buffer = TransferTexture(*gc, mip_width, mip_height, data_to_gpu, original_format);
+					buffer.lock(*gc, access_write_discard);
+				}
+				else
+				{
+					buffer = PixelBuffer(mip_width, mip_height, original_format);
+				}
+
+				unsigned char *dest = buffer.get_data<unsigned char>();
+				int dest_pitch = buffer.get_pitch();
+				if (level_data.get_size() > 0)
+				{
+					const unsigned char *src = level_data.get_data<unsigned char>() + image_size * slice;
+					for (int y = 0; y < row_count; y++)
+						memcpy(dest + y * dest_pitch, src + y * row_size, row_size);
+				}
+				else if (dest_pitch == row_size)
+				{
+					if (file.read(dest, image_size) != (int)image_size)
+						throw Exception("Premature end of KTX2 file");
+				}
+				else
+				{
+					for (int y = 0; y < row_count; y++)
+					{
+						if (file.read(dest + y * dest_pitch, row_size) != row_size)
+							throw Exception("Premature end of KTX2 file");
+					}
+				}
+
+				if (transfer)
+					buffer.unlock();
+				if (texture_format != original_format)
+					buffer = buffer.to_format(texture_format);
+				set.set_image(slice, level, buffer);
+			}
+		}
+		return set;
+	}
+
+	TextureFormat KTX2Provider::get_preferred_format(const GraphicContext &gc, bool srgb, bool alpha)
+	{
+		TextureFormat candidates[] =
+		{
+			srgb ? tf_compressed_srgb_alpha_bptc_unorm : tf_compressed_rgba_bptc_unorm,
+			srgb ? tf_compressed_srgb8_alpha8_astc_4x4 : tf_compressed_rgba_astc_4x4,
+			alpha ? (srgb ? tf_compressed_srgb8_alpha8_etc2_eac : tf_compressed_rgba8_etc2_eac) : (srgb ? tf_compressed_srgb8_etc2 : tf_compressed_rgb8_etc2),
+			alpha ? (srgb ? tf_compressed_srgb_alpha_s3tc_dxt5 : tf_compressed_rgba_s3tc_dxt5) : (srgb ? tf_compressed_srgb_s3tc_dxt1 : tf_compressed_rgb_s3tc_dxt1)
+		};
+
+		for (TextureFormat format : candidates)
+		{
+			if (gc.is_compressed_format_supported(format))
+				return format;
+		}
+		return srgb ? tf_srgb8_alpha8 : tf_rgba8;
+	}
+
+	bool KTX2Provider::from_vk_format(unsigned int vk_format, TextureFormat &out_format)
+	{
+		switch (vk_format)
+		{
+		case 9: out_format = tf_r8; return true; // VK_FORMAT_R8_UNORM
+		case 16: out_format = tf_rg8; return true; // VK_FORMAT_R8G8_UNORM
+		case 23: out_format = tf_rgb8; return true; // VK_FORMAT_R8G8B8_UNORM
+		case 29: out_format = tf_srgb8; return true; // VK_FORMAT_R8G8B8_SRGB
+		case 30: out_format = tf_bgr8; return true; // VK_FORMAT_B8G8R8_UNORM
+		case 37: out_format = tf_rgba8; return true; // VK_FORMAT_R8G8B8A8_UNORM
+		case 43: out_format = tf_srgb8_alpha8; return true; // VK_FORMAT_R8G8B8A8_SRGB
+		case 44: out_format = tf_bgra8; return true; // VK_FORMAT_B8G8R8A8_UNORM
+		case 76: out_format = tf_r16f; return true; // VK_FORMAT_R16_SFLOAT
+		case 83: out_format = tf_rg16f; return true; // VK_FORMAT_R16G16_SFLOAT
+		case 97: out_format = tf_rgba16f; return true; // VK_FORMAT_R16G16B16A16_SFLOAT
+		case 100: out_format = tf_r32f; return true; // VK_FORMAT_R32_SFLOAT
+		case 103: out_format = tf_rg32f; return true; // VK_FORMAT_R32G32_SFLOAT
+		case 109: out_format = tf_rgba32f; return true; // VK_FORMAT_R32G32B32A32_SFLOAT
+		case 131: out_format = tf_compressed_rgb_s3tc_dxt1; return true; // VK_FORMAT_BC1_RGB_UNORM_BLOCK
+		case 132: out_format = tf_compressed_srgb_s3tc_dxt1; return true; // VK_FORMAT_BC1_RGB_SRGB_BLOCK
+		case 133: out_format = tf_compressed_rgba_s3tc_dxt1; return true; // VK_FORMAT_BC1_RGBA_UNORM_BLOCK
+		case 134: out_format = tf_compressed_srgb_alpha_s3tc_dxt1; return true; // VK_FORMAT_BC1_RGBA_SRGB_BLOCK
+		case 135: out_format = tf_compressed_rgba_s3tc_dxt3; return true; // VK_FORMAT_BC2_UNORM_BLOCK
+		case 136: out_format = tf_compressed_srgb_alpha_s3tc_dxt3; return true; // VK_FORMAT_BC2_SRGB_BLOCK
+		case 137: out_format = tf_compressed_rgba_s3tc_dxt5; return true; // VK_FORMAT_BC3_UNORM_BLOCK
+		case 138: out_format = tf_compressed_srgb_alpha_s3tc_dxt5; return true; // VK_FORMAT_BC3_SRGB_BLOCK
+		case 139: out_format = tf_compressed_red_rgtc1; return true; // VK_FORMAT_BC4_UNORM_BLOCK
+		case 140: out_format = tf_compressed_signed_red_rgtc1; return true; // VK_FORMAT_BC4_SNORM_BLOCK
+		case 141: out_format = tf_compressed_rg_rgtc2; return true; // VK_FORMAT_BC5_UNORM_BLOCK
+		case 142: out_format = tf_compressed_signed_rg_rgtc2; return true; // VK_FORMAT_BC5_SNORM_BLOCK
+		case 145: out_format = tf_compressed_rgba_bptc_unorm; return true; // VK_FORMAT_BC7_UNORM_BLOCK
+		case 146: out_format = tf_compressed_srgb_alpha_bptc_unorm; return true; // VK_FORMAT_BC7_SRGB_BLOCK
+		case 147: out_format = tf_compressed_rgb8_etc2; return true; // VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK
+		case 148: out_format = tf_compressed_srgb8_etc2; return true; // VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK
+		case 151: out_format = tf_compressed_rgba8_etc2_eac; return true; // VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK
+		case 152: out_format = tf_compressed_srgb8_alpha8_etc2_eac; return true; // VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK
+		case 157: out_format = tf_compressed_rgba_astc_4x4; return true; // VK_FORMAT_ASTC_4x4_UNORM_BLOCK
+		case 158: out_format = tf_compressed_srgb8_alpha8_astc_4x4; return true; // VK_FORMAT_ASTC_4x4_SRGB_BLOCK
+		default: return false;
+		}
+	}
+}
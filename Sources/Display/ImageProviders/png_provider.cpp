@@ -36,6 +36,7 @@
 #include "API/Display/ImageProviders/png_provider.h"
 #include "Display/ImageProviders/PNGLoader/png_loader.h"
 #include "Display/ImageProviders/PNGWriter/png_writer.h"
+#include "API/Core/System/work_queue.h"
 #include "Core/Zip/miniz.h"
 #include <stdlib.h>
 
@@ -81,6 +82,30 @@ namespace clan
 		PNGProvider::save(buffer, filename, vfs);
 	}
 
+	void PNGProvider::save(PixelBuffer buffer, IODevice &iodev, int compression_level, FilterMode filter)
+	{
+		PNGWriter::save(iodev, buffer, compression_level, filter);
+	}
+
+	std::future<void> PNGProvider::save_async(PixelBuffer buffer, const std::string &fullname, int compression_level, FilterMode filter)
+	{
+		// A single worker, so saves finish in the order they were started
+		static WorkQueue queue(true);
+
+		PixelBuffer pixels = buffer.copy();
+		auto task = std::make_shared<std::packaged_task<void()>>([=]()
+		{
+			std::string path = PathHelp::get_fullpath(fullname, PathHelp::path_type_file);
+			std::string filename = PathHelp::get_filename(fullname, PathHelp::path_type_file);
+			FileSystem vfs(path);
+			IODevice file = vfs.open_file(filename, File::create_always, File::access_read_write);
+			PNGWriter::save(file, pixels, compression_level, filter);
+		});
+		std::future<void> result = task->get_future();
+		queue.queue([task]() { (*task)(); });
+		return result;
+	}
+
 	void PNGProvider::save(PixelBuffer buffer, IODevice &iodev)
 	{
 		PNGWriter::save(iodev, buffer);
@@ -122,6 +122,12 @@ namespace clan
 		SetCursorPos(pt.x, pt.y);
 	}
 
+	bool InputDeviceProvider_Win32Mouse::set_raw_input(bool enable)
+	{
+		throw_if_disposed();
+		return window->set_raw_mouse_input(enable);
+	}
+
 	void InputDeviceProvider_Win32Mouse::on_dispose()
 	{
 	}
@@ -52,6 +52,7 @@ namespace clan
 
 		void set_position(float x, float y) override;
 		void set_device_position(int x, int y) override;
+		bool set_raw_input(bool enable) override;
 
 	private:
 		void on_dispose();
@@ -950,7 +950,19 @@ namespace clan
 					RAWINPUT *rawinput = (RAWINPUT*)buffer.get_data();
 					if (rawinput->header.dwType == RIM_TYPEMOUSE)
 					{
-						// To do: generate relative mouse movement events based on HID mouse information.
+						const RAWMOUSE &raw_mouse = rawinput->data.mouse;
+						bool relative = (raw_mouse.usFlags & MOUSE_MOVE_ABSOLUTE) == 0;
+						if (raw_mouse_input && relative && (raw_mouse.lLastX != 0 || raw_mouse.lLastY != 0))
+						{
+							InputEvent key;
+							key.type = InputEvent::pointer_raw_moved;
+							key.raw_delta = Pointf((float)raw_mouse.lLastX, (float)raw_mouse.lLastY);
+							key.mouse_pos = Pointf(mouse_pos.x / pixel_ratio, mouse_pos.y / pixel_ratio);
+							key.mouse_device_pos = mouse_pos;
+							set_modifier_keys(key);
+
+							mouse.sig_pointer_raw_move()(key);
+						}
 					}
 					else if (rawinput->header.dwType == RIM_TYPEHID)
 					{
@@ -1620,6 +1632,24 @@ namespace clan
 		create_hid_devices();
 	}
 
+	bool Win32Window::set_raw_mouse_input(bool enable)
+	{
+		if (raw_mouse_input == enable)
+			return true;
+
+		// Legacy WM_MOUSEMOVE messages are still generated, so the regular pointer events keep working
+		RAWINPUTDEVICE device;
+		device.usUsagePage = HID_USAGE_PAGE_GENERIC;
+		device.usUsage = HID_USAGE_GENERIC_MOUSE;
+		device.dwFlags = enable ? 0 : RIDEV_REMOVE;
+		device.hwndTarget = enable ? hwnd : 0;
+		if (RegisterRawInputDevices(&device, 1, sizeof(RAWINPUTDEVICE)) == FALSE)
+			return false;
+
+		raw_mouse_input = enable;
+		return true;
+	}
+
 	void Win32Window::create_hid_devices()
 	{
 		UINT num_devices = 0;
@@ -119,6 +119,7 @@ namespace clan
 		void bring_to_front();
 
 		void capture_mouse(bool capture);
+		bool set_raw_mouse_input(bool enable);
 
 		void set_clipboard_text(const std::string &text);
 		std::string get_clipboard_text() const;
@@ -227,6 +228,7 @@ namespace clan
 		unsigned int update_window_max_region_rects;
 
 		float pixel_ratio = 1.0f;
+		bool raw_mouse_input = false;
 
 		WINDOWPLACEMENT window_positon_before_fullscreen = {};
 		DWORD window_style_before_fullscreen;
@@ -33,9 +33,14 @@
 #include "API/Core/System/thread_local_storage.h"
 #include "display_message_queue_x11.h"
 #include "x11_window.h"
+#include "input_device_provider_x11mouse.h"
 #include "../../setup_display.h"
 #include <algorithm>
 #include <dlfcn.h>
+#include <poll.h>
+#ifdef HAVE_X11_EXTENSIONS_XINPUT2_H
+#include <X11/extensions/XInput2.h>
+#endif
 
 namespace clan
 {
@@ -82,23 +87,36 @@ namespace clan
 
 	void DisplayMessageQueue_X11::add_client(X11Window *window)
 	{
-		this->get_thread_data()->windows_born.push_back(window);
+		this->get_thread_data()->windows.push_back(window);
 	}
 
 	void DisplayMessageQueue_X11::remove_client(X11Window *window)
 	{
-		this->get_thread_data()->windows_died.push_back(window);
+		if (raw_input_window == window)
+			set_raw_input(window, false);
+
+		auto data = get_thread_data();
+		data->windows.erase(std::remove(data->windows.begin(), data->windows.end(), window), data->windows.end());
+
+		for (auto it = data->window_handles.begin(); it != data->window_handles.end();)
+		{
+			if (it->second == window)
+				it = data->window_handles.erase(it);
+			else
+				++it;
+		}
 	}
 
-	DisplayMessageQueue_X11::ThreadDataPtr DisplayMessageQueue_X11::get_thread_data()
+	DisplayMessageQueue_X11::ThreadData *DisplayMessageQueue_X11::get_thread_data()
 	{
-		ThreadDataPtr data = std::dynamic_pointer_cast<ThreadData>(
-				ThreadLocalStorage::get_variable("DisplayMessageQueue_X11::thread_data")
-				);
+		static ThreadLocalSlot<ThreadData> slot("DisplayMessageQueue_X11::thread_data");
+
+		ThreadData *data = slot.get();
 		if (!data)
 		{
-			data = ThreadDataPtr(new ThreadData);
-			ThreadLocalStorage::set_variable("DisplayMessageQueue_X11::thread_data", data);
+			auto new_data = std::make_shared<ThreadData>();
+			data = new_data.get();
+			slot.set(std::move(new_data));
 		}
 		return data;
 	}
@@ -117,9 +135,52 @@ namespace clan
 
 	}
 
+	bool DisplayMessageQueue_X11::set_raw_input(X11Window *window, bool state)
+	{
+#ifdef HAVE_X11_EXTENSIONS_XINPUT2_H
+		::Display *display = get_display();
+
+		if (xinput2_opcode == -1)
+		{
+			int event_base = 0, error_base = 0;
+			int major = 2, minor = 0;
+			if (!XQueryExtension(display, "XInputExtension", &xinput2_opcode, &event_base, &error_base) || XIQueryVersion(display, &major, &minor) != Success)
+			{
+				xinput2_opcode = -1;
+				return false;
+			}
+		}
+
+		if (!state && raw_input_window != window)
+			return true;
+
+		// Raw events can only be selected on the root window. They are reported whatever window has focus.
+		unsigned char mask_bits[XIMaskLen(XI_RawMotion)] = { 0 };
+		if (state)
+			XISetMask(mask_bits, XI_RawMotion);
+
+		XIEventMask mask;
+		mask.deviceid = XIAllMasterDevices;
+		mask.mask_len = sizeof(mask_bits);
+		mask.mask = mask_bits;
+		XISelectEvents(display, DefaultRootWindow(display), &mask, 1);
+		XFlush(display);
+
+		raw_input_window = state ? window : nullptr;
+		return true;
+#else
+		return false;
+#endif
+	}
+
 	void DisplayMessageQueue_X11::run()
 	{
-		process(-1);
+		while (true)
+		{
+			process_message();
+			if (wait_for_events(-1) == WaitResult::exit)
+				break;
+		}
 	}
 
 	void DisplayMessageQueue_X11::exit()
@@ -130,7 +191,6 @@ namespace clan
 	bool DisplayMessageQueue_X11::process(int timeout_ms)
 	{
 		auto time_start = System::get_time();
-		int x11_handle = ConnectionNumber(display);
 
 		while (true)
 		{
@@ -139,45 +199,46 @@ namespace clan
 			auto time_now = System::get_time();
 			int time_remaining_ms = timeout_ms - (time_now - time_start);
 
-			struct timeval tv;
-			if (time_remaining_ms > 0)
-			{
-				tv.tv_sec = time_remaining_ms / 1000;
-				tv.tv_usec = (time_remaining_ms % 1000) * 1000;
-			}
-			else
-			{
-				tv.tv_sec = 0;
-				tv.tv_usec = 0;
-			}
+			WaitResult result = wait_for_events(std::max(time_remaining_ms, 0));
+			if (result == WaitResult::exit)
+				return false;
+			else if (result == WaitResult::timeout)
+				break;
+		}
+		return true;
+	}
 
-			fd_set rfds;
-			FD_ZERO(&rfds);
+	DisplayMessageQueue_X11::WaitResult DisplayMessageQueue_X11::wait_for_events(int timeout_ms)
+	{
+		// poll has no FD_SETSIZE limit, so this keeps working in processes with many open sockets
+		::Display *display = get_display();
+		XFlush(display);
+
+		pollfd fds[3];
+		fds[0].fd = ConnectionNumber(display);
+		fds[1].fd = async_work_event.read_fd();
+		fds[2].fd = exit_event.read_fd();
+		for (auto &fd : fds)
+		{
+			fd.events = POLLIN;
+			fd.revents = 0;
+		}
 
-			FD_SET(x11_handle, &rfds);
-			FD_SET(async_work_event.read_fd(), &rfds);
-			FD_SET(exit_event.read_fd(), &rfds);
+		int result = poll(fds, 3, timeout_ms);
+		if (result <= 0)
+			return WaitResult::timeout;
 
-			int result = select(std::max(std::max(async_work_event.read_fd(), x11_handle), exit_event.read_fd()) + 1, &rfds, nullptr, nullptr, &tv);
-			if (result > 0)
-			{
-				if (FD_ISSET(async_work_event.read_fd(), &rfds))
-				{
-					async_work_event.reset();
-					process_async_work();
-				}
-				if (FD_ISSET(exit_event.read_fd(), &rfds))
-				{
-					exit_event.reset();
-					return false;
-				}
-			}
-			else
-			{
-				break;
-			}
+		if (fds[1].revents & POLLIN)
+		{
+			async_work_event.reset();
+			process_async_work();
 		}
-		return true;
+		if (fds[2].revents & POLLIN)
+		{
+			exit_event.reset();
+			return WaitResult::exit;
+		}
+		return WaitResult::ready;
 	}
 
 	void DisplayMessageQueue_X11::post_async_work_needed()
@@ -190,61 +251,88 @@ namespace clan
 		auto display = get_display();
 		auto data    = get_thread_data();
 
-		XEvent event;
-		while (XPending(display) > 0)
+		// Fetch events in batches instead of calling XPending, which flushes the output buffer, for every event
+		int count = XEventsQueued(display, QueuedAfterFlush);
+		while (count > 0)
 		{
-			XNextEvent(display, &event); // TODO Use XCheckIfEvent to select event based on window?
+			for (int i = 0; i < count; i++)
+			{
+				XEvent event;
+				XNextEvent(display, &event);
 
-			::Window event_target = event.xany.window;
+				if (event.type == GenericEvent)
+				{
+					process_generic_event(event);
+					continue;
+				}
 
-			auto is_target = [&](const X11Window* elem) -> bool
-			{
-				return elem->get_handle().window == event_target;
-			};
+				X11Window *window = find_window(data, event.xany.window);
+				if (!window)
+				{
+#ifdef DEBUG
+					log_event("debug", "DisplayMessageQueue_X11::process_message(): dropping with event with unknown target window.");
+#endif
+					continue;
+				}
 
-			// Skip windows marked as dead.
-			auto dead = std::find_if(data->windows_died.begin(), data->windows_died.end(), is_target);
-			if (dead != data->windows_died.cend())
-				continue;
+				X11Window *mouse_capture_window = (current_mouse_capture_window == nullptr) ? window : current_mouse_capture_window;
 
-			// End loop if window is newborn.
-			auto born = std::find_if(data->windows_born.begin(), data->windows_born.end(), is_target);
-			if (born != data->windows_born.cend())
-			{
-				XPutBackEvent(display, &event);
-				break; // End this loop now so that windows in windows_born gets added to the main list.
+				// Process the event. This may create or destroy windows, which updates the lookup tables directly.
+				window->process_event(event, mouse_capture_window);
 			}
 
-			// Get window from list.
-			auto iter = std::find_if(data->windows.begin(), data->windows.end(), is_target);
-			if (iter == data->windows.end()) // Event not in window list
-#ifndef DEBUG
-				continue;
-#else
+			count = XEventsQueued(display, QueuedAfterReading);
+		}
+	}
+
+	void DisplayMessageQueue_X11::process_generic_event(XEvent &event)
+	{
+#ifdef HAVE_X11_EXTENSIONS_XINPUT2_H
+		if (event.xcookie.extension != xinput2_opcode || !XGetEventData(display, &event.xcookie))
+			return;
+
+		if (event.xcookie.evtype == XI_RawMotion && raw_input_window)
+		{
+			// raw_values holds one entry per set valuator bit. Valuators 0 and 1 are the X and Y axes.
+			XIRawEvent *raw_event = static_cast<XIRawEvent *>(event.xcookie.data);
+			const double *values = raw_event->raw_values;
+			double delta[2] = { 0.0, 0.0 };
+			for (int axis = 0; axis < 2 && axis < raw_event->valuators.mask_len * 8; axis++)
 			{
-				log_event("debug", "DisplayMessageQueue_X11::process_message(): dropping with event with unknown target window.");
-				continue;
+				if (XIMaskIsSet(raw_event->valuators.mask, axis))
+					delta[axis] = *(values++);
 			}
-#endif
-
-			X11Window *window = *iter;
-			X11Window *mouse_capture_window = (current_mouse_capture_window == nullptr) ? window : current_mouse_capture_window;
 
-			// Process the event.
-			window->process_event(event, mouse_capture_window);
+			if (delta[0] != 0.0 || delta[1] != 0.0)
+			{
+				dynamic_cast<InputDeviceProvider_X11Mouse *>(raw_input_window->get_mouse().get_provider())
+					->received_raw_motion(raw_input_window->get_mouse(), delta[0], delta[1]);
+			}
 		}
 
-		// Remove dead windows.
-		for (auto &elem : data->windows_died)
-			std::remove(data->windows.begin(), data->windows.end(), elem);
-		
-		data->windows_died.clear();
+		XFreeEventData(display, &event.xcookie);
+#endif
+	}
 
-		// Insert newborn windows.
-		for (auto &elem : data->windows_born)
-			data->windows.push_back(elem);
+	X11Window *DisplayMessageQueue_X11::find_window(ThreadData *data, ::Window window)
+	{
+		auto it = data->window_handles.find(window);
+		if (it != data->window_handles.end())
+		{
+			// The X11Window may have destroyed and recreated its window since the entry was added
+			if (it->second->get_handle().window == window)
+				return it->second;
+			data->window_handles.erase(it);
+		}
 
-		data->windows_born.clear();
+		for (X11Window *elem : data->windows)
+		{
+			if (elem->get_handle().window == window)
+			{
+				data->window_handles[window] = elem;
+				return elem;
+			}
+		}
+		return nullptr;
 	}
 }
-
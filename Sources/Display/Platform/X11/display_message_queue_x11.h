@@ -31,10 +31,14 @@
 
 #include "Display/System/run_loop_impl.h"
 #include <vector>
+#include <unordered_map>
 #include <X11/Xlib.h>
 #include "API/Core/System/thread_local_storage.h"
 #include <unistd.h>
 #include <fcntl.h>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
 
 namespace clan
 {
@@ -48,13 +52,42 @@ namespace clan
 		public:
 			ThreadData() {}
 			std::vector<X11Window *> windows;
-			std::vector<X11Window *> windows_born;
-			std::vector<X11Window *> windows_died;
+
+			// XID lookup cache. Filled on first event since windows register before their X11 window is created.
+			std::unordered_map<::Window, X11Window *> window_handles;
 		};
 
 		class NotifyEvent
 		{
 		public:
+#ifdef __linux__
+			NotifyEvent()
+			{
+				notify_handle[0] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+				if (notify_handle[0] < 0)
+					throw Exception("Unable to create eventfd handle");
+				notify_handle[1] = notify_handle[0];
+			}
+
+			~NotifyEvent()
+			{
+				::close(notify_handle[0]);
+			}
+
+			int read_fd() const { return notify_handle[0]; }
+
+			void reset()
+			{
+				uint64_t value;
+				while (read(notify_handle[0], &value, sizeof(value)) == sizeof(value));
+			}
+
+			void set()
+			{
+				uint64_t value = 1;
+				::write(notify_handle[1], &value, sizeof(value));
+			}
+#else
 			NotifyEvent()
 			{
 				int result = pipe(notify_handle);
@@ -88,20 +121,19 @@ namespace clan
 			{
 				::write(notify_handle[1], "x", 1);
 			}
+#endif
 
 		private:
 			int notify_handle[2];
 		};
 
 	public:
-		using ThreadDataPtr = std::shared_ptr<ThreadData>;
-
 		DisplayMessageQueue_X11();
 		~DisplayMessageQueue_X11();
 
 		::Display *get_display();
 
-		ThreadDataPtr get_thread_data();
+		ThreadData *get_thread_data();
 
 		void    add_client(X11Window *window);
 		void remove_client(X11Window *window);
@@ -109,6 +141,9 @@ namespace clan
 
 		void set_mouse_capture(X11Window *window, bool state);
 
+		/// \brief Routes XInput2 raw motion to the mouse of the window. Returns false if XInput2 is not available.
+		bool set_raw_input(X11Window *window, bool state);
+
 		// The library will be opened / closed by this class
 		// Returns 0 if the library could not be found
 		// Currently, only supports a single library
@@ -120,10 +155,21 @@ namespace clan
 		void post_async_work_needed() override;
 
 	private:
+		enum class WaitResult
+		{
+			timeout,
+			ready,
+			exit
+		};
+
 		void process_message();
-		void prune_clients();
+		WaitResult wait_for_events(int timeout_ms);
+		X11Window *find_window(ThreadData *data, ::Window window);
+		void process_generic_event(XEvent &event);
 
 		X11Window *current_mouse_capture_window = nullptr;
+		X11Window *raw_input_window = nullptr;
+		int xinput2_opcode = -1;
 		::Display *display = nullptr;
 		void *dlopen_lib_handle = nullptr;
 
@@ -29,22 +29,23 @@
 #include "Display/precomp.h"
 #include "font_config.h"
 #include "API/Core/IOData/iodevice.h"
+#include "API/Core/IOData/directory.h"
+#include "API/Core/IOData/file.h"
+#include "API/Core/IOData/file_help.h"
+#include "API/Core/IOData/path_help.h"
 #include "API/Core/System/databuffer.h"
+#include "API/Core/Text/string_help.h"
 #include "API/Display/Font/font_description.h"
+#include <algorithm>
 #include <cmath>
+#include <cstdlib>
 
 namespace clan
 {
 	FontConfig::FontConfig()
 	{
-		if (!fc_config)
-		{
-			fc_config = FcInitLoadConfigAndFonts();
-		}
-		if (!fc_config)
-		{
-			throw Exception("CL_FontConfig: Initializing FontConfig library failed.");
-		}
+		// Loading the configuration scans every installed font, so it is started here and only waited for when a match is needed
+		fc_config = std::async(std::launch::async, []() { return FcInitLoadConfigAndFonts(); }).share();
 	}
 
 	FontConfig::~FontConfig()
@@ -60,6 +61,40 @@ namespace clan
 
 	std::string FontConfig::match_font(const std::string &typeface_name, const FontDescription &desc) const
 	{
+		std::string key = get_match_key(typeface_name, desc);
+
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			if (!match_cache_loaded)
+				load_match_cache();
+
+			auto it = matches.find(key);
+			if (it != matches.end() && FileHelp::file_exists(it->second))
+				return it->second;
+		}
+
+		std::string font_file_path = find_font(typeface_name, desc);
+
+		std::unique_lock<std::mutex> lock(mutex);
+		matches[key] = font_file_path;
+		save_match_cache();
+		return font_file_path;
+	}
+
+	FcConfig *FontConfig::get_config() const
+	{
+		FcConfig *config = fc_config.get();
+		if (!config)
+		{
+			throw Exception("CL_FontConfig: Initializing FontConfig library failed.");
+		}
+		return config;
+	}
+
+	std::string FontConfig::find_font(const std::string &typeface_name, const FontDescription &desc) const
+	{
+		FcConfig *config = get_config();
+
 		FcPattern * fc_pattern = nullptr;
 		FcPattern * fc_match = nullptr;
 		try
@@ -81,7 +116,7 @@ namespace clan
 			}
 
 			// Execute any needed param substitutions required by the system config.
-			if (FcTrue != FcConfigSubstitute(fc_config, fc_pattern, FcMatchPattern))
+			if (FcTrue != FcConfigSubstitute(config, fc_pattern, FcMatchPattern))
 			{
 				throw Exception("CL_FontConfig: Font config substitutions failed.");
 			}
@@ -91,7 +126,7 @@ namespace clan
 
 			// Find best match for pattern and extract filename.
 			FcResult match_result; // Doesn't appear to be actually updated.
-			fc_match = FcFontMatch(fc_config, fc_pattern, &match_result);
+			fc_match = FcFontMatch(config, fc_pattern, &match_result);
 			FcChar8 * fc_font_file_path = nullptr;
 			if (FcResultMatch != FcPatternGetString(fc_match, FC_FILE, 0, &fc_font_file_path))
 			{
@@ -112,4 +147,104 @@ namespace clan
 			throw;
 		}
 	}
+
+	void FontConfig::load_match_cache() const
+	{
+		match_cache_loaded = true;
+
+		std::string filename = get_match_cache_filename();
+		if (filename.empty() || !FileHelp::file_exists(filename))
+			return;
+
+		try
+		{
+			std::vector<std::string> lines = StringHelp::split_text(File::read_text(filename), "\n");
+			if (lines.empty() || lines[0] != get_match_cache_stamp())
+				return;
+
+			for (size_t i = 1; i < lines.size(); i++)
+			{
+				std::string::size_type separator = lines[i].find('\t');
+				if (separator != std::string::npos)
+					matches[lines[i].substr(0, separator)] = lines[i].substr(separator + 1);
+			}
+		}
+		catch (const Exception &)
+		{
+			// The cache is only an optimization. Start over with an empty one.
+			matches.clear();
+		}
+	}
+
+	void FontConfig::save_match_cache() const
+	{
+		std::string filename = get_match_cache_filename();
+		if (filename.empty())
+			return;
+
+		try
+		{
+			std::string text = get_match_cache_stamp();
+			text += "\n";
+			for (const auto &match : matches)
+			{
+				text += match.first;
+				text += "\t";
+				text += match.second;
+				text += "\n";
+			}
+
+			Directory::create(PathHelp::get_fullpath(filename, PathHelp::path_type_file), true);
+			File::write_text(filename, text);
+		}
+		catch (const Exception &)
+		{
+			// The cache is only an optimization. Errors writing it are ignored.
+		}
+	}
+
+	std::string FontConfig::get_match_key(const std::string &typeface_name, const FontDescription &desc)
+	{
+		// The pixel size is part of the fontconfig pattern, so it can change the match for bitmap fonts
+		std::string key = typeface_name;
+		std::replace(key.begin(), key.end(), '\t', ' ');
+		std::replace(key.begin(), key.end(), '\n', ' ');
+		key += "/" + StringHelp::int_to_text(static_cast<int>(desc.get_weight()));
+		key += "/" + StringHelp::int_to_text(static_cast<int>(desc.get_style()));
+		key += "/" + StringHelp::float_to_text(std::abs(desc.get_height()));
+		return key;
+	}
+
+	std::string FontConfig::get_match_cache_filename()
+	{
+		const char *cache_home = getenv("XDG_CACHE_HOME");
+		if (cache_home && cache_home[0])
+			return std::string(cache_home) + "/clanlib/fontconfig_matches";
+
+		const char *home = getenv("HOME");
+		if (home && home[0])
+			return std::string(home) + "/.cache/clanlib/fontconfig_matches";
+
+		return std::string();
+	}
+
+	std::string FontConfig::get_match_cache_stamp()
+	{
+		// Fontconfig rewrites its cache files when fonts are installed or removed, which updates the cache directories.
+		// The stamp is taken from them and the configuration directories, so it can be checked without loading fontconfig.
+		std::vector<std::string> paths = { "/etc/fonts", "/etc/fonts/conf.d", "/var/cache/fontconfig" };
+
+		const char *cache_home = getenv("XDG_CACHE_HOME");
+		const char *home = getenv("HOME");
+		if (cache_home && cache_home[0])
+			paths.push_back(std::string(cache_home) + "/fontconfig");
+		else if (home && home[0])
+			paths.push_back(std::string(home) + "/.cache/fontconfig");
+
+		uint64_t stamp = 0;
+		for (const auto &path : paths)
+			stamp = std::max(stamp, FileHelp::get_last_write_time(path));
+
+		return "fontconfig-matches " + StringHelp::ull_to_text(stamp);
+	}
 }
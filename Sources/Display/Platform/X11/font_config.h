@@ -31,11 +31,18 @@
 #ifndef __APPLE__
 #include "fontconfig/fontconfig.h"
 #endif
+#include <future>
+#include <map>
+#include <mutex>
 
 namespace clan
 {
 	class FontDescription;
 
+	/// \brief Resolves typefaces to font files using fontconfig
+	///
+	/// Fontconfig is loaded on a background thread when the instance is created. Matches are remembered in memory and
+	/// in a file in the user's cache directory, which is discarded when the fontconfig caches or configuration change.
 	class FontConfig
 	{
 	public:
@@ -50,7 +57,20 @@ namespace clan
 
 	private:
 #ifndef __APPLE__
-		FcConfig * fc_config;
+		FcConfig *get_config() const;
+		std::string find_font(const std::string &typeface_name, const FontDescription &desc) const;
+		void load_match_cache() const;
+		void save_match_cache() const;
+
+		static std::string get_match_key(const std::string &typeface_name, const FontDescription &desc);
+		static std::string get_match_cache_filename();
+		static std::string get_match_cache_stamp();
+
+		std::shared_future<FcConfig *> fc_config;
+
+		mutable std::mutex mutex;
+		mutable std::map<std::string, std::string> matches;
+		mutable bool match_cache_loaded = false;
 #endif
 	};
 }
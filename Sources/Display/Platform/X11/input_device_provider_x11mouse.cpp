@@ -33,6 +33,8 @@
 #include "API/Display/Window/input_event.h"
 #include "API/Display/Window/keys.h"
 #include "x11_window.h"
+#include "display_message_queue_x11.h"
+#include "../../setup_display.h"
 
 namespace clan
 {
@@ -124,6 +126,11 @@ namespace clan
 		XWarpPointer(window->get_handle().display, None, window->get_handle().window, 0, 0, 0, 0, x, y);
 	}
 
+	bool InputDeviceProvider_X11Mouse::set_raw_input(bool enable)
+	{
+		return SetupDisplay::get_message_queue()->set_raw_input(window, enable);
+	}
+
 	void InputDeviceProvider_X11Mouse::received_mouse_input(InputDevice &mouse, XButtonEvent &event)
 	{
 		int id;
@@ -219,4 +226,16 @@ namespace clan
 			mouse.sig_pointer_move()(key);
 		}
 	}
+
+	void InputDeviceProvider_X11Mouse::received_raw_motion(InputDevice &mouse, double delta_x, double delta_y)
+	{
+		InputEvent key;
+		key.type = InputEvent::pointer_raw_moved;
+		key.raw_delta = Pointf((float)delta_x, (float)delta_y);
+		key.mouse_pos = Pointf(mouse_pos) / window->get_pixel_ratio();
+		key.mouse_device_pos = mouse_pos;
+		window->get_keyboard_modifiers(key.shift, key.alt, key.ctrl);
+
+		mouse.sig_pointer_raw_move()(key);
+	}
 }
@@ -57,9 +57,11 @@ namespace clan
 
 		void set_position(float x, float y) override;
 		void set_device_position(int x, int y) override;
+		bool set_raw_input(bool enable) override;
 
 		void received_mouse_input(InputDevice &mouse, XButtonEvent &event);
 		void received_mouse_move(InputDevice &mouse, XMotionEvent &event);
+		void received_raw_motion(InputDevice &mouse, double delta_x, double delta_y);
 
 	private:
 		void on_dispose() override;
@@ -0,0 +1,154 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Display/precomp.h"
+#include "API/Display/Render/async_readback.h"
+#include "API/Display/Render/graphic_context.h"
+#include "API/Display/Render/transfer_texture.h"
+#include "API/Display/TargetProviders/graphic_context_provider.h"
+#include "API/Display/TargetProviders/fence_provider.h"
+#include "API/Core/System/exception.h"
+#include <deque>
+#include <cstring>
+
+namespace clan
+{
+	class AsyncReadback_Impl
+	{
+	public:
+		struct Request
+		{
+			TransferTexture buffer;
+			std::unique_ptr<FenceProvider> fence;
+			std::function<void(PixelBuffer &)> callback;
+		};
+
+		TransferTexture acquire_buffer(GraphicContext &gc, const Size &size, TextureFormat texture_format)
+		{
+			for (size_t i = 0; i < free_buffers.size(); i++)
+			{
+				if (free_buffers[i].get_size() == size && free_buffers[i].get_format() == texture_format)
+				{
+					TransferTexture buffer = free_buffers[i];
+					free_buffers.erase(free_buffers.begin() + i);
+					return buffer;
+				}
+			}
+			return TransferTexture(gc, size.width, size.height, data_from_gpu, texture_format, nullptr, usage_stream_read);
+		}
+
+		void complete(GraphicContext &gc, Request &request)
+		{
+			// Copy row by row as the mapped pitch of the transfer texture may be padded
+			PixelBuffer pixels(request.buffer.get_width(), request.buffer.get_height(), request.buffer.get_format());
+			request.buffer.lock(gc, access_read_only);
+			const char *src = static_cast<const char *>(request.buffer.get_data());
+			char *dest = static_cast<char *>(pixels.get_data());
+			int row_size = std::min(pixels.get_pitch(), request.buffer.get_pitch());
+			for (int y = 0; y < pixels.get_height(); y++)
+				memcpy(dest + y * pixels.get_pitch(), src + y * request.buffer.get_pitch(), row_size);
+			request.buffer.unlock();
+
+			if (gc.get_texture_image_y_axis() == y_axis_bottom_up)
+				pixels.flip_vertical();
+
+			if (free_buffers.size() < (size_t)max_pending)
+				free_buffers.push_back(request.buffer);
+
+			request.callback(pixels);
+		}
+
+		int max_pending = 3;
+		std::deque<Request> pending;
+		std::vector<TransferTexture> free_buffers;
+	};
+
+	AsyncReadback::AsyncReadback()
+	{
+	}
+
+	AsyncReadback::AsyncReadback(GraphicContext &gc, int max_pending)
+		: impl(std::make_shared<AsyncReadback_Impl>())
+	{
+		impl->max_pending = max(max_pending, 1);
+	}
+
+	void AsyncReadback::throw_if_null() const
+	{
+		if (!impl)
+			throw Exception("AsyncReadback is null");
+	}
+
+	int AsyncReadback::get_pending_count() const
+	{
+		return (int)impl->pending.size();
+	}
+
+	void AsyncReadback::read_pixels(GraphicContext &gc, const Rect &rect, TextureFormat texture_format, const std::function<void(PixelBuffer &)> &callback)
+	{
+		while (impl->pending.size() >= (size_t)impl->max_pending)
+		{
+			AsyncReadback_Impl::Request request = std::move(impl->pending.front());
+			impl->pending.pop_front();
+			request.fence->wait();
+			impl->complete(gc, request);
+		}
+
+		AsyncReadback_Impl::Request request;
+		request.buffer = impl->acquire_buffer(gc, rect.get_size(), texture_format);
+		request.callback = callback;
+		gc.get_provider()->read_pixels(rect, request.buffer.get_provider());
+		request.fence.reset(gc.get_provider()->alloc_fence());
+		request.fence->insert();
+		impl->pending.push_back(std::move(request));
+	}
+
+	int AsyncReadback::poll(GraphicContext &gc)
+	{
+		int completed = 0;
+		while (!impl->pending.empty() && impl->pending.front().fence->is_signaled())
+		{
+			AsyncReadback_Impl::Request request = std::move(impl->pending.front());
+			impl->pending.pop_front();
+			impl->complete(gc, request);
+			completed++;
+		}
+		return completed;
+	}
+
+	void AsyncReadback::finish(GraphicContext &gc)
+	{
+		while (!impl->pending.empty())
+		{
+			AsyncReadback_Impl::Request request = std::move(impl->pending.front());
+			impl->pending.pop_front();
+			request.fence->wait();
+			impl->complete(gc, request);
+		}
+	}
+}
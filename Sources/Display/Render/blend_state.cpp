@@ -28,6 +28,7 @@
 
 #include "Display/precomp.h"
 #include "API/Display/Render/blend_state.h"
+#include "API/Display/Render/blend_state_description.h"
 #include "API/Display/Render/graphic_context.h"
 #include "API/Display/TargetProviders/graphic_context_provider.h"
 
@@ -38,7 +39,7 @@ namespace clan
 	}
 
 	BlendState::BlendState(GraphicContext &context, const BlendStateDescription &desc)
-		: provider(context.get_provider()->create_blend_state(desc))
+		: provider(context.get_provider()->create_blend_state(desc)), description(std::make_shared<BlendStateDescription>(desc.clone()))
 	{
 	}
 
@@ -46,4 +47,9 @@ namespace clan
 	{
 		return provider.get();
 	}
+
+	BlendStateDescription BlendState::get_description() const
+	{
+		return description ? description->clone() : BlendStateDescription();
+	}
 }
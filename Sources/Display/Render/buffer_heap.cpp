@@ -0,0 +1,158 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Display/precomp.h"
+#include "API/Display/Render/buffer_heap.h"
+#include "API/Core/System/exception.h"
+#include <map>
+
+namespace clan
+{
+	class BufferHeap_Impl
+	{
+	public:
+		int align(int value) const { return (value + alignment - 1) / alignment * alignment; }
+
+		int size = 0;
+		int alignment = 16;
+		int free_size = 0;
+		std::map<int, int> free_blocks;	// Offset to size of each free block, neighbouring blocks are always merged
+	};
+
+	BufferHeap::BufferHeap()
+	{
+	}
+
+	BufferHeap::BufferHeap(int size, int alignment)
+		: impl(std::make_shared<BufferHeap_Impl>())
+	{
+		if (alignment <= 0 || size < alignment)
+			throw Exception("Invalid buffer heap size");
+
+		// A partial block at the end could never hold an aligned allocation
+		impl->size = size / alignment * alignment;
+		impl->alignment = alignment;
+		clear();
+	}
+
+	void BufferHeap::throw_if_null() const
+	{
+		if (!impl)
+			throw Exception("BufferHeap is null");
+	}
+
+	int BufferHeap::get_size() const
+	{
+		return impl->size;
+	}
+
+	int BufferHeap::get_alignment() const
+	{
+		return impl->alignment;
+	}
+
+	int BufferHeap::get_free_size() const
+	{
+		return impl->free_size;
+	}
+
+	int BufferHeap::get_largest_free_block() const
+	{
+		int largest = 0;
+		for (const auto &block : impl->free_blocks)
+			largest = std::max(largest, block.second);
+		return largest;
+	}
+
+	BufferRange BufferHeap::allocate(int size)
+	{
+		if (size <= 0)
+			return BufferRange();
+
+		int aligned_size = impl->align(size);
+
+		auto best = impl->free_blocks.end();
+		for (auto it = impl->free_blocks.begin(); it != impl->free_blocks.end(); ++it)
+		{
+			if (it->second >= aligned_size && (best == impl->free_blocks.end() || it->second < best->second))
+			{
+				best = it;
+				if (best->second == aligned_size)
+					break;
+			}
+		}
+
+		if (best == impl->free_blocks.end())
+			return BufferRange();
+
+		int offset = best->first;
+		int remaining = best->second - aligned_size;
+		impl->free_blocks.erase(best);
+		if (remaining > 0)
+			impl->free_blocks[offset + aligned_size] = remaining;
+		impl->free_size -= aligned_size;
+
+		return BufferRange(offset, size);
+	}
+
+	void BufferHeap::free(const BufferRange &range)
+	{
+		if (range.is_null())
+			return;
+
+		int offset = range.offset;
+		int size = impl->align(range.size);
+		impl->free_size += size;
+
+		auto next = impl->free_blocks.lower_bound(offset);
+		if (next != impl->free_blocks.end() && next->first == offset + size)
+		{
+			size += next->second;
+			next = impl->free_blocks.erase(next);
+		}
+
+		if (next != impl->free_blocks.begin())
+		{
+			auto prev = std::prev(next);
+			if (prev->first + prev->second == offset)
+			{
+				prev->second += size;
+				return;
+			}
+		}
+
+		impl->free_blocks[offset] = size;
+	}
+
+	void BufferHeap::clear()
+	{
+		impl->free_blocks.clear();
+		impl->free_blocks[0] = impl->size;
+		impl->free_size = impl->size;
+	}
+}
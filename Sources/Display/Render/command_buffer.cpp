@@ -0,0 +1,261 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Display/precomp.h"
+#include "API/Display/Render/command_buffer.h"
+#include "API/Display/Render/frame_buffer.h"
+#include "API/Display/Render/uniform_buffer.h"
+#include "API/Display/Render/storage_buffer.h"
+#include "API/Display/Render/texture.h"
+#include "API/Display/Render/rasterizer_state.h"
+#include "API/Display/Render/blend_state.h"
+#include "API/Display/Render/depth_stencil_state.h"
+#include "API/Display/Render/program_object.h"
+#include "API/Display/Render/primitives_array.h"
+#include "API/Display/Render/element_array_buffer.h"
+
+namespace clan
+{
+	class CommandBuffer_Impl
+	{
+	public:
+		std::vector<std::function<void(GraphicContext &)>> commands;
+	};
+
+	CommandBuffer::CommandBuffer()
+		: impl(std::make_shared<CommandBuffer_Impl>())
+	{
+	}
+
+	bool CommandBuffer::is_empty() const
+	{
+		return impl->commands.empty();
+	}
+
+	size_t CommandBuffer::get_size() const
+	{
+		return impl->commands.size();
+	}
+
+	void CommandBuffer::clear_commands()
+	{
+		impl->commands.clear();
+	}
+
+	void CommandBuffer::reserve(size_t size)
+	{
+		impl->commands.reserve(size);
+	}
+
+	void CommandBuffer::record(const std::function<void(GraphicContext &)> &command)
+	{
+		impl->commands.push_back(command);
+	}
+
+	void CommandBuffer::append(const CommandBuffer &commands)
+	{
+		impl->commands.insert(impl->commands.end(), commands.impl->commands.begin(), commands.impl->commands.end());
+	}
+
+	void CommandBuffer::execute(GraphicContext &gc) const
+	{
+		for (const auto &command : impl->commands)
+			command(gc);
+	}
+
+	void CommandBuffer::set_frame_buffer(const FrameBuffer &write_buffer)
+	{
+		record([=](GraphicContext &gc) { gc.set_frame_buffer(write_buffer); });
+	}
+
+	void CommandBuffer::reset_frame_buffer()
+	{
+		record([](GraphicContext &gc) { gc.reset_frame_buffer(); });
+	}
+
+	void CommandBuffer::set_uniform_buffer(int index, const UniformBuffer &buffer)
+	{
+		record([=](GraphicContext &gc) { gc.set_uniform_buffer(index, buffer); });
+	}
+
+	void CommandBuffer::set_uniform_buffer(int index, const UniformBuffer &buffer, int offset, int size)
+	{
+		record([=](GraphicContext &gc) { gc.set_uniform_buffer(index, buffer, offset, size); });
+	}
+
+	void CommandBuffer::reset_uniform_buffer(int index)
+	{
+		record([=](GraphicContext &gc) { gc.reset_uniform_buffer(index); });
+	}
+
+	void CommandBuffer::set_storage_buffer(int index, const StorageBuffer &buffer)
+	{
+		record([=](GraphicContext &gc) { gc.set_storage_buffer(index, buffer); });
+	}
+
+	void CommandBuffer::reset_storage_buffer(int index)
+	{
+		record([=](GraphicContext &gc) { gc.reset_storage_buffer(index); });
+	}
+
+	void CommandBuffer::set_texture(int unit_index, const Texture &texture)
+	{
+		record([=](GraphicContext &gc) { gc.set_texture(unit_index, texture); });
+	}
+
+	void CommandBuffer::reset_texture(int unit_index)
+	{
+		record([=](GraphicContext &gc) { gc.reset_texture(unit_index); });
+	}
+
+	void CommandBuffer::set_rasterizer_state(const RasterizerState &state)
+	{
+		record([=](GraphicContext &gc) { gc.set_rasterizer_state(state); });
+	}
+
+	void CommandBuffer::set_blend_state(const BlendState &state, const Colorf &blend_color, unsigned int sample_mask)
+	{
+		record([=](GraphicContext &gc) { gc.set_blend_state(state, blend_color, sample_mask); });
+	}
+
+	void CommandBuffer::set_depth_stencil_state(const DepthStencilState &state, int stencil_ref)
+	{
+		record([=](GraphicContext &gc) { gc.set_depth_stencil_state(state, stencil_ref); });
+	}
+
+	void CommandBuffer::reset_rasterizer_state()
+	{
+		record([](GraphicContext &gc) { gc.reset_rasterizer_state(); });
+	}
+
+	void CommandBuffer::reset_blend_state()
+	{
+		record([](GraphicContext &gc) { gc.reset_blend_state(); });
+	}
+
+	void CommandBuffer::reset_depth_stencil_state()
+	{
+		record([](GraphicContext &gc) { gc.reset_depth_stencil_state(); });
+	}
+
+	void CommandBuffer::set_program_object(const ProgramObject &program)
+	{
+		record([=](GraphicContext &gc) { gc.set_program_object(program); });
+	}
+
+	void CommandBuffer::reset_program_object()
+	{
+		record([](GraphicContext &gc) { gc.reset_program_object(); });
+	}
+
+	void CommandBuffer::set_primitives_array(const PrimitivesArray &array)
+	{
+		record([=](GraphicContext &gc) { gc.set_primitives_array(array); });
+	}
+
+	void CommandBuffer::reset_primitives_array()
+	{
+		record([](GraphicContext &gc) { gc.reset_primitives_array(); });
+	}
+
+	void CommandBuffer::set_primitives_elements(const ElementArrayBuffer &element_array)
+	{
+		ElementArrayBuffer buffer = element_array;
+		record([=](GraphicContext &gc) mutable { gc.set_primitives_elements(buffer); });
+	}
+
+	void CommandBuffer::reset_primitives_elements()
+	{
+		record([](GraphicContext &gc) { gc.reset_primitives_elements(); });
+	}
+
+	void CommandBuffer::set_scissor(const Rect &rect, TextureImageYAxis y_axis)
+	{
+		record([=](GraphicContext &gc) { gc.set_scissor(rect, y_axis); });
+	}
+
+	void CommandBuffer::reset_scissor()
+	{
+		record([](GraphicContext &gc) { gc.reset_scissor(); });
+	}
+
+	void CommandBuffer::set_viewport(const Rectf &viewport)
+	{
+		record([=](GraphicContext &gc) { gc.set_viewport(viewport); });
+	}
+
+	void CommandBuffer::draw_primitives_array(PrimitivesType type, int offset, int num_vertices)
+	{
+		record([=](GraphicContext &gc) { gc.draw_primitives_array(type, offset, num_vertices); });
+	}
+
+	void CommandBuffer::draw_primitives_array_instanced(PrimitivesType type, int offset, int num_vertices, int instance_count)
+	{
+		record([=](GraphicContext &gc) { gc.draw_primitives_array_instanced(type, offset, num_vertices, instance_count); });
+	}
+
+	void CommandBuffer::draw_primitives_array_indirect(PrimitivesType type, const StorageBuffer &commands, size_t offset, int draw_count, int stride)
+	{
+		record([=](GraphicContext &gc) { gc.draw_primitives_array_indirect(type, commands, offset, draw_count, stride); });
+	}
+
+	void CommandBuffer::draw_primitives_elements(PrimitivesType type, int count, VertexAttributeDataType indices_type, size_t offset)
+	{
+		record([=](GraphicContext &gc) { gc.draw_primitives_elements(type, count, indices_type, offset); });
+	}
+
+	void CommandBuffer::draw_primitives_elements_instanced(PrimitivesType type, int count, VertexAttributeDataType indices_type, size_t offset, int instance_count)
+	{
+		record([=](GraphicContext &gc) { gc.draw_primitives_elements_instanced(type, count, indices_type, offset, instance_count); });
+	}
+
+	void CommandBuffer::draw_primitives_elements_indirect(PrimitivesType type, VertexAttributeDataType indices_type, const StorageBuffer &commands, size_t offset, int draw_count, int stride)
+	{
+		record([=](GraphicContext &gc) { gc.draw_primitives_elements_indirect(type, indices_type, commands, offset, draw_count, stride); });
+	}
+
+	void CommandBuffer::dispatch(int x, int y, int z)
+	{
+		record([=](GraphicContext &gc) { gc.dispatch(x, y, z); });
+	}
+
+	void CommandBuffer::clear(const Colorf &color)
+	{
+		record([=](GraphicContext &gc) { gc.clear(color); });
+	}
+
+	void CommandBuffer::clear_depth(float value)
+	{
+		record([=](GraphicContext &gc) { gc.clear_depth(value); });
+	}
+
+	void CommandBuffer::clear_stencil(int value)
+	{
+		record([=](GraphicContext &gc) { gc.clear_stencil(value); });
+	}
+}
@@ -28,6 +28,7 @@
 
 #include "Display/precomp.h"
 #include "API/Display/Render/depth_stencil_state.h"
+#include "API/Display/Render/depth_stencil_state_description.h"
 #include "API/Display/Render/graphic_context.h"
 #include "API/Display/TargetProviders/graphic_context_provider.h"
 
@@ -38,7 +39,7 @@ namespace clan
 	}
 
 	DepthStencilState::DepthStencilState(GraphicContext &context, const DepthStencilStateDescription &desc)
-		: provider(context.get_provider()->create_depth_stencil_state(desc))
+		: provider(context.get_provider()->create_depth_stencil_state(desc)), description(std::make_shared<DepthStencilStateDescription>(desc.clone()))
 	{
 	}
 
@@ -46,4 +47,9 @@ namespace clan
 	{
 		return provider.get();
 	}
+
+	DepthStencilStateDescription DepthStencilState::get_description() const
+	{
+		return description ? description->clone() : DepthStencilStateDescription();
+	}
 }
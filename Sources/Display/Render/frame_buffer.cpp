@@ -208,4 +208,19 @@ namespace clan
 	{
 		impl->provider->set_bind_target(target);
 	}
+
+	void FrameBuffer::set_load_action(FrameBufferLoadAction action, int attachments)
+	{
+		impl->provider->set_load_action(action, attachments);
+	}
+
+	void FrameBuffer::set_store_action(FrameBufferStoreAction action, int attachments)
+	{
+		impl->provider->set_store_action(action, attachments);
+	}
+
+	void FrameBuffer::invalidate_attachments(int attachments)
+	{
+		impl->provider->invalidate_attachments(attachments);
+	}
 }
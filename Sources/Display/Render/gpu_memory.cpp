@@ -0,0 +1,139 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Display/precomp.h"
+#include "API/Display/Render/gpu_memory.h"
+#include "API/Display/Image/pixel_buffer.h"
+#include "API/Core/System/allocation_tracker.h"
+#include <mutex>
+
+namespace clan
+{
+	namespace
+	{
+		struct GPUMemoryState
+		{
+			std::mutex mutex;
+			GPUMemoryStats stats;
+			size_t total = 0;
+			size_t budget = 0;
+			std::function<void(const GPUMemoryStats &)> over_budget_callback;
+		};
+
+		GPUMemoryState &get_state()
+		{
+			static GPUMemoryState state;
+			return state;
+		}
+	}
+
+	size_t GPUMemoryStats::get_total_bytes() const
+	{
+		size_t total = 0;
+		for (size_t bytes_in_category : bytes)
+			total += bytes_in_category;
+		return total;
+	}
+
+	GPUMemoryStats GPUMemoryTracker::get_stats()
+	{
+		GPUMemoryState &state = get_state();
+		std::unique_lock<std::mutex> lock(state.mutex);
+		return state.stats;
+	}
+
+	void GPUMemoryTracker::set_budget(size_t bytes, const std::function<void(const GPUMemoryStats &)> &over_budget_callback)
+	{
+		GPUMemoryState &state = get_state();
+		std::unique_lock<std::mutex> lock(state.mutex);
+		state.budget = bytes;
+		state.over_budget_callback = over_budget_callback;
+	}
+
+	size_t GPUMemoryTracker::get_budget()
+	{
+		GPUMemoryState &state = get_state();
+		std::unique_lock<std::mutex> lock(state.mutex);
+		return state.budget;
+	}
+
+	void GPUMemoryTracker::allocate(GPUMemoryCategory category, size_t bytes)
+	{
+		AllocationTracker::allocate(allocation_tag_gpu, nullptr, bytes);
+
+		GPUMemoryState &state = get_state();
+		std::unique_lock<std::mutex> lock(state.mutex);
+		bool was_within_budget = state.total <= state.budget;
+		state.stats.bytes[category] += bytes;
+		state.stats.allocations[category]++;
+		state.total += bytes;
+
+		if (state.budget != 0 && was_within_budget && state.total > state.budget && state.over_budget_callback)
+		{
+			// Run the callback unlocked so it can free memory
+			std::function<void(const GPUMemoryStats &)> callback = state.over_budget_callback;
+			GPUMemoryStats stats = state.stats;
+			lock.unlock();
+			callback(stats);
+		}
+	}
+
+	void GPUMemoryTracker::free(GPUMemoryCategory category, size_t bytes)
+	{
+		AllocationTracker::free(allocation_tag_gpu, nullptr, bytes);
+
+		GPUMemoryState &state = get_state();
+		std::unique_lock<std::mutex> lock(state.mutex);
+		state.stats.bytes[category] -= bytes;
+		state.stats.allocations[category]--;
+		state.total -= bytes;
+	}
+
+	size_t GPUMemoryTracker::get_texture_size(TextureFormat texture_format, int width, int height, int depth, int array_size, int levels, int samples)
+	{
+		if (levels <= 0)
+		{
+			levels = 1;
+			for (int size = max(max(width, height), depth); size > 1; size /= 2)
+				levels++;
+		}
+
+		size_t total = 0;
+		for (int level = 0; level < levels; level++)
+		{
+			int mip_width = max(width >> level, 1);
+			int mip_height = max(height >> level, 1);
+			int mip_depth = max(depth >> level, 1);
+			if (PixelBuffer::is_compressed(texture_format))
+				total += (size_t)((mip_width + 3) / 4) * ((mip_height + 3) / 4) * PixelBuffer::get_bytes_per_block(texture_format) * mip_depth;
+			else
+				total += (size_t)mip_width * mip_height * mip_depth * PixelBuffer::get_bytes_per_pixel(texture_format);
+		}
+		return total * max(array_size, 1) * max(samples, 1);
+	}
+}
@@ -41,6 +41,7 @@
 #include "API/Core/Math/angle.h"
 #include "primitives_array_impl.h"
 #include "graphic_context_impl.h"
+#include "graphic_context_capture_impl.h"
 #include "API/Display/Render/shared_gc_data.h"
 #include "API/Display/Render/depth_stencil_state_description.h"
 #include "API/Display/Render/blend_state_description.h"
@@ -118,6 +119,11 @@ namespace clan
 		return get_provider()->get_shader_language();
 	}
 
+	GPUMemoryStats GraphicContext::get_memory_stats() const
+	{
+		return GPUMemoryTracker::get_stats();
+	}
+
 	int GraphicContext::get_major_version() const
 	{
 		return get_provider()->get_major_version();
@@ -133,6 +139,11 @@ namespace clan
 		return get_provider()->has_compute_shader_support();
 	}
 
+	bool GraphicContext::is_compressed_format_supported(TextureFormat format) const
+	{
+		return get_provider()->is_compressed_format_supported(format);
+	}
+
 	Texture GraphicContext::get_texture(int unit) const
 	{
 		if ((unit < 0) || (unit >= impl->textures.size()))
@@ -188,6 +199,11 @@ namespace clan
 		return impl->graphic_screen->get_provider()->get_max_texture_size();
 	}
 
+	int GraphicContext::get_uniform_buffer_alignment() const
+	{
+		return impl->graphic_screen->get_provider()->get_uniform_buffer_alignment();
+	}
+
 	GraphicContextProvider *GraphicContext::get_provider()
 	{
 		if (impl)
@@ -228,13 +244,18 @@ namespace clan
 
 	void GraphicContext::set_uniform_buffer(int index, const UniformBuffer &buffer)
 	{
-		impl->set_uniform_buffer(index, buffer);
+		impl->set_uniform_buffer(index, buffer, 0, 0);
+	}
+
+	void GraphicContext::set_uniform_buffer(int index, const UniformBuffer &buffer, int offset, int size)
+	{
+		impl->set_uniform_buffer(index, buffer, offset, size);
 	}
 
 	void GraphicContext::reset_uniform_buffer(int index)
 	{
 		UniformBuffer null_buffer;
-		impl->set_uniform_buffer(index, null_buffer);
+		impl->set_uniform_buffer(index, null_buffer, 0, 0);
 	}
 
 	void GraphicContext::set_storage_buffer(int index, const StorageBuffer &buffer)
@@ -344,6 +365,11 @@ namespace clan
 		impl->reset_program_object();
 	}
 
+	void GraphicContext::set_pipeline_state(const PipelineState &pipeline)
+	{
+		impl->set_pipeline_state(pipeline);
+	}
+
 	bool GraphicContext::is_primitives_array_owner(const PrimitivesArray &primitives_array)
 	{
 		return get_provider()->is_primitives_array_owner(primitives_array);
@@ -352,94 +378,166 @@ namespace clan
 	void GraphicContext::draw_primitives(PrimitivesType type, int num_vertices, const PrimitivesArray &prim_array)
 	{
 		impl->graphic_screen->set_active(impl.get());
+		if (GraphicContextCapture_Impl *capture = impl->graphic_screen->capture)
+			capture->draw_primitives(*impl, type, num_vertices, prim_array);
 		get_provider()->draw_primitives(type, num_vertices, prim_array);
 	}
 
 	void GraphicContext::set_primitives_array(const PrimitivesArray &prim_array)
 	{
+		if (GraphicContextCapture_Impl *capture = impl->graphic_screen->capture)
+			capture->set_primitives_array(prim_array);
 		get_provider()->set_primitives_array(prim_array);
 	}
 
 	void GraphicContext::draw_primitives_array(PrimitivesType type, int num_vertices)
 	{
 		impl->graphic_screen->set_active(impl.get());
+		if (GraphicContextCapture_Impl *capture = impl->graphic_screen->capture)
+			capture->draw_primitives_array(*impl, type, 0, num_vertices, 0);
 		get_provider()->draw_primitives_array(type, 0, num_vertices);
 	}
 
 	void GraphicContext::draw_primitives_array(PrimitivesType type, int offset, int num_vertices)
 	{
 		impl->graphic_screen->set_active(impl.get());
+		if (GraphicContextCapture_Impl *capture = impl->graphic_screen->capture)
+			capture->draw_primitives_array(*impl, type, offset, num_vertices, 0);
 		get_provider()->draw_primitives_array(type, offset, num_vertices);
 	}
 
 	void GraphicContext::draw_primitives_array_instanced(PrimitivesType type, int offset, int num_vertices, int instance_count)
 	{
 		impl->graphic_screen->set_active(impl.get());
+		if (GraphicContextCapture_Impl *capture = impl->graphic_screen->capture)
+			capture->draw_primitives_array(*impl, type, offset, num_vertices, instance_count);
 		get_provider()->draw_primitives_array_instanced(type, offset, num_vertices, instance_count);
 	}
 
+	void GraphicContext::draw_primitives_array_indirect(PrimitivesType type, const StorageBuffer &commands, size_t offset, int draw_count, int stride)
+	{
+		impl->graphic_screen->set_active(impl.get());
+		if (GraphicContextCapture_Impl *capture = impl->graphic_screen->capture)
+			capture->draw_primitives_array_indirect(*impl, type, commands, offset, draw_count, stride);
+		get_provider()->draw_primitives_array_indirect(type, commands, offset, draw_count, stride);
+	}
+
 	void GraphicContext::set_primitives_elements(ElementArrayBuffer &element_array)
 	{
 		impl->graphic_screen->set_active(impl.get());
+		if (GraphicContextCapture_Impl *capture = impl->graphic_screen->capture)
+			capture->set_primitives_elements(element_array);
 		get_provider()->set_primitives_elements(element_array.get_provider());
 	}
 
 	void GraphicContext::draw_primitives_elements(PrimitivesType type, int count, VertexAttributeDataType indices_type, size_t offset)
 	{
 		impl->graphic_screen->set_active(impl.get());
+		if (GraphicContextCapture_Impl *capture = impl->graphic_screen->capture)
+			capture->draw_primitives_elements(*impl, type, count, nullptr, indices_type, offset, 0);
 		get_provider()->draw_primitives_elements(type, count, indices_type, offset);
 	}
 
 	void GraphicContext::draw_primitives_elements_instanced(PrimitivesType type, int count, VertexAttributeDataType indices_type, size_t offset, int instance_count)
 	{
 		impl->graphic_screen->set_active(impl.get());
+		if (GraphicContextCapture_Impl *capture = impl->graphic_screen->capture)
+			capture->draw_primitives_elements(*impl, type, count, nullptr, indices_type, offset, instance_count);
 		get_provider()->draw_primitives_elements_instanced(type, count, indices_type, offset, instance_count);
 	}
 
+	void GraphicContext::draw_primitives_elements_indirect(PrimitivesType type, VertexAttributeDataType indices_type, const StorageBuffer &commands, size_t offset, int draw_count, int stride)
+	{
+		impl->graphic_screen->set_active(impl.get());
+		if (GraphicContextCapture_Impl *capture = impl->graphic_screen->capture)
+			capture->draw_primitives_elements_indirect(*impl, type, indices_type, commands, offset, draw_count, stride);
+		get_provider()->draw_primitives_elements_indirect(type, indices_type, commands, offset, draw_count, stride);
+	}
+
 	void GraphicContext::reset_primitives_elements()
 	{
 		impl->graphic_screen->set_active(impl.get());
+		if (GraphicContextCapture_Impl *capture = impl->graphic_screen->capture)
+			capture->reset_primitives_elements();
 		get_provider()->reset_primitives_elements();
 	}
 
 	void GraphicContext::draw_primitives_elements(PrimitivesType type, int count, ElementArrayBuffer &elements_array, VertexAttributeDataType indices_type, size_t offset)
 	{
 		impl->graphic_screen->set_active(impl.get());
+		if (GraphicContextCapture_Impl *capture = impl->graphic_screen->capture)
+			capture->draw_primitives_elements(*impl, type, count, &elements_array, indices_type, offset, 0);
 		get_provider()->draw_primitives_elements(type, count, elements_array.get_provider(), indices_type, (void*)offset);
 	}
 
 	void GraphicContext::draw_primitives_elements_instanced(PrimitivesType type, int count, ElementArrayBuffer &elements_array, VertexAttributeDataType indices_type, size_t offset, int instance_count)
 	{
 		impl->graphic_screen->set_active(impl.get());
+		if (GraphicContextCapture_Impl *capture = impl->graphic_screen->capture)
+			capture->draw_primitives_elements(*impl, type, count, &elements_array, indices_type, offset, instance_count);
 		get_provider()->draw_primitives_elements_instanced(type, count, elements_array.get_provider(), indices_type, (void*)offset, instance_count);
 	}
 
 	void GraphicContext::reset_primitives_array()
 	{
+		if (GraphicContextCapture_Impl *capture = impl->graphic_screen->capture)
+			capture->reset_primitives_array();
 		get_provider()->reset_primitives_array();
 	}
 
 	void GraphicContext::dispatch(int x, int y, int z)
 	{
 		impl->graphic_screen->set_active(impl.get());
+		if (GraphicContextCapture_Impl *capture = impl->graphic_screen->capture)
+			capture->dispatch(*impl, x, y, z, true);
 		get_provider()->dispatch(x, y, z);
 	}
 
+	void GraphicContext::dispatch_no_barrier(int x, int y, int z)
+	{
+		impl->graphic_screen->set_active(impl.get());
+		if (GraphicContextCapture_Impl *capture = impl->graphic_screen->capture)
+			capture->dispatch(*impl, x, y, z, false);
+		get_provider()->dispatch_no_barrier(x, y, z);
+	}
+
+	void GraphicContext::memory_barrier(int barrier_flags)
+	{
+		impl->graphic_screen->set_active(impl.get());
+		if (GraphicContextCapture_Impl *capture = impl->graphic_screen->capture)
+			capture->memory_barrier(barrier_flags);
+		get_provider()->memory_barrier(barrier_flags);
+	}
+
+	void GraphicContext::invalidate_attachments(int attachments)
+	{
+		impl->graphic_screen->set_active(impl.get());
+		if (GraphicContextCapture_Impl *capture = impl->graphic_screen->capture)
+			capture->invalidate_attachments(*impl, attachments);
+		get_provider()->invalidate_attachments(attachments);
+	}
+
 	void GraphicContext::clear(const Colorf &color)
 	{
 		impl->graphic_screen->set_active(impl.get());
+		if (GraphicContextCapture_Impl *capture = impl->graphic_screen->capture)
+			capture->clear(*impl, color);
 		get_provider()->clear(color);
 	}
 
 	void GraphicContext::clear_stencil(int value)
 	{
 		impl->graphic_screen->set_active(impl.get());
+		if (GraphicContextCapture_Impl *capture = impl->graphic_screen->capture)
+			capture->clear_stencil(*impl, value);
 		get_provider()->clear_stencil(value);
 	}
 
 	void GraphicContext::clear_depth(float value)
 	{
 		impl->graphic_screen->set_active(impl.get());
+		if (GraphicContextCapture_Impl *capture = impl->graphic_screen->capture)
+			capture->clear_depth(*impl, value);
 		get_provider()->clear_depth(value);
 	}
 
@@ -0,0 +1,925 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "Display/precomp.h"
+#include "API/Display/Render/graphic_context_capture.h"
+#include "API/Display/Render/blend_state_description.h"
+#include "API/Display/Render/depth_stencil_state_description.h"
+#include "API/Display/Render/rasterizer_state_description.h"
+#include "API/Display/Render/shader_object.h"
+#include "API/Display/Render/storage_buffer.h"
+#include "API/Display/Render/texture_2d.h"
+#include "API/Display/Render/transfer_buffer.h"
+#include "API/Display/Render/uniform_buffer.h"
+#include "API/Display/Image/pixel_buffer.h"
+#include "API/Display/TargetProviders/texture_provider.h"
+#include "graphic_context_capture_impl.h"
+#include "primitives_array_impl.h"
+#include "program_object_impl.h"
+#include "texture_impl.h"
+#include <algorithm>
+
+namespace clan
+{
+	GraphicContextCapture::GraphicContextCapture()
+	{
+	}
+
+	GraphicContextCapture::GraphicContextCapture(GraphicContext &gc, IODevice &output, int frame_count)
+		: impl(std::make_shared<GraphicContextCapture_Impl>(gc, output, frame_count))
+	{
+	}
+
+	void GraphicContextCapture::throw_if_null() const
+	{
+		if (!impl)
+			throw Exception("GraphicContextCapture is null");
+	}
+
+	bool GraphicContextCapture::is_capturing() const
+	{
+		return impl && impl->is_capturing();
+	}
+
+	int GraphicContextCapture::get_captured_frames() const
+	{
+		return impl->captured_frames;
+	}
+
+	void GraphicContextCapture::end_frame()
+	{
+		impl->end_frame();
+	}
+
+	void GraphicContextCapture::stop()
+	{
+		impl->stop();
+	}
+
+	/////////////////////////////////////////////////////////////////////////
+
+	std::atomic<int> GraphicContextCapture_Impl::active_count(0);
+	std::mutex GraphicContextCapture_Impl::active_mutex;
+	std::vector<GraphicContextCapture_Impl *> GraphicContextCapture_Impl::active_captures;
+
+	GraphicContextCapture_Impl::GraphicContextCapture_Impl(GraphicContext &gc, IODevice &output, int frame_count)
+		: gc(gc), output(output), frame_count(frame_count)
+	{
+		if (frame_count <= 0)
+			throw Exception("A capture must record at least one frame");
+
+		screen = gc.impl->graphic_screen.get();
+		if (screen->capture)
+			throw Exception("The graphic context is already being captured");
+		screen->capture = this;
+
+		std::unique_lock<std::mutex> lock(active_mutex);
+		active_captures.push_back(this);
+		active_count++;
+		lock.unlock();
+
+		Size size = gc.get_size();
+		writer.write_uint32(graphic_context_trace_magic);
+		writer.write_uint32(graphic_context_trace_version);
+		writer.write_int32(gc.get_shader_language());
+		writer.write_int32(size.width);
+		writer.write_int32(size.height);
+	}
+
+	GraphicContextCapture_Impl::~GraphicContextCapture_Impl()
+	{
+		stop();
+	}
+
+	void GraphicContextCapture_Impl::end_frame()
+	{
+		if (!screen)
+			return;
+
+		writer.write_op(trace_end_frame);
+		captured_frames++;
+		write_output();
+
+		if (captured_frames >= frame_count)
+			stop();
+	}
+
+	void GraphicContextCapture_Impl::stop()
+	{
+		if (!screen)
+			return;
+
+		screen->capture = nullptr;
+		screen = nullptr;
+
+		std::unique_lock<std::mutex> lock(active_mutex);
+		active_captures.erase(std::find(active_captures.begin(), active_captures.end(), this));
+		active_count--;
+		lock.unlock();
+
+		write_output();
+		ids.clear();
+		kept_alive.clear();
+		recorded_state = GraphicContext_State();
+		recorded_state_valid = false;
+	}
+
+	void GraphicContextCapture_Impl::write_output()
+	{
+		if (!writer.data.empty())
+			output.write(writer.data.data(), (int)writer.data.size());
+		writer.data.clear();
+	}
+
+	void GraphicContextCapture_Impl::program_uniform(ProgramObject_Impl *program, int location, GraphicContextTraceUniformKind kind, int size, int count, bool transpose, const void *values)
+	{
+		std::unique_lock<std::mutex> lock(active_mutex);
+		for (GraphicContextCapture_Impl *capture : active_captures)
+		{
+			// Float uniforms of programs not used by a command yet are lost, as programs are only defined on first use
+			auto it = capture->ids.find(program);
+			if (it == capture->ids.end())
+				continue;
+			int id = it->second;
+
+			int num_values = kind == trace_uniform_matrix ? size * size * count : size * count;
+			capture->writer.write_op(trace_program_uniform);
+			capture->writer.write_int32(id);
+			capture->writer.write_int32(location);
+			capture->writer.write_uint8((unsigned char)kind);
+			capture->writer.write_int32(size);
+			capture->writer.write_int32(count);
+			capture->writer.write_bool(transpose);
+			capture->writer.write(values, num_values * 4);
+		}
+	}
+
+	void GraphicContextCapture_Impl::set_primitives_array(const PrimitivesArray &array)
+	{
+		recorded_primitives_array = get_id(array);
+		writer.write_op(trace_set_primitives_array);
+		writer.write_int32(recorded_primitives_array);
+	}
+
+	void GraphicContextCapture_Impl::set_primitives_elements(const ElementArrayBuffer &elements)
+	{
+		recorded_primitives_elements = get_id(elements);
+		writer.write_op(trace_set_primitives_elements);
+		writer.write_int32(recorded_primitives_elements);
+	}
+
+	void GraphicContextCapture_Impl::reset_primitives_array()
+	{
+		recorded_primitives_array = -1;
+		writer.write_op(trace_set_primitives_array);
+		writer.write_int32(-1);
+	}
+
+	void GraphicContextCapture_Impl::reset_primitives_elements()
+	{
+		recorded_primitives_elements = -1;
+		writer.write_op(trace_set_primitives_elements);
+		writer.write_int32(-1);
+	}
+
+	void GraphicContextCapture_Impl::draw_primitives(const GraphicContext_State &state, PrimitivesType type, int num_vertices, const PrimitivesArray &array)
+	{
+		flush_state(state);
+		int array_id = get_id(array);
+		writer.write_op(trace_draw_primitives);
+		writer.write_int32(type);
+		writer.write_int32(num_vertices);
+		writer.write_int32(array_id);
+	}
+
+	void GraphicContextCapture_Impl::draw_primitives_array(const GraphicContext_State &state, PrimitivesType type, int offset, int num_vertices, int instance_count)
+	{
+		flush_state(state);
+		writer.write_op(trace_draw_array);
+		writer.write_int32(type);
+		writer.write_int32(offset);
+		writer.write_int32(num_vertices);
+		writer.write_int32(instance_count);
+	}
+
+	void GraphicContextCapture_Impl::draw_primitives_array_indirect(const GraphicContext_State &state, PrimitivesType type, const StorageBuffer &commands, size_t offset, int draw_count, int stride)
+	{
+		flush_state(state);
+		int commands_id = get_id(commands);
+		writer.write_op(trace_draw_array_indirect);
+		writer.write_int32(type);
+		writer.write_int32(commands_id);
+		writer.write_uint64(offset);
+		writer.write_int32(draw_count);
+		writer.write_int32(stride);
+	}
+
+	void GraphicContextCapture_Impl::draw_primitives_elements(const GraphicContext_State &state, PrimitivesType type, int count, const ElementArrayBuffer *elements, VertexAttributeDataType indices_type, size_t offset, int instance_count)
+	{
+		flush_state(state);
+		int elements_id = elements ? get_id(*elements) : -1;
+		writer.write_op(trace_draw_elements);
+		writer.write_int32(type);
+		writer.write_int32(count);
+		writer.write_int32(elements_id);
+		writer.write_int32(indices_type);
+		writer.write_uint64(offset);
+		writer.write_int32(instance_count);
+	}
+
+	void GraphicContextCapture_Impl::draw_primitives_elements_indirect(const GraphicContext_State &state, PrimitivesType type, VertexAttributeDataType indices_type, const StorageBuffer &commands, size_t offset, int draw_count, int stride)
+	{
+		flush_state(state);
+		int commands_id = get_id(commands);
+		writer.write_op(trace_draw_elements_indirect);
+		writer.write_int32(type);
+		writer.write_int32(indices_type);
+		writer.write_int32(commands_id);
+		writer.write_uint64(offset);
+		writer.write_int32(draw_count);
+		writer.write_int32(stride);
+	}
+
+	void GraphicContextCapture_Impl::dispatch(const GraphicContext_State &state, int x, int y, int z, bool barrier)
+	{
+		flush_state(state);
+		writer.write_op(trace_dispatch);
+		writer.write_int32(x);
+		writer.write_int32(y);
+		writer.write_int32(z);
+		writer.write_bool(barrier);
+	}
+
+	void GraphicContextCapture_Impl::memory_barrier(int barrier_flags)
+	{
+		writer.write_op(trace_memory_barrier);
+		writer.write_int32(barrier_flags);
+	}
+
+	void GraphicContextCapture_Impl::invalidate_attachments(const GraphicContext_State &state, int attachments)
+	{
+		flush_state(state);
+		writer.write_op(trace_invalidate_attachments);
+		writer.write_int32(attachments);
+	}
+
+	void GraphicContextCapture_Impl::clear(const GraphicContext_State &state, const Colorf &color)
+	{
+		flush_state(state);
+		writer.write_op(trace_clear);
+		writer.write_float(color.r);
+		writer.write_float(color.g);
+		writer.write_float(color.b);
+		writer.write_float(color.a);
+	}
+
+	void GraphicContextCapture_Impl::clear_depth(const GraphicContext_State &state, float value)
+	{
+		flush_state(state);
+		writer.write_op(trace_clear_depth);
+		writer.write_float(value);
+	}
+
+	void GraphicContextCapture_Impl::clear_stencil(const GraphicContext_State &state, int value)
+	{
+		flush_state(state);
+		writer.write_op(trace_clear_stencil);
+		writer.write_int32(value);
+	}
+
+	void GraphicContextCapture_Impl::upload(const VertexArrayBuffer &buffer, int offset, const void *data, int size)
+	{
+		write_buffer_upload(get_id(buffer), offset, data, size);
+	}
+
+	void GraphicContextCapture_Impl::upload(const ElementArrayBuffer &buffer, int offset, const void *data, int size)
+	{
+		write_buffer_upload(get_id(buffer), offset, data, size);
+	}
+
+	void GraphicContextCapture_Impl::upload(const UniformBuffer &buffer, int offset, const void *data, int size)
+	{
+		write_buffer_upload(get_id(buffer), offset, data, size);
+	}
+
+	void GraphicContextCapture_Impl::upload(const StorageBuffer &buffer, int offset, const void *data, int size)
+	{
+		write_buffer_upload(get_id(buffer), offset, data, size);
+	}
+
+	void GraphicContextCapture_Impl::write_buffer_upload(int id, int offset, const void *data, int size)
+	{
+		writer.write_op(trace_upload_buffer);
+		writer.write_int32(id);
+		writer.write_int32(offset);
+		writer.write_block(data, size);
+	}
+
+	void GraphicContextCapture_Impl::upload(const Texture2D &texture, int x, int y, int level, const PixelBuffer &image, const Rect &src_rect)
+	{
+		int id = get_id(texture);
+
+		// Transfer textures keep their pixels on the GPU
+		PixelBuffer source = image;
+		bool gpu = source.is_gpu();
+		if (gpu)
+			source.lock(gc, access_read_only);
+
+		writer.write_op(trace_upload_texture);
+		writer.write_int32(id);
+		writer.write_int32(x);
+		writer.write_int32(y);
+		writer.write_int32(level);
+		writer.write_int32(source.get_format());
+		if (source.is_compressed())
+		{
+			// Compressed rows cannot be cut at pixel boundaries, so the whole image goes into the trace
+			writer.write_int32(source.get_width());
+			writer.write_int32(source.get_height());
+			writer.write_int32(src_rect.left);
+			writer.write_int32(src_rect.top);
+			writer.write_int32(src_rect.right);
+			writer.write_int32(src_rect.bottom);
+			writer.write_block(source.get_data(), source.get_data_size());
+		}
+		else
+		{
+			int row_size = src_rect.get_width() * source.get_bytes_per_pixel();
+			writer.write_int32(src_rect.get_width());
+			writer.write_int32(src_rect.get_height());
+			writer.write_int32(0);
+			writer.write_int32(0);
+			writer.write_int32(src_rect.get_width());
+			writer.write_int32(src_rect.get_height());
+			writer.write_int32(row_size * src_rect.get_height());
+			const unsigned char *pixels = source.get_data_uint8() + src_rect.top * source.get_pitch() + src_rect.left * source.get_bytes_per_pixel();
+			for (int row = 0; row < src_rect.get_height(); row++)
+				writer.write(pixels + row * source.get_pitch(), row_size);
+		}
+
+		if (gpu)
+			source.unlock();
+	}
+
+	void GraphicContextCapture_Impl::flush_state(const GraphicContext_State &state)
+	{
+		// Only the state used by a command is recorded, as the difference to the state of the previous command
+		bool all = !recorded_state_valid;
+		const GraphicContext_State &old = recorded_state;
+
+		if (all || !(state.write_frame_buffer == old.write_frame_buffer) || !(state.read_frame_buffer == old.read_frame_buffer))
+		{
+			int write_id = get_id(state.write_frame_buffer);
+			int read_id = get_id(state.read_frame_buffer);
+			writer.write_op(trace_set_frame_buffer);
+			writer.write_int32(write_id);
+			writer.write_int32(read_id);
+		}
+
+		if (all || state.draw_buffer != old.draw_buffer)
+		{
+			writer.write_op(trace_set_draw_buffer);
+			writer.write_int32(state.draw_buffer);
+		}
+
+		if (all || state.viewport != old.viewport)
+		{
+			writer.write_op(trace_set_viewports);
+			writer.write_int32((int)state.viewport.size());
+			for (const Rectf &viewport : state.viewport)
+			{
+				writer.write_float(viewport.left);
+				writer.write_float(viewport.top);
+				writer.write_float(viewport.right);
+				writer.write_float(viewport.bottom);
+			}
+		}
+
+		if (all || state.depth_range != old.depth_range)
+		{
+			writer.write_op(trace_set_depth_ranges);
+			writer.write_int32((int)state.depth_range.size());
+			for (const Sizef &range : state.depth_range)
+			{
+				writer.write_float(range.width);
+				writer.write_float(range.height);
+			}
+		}
+
+		if (all || state.scissor_set != old.scissor_set || (state.scissor_set && state.scissor != old.scissor))
+		{
+			writer.write_op(trace_set_scissor);
+			writer.write_bool(state.scissor_set);
+			writer.write_int32(state.scissor.left);
+			writer.write_int32(state.scissor.top);
+			writer.write_int32(state.scissor.right);
+			writer.write_int32(state.scissor.bottom);
+		}
+
+		size_t num_textures = std::max(state.textures.size(), all ? 0 : old.textures.size());
+		for (size_t unit = 0; unit < num_textures; unit++)
+		{
+			Texture texture = unit < state.textures.size() ? state.textures[unit] : Texture();
+			Texture old_texture = !all && unit < old.textures.size() ? old.textures[unit] : Texture();
+			if (all || !(texture == old_texture))
+			{
+				int id = get_id(texture);
+				writer.write_op(trace_set_texture);
+				writer.write_int32((int)unit);
+				writer.write_int32(id);
+			}
+		}
+
+		size_t num_image_textures = std::max(state.image_textures.size(), all ? 0 : old.image_textures.size());
+		for (size_t unit = 0; unit < num_image_textures; unit++)
+		{
+			Texture texture = unit < state.image_textures.size() ? state.image_textures[unit] : Texture();
+			Texture old_texture = !all && unit < old.image_textures.size() ? old.image_textures[unit] : Texture();
+			if (all || !(texture == old_texture))
+			{
+				int id = get_id(texture);
+				writer.write_op(trace_set_image_texture);
+				writer.write_int32((int)unit);
+				writer.write_int32(id);
+			}
+		}
+
+		size_t num_uniform_buffers = std::max(state.uniform_buffers.size(), all ? 0 : old.uniform_buffers.size());
+		for (size_t index = 0; index < num_uniform_buffers; index++)
+		{
+			UniformBuffer buffer = index < state.uniform_buffers.size() ? state.uniform_buffers[index] : UniformBuffer();
+			UniformBuffer old_buffer = !all && index < old.uniform_buffers.size() ? old.uniform_buffers[index] : UniformBuffer();
+			GraphicContext_State::UniformBufferRange range = index < state.uniform_buffer_ranges.size() ? state.uniform_buffer_ranges[index] : GraphicContext_State::UniformBufferRange();
+			GraphicContext_State::UniformBufferRange old_range = !all && index < old.uniform_buffer_ranges.size() ? old.uniform_buffer_ranges[index] : GraphicContext_State::UniformBufferRange();
+			if (all || !(buffer == old_buffer) || range.offset != old_range.offset || range.size != old_range.size)
+			{
+				int id = buffer.is_null() ? -1 : get_id(buffer);
+				writer.write_op(trace_set_uniform_buffer);
+				writer.write_int32((int)index);
+				writer.write_int32(id);
+				writer.write_int32(range.offset);
+				writer.write_int32(range.size);
+			}
+		}
+
+		size_t num_storage_buffers = std::max(state.storage_buffers.size(), all ? 0 : old.storage_buffers.size());
+		for (size_t index = 0; index < num_storage_buffers; index++)
+		{
+			StorageBuffer buffer = index < state.storage_buffers.size() ? state.storage_buffers[index] : StorageBuffer();
+			StorageBuffer old_buffer = !all && index < old.storage_buffers.size() ? old.storage_buffers[index] : StorageBuffer();
+			if (all || !(buffer == old_buffer))
+			{
+				int id = buffer.is_null() ? -1 : get_id(buffer);
+				writer.write_op(trace_set_storage_buffer);
+				writer.write_int32((int)index);
+				writer.write_int32(id);
+			}
+		}
+
+		if (all || !(state.program == old.program))
+		{
+			int id = get_id(state.program);
+			writer.write_op(trace_set_program);
+			writer.write_int32(id);
+		}
+
+		if (all || state.rasterizer_state.get_provider() != old.rasterizer_state.get_provider())
+		{
+			int id = get_id(state.rasterizer_state);
+			writer.write_op(trace_set_rasterizer_state);
+			writer.write_int32(id);
+		}
+
+		if (all || state.blend_state.get_provider() != old.blend_state.get_provider() || state.blend_color != old.blend_color || state.sample_mask != old.sample_mask)
+		{
+			int id = get_id(state.blend_state);
+			writer.write_op(trace_set_blend_state);
+			writer.write_int32(id);
+			writer.write_float(state.blend_color.r);
+			writer.write_float(state.blend_color.g);
+			writer.write_float(state.blend_color.b);
+			writer.write_float(state.blend_color.a);
+			writer.write_uint32(state.sample_mask);
+		}
+
+		if (all || state.depth_stencil_state.get_provider() != old.depth_stencil_state.get_provider() || state.stencil_ref != old.stencil_ref)
+		{
+			int id = get_id(state.depth_stencil_state);
+			writer.write_op(trace_set_depth_stencil_state);
+			writer.write_int32(id);
+			writer.write_int32(state.stencil_ref);
+		}
+
+		recorded_state.copy_state(&state);
+		recorded_state_valid = true;
+	}
+
+	bool GraphicContextCapture_Impl::find_id(const void *key, int &out_id)
+	{
+		auto it = ids.find(key);
+		if (it != ids.end())
+		{
+			out_id = it->second;
+			return true;
+		}
+
+		out_id = (int)ids.size();
+		ids[key] = out_id;
+		return false;
+	}
+
+	void GraphicContextCapture_Impl::define_buffer(int id, GraphicContextTraceBufferKind kind, int size, int stride, const std::function<void(TransferBuffer &transfer)> &copy_to)
+	{
+		writer.write_op(trace_define_buffer);
+		writer.write_int32(id);
+		writer.write_uint8((unsigned char)kind);
+		writer.write_int32(size);
+		writer.write_int32(stride);
+
+		// Read back the current contents, as they may have been uploaded before the capture started
+		bool has_data = false;
+		if (size > 0)
+		{
+			try
+			{
+				TransferBuffer transfer(gc, size, usage_stream_read);
+				copy_to(transfer);
+				transfer.lock(gc, access_read_only);
+
+				// Trailing zeros are left out, as large ring buffers are mostly unused
+				const unsigned char *data = (const unsigned char *)transfer.get_data();
+				int data_size = size;
+				while (data_size > 0 && data[data_size - 1] == 0)
+					data_size--;
+
+				writer.write_bool(true);
+				writer.write_block(data, data_size);
+				transfer.unlock();
+				has_data = true;
+			}
+			catch (Exception &)
+			{
+			}
+		}
+		if (!has_data)
+			writer.write_bool(false);
+	}
+
+	int GraphicContextCapture_Impl::get_id(const VertexArrayBuffer &buffer)
+	{
+		int id;
+		if (find_id(buffer.get_provider(), id))
+			return id;
+
+		kept_alive.push_back(std::make_shared<VertexArrayBuffer>(buffer));
+		VertexArrayBuffer source = buffer;
+		define_buffer(id, trace_vertex_buffer, buffer.get_size(), 0, [&](TransferBuffer &transfer) { source.copy_to(gc, transfer, 0, 0, source.get_size()); });
+		return id;
+	}
+
+	int GraphicContextCapture_Impl::get_id(const ElementArrayBuffer &buffer)
+	{
+		int id;
+		if (find_id(buffer.get_provider(), id))
+			return id;
+
+		kept_alive.push_back(std::make_shared<ElementArrayBuffer>(buffer));
+		ElementArrayBuffer source = buffer;
+		define_buffer(id, trace_element_buffer, buffer.get_size(), 0, [&](TransferBuffer &transfer) { source.copy_to(gc, transfer, 0, 0, source.get_size()); });
+		return id;
+	}
+
+	int GraphicContextCapture_Impl::get_id(const UniformBuffer &buffer)
+	{
+		int id;
+		if (find_id(buffer.get_provider(), id))
+			return id;
+
+		kept_alive.push_back(std::make_shared<UniformBuffer>(buffer));
+		UniformBuffer source = buffer;
+		define_buffer(id, trace_uniform_buffer, buffer.get_size(), 0, [&](TransferBuffer &transfer) { source.copy_to(gc, transfer, 0, 0, source.get_size()); });
+		return id;
+	}
+
+	int GraphicContextCapture_Impl::get_id(const StorageBuffer &buffer)
+	{
+		int id;
+		if (find_id(buffer.get_provider(), id))
+			return id;
+
+		kept_alive.push_back(std::make_shared<StorageBuffer>(buffer));
+		StorageBuffer source = buffer;
+		define_buffer(id, trace_storage_buffer, buffer.get_size(), buffer.get_stride(), [&](TransferBuffer &transfer) { source.copy_to(gc, transfer, 0, 0, source.get_size()); });
+		return id;
+	}
+
+	int GraphicContextCapture_Impl::get_id(const Texture &texture)
+	{
+		if (texture.is_null())
+			return -1;
+
+		std::shared_ptr<Texture_Impl> texture_impl = texture.get_impl().lock();
+		int id;
+		if (find_id(texture_impl.get(), id))
+			return id;
+
+		kept_alive.push_back(std::make_shared<Texture>(texture));
+		writer.write_op(trace_define_texture);
+		writer.write_int32(id);
+		writer.write_int32(texture_impl->dimensions);
+		writer.write_int32(texture_impl->width);
+		writer.write_int32(texture_impl->height);
+		writer.write_int32(texture_impl->depth);
+		writer.write_int32(texture_impl->array_size);
+		writer.write_int32(texture_impl->texture_format);
+		writer.write_int32(texture_impl->levels);
+
+		// The first level of 2D textures is read back. Replay generates the other levels from it.
+		PixelBuffer image;
+		if (texture_impl->dimensions == texture_2d)
+		{
+			try
+			{
+				image = texture_impl->provider->get_pixeldata(gc, texture_impl->texture_format, 0);
+			}
+			catch (Exception &)
+			{
+			}
+		}
+
+		if (!image.is_null() && !image.is_compressed())
+		{
+			int row_size = image.get_width() * image.get_bytes_per_pixel();
+			std::vector<unsigned char> pixels(row_size * image.get_height());
+			for (int row = 0; row < image.get_height(); row++)
+				memcpy(pixels.data() + row * row_size, image.get_data_uint8() + row * image.get_pitch(), row_size);
+
+			// Trailing zeros are left out, as atlas and batch textures are mostly unused
+			int data_size = (int)pixels.size();
+			while (data_size > 0 && pixels[data_size - 1] == 0)
+				data_size--;
+
+			writer.write_bool(true);
+			writer.write_int32(image.get_width());
+			writer.write_int32(image.get_height());
+			writer.write_block(pixels.data(), data_size);
+		}
+		else
+		{
+			writer.write_bool(false);
+		}
+		return id;
+	}
+
+	int GraphicContextCapture_Impl::get_id(const FrameBuffer &frame_buffer)
+	{
+		if (frame_buffer.is_null())
+			return -1;
+
+		int id;
+		if (find_id(frame_buffer.get_provider(), id))
+			return id;
+
+		kept_alive.push_back(std::make_shared<FrameBuffer>(frame_buffer));
+		Size size = frame_buffer.get_size();
+		writer.write_op(trace_define_frame_buffer);
+		writer.write_int32(id);
+		writer.write_int32(size.width);
+		writer.write_int32(size.height);
+		return id;
+	}
+
+	int GraphicContextCapture_Impl::get_id(const ProgramObject &program)
+	{
+		if (program.is_null())
+			return -1;
+
+		int id;
+		if (find_id(program.impl.get(), id))
+			return id;
+
+		kept_alive.push_back(std::make_shared<ProgramObject>(program));
+		const ProgramObject_Impl &program_impl = *program.impl;
+
+		writer.write_op(trace_define_program);
+		writer.write_int32(id);
+
+		std::vector<ShaderObject> shaders = program.get_shaders();
+		writer.write_int32((int)shaders.size());
+		for (const ShaderObject &shader : shaders)
+		{
+			writer.write_int32(shader.get_shader_type());
+			writer.write_string(shader.get_shader_source());
+		}
+
+		writer.write_int32((int)program_impl.attribute_bindings.size());
+		for (const auto &binding : program_impl.attribute_bindings)
+		{
+			writer.write_int32(binding.first);
+			writer.write_string(binding.second);
+		}
+
+		writer.write_int32((int)program_impl.frag_data_bindings.size());
+		for (const auto &binding : program_impl.frag_data_bindings)
+		{
+			writer.write_int32(binding.first);
+			writer.write_string(binding.second);
+		}
+
+		writer.write_int32((int)program_impl.uniform_buffer_bindings.size());
+		for (const auto &binding : program_impl.uniform_buffer_bindings)
+		{
+			writer.write_int32(binding.first);
+			writer.write_int32(binding.second);
+		}
+
+		writer.write_int32((int)program_impl.storage_buffer_bindings.size());
+		for (const auto &binding : program_impl.storage_buffer_bindings)
+		{
+			writer.write_int32(binding.first);
+			writer.write_int32(binding.second);
+		}
+
+		writer.write_int32((int)program_impl.int_uniforms.size());
+		for (const auto &uniform : program_impl.int_uniforms)
+		{
+			writer.write_int32(uniform.location);
+			writer.write_int32(uniform.size);
+			writer.write_block(uniform.values.data(), (int)(uniform.values.size() * sizeof(int)));
+		}
+		return id;
+	}
+
+	int GraphicContextCapture_Impl::get_id(const PrimitivesArray &array)
+	{
+		if (array.is_null())
+			return -1;
+
+		int id;
+		if (find_id(array.get_provider(), id))
+			return id;
+
+		kept_alive.push_back(std::make_shared<PrimitivesArray>(array));
+
+		std::vector<int> buffer_ids;
+		for (const auto &attribute : array.impl->attributes)
+			buffer_ids.push_back(get_id(attribute.buffer));
+
+		writer.write_op(trace_define_primitives_array);
+		writer.write_int32(id);
+		writer.write_int32((int)array.impl->attributes.size());
+		for (size_t i = 0; i < array.impl->attributes.size(); i++)
+		{
+			const auto &attribute = array.impl->attributes[i];
+			writer.write_int32(attribute.index);
+			writer.write_int32(buffer_ids[i]);
+			writer.write_int32(attribute.size);
+			writer.write_int32(attribute.type);
+			writer.write_uint64(attribute.offset);
+			writer.write_int32(attribute.stride);
+			writer.write_bool(attribute.normalize);
+		}
+		return id;
+	}
+
+	int GraphicContextCapture_Impl::get_id(const RasterizerState &state)
+	{
+		if (state.is_null())
+			return -1;
+
+		int id;
+		if (find_id(state.get_provider(), id))
+			return id;
+
+		kept_alive.push_back(std::make_shared<RasterizerState>(state));
+		RasterizerStateDescription desc = state.get_description();
+		float offset_factor, offset_units;
+		desc.get_polygon_offset(offset_factor, offset_units);
+
+		writer.write_op(trace_define_rasterizer_state);
+		writer.write_int32(id);
+		writer.write_bool(desc.get_culled());
+		writer.write_bool(desc.get_enable_line_antialiasing());
+		writer.write_int32(desc.get_face_cull_mode());
+		writer.write_int32(desc.get_face_fill_mode());
+		writer.write_int32(desc.get_front_face());
+		writer.write_bool(desc.get_enable_scissor());
+		writer.write_bool(desc.get_antialiased());
+		writer.write_bool(desc.get_offset_point());
+		writer.write_bool(desc.get_offset_line());
+		writer.write_bool(desc.get_offset_fill());
+		writer.write_float(offset_factor);
+		writer.write_float(offset_units);
+		writer.write_float(desc.get_point_size());
+		writer.write_float(desc.get_point_fade_treshold_size());
+		writer.write_bool(desc.is_point_size());
+		writer.write_int32(desc.get_point_sprite_origin());
+		return id;
+	}
+
+	int GraphicContextCapture_Impl::get_id(const BlendState &state)
+	{
+		if (state.is_null())
+			return -1;
+
+		int id;
+		if (find_id(state.get_provider(), id))
+			return id;
+
+		kept_alive.push_back(std::make_shared<BlendState>(state));
+		BlendStateDescription desc = state.get_description();
+		BlendEquation equation_color, equation_alpha;
+		BlendFunc src, dest, src_alpha, dest_alpha;
+		bool red, green, blue, alpha;
+		desc.get_blend_equation(equation_color, equation_alpha);
+		desc.get_blend_function(src, dest, src_alpha, dest_alpha);
+		desc.get_color_write(red, green, blue, alpha);
+
+		writer.write_op(trace_define_blend_state);
+		writer.write_int32(id);
+		writer.write_bool(desc.is_blending_enabled());
+		writer.write_int32(equation_color);
+		writer.write_int32(equation_alpha);
+		writer.write_int32(src);
+		writer.write_int32(dest);
+		writer.write_int32(src_alpha);
+		writer.write_int32(dest_alpha);
+		writer.write_bool(red);
+		writer.write_bool(green);
+		writer.write_bool(blue);
+		writer.write_bool(alpha);
+		writer.write_bool(desc.is_logic_op_enabled());
+		writer.write_int32(desc.get_logic_op());
+		return id;
+	}
+
+	int GraphicContextCapture_Impl::get_id(const DepthStencilState &state)
+	{
+		if (state.is_null())
+			return -1;
+
+		int id;
+		if (find_id(state.get_provider(), id))
+			return id;
+
+		kept_alive.push_back(std::make_shared<DepthStencilState>(state));
+		DepthStencilStateDescription desc = state.get_description();
+		CompareFunction front_func, back_func;
+		int front_ref, front_mask, back_ref, back_mask;
+		unsigned char front_write_mask, back_write_mask;
+		StencilOp front_fail, front_depth_fail, front_pass, back_fail, back_depth_fail, back_pass;
+		desc.get_stencil_compare_front(front_func, front_ref, front_mask);
+		desc.get_stencil_compare_back(back_func, back_ref, back_mask);
+		desc.get_stencil_write_mask(front_write_mask, back_write_mask);
+		desc.get_stencil_op_front(front_fail, front_depth_fail, front_pass);
+		desc.get_stencil_op_back(back_fail, back_depth_fail, back_pass);
+
+		writer.write_op(trace_define_depth_stencil_state);
+		writer.write_int32(id);
+		writer.write_bool(desc.is_stencil_test_enabled());
+		writer.write_int32(front_func);
+		writer.write_int32(front_ref);
+		writer.write_int32(front_mask);
+		writer.write_int32(back_func);
+		writer.write_int32(back_ref);
+		writer.write_int32(back_mask);
+		writer.write_uint8(front_write_mask);
+		writer.write_uint8(back_write_mask);
+		writer.write_int32(front_fail);
+		writer.write_int32(front_depth_fail);
+		writer.write_int32(front_pass);
+		writer.write_int32(back_fail);
+		writer.write_int32(back_depth_fail);
+		writer.write_int32(back_pass);
+		writer.write_bool(desc.is_depth_test_enabled());
+		writer.write_bool(desc.is_depth_write_enabled());
+		writer.write_int32(desc.get_depth_compare_function());
+		return id;
+	}
+}
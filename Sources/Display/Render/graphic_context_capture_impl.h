@@ -0,0 +1,134 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include "API/Display/Render/graphic_context.h"
+#include "API/Display/Render/element_array_buffer.h"
+#include "API/Display/Render/primitives_array.h"
+#include "API/Display/Render/vertex_array_buffer.h"
+#include "API/Core/IOData/iodevice.h"
+#include "graphic_context_impl.h"
+#include "graphic_context_state.h"
+#include "graphic_context_trace.h"
+#include <atomic>
+#include <functional>
+#include <map>
+#include <mutex>
+
+namespace clan
+{
+	class ProgramObject_Impl;
+	class Texture2D;
+	class TransferBuffer;
+
+	class GraphicContextCapture_Impl
+	{
+	public:
+		GraphicContextCapture_Impl(GraphicContext &gc, IODevice &output, int frame_count);
+		~GraphicContextCapture_Impl();
+
+		/// \brief Returns the capture recording the commands of a graphic context, if any
+		static GraphicContextCapture_Impl *get(const GraphicContext &gc) { return gc.impl ? gc.impl->graphic_screen->capture : nullptr; }
+
+		/// \brief Returns true if any capture is recording, so program uniform changes need to be recorded
+		static bool is_any_active() { return active_count.load(std::memory_order_relaxed) != 0; }
+
+		static void program_uniform(ProgramObject_Impl *program, int location, GraphicContextTraceUniformKind kind, int size, int count, bool transpose, const void *values);
+
+		bool is_capturing() const { return screen != nullptr; }
+		void end_frame();
+		void stop();
+
+		void set_primitives_array(const PrimitivesArray &array);
+		void set_primitives_elements(const ElementArrayBuffer &elements);
+		void reset_primitives_array();
+		void reset_primitives_elements();
+
+		void draw_primitives(const GraphicContext_State &state, PrimitivesType type, int num_vertices, const PrimitivesArray &array);
+		void draw_primitives_array(const GraphicContext_State &state, PrimitivesType type, int offset, int num_vertices, int instance_count);
+		void draw_primitives_array_indirect(const GraphicContext_State &state, PrimitivesType type, const StorageBuffer &commands, size_t offset, int draw_count, int stride);
+		void draw_primitives_elements(const GraphicContext_State &state, PrimitivesType type, int count, const ElementArrayBuffer *elements, VertexAttributeDataType indices_type, size_t offset, int instance_count);
+		void draw_primitives_elements_indirect(const GraphicContext_State &state, PrimitivesType type, VertexAttributeDataType indices_type, const StorageBuffer &commands, size_t offset, int draw_count, int stride);
+		void dispatch(const GraphicContext_State &state, int x, int y, int z, bool barrier);
+		void memory_barrier(int barrier_flags);
+		void invalidate_attachments(const GraphicContext_State &state, int attachments);
+		void clear(const GraphicContext_State &state, const Colorf &color);
+		void clear_depth(const GraphicContext_State &state, float value);
+		void clear_stencil(const GraphicContext_State &state, int value);
+
+		void upload(const VertexArrayBuffer &buffer, int offset, const void *data, int size);
+		void upload(const ElementArrayBuffer &buffer, int offset, const void *data, int size);
+		void upload(const UniformBuffer &buffer, int offset, const void *data, int size);
+		void upload(const StorageBuffer &buffer, int offset, const void *data, int size);
+		void upload(const Texture2D &texture, int x, int y, int level, const PixelBuffer &image, const Rect &src_rect);
+
+		int captured_frames = 0;
+
+	private:
+		void flush_state(const GraphicContext_State &state);
+		void write_buffer_upload(int id, int offset, const void *data, int size);
+
+		int get_id(const VertexArrayBuffer &buffer);
+		int get_id(const ElementArrayBuffer &buffer);
+		int get_id(const UniformBuffer &buffer);
+		int get_id(const StorageBuffer &buffer);
+		int get_id(const Texture &texture);
+		int get_id(const FrameBuffer &frame_buffer);
+		int get_id(const ProgramObject &program);
+		int get_id(const PrimitivesArray &array);
+		int get_id(const RasterizerState &state);
+		int get_id(const BlendState &state);
+		int get_id(const DepthStencilState &state);
+
+		bool find_id(const void *key, int &out_id);
+		void define_buffer(int id, GraphicContextTraceBufferKind kind, int size, int stride, const std::function<void(TransferBuffer &transfer)> &copy_to);
+
+		void write_output();
+
+		GraphicContext gc;
+		GraphicScreen *screen = nullptr;
+		IODevice output;
+		int frame_count = 0;
+
+		GraphicContextTraceWriter writer;
+
+		std::map<const void *, int> ids;
+		std::vector<std::shared_ptr<void>> kept_alive;	// Keeps captured resources alive so their addresses are not reused for other resources
+
+		GraphicContext_State recorded_state;
+		bool recorded_state_valid = false;
+		int recorded_primitives_array = -1;
+		int recorded_primitives_elements = -1;
+
+		static std::atomic<int> active_count;
+		static std::mutex active_mutex;
+		static std::vector<GraphicContextCapture_Impl *> active_captures;
+	};
+}
@@ -30,6 +30,8 @@
 #include "graphic_context_impl.h"
 #include "primitives_array_impl.h"
 #include "API/Display/Render/shared_gc_data.h"
+#include "API/Display/Render/pipeline_state.h"
+#include "API/Display/Render/primitives_array.h"
 
 namespace clan
 {
@@ -133,17 +135,23 @@ namespace clan
 		graphic_screen->on_image_textures_changed(this);
 	}
 
-	void GraphicContext_Impl::set_uniform_buffer(int index, const UniformBuffer &buffer)
+	void GraphicContext_Impl::set_uniform_buffer(int index, const UniformBuffer &buffer, int offset, int size)
 	{
 		// Limit the number of unit index to 255, this should always be enough. This simplifies the saving of the texture
 		if ((index < 0) || (index > 255))
 			throw Exception("Invalid uniform buffer index");
+		if ((offset < 0) || (size < 0))
+			throw Exception("Invalid uniform buffer range");
 
 		// Extend the selected uniform_buffers array if required
 		if (index >= uniform_buffers.size())
+		{
 			uniform_buffers.resize(index + 1);
+			uniform_buffer_ranges.resize(index + 1);
+		}
 
 		uniform_buffers[index] = buffer;
+		uniform_buffer_ranges[index] = UniformBufferRange(offset, size);
 		graphic_screen->on_uniform_buffer_changed(this, index);
 	}
 
@@ -262,6 +270,26 @@ namespace clan
 		graphic_screen->on_depth_stencil_state_changed(this);
 	}
 
+	void GraphicContext_Impl::set_pipeline_state(const PipelineState &pipeline)
+	{
+		pipeline.throw_if_null();
+
+		if (program_standard_set || !(program == pipeline.get_program()))
+			set_program_object(pipeline.get_program());
+
+		if (rasterizer_state.get_provider() != pipeline.get_rasterizer_state().get_provider())
+			set_rasterizer_state(pipeline.get_rasterizer_state());
+
+		if (blend_state.get_provider() != pipeline.get_blend_state().get_provider() || !(blend_color == pipeline.get_blend_color()) || sample_mask != pipeline.get_sample_mask())
+			set_blend_state(pipeline.get_blend_state(), pipeline.get_blend_color(), pipeline.get_sample_mask());
+
+		if (depth_stencil_state.get_provider() != pipeline.get_depth_stencil_state().get_provider() || stencil_ref != pipeline.get_stencil_ref())
+			set_depth_stencil_state(pipeline.get_depth_stencil_state(), pipeline.get_stencil_ref());
+
+		if (!pipeline.get_vertex_layout().is_null())
+			graphic_screen->get_provider()->set_primitives_array(pipeline.get_vertex_layout());
+	}
+
 	void GraphicContext_Impl::set_draw_buffer(DrawBuffer buffer)
 	{
 		draw_buffer = buffer;
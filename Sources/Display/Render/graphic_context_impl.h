@@ -59,7 +59,7 @@ namespace clan
 		void set_image_texture(int unit_index, const Texture &texture);
 		void set_image_textures(std::vector<Texture> &textures);
 
-		void set_uniform_buffer(int index, const UniformBuffer &buffer);
+		void set_uniform_buffer(int index, const UniformBuffer &buffer, int offset, int size);
 		void set_storage_buffer(int index, const StorageBuffer &buffer);
 
 		void set_program_object(StandardProgram standard_program);
@@ -71,6 +71,7 @@ namespace clan
 		void set_rasterizer_state(const RasterizerState &state);
 		void set_blend_state(const BlendState &state, const Colorf &blend_color, unsigned int sample_mask);
 		void set_depth_stencil_state(const DepthStencilState &state, int stencil_ref);
+		void set_pipeline_state(const PipelineState &pipeline);
 
 		void set_draw_buffer(DrawBuffer buffer);
 
@@ -90,5 +91,6 @@ namespace clan
 
 		friend class GraphicScreen;
 		friend class GraphicContext;
+		friend class GraphicContextCapture_Impl;
 	};
 }
@@ -0,0 +1,930 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "Display/precomp.h"
+#include "API/Display/Render/graphic_context_replay.h"
+#include "API/Display/Render/blend_state.h"
+#include "API/Display/Render/blend_state_description.h"
+#include "API/Display/Render/depth_stencil_state.h"
+#include "API/Display/Render/depth_stencil_state_description.h"
+#include "API/Display/Render/element_array_buffer.h"
+#include "API/Display/Render/frame_buffer.h"
+#include "API/Display/Render/primitives_array.h"
+#include "API/Display/Render/program_object.h"
+#include "API/Display/Render/rasterizer_state.h"
+#include "API/Display/Render/rasterizer_state_description.h"
+#include "API/Display/Render/render_buffer.h"
+#include "API/Display/Render/shader_object.h"
+#include "API/Display/Render/storage_buffer.h"
+#include "API/Display/Render/texture_1d.h"
+#include "API/Display/Render/texture_1d_array.h"
+#include "API/Display/Render/texture_2d.h"
+#include "API/Display/Render/texture_2d_array.h"
+#include "API/Display/Render/texture_3d.h"
+#include "API/Display/Render/texture_cube.h"
+#include "API/Display/Render/texture_cube_array.h"
+#include "API/Display/Render/timer_query.h"
+#include "API/Display/Render/uniform_buffer.h"
+#include "API/Display/Render/vertex_array_buffer.h"
+#include "API/Display/Image/pixel_buffer.h"
+#include "API/Core/IOData/iodevice.h"
+#include "graphic_context_trace.h"
+#include <map>
+
+namespace clan
+{
+	class GraphicContextReplay_Impl
+	{
+	public:
+		void replay(GraphicContext &gc, std::vector<GraphicContextReplayCall> &calls);
+
+		std::vector<unsigned char> trace;
+		ShaderLanguage shader_language = shader_glsl;
+		Size size;
+		size_t commands_offset = 0;
+
+	private:
+		struct Buffer
+		{
+			GraphicContextTraceBufferKind kind = trace_vertex_buffer;
+			VertexArrayBuffer vertex_buffer;
+			ElementArrayBuffer element_buffer;
+			UniformBuffer uniform_buffer;
+			StorageBuffer storage_buffer;
+		};
+
+		struct PendingCall
+		{
+			size_t call_index;
+			TimerQuery query;
+		};
+
+		void define_buffer(GraphicContextTraceReader &reader);
+		void define_texture(GraphicContextTraceReader &reader);
+		void define_frame_buffer(GraphicContextTraceReader &reader);
+		void define_program(GraphicContextTraceReader &reader);
+		void define_primitives_array(GraphicContextTraceReader &reader);
+		void define_rasterizer_state(GraphicContextTraceReader &reader);
+		void define_blend_state(GraphicContextTraceReader &reader);
+		void define_depth_stencil_state(GraphicContextTraceReader &reader);
+
+		void upload_buffer(GraphicContextTraceReader &reader);
+		void upload_texture(GraphicContextTraceReader &reader);
+		void program_uniform(GraphicContextTraceReader &reader);
+
+		void execute(GraphicContextTraceReader &reader, GraphicContextTraceOp op);
+
+		void begin_call(GraphicContextReplayCallType type, const char *name, int64_t element_count, int resource_id);
+		void end_call();
+		void end_frame();
+		bool is_redundant(const std::vector<int> &key, const void *data, int size);
+		void clear_resources();
+
+		template<typename Type>
+		static Type find(const std::map<int, Type> &objects, int id)
+		{
+			auto it = objects.find(id);
+			return it != objects.end() ? it->second : Type();
+		}
+
+		GraphicContext gc;
+		std::vector<GraphicContextReplayCall> *calls = nullptr;
+		int frame = 0;
+		int command_index = 0;
+		int current_program = -1;
+
+		std::map<int, Buffer> buffers;
+		std::map<int, Texture> textures;
+		std::map<int, FrameBuffer> frame_buffers;
+		std::map<int, ProgramObject> programs;
+		std::map<int, PrimitivesArray> primitives_arrays;
+		std::map<int, RasterizerState> rasterizer_states;
+		std::map<int, BlendState> blend_states;
+		std::map<int, DepthStencilState> depth_stencil_states;
+
+		std::map<std::vector<int>, uint64_t> upload_hashes;
+		std::vector<TimerQuery> free_queries;
+		std::vector<PendingCall> pending_calls;
+	};
+
+	GraphicContextReplay::GraphicContextReplay()
+	{
+	}
+
+	GraphicContextReplay::GraphicContextReplay(IODevice &trace)
+		: impl(std::make_shared<GraphicContextReplay_Impl>())
+	{
+		IODevice device = trace;
+		impl->trace.resize((size_t)(device.get_size() - device.get_position()));
+		if (!impl->trace.empty())
+			device.read(impl->trace.data(), (int)impl->trace.size());
+
+		GraphicContextTraceReader reader(impl->trace.data(), impl->trace.size());
+		if (reader.read_uint32() != graphic_context_trace_magic)
+			throw Exception("Not a graphic context trace");
+		if (reader.read_uint32() != graphic_context_trace_version)
+			throw Exception("Unsupported graphic context trace version");
+		impl->shader_language = (ShaderLanguage)reader.read_int32();
+		impl->size.width = reader.read_int32();
+		impl->size.height = reader.read_int32();
+		impl->commands_offset = reader.get_position();
+	}
+
+	void GraphicContextReplay::throw_if_null() const
+	{
+		if (!impl)
+			throw Exception("GraphicContextReplay is null");
+	}
+
+	ShaderLanguage GraphicContextReplay::get_shader_language() const
+	{
+		return impl->shader_language;
+	}
+
+	Size GraphicContextReplay::get_size() const
+	{
+		return impl->size;
+	}
+
+	std::vector<GraphicContextReplayCall> GraphicContextReplay::replay(GraphicContext &gc)
+	{
+		if (gc.get_shader_language() != impl->shader_language)
+			throw Exception("The trace was captured with a different shader language than the graphic context uses");
+
+		std::vector<GraphicContextReplayCall> calls;
+		impl->replay(gc, calls);
+		return calls;
+	}
+
+	/////////////////////////////////////////////////////////////////////////
+
+	void GraphicContextReplay_Impl::replay(GraphicContext &target_gc, std::vector<GraphicContextReplayCall> &out_calls)
+	{
+		// Replay on a new default graphic context, so the state of the caller's graphic context is left alone
+		gc = target_gc.create();
+		calls = &out_calls;
+		frame = 0;
+		command_index = 0;
+		current_program = -1;
+
+		try
+		{
+			GraphicContextTraceReader reader(trace.data() + commands_offset, trace.size() - commands_offset);
+			while (!reader.at_end())
+				execute(reader, reader.read_op());
+			if (!pending_calls.empty())
+				end_frame();
+		}
+		catch (...)
+		{
+			clear_resources();
+			throw;
+		}
+		clear_resources();
+	}
+
+	void GraphicContextReplay_Impl::clear_resources()
+	{
+		pending_calls.clear();
+		buffers.clear();
+		textures.clear();
+		frame_buffers.clear();
+		programs.clear();
+		primitives_arrays.clear();
+		rasterizer_states.clear();
+		blend_states.clear();
+		depth_stencil_states.clear();
+		upload_hashes.clear();
+		gc = GraphicContext();
+		calls = nullptr;
+	}
+
+	void GraphicContextReplay_Impl::execute(GraphicContextTraceReader &reader, GraphicContextTraceOp op)
+	{
+		switch (op)
+		{
+		case trace_define_buffer: define_buffer(reader); break;
+		case trace_define_texture: define_texture(reader); break;
+		case trace_define_frame_buffer: define_frame_buffer(reader); break;
+		case trace_define_program: define_program(reader); break;
+		case trace_define_primitives_array: define_primitives_array(reader); break;
+		case trace_define_rasterizer_state: define_rasterizer_state(reader); break;
+		case trace_define_blend_state: define_blend_state(reader); break;
+		case trace_define_depth_stencil_state: define_depth_stencil_state(reader); break;
+		case trace_upload_buffer: upload_buffer(reader); break;
+		case trace_upload_texture: upload_texture(reader); break;
+		case trace_program_uniform: program_uniform(reader); break;
+
+		case trace_set_frame_buffer:
+		{
+			FrameBuffer write_buffer = find(frame_buffers, reader.read_int32());
+			FrameBuffer read_buffer = find(frame_buffers, reader.read_int32());
+			if (write_buffer.is_null() && read_buffer.is_null())
+				gc.reset_frame_buffer();
+			else
+				gc.set_frame_buffer(write_buffer, read_buffer);
+			break;
+		}
+		case trace_set_draw_buffer:
+			gc.set_draw_buffer((DrawBuffer)reader.read_int32());
+			break;
+		case trace_set_viewports:
+		{
+			// Viewports were recorded in the native direction of the y axis. Undo the flip set_viewport applies for bottom-up targets.
+			int count = reader.read_int32();
+			for (int index = 0; index < count; index++)
+			{
+				Rectf viewport;
+				viewport.left = reader.read_float();
+				viewport.top = reader.read_float();
+				viewport.right = reader.read_float();
+				viewport.bottom = reader.read_float();
+				if (gc.get_texture_image_y_axis() == y_axis_bottom_up)
+					viewport = Rectf(Pointf(viewport.left, gc.get_size().height - viewport.bottom), viewport.get_size());
+				gc.set_viewport(index, viewport);
+			}
+			break;
+		}
+		case trace_set_depth_ranges:
+		{
+			int count = reader.read_int32();
+			for (int index = 0; index < count; index++)
+			{
+				float n = reader.read_float();
+				float f = reader.read_float();
+				gc.set_depth_range(index, n, f);
+			}
+			break;
+		}
+		case trace_set_scissor:
+		{
+			bool scissor_set = reader.read_bool();
+			Rect rect;
+			rect.left = reader.read_int32();
+			rect.top = reader.read_int32();
+			rect.right = reader.read_int32();
+			rect.bottom = reader.read_int32();
+			if (scissor_set)
+				gc.set_scissor(rect, gc.get_texture_image_y_axis());
+			else
+				gc.reset_scissor();
+			break;
+		}
+		case trace_set_texture:
+		{
+			int unit = reader.read_int32();
+			Texture texture = find(textures, reader.read_int32());
+			if (texture.is_null())
+				gc.reset_texture(unit);
+			else
+				gc.set_texture(unit, texture);
+			break;
+		}
+		case trace_set_image_texture:
+		{
+			int unit = reader.read_int32();
+			Texture texture = find(textures, reader.read_int32());
+			if (texture.is_null())
+				gc.reset_image_texture(unit);
+			else
+				gc.set_image_texture(unit, texture);
+			break;
+		}
+		case trace_set_uniform_buffer:
+		{
+			int index = reader.read_int32();
+			UniformBuffer buffer = find(buffers, reader.read_int32()).uniform_buffer;
+			int offset = reader.read_int32();
+			int size = reader.read_int32();
+			if (buffer.is_null())
+				gc.reset_uniform_buffer(index);
+			else
+				gc.set_uniform_buffer(index, buffer, offset, size);
+			break;
+		}
+		case trace_set_storage_buffer:
+		{
+			int index = reader.read_int32();
+			StorageBuffer buffer = find(buffers, reader.read_int32()).storage_buffer;
+			if (buffer.is_null())
+				gc.reset_storage_buffer(index);
+			else
+				gc.set_storage_buffer(index, buffer);
+			break;
+		}
+		case trace_set_program:
+		{
+			current_program = reader.read_int32();
+			ProgramObject program = find(programs, current_program);
+			if (program.is_null())
+				gc.reset_program_object();
+			else
+				gc.set_program_object(program);
+			break;
+		}
+		case trace_set_rasterizer_state:
+		{
+			RasterizerState state = find(rasterizer_states, reader.read_int32());
+			if (state.is_null())
+				gc.reset_rasterizer_state();
+			else
+				gc.set_rasterizer_state(state);
+			break;
+		}
+		case trace_set_blend_state:
+		{
+			BlendState state = find(blend_states, reader.read_int32());
+			Colorf blend_color;
+			blend_color.r = reader.read_float();
+			blend_color.g = reader.read_float();
+			blend_color.b = reader.read_float();
+			blend_color.a = reader.read_float();
+			unsigned int sample_mask = reader.read_uint32();
+			if (state.is_null())
+				gc.reset_blend_state();
+			else
+				gc.set_blend_state(state, blend_color, sample_mask);
+			break;
+		}
+		case trace_set_depth_stencil_state:
+		{
+			DepthStencilState state = find(depth_stencil_states, reader.read_int32());
+			int stencil_ref = reader.read_int32();
+			if (state.is_null())
+				gc.reset_depth_stencil_state();
+			else
+				gc.set_depth_stencil_state(state, stencil_ref);
+			break;
+		}
+		case trace_set_primitives_array:
+		{
+			PrimitivesArray array = find(primitives_arrays, reader.read_int32());
+			if (array.is_null())
+				gc.reset_primitives_array();
+			else
+				gc.set_primitives_array(array);
+			break;
+		}
+		case trace_set_primitives_elements:
+		{
+			ElementArrayBuffer elements = find(buffers, reader.read_int32()).element_buffer;
+			if (elements.is_null())
+				gc.reset_primitives_elements();
+			else
+				gc.set_primitives_elements(elements);
+			break;
+		}
+
+		case trace_draw_primitives:
+		{
+			PrimitivesType type = (PrimitivesType)reader.read_int32();
+			int num_vertices = reader.read_int32();
+			PrimitivesArray array = find(primitives_arrays, reader.read_int32());
+			begin_call(replay_call_draw, "draw_primitives", num_vertices, current_program);
+			gc.draw_primitives(type, num_vertices, array);
+			end_call();
+			break;
+		}
+		case trace_draw_array:
+		{
+			PrimitivesType type = (PrimitivesType)reader.read_int32();
+			int offset = reader.read_int32();
+			int num_vertices = reader.read_int32();
+			int instance_count = reader.read_int32();
+			if (instance_count == 0)
+			{
+				begin_call(replay_call_draw, "draw_primitives_array", num_vertices, current_program);
+				gc.draw_primitives_array(type, offset, num_vertices);
+			}
+			else
+			{
+				begin_call(replay_call_draw, "draw_primitives_array_instanced", (int64_t)num_vertices * instance_count, current_program);
+				gc.draw_primitives_array_instanced(type, offset, num_vertices, instance_count);
+			}
+			end_call();
+			break;
+		}
+		case trace_draw_array_indirect:
+		{
+			PrimitivesType type = (PrimitivesType)reader.read_int32();
+			StorageBuffer commands = find(buffers, reader.read_int32()).storage_buffer;
+			size_t offset = (size_t)reader.read_uint64();
+			int draw_count = reader.read_int32();
+			int stride = reader.read_int32();
+			begin_call(replay_call_draw, "draw_primitives_array_indirect", draw_count, current_program);
+			gc.draw_primitives_array_indirect(type, commands, offset, draw_count, stride);
+			end_call();
+			break;
+		}
+		case trace_draw_elements:
+		{
+			PrimitivesType type = (PrimitivesType)reader.read_int32();
+			int count = reader.read_int32();
+			ElementArrayBuffer elements = find(buffers, reader.read_int32()).element_buffer;
+			VertexAttributeDataType indices_type = (VertexAttributeDataType)reader.read_int32();
+			size_t offset = (size_t)reader.read_uint64();
+			int instance_count = reader.read_int32();
+			int64_t element_count = instance_count == 0 ? count : (int64_t)count * instance_count;
+			begin_call(replay_call_draw, instance_count == 0 ? "draw_primitives_elements" : "draw_primitives_elements_instanced", element_count, current_program);
+			if (elements.is_null() && instance_count == 0)
+				gc.draw_primitives_elements(type, count, indices_type, offset);
+			else if (elements.is_null())
+				gc.draw_primitives_elements_instanced(type, count, indices_type, offset, instance_count);
+			else if (instance_count == 0)
+				gc.draw_primitives_elements(type, count, elements, indices_type, offset);
+			else
+				gc.draw_primitives_elements_instanced(type, count, elements, indices_type, offset, instance_count);
+			end_call();
+			break;
+		}
+		case trace_draw_elements_indirect:
+		{
+			PrimitivesType type = (PrimitivesType)reader.read_int32();
+			VertexAttributeDataType indices_type = (VertexAttributeDataType)reader.read_int32();
+			StorageBuffer commands = find(buffers, reader.read_int32()).storage_buffer;
+			size_t offset = (size_t)reader.read_uint64();
+			int draw_count = reader.read_int32();
+			int stride = reader.read_int32();
+			begin_call(replay_call_draw, "draw_primitives_elements_indirect", draw_count, current_program);
+			gc.draw_primitives_elements_indirect(type, indices_type, commands, offset, draw_count, stride);
+			end_call();
+			break;
+		}
+		case trace_dispatch:
+		{
+			int x = reader.read_int32();
+			int y = reader.read_int32();
+			int z = reader.read_int32();
+			bool barrier = reader.read_bool();
+			begin_call(replay_call_dispatch, barrier ? "dispatch" : "dispatch_no_barrier", (int64_t)x * y * z, current_program);
+			if (barrier)
+				gc.dispatch(x, y, z);
+			else
+				gc.dispatch_no_barrier(x, y, z);
+			end_call();
+			break;
+		}
+		case trace_memory_barrier:
+			gc.memory_barrier(reader.read_int32());
+			break;
+		case trace_invalidate_attachments:
+			gc.invalidate_attachments(reader.read_int32());
+			break;
+		case trace_clear:
+		{
+			Colorf color;
+			color.r = reader.read_float();
+			color.g = reader.read_float();
+			color.b = reader.read_float();
+			color.a = reader.read_float();
+			begin_call(replay_call_clear, "clear", 0, -1);
+			gc.clear(color);
+			end_call();
+			break;
+		}
+		case trace_clear_depth:
+		{
+			float value = reader.read_float();
+			begin_call(replay_call_clear, "clear_depth", 0, -1);
+			gc.clear_depth(value);
+			end_call();
+			break;
+		}
+		case trace_clear_stencil:
+		{
+			int value = reader.read_int32();
+			begin_call(replay_call_clear, "clear_stencil", 0, -1);
+			gc.clear_stencil(value);
+			end_call();
+			break;
+		}
+		case trace_end_frame:
+			end_frame();
+			break;
+		default:
+			throw Exception("Unknown command in graphic context trace");
+		}
+	}
+
+	void GraphicContextReplay_Impl::define_buffer(GraphicContextTraceReader &reader)
+	{
+		int id = reader.read_int32();
+		Buffer buffer;
+		buffer.kind = (GraphicContextTraceBufferKind)reader.read_uint8();
+		int size = reader.read_int32();
+		int stride = reader.read_int32();
+
+		// The recorded contents leave out trailing zeros
+		std::vector<unsigned char> contents;
+		const void *data = nullptr;
+		if (reader.read_bool())
+		{
+			int data_size = 0;
+			const unsigned char *block = reader.read_block(data_size);
+			if (data_size > size)
+				throw Exception("Graphic context trace is corrupt");
+			contents.resize(size);
+			memcpy(contents.data(), block, data_size);
+			data = contents.data();
+		}
+
+		switch (buffer.kind)
+		{
+		case trace_vertex_buffer:
+			buffer.vertex_buffer = data ? VertexArrayBuffer(gc, data, size) : VertexArrayBuffer(gc, size);
+			break;
+		case trace_element_buffer:
+			buffer.element_buffer = data ? ElementArrayBuffer(gc, data, size) : ElementArrayBuffer(gc, size);
+			break;
+		case trace_uniform_buffer:
+			buffer.uniform_buffer = data ? UniformBuffer(gc, data, size) : UniformBuffer(gc, size);
+			break;
+		case trace_storage_buffer:
+			buffer.storage_buffer = data ? StorageBuffer(gc, data, size, stride) : StorageBuffer(gc, size, stride);
+			break;
+		default:
+			throw Exception("Graphic context trace is corrupt");
+		}
+		buffers[id] = buffer;
+	}
+
+	void GraphicContextReplay_Impl::define_texture(GraphicContextTraceReader &reader)
+	{
+		int id = reader.read_int32();
+		TextureDimensions dimensions = (TextureDimensions)reader.read_int32();
+		int width = reader.read_int32();
+		int height = reader.read_int32();
+		int depth = reader.read_int32();
+		int array_size = reader.read_int32();
+		TextureFormat format = (TextureFormat)reader.read_int32();
+		int levels = reader.read_int32();
+
+		Texture texture;
+		switch (dimensions)
+		{
+		case texture_1d: texture = Texture1D(gc, width, format, levels); break;
+		case texture_1d_array: texture = Texture1DArray(gc, width, array_size, format, levels); break;
+		case texture_2d: texture = Texture2D(gc, width, height, format, levels); break;
+		case texture_2d_array: texture = Texture2DArray(gc, width, height, array_size, format, levels); break;
+		case texture_3d: texture = Texture3D(gc, width, height, depth, format, levels); break;
+		case texture_cube: texture = TextureCube(gc, width, height, format, levels); break;
+		case texture_cube_array: texture = TextureCubeArray(gc, width, height, array_size, format, levels); break;
+		default: throw Exception("Graphic context trace is corrupt");
+		}
+
+		if (reader.read_bool())
+		{
+			int image_width = reader.read_int32();
+			int image_height = reader.read_int32();
+			int data_size = 0;
+			const unsigned char *data = reader.read_block(data_size);
+
+			// The recorded pixels leave out trailing zeros
+			PixelBuffer image(image_width, image_height, format);
+			if ((int)image.get_data_size() < data_size)
+				throw Exception("Graphic context trace is corrupt");
+			memcpy(image.get_data(), data, data_size);
+			memset(image.get_data_uint8() + data_size, 0, image.get_data_size() - data_size);
+
+			Texture2D texture_2d = texture.to_texture_2d();
+			texture_2d.set_image(gc, image);
+			if (levels != 1)
+				texture.generate_mipmap();
+		}
+
+		textures[id] = texture;
+	}
+
+	void GraphicContextReplay_Impl::define_frame_buffer(GraphicContextTraceReader &reader)
+	{
+		int id = reader.read_int32();
+		int width = reader.read_int32();
+		int height = reader.read_int32();
+
+		// Only the size of a frame buffer is recorded. An rgba8 color buffer with a depth-stencil buffer stands in for its attachments.
+		FrameBuffer frame_buffer(gc);
+		frame_buffer.attach_color(0, Texture2D(gc, width, height, tf_rgba8));
+		frame_buffer.attach_depth_stencil(RenderBuffer(gc, width, height, tf_depth24_stencil8));
+		frame_buffers[id] = frame_buffer;
+	}
+
+	void GraphicContextReplay_Impl::define_program(GraphicContextTraceReader &reader)
+	{
+		int id = reader.read_int32();
+		ProgramObject program(gc);
+
+		int num_shaders = reader.read_int32();
+		for (int i = 0; i < num_shaders; i++)
+		{
+			ShaderType type = (ShaderType)reader.read_int32();
+			std::string source = reader.read_string();
+			ShaderObject shader(gc, type, source);
+			if (!shader.compile())
+				throw Exception("Unable to compile shader from graphic context trace: " + shader.get_info_log());
+			program.attach(shader);
+		}
+
+		int num_attributes = reader.read_int32();
+		for (int i = 0; i < num_attributes; i++)
+		{
+			int index = reader.read_int32();
+			program.bind_attribute_location(index, reader.read_string());
+		}
+
+		int num_frag_data = reader.read_int32();
+		for (int i = 0; i < num_frag_data; i++)
+		{
+			int color_number = reader.read_int32();
+			program.bind_frag_data_location(color_number, reader.read_string());
+		}
+
+		if (!program.link())
+			throw Exception("Unable to link program from graphic context trace: " + program.get_info_log());
+
+		int num_uniform_blocks = reader.read_int32();
+		for (int i = 0; i < num_uniform_blocks; i++)
+		{
+			int block_index = reader.read_int32();
+			program.set_uniform_buffer_index(block_index, reader.read_int32());
+		}
+
+		int num_storage_blocks = reader.read_int32();
+		for (int i = 0; i < num_storage_blocks; i++)
+		{
+			int block_index = reader.read_int32();
+			program.set_storage_buffer_index(block_index, reader.read_int32());
+		}
+
+		int num_int_uniforms = reader.read_int32();
+		for (int i = 0; i < num_int_uniforms; i++)
+		{
+			int location = reader.read_int32();
+			int size = reader.read_int32();
+			int data_size = 0;
+			const int *values = (const int *)reader.read_block(data_size);
+			if (size > 0)
+				program.set_uniformiv(location, size, data_size / (int)sizeof(int) / size, values);
+		}
+
+		programs[id] = program;
+	}
+
+	void GraphicContextReplay_Impl::define_primitives_array(GraphicContextTraceReader &reader)
+	{
+		int id = reader.read_int32();
+		PrimitivesArray array(gc);
+
+		int num_attributes = reader.read_int32();
+		for (int i = 0; i < num_attributes; i++)
+		{
+			int index = reader.read_int32();
+			VertexArrayBuffer buffer = find(buffers, reader.read_int32()).vertex_buffer;
+			int size = reader.read_int32();
+			VertexAttributeDataType type = (VertexAttributeDataType)reader.read_int32();
+			size_t offset = (size_t)reader.read_uint64();
+			int stride = reader.read_int32();
+			bool normalize = reader.read_bool();
+			array.set_attributes(index, buffer, size, type, offset, stride, normalize);
+		}
+
+		primitives_arrays[id] = array;
+	}
+
+	void GraphicContextReplay_Impl::define_rasterizer_state(GraphicContextTraceReader &reader)
+	{
+		int id = reader.read_int32();
+		RasterizerStateDescription desc;
+		desc.set_culled(reader.read_bool());
+		desc.enable_line_antialiasing(reader.read_bool());
+		desc.set_face_cull_mode((CullMode)reader.read_int32());
+		desc.set_face_fill_mode((FillMode)reader.read_int32());
+		desc.set_front_face((FaceSide)reader.read_int32());
+		desc.enable_scissor(reader.read_bool());
+		desc.enable_antialiased(reader.read_bool());
+		desc.enable_offset_point(reader.read_bool());
+		desc.enable_offset_line(reader.read_bool());
+		desc.enable_offset_fill(reader.read_bool());
+		float offset_factor = reader.read_float();
+		float offset_units = reader.read_float();
+		desc.set_polygon_offset(offset_factor, offset_units);
+		desc.set_point_size(reader.read_float());
+		desc.set_point_fade_treshold_size(reader.read_float());
+		desc.enable_point_size(reader.read_bool());
+		desc.set_point_sprite_origin((PointSpriteOrigin)reader.read_int32());
+		rasterizer_states[id] = RasterizerState(gc, desc);
+	}
+
+	void GraphicContextReplay_Impl::define_blend_state(GraphicContextTraceReader &reader)
+	{
+		int id = reader.read_int32();
+		BlendStateDescription desc;
+		desc.enable_blending(reader.read_bool());
+		BlendEquation equation_color = (BlendEquation)reader.read_int32();
+		BlendEquation equation_alpha = (BlendEquation)reader.read_int32();
+		desc.set_blend_equation(equation_color, equation_alpha);
+		BlendFunc src = (BlendFunc)reader.read_int32();
+		BlendFunc dest = (BlendFunc)reader.read_int32();
+		BlendFunc src_alpha = (BlendFunc)reader.read_int32();
+		BlendFunc dest_alpha = (BlendFunc)reader.read_int32();
+		desc.set_blend_function(src, dest, src_alpha, dest_alpha);
+		bool red = reader.read_bool();
+		bool green = reader.read_bool();
+		bool blue = reader.read_bool();
+		bool alpha = reader.read_bool();
+		desc.enable_color_write(red, green, blue, alpha);
+		desc.enable_logic_op(reader.read_bool());
+		desc.set_logic_op((LogicOp)reader.read_int32());
+		blend_states[id] = BlendState(gc, desc);
+	}
+
+	void GraphicContextReplay_Impl::define_depth_stencil_state(GraphicContextTraceReader &reader)
+	{
+		int id = reader.read_int32();
+		DepthStencilStateDescription desc;
+		desc.enable_stencil_test(reader.read_bool());
+		CompareFunction front_func = (CompareFunction)reader.read_int32();
+		int front_ref = reader.read_int32();
+		int front_mask = reader.read_int32();
+		desc.set_stencil_compare_front(front_func, front_ref, front_mask);
+		CompareFunction back_func = (CompareFunction)reader.read_int32();
+		int back_ref = reader.read_int32();
+		int back_mask = reader.read_int32();
+		desc.set_stencil_compare_back(back_func, back_ref, back_mask);
+		unsigned char front_write_mask = reader.read_uint8();
+		unsigned char back_write_mask = reader.read_uint8();
+		desc.set_stencil_write_mask(front_write_mask, back_write_mask);
+		StencilOp front_fail = (StencilOp)reader.read_int32();
+		StencilOp front_depth_fail = (StencilOp)reader.read_int32();
+		StencilOp front_pass = (StencilOp)reader.read_int32();
+		desc.set_stencil_op_front(front_fail, front_depth_fail, front_pass);
+		StencilOp back_fail = (StencilOp)reader.read_int32();
+		StencilOp back_depth_fail = (StencilOp)reader.read_int32();
+		StencilOp back_pass = (StencilOp)reader.read_int32();
+		desc.set_stencil_op_back(back_fail, back_depth_fail, back_pass);
+		desc.enable_depth_test(reader.read_bool());
+		desc.enable_depth_write(reader.read_bool());
+		desc.set_depth_compare_function((CompareFunction)reader.read_int32());
+		depth_stencil_states[id] = DepthStencilState(gc, desc);
+	}
+
+	void GraphicContextReplay_Impl::upload_buffer(GraphicContextTraceReader &reader)
+	{
+		int id = reader.read_int32();
+		int offset = reader.read_int32();
+		int size = 0;
+		const void *data = reader.read_block(size);
+
+		auto it = buffers.find(id);
+		if (it == buffers.end())
+			throw Exception("Graphic context trace is corrupt");
+		Buffer &buffer = it->second;
+
+		begin_call(replay_call_upload_buffer, "upload_data", 0, id);
+		calls->back().upload_size = size;
+		calls->back().redundant = is_redundant({ id, offset, size }, data, size);
+		switch (buffer.kind)
+		{
+		case trace_vertex_buffer: buffer.vertex_buffer.upload_data(gc, offset, data, size); break;
+		case trace_element_buffer: buffer.element_buffer.upload_data(gc, offset, data, size); break;
+		case trace_uniform_buffer: buffer.uniform_buffer.upload_data(gc, offset, data, size); break;
+		case trace_storage_buffer: buffer.storage_buffer.upload_data(gc, data, size); break;
+		}
+		end_call();
+	}
+
+	void GraphicContextReplay_Impl::upload_texture(GraphicContextTraceReader &reader)
+	{
+		int id = reader.read_int32();
+		int x = reader.read_int32();
+		int y = reader.read_int32();
+		int level = reader.read_int32();
+		TextureFormat format = (TextureFormat)reader.read_int32();
+		int width = reader.read_int32();
+		int height = reader.read_int32();
+		Rect src_rect;
+		src_rect.left = reader.read_int32();
+		src_rect.top = reader.read_int32();
+		src_rect.right = reader.read_int32();
+		src_rect.bottom = reader.read_int32();
+		int size = 0;
+		const void *data = reader.read_block(size);
+
+		PixelBuffer image(width, height, format, data, true);
+		if ((int)image.get_data_size() != size)
+			throw Exception("Graphic context trace is corrupt");
+
+		Texture2D texture = find(textures, id).to_texture_2d();
+		begin_call(replay_call_upload_texture, "set_subimage", 0, id);
+		calls->back().upload_size = size;
+		calls->back().redundant = is_redundant({ id, level, x, y, src_rect.left, src_rect.top, src_rect.right, src_rect.bottom }, data, size);
+		texture.set_subimage(gc, x, y, image, src_rect, level);
+		end_call();
+	}
+
+	void GraphicContextReplay_Impl::program_uniform(GraphicContextTraceReader &reader)
+	{
+		ProgramObject program = find(programs, reader.read_int32());
+		int location = reader.read_int32();
+		GraphicContextTraceUniformKind kind = (GraphicContextTraceUniformKind)reader.read_uint8();
+		int size = reader.read_int32();
+		int count = reader.read_int32();
+		bool transpose = reader.read_bool();
+		int num_values = kind == trace_uniform_matrix ? size * size * count : size * count;
+		std::vector<int> values(num_values);
+		reader.read(values.data(), values.size() * sizeof(int));
+
+		if (program.is_null())
+			throw Exception("Graphic context trace is corrupt");
+
+		switch (kind)
+		{
+		case trace_uniform_int: program.set_uniformiv(location, size, count, values.data()); break;
+		case trace_uniform_float: program.set_uniformfv(location, size, count, (const float *)values.data()); break;
+		case trace_uniform_matrix: program.set_uniform_matrix(location, size, count, transpose, (const float *)values.data()); break;
+		}
+	}
+
+	void GraphicContextReplay_Impl::begin_call(GraphicContextReplayCallType type, const char *name, int64_t element_count, int resource_id)
+	{
+		GraphicContextReplayCall call;
+		call.frame = frame;
+		call.command_index = command_index++;
+		call.type = type;
+		call.name = name;
+		call.element_count = element_count;
+		call.resource_id = resource_id;
+		calls->push_back(call);
+
+		PendingCall pending;
+		pending.call_index = calls->size() - 1;
+		if (!free_queries.empty())
+		{
+			pending.query = free_queries.back();
+			free_queries.pop_back();
+		}
+		else
+		{
+			pending.query = TimerQuery(gc);
+		}
+		pending.query.begin();
+		pending_calls.push_back(pending);
+	}
+
+	void GraphicContextReplay_Impl::end_call()
+	{
+		pending_calls.back().query.end();
+	}
+
+	void GraphicContextReplay_Impl::end_frame()
+	{
+		gc.flush();
+		for (PendingCall &pending : pending_calls)
+		{
+			(*calls)[pending.call_index].gpu_time = pending.query.get_result();
+			free_queries.push_back(pending.query);
+		}
+		pending_calls.clear();
+		frame++;
+		command_index = 0;
+	}
+
+	bool GraphicContextReplay_Impl::is_redundant(const std::vector<int> &key, const void *data, int size)
+	{
+		// FNV-1a
+		uint64_t hash = 14695981039346656037ULL;
+		const unsigned char *bytes = (const unsigned char *)data;
+		for (int i = 0; i < size; i++)
+			hash = (hash ^ bytes[i]) * 1099511628211ULL;
+
+		auto it = upload_hashes.find(key);
+		bool redundant = it != upload_hashes.end() && it->second == hash;
+		upload_hashes[key] = hash;
+		return redundant;
+	}
+}
@@ -42,6 +42,16 @@ namespace clan
 	class GraphicContext_State
 	{
 	public:
+		/// \brief Part of a uniform buffer bound to an index. A size of zero binds the whole buffer.
+		struct UniformBufferRange
+		{
+			UniformBufferRange() { }
+			UniformBufferRange(int offset, int size) : offset(offset), size(size) { }
+
+			int offset = 0;
+			int size = 0;
+		};
+
 		GraphicContext_State();
 		void copy_state(const GraphicContext_State *other);
 
@@ -51,6 +61,7 @@ namespace clan
 		std::vector<Texture> textures;
 		std::vector<Texture> image_textures;
 		std::vector<UniformBuffer> uniform_buffers;
+		std::vector<UniformBufferRange> uniform_buffer_ranges;
 		std::vector<StorageBuffer> storage_buffers;
 
 		Rect scissor;
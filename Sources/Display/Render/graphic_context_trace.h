@@ -0,0 +1,190 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include "API/Core/System/exception.h"
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace clan
+{
+	// Trace files start with the magic and version, followed by records that each begin with one of these codes.
+	// Values are stored in native byte order. Resource ids are -1 for none.
+	enum GraphicContextTraceOp
+	{
+		trace_define_buffer,
+		trace_define_texture,
+		trace_define_frame_buffer,
+		trace_define_program,
+		trace_define_primitives_array,
+		trace_define_rasterizer_state,
+		trace_define_blend_state,
+		trace_define_depth_stencil_state,
+		trace_upload_buffer,
+		trace_upload_texture,
+		trace_program_uniform,
+		trace_set_frame_buffer,
+		trace_set_draw_buffer,
+		trace_set_viewports,
+		trace_set_depth_ranges,
+		trace_set_scissor,
+		trace_set_texture,
+		trace_set_image_texture,
+		trace_set_uniform_buffer,
+		trace_set_storage_buffer,
+		trace_set_program,
+		trace_set_rasterizer_state,
+		trace_set_blend_state,
+		trace_set_depth_stencil_state,
+		trace_set_primitives_array,
+		trace_set_primitives_elements,
+		trace_draw_primitives,
+		trace_draw_array,
+		trace_draw_array_indirect,
+		trace_draw_elements,
+		trace_draw_elements_indirect,
+		trace_dispatch,
+		trace_memory_barrier,
+		trace_invalidate_attachments,
+		trace_clear,
+		trace_clear_depth,
+		trace_clear_stencil,
+		trace_end_frame
+	};
+
+	enum GraphicContextTraceBufferKind
+	{
+		trace_vertex_buffer,
+		trace_element_buffer,
+		trace_uniform_buffer,
+		trace_storage_buffer
+	};
+
+	enum GraphicContextTraceUniformKind
+	{
+		trace_uniform_int,
+		trace_uniform_float,
+		trace_uniform_matrix
+	};
+
+	static const unsigned int graphic_context_trace_magic = 0x54474c43; // "CLGT"
+	static const unsigned int graphic_context_trace_version = 1;
+
+	class GraphicContextTraceWriter
+	{
+	public:
+		void write_op(GraphicContextTraceOp op) { write_uint8((unsigned char)op); }
+		void write_uint8(unsigned char value) { data.push_back(value); }
+		void write_bool(bool value) { data.push_back(value ? 1 : 0); }
+		void write_int32(int value) { write(&value, sizeof(value)); }
+		void write_uint32(unsigned int value) { write(&value, sizeof(value)); }
+		void write_uint64(uint64_t value) { write(&value, sizeof(value)); }
+		void write_float(float value) { write(&value, sizeof(value)); }
+
+		void write_string(const std::string &value)
+		{
+			write_int32((int)value.size());
+			write(value.data(), value.size());
+		}
+
+		void write_block(const void *block, int size)
+		{
+			write_int32(size);
+			write(block, size);
+		}
+
+		void write(const void *block, size_t size)
+		{
+			size_t pos = data.size();
+			data.resize(pos + size);
+			if (size)
+				memcpy(data.data() + pos, block, size);
+		}
+
+		std::vector<unsigned char> data;
+	};
+
+	class GraphicContextTraceReader
+	{
+	public:
+		GraphicContextTraceReader(const unsigned char *data, size_t size) : start(data), pos(data), end(data + size) { }
+
+		bool at_end() const { return pos == end; }
+		size_t get_position() const { return pos - start; }
+
+		GraphicContextTraceOp read_op() { return (GraphicContextTraceOp)read_uint8(); }
+		unsigned char read_uint8() { unsigned char value; read(&value, sizeof(value)); return value; }
+		bool read_bool() { return read_uint8() != 0; }
+		int read_int32() { int value; read(&value, sizeof(value)); return value; }
+		unsigned int read_uint32() { unsigned int value; read(&value, sizeof(value)); return value; }
+		uint64_t read_uint64() { uint64_t value; read(&value, sizeof(value)); return value; }
+		float read_float() { float value; read(&value, sizeof(value)); return value; }
+
+		std::string read_string()
+		{
+			int size = read_size();
+			std::string value((const char *)pos, size);
+			pos += size;
+			return value;
+		}
+
+		// Returns a pointer to a block inside the trace, which stays valid as long as the trace data
+		const unsigned char *read_block(int &out_size)
+		{
+			out_size = read_size();
+			const unsigned char *block = pos;
+			pos += out_size;
+			return block;
+		}
+
+		void read(void *value, size_t size)
+		{
+			if ((size_t)(end - pos) < size)
+				throw Exception("Graphic context trace is truncated");
+			memcpy(value, pos, size);
+			pos += size;
+		}
+
+	private:
+		int read_size()
+		{
+			int size = read_int32();
+			if (size < 0 || size > end - pos)
+				throw Exception("Graphic context trace is truncated");
+			return size;
+		}
+
+		const unsigned char *start;
+		const unsigned char *pos;
+		const unsigned char *end;
+	};
+}
@@ -206,16 +206,13 @@ namespace clan
 		if (state == current)
 		{
 			if (active_state.uniform_buffers.size() < unit_index + 1)
-				active_state.uniform_buffers.resize(unit_index + 1);
-			active_state.uniform_buffers[unit_index] = state->uniform_buffers[unit_index];	// Copy to active state
-			if (state->uniform_buffers[unit_index].is_null())
-			{
-				provider->reset_uniform_buffer(unit_index);
-			}
-			else
 			{
-				provider->set_uniform_buffer(unit_index, state->uniform_buffers[unit_index]);
+				active_state.uniform_buffers.resize(unit_index + 1);
+				active_state.uniform_buffer_ranges.resize(unit_index + 1);
 			}
+			active_state.uniform_buffers[unit_index] = state->uniform_buffers[unit_index];	// Copy to active state
+			active_state.uniform_buffer_ranges[unit_index] = state->uniform_buffer_ranges[unit_index];
+			set_active_uniform_buffer(unit_index, state->uniform_buffers[unit_index], state->uniform_buffer_ranges[unit_index]);
 		}
 		else
 		{
@@ -424,18 +421,11 @@ namespace clan
 	{
 		int old_max_uniform_buffers = active_state.uniform_buffers.size();
 		active_state.uniform_buffers = state->uniform_buffers;
+		active_state.uniform_buffer_ranges = state->uniform_buffer_ranges;
 		unsigned int max_uniform_buffers = active_state.uniform_buffers.size();
 		for (unsigned int cnt = 0; cnt < max_uniform_buffers; cnt++)
 		{
-			UniformBuffer buffer = active_state.uniform_buffers[cnt];
-			if (buffer.is_null())
-			{
-				provider->reset_uniform_buffer(cnt);
-			}
-			else
-			{
-				provider->set_uniform_buffer(cnt, buffer);
-			}
+			set_active_uniform_buffer(cnt, active_state.uniform_buffers[cnt], active_state.uniform_buffer_ranges[cnt]);
 		}
 		for (unsigned int cnt = max_uniform_buffers; cnt < old_max_uniform_buffers; cnt++)
 		{
@@ -443,6 +433,22 @@ namespace clan
 		}
 	}
 
+	void GraphicScreen::set_active_uniform_buffer(int index, const UniformBuffer &buffer, const GraphicContext_State::UniformBufferRange &range)
+	{
+		if (buffer.is_null())
+		{
+			provider->reset_uniform_buffer(index);
+		}
+		else if (range.size != 0)
+		{
+			provider->set_uniform_buffer_range(index, buffer, range.offset, range.size);
+		}
+		else
+		{
+			provider->set_uniform_buffer(index, buffer);
+		}
+	}
+
 	void GraphicScreen::set_active_storage_buffers(GraphicContext_State *state)
 	{
 		int old_max_storage_buffers = active_state.storage_buffers.size();
@@ -33,6 +33,7 @@
 namespace clan
 {
 	class GraphicContextProvider;
+	class GraphicContextCapture_Impl;
 
 	class GraphicScreen
 	{
@@ -72,6 +73,7 @@ namespace clan
 		void set_active_textures(GraphicContext_State *state);
 		void set_active_image_textures(GraphicContext_State *state);
 		void set_active_uniform_buffers(GraphicContext_State *state);
+		void set_active_uniform_buffer(int index, const UniformBuffer &buffer, const GraphicContext_State::UniformBufferRange &range);
 		void set_active_storage_buffers(GraphicContext_State *state);
 		void set_active_scissor(GraphicContext_State *state);
 		void set_active_viewport(GraphicContext_State *state);
@@ -83,5 +85,8 @@ namespace clan
 		GraphicContextProvider *provider;
 		GraphicContext_State *current;
 		GraphicContext_State active_state;
+
+	public:
+		GraphicContextCapture_Impl *capture = nullptr;	// Set while the commands of this screen are being recorded
 	};
 }
@@ -0,0 +1,164 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Display/precomp.h"
+#include "API/Display/Render/pipeline_state.h"
+#include "API/Display/Render/program_object.h"
+#include "API/Display/Render/primitives_array.h"
+#include "API/Display/Render/rasterizer_state.h"
+#include "API/Display/Render/blend_state.h"
+#include "API/Display/Render/depth_stencil_state.h"
+#include "API/Display/Render/graphic_context.h"
+#include "API/Core/System/exception.h"
+
+namespace clan
+{
+	class PipelineState_Impl
+	{
+	public:
+		void update_hash()
+		{
+			const void *parts[] =
+			{
+				program.is_null() ? nullptr : program.get_provider(),
+				vertex_layout.is_null() ? nullptr : vertex_layout.get_provider(),
+				rasterizer_state.get_provider(),
+				blend_state.get_provider(),
+				depth_stencil_state.get_provider()
+			};
+
+			hash = 0;
+			for (const void *part : parts)
+				hash = hash * 31 + std::hash<const void *>()(part);
+			hash = hash * 31 + std::hash<unsigned int>()(sample_mask);
+			hash = hash * 31 + std::hash<int>()(stencil_ref);
+		}
+
+		ProgramObject program;
+		PrimitivesArray vertex_layout;
+		RasterizerState rasterizer_state;
+		BlendState blend_state;
+		DepthStencilState depth_stencil_state;
+		Colorf blend_color;
+		unsigned int sample_mask = 0xffffffff;
+		int stencil_ref = 0;
+		size_t hash = 0;
+	};
+
+	PipelineState::PipelineState()
+	{
+	}
+
+	PipelineState::PipelineState(const ProgramObject &program, const PrimitivesArray &vertex_layout, const RasterizerState &rasterizer_state, const BlendState &blend_state, const DepthStencilState &depth_stencil_state, const Colorf &blend_color, unsigned int sample_mask, int stencil_ref)
+		: impl(std::make_shared<PipelineState_Impl>())
+	{
+		impl->program = program;
+		impl->vertex_layout = vertex_layout;
+		impl->rasterizer_state = rasterizer_state;
+		impl->blend_state = blend_state;
+		impl->depth_stencil_state = depth_stencil_state;
+		impl->blend_color = blend_color;
+		impl->sample_mask = sample_mask;
+		impl->stencil_ref = stencil_ref;
+		impl->update_hash();
+	}
+
+	PipelineState::PipelineState(GraphicContext &gc, const ProgramObject &program, const PrimitivesArray &vertex_layout, const RasterizerStateDescription &rasterizer_desc, const BlendStateDescription &blend_desc, const DepthStencilStateDescription &depth_stencil_desc, const Colorf &blend_color, unsigned int sample_mask, int stencil_ref)
+		: PipelineState(program, vertex_layout, RasterizerState(gc, rasterizer_desc), BlendState(gc, blend_desc), DepthStencilState(gc, depth_stencil_desc), blend_color, sample_mask, stencil_ref)
+	{
+	}
+
+	void PipelineState::throw_if_null() const
+	{
+		if (!impl)
+			throw Exception("PipelineState is null");
+	}
+
+	const ProgramObject &PipelineState::get_program() const
+	{
+		return impl->program;
+	}
+
+	const PrimitivesArray &PipelineState::get_vertex_layout() const
+	{
+		return impl->vertex_layout;
+	}
+
+	const RasterizerState &PipelineState::get_rasterizer_state() const
+	{
+		return impl->rasterizer_state;
+	}
+
+	const BlendState &PipelineState::get_blend_state() const
+	{
+		return impl->blend_state;
+	}
+
+	const DepthStencilState &PipelineState::get_depth_stencil_state() const
+	{
+		return impl->depth_stencil_state;
+	}
+
+	const Colorf &PipelineState::get_blend_color() const
+	{
+		return impl->blend_color;
+	}
+
+	unsigned int PipelineState::get_sample_mask() const
+	{
+		return impl->sample_mask;
+	}
+
+	int PipelineState::get_stencil_ref() const
+	{
+		return impl->stencil_ref;
+	}
+
+	size_t PipelineState::get_hash() const
+	{
+		return impl ? impl->hash : 0;
+	}
+
+	bool PipelineState::operator==(const PipelineState &other) const
+	{
+		if (impl == other.impl)
+			return true;
+		if (!impl || !other.impl || impl->hash != other.impl->hash)
+			return false;
+
+		return impl->program == other.impl->program &&
+			impl->vertex_layout.is_null() == other.impl->vertex_layout.is_null() &&
+			(impl->vertex_layout.is_null() || impl->vertex_layout.get_provider() == other.impl->vertex_layout.get_provider()) &&
+			impl->rasterizer_state.get_provider() == other.impl->rasterizer_state.get_provider() &&
+			impl->blend_state.get_provider() == other.impl->blend_state.get_provider() &&
+			impl->depth_stencil_state.get_provider() == other.impl->depth_stencil_state.get_provider() &&
+			impl->blend_color == other.impl->blend_color &&
+			impl->sample_mask == other.impl->sample_mask &&
+			impl->stencil_ref == other.impl->stencil_ref;
+	}
+}
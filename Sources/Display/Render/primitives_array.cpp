@@ -34,6 +34,7 @@
 #include "API/Display/Render/vertex_array_buffer.h"
 #include "graphic_context_impl.h"
 #include "primitives_array_impl.h"
+#include <algorithm>
 
 namespace clan
 {
@@ -66,5 +67,12 @@ namespace clan
 	{
 		PrimitivesArrayProvider::VertexData data(buffer.get_provider(), type, offset, size, stride);
 		impl->provider->set_attribute(index, data, normalize);
+
+		PrimitivesArray_Impl::Attribute attribute = { index, buffer, size, type, offset, stride, normalize };
+		auto it = std::find_if(impl->attributes.begin(), impl->attributes.end(), [&](const PrimitivesArray_Impl::Attribute &a) { return a.index == index; });
+		if (it != impl->attributes.end())
+			*it = attribute;
+		else
+			impl->attributes.push_back(attribute);
 	}
 }
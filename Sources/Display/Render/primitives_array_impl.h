@@ -30,6 +30,8 @@
 #pragma once
 
 #include "API/Display/TargetProviders/primitives_array_provider.h"
+#include "API/Display/Render/vertex_array_buffer.h"
+#include <vector>
 
 namespace clan
 {
@@ -40,5 +42,18 @@ namespace clan
 		~PrimitivesArray_Impl() { if (provider) delete provider; }
 
 		PrimitivesArrayProvider *provider;
+
+		/// \brief Attribute as given to set_attributes, kept so the array can be described in a capture
+		struct Attribute
+		{
+			int index;
+			VertexArrayBuffer buffer;
+			int size;
+			VertexAttributeDataType type;
+			size_t offset;
+			int stride;
+			bool normalize;
+		};
+		std::vector<Attribute> attributes;
 	};
 }
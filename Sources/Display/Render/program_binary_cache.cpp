@@ -0,0 +1,145 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Display/precomp.h"
+#include "API/Display/Render/program_binary_cache.h"
+#include "API/Core/Crypto/sha1.h"
+#include "API/Core/IOData/directory.h"
+#include "API/Core/IOData/file.h"
+#include "API/Core/IOData/file_help.h"
+#include "API/Core/IOData/path_help.h"
+#include "API/Core/System/databuffer.h"
+#include <mutex>
+
+namespace clan
+{
+	namespace
+	{
+		std::mutex &get_cache_mutex()
+		{
+			static std::mutex mutex;
+			return mutex;
+		}
+
+		std::string &get_cache_directory()
+		{
+			static std::string directory;
+			return directory;
+		}
+
+		std::string get_filename(const std::string &key)
+		{
+			std::unique_lock<std::mutex> lock(get_cache_mutex());
+			if (get_cache_directory().empty())
+				return std::string();
+			return PathHelp::combine(get_cache_directory(), key + ".bin");
+		}
+	}
+
+	void ProgramBinaryCache::set_directory(const std::string &path)
+	{
+		if (!path.empty())
+			Directory::create(path, true);
+
+		std::unique_lock<std::mutex> lock(get_cache_mutex());
+		get_cache_directory() = path;
+	}
+
+	std::string ProgramBinaryCache::get_directory()
+	{
+		std::unique_lock<std::mutex> lock(get_cache_mutex());
+		return get_cache_directory();
+	}
+
+	bool ProgramBinaryCache::is_enabled()
+	{
+		std::unique_lock<std::mutex> lock(get_cache_mutex());
+		return !get_cache_directory().empty();
+	}
+
+	std::string ProgramBinaryCache::get_key(const std::string &text)
+	{
+		SHA1 sha1;
+		sha1.add(text.data(), text.length());
+		sha1.calculate();
+		return sha1.get_hash();
+	}
+
+	bool ProgramBinaryCache::contains(const std::string &key)
+	{
+		std::string filename = get_filename(key);
+		return !filename.empty() && FileHelp::file_exists(filename);
+	}
+
+	DataBuffer ProgramBinaryCache::load(const std::string &key)
+	{
+		std::string filename = get_filename(key);
+		if (filename.empty() || !FileHelp::file_exists(filename))
+			return DataBuffer();
+
+		try
+		{
+			return File::read_bytes(filename);
+		}
+		catch (const Exception &)
+		{
+			return DataBuffer();
+		}
+	}
+
+	void ProgramBinaryCache::save(const std::string &key, const DataBuffer &data)
+	{
+		std::string filename = get_filename(key);
+		if (filename.empty())
+			return;
+
+		// A partially written entry is harmless: the driver rejects it and it is replaced on the next save
+		try
+		{
+			File::write_bytes(filename, data);
+		}
+		catch (const Exception &)
+		{
+		}
+	}
+
+	void ProgramBinaryCache::remove(const std::string &key)
+	{
+		std::string filename = get_filename(key);
+		if (filename.empty() || !FileHelp::file_exists(filename))
+			return;
+
+		try
+		{
+			FileHelp::delete_file(filename);
+		}
+		catch (const Exception &)
+		{
+		}
+	}
+}
@@ -38,24 +38,17 @@
 #include "API/Core/Text/string_help.h"
 #include "API/Core/Text/string_format.h"
 #include "API/Core/IOData/iodevice.h"
+#include "program_object_impl.h"
+#include "graphic_context_capture_impl.h"
 
 namespace clan
 {
-	class ProgramObject_Impl
+	static void set_int_uniform(ProgramObject_Impl *impl, int location, int size, int count, const int *values)
 	{
-	public:
-		ProgramObject_Impl() : provider(nullptr)
-		{
-		}
-
-		~ProgramObject_Impl()
-		{
-			if (provider)
-				delete provider;
-		}
-
-		ProgramObjectProvider *provider;
-	};
+		impl->store_int_uniform(location, size, count, values);
+		if (GraphicContextCapture_Impl::is_any_active())
+			GraphicContextCapture_Impl::program_uniform(impl, location, trace_uniform_int, size, count, false, values);
+	}
 
 	ProgramObject::ProgramObject()
 	{
@@ -339,11 +332,13 @@ namespace clan
 	void ProgramObject::bind_attribute_location(int index, const std::string &name)
 	{
 		impl->provider->bind_attribute_location(index, name);
+		impl->attribute_bindings.push_back(std::make_pair(index, name));
 	}
 
 	void ProgramObject::bind_frag_data_location(int color_number, const std::string &name)
 	{
 		impl->provider->bind_frag_data_location(color_number, name);
+		impl->frag_data_bindings.push_back(std::make_pair(color_number, name));
 	}
 
 	bool ProgramObject::link()
@@ -361,75 +356,111 @@ namespace clan
 	void ProgramObject::set_uniform1i(int location, int v1)
 	{
 		impl->provider->set_uniform1i(location, v1);
+		int values[] = { v1 };
+		set_int_uniform(impl.get(), location, 1, 1, values);
 	}
 
 	void ProgramObject::set_uniform2i(int location, int v1, int v2)
 	{
 		impl->provider->set_uniform2i(location, v1, v2);
+		int values[] = { v1, v2 };
+		set_int_uniform(impl.get(), location, 2, 1, values);
 	}
 
 	void ProgramObject::set_uniform3i(int location, int v1, int v2, int v3)
 	{
 		impl->provider->set_uniform3i(location, v1, v2, v3);
+		int values[] = { v1, v2, v3 };
+		set_int_uniform(impl.get(), location, 3, 1, values);
 	}
 
 	void ProgramObject::set_uniform4i(int location, int v1, int v2, int v3, int v4)
 	{
 		impl->provider->set_uniform4i(location, v1, v2, v3, v4);
+		int values[] = { v1, v2, v3, v4 };
+		set_int_uniform(impl.get(), location, 4, 1, values);
 	}
 
 	void ProgramObject::set_uniformiv(int location, int size, int count, const int *data)
 	{
 		impl->provider->set_uniformiv(location, size, count, data);
+		set_int_uniform(impl.get(), location, size, count, data);
 	}
 
 	void ProgramObject::set_uniform1f(int location, float v1)
 	{
 		impl->provider->set_uniform1f(location, v1);
+		if (GraphicContextCapture_Impl::is_any_active())
+		{
+			float values[] = { v1 };
+			GraphicContextCapture_Impl::program_uniform(impl.get(), location, trace_uniform_float, 1, 1, false, values);
+		}
 	}
 
 	void ProgramObject::set_uniform2f(int location, float v1, float v2)
 	{
 		impl->provider->set_uniform2f(location, v1, v2);
+		if (GraphicContextCapture_Impl::is_any_active())
+		{
+			float values[] = { v1, v2 };
+			GraphicContextCapture_Impl::program_uniform(impl.get(), location, trace_uniform_float, 2, 1, false, values);
+		}
 	}
 
 	void ProgramObject::set_uniform3f(int location, float v1, float v2, float v3)
 	{
 		impl->provider->set_uniform3f(location, v1, v2, v3);
+		if (GraphicContextCapture_Impl::is_any_active())
+		{
+			float values[] = { v1, v2, v3 };
+			GraphicContextCapture_Impl::program_uniform(impl.get(), location, trace_uniform_float, 3, 1, false, values);
+		}
 	}
 
 	void ProgramObject::set_uniform4f(int location, float v1, float v2, float v3, float v4)
 	{
 		impl->provider->set_uniform4f(location, v1, v2, v3, v4);
+		if (GraphicContextCapture_Impl::is_any_active())
+		{
+			float values[] = { v1, v2, v3, v4 };
+			GraphicContextCapture_Impl::program_uniform(impl.get(), location, trace_uniform_float, 4, 1, false, values);
+		}
 	}
 
 	void ProgramObject::set_uniformfv(int location, int size, int count, const float *data)
 	{
 		impl->provider->set_uniformfv(location, size, count, data);
+		if (GraphicContextCapture_Impl::is_any_active())
+			GraphicContextCapture_Impl::program_uniform(impl.get(), location, trace_uniform_float, size, count, false, data);
 	}
 
 	void ProgramObject::set_uniform_matrix(int location, int size, int count, bool transpose, const float *data)
 	{
 		impl->provider->set_uniform_matrix(location, size, count, transpose, data);
+		if (GraphicContextCapture_Impl::is_any_active())
+			GraphicContextCapture_Impl::program_uniform(impl.get(), location, trace_uniform_matrix, size, count, transpose, data);
 	}
 
 	void ProgramObject::set_uniform_buffer_index(const std::string &name, int bind_index)
 	{
-		impl->provider->set_uniform_buffer_index(get_uniform_buffer_index(name), bind_index);
+		set_uniform_buffer_index(get_uniform_buffer_index(name), bind_index);
 	}
 
 	void ProgramObject::set_uniform_buffer_index(int block_index, int bind_index)
 	{
 		impl->provider->set_uniform_buffer_index(block_index, bind_index);
+		impl->uniform_buffer_bindings.push_back(std::make_pair(block_index, bind_index));
 	}
 
 	void ProgramObject::set_storage_buffer_index(const std::string &name, int bind_index)
 	{
-		impl->provider->set_storage_buffer_index(get_storage_buffer_index(name), bind_index);
+		set_storage_buffer_index(get_storage_buffer_index(name), bind_index);
 	}
 
 	void ProgramObject::set_storage_buffer_index(int block_index, int bind_index)
 	{
 		impl->provider->set_storage_buffer_index(block_index, bind_index);
+		impl->storage_buffer_bindings.push_back(std::make_pair(block_index, bind_index));
 	}
+
 }
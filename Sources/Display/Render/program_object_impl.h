@@ -0,0 +1,86 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include "API/Display/TargetProviders/program_object_provider.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace clan
+{
+	class ProgramObject_Impl
+	{
+	public:
+		ProgramObject_Impl() : provider(nullptr)
+		{
+		}
+
+		~ProgramObject_Impl()
+		{
+			if (provider)
+				delete provider;
+		}
+
+		/// \brief Remembers the current value of an integer uniform (usually a sampler unit)
+		void store_int_uniform(int location, int size, int count, const int *values)
+		{
+			IntUniform uniform;
+			uniform.location = location;
+			uniform.size = size;
+			uniform.values.assign(values, values + size * count);
+
+			for (auto &existing : int_uniforms)
+			{
+				if (existing.location == location)
+				{
+					existing = std::move(uniform);
+					return;
+				}
+			}
+			int_uniforms.push_back(std::move(uniform));
+		}
+
+		ProgramObjectProvider *provider;
+
+		// Bindings retained for GraphicContextCapture, as providers cannot report them back
+		struct IntUniform
+		{
+			int location;
+			int size;
+			std::vector<int> values;
+		};
+		std::vector<std::pair<int, std::string>> attribute_bindings;
+		std::vector<std::pair<int, std::string>> frag_data_bindings;
+		std::vector<std::pair<int, int>> uniform_buffer_bindings;
+		std::vector<std::pair<int, int>> storage_buffer_bindings;
+		std::vector<IntUniform> int_uniforms;
+	};
+}
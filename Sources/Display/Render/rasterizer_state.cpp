@@ -28,6 +28,7 @@
 
 #include "Display/precomp.h"
 #include "API/Display/Render/rasterizer_state.h"
+#include "API/Display/Render/rasterizer_state_description.h"
 #include "API/Display/Render/graphic_context.h"
 #include "API/Display/TargetProviders/graphic_context_provider.h"
 
@@ -38,7 +39,7 @@ namespace clan
 	}
 
 	RasterizerState::RasterizerState(GraphicContext &context, const RasterizerStateDescription &desc)
-		: provider(context.get_provider()->create_rasterizer_state(desc))
+		: provider(context.get_provider()->create_rasterizer_state(desc)), description(std::make_shared<RasterizerStateDescription>(desc.clone()))
 	{
 	}
 
@@ -46,4 +47,9 @@ namespace clan
 	{
 		return provider.get();
 	}
+
+	RasterizerStateDescription RasterizerState::get_description() const
+	{
+		return description ? description->clone() : RasterizerStateDescription();
+	}
 }
@@ -0,0 +1,198 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Display/precomp.h"
+#include "API/Display/Render/render_target_pool.h"
+#include "API/Display/Render/texture_2d.h"
+#include "API/Display/Render/render_buffer.h"
+#include "API/Display/Render/frame_buffer.h"
+#include "API/Core/System/exception.h"
+
+namespace clan
+{
+	class RenderTargetPool_Impl
+	{
+	public:
+		template<typename Type>
+		struct Entry
+		{
+			Type target;
+			Size size;
+			TextureFormat format;
+			int param;	// Mipmap levels for textures, sample count for render buffers
+			bool in_use;
+			int last_used_frame;
+		};
+
+		template<typename Type>
+		Entry<Type> *find_free(std::vector<Entry<Type>> &entries, const Size &size, TextureFormat format, int param)
+		{
+			for (auto &entry : entries)
+			{
+				if (!entry.in_use && entry.size == size && entry.format == format && entry.param == param)
+					return &entry;
+			}
+			return nullptr;
+		}
+
+		template<typename Type>
+		static void release(std::vector<Entry<Type>> &entries, const Type &target)
+		{
+			for (auto &entry : entries)
+			{
+				if (entry.target == target)
+				{
+					entry.in_use = false;
+					return;
+				}
+			}
+		}
+
+		template<typename Type>
+		void end_frame(std::vector<Entry<Type>> &entries)
+		{
+			for (auto &entry : entries)
+			{
+				if (entry.in_use)
+				{
+					entry.in_use = false;
+					entry.last_used_frame = frame;
+				}
+			}
+			entries.erase(std::remove_if(entries.begin(), entries.end(), [&](const Entry<Type> &entry) { return frame - entry.last_used_frame > max_unused_frames; }), entries.end());
+		}
+
+		template<typename Type>
+		static void clear(std::vector<Entry<Type>> &entries)
+		{
+			entries.erase(std::remove_if(entries.begin(), entries.end(), [](const Entry<Type> &entry) { return !entry.in_use; }), entries.end());
+		}
+
+		int max_unused_frames = 2;
+		int frame = 0;
+		std::vector<Entry<Texture2D>> textures;
+		std::vector<Entry<RenderBuffer>> render_buffers;
+		std::vector<Entry<FrameBuffer>> frame_buffers;
+	};
+
+	RenderTargetPool::RenderTargetPool()
+	{
+	}
+
+	RenderTargetPool::RenderTargetPool(int max_unused_frames)
+		: impl(std::make_shared<RenderTargetPool_Impl>())
+	{
+		impl->max_unused_frames = max_unused_frames;
+	}
+
+	void RenderTargetPool::throw_if_null() const
+	{
+		if (!impl)
+			throw Exception("RenderTargetPool is null");
+	}
+
+	Texture2D RenderTargetPool::acquire_texture(GraphicContext &gc, const Size &size, TextureFormat texture_format, int levels)
+	{
+		auto entry = impl->find_free(impl->textures, size, texture_format, levels);
+		if (!entry)
+		{
+			impl->textures.push_back({ Texture2D(gc, size, texture_format, levels), size, texture_format, levels, false, impl->frame });
+			entry = &impl->textures.back();
+		}
+		entry->in_use = true;
+		entry->last_used_frame = impl->frame;
+		return entry->target;
+	}
+
+	RenderBuffer RenderTargetPool::acquire_render_buffer(GraphicContext &gc, const Size &size, TextureFormat texture_format, int multisample_samples)
+	{
+		auto entry = impl->find_free(impl->render_buffers, size, texture_format, multisample_samples);
+		if (!entry)
+		{
+			impl->render_buffers.push_back({ RenderBuffer(gc, size.width, size.height, texture_format, multisample_samples), size, texture_format, multisample_samples, false, impl->frame });
+			entry = &impl->render_buffers.back();
+		}
+		entry->in_use = true;
+		entry->last_used_frame = impl->frame;
+		return entry->target;
+	}
+
+	FrameBuffer RenderTargetPool::acquire_frame_buffer(GraphicContext &gc)
+	{
+		auto entry = impl->find_free(impl->frame_buffers, Size(), tf_rgba8, 0);
+		if (!entry)
+		{
+			impl->frame_buffers.push_back({ FrameBuffer(gc), Size(), tf_rgba8, 0, false, impl->frame });
+			entry = &impl->frame_buffers.back();
+		}
+		else
+		{
+			// Load and store actions belong to the pass that set them
+			entry->target.set_load_action(load_action_load);
+			entry->target.set_store_action(store_action_store);
+		}
+		entry->in_use = true;
+		entry->last_used_frame = impl->frame;
+		return entry->target;
+	}
+
+	void RenderTargetPool::release(const Texture2D &texture)
+	{
+		impl->release(impl->textures, texture);
+	}
+
+	void RenderTargetPool::release(const RenderBuffer &render_buffer)
+	{
+		impl->release(impl->render_buffers, render_buffer);
+	}
+
+	void RenderTargetPool::release(const FrameBuffer &frame_buffer)
+	{
+		impl->release(impl->frame_buffers, frame_buffer);
+	}
+
+	void RenderTargetPool::end_frame()
+	{
+		impl->end_frame(impl->textures);
+		impl->end_frame(impl->render_buffers);
+		impl->end_frame(impl->frame_buffers);
+		impl->frame++;
+	}
+
+	void RenderTargetPool::clear()
+	{
+		impl->clear(impl->textures);
+		impl->clear(impl->render_buffers);
+		impl->clear(impl->frame_buffers);
+	}
+
+	int RenderTargetPool::get_target_count() const
+	{
+		return (int)(impl->textures.size() + impl->render_buffers.size() + impl->frame_buffers.size());
+	}
+}
@@ -33,6 +33,7 @@
 #include "API/Display/Render/graphic_context.h"
 #include "API/Display/TargetProviders/graphic_context_provider.h"
 #include "API/Core/System/exception.h"
+#include "graphic_context_capture_impl.h"
 
 namespace clan
 {
@@ -43,6 +44,8 @@ namespace clan
 		~StorageBuffer_Impl() { if (provider) delete provider; }
 
 		StorageBufferProvider *provider;
+		int size = 0;
+		int stride = 0;
 	};
 
 	StorageBuffer::StorageBuffer()
@@ -55,6 +58,8 @@ namespace clan
 		GraphicContextProvider *gc_provider = gc.get_provider();
 		impl->provider = gc_provider->alloc_storage_buffer();
 		impl->provider->create(size, stride, usage);
+		impl->size = size;
+		impl->stride = stride;
 	}
 
 	StorageBuffer::StorageBuffer(GraphicContext &gc, const void *data, int size, int stride, BufferUsage usage)
@@ -63,6 +68,8 @@ namespace clan
 		GraphicContextProvider *gc_provider = gc.get_provider();
 		impl->provider = gc_provider->alloc_storage_buffer();
 		impl->provider->create(data, size, stride, usage);
+		impl->size = size;
+		impl->stride = stride;
 	}
 
 	void StorageBuffer::throw_if_null() const
@@ -76,6 +83,16 @@ namespace clan
 		return impl->provider;
 	}
 
+	int StorageBuffer::get_size() const
+	{
+		return impl->size;
+	}
+
+	int StorageBuffer::get_stride() const
+	{
+		return impl->stride;
+	}
+
 	bool StorageBuffer::operator==(const StorageBuffer &other) const
 	{
 		return impl == other.impl;
@@ -83,6 +100,8 @@ namespace clan
 
 	void StorageBuffer::upload_data(GraphicContext &gc, const void *data, int size)
 	{
+		if (GraphicContextCapture_Impl *capture = GraphicContextCapture_Impl::get(gc))
+			capture->upload(*this, 0, data, size);
 		impl->provider->upload_data(gc, data, size);
 	}
 
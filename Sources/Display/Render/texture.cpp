@@ -208,6 +208,11 @@ namespace clan
 		return impl->resident;
 	}
 
+	int Texture::get_resident_mip() const
+	{
+		return impl->resident_mip;
+	}
+
 	TextureCompareMode Texture::get_compare_mode() const
 	{
 		return impl->compare_mode;
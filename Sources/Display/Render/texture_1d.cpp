@@ -51,6 +51,9 @@ namespace clan
 
 		impl->provider = gc_provider->alloc_texture(texture_1d);
 		impl->provider->create(size, 1, 1, 1, texture_format, levels);
+		impl->dimensions = texture_1d;
+		impl->texture_format = texture_format;
+		impl->levels = levels;
 		impl->width = size;
 
 		impl->provider->set_wrap_mode(impl->wrap_mode_s);
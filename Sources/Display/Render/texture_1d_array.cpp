@@ -51,6 +51,9 @@ namespace clan
 
 		impl->provider = gc_provider->alloc_texture(texture_1d_array);
 		impl->provider->create(size, 1, 1, array_size, texture_format, levels);
+		impl->dimensions = texture_1d_array;
+		impl->texture_format = texture_format;
+		impl->levels = levels;
 		impl->width = size;
 		impl->array_size = array_size;
 
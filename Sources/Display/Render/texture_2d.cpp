@@ -40,6 +40,7 @@
 #include "graphic_context_impl.h"
 #include "texture_impl.h"
 #include "API/Display/Resources/display_cache.h"
+#include "graphic_context_capture_impl.h"
 
 namespace clan
 {
@@ -59,6 +60,9 @@ namespace clan
 
 		impl->provider = gc_provider->alloc_texture(texture_2d);
 		impl->provider->create(width, height, 1, 1, texture_format, levels);
+		impl->dimensions = texture_2d;
+		impl->texture_format = texture_format;
+		impl->levels = levels;
 		impl->width = width;
 		impl->height = height;
 
@@ -77,6 +81,9 @@ namespace clan
 
 		impl->provider = gc_provider->alloc_texture(texture_2d);
 		impl->provider->create(size.width, size.height, 1, 1, texture_format, levels);
+		impl->dimensions = texture_2d;
+		impl->texture_format = texture_format;
+		impl->levels = levels;
 		impl->width = size.width;
 		impl->height = size.height;
 
@@ -163,16 +170,22 @@ namespace clan
 
 	void Texture2D::set_image(GraphicContext &context, const PixelBuffer &image, int level)
 	{
+		if (GraphicContextCapture_Impl *capture = GraphicContextCapture_Impl::get(context))
+			capture->upload(*this, 0, 0, level, image, image.get_size());
 		impl->provider->copy_from(context, 0, 0, 0, level, image, image.get_size());
 	}
 
 	void Texture2D::set_subimage(GraphicContext &context, int x, int y, const PixelBuffer &image, const Rect &src_rect, int level)
 	{
+		if (GraphicContextCapture_Impl *capture = GraphicContextCapture_Impl::get(context))
+			capture->upload(*this, x, y, level, image, src_rect);
 		impl->provider->copy_from(context, x, y, 0, level, image, src_rect);
 	}
 
 	void Texture2D::set_subimage(GraphicContext &context, const Point &point, const PixelBuffer &image, const Rect &src_rect, int level)
 	{
+		if (GraphicContextCapture_Impl *capture = GraphicContextCapture_Impl::get(context))
+			capture->upload(*this, point.x, point.y, level, image, src_rect);
 		impl->provider->copy_from(context, point.x, point.y, 0, level, image, src_rect);
 	}
 
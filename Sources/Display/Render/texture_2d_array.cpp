@@ -50,6 +50,9 @@ namespace clan
 		GraphicContextProvider *gc_provider = context.get_provider();
 		impl->provider = gc_provider->alloc_texture(texture_2d_array);
 		impl->provider->create(width, height, 1, array_size, texture_format, levels);
+		impl->dimensions = texture_2d_array;
+		impl->texture_format = texture_format;
+		impl->levels = levels;
 		impl->width = width;
 		impl->height = height;
 		impl->array_size = array_size;
@@ -66,6 +69,9 @@ namespace clan
 		GraphicContextProvider *gc_provider = context.get_provider();
 		impl->provider = gc_provider->alloc_texture(texture_2d_array);
 		impl->provider->create(size.width, size.height, 1, array_size, texture_format, levels);
+		impl->dimensions = texture_2d_array;
+		impl->texture_format = texture_format;
+		impl->levels = levels;
 		impl->width = size.width;
 		impl->height = size.height;
 		impl->array_size = array_size;
@@ -131,6 +137,9 @@ namespace clan
 		view.impl->height = impl->height;
 		view.impl->array_size = impl->array_size;
 		view.impl->provider = impl->provider->create_view(texture_2d, texture_format, min_level, num_levels, array_index, 1);
+		view.impl->dimensions = texture_2d;
+		view.impl->texture_format = texture_format;
+		view.impl->levels = num_levels;
 		return view.to_texture_2d();
 	}
 
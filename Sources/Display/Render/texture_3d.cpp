@@ -52,6 +52,9 @@ namespace clan
 
 		impl->provider = gc_provider->alloc_texture(texture_3d);
 		impl->provider->create(width, height, depth, 1, texture_format, levels);
+		impl->dimensions = texture_3d;
+		impl->texture_format = texture_format;
+		impl->levels = levels;
 		impl->width = width;
 		impl->height = height;
 		impl->depth = depth;
@@ -71,6 +74,9 @@ namespace clan
 
 		impl->provider = gc_provider->alloc_texture(texture_3d);
 		impl->provider->create(size.x, size.y, size.z, 1, texture_format, levels);
+		impl->dimensions = texture_3d;
+		impl->texture_format = texture_format;
+		impl->levels = levels;
 		impl->width = size.x;
 		impl->height = size.y;
 		impl->depth = size.z;
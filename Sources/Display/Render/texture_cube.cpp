@@ -51,6 +51,9 @@ namespace clan
 
 		impl->provider = gc_provider->alloc_texture(texture_cube);
 		impl->provider->create(width, height, 1, 1, texture_format, levels);
+		impl->dimensions = texture_cube;
+		impl->texture_format = texture_format;
+		impl->levels = levels;
 		impl->width = width;
 		impl->height = height;
 
@@ -69,6 +72,9 @@ namespace clan
 
 		impl->provider = gc_provider->alloc_texture(texture_cube);
 		impl->provider->create(size.width, size.height, 1, 1, texture_format, levels);
+		impl->dimensions = texture_cube;
+		impl->texture_format = texture_format;
+		impl->levels = levels;
 		impl->width = size.width;
 		impl->height = size.height;
 
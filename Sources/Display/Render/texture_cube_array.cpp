@@ -51,6 +51,9 @@ namespace clan
 
 		impl->provider = gc_provider->alloc_texture(texture_cube_array);
 		impl->provider->create(width, height, 1, array_size, texture_format, levels);
+		impl->dimensions = texture_cube_array;
+		impl->texture_format = texture_format;
+		impl->levels = levels;
 		impl->width = width;
 		impl->height = height;
 		impl->array_size = array_size;
@@ -70,6 +73,9 @@ namespace clan
 
 		impl->provider = gc_provider->alloc_texture(texture_cube_array);
 		impl->provider->create(size.width, size.height, 1, array_size, texture_format, levels);
+		impl->dimensions = texture_cube_array;
+		impl->texture_format = texture_format;
+		impl->levels = levels;
 		impl->width = size.width;
 		impl->height = size.height;
 		impl->array_size = array_size;
@@ -32,4 +32,16 @@
 
 namespace clan
 {
+	void Texture_Impl::replace_provider(TextureProvider *new_provider)
+	{
+		new_provider->set_wrap_mode(wrap_mode_s, wrap_mode_t);
+		new_provider->set_min_filter(min_filter);
+		new_provider->set_mag_filter(mag_filter);
+		new_provider->set_max_anisotropy(max_anisotropy);
+		new_provider->set_lod_bias(lod_bias);
+		new_provider->set_texture_compare(compare_mode, compare_function);
+
+		delete provider;
+		provider = new_provider;
+	}
 }
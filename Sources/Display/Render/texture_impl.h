@@ -91,5 +91,14 @@ namespace clan
 		CompareFunction compare_function;
 
 		float pixel_ratio = 0.0f;
+		int resident_mip = 0;
+
+		// Parameters the provider was created with
+		TextureDimensions dimensions = texture_2d;
+		TextureFormat texture_format = tf_rgba8;
+		int levels = 0;
+
+		/// \brief Replaces the provider of a 2D texture with one holding a different set of mip levels, keeping the sampler state
+		void replace_provider(TextureProvider *new_provider);
 	};
 }
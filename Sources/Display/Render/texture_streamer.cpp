@@ -0,0 +1,312 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Display/precomp.h"
+#include "API/Display/Render/texture_streamer.h"
+#include "API/Display/Render/graphic_context.h"
+#include "API/Display/TargetProviders/graphic_context_provider.h"
+#include "API/Display/ImageProviders/dds_provider.h"
+#include "API/Display/ImageProviders/ktx2_provider.h"
+#include "API/Display/Image/pixel_buffer.h"
+#include "API/Display/Image/pixel_buffer_set.h"
+#include "API/Core/IOData/path_help.h"
+#include "API/Core/Math/cl_math.h"
+#include "API/Core/System/exception.h"
+#include "API/Core/System/work_queue.h"
+#include "API/Core/Text/string_help.h"
+#include "texture_impl.h"
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace clan
+{
+	namespace
+	{
+		WorkQueue &get_streaming_queue()
+		{
+			static WorkQueue queue;
+			return queue;
+		}
+	}
+
+	class StreamedTexture
+	{
+	public:
+		std::string fullname;
+		std::weak_ptr<Texture_Impl> texture;
+		TextureFormat format = tf_rgba8;
+		int width = 0;
+		int height = 0;
+		int levels = 0;
+		size_t resident_bytes = 0;
+
+		int tail_level = 0;				// Most detailed level of the tail that always stays resident
+		std::vector<PixelBuffer> tail;	// System memory copy of the tail, used when evicting
+
+		int wanted_level = 0;
+		int last_request_frame = -1;
+		bool loading = false;
+		int loading_level = 0;
+
+		// Written by the worker thread
+		std::mutex mutex;
+		bool load_finished = false;
+		PixelBufferSet loaded;
+
+		size_t get_resident_bytes(int first_level) const
+		{
+			size_t bytes = 0;
+			for (int level = first_level; level < levels; level++)
+				bytes += PixelBuffer::get_data_size(Size(max(width >> level, 1), max(height >> level, 1)), format);
+			return bytes;
+		}
+	};
+
+	class TextureStreamer_Impl
+	{
+	public:
+		static const int tail_size = 64;
+
+		size_t memory_budget = 0;
+		size_t memory_usage = 0;
+		int frame = 0;
+		std::map<Texture_Impl *, std::shared_ptr<StreamedTexture> > textures;
+
+		static PixelBufferSet load_file(const std::string &fullname);
+
+		void make_resident(GraphicContext &gc, StreamedTexture &entry, Texture_Impl &texture, int first_level, const std::vector<PixelBuffer> &images);
+		void evict(GraphicContext &gc, size_t needed_bytes, const StreamedTexture *keep);
+	};
+
+	TextureStreamer::TextureStreamer()
+	{
+	}
+
+	TextureStreamer::TextureStreamer(size_t memory_budget)
+		: impl(std::make_shared<TextureStreamer_Impl>())
+	{
+		impl->memory_budget = memory_budget;
+	}
+
+	size_t TextureStreamer::get_memory_usage() const
+	{
+		return impl->memory_usage;
+	}
+
+	size_t TextureStreamer::get_memory_budget() const
+	{
+		return impl->memory_budget;
+	}
+
+	void TextureStreamer::set_memory_budget(size_t memory_budget)
+	{
+		impl->memory_budget = memory_budget;
+	}
+
+	Texture2D TextureStreamer::load(GraphicContext &gc, const std::string &fullname)
+	{
+		PixelBufferSet set = TextureStreamer_Impl::load_file(fullname);
+		if (set.get_dimensions() != texture_2d)
+			throw Exception("TextureStreamer can only stream 2D textures");
+
+		auto entry = std::make_shared<StreamedTexture>();
+		entry->fullname = fullname;
+		entry->format = set.get_format();
+		entry->width = set.get_width();
+		entry->height = set.get_height();
+		entry->levels = set.get_max_level() + 1;
+
+		while (entry->tail_level + 1 < entry->levels && max(entry->width >> entry->tail_level, entry->height >> entry->tail_level) > TextureStreamer_Impl::tail_size)
+			entry->tail_level++;
+		for (int level = entry->tail_level; level < entry->levels; level++)
+			entry->tail.push_back(set.get_image(0, level));
+		entry->wanted_level = entry->tail_level;
+
+		auto texture_impl = std::make_shared<Texture_Impl>();
+		texture_impl->width = entry->width;
+		texture_impl->height = entry->height;
+		entry->texture = texture_impl;
+
+		impl->make_resident(gc, *entry, *texture_impl, entry->tail_level, entry->tail);
+		impl->textures[texture_impl.get()] = entry;
+		return Texture2D(texture_impl);
+	}
+
+	void TextureStreamer::request(const Texture &texture, float screen_size)
+	{
+		std::shared_ptr<Texture_Impl> texture_impl = texture.get_impl().lock();
+		auto it = impl->textures.find(texture_impl.get());
+		if (it == impl->textures.end())
+			return;
+
+		StreamedTexture &entry = *it->second;
+		int level = 0;
+		float size = (float)max(entry.width, entry.height);
+		while (level < entry.tail_level && size * 0.5f >= screen_size)
+		{
+			size *= 0.5f;
+			level++;
+		}
+
+		// The texture may be drawn several times in a frame, so keep the most detailed request
+		if (entry.last_request_frame == impl->frame)
+			entry.wanted_level = min(entry.wanted_level, level);
+		else
+			entry.wanted_level = level;
+		entry.last_request_frame = impl->frame;
+	}
+
+	void TextureStreamer::update(GraphicContext &gc)
+	{
+		for (auto it = impl->textures.begin(); it != impl->textures.end();)
+		{
+			std::shared_ptr<StreamedTexture> entry = it->second;
+			std::shared_ptr<Texture_Impl> texture_impl = entry->texture.lock();
+			if (!texture_impl)
+			{
+				impl->memory_usage -= entry->resident_bytes;
+				it = impl->textures.erase(it);
+				continue;
+			}
+			++it;
+
+			if (entry->loading)
+			{
+				PixelBufferSet loaded;
+				{
+					std::unique_lock<std::mutex> lock(entry->mutex);
+					if (!entry->load_finished)
+						continue;
+					loaded = entry->loaded;
+					entry->loaded = PixelBufferSet();
+					entry->load_finished = false;
+				}
+				entry->loading = false;
+
+				// A failed load leaves the texture at its current levels
+				int first_level = max(entry->loading_level, entry->wanted_level);
+				if (loaded.is_null() || first_level >= texture_impl->resident_mip)
+					continue;
+
+				impl->evict(gc, entry->get_resident_bytes(first_level) - entry->resident_bytes, entry.get());
+				while (first_level < texture_impl->resident_mip && impl->memory_usage - entry->resident_bytes + entry->get_resident_bytes(first_level) > impl->memory_budget)
+					first_level++;
+				if (first_level >= texture_impl->resident_mip)
+					continue;
+
+				std::vector<PixelBuffer> images;
+				for (int level = first_level; level < entry->levels; level++)
+					images.push_back(loaded.get_image(0, level));
+				impl->make_resident(gc, *entry, *texture_impl, first_level, images);
+			}
+			else if (entry->wanted_level < texture_impl->resident_mip && entry->last_request_frame == impl->frame)
+			{
+				entry->loading = true;
+				entry->loading_level = entry->wanted_level;
+				get_streaming_queue().queue([entry]()
+				{
+					PixelBufferSet loaded;
+					try
+					{
+						loaded = TextureStreamer_Impl::load_file(entry->fullname);
+					}
+					catch (...)
+					{
+					}
+					std::unique_lock<std::mutex> lock(entry->mutex);
+					entry->loaded = loaded;
+					entry->load_finished = true;
+				});
+			}
+		}
+
+		if (impl->memory_usage > impl->memory_budget)
+			impl->evict(gc, 0, nullptr);
+
+		impl->frame++;
+	}
+
+	PixelBufferSet TextureStreamer_Impl::load_file(const std::string &fullname)
+	{
+		std::string extension = StringHelp::text_to_lower(PathHelp::get_extension(fullname));
+		if (extension == "ktx2")
+			return KTX2Provider::load(fullname);
+		else if (extension == "dds")
+			return DDSProvider::load(fullname);
+		else
+			throw Exception("TextureStreamer only supports .dds and .ktx2 files");
+	}
+
+	void TextureStreamer_Impl::make_resident(GraphicContext &gc, StreamedTexture &entry, Texture_Impl &texture, int first_level, const std::vector<PixelBuffer> &images)
+	{
+		// The texture keeps its full resolution size, so texture coordinates are not affected by which levels are resident
+		std::unique_ptr<TextureProvider> provider(gc.get_provider()->alloc_texture(texture_2d));
+		provider->create(max(entry.width >> first_level, 1), max(entry.height >> first_level, 1), 1, 1, entry.format, entry.levels - first_level);
+		for (size_t i = 0; i < images.size(); i++)
+			provider->copy_from(gc, 0, 0, 0, (int)i, images[i], images[i].get_size());
+
+		if (texture.provider)
+			texture.replace_provider(provider.release());
+		else
+			texture.provider = provider.release();
+		texture.texture_format = entry.format;
+		texture.levels = entry.levels - first_level;
+
+		memory_usage -= entry.resident_bytes;
+		entry.resident_bytes = entry.get_resident_bytes(first_level);
+		memory_usage += entry.resident_bytes;
+		texture.resident_mip = first_level;
+	}
+
+	void TextureStreamer_Impl::evict(GraphicContext &gc, size_t needed_bytes, const StreamedTexture *keep)
+	{
+		while (memory_usage + needed_bytes > memory_budget)
+		{
+			// Evict the texture that was requested least recently
+			StreamedTexture *oldest = nullptr;
+			std::shared_ptr<Texture_Impl> oldest_texture;
+			for (auto &it : textures)
+			{
+				StreamedTexture *entry = it.second.get();
+				std::shared_ptr<Texture_Impl> texture = entry->texture.lock();
+				if (entry == keep || !texture || texture->resident_mip >= entry->tail_level)
+					continue;
+				if (!oldest || entry->last_request_frame < oldest->last_request_frame)
+				{
+					oldest = entry;
+					oldest_texture = texture;
+				}
+			}
+
+			if (!oldest)
+				break;
+			make_resident(gc, *oldest, *oldest_texture, oldest->tail_level, oldest->tail);
+		}
+	}
+}
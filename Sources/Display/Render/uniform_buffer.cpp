@@ -33,6 +33,7 @@
 #include "API/Display/Render/graphic_context.h"
 #include "API/Display/TargetProviders/graphic_context_provider.h"
 #include "API/Core/System/exception.h"
+#include "graphic_context_capture_impl.h"
 
 namespace clan
 {
@@ -44,6 +45,7 @@ namespace clan
 
 		int lock_count;
 		UniformBufferProvider *provider;
+		int size = 0;
 	};
 
 	UniformBuffer::UniformBuffer()
@@ -56,6 +58,7 @@ namespace clan
 		GraphicContextProvider *gc_provider = gc.get_provider();
 		impl->provider = gc_provider->alloc_uniform_buffer();
 		impl->provider->create(size, usage);
+		impl->size = size;
 	}
 
 	UniformBuffer::UniformBuffer(GraphicContext &gc, const void *data, int size, BufferUsage usage)
@@ -64,6 +67,7 @@ namespace clan
 		GraphicContextProvider *gc_provider = gc.get_provider();
 		impl->provider = gc_provider->alloc_uniform_buffer();
 		impl->provider->create(data, size, usage);
+		impl->size = size;
 	}
 
 	UniformBuffer::UniformBuffer(GraphicContext &gc, ProgramObject &program, const std::string &name, int num_blocks, BufferUsage usage)
@@ -71,7 +75,8 @@ namespace clan
 	{
 		GraphicContextProvider *gc_provider = gc.get_provider();
 		impl->provider = gc_provider->alloc_uniform_buffer();
-		impl->provider->create(program.get_uniform_buffer_size(name) * num_blocks, usage);
+		impl->size = program.get_uniform_buffer_size(name) * num_blocks;
+		impl->provider->create(impl->size, usage);
 	}
 
 	void UniformBuffer::throw_if_null() const
@@ -85,6 +90,11 @@ namespace clan
 		return impl->provider;
 	}
 
+	int UniformBuffer::get_size() const
+	{
+		return impl->size;
+	}
+
 	bool UniformBuffer::operator==(const UniformBuffer &other) const
 	{
 		return impl == other.impl;
@@ -92,9 +102,25 @@ namespace clan
 
 	void UniformBuffer::upload_data(GraphicContext &gc, const void *data, int size)
 	{
+		if (GraphicContextCapture_Impl *capture = GraphicContextCapture_Impl::get(gc))
+			capture->upload(*this, 0, data, size);
 		impl->provider->upload_data(gc, data, size);
 	}
 
+	void UniformBuffer::upload_data(GraphicContext &gc, int offset, const void *data, int size)
+	{
+		if (GraphicContextCapture_Impl *capture = GraphicContextCapture_Impl::get(gc))
+			capture->upload(*this, offset, data, size);
+		impl->provider->upload_data(gc, offset, data, size);
+	}
+
+	void UniformBuffer::upload_data_unsynchronized(GraphicContext &gc, int offset, const void *data, int size, bool discard)
+	{
+		if (GraphicContextCapture_Impl *capture = GraphicContextCapture_Impl::get(gc))
+			capture->upload(*this, offset, data, size);
+		impl->provider->upload_data_unsynchronized(gc, offset, data, size, discard);
+	}
+
 	void UniformBuffer::copy_from(GraphicContext &gc, TransferBuffer &buffer, int dest_pos, int src_pos, int size)
 	{
 		impl->provider->copy_from(gc, buffer, dest_pos, src_pos, size);
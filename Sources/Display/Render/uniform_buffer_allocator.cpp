@@ -0,0 +1,125 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Display/precomp.h"
+#include "API/Display/Render/uniform_buffer_allocator.h"
+#include "API/Display/Render/graphic_context.h"
+#include "API/Core/System/exception.h"
+
+namespace clan
+{
+	class UniformBufferAllocator_Impl
+	{
+	public:
+		struct Frame
+		{
+			std::vector<UniformBuffer> pages;
+			int current_page = 0;
+			int position = 0;
+		};
+
+		int page_size = 0;
+		int alignment = 256;
+		std::vector<Frame> frames;
+		int current_frame = 0;
+	};
+
+	UniformBufferAllocator::UniformBufferAllocator()
+	{
+	}
+
+	UniformBufferAllocator::UniformBufferAllocator(GraphicContext &gc, int page_size, int frames_in_flight)
+		: impl(std::make_shared<UniformBufferAllocator_Impl>())
+	{
+		if (page_size <= 0 || frames_in_flight <= 0)
+			throw Exception("Invalid uniform buffer allocator size");
+
+		impl->page_size = page_size;
+		impl->alignment = std::max(gc.get_uniform_buffer_alignment(), 1);
+		impl->frames.resize(frames_in_flight);
+	}
+
+	void UniformBufferAllocator::throw_if_null() const
+	{
+		if (!impl)
+			throw Exception("UniformBufferAllocator is null");
+	}
+
+	UniformBufferAllocation UniformBufferAllocator::allocate(GraphicContext &gc, const void *data, int size)
+	{
+		if (size <= 0 || size > impl->page_size)
+			throw Exception("Uniform block does not fit in a uniform buffer allocator page");
+
+		UniformBufferAllocator_Impl::Frame &frame = impl->frames[impl->current_frame];
+
+		int offset = (frame.position + impl->alignment - 1) / impl->alignment * impl->alignment;
+		if (frame.current_page < (int)frame.pages.size() && offset + size > impl->page_size)
+		{
+			frame.current_page++;
+			offset = 0;
+		}
+
+		if (frame.current_page == (int)frame.pages.size())
+			frame.pages.push_back(UniformBuffer(gc, impl->page_size, usage_stream_draw));
+
+		UniformBufferAllocation allocation;
+		allocation.buffer = frame.pages[frame.current_page];
+		allocation.offset = offset;
+		allocation.size = size;
+
+		// Earlier blocks of this page may still be read by queued draws, but not the range written here
+		allocation.buffer.upload_data_unsynchronized(gc, offset, data, size);
+		frame.position = offset + size;
+		return allocation;
+	}
+
+	UniformBufferAllocation UniformBufferAllocator::set_uniform_buffer(GraphicContext &gc, int index, const void *data, int size)
+	{
+		UniformBufferAllocation allocation = allocate(gc, data, size);
+		gc.set_uniform_buffer(index, allocation.buffer, allocation.offset, allocation.size);
+		return allocation;
+	}
+
+	void UniformBufferAllocator::next_frame()
+	{
+		impl->current_frame = (impl->current_frame + 1) % impl->frames.size();
+
+		// The GPU finished with this frame's pages frames_in_flight frames ago
+		UniformBufferAllocator_Impl::Frame &frame = impl->frames[impl->current_frame];
+		frame.current_page = 0;
+		frame.position = 0;
+	}
+
+	int UniformBufferAllocator::get_page_count() const
+	{
+		int count = 0;
+		for (const auto &frame : impl->frames)
+			count += frame.pages.size();
+		return count;
+	}
+}
@@ -32,6 +32,7 @@
 #include "API/Display/Render/graphic_context.h"
 #include "API/Display/TargetProviders/graphic_context_provider.h"
 #include "API/Core/System/exception.h"
+#include "graphic_context_capture_impl.h"
 
 namespace clan
 {
@@ -43,6 +44,7 @@ namespace clan
 
 		int lock_count;
 		VertexArrayBufferProvider *provider;
+		int size = 0;
 	};
 
 	VertexArrayBuffer::VertexArrayBuffer()
@@ -55,6 +57,7 @@ namespace clan
 		GraphicContextProvider *gc_provider = gc.get_provider();
 		impl->provider = gc_provider->alloc_vertex_array_buffer();
 		impl->provider->create(size, usage);
+		impl->size = size;
 	}
 
 	VertexArrayBuffer::VertexArrayBuffer(GraphicContext &gc, const void *data, int size, BufferUsage usage)
@@ -63,6 +66,7 @@ namespace clan
 		GraphicContextProvider *gc_provider = gc.get_provider();
 		impl->provider = gc_provider->alloc_vertex_array_buffer();
 		impl->provider->create((void*)data, size, usage);
+		impl->size = size;
 	}
 
 	VertexArrayBuffer::~VertexArrayBuffer()
@@ -80,6 +84,11 @@ namespace clan
 		return impl->provider;
 	}
 
+	int VertexArrayBuffer::get_size() const
+	{
+		return impl->size;
+	}
+
 	bool VertexArrayBuffer::operator==(const VertexArrayBuffer &other) const
 	{
 		return impl == other.impl;
@@ -87,9 +96,18 @@ namespace clan
 
 	void VertexArrayBuffer::upload_data(GraphicContext &gc, int offset, const void *data, int size)
 	{
+		if (GraphicContextCapture_Impl *capture = GraphicContextCapture_Impl::get(gc))
+			capture->upload(*this, offset, data, size);
 		impl->provider->upload_data(gc, offset, data, size);
 	}
 
+	void VertexArrayBuffer::upload_data_unsynchronized(GraphicContext &gc, int offset, const void *data, int size, bool discard)
+	{
+		if (GraphicContextCapture_Impl *capture = GraphicContextCapture_Impl::get(gc))
+			capture->upload(*this, offset, data, size);
+		impl->provider->upload_data_unsynchronized(gc, offset, data, size, discard);
+	}
+
 	void VertexArrayBuffer::copy_from(GraphicContext &gc, TransferBuffer &buffer, int dest_pos, int src_pos, int size)
 	{
 		impl->provider->copy_from(gc, buffer, dest_pos, src_pos, size);
@@ -29,9 +29,283 @@
 #include "Display/precomp.h"
 #include "API/Display/Resources/display_cache.h"
 #include "API/Core/Resources/resource_manager.h"
+#include "API/Core/System/system.h"
+#include "API/Core/System/work_queue.h"
+#include "API/Core/IOData/file_system.h"
+#include "API/Core/IOData/file_help.h"
+#include "API/Core/IOData/path_help.h"
+#include "API/Core/IOData/async_file_reader.h"
+#include "API/Core/IOData/memory_device.h"
+#include "API/Core/System/exception.h"
+#include "API/Display/Render/texture_2d.h"
+#include "API/Display/2D/sprite.h"
+#include "API/Display/2D/image.h"
+#include "API/Display/2D/subtexture.h"
+#include "API/Display/Image/pixel_buffer.h"
+#include "API/Display/Image/image_import_description.h"
+#include "API/Display/ImageProviders/provider_factory.h"
+#include <deque>
 
 namespace clan
 {
+	class DisplayCacheAsyncLoader
+	{
+	public:
+		DisplayCacheAsyncLoader() : file_reader(work_queue)
+		{
+		}
+
+		struct DecodedTexture
+		{
+			Resource<Texture> texture;
+			PixelBuffer pixels;
+			std::string filename;
+			FileSystem fs;
+			bool srgb;
+		};
+
+		/// \brief Decoded textures waiting for upload. Only accessed on the main thread.
+		std::deque<DecodedTexture> decoded;
+		int pending = 0;
+
+		// Declared last, so the worker threads are stopped before the state they report to is destroyed
+		WorkQueue work_queue;
+
+		/// \brief Reads files on disk, so their reads do not occupy the worker threads. Destroyed before work_queue.
+		AsyncFileReader file_reader;
+
+		/// \brief Returns the file on disk a file system opens for a filename, or an empty string for archives and mounts
+		static std::string get_local_filename(const std::string &filename, const FileSystem &fs)
+		{
+			if (fs.is_null())
+				return std::string();
+
+			FileSystem mounts = fs;
+			std::string path = PathHelp::make_absolute("/", filename, PathHelp::path_type_virtual);
+			for (std::string::size_type slash = path.find('/', 1); slash != std::string::npos; slash = path.find('/', slash + 1))
+			{
+				if (mounts.is_mount(path.substr(0, slash + 1)))
+					return std::string();
+			}
+
+			std::string local_filename = PathHelp::combine(fs.get_path(), filename);
+			return FileHelp::file_exists(local_filename) ? local_filename : std::string();
+		}
+	};
+
+	class DisplayCacheFileDependencies
+	{
+	public:
+		struct Dependency
+		{
+			std::weak_ptr<Resource_BaseImpl> resource;
+			std::string local_filename;
+			uint64_t last_write_time;
+			std::function<void()> reload;
+		};
+
+		std::vector<Dependency> dependencies;
+	};
+
+	Resource<Texture> DisplayCache::get_texture_async(GraphicContext &gc, const std::string &id)
+	{
+		return get_texture(gc, id);
+	}
+
+	void DisplayCache::prefetch_textures(GraphicContext &gc, const std::vector<std::string> &ids)
+	{
+		for (const auto &id : ids)
+			get_texture_async(gc, id);
+	}
+
+	void DisplayCache::load_texture_async(const Resource<Texture> &texture, const std::string &filename, const FileSystem &fs, bool srgb)
+	{
+		if (!async_loader)
+			async_loader = std::make_shared<DisplayCacheAsyncLoader>();
+
+		DisplayCacheAsyncLoader *loader = async_loader.get();
+		loader->pending++;
+
+		// Shared, so the queued functions stay small enough to be stored without an allocation
+		auto item = std::make_shared<DisplayCacheAsyncLoader::DecodedTexture>();
+		item->texture = texture;
+		item->filename = filename;
+		item->fs = fs;
+		item->srgb = srgb;
+
+		std::string local_filename = DisplayCacheAsyncLoader::get_local_filename(filename, fs);
+		if (!local_filename.empty())
+		{
+			// Read without blocking a worker thread, then decode on the worker thread running the callback
+			loader->file_reader.read_file(local_filename, [loader, item](bool success, DataBuffer &data)
+			{
+				try
+				{
+					if (success)
+					{
+						MemoryDevice device(data);
+						item->pixels = ImageProviderFactory::load(device, PathHelp::get_extension(item->filename), item->srgb);
+					}
+				}
+				catch (const Exception &)
+				{
+					// Loaded again on upload, which reports the error on the rendering thread
+				}
+				loader->work_queue.work_completed([loader, item]() { loader->decoded.push_back(*item); });
+			});
+			return;
+		}
+
+		loader->work_queue.queue([loader, item]()
+		{
+			try
+			{
+				item->pixels = ImageProviderFactory::load(item->filename, item->fs, std::string(), item->srgb);
+			}
+			catch (const Exception &)
+			{
+				// Loaded again on upload, which reports the error on the rendering thread
+			}
+			loader->work_queue.work_completed([loader, item]() { loader->decoded.push_back(*item); });
+		});
+	}
+
+	void DisplayCache::process_async_loads(GraphicContext &gc, int time_budget_microseconds)
+	{
+		if (!async_loader)
+			return;
+
+		DisplayCacheAsyncLoader *loader = async_loader.get();
+		loader->file_reader.submit();
+		loader->work_queue.process_work_completed();
+
+		uint64_t start_time = System::get_microseconds();
+		while (!loader->decoded.empty())
+		{
+			DisplayCacheAsyncLoader::DecodedTexture item = loader->decoded.front();
+			loader->decoded.pop_front();
+			loader->pending--;
+
+			if (item.pixels.is_null() && !item.texture.get().is_null())
+			{
+				// A reload of a file still being written. Keep the old texture.
+			}
+			else if (item.pixels.is_null())
+			{
+				ImageImportDescription import_desc;
+				import_desc.set_srgb(item.srgb);
+				item.texture.set(Texture2D(gc, item.filename, item.fs, import_desc));
+			}
+			else
+			{
+				item.texture.set(Texture2D(gc, item.pixels, item.srgb));
+			}
+
+			if (System::get_microseconds() - start_time >= (uint64_t)time_budget_microseconds)
+				break;
+		}
+	}
+
+	int DisplayCache::get_async_loads_pending() const
+	{
+		return async_loader ? async_loader->pending : 0;
+	}
+
+	void DisplayCache::add_file_dependency(const std::weak_ptr<Resource_BaseImpl> &resource, const std::string &filename, const FileSystem &fs, const std::function<void()> &reload)
+	{
+		if (fs.is_null())
+			return;
+
+		DisplayCacheFileDependencies::Dependency dependency;
+		dependency.resource = resource;
+		dependency.local_filename = PathHelp::combine(fs.get_path(), filename);
+		dependency.last_write_time = FileHelp::get_last_write_time(dependency.local_filename);
+		dependency.reload = reload;
+
+		// Files inside zip archives and other virtual file systems have no write time and are not watched
+		if (dependency.last_write_time == 0)
+			return;
+
+		if (!file_dependencies)
+			file_dependencies = std::make_shared<DisplayCacheFileDependencies>();
+		file_dependencies->dependencies.push_back(dependency);
+	}
+
+	void DisplayCache::add_texture_file_dependency(const Resource<Texture> &texture, const std::string &filename, const FileSystem &fs, bool srgb)
+	{
+		std::weak_ptr<Resource_Impl<Texture> > weak_texture = texture.handle();
+		add_file_dependency(texture.handle(), filename, fs, [this, weak_texture, filename, fs, srgb]()
+		{
+			std::shared_ptr<Resource_Impl<Texture> > handle = weak_texture.lock();
+			if (handle)
+				load_texture_async(Resource<Texture>(handle), filename, fs, srgb);
+		});
+	}
+
+	int DisplayCache::reload_changed_files()
+	{
+		if (!file_dependencies)
+			return 0;
+
+		int reloaded = 0;
+		std::vector<DisplayCacheFileDependencies::Dependency> &dependencies = file_dependencies->dependencies;
+		for (size_t i = 0; i < dependencies.size(); )
+		{
+			DisplayCacheFileDependencies::Dependency &dependency = dependencies[i];
+			if (dependency.resource.expired())
+			{
+				dependencies.erase(dependencies.begin() + i);
+				continue;
+			}
+
+			uint64_t last_write_time = FileHelp::get_last_write_time(dependency.local_filename);
+			if (last_write_time != 0 && last_write_time != dependency.last_write_time)
+			{
+				try
+				{
+					dependency.reload();
+					dependency.last_write_time = last_write_time;
+					reloaded++;
+				}
+				catch (const Exception &)
+				{
+					// Most likely still being written. Tried again on the next call.
+				}
+			}
+			i++;
+		}
+		return reloaded;
+	}
+
+	size_t DisplayCache::estimate_size(const Sprite &sprite)
+	{
+		// Assumes 32 bits per pixel and ignores textures shared between frames or with other sprites
+		size_t size = 0;
+		int frame_count = sprite.get_frame_count();
+		for (int frame = 0; frame < frame_count; frame++)
+		{
+			Size frame_size = sprite.get_frame_size(frame);
+			size += (size_t)frame_size.width * frame_size.height * 4;
+		}
+		return size;
+	}
+
+	size_t DisplayCache::estimate_size(const Image &image)
+	{
+		if (image.is_null())
+			return 0;
+		Rect geometry = image.get_texture().get_geometry();
+		return (size_t)geometry.get_width() * geometry.get_height() * 4;
+	}
+
+	size_t DisplayCache::estimate_size(const Texture &texture)
+	{
+		if (texture.is_null())
+			return 0;
+		Texture2D texture_2d = texture.to_texture_2d();
+		return (size_t)texture_2d.get_width() * texture_2d.get_height() * 4;
+	}
+
 	DisplayCache &DisplayCache::get(const ResourceManager &resources)
 	{
 		return *resources.get_cache<DisplayCache>("clan.display").get();
@@ -45,8 +45,14 @@
 namespace clan
 {
 	FileDisplayCache::FileDisplayCache(const FileResourceDocument &doc)
-		: doc(doc)
+		: doc(doc),
+		sprites([](const Sprite &sprite) { return estimate_size(sprite); }),
+		images([](const Image &image) { return estimate_size(image); }),
+		textures([](const Texture &texture) { return estimate_size(texture); })
 	{
+		sprites.func_evicted() = [this](const std::string &id, Resource<Sprite> &) { if (func_resource_evicted()) func_resource_evicted()(display_cache_sprite, id); };
+		images.func_evicted() = [this](const std::string &id, Resource<Image> &) { if (func_resource_evicted()) func_resource_evicted()(display_cache_image, id); };
+		textures.func_evicted() = [this](const std::string &id, Resource<Texture> &) { if (func_resource_evicted()) func_resource_evicted()(display_cache_texture, id); };
 	}
 
 	FileDisplayCache::~FileDisplayCache()
@@ -55,44 +61,76 @@ namespace clan
 
 	Resource<Sprite> FileDisplayCache::get_sprite(Canvas &canvas, const std::string &id)
 	{
-		auto it = sprites.find(id);
-		if (it != sprites.end())
+		Resource<Sprite> cached_sprite;
+		if (sprites.find(id, cached_sprite))
 		{
-			Resource<Sprite> sprite = it->second;
-			sprite.get() = sprite.get().clone();
-			return sprite;
+			cached_sprite.get() = cached_sprite.get().clone();
+			return cached_sprite;
 		}
 
-		Resource<Sprite> sprite = Sprite(canvas, id, doc.get_file_system());
-		sprites[id] = sprite;
+		FileSystem fs = doc.get_file_system();
+		Resource<Sprite> sprite = Sprite(canvas, id, fs);
+		sprites.insert(id, sprite);
+
+		std::weak_ptr<Resource_Impl<Sprite> > weak_sprite = sprite.handle();
+		add_file_dependency(sprite.handle(), id, fs, [canvas, weak_sprite, id, fs]() mutable
+		{
+			std::shared_ptr<Resource_Impl<Sprite> > handle = weak_sprite.lock();
+			if (handle)
+				Resource<Sprite>(handle).set(Sprite(canvas, id, fs));
+		});
+
 		sprite.get() = sprite.get().clone();
 		return sprite;
 	}
 
 	Resource<Image> FileDisplayCache::get_image(Canvas &canvas, const std::string &id)
 	{
-		auto it = images.find(id);
-		if (it != images.end())
+		Resource<Image> cached_image;
+		if (images.find(id, cached_image))
 		{
-			Resource<Image> image = it->second;
-			image.get() = image.get().clone();
-			return image;
+			cached_image.get() = cached_image.get().clone();
+			return cached_image;
 		}
 
-		Resource<Image> image = Image(canvas, id, doc.get_file_system());
-		images[id] = image;
+		FileSystem fs = doc.get_file_system();
+		Resource<Image> image = Image(canvas, id, fs);
+		images.insert(id, image);
+
+		std::weak_ptr<Resource_Impl<Image> > weak_image = image.handle();
+		add_file_dependency(image.handle(), id, fs, [canvas, weak_image, id, fs]() mutable
+		{
+			std::shared_ptr<Resource_Impl<Image> > handle = weak_image.lock();
+			if (handle)
+				Resource<Image>(handle).set(Image(canvas, id, fs));
+		});
+
 		image.get() = image.get().clone();
 		return image;
 	}
 
 	Resource<Texture> FileDisplayCache::get_texture(GraphicContext &gc, const std::string &id)
 	{
-		auto it = textures.find(id);
-		if (it != textures.end())
-			return it->second;
+		Resource<Texture> cached_texture;
+		if (textures.find(id, cached_texture))
+			return cached_texture;
 
 		Resource<Texture> texture = Texture2D(gc, id, doc.get_file_system());
-		textures[id] = texture;
+		textures.insert(id, texture);
+		add_texture_file_dependency(texture, id, doc.get_file_system());
+		return texture;
+	}
+
+	Resource<Texture> FileDisplayCache::get_texture_async(GraphicContext &gc, const std::string &id)
+	{
+		Resource<Texture> cached_texture;
+		if (textures.find(id, cached_texture))
+			return cached_texture;
+
+		Resource<Texture> texture;
+		textures.insert(id, texture);
+		load_texture_async(texture, id, doc.get_file_system());
+		add_texture_file_dependency(texture, id, doc.get_file_system());
 		return texture;
 	}
 
@@ -111,4 +149,46 @@ namespace clan
 
 		return font;
 	}
+
+	size_t FileDisplayCache::trim(DisplayCacheResourceType type, size_t max_bytes)
+	{
+		switch (type)
+		{
+		case display_cache_sprite: return sprites.trim(max_bytes);
+		case display_cache_image: return images.trim(max_bytes);
+		case display_cache_texture: return textures.trim(max_bytes);
+		}
+		return 0;
+	}
+
+	void FileDisplayCache::set_memory_budget(DisplayCacheResourceType type, size_t bytes)
+	{
+		switch (type)
+		{
+		case display_cache_sprite: sprites.set_budget(bytes); break;
+		case display_cache_image: images.set_budget(bytes); break;
+		case display_cache_texture: textures.set_budget(bytes); break;
+		}
+	}
+
+	size_t FileDisplayCache::get_memory_used(DisplayCacheResourceType type) const
+	{
+		switch (type)
+		{
+		case display_cache_sprite: return sprites.get_used_bytes();
+		case display_cache_image: return images.get_used_bytes();
+		case display_cache_texture: return textures.get_used_bytes();
+		}
+		return 0;
+	}
+
+	void FileDisplayCache::set_pinned(DisplayCacheResourceType type, const std::string &id, bool pinned)
+	{
+		switch (type)
+		{
+		case display_cache_sprite: sprites.set_pinned(id, pinned); break;
+		case display_cache_image: images.set_pinned(id, pinned); break;
+		case display_cache_texture: textures.set_pinned(id, pinned); break;
+		}
+	}
 }
@@ -0,0 +1,439 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "Display/precomp.h"
+#include "API/Display/ShaderEffect/occlusion_culler.h"
+#include "API/Display/ShaderEffect/shader_effect.h"
+#include "API/Display/ShaderEffect/shader_effect_description.h"
+#include "API/Display/ShaderEffect/shader_effect_graph.h"
+#include "API/Display/Render/uniform_buffer.h"
+#include "API/Core/System/exception.h"
+#include "API/Core/Text/string_format.h"
+#include <algorithm>
+#include <vector>
+
+namespace clan
+{
+	class OcclusionCuller_Impl
+	{
+	public:
+		enum
+		{
+			max_levels = 16,
+			cull_group_size = 64,
+			reduce_group_size = 8
+		};
+
+		struct CullUniforms
+		{
+			Mat4f view_projection;
+			Mat4f previous_view_projection;
+			Vec4i object_info; // count, command stride in unsigned ints, history, level count
+			Vec4i depth_size;
+			Vec4i levels[max_levels]; // width, height, offset
+		};
+
+		struct LevelUniforms
+		{
+			Vec4i source; // width, height, offset
+			Vec4i dest;
+		};
+
+		OcclusionCuller_Impl(GraphicContext &gc);
+
+		ShaderEffectDescription create_description(GraphicContext &gc, const std::string &code);
+		void create_pyramid(GraphicContext &gc, int width, int height);
+
+		ShaderEffect cull_effect;
+		Resource<UniformBuffer> cull_uniforms;
+		Resource<StorageBuffer> bounds;
+		Resource<StorageBuffer> commands;
+		Resource<StorageBuffer> draw_commands;
+		Resource<StorageBuffer> visibility;
+		Resource<StorageBuffer> pyramid;
+		Resource<Texture> depth_texture;
+
+		int draw_commands_capacity = 0;
+		int visibility_capacity = 0;
+
+		int depth_width = 0;
+		int depth_height = 0;
+		std::vector<Vec4i> levels;
+		std::vector<ShaderEffect> level_effects;
+		ShaderEffectGraph pyramid_graph;
+
+		bool history = false;
+		Mat4f previous_view_projection;
+
+		static const char *reduce_shader;
+		static const char *cull_shader;
+	};
+
+	OcclusionCuller::OcclusionCuller()
+	{
+	}
+
+	OcclusionCuller::OcclusionCuller(GraphicContext &gc)
+		: impl(std::make_shared<OcclusionCuller_Impl>(gc))
+	{
+	}
+
+	void OcclusionCuller::throw_if_null() const
+	{
+		if (!impl)
+			throw Exception("OcclusionCuller is null");
+	}
+
+	void OcclusionCuller::cull(GraphicContext &gc, const Mat4f &view_projection, const StorageBuffer &bounds, const StorageBuffer &commands, int count, int command_stride)
+	{
+		throw_if_null();
+		if (command_stride <= 0 || command_stride % 4 != 0)
+			throw Exception("OcclusionCuller::cull: command stride must be a multiple of 4");
+
+		if (count * command_stride > impl->draw_commands_capacity)
+		{
+			impl->draw_commands_capacity = std::max(count * command_stride, impl->draw_commands_capacity * 2);
+			impl->draw_commands.set(StorageBuffer(gc, impl->draw_commands_capacity, 4, usage_dynamic_copy));
+		}
+
+		if (count > impl->visibility_capacity)
+		{
+			impl->visibility_capacity = std::max(count, impl->visibility_capacity * 2);
+			impl->visibility.set(StorageBuffer(gc, impl->visibility_capacity * 4, 4, usage_dynamic_copy));
+		}
+
+		if (count == 0)
+			return;
+
+		OcclusionCuller_Impl::CullUniforms uniforms;
+		uniforms.view_projection = view_projection;
+		uniforms.previous_view_projection = impl->previous_view_projection;
+		uniforms.object_info = Vec4i(count, command_stride / 4, impl->history ? 1 : 0, (int)impl->levels.size());
+		uniforms.depth_size = Vec4i(impl->depth_width, impl->depth_height, 0, 0);
+		for (size_t i = 0; i < impl->levels.size(); i++)
+			uniforms.levels[i] = impl->levels[i];
+		impl->cull_uniforms->upload_data(gc, &uniforms, sizeof(uniforms));
+
+		impl->bounds.set(bounds);
+		impl->commands.set(commands);
+
+		impl->cull_effect.dispatch(gc, (count + OcclusionCuller_Impl::cull_group_size - 1) / OcclusionCuller_Impl::cull_group_size);
+
+		// Don't keep the caller's buffers alive
+		impl->bounds.set(StorageBuffer());
+		impl->commands.set(StorageBuffer());
+	}
+
+	StorageBuffer OcclusionCuller::get_draw_commands() const
+	{
+		throw_if_null();
+		return impl->draw_commands;
+	}
+
+	StorageBuffer OcclusionCuller::get_visibility() const
+	{
+		throw_if_null();
+		return impl->visibility;
+	}
+
+	void OcclusionCuller::update_depth_pyramid(GraphicContext &gc, const Texture2D &depth_texture, const Mat4f &view_projection)
+	{
+		throw_if_null();
+
+		if (depth_texture.get_width() != impl->depth_width || depth_texture.get_height() != impl->depth_height)
+			impl->create_pyramid(gc, depth_texture.get_width(), depth_texture.get_height());
+
+		impl->depth_texture.set(depth_texture);
+		impl->pyramid_graph.execute(gc);
+		impl->depth_texture.set(Texture());
+
+		impl->previous_view_projection = view_projection;
+		impl->history = true;
+	}
+
+	void OcclusionCuller::reset_history()
+	{
+		throw_if_null();
+		impl->history = false;
+	}
+
+	bool OcclusionCuller::has_history() const
+	{
+		return impl && impl->history;
+	}
+
+	int OcclusionCuller::get_pyramid_level_count() const
+	{
+		throw_if_null();
+		return (int)impl->levels.size();
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	OcclusionCuller_Impl::OcclusionCuller_Impl(GraphicContext &gc)
+	{
+		if (!gc.has_compute_shader_support() || gc.get_shader_language() != shader_glsl)
+			throw Exception("OcclusionCuller requires GLSL compute shader support");
+
+		cull_uniforms.set(UniformBuffer(gc, sizeof(CullUniforms)));
+		pyramid.set(StorageBuffer(gc, 4, 4, usage_dynamic_copy));
+
+		ShaderEffectDescription description = create_description(gc, cull_shader);
+		description.set_define("MAX_LEVELS", string_format("%1", (int)max_levels));
+		description.set_uniform_block("CullUniforms", cull_uniforms);
+		description.set_storage("Bounds", bounds);
+		description.set_storage("Commands", commands);
+		description.set_storage("DrawCommands", draw_commands);
+		description.set_storage("Visibility", visibility);
+		description.set_storage("Pyramid", pyramid);
+		cull_effect = ShaderEffect(gc, description);
+	}
+
+	ShaderEffectDescription OcclusionCuller_Impl::create_description(GraphicContext &gc, const std::string &code)
+	{
+		ShaderEffectDescription description;
+		description.set_glsl_version(430);
+		if (gc.get_clip_z_range() == clip_zero_positive_w)
+			description.set_define("CLIP_Z_ZERO");
+		if (gc.get_texture_image_y_axis() == y_axis_top_down)
+			description.set_define("Y_AXIS_TOP_DOWN");
+		description.set_compute_shader(code);
+		return description;
+	}
+
+	void OcclusionCuller_Impl::create_pyramid(GraphicContext &gc, int width, int height)
+	{
+		if (width <= 0 || height <= 0)
+			throw Exception("OcclusionCuller: depth texture is empty");
+
+		// Level n covers 2^(n+1) depth pixels per texel, so lookups only need a shift
+		levels.clear();
+		int level_width = width;
+		int level_height = height;
+		int size = 0;
+		do
+		{
+			if ((int)levels.size() == max_levels)
+				throw Exception("OcclusionCuller: depth texture too large");
+
+			level_width = (level_width + 1) / 2;
+			level_height = (level_height + 1) / 2;
+			levels.push_back(Vec4i(level_width, level_height, size, 0));
+			size += level_width * level_height;
+		} while (level_width > 1 || level_height > 1);
+
+		depth_width = width;
+		depth_height = height;
+		history = false;
+
+		pyramid.set(StorageBuffer(gc, size * 4, 4, usage_dynamic_copy));
+
+		level_effects.clear();
+		pyramid_graph = ShaderEffectGraph();
+		for (size_t i = 0; i < levels.size(); i++)
+		{
+			LevelUniforms uniforms;
+			uniforms.source = i == 0 ? Vec4i(width, height, 0, 0) : levels[i - 1];
+			uniforms.dest = levels[i];
+			Resource<UniformBuffer> level_uniforms(UniformBuffer(gc, &uniforms, sizeof(uniforms)));
+
+			ShaderEffectDescription description = create_description(gc, reduce_shader);
+			description.set_uniform_block("LevelUniforms", level_uniforms);
+			description.set_storage("Pyramid", pyramid);
+			if (i == 0)
+			{
+				description.set_define("FROM_DEPTH_TEXTURE");
+				description.set_texture("DepthTexture", depth_texture);
+			}
+			level_effects.push_back(ShaderEffect(gc, description));
+
+			int pass = pyramid_graph.add_pass(level_effects.back(), (levels[i].x + reduce_group_size - 1) / reduce_group_size, (levels[i].y + reduce_group_size - 1) / reduce_group_size);
+			pyramid_graph.read_uniforms(pass, level_uniforms);
+			if (i == 0)
+				pyramid_graph.read_texture(pass, depth_texture);
+			else
+				pyramid_graph.read_storage(pass, pyramid);
+			pyramid_graph.write_storage(pass, pyramid);
+		}
+		pyramid_graph.add_output(pyramid, barrier_storage_buffer);
+	}
+
+	const char *OcclusionCuller_Impl::reduce_shader = R"shaderend(
+		layout(local_size_x = 8, local_size_y = 8) in;
+
+		layout(std140) uniform LevelUniforms
+		{
+			ivec4 source;
+			ivec4 dest;
+		};
+
+		layout(std430) buffer Pyramid { float depths[]; };
+
+	#if defined(FROM_DEPTH_TEXTURE)
+		uniform sampler2D DepthTexture;
+		float load_source(ivec2 pos) { return texelFetch(DepthTexture, pos, 0).r; }
+	#else
+		float load_source(ivec2 pos) { return depths[source.z + pos.y * source.x + pos.x]; }
+	#endif
+
+		void main()
+		{
+			ivec2 pos = ivec2(gl_GlobalInvocationID.xy);
+			if (pos.x >= dest.x || pos.y >= dest.y)
+				return;
+
+			// The last row and column of odd sized levels also cover the texel past them
+			ivec2 p0 = pos * 2;
+			ivec2 p1 = min(p0 + 1, source.xy - 1);
+			float depth = max(max(load_source(p0), load_source(ivec2(p1.x, p0.y))), max(load_source(ivec2(p0.x, p1.y)), load_source(p1)));
+			depths[dest.z + pos.y * dest.x + pos.x] = depth;
+		}
+	)shaderend";
+
+	const char *OcclusionCuller_Impl::cull_shader = R"shaderend(
+		layout(local_size_x = 64) in;
+
+		layout(std140) uniform CullUniforms
+		{
+			mat4 view_projection;
+			mat4 previous_view_projection;
+			ivec4 object_info;
+			ivec4 depth_size;
+			ivec4 levels[MAX_LEVELS];
+		};
+
+		layout(std430) readonly buffer Bounds { vec4 bounds[]; };
+		layout(std430) readonly buffer Commands { uint commands[]; };
+		layout(std430) writeonly buffer DrawCommands { uint draw_commands[]; };
+		layout(std430) writeonly buffer Visibility { uint visibility[]; };
+		layout(std430) readonly buffer Pyramid { float depths[]; };
+
+		vec3 get_corner(vec3 bmin, vec3 bmax, int i)
+		{
+			return vec3((i & 1) != 0 ? bmax.x : bmin.x, (i & 2) != 0 ? bmax.y : bmin.y, (i & 4) != 0 ? bmax.z : bmin.z);
+		}
+
+		bool outside_frustum(vec3 bmin, vec3 bmax)
+		{
+			int outside_all = 63;
+			for (int i = 0; i < 8; i++)
+			{
+				vec4 c = view_projection * vec4(get_corner(bmin, bmax, i), 1.0);
+				int outside = 0;
+				if (c.x < -c.w) outside |= 1;
+				if (c.x > c.w) outside |= 2;
+				if (c.y < -c.w) outside |= 4;
+				if (c.y > c.w) outside |= 8;
+	#if defined(CLIP_Z_ZERO)
+				if (c.z < 0.0) outside |= 16;
+	#else
+				if (c.z < -c.w) outside |= 16;
+	#endif
+				if (c.z > c.w) outside |= 32;
+				outside_all &= outside;
+			}
+			return outside_all != 0;
+		}
+
+		bool occluded(vec3 bmin, vec3 bmax)
+		{
+			vec2 ndc_min = vec2(1.0e30);
+			vec2 ndc_max = vec2(-1.0e30);
+			float nearest = 1.0;
+			for (int i = 0; i < 8; i++)
+			{
+				vec4 c = previous_view_projection * vec4(get_corner(bmin, bmax, i), 1.0);
+				if (c.w <= 1.0e-5)
+					return false; // Crosses the camera plane of the previous frame
+
+				vec3 ndc = c.xyz / c.w;
+				ndc_min = min(ndc_min, ndc.xy);
+				ndc_max = max(ndc_max, ndc.xy);
+	#if defined(CLIP_Z_ZERO)
+				nearest = min(nearest, ndc.z);
+	#else
+				nearest = min(nearest, ndc.z * 0.5 + 0.5);
+	#endif
+			}
+
+			// Nothing is known about what was outside the previous view
+			if (any(lessThan(ndc_min, vec2(-1.0))) || any(greaterThan(ndc_max, vec2(1.0))))
+				return false;
+
+			vec2 uv_min = ndc_min * 0.5 + 0.5;
+			vec2 uv_max = ndc_max * 0.5 + 0.5;
+	#if defined(Y_AXIS_TOP_DOWN)
+			float flipped_min_y = 1.0 - uv_max.y;
+			uv_max.y = 1.0 - uv_min.y;
+			uv_min.y = flipped_min_y;
+	#endif
+
+			ivec2 p0 = clamp(ivec2(floor(uv_min * vec2(depth_size.xy))), ivec2(0), depth_size.xy - 1);
+			ivec2 p1 = clamp(ivec2(floor(uv_max * vec2(depth_size.xy))), ivec2(0), depth_size.xy - 1);
+
+			// Pick the finest level where the rectangle covers at most 2x2 texels
+			int extent = max(p1.x - p0.x, p1.y - p0.y) + 1;
+			int level = extent <= 1 ? 0 : findMSB(extent - 1);
+			level = min(level, object_info.w - 1);
+
+			ivec4 info = levels[level];
+			ivec2 t0 = p0 >> (level + 1);
+			ivec2 t1 = min(p1 >> (level + 1), info.xy - 1);
+
+			float farthest = 0.0;
+			for (int y = t0.y; y <= t1.y; y++)
+			{
+				for (int x = t0.x; x <= t1.x; x++)
+					farthest = max(farthest, depths[info.z + y * info.x + x]);
+			}
+			return nearest > farthest;
+		}
+
+		void main()
+		{
+			int index = int(gl_GlobalInvocationID.x);
+			if (index >= object_info.x)
+				return;
+
+			vec3 bmin = bounds[index * 2].xyz;
+			vec3 bmax = bounds[index * 2 + 1].xyz;
+
+			bool visible = !outside_frustum(bmin, bmax);
+			if (visible && object_info.z != 0)
+				visible = !occluded(bmin, bmax);
+
+			visibility[index] = visible ? 1u : 0u;
+
+			// instance_count is the second field of both indirect command layouts
+			int stride = object_info.y;
+			for (int i = 0; i < stride; i++)
+				draw_commands[index * stride + i] = (i == 1 && !visible) ? 0u : commands[index * stride + i];
+		}
+	)shaderend";
+}
@@ -108,6 +108,11 @@ namespace clan
 	}
 
 	void ShaderEffect::dispatch(GraphicContext &gc, int x, int y, int z)
+	{
+		dispatch(gc, x, y, z, true);
+	}
+
+	void ShaderEffect::dispatch(GraphicContext &gc, int x, int y, int z, bool barrier)
 	{
 		gc.set_program_object(impl->program);
 
@@ -131,7 +136,10 @@ namespace clan
 			gc.set_texture(elem.first, elem.second);
 		}
 
-		gc.dispatch(x, y, z);
+		if (barrier)
+			gc.dispatch(x, y, z);
+		else
+			gc.dispatch_no_barrier(x, y, z);
 
 		for (auto & elem : impl->uniform_bindings)
 		{
@@ -330,6 +338,8 @@ namespace clan
 		for (auto it = description->storage_buffers.begin(); it != description->storage_buffers.end(); ++it, index++)
 		{
 			program.set_uniform1i(it->first, index);
+			if (gc.get_shader_language() == shader_glsl)
+				program.set_storage_buffer_index(it->first, index);
 			storage_bindings[index] = it->second;
 		}
 
@@ -422,5 +432,11 @@ namespace clan
 				fb = FrameBuffer(gc);
 			fb.attach_depth(description->depth_buffer);
 		}
+
+		if (!fb.is_null())
+		{
+			fb.set_load_action(load_action_dont_care, description->load_dont_care);
+			fb.set_store_action(store_action_dont_care, description->store_dont_care);
+		}
 	}
 }
@@ -123,6 +123,22 @@ namespace clan
 		impl->stencil_texture = texture;
 	}
 
+	void ShaderEffectDescription::set_load_action(FrameBufferLoadAction action, int attachments)
+	{
+		if (action == load_action_dont_care)
+			impl->load_dont_care |= attachments;
+		else
+			impl->load_dont_care &= ~attachments;
+	}
+
+	void ShaderEffectDescription::set_store_action(FrameBufferStoreAction action, int attachments)
+	{
+		if (action == store_action_dont_care)
+			impl->store_dont_care |= attachments;
+		else
+			impl->store_dont_care &= ~attachments;
+	}
+
 	void ShaderEffectDescription::set_texture(std::string name, Resource<Texture> texture)
 	{
 		impl->textures[name] = texture;
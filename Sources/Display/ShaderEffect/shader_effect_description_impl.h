@@ -71,6 +71,9 @@ namespace clan
 		RenderBuffer stencil_buffer;
 		Texture stencil_texture;
 
+		int load_dont_care = 0;		// FrameBufferAttachmentFlags
+		int store_dont_care = 0;	// FrameBufferAttachmentFlags
+
 		std::map<std::string, Resource<UniformBuffer >> uniform_buffers;
 		std::map<std::string, Resource<Texture> > textures;
 		std::map<std::string, Resource<Texture> > images;
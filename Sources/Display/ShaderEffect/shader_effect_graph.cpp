@@ -0,0 +1,350 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "Display/precomp.h"
+#include "API/Display/ShaderEffect/shader_effect_graph.h"
+#include "API/Display/Render/texture_2d.h"
+#include "API/Core/System/exception.h"
+#include <map>
+#include <vector>
+
+namespace clan
+{
+	class ShaderEffectGraph_Impl
+	{
+	public:
+		struct GraphResource
+		{
+			Resource<Texture> image;
+			bool transient = false;
+			int width = 0;
+			int height = 0;
+			TextureFormat format = tf_rgba8;
+
+			bool output = false;
+			int output_barriers = 0;
+
+			// State during execute
+			bool written = false;
+			int visible_barriers = 0;
+			int first_use = -1;
+			int last_use = -1;
+		};
+
+		struct PassAccess
+		{
+			int resource;
+			int barrier;
+			bool write;
+		};
+
+		struct GraphPass
+		{
+			ShaderEffect effect;
+			int x, y, z;
+			std::vector<PassAccess> accesses;
+		};
+
+		struct PooledTexture
+		{
+			Texture2D texture;
+			int width;
+			int height;
+			TextureFormat format;
+			int busy_until;
+		};
+
+		int get_resource(const void *key);
+		void add_access(int pass, const void *key, int barrier, bool write);
+		void assign_transient_image(GraphicContext &gc, GraphResource &resource);
+
+		std::vector<GraphResource> resources;
+		std::map<const void *, int> resource_indices;
+		std::vector<GraphPass> passes;
+		std::vector<PooledTexture> texture_pool;
+
+		int executed_pass_count = 0;
+		int barrier_count = 0;
+	};
+
+	ShaderEffectGraph::ShaderEffectGraph()
+		: impl(std::make_shared<ShaderEffectGraph_Impl>())
+	{
+	}
+
+	Resource<Texture> ShaderEffectGraph::create_transient_image(int width, int height, TextureFormat format)
+	{
+		Resource<Texture> image;
+		int index = impl->get_resource(image.handle().get());
+		ShaderEffectGraph_Impl::GraphResource &resource = impl->resources[index];
+		resource.image = image;
+		resource.transient = true;
+		resource.width = width;
+		resource.height = height;
+		resource.format = format;
+		return image;
+	}
+
+	int ShaderEffectGraph::add_pass(const ShaderEffect &effect, int x, int y, int z)
+	{
+		if (effect.is_null())
+			throw Exception("ShaderEffectGraph::add_pass: shader effect is null");
+
+		ShaderEffectGraph_Impl::GraphPass pass;
+		pass.effect = effect;
+		pass.x = x;
+		pass.y = y;
+		pass.z = z;
+		impl->passes.push_back(pass);
+		return (int)impl->passes.size() - 1;
+	}
+
+	void ShaderEffectGraph::read_image(int pass, const Resource<Texture> &image)
+	{
+		impl->add_access(pass, image.handle().get(), barrier_image_access, false);
+	}
+
+	void ShaderEffectGraph::read_texture(int pass, const Resource<Texture> &texture)
+	{
+		impl->add_access(pass, texture.handle().get(), barrier_texture_fetch, false);
+	}
+
+	void ShaderEffectGraph::read_storage(int pass, const Resource<StorageBuffer> &buffer)
+	{
+		impl->add_access(pass, buffer.handle().get(), barrier_storage_buffer, false);
+	}
+
+	void ShaderEffectGraph::read_uniforms(int pass, const Resource<UniformBuffer> &buffer)
+	{
+		impl->add_access(pass, buffer.handle().get(), barrier_uniform, false);
+	}
+
+	void ShaderEffectGraph::write_image(int pass, const Resource<Texture> &image)
+	{
+		impl->add_access(pass, image.handle().get(), barrier_image_access, true);
+	}
+
+	void ShaderEffectGraph::write_storage(int pass, const Resource<StorageBuffer> &buffer)
+	{
+		impl->add_access(pass, buffer.handle().get(), barrier_storage_buffer, true);
+	}
+
+	void ShaderEffectGraph::add_output(const Resource<Texture> &texture, int barrier_flags)
+	{
+		ShaderEffectGraph_Impl::GraphResource &resource = impl->resources[impl->get_resource(texture.handle().get())];
+		resource.output = true;
+		resource.output_barriers = barrier_flags;
+	}
+
+	void ShaderEffectGraph::add_output(const Resource<StorageBuffer> &buffer, int barrier_flags)
+	{
+		ShaderEffectGraph_Impl::GraphResource &resource = impl->resources[impl->get_resource(buffer.handle().get())];
+		resource.output = true;
+		resource.output_barriers = barrier_flags;
+	}
+
+	void ShaderEffectGraph::execute(GraphicContext &gc)
+	{
+		auto &resources = impl->resources;
+		auto &passes = impl->passes;
+
+		// Walk backwards from the outputs to find the passes contributing to them
+		std::vector<bool> live(resources.size(), false);
+		for (size_t i = 0; i < resources.size(); i++)
+			live[i] = resources[i].output;
+
+		std::vector<bool> needed(passes.size(), false);
+		for (int pass_index = (int)passes.size() - 1; pass_index >= 0; pass_index--)
+		{
+			for (const auto &access : passes[pass_index].accesses)
+			{
+				if (access.write && live[access.resource])
+					needed[pass_index] = true;
+			}
+
+			if (needed[pass_index])
+			{
+				for (const auto &access : passes[pass_index].accesses)
+				{
+					if (!access.write)
+						live[access.resource] = true;
+				}
+			}
+		}
+
+		// Lifetimes of the transient images among the passes that run
+		for (auto &resource : resources)
+		{
+			resource.written = false;
+			resource.visible_barriers = 0;
+			resource.first_use = -1;
+			resource.last_use = -1;
+		}
+
+		for (int pass_index = 0; pass_index < (int)passes.size(); pass_index++)
+		{
+			if (!needed[pass_index])
+				continue;
+
+			for (const auto &access : passes[pass_index].accesses)
+			{
+				ShaderEffectGraph_Impl::GraphResource &resource = resources[access.resource];
+				if (resource.first_use == -1)
+					resource.first_use = pass_index;
+				resource.last_use = pass_index;
+			}
+		}
+
+		for (auto &resource : resources)
+		{
+			if (resource.transient && resource.output && resource.first_use != -1)
+				resource.last_use = (int)passes.size();
+		}
+
+		for (auto &pooled : impl->texture_pool)
+			pooled.busy_until = -1;
+
+		impl->executed_pass_count = 0;
+		impl->barrier_count = 0;
+
+		for (int pass_index = 0; pass_index < (int)passes.size(); pass_index++)
+		{
+			if (!needed[pass_index])
+				continue;
+
+			ShaderEffectGraph_Impl::GraphPass &pass = passes[pass_index];
+
+			int barriers = 0;
+			for (const auto &access : pass.accesses)
+			{
+				ShaderEffectGraph_Impl::GraphResource &resource = resources[access.resource];
+				if (resource.transient && resource.first_use == pass_index)
+					impl->assign_transient_image(gc, resource);
+
+				if (resource.written && (resource.visible_barriers & access.barrier) == 0)
+					barriers |= access.barrier;
+			}
+
+			if (barriers)
+			{
+				gc.memory_barrier(barriers);
+				impl->barrier_count++;
+				for (auto &resource : resources)
+				{
+					if (resource.written)
+						resource.visible_barriers |= barriers;
+				}
+			}
+
+			pass.effect.dispatch(gc, pass.x, pass.y, pass.z, false);
+			impl->executed_pass_count++;
+
+			for (const auto &access : pass.accesses)
+			{
+				if (access.write)
+				{
+					resources[access.resource].written = true;
+					resources[access.resource].visible_barriers = 0;
+				}
+			}
+		}
+
+		// Make the outputs visible to whatever uses them next
+		int output_barriers = 0;
+		for (const auto &resource : resources)
+		{
+			if (resource.output && resource.written)
+				output_barriers |= resource.output_barriers & ~resource.visible_barriers;
+		}
+
+		if (output_barriers)
+		{
+			gc.memory_barrier(output_barriers);
+			impl->barrier_count++;
+		}
+	}
+
+	int ShaderEffectGraph::get_executed_pass_count() const
+	{
+		return impl->executed_pass_count;
+	}
+
+	int ShaderEffectGraph::get_barrier_count() const
+	{
+		return impl->barrier_count;
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	int ShaderEffectGraph_Impl::get_resource(const void *key)
+	{
+		auto it = resource_indices.find(key);
+		if (it != resource_indices.end())
+			return it->second;
+
+		int index = (int)resources.size();
+		resources.push_back(GraphResource());
+		resource_indices[key] = index;
+		return index;
+	}
+
+	void ShaderEffectGraph_Impl::add_access(int pass, const void *key, int barrier, bool write)
+	{
+		if (pass < 0 || pass >= (int)passes.size())
+			throw Exception("ShaderEffectGraph: invalid pass index");
+
+		PassAccess access;
+		access.resource = get_resource(key);
+		access.barrier = barrier;
+		access.write = write;
+		passes[pass].accesses.push_back(access);
+	}
+
+	void ShaderEffectGraph_Impl::assign_transient_image(GraphicContext &gc, GraphResource &resource)
+	{
+		for (auto &pooled : texture_pool)
+		{
+			if (pooled.busy_until < resource.first_use && pooled.width == resource.width && pooled.height == resource.height && pooled.format == resource.format)
+			{
+				pooled.busy_until = resource.last_use;
+				resource.image.set(pooled.texture);
+				return;
+			}
+		}
+
+		PooledTexture pooled;
+		pooled.texture = Texture2D(gc, resource.width, resource.height, resource.format);
+		pooled.width = resource.width;
+		pooled.height = resource.height;
+		pooled.format = resource.format;
+		pooled.busy_until = resource.last_use;
+		texture_pool.push_back(pooled);
+		resource.image.set(pooled.texture);
+	}
+}
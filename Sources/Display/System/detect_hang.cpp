@@ -28,7 +28,14 @@
 
 #include "Display/precomp.h"
 #include "API/Display/System/detect_hang.h"
+#include "API/Core/IOData/file.h"
+#include "API/Core/System/system.h"
+#include "API/Core/System/datetime.h"
+#include "API/Core/Text/string_format.h"
 #include "detect_hang_impl.h"
+#include <algorithm>
+#include <atomic>
+#include <map>
 
 namespace clan
 {
@@ -36,4 +43,176 @@ namespace clan
 		: impl(std::make_shared<DetectHang_Impl>())
 	{
 	}
+
+	DetectHang::DetectHang(const std::string &reports_directory, int frame_threshold_ms, int sample_interval_ms)
+		: impl(std::make_shared<DetectHang_Impl>(reports_directory, frame_threshold_ms, sample_interval_ms))
+	{
+	}
+
+	void DetectHang::end_frame()
+	{
+		impl->end_frame();
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	DetectHang_Impl::DetectHang_Impl(const std::string &reports_directory, int frame_threshold_ms, int sample_interval_ms)
+		: reports_directory(reports_directory), frame_threshold(frame_threshold_ms * (uint64_t)1000), sample_interval(sample_interval_ms * (uint64_t)1000)
+	{
+		if (sample_interval > 0)
+		{
+			sampled_thread_id = CrashReporter::get_current_thread_id();
+
+			// Keep enough samples to cover a frame 100 times longer than the threshold
+			size_t sample_count = (size_t)std::max((uint64_t)64, std::min((uint64_t)8192, frame_threshold * 100 / sample_interval));
+			samples.resize(sample_count);
+		}
+
+		thread = std::thread(&DetectHang_Impl::worker_main, this);
+	}
+
+	DetectHang_Impl::~DetectHang_Impl()
+	{
+		{
+			std::unique_lock<std::mutex> mutex_lock(mutex);
+			stop_flag = true;
+		}
+		stop_condition.notify_all();
+		thread.join();
+	}
+
+	void DetectHang_Impl::end_frame()
+	{
+		if (sample_interval == 0)
+			return;
+
+		uint64_t now = System::get_microseconds();
+		if (last_frame_end != 0 && now - last_frame_end > frame_threshold)
+		{
+			SlowFrame frame;
+			frame.frame_number = frame_number;
+			frame.start_time = last_frame_end;
+			frame.end_time = now;
+
+			std::unique_lock<std::mutex> mutex_lock(mutex);
+			slow_frames.push_back(frame);
+		}
+		last_frame_end = now;
+		frame_number++;
+	}
+
+	void DetectHang_Impl::worker_main()
+	{
+		const uint64_t heartbeat_interval = 30 * (uint64_t)1000000;
+		const uint64_t heartbeat_timeout = 1000000;
+
+		std::shared_ptr<std::atomic<bool>> heartbeat;
+		uint64_t heartbeat_time = System::get_microseconds();
+
+		while (true)
+		{
+			std::vector<SlowFrame> frames;
+			{
+				std::unique_lock<std::mutex> mutex_lock(mutex);
+				uint64_t wait_time = sample_interval > 0 ? sample_interval : heartbeat_timeout;
+				if (stop_condition.wait_for(mutex_lock, std::chrono::microseconds(wait_time), [&]() -> bool { return stop_flag; }))
+					break;
+				frames.swap(slow_frames);
+			}
+
+			uint64_t now = System::get_microseconds();
+			if (!heartbeat && now - heartbeat_time >= heartbeat_interval)
+			{
+				heartbeat = std::make_shared<std::atomic<bool>>(false);
+				heartbeat_time = now;
+				std::shared_ptr<std::atomic<bool>> alive = heartbeat;
+				RunLoop::main_thread_async([alive]() { alive->store(true); });
+			}
+			else if (heartbeat && now - heartbeat_time >= heartbeat_timeout)
+			{
+				if (!heartbeat->load())
+					CrashReporter::invoke();
+				heartbeat.reset();
+				heartbeat_time = now;
+			}
+
+			if (sample_interval > 0)
+			{
+				capture_sample();
+				for (const auto &frame : frames)
+					write_report(frame);
+			}
+		}
+	}
+
+	void DetectHang_Impl::capture_sample()
+	{
+		StackSample &sample = samples[next_sample];
+		sample.time = System::get_microseconds();
+		sample.num_frames = CrashReporter::capture_thread_stack(sampled_thread_id, max_stack_frames, sample.frames);
+		next_sample = (next_sample + 1) % samples.size();
+	}
+
+	void DetectHang_Impl::write_report(const SlowFrame &frame)
+	{
+		// Group identical stacks and count how often each was seen
+		std::map<std::vector<void*>, int> stacks;
+		int sample_count = 0;
+		for (const auto &sample : samples)
+		{
+			if (sample.num_frames > 0 && sample.time >= frame.start_time && sample.time <= frame.end_time)
+			{
+				stacks[std::vector<void*>(sample.frames, sample.frames + sample.num_frames)]++;
+				sample_count++;
+			}
+		}
+
+		std::vector<std::pair<int, const std::vector<void*> *>> sorted_stacks;
+		for (const auto &it : stacks)
+			sorted_stacks.push_back(std::make_pair(it.second, &it.first));
+		std::sort(sorted_stacks.begin(), sorted_stacks.end(), [](const std::pair<int, const std::vector<void*> *> &a, const std::pair<int, const std::vector<void*> *> &b) { return a.first > b.first; });
+
+		std::string report = string_format("frame %1 duration %2 ms samples %3\n", (unsigned long long)frame.frame_number, (int)((frame.end_time - frame.start_time) / 1000), sample_count);
+		for (const auto &stack : sorted_stacks)
+		{
+			std::vector<void*> addresses = *stack.second;
+			std::vector<std::string> names = System::get_stack_frames_text(addresses.data(), (int)addresses.size());
+			report += string_format("  %1 ", stack.first);
+			for (size_t i = 0; i < names.size(); i++)
+			{
+				if (i > 0)
+					report += " < ";
+				report += names[i];
+			}
+			report += "\n";
+		}
+
+		try
+		{
+			if (report_filename.empty())
+			{
+				DateTime time = DateTime::get_current_local_time();
+				std::string directory = reports_directory;
+				if (!directory.empty() && directory.back() != '/' && directory.back() != '\\')
+					directory.push_back('/');
+				StringFormat format("%1%2-%3-%4 %5.%6.%7 frames.txt");
+				format.set_arg(1, directory);
+				format.set_arg(2, (int)time.get_year());
+				format.set_arg(3, (int)time.get_month(), 2);
+				format.set_arg(4, (int)time.get_day(), 2);
+				format.set_arg(5, (int)time.get_hour(), 2);
+				format.set_arg(6, (int)time.get_minutes(), 2);
+				format.set_arg(7, (int)time.get_seconds(), 2);
+				report_filename = format.get_result();
+			}
+
+			File file(report_filename, File::open_always, File::access_write);
+			file.seek(0, File::seek_end);
+			file.write(report.data(), (int)report.size());
+		}
+		catch (const Exception &)
+		{
+			// Reports are best effort
+		}
+	}
 }
@@ -33,47 +33,59 @@
 #include <mutex>
 #include <thread>
 #include <condition_variable>
+#include <vector>
 
 namespace clan
 {
 	class DetectHang_Impl
 	{
 	public:
-		DetectHang_Impl()
-		{
-			thread = std::thread(&DetectHang_Impl::worker_main, this);
-		}
+		DetectHang_Impl(const std::string &reports_directory = std::string(), int frame_threshold_ms = 0, int sample_interval_ms = 0);
+		~DetectHang_Impl();
 
-		~DetectHang_Impl()
-		{
-			{
-				std::unique_lock<std::mutex> mutex_lock(mutex);
-				stop_flag = true;
-			}
-			stop_condition.notify_all();
-			thread.join();
-		}
+		void end_frame();
 
 	private:
-		void worker_main()
-		{
-			while (true)
-			{
-				std::unique_lock<std::mutex> mutex_lock(mutex);
+		enum { max_stack_frames = 32 };
 
-				std::future<void> heartbeat = RunLoop::main_thread_task([](){});
+		struct StackSample
+		{
+			uint64_t time = 0;
+			int num_frames = 0;
+			void *frames[max_stack_frames];
+		};
 
-				if (stop_condition.wait_for(mutex_lock, std::chrono::seconds(30), [&]() -> bool { return stop_flag; }))
-					break;
+		struct SlowFrame
+		{
+			uint64_t frame_number = 0;
+			uint64_t start_time = 0;
+			uint64_t end_time = 0;
+		};
 
-				if (heartbeat.wait_for(std::chrono::seconds(1)) == std::future_status::timeout)
-					CrashReporter::invoke();
-			}
-		}
+		void worker_main();
+		void capture_sample();
+		void write_report(const SlowFrame &frame);
 
 		std::mutex mutex;
 		std::condition_variable stop_condition;
 		bool stop_flag = false;
 		std::thread thread;
+
+		std::string reports_directory;
+		std::string report_filename;
+		uint64_t frame_threshold = 0;
+		uint64_t sample_interval = 0;
+		uint64_t sampled_thread_id = 0;
+
+		// Owned by the sampled thread
+		uint64_t frame_number = 0;
+		uint64_t last_frame_end = 0;
+
+		// Protected by mutex
+		std::vector<SlowFrame> slow_frames;
+
+		// Owned by the worker thread
+		std::vector<StackSample> samples;
+		size_t next_sample = 0;
 	};
 }
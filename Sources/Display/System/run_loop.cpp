@@ -28,6 +28,8 @@
 
 #include "Display/precomp.h"
 #include "API/Display/System/run_loop.h"
+#include "API/Core/System/profiler.h"
+#include "API/Core/System/system.h"
 #include "run_loop_impl.h"
 
 namespace clan
@@ -44,22 +46,29 @@ namespace clan
 
 	bool RunLoop::process(int timeout_ms)
 	{
+		cl_profile_zone("RunLoop process");
 		return RunLoopImpl::get_instance()->process(timeout_ms);
 	}
 
 	void RunLoop::main_thread_async(std::function<void()> func)
 	{
 		RunLoopImpl *impl = RunLoopImpl::get_instance();
-		
-		std::unique_lock<std::mutex> lock(impl->mutex);
-		bool needs_notify = impl->async_work.empty();
-		impl->async_work.push_back(func);
-		lock.unlock();
 
-		if (needs_notify)
+		// Only the post that makes the queue non-empty wakes the main thread
+		if (impl->push_async_work(std::move(func)))
 			impl->post_async_work_needed();
 	}
 
+	void RunLoop::set_async_work_budget(int microseconds)
+	{
+		RunLoopImpl::get_instance()->budget_microseconds.store(std::max(microseconds, 0), std::memory_order_relaxed);
+	}
+
+	int RunLoop::get_async_work_budget()
+	{
+		return RunLoopImpl::get_instance()->budget_microseconds.load(std::memory_order_relaxed);
+	}
+
 	/////////////////////////////////////////////////////////////////////////
 
 	RunLoopImpl *RunLoopImpl::get_instance()
@@ -69,7 +78,7 @@ namespace clan
 		return instance;
 	}
 
-	RunLoopImpl::RunLoopImpl()
+	RunLoopImpl::RunLoopImpl() : incoming(nullptr), budget_microseconds(0)
 	{
 		instance = this;
 	}
@@ -77,19 +86,77 @@ namespace clan
 	RunLoopImpl::~RunLoopImpl()
 	{
 		instance = 0;
+		delete_nodes(incoming.exchange(nullptr));
+		delete_nodes(pending);
 	}
 
 	void RunLoopImpl::process_async_work()
 	{
-		std::vector<std::function<void()>> current_async_work;
+		take_async_work();
 
-		std::unique_lock<std::mutex> lock(mutex);
-		current_async_work.swap(async_work);
-		lock.unlock();
+		int budget = budget_microseconds.load(std::memory_order_relaxed);
+		uint64_t start_time = budget > 0 ? System::get_microseconds() : 0;
 
-		for (auto &work : current_async_work)
+		while (pending)
+		{
+			// Unlink before running so work that recursively processes messages sees a consistent list
+			std::unique_ptr<AsyncWorkNode> node(pending);
+			pending = node->next;
+			if (!pending)
+				pending_tail = nullptr;
+
+			node->func();
+
+			if (budget > 0 && pending && System::get_microseconds() - start_time >= (uint64_t)budget)
+			{
+				// Continue with the rest on the next wakeup
+				post_async_work_needed();
+				break;
+			}
+		}
+	}
+
+	bool RunLoopImpl::push_async_work(std::function<void()> func)
+	{
+		AsyncWorkNode *node = new AsyncWorkNode(std::move(func));
+		node->next = incoming.load(std::memory_order_relaxed);
+		while (!incoming.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed))
+		{
+		}
+		return node->next == nullptr;
+	}
+
+	void RunLoopImpl::take_async_work()
+	{
+		AsyncWorkNode *node = incoming.exchange(nullptr, std::memory_order_acquire);
+		if (!node)
+			return;
+
+		// The incoming list is newest first
+		AsyncWorkNode *reversed = nullptr;
+		AsyncWorkNode *last = node;
+		while (node)
+		{
+			AsyncWorkNode *next = node->next;
+			node->next = reversed;
+			reversed = node;
+			node = next;
+		}
+
+		if (pending_tail)
+			pending_tail->next = reversed;
+		else
+			pending = reversed;
+		pending_tail = last;
+	}
+
+	void RunLoopImpl::delete_nodes(AsyncWorkNode *node)
+	{
+		while (node)
 		{
-			work();
+			AsyncWorkNode *next = node->next;
+			delete node;
+			node = next;
 		}
 	}
 
@@ -28,8 +28,7 @@
 
 #pragma once
 
-#include <mutex>
-#include <vector>
+#include <atomic>
 #include <functional>
 
 namespace clan
@@ -50,8 +49,30 @@ namespace clan
 		static RunLoopImpl *get_instance();
 
 	private:
-		std::mutex mutex;
-		std::vector<std::function<void()>> async_work;
+		struct AsyncWorkNode
+		{
+			AsyncWorkNode(std::function<void()> func) : func(std::move(func)) { }
+			std::function<void()> func;
+			AsyncWorkNode *next = nullptr;
+		};
+
+		/// \brief Queues work. May be called by any thread. Returns true if the queue was empty before.
+		bool push_async_work(std::function<void()> func);
+
+		/// \brief Moves everything queued so far to the end of the pending list
+		void take_async_work();
+
+		static void delete_nodes(AsyncWorkNode *node);
+
+		// Producers push with a single compare and swap, newest first
+		std::atomic<AsyncWorkNode *> incoming;
+
+		// Work taken from incoming in the order it was posted. Only touched by the main thread.
+		AsyncWorkNode *pending = nullptr;
+		AsyncWorkNode *pending_tail = nullptr;
+
+		std::atomic_int budget_microseconds;
+
 		static RunLoopImpl *instance;
 
 		friend class RunLoop;
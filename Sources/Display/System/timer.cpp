@@ -45,8 +45,14 @@ namespace clan
 		std::weak_ptr<TimerImpl> timer_impl;
 		bool is_repeating = false;
 		int timeout = 0;
-		std::chrono::steady_clock::time_point next_awake_time;
+		uint64_t expire_tick = 0;
 		std::function<void()> func_expired;
+
+		// Timer wheel slot links
+		ActiveTimer *prev = nullptr;
+		ActiveTimer *next = nullptr;
+		int level = -1;
+		int slot = 0;
 	};
 
 	class TimerImpl
@@ -60,6 +66,141 @@ namespace clan
 		std::function<void()> func_expired;
 	};
 
+	/// \brief Hierarchical timer wheel with one millisecond ticks
+	///
+	/// Level 0 holds the timers expiring within the next 256 ticks, one slot per tick.
+	/// Each higher level covers 256 times the range of the level below it, and its slots are
+	/// moved down a level when the lower level wraps around. Adding and removing a timer is O(1).
+	class TimerWheel
+	{
+	public:
+		enum
+		{
+			num_levels = 4,
+			slot_bits = 8,
+			num_slots = 1 << slot_bits,
+			slot_mask = num_slots - 1
+		};
+
+		TimerWheel()
+		{
+			for (auto &level : slots)
+				for (auto &slot : level)
+					slot = nullptr;
+		}
+
+		bool empty() const { return count == 0; }
+
+		uint64_t get_current_tick() const { return current_tick; }
+
+		void set_current_tick(uint64_t tick) { current_tick = tick; }
+
+		void insert(ActiveTimer *timer)
+		{
+			uint64_t expire_tick = std::max(timer->expire_tick, current_tick);
+			uint64_t delta = expire_tick - current_tick;
+
+			int level = 0;
+			while (level + 1 < num_levels && delta >= (uint64_t(1) << ((level + 1) * slot_bits)))
+				level++;
+
+			// Timers beyond the range of the top level wait in its furthest slot and are resorted when it is reached
+			if (level == num_levels - 1 && delta >= (uint64_t(1) << (num_levels * slot_bits)))
+				expire_tick = current_tick + (uint64_t(1) << (num_levels * slot_bits)) - 1;
+
+			int slot = (int)((expire_tick >> (level * slot_bits)) & slot_mask);
+
+			timer->level = level;
+			timer->slot = slot;
+			timer->prev = nullptr;
+			timer->next = slots[level][slot];
+			if (timer->next)
+				timer->next->prev = timer;
+			slots[level][slot] = timer;
+			count++;
+		}
+
+		void remove(ActiveTimer *timer)
+		{
+			if (timer->level == -1)
+				return;
+
+			if (timer->prev)
+				timer->prev->next = timer->next;
+			else
+				slots[timer->level][timer->slot] = timer->next;
+			if (timer->next)
+				timer->next->prev = timer->prev;
+
+			timer->prev = nullptr;
+			timer->next = nullptr;
+			timer->level = -1;
+			count--;
+		}
+
+		/// \brief Advances the wheel by one tick and returns the timers that expired in it
+		void advance(std::vector<ActiveTimer*> &out_expired)
+		{
+			// Move timers from higher levels down when the level below wraps around
+			for (int level = 1; level < num_levels; level++)
+			{
+				if ((current_tick & ((uint64_t(1) << (level * slot_bits)) - 1)) != 0)
+					break;
+				cascade(level, (int)((current_tick >> (level * slot_bits)) & slot_mask));
+			}
+
+			int slot = (int)(current_tick & slot_mask);
+			while (slots[0][slot])
+			{
+				ActiveTimer *timer = slots[0][slot];
+				remove(timer);
+				if (timer->expire_tick > current_tick)
+					insert(timer); // Clamped timer from the top level
+				else
+					out_expired.push_back(timer);
+			}
+
+			current_tick++;
+		}
+
+		/// \brief Returns the first tick that has timers to expire or move between levels
+		uint64_t next_work_tick() const
+		{
+			uint64_t best = ~uint64_t(0);
+			for (int level = 0; level < num_levels; level++)
+			{
+				int shift = level * slot_bits;
+				uint64_t first = (current_tick + (uint64_t(1) << shift) - 1) >> shift;
+				for (uint64_t i = first; i < first + num_slots; i++)
+				{
+					if (slots[level][i & slot_mask])
+					{
+						best = std::min(best, i << shift);
+						break;
+					}
+				}
+			}
+			return best;
+		}
+
+	private:
+		void cascade(int level, int slot)
+		{
+			ActiveTimer *timer = slots[level][slot];
+			while (timer)
+			{
+				ActiveTimer *next = timer->next;
+				remove(timer);
+				insert(timer);
+				timer = next;
+			}
+		}
+
+		ActiveTimer *slots[num_levels][num_slots];
+		uint64_t current_tick = 0;
+		int count = 0;
+	};
+
 	class TimerThread
 	{
 	public:
@@ -68,17 +209,19 @@ namespace clan
 			std::unique_lock<std::mutex> lock(mutex);
 
 			if (!timer->active)
-			{
-				auto active = std::make_shared<ActiveTimer>(timer);
-				timers.push_back(active);
-				timer->active = active;
-			}
+				timer->active = std::make_shared<ActiveTimer>(timer);
+			else
+				wheel.remove(timer->active.get());
+
+			if (wheel.empty())
+				wheel.set_current_tick(get_tick());
 
 			// Copy timer fields to keep TimerImpl fields updateable outside the mutex lock
 			timer->active->timeout = timer->timeout;
 			timer->active->is_repeating = timer->is_repeating;
 			timer->active->func_expired = timer->func_expired;
-			timer->active->next_awake_time = std::chrono::steady_clock::now() + std::chrono::milliseconds(timer->timeout);
+			timer->active->expire_tick = get_tick() + timer->timeout;
+			wheel.insert(timer->active.get());
 			stop_flag = false;
 
 			lock.unlock();
@@ -97,13 +240,11 @@ namespace clan
 
 			if (timer->active)
 			{
-				auto it = std::find(timers.begin(), timers.end(), timer->active);
-				if (it != timers.end())
-					timers.erase(it);
+				wheel.remove(timer->active.get());
 				timer->active.reset();
 			}
 
-			bool no_timers = timers.empty();
+			bool no_timers = wheel.empty();
 			if (no_timers)
 				stop_flag = true;
 
@@ -125,79 +266,76 @@ namespace clan
 			{
 				fire_timers();
 
-				if (timers.empty())
+				if (wheel.empty())
 					timers_changed_event.wait(lock);
 				else
-					timers_changed_event.wait_until(lock, next_awake_time());
+					timers_changed_event.wait_until(lock, start_time + std::chrono::milliseconds(wheel.next_work_tick()));
 			}
 		}
 
 		void fire_timers()
 		{
-			auto cur_time = std::chrono::steady_clock::now();
-			for (auto it = timers.begin(); it != timers.end();)
+			uint64_t cur_tick = get_tick();
+			while (!wheel.empty() && wheel.get_current_tick() <= cur_tick)
 			{
-				auto &timer = *it;
-				bool remove = false;
+				// Skip ticks with nothing to do in one step
+				uint64_t next_tick = wheel.next_work_tick();
+				if (next_tick > cur_tick)
+				{
+					wheel.set_current_tick(cur_tick + 1);
+					break;
+				}
+				if (next_tick > wheel.get_current_tick())
+					wheel.set_current_tick(next_tick);
+
+				expired.clear();
+				wheel.advance(expired);
 
-				if (timer->next_awake_time < cur_time)
+				for (ActiveTimer *timer : expired)
 				{
 					if (timer->func_expired)
-					{
-						// Copy timer fields to detach them from the mutex lock
-						auto timer_impl = timer->timer_impl;
-						auto func_expired = timer->func_expired;
-
-						RunLoop::main_thread_async([=]()
-						{
-							// Only fire the timer if it is still valid when we reached the main thread
-							if (timer_impl.lock())
-								func_expired();
-						});
-					}
+						expired_callbacks.push_back(std::make_pair(timer->timer_impl, timer->func_expired));
 
 					if (timer->is_repeating)
 					{
-						while (timer->next_awake_time < cur_time)
-							timer->next_awake_time += std::chrono::milliseconds(timer->timeout);
+						uint64_t timeout = std::max(timer->timeout, 1);
+						while (timer->expire_tick <= cur_tick)
+							timer->expire_tick += timeout;
+						wheel.insert(timer);
 					}
 					else
 					{
-						remove = true;
+						// Since the timer is now stopping, we must notify the implementation that the timer is no longer active, else we will not be able to restart it
+						auto timer_impl = timer->timer_impl.lock();
+						if (timer_impl)
+							timer_impl->active.reset();
 					}
 				}
+			}
+			if (wheel.empty())
+				wheel.set_current_tick(cur_tick + 1);
+
+			if (!expired_callbacks.empty())
+			{
+				// All timers expiring in this wakeup are delivered to the main thread together
+				auto callbacks = std::make_shared<std::vector<std::pair<std::weak_ptr<TimerImpl>, std::function<void()>>>>();
+				callbacks->swap(expired_callbacks);
 
-				if (remove)
+				RunLoop::main_thread_async([=]()
 				{
-					// Since the timer is now stopping, we must notify the implementation that the timer is no longer active, else we will not be able to restart it
-					auto timer_impl = timer->timer_impl.lock();
-					if (timer_impl)
-						timer_impl->active.reset();
-					it = timers.erase(it);
-				}
-				else
-					++it;
+					for (auto &callback : *callbacks)
+					{
+						// Only fire the timer if it is still valid when we reached the main thread
+						if (callback.first.lock())
+							callback.second();
+					}
+				});
 			}
 		}
 
-		std::chrono::steady_clock::time_point next_awake_time()
+		uint64_t get_tick() const
 		{
-			std::chrono::steady_clock::time_point t;
-			bool first = true;
-			for (auto &timer : timers)
-			{
-				if (first)
-				{
-					t = timer->next_awake_time;
-					first = false;
-				}
-				else
-				{
-					if (t > timer->next_awake_time)
-						t = timer->next_awake_time;
-				}
-			}
-			return t;
+			return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time).count();
 		}
 
 		bool thread_created = false;
@@ -205,7 +343,10 @@ namespace clan
 		std::mutex mutex;
 		std::condition_variable timers_changed_event;
 		bool stop_flag = false;
-		std::vector<std::shared_ptr<ActiveTimer>> timers;
+		std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+		TimerWheel wheel;
+		std::vector<ActiveTimer*> expired;
+		std::vector<std::pair<std::weak_ptr<TimerImpl>, std::function<void()>>> expired_callbacks;
 	};
 
 	TimerThread timer_thread;
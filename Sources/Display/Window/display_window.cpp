@@ -31,8 +31,10 @@
 #include "Display/precomp.h"
 #include "display_window_impl.h"
 #include "../Render/graphic_context_impl.h"
+#include "../Render/graphic_context_capture_impl.h"
 #include "../setup_display.h"
 #include "API/Display/Window/input_device.h"
+#include <cmath>
 
 namespace clan
 {
@@ -453,9 +455,51 @@ namespace clan
 	void DisplayWindow::flip(int interval)
 	{
 		impl->sig_window_flip();
+		if (GraphicContextCapture_Impl *capture = GraphicContextCapture_Impl::get(get_gc()))
+			capture->end_frame();
 		impl->provider->flip(interval);
 	}
 
+	void DisplayWindow::flip(const std::vector<Rectf> &damage, int interval)
+	{
+		impl->sig_window_flip();
+		if (GraphicContextCapture_Impl *capture = GraphicContextCapture_Impl::get(get_gc()))
+			capture->end_frame();
+
+		float pixel_ratio = impl->provider->get_pixel_ratio();
+		std::vector<Rect> pixel_damage;
+		pixel_damage.reserve(damage.size());
+		for (const auto &rect : damage)
+		{
+			pixel_damage.push_back(Rect(
+				(int)std::floor(rect.left * pixel_ratio),
+				(int)std::floor(rect.top * pixel_ratio),
+				(int)std::ceil(rect.right * pixel_ratio),
+				(int)std::ceil(rect.bottom * pixel_ratio)));
+		}
+		impl->provider->flip(pixel_damage, interval);
+	}
+
+	void DisplayWindow::set_max_frame_latency(int frames)
+	{
+		impl->provider->set_max_frame_latency(frames);
+	}
+
+	bool DisplayWindow::set_adaptive_vsync(bool enable)
+	{
+		return impl->provider->set_adaptive_vsync(enable);
+	}
+
+	void DisplayWindow::wait_for_frame_slot()
+	{
+		impl->provider->wait_for_frame_slot();
+	}
+
+	FrameTiming DisplayWindow::get_frame_timing() const
+	{
+		return impl->provider->get_frame_timing();
+	}
+
 	void DisplayWindow::show_cursor()
 	{
 		impl->provider->show_system_cursor();
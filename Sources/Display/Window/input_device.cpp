@@ -31,6 +31,7 @@
 #include "API/Display/Window/input_device.h"
 #include "API/Display/TargetProviders/input_device_provider.h"
 #include "API/Display/Window/keys.h"
+#include "API/Display/Window/input_event.h"
 #include "API/Core/Text/string_format.h"
 #include "API/Core/Text/string_help.h"
 #include "input_device_impl.h"
@@ -459,6 +460,47 @@ namespace clan
 			impl->provider->set_device_position(x, y);
 	}
 
+	bool InputDevice::set_raw_input(bool enable)
+	{
+		if (impl->provider)
+			return impl->provider->set_raw_input(enable);
+		else
+			return false;
+	}
+
+	void InputDevice::set_event_batching(bool enable)
+	{
+		if (impl->batching == enable)
+			return;
+
+		impl->batching = enable;
+		impl->batched_events.clear();
+		impl->batch_slots = SlotContainer();
+
+		if (enable)
+		{
+			// The slots are owned by the impl, so capturing it directly is safe
+			InputDevice_Impl *device_impl = impl.get();
+			auto queue = [device_impl](const InputEvent &e) { device_impl->queue_event(e); };
+			impl->batch_slots.connect(impl->sig_key_down, queue);
+			impl->batch_slots.connect(impl->sig_key_up, queue);
+			impl->batch_slots.connect(impl->sig_pointer_move, queue);
+			impl->batch_slots.connect(impl->sig_axis_move, queue);
+			impl->batch_slots.connect(impl->sig_key_dblclk, queue);
+			impl->batch_slots.connect(impl->sig_proximity_change, queue);
+			impl->batch_slots.connect(impl->sig_pointer_raw_move, queue);
+		}
+	}
+
+	std::vector<InputEvent> InputDevice::take_events()
+	{
+		std::vector<InputEvent> events;
+		events.swap(impl->batched_events);
+		for (auto &e : events)
+			e.device = *this;
+		return events;
+	}
+
 	Signal<void(const InputEvent &)> &InputDevice::sig_key_down()
 	{
 		return impl->sig_key_down;
@@ -474,6 +516,11 @@ namespace clan
 		return impl->sig_pointer_move;
 	}
 
+	Signal<void(const InputEvent &)> &InputDevice::sig_pointer_raw_move()
+	{
+		return impl->sig_pointer_raw_move;
+	}
+
 	Signal<void(const InputEvent &)> &InputDevice::sig_axis_move()
 	{
 		return impl->sig_axis_move;
@@ -488,4 +535,18 @@ namespace clan
 	{
 		return impl->sig_proximity_change;
 	}
+
+	/////////////////////////////////////////////////////////////////////////
+
+	void InputDevice_Impl::queue_event(const InputEvent &e)
+	{
+		// Nobody is draining the queue. Drop the oldest half at once rather than shifting the vector for every event.
+		if (batched_events.size() >= max_batched_events)
+			batched_events.erase(batched_events.begin(), batched_events.begin() + max_batched_events / 2);
+
+		batched_events.push_back(e);
+
+		// The queue lives in this impl, so holding a reference to the device would keep it alive forever
+		batched_events.back().device = InputDevice();
+	}
 }
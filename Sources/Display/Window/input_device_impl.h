@@ -30,6 +30,7 @@
 
 #include "API/Core/Signals/signal.h"
 #include "API/Display/TargetProviders/input_device_provider.h"
+#include "API/Display/Window/input_event.h"
 
 namespace clan
 {
@@ -45,5 +46,13 @@ namespace clan
 		Signal<void(const InputEvent &)> sig_axis_move;
 		Signal<void(const InputEvent &)> sig_key_dblclk;
 		Signal<void(const InputEvent &)> sig_proximity_change;
+		Signal<void(const InputEvent &)> sig_pointer_raw_move;
+
+		void queue_event(const InputEvent &e);
+
+		static const size_t max_batched_events = 4096;
+		bool batching = false;
+		std::vector<InputEvent> batched_events;
+		SlotContainer batch_slots;
 	};
 }
@@ -28,11 +28,12 @@
 
 #include "Display/precomp.h"
 #include "API/Display/Window/input_event.h"
+#include "API/Core/System/system.h"
 
 namespace clan
 {
 	InputEvent::InputEvent()
-		: id(keycode_unknown), id_offset(0), type(InputEvent::no_key), repeat_count(0)
+		: id(keycode_unknown), id_offset(0), type(InputEvent::no_key), axis_pos(0.0), repeat_count(0), alt(false), shift(false), ctrl(false), timestamp(System::get_microseconds())
 	{
 	}
 
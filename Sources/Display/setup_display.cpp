@@ -46,6 +46,7 @@
 #include "Platform/Cocoa/display_message_queue_cocoa.h"
 #elif !defined(__ANDROID__)
 #include "Platform/X11/display_message_queue_x11.h"
+#include "Platform/X11/font_config.h"
 #endif
 
 #if !defined __ANDROID__ && ! defined __APPLE__ && ! defined WIN32
@@ -106,6 +107,9 @@ namespace clan
 		// The XInitThreads() function initializes Xlib support for concurrent threads.
 		// This function must be the first Xlib function a multi-threaded program calls, and it must complete before any other Xlib call is made.
 		XInitThreads();
+
+		// Start loading fontconfig in the background, so it is ready when the first system font is created
+		FontConfig::instance();
 #endif
 		jpeg_provider = new ProviderType_Register<JPEGProvider>("jpeg");
 		jpg_provider = new ProviderType_Register<JPEGProvider>("jpg");
@@ -56,6 +56,7 @@
 #include "API/Display/2D/image.h"
 #include "gl1_frame_buffer_provider.h"
 #include "Display/2D/render_batch_triangle.h"
+#include <algorithm>
 
 #ifdef WIN32
 #include "../Platform/WGL/opengl_window_provider_wgl.h"
@@ -82,6 +83,14 @@ namespace clan
 		framebuffer_bound(false)
 	{
 		check_opengl_version();
+
+		// Vertex buffer objects are core in OpenGL 1.5. The function pointers fall back to the ARB names for older drivers.
+		int version_major = 0, version_minor = 0, version_release = 0;
+		get_opengl_version(version_major, version_minor, version_release);
+		const char *extensions = (const char *)glGetString(GL_EXTENSIONS);
+		bool buffer_objects_available = (version_major > 1 || version_minor >= 5) || (extensions && strstr(extensions, "GL_ARB_vertex_buffer_object"));
+		vertex_buffer_objects = buffer_objects_available && glGenBuffers && glDeleteBuffers && glBindBuffer && glBufferData && glBufferSubData;
+
 		max_texture_coords = get_max_texture_coords();
 		// Limit the internal texture coords, to avoid situations where the opengl driver says there are unlimited texture coords
 		if (max_texture_coords > 32)
@@ -186,6 +195,32 @@ namespace clan
 			version_release = StringHelp::text_to_int(split_version[2]);
 	}
 
+	bool GL1GraphicContextProvider::is_compressed_format_supported(TextureFormat format) const
+	{
+		if (format < tf_compressed_red_rgtc1)
+			return false;
+
+		GLint gl_internal_format;
+		GLenum gl_pixel_format;
+		try
+		{
+			GL1TextureProvider::to_opengl_textureformat(format, gl_internal_format, gl_pixel_format);
+		}
+		catch (const Exception &)
+		{
+			return false;
+		}
+
+		OpenGL::set_active(this);
+		GLint count = 0;
+		glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &count);
+		if (count <= 0)
+			return false;
+		std::vector<GLint> formats(count);
+		glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, formats.data());
+		return std::find(formats.begin(), formats.end(), gl_internal_format) != formats.end();
+	}
+
 	ProcAddress *GL1GraphicContextProvider::get_proc_address(const std::string& function_name) const
 	{
 		return render_window->get_proc_address(function_name);
@@ -213,6 +248,11 @@ namespace clan
 		return max_attributes;
 	}
 
+	int GL1GraphicContextProvider::get_uniform_buffer_alignment() const
+	{
+		return 16;
+	}
+
 
 	Size GL1GraphicContextProvider::get_max_texture_size() const
 	{
@@ -249,6 +289,16 @@ namespace clan
 		throw Exception("Occlusion Queries are not supported for OpenGL 1.3");
 	}
 
+	TimerQueryProvider *GL1GraphicContextProvider::alloc_timer_query()
+	{
+		throw Exception("Timer Queries are not supported for OpenGL 1.3");
+	}
+
+	FenceProvider *GL1GraphicContextProvider::alloc_fence()
+	{
+		throw Exception("Fences are not supported for OpenGL 1.3");
+	}
+
 	ProgramObjectProvider *GL1GraphicContextProvider::alloc_program_object()
 	{
 		throw Exception("Program Objects are not supported for OpenGL 1.3");
@@ -276,7 +326,7 @@ namespace clan
 
 	VertexArrayBufferProvider *GL1GraphicContextProvider::alloc_vertex_array_buffer()
 	{
-		return new GL1VertexArrayBufferProvider;
+		return new GL1VertexArrayBufferProvider(this);
 	}
 
 	UniformBufferProvider *GL1GraphicContextProvider::alloc_uniform_buffer()
@@ -425,11 +475,20 @@ namespace clan
 		return pbuf;
 	}
 
+	void GL1GraphicContextProvider::read_pixels(const Rect& rect, PixelBufferProvider *destination)
+	{
+		throw Exception("Asynchronous pixel reads are not supported for OpenGL 1.3");
+	}
+
 	void GL1GraphicContextProvider::set_uniform_buffer(int index, const UniformBuffer &buffer)
 	{
 		//GL1UniformBufferProvider *provider = static_cast<GL1UniformBufferProvider*>(buffer.get_provider());
 	}
 
+	void GL1GraphicContextProvider::set_uniform_buffer_range(int index, const UniformBuffer &buffer, int offset, int size)
+	{
+	}
+
 	void GL1GraphicContextProvider::reset_uniform_buffer(int index)
 	{
 	}
@@ -595,21 +654,18 @@ namespace clan
 
 			const PrimitivesArrayProvider::VertexData &attribute = prim_array->attributes[attribute_index];
 
-			GL1VertexArrayBufferProvider *vertex_array_ptr = static_cast<GL1VertexArrayBufferProvider *>(attribute.array_provider);
-			if (!vertex_array_ptr)
+			if (!attribute.array_provider)
 				throw Exception("Invalid BindBuffer Provider");
 
-			const char *data_ptr = ((const char *)vertex_array_ptr->get_data()) + attribute.offset;
-
 			switch (attribute_index)
 			{
 			case 0: // POSITION
 				glEnableClientState(GL_VERTEX_ARRAY);
-				glVertexPointer(attribute.size, OpenGL::to_enum(attribute.type), attribute.stride, data_ptr);
+				glVertexPointer(attribute.size, OpenGL::to_enum(attribute.type), attribute.stride, bind_vertex_array(attribute));
 				break;
 			case 1: // COLOR
 				glEnableClientState(GL_COLOR_ARRAY);
-				glColorPointer(attribute.size, OpenGL::to_enum(attribute.type), attribute.stride, data_ptr);
+				glColorPointer(attribute.size, OpenGL::to_enum(attribute.type), attribute.stride, bind_vertex_array(attribute));
 
 				break;
 			case 2: // TEXTURE
@@ -622,12 +678,28 @@ namespace clan
 				break;
 			case 4: // NORMAL
 				glEnableClientState(GL_NORMAL_ARRAY);
-				glNormalPointer(OpenGL::to_enum(attribute.type), attribute.stride, data_ptr);
+				glNormalPointer(OpenGL::to_enum(attribute.type), attribute.stride, bind_vertex_array(attribute));
 				break;
 			}
 		}
 	}
 
+	const char *GL1GraphicContextProvider::bind_vertex_array(const PrimitivesArrayProvider::VertexData &attribute)
+	{
+		GL1VertexArrayBufferProvider *vertex_array_ptr = static_cast<GL1VertexArrayBufferProvider *>(attribute.array_provider);
+		if (!vertex_array_ptr)
+			throw Exception("Invalid BindBuffer Provider");
+
+		// With a buffer object bound the pointer is an offset into it, so the vertices are not sent again for every draw
+		if (vertex_buffer_objects)
+		{
+			glBindBuffer(GL_ARRAY_BUFFER, vertex_array_ptr->get_handle());
+			if (vertex_array_ptr->get_handle())
+				return (const char *)nullptr + attribute.offset;
+		}
+		return ((const char *)vertex_array_ptr->get_data()) + attribute.offset;
+	}
+
 	void GL1GraphicContextProvider::draw_primitives_array(PrimitivesType type, int offset, int num_vertices)
 	{
 		set_active();
@@ -723,6 +795,11 @@ namespace clan
 		throw Exception("Cannot draw instanced for the OpenGL 1.3 target");
 	}
 
+	void GL1GraphicContextProvider::draw_primitives_array_indirect(PrimitivesType type, const StorageBuffer &commands, size_t offset, int draw_count, int stride)
+	{
+		throw Exception("Cannot draw indirect for the OpenGL 1.3 target");
+	}
+
 	void GL1GraphicContextProvider::set_primitives_elements(ElementArrayBufferProvider *array_provider)
 	{
 		throw Exception("Cannot draw Element Array Buffers for the OpenGL 1.3 target");
@@ -738,6 +815,11 @@ namespace clan
 		throw Exception("Cannot draw instanced for the OpenGL 1.3 target");
 	}
 
+	void GL1GraphicContextProvider::draw_primitives_elements_indirect(PrimitivesType type, VertexAttributeDataType indices_type, const StorageBuffer &commands, size_t offset, int draw_count, int stride)
+	{
+		throw Exception("Cannot draw indirect for the OpenGL 1.3 target");
+	}
+
 	void GL1GraphicContextProvider::reset_primitives_elements()
 	{
 		throw Exception("Cannot draw Element Array Buffers for the OpenGL 1.3 target");
@@ -771,6 +853,9 @@ namespace clan
 		primitives_array_texture_set = false;
 		primitives_array_texindex_set = false;
 
+		if (vertex_buffer_objects)
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+
 		glDisableClientState(GL_VERTEX_ARRAY);
 		glDisableClientState(GL_COLOR_ARRAY);
 		glDisableClientState(GL_NORMAL_ARRAY);
@@ -939,24 +1024,23 @@ namespace clan
 			glBindTexture(texture->get_texture_type(), texture->get_handle());
 
 			if (glClientActiveTexture)
+			{
 				glClientActiveTexture(GL_TEXTURE0 + texture_index);
+				num_set_tex_arrays = std::max(num_set_tex_arrays, texture_index + 1);
+			}
 
 			glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 
 			if (texture->is_power_of_two_texture() || (num_vertices == 0))
 			{
-				GL1VertexArrayBufferProvider *vertex_array_ptr = static_cast<GL1VertexArrayBufferProvider *>(array_texture.array_provider);
-				if (!vertex_array_ptr)
-					throw Exception("Invalid BindBuffer Provider");
-
-				const char *data_ptr = ((const char *)vertex_array_ptr->get_data()) + array_texture.offset;
-
-				glTexCoordPointer(array_texture.size, OpenGL::to_enum(array_texture.type), array_texture.stride, data_ptr);
+				glTexCoordPointer(array_texture.size, OpenGL::to_enum(array_texture.type), array_texture.stride, bind_vertex_array(array_texture));
 			}
 			else
 			{
 				// A hack to handle non-power-of-two textures
 				texture->transform_coordinate(array_texture, transformed_coords, offset, num_vertices, total_vertices);
+				if (vertex_buffer_objects)
+					glBindBuffer(GL_ARRAY_BUFFER, 0);
 				glTexCoordPointer(array_texture.size, GL_FLOAT, 0, &transformed_coords[0]);
 			}
 		}
@@ -86,6 +86,7 @@ namespace clan
 		~GL1GraphicContextProvider();
 
 		int get_max_attributes() override;
+		int get_uniform_buffer_alignment() const override;
 		Size get_max_texture_size() const override;
 		const DisplayWindowProvider & get_render_window() const;
 		OpenGLWindowProvider & get_opengl_window();
@@ -109,8 +110,11 @@ namespace clan
 		int get_major_version() const override { int major = 0, minor = 0; get_opengl_version(major, minor); return major; }
 		int get_minor_version() const override { int major = 0, minor = 0; get_opengl_version(major, minor); return minor; }
 		bool has_compute_shader_support() const override { return false; }
+		bool is_compressed_format_supported(TextureFormat format) const override;
 		TextureProvider *alloc_texture(TextureDimensions texture_dimensions) override;
 		OcclusionQueryProvider *alloc_occlusion_query() override;
+		TimerQueryProvider *alloc_timer_query() override;
+		FenceProvider *alloc_fence() override;
 		ProgramObjectProvider *alloc_program_object() override;
 		ShaderObjectProvider *alloc_shader_object() override;
 		FrameBufferProvider *alloc_frame_buffer() override;
@@ -129,7 +133,9 @@ namespace clan
 		void set_blend_state(BlendStateProvider *state, const Colorf &blend_color, unsigned int sample_mask) override;
 		void set_depth_stencil_state(DepthStencilStateProvider *state, int stencil_ref) override;
 		PixelBuffer get_pixeldata(const Rect& rect, TextureFormat texture_format, bool clamp) const override;
+		void read_pixels(const Rect& rect, PixelBufferProvider *destination) override;
 		void set_uniform_buffer(int index, const UniformBuffer &buffer) override;
+		void set_uniform_buffer_range(int index, const UniformBuffer &buffer, int offset, int size) override;
 		void reset_uniform_buffer(int index) override;
 		void set_storage_buffer(int index, const StorageBuffer &buffer) override;
 		void reset_storage_buffer(int index) override;
@@ -150,9 +156,11 @@ namespace clan
 		void set_primitives_array(const PrimitivesArray &primitives_array) override;
 		void draw_primitives_array(PrimitivesType type, int offset, int num_vertices) override;
 		void draw_primitives_array_instanced(PrimitivesType type, int offset, int num_vertices, int instance_count) override;
+		void draw_primitives_array_indirect(PrimitivesType type, const StorageBuffer &commands, size_t offset, int draw_count, int stride) override;
 		void set_primitives_elements(ElementArrayBufferProvider *array_provider) override;
 		void draw_primitives_elements(PrimitivesType type, int count, VertexAttributeDataType indices_type, size_t offset = 0) override;
 		void draw_primitives_elements_instanced(PrimitivesType type, int count, VertexAttributeDataType indices_type, size_t offset, int instance_count) override;
+		void draw_primitives_elements_indirect(PrimitivesType type, VertexAttributeDataType indices_type, const StorageBuffer &commands, size_t offset, int draw_count, int stride) override;
 		void reset_primitives_elements() override;
 		void draw_primitives_elements(PrimitivesType type, int count, ElementArrayBufferProvider *array_provider, VertexAttributeDataType indices_type, void *offset) override;
 		void draw_primitives_elements_instanced(PrimitivesType type, int count, ElementArrayBufferProvider *array_provider, VertexAttributeDataType indices_type, void *offset, int instance_count) override;
@@ -174,6 +182,9 @@ namespace clan
 		// GL1 Only
 		void set_active() const;
 
+		/// \brief Returns true if vertex arrays are stored in ARB_vertex_buffer_object buffers instead of being sent from system memory on every draw
+		bool is_vertex_buffer_object_supported() const { return vertex_buffer_objects; }
+
 		void add_disposable(DisposableObject *disposable);
 		void remove_disposable(DisposableObject *disposable);
 		void make_current() const override;
@@ -186,6 +197,7 @@ namespace clan
 		void set_primitive_texture(int texture_index, PrimitivesArrayProvider::VertexData &array_texture, int offset, int num_vertices, int total_vertices);
 		void reset_primitive_texture(int texture_index);
 		void reset_primitive_texture_all();
+		const char *bind_vertex_array(const PrimitivesArrayProvider::VertexData &attribute);
 
 		OpenGLWindowProvider *render_window;
 
@@ -195,6 +207,8 @@ namespace clan
 
 		int max_texture_coords;
 
+		bool vertex_buffer_objects = false;
+
 		std::vector<GL1SelectedTexture> selected_textures;
 
 		bool primitives_array_texture_set;
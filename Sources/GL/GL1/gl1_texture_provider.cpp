@@ -1325,6 +1325,14 @@ namespace clan
 			case tf_compressed_srgb_alpha_s3tc_dxt1: break;
 			case tf_compressed_srgb_alpha_s3tc_dxt3: break;
 			case tf_compressed_srgb_alpha_s3tc_dxt5: break;
+			case tf_compressed_rgba_bptc_unorm: break;
+			case tf_compressed_srgb_alpha_bptc_unorm: break;
+			case tf_compressed_rgb8_etc2: break;
+			case tf_compressed_srgb8_etc2: break;
+			case tf_compressed_rgba8_etc2_eac: break;
+			case tf_compressed_srgb8_alpha8_etc2_eac: break;
+			case tf_compressed_rgba_astc_4x4: break;
+			case tf_compressed_srgb8_alpha8_astc_4x4: break;
 		}
 
 		return valid;
@@ -70,6 +70,14 @@ namespace clan
 		memcpy(this->data, data, size);
 	}
 
+	void GL1UniformBufferProvider::upload_data(GraphicContext &gc, int offset, const void *data, int size)
+	{
+		if ((offset < 0) || (size < 0) || ((size + offset) > this->size))
+			throw Exception("Uniform buffer, invalid size");
+
+		memcpy(this->data + offset, data, size);
+	}
+
 	void GL1UniformBufferProvider::copy_from(GraphicContext &gc, TransferBuffer &buffer, int dest_pos, int src_pos, int size)
 	{
 		buffer.lock(gc, access_read_only);
@@ -45,6 +45,7 @@ namespace clan
 		void *get_data() const { return data; }
 
 		void upload_data(GraphicContext &gc, const void *data, int size) override;
+		void upload_data(GraphicContext &gc, int offset, const void *data, int size) override;
 		void copy_from(GraphicContext &gc, TransferBuffer &buffer, int dest_pos, int src_pos, int size) override;
 		void copy_to(GraphicContext &gc, TransferBuffer &buffer, int dest_pos, int src_pos, int size) override;
 
@@ -28,37 +28,85 @@
 
 #include "GL/precomp.h"
 #include "gl1_vertex_array_buffer_provider.h"
+#include "gl1_graphic_context_provider.h"
 #include "API/Display/Render/transfer_buffer.h"
+#include "API/GL/opengl_wrap.h"
 
 namespace clan
 {
-	GL1VertexArrayBufferProvider::GL1VertexArrayBufferProvider()
-		: data(nullptr), size(0)
+	GL1VertexArrayBufferProvider::GL1VertexArrayBufferProvider(GL1GraphicContextProvider *gc_provider)
+		: gc_provider(gc_provider), data(nullptr), size(0)
 	{
+		gc_provider->add_disposable(this);
 	}
 
 	GL1VertexArrayBufferProvider::~GL1VertexArrayBufferProvider()
 	{
+		dispose();
 		delete[] data;
 	}
 
-	void GL1VertexArrayBufferProvider::create(int new_size, BufferUsage usage)
+	void GL1VertexArrayBufferProvider::on_dispose()
+	{
+		if (handle)
+		{
+			if (OpenGL::set_active())
+				glDeleteBuffers(1, &handle);
+			handle = 0;
+		}
+		gc_provider->remove_disposable(this);
+	}
+
+	void GL1VertexArrayBufferProvider::create(int new_size, BufferUsage new_usage)
 	{
 		delete[] data;
 		data = nullptr;
 		size = 0;
 		data = new char[new_size];
 		size = new_size;
+		usage = new_usage;
+		create_buffer_object(nullptr);
 	}
 
-	void GL1VertexArrayBufferProvider::create(void *init_data, int new_size, BufferUsage usage)
+	void GL1VertexArrayBufferProvider::create(void *init_data, int new_size, BufferUsage new_usage)
 	{
 		delete[] data;
 		data = nullptr;
 		size = 0;
 		data = new char[new_size];
 		size = new_size;
+		usage = new_usage;
 		memcpy(data, init_data, size);
+		create_buffer_object(init_data);
+	}
+
+	void GL1VertexArrayBufferProvider::create_buffer_object(const void *init_data)
+	{
+		throw_if_disposed();
+		if (!gc_provider->is_vertex_buffer_object_supported())
+			return;
+
+		gc_provider->set_active();
+		if (!handle)
+			glGenBuffers(1, &handle);
+		glBindBuffer(GL_ARRAY_BUFFER, handle);
+		glBufferData(GL_ARRAY_BUFFER, size, init_data, OpenGL::to_enum(usage));
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	void GL1VertexArrayBufferProvider::upload_buffer_object(int offset, const void *new_data, int new_size, bool discard)
+	{
+		if (!handle)
+			return;
+
+		gc_provider->set_active();
+		glBindBuffer(GL_ARRAY_BUFFER, handle);
+
+		// Reallocating the storage lets the driver hand out fresh memory instead of waiting for draws still reading the old contents
+		if (discard)
+			glBufferData(GL_ARRAY_BUFFER, size, nullptr, OpenGL::to_enum(usage));
+		glBufferSubData(GL_ARRAY_BUFFER, offset, new_size, new_data);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
 	}
 
 	void GL1VertexArrayBufferProvider::upload_data(GraphicContext &gc, int offset, const void *new_data, int new_size)
@@ -67,6 +115,16 @@ namespace clan
 			throw Exception("Vertex array buffer, invalid size");
 
 		memcpy(data + offset, new_data, new_size);
+		upload_buffer_object(offset, new_data, new_size, false);
+	}
+
+	void GL1VertexArrayBufferProvider::upload_data_unsynchronized(GraphicContext &gc, int offset, const void *new_data, int new_size, bool discard)
+	{
+		if ((offset < 0) || (new_size < 0) || ((new_size + offset) > size))
+			throw Exception("Vertex array buffer, invalid size");
+
+		memcpy(data + offset, new_data, new_size);
+		upload_buffer_object(offset, new_data, new_size, discard);
 	}
 
 	void GL1VertexArrayBufferProvider::copy_from(GraphicContext &gc, TransferBuffer &buffer, int dest_pos, int src_pos, int size)
@@ -74,6 +132,7 @@ namespace clan
 		buffer.lock(gc, access_read_only);
 		memcpy(this->data + dest_pos, (char *)buffer.get_data() + src_pos, size);
 		buffer.unlock();
+		upload_buffer_object(dest_pos, this->data + dest_pos, size, false);
 	}
 
 	void GL1VertexArrayBufferProvider::copy_to(GraphicContext &gc, TransferBuffer &buffer, int dest_pos, int src_pos, int size)
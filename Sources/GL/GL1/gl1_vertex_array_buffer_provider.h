@@ -29,25 +29,45 @@
 #pragma once
 
 #include "API/Display/TargetProviders/vertex_array_buffer_provider.h"
+#include "API/Core/System/disposable_object.h"
+#include "API/GL/opengl.h"
 
 namespace clan
 {
-	class GL1VertexArrayBufferProvider : public VertexArrayBufferProvider
+	class GL1GraphicContextProvider;
+
+	class GL1VertexArrayBufferProvider : public VertexArrayBufferProvider, DisposableObject
 	{
 	public:
-		GL1VertexArrayBufferProvider();
+		GL1VertexArrayBufferProvider(GL1GraphicContextProvider *gc_provider);
 		~GL1VertexArrayBufferProvider();
 		void create(int size, BufferUsage usage) override;
 		void create(void *data, int size, BufferUsage usage) override;
 
+		/// \brief Returns the copy of the data in system memory
+		///
+		/// This is always kept, as texture index and non-power-of-two texture coordinate arrays are read on the CPU.
 		void *get_data() const { return data; }
 
+		/// \brief Returns the vertex buffer object holding the data, or 0 if the driver has no vertex buffer objects
+		///
+		/// When set, attribute pointers are offsets into this buffer instead of pointers into get_data().
+		GLuint get_handle() const { return handle; }
+
 		void upload_data(GraphicContext &gc, int offset, const void *data, int size) override;
+		void upload_data_unsynchronized(GraphicContext &gc, int offset, const void *data, int size, bool discard) override;
 		void copy_from(GraphicContext &gc, TransferBuffer &buffer, int dest_pos, int src_pos, int size) override;
 		void copy_to(GraphicContext &gc, TransferBuffer &buffer, int dest_pos, int src_pos, int size) override;
 
 	private:
+		void on_dispose() override;
+		void create_buffer_object(const void *init_data);
+		void upload_buffer_object(int offset, const void *data, int size, bool discard);
+
+		GL1GraphicContextProvider *gc_provider;
 		char *data;
 		int size;
+		BufferUsage usage = usage_static_draw;
+		GLuint handle = 0;
 	};
 }
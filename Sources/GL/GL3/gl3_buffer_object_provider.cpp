@@ -36,8 +36,8 @@
 
 namespace clan
 {
-	GL3BufferObjectProvider::GL3BufferObjectProvider()
-		: handle(0), data_ptr(nullptr)
+	GL3BufferObjectProvider::GL3BufferObjectProvider(GPUMemoryCategory memory_category)
+		: handle(0), data_ptr(nullptr), memory(memory_category)
 	{
 		SharedGCData::add_disposable(this);
 		OpenGL::set_active();
@@ -58,6 +58,7 @@ namespace clan
 			if (OpenGL::set_active())
 			{
 				glDeleteBuffers(1, &handle);
+				GL3GraphicContextProvider::forget_buffer(handle);
 			}
 		}
 	}
@@ -77,6 +78,8 @@ namespace clan
 		glBindBuffer(target, handle);
 		glBufferData(target, size, data, OpenGL::to_enum(usage));
 		glBindBuffer(target, last_buffer);
+
+		memory.set_size(size);
 	}
 
 	void *GL3BufferObjectProvider::get_data()
@@ -125,6 +128,36 @@ namespace clan
 		glBindBuffer(target, last_buffer);
 	}
 
+	void GL3BufferObjectProvider::upload_data_unsynchronized(GraphicContext &gc, int offset, const void *data, int size, bool discard)
+	{
+		throw_if_disposed();
+		OpenGL::set_active(gc);
+		if (glMapBufferRange == nullptr)
+		{
+			upload_data(gc, offset, data, size);
+			return;
+		}
+
+		GLint last_buffer = 0;
+		if (binding)
+			glGetIntegerv(binding, &last_buffer);
+		glBindBuffer(target, handle);
+
+		// Invalidating the whole buffer lets the driver hand out new storage while the GPU still reads the old
+		GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | (discard ? GL_MAP_INVALIDATE_BUFFER_BIT : GL_MAP_INVALIDATE_RANGE_BIT);
+		void *dest = glMapBufferRange(target, offset, size, access);
+		if (dest)
+		{
+			memcpy(dest, data, size);
+			glUnmapBuffer(target);
+		}
+		else
+		{
+			glBufferSubData(target, offset, size, data);
+		}
+		glBindBuffer(target, last_buffer);
+	}
+
 	void GL3BufferObjectProvider::upload_data(GraphicContext &gc, const void *data, int size)
 	{
 		upload_data(gc, 0, data, size);
@@ -31,6 +31,7 @@
 
 #include "API/Display/TargetProviders/vertex_array_buffer_provider.h"
 #include "API/Display/Render/graphic_context.h"
+#include "API/Display/Render/gpu_memory.h"
 #include "API/GL/opengl.h"
 #include "API/Core/System/disposable_object.h"
 
@@ -43,7 +44,7 @@ namespace clan
 	class GL3BufferObjectProvider : public DisposableObject
 	{
 	public:
-		GL3BufferObjectProvider();
+		GL3BufferObjectProvider(GPUMemoryCategory memory_category);
 		~GL3BufferObjectProvider();
 		void create(const void *data, int size, BufferUsage usage, GLenum new_binding, GLenum new_target);
 
@@ -56,6 +57,7 @@ namespace clan
 		void lock(GraphicContext &gc, BufferAccess access);
 		void unlock();
 		void upload_data(GraphicContext &gc, int offset, const void *data, int size);
+		void upload_data_unsynchronized(GraphicContext &gc, int offset, const void *data, int size, bool discard);
 
 		void upload_data(GraphicContext &gc, const void *data, int size);
 		void copy_from(GraphicContext &gc, TransferBuffer &buffer, int dest_pos, int src_pos, int size);
@@ -70,5 +72,7 @@ namespace clan
 
 		void *data_ptr;
 		GraphicContext lock_gc;
+
+		GPUMemoryAllocation memory;
 	};
 }
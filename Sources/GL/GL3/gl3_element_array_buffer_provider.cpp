@@ -36,6 +36,7 @@
 namespace clan
 {
 	GL3ElementArrayBufferProvider::GL3ElementArrayBufferProvider()
+		: buffer(gpu_memory_element_buffer)
 	{
 	}
 
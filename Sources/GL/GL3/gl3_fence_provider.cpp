@@ -0,0 +1,99 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Harry Storbacka
+*/
+
+#include "GL/precomp.h"
+#include "gl3_fence_provider.h"
+#include "API/GL/opengl_wrap.h"
+#include "API/Display/Render/shared_gc_data.h"
+#include "gl3_graphic_context_provider.h"
+
+namespace clan
+{
+	GL3FenceProvider::GL3FenceProvider(GL3GraphicContextProvider *gc_provider)
+		: handle(nullptr), gc_provider(gc_provider)
+	{
+		SharedGCData::add_disposable(this);
+	}
+
+	GL3FenceProvider::~GL3FenceProvider()
+	{
+		dispose();
+		SharedGCData::remove_disposable(this);
+	}
+
+	void GL3FenceProvider::on_dispose()
+	{
+		if (handle)
+		{
+			if (OpenGL::set_active())
+			{
+				glDeleteSync(handle);
+			}
+			handle = nullptr;
+		}
+	}
+
+	void GL3FenceProvider::insert()
+	{
+		OpenGL::set_active(gc_provider);
+
+		if (handle)
+			glDeleteSync(handle);
+		handle = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+		// Without a flush the fence may sit in the command queue and never be signaled while polling
+		glFlush();
+	}
+
+	bool GL3FenceProvider::is_signaled()
+	{
+		if (!handle)
+			return true;
+
+		OpenGL::set_active(gc_provider);
+		GLint status = 0;
+		glGetSynciv(handle, GL_SYNC_STATUS, 1, nullptr, &status);
+		return status == GL_SIGNALED;
+	}
+
+	void GL3FenceProvider::wait()
+	{
+		if (!handle)
+			return;
+
+		OpenGL::set_active(gc_provider);
+		while (true)
+		{
+			GLenum result = glClientWaitSync(handle, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+			if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED)
+				break;
+			if (result == GL_WAIT_FAILED)
+				throw Exception("glClientWaitSync failed");
+		}
+	}
+}
@@ -72,6 +72,8 @@ namespace clan
 		{
 			OpenGL::set_active(gc_provider);
 			glDeleteFramebuffers(1, &handle);
+			gc_provider->get_state_cache().forget_frame_buffer(handle);
+			gc_provider->forget_frame_buffer(this);
 			handle = 0;
 		}
 
@@ -305,6 +307,55 @@ namespace clan
 		bind_target = target;
 	}
 
+	void GL3FrameBufferProvider::set_load_action(FrameBufferLoadAction action, int attachments)
+	{
+		if (action == load_action_dont_care)
+			load_dont_care |= attachments;
+		else
+			load_dont_care &= ~attachments;
+	}
+
+	void GL3FrameBufferProvider::set_store_action(FrameBufferStoreAction action, int attachments)
+	{
+		if (action == store_action_dont_care)
+			store_dont_care |= attachments;
+		else
+			store_dont_care &= ~attachments;
+	}
+
+	void GL3FrameBufferProvider::invalidate_attachments(int attachments)
+	{
+		FrameBufferStateTracker tracker(framebuffer_draw, handle, gc_provider);
+		invalidate_bound(attachments);
+	}
+
+	void GL3FrameBufferProvider::invalidate_bound(int attachments)
+	{
+		if (glInvalidateFramebuffer == nullptr)
+			return;
+
+		GLenum buffers[max_color_attachments + 2];
+		GLsizei count = 0;
+		if (attachments & attachment_color)
+		{
+			for (int i = 0; i < max_color_attachments; i++)
+			{
+				int offset = color_attachment_offset + i;
+				if (!attached_textures[offset].is_null() || !attached_renderbuffers[offset].is_null())
+					buffers[count++] = GL_COLOR_ATTACHMENT0 + i;
+			}
+		}
+
+		bool depth_stencil = !attached_textures[depth_stencil_attachment_offset].is_null() || !attached_renderbuffers[depth_stencil_attachment_offset].is_null();
+		if ((attachments & attachment_depth) && (depth_stencil || !attached_textures[depth_attachment_offset].is_null() || !attached_renderbuffers[depth_attachment_offset].is_null()))
+			buffers[count++] = GL_DEPTH_ATTACHMENT;
+		if ((attachments & attachment_stencil) && (depth_stencil || !attached_textures[stencil_attachment_offset].is_null() || !attached_renderbuffers[stencil_attachment_offset].is_null()))
+			buffers[count++] = GL_STENCIL_ATTACHMENT;
+
+		if (count > 0)
+			glInvalidateFramebuffer(GL_DRAW_FRAMEBUFFER, count, buffers);
+	}
+
 	void GL3FrameBufferProvider::check_framebuffer_complete()
 	{
 		FrameBufferStateTracker tracker(bind_target, handle, gc_provider);
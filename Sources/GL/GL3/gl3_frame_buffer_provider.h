@@ -73,10 +73,18 @@ namespace clan
 		void detach_depth_stencil() override;
 
 		void set_bind_target(FrameBufferBindTarget target) override;
+		void set_load_action(FrameBufferLoadAction action, int attachments) override;
+		void set_store_action(FrameBufferStoreAction action, int attachments) override;
+		void invalidate_attachments(int attachments) override;
 
 		void check_framebuffer_complete();
 		void bind_framebuffer(bool write_only);
 
+		/// \brief Invalidates attachments of this frame buffer while it is bound for drawing
+		void invalidate_bound(int attachments);
+		void apply_load_actions() { if (load_dont_care) invalidate_bound(load_dont_care); }
+		void apply_store_actions() { if (store_dont_care) invalidate_bound(store_dont_care); }
+
 	private:
 		void on_dispose() override;
 		static std::string get_error_message(int error_code);
@@ -101,6 +109,8 @@ namespace clan
 		RenderBuffer attached_renderbuffers[num_attachment_offsets];
 
 		int count_color_attachments = 0;
+		int load_dont_care = 0;		// FrameBufferAttachmentFlags
+		int store_dont_care = 0;	// FrameBufferAttachmentFlags
 		GLuint handle = 0;
 		FrameBufferBindTarget bind_target = framebuffer_draw;
 
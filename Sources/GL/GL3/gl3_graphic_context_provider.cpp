@@ -34,6 +34,8 @@
 #include "GL/precomp.h"
 #include "gl3_graphic_context_provider.h"
 #include "gl3_occlusion_query_provider.h"
+#include "gl3_timer_query_provider.h"
+#include "gl3_fence_provider.h"
 #include "gl3_texture_provider.h"
 #include "gl3_program_object_provider.h"
 #include "gl3_shader_object_provider.h"
@@ -63,26 +65,14 @@
 #include "API/GL/opengl_wrap.h"
 #include "API/Display/2D/image.h"
 #include "API/GL/opengl_context_description.h"
-#ifdef __APPLE__
-#include "../Platform/OSX/opengl_window_provider_osx.h"
-#elif !defined(WIN32)
-
-#if defined(__ANDROID__)
-#include "../Platform/Android/opengl_window_provider_android.h"
-#else
-#include "../Platform/GLX/opengl_window_provider_glx.h"
-#endif
-#endif
-
-#ifdef WIN32
-#include "../Platform/WGL/opengl_window_provider_wgl.h"
-#endif
+#include <algorithm>
+#include "GL/opengl_display_window_provider.h"
 
 #include <memory>
 
 namespace clan
 {
-	GL3GraphicContextProvider::GL3GraphicContextProvider(const OpenGLWindowProvider * const render_window)
+	GL3GraphicContextProvider::GL3GraphicContextProvider(const OpenGLDisplayWindowProvider * const render_window)
 		: render_window(render_window), framebuffer_bound(false), opengl_version_major(0), shader_version_major(0), scissor_enabled(false)
 	{
 		check_opengl_version();
@@ -150,6 +140,39 @@ namespace clan
 		}
 	}
 
+	void GL3GraphicContextProvider::forget_texture(GLuint handle)
+	{
+		std::unique_ptr<std::unique_lock<std::recursive_mutex>> mutex_section;
+		for (GraphicContextProvider *provider : SharedGCData::get_gc_providers(mutex_section))
+		{
+			GL3GraphicContextProvider *gc_provider = dynamic_cast<GL3GraphicContextProvider *>(provider);
+			if (gc_provider)
+				gc_provider->state_cache.forget_texture(handle);
+		}
+	}
+
+	void GL3GraphicContextProvider::forget_buffer(GLuint handle)
+	{
+		std::unique_ptr<std::unique_lock<std::recursive_mutex>> mutex_section;
+		for (GraphicContextProvider *provider : SharedGCData::get_gc_providers(mutex_section))
+		{
+			GL3GraphicContextProvider *gc_provider = dynamic_cast<GL3GraphicContextProvider *>(provider);
+			if (gc_provider)
+				gc_provider->state_cache.forget_buffer(handle);
+		}
+	}
+
+	void GL3GraphicContextProvider::forget_program(GLuint handle)
+	{
+		std::unique_ptr<std::unique_lock<std::recursive_mutex>> mutex_section;
+		for (GraphicContextProvider *provider : SharedGCData::get_gc_providers(mutex_section))
+		{
+			GL3GraphicContextProvider *gc_provider = dynamic_cast<GL3GraphicContextProvider *>(provider);
+			if (gc_provider)
+				gc_provider->state_cache.forget_program(handle);
+		}
+	}
+
 	ProcAddress *GL3GraphicContextProvider::get_proc_address(const std::string& function_name) const
 	{
 		return render_window->get_proc_address(function_name);
@@ -261,6 +284,16 @@ namespace clan
 		return max_attributes;
 	}
 
+	int GL3GraphicContextProvider::get_uniform_buffer_alignment() const
+	{
+		OpenGL::set_active(this);
+		GLint alignment = 0;
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+		if (alignment < 1)
+			alignment = 256;
+		return alignment;
+	}
+
 	Size GL3GraphicContextProvider::get_max_texture_size() const
 	{
 		OpenGL::set_active(this);
@@ -289,6 +322,16 @@ namespace clan
 		return new GL3OcclusionQueryProvider(this);
 	}
 
+	TimerQueryProvider *GL3GraphicContextProvider::alloc_timer_query()
+	{
+		return new GL3TimerQueryProvider(this);
+	}
+
+	FenceProvider *GL3GraphicContextProvider::alloc_fence()
+	{
+		return new GL3FenceProvider(this);
+	}
+
 	ProgramObjectProvider *GL3GraphicContextProvider::alloc_program_object()
 	{
 		return new GL3ProgramObjectProvider();
@@ -399,7 +442,7 @@ namespace clan
 		if (state)
 		{
 			OpenGLRasterizerStateProvider *gl3_state = static_cast<OpenGLRasterizerStateProvider*>(state);
-			if (gl3_state)
+			if (gl3_state && state_cache.set_rasterizer_state(state))
 			{
 				selected_rasterizer_state.set(gl3_state->desc);
 				OpenGL::set_active(this);
@@ -414,7 +457,7 @@ namespace clan
 		if (state)
 		{
 			OpenGLBlendStateProvider *gl3_state = static_cast<OpenGLBlendStateProvider*>(state);
-			if (gl3_state)
+			if (gl3_state && state_cache.set_blend_state(state, blend_color))
 			{
 				selected_blend_state.set(gl3_state->desc, blend_color);
 				OpenGL::set_active(this);
@@ -428,7 +471,7 @@ namespace clan
 		if (state)
 		{
 			OpenGLDepthStencilStateProvider *gl3_state = static_cast<OpenGLDepthStencilStateProvider*>(state);
-			if (gl3_state)
+			if (gl3_state && state_cache.set_depth_stencil_state(state, stencil_ref))
 			{
 				selected_depth_stencil_state.set(gl3_state->desc);
 				OpenGL::set_active(this);
@@ -463,26 +506,79 @@ namespace clan
 		return pbuf;
 	}
 
+	void GL3GraphicContextProvider::read_pixels(const Rect& rect, PixelBufferProvider *destination)
+	{
+		GL3PixelBufferProvider *pixel_buffer = static_cast<GL3PixelBufferProvider *>(destination);
+		if (pixel_buffer->get_target() != GL_PIXEL_PACK_BUFFER)
+			throw Exception("GraphicContext::read_pixels requires a pixel buffer created with data_from_gpu");
+		if (pixel_buffer->get_size() != rect.get_size())
+			throw Exception("GraphicContext::read_pixels rectangle does not match the pixel buffer size");
+
+		TextureFormat_GL tf = OpenGL::get_textureformat(pixel_buffer->get_format());
+		if (!tf.valid)
+			throw Exception("Unsupported texture format passed to GraphicContext::read_pixels");
+
+		OpenGL::set_active(this);
+		if (!framebuffer_bound)
+		{
+			render_window->is_double_buffered() ? glReadBuffer(GL_BACK) : glReadBuffer(GL_FRONT);
+		}
+
+		Size display_size = get_display_window_size();
+
+		// The copy lands in the pack buffer and is only waited for when the buffer is locked
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, pixel_buffer->get_handle());
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+		glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+		glPixelStorei(GL_PACK_SKIP_PIXELS, 0);
+		glPixelStorei(GL_PACK_SKIP_ROWS, 0);
+		glReadPixels(rect.left, display_size.height - rect.bottom, rect.get_width(), rect.get_height(), tf.pixel_format, tf.pixel_datatype, nullptr);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	}
+
 	void GL3GraphicContextProvider::set_uniform_buffer(int index, const UniformBuffer &buffer)
 	{
+		GLuint handle = static_cast<GL3UniformBufferProvider*>(buffer.get_provider())->get_handle();
+		if (!state_cache.set_uniform_buffer(index, handle))
+			return;
+
+		OpenGL::set_active(this);
+		glBindBufferBase(GL_UNIFORM_BUFFER, index, handle);
+	}
+
+	void GL3GraphicContextProvider::set_uniform_buffer_range(int index, const UniformBuffer &buffer, int offset, int size)
+	{
+		GLuint handle = static_cast<GL3UniformBufferProvider*>(buffer.get_provider())->get_handle();
+		state_cache.set_uniform_buffer_range(index);
+
 		OpenGL::set_active(this);
-		glBindBufferBase(GL_UNIFORM_BUFFER, index, static_cast<GL3UniformBufferProvider*>(buffer.get_provider())->get_handle());
+		glBindBufferRange(GL_UNIFORM_BUFFER, index, handle, offset, size);
 	}
 
 	void GL3GraphicContextProvider::reset_uniform_buffer(int index)
 	{
+		if (!state_cache.set_uniform_buffer(index, 0))
+			return;
+
 		OpenGL::set_active(this);
 		glBindBufferBase(GL_UNIFORM_BUFFER, index, 0);
 	}
 
 	void GL3GraphicContextProvider::set_storage_buffer(int index, const StorageBuffer &buffer)
 	{
+		GLuint handle = static_cast<GL3StorageBufferProvider*>(buffer.get_provider())->get_handle();
+		if (!state_cache.set_storage_buffer(index, handle))
+			return;
+
 		OpenGL::set_active(this);
-		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, index, static_cast<GL3StorageBufferProvider*>(buffer.get_provider())->get_handle());
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, index, handle);
 	}
 
 	void GL3GraphicContextProvider::reset_storage_buffer(int index)
 	{
+		if (!state_cache.set_storage_buffer(index, 0))
+			return;
+
 		OpenGL::set_active(this);
 		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, index, 0);
 	}
@@ -493,7 +589,8 @@ namespace clan
 
 		if (glActiveTexture != nullptr)
 		{
-			glActiveTexture(GL_TEXTURE0 + unit_index);
+			if (state_cache.set_active_texture(unit_index))
+				glActiveTexture(GL_TEXTURE0 + unit_index);
 		}
 		else if (unit_index > 0)
 		{
@@ -503,7 +600,8 @@ namespace clan
 		if (!texture.is_null())
 		{
 			GL3TextureProvider *provider = static_cast<GL3TextureProvider *>(texture.get_provider());
-			glBindTexture(provider->get_texture_type(), provider->get_handle());
+			if (state_cache.set_texture(unit_index, provider->get_texture_type(), provider->get_handle()))
+				glBindTexture(provider->get_texture_type(), provider->get_handle());
 		}
 	}
 
@@ -513,14 +611,16 @@ namespace clan
 
 		if (glActiveTexture != nullptr)
 		{
-			glActiveTexture(GL_TEXTURE0 + unit_index);
+			if (state_cache.set_active_texture(unit_index))
+				glActiveTexture(GL_TEXTURE0 + unit_index);
 		}
 		else if (unit_index > 0)
 		{
 			return;
 		}
 		// Set the texture to the default state
-		glBindTexture(GL_TEXTURE_2D, 0);
+		if (state_cache.set_texture(unit_index, GL_TEXTURE_2D, 0))
+			glBindTexture(GL_TEXTURE_2D, 0);
 	}
 
 	void GL3GraphicContextProvider::set_image_texture(int unit_index, const Texture &texture)
@@ -560,9 +660,19 @@ namespace clan
 
 		OpenGL::set_active(this);
 
-		draw_buffer_provider->bind_framebuffer(true);
-		if (draw_buffer_provider != read_buffer_provider)		// You cannot read and write to the same framebuffer
-			read_buffer_provider->bind_framebuffer(false);
+		if (state_cache.set_frame_buffers(draw_buffer_provider->get_handle(), read_buffer_provider->get_handle()))
+		{
+			if (draw_frame_buffer && draw_frame_buffer != draw_buffer_provider)
+				draw_frame_buffer->apply_store_actions();
+
+			draw_buffer_provider->bind_framebuffer(true);
+			if (draw_buffer_provider != read_buffer_provider)		// You cannot read and write to the same framebuffer
+				read_buffer_provider->bind_framebuffer(false);
+
+			if (draw_frame_buffer != draw_buffer_provider)
+				draw_buffer_provider->apply_load_actions();
+			draw_frame_buffer = draw_buffer_provider;
+		}
 
 		// Check for framebuffer completeness
 		draw_buffer_provider->check_framebuffer_complete();
@@ -572,15 +682,35 @@ namespace clan
 		framebuffer_bound = true;
 	}
 
+	void GL3GraphicContextProvider::forget_frame_buffer(GL3FrameBufferProvider *frame_buffer)
+	{
+		if (draw_frame_buffer == frame_buffer)
+			draw_frame_buffer = nullptr;
+	}
+
 	void GL3GraphicContextProvider::reset_frame_buffer()
 	{
+		framebuffer_bound = false;
+		if (!state_cache.set_frame_buffers(0, 0))
+			return;
+
 		OpenGL::set_active(this);
 
-		// To do: move this to OpenGLWindowProvider abstraction (some targets doesn't have a default frame buffer)
+		if (draw_frame_buffer)
+		{
+			draw_frame_buffer->apply_store_actions();
+			draw_frame_buffer = nullptr;
+		}
+
 		glBindFramebuffer(GL_FRAMEBUFFER, 0);
 		glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
 
-		if (render_window->is_double_buffered())
+		if (!render_window->has_default_frame_buffer())
+		{
+			glDrawBuffer(GL_NONE);
+			glReadBuffer(GL_NONE);
+		}
+		else if (render_window->is_double_buffered())
 		{
 			glDrawBuffer(GL_BACK);
 			glReadBuffer(GL_BACK);
@@ -591,8 +721,6 @@ namespace clan
 			glReadBuffer(GL_FRONT);
 		}
 
-		framebuffer_bound = false;
-
 	}
 
 	void GL3GraphicContextProvider::set_program_object(StandardProgram standard_program)
@@ -606,16 +734,16 @@ namespace clan
 		if (glUseProgram == nullptr)
 			return;
 
-		if (program.is_null())
-			glUseProgram(0);
-		else
-		{
-			glUseProgram(program.get_handle());
-		}
+		GLuint handle = program.is_null() ? 0 : program.get_handle();
+		if (state_cache.set_program(handle))
+			glUseProgram(handle);
 	}
 
 	void GL3GraphicContextProvider::reset_program_object()
 	{
+		if (!state_cache.set_program(0))
+			return;
+
 		OpenGL::set_active(this);
 		glUseProgram(0);
 	}
@@ -640,6 +768,9 @@ namespace clan
 	{
 		GL3PrimitivesArrayProvider *prim_array = static_cast<GL3PrimitivesArrayProvider *>(primitives_array.get_provider());
 
+		if (!state_cache.set_vertex_array(prim_array->handle))
+			return;
+
 		OpenGL::set_active(this);
 		glBindVertexArray(prim_array->handle);
 	}
@@ -656,6 +787,24 @@ namespace clan
 		glDrawArraysInstanced(OpenGL::to_enum(type), offset, num_vertices, instance_count);
 	}
 
+	void GL3GraphicContextProvider::draw_primitives_array_indirect(PrimitivesType type, const StorageBuffer &commands, size_t offset, int draw_count, int stride)
+	{
+		OpenGL::set_active(this);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, static_cast<GL3StorageBufferProvider*>(commands.get_provider())->get_handle());
+		if (glMultiDrawArraysIndirect)
+		{
+			glMultiDrawArraysIndirect(OpenGL::to_enum(type), (const GLvoid*)offset, draw_count, stride);
+		}
+		else
+		{
+			if (stride == 0)
+				stride = sizeof(DrawArraysIndirectCommand);
+			for (int i = 0; i < draw_count; i++)
+				glDrawArraysIndirect(OpenGL::to_enum(type), (const GLvoid*)(offset + i * stride));
+		}
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	}
+
 	void GL3GraphicContextProvider::set_primitives_elements(ElementArrayBufferProvider *array_provider)
 	{
 		OpenGL::set_active(this);
@@ -674,6 +823,24 @@ namespace clan
 		glDrawElementsInstanced(OpenGL::to_enum(type), count, OpenGL::to_enum(indices_type), (const GLvoid*)offset, instance_count);
 	}
 
+	void GL3GraphicContextProvider::draw_primitives_elements_indirect(PrimitivesType type, VertexAttributeDataType indices_type, const StorageBuffer &commands, size_t offset, int draw_count, int stride)
+	{
+		OpenGL::set_active(this);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, static_cast<GL3StorageBufferProvider*>(commands.get_provider())->get_handle());
+		if (glMultiDrawElementsIndirect)
+		{
+			glMultiDrawElementsIndirect(OpenGL::to_enum(type), OpenGL::to_enum(indices_type), (const GLvoid*)offset, draw_count, stride);
+		}
+		else
+		{
+			if (stride == 0)
+				stride = sizeof(DrawElementsIndirectCommand);
+			for (int i = 0; i < draw_count; i++)
+				glDrawElementsIndirect(OpenGL::to_enum(type), OpenGL::to_enum(indices_type), (const GLvoid*)(offset + i * stride));
+		}
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	}
+
 	void GL3GraphicContextProvider::reset_primitives_elements()
 	{
 		OpenGL::set_active(this);
@@ -709,6 +876,9 @@ namespace clan
 
 	void GL3GraphicContextProvider::reset_primitives_array()
 	{
+		if (!state_cache.set_vertex_array(0))
+			return;
+
 		OpenGL::set_active(this);
 		glBindVertexArray(0);
 	}
@@ -734,12 +904,112 @@ namespace clan
 		glDisable(GL_SCISSOR_TEST);
 	}
 
+	bool GL3GraphicContextProvider::has_compute_shader_support() const
+	{
+		// Compute shaders, storage buffers and image load/store are all core in OpenGL 4.3
+		int version_major = 0;
+		int version_minor = 0;
+		get_opengl_version(version_major, version_minor);
+		return version_major > 4 || (version_major == 4 && version_minor >= 3);
+	}
+
+	bool GL3GraphicContextProvider::is_compressed_format_supported(TextureFormat format) const
+	{
+		if (format < tf_compressed_red_rgtc1)
+			return false;
+
+		TextureFormat_GL gl_format = OpenGL::get_textureformat(format);
+		if (!gl_format.valid)
+			return false;
+
+		// Formats that are core in the running version are not always listed by the driver
+		int version_major = 0;
+		int version_minor = 0;
+		get_opengl_version(version_major, version_minor);
+		int version = version_major * 10 + version_minor;
+		if (format <= tf_compressed_signed_rg_rgtc2 && version >= 30)
+			return true;
+		if ((format == tf_compressed_rgba_bptc_unorm || format == tf_compressed_srgb_alpha_bptc_unorm) && version >= 42)
+			return true;
+		if (format >= tf_compressed_rgb8_etc2 && format <= tf_compressed_srgb8_alpha8_etc2_eac && version >= 43)
+			return true;
+
+		OpenGL::set_active(this);
+		GLint count = 0;
+		glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &count);
+		if (count <= 0)
+			return false;
+		std::vector<GLint> formats(count);
+		glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, formats.data());
+		return std::find(formats.begin(), formats.end(), (GLint)gl_format.internal_format) != formats.end();
+	}
+
 	void GL3GraphicContextProvider::dispatch(int x, int y, int z)
+	{
+		OpenGL::set_active(this);
+		glDispatchCompute(x, y, z);
+
+		// Make the results visible to the commands that follow, like Direct3D does
+		glMemoryBarrier(GL_ALL_BARRIER_BITS);
+	}
+
+	void GL3GraphicContextProvider::dispatch_no_barrier(int x, int y, int z)
 	{
 		OpenGL::set_active(this);
 		glDispatchCompute(x, y, z);
 	}
 
+	void GL3GraphicContextProvider::memory_barrier(int barrier_flags)
+	{
+		if (barrier_flags == 0)
+			return;
+
+		GLbitfield barriers = 0;
+		if (barrier_flags == barrier_all)
+		{
+			barriers = GL_ALL_BARRIER_BITS;
+		}
+		else
+		{
+			if (barrier_flags & barrier_vertex_attrib) barriers |= GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT;
+			if (barrier_flags & barrier_element_array) barriers |= GL_ELEMENT_ARRAY_BARRIER_BIT;
+			if (barrier_flags & barrier_uniform) barriers |= GL_UNIFORM_BARRIER_BIT;
+			if (barrier_flags & barrier_texture_fetch) barriers |= GL_TEXTURE_FETCH_BARRIER_BIT;
+			if (barrier_flags & barrier_image_access) barriers |= GL_SHADER_IMAGE_ACCESS_BARRIER_BIT;
+			if (barrier_flags & barrier_indirect_command) barriers |= GL_COMMAND_BARRIER_BIT;
+			if (barrier_flags & barrier_pixel_buffer) barriers |= GL_PIXEL_BUFFER_BARRIER_BIT;
+			if (barrier_flags & barrier_texture_update) barriers |= GL_TEXTURE_UPDATE_BARRIER_BIT;
+			if (barrier_flags & barrier_buffer_update) barriers |= GL_BUFFER_UPDATE_BARRIER_BIT;
+			if (barrier_flags & barrier_frame_buffer) barriers |= GL_FRAMEBUFFER_BARRIER_BIT;
+			if (barrier_flags & barrier_storage_buffer) barriers |= GL_SHADER_STORAGE_BARRIER_BIT;
+		}
+
+		OpenGL::set_active(this);
+		glMemoryBarrier(barriers);
+	}
+
+	void GL3GraphicContextProvider::invalidate_attachments(int attachments)
+	{
+		OpenGL::set_active(this);
+		if (framebuffer_bound)
+		{
+			if (draw_frame_buffer)
+				draw_frame_buffer->invalidate_bound(attachments);
+			return;
+		}
+
+		if (glInvalidateFramebuffer == nullptr || !render_window->has_default_frame_buffer())
+			return;
+
+		GLenum buffers[3];
+		GLsizei count = 0;
+		if (attachments & attachment_color) buffers[count++] = GL_COLOR;
+		if (attachments & attachment_depth) buffers[count++] = GL_DEPTH;
+		if (attachments & attachment_stencil) buffers[count++] = GL_STENCIL;
+		if (count > 0)
+			glInvalidateFramebuffer(GL_DRAW_FRAMEBUFFER, count, buffers);
+	}
+
 	void GL3GraphicContextProvider::clear(const Colorf &color)
 	{
 		OpenGL::set_active(this);
@@ -826,6 +1096,9 @@ namespace clan
 		if (glDrawBuffer)
 			glDrawBuffer(OpenGL::to_enum(buffer));
 
+		// Binding a frame buffer also selects its draw buffer, so the next bind must not be skipped
+		state_cache.invalidate_frame_buffers();
+
 	}
 
 	void GL3GraphicContextProvider::make_current() const
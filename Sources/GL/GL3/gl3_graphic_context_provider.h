@@ -41,6 +41,7 @@
 #include "API/Display/Render/depth_stencil_state_description.h"
 #include "API/Core/System/disposable_object.h"
 #include "gl3_standard_programs.h"
+#include "gl3_state_cache.h"
 #include "GL/opengl_graphic_context_provider.h"
 #include "../State/opengl_blend_state.h"
 #include "../State/opengl_rasterizer_state.h"
@@ -56,16 +57,17 @@ namespace clan
 	class GL3FrameBufferProvider;
 	class DisposableObject;
 	class OpenGLContextDescription;
-	class OpenGLWindowProvider;
+	class OpenGLDisplayWindowProvider;
 
 	class GL3GraphicContextProvider : public OpenGLGraphicContextProvider, public GraphicContextProvider, public DisposableObject
 	{
 	public:
 		/// \brief Creates a new OpenGL graphic context provider for a rendering window.
-		GL3GraphicContextProvider(const OpenGLWindowProvider * const render_window);
+		GL3GraphicContextProvider(const OpenGLDisplayWindowProvider * const render_window);
 		~GL3GraphicContextProvider();
 
 		int get_max_attributes() override;
+		int get_uniform_buffer_alignment() const override;
 		Size get_max_texture_size() const override;
 
 		/// \brief Get the opengl version major number
@@ -96,9 +98,12 @@ namespace clan
 		ShaderLanguage get_shader_language() const override { return shader_glsl; }
 		int get_major_version() const override { int major = 0, minor = 0; get_opengl_version(major, minor); return major; }
 		int get_minor_version() const override { int major = 0, minor = 0; get_opengl_version(major, minor); return minor; }
-		bool has_compute_shader_support() const override { return false; }
+		bool has_compute_shader_support() const override;
+		bool is_compressed_format_supported(TextureFormat format) const override;
 		TextureProvider *alloc_texture(TextureDimensions texture_dimensions) override;
 		OcclusionQueryProvider *alloc_occlusion_query() override;
+		TimerQueryProvider *alloc_timer_query() override;
+		FenceProvider *alloc_fence() override;
 		ProgramObjectProvider *alloc_program_object() override;
 		ShaderObjectProvider *alloc_shader_object() override;
 		FrameBufferProvider *alloc_frame_buffer() override;
@@ -117,7 +122,9 @@ namespace clan
 		void set_blend_state(BlendStateProvider *state, const Colorf &blend_color, unsigned int sample_mask) override;
 		void set_depth_stencil_state(DepthStencilStateProvider *state, int stencil_ref) override;
 		PixelBuffer get_pixeldata(const Rect& rect, TextureFormat texture_format, bool clamp) const override;
+		void read_pixels(const Rect& rect, PixelBufferProvider *destination) override;
 		void set_uniform_buffer(int index, const UniformBuffer &buffer) override;
+		void set_uniform_buffer_range(int index, const UniformBuffer &buffer, int offset, int size) override;
 		void reset_uniform_buffer(int index) override;
 		void set_storage_buffer(int index, const StorageBuffer &buffer) override;
 		void reset_storage_buffer(int index) override;
@@ -139,9 +146,11 @@ namespace clan
 		void set_primitives_array(const PrimitivesArray &primitives_array) override;
 		void draw_primitives_array(PrimitivesType type, int offset, int num_vertices) override;
 		void draw_primitives_array_instanced(PrimitivesType type, int offset, int num_vertices, int instance_count) override;
+		void draw_primitives_array_indirect(PrimitivesType type, const StorageBuffer &commands, size_t offset, int draw_count, int stride) override;
 		void set_primitives_elements(ElementArrayBufferProvider *array_provider) override;
 		void draw_primitives_elements(PrimitivesType type, int count, VertexAttributeDataType indices_type, size_t offset = 0) override;
 		void draw_primitives_elements_instanced(PrimitivesType type, int count, VertexAttributeDataType indices_type, size_t offset, int instance_count) override;
+		void draw_primitives_elements_indirect(PrimitivesType type, VertexAttributeDataType indices_type, const StorageBuffer &commands, size_t offset, int draw_count, int stride) override;
 		void reset_primitives_elements() override;
 		void draw_primitives_elements(PrimitivesType type, int count, ElementArrayBufferProvider *array_provider, VertexAttributeDataType indices_type, void *offset) override;
 		void draw_primitives_elements_instanced(PrimitivesType type, int count, ElementArrayBufferProvider *array_provider, VertexAttributeDataType indices_type, void *offset, int instance_count) override;
@@ -149,6 +158,9 @@ namespace clan
 		void set_scissor(const Rect &rect) override;
 		void reset_scissor() override;
 		void dispatch(int x, int y, int z) override;
+		void dispatch_no_barrier(int x, int y, int z) override;
+		void memory_barrier(int barrier_flags) override;
+		void invalidate_attachments(int attachments) override;
 		void clear(const Colorf &color) override;
 		void clear_depth(float value) override;
 		void clear_stencil(int value) override;
@@ -168,6 +180,16 @@ namespace clan
 
 		void flush() override;
 
+		GL3StateCache &get_state_cache() { return state_cache; }
+
+		/// \brief Called by a frame buffer being disposed so it is no longer considered bound
+		void forget_frame_buffer(GL3FrameBufferProvider *frame_buffer);
+
+		/// \brief Removes a deleted shared object from the state cache of every GL3 graphic context
+		static void forget_texture(GLuint handle);
+		static void forget_buffer(GLuint handle);
+		static void forget_program(GLuint handle);
+
 	private:
 		void on_dispose() override;
 		void create_standard_programs();
@@ -176,9 +198,10 @@ namespace clan
 		void calculate_shading_language_version();
 
 		/// \brief OpenGL render window.
-		const OpenGLWindowProvider * const render_window;
+		const OpenGLDisplayWindowProvider * const render_window;
 
 		bool framebuffer_bound;
+		GL3FrameBufferProvider *draw_frame_buffer = nullptr;
 
 		mutable int opengl_version_major;
 		mutable int opengl_version_minor;
@@ -201,5 +224,7 @@ namespace clan
 		OpenGLDepthStencilState selected_depth_stencil_state;
 
 		GL3StandardPrograms standard_programs;
+
+		GL3StateCache state_cache;
 	};
 }
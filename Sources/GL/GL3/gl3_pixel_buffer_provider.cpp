@@ -36,6 +36,7 @@
 namespace clan
 {
 	GL3PixelBufferProvider::GL3PixelBufferProvider()
+		: buffer(gpu_memory_pixel_buffer)
 	{
 	}
 
@@ -59,10 +60,20 @@ namespace clan
 			selected_target = GL_PIXEL_UNPACK_BUFFER;
 		}
 
-		int total_size = PixelBuffer::get_bytes_per_pixel(new_format);
-		bytes_per_pixel = total_size;
-		pitch = bytes_per_pixel * size.width;
-		total_size = pitch * size.height;
+		int total_size;
+		if (PixelBuffer::is_compressed(new_format))
+		{
+			// Compressed formats are stored as rows of 4x4 blocks
+			bytes_per_pixel = 0;
+			pitch = (size.width + 3) / 4 * PixelBuffer::get_bytes_per_block(new_format);
+			total_size = pitch * ((size.height + 3) / 4);
+		}
+		else
+		{
+			bytes_per_pixel = PixelBuffer::get_bytes_per_pixel(new_format);
+			pitch = bytes_per_pixel * size.width;
+			total_size = pitch * size.height;
+		}
 
 		buffer.create(data, total_size, usage, selected_binding, selected_target);
 	}
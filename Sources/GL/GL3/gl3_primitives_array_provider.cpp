@@ -54,7 +54,8 @@ namespace clan
 		glBindBuffer(GL_ARRAY_BUFFER, static_cast<GL3VertexArrayBufferProvider *>(attribute.array_provider)->get_handle());
 		glEnableVertexAttribArray(attrib_index);
 
-		if (attribute.type == type_float)
+		// Normalized integer data is read as floating point by the shader
+		if (attribute.type == type_float || normalize)
 		{
 			glVertexAttribPointer(attrib_index, attribute.size, OpenGL::to_enum(attribute.type),
 				normalize ? GL_TRUE : GL_FALSE, attribute.stride, (GLvoid *)attribute.offset);
@@ -72,6 +73,7 @@ namespace clan
 		{
 			OpenGL::set_active(gc_provider);
 			glDeleteVertexArrays(1, &handle);
+			gc_provider->get_state_cache().forget_vertex_array(handle);
 		}
 		gc_provider->remove_disposable(this);
 	}
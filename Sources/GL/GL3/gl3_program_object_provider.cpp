@@ -37,11 +37,15 @@
 #include "API/Display/Render/shared_gc_data.h"
 #include "gl3_graphic_context_provider.h"
 #include "gl3_uniform_buffer_provider.h"
+#include "gl3_shader_object_provider.h"
+#include "API/Display/Render/program_binary_cache.h"
+#include "API/Core/System/databuffer.h"
+#include <cstring>
 
 namespace clan
 {
 	GL3ProgramObjectProvider::GL3ProgramObjectProvider()
-		: handle(0)
+		: handle(0), locations_fetched(false)
 	{
 		SharedGCData::add_disposable(this);
 		OpenGL::set_active();
@@ -61,6 +65,7 @@ namespace clan
 			if (OpenGL::set_active())
 			{
 				glDeleteProgram(handle);
+				GL3GraphicContextProvider::forget_program(handle);
 			}
 		}
 	}
@@ -119,6 +124,17 @@ namespace clan
 	int GL3ProgramObjectProvider::get_uniform_location(const std::string &name) const
 	{
 		throw_if_disposed();
+		if (locations_fetched)
+		{
+			auto it = active_uniforms.find(name);
+			if (it != active_uniforms.end())
+				return it->second;
+
+			// Only the first element of an array is in the table
+			if (name.find('[') == std::string::npos)
+				return -1;
+		}
+
 		OpenGL::set_active();
 		return glGetUniformLocation(handle, StringHelp::text_to_local8(name).c_str());
 	}
@@ -126,6 +142,12 @@ namespace clan
 	int GL3ProgramObjectProvider::get_attribute_location(const std::string &name) const
 	{
 		throw_if_disposed();
+		if (locations_fetched)
+		{
+			auto it = active_attributes.find(name);
+			return it != active_attributes.end() ? it->second : -1;
+		}
+
 		OpenGL::set_active();
 		return glGetAttribLocation(handle, StringHelp::text_to_local8(name).c_str());
 	}
@@ -194,6 +216,7 @@ namespace clan
 		throw_if_disposed();
 		OpenGL::set_active();
 		glBindAttribLocation(handle, index, StringHelp::text_to_local8(name).c_str());
+		attribute_locations.push_back(std::make_pair(index, name));
 	}
 
 	void GL3ProgramObjectProvider::bind_frag_data_location(int color_number, const std::string &name)
@@ -201,13 +224,171 @@ namespace clan
 		throw_if_disposed();
 		OpenGL::set_active();
 		glBindFragDataLocation(handle, color_number, StringHelp::text_to_local8(name).c_str());
+		frag_data_locations.push_back(std::make_pair(color_number, name));
 	}
 
 	void GL3ProgramObjectProvider::link()
 	{
 		throw_if_disposed();
 		OpenGL::set_active();
+
+		std::string cache_key = get_program_cache_key();
+		if (!cache_key.empty() && load_program_binary(cache_key))
+		{
+			fetch_locations();
+			return;
+		}
+
+		// Shaders known to compile skip compilation until it is clear the program binary cannot be used
+		for (auto &shader : shaders)
+			static_cast<GL3ShaderObjectProvider *>(shader.get_provider())->compile_if_deferred();
+
+		if (!cache_key.empty())
+			glProgramParameteri(handle, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
 		glLinkProgram(handle);
+
+		if (!cache_key.empty() && get_link_status())
+			save_program_binary(cache_key);
+
+		fetch_locations();
+	}
+
+	void GL3ProgramObjectProvider::fetch_locations()
+	{
+		locations_fetched = false;
+		active_uniforms.clear();
+		active_attributes.clear();
+
+		if (!get_link_status())
+			return;
+
+		GLint count = 0;
+		GLint max_length = 0;
+		glGetProgramiv(handle, GL_ACTIVE_UNIFORMS, &count);
+		glGetProgramiv(handle, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length);
+		std::vector<GLchar> name_buffer(max_length + 1);
+		for (GLint index = 0; index < count; index++)
+		{
+			GLsizei length = 0;
+			GLint size = 0;
+			GLenum type = 0;
+			glGetActiveUniform(handle, index, name_buffer.size(), &length, &size, &type, name_buffer.data());
+			std::string name(name_buffer.data(), length);
+
+			// Uniforms inside uniform blocks have no location
+			GLint location = glGetUniformLocation(handle, name.c_str());
+			if (location < 0)
+				continue;
+
+			active_uniforms[StringHelp::local8_to_text(name)] = location;
+
+			// Arrays are reported as "name[0]" but are usually looked up as "name"
+			if (name.length() > 3 && name.compare(name.length() - 3, 3, "[0]") == 0)
+				active_uniforms[StringHelp::local8_to_text(name.substr(0, name.length() - 3))] = location;
+		}
+
+		count = 0;
+		max_length = 0;
+		glGetProgramiv(handle, GL_ACTIVE_ATTRIBUTES, &count);
+		glGetProgramiv(handle, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &max_length);
+		name_buffer.resize(max_length + 1);
+		for (GLint index = 0; index < count; index++)
+		{
+			GLsizei length = 0;
+			GLint size = 0;
+			GLenum type = 0;
+			glGetActiveAttrib(handle, index, name_buffer.size(), &length, &size, &type, name_buffer.data());
+			std::string name(name_buffer.data(), length);
+			active_attributes[StringHelp::local8_to_text(name)] = glGetAttribLocation(handle, name.c_str());
+		}
+
+		locations_fetched = true;
+	}
+
+	std::string GL3ProgramObjectProvider::get_binary_cache_key(const std::string &text)
+	{
+		if (!ProgramBinaryCache::is_enabled())
+			return std::string();
+
+		OpenGL::set_active();
+		if (!glProgramBinary || !glGetProgramBinary || !glProgramParameteri)
+			return std::string();
+
+		GLint num_formats = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &num_formats);
+		if (num_formats <= 0)
+			return std::string();
+
+		// Binaries are only valid for the driver that created them
+		std::string driver;
+		const GLenum driver_strings[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+		for (GLenum name : driver_strings)
+		{
+			const GLubyte *value = glGetString(name);
+			if (value)
+				driver += reinterpret_cast<const char *>(value);
+			driver += "\n";
+		}
+
+		return ProgramBinaryCache::get_key(driver + text);
+	}
+
+	std::string GL3ProgramObjectProvider::get_program_cache_key() const
+	{
+		if (shaders.empty())
+			return std::string();
+
+		std::string text = "program\n";
+		for (const auto &shader : shaders)
+		{
+			const std::string &shader_key = static_cast<GL3ShaderObjectProvider *>(shader.get_provider())->get_cache_key();
+			if (shader_key.empty())
+				return std::string();
+			text += shader_key + "\n";
+		}
+		for (const auto &location : attribute_locations)
+			text += string_format("attribute %1 %2\n", location.first, location.second);
+		for (const auto &location : frag_data_locations)
+			text += string_format("frag_data %1 %2\n", location.first, location.second);
+
+		return get_binary_cache_key(text);
+	}
+
+	bool GL3ProgramObjectProvider::load_program_binary(const std::string &cache_key)
+	{
+		DataBuffer data = ProgramBinaryCache::load(cache_key);
+		if (data.get_size() <= sizeof(GLenum))
+			return false;
+
+		GLenum binary_format = 0;
+		memcpy(&binary_format, data.get_data(), sizeof(GLenum));
+		glProgramBinary(handle, binary_format, data.get_data() + sizeof(GLenum), data.get_size() - sizeof(GLenum));
+		if (get_link_status())
+			return true;
+
+		// The driver rejected the binary, usually because it was updated
+		ProgramBinaryCache::remove(cache_key);
+		return false;
+	}
+
+	void GL3ProgramObjectProvider::save_program_binary(const std::string &cache_key)
+	{
+		GLint length = 0;
+		glGetProgramiv(handle, GL_PROGRAM_BINARY_LENGTH, &length);
+		if (length <= 0)
+			return;
+
+		DataBuffer data(sizeof(GLenum) + length);
+		GLenum binary_format = 0;
+		GLsizei written = 0;
+		glGetProgramBinary(handle, length, &written, &binary_format, data.get_data() + sizeof(GLenum));
+		if (written <= 0)
+			return;
+
+		memcpy(data.get_data(), &binary_format, sizeof(GLenum));
+		data.set_size(sizeof(GLenum) + written);
+		ProgramBinaryCache::save(cache_key, data);
 	}
 
 	void GL3ProgramObjectProvider::validate()
@@ -34,6 +34,7 @@
 #include "API/GL/opengl.h"
 #include "API/Display/TargetProviders/program_object_provider.h"
 #include "API/Core/System/disposable_object.h"
+#include <unordered_map>
 
 namespace clan
 {
@@ -110,11 +111,26 @@ namespace clan
 		void set_uniform_buffer_index(int block_index, int bind_index) override;
 		void set_storage_buffer_index(int buffer_index, int bind_unit_index) override;
 
+		/// \brief Returns the ProgramBinaryCache key for the text on the active driver, or an empty string if binaries cannot be cached
+		static std::string get_binary_cache_key(const std::string &text);
+
 	private:
 		void on_dispose() override;
 
+		void fetch_locations();
+		std::string get_program_cache_key() const;
+		bool load_program_binary(const std::string &cache_key);
+		void save_program_binary(const std::string &cache_key);
+
 		GLuint handle;
 		std::vector<ShaderObject> shaders;
+		std::vector<std::pair<int, std::string> > attribute_locations;
+		std::vector<std::pair<int, std::string> > frag_data_locations;
+
+		// Locations of the active uniforms and attributes, introspected when the program is linked
+		bool locations_fetched;
+		std::unordered_map<std::string, int> active_uniforms;
+		std::unordered_map<std::string, int> active_attributes;
 	};
 
 	class ProgramObjectStateTracker
@@ -77,6 +77,7 @@ namespace clan
 		glGenRenderbuffers(1, &handle);
 		glBindRenderbuffer(GL_RENDERBUFFER, handle);
 		glRenderbufferStorageMultisample(GL_RENDERBUFFER, multisample_samples, tf.pixel_format, width, height);
+		memory.set_size(GPUMemoryTracker::get_texture_size(texture_format, width, height, 1, 1, 1, max(multisample_samples, 1)));
 
 		glBindRenderbuffer(GL_RENDERBUFFER, last_render_buffer);
 	}
@@ -33,6 +33,7 @@
 #include "gl3_graphic_context_provider.h"
 #include "API/Display/TargetProviders/render_buffer_provider.h"
 #include "API/Core/System/disposable_object.h"
+#include "API/Display/Render/gpu_memory.h"
 
 namespace clan
 {
@@ -51,5 +52,7 @@ namespace clan
 		void on_dispose() override;
 
 		GLuint handle;
+
+		GPUMemoryAllocation memory{gpu_memory_render_buffer};
 	};
 }
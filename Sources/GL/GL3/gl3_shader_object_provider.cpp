@@ -31,6 +31,9 @@
 #include "GL/precomp.h"
 #include "gl3_shader_object_provider.h"
 #include "gl3_graphic_context_provider.h"
+#include "gl3_program_object_provider.h"
+#include "API/Display/Render/program_binary_cache.h"
+#include "API/Core/System/databuffer.h"
 #include "API/Core/System/exception.h"
 #include "API/Core/Text/string_help.h"
 #include "API/Core/Text/string_format.h"
@@ -39,7 +42,7 @@
 namespace clan
 {
 	GL3ShaderObjectProvider::GL3ShaderObjectProvider()
-		: handle(0)
+		: handle(0), compile_deferred(false)
 	{
 		SharedGCData::add_disposable(this);
 	}
@@ -67,6 +70,8 @@ namespace clan
 		source_lengths[0] = source.length();
 		sources[0] = source8.c_str();
 		glShaderSource(handle, 1, sources, source_lengths);
+
+		set_cache_key(source8);
 	}
 
 	void GL3ShaderObjectProvider::create(
@@ -100,6 +105,11 @@ namespace clan
 			delete[] array_sources;
 			throw;
 		}
+
+		std::string joined_sources;
+		for (const auto &source : sources)
+			joined_sources += source;
+		set_cache_key(joined_sources);
 	}
 
 	GL3ShaderObjectProvider::~GL3ShaderObjectProvider()
@@ -126,6 +136,9 @@ namespace clan
 
 	bool GL3ShaderObjectProvider::get_compile_status() const
 	{
+		if (compile_deferred)
+			return true;
+
 		OpenGL::set_active();
 		GLint status = 0;
 		glGetShaderiv(handle, GL_COMPILE_STATUS, &status);
@@ -139,6 +152,9 @@ namespace clan
 
 	std::string GL3ShaderObjectProvider::get_info_log() const
 	{
+		if (compile_deferred)
+			return std::string();
+
 		OpenGL::set_active();
 		std::string result;
 		GLsizei buffer_size = 16 * 1024;
@@ -179,8 +195,36 @@ namespace clan
 
 	void GL3ShaderObjectProvider::compile()
 	{
+		// The program binary cache only needs the source if the program binary cannot be used
+		if (!cache_key.empty() && ProgramBinaryCache::contains(cache_key))
+		{
+			compile_deferred = true;
+			return;
+		}
+
+		compile_deferred = false;
 		OpenGL::set_active();
 		glCompileShader(handle);
+
+		// An entry for a shader records that its source compiles on this driver
+		if (!cache_key.empty() && get_compile_status())
+			ProgramBinaryCache::save(cache_key, DataBuffer(1));
+	}
+
+	void GL3ShaderObjectProvider::compile_if_deferred()
+	{
+		if (compile_deferred)
+		{
+			compile_deferred = false;
+			OpenGL::set_active();
+			glCompileShader(handle);
+		}
+	}
+
+	void GL3ShaderObjectProvider::set_cache_key(const std::string &source)
+	{
+		compile_deferred = false;
+		cache_key = GL3ProgramObjectProvider::get_binary_cache_key(string_format("shader %1\n", (int)type) + source);
 	}
 
 	GLenum GL3ShaderObjectProvider::shadertype_to_opengl(ShaderType type)
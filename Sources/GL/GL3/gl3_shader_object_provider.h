@@ -69,11 +69,20 @@ namespace clan
 			get_info_log() will return the compile log.</p>*/
 		void compile() override;
 
+		/// \brief Compiles the shader if compile() skipped it because the source is known to compile
+		void compile_if_deferred();
+
+		/// \brief Returns the ProgramBinaryCache key for the source, or an empty string if the cache is disabled
+		const std::string &get_cache_key() const { return cache_key; }
+
 	private:
 		void on_dispose() override;
 		GLenum shadertype_to_opengl(ShaderType type);
+		void set_cache_key(const std::string &source);
 
 		GLuint handle;
 		ShaderType type;
+		std::string cache_key;
+		bool compile_deferred;
 	};
 }
@@ -34,6 +34,9 @@
 #include "gl3_render_buffer_provider.h"
 #include "gl3_vertex_array_buffer_provider.h"
 #include "Display/2D/render_batch_triangle.h"
+#include "Display/2D/render_batch_sprite_instanced.h"
+#include "Display/2D/render_batch_box.h"
+#include "Display/2D/path_fill_renderer.h"
 
 namespace clan
 {
@@ -111,6 +114,30 @@ namespace clan
 		"flat out int TexIndex; "
 		"void main() { gl_Position = Position; Color = Color0; TexCoord = TexCoord0; TexIndex = TexIndex0; }";
 
+	const std::string::value_type *cl_glsl15_vertex_sprite_static =
+		"#version 150\n"
+		"uniform mat4 Transform; "
+		"uniform vec4 ColorModulate; "
+		"in vec4 Position, Color0; "
+		"in vec2 TexCoord0; "
+		"in int TexIndex0; "
+		"out vec4 Color; "
+		"out vec2 TexCoord; "
+		"flat out int TexIndex; "
+		"void main() { gl_Position = Transform*Position; Color = Color0*ColorModulate; TexCoord = TexCoord0; TexIndex = TexIndex0; }";
+
+	const std::string::value_type *cl_glsl_vertex_sprite_static =
+		"#version 130\n"
+		"uniform mat4 Transform; "
+		"uniform vec4 ColorModulate; "
+		"in vec4 Position, Color0; "
+		"in vec2 TexCoord0; "
+		"in int TexIndex0; "
+		"out vec4 Color; "
+		"out vec2 TexCoord; "
+		"flat out int TexIndex; "
+		"void main() { gl_Position = Transform*Position; Color = Color0*ColorModulate; TexCoord = TexCoord0; TexIndex = TexIndex0; }";
+
 	const std::string::value_type *cl_glsl15_fragment_sprite =
 		"#version 150\n"
 		"uniform sampler2D Texture0; "
@@ -204,6 +231,295 @@ namespace clan
 		"} "
 		"void main() { gl_FragColor = Color*sampleTexture(TexIndex, TexCoord); } ";
 
+	const std::string::value_type *cl_glsl15_vertex_sprite_instanced = R"shaderend(
+			#version 150
+			uniform sampler2D InstanceData;
+			out vec4 Color;
+			out vec2 TexCoord;
+			flat out int TexIndex;
+
+			void main()
+			{
+				const int instance_width = 1024;
+				const vec2 corners[6] = vec2[6](vec2(0.0, 0.0), vec2(1.0, 0.0), vec2(0.0, 1.0), vec2(1.0, 0.0), vec2(1.0, 1.0), vec2(0.0, 1.0));
+
+				int texel = gl_InstanceID * 4;
+				ivec2 pos = ivec2(texel % instance_width, texel / instance_width);
+				vec4 position = texelFetch(InstanceData, pos, 0);
+				vec4 axes = texelFetch(InstanceData, pos + ivec2(1, 0), 0);
+				vec4 texcoords = texelFetch(InstanceData, pos + ivec2(2, 0), 0);
+				Color = texelFetch(InstanceData, pos + ivec2(3, 0), 0);
+
+				vec2 corner = corners[gl_VertexID];
+				gl_Position = vec4(position.xy + corner.x * axes.xy + corner.y * axes.zw, position.z, 1.0);
+				TexCoord = mix(texcoords.xy, texcoords.zw, corner);
+				TexIndex = int(position.w);
+			}
+		)shaderend";
+
+	const std::string::value_type *cl_glsl15_fragment_sprite_array =
+		"#version 150\n"
+		"uniform sampler2DArray Texture0; "
+		"uniform sampler2DArray Texture1; "
+		"uniform sampler2DArray Texture2; "
+		"uniform sampler2DArray Texture3; "
+		"uniform sampler2DArray Texture4; "
+		"uniform sampler2DArray Texture5; "
+		"uniform sampler2DArray Texture6; "
+		"uniform sampler2DArray Texture7; "
+		"uniform sampler2DArray Texture8; "
+		"uniform sampler2DArray Texture9; "
+		"uniform sampler2DArray Texture10; "
+		"uniform sampler2DArray Texture11; "
+		"uniform sampler2DArray Texture12; "
+		"uniform sampler2DArray Texture13; "
+		"uniform sampler2DArray Texture14; "
+		"uniform sampler2DArray Texture15; "
+		"in vec4 Color; "
+		"in vec2 TexCoord; "
+		"flat in int TexIndex; "
+		"out vec4 cl_FragColor; "
+		"vec4 sampleTexture(int index, vec2 pos) "
+		"{ "
+		"vec3 coord = vec3(pos, float(index / 32)); "
+		"switch (index % 32) "
+		"{ "
+		"case 0: return texture(Texture0, coord); "
+		"case 1: return texture(Texture1, coord); "
+		"case 2: return texture(Texture2, coord); "
+		"case 3: return texture(Texture3, coord); "
+		"case 4: return texture(Texture4, coord); "
+		"case 5: return texture(Texture5, coord); "
+		"case 6: return texture(Texture6, coord); "
+		"case 7: return texture(Texture7, coord); "
+		"case 8: return texture(Texture8, coord); "
+		"case 9: return texture(Texture9, coord); "
+		"case 10: return texture(Texture10, coord); "
+		"case 11: return texture(Texture11, coord); "
+		"case 12: return texture(Texture12, coord); "
+		"case 13: return texture(Texture13, coord); "
+		"case 14: return texture(Texture14, coord); "
+		"case 15: return texture(Texture15, coord); "
+		"default: return vec4(1.0,1.0,1.0,1.0); "
+		"} "
+		"} "
+		"void main() { cl_FragColor = Color*sampleTexture(TexIndex, TexCoord); } ";
+
+	const std::string::value_type *cl_glsl_fragment_sprite_array =
+		"#version 130\n"
+		"uniform sampler2DArray Texture0; "
+		"uniform sampler2DArray Texture1; "
+		"uniform sampler2DArray Texture2; "
+		"uniform sampler2DArray Texture3; "
+		"uniform sampler2DArray Texture4; "
+		"uniform sampler2DArray Texture5; "
+		"uniform sampler2DArray Texture6; "
+		"uniform sampler2DArray Texture7; "
+		"uniform sampler2DArray Texture8; "
+		"uniform sampler2DArray Texture9; "
+		"uniform sampler2DArray Texture10; "
+		"uniform sampler2DArray Texture11; "
+		"uniform sampler2DArray Texture12; "
+		"uniform sampler2DArray Texture13; "
+		"uniform sampler2DArray Texture14; "
+		"uniform sampler2DArray Texture15; "
+		"in vec4 Color; "
+		"in vec2 TexCoord; "
+		"flat in int TexIndex; "
+		"vec4 sampleTexture(int index, vec2 pos) "
+		"{ "
+		"vec3 coord = vec3(pos, float(index / 32)); "
+		"switch (index % 32) "
+		"{ "
+		"case 0: return texture(Texture0, coord); "
+		"case 1: return texture(Texture1, coord); "
+		"case 2: return texture(Texture2, coord); "
+		"case 3: return texture(Texture3, coord); "
+		"case 4: return texture(Texture4, coord); "
+		"case 5: return texture(Texture5, coord); "
+		"case 6: return texture(Texture6, coord); "
+		"case 7: return texture(Texture7, coord); "
+		"case 8: return texture(Texture8, coord); "
+		"case 9: return texture(Texture9, coord); "
+		"case 10: return texture(Texture10, coord); "
+		"case 11: return texture(Texture11, coord); "
+		"case 12: return texture(Texture12, coord); "
+		"case 13: return texture(Texture13, coord); "
+		"case 14: return texture(Texture14, coord); "
+		"case 15: return texture(Texture15, coord); "
+		"default: return vec4(1.0,1.0,1.0,1.0); "
+		"} "
+		"} "
+		"void main() { gl_FragColor = Color*sampleTexture(TexIndex, TexCoord); } ";
+
+
+	// The glyph edge is where the distance field crosses 0.5. The edge is smoothed over about one screen pixel at any scale.
+	const std::string::value_type *cl_glsl15_fragment_sprite_distance_field =
+		"#version 150\n"
+		"uniform sampler2D Texture0; "
+		"uniform sampler2D Texture1; "
+		"uniform sampler2D Texture2; "
+		"uniform sampler2D Texture3; "
+		"uniform sampler2D Texture4; "
+		"uniform sampler2D Texture5; "
+		"uniform sampler2D Texture6; "
+		"uniform sampler2D Texture7; "
+		"uniform sampler2D Texture8; "
+		"uniform sampler2D Texture9; "
+		"uniform sampler2D Texture10; "
+		"uniform sampler2D Texture11; "
+		"uniform sampler2D Texture12; "
+		"uniform sampler2D Texture13; "
+		"uniform sampler2D Texture14; "
+		"uniform sampler2D Texture15; "
+		"in vec4 Color; "
+		"in vec2 TexCoord; "
+		"flat in int TexIndex; "
+		"out vec4 cl_FragColor; "
+		"float sampleDistance(int index, vec2 pos) "
+		"{ "
+		"switch (index) "
+		"{ "
+		"case 0: return texture(Texture0, pos).a; "
+		"case 1: return texture(Texture1, pos).a; "
+		"case 2: return texture(Texture2, pos).a; "
+		"case 3: return texture(Texture3, pos).a; "
+		"case 4: return texture(Texture4, pos).a; "
+		"case 5: return texture(Texture5, pos).a; "
+		"case 6: return texture(Texture6, pos).a; "
+		"case 7: return texture(Texture7, pos).a; "
+		"case 8: return texture(Texture8, pos).a; "
+		"case 9: return texture(Texture9, pos).a; "
+		"case 10: return texture(Texture10, pos).a; "
+		"case 11: return texture(Texture11, pos).a; "
+		"case 12: return texture(Texture12, pos).a; "
+		"case 13: return texture(Texture13, pos).a; "
+		"case 14: return texture(Texture14, pos).a; "
+		"case 15: return texture(Texture15, pos).a; "
+		"default: return 1.0; "
+		"} "
+		"} "
+		"void main() "
+		"{ "
+		"float distance = sampleDistance(TexIndex, TexCoord); "
+		"float width = max(fwidth(distance) * 0.7, 0.0001); "
+		"cl_FragColor = vec4(Color.rgb, Color.a * smoothstep(0.5 - width, 0.5 + width, distance)); "
+		"} ";
+
+	const std::string::value_type *cl_glsl_fragment_sprite_distance_field =
+		"#version 130\n"
+		"uniform sampler2D Texture0; "
+		"uniform sampler2D Texture1; "
+		"uniform sampler2D Texture2; "
+		"uniform sampler2D Texture3; "
+		"uniform sampler2D Texture4; "
+		"uniform sampler2D Texture5; "
+		"uniform sampler2D Texture6; "
+		"uniform sampler2D Texture7; "
+		"uniform sampler2D Texture8; "
+		"uniform sampler2D Texture9; "
+		"uniform sampler2D Texture10; "
+		"uniform sampler2D Texture11; "
+		"uniform sampler2D Texture12; "
+		"uniform sampler2D Texture13; "
+		"uniform sampler2D Texture14; "
+		"uniform sampler2D Texture15; "
+		"in vec4 Color; "
+		"in vec2 TexCoord; "
+		"flat in int TexIndex; "
+		"float sampleDistance(int index, vec2 pos) "
+		"{ "
+		"switch (index) "
+		"{ "
+		"case 0: return texture(Texture0, pos).a; "
+		"case 1: return texture(Texture1, pos).a; "
+		"case 2: return texture(Texture2, pos).a; "
+		"case 3: return texture(Texture3, pos).a; "
+		"case 4: return texture(Texture4, pos).a; "
+		"case 5: return texture(Texture5, pos).a; "
+		"case 6: return texture(Texture6, pos).a; "
+		"case 7: return texture(Texture7, pos).a; "
+		"case 8: return texture(Texture8, pos).a; "
+		"case 9: return texture(Texture9, pos).a; "
+		"case 10: return texture(Texture10, pos).a; "
+		"case 11: return texture(Texture11, pos).a; "
+		"case 12: return texture(Texture12, pos).a; "
+		"case 13: return texture(Texture13, pos).a; "
+		"case 14: return texture(Texture14, pos).a; "
+		"case 15: return texture(Texture15, pos).a; "
+		"default: return 1.0; "
+		"} "
+		"} "
+		"void main() "
+		"{ "
+		"float distance = sampleDistance(TexIndex, TexCoord); "
+		"float width = max(fwidth(distance) * 0.7, 0.0001); "
+		"gl_FragColor = vec4(Color.rgb, Color.a * smoothstep(0.5 - width, 0.5 + width, distance)); "
+		"} ";
+
+	// Draws sprites and LCD subpixel glyphs in one batch. The second output holds the blend factor per channel.
+	// Glyph vertices have RenderBatchTriangle::dual_source_glyph_flag added to their texture index.
+	const std::string::value_type *cl_glsl33_fragment_sprite_dual_source =
+		"#version 330\n"
+		"uniform sampler2D Texture0; "
+		"uniform sampler2D Texture1; "
+		"uniform sampler2D Texture2; "
+		"uniform sampler2D Texture3; "
+		"uniform sampler2D Texture4; "
+		"uniform sampler2D Texture5; "
+		"uniform sampler2D Texture6; "
+		"uniform sampler2D Texture7; "
+		"uniform sampler2D Texture8; "
+		"uniform sampler2D Texture9; "
+		"uniform sampler2D Texture10; "
+		"uniform sampler2D Texture11; "
+		"uniform sampler2D Texture12; "
+		"uniform sampler2D Texture13; "
+		"uniform sampler2D Texture14; "
+		"uniform sampler2D Texture15; "
+		"in vec4 Color; "
+		"in vec2 TexCoord; "
+		"flat in int TexIndex; "
+		"layout(location = 0, index = 0) out vec4 cl_FragColor; "
+		"layout(location = 0, index = 1) out vec4 cl_FragBlend; "
+		"vec4 sampleTexture(int index, vec2 pos) "
+		"{ "
+		"switch (index) "
+		"{ "
+		"case 0: return texture(Texture0, pos); "
+		"case 1: return texture(Texture1, pos); "
+		"case 2: return texture(Texture2, pos); "
+		"case 3: return texture(Texture3, pos); "
+		"case 4: return texture(Texture4, pos); "
+		"case 5: return texture(Texture5, pos); "
+		"case 6: return texture(Texture6, pos); "
+		"case 7: return texture(Texture7, pos); "
+		"case 8: return texture(Texture8, pos); "
+		"case 9: return texture(Texture9, pos); "
+		"case 10: return texture(Texture10, pos); "
+		"case 11: return texture(Texture11, pos); "
+		"case 12: return texture(Texture12, pos); "
+		"case 13: return texture(Texture13, pos); "
+		"case 14: return texture(Texture14, pos); "
+		"case 15: return texture(Texture15, pos); "
+		"default: return vec4(1.0,1.0,1.0,1.0); "
+		"} "
+		"} "
+		"void main() "
+		"{ "
+		"if (TexIndex >= 64) "
+		"{ "
+		"vec3 coverage = sampleTexture(TexIndex - 64, TexCoord).rgb * Color.a; "
+		"cl_FragColor = vec4(Color.rgb * coverage, 0.0); "
+		"cl_FragBlend = vec4(coverage, 0.0); "
+		"} "
+		"else "
+		"{ "
+		"vec4 color = Color * sampleTexture(TexIndex, TexCoord); "
+		"cl_FragColor = vec4(color.rgb * color.a, color.a); "
+		"cl_FragBlend = vec4(color.a); "
+		"} "
+		"} ";
 
 	const std::string::value_type *cl_glsl_vertex_path =
 		"#version 130\n"
@@ -267,11 +583,10 @@ namespace clan
 		"flat in vec4 brush_data2;\n"
 		"in vec4 vary_data;\n"
 		"out vec4 cl_FragColor;\n"
-		"flat in ivec2 instance_offset;\n"
 		"\n"
-		"uniform sampler2D instance_data;\n"
 		"uniform sampler2D image_texture;\n"
 		"uniform sampler2D mask_texture;\n"
+		"uniform sampler2D gradient_texture;\n"
 		"\n"
 		"vec4 mask(vec4 color)\n"
 		"{\n"
@@ -284,19 +599,10 @@ namespace clan
 		"	cl_FragColor = mask(fill_color);\n"
 		"}\n"
 		"\n"
-		"vec4 gradient_color(int stop_start, int stop_end, float t)\n"
+		"vec4 gradient_color(float t)\n"
 		"{\n"
-		"	vec4 color = texelFetch(instance_data, ivec2(instance_offset.x + stop_start, instance_offset.y), 0);\n"
-		"	float last_stop_pos = texelFetch(instance_data, ivec2(instance_offset.x + stop_start + 1, instance_offset.y), 0).x;\n"
-		"	for (int i = stop_start; i < stop_end; i += 2)\n"
-		"	{\n"
-		"		vec4 stop_color = texelFetch(instance_data, ivec2(instance_offset.x + i, instance_offset.y), 0);\n"
-		"		float stop_pos = texelFetch(instance_data, ivec2(instance_offset.x + i + 1, instance_offset.y), 0).x;\n"
-		"		float tt = clamp((t - last_stop_pos) / (stop_pos - last_stop_pos), 0.0, 1.0);\n"
-		"		color = mix(color, stop_color, tt);\n"
-		"		last_stop_pos = stop_pos;\n"
-		"	}\n"
-		"	return color;\n"
+		"	vec4 color = texture(gradient_texture, vec2(clamp(t, 0.0, 1.0) * brush_data2.z + brush_data2.w, brush_data2.y));\n"
+		"	return vec4(color.rgb * color.a, color.a);\n"
 		"}\n"
 		"\n"
 		"void linear_gradient_fill()\n"
@@ -304,22 +610,18 @@ namespace clan
 		"	vec2 grad_start = vary_data.xy;\n"
 		"	vec2 grad_dir = brush_data1.zw;\n"
 		"	float rcp_grad_length = brush_data2.x;\n"
-		"	int stop_start = int(brush_data2.y);\n"
-		"	int stop_end = int(brush_data2.z);\n"
 		"\n"
 		"	float t = dot(grad_start, grad_dir) * rcp_grad_length;\n"
-		"	cl_FragColor = mask(gradient_color(stop_start, stop_end, t));\n"
+		"	cl_FragColor = mask(gradient_color(t));\n"
 		"}\n"
 		"\n"
 		"void radial_gradient_fill()\n"
 		"{\n"
 		"	vec2 grad_center = vary_data.xy;\n"
 		"	float rcp_grad_length = brush_data2.x;\n"
-		"	int stop_start = int(brush_data2.y);\n"
-		"	int stop_end = int(brush_data2.z);\n"
 		"\n"
 		"	float t = length(grad_center) * rcp_grad_length;\n"
-		"	cl_FragColor = mask(gradient_color(stop_start, stop_end, t));\n"
+		"	cl_FragColor = mask(gradient_color(t));\n"
 		"}\n"
 		"\n"
 		"void image_fill()\n"
@@ -403,11 +705,10 @@ namespace clan
 	flat in vec4 brush_data2;
 	in vec4 vary_data;
 	out vec4 cl_FragColor;
-	flat in ivec2 instance_offset;
 
-	uniform sampler2D instance_data;
 	uniform sampler2D image_texture;
 	uniform sampler2D mask_texture;
+	uniform sampler2D gradient_texture;
 
 	vec4 mask(vec4 color)
 	{
@@ -420,19 +721,11 @@ namespace clan
 		cl_FragColor = mask(fill_color);
 	}
 
-	vec4 gradient_color(int stop_start, int stop_end, float t)
+	// The stops are baked into a row of the gradient atlas, unpremultiplied
+	vec4 gradient_color(float t)
 	{
-		vec4 color = texelFetch(instance_data, ivec2(instance_offset.x + stop_start, instance_offset.y), 0);
-		float last_stop_pos = texelFetch(instance_data, ivec2(instance_offset.x + stop_start + 1, instance_offset.y), 0).x;
-		for (int i = stop_start; i < stop_end; i+=2)
-		{
-			vec4 stop_color = texelFetch(instance_data, ivec2(instance_offset.x + i, instance_offset.y), 0);
-			float stop_pos = texelFetch(instance_data, ivec2(instance_offset.x + i + 1, instance_offset.y), 0).x;
-			float tt = clamp((t - last_stop_pos)/(stop_pos - last_stop_pos), 0.0, 1.0);
-			color = mix(color, stop_color, tt);
-			last_stop_pos = stop_pos;
-		}
-		return color;
+		vec4 color = texture(gradient_texture, vec2(clamp(t, 0.0, 1.0) * brush_data2.z + brush_data2.w, brush_data2.y));
+		return vec4(color.rgb * color.a, color.a);
 	}
 
 	void linear_gradient_fill()
@@ -440,22 +733,18 @@ namespace clan
 		vec2 grad_start = vary_data.xy;
 		vec2 grad_dir = brush_data1.zw;
 		float rcp_grad_length = brush_data2.x;
-		int stop_start = int(brush_data2.y);
-		int stop_end = int(brush_data2.z);
 
 		float t = dot(grad_start, grad_dir) * rcp_grad_length;
-		cl_FragColor = mask(gradient_color(stop_start, stop_end, t));
+		cl_FragColor = mask(gradient_color(t));
 	}
 
 	void radial_gradient_fill()
 	{
 		vec2 grad_center = vary_data.xy;
 		float rcp_grad_length = brush_data2.x;
-		int stop_start = int(brush_data2.y);
-		int stop_end = int(brush_data2.z);
 
 		float t = length(grad_center) * rcp_grad_length;
-		cl_FragColor = mask(gradient_color(stop_start, stop_end, t));
+		cl_FragColor = mask(gradient_color(t));
 	}
 
 	void image_fill()
@@ -477,6 +766,127 @@ namespace clan
 	}
 		)shaderend";
 
+	const std::string::value_type *cl_glsl15_vertex_box = R"shaderend(
+			#version 150
+			in vec4 Position;
+			in vec2 Local0;
+			in vec2 HalfSize0;
+			in vec4 Radii0;
+			in vec4 Inner0;
+			in vec4 InnerRadii0;
+			in vec4 FillColor0;
+			in vec4 BorderColor0;
+			in float BlurRadius0;
+			out vec2 Local;
+			flat out vec2 HalfSize;
+			flat out vec4 Radii;
+			flat out vec4 Inner;
+			flat out vec4 InnerRadii;
+			flat out vec4 FillColor;
+			flat out vec4 BorderColor;
+			flat out float BlurRadius;
+
+			void main()
+			{
+				gl_Position = Position;
+				Local = Local0;
+				HalfSize = HalfSize0;
+				Radii = Radii0;
+				Inner = Inner0;
+				InnerRadii = InnerRadii0;
+				FillColor = FillColor0;
+				BorderColor = BorderColor0;
+				BlurRadius = BlurRadius0;
+			}
+		)shaderend";
+
+	// Coverage of boxes, borders and shadows from the signed distance to a rounded box.
+	// Shadows fade out with the same (1-t)^2 curve as the gradient stops used by the path based style renderer.
+	const std::string::value_type *cl_glsl15_fragment_box = R"shaderend(
+			#version 150
+			in vec2 Local;
+			flat in vec2 HalfSize;
+			flat in vec4 Radii;
+			flat in vec4 Inner;
+			flat in vec4 InnerRadii;
+			flat in vec4 FillColor;
+			flat in vec4 BorderColor;
+			flat in float BlurRadius;
+			out vec4 cl_FragColor;
+
+			float rounded_box_distance(vec2 pos, vec2 half_size, vec4 radii)
+			{
+				float radius = pos.x < 0.0 ? (pos.y < 0.0 ? radii.x : radii.w) : (pos.y < 0.0 ? radii.y : radii.z);
+				vec2 q = abs(pos) - half_size + radius;
+				return min(max(q.x, q.y), 0.0) + length(max(q, 0.0)) - radius;
+			}
+
+			void main()
+			{
+				float pixel_size = max(length(fwidth(Local)) * 0.7071, 0.0001);
+				float outer = rounded_box_distance(Local, HalfSize, Radii);
+				if (BlurRadius > 0.0)
+				{
+					float t = clamp(outer / BlurRadius, 0.0, 1.0);
+					float outside = clamp(outer / pixel_size + 0.5, 0.0, 1.0);
+					cl_FragColor = vec4(FillColor.rgb, FillColor.a * (1.0 - t) * (1.0 - t) * outside);
+				}
+				else
+				{
+					float inner = rounded_box_distance(Local - Inner.xy, Inner.zw, InnerRadii);
+					float outer_coverage = clamp(0.5 - outer / pixel_size, 0.0, 1.0);
+					float border_coverage = outer_coverage * clamp(0.5 + inner / pixel_size, 0.0, 1.0);
+					vec4 fill = vec4(FillColor.rgb * FillColor.a, FillColor.a) * outer_coverage;
+					vec4 border = vec4(BorderColor.rgb * BorderColor.a, BorderColor.a) * border_coverage;
+					vec4 color = border + fill * (1.0 - border.a);
+					cl_FragColor = color.a > 0.0 ? vec4(color.rgb / color.a, color.a) : vec4(0.0);
+				}
+			}
+		)shaderend";
+
+	// Rasterizes the mask blocks collected by PathCoverageBuffer. Each thread sums the coverage of one mask pixel
+	const std::string::value_type *cl_glsl43_compute_path_coverage = R"shaderend(
+	#version 430
+
+	layout(local_size_x = 16, local_size_y = 16) in;
+
+	layout(r8, binding = 0) uniform writeonly image2D mask_image;
+	layout(std430, binding = 0) readonly buffer Blocks { int blocks[]; };
+	layout(std430, binding = 1) readonly buffer Spans { ivec2 spans[]; };
+
+	const int mask_block_size = 16;
+	const int antialias_level = 2;
+	const int block_entries = mask_block_size * antialias_level + 2;
+	const int mask_texture_size = 1024;
+
+	void main()
+	{
+		int base = int(gl_WorkGroupID.x) * block_entries;
+		int mask_index = blocks[base];
+		int x = int(gl_LocalInvocationID.x);
+		int y = int(gl_LocalInvocationID.y);
+
+		int coverage = 0;
+		for (int alias_y = 0; alias_y < antialias_level; alias_y++)
+		{
+			int scanline = y * antialias_level + alias_y;
+			int span_end = blocks[base + 2 + scanline];
+			for (int i = blocks[base + 1 + scanline]; i < span_end; i++)
+			{
+				ivec2 span = spans[i];
+				for (int alias_x = 0; alias_x < antialias_level; alias_x++)
+				{
+					if (x >= (span.x + alias_x) / antialias_level && x < (span.y + alias_x) / antialias_level)
+						coverage += 256 / (antialias_level * antialias_level);
+				}
+			}
+		}
+
+		int blocks_per_row = mask_texture_size / mask_block_size;
+		ivec2 pos = ivec2((mask_index % blocks_per_row) * mask_block_size + x, (mask_index / blocks_per_row) * mask_block_size + y);
+		imageStore(mask_image, pos, vec4(float(min(coverage, 255)) / 255.0));
+	}
+		)shaderend";
 
 	class GL3StandardPrograms_Impl
 	{
@@ -487,7 +897,14 @@ namespace clan
 		ProgramObject color_only_program;
 		ProgramObject single_texture_program;
 		ProgramObject sprite_program;
+		ProgramObject sprite_array_program;
+		ProgramObject sprite_distance_field_program;
+		ProgramObject sprite_dual_source_program;
+		ProgramObject sprite_instanced_program;
+		ProgramObject sprite_static_program;
 		ProgramObject path_program;
+		ProgramObject path_coverage_program;
+		ProgramObject box_program;
 
 	};
 
@@ -529,10 +946,18 @@ namespace clan
 		if (!vertex_sprite_shader.compile())
 			throw Exception("Unable to compile the standard shader program: 'vertex sprite' Error:" + vertex_sprite_shader.get_info_log());
 
+		ShaderObject vertex_sprite_static_shader(provider, shadertype_vertex, use_glsl_150 ? cl_glsl15_vertex_sprite_static : cl_glsl_vertex_sprite_static);
+		if (!vertex_sprite_static_shader.compile())
+			throw Exception("Unable to compile the standard shader program: 'vertex sprite static' Error:" + vertex_sprite_static_shader.get_info_log());
+
 		ShaderObject fragment_sprite_shader(provider, shadertype_fragment, use_glsl_150 ? cl_glsl15_fragment_sprite : cl_glsl_fragment_sprite);
 		if (!fragment_sprite_shader.compile())
 			throw Exception("Unable to compile the standard shader program: 'fragment sprite' Error:" + fragment_sprite_shader.get_info_log());
 
+		ShaderObject fragment_sprite_array_shader(provider, shadertype_fragment, use_glsl_150 ? cl_glsl15_fragment_sprite_array : cl_glsl_fragment_sprite_array);
+		if (!fragment_sprite_array_shader.compile())
+			throw Exception("Unable to compile the standard shader program: 'fragment sprite array' Error:" + fragment_sprite_array_shader.get_info_log());
+
 		ShaderObject vertex_path_shader(provider, shadertype_vertex, use_glsl_150 ? cl_glsl15_vertex_path : cl_glsl_vertex_path);
 		if (!vertex_path_shader.compile())
 			throw Exception("Unable to compile the standard shader program: 'vertex path' Error:" + vertex_path_shader.get_info_log());
@@ -598,6 +1023,139 @@ namespace clan
 		sprite_program.set_uniform1i("Texture14", 14);
 		sprite_program.set_uniform1i("Texture15", 15);
 
+		ProgramObject sprite_array_program(provider);
+		sprite_array_program.attach(vertex_sprite_shader);
+		sprite_array_program.attach(fragment_sprite_array_shader);
+		sprite_array_program.bind_attribute_location(0, "Position");
+		sprite_array_program.bind_attribute_location(1, "Color0");
+		sprite_array_program.bind_attribute_location(2, "TexCoord0");
+		sprite_array_program.bind_attribute_location(3, "TexIndex0");
+
+		if (use_glsl_150)
+			sprite_array_program.bind_frag_data_location(0, "cl_FragColor");
+
+		if (!sprite_array_program.link())
+			throw Exception("Unable to link the standard shader program: 'sprite array' Error:" + sprite_array_program.get_info_log());
+
+		for (int i = 0; i < 16; i++)
+			sprite_array_program.set_uniform1i(string_format("Texture%1", i), i);
+
+		ShaderObject fragment_sprite_distance_field_shader(provider, shadertype_fragment, use_glsl_150 ? cl_glsl15_fragment_sprite_distance_field : cl_glsl_fragment_sprite_distance_field);
+		if (!fragment_sprite_distance_field_shader.compile())
+			throw Exception("Unable to compile the standard shader program: 'fragment sprite distance field' Error:" + fragment_sprite_distance_field_shader.get_info_log());
+
+		ProgramObject sprite_distance_field_program(provider);
+		sprite_distance_field_program.attach(vertex_sprite_shader);
+		sprite_distance_field_program.attach(fragment_sprite_distance_field_shader);
+		sprite_distance_field_program.bind_attribute_location(0, "Position");
+		sprite_distance_field_program.bind_attribute_location(1, "Color0");
+		sprite_distance_field_program.bind_attribute_location(2, "TexCoord0");
+		sprite_distance_field_program.bind_attribute_location(3, "TexIndex0");
+
+		if (use_glsl_150)
+			sprite_distance_field_program.bind_frag_data_location(0, "cl_FragColor");
+
+		if (!sprite_distance_field_program.link())
+			throw Exception("Unable to link the standard shader program: 'sprite distance field' Error:" + sprite_distance_field_program.get_info_log());
+
+		for (int i = 0; i < 16; i++)
+			sprite_distance_field_program.set_uniform1i(string_format("Texture%1", i), i);
+
+		// Dual source blending needs OpenGL 3.3 or GL_ARB_blend_func_extended. Subpixel glyphs use a separate pass without it.
+		ShaderObject fragment_sprite_dual_source_shader(provider, shadertype_fragment, cl_glsl33_fragment_sprite_dual_source);
+		if (fragment_sprite_dual_source_shader.compile())
+		{
+			ProgramObject sprite_dual_source_program(provider);
+			sprite_dual_source_program.attach(vertex_sprite_shader);
+			sprite_dual_source_program.attach(fragment_sprite_dual_source_shader);
+			sprite_dual_source_program.bind_attribute_location(0, "Position");
+			sprite_dual_source_program.bind_attribute_location(1, "Color0");
+			sprite_dual_source_program.bind_attribute_location(2, "TexCoord0");
+			sprite_dual_source_program.bind_attribute_location(3, "TexIndex0");
+
+			if (sprite_dual_source_program.link())
+			{
+				for (int i = 0; i < 16; i++)
+					sprite_dual_source_program.set_uniform1i(string_format("Texture%1", i), i);
+
+				impl->sprite_dual_source_program = sprite_dual_source_program;
+				RenderBatchTriangle::dual_source_blending_supported = true;
+			}
+		}
+
+		ProgramObject sprite_static_program(provider);
+		sprite_static_program.attach(vertex_sprite_static_shader);
+		sprite_static_program.attach(fragment_sprite_shader);
+		sprite_static_program.bind_attribute_location(0, "Position");
+		sprite_static_program.bind_attribute_location(1, "Color0");
+		sprite_static_program.bind_attribute_location(2, "TexCoord0");
+		sprite_static_program.bind_attribute_location(3, "TexIndex0");
+
+		if (use_glsl_150)
+			sprite_static_program.bind_frag_data_location(0, "cl_FragColor");
+
+		if (!sprite_static_program.link())
+			throw Exception("Unable to link the standard shader program: 'sprite static' Error:" + sprite_static_program.get_info_log());
+
+		for (int i = 0; i < 16; i++)
+			sprite_static_program.set_uniform1i(string_format("Texture%1", i), i);
+
+		// gl_InstanceID needs GLSL 1.40
+		if (use_glsl_150)
+		{
+			ShaderObject vertex_sprite_instanced_shader(provider, shadertype_vertex, cl_glsl15_vertex_sprite_instanced);
+			if (!vertex_sprite_instanced_shader.compile())
+				throw Exception("Unable to compile the standard shader program: 'vertex sprite instanced' Error:" + vertex_sprite_instanced_shader.get_info_log());
+
+			ProgramObject sprite_instanced_program(provider);
+			sprite_instanced_program.attach(vertex_sprite_instanced_shader);
+			sprite_instanced_program.attach(fragment_sprite_shader);
+			sprite_instanced_program.bind_frag_data_location(0, "cl_FragColor");
+
+			if (!sprite_instanced_program.link())
+				throw Exception("Unable to link the standard shader program: 'sprite instanced' Error:" + sprite_instanced_program.get_info_log());
+
+			// The instance data takes the unit of the last sprite texture
+			for (int i = 0; i < 15; i++)
+				sprite_instanced_program.set_uniform1i(string_format("Texture%1", i), i);
+			sprite_instanced_program.set_uniform1i("InstanceData", 15);
+
+			impl->sprite_instanced_program = sprite_instanced_program;
+			RenderBatchSpriteInstanced::instancing_supported = true;
+		}
+
+		// The box program draws the style backgrounds, borders and shadows of the UI
+		if (use_glsl_150)
+		{
+			ShaderObject vertex_box_shader(provider, shadertype_vertex, cl_glsl15_vertex_box);
+			if (!vertex_box_shader.compile())
+				throw Exception("Unable to compile the standard shader program: 'vertex box' Error:" + vertex_box_shader.get_info_log());
+
+			ShaderObject fragment_box_shader(provider, shadertype_fragment, cl_glsl15_fragment_box);
+			if (!fragment_box_shader.compile())
+				throw Exception("Unable to compile the standard shader program: 'fragment box' Error:" + fragment_box_shader.get_info_log());
+
+			ProgramObject box_program(provider);
+			box_program.attach(vertex_box_shader);
+			box_program.attach(fragment_box_shader);
+			box_program.bind_attribute_location(0, "Position");
+			box_program.bind_attribute_location(1, "Local0");
+			box_program.bind_attribute_location(2, "HalfSize0");
+			box_program.bind_attribute_location(3, "Radii0");
+			box_program.bind_attribute_location(4, "Inner0");
+			box_program.bind_attribute_location(5, "InnerRadii0");
+			box_program.bind_attribute_location(6, "FillColor0");
+			box_program.bind_attribute_location(7, "BorderColor0");
+			box_program.bind_attribute_location(8, "BlurRadius0");
+			box_program.bind_frag_data_location(0, "cl_FragColor");
+
+			if (!box_program.link())
+				throw Exception("Unable to link the standard shader program: 'box' Error:" + box_program.get_info_log());
+
+			impl->box_program = box_program;
+			RenderBatchBox::supported = true;
+		}
+
 		ProgramObject path_program(provider);
 		path_program.attach(vertex_path_shader);
 		path_program.attach(fragment_path_shader);
@@ -611,13 +1169,36 @@ namespace clan
 		path_program.set_uniform1i("mask_texture", 0);
 		path_program.set_uniform1i("instance_data", 1);
 		path_program.set_uniform1i("image_texture", 2);
+		path_program.set_uniform1i("gradient_texture", 3);
+		PathFillRenderer::gradient_atlas_supported = true;
+
+		if (provider->has_compute_shader_support())
+		{
+			ShaderObject compute_path_coverage_shader(provider, shadertype_compute, cl_glsl43_compute_path_coverage);
+			if (!compute_path_coverage_shader.compile())
+				throw Exception("Unable to compile the standard shader program: 'compute path coverage' Error:" + compute_path_coverage_shader.get_info_log());
+
+			ProgramObject path_coverage_program(provider);
+			path_coverage_program.attach(compute_path_coverage_shader);
+			if (!path_coverage_program.link())
+				throw Exception("Unable to link the standard shader program: 'path coverage' Error:" + path_coverage_program.get_info_log());
+
+			impl->path_coverage_program = path_coverage_program;
+			PathFillRenderer::gpu_coverage_supported = true;
+		}
 
 		impl->color_only_program = color_only_program;
 		impl->single_texture_program = single_texture_program;
 		impl->sprite_program = sprite_program;
+		impl->sprite_array_program = sprite_array_program;
+		impl->sprite_distance_field_program = sprite_distance_field_program;
+		impl->sprite_static_program = sprite_static_program;
 		impl->path_program = path_program;
 
 		RenderBatchTriangle::max_textures = 16; // Too many hacks..
+		RenderBatchTriangle::texture_arrays_supported = true;
+		RenderBatchTriangle::static_batches_supported = true;
+		RenderBatchTriangle::distance_fields_supported = true;
 	}
 
 	GL3StandardPrograms::~GL3StandardPrograms()
@@ -632,6 +1213,13 @@ namespace clan
 		case program_single_texture: return impl->single_texture_program;
 		case program_sprite: return impl->sprite_program;
 		case program_path: return impl->path_program;
+		case program_sprite_array: return impl->sprite_array_program;
+		case program_sprite_instanced: return impl->sprite_instanced_program;
+		case program_sprite_static: return impl->sprite_static_program;
+		case program_path_coverage: return impl->path_coverage_program;
+		case program_sprite_distance_field: return impl->sprite_distance_field_program;
+		case program_sprite_dual_source: return impl->sprite_dual_source_program;
+		case program_box: return impl->box_program;
 		}
 		throw Exception("Unsupported standard program");
 	}
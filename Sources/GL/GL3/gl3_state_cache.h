@@ -0,0 +1,261 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+*/
+
+#pragma once
+
+#include "API/GL/opengl.h"
+#include "API/Display/2D/color.h"
+#include <vector>
+
+namespace clan
+{
+	class BlendStateProvider;
+	class RasterizerStateProvider;
+	class DepthStencilStateProvider;
+
+	/// \brief Shadow copy of the bindings made through a GL3GraphicContextProvider
+	///
+	/// Each set function records the new value and returns true if OpenGL must be called, or false if the
+	/// binding already has that value. Code binding objects behind the graphic context's back must restore the
+	/// previous binding afterwards, as the state trackers do, or call invalidate().
+	class GL3StateCache
+	{
+	public:
+		GL3StateCache()
+		{
+			invalidate();
+		}
+
+		/// \brief Forgets all bindings, so the next change of each kind reaches OpenGL
+		void invalidate()
+		{
+			active_texture_unit = -1;
+			textures.clear();
+			uniform_buffers.clear();
+			storage_buffers.clear();
+			program = unknown_handle;
+			vertex_array = unknown_handle;
+			invalidate_frame_buffers();
+			blend_state = nullptr;
+			rasterizer_state = nullptr;
+			depth_stencil_state = nullptr;
+		}
+
+		/// \brief Forgets the frame buffer bindings, for changes to the draw or read buffers
+		void invalidate_frame_buffers()
+		{
+			draw_frame_buffer = unknown_handle;
+			read_frame_buffer = unknown_handle;
+		}
+
+		bool set_active_texture(int unit)
+		{
+			return update(active_texture_unit, unit, counters.texture_units);
+		}
+
+		bool set_texture(int unit, GLenum target, GLuint handle)
+		{
+			if (unit >= (int)textures.size())
+				textures.resize(unit + 1);
+
+			// Only the last target bound on the unit is tracked. Bindings to other targets are still issued, which is always safe.
+			TextureBinding &binding = textures[unit];
+			if (binding.target == target && binding.handle == handle)
+			{
+				counters.textures.dropped++;
+				return false;
+			}
+			binding.target = target;
+			binding.handle = handle;
+			counters.textures.issued++;
+			return true;
+		}
+
+		bool set_uniform_buffer(int index, GLuint handle)
+		{
+			return update_indexed(uniform_buffers, index, handle, counters.uniform_buffers);
+		}
+
+		/// \brief Records a binding of part of a uniform buffer. Ranges are not tracked, so these are always issued.
+		void set_uniform_buffer_range(int index)
+		{
+			if (index >= (int)uniform_buffers.size())
+				uniform_buffers.resize(index + 1, (GLuint)unknown_handle);
+			uniform_buffers[index] = unknown_handle;
+			counters.uniform_buffers.issued++;
+		}
+
+		bool set_storage_buffer(int index, GLuint handle)
+		{
+			return update_indexed(storage_buffers, index, handle, counters.storage_buffers);
+		}
+
+		bool set_program(GLuint handle)
+		{
+			return update(program, handle, counters.programs);
+		}
+
+		bool set_vertex_array(GLuint handle)
+		{
+			return update(vertex_array, handle, counters.vertex_arrays);
+		}
+
+		bool set_frame_buffers(GLuint draw_handle, GLuint read_handle)
+		{
+			if (draw_frame_buffer == draw_handle && read_frame_buffer == read_handle)
+			{
+				counters.frame_buffers.dropped++;
+				return false;
+			}
+			draw_frame_buffer = draw_handle;
+			read_frame_buffer = read_handle;
+			counters.frame_buffers.issued++;
+			return true;
+		}
+
+		/// \brief State providers are cached per description by the graphic context, so equal pointers mean equal state
+		bool set_blend_state(const BlendStateProvider *state, const Colorf &new_blend_color)
+		{
+			if (blend_state == state && blend_color == new_blend_color)
+			{
+				counters.blend_states.dropped++;
+				return false;
+			}
+			blend_state = state;
+			blend_color = new_blend_color;
+			counters.blend_states.issued++;
+			return true;
+		}
+
+		bool set_rasterizer_state(const RasterizerStateProvider *state)
+		{
+			return update(rasterizer_state, state, counters.rasterizer_states);
+		}
+
+		bool set_depth_stencil_state(const DepthStencilStateProvider *state, int new_stencil_ref)
+		{
+			if (depth_stencil_state == state && stencil_ref == new_stencil_ref)
+			{
+				counters.depth_stencil_states.dropped++;
+				return false;
+			}
+			depth_stencil_state = state;
+			stencil_ref = new_stencil_ref;
+			counters.depth_stencil_states.issued++;
+			return true;
+		}
+
+		/// \brief Forgets bindings of a deleted object, as OpenGL may give its name to a new object
+		void forget_texture(GLuint handle)
+		{
+			for (auto &binding : textures)
+			{
+				if (binding.handle == handle)
+					binding.handle = unknown_handle;
+			}
+		}
+
+		void forget_buffer(GLuint handle)
+		{
+			forget_indexed(uniform_buffers, handle);
+			forget_indexed(storage_buffers, handle);
+		}
+
+		void forget_program(GLuint handle)
+		{
+			if (program == handle)
+				program = unknown_handle;
+		}
+
+		void forget_vertex_array(GLuint handle)
+		{
+			if (vertex_array == handle)
+				vertex_array = unknown_handle;
+		}
+
+		void forget_frame_buffer(GLuint handle)
+		{
+			if (draw_frame_buffer == handle || read_frame_buffer == handle)
+				invalidate_frame_buffers();
+		}
+
+		OpenGLStateCounters counters;
+
+	private:
+		static const GLuint unknown_handle = 0xffffffff;
+
+		struct TextureBinding
+		{
+			GLenum target = 0;
+			GLuint handle = unknown_handle;
+		};
+
+		template<typename Type>
+		static bool update(Type &current, Type value, OpenGLStateChangeCount &count)
+		{
+			if (current == value)
+			{
+				count.dropped++;
+				return false;
+			}
+			current = value;
+			count.issued++;
+			return true;
+		}
+
+		static bool update_indexed(std::vector<GLuint> &bindings, int index, GLuint handle, OpenGLStateChangeCount &count)
+		{
+			if (index >= (int)bindings.size())
+				bindings.resize(index + 1, (GLuint)unknown_handle);
+			return update(bindings[index], handle, count);
+		}
+
+		static void forget_indexed(std::vector<GLuint> &bindings, GLuint handle)
+		{
+			for (auto &binding : bindings)
+			{
+				if (binding == handle)
+					binding = unknown_handle;
+			}
+		}
+
+		int active_texture_unit;
+		std::vector<TextureBinding> textures;
+		std::vector<GLuint> uniform_buffers;
+		std::vector<GLuint> storage_buffers;
+		GLuint program;
+		GLuint vertex_array;
+		GLuint draw_frame_buffer;
+		GLuint read_frame_buffer;
+		const BlendStateProvider *blend_state;
+		Colorf blend_color;
+		const RasterizerStateProvider *rasterizer_state;
+		const DepthStencilStateProvider *depth_stencil_state;
+		int stencil_ref = 0;
+	};
+}
@@ -36,6 +36,7 @@
 namespace clan
 {
 	GL3StorageBufferProvider::GL3StorageBufferProvider()
+		: buffer(gpu_memory_storage_buffer)
 	{
 	}
 
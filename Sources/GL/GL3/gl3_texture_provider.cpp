@@ -125,6 +125,7 @@ namespace clan
 			if (OpenGL::set_active())
 			{
 				glDeleteTextures(1, &handle);
+				GL3GraphicContextProvider::forget_texture(handle);
 			}
 		}
 	}
@@ -164,6 +165,10 @@ namespace clan
 			} while (max(width >> levels, 1) != 1 || max(height >> levels, 1) != 1);
 		}
 
+		int layers = (texture_type == GL_TEXTURE_CUBE_MAP) ? 6 : max(array_size, 1);
+		int texture_depth = (texture_type == GL_TEXTURE_3D) ? depth : 1;
+		memory.set_size(GPUMemoryTracker::get_texture_size(texture_format, width, height, texture_depth, layers, levels, samples));
+
 		// Emulate glTexStorage behavior so we can support older versions of OpenGL
 		for (int level = 0; level < levels; level++)
 		{
@@ -230,20 +235,20 @@ namespace clan
 		if (tf.valid)
 		{
 			PixelBuffer buffer(width, height, texture_format);
-			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-			glPixelStorei(GL_UNPACK_ROW_LENGTH, buffer.get_pitch() / buffer.get_bytes_per_pixel());
-			glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
-			glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+			glPixelStorei(GL_PACK_ALIGNMENT, 1);
+			glPixelStorei(GL_PACK_ROW_LENGTH, buffer.get_pitch() / buffer.get_bytes_per_pixel());
+			glPixelStorei(GL_PACK_SKIP_PIXELS, 0);
+			glPixelStorei(GL_PACK_SKIP_ROWS, 0);
 			glGetTexImage(texture_type, level, tf.pixel_format, tf.pixel_datatype, buffer.get_data());
 			return buffer;
 		}
 		else
 		{
 			PixelBuffer buffer(width, height, tf_bgra8);
-			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-			glPixelStorei(GL_UNPACK_ROW_LENGTH, buffer.get_pitch() / buffer.get_bytes_per_pixel());
-			glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
-			glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+			glPixelStorei(GL_PACK_ALIGNMENT, 1);
+			glPixelStorei(GL_PACK_ROW_LENGTH, buffer.get_pitch() / buffer.get_bytes_per_pixel());
+			glPixelStorei(GL_PACK_SKIP_PIXELS, 0);
+			glPixelStorei(GL_PACK_SKIP_ROWS, 0);
 			glGetTexImage(texture_type, level, GL_RGBA, GL_UNSIGNED_BYTE, buffer.get_data());
 			return buffer.to_format(texture_format);
 		}
@@ -33,6 +33,7 @@
 #include "API/Display/TargetProviders/texture_provider.h"
 #include "API/Core/System/disposable_object.h"
 #include "API/GL/opengl.h"
+#include "API/Display/Render/gpu_memory.h"
 
 namespace clan
 {
@@ -107,6 +108,8 @@ namespace clan
 
 		int width, height, depth, array_size;
 
+		GPUMemoryAllocation memory{gpu_memory_texture};
+
 		/// \brief OpenGL texture handle.
 		GLuint handle;
 		GLuint texture_type;
@@ -0,0 +1,105 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "GL/precomp.h"
+#include "gl3_timer_query_provider.h"
+#include "API/GL/opengl_wrap.h"
+#include "API/Display/Render/shared_gc_data.h"
+#include "gl3_graphic_context_provider.h"
+
+namespace clan
+{
+	GL3TimerQueryProvider::GL3TimerQueryProvider(GL3GraphicContextProvider *gc_provider)
+		: handle(0), gc_provider(gc_provider)
+	{
+		SharedGCData::add_disposable(this);
+		create();
+	}
+
+	GL3TimerQueryProvider::~GL3TimerQueryProvider()
+	{
+		dispose();
+		SharedGCData::remove_disposable(this);
+	}
+
+	void GL3TimerQueryProvider::on_dispose()
+	{
+		if (handle)
+		{
+			if (OpenGL::set_active())
+			{
+				glDeleteQueries(1, &handle);
+			}
+		}
+	}
+
+	bool GL3TimerQueryProvider::is_result_ready() const
+	{
+		OpenGL::set_active(gc_provider);
+		int available;
+		glGetQueryObjectiv(handle, GL_QUERY_RESULT_AVAILABLE, &available);
+		return (available != 0);
+	}
+
+	uint64_t GL3TimerQueryProvider::get_result() const
+	{
+		OpenGL::set_active(gc_provider);
+		CLuint64 result = 0;
+		glGetQueryObjectui64v(handle, GL_QUERY_RESULT, &result);
+		return result;
+	}
+
+	void GL3TimerQueryProvider::create()
+	{
+		OpenGL::set_active(gc_provider);
+
+		if (handle)
+		{
+			glDeleteQueries(1, &handle);
+			handle = 0;
+		}
+
+		if (!glGetQueryObjectui64v)
+			throw Exception("Timer queries require OpenGL 3.3 or GL_ARB_timer_query");
+
+		glGenQueries(1, &handle);
+	}
+
+	void GL3TimerQueryProvider::begin()
+	{
+		OpenGL::set_active(gc_provider);
+		glBeginQuery(GL_TIME_ELAPSED, handle);
+	}
+
+	void GL3TimerQueryProvider::end()
+	{
+		OpenGL::set_active(gc_provider);
+		glEndQuery(GL_TIME_ELAPSED);
+	}
+}
@@ -36,6 +36,7 @@
 namespace clan
 {
 	GL3TransferBufferProvider::GL3TransferBufferProvider()
+		: buffer(gpu_memory_transfer_buffer)
 	{
 	}
 
@@ -36,6 +36,7 @@
 namespace clan
 {
 	GL3UniformBufferProvider::GL3UniformBufferProvider()
+		: buffer(gpu_memory_uniform_buffer)
 	{
 	}
 
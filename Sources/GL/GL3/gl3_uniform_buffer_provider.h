@@ -49,6 +49,8 @@ namespace clan
 		GLuint get_handle() const { return buffer.get_handle(); }
 
 		void upload_data(GraphicContext &gc, const void *data, int size) override { buffer.upload_data(gc, data, size); }
+		void upload_data(GraphicContext &gc, int offset, const void *data, int size) override { buffer.upload_data(gc, offset, data, size); }
+		void upload_data_unsynchronized(GraphicContext &gc, int offset, const void *data, int size, bool discard) override { buffer.upload_data_unsynchronized(gc, offset, data, size, discard); }
 		void copy_from(GraphicContext &gc, TransferBuffer &transfer_buffer, int dest_pos, int src_pos, int size) override { buffer.copy_from(gc, transfer_buffer, dest_pos, src_pos, size); }
 		void copy_to(GraphicContext &gc, TransferBuffer &transfer_buffer, int dest_pos, int src_pos, int size) override { buffer.copy_to(gc, transfer_buffer, dest_pos, src_pos, size); }
 
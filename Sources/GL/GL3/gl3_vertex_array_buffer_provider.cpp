@@ -36,6 +36,7 @@
 namespace clan
 {
 	GL3VertexArrayBufferProvider::GL3VertexArrayBufferProvider()
+		: buffer(gpu_memory_vertex_buffer)
 	{
 	}
 
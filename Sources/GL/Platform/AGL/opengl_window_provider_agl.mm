@@ -266,6 +266,11 @@ void OpenGLWindowProvider::flip(int interval)
 	OpenGL::check_error();
 }
 
+void OpenGLWindowProvider::flip(const std::vector<Rect> &damage, int interval)
+{
+	flip(interval);
+}
+
 CursorProvider *OpenGLWindowProvider::create_cursor(const SpriteDescription &sprite_description, const Point &hotspot)
 {
 //	return new CursorProvider_Cocoa(sprite_description, hotspot);
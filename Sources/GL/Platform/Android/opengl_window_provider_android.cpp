@@ -259,6 +259,12 @@ namespace clan
 		if (surface == EGL_NO_SURFACE)
 			throw Exception("eglCreateWindowSurface failed");
 
+		// Partial presentation needs the back buffer to survive the swap; this fails harmlessly if the config cannot do it
+		buffer_preserved = eglSurfaceAttrib(display, surface, EGL_SWAP_BEHAVIOR, EGL_BUFFER_PRESERVED) == EGL_TRUE;
+		const char *egl_extensions = eglQueryString(display, EGL_EXTENSIONS);
+		if (egl_extensions && strstr(egl_extensions, "EGL_KHR_swap_buffers_with_damage"))
+			eglSwapBuffersWithDamageKHR = (ptr_eglSwapBuffersWithDamageKHR)eglGetProcAddress("eglSwapBuffersWithDamageKHR");
+
 		context = eglCreateContext(display, config, NULL, NULL);
 		if (context == EGL_NO_CONTEXT)
 			throw Exception("eglCreateWindowSurface failed");
@@ -404,6 +410,38 @@ namespace clan
 		OpenGL::check_error();
 	}
 
+	void OpenGLWindowProvider::flip(const std::vector<Rect> &damage, int interval)
+	{
+		if (!eglSwapBuffersWithDamageKHR || !buffer_preserved || display == EGL_NO_DISPLAY || surface == EGL_NO_SURFACE)
+		{
+			flip(interval);
+			return;
+		}
+
+		OpenGL::set_active(get_gc());
+		glFlush();
+
+		if (interval != -1 && interval != swap_interval)
+		{
+			swap_interval = interval;
+			eglSwapInterval(display, swap_interval);
+		}
+
+		int height = get_viewport().get_height();
+		std::vector<EGLint> rects;
+		rects.reserve(damage.size() * 4);
+		for (const auto &rect : damage)
+		{
+			rects.push_back(rect.left);
+			rects.push_back(height - rect.bottom);
+			rects.push_back(rect.get_width());
+			rects.push_back(rect.get_height());
+		}
+
+		eglSwapBuffersWithDamageKHR(display, surface, rects.data(), (EGLint)damage.size());
+		OpenGL::check_error();
+	}
+
 	void OpenGLWindowProvider::capture_mouse(bool capture)
 	{
 	}
@@ -34,6 +34,7 @@
 #include <memory>
 #include "API/GL/opengl_context_description.h"
 #include "API/GL/opengl_wrap.h"
+#include "GL/opengl_display_window_provider.h"
 
 #include <EGL/egl.h>
 #include <GLES/gl.h>
@@ -43,7 +44,7 @@ namespace clan
 
 	class OpenGLContextDescription;
 
-	class OpenGLWindowProvider : public DisplayWindowProvider
+	class OpenGLWindowProvider : public OpenGLDisplayWindowProvider
 	{
 /// \name Construction
 /// \{
@@ -75,8 +76,8 @@ namespace clan
 		std::string get_clipboard_text() const override;
 		PixelBuffer get_clipboard_image() const override;
 		float get_pixel_ratio() const override;
-		ProcAddress *get_proc_address(const std::string& function_name) const;
-		bool is_double_buffered() const { return double_buffered; }
+		ProcAddress *get_proc_address(const std::string& function_name) const override;
+		bool is_double_buffered() const override { return double_buffered; }
 
 		EGLDisplay get_display() const { return display; }
 		EGLContext get_context() const { return context; }
@@ -86,7 +87,7 @@ namespace clan
 /// \{
 
 	public:
-		void make_current() const;
+		void make_current() const override;
 		Point client_to_screen(const Point &client) override;
 		Point screen_to_client(const Point &screen) override;
 		void create(DisplayWindowSite *site, const DisplayWindowDescription &description) override;
@@ -112,6 +113,7 @@ namespace clan
 
 		/// \brief Flip OpenGL buffers.
 		void flip(int interval) override;
+		void flip(const std::vector<Rect> &damage, int interval) override;
 
 		/// \brief Capture/Release the mouse.
 		void capture_mouse(bool capture) override;
@@ -148,6 +150,10 @@ namespace clan
 		bool double_buffered = false;
 		int swap_interval = 0;
 
+		typedef EGLBoolean (*ptr_eglSwapBuffersWithDamageKHR)(EGLDisplay dpy, EGLSurface surface, EGLint *rects, EGLint n_rects);
+		ptr_eglSwapBuffersWithDamageKHR eglSwapBuffersWithDamageKHR = nullptr;
+		bool buffer_preserved = false;
+
 		OpenGLContextDescription opengl_desc;
 		DisplayWindowHandle window_handle;
 		EGLDisplay display = EGL_NO_DISPLAY;
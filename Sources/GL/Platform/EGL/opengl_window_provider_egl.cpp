@@ -0,0 +1,561 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "GL/precomp.h"
+#include "opengl_window_provider_egl.h"
+#include "API/Core/Math/rect.h"
+#include "API/Core/System/system.h"
+#include "API/Core/Text/string_format.h"
+#include "API/Core/Text/string_help.h"
+#include "API/Display/Window/display_window_description.h"
+#include "API/Display/Render/shared_gc_data.h"
+#include "API/GL/opengl.h"
+#include "API/GL/opengl_wrap.h"
+#include "GL/GL3/gl3_graphic_context_provider.h"
+#include <dlfcn.h>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+#define GL_EGL_LIBRARY "libEGL.so.1"
+
+namespace clan
+{
+
+static bool cl_is_egl_extension_in_list(const char *ext_string, const char *ext_name)
+{
+	if (!ext_string)
+		return false;
+
+	size_t ext_len = strlen(ext_name);
+	for (const char *start = ext_string; ; )
+	{
+		const char *where = strstr(start, ext_name);
+		if (!where)
+			return false;
+
+		const char *terminator = where + ext_len;
+		if ((where == start || *(where - 1) == ' ') && (*terminator == ' ' || *terminator == '\0'))
+			return true;
+
+		start = terminator;
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// GL_EGLFunctions:
+
+bool GL_EGLFunctions::load()
+{
+	// Vendor drivers register exit handlers, so the library stays loaded for the lifetime of the process
+	static void *handle = dlopen(GL_EGL_LIBRARY, RTLD_NOW | RTLD_LOCAL);
+	if (!handle)
+		return false;
+
+	eglGetProcAddress = (ptr_eglGetProcAddress) dlsym(handle, "eglGetProcAddress");
+	eglGetError = (ptr_eglGetError) dlsym(handle, "eglGetError");
+	eglQueryString = (ptr_eglQueryString) dlsym(handle, "eglQueryString");
+	eglGetDisplay = (ptr_eglGetDisplay) dlsym(handle, "eglGetDisplay");
+	eglInitialize = (ptr_eglInitialize) dlsym(handle, "eglInitialize");
+	eglTerminate = (ptr_eglTerminate) dlsym(handle, "eglTerminate");
+	eglBindAPI = (ptr_eglBindAPI) dlsym(handle, "eglBindAPI");
+	eglChooseConfig = (ptr_eglChooseConfig) dlsym(handle, "eglChooseConfig");
+	eglCreateContext = (ptr_eglCreateContext) dlsym(handle, "eglCreateContext");
+	eglDestroyContext = (ptr_eglDestroyContext) dlsym(handle, "eglDestroyContext");
+	eglCreatePbufferSurface = (ptr_eglCreatePbufferSurface) dlsym(handle, "eglCreatePbufferSurface");
+	eglDestroySurface = (ptr_eglDestroySurface) dlsym(handle, "eglDestroySurface");
+	eglMakeCurrent = (ptr_eglMakeCurrent) dlsym(handle, "eglMakeCurrent");
+	eglGetCurrentContext = (ptr_eglGetCurrentContext) dlsym(handle, "eglGetCurrentContext");
+
+	if ( (eglGetProcAddress == nullptr) ||
+		(eglGetError == nullptr) ||
+		(eglQueryString == nullptr) ||
+		(eglGetDisplay == nullptr) ||
+		(eglInitialize == nullptr) ||
+		(eglTerminate == nullptr) ||
+		(eglBindAPI == nullptr) ||
+		(eglChooseConfig == nullptr) ||
+		(eglCreateContext == nullptr) ||
+		(eglDestroyContext == nullptr) ||
+		(eglCreatePbufferSurface == nullptr) ||
+		(eglDestroySurface == nullptr) ||
+		(eglMakeCurrent == nullptr) ||
+		(eglGetCurrentContext == nullptr) )
+	{
+		return false;
+	}
+
+	// Client extensions are only listed by implementations supporting EGL_EXT_client_extensions
+	const char *client_extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+	if (!client_extensions)
+	{
+		eglGetError();	// Clear the EGL_BAD_DISPLAY error
+	}
+	else
+	{
+		if (cl_is_egl_extension_in_list(client_extensions, "EGL_EXT_device_enumeration") || cl_is_egl_extension_in_list(client_extensions, "EGL_EXT_device_base"))
+			eglQueryDevicesEXT = (ptr_eglQueryDevicesEXT) eglGetProcAddress("eglQueryDevicesEXT");
+		if (cl_is_egl_extension_in_list(client_extensions, "EGL_EXT_platform_device"))
+			eglGetPlatformDisplayEXT = (ptr_eglGetPlatformDisplayEXT) eglGetProcAddress("eglGetPlatformDisplayEXT");
+		if (cl_is_egl_extension_in_list(client_extensions, "EGL_EXT_device_query") || cl_is_egl_extension_in_list(client_extensions, "EGL_EXT_device_base"))
+			eglQueryDeviceStringEXT = (ptr_eglQueryDeviceStringEXT) eglGetProcAddress("eglQueryDeviceStringEXT");
+	}
+	return true;
+}
+
+std::vector<EGLDeviceEXT> GL_EGLFunctions::query_devices() const
+{
+	std::vector<EGLDeviceEXT> devices;
+	if (!eglQueryDevicesEXT || !eglGetPlatformDisplayEXT)
+		return devices;
+
+	EGLint num_devices = 0;
+	if (!eglQueryDevicesEXT(0, nullptr, &num_devices) || num_devices <= 0)
+		return devices;
+
+	devices.resize(num_devices);
+	if (!eglQueryDevicesEXT(num_devices, devices.data(), &num_devices))
+		num_devices = 0;
+	devices.resize(num_devices);
+	return devices;
+}
+
+bool GL_EGLFunctions::is_software_device(EGLDeviceEXT device) const
+{
+	if (!eglQueryDeviceStringEXT)
+		return false;
+	return cl_is_egl_extension_in_list(eglQueryDeviceStringEXT(device, EGL_EXTENSIONS), "EGL_MESA_device_software");
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// OpenGLHeadlessWindowProvider Construction:
+
+OpenGLHeadlessWindowProvider::OpenGLHeadlessWindowProvider(OpenGLContextDescription &opengl_desc)
+: opengl_desc(opengl_desc)
+{
+	if (!egl.load())
+		throw Exception(string_format("Cannot open EGL library: %1", GL_EGL_LIBRARY));
+}
+
+OpenGLHeadlessWindowProvider::~OpenGLHeadlessWindowProvider()
+{
+	if (context != EGL_NO_CONTEXT)
+	{
+		if (!gc.is_null())
+		{
+			OpenGL::set_active(gc);
+
+			GL3GraphicContextProvider *gl_provider = dynamic_cast<GL3GraphicContextProvider*>(gc.get_provider());
+			if (gl_provider)
+				gl_provider->dispose();
+		}
+
+		if (egl.eglGetCurrentContext() == context)
+			OpenGL::set_active(nullptr);
+
+		egl.eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+		egl.eglDestroyContext(display, context);
+		context = EGL_NO_CONTEXT;
+	}
+
+	if (surface != EGL_NO_SURFACE)
+	{
+		egl.eglDestroySurface(display, surface);
+		surface = EGL_NO_SURFACE;
+	}
+
+	// Displays are shared per device, so terminating would pull the rug from other headless windows
+	display = EGL_NO_DISPLAY;
+}
+
+int OpenGLHeadlessWindowProvider::get_device_count()
+{
+	GL_EGLFunctions egl;
+	if (!egl.load())
+		return 0;
+
+	int count = egl.query_devices().size();
+	if (count == 0)
+		count = 1;	// No enumeration: only the default display is available
+	return count;
+}
+
+bool OpenGLHeadlessWindowProvider::is_software_device(int index)
+{
+	GL_EGLFunctions egl;
+	if (!egl.load())
+		return false;
+
+	std::vector<EGLDeviceEXT> devices = egl.query_devices();
+	if (index < 0 || index >= (int)devices.size())
+		return false;
+	return egl.is_software_device(devices[index]);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// OpenGLHeadlessWindowProvider Attributes:
+
+ProcAddress *OpenGLHeadlessWindowProvider::get_proc_address(const std::string& function_name) const
+{
+	return egl.eglGetProcAddress(function_name.c_str());
+}
+
+InputDevice &OpenGLHeadlessWindowProvider::get_keyboard()
+{
+	static InputDevice empty;
+	return empty;
+}
+
+InputDevice &OpenGLHeadlessWindowProvider::get_mouse()
+{
+	static InputDevice empty;
+	return empty;
+}
+
+std::vector<InputDevice> &OpenGLHeadlessWindowProvider::get_game_controllers()
+{
+	static std::vector<InputDevice> empty;
+	return empty;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// OpenGLHeadlessWindowProvider Operations:
+
+void OpenGLHeadlessWindowProvider::make_current() const
+{
+	egl.eglMakeCurrent(display, surface, surface, context);
+}
+
+bool OpenGLHeadlessWindowProvider::make_current_on_surface_of(const OpenGLDisplayWindowProvider &window) const
+{
+	const OpenGLHeadlessWindowProvider *other = dynamic_cast<const OpenGLHeadlessWindowProvider *>(&window);
+	if (!other || other->display != display || other->config != config || other->surface == EGL_NO_SURFACE)
+		return false;
+	return egl.eglMakeCurrent(display, other->surface, other->surface, context) == EGL_TRUE;
+}
+
+void OpenGLHeadlessWindowProvider::create(DisplayWindowSite *new_site, const DisplayWindowDescription &desc)
+{
+	site = new_site;
+	title = desc.get_title();
+
+	Size new_size((int)std::round(desc.get_size().width * pixel_ratio), (int)std::round(desc.get_size().height * pixel_ratio));
+	if (context != EGL_NO_CONTEXT)
+	{
+		set_size(new_size.width, new_size.height, true);
+		return;
+	}
+
+	display = open_display();
+
+	EGLint major = 0, minor = 0;
+	if (!egl.eglInitialize(display, &major, &minor))
+		throw Exception("eglInitialize failed");
+	egl_version_major = major;
+	egl_version_minor = minor;
+
+	if (!egl.eglBindAPI(EGL_OPENGL_API))
+		throw Exception("EGL implementation does not support desktop OpenGL");
+
+	// Software and some device platforms only offer configless contexts; those fall back to surfaceless rendering
+	if (new_size.width > 0 && new_size.height > 0)
+		pbuffer_supported = choose_config(desc, EGL_PBUFFER_BIT);
+	if (!pbuffer_supported && !choose_config(desc, 0))
+	{
+		if (!is_egl_extension_supported("EGL_KHR_no_config_context"))
+			throw Exception("eglChooseConfig found no matching headless OpenGL config");
+		config = EGL_NO_CONFIG_KHR;
+	}
+	if (!pbuffer_supported && !is_egl_extension_supported("EGL_KHR_surfaceless_context"))
+		throw Exception("A headless window without a pbuffer requires EGL_KHR_surfaceless_context");
+
+	int gl_major = opengl_desc.get_version_major();
+	int gl_minor = opengl_desc.get_version_minor();
+	if (gl_major < 3)
+		throw Exception("Headless rendering requires OpenGL 3.0 or above");
+
+	EGLContext share_context = get_share_context();
+
+	uint64_t start_time = System::get_microseconds();
+	context = create_context(gl_major, gl_minor, share_context);
+	if (context == EGL_NO_CONTEXT && opengl_desc.get_allow_lower_versions())
+	{
+		static const char opengl_version_list[] =
+		{
+			// Clanlib supported version pairs
+			4,4,
+			4,3,
+			4,2,
+			4,1,
+			4,0,
+			3,3,
+			3,2,
+			3,1,
+			3,0,
+			0,0,	// End of list
+		};
+
+		for (const char *version = opengl_version_list; version[0] != 0 && context == EGL_NO_CONTEXT; version += 2)
+		{
+			if (version[0] > gl_major || (version[0] == gl_major && version[1] >= gl_minor))
+				continue;
+			context = create_context(version[0], version[1], share_context);
+		}
+	}
+	cl_record_context_creation(System::get_microseconds() - start_time);
+	if (context == EGL_NO_CONTEXT)
+		throw Exception(string_format("This application requires OpenGL %1.%2 or above. Try updating your drivers, or upgrade to a newer graphics card.", gl_major, gl_minor));
+
+	create_surface(pbuffer_supported ? new_size : Size());
+
+	int version_major = 0, version_minor = 0;
+	get_opengl_version(version_major, version_minor);
+	if (version_major < 3)
+		throw Exception("Headless rendering requires OpenGL 3.0 or above");
+
+	gc = GraphicContext(new GL3GraphicContextProvider(this));
+}
+
+void OpenGLHeadlessWindowProvider::set_size(int width, int height, bool client_area)
+{
+	Size new_size(width, height);
+	if (context == EGL_NO_CONTEXT || new_size == size)
+		return;
+
+	// A surfaceless context has no config for pbuffers, so it keeps rendering to frame buffers only
+	if (!pbuffer_supported)
+		return;
+
+	// create_surface makes the context current, which must be known to OpenGL::set_active when another context was active
+	GL3GraphicContextProvider *gl_provider = dynamic_cast<GL3GraphicContextProvider*>(gc.get_provider());
+	if (gl_provider)
+		OpenGL::set_active(gl_provider);
+
+	create_surface(new_size);
+
+	if (gl_provider)
+		gl_provider->on_window_resized();
+
+	if (site)
+		site->sig_resize(size.width / pixel_ratio, size.height / pixel_ratio);
+}
+
+CursorProvider *OpenGLHeadlessWindowProvider::create_cursor(const CursorDescription &cursor_description)
+{
+	throw Exception("Headless windows have no cursor");
+}
+
+void OpenGLHeadlessWindowProvider::flip(int interval)
+{
+	// Pbuffers are never presented; flushing makes the frame visible to readbacks and other contexts
+	OpenGL::set_active(gc);
+	glFlush();
+	OpenGL::check_error();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// OpenGLHeadlessWindowProvider Implementation:
+
+EGLDisplay OpenGLHeadlessWindowProvider::open_display()
+{
+	int device_index = opengl_desc.get_headless_device();
+	std::vector<EGLDeviceEXT> devices = egl.query_devices();
+
+	if (opengl_desc.get_headless_software())
+	{
+		auto it = std::find_if(devices.begin(), devices.end(), [&](EGLDeviceEXT device) { return egl.is_software_device(device); });
+		if (it == devices.end())
+			throw Exception("No software rasterizer EGL device is available. Install Mesa llvmpipe");
+		device_index = (int)(it - devices.begin());
+	}
+
+	if (devices.empty())
+	{
+		if (device_index != 0)
+			throw Exception(string_format("Headless device %1 requested, but EGL cannot enumerate devices", device_index));
+
+		EGLDisplay default_display = egl.eglGetDisplay(EGL_DEFAULT_DISPLAY);
+		if (default_display == EGL_NO_DISPLAY)
+			throw Exception("eglGetDisplay failed");
+		return default_display;
+	}
+
+	if (device_index < 0 || device_index >= (int)devices.size())
+		throw Exception(string_format("Headless device %1 requested, but only %2 EGL devices are available", device_index, (int)devices.size()));
+
+	EGLDisplay device_display = egl.eglGetPlatformDisplayEXT(EGL_PLATFORM_DEVICE_EXT, devices[device_index], nullptr);
+	if (device_display == EGL_NO_DISPLAY)
+		throw Exception(string_format("eglGetPlatformDisplayEXT failed for headless device %1", device_index));
+	return device_display;
+}
+
+bool OpenGLHeadlessWindowProvider::choose_config(const DisplayWindowDescription &desc, EGLint surface_type)
+{
+	EGLint config_attribs[] =
+	{
+		EGL_SURFACE_TYPE, surface_type,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_RED_SIZE, 8,
+		EGL_GREEN_SIZE, 8,
+		EGL_BLUE_SIZE, 8,
+		EGL_ALPHA_SIZE, 8,
+		EGL_DEPTH_SIZE, desc.get_depth_size(),
+		EGL_STENCIL_SIZE, desc.get_stencil_size(),
+		EGL_SAMPLE_BUFFERS, desc.get_multisampling() > 0 ? 1 : 0,
+		EGL_SAMPLES, desc.get_multisampling(),
+		EGL_NONE
+	};
+
+	EGLint num_configs = 0;
+	return egl.eglChooseConfig(display, config_attribs, &config, 1, &num_configs) && num_configs > 0;
+}
+
+void OpenGLHeadlessWindowProvider::create_surface(const Size &new_size)
+{
+	EGLSurface new_surface = EGL_NO_SURFACE;
+	if (new_size.width > 0 && new_size.height > 0)
+	{
+		EGLint pbuffer_attribs[] =
+		{
+			EGL_WIDTH, new_size.width,
+			EGL_HEIGHT, new_size.height,
+			EGL_NONE
+		};
+		new_surface = egl.eglCreatePbufferSurface(display, config, pbuffer_attribs);
+		if (new_surface == EGL_NO_SURFACE)
+			throw Exception(string_format("eglCreatePbufferSurface failed for a %1x%2 pbuffer", new_size.width, new_size.height));
+	}
+
+	if (!egl.eglMakeCurrent(display, new_surface, new_surface, context))
+	{
+		if (new_surface != EGL_NO_SURFACE)
+			egl.eglDestroySurface(display, new_surface);
+		throw Exception("Unable to eglMakeCurrent");
+	}
+
+	if (surface != EGL_NO_SURFACE)
+		egl.eglDestroySurface(display, surface);
+	surface = new_surface;
+	size = new_size;
+}
+
+EGLContext OpenGLHeadlessWindowProvider::get_share_context()
+{
+	// Textures and buffers are shared between all graphic contexts, like the contexts of the other window providers
+	std::unique_ptr<std::unique_lock<std::recursive_mutex>> mutex_section;
+	GL3GraphicContextProvider *gl_provider = dynamic_cast<GL3GraphicContextProvider*>(SharedGCData::get_provider(mutex_section));
+	if (!gl_provider)
+		return EGL_NO_CONTEXT;
+
+	const OpenGLHeadlessWindowProvider *render_window = dynamic_cast<const OpenGLHeadlessWindowProvider*>(&gl_provider->get_render_window());
+	if (!render_window || render_window->display != display)
+		return EGL_NO_CONTEXT;
+	return render_window->context;
+}
+
+EGLContext OpenGLHeadlessWindowProvider::create_context(int major_version, int minor_version, EGLContext share_context)
+{
+	std::vector<EGLint> attribs;
+	attribs.push_back(EGL_CONTEXT_MAJOR_VERSION);
+	attribs.push_back(major_version);
+	attribs.push_back(EGL_CONTEXT_MINOR_VERSION);
+	attribs.push_back(minor_version);
+
+	// Profiles only exist from OpenGL 3.2
+	if (major_version > 3 || (major_version == 3 && minor_version >= 2))
+	{
+		attribs.push_back(EGL_CONTEXT_OPENGL_PROFILE_MASK);
+		if (opengl_desc.get_compatibility_profile())
+			attribs.push_back(EGL_CONTEXT_OPENGL_COMPATIBILITY_PROFILE_BIT);
+		else
+			attribs.push_back(EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT);
+	}
+
+	if (egl_version_major > 1 || (egl_version_major == 1 && egl_version_minor >= 5))
+	{
+		if (opengl_desc.get_debug())
+		{
+			attribs.push_back(EGL_CONTEXT_OPENGL_DEBUG);
+			attribs.push_back(EGL_TRUE);
+		}
+		if (opengl_desc.get_forward_compatible())
+		{
+			attribs.push_back(EGL_CONTEXT_OPENGL_FORWARD_COMPATIBLE);
+			attribs.push_back(EGL_TRUE);
+		}
+	}
+	else
+	{
+		EGLint flags = 0;
+		if (opengl_desc.get_debug())
+			flags |= EGL_CONTEXT_OPENGL_DEBUG_BIT_KHR;
+		if (opengl_desc.get_forward_compatible())
+			flags |= EGL_CONTEXT_OPENGL_FORWARD_COMPATIBLE_BIT_KHR;
+		if (flags)
+		{
+			attribs.push_back(EGL_CONTEXT_FLAGS_KHR);
+			attribs.push_back(flags);
+		}
+	}
+	attribs.push_back(EGL_NONE);
+
+	EGLContext new_context = egl.eglCreateContext(display, config, share_context, attribs.data());
+	if (new_context == EGL_NO_CONTEXT)
+		egl.eglGetError();	// Clear the error before trying the next version
+	return new_context;
+}
+
+void OpenGLHeadlessWindowProvider::get_opengl_version(int &version_major, int &version_minor)
+{
+	version_major = 0;
+	version_minor = 0;
+
+	// libGL may not be loaded at all on a headless server, so the entry point comes from EGL
+	typedef const GLubyte *(GLFUNC *ptr_glGetString)(GLenum name);
+	ptr_glGetString get_string = (ptr_glGetString) get_proc_address("glGetString");
+	if (!get_string)
+		return;
+
+	const char *version = (const char *) get_string(GL_VERSION);
+	if (!version)
+		return;
+
+	std::vector<std::string> split_version = StringHelp::split_text(version, ".");
+	if(split_version.size() > 0)
+		version_major = StringHelp::text_to_int(split_version[0]);
+	if(split_version.size() > 1)
+		version_minor = StringHelp::text_to_int(split_version[1]);
+}
+
+bool OpenGLHeadlessWindowProvider::is_egl_extension_supported(const char *ext_name) const
+{
+	return cl_is_egl_extension_in_list(egl.eglQueryString(display, EGL_EXTENSIONS), ext_name);
+}
+
+}
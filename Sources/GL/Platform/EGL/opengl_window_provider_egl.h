@@ -0,0 +1,237 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include "API/Display/TargetProviders/display_window_provider.h"
+#include "API/Display/Render/graphic_context.h"
+#include "API/Display/Window/input_device.h"
+#include "API/Display/Image/pixel_buffer.h"
+#include "API/GL/opengl_context_description.h"
+#include "GL/opengl_display_window_provider.h"
+
+// Headless rendering must not pull in Xlib through eglplatform.h
+#ifndef EGL_NO_X11
+#define EGL_NO_X11
+#endif
+#ifndef MESA_EGL_NO_X11_HEADERS
+#define MESA_EGL_NO_X11_HEADERS
+#endif
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+namespace clan
+{
+
+class GL_EGLFunctions
+{
+public:
+	typedef void (*(EGLAPIENTRY *ptr_eglGetProcAddress)(const char *procname))(void);
+	typedef EGLint (EGLAPIENTRY *ptr_eglGetError)(void);
+	typedef const char *(EGLAPIENTRY *ptr_eglQueryString)(EGLDisplay dpy, EGLint name);
+	typedef EGLDisplay (EGLAPIENTRY *ptr_eglGetDisplay)(EGLNativeDisplayType display_id);
+	typedef EGLBoolean (EGLAPIENTRY *ptr_eglInitialize)(EGLDisplay dpy, EGLint *major, EGLint *minor);
+	typedef EGLBoolean (EGLAPIENTRY *ptr_eglTerminate)(EGLDisplay dpy);
+	typedef EGLBoolean (EGLAPIENTRY *ptr_eglBindAPI)(EGLenum api);
+	typedef EGLBoolean (EGLAPIENTRY *ptr_eglChooseConfig)(EGLDisplay dpy, const EGLint *attrib_list, EGLConfig *configs, EGLint config_size, EGLint *num_config);
+	typedef EGLContext (EGLAPIENTRY *ptr_eglCreateContext)(EGLDisplay dpy, EGLConfig config, EGLContext share_context, const EGLint *attrib_list);
+	typedef EGLBoolean (EGLAPIENTRY *ptr_eglDestroyContext)(EGLDisplay dpy, EGLContext ctx);
+	typedef EGLSurface (EGLAPIENTRY *ptr_eglCreatePbufferSurface)(EGLDisplay dpy, EGLConfig config, const EGLint *attrib_list);
+	typedef EGLBoolean (EGLAPIENTRY *ptr_eglDestroySurface)(EGLDisplay dpy, EGLSurface surface);
+	typedef EGLBoolean (EGLAPIENTRY *ptr_eglMakeCurrent)(EGLDisplay dpy, EGLSurface draw, EGLSurface read, EGLContext ctx);
+	typedef EGLContext (EGLAPIENTRY *ptr_eglGetCurrentContext)(void);
+
+	typedef EGLBoolean (EGLAPIENTRY *ptr_eglQueryDevicesEXT)(EGLint max_devices, EGLDeviceEXT *devices, EGLint *num_devices);
+	typedef EGLDisplay (EGLAPIENTRY *ptr_eglGetPlatformDisplayEXT)(EGLenum platform, void *native_display, const EGLint *attrib_list);
+	typedef const char *(EGLAPIENTRY *ptr_eglQueryDeviceStringEXT)(EGLDeviceEXT device, EGLint name);
+
+public:
+	ptr_eglGetProcAddress eglGetProcAddress = nullptr;
+	ptr_eglGetError eglGetError = nullptr;
+	ptr_eglQueryString eglQueryString = nullptr;
+	ptr_eglGetDisplay eglGetDisplay = nullptr;
+	ptr_eglInitialize eglInitialize = nullptr;
+	ptr_eglTerminate eglTerminate = nullptr;
+	ptr_eglBindAPI eglBindAPI = nullptr;
+	ptr_eglChooseConfig eglChooseConfig = nullptr;
+	ptr_eglCreateContext eglCreateContext = nullptr;
+	ptr_eglDestroyContext eglDestroyContext = nullptr;
+	ptr_eglCreatePbufferSurface eglCreatePbufferSurface = nullptr;
+	ptr_eglDestroySurface eglDestroySurface = nullptr;
+	ptr_eglMakeCurrent eglMakeCurrent = nullptr;
+	ptr_eglGetCurrentContext eglGetCurrentContext = nullptr;
+
+	ptr_eglQueryDevicesEXT eglQueryDevicesEXT = nullptr;	// Null if EGL_EXT_device_enumeration is missing
+	ptr_eglGetPlatformDisplayEXT eglGetPlatformDisplayEXT = nullptr;	// Null if EGL_EXT_platform_device is missing
+	ptr_eglQueryDeviceStringEXT eglQueryDeviceStringEXT = nullptr;	// Null if EGL_EXT_device_query is missing
+
+	/// \brief Loads libEGL and the client extension entry points. Returns false if unavailable
+	bool load();
+
+	/// \brief Returns the EGL devices, or an empty list if they cannot be enumerated
+	std::vector<EGLDeviceEXT> query_devices() const;
+
+	/// \brief Returns true if the device is a CPU rasterizer (EGL_MESA_device_software)
+	bool is_software_device(EGLDeviceEXT device) const;
+};
+
+/// \brief Offscreen OpenGL context created through EGL, without any window system
+///
+/// The "window" is a pbuffer of the description size. When the size is zero, or the
+/// EGL device has no pbuffer configs, the context is surfaceless and only renders to
+/// frame buffer objects.
+class OpenGLHeadlessWindowProvider : public OpenGLDisplayWindowProvider
+{
+public:
+	OpenGLHeadlessWindowProvider(OpenGLContextDescription &opengl_desc);
+	~OpenGLHeadlessWindowProvider();
+
+	/// \brief Returns the number of EGL devices usable for headless rendering
+	static int get_device_count();
+
+	/// \brief Returns true if the EGL device at index rasterizes on the CPU
+	static bool is_software_device(int index);
+
+public: // OpenGL-related attributes
+	// EGL pbuffers always render to the back buffer
+	bool is_double_buffered() const override { return true; }
+	bool has_default_frame_buffer() const override { return surface != EGL_NO_SURFACE; }
+
+	EGLDisplay get_display() const { return display; }
+	EGLContext get_context() const { return context; }
+
+	GraphicContext &get_gc() override { return gc; }
+
+	ProcAddress *get_proc_address(const std::string& function_name) const override;
+	void make_current() const override;
+	bool make_current_on_surface_of(const OpenGLDisplayWindowProvider &window) const override;
+
+public: // Window attributes
+	DisplayWindowHandle get_handle() const override { return DisplayWindowHandle(); }
+
+	float get_pixel_ratio() const override { return pixel_ratio; }
+
+	Rect get_geometry() const override { return Rect(Point(), size); }
+	Rect get_viewport() const override { return Rect(Point(), size); }
+
+	Size get_minimum_size(bool client_area) const override { return Size(); }
+	Size get_maximum_size(bool client_area) const override { return Size(); }
+
+	std::string get_title() const override { return title; }
+
+	bool has_focus() const override { return false; }
+	bool is_fullscreen() const override { return false; }
+	bool is_minimized() const override { return false; }
+	bool is_maximized() const override { return false; }
+	bool is_visible() const override { return false; }
+
+	InputDevice &get_keyboard() override;
+	InputDevice &get_mouse() override;
+	std::vector<InputDevice> &get_game_controllers() override;
+
+	bool is_clipboard_text_available() const override { return false; }
+	bool is_clipboard_image_available() const override { return false; }
+
+	std::string get_clipboard_text() const override { return std::string(); }
+	PixelBuffer get_clipboard_image() const override { return PixelBuffer(); }
+
+public: // Operations
+	void create(DisplayWindowSite *site, const DisplayWindowDescription &description) override;
+
+	/// \brief Recreates the pbuffer with the new size
+	void set_size(int width, int height, bool client_area) override;
+	void set_position(const Rect &pos, bool client_area) override { set_size(pos.get_width(), pos.get_height(), client_area); }
+
+	void set_pixel_ratio(float ratio) override { pixel_ratio = ratio; }
+	void set_title(const std::string &new_title) override { title = new_title; }
+
+	void set_minimum_size(int width, int height, bool client_area) override { }
+	void set_maximum_size(int width, int height, bool client_area) override { }
+	void set_enabled(bool enable) override { }
+	void minimize() override { }
+	void restore() override { }
+	void maximize() override { }
+	void toggle_fullscreen() override { }
+	void show(bool activate) override { }
+	void hide() override { }
+	void bring_to_front() override { }
+	void request_repaint() override { }
+	void capture_mouse(bool capture) override { }
+
+	Point client_to_screen(const Point &client) override { return client; }
+	Point screen_to_client(const Point &screen) override { return screen; }
+
+	void show_system_cursor() override { }
+	void hide_system_cursor() override { }
+	CursorProvider *create_cursor(const CursorDescription &cursor_description) override;
+	void set_cursor(CursorProvider *cursor) override { }
+	void set_cursor(StandardCursor type) override { }
+
+	void set_clipboard_text(const std::string &text) override { }
+	void set_clipboard_image(const PixelBuffer &buf) override { }
+
+	void set_large_icon(const PixelBuffer &image) override { }
+	void set_small_icon(const PixelBuffer &image) override { }
+
+	void enable_alpha_channel(const Rect &blur_rect) override { }
+	void extend_frame_into_client_area(int left, int top, int right, int bottom) override { }
+
+	/// \brief Submits the queued commands. There is nothing to present
+	void flip(int interval) override;
+	void flip(const std::vector<Rect> &damage, int interval) override { flip(interval); }
+
+private:
+	EGLDisplay open_display();
+	bool choose_config(const DisplayWindowDescription &desc, EGLint surface_type);
+	void create_surface(const Size &new_size);
+	EGLContext get_share_context();
+	EGLContext create_context(int major_version, int minor_version, EGLContext share_context);
+	void get_opengl_version(int &version_major, int &version_minor);
+	bool is_egl_extension_supported(const char *ext_name) const;
+
+	GL_EGLFunctions egl;
+
+	GraphicContext gc;
+	DisplayWindowSite *site = nullptr;
+	OpenGLContextDescription opengl_desc;
+
+	EGLDisplay display = EGL_NO_DISPLAY;
+	EGLConfig config = nullptr;
+	bool pbuffer_supported = false;
+	EGLSurface surface = EGL_NO_SURFACE;
+	EGLContext context = EGL_NO_CONTEXT;
+	int egl_version_major = 0;
+	int egl_version_minor = 0;
+
+	Size size;
+	float pixel_ratio = 1.0f;
+	std::string title;
+};
+
+}
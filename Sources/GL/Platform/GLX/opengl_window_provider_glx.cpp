@@ -32,6 +32,7 @@
 #include "GL/precomp.h"
 #include "opengl_window_provider_glx.h"
 #include "API/Core/Math/rect.h"
+#include "API/Core/System/system.h"
 #include "API/Core/Text/logger.h"
 #include "API/Display/Window/display_window_description.h"
 #include "API/Display/display_target.h"
@@ -173,6 +174,9 @@ OpenGLWindowProvider::~OpenGLWindowProvider()
 	{
 		if (!gc.is_null())
 		{
+			OpenGL::set_active(gc);
+			frame_pacer.clear();
+
 			if (using_gl3)
 			{
 				GL3GraphicContextProvider *gl_provider = dynamic_cast<GL3GraphicContextProvider*>(gc.get_provider());
@@ -225,6 +229,32 @@ void OpenGLWindowProvider::make_current() const
 	glx.glXMakeCurrent(x11_window.get_handle().display, x11_window.get_handle().window, opengl_context);
 }
 
+bool OpenGLWindowProvider::make_current_on_surface_of(const OpenGLDisplayWindowProvider &window) const
+{
+	const OpenGLWindowProvider *other = dynamic_cast<const OpenGLWindowProvider *>(&window);
+	if (!other || !glx_1_3 || !other->glx_1_3 || !glx.glXGetFBConfigAttrib)
+		return false;
+
+	::Display *disp = x11_window.get_handle().display;
+	if (other->x11_window.get_handle().display != disp)
+		return false;
+
+	// A context can only be made current on drawables created with a compatible frame buffer configuration
+	int config_id = 0;
+	int other_config_id = 0;
+	glx.glXGetFBConfigAttrib(disp, fbconfig, GLX_FBCONFIG_ID, &config_id);
+	glx.glXGetFBConfigAttrib(disp, other->fbconfig, GLX_FBCONFIG_ID, &other_config_id);
+	if (config_id != other_config_id)
+		return false;
+
+	return glx.glXMakeCurrent(disp, other->x11_window.get_handle().window, opengl_context) == True;
+}
+
+void OpenGLWindowProvider::swap_surface_buffers()
+{
+	glx.glXSwapBuffers(x11_window.get_handle().display, x11_window.get_handle().window);
+}
+
 void OpenGLWindowProvider::create(DisplayWindowSite *new_site, const DisplayWindowDescription &desc)
 {
 	site = new_site;
@@ -311,19 +341,7 @@ void OpenGLWindowProvider::create(DisplayWindowSite *new_site, const DisplayWind
 	setup_extension_pointers();
 	swap_interval = desc.get_swap_interval();
 	if (swap_interval != -1)
-	{
-		if (glXSwapIntervalEXT)
-		{
-			glXSwapIntervalEXT(disp, x11_window.get_handle().window, swap_interval);
-		}else if (glXSwapIntervalSGI)
-		{
-			glXSwapIntervalSGI(swap_interval);
-		}
-		else if (glXSwapIntervalMESA)
-		{
-			glXSwapIntervalMESA(swap_interval);
-		}
-	}
+		apply_swap_interval();
 }
 
 void OpenGLWindowProvider::get_opengl_version(int &version_major, int &version_minor)
@@ -601,11 +619,30 @@ bool OpenGLWindowProvider::is_glx_extension_supported(const char *ext_name)
 	return false;
 }
 
+void OpenGLWindowProvider::apply_swap_interval()
+{
+	if (glXSwapIntervalEXT)
+	{
+		// GLX_EXT_swap_control_tear uses negative intervals for adaptive vsync
+		int interval = (adaptive_vsync && swap_interval > 0) ? -swap_interval : swap_interval;
+		glXSwapIntervalEXT(x11_window.get_handle().display, x11_window.get_handle().window, interval);
+	}
+	else if (glXSwapIntervalSGI)
+	{
+		glXSwapIntervalSGI(swap_interval);
+	}
+	else if (glXSwapIntervalMESA)
+	{
+		glXSwapIntervalMESA(swap_interval);
+	}
+}
+
 void OpenGLWindowProvider::setup_extension_pointers()
 {
 	glXSwapIntervalSGI = (ptr_glXSwapIntervalSGI) OpenGL::get_proc_address("glXSwapIntervalSGI");
 	glXSwapIntervalMESA = (ptr_glXSwapIntervalMESA) OpenGL::get_proc_address("glXSwapIntervalMESA");
 	glXSwapIntervalEXT = (ptr_glXSwapIntervalEXT) OpenGL::get_proc_address("glXSwapIntervalEXT");
+	glXCopySubBufferMESA = (ptr_glXCopySubBufferMESA) OpenGL::get_proc_address("glXCopySubBufferMESA");
 
 	// See - http://dri.freedesktop.org/wiki/glXGetProcAddressNeverReturnsNULL ,get_proc_address() may return an invalid extension address
 
@@ -624,6 +661,13 @@ void OpenGLWindowProvider::setup_extension_pointers()
 		glXSwapIntervalMESA = nullptr;
 	}
 
+	if ( !is_glx_extension_supported("GLX_MESA_copy_sub_buffer") )
+	{
+		glXCopySubBufferMESA = nullptr;
+	}
+
+	swap_control_tear = glXSwapIntervalEXT && is_glx_extension_supported("GLX_EXT_swap_control_tear");
+
 	glx.glXCreatePbufferSGIX = (GL_GLXFunctions::ptr_glXCreatePbufferSGIX) OpenGL::get_proc_address("glXCreateGLXPbufferSGIX");
 	glx.glXDestroyPbufferSGIX = (GL_GLXFunctions::ptr_glXDestroyPbuffer) OpenGL::get_proc_address("glXDestroyGLXPbufferSGIX");
 	glx.glXChooseFBConfigSGIX = (GL_GLXFunctions::ptr_glXChooseFBConfig) OpenGL::get_proc_address("glXChooseFBConfigSGIX");
@@ -678,6 +722,7 @@ GLXContext OpenGLWindowProvider::create_context(const DisplayWindowDescription &
 	}
 
 	GLXContext context;
+	uint64_t start_time = System::get_microseconds();
 
 	if (glx_1_3)
 	{
@@ -688,6 +733,7 @@ GLXContext OpenGLWindowProvider::create_context(const DisplayWindowDescription &
 		context = create_context_glx_1_2(desc, shared_context);
 	}
 
+	cl_record_context_creation(System::get_microseconds() - start_time);
 	return context;
 }
 
@@ -739,12 +785,6 @@ GLXContext OpenGLWindowProvider::create_context_glx_1_3_helper(GLXContext shared
 
 GLXContext OpenGLWindowProvider::create_context_glx_1_3(const DisplayWindowDescription &desc, GLXContext shared_context)
 {
-	GLXContext context;
-
-	context = glx.glXCreateNewContext(x11_window.get_handle().display, fbconfig, GLX_RGBA_TYPE, shared_context, True);
-	if(context == nullptr)
-		throw Exception("glXCreateContext failed");
-
 	ptr_glXCreateContextAttribs glXCreateContextAttribs = nullptr;
 
 	if (is_glx_extension_supported("GLX_ARB_create_context"))
@@ -811,7 +851,7 @@ GLXContext OpenGLWindowProvider::create_context_glx_1_3(const DisplayWindowDescr
 						continue;
 				}
 
-				context_gl3 = create_context_glx_1_3_helper(shared_context, gl_major, gl_minor, desc, glXCreateContextAttribs);
+				context_gl3 = create_context_glx_1_3_helper(shared_context, major, minor, desc, glXCreateContextAttribs);
 
 			}while(!context_gl3);
 		}
@@ -820,11 +860,14 @@ GLXContext OpenGLWindowProvider::create_context_glx_1_3(const DisplayWindowDescr
 		XSetErrorHandler( oldHandler );
 
 		if (context_gl3)
-		{
-			glx.glXDestroyContext(x11_window.get_handle().display, context);
-			context = context_gl3;
-		}
+			return context_gl3;
 	}
+
+	// Only create a legacy context when a versioned one is unavailable, as creating a context is expensive
+	GLXContext context = glx.glXCreateNewContext(x11_window.get_handle().display, fbconfig, GLX_RGBA_TYPE, shared_context, True);
+	if(context == nullptr)
+		throw Exception("glXCreateContext failed");
+
 	return context;
 }
 
@@ -850,24 +893,56 @@ void OpenGLWindowProvider::flip(int interval)
 	if (interval != -1 && interval != swap_interval)
 	{
 		swap_interval = interval;
-		if (glXSwapIntervalEXT)
-		{
-			glXSwapIntervalEXT(x11_window.get_handle().display, x11_window.get_handle().window, swap_interval);
-		}
-		else if (glXSwapIntervalSGI)
-		{
-			glXSwapIntervalSGI(swap_interval);
-		}
-		else if (glXSwapIntervalMESA)
-		{
-			glXSwapIntervalMESA(swap_interval);
-		}
+		apply_swap_interval();
 	}
 
 	glx.glXSwapBuffers(x11_window.get_handle().display, x11_window.get_handle().window);
+	frame_pacer.frame_flipped();
+	OpenGL::check_error();
+}
+
+void OpenGLWindowProvider::flip(const std::vector<Rect> &damage, int interval)
+{
+	if (!glXCopySubBufferMESA)
+	{
+		flip(interval);
+		return;
+	}
+
+	GraphicContext gc = get_gc();
+	OpenGL::set_active(gc);
+	glFlush();
+
+	// Copying leaves the back buffer intact, so the next frame only needs to redraw its own damage
+	int height = get_viewport().get_height();
+	for (const auto &rect : damage)
+	{
+		glXCopySubBufferMESA(x11_window.get_handle().display, x11_window.get_handle().window, rect.left, height - rect.bottom, rect.get_width(), rect.get_height());
+	}
+	frame_pacer.frame_flipped();
 	OpenGL::check_error();
 }
 
+bool OpenGLWindowProvider::set_adaptive_vsync(bool enable)
+{
+	if (!swap_control_tear)
+		return !enable;
+
+	adaptive_vsync = enable;
+	if (swap_interval > 0)
+	{
+		OpenGL::set_active(get_gc());
+		apply_swap_interval();
+	}
+	return true;
+}
+
+void OpenGLWindowProvider::wait_for_frame_slot()
+{
+	OpenGL::set_active(get_gc());
+	frame_pacer.wait_for_frame_slot();
+}
+
 void OpenGLWindowProvider::set_cursor(CursorProvider *cursor)
 {
 	// x11_window.set_cursor(static_cast<CursorProvider_X11 *>(cursor));
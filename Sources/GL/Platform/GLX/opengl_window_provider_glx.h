@@ -35,6 +35,8 @@
 #include "Display/Platform/X11/x11_window.h"
 #include "API/Display/Image/pixel_buffer.h"
 #include "API/GL/opengl_context_description.h"
+#include "GL/opengl_frame_pacer.h"
+#include "GL/opengl_display_window_provider.h"
 
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
@@ -52,6 +54,7 @@ namespace clan
 typedef int (*ptr_glXSwapIntervalSGI)(int interval);
 typedef int (*ptr_glXSwapIntervalMESA)(int interval);
 typedef void (*ptr_glXSwapIntervalEXT)(::Display *dptr, GLXDrawable drawable, int interval);
+typedef void (*ptr_glXCopySubBufferMESA)(::Display *dpy, GLXDrawable drawable, int x, int y, int width, int height);
 typedef GLXContext (*ptr_glXCreateContextAttribs)(::Display *dpy, GLXFBConfig config, GLXContext share_list, Bool direct, const int *attrib_list);
 
 class OpenGLWindowProvider;
@@ -160,14 +163,14 @@ public:
 
 };
 
-class OpenGLWindowProvider : public DisplayWindowProvider
+class OpenGLWindowProvider : public OpenGLDisplayWindowProvider
 {
 public:
 	OpenGLWindowProvider(OpenGLContextDescription &opengl_desc);
 	~OpenGLWindowProvider();
 
 public: // OpenGL-related attributes
-	constexpr static bool is_double_buffered() { return true; }
+	bool is_double_buffered() const override { return true; }
 
 	//! Retrieves the GLX rendering context for this window.
 	GLXContext get_opengl_context() { return opengl_context; }
@@ -211,9 +214,11 @@ public: // X11Window-related attributes (mirror)
 	PixelBuffer get_clipboard_image() const override { return x11_window.get_clipboard_image(); }
 
 public: // ?
-	ProcAddress *get_proc_address(const std::string& function_name) const;
+	ProcAddress *get_proc_address(const std::string& function_name) const override;
 
-	void make_current() const;
+	void make_current() const override;
+	bool make_current_on_surface_of(const OpenGLDisplayWindowProvider &window) const override;
+	void swap_surface_buffers() override;
 
 	void create(DisplayWindowSite *site, const DisplayWindowDescription &description) override;
 	// void destroy() { delete this; }
@@ -279,6 +284,12 @@ public: // X11Window-related const operations
 public: // Other DisplayWindow operations
 	//! Flip OpenGL buffers.
 	void flip(int interval) override;
+	void flip(const std::vector<Rect> &damage, int interval) override;
+
+	void set_max_frame_latency(int frames) override { frame_pacer.set_max_frame_latency(frames); }
+	bool set_adaptive_vsync(bool enable) override;
+	void wait_for_frame_slot() override;
+	FrameTiming get_frame_timing() const override { return frame_pacer.get_frame_timing(); }
 
 	//! Process window messages
 	void process_messages();
@@ -309,6 +320,7 @@ private: // Implementation
 	bool is_glx_extension_supported(const char *ext_name);
 
 	void setup_extension_pointers();
+	void apply_swap_interval();
 
 	X11Window x11_window;
 
@@ -326,7 +338,12 @@ private: // Implementation
 	ptr_glXSwapIntervalSGI glXSwapIntervalSGI;
 	ptr_glXSwapIntervalMESA glXSwapIntervalMESA;
 	ptr_glXSwapIntervalEXT glXSwapIntervalEXT = nullptr;
+	ptr_glXCopySubBufferMESA glXCopySubBufferMESA = nullptr;
 	int swap_interval;
+	bool swap_control_tear = false;
+	bool adaptive_vsync = false;
+
+	OpenGLFramePacer frame_pacer;
 
 	GLXFBConfig fbconfig;
 
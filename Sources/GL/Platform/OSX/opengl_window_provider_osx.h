@@ -33,6 +33,7 @@
 #include "API/Display/Window/input_device.h"
 #include "API/GL/opengl_context_description.h"
 #include "API/GL/opengl_wrap.h"
+#include "GL/opengl_display_window_provider.h"
 #include <memory>
 
 namespace clan
@@ -42,7 +43,7 @@ namespace clan
 	class OpenGLContextDescription;
 	class OpenGLWindowProvider_Impl;
 
-	class OpenGLWindowProvider : public DisplayWindowProvider
+	class OpenGLWindowProvider : public OpenGLDisplayWindowProvider
 	{
 	public:
 		OpenGLWindowProvider(OpenGLContextDescription &opengl_desc);
@@ -69,9 +70,9 @@ namespace clan
 		PixelBuffer get_clipboard_image() const override;
 		float get_pixel_ratio() const override;
 
-		bool is_double_buffered() const;
+		bool is_double_buffered() const override;
 		
-		void make_current() const;
+		void make_current() const override;
 		
 		Point client_to_screen(const Point &client) override;
 		Point screen_to_client(const Point &screen) override;
@@ -96,6 +97,7 @@ namespace clan
 		void hide() override;
 		void bring_to_front() override;
 		void flip(int interval) override;
+		void flip(const std::vector<Rect> &damage, int interval) override;
 		void capture_mouse(bool capture) override;
 		void set_clipboard_text(const std::string &text) override;
 		void set_clipboard_image(const PixelBuffer &buf) override;
@@ -106,7 +108,7 @@ namespace clan
 		void enable_alpha_channel(const Rect &blur_rect) override;
 		void extend_frame_into_client_area(int left, int top, int right, int bottom) override;
 
-		ProcAddress *get_proc_address(const std::string& function_name) const;
+		ProcAddress *get_proc_address(const std::string& function_name) const override;
 		
 		void set_pixel_ratio(float ratio) override;
 		
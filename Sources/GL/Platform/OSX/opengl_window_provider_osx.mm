@@ -405,6 +405,11 @@ namespace clan
 		[impl->opengl_context flushBuffer];
 	}
 
+	void OpenGLWindowProvider::flip(const std::vector<Rect> &damage, int interval)
+	{
+		flip(interval);
+	}
+
 	void OpenGLWindowProvider::capture_mouse(bool capture)
 	{
 	}
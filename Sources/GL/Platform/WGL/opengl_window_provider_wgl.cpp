@@ -32,6 +32,7 @@
 #include "GL/precomp.h"
 #include "opengl_window_provider_wgl.h"
 #include "API/Core/Math/rect.h"
+#include "API/Core/System/system.h"
 #include "API/Display/Window/display_window_description.h"
 #include "API/Display/display_target.h"
 #include "API/Display/TargetProviders/display_window_provider.h"
@@ -41,6 +42,7 @@
 #include "API/GL/opengl_wrap.h"
 #include "API/GL/opengl_context_description.h"
 #include "API/Core/Text/logger.h"
+#include "API/Core/Text/string_help.h"
 #include "Display/Platform/Win32/cursor_provider_win32.h"
 #include "Display/Platform/Win32/dwm_functions.h"
 #include "../../opengl_context_description_impl.h"
@@ -65,6 +67,9 @@ namespace clan
 		{
 			if (!gc.is_null())
 			{
+				OpenGL::set_active(gc);
+				frame_pacer.clear();
+
 				if (using_gl3)
 				{
 					GL3GraphicContextProvider *gl_provider = dynamic_cast<GL3GraphicContextProvider*>(gc.get_provider());
@@ -179,6 +184,24 @@ namespace clan
 		wglMakeCurrent(device_context, opengl_context);
 	}
 
+	bool OpenGLWindowProvider::make_current_on_surface_of(const OpenGLDisplayWindowProvider &window) const
+	{
+		const OpenGLWindowProvider *other = dynamic_cast<const OpenGLWindowProvider *>(&window);
+		if (!other || !other->device_context)
+			return false;
+
+		// A rendering context can only be made current on device contexts with the same pixel format
+		if (GetPixelFormat(device_context) != GetPixelFormat(other->device_context))
+			return false;
+
+		return wglMakeCurrent(other->device_context, opengl_context) == TRUE;
+	}
+
+	void OpenGLWindowProvider::swap_surface_buffers()
+	{
+		SwapBuffers(device_context);
+	}
+
 	Point OpenGLWindowProvider::client_to_screen(const Point &client)
 	{
 		return win32_window.client_to_screen(client);
@@ -242,6 +265,8 @@ namespace clan
 
 			HGLRC share_context = get_share_context();
 
+			uint64_t start_time = System::get_microseconds();
+
 			OpenGLCreationHelper helper(handle, device_context);
 			helper.set_multisampling_pixel_format(desc);
 
@@ -300,6 +325,8 @@ namespace clan
 
 			}
 
+			cl_record_context_creation(System::get_microseconds() - start_time);
+
 			bool use_gl3;
 			int desc_version_major = opengl_desc.get_version_major();
 			int desc_version_minor = opengl_desc.get_version_minor();
@@ -343,9 +370,17 @@ namespace clan
 		}
 
 		wglSwapIntervalEXT = (ptr_wglSwapIntervalEXT)OpenGL::get_proc_address("wglSwapIntervalEXT");
+
+		ptr_wglGetExtensionsStringEXT wglGetExtensionsStringEXT = (ptr_wglGetExtensionsStringEXT)OpenGL::get_proc_address("wglGetExtensionsStringEXT");
+		if (wglSwapIntervalEXT && wglGetExtensionsStringEXT)
+		{
+			std::vector<std::string> extensions = StringHelp::split_text(wglGetExtensionsStringEXT(), " ");
+			swap_control_tear = std::find(extensions.begin(), extensions.end(), "WGL_EXT_swap_control_tear") != extensions.end();
+		}
+
 		swap_interval = desc.get_swap_interval();
-		if (wglSwapIntervalEXT && swap_interval != -1)
-			wglSwapIntervalEXT(swap_interval);
+		if (swap_interval != -1)
+			apply_swap_interval();
 	}
 
 	void OpenGLWindowProvider::get_opengl_version(int &version_major, int &version_minor)
@@ -569,11 +604,11 @@ namespace clan
 			if (interval != -1 && interval != swap_interval)
 			{
 				swap_interval = interval;
-				if (wglSwapIntervalEXT)
-					wglSwapIntervalEXT(swap_interval);
+				apply_swap_interval();
 			}
 
 			BOOL retval = SwapBuffers(get_device_context());
+			frame_pacer.frame_flipped();
 
 			if (dwm_layered)
 			{
@@ -600,6 +635,38 @@ namespace clan
 		OpenGL::check_error();
 	}
 
+	void OpenGLWindowProvider::flip(const std::vector<Rect> &damage, int interval)
+	{
+		flip(interval);
+	}
+
+	bool OpenGLWindowProvider::set_adaptive_vsync(bool enable)
+	{
+		if (!swap_control_tear)
+			return !enable;
+
+		adaptive_vsync = enable;
+		if (swap_interval > 0)
+		{
+			OpenGL::set_active(get_gc());
+			apply_swap_interval();
+		}
+		return true;
+	}
+
+	void OpenGLWindowProvider::wait_for_frame_slot()
+	{
+		OpenGL::set_active(get_gc());
+		frame_pacer.wait_for_frame_slot();
+	}
+
+	void OpenGLWindowProvider::apply_swap_interval()
+	{
+		// WGL_EXT_swap_control_tear uses negative intervals for adaptive vsync
+		if (wglSwapIntervalEXT)
+			wglSwapIntervalEXT((adaptive_vsync && swap_interval > 0) ? -swap_interval : swap_interval);
+	}
+
 	void OpenGLWindowProvider::capture_mouse(bool capture)
 	{
 		win32_window.capture_mouse(capture);
@@ -37,14 +37,17 @@
 #include <memory>
 #include "API/GL/opengl_context_description.h"
 #include "API/GL/opengl_wrap.h"
+#include "GL/opengl_frame_pacer.h"
+#include "GL/opengl_display_window_provider.h"
 
 namespace clan
 {
 	typedef BOOL(APIENTRY *ptr_wglSwapIntervalEXT)(int interval);
+	typedef const char *(APIENTRY *ptr_wglGetExtensionsStringEXT)();
 
 	class OpenGLContextDescription;
 
-	class OpenGLWindowProvider : public DisplayWindowProvider
+	class OpenGLWindowProvider : public OpenGLDisplayWindowProvider
 	{
 	public:
 		OpenGLWindowProvider(OpenGLContextDescription &opengl_desc);
@@ -75,6 +78,8 @@ namespace clan
 		float get_pixel_ratio() const override;
 
 		void make_current() const;
+		bool make_current_on_surface_of(const OpenGLDisplayWindowProvider &window) const override;
+		void swap_surface_buffers() override;
 		Point client_to_screen(const Point &client);
 		Point screen_to_client(const Point &screen);
 		void create(DisplayWindowSite *site, const DisplayWindowDescription &description);
@@ -102,6 +107,12 @@ namespace clan
 
 		/// \brief Flip OpenGL buffers.
 		void flip(int interval);
+		void flip(const std::vector<Rect> &damage, int interval);
+
+		void set_max_frame_latency(int frames) override { frame_pacer.set_max_frame_latency(frames); }
+		bool set_adaptive_vsync(bool enable) override;
+		void wait_for_frame_slot() override;
+		FrameTiming get_frame_timing() const override { return frame_pacer.get_frame_timing(); }
 
 		/// \brief Capture/Release the mouse.
 		void capture_mouse(bool capture);
@@ -128,6 +139,7 @@ namespace clan
 		void create_shadow_window(HWND wnd);
 		void on_window_resized();
 		void get_opengl_version(int &version_major, int &version_minor);
+		void apply_swap_interval();
 
 		GraphicContext gc;
 		Win32Window win32_window;
@@ -145,6 +157,10 @@ namespace clan
 
 		ptr_wglSwapIntervalEXT wglSwapIntervalEXT;
 		int swap_interval;
+		bool swap_control_tear = false;
+		bool adaptive_vsync = false;
+
+		OpenGLFramePacer frame_pacer;
 
 		OpenGLContextDescription opengl_desc;
 
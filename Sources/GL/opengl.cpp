@@ -35,6 +35,7 @@
 #include "API/Core/System/exception.h"
 #include "API/Core/IOData/cl_endian.h"
 #include "API/Core/Text/string_format.h"
+#include "API/Core/System/system.h"
 #include "API/Display/Render/graphic_context.h"
 #include "API/Display/Render/texture.h"
 #include "API/Display/TargetProviders/display_window_provider.h"
@@ -43,6 +44,7 @@
 #include "GL3/gl3_graphic_context_provider.h"
 #include "GL3/gl3_texture_provider.h"
 #include <map>
+#include <memory>
 
 #if defined(__IOS__)
 #include <OpenGLES/ES2/gl.h>
@@ -70,14 +72,20 @@ namespace clan
 
 	// A fix for a compiler bug with compiler version 13.00.9466
 	#if _MSC_VER > 1300
-	typedef std::map<const OpenGLGraphicContextProvider * const, GLFunctions *> cl_function_map_type;
+	typedef std::map<const OpenGLGraphicContextProvider * const, std::shared_ptr<GLFunctions>> cl_function_map_type;
 	#else
-	typedef std::map<const OpenGLGraphicContextProvider *, GLFunctions *> cl_function_map_type;
+	typedef std::map<const OpenGLGraphicContextProvider *, std::shared_ptr<GLFunctions>> cl_function_map_type;
 	#endif
 
 	static cl_function_map_type cl_function_map;
 
+	// Function tables keyed by driver (vendor, renderer and version), shared by all contexts using that driver
+	static std::map<std::string, std::weak_ptr<GLFunctions>> cl_driver_function_map;
+
+	static OpenGLSetupTimings cl_setup_timings;
+
 	GLFunctions *cl_setup_binds();
+	static std::string cl_get_driver_key();
 
 
 	void OpenGL::check_error()
@@ -263,6 +271,14 @@ namespace clan
 			case tf_compressed_srgb_alpha_s3tc_dxt1: tf.internal_format = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT; tf.pixel_format = GL_RGBA; tf.pixel_datatype = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT; break;
 			case tf_compressed_srgb_alpha_s3tc_dxt3: tf.internal_format = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT; tf.pixel_format = GL_RGBA; tf.pixel_datatype = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT; break;
 			case tf_compressed_srgb_alpha_s3tc_dxt5: tf.internal_format = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT; tf.pixel_format = GL_RGBA; tf.pixel_datatype = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT; break;
+			case tf_compressed_rgba_bptc_unorm: tf.internal_format = GL_COMPRESSED_RGBA_BPTC_UNORM_ARB; tf.pixel_format = GL_RGBA; tf.pixel_datatype = GL_COMPRESSED_RGBA_BPTC_UNORM_ARB; break;
+			case tf_compressed_srgb_alpha_bptc_unorm: tf.internal_format = GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM_ARB; tf.pixel_format = GL_RGBA; tf.pixel_datatype = GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM_ARB; break;
+			case tf_compressed_rgb8_etc2: tf.internal_format = GL_COMPRESSED_RGB8_ETC2; tf.pixel_format = GL_RGB; tf.pixel_datatype = GL_COMPRESSED_RGB8_ETC2; break;
+			case tf_compressed_srgb8_etc2: tf.internal_format = GL_COMPRESSED_SRGB8_ETC2; tf.pixel_format = GL_RGB; tf.pixel_datatype = GL_COMPRESSED_SRGB8_ETC2; break;
+			case tf_compressed_rgba8_etc2_eac: tf.internal_format = GL_COMPRESSED_RGBA8_ETC2_EAC; tf.pixel_format = GL_RGBA; tf.pixel_datatype = GL_COMPRESSED_RGBA8_ETC2_EAC; break;
+			case tf_compressed_srgb8_alpha8_etc2_eac: tf.internal_format = GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC; tf.pixel_format = GL_RGBA; tf.pixel_datatype = GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC; break;
+			case tf_compressed_rgba_astc_4x4: tf.internal_format = GL_COMPRESSED_RGBA_ASTC_4x4_KHR; tf.pixel_format = GL_RGBA; tf.pixel_datatype = GL_COMPRESSED_RGBA_ASTC_4x4_KHR; break;
+			case tf_compressed_srgb8_alpha8_astc_4x4: tf.internal_format = GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR; tf.pixel_format = GL_RGBA; tf.pixel_datatype = GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR; break;
 	#endif
 			default:
 				tf.valid = false;
@@ -313,6 +329,52 @@ namespace clan
 		return false;
 	}
 
+	static std::shared_ptr<GLFunctions> cl_get_function_table()
+	{
+		std::string driver_key = cl_get_driver_key();
+		if (!driver_key.empty())
+		{
+			auto it = cl_driver_function_map.find(driver_key);
+			if (it != cl_driver_function_map.end())
+			{
+				std::shared_ptr<GLFunctions> functions = it->second.lock();
+				if (functions)
+				{
+					cl_setup_timings.function_tables_shared++;
+					return functions;
+				}
+			}
+		}
+
+		uint64_t start_time = System::get_microseconds();
+		std::shared_ptr<GLFunctions> functions(cl_setup_binds());
+		cl_setup_timings.function_binding_microseconds += System::get_microseconds() - start_time;
+		cl_setup_timings.function_tables_created++;
+
+		if (!driver_key.empty())
+			cl_driver_function_map[driver_key] = functions;
+		return functions;
+	}
+
+	void cl_record_context_creation(uint64_t microseconds)
+	{
+		std::unique_lock<std::recursive_mutex> mutex_lock(cl_function_map_mutex);
+		cl_setup_timings.context_creation_microseconds += microseconds;
+		cl_setup_timings.contexts_created++;
+	}
+
+	OpenGLSetupTimings OpenGL::get_setup_timings()
+	{
+		std::unique_lock<std::recursive_mutex> mutex_lock(cl_function_map_mutex);
+		return cl_setup_timings;
+	}
+
+	void OpenGL::reset_setup_timings()
+	{
+		std::unique_lock<std::recursive_mutex> mutex_lock(cl_function_map_mutex);
+		cl_setup_timings = OpenGLSetupTimings();
+	}
+
 	void OpenGL::set_active(const OpenGLGraphicContextProvider * const gc_provider)
 	{
 		// Don't do anything if the supplied graphic context is already active.
@@ -331,14 +393,14 @@ namespace clan
 				it = cl_function_map.find(gc_provider);
 				if (it != cl_function_map.end())
 				{
-					OpenGL::functions = it->second;
+					OpenGL::functions = it->second.get();
 				}
 				else
 				{
 					cl_active_opengl_gc = gc_provider;
-					GLFunctions *functions = cl_setup_binds();
+					std::shared_ptr<GLFunctions> functions = cl_get_function_table();
 					cl_function_map[gc_provider] = functions;
-					OpenGL::functions = functions;
+					OpenGL::functions = functions.get();
 				}
 			}
 
@@ -373,9 +435,7 @@ namespace clan
 		it = cl_function_map.find(gc_provider);
 		if (it != cl_function_map.end())
 		{
-			GLFunctions *functions = it->second;
 			cl_function_map.erase(it);
-			delete functions;
 
 			if (cl_active_opengl_gc == gc_provider)
 			{
@@ -1206,6 +1266,31 @@ namespace clan
 		return functions;
 	}
 
+	static std::string cl_get_driver_key()
+	{
+		// Must be placed after cl_setup_binds(), where win32 has undefined glGetString to get the static link
+	#ifdef WIN32
+		GLFunctions::ptr_glGetString get_string = (GLFunctions::ptr_glGetString) &glGetString;
+	#else
+		GLFunctions::ptr_glGetString get_string = (GLFunctions::ptr_glGetString) OpenGL::get_proc_address("glGetString");
+	#endif
+		if (!get_string)
+			return std::string();
+
+		const GLubyte *vendor = get_string(GL_VENDOR);
+		const GLubyte *renderer = get_string(GL_RENDERER);
+		const GLubyte *version = get_string(GL_VERSION);
+		if (!vendor || !renderer || !version)
+			return std::string();
+
+		std::string key = (const char *)vendor;
+		key += '\n';
+		key += (const char *)renderer;
+		key += '\n';
+		key += (const char *)version;
+		return key;
+	}
+
 	GLenum OpenGL::to_enum(DrawBuffer buffer)
 	{
 		switch(buffer)
@@ -1297,6 +1382,9 @@ namespace clan
 		case blend_one_minus_constant_color: return GL_ONE_MINUS_CONSTANT_COLOR;
 		case blend_constant_alpha: return GL_CONSTANT_ALPHA;
 		case blend_one_minus_constant_alpha: return GL_ONE_MINUS_CONSTANT_ALPHA;
+		case blend_src1_color: return GL_SRC1_COLOR;
+		case blend_one_minus_src1_color: return GL_ONE_MINUS_SRC1_COLOR;
+		case blend_one_minus_src1_alpha: return GL_ONE_MINUS_SRC1_ALPHA;
 		default: return GL_BLEND_SRC;
 		}
 	}
@@ -1483,4 +1571,20 @@ namespace clan
 		//FIXME For GL1
 		return Texture(new GL3TextureProvider(type, handle));
 	}
+
+	OpenGLStateCounters OpenGL::get_state_counters(GraphicContext &gc)
+	{
+		GL3GraphicContextProvider *gc_provider = dynamic_cast<GL3GraphicContextProvider *>(gc.get_provider());
+		if (gc_provider)
+			return gc_provider->get_state_cache().counters;
+		else
+			return OpenGLStateCounters();
+	}
+
+	void OpenGL::reset_state_counters(GraphicContext &gc)
+	{
+		GL3GraphicContextProvider *gc_provider = dynamic_cast<GL3GraphicContextProvider *>(gc.get_provider());
+		if (gc_provider)
+			gc_provider->get_state_cache().counters = OpenGLStateCounters();
+	}
 }
@@ -78,6 +78,21 @@ namespace clan
 		return impl->layer_plane;
 	}
 
+	bool OpenGLContextDescription::get_headless() const
+	{
+		return impl->headless;
+	}
+
+	int OpenGLContextDescription::get_headless_device() const
+	{
+		return impl->headless_device;
+	}
+
+	bool OpenGLContextDescription::get_headless_software() const
+	{
+		return impl->headless_software;
+	}
+
 	void OpenGLContextDescription::set_version(int major, int minor, bool allow_lower_versions)
 	{
 		impl->version_major = major;
@@ -106,4 +121,19 @@ namespace clan
 	{
 		impl->layer_plane = value;
 	}
+
+	void OpenGLContextDescription::set_headless(bool enable)
+	{
+		impl->headless = enable;
+	}
+
+	void OpenGLContextDescription::set_headless_device(int index)
+	{
+		impl->headless_device = index;
+	}
+
+	void OpenGLContextDescription::set_headless_software(bool enable)
+	{
+		impl->headless_software = enable;
+	}
 }
@@ -45,6 +45,9 @@ namespace clan
 			core_profile_flag = true;
 			compatibility_profile_flag = false;
 			layer_plane = 0;
+			headless = false;
+			headless_device = 0;
+			headless_software = false;
 
 		}
 
@@ -57,5 +60,8 @@ namespace clan
 		bool core_profile_flag;
 		bool compatibility_profile_flag;
 		int layer_plane;
+		bool headless;
+		int headless_device;
+		bool headless_software;
 	};
 }
@@ -0,0 +1,57 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include "API/Display/TargetProviders/display_window_provider.h"
+#include "API/GL/opengl.h"
+
+namespace clan
+{
+	/// \brief Display window provider owning the OpenGL context that a GL3GraphicContextProvider renders with
+	class OpenGLDisplayWindowProvider : public DisplayWindowProvider
+	{
+	public:
+		virtual ProcAddress *get_proc_address(const std::string& function_name) const = 0;
+		virtual void make_current() const = 0;
+		virtual bool is_double_buffered() const = 0;
+
+		/// \brief Returns false for targets such as surfaceless contexts, where frame buffer 0 has no images
+		virtual bool has_default_frame_buffer() const { return true; }
+
+		/// \brief Makes the context of this window current on the surface of another window, so both are drawn without a context switch
+		///
+		/// Returns false if the platform cannot do this or the surfaces have different pixel formats. Call make_current to
+		/// return to the own surface.
+		virtual bool make_current_on_surface_of(const OpenGLDisplayWindowProvider &window) const { return false; }
+
+		/// \brief Presents the surface of this window while the context of another window is current on it
+		virtual void swap_surface_buffers() { }
+	};
+}
@@ -0,0 +1,141 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "GL/precomp.h"
+#include "opengl_frame_pacer.h"
+#include "API/GL/opengl_wrap.h"
+#include "API/Core/System/system.h"
+
+namespace clan
+{
+	void OpenGLFramePacer::frame_flipped()
+	{
+		timing.frames_presented++;
+
+		// Sync objects need OpenGL 3.2 or GL_ARB_sync. Without them only the frame count is tracked.
+		if (glFenceSync)
+		{
+			PendingFrame pending;
+			pending.frame = timing.frames_presented;
+
+			if (glQueryCounter)
+			{
+				// Recalibrate now and then, as the GPU and CPU clocks drift apart
+				if (!clock_calibrated || pending.frame % 1000 == 0)
+					calibrate_gpu_clock();
+
+				glGenQueries(1, &pending.query);
+				glQueryCounter(pending.query, GL_TIMESTAMP);
+			}
+
+			pending.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+			glFlush();
+			pending_frames.push_back(pending);
+		}
+
+		retire_frames(max_frame_latency > 0 ? max_frame_latency : -1);
+	}
+
+	void OpenGLFramePacer::wait_for_frame_slot()
+	{
+		if (max_frame_latency > 0)
+			retire_frames(max_frame_latency - 1);
+	}
+
+	void OpenGLFramePacer::clear()
+	{
+		for (auto &pending : pending_frames)
+			delete_frame(pending);
+		pending_frames.clear();
+		timing.frames_in_flight = 0;
+	}
+
+	void OpenGLFramePacer::retire_frames(int max_pending)
+	{
+		// Completed frames are always retired. Beyond that, wait for the oldest frames until at most max_pending remain.
+		while (!pending_frames.empty())
+		{
+			PendingFrame &oldest = pending_frames.front();
+			bool must_wait = max_pending >= 0 && (int)pending_frames.size() > max_pending;
+
+			GLenum result = glClientWaitSync(oldest.fence, GL_SYNC_FLUSH_COMMANDS_BIT, must_wait ? 1000000000 : 0);
+			if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED)
+				frame_completed(oldest);
+			else if (result != GL_WAIT_FAILED && must_wait)
+				continue;
+			else if (result != GL_WAIT_FAILED)
+				break;
+
+			delete_frame(oldest);
+			pending_frames.pop_front();
+		}
+
+		timing.frames_in_flight = (int)pending_frames.size();
+	}
+
+	void OpenGLFramePacer::frame_completed(const PendingFrame &pending)
+	{
+		uint64_t display_time;
+		if (pending.query)
+		{
+			CLuint64 gpu_time = 0;
+			glGetQueryObjectui64v(pending.query, GL_QUERY_RESULT, &gpu_time);
+			display_time = (uint64_t)(((int64_t)gpu_time + gpu_to_cpu_offset) / 1000);
+		}
+		else
+		{
+			display_time = System::get_microseconds();
+		}
+
+		if (timing.display_time != 0 && display_time > timing.display_time)
+			timing.frame_interval = display_time - timing.display_time;
+
+		timing.display_time = display_time;
+		timing.last_displayed_frame = pending.frame;
+		timing.display_time_exact = false;
+	}
+
+	void OpenGLFramePacer::calibrate_gpu_clock()
+	{
+		CLint64 gpu_now = 0;
+		glGetInteger64v(GL_TIMESTAMP, &gpu_now);
+		gpu_to_cpu_offset = (int64_t)System::get_microseconds() * 1000 - gpu_now;
+		clock_calibrated = true;
+	}
+
+	void OpenGLFramePacer::delete_frame(PendingFrame &pending)
+	{
+		if (pending.fence)
+			glDeleteSync(pending.fence);
+		if (pending.query)
+			glDeleteQueries(1, &pending.query);
+		pending.fence = nullptr;
+		pending.query = 0;
+	}
+}
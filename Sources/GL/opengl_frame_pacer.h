@@ -0,0 +1,78 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include "API/Display/Window/frame_timing.h"
+#include "API/GL/opengl.h"
+#include <deque>
+
+namespace clan
+{
+	/// \brief Frame latency limiting and present timing for OpenGL window providers
+	///
+	/// Every flip inserts a fence and a timestamp query after the buffer swap. The fence is used to wait
+	/// for a frame slot, the query tells when the GPU finished the frame. All functions must be called
+	/// with the window's context active.
+	class OpenGLFramePacer
+	{
+	public:
+		void set_max_frame_latency(int frames) { max_frame_latency = frames; }
+
+		/// \brief Call right after the buffer swap
+		void frame_flipped();
+
+		void wait_for_frame_slot();
+
+		const FrameTiming &get_frame_timing() const { return timing; }
+
+		/// \brief Deletes the pending fences and queries. Call before the context is destroyed.
+		void clear();
+
+	private:
+		struct PendingFrame
+		{
+			uint64_t frame = 0;
+			CLsync fence = nullptr;
+			GLuint query = 0;
+		};
+
+		void retire_frames(int max_pending);
+		void frame_completed(const PendingFrame &pending);
+		void calibrate_gpu_clock();
+		void delete_frame(PendingFrame &pending);
+
+		std::deque<PendingFrame> pending_frames;
+		int max_frame_latency = 0;
+		FrameTiming timing;
+
+		bool clock_calibrated = false;
+		int64_t gpu_to_cpu_offset = 0;
+	};
+}
@@ -42,4 +42,7 @@ namespace clan
 		virtual void make_current() const = 0;
 		virtual ProcAddress *get_proc_address(const std::string& function_name) const = 0;
 	};
+
+	/// \brief Adds the time a window provider spent creating an OpenGL context to OpenGL::get_setup_timings()
+	void cl_record_context_creation(uint64_t microseconds);
 }
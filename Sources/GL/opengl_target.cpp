@@ -36,6 +36,9 @@
 #include "GL3/gl3_graphic_context_provider.h"
 #include "setup_gl_impl.h"
 #include "setup_gl.h"
+#if !defined(__APPLE__) && !defined(WIN32) && !defined(__ANDROID__) && defined(HAVE_EGL_EGLEXT_H)
+#include "Platform/EGL/opengl_window_provider_egl.h"
+#endif
 
 namespace clan
 {
@@ -131,4 +134,22 @@ namespace clan
 			throw Exception("Graphic Context is not from a GL target");
 		OpenGL::set_active(provider);
 	}
+
+	int OpenGLTarget::get_headless_device_count()
+	{
+#if !defined(__APPLE__) && !defined(WIN32) && !defined(__ANDROID__) && defined(HAVE_EGL_EGLEXT_H)
+		return OpenGLHeadlessWindowProvider::get_device_count();
+#else
+		return 0;
+#endif
+	}
+
+	bool OpenGLTarget::is_headless_device_software(int index)
+	{
+#if !defined(__APPLE__) && !defined(WIN32) && !defined(__ANDROID__) && defined(HAVE_EGL_EGLEXT_H)
+		return OpenGLHeadlessWindowProvider::is_software_device(index);
+#else
+		return false;
+#endif
+	}
 }
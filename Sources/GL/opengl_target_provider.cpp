@@ -38,6 +38,9 @@
 #include "Platform/Android/opengl_window_provider_android.h"
 #else
 #include "Platform/GLX/opengl_window_provider_glx.h"
+#ifdef HAVE_EGL_EGLEXT_H
+#include "Platform/EGL/opengl_window_provider_egl.h"
+#endif
 namespace clan { DisplayWindowProvider *newOpenGLWindowProvider(); }
 #endif
 
@@ -53,6 +56,14 @@ namespace clan
 
 	DisplayWindowProvider *OpenGLTargetProvider::alloc_display_window()
 	{
+		if (description.get_headless())
+		{
+#if !defined(__APPLE__) && !defined(WIN32) && !defined(__ANDROID__) && defined(HAVE_EGL_EGLEXT_H)
+			return new OpenGLHeadlessWindowProvider(description);
+#else
+			throw Exception("Headless OpenGL rendering is not supported on this platform");
+#endif
+		}
 		return new OpenGLWindowProvider(description);
 	}
 }
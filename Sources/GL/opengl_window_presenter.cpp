@@ -0,0 +1,284 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "GL/precomp.h"
+#include "API/GL/opengl_window_presenter.h"
+#include "API/GL/opengl.h"
+#include "API/GL/opengl_wrap.h"
+#include "API/Display/Window/display_window.h"
+#include "API/Display/2D/canvas.h"
+#include "API/Display/Render/frame_buffer.h"
+#include "API/Display/Render/render_buffer.h"
+#include "API/Display/Render/texture_2d.h"
+#include "GL3/gl3_graphic_context_provider.h"
+#include "GL3/gl3_frame_buffer_provider.h"
+#include "opengl_display_window_provider.h"
+#include <algorithm>
+
+namespace clan
+{
+	class OpenGLWindowPresenter_Impl
+	{
+	public:
+		struct PresentedWindow
+		{
+			DisplayWindow window;
+			OpenGLDisplayWindowProvider *provider = nullptr;
+			Size size;
+			Texture2D color;
+			RenderBuffer depth_stencil;
+			FrameBuffer frame_buffer;
+			Canvas canvas;
+			FrameBuffer own_frame_buffer;	// The color texture attached on the context of the window, for the fallback path
+		};
+
+		PresentedWindow &find_window(DisplayWindow &window);
+		void update_frame_buffer(PresentedWindow &window);
+		void present_on_main_surface(PresentedWindow &window);
+		void present_with_own_context(PresentedWindow &window);
+		static void blit(GL3GraphicContextProvider *gc_provider, FrameBuffer &frame_buffer, const Size &size);
+
+		DisplayWindow main_window;
+		OpenGLDisplayWindowProvider *main_provider = nullptr;
+		Canvas main_canvas;
+		std::vector<PresentedWindow> windows;
+
+		int context_switches = 0;
+		int surface_switches = 0;
+	};
+
+	OpenGLWindowPresenter::OpenGLWindowPresenter()
+	{
+	}
+
+	OpenGLWindowPresenter::OpenGLWindowPresenter(DisplayWindow &main_window) : impl(std::make_shared<OpenGLWindowPresenter_Impl>())
+	{
+		impl->main_provider = dynamic_cast<OpenGLDisplayWindowProvider *>(main_window.get_provider());
+		if (!impl->main_provider || !dynamic_cast<GL3GraphicContextProvider *>(main_window.get_gc().get_provider()))
+			throw Exception("OpenGLWindowPresenter requires a window using the OpenGL 3 target");
+		impl->main_window = main_window;
+	}
+
+	void OpenGLWindowPresenter::throw_if_null() const
+	{
+		if (!impl)
+			throw Exception("OpenGLWindowPresenter is null");
+	}
+
+	void OpenGLWindowPresenter::add_window(DisplayWindow &window)
+	{
+		throw_if_null();
+		if (window.get_provider() == impl->main_window.get_provider())
+			throw Exception("The main window cannot be added to its own OpenGLWindowPresenter");
+
+		for (auto &presented : impl->windows)
+		{
+			if (presented.window.get_provider() == window.get_provider())
+				return;
+		}
+
+		OpenGLWindowPresenter_Impl::PresentedWindow presented;
+		presented.provider = dynamic_cast<OpenGLDisplayWindowProvider *>(window.get_provider());
+		if (!presented.provider || !dynamic_cast<GL3GraphicContextProvider *>(window.get_gc().get_provider()))
+			throw Exception("OpenGLWindowPresenter requires a window using the OpenGL 3 target");
+		presented.window = window;
+		impl->windows.push_back(presented);
+	}
+
+	void OpenGLWindowPresenter::remove_window(DisplayWindow &window)
+	{
+		throw_if_null();
+		DisplayWindowProvider *provider = window.get_provider();
+		auto it = std::remove_if(impl->windows.begin(), impl->windows.end(), [&](const OpenGLWindowPresenter_Impl::PresentedWindow &presented) { return presented.window.get_provider() == provider; });
+		impl->windows.erase(it, impl->windows.end());
+	}
+
+	Canvas OpenGLWindowPresenter::get_canvas(DisplayWindow &window)
+	{
+		throw_if_null();
+		if (window.get_provider() == impl->main_window.get_provider())
+		{
+			if (impl->main_canvas.is_null())
+				impl->main_canvas = Canvas(impl->main_window);
+			return impl->main_canvas;
+		}
+
+		OpenGLWindowPresenter_Impl::PresentedWindow &presented = impl->find_window(window);
+		impl->update_frame_buffer(presented);
+		return presented.canvas;
+	}
+
+	void OpenGLWindowPresenter::present(int interval)
+	{
+		throw_if_null();
+		impl->context_switches = 0;
+		impl->surface_switches = 0;
+
+		if (!impl->main_canvas.is_null())
+			impl->main_canvas.flush();
+		for (auto &presented : impl->windows)
+		{
+			if (!presented.canvas.is_null())
+				presented.canvas.flush();
+		}
+
+		// Activating the state of the main window also unbinds the frame buffers of the window canvases
+		GraphicContext main_gc = impl->main_window.get_gc();
+		OpenGL::set_active(main_gc);
+
+		std::vector<OpenGLWindowPresenter_Impl::PresentedWindow *> fallback;
+		bool surface_bound = false;
+		for (auto &presented : impl->windows)
+		{
+			if (presented.frame_buffer.is_null())
+				continue;
+
+			if (impl->main_provider->make_current_on_surface_of(*presented.provider))
+			{
+				surface_bound = true;
+				impl->present_on_main_surface(presented);
+				impl->surface_switches++;
+			}
+			else
+			{
+				fallback.push_back(&presented);
+			}
+		}
+		if (surface_bound)
+			impl->main_provider->make_current();
+
+		if (!fallback.empty())
+		{
+			// The other contexts read the frames rendered here, so the commands must have been submitted
+			glFlush();
+
+			for (auto presented : fallback)
+			{
+				impl->present_with_own_context(*presented);
+				impl->context_switches++;
+			}
+			OpenGL::set_active(main_gc);
+		}
+
+		impl->main_window.flip(interval);
+	}
+
+	int OpenGLWindowPresenter::get_context_switches() const
+	{
+		throw_if_null();
+		return impl->context_switches;
+	}
+
+	int OpenGLWindowPresenter::get_surface_switches() const
+	{
+		throw_if_null();
+		return impl->surface_switches;
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	OpenGLWindowPresenter_Impl::PresentedWindow &OpenGLWindowPresenter_Impl::find_window(DisplayWindow &window)
+	{
+		for (auto &presented : windows)
+		{
+			if (presented.window.get_provider() == window.get_provider())
+				return presented;
+		}
+		throw Exception("Window has not been added to the OpenGLWindowPresenter");
+	}
+
+	void OpenGLWindowPresenter_Impl::update_frame_buffer(PresentedWindow &presented)
+	{
+		GraphicContext window_gc = presented.window.get_gc();
+		Size size = window_gc.get_size();
+		size.width = std::max(size.width, 1);
+		size.height = std::max(size.height, 1);
+		if (!presented.frame_buffer.is_null() && presented.size == size)
+			return;
+
+		if (main_canvas.is_null())
+			main_canvas = Canvas(main_window);
+
+		presented.size = size;
+		presented.color = Texture2D(main_canvas, size, tf_rgba8, 1);
+		presented.color.set_pixel_ratio(window_gc.get_pixel_ratio());
+		presented.depth_stencil = RenderBuffer(main_canvas, size.width, size.height, tf_depth24_stencil8);
+		presented.frame_buffer = FrameBuffer(main_canvas);
+		presented.frame_buffer.attach_color(0, presented.color);
+		presented.frame_buffer.attach_depth_stencil(presented.depth_stencil);
+		presented.canvas = Canvas(main_canvas, presented.frame_buffer);
+		presented.own_frame_buffer = FrameBuffer();
+	}
+
+	void OpenGLWindowPresenter_Impl::present_on_main_surface(PresentedWindow &presented)
+	{
+		GL3GraphicContextProvider *gc_provider = static_cast<GL3GraphicContextProvider *>(main_window.get_gc().get_provider());
+		blit(gc_provider, presented.frame_buffer, presented.size);
+		presented.provider->swap_surface_buffers();
+	}
+
+	void OpenGLWindowPresenter_Impl::present_with_own_context(PresentedWindow &presented)
+	{
+		GraphicContext window_gc = presented.window.get_gc();
+		if (presented.own_frame_buffer.is_null())
+		{
+			presented.own_frame_buffer = FrameBuffer(window_gc);
+			presented.own_frame_buffer.attach_color(0, presented.color);
+		}
+
+		OpenGL::set_active(window_gc);
+		blit(static_cast<GL3GraphicContextProvider *>(window_gc.get_provider()), presented.own_frame_buffer, presented.size);
+		presented.window.flip(-1);
+	}
+
+	void OpenGLWindowPresenter_Impl::blit(GL3GraphicContextProvider *gc_provider, FrameBuffer &frame_buffer, const Size &size)
+	{
+		GL3StateCache &state_cache = gc_provider->get_state_cache();
+		GLuint handle = static_cast<GL3FrameBufferProvider *>(frame_buffer.get_provider())->get_handle();
+
+		if (state_cache.set_frame_buffers(0, handle))
+		{
+			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+			glBindFramebuffer(GL_READ_FRAMEBUFFER, handle);
+		}
+
+		// Blits are clipped by the scissor test but no other fragment operation
+		GLboolean scissor_enabled = glIsEnabled(GL_SCISSOR_TEST);
+		if (scissor_enabled)
+			glDisable(GL_SCISSOR_TEST);
+
+		glBlitFramebuffer(0, 0, size.width, size.height, 0, size.height, size.width, 0, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+
+		if (scissor_enabled)
+			glEnable(GL_SCISSOR_TEST);
+
+		if (state_cache.set_frame_buffers(0, 0))
+			glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+	}
+}
@@ -31,11 +31,19 @@
 #include "API/Network/NetGame/connection.h"
 #include "API/Network/NetGame/event.h"
 #include "API/Network/Socket/socket_name.h"
+#include "API/Network/Socket/tcp_connection.h"
 #include "network_event.h"
 #include "client_impl.h"
 
 namespace clan
 {
+	namespace
+	{
+		std::mutex shared_reactor_mutex;
+		int shared_reactor_thread_count = 0;
+		std::weak_ptr<NetGameReactor> shared_reactor;
+	}
+
 	NetGameClient::NetGameClient()
 		: impl(std::make_shared<NetGameClient_Impl>())
 	{
@@ -44,12 +52,29 @@ namespace clan
 	NetGameClient::~NetGameClient()
 	{
 		impl->connection.reset();
+		impl->udp_transport.reset();
 	}
 
 	void NetGameClient::connect(const std::string &server, const std::string &port)
 	{
 		disconnect();
-		impl->connection.reset(new NetGameConnection(this, SocketName(server, port)));
+		impl->reactor = NetGameClient_Impl::get_shared_reactor();
+		if (impl->reactor)
+			impl->connection.reset(new NetGameConnection(this, TCPConnection(SocketName(server, port)), impl->reactor.get()));
+		else
+			impl->connection.reset(new NetGameConnection(this, SocketName(server, port)));
+		impl->connection->set_flush_delay(impl->flush_delay);
+		if (impl->compression_enabled)
+			impl->connection->set_compression(true, impl->compression_threshold);
+	}
+
+	void NetGameClient::connect_udp(const std::string &server, const std::string &port)
+	{
+		disconnect();
+		impl->udp_transport.reset(new NetGameUDPTransport(this));
+		std::shared_ptr<NetGameUDPPeer> peer = impl->udp_transport->add_peer(SocketName(server, port));
+		impl->connection.reset(new NetGameConnection(this, impl->udp_transport.get(), peer));
+		impl->udp_transport->start();
 	}
 
 	void NetGameClient::disconnect()
@@ -57,9 +82,42 @@ namespace clan
 		if (impl->connection.get() != nullptr)
 			impl->connection->disconnect();
 		impl->connection.reset();
+		impl->udp_transport.reset();
+		impl->reactor.reset();
 		impl->events.clear();
 	}
 
+	void NetGameClient::set_shared_io_thread_count(int count)
+	{
+		std::unique_lock<std::mutex> lock(shared_reactor_mutex);
+		shared_reactor_thread_count = count;
+
+		// Clients already connected keep the previous pool alive until they disconnect
+		shared_reactor.reset();
+	}
+
+	void NetGameClient::set_flush_delay(int milliseconds)
+	{
+		impl->flush_delay = milliseconds;
+		if (impl->connection)
+			impl->connection->set_flush_delay(milliseconds);
+	}
+
+	void NetGameClient::set_compression(bool enable, int threshold)
+	{
+		impl->compression_enabled = enable;
+		impl->compression_threshold = threshold;
+		if (impl->connection && !impl->udp_transport)
+			impl->connection->set_compression(enable, threshold);
+	}
+
+	NetGameConnectionStats NetGameClient::get_stats()
+	{
+		if (impl->connection)
+			return impl->connection->get_stats();
+		return NetGameConnectionStats();
+	}
+
 	void NetGameClient::process_events()
 	{
 		impl->process();
@@ -71,6 +129,12 @@ namespace clan
 			impl->connection->send_event(game_event);
 	}
 
+	void NetGameClient::send_event(const NetGameEvent &game_event, NetGameReliability reliability)
+	{
+		if (impl->connection.get() != nullptr)
+			impl->connection->send_event(game_event, reliability);
+	}
+
 	Signal<void(const NetGameEvent &)> &NetGameClient::sig_event_received()
 	{
 		return impl->sig_game_event_received;
@@ -92,6 +156,21 @@ namespace clan
 		impl->events.push_back(e);
 	}
 
+	std::shared_ptr<NetGameReactor> NetGameClient_Impl::get_shared_reactor()
+	{
+		std::unique_lock<std::mutex> lock(shared_reactor_mutex);
+		if (shared_reactor_thread_count <= 0 || !NetworkPoller::is_supported())
+			return std::shared_ptr<NetGameReactor>();
+
+		std::shared_ptr<NetGameReactor> reactor = shared_reactor.lock();
+		if (!reactor)
+		{
+			reactor = std::make_shared<NetGameReactor>(shared_reactor_thread_count);
+			shared_reactor = reactor;
+		}
+		return reactor;
+	}
+
 	void NetGameClient_Impl::process()
 	{
 		std::unique_lock<std::recursive_mutex> mutex_lock(mutex);
@@ -100,6 +179,13 @@ namespace clan
 		mutex_lock.unlock();
 		for (auto & new_event : new_events)
 		{
+			if (new_event.receive_backlog)
+				new_event.receive_backlog->fetch_sub(1);
+
+			// Ignore events still queued from a connection that has since been replaced
+			if (new_event.connection != connection.get())
+				continue;
+
 			switch (new_event.type)
 			{
 			case NetGameNetworkEvent::client_connected:
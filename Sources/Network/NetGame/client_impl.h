@@ -30,6 +30,8 @@
 
 #include <memory>
 #include <mutex>
+#include "udp_transport.h"
+#include "reactor.h"
 
 namespace clan
 {
@@ -38,10 +40,20 @@ namespace clan
 	public:
 		void process();
 
+		/// \brief Returns the I/O thread pool shared by all clients, or null if clients use their own threads
+		static std::shared_ptr<NetGameReactor> get_shared_reactor();
+
 		std::recursive_mutex mutex;
 		std::vector<NetGameNetworkEvent> events;
 
+		// Declared before the connection so that it outlives it
+		std::shared_ptr<NetGameReactor> reactor;
+
+		std::unique_ptr<NetGameUDPTransport> udp_transport;
 		std::unique_ptr<NetGameConnection> connection;
+		int flush_delay = 0;
+		bool compression_enabled = false;
+		int compression_threshold = 256;
 		Signal<void(const NetGameEvent &)> sig_game_event_received;
 		Signal<void()> sig_game_connected;
 		Signal<void()> sig_game_disconnected;
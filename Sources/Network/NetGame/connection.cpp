@@ -47,6 +47,18 @@ namespace clan
 		impl->start(this, site, socket_name);
 	}
 
+	NetGameConnection::NetGameConnection(NetGameConnectionSite *site, const TCPConnection &connection, NetGameReactor *reactor, int io_thread_index)
+		: impl(new NetGameConnection_Impl)
+	{
+		impl->start(this, site, connection, reactor, io_thread_index);
+	}
+
+	NetGameConnection::NetGameConnection(NetGameConnectionSite *site, NetGameUDPTransport *transport, const std::shared_ptr<NetGameUDPPeer> &peer)
+		: impl(new NetGameConnection_Impl)
+	{
+		impl->start(this, site, transport, peer);
+	}
+
 	NetGameConnection::~NetGameConnection()
 	{
 		delete impl;
@@ -67,11 +79,36 @@ namespace clan
 		impl->send_event(game_event);
 	}
 
+	void NetGameConnection::send_event(const NetGameEvent &game_event, NetGameReliability reliability)
+	{
+		impl->send_event(game_event, reliability);
+	}
+
 	void NetGameConnection::disconnect()
 	{
 		impl->disconnect();
 	}
 
+	void NetGameConnection::set_flush_delay(int milliseconds)
+	{
+		impl->set_flush_delay(milliseconds);
+	}
+
+	void NetGameConnection::set_compression(bool enable, int threshold)
+	{
+		impl->set_compression(enable, threshold);
+	}
+
+	void NetGameConnection::set_load_limits(const NetGameLoadLimits &limits)
+	{
+		impl->set_load_limits(limits);
+	}
+
+	NetGameConnectionStats NetGameConnection::get_stats() const
+	{
+		return impl->get_stats();
+	}
+
 	SocketName NetGameConnection::get_remote_name() const
 	{
 		return impl->get_remote_name();
@@ -31,13 +31,17 @@
 #include "API/Network/NetGame/connection.h"
 #include "API/Network/NetGame/connection_site.h"
 #include "API/Core/System/databuffer.h"
+#include "API/Core/System/profiler.h"
+#include "API/Core/System/system.h"
+#include "API/Core/Math/cl_math.h"
 #include "network_event.h"
 #include "network_data.h"
 #include "connection_impl.h"
+#include "udp_transport.h"
 
 namespace clan
 {
-	NetGameConnection_Impl::NetGameConnection_Impl()
+	NetGameConnection_Impl::NetGameConnection_Impl() : stats(std::make_shared<NetGameConnectionStatsCollector>()), receive_backlog(std::make_shared<std::atomic<int>>(0))
 	{
 	}
 
@@ -60,11 +64,39 @@ namespace clan
 		thread = std::thread(&NetGameConnection_Impl::connection_main, this);
 	}
 
+	void NetGameConnection_Impl::start(NetGameConnection *xbase, NetGameConnectionSite *xsite, const TCPConnection &xconnection, NetGameReactor *xreactor, int io_thread_index)
+	{
+		base = xbase;
+		site = xsite;
+		connection = xconnection;
+		socket_name = connection.get_remote_name();
+		is_connected = true;
+		receive_buffer.set_size(max_event_packet_size);
+		reactor = xreactor;
+		reactor->add(this, io_thread_index);
+	}
+
+	void NetGameConnection_Impl::start(NetGameConnection *xbase, NetGameConnectionSite *xsite, NetGameUDPTransport *transport, const std::shared_ptr<NetGameUDPPeer> &peer)
+	{
+		base = xbase;
+		site = xsite;
+		socket_name = peer->name;
+		is_connected = true;
+		udp_transport = transport;
+		udp_peer = peer;
+		stats = peer->stats;
+		udp_transport->attach(udp_peer, base);
+	}
+
 	NetGameConnection_Impl::~NetGameConnection_Impl()
 	{
 		std::unique_lock<std::mutex> mutex_lock(mutex);
 		stop_flag = true;
 		mutex_lock.unlock();
+		if (udp_transport)
+			udp_transport->detach(udp_peer);
+		if (reactor)
+			reactor->remove(this);
 		worker_event.notify();
 		if (thread.joinable())
 			thread.join();
@@ -98,23 +130,54 @@ namespace clan
 
 	void NetGameConnection_Impl::send_event(const NetGameEvent &game_event)
 	{
+		send_event(game_event, NetGameReliability::reliable_ordered);
+	}
+
+	void NetGameConnection_Impl::send_event(const NetGameEvent &game_event, NetGameReliability reliability)
+	{
+		if (udp_transport)
+		{
+			udp_transport->send_event(udp_peer, game_event, reliability);
+			return;
+		}
+
 		std::unique_lock<std::mutex> mutex_lock(mutex);
-		Message message;
-		message.type = Message::type_message;
-		message.event = game_event;
-		send_queue.push_back(message);
+		if (accept_sent_event(game_event))
+		{
+			Message message;
+			message.type = Message::type_message;
+			message.event = game_event;
+			message.queue_time = System::get_time();
+			send_queue.push_back(message);
+		}
+		else if (!send_queue_overflow)
+		{
+			return;
+		}
 		mutex_lock.unlock();
-		worker_event.notify();
+		if (reactor)
+			reactor->wake(this);
+		else
+			worker_event.notify();
 	}
 
 	void NetGameConnection_Impl::disconnect()
 	{
+		if (udp_transport)
+		{
+			udp_transport->disconnect(udp_peer);
+			return;
+		}
+
 		std::unique_lock<std::mutex> mutex_lock(mutex);
 		Message message;
 		message.type = Message::type_disconnect;
 		send_queue.push_back(message);
 		mutex_lock.unlock();
-		worker_event.notify();
+		if (reactor)
+			reactor->wake(this);
+		else
+			worker_event.notify();
 	}
 
 	SocketName NetGameConnection_Impl::get_remote_name() const
@@ -122,8 +185,129 @@ namespace clan
 		return socket_name;
 	}
 
+	void NetGameConnection_Impl::set_flush_delay(int milliseconds)
+	{
+		std::unique_lock<std::mutex> mutex_lock(mutex);
+		flush_delay = milliseconds;
+	}
+
+	void NetGameConnection_Impl::set_compression(bool enable, int threshold)
+	{
+		std::unique_lock<std::mutex> mutex_lock(mutex);
+		compression_enabled = enable;
+		compression_threshold = threshold;
+		if (enable && !udp_transport)
+		{
+			// Tells the peer it may send us compressed frames
+			Message message;
+			message.type = Message::type_message;
+			message.event = NetGameEvent("_compression");
+			send_queue.push_back(message);
+		}
+		mutex_lock.unlock();
+		if (reactor)
+			reactor->wake(this);
+		else if (!udp_transport)
+			worker_event.notify();
+	}
+
+	void NetGameConnection_Impl::set_load_limits(const NetGameLoadLimits &new_limits)
+	{
+		std::unique_lock<std::mutex> mutex_lock(mutex);
+		std::atomic_store(&limits, std::shared_ptr<const NetGameLoadLimits>(std::make_shared<NetGameLoadLimits>(new_limits)));
+	}
+
+	bool NetGameConnection_Impl::accept_sent_event(const NetGameEvent &game_event)
+	{
+		if (!limits)
+			return true;
+
+		NetGameEventPriority priority = limits->get_priority(game_event.get_name());
+		if (priority == NetGameEventPriority::latest_only)
+		{
+			// A newer state makes the queued one obsolete
+			for (auto it = send_queue.rbegin(); it != send_queue.rend(); ++it)
+			{
+				if (it->type == Message::type_message && it->event.get_name() == game_event.get_name())
+				{
+					send_queue.erase(std::next(it).base());
+					stats->event_dropped(game_event.get_name());
+					return true;
+				}
+			}
+		}
+
+		if (limits->max_send_queue <= 0 || (int)send_queue.size() < limits->max_send_queue)
+			return true;
+
+		if (priority == NetGameEventPriority::normal)
+		{
+			// The peer is not keeping up. Disconnecting it is better than queuing forever.
+			send_queue_overflow = true;
+		}
+		else
+		{
+			stats->event_dropped(game_event.get_name());
+		}
+		return false;
+	}
+
+	bool NetGameConnection_Impl::accept_received_event(const NetGameEvent &game_event, int bytes)
+	{
+		if (!io_limits)
+			return true;
+
+		uint64_t now = System::get_time();
+		bool within_rate = event_bucket.consume(1.0f, now) && byte_bucket.consume((float)bytes, now);
+		bool within_queue = io_limits->max_receive_queue <= 0 || receive_backlog->load() < io_limits->max_receive_queue;
+		if (within_rate && within_queue)
+			return true;
+
+		if (io_limits->get_priority(game_event.get_name()) == NetGameEventPriority::normal)
+			throw Exception(within_rate ? "Receive queue limit exceeded" : "Receive rate limit exceeded");
+
+		stats->event_dropped(game_event.get_name());
+		return false;
+	}
+
+	NetGameConnectionStats NetGameConnection_Impl::get_stats()
+	{
+		NetGameConnectionStats result = stats->get_stats();
+		if (udp_transport)
+		{
+			udp_transport->get_stats(udp_peer, result);
+		}
+		else
+		{
+			std::unique_lock<std::mutex> mutex_lock(mutex);
+			result.send_queue_length = send_queue.size();
+			if (!send_queue.empty() && send_queue.front().queue_time != 0)
+				result.send_queue_age = (int)(System::get_time() - send_queue.front().queue_time);
+		}
+		return result;
+	}
+
+	int NetGameConnection_Impl::get_flush_timeout() const
+	{
+		if (!flush_held)
+			return -1;
+		uint64_t now = System::get_time();
+		return now < flush_deadline ? (int)(flush_deadline - now) : 0;
+	}
+
 	bool NetGameConnection_Impl::read_connection_data(DataBuffer &receive_buffer, int &bytes_received)
 	{
+		cl_profile_zone("NetGame receive");
+
+		std::shared_ptr<const NetGameLoadLimits> current_limits = std::atomic_load(&limits);
+		if (current_limits != io_limits)
+		{
+			io_limits = current_limits;
+			uint64_t now = System::get_time();
+			event_bucket = NetGameTokenBucket(io_limits->event_rate, io_limits->event_burst, now);
+			byte_bucket = NetGameTokenBucket(io_limits->byte_rate, io_limits->byte_burst, now);
+		}
+
 		while (true)
 		{
 			int bytes = connection.read(receive_buffer.get_data() + bytes_received, receive_buffer.get_size() - bytes_received);
@@ -137,9 +321,10 @@ namespace clan
 			}
 
 			bytes_received += bytes;
+			stats->data_received(bytes);
 
 			int bytes_consumed = 0;
-			bool exit = read_data(receive_buffer.get_data(), bytes_received, bytes_consumed);
+			bool exit = read_data(DataBufferView(receive_buffer, 0, bytes_received), bytes_consumed);
 
 			if (bytes_consumed >= 0)
 			{
@@ -155,35 +340,51 @@ namespace clan
 
 	bool NetGameConnection_Impl::write_connection_data(DataBuffer &send_buffer, int &bytes_sent, bool &send_graceful_close)
 	{
-		while (true)
-		{
-			int bytes = connection.write(send_buffer.get_data() + bytes_sent, send_buffer.get_size() - bytes_sent);
-			if (bytes < 0)
-				return false;
+		cl_profile_zone("NetGame send");
 
-			bytes_sent += bytes;
+		// All queued events are appended to one buffer, so a burst of small events goes out in a single write
+		if (!send_graceful_close)
+		{
+			bool was_empty = bytes_sent == (int)send_buffer.get_size();
+			send_graceful_close = write_data(send_buffer);
+			if (was_empty && io_flush_delay > 0)
+				flush_deadline = System::get_time() + io_flush_delay;
+		}
 
-			if (bytes_sent == send_buffer.get_size())
+		flush_held = false;
+		while (true)
+		{
+			int pending = send_buffer.get_size() - bytes_sent;
+			if (pending == 0)
 			{
+				bytes_sent = 0;
+				send_buffer.set_size(0);
 				if (send_graceful_close)
 				{
 					connection.close();
 					return true;
 				}
-				else
-				{
-					bytes_sent = 0;
-					send_buffer.set_size(0);
-					send_graceful_close = write_data(send_buffer);
-					if (send_buffer.get_size() == 0)
-						return false;
-				}
+				return false;
+			}
+
+			if (!send_graceful_close && io_flush_delay > 0 && pending < coalesce_frame_size && System::get_time() < flush_deadline)
+			{
+				flush_held = true;
+				return false;
 			}
+
+			int bytes = connection.write(send_buffer.get_data() + bytes_sent, pending);
+			if (bytes < 0)
+				return false;
+
+			bytes_sent += bytes;
+			stats->data_sent(bytes);
 		}
 	}
 
 	void NetGameConnection_Impl::connection_main()
 	{
+		Profiler::set_thread_name("NetGame connection");
 		try
 		{
 			if (!is_connected)
@@ -191,13 +392,7 @@ namespace clan
 			is_connected = true;
 			site->add_network_event(NetGameNetworkEvent(base, NetGameNetworkEvent::client_connected));
 
-			int bytes_received = 0;
-			int bytes_sent = 0;
-			const int max_event_packet_size = 32000 + 2;
-			DataBuffer receive_buffer(max_event_packet_size);
-			DataBuffer send_buffer;
-
-			bool send_graceful_close = false;
+			receive_buffer.set_size(max_event_packet_size);
 
 			while (true)
 			{
@@ -210,7 +405,7 @@ namespace clan
 				if (stop_flag)
 					break;
 				NetworkEvent *events[] = { &connection };
-				worker_event.wait(lock, 1, events);
+				worker_event.wait(lock, 1, events, get_flush_timeout());
 			}
 
 			site->add_network_event(NetGameNetworkEvent(base, NetGameNetworkEvent::client_disconnected));
@@ -221,13 +416,47 @@ namespace clan
 		}
 	}
 
-	bool NetGameConnection_Impl::read_data(const void *data, int size, int &bytes_consumed)
+	bool NetGameConnection_Impl::process_io()
+	{
+		try
+		{
+			if (read_connection_data(receive_buffer, bytes_received) || write_connection_data(send_buffer, bytes_sent, send_graceful_close))
+			{
+				site->add_network_event(NetGameNetworkEvent(base, NetGameNetworkEvent::client_disconnected));
+				return true;
+			}
+			return false;
+		}
+		catch (const Exception& e)
+		{
+			site->add_network_event(NetGameNetworkEvent(base, NetGameNetworkEvent::client_disconnected, NetGameEvent(e.message)));
+			return true;
+		}
+	}
+
+	bool NetGameConnection_Impl::read_data(const DataBufferView &data, int &bytes_consumed)
 	{
 		bytes_consumed = 0;
-		while (bytes_consumed != size)
+		while (bytes_consumed != (int)data.get_size())
 		{
+			DataBufferView frame = data.skip(bytes_consumed);
+			if (frame.get_size() >= 2 && (*frame.get_data<unsigned short>() & NetGameNetworkData::compressed_frame_flag))
+			{
+				unsigned int length = *frame.get_data<unsigned short>() & ~NetGameNetworkData::compressed_frame_flag;
+				if (length > NetGameNetworkData::compressed_frame_limit)
+					throw Exception("Incoming message too big");
+				if (frame.get_size() < 2 + length)
+					return false;
+
+				bytes_consumed += 2 + length;
+				if (read_compressed_frame(frame.slice(2, length)))
+					return true;
+				continue;
+			}
+
 			int bytes = 0;
-			NetGameEvent incoming_event = NetGameNetworkData::receive_data(static_cast<const char*>(data)+bytes_consumed, size - bytes_consumed, bytes);
+			uint64_t decode_start = System::get_microseconds();
+			NetGameEvent incoming_event = NetGameNetworkData::receive_data(frame, bytes);
 			bytes_consumed += bytes;
 
 			if (bytes == 0)
@@ -238,27 +467,63 @@ namespace clan
 			{
 				return true;
 			}
+			else if (incoming_event.get_name() == "_compression")
+			{
+				peer_accepts_compression = true;
+				continue;
+			}
+
+			stats->event_received(incoming_event.get_name(), bytes, System::get_microseconds() - decode_start);
+			if (!accept_received_event(incoming_event, bytes))
+				continue;
 
-			site->add_network_event(NetGameNetworkEvent(base, incoming_event));
+			NetGameNetworkEvent network_event(base, incoming_event);
+			if (io_limits && io_limits->max_receive_queue > 0)
+			{
+				receive_backlog->fetch_add(1);
+				network_event.receive_backlog = receive_backlog;
+			}
+			site->add_network_event(network_event);
 		}
 		return false;
 	}
 
+	bool NetGameConnection_Impl::read_compressed_frame(const DataBufferView &frame)
+	{
+		if (!decompressor)
+			decompressor.reset(new ZLibDecompressor());
+		decompressor->decompress(frame.get_data(), frame.get_size(), inflate_buffer);
+
+		// A large event may span several compressed frames, so keep any partial event for the next frame
+		int inflated_consumed = 0;
+		bool exit = read_data(DataBufferView(inflate_buffer), inflated_consumed);
+		memmove(inflate_buffer.get_data(), inflate_buffer.get_data() + inflated_consumed, inflate_buffer.get_size() - inflated_consumed);
+		inflate_buffer.set_size(inflate_buffer.get_size() - inflated_consumed);
+		return exit;
+	}
+
 	bool NetGameConnection_Impl::write_data(DataBuffer &buffer)
 	{
+		// Swap between two queues so draining does not allocate
+		send_queue_drain.clear();
 		std::unique_lock<std::mutex> mutex_lock(mutex);
-		std::vector<Message> new_send_queue;
-		send_queue.swap(new_send_queue);
+		if (send_queue_overflow)
+			throw Exception("Send queue limit exceeded");
+		send_queue.swap(send_queue_drain);
+		io_flush_delay = flush_delay;
+		io_compression_enabled = compression_enabled;
+		io_compression_threshold = compression_threshold;
 		mutex_lock.unlock();
-		for (auto & elem : new_send_queue)
+		for (auto & elem : send_queue_drain)
 		{
 			if (elem.type == Message::type_message)
 			{
-				DataBuffer packet = NetGameNetworkData::send_data(elem.event);
-
-				int pos = buffer.get_size();
-				buffer.set_size(pos + packet.get_size());
-				memcpy(buffer.get_data() + pos, packet.get_data(), packet.get_size());
+				unsigned int start = buffer.get_size();
+				uint64_t encode_start = System::get_microseconds();
+				NetGameNetworkData::send_data(buffer, elem.event);
+				stats->event_sent(elem.event.get_name(), buffer.get_size() - start, System::get_microseconds() - encode_start);
+				if (io_compression_enabled && peer_accepts_compression && buffer.get_size() - start >= (unsigned int)io_compression_threshold)
+					compress_frame(buffer, start);
 			}
 			else if (elem.type == Message::type_disconnect)
 			{
@@ -267,4 +532,27 @@ namespace clan
 		}
 		return false;
 	}
+
+	void NetGameConnection_Impl::compress_frame(DataBuffer &buffer, unsigned int start)
+	{
+		if (!compressor)
+			compressor.reset(new ZLibCompressor(true, 1));
+
+		compress_buffer.set_size(0);
+		compressor->compress(buffer.get_data() + start, buffer.get_size() - start, compress_buffer, ZLibCompressor::sync_flush);
+
+		// Replace the encoded event with one or more compressed frames
+		buffer.set_size(start);
+		unsigned int compressed_size = compress_buffer.get_size();
+		for (unsigned int pos = 0; pos < compressed_size; pos += NetGameNetworkData::compressed_frame_limit)
+		{
+			unsigned int length = min(compressed_size - pos, (unsigned int)NetGameNetworkData::compressed_frame_limit);
+			unsigned int frame_pos = buffer.get_size();
+			if (frame_pos + 2 + length > buffer.get_capacity())
+				buffer.set_capacity(max(frame_pos + 2 + length, buffer.get_capacity() * 2));
+			buffer.set_size(frame_pos + 2 + length);
+			*reinterpret_cast<unsigned short*>(buffer.get_data() + frame_pos) = NetGameNetworkData::compressed_frame_flag | length;
+			memcpy(buffer.get_data() + frame_pos + 2, compress_buffer.get_data() + pos, length);
+		}
+	}
 }
@@ -31,8 +31,16 @@
 
 #include <mutex>
 #include <thread>
+#include "API/Network/NetGame/connection.h"
 #include "API/Network/Socket/tcp_connection.h"
 #include "API/Network/Socket/socket_name.h"
+#include "API/Core/System/databuffer_view.h"
+#include "API/Core/Zip/zlib_compression.h"
+#include "API/Network/NetGame/load_limits.h"
+#include "reactor.h"
+#include "connection_stats_collector.h"
+#include "token_bucket.h"
+#include <atomic>
 
 namespace clan
 {
@@ -43,20 +51,46 @@ namespace clan
 		~NetGameConnection_Impl();
 		void start(NetGameConnection *base, NetGameConnectionSite *site, const TCPConnection &connection);
 		void start(NetGameConnection *base, NetGameConnectionSite *site, const SocketName &socket_name);
+		void start(NetGameConnection *base, NetGameConnectionSite *site, const TCPConnection &connection, NetGameReactor *reactor, int io_thread_index);
+		void start(NetGameConnection *base, NetGameConnectionSite *site, NetGameUDPTransport *transport, const std::shared_ptr<NetGameUDPPeer> &peer);
 		void set_data(const std::string &name, void *data);
 		void *get_data(const std::string &name) const;
 		void send_event(const NetGameEvent &game_event);
+		void send_event(const NetGameEvent &game_event, NetGameReliability reliability);
 		void disconnect();
 		SocketName get_remote_name() const;
+		void set_flush_delay(int milliseconds);
+		void set_compression(bool enable, int threshold);
+		void set_load_limits(const NetGameLoadLimits &limits);
+		NetGameConnectionStats get_stats();
 
 	private:
 		void connection_main();
 
+		/// \brief Reads and writes as much data as possible without blocking
+		/** \return true if the connection has ended*/
+		bool process_io();
+		bool wants_write() const { return bytes_sent < (int)send_buffer.get_size() && !flush_held; }
+
+		/// \brief Milliseconds until held back data must be written, or -1 if nothing is held back
+		int get_flush_timeout() const;
+
 		bool read_connection_data(DataBuffer &receive_buffer, int &bytes_received);
 		bool write_connection_data(DataBuffer &send_buffer, int &bytes_sent, bool &send_graceful_close);
 
-		bool read_data(const void *data, int size, int &out_bytes_consumed);
+		bool read_data(const DataBufferView &data, int &out_bytes_consumed);
+
+		/// \brief Applies the receive limits to an incoming event
+		/** \return false if the event is dropped*/
+		bool accept_received_event(const NetGameEvent &game_event, int bytes);
+
+		/// \brief Applies the send queue limit to an outgoing event. Called with the mutex locked.
+		/** \return false if the event is dropped*/
+		bool accept_sent_event(const NetGameEvent &game_event);
+
+		bool read_compressed_frame(const DataBufferView &frame);
 		bool write_data(DataBuffer &buffer);
+		void compress_frame(DataBuffer &buffer, unsigned int start);
 
 		NetGameConnection *base;
 
@@ -79,13 +113,60 @@ namespace clan
 			};
 			Type type;
 			NetGameEvent event;
+			uint64_t queue_time = 0;
 		};
 		std::vector<Message> send_queue;
+		std::vector<Message> send_queue_drain;
 		struct AttachedData
 		{
 			std::string name;
 			void *data;
 		};
 		std::vector<AttachedData> data;
+
+		enum { max_event_packet_size = 32000 + 2 };
+		DataBuffer receive_buffer;
+		DataBuffer send_buffer;
+		int bytes_received = 0;
+		int bytes_sent = 0;
+		bool send_graceful_close = false;
+
+		/// \brief Small writes are held back up to this many milliseconds so that events sent close together share a frame
+		int flush_delay = 0;
+		int io_flush_delay = 0;
+		uint64_t flush_deadline = 0;
+		bool flush_held = false;
+		enum { coalesce_frame_size = 1400 };
+
+		/// \brief Events at least this big are deflated once both sides have announced compression support
+		bool compression_enabled = false;
+		int compression_threshold = 256;
+		bool io_compression_enabled = false;
+		int io_compression_threshold = 256;
+		bool peer_accepts_compression = false;
+		std::unique_ptr<ZLibCompressor> compressor;
+		std::unique_ptr<ZLibDecompressor> decompressor;
+		DataBuffer compress_buffer;
+		DataBuffer inflate_buffer;
+
+		std::shared_ptr<NetGameConnectionStatsCollector> stats;
+
+		/// \brief Replaced as a whole so the I/O thread can read it without the mutex
+		std::shared_ptr<const NetGameLoadLimits> limits;
+		std::shared_ptr<const NetGameLoadLimits> io_limits;
+		NetGameTokenBucket event_bucket;
+		NetGameTokenBucket byte_bucket;
+		std::shared_ptr<std::atomic<int>> receive_backlog;
+		bool send_queue_overflow = false;
+
+		NetGameReactor *reactor = nullptr;
+		NetGameReactor::IOThread *io_thread = nullptr;
+		bool io_finished = false;
+		bool io_want_write = false;
+
+		NetGameUDPTransport *udp_transport = nullptr;
+		std::shared_ptr<NetGameUDPPeer> udp_peer;
+
+		friend class NetGameReactor;
 	};
 }
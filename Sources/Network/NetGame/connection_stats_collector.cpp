@@ -0,0 +1,130 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Network/precomp.h"
+#include "API/Core/System/system.h"
+#include "connection_stats_collector.h"
+
+namespace clan
+{
+	void NetGameConnectionStatsCollector::event_sent(const std::string &name, unsigned int bytes, uint64_t encode_microseconds)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		stats.events_sent++;
+		NetGameEventTypeStats &type_stats = stats.event_types[name];
+		type_stats.events_sent++;
+		type_stats.bytes_sent += bytes;
+		type_stats.encode_microseconds += encode_microseconds;
+		type_stats.size_histogram.add(bytes);
+	}
+
+	void NetGameConnectionStatsCollector::event_received(const std::string &name, unsigned int bytes, uint64_t decode_microseconds)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		stats.events_received++;
+		NetGameEventTypeStats &type_stats = stats.event_types[name];
+		type_stats.events_received++;
+		type_stats.bytes_received += bytes;
+		type_stats.decode_microseconds += decode_microseconds;
+		type_stats.size_histogram.add(bytes);
+	}
+
+	void NetGameConnectionStatsCollector::data_sent(unsigned int bytes)
+	{
+		uint64_t now = System::get_time();
+		std::unique_lock<std::mutex> lock(mutex);
+		stats.bytes_sent += bytes;
+		sent_rate.add(bytes, now);
+	}
+
+	void NetGameConnectionStatsCollector::data_received(unsigned int bytes)
+	{
+		uint64_t now = System::get_time();
+		std::unique_lock<std::mutex> lock(mutex);
+		stats.bytes_received += bytes;
+		received_rate.add(bytes, now);
+	}
+
+	void NetGameConnectionStatsCollector::message_resent()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		stats.resends++;
+	}
+
+	void NetGameConnectionStatsCollector::event_dropped(const std::string &name)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		stats.events_dropped++;
+		stats.event_types[name].events_dropped++;
+	}
+
+	void NetGameConnectionStatsCollector::round_trip_sample(float milliseconds)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		stats.round_trip_histogram.add((uint64_t)(milliseconds + 0.5f));
+	}
+
+	NetGameConnectionStats NetGameConnectionStatsCollector::get_stats()
+	{
+		uint64_t now = System::get_time();
+		std::unique_lock<std::mutex> lock(mutex);
+		NetGameConnectionStats result = stats;
+		result.bytes_sent_per_second = sent_rate.get_rate(now);
+		result.bytes_received_per_second = received_rate.get_rate(now);
+		return result;
+	}
+
+	void NetGameConnectionStatsCollector::RateCounter::add(uint64_t bytes, uint64_t now_milliseconds)
+	{
+		advance(now_milliseconds);
+		buckets[current_bucket % bucket_count] += bytes;
+	}
+
+	float NetGameConnectionStatsCollector::RateCounter::get_rate(uint64_t now_milliseconds)
+	{
+		advance(now_milliseconds);
+		uint64_t total = 0;
+		for (auto bucket : buckets)
+			total += bucket;
+		return (float)total * 1000.0f / (bucket_milliseconds * bucket_count);
+	}
+
+	void NetGameConnectionStatsCollector::RateCounter::advance(uint64_t now_milliseconds)
+	{
+		uint64_t bucket = now_milliseconds / bucket_milliseconds;
+		if (bucket <= current_bucket)
+			return;
+
+		uint64_t expired = bucket - current_bucket;
+		if (expired > bucket_count)
+			expired = bucket_count;
+		for (uint64_t i = 1; i <= expired; i++)
+			buckets[(current_bucket + i) % bucket_count] = 0;
+		current_bucket = bucket;
+	}
+}
@@ -0,0 +1,72 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "API/Network/NetGame/connection_stats.h"
+#include <mutex>
+
+namespace clan
+{
+	/// \brief Thread safe counters behind NetGameConnection::get_stats
+	class NetGameConnectionStatsCollector
+	{
+	public:
+		void event_sent(const std::string &name, unsigned int bytes, uint64_t encode_microseconds);
+		void event_received(const std::string &name, unsigned int bytes, uint64_t decode_microseconds);
+		void data_sent(unsigned int bytes);
+		void data_received(unsigned int bytes);
+		void message_resent();
+		void event_dropped(const std::string &name);
+		void round_trip_sample(float milliseconds);
+
+		/// \brief Copies the counters. Queue state and round trip time are filled in by the transport.
+		NetGameConnectionStats get_stats();
+
+	private:
+		/// \brief Bytes per 100 ms over the last second
+		class RateCounter
+		{
+		public:
+			void add(uint64_t bytes, uint64_t now_milliseconds);
+			float get_rate(uint64_t now_milliseconds);
+
+		private:
+			void advance(uint64_t now_milliseconds);
+
+			enum { bucket_milliseconds = 100, bucket_count = 10 };
+			uint64_t buckets[bucket_count] = {};
+			uint64_t current_bucket = 0;
+		};
+
+		std::mutex mutex;
+		NetGameConnectionStats stats;
+		RateCounter sent_rate;
+		RateCounter received_rate;
+	};
+}
@@ -34,16 +34,25 @@ namespace clan
 {
 	NetGameEvent::NetGameEvent(const std::string &name, std::vector<NetGameEventValue> arg)
 		: name(name)
-		, arguments(arg)
+		, name_id(hash_name(name))
+		, arguments(std::move(arg))
 	{
 	}
 
+	unsigned int NetGameEvent::hash_name(const std::string &name)
+	{
+		unsigned int value = 2166136261U;
+		for (char c : name)
+			value = (value ^ (unsigned char)c) * 16777619U;
+		return value;
+	}
+
 	unsigned int NetGameEvent::get_argument_count() const
 	{
 		return arguments.size();
 	}
 
-	NetGameEventValue NetGameEvent::get_argument(unsigned int index) const
+	const NetGameEventValue &NetGameEvent::get_argument(unsigned int index) const
 	{
 		if (index >= arguments.size())
 			throw Exception(string_format("Arguments out of bounds for game event %1", name));
@@ -55,6 +64,11 @@ namespace clan
 		arguments.push_back(value);
 	}
 
+	void NetGameEvent::add_argument(NetGameEventValue &&value)
+	{
+		arguments.push_back(std::move(value));
+	}
+
 	std::string NetGameEvent::to_string() const
 	{
 		std::string event_info = string_format("%1(", name);
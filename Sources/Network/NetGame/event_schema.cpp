@@ -0,0 +1,138 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Network/precomp.h"
+#include "API/Network/NetGame/event_schema.h"
+#include "API/Core/Text/string_format.h"
+#include "event_schema_registry.h"
+#include <mutex>
+
+namespace clan
+{
+	static std::mutex &schema_registry_mutex()
+	{
+		static std::mutex *mutex = new std::mutex();
+		return *mutex;
+	}
+
+	static std::shared_ptr<const NetGameEventSchemaRegistry> &schema_registry_instance()
+	{
+		static std::shared_ptr<const NetGameEventSchemaRegistry> *instance = new std::shared_ptr<const NetGameEventSchemaRegistry>();
+		return *instance;
+	}
+
+	NetGameEventSchema::NetGameEventSchema(const std::string &event_name) : event_name(event_name)
+	{
+	}
+
+	NetGameEventSchema &NetGameEventSchema::add_boolean()
+	{
+		fields.push_back({ field_boolean, 1, 0.0f, 0.0f });
+		return *this;
+	}
+
+	NetGameEventSchema &NetGameEventSchema::add_uinteger()
+	{
+		fields.push_back({ field_uinteger, 0, 0.0f, 0.0f });
+		return *this;
+	}
+
+	NetGameEventSchema &NetGameEventSchema::add_integer()
+	{
+		fields.push_back({ field_integer, 0, 0.0f, 0.0f });
+		return *this;
+	}
+
+	NetGameEventSchema &NetGameEventSchema::add_bits(int bits)
+	{
+		if (bits < 1 || bits > 32)
+			throw Exception("Schema field bit count must be between 1 and 32");
+		fields.push_back({ field_bits, bits, 0.0f, 0.0f });
+		return *this;
+	}
+
+	NetGameEventSchema &NetGameEventSchema::add_number()
+	{
+		fields.push_back({ field_number, 32, 0.0f, 0.0f });
+		return *this;
+	}
+
+	NetGameEventSchema &NetGameEventSchema::add_quantized_number(float min_value, float max_value, int bits)
+	{
+		if (bits < 1 || bits > 32)
+			throw Exception("Schema field bit count must be between 1 and 32");
+		if (!(max_value > min_value))
+			throw Exception("Quantized schema field needs a non-empty range");
+		fields.push_back({ field_quantized_number, bits, min_value, max_value });
+		return *this;
+	}
+
+	NetGameEventSchema &NetGameEventSchema::add_string()
+	{
+		fields.push_back({ field_string, 0, 0.0f, 0.0f });
+		return *this;
+	}
+
+	NetGameEventSchema &NetGameEventSchema::add_binary()
+	{
+		fields.push_back({ field_binary, 0, 0.0f, 0.0f });
+		return *this;
+	}
+
+	void NetGameEventSchema::register_schema(const NetGameEventSchema &schema)
+	{
+		std::unique_lock<std::mutex> lock(schema_registry_mutex());
+		std::shared_ptr<const NetGameEventSchemaRegistry> &instance = schema_registry_instance();
+
+		// Encoders may hold on to the old snapshot, so build a new one instead of modifying it
+		std::shared_ptr<NetGameEventSchemaRegistry> registry = std::make_shared<NetGameEventSchemaRegistry>();
+		if (instance)
+			*registry = *instance;
+
+		if (registry->ids.find(schema.get_event_name()) != registry->ids.end())
+			throw Exception(string_format("A schema for game event %1 is already registered", schema.get_event_name()));
+		if (registry->schemas.size() >= NetGameEventSchemaRegistry::max_schemas)
+			throw Exception("Too many game event schemas");
+
+		registry->ids[schema.get_event_name()] = registry->schemas.size();
+		registry->schemas.push_back(schema);
+		instance = registry;
+	}
+
+	void NetGameEventSchema::clear_schemas()
+	{
+		std::unique_lock<std::mutex> lock(schema_registry_mutex());
+		schema_registry_instance().reset();
+	}
+
+	std::shared_ptr<const NetGameEventSchemaRegistry> NetGameEventSchemaRegistry::get()
+	{
+		std::unique_lock<std::mutex> lock(schema_registry_mutex());
+		return schema_registry_instance();
+	}
+}
@@ -0,0 +1,62 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "API/Network/NetGame/event_schema.h"
+#include <unordered_map>
+
+namespace clan
+{
+	/// \brief Immutable snapshot of the registered event schemas
+	class NetGameEventSchemaRegistry
+	{
+	public:
+		/// \brief Returns the current snapshot, or null if no schemas are registered
+		static std::shared_ptr<const NetGameEventSchemaRegistry> get();
+
+		const NetGameEventSchema *find(const std::string &event_name, unsigned int &out_id) const
+		{
+			auto it = ids.find(event_name);
+			if (it == ids.end())
+				return nullptr;
+			out_id = it->second;
+			return &schemas[it->second];
+		}
+
+		const NetGameEventSchema *find(unsigned int id) const
+		{
+			return id < schemas.size() ? &schemas[id] : nullptr;
+		}
+
+		enum { max_schemas = 0x8000 };
+
+		std::vector<NetGameEventSchema> schemas;
+		std::unordered_map<std::string, unsigned int> ids;
+	};
+}
@@ -67,15 +67,19 @@ namespace clan
 	{
 	}
 
+	NetGameEventValue::NetGameEventValue(std::string &&value)
+		: type(string), value_string(std::move(value))
+	{
+	}
+
 	NetGameEventValue::NetGameEventValue(const char *value)
 		: type(string), value_string(value)
 	{
 	}
 
 	NetGameEventValue::NetGameEventValue(const wchar_t *value)
-		: type(string)
+		: type(string), value_string(StringHelp::ucs2_to_utf8(value))
 	{
-		value_string = StringHelp::ucs2_to_utf8(value);
 	}
 
 	NetGameEventValue::NetGameEventValue(bool value)
@@ -91,6 +95,85 @@ namespace clan
 	NetGameEventValue::NetGameEventValue(Type type)
 		: type(type), value_int(0)
 	{
+		switch (type)
+		{
+		case string: new (&value_string) std::string(); break;
+		case binary: new (&value_binary) DataBuffer(); break;
+		case complex: new (&value_complex) std::vector<NetGameEventValue>(); break;
+		default: break;
+		}
+	}
+
+	NetGameEventValue::NetGameEventValue(const NetGameEventValue &other)
+	{
+		construct_from(other);
+	}
+
+	NetGameEventValue::NetGameEventValue(NetGameEventValue &&other) noexcept
+	{
+		construct_from(std::move(other));
+	}
+
+	NetGameEventValue::~NetGameEventValue()
+	{
+		destroy();
+	}
+
+	NetGameEventValue &NetGameEventValue::operator=(const NetGameEventValue &other)
+	{
+		if (this != &other)
+		{
+			NetGameEventValue copy(other);
+			destroy();
+			construct_from(std::move(copy));
+		}
+		return *this;
+	}
+
+	NetGameEventValue &NetGameEventValue::operator=(NetGameEventValue &&other) noexcept
+	{
+		if (this != &other)
+		{
+			destroy();
+			construct_from(std::move(other));
+		}
+		return *this;
+	}
+
+	void NetGameEventValue::construct_from(const NetGameEventValue &other)
+	{
+		type = other.type;
+		switch (type)
+		{
+		case string: new (&value_string) std::string(other.value_string); break;
+		case binary: new (&value_binary) DataBuffer(other.value_binary); break;
+		case complex: new (&value_complex) std::vector<NetGameEventValue>(other.value_complex); break;
+		default: value_uint = other.value_uint; break;
+		}
+	}
+
+	void NetGameEventValue::construct_from(NetGameEventValue &&other)
+	{
+		type = other.type;
+		switch (type)
+		{
+		case string: new (&value_string) std::string(std::move(other.value_string)); break;
+		case binary: new (&value_binary) DataBuffer(other.value_binary); break;
+		case complex: new (&value_complex) std::vector<NetGameEventValue>(std::move(other.value_complex)); break;
+		default: value_uint = other.value_uint; break;
+		}
+	}
+
+	void NetGameEventValue::destroy()
+	{
+		switch (type)
+		{
+		case string: value_string.~basic_string(); break;
+		case binary: value_binary.~DataBuffer(); break;
+		case complex: value_complex.~vector(); break;
+		default: break;
+		}
+		type = null;
 	}
 
 	NetGameEventValue::Type NetGameEventValue::get_type() const
@@ -166,6 +249,12 @@ namespace clan
 		value_complex.push_back(value);
 	}
 
+	void NetGameEventValue::add_member(NetGameEventValue &&value)
+	{
+		throw_if_not_complex();
+		value_complex.push_back(std::move(value));
+	}
+
 	void NetGameEventValue::set_member(unsigned int index, const NetGameEventValue &value)
 	{
 		throw_if_not_complex();
@@ -218,7 +307,7 @@ namespace clan
 			throw Exception("NetGameEventValue is not a floating point number");
 	}
 
-	std::string NetGameEventValue::get_string() const
+	const std::string &NetGameEventValue::get_string() const
 	{
 		if (is_string())
 			return value_string;
@@ -234,7 +323,7 @@ namespace clan
 			throw Exception("NetGameEventValue is not a boolean");
 	}
 
-	DataBuffer NetGameEventValue::get_binary() const
+	const DataBuffer &NetGameEventValue::get_binary() const
 	{
 		if (is_binary())
 			return value_binary;
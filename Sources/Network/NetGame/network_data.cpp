@@ -28,26 +28,30 @@
 
 #include "Network/precomp.h"
 #include "API/Core/System/databuffer.h"
+#include "API/Core/System/databuffer_view.h"
+#include "API/Core/Math/cl_math.h"
 #include "API/Core/IOData/memory_device.h"
 #include "API/Core/Text/string_help.h"
+#include "API/Core/Text/string_format.h"
 #include "API/Core/Zip/zlib_compression.h"
 #include "network_data.h"
+#include "event_schema_registry.h"
+#include <cmath>
 
 namespace clan
 {
-	NetGameEvent NetGameNetworkData::receive_data(const void *data, int size, int &out_bytes_consumed)
+	NetGameEvent NetGameNetworkData::receive_data(const DataBufferView &data, int &out_bytes_consumed)
 	{
-		if (size >= 2)
+		if (data.get_size() >= 2)
 		{
-			int payload_size = *static_cast<const unsigned short *>(data);
+			int payload_size = *data.get_data<unsigned short>();
 			if (payload_size > packet_limit)
 				throw Exception("Incoming message too big");
 
-			if (size >= 2 + payload_size)
+			if (data.get_size() >= 2 + (unsigned int)payload_size)
 			{
 				out_bytes_consumed = 2 + payload_size;
-				DataBuffer buffer(static_cast<const char*>(data)+2, payload_size);
-				return decode_event(buffer);
+				return decode_event(data.slice(2, payload_size));
 			}
 		}
 
@@ -55,15 +59,12 @@ namespace clan
 		return NetGameEvent(std::string());
 	}
 
-	DataBuffer NetGameNetworkData::send_data(const NetGameEvent &e)
+	void NetGameNetworkData::send_data(DataBuffer &buffer, const NetGameEvent &e)
 	{
-		DataBuffer buffer = encode_event(e);
-		if (buffer.get_size() > packet_limit + 2)
-			throw Exception("Outgoing message too big");
-		return buffer;
+		encode_event(buffer, e);
 	}
 
-	NetGameEvent NetGameNetworkData::decode_event(const DataBuffer &data)
+	NetGameEvent NetGameNetworkData::decode_event(const DataBufferView &data)
 	{
 		const unsigned char *d = data.get_data<unsigned char>();
 		unsigned int length = data.get_size();
@@ -71,6 +72,9 @@ namespace clan
 			throw Exception("Invalid network data");
 
 		unsigned int name_length = *reinterpret_cast<const unsigned short*>(d);
+		if (name_length & schema_flag)
+			return decode_schema_event(d + 2, length - 2, name_length & ~schema_flag);
+
 		if (length < 2 + name_length + 1)
 			throw Exception("Invalid network data");
 		std::string name = std::string(reinterpret_cast<const char*>(d + 2), name_length);
@@ -131,9 +135,9 @@ namespace clan
 			pos += 2;
 			if (pos + name_length > length)
 				throw Exception("Invalid network data");
-			std::string value(reinterpret_cast<const char*>(d + pos), name_length);
+			NetGameEventValue value(std::string(reinterpret_cast<const char*>(d + pos), name_length));
 			pos += name_length;
-			return NetGameEventValue(value);
+			return value;
 		}
 		case 8: // complex
 		{
@@ -182,17 +186,37 @@ namespace clan
 		}
 	}
 
-	DataBuffer NetGameNetworkData::encode_event(const NetGameEvent &e)
+	void NetGameNetworkData::encode_event(DataBuffer &buffer, const NetGameEvent &e)
 	{
+		std::shared_ptr<const NetGameEventSchemaRegistry> registry = NetGameEventSchemaRegistry::get();
+		if (registry)
+		{
+			unsigned int schema_id = 0;
+			const NetGameEventSchema *schema = registry->find(e.get_name(), schema_id);
+			if (schema)
+			{
+				encode_schema_event(buffer, e, *schema, schema_id);
+				return;
+			}
+		}
+
 		unsigned int length = 3 + e.get_name().length();
 		for (unsigned int i = 0; i < e.get_argument_count(); i++)
 			length += get_encoded_length(e.get_argument(i));
 
-		DataBuffer data(length + 2);
+		if (length > packet_limit)
+			throw Exception("Outgoing message too big");
 
-		*data.get_data<unsigned short>() = length;
+		// Encode directly at the end of the buffer. Grow the capacity geometrically so appending many events stays linear.
+		unsigned int pos = buffer.get_size();
+		unsigned int new_size = pos + length + 2;
+		if (new_size > buffer.get_capacity())
+			buffer.set_capacity(max(new_size, buffer.get_capacity() * 2));
+		buffer.set_size(new_size);
 
-		unsigned char *d = data.get_data<unsigned char>() + 2;
+		unsigned char *d = buffer.get_data<unsigned char>() + pos;
+		*reinterpret_cast<unsigned short*>(d) = length;
+		d += 2;
 
 		// Write name (2 + name length)
 		unsigned int name_length = e.get_name().length();
@@ -206,8 +230,6 @@ namespace clan
 
 		// Write end marker
 		*d = 0;
-
-		return data;
 	}
 
 	unsigned int NetGameNetworkData::encode_value(unsigned char *d, const NetGameEventValue &value)
@@ -234,7 +256,7 @@ namespace clan
 			return 1;
 		case NetGameEventValue::string:
 		{
-			std::string s = value.get_string();
+			const std::string &s = value.get_string();
 			*d = 7;
 			*reinterpret_cast<unsigned short*>(d + 1) = s.length();
 			memcpy(d + 3, s.data(), s.length());
@@ -260,7 +282,7 @@ namespace clan
 			return 2;
 		case NetGameEventValue::binary:
 		{
-			DataBuffer s = value.get_binary();
+			const DataBuffer &s = value.get_binary();
 			*d = 11;
 			*reinterpret_cast<unsigned short*>(d + 1) = s.get_size();
 			memcpy(d + 3, s.get_data(), s.get_size());
@@ -300,4 +322,293 @@ namespace clan
 			throw Exception("Unknown game event value type");
 		}
 	}
+
+	namespace
+	{
+		class NetGameBitWriter
+		{
+		public:
+			NetGameBitWriter(unsigned char *d) : d(d), pos(0) { }
+
+			void write(unsigned int value, int bits)
+			{
+				while (bits > 0)
+				{
+					int shift = pos & 7;
+					int count = min(8 - shift, bits);
+					d[pos >> 3] |= (value & ((1u << count) - 1)) << shift;
+					value >>= count;
+					bits -= count;
+					pos += count;
+				}
+			}
+
+			void write_varint(unsigned int value)
+			{
+				while (value >= 0x80)
+				{
+					write((value & 0x7f) | 0x80, 8);
+					value >>= 7;
+				}
+				write(value, 8);
+			}
+
+			void write_bytes(const void *data, unsigned int size)
+			{
+				write_varint(size);
+				const unsigned char *src = static_cast<const unsigned char*>(data);
+				for (unsigned int i = 0; i < size; i++)
+					write(src[i], 8);
+			}
+
+			unsigned int get_byte_size() const { return (pos + 7) >> 3; }
+
+		private:
+			unsigned char *d;
+			unsigned int pos;
+		};
+
+		class NetGameBitReader
+		{
+		public:
+			NetGameBitReader(const unsigned char *d, unsigned int length) : d(d), bit_length(length * 8), pos(0) { }
+
+			unsigned int read(int bits)
+			{
+				if (pos + bits > bit_length)
+					throw Exception("Invalid network data");
+
+				unsigned int value = 0;
+				int value_shift = 0;
+				while (bits > 0)
+				{
+					int shift = pos & 7;
+					int count = min(8 - shift, bits);
+					value |= ((d[pos >> 3] >> shift) & ((1u << count) - 1)) << value_shift;
+					value_shift += count;
+					bits -= count;
+					pos += count;
+				}
+				return value;
+			}
+
+			unsigned int read_varint()
+			{
+				unsigned int value = 0;
+				for (int shift = 0; shift < 35; shift += 7)
+				{
+					unsigned int byte = read(8);
+					value |= (byte & 0x7f) << shift;
+					if ((byte & 0x80) == 0)
+						return value;
+				}
+				throw Exception("Invalid network data");
+			}
+
+			std::string read_string()
+			{
+				unsigned int size = read_varint();
+				if (size > (bit_length - pos) / 8)
+					throw Exception("Invalid network data");
+				std::string s(size, 0);
+				for (unsigned int i = 0; i < size; i++)
+					s[i] = (char)read(8);
+				return s;
+			}
+
+		private:
+			const unsigned char *d;
+			unsigned int bit_length;
+			unsigned int pos;
+		};
+
+		inline unsigned int quantization_steps(int bits)
+		{
+			return bits == 32 ? 0xffffffffu : (1u << bits) - 1;
+		}
+	}
+
+	void NetGameNetworkData::encode_schema_event(DataBuffer &buffer, const NetGameEvent &e, const NetGameEventSchema &schema, unsigned int schema_id)
+	{
+		const std::vector<NetGameEventSchema::Field> &fields = schema.get_fields();
+		if (e.get_argument_count() != fields.size())
+			throw Exception(string_format("Game event %1 does not match its schema", e.get_name()));
+
+		// Worst case size: varints take 5 bytes, strings and binaries a varint length plus their bytes
+		unsigned int max_bits = 0;
+		for (unsigned int i = 0; i < fields.size(); i++)
+		{
+			switch (fields[i].type)
+			{
+			case NetGameEventSchema::field_uinteger:
+			case NetGameEventSchema::field_integer:
+				max_bits += 40;
+				break;
+			case NetGameEventSchema::field_string:
+				max_bits += 40 + 8 * e.get_argument(i).get_string().length();
+				break;
+			case NetGameEventSchema::field_binary:
+				max_bits += 40 + 8 * e.get_argument(i).get_binary().get_size();
+				break;
+			default:
+				max_bits += fields[i].bits;
+				break;
+			}
+		}
+
+		unsigned int max_length = 2 + (max_bits + 7) / 8;
+		if (max_length > packet_limit)
+			throw Exception("Outgoing message too big");
+
+		unsigned int pos = buffer.get_size();
+		unsigned int new_size = pos + max_length + 2;
+		if (new_size > buffer.get_capacity())
+			buffer.set_capacity(max(new_size, buffer.get_capacity() * 2));
+		buffer.set_size(new_size);
+
+		unsigned char *d = buffer.get_data<unsigned char>() + pos;
+		memset(d + 4, 0, max_length - 2);
+		*reinterpret_cast<unsigned short*>(d + 2) = schema_flag | schema_id;
+
+		NetGameBitWriter writer(d + 4);
+		for (unsigned int i = 0; i < fields.size(); i++)
+		{
+			const NetGameEventSchema::Field &field = fields[i];
+			const NetGameEventValue &value = e.get_argument(i);
+			bool matches = true;
+			switch (field.type)
+			{
+			case NetGameEventSchema::field_boolean:
+				matches = value.is_boolean();
+				if (matches)
+					writer.write(value.get_boolean() ? 1 : 0, 1);
+				break;
+			case NetGameEventSchema::field_uinteger:
+				matches = value.is_uinteger();
+				if (matches)
+					writer.write_varint(value.get_uinteger());
+				break;
+			case NetGameEventSchema::field_integer:
+				matches = value.is_integer();
+				if (matches)
+				{
+					int v = value.get_integer();
+					writer.write_varint((static_cast<unsigned int>(v) << 1) ^ static_cast<unsigned int>(v >> 31));
+				}
+				break;
+			case NetGameEventSchema::field_bits:
+				matches = value.is_uinteger() && (field.bits == 32 || value.get_uinteger() < (1u << field.bits));
+				if (matches)
+					writer.write(value.get_uinteger(), field.bits);
+				break;
+			case NetGameEventSchema::field_number:
+				matches = value.is_number();
+				if (matches)
+				{
+					float v = value.get_number();
+					unsigned int bits;
+					memcpy(&bits, &v, sizeof(bits));
+					writer.write(bits, 32);
+				}
+				break;
+			case NetGameEventSchema::field_quantized_number:
+				matches = value.is_number();
+				if (matches)
+				{
+					double v = value.get_number();
+					v = (v == v) ? clamp(v, (double)field.min_value, (double)field.max_value) : (double)field.min_value;
+					double steps = quantization_steps(field.bits);
+					writer.write((unsigned int)std::floor((v - field.min_value) / (field.max_value - field.min_value) * steps + 0.5), field.bits);
+				}
+				break;
+			case NetGameEventSchema::field_string:
+				matches = value.is_string();
+				if (matches)
+				{
+					const std::string &s = value.get_string();
+					writer.write_bytes(s.data(), s.length());
+				}
+				break;
+			case NetGameEventSchema::field_binary:
+				matches = value.is_binary();
+				if (matches)
+				{
+					const DataBuffer &b = value.get_binary();
+					writer.write_bytes(b.get_data(), b.get_size());
+				}
+				break;
+			}
+
+			if (!matches)
+			{
+				buffer.set_size(pos);
+				throw Exception(string_format("Argument %1 of game event %2 does not match its schema", i, e.get_name()));
+			}
+		}
+
+		unsigned int length = 2 + writer.get_byte_size();
+		*reinterpret_cast<unsigned short*>(d) = length;
+		buffer.set_size(pos + 2 + length);
+	}
+
+	NetGameEvent NetGameNetworkData::decode_schema_event(const unsigned char *d, unsigned int length, unsigned int schema_id)
+	{
+		std::shared_ptr<const NetGameEventSchemaRegistry> registry = NetGameEventSchemaRegistry::get();
+		const NetGameEventSchema *schema = registry ? registry->find(schema_id) : nullptr;
+		if (!schema)
+			throw Exception("Invalid network data");
+
+		const std::vector<NetGameEventSchema::Field> &fields = schema->get_fields();
+		std::vector<NetGameEventValue> arguments;
+		arguments.reserve(fields.size());
+
+		NetGameBitReader reader(d, length);
+		for (const auto &field : fields)
+		{
+			switch (field.type)
+			{
+			case NetGameEventSchema::field_boolean:
+				arguments.push_back(NetGameEventValue(reader.read(1) != 0));
+				break;
+			case NetGameEventSchema::field_uinteger:
+				arguments.push_back(NetGameEventValue(reader.read_varint()));
+				break;
+			case NetGameEventSchema::field_integer:
+			{
+				unsigned int v = reader.read_varint();
+				arguments.push_back(NetGameEventValue(static_cast<int>((v >> 1) ^ (0u - (v & 1)))));
+				break;
+			}
+			case NetGameEventSchema::field_bits:
+				arguments.push_back(NetGameEventValue(reader.read(field.bits)));
+				break;
+			case NetGameEventSchema::field_number:
+			{
+				unsigned int bits = reader.read(32);
+				float v;
+				memcpy(&v, &bits, sizeof(v));
+				arguments.push_back(NetGameEventValue(v));
+				break;
+			}
+			case NetGameEventSchema::field_quantized_number:
+			{
+				double q = reader.read(field.bits);
+				double steps = quantization_steps(field.bits);
+				arguments.push_back(NetGameEventValue((float)(field.min_value + q / steps * (field.max_value - field.min_value))));
+				break;
+			}
+			case NetGameEventSchema::field_string:
+				arguments.push_back(NetGameEventValue(reader.read_string()));
+				break;
+			case NetGameEventSchema::field_binary:
+			{
+				std::string s = reader.read_string();
+				arguments.push_back(NetGameEventValue(DataBuffer(s.data(), s.length())));
+				break;
+			}
+			}
+		}
+
+		return NetGameEvent(schema->get_event_name(), std::move(arguments));
+	}
 }
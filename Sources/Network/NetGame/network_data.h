@@ -35,22 +35,37 @@
 namespace clan
 {
 	class DataBuffer;
+	class DataBufferView;
+	class NetGameEventSchema;
 
 	class NetGameNetworkData
 	{
 	public:
-		static NetGameEvent receive_data(const void *data, int size, int &out_bytes_consumed);
-		static DataBuffer send_data(const NetGameEvent &e);
+		static NetGameEvent receive_data(const DataBufferView &data, int &out_bytes_consumed);
 
-	private:
-		static NetGameEvent decode_event(const DataBuffer &data);
-		static DataBuffer encode_event(const NetGameEvent &e);
+		/// \brief Encodes the event and appends it to the end of buffer
+		static void send_data(DataBuffer &buffer, const NetGameEvent &e);
+
+		/// \brief Marks the length field of a frame holding compressed event data
+		enum { compressed_frame_flag = 0x8000, compressed_frame_limit = 32000 };
 
+		/// \brief Size of a value in the generic event encoding
 		static unsigned int get_encoded_length(const NetGameEventValue &value);
+
+	private:
+		static NetGameEvent decode_event(const DataBufferView &data);
+		static void encode_event(DataBuffer &buffer, const NetGameEvent &e);
+
 		static unsigned int encode_value(unsigned char *d, const NetGameEventValue &value);
 
 		static NetGameEventValue decode_value(unsigned char type, const unsigned char *d, unsigned int length, unsigned int &pos);
 
+		static void encode_schema_event(DataBuffer &buffer, const NetGameEvent &e, const NetGameEventSchema &schema, unsigned int schema_id);
+		static NetGameEvent decode_schema_event(const unsigned char *d, unsigned int length, unsigned int schema_id);
+
+		/// \brief Marks a schema encoded event in the name length field
+		enum { schema_flag = 0x8000 };
+
 		enum { packet_limit = 32000 };
 	};
 }
@@ -29,6 +29,8 @@
 #pragma once
 
 #include "API/Network/NetGame/event.h"
+#include <atomic>
+#include <memory>
 
 namespace clan
 {
@@ -62,5 +64,8 @@ namespace clan
 		NetGameConnection *connection;
 		Type type;
 		NetGameEvent game_event;
+
+		/// \brief Count of received events the connection has queued but the site has not processed yet
+		std::shared_ptr<std::atomic<int>> receive_backlog;
 	};
 }
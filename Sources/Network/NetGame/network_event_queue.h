@@ -0,0 +1,143 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "network_event.h"
+#include <atomic>
+#include <vector>
+
+namespace clan
+{
+	/// \brief Lock-free queue of network events with many producers and a single consumer
+	///
+	/// Producers push with a single compare and swap. The consumer takes everything queued so far with one exchange.
+	///
+	/// Drained nodes are handed back to a free list and reused by later pushes, so a steady stream of events
+	/// does not allocate. The free list is only ever pushed to or taken as a whole, which keeps it free of the
+	/// ABA problem a single node pop would have.
+	class NetGameNetworkEventQueue
+	{
+	public:
+		NetGameNetworkEventQueue() : head(nullptr), free_list(nullptr) { }
+		~NetGameNetworkEventQueue() { delete_nodes(head.exchange(nullptr)); delete_nodes(free_list.exchange(nullptr)); }
+
+		/// \brief Queues an event. May be called by any thread.
+		void push(const NetGameNetworkEvent &e)
+		{
+			Node *node = alloc_node(e);
+			push_nodes(head, node, node);
+		}
+
+		/// \brief Moves all queued events to the end of out_events, in the order they were pushed
+		void drain(std::vector<NetGameNetworkEvent> &out_events)
+		{
+			Node *node = head.exchange(nullptr, std::memory_order_acquire);
+			if (!node)
+				return;
+
+			// The list is newest first
+			Node *last = node;
+			Node *reversed = nullptr;
+			while (node)
+			{
+				Node *next = node->next;
+				node->next = reversed;
+				reversed = node;
+				node = next;
+			}
+
+			Node *first = reversed;
+			for (node = first; node; node = node->next)
+				out_events.push_back(std::move(node->event));
+
+			push_nodes(free_list, first, last);
+		}
+
+	private:
+		struct Node
+		{
+			Node(const NetGameNetworkEvent &event) : event(event) { }
+			NetGameNetworkEvent event;
+			Node *next = nullptr;
+		};
+
+		Node *alloc_node(const NetGameNetworkEvent &e)
+		{
+			Node *node = free_list.exchange(nullptr, std::memory_order_acquire);
+			if (!node)
+				return new Node(e);
+
+			// Put the rest back. If another thread refilled the list meanwhile, swap ours in and merge theirs.
+			Node *rest = node->next;
+			if (rest)
+			{
+				Node *expected = nullptr;
+				if (!free_list.compare_exchange_strong(expected, rest, std::memory_order_release, std::memory_order_relaxed))
+				{
+					Node *other = free_list.exchange(rest, std::memory_order_acq_rel);
+					if (other)
+					{
+						Node *other_last = other;
+						while (other_last->next)
+							other_last = other_last->next;
+						push_nodes(free_list, other, other_last);
+					}
+				}
+			}
+
+			node->event = e;
+			node->next = nullptr;
+			return node;
+		}
+
+		static void push_nodes(std::atomic<Node *> &list, Node *first, Node *last)
+		{
+			last->next = list.load(std::memory_order_relaxed);
+			while (!list.compare_exchange_weak(last->next, first, std::memory_order_release, std::memory_order_relaxed))
+			{
+			}
+		}
+
+		static void delete_nodes(Node *node)
+		{
+			while (node)
+			{
+				Node *next = node->next;
+				delete node;
+				node = next;
+			}
+		}
+
+		std::atomic<Node *> head;
+		std::atomic<Node *> free_list;
+
+		NetGameNetworkEventQueue(const NetGameNetworkEventQueue &) = delete;
+		NetGameNetworkEventQueue &operator=(const NetGameNetworkEventQueue &) = delete;
+	};
+}
@@ -0,0 +1,227 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "Network/precomp.h"
+#include "API/Network/NetGame/connection.h"
+#include "API/Network/NetGame/connection_site.h"
+#include "network_event.h"
+#include "reactor.h"
+#include "connection_impl.h"
+#include <algorithm>
+
+namespace clan
+{
+	NetGameReactor::NetGameReactor(int thread_count)
+	{
+		for (int i = 0; i < thread_count; i++)
+			threads.push_back(std::unique_ptr<IOThread>(new IOThread()));
+
+		for (auto &io_thread : threads)
+			io_thread->thread = std::thread(&NetGameReactor::thread_main, this, io_thread.get());
+	}
+
+	NetGameReactor::~NetGameReactor()
+	{
+		for (auto &io_thread : threads)
+		{
+			std::unique_lock<std::mutex> lock(io_thread->mutex);
+			io_thread->stop_flag = true;
+			lock.unlock();
+			io_thread->poller.notify();
+		}
+
+		for (auto &io_thread : threads)
+			io_thread->thread.join();
+	}
+
+	void NetGameReactor::add(NetGameConnection_Impl *connection, int thread_index)
+	{
+		IOThread *io_thread;
+		if (thread_index >= 0)
+		{
+			io_thread = threads[thread_index % threads.size()].get();
+		}
+		else
+		{
+			std::unique_lock<std::mutex> reactor_lock(mutex);
+			io_thread = threads[next_thread].get();
+			next_thread = (next_thread + 1) % threads.size();
+		}
+
+		connection->io_thread = io_thread;
+
+		std::unique_lock<std::mutex> lock(io_thread->mutex);
+		io_thread->added.push_back(connection);
+		lock.unlock();
+		io_thread->poller.notify();
+	}
+
+	void NetGameReactor::remove(NetGameConnection_Impl *connection)
+	{
+		IOThread *io_thread = connection->io_thread;
+		if (!io_thread)
+			return;
+
+		std::unique_lock<std::mutex> lock(io_thread->mutex);
+		if (connection->io_finished)
+			return;
+
+		io_thread->removed.push_back(connection);
+		io_thread->poller.notify();
+		io_thread->removed_event.wait(lock, [&]() { return connection->io_finished || io_thread->stop_flag; });
+	}
+
+	void NetGameReactor::wake(NetGameConnection_Impl *connection)
+	{
+		IOThread *io_thread = connection->io_thread;
+
+		std::unique_lock<std::mutex> lock(io_thread->mutex);
+		if (connection->io_finished)
+			return;
+		bool needs_notify = io_thread->woken.empty();
+		io_thread->woken.push_back(connection);
+		lock.unlock();
+
+		if (needs_notify)
+			io_thread->poller.notify();
+	}
+
+	void NetGameReactor::thread_main(IOThread *io_thread)
+	{
+		std::vector<NetGameConnection_Impl *> added, removed, woken, flushing;
+		std::vector<void *> ready;
+
+		while (true)
+		{
+			std::unique_lock<std::mutex> lock(io_thread->mutex);
+			if (io_thread->stop_flag)
+				break;
+			added.swap(io_thread->added);
+			removed.swap(io_thread->removed);
+			woken.swap(io_thread->woken);
+			lock.unlock();
+
+			for (auto connection : removed)
+			{
+				if (io_thread->connections.erase(connection))
+					io_thread->poller.remove(&connection->connection);
+				io_thread->held.erase(connection);
+
+				lock.lock();
+				connection->io_finished = true;
+				lock.unlock();
+			}
+			if (!removed.empty())
+				io_thread->removed_event.notify_all();
+
+			for (auto connection : added)
+			{
+				if (connection->io_finished)
+					continue;
+				connection->site->add_network_event(NetGameNetworkEvent(connection->base, NetGameNetworkEvent::client_connected));
+				io_thread->connections.insert(connection);
+				io_thread->poller.add(&connection->connection, connection, false);
+				process(io_thread, connection);
+			}
+
+			for (auto connection : woken)
+			{
+				if (io_thread->connections.find(connection) != io_thread->connections.end())
+					process(io_thread, connection);
+			}
+
+			for (void *ready_connection : ready)
+			{
+				auto connection = static_cast<NetGameConnection_Impl *>(ready_connection);
+				if (io_thread->connections.find(connection) != io_thread->connections.end())
+					process(io_thread, connection);
+			}
+
+			// Connections holding back small writes are revisited when their flush delay runs out
+			flushing.assign(io_thread->held.begin(), io_thread->held.end());
+			for (auto connection : flushing)
+			{
+				if (connection->get_flush_timeout() == 0)
+					process(io_thread, connection);
+			}
+
+			int timeout = -1;
+			for (auto connection : io_thread->held)
+			{
+				int connection_timeout = connection->get_flush_timeout();
+				if (timeout == -1 || connection_timeout < timeout)
+					timeout = connection_timeout;
+			}
+
+			added.clear();
+			removed.clear();
+			woken.clear();
+			flushing.clear();
+
+			io_thread->poller.wait(ready, timeout);
+		}
+
+		// Release anyone waiting in remove
+		std::unique_lock<std::mutex> lock(io_thread->mutex);
+		for (auto connection : io_thread->connections)
+			connection->io_finished = true;
+		for (auto connection : io_thread->added)
+			connection->io_finished = true;
+		lock.unlock();
+		io_thread->removed_event.notify_all();
+	}
+
+	void NetGameReactor::process(IOThread *io_thread, NetGameConnection_Impl *connection)
+	{
+		if (connection->process_io())
+		{
+			io_thread->held.erase(connection);
+			io_thread->connections.erase(connection);
+			io_thread->poller.remove(&connection->connection);
+
+			std::unique_lock<std::mutex> lock(io_thread->mutex);
+			connection->io_finished = true;
+			lock.unlock();
+			io_thread->removed_event.notify_all();
+			return;
+		}
+
+		if (connection->wants_write() != connection->io_want_write)
+		{
+			// Only ask for write readiness while there is unsent data, as the socket is nearly always writable
+			connection->io_want_write = connection->wants_write();
+			io_thread->poller.modify(&connection->connection, connection, connection->io_want_write);
+		}
+
+		if (connection->flush_held)
+			io_thread->held.insert(connection);
+		else
+			io_thread->held.erase(connection);
+	}
+}
@@ -0,0 +1,92 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include "Network/Socket/network_poller.h"
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace clan
+{
+	class NetGameConnection_Impl;
+
+	/// \brief Serves many NetGame connections from a fixed pool of I/O threads
+	///
+	/// Each connection is assigned to one I/O thread for its lifetime. The thread waits on all
+	/// its sockets with a NetworkPoller and processes the connections that are ready.
+	class NetGameReactor
+	{
+	public:
+		NetGameReactor(int thread_count);
+		~NetGameReactor();
+
+		/// \brief Starts serving a connection
+		///
+		/// \param thread_index = I/O thread to serve the connection on, or -1 to assign the threads round-robin
+		void add(NetGameConnection_Impl *connection, int thread_index = -1);
+
+		/// \brief Stops serving a connection. Waits until its I/O thread no longer uses it.
+		void remove(NetGameConnection_Impl *connection);
+
+		/// \brief Signals that a connection has events queued for sending
+		void wake(NetGameConnection_Impl *connection);
+
+		struct IOThread;
+
+	private:
+		void thread_main(IOThread *io_thread);
+		void process(IOThread *io_thread, NetGameConnection_Impl *connection);
+
+		std::vector<std::unique_ptr<IOThread>> threads;
+		std::mutex mutex;
+		int next_thread = 0;
+	};
+
+	struct NetGameReactor::IOThread
+	{
+		NetworkPoller poller;
+		std::thread thread;
+
+		std::mutex mutex;
+		std::condition_variable removed_event;
+		bool stop_flag = false;
+		std::vector<NetGameConnection_Impl *> added;
+		std::vector<NetGameConnection_Impl *> removed;
+		std::vector<NetGameConnection_Impl *> woken;
+
+		// Only used by the I/O thread
+		std::unordered_set<NetGameConnection_Impl *> connections;
+		std::unordered_set<NetGameConnection_Impl *> held;
+	};
+}
@@ -30,6 +30,7 @@
 #include "API/Network/NetGame/server.h"
 #include "API/Network/NetGame/connection.h"
 #include "API/Network/Socket/socket_name.h"
+#include "API/Core/System/system.h"
 #include "network_event.h"
 #include "server_impl.h"
 #include <algorithm>
@@ -54,8 +55,7 @@ namespace clan
 
 	void NetGameServer::add_network_event(const NetGameNetworkEvent &e)
 	{
-		std::unique_lock<std::mutex> mutex_lock(impl->mutex);
-		impl->events.push_back(e);
+		impl->events.push(e);
 	}
 
 	void NetGameServer::send_event(const NetGameEvent &game_event)
@@ -67,14 +67,24 @@ namespace clan
 		}
 	}
 
+	void NetGameServer::send_event(const NetGameEvent &game_event, NetGameReliability reliability)
+	{
+		std::unique_lock<std::mutex> mutex_lock(impl->mutex);
+		for (auto & elem : impl->connections)
+		{
+			elem->send_event(game_event, reliability);
+		}
+	}
+
 	void NetGameServer::start(const std::string &port)
 	{
 		stop();
 		std::unique_lock<std::mutex> lock(impl->mutex);
 		impl->stop_flag = false;
 		lock.unlock();
-		impl->tcp_listen.reset(new TCPListen(SocketName(port)));
-		impl->listen_thread = std::thread(&NetGameServer::listen_thread_main, this);
+		if (impl->io_thread_count > 0 && NetworkPoller::is_supported())
+			impl->reactor.reset(new NetGameReactor(impl->io_thread_count));
+		start_listen(SocketName(port));
 	}
 
 	void NetGameServer::start(const std::string &address, const std::string &port)
@@ -83,8 +93,26 @@ namespace clan
 		std::unique_lock<std::mutex> lock(impl->mutex);
 		impl->stop_flag = false;
 		lock.unlock();
-		impl->tcp_listen.reset(new TCPListen(SocketName(address, port)));
-		impl->listen_thread = std::thread(&NetGameServer::listen_thread_main, this);
+		if (impl->io_thread_count > 0 && NetworkPoller::is_supported())
+			impl->reactor.reset(new NetGameReactor(impl->io_thread_count));
+		start_listen(SocketName(address, port));
+	}
+
+	void NetGameServer::start_udp(const std::string &port)
+	{
+		start_udp(std::string(), port);
+	}
+
+	void NetGameServer::start_udp(const std::string &address, const std::string &port)
+	{
+		stop();
+		impl->udp_transport.reset(new NetGameUDPTransport(this));
+		impl->udp_transport->listen(address.empty() ? SocketName(port) : SocketName(address, port), [this](const std::shared_ptr<NetGameUDPPeer> &peer)
+		{
+			std::unique_lock<std::mutex> lock(impl->mutex);
+			impl->connections.push_back(new NetGameConnection(this, impl->udp_transport.get(), peer));
+		});
+		impl->udp_transport->start();
 	}
 
 	void NetGameServer::stop()
@@ -92,34 +120,109 @@ namespace clan
 		std::unique_lock<std::mutex> lock(impl->mutex);
 		impl->stop_flag = true;
 		lock.unlock();
-		impl->worker_event.notify();
-		if (impl->listen_thread.joinable())
-			impl->listen_thread.join();
-		impl->tcp_listen.reset();
+		impl->stop_listen();
+		if (impl->udp_transport)
+			impl->udp_transport->stop();
 
 		for (auto & elem : impl->connections)
 		{
 			delete elem;
 		}
 		impl->connections.clear();
+		impl->pending_connections = 0;
+		impl->connect_buckets.clear();
+		impl->reactor.reset();
+		impl->udp_transport.reset();
+	}
+
+	void NetGameServer::set_io_thread_count(int count)
+	{
+		impl->io_thread_count = count;
+	}
+
+	void NetGameServer::set_listener_count(int count)
+	{
+		impl->listener_count = count;
+	}
+
+	void NetGameServer::set_flush_delay(int milliseconds)
+	{
+		std::unique_lock<std::mutex> lock(impl->mutex);
+		impl->flush_delay = milliseconds;
+	}
+
+	void NetGameServer::set_compression(bool enable, int threshold)
+	{
+		std::unique_lock<std::mutex> lock(impl->mutex);
+		impl->compression_enabled = enable;
+		impl->compression_threshold = threshold;
+	}
+
+	void NetGameServer::set_load_limits(const NetGameLoadLimits &limits)
+	{
+		std::unique_lock<std::mutex> lock(impl->mutex);
+		impl->limits = limits;
+	}
+
+	NetGameConnectionStats NetGameServer::get_stats()
+	{
+		NetGameConnectionStats total;
+		for (const auto &it : get_client_stats())
+			total.merge(it.second);
+		return total;
+	}
+
+	std::vector<std::pair<NetGameConnection *, NetGameConnectionStats>> NetGameServer::get_client_stats()
+	{
+		std::unique_lock<std::mutex> mutex_lock(impl->mutex);
+		std::vector<std::pair<NetGameConnection *, NetGameConnectionStats>> result;
+		for (auto connection : impl->connections)
+			result.push_back(std::make_pair(connection, connection->get_stats()));
+		return result;
 	}
 
-	void NetGameServer::listen_thread_main()
+	void NetGameServer::start_listen(const SocketName &endpoint)
 	{
+		int count = (impl->listener_count > 1 && TCPListen::is_reuse_port_supported()) ? impl->listener_count : 1;
+		for (int i = 0; i < count; i++)
+		{
+			impl->tcp_listens.push_back(std::unique_ptr<TCPListen>(new TCPListen(endpoint, impl->limits.listen_backlog, true, count > 1)));
+			impl->listen_events.push_back(std::unique_ptr<NetworkConditionVariable>(new NetworkConditionVariable()));
+		}
+		for (int i = 0; i < count; i++)
+			impl->listen_threads.push_back(std::thread(&NetGameServer::listen_thread_main, this, i));
+	}
+
+	void NetGameServer::listen_thread_main(int index)
+	{
+		TCPListen *tcp_listen = impl->tcp_listens[index].get();
+		NetworkConditionVariable *listen_event = impl->listen_events[index].get();
+		int io_thread_index = impl->tcp_listens.size() > 1 ? index : -1;
+
 		while (true)
 		{
 			std::unique_lock<std::mutex> lock(impl->mutex);
 			if (impl->stop_flag)
 				break;
 
-			NetworkEvent *events[] = { impl->tcp_listen.get() };
-			impl->worker_event.wait(lock, 1, events);
+			NetworkEvent *events[] = { tcp_listen };
+			listen_event->wait(lock, 1, events);
 
 			SocketName peer_endpoint;
-			TCPConnection connection = impl->tcp_listen->accept(peer_endpoint);
+			TCPConnection connection = tcp_listen->accept(peer_endpoint);
 			if (!connection.is_null())
 			{
-				std::unique_ptr<NetGameConnection> game_connection(new NetGameConnection(this, connection));
+				if (!impl->accept_connection(peer_endpoint))
+				{
+					connection.close();
+					continue;
+				}
+
+				std::unique_ptr<NetGameConnection> game_connection(impl->reactor ? new NetGameConnection(this, connection, impl->reactor.get(), io_thread_index) : new NetGameConnection(this, connection));
+				game_connection->set_flush_delay(impl->flush_delay);
+				if (impl->compression_enabled)
+					game_connection->set_compression(true, impl->compression_threshold);
+				game_connection->set_load_limits(impl->limits);
 				impl->connections.push_back(game_connection.release());
 			}
 		}
@@ -140,21 +243,70 @@ namespace clan
 		return impl->sig_game_event_received;
 	}
 
+	void NetGameServer_Impl::stop_listen()
+	{
+		for (auto &listen_event : listen_events)
+			listen_event->notify();
+		for (auto &listen_thread : listen_threads)
+			listen_thread.join();
+		listen_threads.clear();
+		listen_events.clear();
+		tcp_listens.clear();
+	}
+
+	bool NetGameServer_Impl::accept_connection(const SocketName &peer_endpoint)
+	{
+		if (limits.max_connections > 0 && (int)connections.size() >= limits.max_connections)
+			return false;
+		if (limits.max_pending_connections > 0 && pending_connections >= limits.max_pending_connections)
+			return false;
+
+		if (limits.connect_rate_per_address > 0.0f)
+		{
+			uint64_t now = System::get_time();
+			if (connect_buckets.size() >= max_connect_buckets)
+			{
+				// Addresses that have not connected for a while have full buckets and can be forgotten
+				for (auto it = connect_buckets.begin(); it != connect_buckets.end();)
+				{
+					if (it->second.is_full(now))
+						it = connect_buckets.erase(it);
+					else
+						++it;
+				}
+				if (connect_buckets.size() >= max_connect_buckets)
+					return false;
+			}
+
+			std::string address = peer_endpoint.get_address();
+			auto it = connect_buckets.find(address);
+			if (it == connect_buckets.end())
+				it = connect_buckets.insert(std::make_pair(address, NetGameTokenBucket(limits.connect_rate_per_address, limits.connect_burst_per_address, now))).first;
+			if (!it->second.consume(1.0f, now))
+				return false;
+		}
+
+		pending_connections++;
+		return true;
+	}
+
 	void NetGameServer_Impl::process()
 	{
-		std::unique_lock<std::mutex> mutex_lock(mutex);
 		std::vector<NetGameNetworkEvent> new_events;
-		new_events.swap(events);
-		mutex_lock.unlock();
+		events.drain(new_events);
 
 		for (auto & new_event : new_events)
 		{
 			switch (new_event.type)
 			{
 			case NetGameNetworkEvent::client_connected:
+				if (!udp_transport)
+					pending_connections--;
 				sig_game_client_connected(new_event.connection);
 				break;
 			case NetGameNetworkEvent::event_received:
+				if (new_event.receive_backlog)
+					new_event.receive_backlog->fetch_sub(1);
 				sig_game_event_received(new_event.connection, new_event.game_event);
 				break;
 			case NetGameNetworkEvent::client_disconnected:
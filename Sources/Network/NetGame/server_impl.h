@@ -29,9 +29,17 @@
 #pragma once
 
 #include "API/Network/Socket/tcp_listen.h"
+#include "reactor.h"
+#include "udp_transport.h"
+#include "network_event_queue.h"
+#include "token_bucket.h"
+#include "API/Network/NetGame/load_limits.h"
+#include <atomic>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <thread>
+#include <vector>
 
 namespace clan
 {
@@ -40,14 +48,34 @@ namespace clan
 	public:
 		void process();
 
-		std::unique_ptr<TCPListen> tcp_listen;
-		std::thread listen_thread;
+		/// \brief Checks the connection limits for a client that was just accepted. Called with the mutex locked.
+		bool accept_connection(const SocketName &peer_endpoint);
 
-		NetworkConditionVariable worker_event;
+		/// \brief Stops the accept threads and closes the TCP listeners
+		void stop_listen();
+
+		std::vector<std::unique_ptr<TCPListen>> tcp_listens;
+		std::unique_ptr<NetGameReactor> reactor;
+		std::unique_ptr<NetGameUDPTransport> udp_transport;
+		int io_thread_count = 0;
+		int listener_count = 1;
+		int flush_delay = 0;
+		bool compression_enabled = false;
+		int compression_threshold = 256;
+		NetGameLoadLimits limits;
+		std::vector<std::thread> listen_threads;
+
+		/// \brief One per listener, as a NetworkConditionVariable wakes a single waiting thread
+		std::vector<std::unique_ptr<NetworkConditionVariable>> listen_events;
 		std::mutex mutex;
 		bool stop_flag = false;
 		std::vector<NetGameConnection *> connections;
-		std::vector<NetGameNetworkEvent> events;
+		NetGameNetworkEventQueue events;
+
+		/// \brief Accepted TCP connections whose client_connected event has not been processed
+		std::atomic<int> pending_connections{0};
+		std::map<std::string, NetGameTokenBucket> connect_buckets;
+		enum { max_connect_buckets = 4096 };
 
 		Signal<void(NetGameConnection *)> sig_game_client_connected;
 		Signal<void(NetGameConnection *, const std::string &)> sig_game_client_disconnected;
@@ -0,0 +1,186 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Network/precomp.h"
+#include "API/Network/NetGame/snapshot_client.h"
+#include "API/Network/NetGame/client.h"
+#include "API/Network/NetGame/connection.h"
+#include "API/Network/NetGame/event.h"
+#include "snapshot_world.h"
+
+namespace clan
+{
+	class NetGameSnapshotClient_Impl
+	{
+	public:
+		unsigned int snapshot_id = 0;
+		std::map<unsigned int, std::shared_ptr<const NetGameSnapshotWorld>> history;
+
+		/// \brief Entities seen so far. Unlike the snapshot worlds, entities only leave this through explicit removals.
+		NetGameSnapshotWorld entities;
+
+		Signal<void(unsigned int)> sig_entity_updated;
+		Signal<void(unsigned int)> sig_entity_removed;
+	};
+
+	NetGameSnapshotClient::NetGameSnapshotClient() : impl(std::make_shared<NetGameSnapshotClient_Impl>())
+	{
+	}
+
+	NetGameSnapshotClient::~NetGameSnapshotClient()
+	{
+	}
+
+	bool NetGameSnapshotClient::process_event(NetGameClient &client, const NetGameEvent &e)
+	{
+		if (e.get_name() != NetGameSnapshotProtocol::snapshot_event_name())
+			return false;
+
+		unsigned int snapshot_id = e.get_argument(0).get_uinteger();
+		unsigned int baseline_id = e.get_argument(1).get_uinteger();
+
+		// Snapshots arriving late are useless, the server never encodes against them after a newer one was acked
+		if (snapshot_id <= impl->snapshot_id)
+			return true;
+
+		std::shared_ptr<NetGameSnapshotWorld> world;
+		if (baseline_id == 0)
+		{
+			world = std::make_shared<NetGameSnapshotWorld>();
+		}
+		else
+		{
+			auto it = impl->history.find(baseline_id);
+			if (it == impl->history.end())
+				return true;
+			world = std::make_shared<NetGameSnapshotWorld>(*it->second);
+		}
+
+		unsigned int pos = 2;
+		unsigned int removed_count = e.get_argument(pos++).get_uinteger();
+		std::vector<unsigned int> removed;
+		for (unsigned int i = 0; i < removed_count; i++)
+		{
+			unsigned int id = e.get_argument(pos++).get_uinteger();
+			world->erase(id);
+			removed.push_back(id);
+		}
+
+		std::vector<unsigned int> updated;
+		while (pos < e.get_argument_count())
+		{
+			unsigned int id = e.get_argument(pos++).get_uinteger();
+			unsigned int field_count = e.get_argument(pos++).get_uinteger();
+			unsigned int mask = e.get_argument(pos++).get_uinteger();
+			if (field_count > NetGameSnapshotProtocol::max_fields)
+				throw Exception("Invalid snapshot");
+
+			auto base_it = world->find(id);
+			const std::vector<NetGameEventValue> *base_fields = base_it != world->end() ? base_it->second.get() : nullptr;
+
+			std::shared_ptr<std::vector<NetGameEventValue>> fields = std::make_shared<std::vector<NetGameEventValue>>(field_count);
+			for (unsigned int i = 0; i < field_count; i++)
+			{
+				if (mask & (1u << i))
+					(*fields)[i] = e.get_argument(pos++);
+				else if (base_fields && i < base_fields->size())
+					(*fields)[i] = (*base_fields)[i];
+				else
+					throw Exception("Invalid snapshot");
+			}
+
+			(*world)[id] = fields;
+			updated.push_back(id);
+		}
+
+		impl->snapshot_id = snapshot_id;
+		impl->history[snapshot_id] = world;
+
+		// The server never uses a baseline older than its history length
+		while (!impl->history.empty() && impl->history.begin()->first + NetGameSnapshotProtocol::max_history <= snapshot_id)
+			impl->history.erase(impl->history.begin());
+
+		client.send_event(NetGameEvent(NetGameSnapshotProtocol::ack_event_name(), { NetGameEventValue(snapshot_id) }), NetGameReliability::unreliable);
+
+		for (unsigned int id : removed)
+		{
+			if (impl->entities.erase(id))
+				impl->sig_entity_removed(id);
+		}
+		for (unsigned int id : updated)
+		{
+			impl->entities[id] = (*world)[id];
+			impl->sig_entity_updated(id);
+		}
+
+		return true;
+	}
+
+	void NetGameSnapshotClient::reset()
+	{
+		impl->snapshot_id = 0;
+		impl->history.clear();
+		impl->entities.clear();
+	}
+
+	unsigned int NetGameSnapshotClient::get_snapshot_id() const
+	{
+		return impl->snapshot_id;
+	}
+
+	std::vector<unsigned int> NetGameSnapshotClient::get_entity_ids() const
+	{
+		std::vector<unsigned int> ids;
+		for (const auto &it : impl->entities)
+			ids.push_back(it.first);
+		return ids;
+	}
+
+	bool NetGameSnapshotClient::has_entity(unsigned int id) const
+	{
+		return impl->entities.find(id) != impl->entities.end();
+	}
+
+	std::vector<NetGameEventValue> NetGameSnapshotClient::get_entity(unsigned int id) const
+	{
+		auto it = impl->entities.find(id);
+		if (it == impl->entities.end())
+			throw Exception("Unknown snapshot entity");
+		return *it->second;
+	}
+
+	Signal<void(unsigned int)> &NetGameSnapshotClient::sig_entity_updated()
+	{
+		return impl->sig_entity_updated;
+	}
+
+	Signal<void(unsigned int)> &NetGameSnapshotClient::sig_entity_removed()
+	{
+		return impl->sig_entity_removed;
+	}
+}
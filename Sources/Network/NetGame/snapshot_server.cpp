@@ -0,0 +1,276 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Network/precomp.h"
+#include "API/Network/NetGame/snapshot_server.h"
+#include "API/Network/NetGame/connection.h"
+#include "API/Network/NetGame/event.h"
+#include "snapshot_world.h"
+#include "network_data.h"
+#include <algorithm>
+#include <deque>
+
+namespace clan
+{
+	class NetGameSnapshotServer_Impl
+	{
+	public:
+		struct Entity
+		{
+			std::shared_ptr<const std::vector<NetGameEventValue>> fields;
+			float priority;
+		};
+
+		struct SentSnapshot
+		{
+			unsigned int id;
+			std::shared_ptr<const NetGameSnapshotWorld> world;
+			std::vector<unsigned int> removed;
+		};
+
+		struct Client
+		{
+			unsigned int next_snapshot_id = 1;
+			unsigned int baseline_id = 0;
+			std::shared_ptr<const NetGameSnapshotWorld> baseline;
+			std::deque<SentSnapshot> sent;
+			std::map<unsigned int, float> accumulators;
+
+			/// \brief Entities the client may know about, and the last snapshot that carried them
+			std::map<unsigned int, unsigned int> known;
+		};
+
+		struct Candidate
+		{
+			unsigned int id;
+			const Entity *entity;
+			const std::vector<NetGameEventValue> *base_fields;
+			float accumulator;
+		};
+
+		Client &get_client(NetGameConnection *connection)
+		{
+			auto it = clients.find(connection);
+			if (it == clients.end())
+				throw Exception("Connection is not a snapshot client");
+			return it->second;
+		}
+
+		static unsigned int changed_mask(const std::vector<NetGameEventValue> &fields, const std::vector<NetGameEventValue> *base_fields)
+		{
+			unsigned int mask = 0;
+			for (unsigned int i = 0; i < fields.size(); i++)
+			{
+				if (!base_fields || i >= base_fields->size() || !NetGameSnapshotProtocol::values_equal(fields[i], (*base_fields)[i]))
+					mask |= 1u << i;
+			}
+			return mask;
+		}
+
+		int max_snapshot_bytes = 0;
+		std::map<unsigned int, Entity> entities;
+		std::map<NetGameConnection *, Client> clients;
+	};
+
+	NetGameSnapshotServer::NetGameSnapshotServer(int max_snapshot_bytes) : impl(std::make_shared<NetGameSnapshotServer_Impl>())
+	{
+		impl->max_snapshot_bytes = max_snapshot_bytes;
+	}
+
+	NetGameSnapshotServer::~NetGameSnapshotServer()
+	{
+	}
+
+	void NetGameSnapshotServer::set_entity(unsigned int id, const std::vector<NetGameEventValue> &fields, float priority)
+	{
+		if (fields.size() > NetGameSnapshotProtocol::max_fields)
+			throw Exception("Snapshot entities can have at most 32 fields");
+
+		NetGameSnapshotServer_Impl::Entity &entity = impl->entities[id];
+		entity.fields = std::make_shared<const std::vector<NetGameEventValue>>(fields);
+		entity.priority = priority;
+	}
+
+	void NetGameSnapshotServer::remove_entity(unsigned int id)
+	{
+		impl->entities.erase(id);
+	}
+
+	void NetGameSnapshotServer::add_client(NetGameConnection *connection)
+	{
+		impl->clients[connection] = NetGameSnapshotServer_Impl::Client();
+	}
+
+	void NetGameSnapshotServer::remove_client(NetGameConnection *connection)
+	{
+		impl->clients.erase(connection);
+	}
+
+	void NetGameSnapshotServer::send_snapshots()
+	{
+		for (auto &it : impl->clients)
+			it.first->send_event(create_snapshot(it.first), NetGameReliability::unreliable);
+	}
+
+	NetGameEvent NetGameSnapshotServer::create_snapshot(NetGameConnection *connection)
+	{
+		NetGameSnapshotServer_Impl::Client &client = impl->get_client(connection);
+
+		// The client only keeps a limited history. Fall back to a full update if no ack arrived for too long.
+		if (client.baseline && client.next_snapshot_id - client.baseline_id >= NetGameSnapshotProtocol::max_history)
+		{
+			client.baseline_id = 0;
+			client.baseline.reset();
+		}
+
+		static const NetGameSnapshotWorld empty_world;
+		const NetGameSnapshotWorld &base = client.baseline ? *client.baseline : empty_world;
+
+		unsigned int snapshot_id = client.next_snapshot_id++;
+		std::shared_ptr<NetGameSnapshotWorld> world = std::make_shared<NetGameSnapshotWorld>(base);
+
+		// Removals are repeated until a snapshot carrying them is acknowledged
+		std::vector<unsigned int> removed;
+		for (const auto &it : client.known)
+		{
+			if (impl->entities.find(it.first) == impl->entities.end())
+			{
+				removed.push_back(it.first);
+				world->erase(it.first);
+				client.accumulators.erase(it.first);
+			}
+		}
+
+		// Only entities that differ from what the client acknowledged compete for the budget
+		std::vector<NetGameSnapshotServer_Impl::Candidate> candidates;
+		for (const auto &it : impl->entities)
+		{
+			auto base_it = base.find(it.first);
+			const std::vector<NetGameEventValue> *base_fields = nullptr;
+			if (base_it != base.end())
+			{
+				if (base_it->second == it.second.fields)
+				{
+					client.accumulators.erase(it.first);
+					continue;
+				}
+				base_fields = base_it->second.get();
+				if (NetGameSnapshotServer_Impl::changed_mask(*it.second.fields, base_fields) == 0 && base_fields->size() == it.second.fields->size())
+				{
+					(*world)[it.first] = it.second.fields;
+					client.accumulators.erase(it.first);
+					continue;
+				}
+			}
+
+			float &accumulator = client.accumulators[it.first];
+			accumulator += it.second.priority;
+			candidates.push_back({ it.first, &it.second, base_fields, accumulator });
+		}
+
+		std::stable_sort(candidates.begin(), candidates.end(), [](const NetGameSnapshotServer_Impl::Candidate &a, const NetGameSnapshotServer_Impl::Candidate &b) { return a.accumulator > b.accumulator; });
+
+		NetGameEvent e(NetGameSnapshotProtocol::snapshot_event_name());
+		e.add_argument(snapshot_id);
+		e.add_argument(client.baseline_id);
+		e.add_argument((unsigned int)removed.size());
+		for (unsigned int id : removed)
+			e.add_argument(id);
+
+		const int uint_size = 5;
+		int bytes = 3 + (int)strlen(NetGameSnapshotProtocol::snapshot_event_name()) + uint_size * (3 + (int)removed.size());
+		bool any_sent = false;
+		for (const auto &candidate : candidates)
+		{
+			const std::vector<NetGameEventValue> &fields = *candidate.entity->fields;
+			unsigned int mask = NetGameSnapshotServer_Impl::changed_mask(fields, candidate.base_fields);
+
+			int entity_bytes = uint_size * 3;
+			for (unsigned int i = 0; i < fields.size(); i++)
+			{
+				if (mask & (1u << i))
+					entity_bytes += NetGameNetworkData::get_encoded_length(fields[i]);
+			}
+
+			// Always send at least one entity so a single large entity cannot starve
+			if (any_sent && bytes + entity_bytes > impl->max_snapshot_bytes)
+				continue;
+
+			bytes += entity_bytes;
+			any_sent = true;
+
+			e.add_argument(candidate.id);
+			e.add_argument((unsigned int)fields.size());
+			e.add_argument(mask);
+			for (unsigned int i = 0; i < fields.size(); i++)
+			{
+				if (mask & (1u << i))
+					e.add_argument(fields[i]);
+			}
+
+			(*world)[candidate.id] = candidate.entity->fields;
+			client.accumulators[candidate.id] = 0.0f;
+			client.known[candidate.id] = snapshot_id;
+		}
+
+		client.sent.push_back({ snapshot_id, world, removed });
+		while (client.sent.size() > NetGameSnapshotProtocol::max_history)
+			client.sent.pop_front();
+
+		return e;
+	}
+
+	bool NetGameSnapshotServer::process_event(NetGameConnection *connection, const NetGameEvent &e)
+	{
+		if (e.get_name() != NetGameSnapshotProtocol::ack_event_name())
+			return false;
+
+		auto it = impl->clients.find(connection);
+		if (it == impl->clients.end())
+			return true;
+
+		NetGameSnapshotServer_Impl::Client &client = it->second;
+		unsigned int snapshot_id = e.get_argument(0).get_uinteger();
+		while (!client.sent.empty() && client.sent.front().id <= snapshot_id)
+		{
+			if (client.sent.front().id == snapshot_id)
+			{
+				client.baseline_id = snapshot_id;
+				client.baseline = client.sent.front().world;
+				for (unsigned int id : client.sent.front().removed)
+				{
+					auto known_it = client.known.find(id);
+					if (known_it != client.known.end() && known_it->second < snapshot_id)
+						client.known.erase(known_it);
+				}
+			}
+			client.sent.pop_front();
+		}
+		return true;
+	}
+}
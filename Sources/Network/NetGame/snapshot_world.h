@@ -0,0 +1,88 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "API/Network/NetGame/event_value.h"
+#include "API/Core/System/databuffer.h"
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace clan
+{
+	/// \brief Entity state as seen by one client at one snapshot
+	///
+	/// Entity field vectors are immutable and shared between snapshots, so keeping a world per sent snapshot only copies pointers.
+	typedef std::map<unsigned int, std::shared_ptr<const std::vector<NetGameEventValue>>> NetGameSnapshotWorld;
+
+	class NetGameSnapshotProtocol
+	{
+	public:
+		static const char *snapshot_event_name() { return "_snapshot"; }
+		static const char *ack_event_name() { return "_snapshot_ack"; }
+
+		enum { max_fields = 32, max_history = 64 };
+
+		static bool values_equal(const NetGameEventValue &a, const NetGameEventValue &b)
+		{
+			if (a.get_type() != b.get_type())
+				return false;
+
+			switch (a.get_type())
+			{
+			case NetGameEventValue::null: return true;
+			case NetGameEventValue::integer: return a.get_integer() == b.get_integer();
+			case NetGameEventValue::uinteger: return a.get_uinteger() == b.get_uinteger();
+			case NetGameEventValue::character: return a.get_character() == b.get_character();
+			case NetGameEventValue::ucharacter: return a.get_ucharacter() == b.get_ucharacter();
+			case NetGameEventValue::string: return a.get_string() == b.get_string();
+			case NetGameEventValue::boolean: return a.get_boolean() == b.get_boolean();
+			case NetGameEventValue::number: return a.get_number() == b.get_number();
+			case NetGameEventValue::binary:
+			{
+				const DataBuffer &da = a.get_binary(), &db = b.get_binary();
+				return da.get_size() == db.get_size() && memcmp(da.get_data(), db.get_data(), da.get_size()) == 0;
+			}
+			case NetGameEventValue::complex:
+			{
+				if (a.get_member_count() != b.get_member_count())
+					return false;
+				for (unsigned int i = 0; i < a.get_member_count(); i++)
+				{
+					if (!values_equal(a.get_member(i), b.get_member(i)))
+						return false;
+				}
+				return true;
+			}
+			default:
+				return false;
+			}
+		}
+	};
+}
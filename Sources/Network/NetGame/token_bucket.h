@@ -0,0 +1,85 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <cstdint>
+
+namespace clan
+{
+	/// \brief Token bucket rate limiter. Not thread safe.
+	class NetGameTokenBucket
+	{
+	public:
+		NetGameTokenBucket() { }
+
+		/// \param rate = Tokens added per second. 0 disables the bucket.
+		/// \param burst = Bucket size. Defaults to one second worth of tokens.
+		NetGameTokenBucket(float rate, int burst, uint64_t now_milliseconds)
+			: rate(rate), burst(burst > 0 ? (float)burst : rate), tokens(this->burst), last_time(now_milliseconds)
+		{
+		}
+
+		bool is_enabled() const { return rate > 0.0f; }
+
+		/// \brief Takes the tokens if that many are available
+		bool consume(float amount, uint64_t now_milliseconds)
+		{
+			if (!is_enabled())
+				return true;
+			refill(now_milliseconds);
+			if (tokens < amount)
+				return false;
+			tokens -= amount;
+			return true;
+		}
+
+		/// \brief Returns true if the bucket has refilled completely, so forgetting it changes nothing
+		bool is_full(uint64_t now_milliseconds)
+		{
+			refill(now_milliseconds);
+			return tokens >= burst;
+		}
+
+	private:
+		void refill(uint64_t now_milliseconds)
+		{
+			if (now_milliseconds <= last_time)
+				return;
+			tokens += rate * (now_milliseconds - last_time) / 1000.0f;
+			if (tokens > burst)
+				tokens = burst;
+			last_time = now_milliseconds;
+		}
+
+		float rate = 0.0f;
+		float burst = 0.0f;
+		float tokens = 0.0f;
+		uint64_t last_time = 0;
+	};
+}
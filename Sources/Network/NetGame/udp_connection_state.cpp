@@ -0,0 +1,149 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "Network/precomp.h"
+#include "udp_connection_state.h"
+
+namespace clan
+{
+	NetGameUDPConnectionState::NetGameUDPConnectionState() : local_sequence(0), remote_received(false), next_ack(0), next_ack_bits(0), round_trip_time(0.0f)
+	{
+	}
+
+	unsigned short NetGameUDPConnectionState::write_header(void *packet_data, uint64_t now_microseconds)
+	{
+		local_sequence++;
+
+		SentPacket &sent = sent_packets[local_sequence % send_window];
+		sent.sequence = local_sequence;
+		sent.in_flight = true;
+		sent.send_time = now_microseconds;
+
+		unsigned int *data = static_cast<unsigned int *>(packet_data);
+		data[0] = protocol_magic;
+		data[1] = ((unsigned int)local_sequence << 16) | next_ack;
+		data[2] = next_ack_bits;
+
+		return local_sequence;
+	}
+
+	bool NetGameUDPConnectionState::read_header(const DataBufferView &packet, uint64_t now_microseconds, std::vector<unsigned short> &out_acked_sequences, bool &out_duplicate)
+	{
+		out_acked_sequences.clear();
+		out_duplicate = false;
+
+		if (packet.get_size() < header_size)
+			return false;
+
+		unsigned int data[3];
+		memcpy(data, packet.get_data(), header_size);
+		unsigned int protocol_id = data[0];
+		unsigned short sequence = data[1] >> 16;
+		unsigned short ack = data[1] & 0xffff;
+		unsigned int ack_bits = data[2];
+
+		if (protocol_id != protocol_magic)
+			return false;
+
+		out_duplicate = !update_received_packets_ack(sequence);
+
+		sent_packet_acknowledged(ack, now_microseconds, out_acked_sequences);
+		for (unsigned int i = 0; i < 32; i++)
+		{
+			if (ack_bits & (1u << i))
+				sent_packet_acknowledged(ack - 1 - i, now_microseconds, out_acked_sequences);
+		}
+
+		return true;
+	}
+
+	void NetGameUDPConnectionState::sent_packet_acknowledged(unsigned short sequence, uint64_t now_microseconds, std::vector<unsigned short> &out_acked_sequences)
+	{
+		// The same packet is acknowledged by every packet the peer sends until it falls out of the ack bitfield
+		SentPacket &sent = sent_packets[sequence % send_window];
+		if (!sent.in_flight || sent.sequence != sequence)
+			return;
+
+		sent.in_flight = false;
+
+		float packet_rtt = (now_microseconds - sent.send_time) / 1000.0f;
+		if (round_trip_time != 0.0f)
+			round_trip_time += (packet_rtt - round_trip_time) * 0.1f;
+		else
+			round_trip_time = packet_rtt;
+
+		out_acked_sequences.push_back(sequence);
+	}
+
+	bool NetGameUDPConnectionState::update_received_packets_ack(unsigned short sequence)
+	{
+		if (!remote_received)
+		{
+			remote_received = true;
+			next_ack = sequence;
+			next_ack_bits = 0;
+			return true;
+		}
+
+		int delta = sequence_delta(sequence, next_ack);
+		if (delta > 0)
+		{
+			next_ack = sequence;
+			if (delta < 32)
+				next_ack_bits = ((next_ack_bits << 1) | 1) << (delta - 1);
+			else if (delta == 32)
+				next_ack_bits = 1u << 31;
+			else
+				next_ack_bits = 0;
+			return true;
+		}
+		else if (delta < 0 && delta >= -32)
+		{
+			unsigned int bit = 1u << (-delta - 1);
+			if (next_ack_bits & bit)
+				return false;
+			next_ack_bits |= bit;
+			return true;
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	int NetGameUDPConnectionState::sequence_delta(unsigned int s1, unsigned int s2)
+	{
+		int delta = (int)(s1 & 0xffff) - (int)(s2 & 0xffff);
+		if (delta >= 32768)
+			delta -= 65536;
+		else if (delta < -32768)
+			delta += 65536;
+		return delta;
+	}
+}
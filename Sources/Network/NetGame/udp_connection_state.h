@@ -0,0 +1,90 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include "API/Core/System/databuffer_view.h"
+#include <cstdint>
+#include <vector>
+
+namespace clan
+{
+	/// \brief Packet layer of the UDP NetGame transport
+	///
+	/// Every packet starts with a header holding its sequence number, the latest sequence number
+	/// received from the peer and a bitfield acknowledging the 32 packets before it. Acknowledged
+	/// packets update the round trip time estimate.
+	class NetGameUDPConnectionState
+	{
+	public:
+		NetGameUDPConnectionState();
+
+		enum { header_size = 3 * 4 };
+
+		/// \brief Writes the header of the next outgoing packet
+		/** \return The sequence number of the packet*/
+		unsigned short write_header(void *data, uint64_t now_microseconds);
+
+		/// \brief Reads the header of a received packet
+		/** param: out_acked_sequences = Our packets acknowledged for the first time by this packet
+			param: out_duplicate = Set if the packet was received before or is too old to tell
+			\return false if the packet is not a NetGame packet*/
+		bool read_header(const DataBufferView &packet, uint64_t now_microseconds, std::vector<unsigned short> &out_acked_sequences, bool &out_duplicate);
+
+		/// \brief Smoothed round trip time in milliseconds
+		float get_round_trip_time() const { return round_trip_time; }
+
+		/// \brief Signed distance between two sequence numbers, taking wrap-around into account
+		static int sequence_delta(unsigned int s1, unsigned int s2);
+
+	private:
+		void sent_packet_acknowledged(unsigned short sequence, uint64_t now_microseconds, std::vector<unsigned short> &out_acked_sequences);
+		bool update_received_packets_ack(unsigned short sequence);
+
+		enum { send_window = 64 };
+
+		struct SentPacket
+		{
+			unsigned short sequence = 0;
+			bool in_flight = false;
+			uint64_t send_time = 0;
+		};
+
+		unsigned short local_sequence;
+
+		bool remote_received;
+		unsigned short next_ack;
+		unsigned int next_ack_bits;
+
+		float round_trip_time;
+		SentPacket sent_packets[send_window];
+
+		static const unsigned int protocol_magic = (unsigned int)'c' | ((unsigned int)'l' << 8) | ((unsigned int)'a' << 16) | ((unsigned int)'n' << 24);
+	};
+}
@@ -0,0 +1,264 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "Network/precomp.h"
+#include "udp_peer.h"
+#include "network_data.h"
+#include "API/Core/Math/cl_math.h"
+#include "API/Core/System/system.h"
+
+namespace clan
+{
+	NetGameUDPPeer::NetGameUDPPeer(const SocketName &name, uint64_t now_microseconds) : stats(std::make_shared<NetGameConnectionStatsCollector>()), name(name), received_unordered(65536), last_receive_time(now_microseconds)
+	{
+	}
+
+	void NetGameUDPPeer::queue_event(const NetGameEvent &game_event, NetGameReliability reliability)
+	{
+		uint64_t encode_start = System::get_microseconds();
+		DataBuffer data;
+		NetGameNetworkData::send_data(data, game_event);
+		uint64_t now = System::get_microseconds();
+		stats->event_sent(game_event.get_name(), data.get_size(), now - encode_start);
+
+		switch (reliability)
+		{
+		case NetGameReliability::unreliable:
+			unreliable.push_back(data);
+			break;
+		case NetGameReliability::reliable_unordered:
+		{
+			OutgoingMessage &message = reliable_unordered[next_unordered_id++];
+			message.data = data;
+			message.queue_time = now;
+			break;
+		}
+		case NetGameReliability::reliable_ordered:
+		{
+			OutgoingMessage &message = reliable_ordered[next_ordered_id++];
+			message.data = data;
+			message.queue_time = now;
+			break;
+		}
+		}
+	}
+
+	void NetGameUDPPeer::get_queue_stats(uint64_t now_microseconds, NetGameConnectionStats &out_stats) const
+	{
+		out_stats.send_queue_length = unreliable.size() + reliable_unordered.size() + reliable_ordered.size();
+
+		// Message ids only grow, so the first message in each map is the oldest
+		uint64_t oldest = now_microseconds;
+		if (!reliable_unordered.empty())
+			oldest = min(oldest, reliable_unordered.begin()->second.queue_time);
+		if (!reliable_ordered.empty())
+			oldest = min(oldest, reliable_ordered.begin()->second.queue_time);
+		out_stats.send_queue_age = (int)((now_microseconds - oldest) / 1000);
+		out_stats.round_trip_time = get_round_trip_time();
+	}
+
+	bool NetGameUDPPeer::create_packet(DataBuffer &packet, uint64_t now_microseconds)
+	{
+		packet.set_size(NetGameUDPConnectionState::header_size);
+
+		uint64_t resend_delay = clamp((uint64_t)(get_round_trip_time() * 1500.0f) + 10 * 1000, (uint64_t)min_resend_delay, (uint64_t)max_resend_delay);
+
+		std::vector<MessageRef> messages;
+		add_reliable_messages(packet, message_reliable_ordered, reliable_ordered, now_microseconds, resend_delay, messages);
+		add_reliable_messages(packet, message_reliable_unordered, reliable_unordered, now_microseconds, resend_delay, messages);
+
+		size_t unreliable_sent = 0;
+		while (unreliable_sent < unreliable.size() && append_message(packet, message_unreliable, 0, unreliable[unreliable_sent]))
+			unreliable_sent++;
+		unreliable.erase(unreliable.begin(), unreliable.begin() + unreliable_sent);
+
+		bool has_messages = packet.get_size() > NetGameUDPConnectionState::header_size;
+		if (!has_messages && !ack_pending && now_microseconds - last_send_time < keep_alive_interval)
+			return false;
+
+		unsigned short sequence = state.write_header(packet.get_data(), now_microseconds);
+
+		PacketMessages &contents = packet_contents[sequence % packet_window];
+		contents.sequence = sequence;
+		contents.messages.swap(messages);
+
+		ack_pending = false;
+		last_send_time = now_microseconds;
+		return true;
+	}
+
+	void NetGameUDPPeer::add_reliable_messages(DataBuffer &packet, MessageType type, std::map<unsigned int, OutgoingMessage> &messages, uint64_t now_microseconds, uint64_t resend_delay, std::vector<MessageRef> &packet_messages)
+	{
+		for (auto &it : messages)
+		{
+			OutgoingMessage &message = it.second;
+			if (message.sent && now_microseconds - message.last_send_time < resend_delay)
+				continue;
+
+			if (!append_message(packet, type, it.first, message.data))
+				break;
+
+			if (message.sent)
+				stats->message_resent();
+			message.sent = true;
+			message.last_send_time = now_microseconds;
+			packet_messages.push_back(MessageRef(type, it.first));
+		}
+	}
+
+	bool NetGameUDPPeer::append_message(DataBuffer &packet, MessageType type, unsigned int id, const DataBuffer &data)
+	{
+		unsigned int message_size = 1 + (type != message_unreliable ? 2 : 0) + data.get_size();
+
+		// A message larger than the packet size limit is sent alone
+		unsigned int pos = packet.get_size();
+		if (pos + message_size > max_packet_size && pos > NetGameUDPConnectionState::header_size)
+			return false;
+
+		packet.set_size(pos + message_size);
+		unsigned char *d = packet.get_data<unsigned char>() + pos;
+		*(d++) = type;
+		if (type != message_unreliable)
+		{
+			unsigned short short_id = id;
+			memcpy(d, &short_id, 2);
+			d += 2;
+		}
+		memcpy(d, data.get_data(), data.get_size());
+		return true;
+	}
+
+	bool NetGameUDPPeer::receive_packet(const DataBufferView &packet, uint64_t now_microseconds, std::vector<NetGameEvent> &out_events)
+	{
+		bool duplicate = false;
+		if (!state.read_header(packet, now_microseconds, acked_sequences, duplicate))
+			return false;
+
+		last_receive_time = now_microseconds;
+		connected = true;
+
+		for (unsigned short sequence : acked_sequences)
+			packet_acked(sequence);
+
+		unsigned int pos = NetGameUDPConnectionState::header_size;
+		if (pos < packet.get_size())
+			ack_pending = true;
+
+		while (pos < packet.get_size())
+		{
+			MessageType type = (MessageType)packet.get_data<unsigned char>()[pos++];
+			if (type > message_reliable_ordered)
+				throw Exception("Invalid network data");
+
+			unsigned short id = 0;
+			if (type != message_unreliable)
+			{
+				if (pos + 2 > packet.get_size())
+					throw Exception("Invalid network data");
+				memcpy(&id, packet.get_data() + pos, 2);
+				pos += 2;
+			}
+
+			int bytes_consumed = 0;
+			uint64_t decode_start = System::get_microseconds();
+			NetGameEvent game_event = NetGameNetworkData::receive_data(packet.skip(pos), bytes_consumed);
+			if (bytes_consumed == 0)
+				throw Exception("Invalid network data");
+			pos += bytes_consumed;
+			stats->event_received(game_event.get_name(), bytes_consumed, System::get_microseconds() - decode_start);
+
+			if (type == message_unreliable && duplicate)
+				continue;
+
+			message_received(type, id, game_event, out_events);
+		}
+
+		return true;
+	}
+
+	void NetGameUDPPeer::message_received(MessageType type, unsigned short id, NetGameEvent game_event, std::vector<NetGameEvent> &out_events)
+	{
+		switch (type)
+		{
+		case message_unreliable:
+			out_events.push_back(game_event);
+			break;
+
+		case message_reliable_unordered:
+			if (!received_unordered[id])
+			{
+				// Forget ids half the sequence space away so they can be received again after wrap-around
+				received_unordered[id] = true;
+				received_unordered[(id + 32768) & 0xffff] = false;
+				out_events.push_back(game_event);
+			}
+			break;
+
+		case message_reliable_ordered:
+		{
+			int delta = NetGameUDPConnectionState::sequence_delta(id, next_expected_ordered);
+			if (delta == 0)
+			{
+				out_events.push_back(game_event);
+				next_expected_ordered++;
+				while (true)
+				{
+					auto it = early_ordered.find(next_expected_ordered);
+					if (it == early_ordered.end())
+						break;
+					out_events.push_back(it->second);
+					early_ordered.erase(it);
+					next_expected_ordered++;
+				}
+			}
+			else if (delta > 0)
+			{
+				early_ordered.insert(std::make_pair(id, game_event));
+			}
+			break;
+		}
+		}
+	}
+
+	void NetGameUDPPeer::packet_acked(unsigned short sequence)
+	{
+		PacketMessages &contents = packet_contents[sequence % packet_window];
+		if (contents.sequence != sequence)
+			return;
+
+		for (const MessageRef &message : contents.messages)
+		{
+			if (message.type == message_reliable_ordered)
+				reliable_ordered.erase(message.id);
+			else
+				reliable_unordered.erase(message.id);
+		}
+		contents.messages.clear();
+	}
+}
@@ -0,0 +1,146 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include "API/Network/NetGame/connection.h"
+#include "API/Network/NetGame/event.h"
+#include "API/Network/Socket/socket_name.h"
+#include "API/Core/System/databuffer.h"
+#include "udp_connection_state.h"
+#include "connection_stats_collector.h"
+#include <map>
+#include <vector>
+
+namespace clan
+{
+	/// \brief Message layer of the UDP NetGame transport for one remote end point
+	///
+	/// <p>Events are packed into packets as messages. Unreliable messages are sent once.
+	///    Reliable messages are kept until a packet containing them is acknowledged, and are
+	///    sent again when no acknowledgement arrived within the resend delay derived from the
+	///    round trip time. Reliable ordered messages are delivered in the order they were sent.</p>
+	///    <p>Not thread safe. NetGameUDPTransport serializes all access.</p>
+	class NetGameUDPPeer
+	{
+	public:
+		NetGameUDPPeer(const SocketName &name, uint64_t now_microseconds);
+
+		/// \brief Queues an event for sending
+		void queue_event(const NetGameEvent &game_event, NetGameReliability reliability);
+
+		/// \brief Decodes a received packet
+		/** \return false if the packet is not a valid NetGame packet*/
+		bool receive_packet(const DataBufferView &packet, uint64_t now_microseconds, std::vector<NetGameEvent> &out_events);
+
+		/// \brief Builds the next packet to send
+		/** \return false if there is nothing to send*/
+		bool create_packet(DataBuffer &packet, uint64_t now_microseconds);
+
+		/// \brief Returns true if all reliable messages have been acknowledged
+		bool is_reliable_sent() const { return reliable_unordered.empty() && reliable_ordered.empty(); }
+
+		uint64_t get_last_receive_time() const { return last_receive_time; }
+
+		float get_round_trip_time() const { return state.get_round_trip_time(); }
+
+		/// \brief Fills in the queue length, queue age and round trip time
+		void get_queue_stats(uint64_t now_microseconds, NetGameConnectionStats &out_stats) const;
+
+		std::shared_ptr<NetGameConnectionStatsCollector> stats;
+
+		SocketName name;
+		NetGameConnection *connection = nullptr;
+		bool connected = false;
+		bool closing = false;
+		bool closed = false;
+
+		enum
+		{
+			max_packet_size = 1200,
+			keep_alive_interval = 250 * 1000,
+			min_resend_delay = 30 * 1000,
+			max_resend_delay = 1000 * 1000
+		};
+
+	private:
+		enum MessageType
+		{
+			message_unreliable,
+			message_reliable_unordered,
+			message_reliable_ordered
+		};
+
+		struct OutgoingMessage
+		{
+			DataBuffer data;
+			uint64_t queue_time = 0;
+			uint64_t last_send_time = 0;
+			bool sent = false;
+		};
+
+		struct MessageRef
+		{
+			MessageRef(MessageType type, unsigned int id) : type(type), id(id) { }
+			MessageType type;
+			unsigned int id;
+		};
+
+		struct PacketMessages
+		{
+			unsigned short sequence = 0;
+			std::vector<MessageRef> messages;
+		};
+
+		bool append_message(DataBuffer &packet, MessageType type, unsigned int id, const DataBuffer &data);
+		void add_reliable_messages(DataBuffer &packet, MessageType type, std::map<unsigned int, OutgoingMessage> &messages, uint64_t now_microseconds, uint64_t resend_delay, std::vector<MessageRef> &packet_messages);
+		void packet_acked(unsigned short sequence);
+		void message_received(MessageType type, unsigned short id, NetGameEvent game_event, std::vector<NetGameEvent> &out_events);
+
+		NetGameUDPConnectionState state;
+
+		std::vector<DataBuffer> unreliable;
+		std::map<unsigned int, OutgoingMessage> reliable_unordered;
+		std::map<unsigned int, OutgoingMessage> reliable_ordered;
+		unsigned int next_unordered_id = 0;
+		unsigned int next_ordered_id = 0;
+
+		enum { packet_window = 64 };
+		PacketMessages packet_contents[packet_window];
+
+		std::vector<bool> received_unordered;
+		unsigned short next_expected_ordered = 0;
+		std::map<unsigned short, NetGameEvent> early_ordered;
+
+		bool ack_pending = true;
+		uint64_t last_send_time = 0;
+		uint64_t last_receive_time;
+		std::vector<unsigned short> acked_sequences;
+	};
+}
@@ -0,0 +1,318 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "Network/precomp.h"
+#include "API/Network/NetGame/connection_site.h"
+#include "API/Core/System/system.h"
+#include "network_event.h"
+#include "udp_transport.h"
+
+namespace clan
+{
+	NetGameUDPTransport::NetGameUDPTransport(NetGameConnectionSite *site) : site(site), receive_buffer(receive_batch_size * max_datagram_size)
+	{
+		for (int i = 0; i < receive_batch_size; i++)
+		{
+			received_packets[i].data = receive_buffer.get_data() + i * max_datagram_size;
+			received_packets[i].capacity = max_datagram_size;
+		}
+	}
+
+	NetGameUDPTransport::~NetGameUDPTransport()
+	{
+		stop();
+	}
+
+	void NetGameUDPTransport::listen(const SocketName &endpoint, const std::function<void(const std::shared_ptr<NetGameUDPPeer> &)> &new_func_peer_connected)
+	{
+		socket.bind(endpoint);
+		is_listening = true;
+		func_peer_connected = new_func_peer_connected;
+	}
+
+	std::shared_ptr<NetGameUDPPeer> NetGameUDPTransport::add_peer(const SocketName &name)
+	{
+		// Packets arrive from the numeric address, so resolve the name before using it as a key
+		SocketName resolved_name(name.lookup_ipv4(), name.get_port());
+
+		std::unique_lock<std::mutex> lock(mutex);
+		auto peer = std::make_shared<NetGameUDPPeer>(resolved_name, System::get_microseconds());
+		peers[resolved_name] = peer;
+		return peer;
+	}
+
+	void NetGameUDPTransport::start()
+	{
+		stop_flag = false;
+		thread = std::thread(&NetGameUDPTransport::thread_main, this);
+	}
+
+	void NetGameUDPTransport::stop()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		stop_flag = true;
+		lock.unlock();
+		worker_event.notify();
+		if (thread.joinable())
+			thread.join();
+	}
+
+	void NetGameUDPTransport::attach(const std::shared_ptr<NetGameUDPPeer> &peer, NetGameConnection *connection)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		peer->connection = connection;
+	}
+
+	void NetGameUDPTransport::detach(const std::shared_ptr<NetGameUDPPeer> &peer)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		peer->connection = nullptr;
+
+		auto it = peers.find(peer->name);
+		if (it != peers.end() && it->second == peer)
+		{
+			// Tell the peer right away, as nothing will be sent to it anymore
+			if (!peer->closed)
+			{
+				peer->queue_event(NetGameEvent("_close"), NetGameReliability::unreliable);
+				if (peer->create_packet(send_buffer, System::get_microseconds()))
+					socket.send(send_buffer.get_data(), send_buffer.get_size(), peer->name);
+			}
+			peers.erase(it);
+		}
+		peer->closed = true;
+	}
+
+	void NetGameUDPTransport::send_event(const std::shared_ptr<NetGameUDPPeer> &peer, const NetGameEvent &game_event, NetGameReliability reliability)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		if (peer->closed || peer->closing)
+			return;
+		peer->queue_event(game_event, reliability);
+		lock.unlock();
+		worker_event.notify();
+	}
+
+	void NetGameUDPTransport::disconnect(const std::shared_ptr<NetGameUDPPeer> &peer)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		if (peer->closed || peer->closing)
+			return;
+		peer->queue_event(NetGameEvent("_close"), NetGameReliability::reliable_ordered);
+		peer->closing = true;
+		lock.unlock();
+		worker_event.notify();
+	}
+
+	void NetGameUDPTransport::thread_main()
+	{
+		while (true)
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			if (stop_flag)
+				break;
+
+			NetworkEvent *events[] = { &socket };
+			worker_event.wait(lock, 1, events, tick_interval);
+			if (stop_flag)
+				break;
+
+			uint64_t now = System::get_microseconds();
+			receive_packets(now);
+			send_packets(now);
+			lock.unlock();
+
+			// Connections for new peers are created outside the lock, as they attach to the transport
+			for (auto &peer : new_peers)
+			{
+				func_peer_connected(peer);
+				site->add_network_event(NetGameNetworkEvent(peer->connection, NetGameNetworkEvent::client_connected));
+			}
+			new_peers.clear();
+
+			lock.lock();
+			for (auto &posted : posted_events)
+				posted.connection = posted.peer->connection;
+			lock.unlock();
+
+			for (auto &posted : posted_events)
+			{
+				if (posted.connection)
+					site->add_network_event(NetGameNetworkEvent(posted.connection, posted.type, posted.game_event));
+			}
+			posted_events.clear();
+		}
+	}
+
+	void NetGameUDPTransport::get_stats(const std::shared_ptr<NetGameUDPPeer> &peer, NetGameConnectionStats &out_stats)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		peer->get_queue_stats(System::get_microseconds(), out_stats);
+	}
+
+	void NetGameUDPTransport::receive_packets(uint64_t now)
+	{
+		while (true)
+		{
+			int count = socket.read_batch(received_packets, receive_batch_size);
+			for (int i = 0; i < count; i++)
+				receive_packet(received_packets[i], now);
+			if (count < receive_batch_size)
+				break;
+		}
+	}
+
+	void NetGameUDPTransport::receive_packet(const UDPPacket &packet, uint64_t now)
+	{
+		const SocketName &from = packet.endpoint;
+		int received = packet.size;
+		unsigned int offset = (char *)packet.data - receive_buffer.get_data();
+
+		auto it = peers.find(from);
+		std::shared_ptr<NetGameUDPPeer> peer;
+		if (it != peers.end())
+		{
+			peer = it->second;
+		}
+		else if (is_listening)
+		{
+			peer = std::make_shared<NetGameUDPPeer>(from, now);
+		}
+		else
+		{
+			return;
+		}
+
+		bool was_connected = peer->connected;
+		received_events.clear();
+		try
+		{
+			if (!peer->receive_packet(DataBufferView(receive_buffer, offset, received), now, received_events))
+				return;
+			peer->stats->data_received(received);
+			peer->stats->round_trip_sample(peer->get_round_trip_time());
+		}
+		catch (const Exception &e)
+		{
+			if (it != peers.end())
+				close_peer(peer, e.message);
+			return;
+		}
+
+		if (it == peers.end())
+		{
+			// Do not create a connection for a peer that is saying goodbye
+			bool closing = false;
+			for (auto &game_event : received_events)
+				closing = closing || game_event.get_name() == "_close";
+			if (closing)
+				return;
+
+			peers[from] = peer;
+			new_peers.push_back(peer);
+		}
+		else if (!was_connected)
+		{
+			posted_events.push_back(PostedEvent(peer, NetGameNetworkEvent::client_connected, NetGameEvent(std::string())));
+		}
+
+		for (auto &game_event : received_events)
+		{
+			if (game_event.get_name() == "_close")
+			{
+				close_peer(peer, std::string());
+				break;
+			}
+			posted_events.push_back(PostedEvent(peer, NetGameNetworkEvent::event_received, game_event));
+		}
+	}
+
+	void NetGameUDPTransport::send_packets(uint64_t now)
+	{
+		for (auto it = peers.begin(); it != peers.end();)
+		{
+			std::shared_ptr<NetGameUDPPeer> peer = it->second;
+			++it;
+
+			if (now - peer->get_last_receive_time() > (peer->closing ? (uint64_t)close_timeout : (uint64_t)connection_timeout))
+			{
+				close_peer(peer, "Connection timed out");
+				continue;
+			}
+
+			send_peer_packets(peer.get(), now);
+
+			if (peer->closing && peer->is_reliable_sent())
+				close_peer(peer, std::string());
+		}
+
+		flush_packets();
+	}
+
+	void NetGameUDPTransport::send_peer_packets(NetGameUDPPeer *peer, uint64_t now)
+	{
+		for (int i = 0; i < max_packets_per_tick; i++)
+		{
+			size_t index = outgoing_packets.size();
+			if (index == send_buffers.size())
+				send_buffers.push_back(DataBuffer());
+
+			DataBuffer &buffer = send_buffers[index];
+			if (!peer->create_packet(buffer, now))
+				break;
+
+			UDPPacket packet;
+			packet.data = buffer.get_data();
+			packet.size = buffer.get_size();
+			packet.endpoint = peer->name;
+			outgoing_packets.push_back(packet);
+			peer->stats->data_sent(buffer.get_size());
+		}
+	}
+
+	void NetGameUDPTransport::flush_packets()
+	{
+		if (!outgoing_packets.empty())
+			socket.send_batch(outgoing_packets.data(), (int)outgoing_packets.size());
+		outgoing_packets.clear();
+	}
+
+	void NetGameUDPTransport::close_peer(const std::shared_ptr<NetGameUDPPeer> &peer, const std::string &reason)
+	{
+		if (peer->closed)
+			return;
+
+		peer->closed = true;
+		auto it = peers.find(peer->name);
+		if (it != peers.end() && it->second == peer)
+			peers.erase(it);
+
+		posted_events.push_back(PostedEvent(peer, NetGameNetworkEvent::client_disconnected, NetGameEvent(reason)));
+	}
+}
@@ -0,0 +1,129 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include "API/Network/Socket/udp_socket.h"
+#include "API/Network/Socket/socket_name.h"
+#include "API/Network/Socket/network_condition_variable.h"
+#include "udp_peer.h"
+#include "network_event.h"
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace clan
+{
+	class NetGameConnectionSite;
+
+	/// \brief Reliable UDP transport for NetGame
+	///
+	/// One UDP socket and one thread serve every peer. The thread receives packets, resends
+	/// unacknowledged reliable messages and sends queued events. Network events are posted to the
+	/// connection site without holding the transport lock.
+	class NetGameUDPTransport
+	{
+	public:
+		NetGameUDPTransport(NetGameConnectionSite *site);
+		~NetGameUDPTransport();
+
+		/// \brief Accepts packets from new peers on the end point
+		///
+		/// func_peer_connected is called from the transport thread for every new peer and must
+		/// create its NetGameConnection.
+		void listen(const SocketName &endpoint, const std::function<void(const std::shared_ptr<NetGameUDPPeer> &)> &func_peer_connected);
+
+		/// \brief Adds a peer to connect to
+		std::shared_ptr<NetGameUDPPeer> add_peer(const SocketName &name);
+
+		/// \brief Starts the transport thread
+		void start();
+
+		/// \brief Stops the transport thread
+		void stop();
+
+		void attach(const std::shared_ptr<NetGameUDPPeer> &peer, NetGameConnection *connection);
+		void detach(const std::shared_ptr<NetGameUDPPeer> &peer);
+		void send_event(const std::shared_ptr<NetGameUDPPeer> &peer, const NetGameEvent &game_event, NetGameReliability reliability);
+		void disconnect(const std::shared_ptr<NetGameUDPPeer> &peer);
+		void get_stats(const std::shared_ptr<NetGameUDPPeer> &peer, NetGameConnectionStats &out_stats);
+
+		enum
+		{
+			tick_interval = 10,
+			max_packets_per_tick = 16,
+			receive_batch_size = 8,
+			max_datagram_size = 64 * 1024,
+			connection_timeout = 10 * 1000 * 1000,
+			close_timeout = 3 * 1000 * 1000
+		};
+
+	private:
+		struct PostedEvent
+		{
+			PostedEvent(const std::shared_ptr<NetGameUDPPeer> &peer, NetGameNetworkEvent::Type type, const NetGameEvent &game_event) : peer(peer), type(type), game_event(game_event) { }
+
+			std::shared_ptr<NetGameUDPPeer> peer;
+			NetGameConnection *connection = nullptr;
+			NetGameNetworkEvent::Type type;
+			NetGameEvent game_event;
+		};
+
+		void thread_main();
+		void receive_packets(uint64_t now);
+		void receive_packet(const UDPPacket &packet, uint64_t now);
+		void send_packets(uint64_t now);
+		void send_peer_packets(NetGameUDPPeer *peer, uint64_t now);
+		void flush_packets();
+		void close_peer(const std::shared_ptr<NetGameUDPPeer> &peer, const std::string &reason);
+
+		NetGameConnectionSite *site;
+		UDPSocket socket;
+		std::thread thread;
+		NetworkConditionVariable worker_event;
+		std::mutex mutex;
+		bool stop_flag = false;
+		bool is_listening = false;
+		std::function<void(const std::shared_ptr<NetGameUDPPeer> &)> func_peer_connected;
+
+		std::map<SocketName, std::shared_ptr<NetGameUDPPeer>> peers;
+
+		// Used by the transport thread only
+		DataBuffer receive_buffer;
+		DataBuffer send_buffer;
+		UDPPacket received_packets[receive_batch_size];
+		std::vector<DataBuffer> send_buffers;
+		std::vector<UDPPacket> outgoing_packets;
+		std::vector<NetGameEvent> received_events;
+		std::vector<std::shared_ptr<NetGameUDPPeer>> new_peers;
+		std::vector<PostedEvent> posted_events;
+	};
+}
@@ -0,0 +1,368 @@
+#include "Network/precomp.h"
+#include "network_poller.h"
+#include "tcp_socket.h"
+
+#ifndef WIN32
+#include <unistd.h>
+#include <fcntl.h>
+#include <algorithm>
+#include <map>
+#if defined(__linux__)
+#include <sys/epoll.h>
+#elif defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__)
+#include <sys/event.h>
+#define CL_NETWORK_POLLER_KQUEUE
+#else
+#include <poll.h>
+#endif
+#endif
+
+namespace clan
+{
+#if defined(WIN32)
+
+	// Win32 sockets are waited on with WSAEventSelect events. A completion port based poller
+	// requires overlapped socket I/O, which the socket classes do not use yet.
+	class NetworkPollerImpl
+	{
+	};
+
+	NetworkPoller::NetworkPoller()
+	{
+		throw Exception("NetworkPoller is not available on this platform");
+	}
+
+	NetworkPoller::~NetworkPoller()
+	{
+	}
+
+	bool NetworkPoller::is_supported()
+	{
+		return false;
+	}
+
+	void NetworkPoller::add(NetworkEvent *event, void *user_data, bool want_write)
+	{
+	}
+
+	void NetworkPoller::modify(NetworkEvent *event, void *user_data, bool want_write)
+	{
+	}
+
+	void NetworkPoller::remove(NetworkEvent *event)
+	{
+	}
+
+	bool NetworkPoller::wait(std::vector<void *> &out_ready, int timeout_ms)
+	{
+		return false;
+	}
+
+	void NetworkPoller::notify()
+	{
+	}
+
+#else
+
+	class NetworkPollerImpl
+	{
+	public:
+		NetworkPollerImpl()
+		{
+			int result = pipe(notify_handle);
+			if (result < 0)
+				throw Exception("Unable to create pipe handle");
+
+			result = fcntl(notify_handle[0], F_SETFL, O_NONBLOCK);
+			if (result < 0)
+			{
+				::close(notify_handle[0]);
+				::close(notify_handle[1]);
+				throw Exception("Unable to set pipe non-blocking mode");
+			}
+
+#if defined(__linux__)
+			poll_handle = epoll_create1(0);
+			if (poll_handle < 0)
+			{
+				::close(notify_handle[0]);
+				::close(notify_handle[1]);
+				throw Exception("Unable to create epoll handle");
+			}
+
+			epoll_event e = { 0 };
+			e.events = EPOLLIN;
+			e.data.ptr = nullptr;
+			epoll_ctl(poll_handle, EPOLL_CTL_ADD, notify_handle[0], &e);
+#elif defined(CL_NETWORK_POLLER_KQUEUE)
+			poll_handle = kqueue();
+			if (poll_handle < 0)
+			{
+				::close(notify_handle[0]);
+				::close(notify_handle[1]);
+				throw Exception("Unable to create kqueue handle");
+			}
+
+			struct kevent change;
+			EV_SET(&change, notify_handle[0], EVFILT_READ, EV_ADD, 0, 0, nullptr);
+			kevent(poll_handle, &change, 1, nullptr, 0, nullptr);
+#endif
+		}
+
+		~NetworkPollerImpl()
+		{
+#if defined(__linux__) || defined(CL_NETWORK_POLLER_KQUEUE)
+			::close(poll_handle);
+#endif
+			::close(notify_handle[0]);
+			::close(notify_handle[1]);
+		}
+
+		void reset_notify()
+		{
+			unsigned char buf[64];
+			while (read(notify_handle[0], buf, sizeof(buf)) > 0);
+		}
+
+		void set_notify()
+		{
+			::write(notify_handle[1], "x", 1);
+		}
+
+		int notify_handle[2];
+
+#if defined(__linux__)
+		int poll_handle;
+		std::vector<epoll_event> events;
+#elif defined(CL_NETWORK_POLLER_KQUEUE)
+		int poll_handle;
+		std::vector<struct kevent> events;
+#else
+		std::vector<pollfd> fds;
+		std::vector<void *> fds_user_data;
+		std::map<int, size_t> fd_index;
+#endif
+	};
+
+	NetworkPoller::NetworkPoller() : impl(new NetworkPollerImpl())
+	{
+	}
+
+	NetworkPoller::~NetworkPoller()
+	{
+	}
+
+	bool NetworkPoller::is_supported()
+	{
+		return true;
+	}
+
+	void NetworkPoller::notify()
+	{
+		impl->set_notify();
+	}
+
+#if defined(__linux__)
+
+	void NetworkPoller::add(NetworkEvent *event, void *user_data, bool want_write)
+	{
+		epoll_event e = { 0 };
+		e.events = want_write ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+		e.data.ptr = user_data;
+		if (epoll_ctl(impl->poll_handle, EPOLL_CTL_ADD, event->get_socket_handle()->get_handle(), &e) < 0)
+			throw Exception("epoll_ctl failed");
+		impl->events.resize(impl->events.size() + 1);
+	}
+
+	void NetworkPoller::modify(NetworkEvent *event, void *user_data, bool want_write)
+	{
+		epoll_event e = { 0 };
+		e.events = want_write ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+		e.data.ptr = user_data;
+		if (epoll_ctl(impl->poll_handle, EPOLL_CTL_MOD, event->get_socket_handle()->get_handle(), &e) < 0)
+			throw Exception("epoll_ctl failed");
+	}
+
+	void NetworkPoller::remove(NetworkEvent *event)
+	{
+		epoll_event e = { 0 };
+		epoll_ctl(impl->poll_handle, EPOLL_CTL_DEL, event->get_socket_handle()->get_handle(), &e);
+		impl->events.resize(impl->events.size() - 1);
+	}
+
+	bool NetworkPoller::wait(std::vector<void *> &out_ready, int timeout_ms)
+	{
+		out_ready.clear();
+
+		epoll_event *events = impl->events.empty() ? nullptr : impl->events.data();
+		epoll_event notify_event;
+		int max_events = (int)impl->events.size();
+		if (max_events == 0)
+		{
+			events = &notify_event;
+			max_events = 1;
+		}
+
+		int result = epoll_wait(impl->poll_handle, events, max_events, timeout_ms);
+		if (result < 0)
+		{
+			if (errno == EINTR)
+				return true;
+			throw Exception("epoll_wait failed");
+		}
+
+		for (int i = 0; i < result; i++)
+		{
+			if (events[i].data.ptr)
+				out_ready.push_back(events[i].data.ptr);
+			else
+				impl->reset_notify();
+		}
+		return result > 0;
+	}
+
+#elif defined(CL_NETWORK_POLLER_KQUEUE)
+
+	void NetworkPoller::add(NetworkEvent *event, void *user_data, bool want_write)
+	{
+		int handle = event->get_socket_handle()->get_handle();
+		struct kevent changes[2];
+		EV_SET(&changes[0], handle, EVFILT_READ, EV_ADD, 0, 0, user_data);
+		EV_SET(&changes[1], handle, EVFILT_WRITE, EV_ADD | (want_write ? EV_ENABLE : EV_DISABLE), 0, 0, user_data);
+		if (kevent(impl->poll_handle, changes, 2, nullptr, 0, nullptr) < 0)
+			throw Exception("kevent failed");
+		impl->events.resize(impl->events.size() + 2);
+	}
+
+	void NetworkPoller::modify(NetworkEvent *event, void *user_data, bool want_write)
+	{
+		struct kevent change;
+		EV_SET(&change, event->get_socket_handle()->get_handle(), EVFILT_WRITE, want_write ? EV_ENABLE : EV_DISABLE, 0, 0, user_data);
+		if (kevent(impl->poll_handle, &change, 1, nullptr, 0, nullptr) < 0)
+			throw Exception("kevent failed");
+	}
+
+	void NetworkPoller::remove(NetworkEvent *event)
+	{
+		int handle = event->get_socket_handle()->get_handle();
+		struct kevent changes[2];
+		EV_SET(&changes[0], handle, EVFILT_READ, EV_DELETE, 0, 0, nullptr);
+		EV_SET(&changes[1], handle, EVFILT_WRITE, EV_DELETE, 0, 0, nullptr);
+		kevent(impl->poll_handle, changes, 2, nullptr, 0, nullptr);
+		impl->events.resize(impl->events.size() - 2);
+	}
+
+	bool NetworkPoller::wait(std::vector<void *> &out_ready, int timeout_ms)
+	{
+		out_ready.clear();
+
+		struct kevent notify_event;
+		struct kevent *events = impl->events.empty() ? &notify_event : impl->events.data();
+		int max_events = std::max((int)impl->events.size(), 1);
+
+		timespec timeout;
+		timeout.tv_sec = timeout_ms / 1000;
+		timeout.tv_nsec = (timeout_ms % 1000) * 1000000;
+
+		int result = kevent(impl->poll_handle, nullptr, 0, events, max_events, timeout_ms >= 0 ? &timeout : nullptr);
+		if (result < 0)
+		{
+			if (errno == EINTR)
+				return true;
+			throw Exception("kevent failed");
+		}
+
+		for (int i = 0; i < result; i++)
+		{
+			void *user_data = events[i].udata;
+			if (!user_data)
+				impl->reset_notify();
+			else if (std::find(out_ready.begin(), out_ready.end(), user_data) == out_ready.end())
+				out_ready.push_back(user_data);
+		}
+		return result > 0;
+	}
+
+#else
+
+	void NetworkPoller::add(NetworkEvent *event, void *user_data, bool want_write)
+	{
+		if (impl->fds.empty())
+		{
+			pollfd notify_fd = { 0 };
+			notify_fd.fd = impl->notify_handle[0];
+			notify_fd.events = POLLIN;
+			impl->fds.push_back(notify_fd);
+			impl->fds_user_data.push_back(nullptr);
+		}
+
+		pollfd fd = { 0 };
+		fd.fd = event->get_socket_handle()->get_handle();
+		fd.events = POLLIN | (want_write ? POLLOUT : 0);
+		impl->fd_index[fd.fd] = impl->fds.size();
+		impl->fds.push_back(fd);
+		impl->fds_user_data.push_back(user_data);
+	}
+
+	void NetworkPoller::modify(NetworkEvent *event, void *user_data, bool want_write)
+	{
+		auto it = impl->fd_index.find(event->get_socket_handle()->get_handle());
+		if (it == impl->fd_index.end())
+			throw Exception("Socket not added to poller");
+		impl->fds[it->second].events = POLLIN | (want_write ? POLLOUT : 0);
+		impl->fds_user_data[it->second] = user_data;
+	}
+
+	void NetworkPoller::remove(NetworkEvent *event)
+	{
+		auto it = impl->fd_index.find(event->get_socket_handle()->get_handle());
+		if (it == impl->fd_index.end())
+			return;
+
+		// Swap the last entry into the removed slot
+		size_t index = it->second;
+		impl->fd_index.erase(it);
+		if (index + 1 != impl->fds.size())
+		{
+			impl->fds[index] = impl->fds.back();
+			impl->fds_user_data[index] = impl->fds_user_data.back();
+			impl->fd_index[impl->fds[index].fd] = index;
+		}
+		impl->fds.pop_back();
+		impl->fds_user_data.pop_back();
+	}
+
+	bool NetworkPoller::wait(std::vector<void *> &out_ready, int timeout_ms)
+	{
+		out_ready.clear();
+
+		pollfd notify_fd = { 0 };
+		notify_fd.fd = impl->notify_handle[0];
+		notify_fd.events = POLLIN;
+
+		pollfd *fds = impl->fds.empty() ? &notify_fd : impl->fds.data();
+		int count = impl->fds.empty() ? 1 : (int)impl->fds.size();
+
+		int result = poll(fds, count, timeout_ms);
+		if (result < 0)
+		{
+			if (errno == EINTR)
+				return true;
+			throw Exception("poll failed");
+		}
+
+		for (int i = 0; i < count; i++)
+		{
+			if (fds[i].revents == 0)
+				continue;
+			if (fds[i].fd == impl->notify_handle[0])
+				impl->reset_notify();
+			else
+				out_ready.push_back(impl->fds_user_data[i]);
+		}
+		return result > 0;
+	}
+
+#endif
+#endif
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "API/Network/Socket/network_condition_variable.h"
+#include <memory>
+#include <vector>
+
+namespace clan
+{
+	class NetworkPollerImpl;
+
+	/// \brief Waits for readiness on a large number of sockets
+	///
+	/// Uses epoll on Linux, kqueue on macOS and BSD, and poll elsewhere. Sockets are level
+	/// triggered: a socket is reported ready as long as it has data to read, or room to write
+	/// if write interest is set. Only notify may be called from other threads than the one
+	/// calling wait.
+	class NetworkPoller
+	{
+	public:
+		NetworkPoller();
+		~NetworkPoller();
+
+		/// \brief Returns true if the platform supports NetworkPoller
+		static bool is_supported();
+
+		/// \brief Starts watching a socket. user_data is returned by wait when the socket is ready.
+		void add(NetworkEvent *event, void *user_data, bool want_write);
+
+		/// \brief Changes the write interest of a socket
+		void modify(NetworkEvent *event, void *user_data, bool want_write);
+
+		/// \brief Stops watching a socket
+		void remove(NetworkEvent *event);
+
+		/// \brief Waits until sockets are ready, notify is called or the timeout elapses
+		/** \return false if the wait timed out*/
+		bool wait(std::vector<void *> &out_ready, int timeout_ms = -1);
+
+		/// \brief Awakens the thread waiting in wait
+		void notify();
+
+	private:
+		NetworkPoller(const NetworkPoller &) = delete;
+		NetworkPoller &operator=(const NetworkPoller &) = delete;
+
+		std::unique_ptr<NetworkPollerImpl> impl;
+	};
+}
@@ -18,9 +18,12 @@ namespace clan
 	{
 	}
 
-	TCPListen::TCPListen(const SocketName &endpoint, int backlog, bool reuse_address)
+	TCPListen::TCPListen(const SocketName &endpoint, int backlog, bool reuse_address, bool reuse_port)
 		: impl(new TCPSocket())
 	{
+		if (reuse_port)
+			throw Exception("Listening sockets sharing an end point are not supported on this platform");
+
 		if (reuse_address)
 		{
 			int value = 1;
@@ -98,7 +101,7 @@ namespace clan
 	{
 	}
 
-	TCPListen::TCPListen(const SocketName &endpoint, int backlog, bool reuse_address)
+	TCPListen::TCPListen(const SocketName &endpoint, int backlog, bool reuse_address, bool reuse_port)
 		: impl(new TCPSocket())
 	{
 		if (reuse_address)
@@ -109,6 +112,18 @@ namespace clan
 				throw Exception("Could not set reuse address socket option");
 		}
 
+		if (reuse_port)
+		{
+#if defined(__linux__) && defined(SO_REUSEPORT)
+			int value = 1;
+			int result = setsockopt(impl->handle, SOL_SOCKET, SO_REUSEPORT, (const char *) &value, sizeof(int));
+			if (result == -1)
+				throw Exception("Could not set reuse port socket option");
+#else
+			throw Exception("Listening sockets sharing an end point are not supported on this platform");
+#endif
+		}
+
 		//int receive_buffer_size = 600*1024;
 		int send_buffer_size = 600*1024;
 
@@ -172,4 +187,13 @@ namespace clan
 
 #endif
 
+	bool TCPListen::is_reuse_port_supported()
+	{
+		// BSD and macOS accept SO_REUSEPORT too, but only Linux spreads the connections over the sockets
+#if defined(__linux__) && defined(SO_REUSEPORT)
+		return true;
+#else
+		return false;
+#endif
+	}
 }
@@ -92,6 +92,7 @@ namespace clan
 	public:
 		virtual void begin_wait(fd_set &rfds, fd_set &wfds, int &max_fd) = 0;
 		virtual void end_wait(fd_set &rfds, fd_set &wfds) = 0;
+		virtual int get_handle() const = 0;
 	};
 
 	class TCPSocket : public SocketHandle
@@ -111,7 +112,7 @@ namespace clan
 		}
 
 		TCPSocket(int handle)
-			: handle(handle)
+			: handle(handle), can_write(false)
 		{
 		}
 
@@ -145,6 +146,11 @@ namespace clan
 			}
 		}
 
+		int get_handle() const override
+		{
+			return handle;
+		}
+
 		int handle;
 		bool can_write;
 	};
@@ -0,0 +1,161 @@
+
+#include "Network/precomp.h"
+#include "API/Network/Socket/tls_connection.h"
+#include "API/Network/Socket/socket_name.h"
+#include "API/Core/Crypto/secret.h"
+#include "API/Core/System/exception.h"
+#include "tls_connection_impl.h"
+#include <algorithm>
+#include <cstring>
+
+namespace clan
+{
+	TLSConnection::TLSConnection()
+	{
+	}
+
+	TLSConnection::TLSConnection(const SocketName &endpoint)
+		: TLSConnection(TCPConnection(endpoint), Secret())
+	{
+	}
+
+	TLSConnection::TLSConnection(const SocketName &endpoint, const Secret &session)
+		: TLSConnection(TCPConnection(endpoint), session)
+	{
+	}
+
+	TLSConnection::TLSConnection(const TCPConnection &connection, const Secret &session)
+		: impl(std::make_shared<TLSConnection_Impl>(connection))
+	{
+		if (session.get_size() > 0)
+			impl->tls.set_session(session);
+		impl->start();
+	}
+
+	TLSConnection::~TLSConnection()
+	{
+	}
+
+	bool TLSConnection::is_connected() const
+	{
+		return impl->tls.is_connected();
+	}
+
+	bool TLSConnection::is_session_resumed() const
+	{
+		return impl->tls.is_session_resumed();
+	}
+
+	Secret TLSConnection::get_session() const
+	{
+		return impl->tls.get_session();
+	}
+
+	bool TLSConnection::is_write_pending() const
+	{
+		return impl->tls.get_encrypted_data_available() > 0;
+	}
+
+	SocketName TLSConnection::get_local_name()
+	{
+		return impl->connection.get_local_name();
+	}
+
+	SocketName TLSConnection::get_remote_name()
+	{
+		return impl->connection.get_remote_name();
+	}
+
+	void TLSConnection::close()
+	{
+		if (impl)
+			impl->connection.close();
+	}
+
+	int TLSConnection::write(const void *data, int size)
+	{
+		// The server handshake messages only arrive through the socket, so keep reading until connected
+		if (!impl->tls.is_connected())
+			impl->receive();
+
+		impl->send();
+		int accepted = impl->tls.encrypt(data, size);
+		impl->send();
+
+		if (accepted == 0 && size > 0)
+			return -1;
+		return accepted;
+	}
+
+	int TLSConnection::read(void *data, int size)
+	{
+		impl->receive();
+
+		int available = impl->tls.get_decrypted_data_available();
+		if (available > 0)
+		{
+			int bytes = std::min(available, size);
+			memcpy(data, impl->tls.get_decrypted_data(), bytes);
+			impl->tls.decrypted_data_consumed(bytes);
+			impl->send();
+			return bytes;
+		}
+
+		impl->send();
+		if (impl->remote_closed && impl->receive_pos == impl->receive_size)
+			return 0;
+		return -1;
+	}
+
+	SocketHandle *TLSConnection::get_socket_handle()
+	{
+		return impl->connection.get_socket_handle();
+	}
+
+	void TLSConnection_Impl::start()
+	{
+		// Passing no data makes the client produce its hello
+		tls.encrypt(nullptr, 0);
+		send();
+	}
+
+	void TLSConnection_Impl::receive()
+	{
+		while (true)
+		{
+			if (receive_pos == receive_size)
+			{
+				if (remote_closed)
+					break;
+
+				int received = connection.read(receive_buffer.get_data(), receive_buffer.get_size());
+				if (received < 0)
+					break;
+				if (received == 0)
+				{
+					remote_closed = true;
+					break;
+				}
+				receive_pos = 0;
+				receive_size = received;
+			}
+
+			// Stops accepting data when its buffers are full, until the decrypted data is consumed
+			int consumed = tls.decrypt(receive_buffer.get_data() + receive_pos, receive_size - receive_pos);
+			if (consumed == 0)
+				break;
+			receive_pos += consumed;
+		}
+	}
+
+	void TLSConnection_Impl::send()
+	{
+		while (tls.get_encrypted_data_available() > 0)
+		{
+			int written = connection.write(tls.get_encrypted_data(), tls.get_encrypted_data_available());
+			if (written < 0)
+				break;
+			tls.encrypted_data_consumed(written);
+		}
+	}
+}
@@ -0,0 +1,29 @@
+
+#pragma once
+
+#include "API/Network/Socket/tcp_connection.h"
+#include "API/Core/Crypto/tls_client.h"
+#include "API/Core/System/databuffer.h"
+
+namespace clan
+{
+	class TLSConnection_Impl
+	{
+	public:
+		TLSConnection_Impl(const TCPConnection &connection) : connection(connection), receive_buffer(16 * 1024)
+		{
+		}
+
+		void start();
+		void receive();
+		void send();
+
+		TCPConnection connection;
+		TLSClient tls;
+
+		DataBuffer receive_buffer;
+		int receive_pos = 0;
+		int receive_size = 0;
+		bool remote_closed = false;
+	};
+}
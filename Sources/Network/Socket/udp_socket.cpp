@@ -159,6 +159,11 @@ namespace clan
 		{
 		}
 
+		int get_handle() const override
+		{
+			return handle;
+		}
+
 		int handle;
 	};
 
@@ -217,5 +222,119 @@ namespace clan
 		return result;
 	}
 
+#if defined(__linux__)
+
+	int UDPSocket::send_batch(const UDPPacket *packets, int count)
+	{
+		const int max_batch = 64;
+		sockaddr_in addrs[max_batch];
+		iovec iov[max_batch];
+		mmsghdr msgs[max_batch];
+
+		int sent = 0;
+		int pos = 0;
+		while (pos < count)
+		{
+			int batch = std::min(count - pos, max_batch);
+			for (int i = 0; i < batch; i++)
+			{
+				const UDPPacket &packet = packets[pos + i];
+				packet.endpoint.to_sockaddr(AF_INET, (sockaddr *)&addrs[i], sizeof(sockaddr_in));
+				iov[i].iov_base = packet.data;
+				iov[i].iov_len = packet.size;
+				memset(&msgs[i], 0, sizeof(mmsghdr));
+				msgs[i].msg_hdr.msg_name = &addrs[i];
+				msgs[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+				msgs[i].msg_hdr.msg_iov = &iov[i];
+				msgs[i].msg_hdr.msg_iovlen = 1;
+			}
+
+			int result = sendmmsg(impl->handle, msgs, batch, 0);
+			if (result > 0)
+			{
+				sent += result;
+				pos += result;
+			}
+			else
+			{
+				pos++;	// The first packet failed, drop it and continue with the rest
+			}
+		}
+		return sent;
+	}
+
+	int UDPSocket::read_batch(UDPPacket *packets, int count)
+	{
+		const int max_batch = 64;
+		sockaddr_in addrs[max_batch];
+		iovec iov[max_batch];
+		mmsghdr msgs[max_batch];
+
+		int received = 0;
+		while (received < count)
+		{
+			int batch = std::min(count - received, max_batch);
+			for (int i = 0; i < batch; i++)
+			{
+				UDPPacket &packet = packets[received + i];
+				iov[i].iov_base = packet.data;
+				iov[i].iov_len = packet.capacity;
+				memset(&msgs[i], 0, sizeof(mmsghdr));
+				msgs[i].msg_hdr.msg_name = &addrs[i];
+				msgs[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+				msgs[i].msg_hdr.msg_iov = &iov[i];
+				msgs[i].msg_hdr.msg_iovlen = 1;
+			}
+
+			int result = recvmmsg(impl->handle, msgs, batch, 0, nullptr);
+			if (result == -1)
+			{
+				if (errno == EWOULDBLOCK || errno == EMSGSIZE || errno == ECONNRESET || errno == ENETRESET)
+					break;
+				else
+					throw Exception("Error reading from udp socket");
+			}
+
+			for (int i = 0; i < result; i++)
+			{
+				UDPPacket &packet = packets[received + i];
+				packet.size = msgs[i].msg_len;
+				packet.endpoint.from_sockaddr(AF_INET, (sockaddr *)&addrs[i], msgs[i].msg_hdr.msg_namelen);
+			}
+			received += result;
+
+			if (result < batch)
+				break;
+		}
+		return received;
+	}
+
+#endif
+
+#endif
+
+#if !defined(__linux__)
+
+	// Without recvmmsg/sendmmsg every datagram needs its own call. WSARecvMsg and WSASendMsg also move one datagram per call.
+
+	int UDPSocket::send_batch(const UDPPacket *packets, int count)
+	{
+		for (int i = 0; i < count; i++)
+			send(packets[i].data, packets[i].size, packets[i].endpoint);
+		return count;
+	}
+
+	int UDPSocket::read_batch(UDPPacket *packets, int count)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			int result = read(packets[i].data, packets[i].capacity, packets[i].endpoint);
+			if (result < 0)
+				return i;
+			packets[i].size = result;
+		}
+		return count;
+	}
+
 #endif
 }
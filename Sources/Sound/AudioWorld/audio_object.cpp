@@ -4,6 +4,7 @@
 #include "API/Sound/AudioWorld/audio_world.h"
 #include "audio_object_impl.h"
 #include "audio_world_impl.h"
+#include <algorithm>
 
 namespace clan
 {
@@ -29,22 +30,28 @@ namespace clan
 
 	Vec3f AudioObject::get_position() const
 	{
-		return impl->position;
+		int index = impl->index;
+		return Vec3f(impl->world->position_x[index], impl->world->position_y[index], impl->world->position_z[index]);
 	}
 
 	float AudioObject::get_attenuation_begin() const
 	{
-		return impl->attenuation_begin;
+		return impl->world->attenuation_begin[impl->index];
 	}
 
 	float AudioObject::get_attenuation_end() const
 	{
-		return impl->attenuation_end;
+		return impl->world->attenuation_end[impl->index];
 	}
 
 	float AudioObject::get_volume() const
 	{
-		return impl->volume;
+		return impl->world->volume[impl->index];
+	}
+
+	float AudioObject::get_priority() const
+	{
+		return impl->world->priority[impl->index];
 	}
 
 	bool AudioObject::is_looping() const
@@ -59,27 +66,40 @@ namespace clan
 
 	bool AudioObject::is_playing() const
 	{
-		return impl && !impl->session.is_null() && impl->session.is_playing();
+		return impl && impl->playing;
+	}
+
+	bool AudioObject::is_virtual() const
+	{
+		return impl && impl->playing && !impl->real;
 	}
 
 	void AudioObject::set_position(const Vec3f &position)
 	{
-		impl->position = position;
+		int index = impl->index;
+		impl->world->position_x[index] = position.x;
+		impl->world->position_y[index] = position.y;
+		impl->world->position_z[index] = position.z;
 	}
 
 	void AudioObject::set_attenuation_begin(float distance)
 	{
-		impl->attenuation_begin = distance;
+		impl->world->attenuation_begin[impl->index] = distance;
 	}
 
 	void AudioObject::set_attenuation_end(float distance)
 	{
-		impl->attenuation_end = distance;
+		impl->world->attenuation_end[impl->index] = distance;
 	}
 
 	void AudioObject::set_volume(float volume)
 	{
-		impl->volume = volume;
+		impl->world->volume[impl->index] = volume;
+	}
+
+	void AudioObject::set_priority(float priority)
+	{
+		impl->world->priority[impl->index] = priority;
 	}
 
 	void AudioObject::set_sound(const SoundBuffer &buffer)
@@ -106,10 +126,27 @@ namespace clan
 	{
 		if (!impl->ambience || impl->world->play_ambience)
 		{
+			stop();
+
+			// The session is prepared for virtual voices too, so they know their length and can start at their virtual position
 			impl->session = impl->sound.prepare(impl->looping);
-			impl->world->update_session(impl.get());
-			impl->session.play();
-			impl->world->active_objects.push_back(*this);
+			int length = impl->session.get_length();
+			impl->length = length > 0 ? length / (double)impl->session.get_frequency() : -1.0;
+			impl->virtual_position = 0.0;
+			impl->playing = true;
+			impl->real = false;
+
+			// A stopped object stays in the active list until the next update
+			auto &active_objects = impl->world->active_objects;
+			if (std::find_if(active_objects.begin(), active_objects.end(), [&](const AudioObject &object) { return object.impl == impl; }) == active_objects.end())
+				active_objects.push_back(*this);
+
+			// Start right away while there are free voices. Otherwise the next update decides whether it is important enough.
+			if (impl->world->num_real_voices < impl->world->max_voices)
+			{
+				impl->world->update_attenuation();
+				impl->world->make_real(impl.get());
+			}
 		}
 	}
 
@@ -117,7 +154,9 @@ namespace clan
 	{
 		if (impl && !impl->session.is_null())
 		{
-			impl->session.stop();
+			if (impl->real)
+				impl->world->make_virtual(impl.get());
+			impl->playing = false;
 			impl->session = SoundBuffer_Session();
 		}
 	}
@@ -125,13 +164,13 @@ namespace clan
 	/////////////////////////////////////////////////////////////////////////////
 
 	AudioObject_Impl::AudioObject_Impl(AudioWorld_Impl *world)
-		: world(world), attenuation_begin(0.0f), attenuation_end(0.0f), volume(1.0f), looping(false), ambience(false)
+		: world(world), index(-1), looping(false), ambience(false), playing(false), real(false), virtual_position(0.0), length(-1.0)
 	{
-		it = world->objects.insert(world->objects.end(), this);
+		world->add_object(this);
 	}
 
 	AudioObject_Impl::~AudioObject_Impl()
 	{
-		world->objects.erase(it);
+		world->remove_object(this);
 	}
 }
@@ -28,8 +28,6 @@
 
 #pragma once
 
-#include <list>
-#include "API/Core/Math/vec3.h"
 #include "API/Sound/soundbuffer.h"
 #include "API/Sound/soundbuffer_session.h"
 
@@ -44,15 +42,25 @@ namespace clan
 		~AudioObject_Impl();
 
 		AudioWorld_Impl *world;
-		std::list<AudioObject_Impl *>::iterator it;
 
-		Vec3f position;
-		float attenuation_begin;
-		float attenuation_end;
-		float volume;
+		/// \brief Slot of the object in the object arrays of the world, which also hold its position, attenuation, volume and priority
+		int index;
+
 		bool looping;
 		bool ambience;
 		SoundBuffer sound;
 		SoundBuffer_Session session;
+
+		/// \brief True from play() until the sound ends or stop() is called, whether the voice is real or virtual
+		bool playing;
+
+		/// \brief True if the session is playing on the sound output
+		bool real;
+
+		/// \brief Playback position of a virtual voice, in seconds
+		double virtual_position;
+
+		/// \brief Length of the sound in seconds, or a negative value if the provider does not know it
+		double length;
 	};
 }
@@ -4,8 +4,16 @@
 #include "API/Sound/AudioWorld/audio_object.h"
 #include "API/Sound/soundbuffer.h"
 #include "API/Core/Math/cl_math.h"
+#include "API/Core/System/system.h"
 #include "audio_world_impl.h"
 #include "audio_object_impl.h"
+#include "../soundoutput_impl.h"
+#include <algorithm>
+#include <cmath>
+
+#ifndef CL_DISABLE_SSE2
+#include <emmintrin.h>
+#endif
 
 namespace clan
 {
@@ -20,6 +28,11 @@ namespace clan
 		impl->listener_orientation = orientation;
 	}
 
+	void AudioWorld::enable_ambience(bool enable)
+	{
+		impl->play_ambience = enable;
+	}
+
 	bool AudioWorld::is_ambience_enabled() const
 	{
 		return impl->play_ambience;
@@ -35,62 +48,261 @@ namespace clan
 		return impl->reverse_stereo;
 	}
 
+	void AudioWorld::set_max_voices(int max_voices)
+	{
+		impl->max_voices = max_voices;
+	}
+
+	int AudioWorld::get_max_voices() const
+	{
+		return impl->max_voices;
+	}
+
 	void AudioWorld::update()
 	{
-		for (auto it = impl->objects.begin(); it != impl->objects.end(); ++it)
+		uint64_t time = System::get_time();
+		float elapsed = impl->last_update_time != 0 ? (time - impl->last_update_time) / 1000.0f : 0.0f;
+		impl->last_update_time = time;
+
+		impl->update_attenuation();
+		impl->update_voices(elapsed);
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	AudioWorld_Impl::AudioWorld_Impl(const ResourceManager &resources)
+		: num_real_voices(0), max_voices(32), reported_virtual_voices(0), last_update_time(0), play_ambience(true), reverse_stereo(false), resources(resources)
+	{
+	}
+
+	AudioWorld_Impl::~AudioWorld_Impl()
+	{
+		SoundOutput_Impl::add_virtual_voices(-reported_virtual_voices);
+	}
+
+	void AudioWorld_Impl::add_object(AudioObject_Impl *obj)
+	{
+		obj->index = objects.size();
+		objects.push_back(obj);
+		position_x.push_back(0.0f);
+		position_y.push_back(0.0f);
+		position_z.push_back(0.0f);
+		attenuation_begin.push_back(0.0f);
+		attenuation_end.push_back(0.0f);
+		volume.push_back(1.0f);
+		priority.push_back(1.0f);
+		final_volume.push_back(1.0f);
+		final_pan.push_back(0.0f);
+	}
+
+	void AudioWorld_Impl::remove_object(AudioObject_Impl *obj)
+	{
+		int index = obj->index;
+		int last = objects.size() - 1;
+		if (index != last)
+		{
+			objects[index] = objects[last];
+			objects[index]->index = index;
+			position_x[index] = position_x[last];
+			position_y[index] = position_y[last];
+			position_z[index] = position_z[last];
+			attenuation_begin[index] = attenuation_begin[last];
+			attenuation_end[index] = attenuation_end[last];
+			volume[index] = volume[last];
+			priority[index] = priority[last];
+			final_volume[index] = final_volume[last];
+			final_pan[index] = final_pan[last];
+		}
+
+		objects.pop_back();
+		position_x.pop_back();
+		position_y.pop_back();
+		position_z.pop_back();
+		attenuation_begin.pop_back();
+		attenuation_end.pop_back();
+		volume.pop_back();
+		priority.pop_back();
+		final_volume.pop_back();
+		final_pan.pop_back();
+	}
+
+	void AudioWorld_Impl::update_attenuation()
+	{
+		// Volume is attenuated by distance, and pan is the cosine of the angle between the ear and the sound direction.
+		// The final volume needs to stay the same no matter the panning direction.
+		// Objects with equal attenuation begin and end are not positional and play at their own volume in the center.
+		Vec3f ear_vector = listener_orientation.rotate_vector(Vec3f(1.0f, 0.0f, 0.0f));
+		if (reverse_stereo)
+			ear_vector = -ear_vector;
+
+		int count = objects.size();
+		int i = 0;
+
+#ifndef CL_DISABLE_SSE2
+		__m128 listener_x = _mm_set1_ps(listener_position.x);
+		__m128 listener_y = _mm_set1_ps(listener_position.y);
+		__m128 listener_z = _mm_set1_ps(listener_position.z);
+		__m128 ear_x = _mm_set1_ps(ear_vector.x);
+		__m128 ear_y = _mm_set1_ps(ear_vector.y);
+		__m128 ear_z = _mm_set1_ps(ear_vector.z);
+		__m128 zero = _mm_setzero_ps();
+		__m128 half = _mm_set1_ps(0.5f);
+		__m128 one = _mm_set1_ps(1.0f);
+		__m128 two = _mm_set1_ps(2.0f);
+		__m128 three = _mm_set1_ps(3.0f);
+		__m128 sign_mask = _mm_set1_ps(-0.0f);
+
+		int sse_count = count / 4 * 4;
+		for (; i < sse_count; i += 4)
 		{
-			impl->update_session(*it);
+			__m128 dx = _mm_sub_ps(_mm_loadu_ps(&position_x[i]), listener_x);
+			__m128 dy = _mm_sub_ps(_mm_loadu_ps(&position_y[i]), listener_y);
+			__m128 dz = _mm_sub_ps(_mm_loadu_ps(&position_z[i]), listener_z);
+			__m128 distance = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz)));
+
+			__m128 begin = _mm_loadu_ps(&attenuation_begin[i]);
+			__m128 end = _mm_loadu_ps(&attenuation_end[i]);
+			__m128 base_volume = _mm_loadu_ps(&volume[i]);
+
+			__m128 t = _mm_div_ps(_mm_sub_ps(distance, begin), _mm_sub_ps(end, begin));
+			t = _mm_min_ps(_mm_max_ps(t, zero), one);
+			__m128 attenuation = _mm_sub_ps(one, _mm_mul_ps(_mm_mul_ps(t, t), _mm_sub_ps(three, _mm_mul_ps(two, t))));
+
+			__m128 inv_distance = _mm_and_ps(_mm_div_ps(one, distance), _mm_cmpgt_ps(distance, zero));
+			__m128 pan = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(ear_x, dx), _mm_mul_ps(ear_y, dy)), _mm_mul_ps(ear_z, dz)), inv_distance);
+			__m128 abs_pan = _mm_andnot_ps(sign_mask, pan);
+			__m128 positional_volume = _mm_mul_ps(_mm_mul_ps(_mm_add_ps(half, _mm_mul_ps(abs_pan, half)), attenuation), base_volume);
+
+			__m128 positional = _mm_cmpneq_ps(begin, end);
+			_mm_storeu_ps(&final_volume[i], _mm_or_ps(_mm_and_ps(positional, positional_volume), _mm_andnot_ps(positional, base_volume)));
+			_mm_storeu_ps(&final_pan[i], _mm_and_ps(positional, pan));
 		}
+#endif
 
-		for (auto it = impl->active_objects.begin(); it != impl->active_objects.end();)
+		for (; i < count; i++)
 		{
-			if (it->impl->session.is_playing())
+			if (attenuation_begin[i] != attenuation_end[i])
 			{
-				++it;
+				Vec3f delta(position_x[i] - listener_position.x, position_y[i] - listener_position.y, position_z[i] - listener_position.z);
+				float distance = delta.length();
+				float t = 1.0f - smoothstep(attenuation_begin[i], attenuation_end[i], distance);
+				float pan = distance > 0.0f ? Vec3f::dot(ear_vector, delta) / distance : 0.0f;
+				final_volume[i] = (0.5f + std::abs(pan) * 0.5f) * t * volume[i];
+				final_pan[i] = pan;
 			}
 			else
 			{
-				it = impl->active_objects.erase(it);
+				final_volume[i] = volume[i];
+				final_pan[i] = 0.0f;
 			}
 		}
 	}
 
-	/////////////////////////////////////////////////////////////////////////////
-
-	AudioWorld_Impl::AudioWorld_Impl(const ResourceManager &resources)
-		: play_ambience(true), reverse_stereo(false), resources(resources)
+	void AudioWorld_Impl::update_voices(float elapsed_seconds)
 	{
+		// Find the voices that ended and advance the virtual ones
+		for (auto &object : active_objects)
+		{
+			AudioObject_Impl *obj = object.impl.get();
+			if (!obj->playing)
+				continue;
+
+			if (obj->real)
+			{
+				if (!obj->session.is_playing())
+				{
+					make_virtual(obj);
+					obj->playing = false;
+					obj->session = SoundBuffer_Session();
+				}
+			}
+			else
+			{
+				obj->virtual_position += elapsed_seconds;
+				if (obj->length > 0.0 && obj->virtual_position >= obj->length)
+				{
+					if (obj->looping)
+					{
+						obj->virtual_position = std::fmod(obj->virtual_position, obj->length);
+					}
+					else
+					{
+						obj->playing = false;
+						obj->session = SoundBuffer_Session();
+					}
+				}
+			}
+		}
+		active_objects.erase(std::remove_if(active_objects.begin(), active_objects.end(), [](const AudioObject &object) { return !object.impl->playing; }), active_objects.end());
+
+		// Rank by priority times attenuated volume. Real voices get a small bonus, so voices of similar importance do not swap on every update.
+		int count = active_objects.size();
+		voice_order.resize(count);
+		for (int i = 0; i < count; i++)
+			voice_order[i] = i;
+
+		auto score = [this](int i)
+		{
+			AudioObject_Impl *obj = active_objects[i].impl.get();
+			float value = priority[obj->index] * final_volume[obj->index];
+			return obj->real ? value * 1.1f : value;
+		};
+
+		int num_voices = std::max(std::min(max_voices, count), 0);
+		if (num_voices < count)
+			std::nth_element(voice_order.begin(), voice_order.begin() + num_voices, voice_order.end(), [&](int a, int b) { return score(a) > score(b); });
+
+		// Virtualize first, so the number of real voices never goes above the limit
+		for (int i = num_voices; i < count; i++)
+			make_virtual(active_objects[voice_order[i]].impl.get());
+
+		for (int i = 0; i < num_voices; i++)
+		{
+			AudioObject_Impl *obj = active_objects[voice_order[i]].impl.get();
+			if (obj->real)
+			{
+				obj->session.set_volume(final_volume[obj->index]);
+				obj->session.set_pan(final_pan[obj->index]);
+			}
+			else
+			{
+				make_real(obj);
+			}
+		}
+
+		int num_virtual_voices = count - num_real_voices;
+		if (num_virtual_voices != reported_virtual_voices)
+		{
+			SoundOutput_Impl::add_virtual_voices(num_virtual_voices - reported_virtual_voices);
+			reported_virtual_voices = num_virtual_voices;
+		}
 	}
 
-	AudioWorld_Impl::~AudioWorld_Impl()
+	void AudioWorld_Impl::make_real(AudioObject_Impl *obj)
 	{
+		if (obj->real || obj->session.is_null())
+			return;
+
+		if (obj->virtual_position > 0.0)
+			obj->session.set_position((int)(obj->virtual_position * obj->session.get_frequency()));
+		obj->session.set_volume(final_volume[obj->index]);
+		obj->session.set_pan(final_pan[obj->index]);
+		obj->session.play();
+		obj->real = true;
+		num_real_voices++;
 	}
 
-	void AudioWorld_Impl::update_session(AudioObject_Impl *obj)
+	void AudioWorld_Impl::make_virtual(AudioObject_Impl *obj)
 	{
-		if (obj->attenuation_begin != obj->attenuation_end)
-		{
-			// Calculate volume from distance
-			float distance = obj->position.distance(listener_position);
-			float t = 1.0f - smoothstep(obj->attenuation_begin, obj->attenuation_end, distance);
-
-			// Calculate pan from ear angle
-			Vec3f sound_direction = Vec3f::normalize(obj->position - listener_position);
-			Vec3f ear_vector = listener_orientation.rotate_vector(Vec3f(1.0f, 0.0f, 0.0f));
-			float pan = Vec3f::dot(ear_vector, sound_direction);
-			if (reverse_stereo)
-				pan = -pan;
-
-			// Final volume needs to stay the same no matter the panning direction
-			float volume = (0.5f + std::abs(pan) * 0.5f) * t * obj->volume;
-
-			obj->session.set_volume(volume);
-			obj->session.set_pan(pan);
-		}
-		else
+		if (!obj->real)
+			return;
+
+		if (obj->session.is_playing())
 		{
-			obj->session.set_volume(obj->volume);
-			obj->session.set_pan(0.0f);
+			obj->virtual_position = obj->session.get_position() / (double)obj->session.get_frequency();
+			obj->session.stop();
 		}
+		obj->real = false;
+		num_real_voices--;
 	}
 }
@@ -28,10 +28,11 @@
 
 #pragma once
 
-#include <list>
+#include <vector>
 #include "API/Core/Math/vec3.h"
 #include "API/Core/Math/quaternion.h"
 #include "API/Core/Resources/resource_manager.h"
+#include "API/Sound/AudioWorld/audio_object.h"
 
 namespace clan
 {
@@ -43,10 +44,48 @@ namespace clan
 		AudioWorld_Impl(const ResourceManager &resources);
 		~AudioWorld_Impl();
 
-		void update_session(AudioObject_Impl *obj);
+		/// \brief Gives the object a slot in the object arrays
+		void add_object(AudioObject_Impl *obj);
 
-		std::list<AudioObject_Impl *> objects;
-		std::list<AudioObject> active_objects;
+		/// \brief Frees the slot of the object by moving the last object into it
+		void remove_object(AudioObject_Impl *obj);
+
+		/// \brief Calculates final_volume and final_pan of every object from its position relative to the listener
+		void update_attenuation();
+
+		/// \brief Makes the max_voices most important playing objects real and virtualizes the rest
+		void update_voices(float elapsed_seconds);
+
+		/// \brief Starts playing the session of a voice from its virtual playback cursor
+		void make_real(AudioObject_Impl *obj);
+
+		/// \brief Stops the session of a voice and continues with a virtual playback cursor
+		void make_virtual(AudioObject_Impl *obj);
+
+		/// \brief Objects and their spatial properties, stored by object index so the attenuation pass runs over contiguous arrays
+		std::vector<AudioObject_Impl *> objects;
+		std::vector<float> position_x;
+		std::vector<float> position_y;
+		std::vector<float> position_z;
+		std::vector<float> attenuation_begin;
+		std::vector<float> attenuation_end;
+		std::vector<float> volume;
+		std::vector<float> priority;
+		std::vector<float> final_volume;
+		std::vector<float> final_pan;
+
+		/// \brief Playing objects, both real and virtual
+		std::vector<AudioObject> active_objects;
+		int num_real_voices;
+		int max_voices;
+
+		/// \brief Virtual voice count last added to the output statistics
+		int reported_virtual_voices;
+
+		/// \brief Scratch list used to rank the active objects
+		std::vector<int> voice_order;
+
+		uint64_t last_update_time;
 
 		Vec3f listener_position;
 		Quaternionf listener_orientation;
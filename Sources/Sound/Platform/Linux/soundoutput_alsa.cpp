@@ -133,6 +133,9 @@ void SoundOutput_alsa::write_fragment(float *data)
 
 	switch(snd_pcm_state(handle)) {
 		case SND_PCM_STATE_XRUN:
+			counters.record_device_underrun();
+			snd_pcm_prepare(handle);
+			break;
 		case SND_PCM_STATE_SUSPENDED:
 			snd_pcm_prepare(handle);
 			break;
@@ -0,0 +1,242 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "Sound/precomp.h"
+#include "soundoutput_pulseaudio.h"
+#include "API/Core/System/exception.h"
+
+#ifdef __linux__
+
+namespace clan
+{
+	SoundOutput_PulseAudio::SoundOutput_PulseAudio(int mixing_frequency, int mixing_latency)
+		: SoundOutput_Impl(mixing_frequency, mixing_latency), mainloop(nullptr), context(nullptr), stream(nullptr), period_frames(0), mixing(false)
+	{
+		try
+		{
+			period_frames = get_device_period_frames();
+
+			mainloop = pa_threaded_mainloop_new();
+			if (!mainloop)
+				throw Exception("pa_threaded_mainloop_new failed");
+
+			context = pa_context_new(pa_threaded_mainloop_get_api(mainloop), "ClanLib");
+			if (!context)
+				throw Exception("pa_context_new failed");
+			pa_context_set_state_callback(context, &SoundOutput_PulseAudio::context_state_callback, this);
+
+			// Do not spawn a server. Without a running server ALSA is the better choice.
+			if (pa_context_connect(context, nullptr, PA_CONTEXT_NOAUTOSPAWN, nullptr) < 0)
+				throw Exception("pa_context_connect failed");
+
+			pa_threaded_mainloop_lock(mainloop);
+			if (pa_threaded_mainloop_start(mainloop) < 0)
+			{
+				pa_threaded_mainloop_unlock(mainloop);
+				throw Exception("pa_threaded_mainloop_start failed");
+			}
+			wait_for_context();
+
+			pa_sample_spec sample_spec;
+			sample_spec.format = PA_SAMPLE_FLOAT32NE;
+			sample_spec.rate = mixing_frequency;
+			sample_spec.channels = 2;
+
+			stream = pa_stream_new(context, "ClanLib mixer", &sample_spec, nullptr);
+			if (!stream)
+			{
+				pa_threaded_mainloop_unlock(mainloop);
+				throw Exception("pa_stream_new failed");
+			}
+			pa_stream_set_state_callback(stream, &SoundOutput_PulseAudio::stream_state_callback, this);
+			pa_stream_set_write_callback(stream, &SoundOutput_PulseAudio::stream_write_callback, this);
+			pa_stream_set_underflow_callback(stream, &SoundOutput_PulseAudio::stream_underflow_callback, this);
+
+			uint32_t period_bytes = period_frames * sizeof(float) * 2;
+			pa_buffer_attr buffer_attr;
+			buffer_attr.maxlength = (uint32_t)-1;
+			buffer_attr.tlength = period_bytes * 2;
+			buffer_attr.prebuf = (uint32_t)-1;
+			buffer_attr.minreq = period_bytes;
+			buffer_attr.fragsize = (uint32_t)-1;
+
+			start_device_mixing();
+			mixing = true;
+
+			pa_stream_flags_t flags = (pa_stream_flags_t)(PA_STREAM_ADJUST_LATENCY | PA_STREAM_AUTO_TIMING_UPDATE);
+			if (pa_stream_connect_playback(stream, nullptr, &buffer_attr, flags, nullptr, nullptr) < 0)
+			{
+				pa_threaded_mainloop_unlock(mainloop);
+				throw Exception("pa_stream_connect_playback failed");
+			}
+			wait_for_stream();
+			pa_threaded_mainloop_unlock(mainloop);
+		}
+		catch (...)
+		{
+			close();
+			throw;
+		}
+	}
+
+	SoundOutput_PulseAudio::~SoundOutput_PulseAudio()
+	{
+		close();
+	}
+
+	void SoundOutput_PulseAudio::close()
+	{
+		if (stream)
+		{
+			pa_threaded_mainloop_lock(mainloop);
+			pa_stream_disconnect(stream);
+			pa_stream_unref(stream);
+			stream = nullptr;
+			pa_threaded_mainloop_unlock(mainloop);
+		}
+
+		// The write callback can no longer run once the stream is gone
+		if (mixing)
+		{
+			stop_device_mixing();
+			mixing = false;
+		}
+
+		if (mainloop)
+			pa_threaded_mainloop_stop(mainloop);
+
+		if (context)
+		{
+			pa_context_disconnect(context);
+			pa_context_unref(context);
+			context = nullptr;
+		}
+
+		if (mainloop)
+		{
+			pa_threaded_mainloop_free(mainloop);
+			mainloop = nullptr;
+		}
+	}
+
+	void SoundOutput_PulseAudio::wait_for_context()
+	{
+		while (true)
+		{
+			pa_context_state_t state = pa_context_get_state(context);
+			if (state == PA_CONTEXT_READY)
+				return;
+			if (!PA_CONTEXT_IS_GOOD(state))
+			{
+				pa_threaded_mainloop_unlock(mainloop);
+				throw Exception("Could not connect to the PulseAudio server");
+			}
+			pa_threaded_mainloop_wait(mainloop);
+		}
+	}
+
+	void SoundOutput_PulseAudio::wait_for_stream()
+	{
+		while (true)
+		{
+			pa_stream_state_t state = pa_stream_get_state(stream);
+			if (state == PA_STREAM_READY)
+				return;
+			if (!PA_STREAM_IS_GOOD(state))
+			{
+				pa_threaded_mainloop_unlock(mainloop);
+				throw Exception("PulseAudio stream could not be created");
+			}
+			pa_threaded_mainloop_wait(mainloop);
+		}
+	}
+
+	void SoundOutput_PulseAudio::silence()
+	{
+	}
+
+	int SoundOutput_PulseAudio::get_fragment_size()
+	{
+		return period_frames;
+	}
+
+	void SoundOutput_PulseAudio::write_fragment(float *data)
+	{
+	}
+
+	void SoundOutput_PulseAudio::wait()
+	{
+	}
+
+	void SoundOutput_PulseAudio::context_state_callback(pa_context *context, void *userdata)
+	{
+		SoundOutput_PulseAudio *self = static_cast<SoundOutput_PulseAudio *>(userdata);
+		pa_threaded_mainloop_signal(self->mainloop, 0);
+	}
+
+	void SoundOutput_PulseAudio::stream_state_callback(pa_stream *stream, void *userdata)
+	{
+		SoundOutput_PulseAudio *self = static_cast<SoundOutput_PulseAudio *>(userdata);
+		pa_threaded_mainloop_signal(self->mainloop, 0);
+	}
+
+	void SoundOutput_PulseAudio::stream_write_callback(pa_stream *stream, size_t num_bytes, void *userdata)
+	{
+		SoundOutput_PulseAudio *self = static_cast<SoundOutput_PulseAudio *>(userdata);
+
+		while (num_bytes >= sizeof(float) * 2)
+		{
+			// Let the server hand out its own memory so the mixed frames are not copied again
+			void *data = nullptr;
+			size_t size = num_bytes;
+			if (pa_stream_begin_write(stream, &data, &size) < 0 || !data)
+				return;
+
+			int num_frames = (int)(size / (sizeof(float) * 2));
+			if (num_frames == 0)
+			{
+				pa_stream_cancel_write(stream);
+				return;
+			}
+
+			self->mix_device_frames(static_cast<float *>(data), num_frames);
+			pa_stream_write(stream, data, num_frames * sizeof(float) * 2, nullptr, 0, PA_SEEK_RELATIVE);
+			num_bytes -= std::min(num_bytes, num_frames * sizeof(float) * 2);
+		}
+	}
+
+	void SoundOutput_PulseAudio::stream_underflow_callback(pa_stream *stream, void *userdata)
+	{
+		// Runs on the mainloop thread, which is also the thread mixing the fragments
+		SoundOutput_PulseAudio *self = static_cast<SoundOutput_PulseAudio *>(userdata);
+		self->counters.record_device_underrun();
+	}
+}
+
+#endif
@@ -0,0 +1,80 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#ifdef __linux__
+
+#include "../../soundoutput_impl.h"
+#include <pulse/pulseaudio.h>
+
+namespace clan
+{
+	/// \brief Callback driven output through PulseAudio, or PipeWire through its PulseAudio server
+	///
+	/// Sessions are mixed on the PulseAudio mainloop thread straight into the stream buffer whenever the server asks
+	/// for more data. The stream negotiates a request size of one device period and a target length of two.
+	class SoundOutput_PulseAudio : public SoundOutput_Impl
+	{
+	public:
+		SoundOutput_PulseAudio(int mixing_frequency, int mixing_latency);
+		~SoundOutput_PulseAudio();
+
+		/// \brief Called when we have no samples to play - and wants to tell the sound card
+		/// \brief about this possible event.
+		void silence() override;
+
+		/// \brief Returns the buffer size used by device (returned as number of [stereo] samples).
+		int get_fragment_size() override;
+
+		/// \brief Not used. The stream write callback mixes directly into the stream buffer.
+		void write_fragment(float *data) override;
+
+		/// \brief Not used. The stream write callback mixes directly into the stream buffer.
+		void wait() override;
+
+	private:
+		void close();
+		void wait_for_context();
+		void wait_for_stream();
+
+		static void context_state_callback(pa_context *context, void *userdata);
+		static void stream_state_callback(pa_stream *stream, void *userdata);
+		static void stream_write_callback(pa_stream *stream, size_t num_bytes, void *userdata);
+		static void stream_underflow_callback(pa_stream *stream, void *userdata);
+
+		pa_threaded_mainloop *mainloop;
+		pa_context *context;
+		pa_stream *stream;
+		int period_frames;
+		bool mixing;
+	};
+}
+
+#endif
@@ -33,138 +33,124 @@
 
 namespace clan
 {
-
-inline UInt32 CalculateLPCMFlags (
-                                  UInt32 inValidBitsPerChannel,
-                                  UInt32 inTotalBitsPerChannel,
-                                  bool inIsFloat,
-                                  bool inIsBigEndian,
-                                  bool inIsNonInterleaved = false
-                                  ) {
-    return
-    (inIsFloat ? kAudioFormatFlagIsFloat : kAudioFormatFlagIsSignedInteger) |
-    (inIsBigEndian ? ((UInt32)kAudioFormatFlagIsBigEndian) : 0)             |
-    ((!inIsFloat && (inValidBitsPerChannel == inTotalBitsPerChannel)) ?
-     kAudioFormatFlagIsPacked : kAudioFormatFlagIsAlignedHigh)           |
-    (inIsNonInterleaved ? ((UInt32)kAudioFormatFlagIsNonInterleaved) : 0);
-}
-    
-    
-SoundOutput_MacOSX::SoundOutput_MacOSX(int frequency, int latency)
-: SoundOutput_Impl(frequency, latency), frequency(frequency), latency(latency), fragment_size(0), next_fragment(0), read_cursor(0), fragments_available(0)
-{
-    fragment_size = frequency * latency / fragment_buffer_count / 1000;
-    fragment_size = (fragment_size + 3) & ~3; // Force to be a multiple of 4
-    fragments_available = fragment_buffer_count;
-    fragment_data = DataBuffer(fragment_size * sizeof(short) * 2 * fragment_buffer_count);
-    
-    audio_format = {0};
-    start_mixer_thread();
-}
-
-SoundOutput_MacOSX::~SoundOutput_MacOSX()
-{
-	stop_mixer_thread();
-}
-
-void SoundOutput_MacOSX::mixer_thread_starting()
-{
-    audio_format.mSampleRate = frequency;
-    audio_format.mFormatID = kAudioFormatLinearPCM;
-    audio_format.mFormatFlags = CalculateLPCMFlags(8*sizeof(short),8*sizeof(short),false,false,false);
-    audio_format.mBytesPerPacket = 2 * sizeof(short);
-    audio_format.mFramesPerPacket = 1;
-    audio_format.mBytesPerFrame = 2 * sizeof(short);
-    audio_format.mChannelsPerFrame = 2;
-    audio_format.mBitsPerChannel = 8 * sizeof (short);
-    audio_format.mReserved = 0;
-
-    OSStatus result = AudioQueueNewOutput(&audio_format, &SoundOutput_MacOSX::static_audio_queue_callback, this, CFRunLoopGetCurrent(), kCFRunLoopDefaultMode, 0, &audio_queue);
-    if (result != 0)
-        throw Exception("AudioQueueNewOutput failed");
-
-    for (int i = 0; i < fragment_buffer_count; i++)
-    {
-        result = AudioQueueAllocateBuffer(audio_queue, fragment_size * sizeof(short) * 2, &audio_buffers[i]);
-        if (result != 0)
-            throw Exception("AudioQueueAllocateBuffer failed");
-        audio_queue_callback(audio_queue, audio_buffers[i]);
-    }
-    result = AudioQueuePrime(audio_queue,0,NULL);
-    if (result != 0)
-        throw Exception("AudioQueuePrime failed");
-    result = AudioQueueStart(audio_queue, 0);
-    if (result != 0)
-        throw Exception("AudioQueueStart failed");
-}
-
-void SoundOutput_MacOSX::mixer_thread_stopping()
-{
-    AudioQueueStop(audio_queue, true);
-    AudioQueueDispose(audio_queue, true);
-}
-
-void SoundOutput_MacOSX::silence()
-{
-}
-
-int SoundOutput_MacOSX::get_fragment_size()
-{
-    return fragment_size;
-}
-
-void SoundOutput_MacOSX::write_fragment(float *dataf)
-{
-    if (fragments_available == 0)
-        wait();
-    
-    short *databuf = reinterpret_cast<short*>(fragment_data.get_data()) + next_fragment * fragment_size * 2;
-    for (int i = 0; i < fragment_size * 2; i++)
-    {
-        databuf[i] = (short)(dataf[i]*32767);
-    }
-    
-    next_fragment++;
-    if (next_fragment == fragment_buffer_count)
-        next_fragment = 0;
-    fragments_available--;
-}
-
-void SoundOutput_MacOSX::wait()
-{
-    while (fragments_available == 0)
-    {
-        CFRunLoopRunInMode(kCFRunLoopDefaultMode, 1, true);
-    }
-}
-
-void SoundOutput_MacOSX::audio_queue_callback(AudioQueueRef queue, AudioQueueBufferRef buffer)
-{
-    if (fragments_available != fragment_buffer_count)
-    {
-        short *databuf = reinterpret_cast<short*>(fragment_data.get_data()) + read_cursor * fragment_size * 2;
-        memcpy(buffer->mAudioData, databuf, fragment_size * sizeof(short) * 2);
-        buffer->mAudioDataByteSize = fragment_size * sizeof(short) * 2;
-        fragments_available++;
-        read_cursor++;
-        if (read_cursor == fragment_buffer_count)
-            read_cursor = 0;
-    }
-    else
-    {
-        memset(buffer->mAudioData, 0, fragment_size * sizeof(short) * 2);
-        buffer->mAudioDataByteSize = fragment_size * sizeof(short) * 2;
-    }
-
-    OSStatus result = AudioQueueEnqueueBuffer(queue, buffer, 0, 0);
-    if (result != 0)
-        throw Exception("AudioQueueEnqueueBuffer failed");
-}
-
-void SoundOutput_MacOSX::static_audio_queue_callback(void *userdata, AudioQueueRef queue, AudioQueueBufferRef buffer)
-{
-    SoundOutput_MacOSX *self = reinterpret_cast<SoundOutput_MacOSX *>(userdata);
-    self->audio_queue_callback(queue, buffer);
-}
-
+	SoundOutput_MacOSX::SoundOutput_MacOSX(int frequency, int latency)
+		: SoundOutput_Impl(frequency, latency), fragment_size(0), audio_unit(nullptr), unit_initialized(false), unit_started(false), mixing(false)
+	{
+		try
+		{
+			AudioComponentDescription component_desc = { 0 };
+			component_desc.componentType = kAudioUnitType_Output;
+			component_desc.componentSubType = kAudioUnitSubType_DefaultOutput;
+			component_desc.componentManufacturer = kAudioUnitManufacturer_Apple;
+
+			AudioComponent component = AudioComponentFindNext(nullptr, &component_desc);
+			if (!component)
+				throw Exception("No default audio output component found");
+
+			OSStatus result = AudioComponentInstanceNew(component, &audio_unit);
+			if (result != noErr)
+				throw Exception("AudioComponentInstanceNew failed");
+
+			AudioStreamBasicDescription audio_format = { 0 };
+			audio_format.mSampleRate = mixing_frequency;
+			audio_format.mFormatID = kAudioFormatLinearPCM;
+			audio_format.mFormatFlags = kAudioFormatFlagIsFloat | kAudioFormatFlagIsPacked;
+			audio_format.mBytesPerPacket = 2 * sizeof(float);
+			audio_format.mFramesPerPacket = 1;
+			audio_format.mBytesPerFrame = 2 * sizeof(float);
+			audio_format.mChannelsPerFrame = 2;
+			audio_format.mBitsPerChannel = 8 * sizeof(float);
+
+			result = AudioUnitSetProperty(audio_unit, kAudioUnitProperty_StreamFormat, kAudioUnitScope_Input, 0, &audio_format, sizeof(audio_format));
+			if (result != noErr)
+				throw Exception("AudioUnitSetProperty(StreamFormat) failed");
+
+			// Ask the device for a buffer of one period. The device may pick another size, which mix_device_frames() handles.
+			fragment_size = get_device_period_frames();
+			UInt32 buffer_frames = fragment_size;
+			AudioUnitSetProperty(audio_unit, kAudioDevicePropertyBufferFrameSize, kAudioUnitScope_Global, 0, &buffer_frames, sizeof(buffer_frames));
+
+			AURenderCallbackStruct callback;
+			callback.inputProc = &SoundOutput_MacOSX::static_render_callback;
+			callback.inputProcRefCon = this;
+			result = AudioUnitSetProperty(audio_unit, kAudioUnitProperty_SetRenderCallback, kAudioUnitScope_Input, 0, &callback, sizeof(callback));
+			if (result != noErr)
+				throw Exception("AudioUnitSetProperty(SetRenderCallback) failed");
+
+			result = AudioUnitInitialize(audio_unit);
+			if (result != noErr)
+				throw Exception("AudioUnitInitialize failed");
+			unit_initialized = true;
+
+			start_device_mixing();
+			mixing = true;
+
+			result = AudioOutputUnitStart(audio_unit);
+			if (result != noErr)
+				throw Exception("AudioOutputUnitStart failed");
+			unit_started = true;
+		}
+		catch (...)
+		{
+			close();
+			throw;
+		}
+	}
+
+	SoundOutput_MacOSX::~SoundOutput_MacOSX()
+	{
+		close();
+	}
+
+	void SoundOutput_MacOSX::close()
+	{
+		// AudioOutputUnitStop waits for a running render callback to return
+		if (unit_started)
+		{
+			AudioOutputUnitStop(audio_unit);
+			unit_started = false;
+		}
+
+		if (mixing)
+		{
+			stop_device_mixing();
+			mixing = false;
+		}
+
+		if (unit_initialized)
+		{
+			AudioUnitUninitialize(audio_unit);
+			unit_initialized = false;
+		}
+
+		if (audio_unit)
+		{
+			AudioComponentInstanceDispose(audio_unit);
+			audio_unit = nullptr;
+		}
+	}
+
+	void SoundOutput_MacOSX::silence()
+	{
+	}
+
+	int SoundOutput_MacOSX::get_fragment_size()
+	{
+		return fragment_size;
+	}
+
+	void SoundOutput_MacOSX::write_fragment(float *data)
+	{
+	}
+
+	void SoundOutput_MacOSX::wait()
+	{
+	}
+
+	OSStatus SoundOutput_MacOSX::static_render_callback(void *userdata, AudioUnitRenderActionFlags *flags, const AudioTimeStamp *timestamp, UInt32 bus, UInt32 num_frames, AudioBufferList *data)
+	{
+		SoundOutput_MacOSX *self = reinterpret_cast<SoundOutput_MacOSX *>(userdata);
+		self->mix_device_frames(static_cast<float *>(data->mBuffers[0].mData), num_frames);
+		return noErr;
+	}
 }
@@ -29,53 +29,43 @@
 #pragma once
 
 #include "../../soundoutput_impl.h"
-#include "API/Core/System/databuffer.h"
 #include <AudioToolbox/AudioToolbox.h>
+#include <AudioUnit/AudioUnit.h>
 
 namespace clan
 {
+	/// \brief Callback driven output through the default output AudioUnit
+	///
+	/// The render callback mixes straight into the buffer CoreAudio hands out, with the device buffer size
+	/// negotiated down to one device period.
+	class SoundOutput_MacOSX : public SoundOutput_Impl
+	{
+	public:
+		SoundOutput_MacOSX(int mixing_frequency, int mixing_latency);
+		~SoundOutput_MacOSX();
 
-class SoundOutput_MacOSX : public SoundOutput_Impl
-{
-public:
-	SoundOutput_MacOSX(int mixing_frequency, int mixing_latency);
-	~SoundOutput_MacOSX();
-    
-	/// \brief Called when we have no samples to play - and wants to tell the soundcard
-	/// \brief about this possible event.
-	virtual void silence();
-    
-	/// \brief Returns the buffer size used by device (returned as num [stereo] samples).
-	virtual int get_fragment_size();
-    
-	/// \brief Writes a fragment to the soundcard.
-	virtual void write_fragment(float *data);
-    
-	/// \brief Waits until output source isn't full anymore.
-	virtual void wait();
+		/// \brief Called when we have no samples to play - and wants to tell the soundcard
+		/// \brief about this possible event.
+		void silence() override;
 
-    /// \brief Called by the mixer thread when it starts
-    virtual void mixer_thread_starting();
-    
-    /// \brief Called by the mixer thread when it stops
-    virtual void mixer_thread_stopping();
-    
-private:
-    void audio_queue_callback(AudioQueueRef queue, AudioQueueBufferRef buffer);
-    static void static_audio_queue_callback(void *userdata, AudioQueueRef queue, AudioQueueBufferRef buffer);
-    
-    static const int fragment_buffer_count = 4;
-    int frequency, latency;
-    int fragment_size;
-    int next_fragment, read_cursor;
-    int fragments_available;
-    DataBuffer fragment_data;
-    
-    AudioStreamBasicDescription audio_format;
-    AudioQueueRef audio_queue;
-    AudioQueueBufferRef audio_buffers[fragment_buffer_count];
-    
-};
-    
-}
+		/// \brief Returns the buffer size used by device (returned as num [stereo] samples).
+		int get_fragment_size() override;
+
+		/// \brief Not used. The render callback mixes directly into the device buffer.
+		void write_fragment(float *data) override;
+
+		/// \brief Not used. The render callback mixes directly into the device buffer.
+		void wait() override;
 
+	private:
+		void close();
+
+		static OSStatus static_render_callback(void *userdata, AudioUnitRenderActionFlags *flags, const AudioTimeStamp *timestamp, UInt32 bus, UInt32 num_frames, AudioBufferList *data);
+
+		int fragment_size;
+		AudioUnit audio_unit;
+		bool unit_initialized;
+		bool unit_started;
+		bool mixing;
+	};
+}
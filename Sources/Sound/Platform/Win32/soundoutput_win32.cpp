@@ -49,7 +49,7 @@ DEFINE_GUID(GUID_NULL,0x00000000L, 0x0000, 0x0000, 0x00, 0x00, 0x00, 0x00, 0x00,
 namespace clan
 {
 	SoundOutput_Win32::SoundOutput_Win32(int init_mixing_frequency, int init_mixing_latency)
-		: SoundOutput_Impl(init_mixing_frequency, init_mixing_latency), audio_buffer_ready_event(INVALID_HANDLE_VALUE), is_playing(false), fragment_size(0), wait_timeout(mixing_latency * 2), write_pos(0)
+		: SoundOutput_Impl(init_mixing_frequency, init_mixing_latency), audio_buffer_ready_event(INVALID_HANDLE_VALUE), exclusive_mode(false), is_playing(false), buffer_frames(0), fragment_frames(0), wait_timeout(mixing_latency * 2), render_stop_flag(false)
 	{
 		try
 		{
@@ -62,10 +62,6 @@ namespace clan
 			if (FAILED(result))
 				throw Exception("IDeviceEnumerator.GetDefaultAudioEndpoint failed");
 
-			result = mmdevice->Activate(__uuidof(IAudioClient), CLSCTX_ALL, 0, (void**)audio_client.output_variable());
-			if (FAILED(result))
-				throw Exception("IMMDevice.Activate failed");
-
 			WAVEFORMATEXTENSIBLE wave_format;
 			wave_format.Format.wFormatTag = WAVE_FORMAT_EXTENSIBLE;
 			wave_format.Format.nChannels = 2;
@@ -79,57 +75,39 @@ namespace clan
 			wave_format.Format.nSamplesPerSec = mixing_frequency;
 			wave_format.Format.nAvgBytesPerSec = wave_format.Format.nSamplesPerSec * wave_format.Format.nBlockAlign;
 
-			WAVEFORMATEX *closest_match = 0;
-			result = audio_client->IsFormatSupported(AUDCLNT_SHAREMODE_SHARED, (WAVEFORMATEX*)&wave_format, &closest_match);
-			if (FAILED(result))
-				throw Exception("IAudioClient.IsFormatSupported failed");
-
-			// We could not get the exact format we wanted. Try to use the frequency that the closest matching format is using:
-			if (result == S_FALSE)
+			audio_buffer_ready_event = CreateEvent(0, FALSE, FALSE, 0);
+			if (audio_buffer_ready_event == 0 || audio_buffer_ready_event == INVALID_HANDLE_VALUE)
 			{
-				mixing_frequency = closest_match->nSamplesPerSec;
-				wait_timeout = mixing_latency * 2;
-				wave_format.Format.nSamplesPerSec = mixing_frequency;
-				wave_format.Format.nAvgBytesPerSec = wave_format.Format.nSamplesPerSec * wave_format.Format.nBlockAlign;
-
-				CoTaskMemFree(closest_match);
-				closest_match = 0;
+				audio_buffer_ready_event = INVALID_HANDLE_VALUE;
+				throw Exception("CreateEvent failed");
 			}
 
-			/*
-					// For debugging what mixing format Windows is using.
-					WAVEFORMATEX *device_format = 0; // Note: this points at a WAVEFORMATEXTENSIBLE if cbSize is 22
-					result = audio_client->GetMixFormat(&device_format);
-					if (SUCCEEDED(result))
-					{
-					CoTaskMemFree(device_format);
-					device_format = 0;
-					}
-					*/
-
-			result = audio_client->Initialize(AUDCLNT_SHAREMODE_SHARED, AUDCLNT_STREAMFLAGS_EVENTCALLBACK, mixing_latency * (REFERENCE_TIME)1000, 0, (WAVEFORMATEX*)&wave_format, 0);
-			if (FAILED(result))
-				throw Exception("IAudioClient.Initialize failed");
+			exclusive_mode = initialize_exclusive(wave_format);
+			if (!exclusive_mode)
+				initialize_shared(wave_format);
 
 			result = audio_client->GetService(__uuidof(IAudioRenderClient), (void**)audio_render_client.output_variable());
 			if (FAILED(result))
 				throw Exception("IAudioClient.GetService(IAudioRenderClient) failed");
 
-			audio_buffer_ready_event = CreateEvent(0, TRUE, TRUE, 0);
-			if (audio_buffer_ready_event == INVALID_HANDLE_VALUE)
-				throw Exception("CreateEvent failed");
-
 			result = audio_client->SetEventHandle(audio_buffer_ready_event);
 			if (FAILED(result))
 				throw Exception("IAudioClient.SetEventHandle failed");
 
-			result = audio_client->GetBufferSize(&fragment_size);
+			result = audio_client->GetBufferSize(&buffer_frames);
 			if (FAILED(result))
 				throw Exception("IAudioClient.GetBufferSize failed");
 
-			next_fragment = DataBuffer(sizeof(float) * 2 * fragment_size);
+			// Exclusive mode events ask for a whole buffer at a time. In shared mode the buffer holds two periods.
+			if (exclusive_mode)
+				fragment_frames = buffer_frames;
+			else
+				fragment_frames = clan::max(buffer_frames / 2, (UINT32)1);
+
+			wait_timeout = clan::max(mixing_latency * 2, 20);
 
-			start_mixer_thread();
+			start_device_mixing();
+			render_thread = std::thread(&SoundOutput_Win32::render_thread_main, this);
 		}
 		catch (...)
 		{
@@ -141,7 +119,11 @@ namespace clan
 
 	SoundOutput_Win32::~SoundOutput_Win32()
 	{
-		stop_mixer_thread();
+		render_stop_flag = true;
+		SetEvent(audio_buffer_ready_event);
+		render_thread.join();
+		stop_device_mixing();
+
 		if (is_playing)
 			audio_client->Stop();
 		audio_render_client.clear();
@@ -150,45 +132,114 @@ namespace clan
 		CloseHandle(audio_buffer_ready_event);
 	}
 
-	void SoundOutput_Win32::silence()
+	bool SoundOutput_Win32::initialize_exclusive(WAVEFORMATEXTENSIBLE &wave_format)
 	{
-	}
+		HRESULT result = mmdevice->Activate(__uuidof(IAudioClient), CLSCTX_ALL, 0, (void**)audio_client.output_variable());
+		if (FAILED(result))
+			throw Exception("IMMDevice.Activate failed");
 
-	int SoundOutput_Win32::get_fragment_size()
-	{
-		return fragment_size;
-	}
+		result = audio_client->IsFormatSupported(AUDCLNT_SHAREMODE_EXCLUSIVE, (WAVEFORMATEX*)&wave_format, 0);
+		if (result != S_OK)
+		{
+			audio_client.clear();
+			return false;
+		}
 
-	void SoundOutput_Win32::write_fragment(float *data)
-	{
-		memcpy(next_fragment.get_data(), data, next_fragment.get_size());
-		write_pos = 0;
+		REFERENCE_TIME default_period = 0;
+		REFERENCE_TIME minimum_period = 0;
+		audio_client->GetDevicePeriod(&default_period, &minimum_period);
+
+		// Aim for the negotiated device period, but never go below what the device supports
+		REFERENCE_TIME period = clan::max(minimum_period, (REFERENCE_TIME)get_device_period_frames() * 10000000 / mixing_frequency);
+
+		result = audio_client->Initialize(AUDCLNT_SHAREMODE_EXCLUSIVE, AUDCLNT_STREAMFLAGS_EVENTCALLBACK, period, period, (WAVEFORMATEX*)&wave_format, 0);
+		if (result == AUDCLNT_E_BUFFER_SIZE_NOT_ALIGNED)
+		{
+			// The device wants a buffer size aligned to its own granularity. Retry with the aligned size on a new client.
+			UINT32 aligned_frames = 0;
+			audio_client->GetBufferSize(&aligned_frames);
+			audio_client.clear();
+
+			period = (REFERENCE_TIME)(10000000.0 * aligned_frames / mixing_frequency + 0.5);
+			result = mmdevice->Activate(__uuidof(IAudioClient), CLSCTX_ALL, 0, (void**)audio_client.output_variable());
+			if (FAILED(result))
+				throw Exception("IMMDevice.Activate failed");
+			result = audio_client->Initialize(AUDCLNT_SHAREMODE_EXCLUSIVE, AUDCLNT_STREAMFLAGS_EVENTCALLBACK, period, period, (WAVEFORMATEX*)&wave_format, 0);
+		}
+
+		if (FAILED(result))
+		{
+			// Exclusive mode is commonly disabled or the device is in use by another exclusive client
+			audio_client.clear();
+			return false;
+		}
+		return true;
 	}
 
-	void SoundOutput_Win32::wait()
+	void SoundOutput_Win32::initialize_shared(WAVEFORMATEXTENSIBLE &wave_format)
 	{
-		while (write_pos < fragment_size)
+		HRESULT result = mmdevice->Activate(__uuidof(IAudioClient), CLSCTX_ALL, 0, (void**)audio_client.output_variable());
+		if (FAILED(result))
+			throw Exception("IMMDevice.Activate failed");
+
+		WAVEFORMATEX *closest_match = 0;
+		result = audio_client->IsFormatSupported(AUDCLNT_SHAREMODE_SHARED, (WAVEFORMATEX*)&wave_format, &closest_match);
+		if (FAILED(result))
+			throw Exception("IAudioClient.IsFormatSupported failed");
+
+		// We could not get the exact format we wanted. Try to use the frequency that the closest matching format is using:
+		if (result == S_FALSE)
 		{
-			WaitForSingleObject(audio_buffer_ready_event, wait_timeout);
+			mixing_frequency = closest_match->nSamplesPerSec;
+			wave_format.Format.nSamplesPerSec = mixing_frequency;
+			wave_format.Format.nAvgBytesPerSec = wave_format.Format.nSamplesPerSec * wave_format.Format.nBlockAlign;
+
+			CoTaskMemFree(closest_match);
+			closest_match = 0;
+		}
+
+		REFERENCE_TIME default_period = 0;
+		REFERENCE_TIME minimum_period = 0;
+		audio_client->GetDevicePeriod(&default_period, &minimum_period);
+
+		// The shared mode engine runs at its default period, so a buffer of two periods is the lowest that does not underrun
+		REFERENCE_TIME period = clan::max(default_period, (REFERENCE_TIME)get_device_period_frames() * 10000000 / mixing_frequency);
 
-			UINT32 num_padding_frames = 0;
-			audio_client->GetCurrentPadding(&num_padding_frames);
+		result = audio_client->Initialize(AUDCLNT_SHAREMODE_SHARED, AUDCLNT_STREAMFLAGS_EVENTCALLBACK, period * 2, 0, (WAVEFORMATEX*)&wave_format, 0);
+		if (FAILED(result))
+			throw Exception("IAudioClient.Initialize failed");
+	}
 
-			UINT32 buffer_available = fragment_size - num_padding_frames;
-			UINT32 buffer_needed = fragment_size - write_pos;
+	void SoundOutput_Win32::render_thread_main()
+	{
+		SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
 
-			if (buffer_available < buffer_needed)
-				ResetEvent(audio_buffer_ready_event);
+		while (!render_stop_flag)
+		{
+			UINT32 num_frames = 0;
+			if (exclusive_mode)
+			{
+				num_frames = buffer_frames;
+			}
+			else
+			{
+				UINT32 num_padding_frames = 0;
+				audio_client->GetCurrentPadding(&num_padding_frames);
+				num_frames = buffer_frames - num_padding_frames;
+
+				// The engine played everything we gave it before we were woken up
+				if (is_playing && num_padding_frames == 0)
+					counters.record_device_underrun();
+			}
 
-			UINT32 buffer_size = clan::min(buffer_needed, buffer_available);
-			if (buffer_size > 0)
+			if (num_frames > 0)
 			{
 				BYTE *buffer = 0;
-				HRESULT result = audio_render_client->GetBuffer(buffer_size, &buffer);
+				HRESULT result = audio_render_client->GetBuffer(num_frames, &buffer);
 				if (SUCCEEDED(result))
 				{
-					memcpy(buffer, next_fragment.get_data<float>() + write_pos * 2, sizeof(float) * 2 * buffer_size);
-					result = audio_render_client->ReleaseBuffer(buffer_size, 0);
+					mix_device_frames(reinterpret_cast<float*>(buffer), num_frames);
+					audio_render_client->ReleaseBuffer(num_frames, 0);
 
 					if (!is_playing)
 					{
@@ -197,9 +248,26 @@ namespace clan
 							is_playing = true;
 					}
 				}
-
-				write_pos += buffer_size;
 			}
+
+			WaitForSingleObject(audio_buffer_ready_event, wait_timeout);
 		}
 	}
+
+	void SoundOutput_Win32::silence()
+	{
+	}
+
+	int SoundOutput_Win32::get_fragment_size()
+	{
+		return fragment_frames;
+	}
+
+	void SoundOutput_Win32::write_fragment(float *data)
+	{
+	}
+
+	void SoundOutput_Win32::wait()
+	{
+	}
 }
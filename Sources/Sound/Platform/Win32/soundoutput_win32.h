@@ -33,9 +33,15 @@
 #include "API/Core/System/databuffer.h"
 #include <mmdeviceapi.h>
 #include <audioclient.h>
+#include <thread>
+#include <atomic>
 
 namespace clan
 {
+	/// \brief Event driven WASAPI output
+	///
+	/// Exclusive mode with the minimum device period is tried first, falling back to shared mode with a buffer of two
+	/// device periods. A render thread woken by the audio engine mixes directly into the endpoint buffer.
 	class SoundOutput_Win32 : public SoundOutput_Impl
 	{
 	public:
@@ -49,21 +55,28 @@ namespace clan
 		/// \brief Returns the buffer size used by device (returned as number of [stereo] samples).
 		int get_fragment_size() override;
 
-		/// \brief Writes a fragment to the sound card.
+		/// \brief Not used. The render thread mixes directly into the endpoint buffer.
 		void write_fragment(float *data) override;
 
-		/// \brief Waits until output source isn't full anymore.
+		/// \brief Not used. The render thread mixes directly into the endpoint buffer.
 		void wait() override;
 
 	private:
+		bool initialize_exclusive(WAVEFORMATEXTENSIBLE &wave_format);
+		void initialize_shared(WAVEFORMATEXTENSIBLE &wave_format);
+		void render_thread_main();
+
 		ComPtr<IMMDevice> mmdevice;
 		ComPtr<IAudioClient> audio_client;
 		ComPtr<IAudioRenderClient> audio_render_client;
-		DataBuffer next_fragment;
 		HANDLE audio_buffer_ready_event;
+		bool exclusive_mode;
 		bool is_playing;
-		UINT32 fragment_size;
+		UINT32 buffer_frames;
+		UINT32 fragment_frames;
 		int wait_timeout;
-		int write_pos;
+
+		std::thread render_thread;
+		std::atomic_bool render_stop_flag;
 	};
 }
@@ -30,6 +30,11 @@
 #include "Sound/precomp.h"
 #include "echofilter_provider.h"
 #include <memory.h>
+#include <algorithm>
+
+#ifndef CL_DISABLE_SSE2
+#include <emmintrin.h>
+#endif
 
 namespace clan
 {
@@ -52,25 +57,48 @@ namespace clan
 
 	void EchoFilterProvider::filter(float **sample_data, int num_samples, int channels)
 	{
-		int start_pos = pos;
-
-		for (int c = 0; c < 2; c++)
+		float feedback = 1.0f / shift_factor;
+		int num_channels = std::min(channels, 2);
+		for (int c = 0; c < num_channels; c++)
 		{
-			if (c == channels) break;
+			// Process the spans between wrap-arounds of the delay line, so there is no wrap check per sample
+			int delay_pos = pos;
+			int i = 0;
+			while (i < num_samples)
+			{
+				int span = std::min(num_samples - i, buffer_size - delay_pos);
+				echo_span(buffer[c] + delay_pos, sample_data[c] + i, span, feedback);
+				i += span;
+				delay_pos += span;
+				if (delay_pos == buffer_size)
+					delay_pos = 0;
+			}
+		}
 
-			float *data = sample_data[c];
-			float *work_buffer = buffer[c];
+		if (num_channels > 0)
+			pos = (int)((pos + (long long)num_samples) % buffer_size);
+	}
 
-			pos = start_pos;
+	void EchoFilterProvider::echo_span(float *delay, float *data, int size, float feedback)
+	{
+#ifndef CL_DISABLE_SSE2
+		int sse_size = (size / 4) * 4;
 
-			for (int i = 0; i < num_samples; i++)
-			{
-				work_buffer[pos] /= shift_factor;
-				work_buffer[pos] += data[i];
-				data[i] = work_buffer[pos];
-				pos++;
-				if (pos == buffer_size) pos = 0;
-			}
+		__m128 feedback0 = _mm_set1_ps(feedback);
+		for (int i = 0; i < sse_size; i += 4)
+		{
+			__m128 s = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(delay + i), feedback0), _mm_loadu_ps(data + i));
+			_mm_storeu_ps(delay + i, s);
+			_mm_storeu_ps(data + i, s);
+		}
+#else
+		const int sse_size = 0;
+#endif
+
+		for (int i = sse_size; i < size; i++)
+		{
+			delay[i] = delay[i] * feedback + data[i];
+			data[i] = delay[i];
 		}
 	}
 }
@@ -42,6 +42,9 @@ namespace clan
 		void filter(float **sample_data, int num_samples, int channels) override;
 
 	private:
+		/// \brief Feeds a span of samples through a part of the delay line that does not wrap around
+		static void echo_span(float *delay, float *data, int size, float feedback);
+
 		int buffer_size;
 		float *buffer[2];
 		float shift_factor;
@@ -29,6 +29,9 @@
 
 #include "Sound/precomp.h"
 #include "fadefilter_provider.h"
+#include "API/Sound/sound_sse.h"
+#include <algorithm>
+#include <cmath>
 
 namespace clan
 {
@@ -79,22 +82,32 @@ namespace clan
 
 	void FadeFilterProvider::filter(float **sample_data, int num_samples, int channels)
 	{
-		for (int i = 0; i < num_samples; i++)
+		// Fades are applied as linear volume ramps over the samples until the target volume is reached
+		int i = 0;
+		while (i < num_samples && speed != 0.0f)
 		{
+			int fade_samples = (int)std::ceil((new_volume - cur_volume) / speed);
+			int count = std::min(num_samples - i, std::max(fade_samples, 1));
+			float end_volume = cur_volume + speed * count;
+
 			for (int j = 0; j < channels; j++)
-			{
-				sample_data[j][i] = (sample_data[j][i] * cur_volume);
-			}
+				SoundSSE::multiply_float_ramp(sample_data[j] + i, count, cur_volume, end_volume);
 
-			// change volume for every second sample (because data is in stereo).
-			cur_volume += speed;
+			cur_volume = end_volume;
+			i += count;
 			if (
-				(speed > 0 && cur_volume > new_volume) ||
-				(speed < 0 && cur_volume < new_volume))
+				(speed > 0 && cur_volume >= new_volume) ||
+				(speed < 0 && cur_volume <= new_volume))
 			{
 				cur_volume = new_volume;
 				speed = 0;
 			}
 		}
+
+		if (i < num_samples)
+		{
+			for (int j = 0; j < channels; j++)
+				SoundSSE::multiply_float(sample_data[j] + i, num_samples - i, cur_volume);
+		}
 	}
 }
@@ -32,10 +32,16 @@
 #include "inverse_echofilter_provider.h"
 #include <memory>
 
+#include <algorithm>
+
 #ifndef WIN32
 #include <string.h>
 #endif
 
+#ifndef CL_DISABLE_SSE2
+#include <emmintrin.h>
+#endif
+
 namespace clan
 {
 	InverseEchoFilterProvider::InverseEchoFilterProvider(int new_buffer_size) : buffer_size(new_buffer_size)
@@ -57,35 +63,68 @@ namespace clan
 
 	void InverseEchoFilterProvider::filter(float **sample_data, int num_samples, int channels)
 	{
-		int start_pos = pos;
-
-		for (int c = 0; c < 2; c++)
+		int delay = buffer_size / 4;
+		int num_channels = std::min(channels, 2);
+		for (int c = 0; c < num_channels; c++)
 		{
-			if (c == channels) break;
-
 			float *work_buffer = buffer[c];
+			float *data = sample_data[c];
 
-			pos = start_pos;
-
-			int delay = buffer_size / 4;
-			for (int i = 0; i < num_samples; i++)
+			int p = pos;
+			int i = 0;
+			while (i < num_samples)
 			{
-				work_buffer[pos] = sample_data[c][i];
-
-				int res = 0;
+				// Largest span where neither the write position nor any of the taps wrap around
+				int tap[4];
+				int span = std::min(num_samples - i, buffer_size - p);
 				for (int j = 0; j < 4; j++)
 				{
-					int p = pos + delay*j;
-					if (p >= buffer_size) p -= buffer_size;
+					tap[j] = (p + delay * j) % buffer_size;
+					span = std::min(span, buffer_size - tap[j]);
+				}
 
-					res += work_buffer[p] / (5 - j);
+				int k = 0;
+#ifndef CL_DISABLE_SSE2
+				// Taps less than a vector ahead would read slots written by the same vector
+				if (delay >= 4)
+				{
+					int sse_span = (span / 4) * 4;
+					__m128 scale1 = _mm_set1_ps(1.0f / 4.0f);
+					__m128 scale2 = _mm_set1_ps(1.0f / 3.0f);
+					__m128 scale3 = _mm_set1_ps(1.0f / 2.0f);
+					__m128 scale0 = _mm_set1_ps(1.0f / 5.0f);
+					for (; k < sse_span; k += 4)
+					{
+						__m128 s = _mm_loadu_ps(data + i + k);
+						_mm_storeu_ps(work_buffer + tap[0] + k, s);
+
+						__m128 res = _mm_mul_ps(s, scale0);
+						res = _mm_add_ps(res, _mm_mul_ps(_mm_loadu_ps(work_buffer + tap[1] + k), scale1));
+						res = _mm_add_ps(res, _mm_mul_ps(_mm_loadu_ps(work_buffer + tap[2] + k), scale2));
+						res = _mm_add_ps(res, _mm_mul_ps(_mm_loadu_ps(work_buffer + tap[3] + k), scale3));
+						_mm_storeu_ps(data + i + k, res);
+					}
 				}
+#endif
+				for (; k < span; k++)
+				{
+					work_buffer[tap[0] + k] = data[i + k];
 
-				sample_data[c][i] = res;
+					float res = 0.0f;
+					for (int j = 0; j < 4; j++)
+						res += work_buffer[tap[j] + k] / (5 - j);
 
-				pos++;
-				if (pos == buffer_size) pos = 0;
+					data[i + k] = res;
+				}
+
+				i += span;
+				p += span;
+				if (p == buffer_size)
+					p = 0;
 			}
 		}
+
+		if (num_channels > 0)
+			pos = (int)((pos + (long long)num_samples) % buffer_size);
 	}
 }
@@ -0,0 +1,166 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "Sound/precomp.h"
+#include "sound_streamer.h"
+#include "API/Core/System/profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace clan
+{
+	SoundStreamBuffer::SoundStreamBuffer(int num_channels, int min_capacity)
+		: capacity(1), read_position(0), write_position(0)
+	{
+		// Power of two, so the positions can wrap around
+		while (capacity < min_capacity)
+			capacity *= 2;
+		data.resize(num_channels);
+		for (auto &channel : data)
+			channel.resize(capacity);
+	}
+
+	int SoundStreamBuffer::write(float **channels, int offset, int count)
+	{
+		unsigned int position = write_position.load(std::memory_order_relaxed);
+		count = std::min(count, get_space());
+
+		int start = position & (capacity - 1);
+		int first = std::min(count, capacity - start);
+		for (size_t i = 0; i < data.size(); i++)
+		{
+			memcpy(&data[i][start], channels[i] + offset, first * sizeof(float));
+			memcpy(&data[i][0], channels[i] + offset + first, (count - first) * sizeof(float));
+		}
+
+		write_position.store(position + count, std::memory_order_release);
+		return count;
+	}
+
+	int SoundStreamBuffer::read(float **channels, int offset, int count)
+	{
+		unsigned int position = read_position.load(std::memory_order_relaxed);
+		count = std::min(count, get_available());
+
+		int start = position & (capacity - 1);
+		int first = std::min(count, capacity - start);
+		for (size_t i = 0; i < data.size(); i++)
+		{
+			memcpy(channels[i] + offset, &data[i][start], first * sizeof(float));
+			memcpy(channels[i] + offset + first, &data[i][0], (count - first) * sizeof(float));
+		}
+
+		read_position.store(position + count, std::memory_order_release);
+		return count;
+	}
+
+	SoundStreamer::SoundStreamer() : stop_flag(false)
+	{
+	}
+
+	SoundStreamer::~SoundStreamer()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		stop_flag = true;
+		lock.unlock();
+		event.notify_all();
+		if (thread.joinable())
+			thread.join();
+	}
+
+	SoundStreamer &SoundStreamer::instance()
+	{
+		static SoundStreamer streamer;
+		return streamer;
+	}
+
+	void SoundStreamer::add(SoundStream *stream)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		streams.push_back(stream);
+		if (!thread.joinable())
+			thread = std::thread(&SoundStreamer::thread_main, this);
+		lock.unlock();
+		event.notify_all();
+	}
+
+	void SoundStreamer::remove(SoundStream *stream)
+	{
+		// Decoding happens with the mutex held, so taking it waits for any block being decoded for the stream
+		std::unique_lock<std::mutex> lock(mutex);
+		streams.erase(std::remove(streams.begin(), streams.end(), stream), streams.end());
+	}
+
+	void SoundStreamer::wake_up()
+	{
+		event.notify_all();
+	}
+
+	void SoundStreamer::thread_main()
+	{
+		Profiler::set_thread_name("Sound streamer");
+
+		std::unique_lock<std::mutex> lock(mutex);
+		while (!stop_flag)
+		{
+			SoundStream *stream = find_next_stream();
+			if (!stream || !stream->decode_stream())
+			{
+				// Buffers are polled as well, since the mixer thread never signals the streamer
+				event.wait_for(lock, std::chrono::milliseconds(5));
+				continue;
+			}
+
+			// Let add and remove in between blocks
+			lock.unlock();
+			std::this_thread::yield();
+			lock.lock();
+		}
+	}
+
+	SoundStream *SoundStreamer::find_next_stream()
+	{
+		SoundStream *urgent = nullptr;
+		SoundStream *emptiest = nullptr;
+		float emptiest_fill = 1.0f;
+		for (SoundStream *stream : streams)
+		{
+			float fill = stream->get_stream_fill();
+			if (fill < 0.5f && (!urgent || stream->get_stream_priority() > urgent->get_stream_priority()))
+				urgent = stream;
+			if (fill < emptiest_fill)
+			{
+				emptiest = stream;
+				emptiest_fill = fill;
+			}
+		}
+		return urgent ? urgent : emptiest;
+	}
+}
@@ -0,0 +1,119 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+namespace clan
+{
+	/// \brief Single producer, single consumer ring of multi channel float samples
+	///
+	/// The streaming thread writes decoded samples and the mixer reads them. Neither end blocks or allocates.
+	class SoundStreamBuffer
+	{
+	public:
+		SoundStreamBuffer(int num_channels, int min_capacity);
+
+		int get_capacity() const { return capacity; }
+
+		/// \brief Number of samples that can be read
+		int get_available() const { return (int)(write_position.load(std::memory_order_acquire) - read_position.load(std::memory_order_relaxed)); }
+
+		/// \brief Number of samples that can be written
+		int get_space() const { return capacity - (int)(write_position.load(std::memory_order_relaxed) - read_position.load(std::memory_order_acquire)); }
+
+		/// \brief Writes up to count samples from each channel. Producer only.
+		int write(float **channels, int offset, int count);
+
+		/// \brief Reads up to count samples into each channel. Consumer only.
+		int read(float **channels, int offset, int count);
+
+		/// \brief Drops all unread samples. Only safe while the consumer is known not to read.
+		void discard() { read_position.store(write_position.load(std::memory_order_relaxed), std::memory_order_release); }
+
+	private:
+		int capacity;
+		std::vector< std::vector<float> > data;
+		std::atomic<unsigned int> read_position;
+		std::atomic<unsigned int> write_position;
+	};
+
+	/// \brief Stream decoded ahead of playback by the sound streamer thread
+	class SoundStream
+	{
+	public:
+		virtual ~SoundStream() { }
+
+		/// \brief Priority of the stream. Streams with higher priority are decoded first when several run low.
+		virtual int get_stream_priority() const = 0;
+
+		/// \brief How full the read-ahead buffer is, from 0 (empty) to 1 (full)
+		virtual float get_stream_fill() const = 0;
+
+		/// \brief Decodes the next block of samples. Returns false if there was nothing to decode.
+		virtual bool decode_stream() = 0;
+	};
+
+	/// \brief Background thread keeping the read-ahead buffers of all sound streams filled
+	///
+	/// Each pass picks one stream to decode a block for. Streams less than half full are served first, highest
+	/// priority first. Otherwise the emptiest stream is decoded. The thread sleeps when all buffers are full.
+	class SoundStreamer
+	{
+	public:
+		~SoundStreamer();
+
+		static SoundStreamer &instance();
+
+		/// \brief Starts decoding a stream on the streamer thread
+		void add(SoundStream *stream);
+
+		/// \brief Stops decoding a stream. Waits if the stream is being decoded.
+		void remove(SoundStream *stream);
+
+		/// \brief Wakes up the streamer thread, for example after a stream was emptied by a seek
+		void wake_up();
+
+	private:
+		SoundStreamer();
+		void thread_main();
+		SoundStream *find_next_stream();
+
+		std::thread thread;
+		std::mutex mutex;
+		std::condition_variable event;
+		std::vector<SoundStream *> streams;
+		bool stop_flag;
+	};
+}
@@ -0,0 +1,150 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Sound/precomp.h"
+#include "soundprovider_pcm_cache.h"
+#include "../sound_pcm_cache_impl.h"
+#include "API/Sound/sound_sse.h"
+#include <algorithm>
+
+namespace clan
+{
+	SoundProvider_PCMCache::SoundProvider_PCMCache(const std::shared_ptr<SoundPCMCache_Impl> &cache, const std::string &key, const SoundBuffer &source)
+		: cache(cache), key(key), source(source)
+	{
+	}
+
+	SoundProvider_Session *SoundProvider_PCMCache::begin_session()
+	{
+		std::shared_ptr<SoundPCMClip> clip = cache->get_clip(key, source.get_provider());
+		if (clip)
+			return new SoundProvider_PCMCache_Session(clip);
+		else
+			return source.get_provider()->begin_session();
+	}
+
+	void SoundProvider_PCMCache::end_session(SoundProvider_Session *session)
+	{
+		if (dynamic_cast<SoundProvider_PCMCache_Session *>(session))
+			delete session;
+		else
+			source.get_provider()->end_session(session);
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	SoundProvider_PCMCache_Session::SoundProvider_PCMCache_Session(const std::shared_ptr<SoundPCMClip> &clip)
+		: clip(clip), position(0), end_position(clip->num_samples)
+	{
+	}
+
+	int SoundProvider_PCMCache_Session::get_num_samples() const
+	{
+		return clip->num_samples;
+	}
+
+	int SoundProvider_PCMCache_Session::get_frequency() const
+	{
+		return clip->frequency;
+	}
+
+	int SoundProvider_PCMCache_Session::get_num_channels() const
+	{
+		return clip->num_channels;
+	}
+
+	int SoundProvider_PCMCache_Session::get_position() const
+	{
+		return position;
+	}
+
+	bool SoundProvider_PCMCache_Session::eof() const
+	{
+		return position >= end_position;
+	}
+
+	void SoundProvider_PCMCache_Session::stop()
+	{
+	}
+
+	bool SoundProvider_PCMCache_Session::play()
+	{
+		return true;
+	}
+
+	bool SoundProvider_PCMCache_Session::set_position(int pos)
+	{
+		if (pos < 0 || pos > clip->num_samples)
+			return false;
+		position = pos;
+		return true;
+	}
+
+	bool SoundProvider_PCMCache_Session::set_end_position(int pos)
+	{
+		if (pos < 0 || pos > clip->num_samples)
+			return false;
+		end_position = pos;
+		return true;
+	}
+
+	int SoundProvider_PCMCache_Session::get_data(float **data_ptr, int data_requested)
+	{
+		int samples = std::max(std::min(data_requested, end_position - position), 0);
+		int num_channels = clip->num_channels;
+
+		if (!clip->float_samples.empty())
+		{
+			for (int j = 0; j < num_channels; j++)
+				memcpy(data_ptr[j], clip->float_samples.data() + j * clip->num_samples + position, samples * sizeof(float));
+		}
+		else
+		{
+			short *src = clip->short_samples.data() + position * num_channels;
+			if (num_channels == 2)
+			{
+				SoundSSE::unpack_16bit_stereo(src, samples * 2, data_ptr);
+			}
+			else if (num_channels == 1)
+			{
+				SoundSSE::unpack_16bit_mono(src, samples, data_ptr[0]);
+			}
+			else
+			{
+				for (int i = 0; i < samples; i++)
+				{
+					for (int j = 0; j < num_channels; j++)
+						data_ptr[j][i] = src[i * num_channels + j] / 32767.0f;
+				}
+			}
+		}
+
+		position += samples;
+		return samples;
+	}
+}
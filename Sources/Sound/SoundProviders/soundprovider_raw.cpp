@@ -64,4 +64,9 @@ namespace clan
 	{
 		delete session;
 	}
+
+	size_t SoundProvider_Raw::get_memory_size() const
+	{
+		return (size_t)impl->num_samples * impl->bytes_per_sample * (impl->stereo ? 2 : 1);
+	}
 }
@@ -44,7 +44,10 @@ namespace clan
 		: impl(std::make_shared<SoundProvider_Vorbis_Impl>())
 	{
 		IODevice input = fs.open_file(filename, File::open_existing, File::access_read, File::share_all);
-		impl->load(input);
+		if (stream)
+			impl->open_stream(input);
+		else
+			impl->load(input);
 	}
 
 	SoundProvider_Vorbis::SoundProvider_Vorbis(
@@ -55,20 +58,36 @@ namespace clan
 		std::string filename = PathHelp::get_filename(fullname, PathHelp::path_type_file);
 		FileSystem vfs(path);
 		IODevice input = vfs.open_file(filename, File::open_existing, File::access_read, File::share_all);
-		impl->load(input);
+		if (stream)
+			impl->open_stream(input);
+		else
+			impl->load(input);
 	}
 
 	SoundProvider_Vorbis::SoundProvider_Vorbis(
 		IODevice &file, bool stream)
 		: impl(std::make_shared<SoundProvider_Vorbis_Impl>())
 	{
-		impl->load(file);
+		if (stream)
+			impl->open_stream(file);
+		else
+			impl->load(file);
 	}
 
 	SoundProvider_Vorbis::~SoundProvider_Vorbis()
 	{
 	}
 
+	void SoundProvider_Vorbis::set_read_ahead(int milliseconds)
+	{
+		impl->read_ahead = milliseconds;
+	}
+
+	void SoundProvider_Vorbis::set_stream_priority(int priority)
+	{
+		impl->priority = priority;
+	}
+
 	SoundProvider_Session *SoundProvider_Vorbis::begin_session()
 	{
 		return new SoundProvider_Vorbis_Session(*this);
@@ -79,6 +98,11 @@ namespace clan
 		delete session;
 	}
 
+	size_t SoundProvider_Vorbis::get_memory_size() const
+	{
+		return impl->buffer.get_size();
+	}
+
 	void SoundProvider_Vorbis_Impl::load(IODevice &input)
 	{
 		int size = input.get_size();
@@ -86,4 +110,19 @@ namespace clan
 		int bytes_read = input.read(buffer.get_data(), buffer.get_size());
 		buffer.set_size(bytes_read);
 	}
+
+	void SoundProvider_Vorbis_Impl::open_stream(IODevice &input)
+	{
+		streaming = true;
+		device = input;
+	}
+
+	int SoundProvider_Vorbis_Impl::read_stream(int offset, void *data, int size)
+	{
+		// Sessions of the same provider share the device
+		std::unique_lock<std::mutex> lock(device_mutex);
+		if (!device.seek(offset))
+			return 0;
+		return device.read(data, size, false);
+	}
 }
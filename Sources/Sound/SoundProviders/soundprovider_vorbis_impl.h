@@ -30,7 +30,9 @@
 
 #include "API/Sound/soundformat.h"
 #include "API/Core/System/databuffer.h"
+#include "API/Core/IOData/iodevice.h"
 #include <string>
+#include <mutex>
 
 namespace clan
 {
@@ -39,6 +41,20 @@ namespace clan
 	public:
 		void load(IODevice &input);
 
+		/// \brief Keeps the device open so sessions read the file in blocks on the streamer thread
+		void open_stream(IODevice &input);
+
+		/// \brief Reads from the streamed file at the given offset. Returns the number of bytes read.
+		int read_stream(int offset, void *data, int size);
+
+		/// \brief Whole file, when not streaming
 		DataBuffer buffer;
+
+		bool streaming = false;
+		IODevice device;
+		std::mutex device_mutex;
+
+		int read_ahead = 500;
+		int priority = 0;
 	};
 }
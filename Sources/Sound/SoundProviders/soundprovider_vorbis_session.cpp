@@ -33,22 +33,35 @@
 #include "API/Core/IOData/iodevice.h"
 #include "API/Core/IOData/memory_device.h"
 #include "API/Core/System/exception.h"
+#include <algorithm>
 
 namespace clan
 {
 	SoundProvider_Vorbis_Session::SoundProvider_Vorbis_Session(SoundProvider_Vorbis &source) :
-		source(source), position(0), stream_eof(false), handle(nullptr), stream_byte_offset(0), pcm(nullptr), pcm_position(0), pcm_samples(0)
+		source(source), frequency(0), num_channels(0), position(0), seek_requested(false), looping(false), stream_end(false), read_ahead_samples(0), priority(source.impl->priority),
+		handle(nullptr), input_data(nullptr), input_size(0), input_offset(0), file_offset(0), pcm(nullptr), pcm_position(0), pcm_samples(0)
 	{
-		int error = 0;
-		handle = stb_vorbis_open_pushdata(source.impl->buffer.get_data<unsigned char>(), source.impl->buffer.get_size(), &stream_byte_offset, &error, nullptr);
-		if (handle == nullptr)
+		if (!open_decoder())
 			throw Exception("Unable to read ogg file");
 
-		stream_info = stb_vorbis_get_info(handle);
+		frequency = stream_info.sample_rate;
+		num_channels = stream_info.channels;
+
+		// The ring has room for a whole frame on top of the read-ahead
+		read_ahead_samples = std::max((int)((long long)source.impl->read_ahead * frequency / 1000), 1);
+		ring.reset(new SoundStreamBuffer(num_channels, read_ahead_samples + 4096));
+
+		// Decode the start of the stream here, so playback can begin before the streamer gets to it
+		while (ring->get_available() < read_ahead_samples / 4 && decode_stream())
+		{
+		}
+
+		SoundStreamer::instance().add(this);
 	}
 
 	SoundProvider_Vorbis_Session::~SoundProvider_Vorbis_Session()
 	{
+		SoundStreamer::instance().remove(this);
 		if (handle)
 			stb_vorbis_close(handle);
 	}
@@ -60,12 +73,12 @@ namespace clan
 
 	int SoundProvider_Vorbis_Session::get_frequency() const
 	{
-		return stream_info.sample_rate;
+		return frequency;
 	}
 
 	int SoundProvider_Vorbis_Session::get_num_channels() const
 	{
-		return stream_info.channels;
+		return num_channels;
 	}
 
 	int SoundProvider_Vorbis_Session::get_position() const
@@ -73,9 +86,15 @@ namespace clan
 		return position;
 	}
 
+	bool SoundProvider_Vorbis_Session::set_looping(bool loop)
+	{
+		looping = loop;
+		return true;
+	}
+
 	bool SoundProvider_Vorbis_Session::eof() const
 	{
-		return stream_eof;
+		return stream_end && !seek_requested && ring->get_available() == 0;
 	}
 
 	void SoundProvider_Vorbis_Session::stop()
@@ -92,55 +111,143 @@ namespace clan
 		// Currently only support seeking to beginning of stream.
 		if (pos != 0) return false;
 
-		if (handle)
-			stb_vorbis_close(handle);
-		handle = nullptr;
-		stream_byte_offset = 0;
-
-		int error = 0;
-		handle = stb_vorbis_open_pushdata(source.impl->buffer.get_data<unsigned char>(), source.impl->buffer.get_size(), &stream_byte_offset, &error, nullptr);
-		if (handle == nullptr)
-			throw Exception("Unable to read ogg file");
-
-		stream_info = stb_vorbis_get_info(handle);
-		stream_eof = false;
+		// The streamer thread restarts the decoder and empties the ring. Nothing is read until it is done.
+		seek_requested = true;
+		position = 0;
+		SoundStreamer::instance().wake_up();
 		return true;
 	}
 
 	int SoundProvider_Vorbis_Session::get_data(float **channels, int data_requested)
 	{
-		int data_left = data_requested;
-		while (!eof() && data_left > 0)
+		if (seek_requested)
+			return 0;
+
+		int samples = ring->read(channels, 0, data_requested);
+		position += samples;
+		return samples;
+	}
+
+	int SoundProvider_Vorbis_Session::get_stream_priority() const
+	{
+		return priority;
+	}
+
+	float SoundProvider_Vorbis_Session::get_stream_fill() const
+	{
+		if (stream_end && !seek_requested)
+			return 1.0f;
+		return std::min(ring->get_available() / (float)read_ahead_samples, 1.0f);
+	}
+
+	bool SoundProvider_Vorbis_Session::decode_stream()
+	{
+		if (seek_requested)
 		{
-			while (pcm_position == pcm_samples)
+			ring->discard();
+			stream_end = !open_decoder();
+			seek_requested = false;
+			return true;
+		}
+
+		if (stream_end)
+			return false;
+
+		if (pcm_position == pcm_samples)
+		{
+			if (!decode_frame())
 			{
-				pcm = nullptr;
-				pcm_position = 0;
-				pcm_samples = 0;
-				int bytes_used = stb_vorbis_decode_frame_pushdata(handle, source.impl->buffer.get_data<unsigned char>() + stream_byte_offset, source.impl->buffer.get_size() - stream_byte_offset, nullptr, &pcm, &pcm_samples);
-				stream_byte_offset += bytes_used;
-				if (bytes_used == 0 || stream_byte_offset == source.impl->buffer.get_size())
-				{
-					stream_eof = true;
-					break;
-				}
+				if (!looping || !open_decoder())
+					stream_end = true;
+				return true;
 			}
+		}
 
-			int samples = pcm_samples - pcm_position;
-			if (samples > data_left) samples = data_left;
+		int written = ring->write(pcm, pcm_position, pcm_samples - pcm_position);
+		pcm_position += written;
+		return written > 0;
+	}
+
+	bool SoundProvider_Vorbis_Session::open_decoder()
+	{
+		if (handle)
+			stb_vorbis_close(handle);
+		handle = nullptr;
+		pcm = nullptr;
+		pcm_position = 0;
+		pcm_samples = 0;
+
+		input_offset = 0;
+		if (source.impl->streaming)
+		{
+			if (input_window.empty())
+				input_window.resize(64 * 1024);
+			input_data = input_window.data();
+			input_size = 0;
+			file_offset = 0;
+		}
+		else
+		{
+			input_data = source.impl->buffer.get_data<unsigned char>();
+			input_size = source.impl->buffer.get_size();
+		}
 
-			int buffer_pos = data_requested - data_left;
-			for (int j = 0; j < stream_info.channels; j++)
+		while (true)
+		{
+			int bytes_used = 0;
+			int error = 0;
+			handle = stb_vorbis_open_pushdata(input_data + input_offset, input_size - input_offset, &bytes_used, &error, nullptr);
+			if (handle)
 			{
-				memcpy(&channels[j][buffer_pos], &pcm[j][pcm_position], samples*sizeof(float));
+				input_offset += bytes_used;
+				stream_info = stb_vorbis_get_info(handle);
+				return true;
 			}
 
-			pcm_position += samples;
-			data_left -= samples;
+			if (error != VORBIS_need_more_data || !read_input())
+				return false;
+		}
+	}
 
-			position += samples;
+	bool SoundProvider_Vorbis_Session::decode_frame()
+	{
+		while (true)
+		{
+			pcm = nullptr;
+			pcm_position = 0;
+			pcm_samples = 0;
+			int bytes_used = stb_vorbis_decode_frame_pushdata(handle, input_data + input_offset, input_size - input_offset, nullptr, &pcm, &pcm_samples);
+			input_offset += bytes_used;
+			if (pcm_samples > 0)
+				return true;
+
+			// Zero bytes used means the decoder needs more data to complete the next frame
+			if (bytes_used == 0 && !read_input())
+				return false;
+		}
+	}
+
+	bool SoundProvider_Vorbis_Session::read_input()
+	{
+		if (!source.impl->streaming)
+			return false;
+
+		// Keep the bytes not used yet and fill up the rest of the window
+		int unused = input_size - input_offset;
+		memmove(input_window.data(), input_window.data() + input_offset, unused);
+		input_size = unused;
+		input_offset = 0;
+
+		// A page that does not fit in the window (large comment headers)
+		if (input_size == (int)input_window.size())
+		{
+			input_window.resize(input_window.size() * 2);
+			input_data = input_window.data();
 		}
 
-		return data_requested - data_left;
+		int bytes_read = source.impl->read_stream(file_offset, input_window.data() + input_size, input_window.size() - input_size);
+		file_offset += bytes_read;
+		input_size += bytes_read;
+		return bytes_read > 0;
 	}
 }
@@ -31,12 +31,21 @@
 #include "API/Sound/SoundProviders/soundprovider_session.h"
 #include "API/Sound/SoundProviders/soundprovider_vorbis.h"
 #include "stb_vorbis.h"
+#include "sound_streamer.h"
+#include <atomic>
+#include <memory>
+#include <vector>
 
 namespace clan
 {
 	class IODevice;
 
-	class SoundProvider_Vorbis_Session : public SoundProvider_Session
+	/// \brief Ogg Vorbis playback session
+	///
+	/// Samples are decoded ahead of playback into a ring buffer by the sound streamer thread, so neither decoding nor
+	/// file access happens on the mixer thread. get_data() only copies from the ring. Seeks and looping are performed
+	/// by the streamer thread, which the session reads as a continuous stream.
+	class SoundProvider_Vorbis_Session : public SoundProvider_Session, SoundStream
 	{
 	public:
 		SoundProvider_Vorbis_Session(SoundProvider_Vorbis &source);
@@ -47,6 +56,7 @@ namespace clan
 		int get_num_channels() const override;
 		int get_position() const override;
 
+		bool set_looping(bool loop) override;
 		bool eof() const override;
 		void stop() override;
 		bool play() override;
@@ -54,14 +64,45 @@ namespace clan
 		bool set_end_position(int pos) override { return false; }
 		int get_data(float **data_ptr, int data_requested) override;
 
+		int get_stream_priority() const override;
+		float get_stream_fill() const override;
+		bool decode_stream() override;
+
 	private:
+		/// \brief Starts decoding from the beginning of the stream. Returns false if the headers could not be read.
+		bool open_decoder();
+
+		/// \brief Decodes the next frame into pcm. Returns false at the end of the stream.
+		bool decode_frame();
+
+		/// \brief Reads more of a streamed file into the input window. Returns false at the end of the file.
+		bool read_input();
+
 		SoundProvider_Vorbis source;
+
+		int frequency;
+		int num_channels;
+
+		// Consumer (mixer) state
 		int position;
-		bool stream_eof;
 
+		// Shared between the consumer and the streamer thread
+		std::unique_ptr<SoundStreamBuffer> ring;
+		std::atomic_bool seek_requested;
+		std::atomic_bool looping;
+		std::atomic_bool stream_end;
+		int read_ahead_samples;
+		int priority;
+
+		// Streamer thread state
 		stb_vorbis *handle;
 		stb_vorbis_info stream_info;
-		int stream_byte_offset;
+
+		unsigned char *input_data;
+		int input_size;
+		int input_offset;
+		std::vector<unsigned char> input_window;
+		int file_offset;
 
 		float **pcm;
 		int pcm_position;
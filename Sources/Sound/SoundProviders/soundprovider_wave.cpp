@@ -32,11 +32,14 @@
 #include "API/Core/Text/string_help.h"
 #include "API/Core/IOData/path_help.h"
 #include "API/Core/IOData/iodevice.h"
+#include "API/Core/IOData/file.h"
+#include "API/Core/IOData/memory_device.h"
 #include "API/Core/IOData/cl_endian.h"
 #include "API/Core/Text/string_format.h"
 #include "API/Core/Text/logger.h"
 #include "soundprovider_wave_impl.h"
 #include "soundprovider_wave_session.h"
+#include <algorithm>
 
 namespace clan
 {
@@ -46,25 +49,28 @@ namespace clan
 		bool stream) : impl(std::make_shared<SoundProvider_Wave_Impl>())
 	{
 		IODevice source = fs.open_file(filename, File::open_existing, File::access_read, File::share_read);
-		impl->load(source);
+		if (stream)
+			impl->open_stream(source);
+		else
+			impl->load(source);
 	}
 
 	SoundProvider_Wave::SoundProvider_Wave(
 		const std::string &fullname, bool stream)
 		: impl(std::make_shared<SoundProvider_Wave_Impl>())
 	{
-		std::string path = PathHelp::get_fullpath(fullname, PathHelp::path_type_file);
-		std::string filename = PathHelp::get_filename(fullname, PathHelp::path_type_file);
-		FileSystem vfs(path);
-		IODevice input = vfs.open_file(filename, File::open_existing, File::access_read, File::share_all);
-		impl->load(input);
+		// Pages of a mapped file are only read from disk as they play, so this also streams
+		impl->map_file(fullname);
 	}
 
 	SoundProvider_Wave::SoundProvider_Wave(
 		IODevice &file, bool stream)
 		: impl(std::make_shared<SoundProvider_Wave_Impl>())
 	{
-		impl->load(file);
+		if (stream)
+			impl->open_stream(file);
+		else
+			impl->load(file);
 	}
 
 	SoundProvider_Wave::~SoundProvider_Wave()
@@ -81,7 +87,62 @@ namespace clan
 		delete session;
 	}
 
+	size_t SoundProvider_Wave::get_memory_size() const
+	{
+		// Mapped and streamed files hold no heap memory
+		if (impl->mapped || impl->streaming)
+			return 0;
+		return impl->data.get_size();
+	}
+
 	void SoundProvider_Wave_Impl::load(IODevice &source)
+	{
+		uint32_t data_size = read_header(source);
+
+		DataBuffer buffer(data_size);
+		int bytes_read = source.read(buffer.get_data(), data_size);
+		buffer.set_size(bytes_read);
+		data = DataBufferView(buffer);
+
+		num_samples = bytes_read / block_align;
+	}
+
+	void SoundProvider_Wave_Impl::map_file(const std::string &filename)
+	{
+		DataBuffer mapping = File::map_bytes(filename);
+		MemoryDevice source(mapping);
+		uint32_t data_size = read_header(source);
+
+		unsigned int start = (unsigned int)source.get_position();
+		if (start > mapping.get_size())
+			throw Exception("Wave data chunk is outside the file");
+		data_size = std::min(data_size, mapping.get_size() - start);
+		data = DataBufferView(mapping, start, data_size);
+		mapped = true;
+
+		num_samples = data_size / block_align;
+	}
+
+	void SoundProvider_Wave_Impl::open_stream(IODevice &source)
+	{
+		uint32_t data_size = read_header(source);
+		data_offset = (int)source.get_position();
+		device = source;
+		streaming = true;
+
+		num_samples = data_size / block_align;
+	}
+
+	int SoundProvider_Wave_Impl::read_stream(int offset, void *buffer, int size)
+	{
+		// Sessions of the same provider share the device
+		std::unique_lock<std::mutex> lock(device_mutex);
+		if (!device.seek(data_offset + offset))
+			return 0;
+		return device.read(buffer, size, false);
+	}
+
+	uint32_t SoundProvider_Wave_Impl::read_header(IODevice &source)
 	{
 		source.set_little_endian_mode();
 
@@ -103,7 +164,7 @@ namespace clan
 		num_channels = source.read_uint16();
 		frequency = source.read_uint32();
 		uint32_t byte_rate = source.read_uint32();
-		uint16_t block_align = source.read_uint16();
+		block_align = source.read_uint16();
 		uint16_t bits_per_sample = source.read_uint16();
 
 		if (bits_per_sample == 16)
@@ -113,12 +174,10 @@ namespace clan
 		else
 			throw Exception("Unsupported wave sample format");
 
-		uint32_t subchunk2_size = find_subchunk("data", source, subchunk_pos, chunk_size);
-
-		data = new char[subchunk2_size];
-		source.read(data, subchunk2_size);
+		if (block_align == 0)
+			throw Exception("Invalid wave block alignment");
 
-		num_samples = subchunk2_size / block_align;
+		return find_subchunk("data", source, subchunk_pos, chunk_size);
 	}
 
 	unsigned int SoundProvider_Wave_Impl::find_subchunk(const char *chunk, IODevice &source, unsigned int file_offset, unsigned int max_offset)
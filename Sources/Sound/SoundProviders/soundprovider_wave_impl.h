@@ -29,34 +29,45 @@
 #pragma once
 
 #include "API/Sound/soundformat.h"
+#include "API/Core/System/databuffer.h"
+#include "API/Core/System/databuffer_view.h"
+#include "API/Core/IOData/iodevice.h"
+#include <mutex>
 
 namespace clan
 {
-	class InputSourceProvider;
-	class IODevice;
-
 	class SoundProvider_Wave_Impl
 	{
 	public:
-		SoundProvider_Wave_Impl()
-			: data(nullptr)
-		{
-		}
+		/// \brief Reads the samples into memory
+		void load(IODevice &source);
 
-		~SoundProvider_Wave_Impl()
-		{
-			delete[] data;
-		}
+		/// \brief Maps the file into memory, so sessions read samples straight from the page cache
+		void map_file(const std::string &filename);
 
-		void load(IODevice &source);
+		/// \brief Keeps the device open so sessions read samples from it as they play
+		void open_stream(IODevice &source);
+
+		/// \brief Reads from the data chunk of the streamed file at the given offset. Returns the number of bytes read.
+		int read_stream(int offset, void *data, int size);
+
+		/// \brief Samples, when not streaming. Points into a mapping of the whole file or a buffer holding the data chunk.
+		DataBufferView data;
+		bool mapped = false;
+
+		bool streaming = false;
+		IODevice device;
+		std::mutex device_mutex;
+		int data_offset = 0;
 
-		char *data;
 		SoundFormat format;
 		int num_channels;
 		int num_samples;
 		int frequency;
+		int block_align;
 
 	private:
+		uint32_t read_header(IODevice &source);
 		uint32_t find_subchunk(const char *chunk, IODevice &source, uint32_t file_offset, uint32_t max_offset);
 	};
 }
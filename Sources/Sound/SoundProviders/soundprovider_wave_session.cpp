@@ -101,32 +101,42 @@ namespace clan
 			block_end = end_position;
 
 		int retrieved = block_end - block_start;
+		if (retrieved <= 0)
+			return 0;
 
-		if (source.impl->format == sf_16bit_signed)
+		int block_align = source.impl->block_align;
+		const char *data;
+		if (source.impl->streaming)
 		{
-			if (source.impl->num_channels == 2)
+			stream_buffer.resize(retrieved * block_align);
+			int bytes_read = source.impl->read_stream(position * block_align, stream_buffer.data(), retrieved * block_align);
+			retrieved = bytes_read / block_align;
+			if (retrieved == 0)
 			{
-				short *src = ((short *)source.impl->data) + position * 2;
-				SoundSSE::unpack_16bit_stereo(src, retrieved * 2, data_ptr);
+				// The device ended before the data chunk did
+				position = end_position;
+				return 0;
 			}
+			data = stream_buffer.data();
+		}
+		else
+		{
+			data = source.impl->data.get_data() + position * block_align;
+		}
+
+		if (source.impl->format == sf_16bit_signed)
+		{
+			if (source.impl->num_channels == 2)
+				SoundSSE::unpack_16bit_stereo((short *)data, retrieved * 2, data_ptr);
 			else
-			{
-				short *src = ((short *)source.impl->data) + position;
-				SoundSSE::unpack_16bit_mono(src, retrieved, data_ptr[0]);
-			}
+				SoundSSE::unpack_16bit_mono((short *)data, retrieved, data_ptr[0]);
 		}
 		else
 		{
 			if (source.impl->num_channels == 2)
-			{
-				unsigned char *src = ((unsigned char *)source.impl->data) + position * 2;
-				SoundSSE::unpack_8bit_stereo(src, retrieved * 2, data_ptr);
-			}
+				SoundSSE::unpack_8bit_stereo((unsigned char *)data, retrieved * 2, data_ptr);
 			else
-			{
-				unsigned char *src = ((unsigned char *)source.impl->data) + position;
-				SoundSSE::unpack_8bit_mono(src, retrieved, data_ptr[0]);
-			}
+				SoundSSE::unpack_8bit_mono((unsigned char *)data, retrieved, data_ptr[0]);
 		}
 
 		position += retrieved;
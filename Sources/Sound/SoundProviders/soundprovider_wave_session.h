@@ -30,6 +30,7 @@
 
 #include "API/Sound/SoundProviders/soundprovider_session.h"
 #include "API/Sound/SoundProviders/soundprovider_wave.h"
+#include <vector>
 
 namespace clan
 {
@@ -58,5 +59,7 @@ namespace clan
 		int end_position;
 		int num_samples;
 		int frequency;
+
+		std::vector<char> stream_buffer;
 	};
 }
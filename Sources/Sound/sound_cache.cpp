@@ -30,6 +30,8 @@
 #include "Sound/precomp.h"
 #include "API/Sound/Resources/sound_cache.h"
 #include "API/Core/Resources/resource_manager.h"
+#include "API/Sound/soundbuffer.h"
+#include "API/Sound/SoundProviders/soundprovider.h"
 
 namespace clan
 {
@@ -42,4 +44,10 @@ namespace clan
 	{
 		resources.set_cache("clan.sound", cache);
 	}
+
+	size_t SoundCache::estimate_size(const SoundBuffer &sound)
+	{
+		SoundProvider *provider = sound.get_provider();
+		return provider ? provider->get_memory_size() : 0;
+	}
 }
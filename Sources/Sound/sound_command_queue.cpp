@@ -0,0 +1,70 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "Sound/precomp.h"
+#include "sound_command_queue.h"
+#include "soundbuffer_session_impl.h"
+
+namespace clan
+{
+	SoundCommandQueue::SoundCommandQueue(int capacity)
+		: read_position(0), write_position(0)
+	{
+		unsigned int size = 2;
+		while (size < (unsigned int)capacity)
+			size *= 2;
+		slots.resize(size);
+		mask = size - 1;
+	}
+
+	bool SoundCommandQueue::push(const SoundCommand &command)
+	{
+		unsigned int write = write_position.load(std::memory_order_relaxed);
+		if (write - read_position.load(std::memory_order_acquire) > mask)
+			return false;
+
+		slots[write & mask] = command;
+		write_position.store(write + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool SoundCommandQueue::pop(SoundCommand &out_command)
+	{
+		unsigned int read = read_position.load(std::memory_order_relaxed);
+		if (read == write_position.load(std::memory_order_acquire))
+			return false;
+
+		// Clear the slot so it does not keep the session or filter alive
+		SoundCommand &slot = slots[read & mask];
+		out_command = slot;
+		slot = SoundCommand();
+		read_position.store(read + 1, std::memory_order_release);
+		return true;
+	}
+}
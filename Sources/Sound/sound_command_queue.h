@@ -0,0 +1,102 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include "API/Sound/soundbuffer_session.h"
+#include "API/Sound/soundfilter.h"
+#include <vector>
+#include <memory>
+#include <atomic>
+
+namespace clan
+{
+	class SoundMixBus_Impl;
+
+	/// \brief State change sent from the API to the mixer thread
+	class SoundCommand
+	{
+	public:
+		enum Type
+		{
+			play_session,
+			stop_session,
+			set_session_volume,
+			set_session_pan,
+			set_session_frequency,
+			set_master_volume,
+			set_master_pan,
+			add_filter,
+			remove_filter,
+			add_bus,
+			set_bus_volume,
+			add_bus_filter,
+			remove_bus_filter,
+			set_session_bus,
+			set_session_send
+		};
+
+		SoundCommand() : type(play_session), value(0.0f) { }
+		SoundCommand(Type type, const SoundBuffer_Session &session, float value = 0.0f) : type(type), session(session), value(value) { }
+		SoundCommand(Type type, float value) : type(type), value(value) { }
+		SoundCommand(Type type, const SoundFilter &filter) : type(type), filter(filter), value(0.0f) { }
+		SoundCommand(Type type, const std::shared_ptr<SoundMixBus_Impl> &bus, float value = 0.0f) : type(type), value(value), bus(bus) { }
+		SoundCommand(Type type, const std::shared_ptr<SoundMixBus_Impl> &bus, const SoundFilter &filter) : type(type), filter(filter), value(0.0f), bus(bus) { }
+		SoundCommand(Type type, const SoundBuffer_Session &session, const std::shared_ptr<SoundMixBus_Impl> &bus, float value) : type(type), session(session), value(value), bus(bus) { }
+
+		Type type;
+		SoundBuffer_Session session;
+		SoundFilter filter;
+		float value;
+		std::shared_ptr<SoundMixBus_Impl> bus;
+	};
+
+	/// \brief Fixed size single producer, single consumer ring of sound commands
+	///
+	/// Neither end ever blocks or allocates. Slots are constructed up front and commands are copied in and out,
+	/// so the only cost of a command is updating the reference counts of the session and filter it carries.
+	class SoundCommandQueue
+	{
+	public:
+		/// \brief Constructs a queue. Capacity is rounded up to a power of two.
+		SoundCommandQueue(int capacity = 1024);
+
+		/// \brief Adds a command. Returns false if the queue is full. Must only be called by the producer.
+		bool push(const SoundCommand &command);
+
+		/// \brief Removes the oldest command. Returns false if the queue is empty. Must only be called by the consumer.
+		bool pop(SoundCommand &out_command);
+
+	private:
+		std::vector<SoundCommand> slots;
+		unsigned int mask;
+		std::atomic<unsigned int> read_position;
+		std::atomic<unsigned int> write_position;
+	};
+}
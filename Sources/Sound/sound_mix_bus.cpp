@@ -0,0 +1,101 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "Sound/precomp.h"
+#include "API/Sound/sound_mix_bus.h"
+#include "API/Sound/soundoutput.h"
+#include "API/Sound/soundfilter.h"
+#include "sound_mix_bus_impl.h"
+#include "soundoutput_impl.h"
+
+namespace clan
+{
+	SoundMixBus::SoundMixBus()
+	{
+	}
+
+	SoundMixBus::SoundMixBus(SoundOutput &output)
+	{
+		output.throw_if_null();
+		impl = std::make_shared<SoundMixBus_Impl>(output.impl, output.impl->create_bus_index());
+		output.impl->queue_command(SoundCommand(SoundCommand::add_bus, impl));
+	}
+
+	SoundMixBus::~SoundMixBus()
+	{
+	}
+
+	void SoundMixBus::throw_if_null() const
+	{
+		if (!impl)
+			throw Exception("SoundMixBus is null");
+	}
+
+	float SoundMixBus::get_volume() const
+	{
+		return impl->volume;
+	}
+
+	void SoundMixBus::set_volume(float volume)
+	{
+		impl->volume = volume;
+		std::shared_ptr<SoundOutput_Impl> output = impl->output.lock();
+		if (output)
+			output->queue_command(SoundCommand(SoundCommand::set_bus_volume, impl, volume));
+	}
+
+	void SoundMixBus::add_filter(SoundFilter &filter)
+	{
+		std::unique_lock<std::mutex> mutex_lock(impl->mutex);
+		impl->filters.push_back(filter);
+		mutex_lock.unlock();
+
+		std::shared_ptr<SoundOutput_Impl> output = impl->output.lock();
+		if (output)
+			output->queue_command(SoundCommand(SoundCommand::add_bus_filter, impl, filter));
+	}
+
+	void SoundMixBus::remove_filter(SoundFilter &filter)
+	{
+		std::unique_lock<std::mutex> mutex_lock(impl->mutex);
+		for (auto it = impl->filters.begin(); it != impl->filters.end(); ++it)
+		{
+			if (*it == filter)
+			{
+				impl->filters.erase(it);
+				break;
+			}
+		}
+		mutex_lock.unlock();
+
+		std::shared_ptr<SoundOutput_Impl> output = impl->output.lock();
+		if (output)
+			output->queue_command(SoundCommand(SoundCommand::remove_bus_filter, impl, filter));
+	}
+}
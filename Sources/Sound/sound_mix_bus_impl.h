@@ -0,0 +1,66 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include "API/Sound/soundfilter.h"
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace clan
+{
+	class SoundOutput_Impl;
+
+	class SoundMixBus_Impl
+	{
+	public:
+		SoundMixBus_Impl(const std::shared_ptr<SoundOutput_Impl> &output, int index)
+			: output(output), index(index), volume(1.0f), mix_volume(1.0f), last_volume(1.0f)
+		{
+		}
+
+		/// \brief The output holds on to its buses, so the bus only refers back weakly
+		std::weak_ptr<SoundOutput_Impl> output;
+
+		/// \brief Position of the bus buffers in the mixing targets of the output. The output itself is target 0.
+		int index;
+
+		float volume;
+		std::vector<SoundFilter> filters;
+		std::mutex mutex;
+
+		/// \brief Mixer thread copies of the state above. Only changed by commands.
+		float mix_volume;
+		std::vector<SoundFilter> mix_filters;
+
+		/// \brief Volume the bus was mixed with at the end of the last fragment. Volume changes ramp from here.
+		float last_volume;
+	};
+}
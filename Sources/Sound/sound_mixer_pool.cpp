@@ -0,0 +1,197 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "Sound/precomp.h"
+#include "sound_mixer_pool.h"
+#include "soundbuffer_session_impl.h"
+#include "API/Sound/soundbuffer_session.h"
+#include "API/Sound/sound_sse.h"
+#include "API/Core/System/profiler.h"
+#include <chrono>
+
+namespace clan
+{
+	SoundMixerPool::SoundMixerPool()
+		: stop_flag(false), claim_state((unsigned long long)closed_index), session_count(0), busy_workers(0), generation(0),
+		sessions(nullptr), playing(nullptr), num_targets(0), num_samples(0)
+	{
+	}
+
+	SoundMixerPool::~SoundMixerPool()
+	{
+		stop();
+	}
+
+	void SoundMixerPool::start(int num_workers)
+	{
+		stop();
+
+		stop_flag = false;
+		for (int i = 0; i < num_workers; i++)
+		{
+			workers.push_back(std::unique_ptr<Worker>(new Worker()));
+			Worker *worker = workers.back().get();
+			worker->thread = std::thread(&SoundMixerPool::worker_main, this, worker);
+		}
+	}
+
+	void SoundMixerPool::stop()
+	{
+		stop_flag = true;
+		for (auto &worker : workers)
+		{
+			worker->thread.join();
+			free_worker_buffers(worker.get());
+		}
+		workers.clear();
+	}
+
+	void SoundMixerPool::mix(SoundBuffer_Session *new_sessions, char *out_playing, int num_sessions, float **targets, int new_num_targets, float **temp_buffers, int new_num_samples)
+	{
+		if (num_sessions == 0)
+			return;
+
+		// All claims of the previous fragment were closed and no worker holds one, so the workers are not touching their buffers
+		for (auto &worker : workers)
+			resize_worker_buffers(worker.get(), new_num_samples, new_num_targets * 2);
+
+		sessions = new_sessions;
+		playing = out_playing;
+		num_targets = new_num_targets;
+		num_samples = new_num_samples;
+		session_count = num_sessions;
+
+		generation++;
+		if (generation == 0)
+			generation++;
+		claim_state = ((unsigned long long)generation) << 32;
+
+		mix_claimed_sessions(nullptr, targets, temp_buffers);
+
+		// Close the fragment and wait for the sessions still being mixed by workers
+		claim_state = (((unsigned long long)generation) << 32) | closed_index;
+		while (busy_workers.load() != 0)
+			std::this_thread::yield();
+
+		for (auto &worker : workers)
+		{
+			if (worker->mixed_generation.load() == generation)
+			{
+				for (int i = 0; i < num_targets * 2; i++)
+					SoundSSE::mix_one_to_one(worker->mix_buffers[i], num_samples, targets[i], 1.0f);
+			}
+		}
+	}
+
+	void SoundMixerPool::worker_main(Worker *worker)
+	{
+		Profiler::set_thread_name("Sound mixer worker");
+
+		unsigned int seen_generation = 0;
+		int idle_count = 0;
+		while (!stop_flag)
+		{
+			unsigned long long state = claim_state.load();
+			unsigned int state_generation = (unsigned int)(state >> 32);
+			if (state_generation != seen_generation && (unsigned int)state != closed_index)
+			{
+				seen_generation = state_generation;
+				idle_count = 0;
+
+				busy_workers++;
+				mix_claimed_sessions(worker, worker->mix_buffers.data(), worker->temp_buffers);
+				busy_workers--;
+			}
+			else if (idle_count < 64)
+			{
+				idle_count++;
+				std::this_thread::yield();
+			}
+			else
+			{
+				// Waking up late only means the other threads mix more of the fragment
+				std::this_thread::sleep_for(std::chrono::microseconds(200));
+			}
+		}
+	}
+
+	void SoundMixerPool::mix_claimed_sessions(Worker *worker, float **targets, float **temp_buffers)
+	{
+		unsigned long long state = claim_state.load();
+		while (true)
+		{
+			unsigned int index = (unsigned int)state;
+			if (index >= (unsigned int)session_count.load())
+				break;
+
+			// The claim only succeeds if the fragment was not closed or replaced since the state was read
+			if (!claim_state.compare_exchange_weak(state, state + 1))
+				continue;
+
+			if (worker)
+			{
+				unsigned int claimed_generation = (unsigned int)(state >> 32);
+				if (worker->mixed_generation.load() != claimed_generation)
+				{
+					for (int i = 0; i < num_targets * 2; i++)
+						SoundSSE::set_float(targets[i], num_samples, 0.0f);
+					worker->mixed_generation = claimed_generation;
+				}
+			}
+
+			playing[index] = sessions[index].impl->mix_to(targets, num_targets, temp_buffers, num_samples) ? 1 : 0;
+			state = claim_state.load();
+		}
+	}
+
+	void SoundMixerPool::resize_worker_buffers(Worker *worker, int size, int num_channels)
+	{
+		if (worker->buffer_size == size && (int)worker->mix_buffers.size() == num_channels)
+			return;
+
+		free_worker_buffers(worker);
+		worker->buffer_size = size;
+		for (int i = 0; i < num_channels; i++)
+			worker->mix_buffers.push_back((float *)SoundSSE::aligned_alloc(sizeof(float) * size));
+		for (int i = 0; i < 2; i++)
+			worker->temp_buffers[i] = (float *)SoundSSE::aligned_alloc(sizeof(float) * size);
+	}
+
+	void SoundMixerPool::free_worker_buffers(Worker *worker)
+	{
+		for (float *buffer : worker->mix_buffers)
+			SoundSSE::aligned_free(buffer);
+		worker->mix_buffers.clear();
+		for (int i = 0; i < 2; i++)
+		{
+			SoundSSE::aligned_free(worker->temp_buffers[i]); worker->temp_buffers[i] = nullptr;
+		}
+		worker->buffer_size = 0;
+	}
+}
@@ -0,0 +1,102 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+
+namespace clan
+{
+	class SoundBuffer_Session;
+
+	/// \brief Mixes soundbuffer sessions on a set of worker threads
+	///
+	/// The calling thread and the workers claim sessions one at a time from an atomic counter and mix them into
+	/// their own partial mix buses, which are summed into the output at the end. Publishing a fragment, claiming
+	/// sessions and waiting for the workers only use atomics, so the mixer thread never blocks on a lock or allocates
+	/// while the pool is mixing. Workers that have not woken up in time simply leave their share to the others.
+	class SoundMixerPool
+	{
+	public:
+		SoundMixerPool();
+		~SoundMixerPool();
+
+		/// \brief Starts the worker threads. The calling thread of mix() is not included in the count.
+		void start(int num_workers);
+
+		/// \brief Stops and joins the worker threads
+		void stop();
+
+		/// \brief Mixes all sessions into the (cleared) targets and stores whether each session is still playing.
+		///
+		/// 'targets' holds a left and right channel for each of the num_targets mixing targets.
+		/// Must only be called from one thread at a time, typically the mixer thread.
+		void mix(SoundBuffer_Session *sessions, char *out_playing, int num_sessions, float **targets, int num_targets, float **temp_buffers, int num_samples);
+
+	private:
+		struct Worker
+		{
+			Worker() : mixed_generation(0), buffer_size(0)
+			{
+				temp_buffers[0] = temp_buffers[1] = nullptr;
+			}
+
+			std::thread thread;
+			std::atomic<unsigned int> mixed_generation;
+			int buffer_size;
+			std::vector<float *> mix_buffers;
+			float *temp_buffers[2];
+		};
+
+		void worker_main(Worker *worker);
+		void mix_claimed_sessions(Worker *worker, float **targets, float **temp_buffers);
+		void resize_worker_buffers(Worker *worker, int size, int num_channels);
+		void free_worker_buffers(Worker *worker);
+
+		static const unsigned int closed_index = 0xffffffff;
+
+		std::vector<std::unique_ptr<Worker>> workers;
+		std::atomic_bool stop_flag;
+
+		/// \brief Fragment generation in the upper 32 bits and the next unclaimed session index in the lower 32 bits
+		std::atomic<unsigned long long> claim_state;
+		std::atomic<int> session_count;
+		std::atomic<int> busy_workers;
+		unsigned int generation;
+
+		// Fragment parameters. Written before a generation is published and only read by claim holders.
+		SoundBuffer_Session *sessions;
+		char *playing;
+		int num_targets;
+		int num_samples;
+	};
+}
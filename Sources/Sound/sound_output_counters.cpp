@@ -0,0 +1,167 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "Sound/precomp.h"
+#include "sound_output_counters.h"
+#include "API/Core/System/system.h"
+#include <algorithm>
+
+namespace clan
+{
+	SoundOutputCounters::SoundOutputCounters()
+		: fragments_mixed(0), total_mix_microseconds(0), mix_microseconds(0), max_mix_microseconds(0), deadline_microseconds(0),
+		min_headroom_microseconds(0), deadline_misses(0), device_underruns(0), active_voices(0), virtual_voices(0), underrun_log_count(0)
+	{
+	}
+
+	void SoundOutputCounters::record_fragment(int mix_time, int deadline, int voices)
+	{
+		// Single writer, so plain load and store pairs are enough
+		uint64_t count = fragments_mixed.load(std::memory_order_relaxed);
+		int headroom = deadline - mix_time;
+		if (count == 0 || headroom < min_headroom_microseconds.load(std::memory_order_relaxed))
+			min_headroom_microseconds.store(headroom, std::memory_order_relaxed);
+		if (mix_time > max_mix_microseconds.load(std::memory_order_relaxed))
+			max_mix_microseconds.store(mix_time, std::memory_order_relaxed);
+
+		mix_microseconds.store(mix_time, std::memory_order_relaxed);
+		deadline_microseconds.store(deadline, std::memory_order_relaxed);
+		active_voices.store(voices, std::memory_order_relaxed);
+		total_mix_microseconds.store(total_mix_microseconds.load(std::memory_order_relaxed) + mix_time, std::memory_order_relaxed);
+		fragments_mixed.store(count + 1, std::memory_order_release);
+
+		if (headroom < 0)
+		{
+			deadline_misses.store(deadline_misses.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			log_underrun(SoundOutputUnderrun::deadline_missed);
+		}
+	}
+
+	void SoundOutputCounters::record_device_underrun()
+	{
+		device_underruns.store(device_underruns.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		log_underrun(SoundOutputUnderrun::device_reported);
+	}
+
+	void SoundOutputCounters::record_decode(const char *provider_name, uint64_t microseconds, int samples)
+	{
+		for (auto &slot : providers)
+		{
+			const char *name = slot.name.load(std::memory_order_acquire);
+			if (name == nullptr)
+			{
+				// Claim the free slot. If another thread won the race, check whether it claimed it for the same provider.
+				if (!slot.name.compare_exchange_strong(name, provider_name, std::memory_order_acq_rel))
+				{
+					if (name != provider_name)
+						continue;
+				}
+				name = provider_name;
+			}
+
+			if (name == provider_name)
+			{
+				slot.decode_calls.fetch_add(1, std::memory_order_relaxed);
+				slot.decode_microseconds.fetch_add(microseconds, std::memory_order_relaxed);
+				slot.decoded_samples.fetch_add(samples, std::memory_order_relaxed);
+				return;
+			}
+		}
+		// All slots are taken by other providers. Dropping the sample is better than blocking the mixer.
+	}
+
+	void SoundOutputCounters::add_virtual_voices(int delta)
+	{
+		virtual_voices.fetch_add(delta, std::memory_order_relaxed);
+	}
+
+	void SoundOutputCounters::log_underrun(SoundOutputUnderrun::Source source)
+	{
+		uint64_t index = underrun_log_count.load(std::memory_order_relaxed);
+		UnderrunEntry &entry = underrun_log[index & (underrun_log_size - 1)];
+		entry.timestamp.store(System::get_microseconds(), std::memory_order_relaxed);
+		entry.source.store(source, std::memory_order_relaxed);
+		entry.mix_microseconds.store(mix_microseconds.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		entry.deadline_microseconds.store(deadline_microseconds.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		underrun_log_count.store(index + 1, std::memory_order_release);
+	}
+
+	SoundOutputStats SoundOutputCounters::get_stats() const
+	{
+		SoundOutputStats stats;
+		stats.fragments_mixed = fragments_mixed.load(std::memory_order_acquire);
+		stats.mix_microseconds = mix_microseconds.load(std::memory_order_relaxed);
+		stats.max_mix_microseconds = max_mix_microseconds.load(std::memory_order_relaxed);
+		if (stats.fragments_mixed != 0)
+			stats.average_mix_microseconds = (int)(total_mix_microseconds.load(std::memory_order_relaxed) / stats.fragments_mixed);
+		stats.deadline_microseconds = deadline_microseconds.load(std::memory_order_relaxed);
+		stats.headroom_microseconds = stats.deadline_microseconds - stats.mix_microseconds;
+		stats.min_headroom_microseconds = min_headroom_microseconds.load(std::memory_order_relaxed);
+		stats.deadline_misses = deadline_misses.load(std::memory_order_relaxed);
+		stats.device_underruns = device_underruns.load(std::memory_order_relaxed);
+		stats.underruns = stats.deadline_misses + stats.device_underruns;
+		stats.active_voices = active_voices.load(std::memory_order_relaxed);
+		stats.virtual_voices = virtual_voices.load(std::memory_order_relaxed);
+
+		for (const auto &slot : providers)
+		{
+			const char *name = slot.name.load(std::memory_order_acquire);
+			if (name == nullptr)
+				break;
+
+			SoundProviderStats &provider = stats.providers[name];
+			provider.decode_calls = slot.decode_calls.load(std::memory_order_relaxed);
+			provider.decode_microseconds = slot.decode_microseconds.load(std::memory_order_relaxed);
+			provider.decoded_samples = slot.decoded_samples.load(std::memory_order_relaxed);
+		}
+
+		// Copy the log, then drop the entries the mixer may have overwritten while copying
+		uint64_t end = underrun_log_count.load(std::memory_order_acquire);
+		uint64_t begin = end > (uint64_t)underrun_log_size ? end - underrun_log_size : 0;
+		std::vector<SoundOutputUnderrun> entries;
+		for (uint64_t i = begin; i < end; i++)
+		{
+			const UnderrunEntry &entry = underrun_log[i & (underrun_log_size - 1)];
+			SoundOutputUnderrun underrun;
+			underrun.timestamp = entry.timestamp.load(std::memory_order_relaxed);
+			underrun.source = (SoundOutputUnderrun::Source)entry.source.load(std::memory_order_relaxed);
+			underrun.mix_microseconds = entry.mix_microseconds.load(std::memory_order_relaxed);
+			underrun.deadline_microseconds = entry.deadline_microseconds.load(std::memory_order_relaxed);
+			entries.push_back(underrun);
+		}
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+		uint64_t new_end = underrun_log_count.load(std::memory_order_relaxed);
+		uint64_t first_valid = new_end > (uint64_t)underrun_log_size ? new_end - underrun_log_size + 1 : 0;
+		size_t skip = (size_t)std::min<uint64_t>(first_valid > begin ? first_valid - begin : 0, entries.size());
+		stats.underrun_log.assign(entries.begin() + skip, entries.end());
+
+		return stats;
+	}
+}
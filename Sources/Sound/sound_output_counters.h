@@ -0,0 +1,104 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include "API/Sound/soundoutput_stats.h"
+#include <atomic>
+#include <cstdint>
+
+namespace clan
+{
+	/// \brief Lock-free statistics collection for SoundOutput_Impl
+	///
+	/// Fragment and underrun counters are only written by the thread mixing the fragments. Decode counters are written by
+	/// any mixing thread. Readers take snapshots with plain atomic loads, so a snapshot may mix values of two fragments.
+	class SoundOutputCounters
+	{
+	public:
+		SoundOutputCounters();
+
+		/// \brief Records the mix time of a fragment. Counts a deadline miss when the mix time exceeds the deadline.
+		void record_fragment(int mix_microseconds, int deadline_microseconds, int active_voices);
+
+		/// \brief Records an underrun the device reported. Must be called by the thread mixing the fragments.
+		void record_device_underrun();
+
+		/// \brief Records time a provider session spent producing data. 'provider_name' must stay valid for the program lifetime.
+		void record_decode(const char *provider_name, uint64_t microseconds, int samples);
+
+		/// \brief Adjusts the number of virtual voices
+		void add_virtual_voices(int delta);
+
+		/// \brief Returns a snapshot of the counters
+		SoundOutputStats get_stats() const;
+
+	private:
+		void log_underrun(SoundOutputUnderrun::Source source);
+
+		struct ProviderSlot
+		{
+			ProviderSlot() : name(nullptr), decode_calls(0), decode_microseconds(0), decoded_samples(0) { }
+
+			std::atomic<const char *> name;
+			std::atomic<uint64_t> decode_calls;
+			std::atomic<uint64_t> decode_microseconds;
+			std::atomic<uint64_t> decoded_samples;
+		};
+
+		struct UnderrunEntry
+		{
+			UnderrunEntry() : timestamp(0), source(0), mix_microseconds(0), deadline_microseconds(0) { }
+
+			std::atomic<uint64_t> timestamp;
+			std::atomic<int> source;
+			std::atomic<int> mix_microseconds;
+			std::atomic<int> deadline_microseconds;
+		};
+
+		static const int max_providers = 16;
+		static const int underrun_log_size = 64;	// Must be a power of two
+
+		std::atomic<uint64_t> fragments_mixed;
+		std::atomic<uint64_t> total_mix_microseconds;
+		std::atomic<int> mix_microseconds;
+		std::atomic<int> max_mix_microseconds;
+		std::atomic<int> deadline_microseconds;
+		std::atomic<int> min_headroom_microseconds;
+		std::atomic<uint64_t> deadline_misses;
+		std::atomic<uint64_t> device_underruns;
+		std::atomic<int> active_voices;
+		std::atomic<int> virtual_voices;
+
+		ProviderSlot providers[max_providers];
+
+		UnderrunEntry underrun_log[underrun_log_size];
+		std::atomic<uint64_t> underrun_log_count;
+	};
+}
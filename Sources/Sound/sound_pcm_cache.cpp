@@ -0,0 +1,224 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Sound/precomp.h"
+#include "API/Sound/sound_pcm_cache.h"
+#include "API/Sound/soundbuffer.h"
+#include "API/Sound/SoundProviders/soundprovider.h"
+#include "API/Sound/SoundProviders/soundprovider_session.h"
+#include "sound_pcm_cache_impl.h"
+#include "SoundProviders/soundprovider_pcm_cache.h"
+#include <algorithm>
+#include <thread>
+
+namespace clan
+{
+	SoundPCMCache::SoundPCMCache()
+	{
+	}
+
+	SoundPCMCache::SoundPCMCache(size_t max_bytes, bool store_16bit, int max_clip_length)
+		: impl(std::make_shared<SoundPCMCache_Impl>(max_bytes, store_16bit, max_clip_length))
+	{
+	}
+
+	SoundPCMCache::~SoundPCMCache()
+	{
+	}
+
+	void SoundPCMCache::throw_if_null() const
+	{
+		if (!impl)
+			throw Exception("SoundPCMCache is null");
+	}
+
+	size_t SoundPCMCache::get_used_bytes() const
+	{
+		std::unique_lock<std::mutex> lock(impl->mutex);
+		return impl->used_bytes;
+	}
+
+	size_t SoundPCMCache::get_max_bytes() const
+	{
+		std::unique_lock<std::mutex> lock(impl->mutex);
+		return impl->max_bytes;
+	}
+
+	void SoundPCMCache::set_max_bytes(size_t max_bytes)
+	{
+		std::unique_lock<std::mutex> lock(impl->mutex);
+		impl->max_bytes = max_bytes;
+		impl->trim();
+	}
+
+	SoundBuffer SoundPCMCache::get_sound(const std::string &key, const SoundBuffer &source)
+	{
+		throw_if_null();
+		source.throw_if_null();
+
+		SoundBuffer buffer(new SoundProvider_PCMCache(impl, key, source));
+		buffer.set_volume(source.get_volume());
+		buffer.set_pan(source.get_pan());
+		return buffer;
+	}
+
+	void SoundPCMCache::clear()
+	{
+		std::unique_lock<std::mutex> lock(impl->mutex);
+		impl->entries.clear();
+		impl->lru.clear();
+		impl->too_long.clear();
+		impl->used_bytes = 0;
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	SoundPCMCache_Impl::SoundPCMCache_Impl(size_t max_bytes, bool store_16bit, int max_clip_length)
+		: max_bytes(max_bytes), store_16bit(store_16bit), max_clip_length(max_clip_length)
+	{
+	}
+
+	std::shared_ptr<SoundPCMClip> SoundPCMCache_Impl::get_clip(const std::string &key, SoundProvider *provider)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+
+		auto it = entries.find(key);
+		if (it != entries.end())
+		{
+			lru.splice(lru.begin(), lru, it->second.lru_position);
+			return it->second.clip;
+		}
+		if (too_long.find(key) != too_long.end())
+			return std::shared_ptr<SoundPCMClip>();
+
+		// Decode without holding the lock, so other clips can be played meanwhile
+		lock.unlock();
+		std::shared_ptr<SoundPCMClip> clip = decode(provider);
+		lock.lock();
+
+		if (!clip)
+		{
+			too_long.insert(key);
+			return clip;
+		}
+
+		// Another thread may have decoded the same clip meanwhile
+		it = entries.find(key);
+		if (it != entries.end())
+		{
+			lru.splice(lru.begin(), lru, it->second.lru_position);
+			return it->second.clip;
+		}
+
+		// A clip larger than the whole budget is played, but not kept
+		if (clip->get_size() > max_bytes)
+			return clip;
+
+		lru.push_front(key);
+		Entry &entry = entries[key];
+		entry.clip = clip;
+		entry.lru_position = lru.begin();
+		used_bytes += clip->get_size();
+		trim();
+		return clip;
+	}
+
+	void SoundPCMCache_Impl::trim()
+	{
+		while (used_bytes > max_bytes && !lru.empty())
+		{
+			auto it = entries.find(lru.back());
+			used_bytes -= it->second.clip->get_size();
+			entries.erase(it);
+			lru.pop_back();
+		}
+	}
+
+	std::shared_ptr<SoundPCMClip> SoundPCMCache_Impl::decode(SoundProvider *provider) const
+	{
+		SoundProvider_Session *session = provider->begin_session();
+
+		auto clip = std::make_shared<SoundPCMClip>();
+		clip->frequency = session->get_frequency();
+		clip->num_channels = session->get_num_channels();
+		int max_samples = (int)((long long)max_clip_length * clip->frequency / 1000);
+
+		const int block_size = 4096;
+		std::vector<std::vector<float>> channels(clip->num_channels);
+		std::vector<float *> block(clip->num_channels);
+
+		bool fits = true;
+		session->set_looping(false);
+		session->play();
+		while (!session->eof())
+		{
+			if (clip->num_samples > max_samples)
+			{
+				fits = false;
+				break;
+			}
+
+			for (int i = 0; i < clip->num_channels; i++)
+			{
+				channels[i].resize(clip->num_samples + block_size);
+				block[i] = channels[i].data() + clip->num_samples;
+			}
+
+			int samples = session->get_data(block.data(), block_size);
+			clip->num_samples += samples;
+
+			// Streamed providers decode on another thread and may not have samples ready yet
+			if (samples == 0)
+				std::this_thread::yield();
+		}
+		provider->end_session(session);
+
+		if (!fits || clip->num_samples > max_samples)
+			return std::shared_ptr<SoundPCMClip>();
+
+		if (store_16bit)
+		{
+			clip->short_samples.resize(clip->num_samples * clip->num_channels);
+			for (int i = 0; i < clip->num_samples; i++)
+			{
+				for (int j = 0; j < clip->num_channels; j++)
+				{
+					float sample = std::max(std::min(channels[j][i], 1.0f), -1.0f);
+					clip->short_samples[i * clip->num_channels + j] = (short)(sample * 32767.0f);
+				}
+			}
+		}
+		else
+		{
+			clip->float_samples.resize(clip->num_samples * clip->num_channels);
+			for (int j = 0; j < clip->num_channels; j++)
+				std::copy(channels[j].begin(), channels[j].begin() + clip->num_samples, clip->float_samples.begin() + j * clip->num_samples);
+		}
+		return clip;
+	}
+}
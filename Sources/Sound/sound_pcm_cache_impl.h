@@ -0,0 +1,94 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+#include <mutex>
+
+namespace clan
+{
+	class SoundProvider;
+
+	/// \brief Decoded samples of a clip
+	class SoundPCMClip
+	{
+	public:
+		int frequency = 0;
+		int num_channels = 0;
+		int num_samples = 0;
+
+		/// \brief Samples of each channel after each other, when stored as floats
+		std::vector<float> float_samples;
+
+		/// \brief Interleaved samples, when stored as 16 bit
+		std::vector<short> short_samples;
+
+		size_t get_size() const { return float_samples.size() * sizeof(float) + short_samples.size() * sizeof(short); }
+	};
+
+	class SoundPCMCache_Impl
+	{
+	public:
+		SoundPCMCache_Impl(size_t max_bytes, bool store_16bit, int max_clip_length);
+
+		/// \brief Returns the decoded clip for a key, decoding the provider if it is not cached. Returns null if the clip is too long.
+		std::shared_ptr<SoundPCMClip> get_clip(const std::string &key, SoundProvider *provider);
+
+		/// \brief Drops the least recently used clips until the cache is within its budget
+		void trim();
+
+		/// \brief Decodes a provider. Returns null if it is longer than max_clip_length.
+		std::shared_ptr<SoundPCMClip> decode(SoundProvider *provider) const;
+
+		struct Entry
+		{
+			std::shared_ptr<SoundPCMClip> clip;
+			std::list<std::string>::iterator lru_position;
+		};
+
+		std::mutex mutex;
+		size_t max_bytes;
+		size_t used_bytes = 0;
+		bool store_16bit;
+		int max_clip_length;
+
+		std::unordered_map<std::string, Entry> entries;
+
+		/// \brief Keys from most to least recently used
+		std::list<std::string> lru;
+
+		/// \brief Keys of clips found to be too long, so they are not decoded again
+		std::unordered_set<std::string> too_long;
+	};
+}
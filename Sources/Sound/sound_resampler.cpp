@@ -0,0 +1,214 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Sound/precomp.h"
+#include "sound_resampler.h"
+#include <cmath>
+#include <algorithm>
+
+#ifndef CL_DISABLE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace clan
+{
+	SoundResampler::SoundResampler()
+		: quality(resample_linear), sinc_cutoff(0.0)
+	{
+	}
+
+	void SoundResampler::resample(const float *input, double position, double speed, float *output, int count)
+	{
+		switch (quality)
+		{
+		default:
+		case resample_linear:
+			interpolate_linear(input, position, speed, output, count);
+			break;
+		case resample_cubic:
+			interpolate_cubic(input, position, speed, output, count);
+			break;
+		case resample_sinc:
+			interpolate_sinc(input, position, speed, output, count);
+			break;
+		}
+	}
+
+	void SoundResampler::interpolate_linear(const float *input, double position, double speed, float *output, int count)
+	{
+		int i = 0;
+#ifndef CL_DISABLE_SSE2
+		// Four output samples at a time, with the source samples of each lane gathered by scalar loads
+		for (; i + 4 <= count; i += 4)
+		{
+			int index[4];
+			float frac[4];
+			for (int lane = 0; lane < 4; lane++)
+			{
+				double pos = position + (i + lane) * speed;
+				index[lane] = (int)pos;
+				frac[lane] = (float)(pos - index[lane]);
+			}
+
+			__m128 p0 = _mm_setr_ps(input[index[0]], input[index[1]], input[index[2]], input[index[3]]);
+			__m128 p1 = _mm_setr_ps(input[index[0] + 1], input[index[1] + 1], input[index[2] + 1], input[index[3] + 1]);
+			__m128 t = _mm_loadu_ps(frac);
+			_mm_storeu_ps(output + i, _mm_add_ps(p0, _mm_mul_ps(t, _mm_sub_ps(p1, p0))));
+		}
+#endif
+		for (; i < count; i++)
+		{
+			double pos = position + i * speed;
+			int index = (int)pos;
+			float t = (float)(pos - index);
+			output[i] = input[index] + t * (input[index + 1] - input[index]);
+		}
+	}
+
+	void SoundResampler::interpolate_cubic(const float *input, double position, double speed, float *output, int count)
+	{
+		int i = 0;
+#ifndef CL_DISABLE_SSE2
+		__m128 half = _mm_set1_ps(0.5f);
+		__m128 one = _mm_set1_ps(1.0f);
+		__m128 one_and_half = _mm_set1_ps(1.5f);
+		__m128 two = _mm_set1_ps(2.0f);
+		__m128 two_and_half = _mm_set1_ps(2.5f);
+		for (; i + 4 <= count; i += 4)
+		{
+			int index[4];
+			float frac[4];
+			for (int lane = 0; lane < 4; lane++)
+			{
+				double pos = position + (i + lane) * speed;
+				index[lane] = (int)pos;
+				frac[lane] = (float)(pos - index[lane]);
+			}
+
+			__m128 p0 = _mm_setr_ps(input[index[0] - 1], input[index[1] - 1], input[index[2] - 1], input[index[3] - 1]);
+			__m128 p1 = _mm_setr_ps(input[index[0]], input[index[1]], input[index[2]], input[index[3]]);
+			__m128 p2 = _mm_setr_ps(input[index[0] + 1], input[index[1] + 1], input[index[2] + 1], input[index[3] + 1]);
+			__m128 p3 = _mm_setr_ps(input[index[0] + 2], input[index[1] + 2], input[index[2] + 2], input[index[3] + 2]);
+
+			// Catmull-Rom weights
+			__m128 t = _mm_loadu_ps(frac);
+			__m128 t2 = _mm_mul_ps(t, t);
+			__m128 w0 = _mm_mul_ps(t, _mm_sub_ps(_mm_mul_ps(t, _mm_sub_ps(one, _mm_mul_ps(half, t))), half));
+			__m128 w1 = _mm_add_ps(one, _mm_mul_ps(t2, _mm_sub_ps(_mm_mul_ps(one_and_half, t), two_and_half)));
+			__m128 w2 = _mm_mul_ps(t, _mm_add_ps(half, _mm_mul_ps(t, _mm_sub_ps(two, _mm_mul_ps(one_and_half, t)))));
+			__m128 w3 = _mm_mul_ps(t2, _mm_sub_ps(_mm_mul_ps(half, t), half));
+
+			__m128 result = _mm_add_ps(_mm_add_ps(_mm_mul_ps(p0, w0), _mm_mul_ps(p1, w1)), _mm_add_ps(_mm_mul_ps(p2, w2), _mm_mul_ps(p3, w3)));
+			_mm_storeu_ps(output + i, result);
+		}
+#endif
+		for (; i < count; i++)
+		{
+			double pos = position + i * speed;
+			int index = (int)pos;
+			float t = (float)(pos - index);
+			float t2 = t * t;
+			float w0 = t * (t * (1.0f - 0.5f * t) - 0.5f);
+			float w1 = 1.0f + t2 * (1.5f * t - 2.5f);
+			float w2 = t * (0.5f + t * (2.0f - 1.5f * t));
+			float w3 = t2 * (0.5f * t - 0.5f);
+			output[i] = input[index - 1] * w0 + input[index] * w1 + input[index + 1] * w2 + input[index + 2] * w3;
+		}
+	}
+
+	void SoundResampler::interpolate_sinc(const float *input, double position, double speed, float *output, int count)
+	{
+		update_sinc_table(speed);
+
+		for (int i = 0; i < count; i++)
+		{
+			double pos = position + i * speed;
+			int index = (int)pos;
+			float phase_pos = (float)(pos - index) * sinc_phases;
+			int phase = (int)phase_pos;
+			float t = phase_pos - phase;
+
+			// Taps run from index - margin + 1 to index + margin. The result is interpolated between two neighbouring phases.
+			const float *samples = input + index - margin + 1;
+			const float *coeffs0 = &sinc_table[phase * sinc_taps];
+			const float *coeffs1 = coeffs0 + sinc_taps;
+#ifndef CL_DISABLE_SSE2
+			__m128 sum0 = _mm_setzero_ps();
+			__m128 sum1 = _mm_setzero_ps();
+			for (int tap = 0; tap < sinc_taps; tap += 4)
+			{
+				__m128 s = _mm_loadu_ps(samples + tap);
+				sum0 = _mm_add_ps(sum0, _mm_mul_ps(s, _mm_loadu_ps(coeffs0 + tap)));
+				sum1 = _mm_add_ps(sum1, _mm_mul_ps(s, _mm_loadu_ps(coeffs1 + tap)));
+			}
+			__m128 sum = _mm_add_ps(sum0, _mm_mul_ps(_mm_set1_ps(t), _mm_sub_ps(sum1, sum0)));
+			sum = _mm_add_ps(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(1, 0, 3, 2)));
+			sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(0, 0, 0, 1)));
+			output[i] = _mm_cvtss_f32(sum);
+#else
+			float sum0 = 0.0f;
+			float sum1 = 0.0f;
+			for (int tap = 0; tap < sinc_taps; tap++)
+			{
+				sum0 += samples[tap] * coeffs0[tap];
+				sum1 += samples[tap] * coeffs1[tap];
+			}
+			output[i] = sum0 + t * (sum1 - sum0);
+#endif
+		}
+	}
+
+	void SoundResampler::update_sinc_table(double speed)
+	{
+		double cutoff = std::min(1.0, 1.0 / speed);
+		if (cutoff == sinc_cutoff && !sinc_table.empty())
+			return;
+
+		const double pi = 3.14159265358979323846;
+		sinc_cutoff = cutoff;
+		sinc_table.resize((sinc_phases + 1) * sinc_taps);
+		for (int phase = 0; phase <= sinc_phases; phase++)
+		{
+			float *coeffs = &sinc_table[phase * sinc_taps];
+			double frac = phase / (double)sinc_phases;
+			double total = 0.0;
+			for (int tap = 0; tap < sinc_taps; tap++)
+			{
+				double x = (tap - margin + 1) - frac;
+				double sinc = (x == 0.0) ? 1.0 : std::sin(pi * cutoff * x) / (pi * cutoff * x);
+				double window = 0.42 + 0.5 * std::cos(pi * x / margin) + 0.08 * std::cos(2.0 * pi * x / margin);	// Blackman
+				coeffs[tap] = (float)(sinc * window);
+				total += coeffs[tap];
+			}
+
+			// Normalize so a constant signal passes at unit gain
+			for (int tap = 0; tap < sinc_taps; tap++)
+				coeffs[tap] = (float)(coeffs[tap] / total);
+		}
+	}
+}
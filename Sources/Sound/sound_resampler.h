@@ -0,0 +1,66 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "API/Sound/soundbuffer_session.h"
+#include <vector>
+
+namespace clan
+{
+	/// \brief Converts a channel between sample rates a block at a time
+	class SoundResampler
+	{
+	public:
+		SoundResampler();
+
+		/// \brief Samples read before and after the sample at a position. Input must be valid in this range.
+		static const int margin = 8;
+
+		ResampleQuality get_quality() const { return quality; }
+		void set_quality(ResampleQuality new_quality) { quality = new_quality; }
+
+		/// \brief Writes count samples taken from input at position, position + speed, position + 2 * speed and so on
+		void resample(const float *input, double position, double speed, float *output, int count);
+
+	private:
+		void interpolate_linear(const float *input, double position, double speed, float *output, int count);
+		void interpolate_cubic(const float *input, double position, double speed, float *output, int count);
+		void interpolate_sinc(const float *input, double position, double speed, float *output, int count);
+
+		/// \brief Calculates the filter for each phase, low passed to the lower of the two frequencies
+		void update_sinc_table(double speed);
+
+		static const int sinc_taps = 2 * margin;
+		static const int sinc_phases = 256;
+
+		ResampleQuality quality;
+		std::vector<float> sinc_table;	// sinc_phases + 1 rows of sinc_taps coefficients
+		double sinc_cutoff;
+	};
+}
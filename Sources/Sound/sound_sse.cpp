@@ -36,12 +36,133 @@
 #include <emmintrin.h>
 #endif
 
+#if !defined CL_DISABLE_SSE2 && !defined __ANDROID__
+#include <immintrin.h>
+#define CL_SOUND_AVX
+#if defined(__GNUC__)
+// The AVX kernels are compiled for AVX only, and selected at runtime
+#define CL_TARGET_AVX __attribute__((target("avx")))
+#else
+#define CL_TARGET_AVX
+#endif
+#endif
+
+#if defined CL_DISABLE_SSE2 && (defined __ARM_NEON || defined __ARM_NEON__)
+#include <arm_neon.h>
+#define CL_SOUND_NEON
+#endif
+
 #ifdef __MINGW32__
 #include <malloc.h>
 #endif
 
 namespace clan
 {
+	static short to_16bit(float sample)
+	{
+		if (sample > 1.0f) sample = 1.0f;
+		else if (sample < -1.0f) sample = -1.0f;
+		return (short)(sample * 32767);
+	}
+
+#ifndef CL_DISABLE_SSE2
+	static int sse_pack_16bit_stereo(float *input[2], int size, short *output)
+	{
+		int sse_size = (size / 4) * 4;
+
+		// The range is clamped first, as _mm_cvtps_epi32 turns large positive values negative
+		__m128 constant1 = _mm_set1_ps(32767);
+		__m128 min_value = _mm_set1_ps(-1.0f);
+		__m128 max_value = _mm_set1_ps(1.0f);
+		for (int i = 0; i < sse_size; i += 4)
+		{
+			__m128 samples0 = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(input[0] + i), min_value), max_value);
+			__m128 samples1 = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(input[1] + i), min_value), max_value);
+			samples0 = _mm_mul_ps(samples0, constant1);
+			samples1 = _mm_mul_ps(samples1, constant1);
+			__m128 tmp0, tmp1;
+			tmp0 = _mm_unpacklo_ps(samples0, samples1);
+			tmp1 = _mm_unpackhi_ps(samples0, samples1);
+			__m128i isamples0 = _mm_cvtps_epi32(tmp0);
+			__m128i isamples1 = _mm_cvtps_epi32(tmp1);
+			__m128i isamples = _mm_packs_epi32(isamples0, isamples1);
+			_mm_storeu_si128((__m128i*)(output + i * 2), isamples);
+		}
+		return sse_size;
+	}
+#endif
+
+#ifdef CL_SOUND_AVX
+	static bool use_avx()
+	{
+		static const bool avx = System::detect_cpu_extension(System::avx);
+		return avx;
+	}
+
+	/// \brief Mixes with a volume of start_volume + step * i. Returns the number of samples processed.
+	CL_TARGET_AVX static int avx_mix_one_to_one(const float *input, int size, float *output, float start_volume, float step)
+	{
+		int avx_size = (size / 8) * 8;
+		__m256 volume = _mm256_add_ps(_mm256_set1_ps(start_volume), _mm256_mul_ps(_mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_ps(step)));
+		__m256 volume_step = _mm256_set1_ps(step * 8);
+		for (int i = 0; i < avx_size; i += 8)
+		{
+			_mm256_storeu_ps(output + i, _mm256_add_ps(_mm256_loadu_ps(output + i), _mm256_mul_ps(_mm256_loadu_ps(input + i), volume)));
+			volume = _mm256_add_ps(volume, volume_step);
+		}
+		_mm256_zeroupper();
+		return avx_size;
+	}
+
+	CL_TARGET_AVX static int avx_multiply_float(float *channel, int size, float start_volume, float step)
+	{
+		int avx_size = (size / 8) * 8;
+		__m256 volume = _mm256_add_ps(_mm256_set1_ps(start_volume), _mm256_mul_ps(_mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_ps(step)));
+		__m256 volume_step = _mm256_set1_ps(step * 8);
+		for (int i = 0; i < avx_size; i += 8)
+		{
+			_mm256_storeu_ps(channel + i, _mm256_mul_ps(_mm256_loadu_ps(channel + i), volume));
+			volume = _mm256_add_ps(volume, volume_step);
+		}
+		_mm256_zeroupper();
+		return avx_size;
+	}
+
+	CL_TARGET_AVX static int avx_clamp_float(float *channel, int size, float min_value, float max_value)
+	{
+		int avx_size = (size / 8) * 8;
+		__m256 min0 = _mm256_set1_ps(min_value);
+		__m256 max0 = _mm256_set1_ps(max_value);
+		for (int i = 0; i < avx_size; i += 8)
+			_mm256_storeu_ps(channel + i, _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(channel + i), min0), max0));
+		_mm256_zeroupper();
+		return avx_size;
+	}
+
+	CL_TARGET_AVX static int avx_pack_16bit_stereo(float *input[2], int size, short *output)
+	{
+		int avx_size = (size / 8) * 8;
+		__m256 constant1 = _mm256_set1_ps(32767);
+		__m256 min_value = _mm256_set1_ps(-1.0f);
+		__m256 max_value = _mm256_set1_ps(1.0f);
+		for (int i = 0; i < avx_size; i += 8)
+		{
+			__m256 samples0 = _mm256_mul_ps(_mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(input[0] + i), min_value), max_value), constant1);
+			__m256 samples1 = _mm256_mul_ps(_mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(input[1] + i), min_value), max_value), constant1);
+
+			// Unpacking works per 128 bit lane: tmp0 holds samples 0, 1, 4, 5 and tmp1 holds 2, 3, 6, 7 of each channel
+			__m256i tmp0 = _mm256_cvtps_epi32(_mm256_unpacklo_ps(samples0, samples1));
+			__m256i tmp1 = _mm256_cvtps_epi32(_mm256_unpackhi_ps(samples0, samples1));
+
+			// Plain AVX has no 256 bit integer packing, so each half is packed with SSE2
+			_mm_storeu_si128((__m128i*)(output + i * 2), _mm_packs_epi32(_mm256_castsi256_si128(tmp0), _mm256_castsi256_si128(tmp1)));
+			_mm_storeu_si128((__m128i*)(output + i * 2 + 8), _mm_packs_epi32(_mm256_extractf128_si256(tmp0, 1), _mm256_extractf128_si256(tmp1, 1)));
+		}
+		_mm256_zeroupper();
+		return avx_size;
+	}
+#endif
+
 	void *SoundSSE::aligned_alloc(int size)
 	{
 		return System::aligned_alloc(size, 16);
@@ -199,25 +320,28 @@ namespace clan
 
 	void SoundSSE::pack_16bit_stereo(float *input[2], int size, short *output)
 	{
-#ifndef CL_DISABLE_SSE2
+#if defined CL_SOUND_NEON
 		int sse_size = (size / 4) * 4;
 
-		__m128 constant1 = _mm_set1_ps(32767);
+		float32x4_t constant1 = vdupq_n_f32(32767);
 		for (int i = 0; i < sse_size; i += 4)
 		{
-			__m128 samples0 = _mm_loadu_ps(input[0] + i);
-			__m128 samples1 = _mm_loadu_ps(input[1] + i);
-			samples0 = _mm_mul_ps(samples0, constant1);
-			samples1 = _mm_mul_ps(samples1, constant1);
-			__m128 tmp0, tmp1;
-			tmp0 = _mm_unpacklo_ps(samples0, samples1);
-			tmp1 = _mm_unpackhi_ps(samples0, samples1);
-			__m128i isamples0 = _mm_cvtps_epi32(tmp0);
-			__m128i isamples1 = _mm_cvtps_epi32(tmp1);
-			__m128i isamples = _mm_packs_epi32(isamples0, isamples1);
-			_mm_storeu_si128((__m128i*)(output + i * 2), isamples);
+			// Converting to 32 bit saturates, and narrowing to 16 bit saturates again
+			int32x4_t isamples0 = vcvtq_s32_f32(vmulq_f32(vld1q_f32(input[0] + i), constant1));
+			int32x4_t isamples1 = vcvtq_s32_f32(vmulq_f32(vld1q_f32(input[1] + i), constant1));
+			int16x4x2_t interleaved;
+			interleaved.val[0] = vqmovn_s32(isamples0);
+			interleaved.val[1] = vqmovn_s32(isamples1);
+			vst2_s16(output + i * 2, interleaved);
 		}
-
+#elif !defined CL_DISABLE_SSE2
+		int sse_size = 0;
+#ifdef CL_SOUND_AVX
+		if (use_avx())
+			sse_size = avx_pack_16bit_stereo(input, size, output);
+		else
+#endif
+		sse_size = sse_pack_16bit_stereo(input, size, output);
 #else
 		const int sse_size = 0;
 #endif
@@ -225,8 +349,8 @@ namespace clan
 		// Pack remaining
 		for (int i = sse_size; i < size; i++)
 		{
-			output[i * 2] = input[0][i] * 32767;
-			output[i * 2 + 1] = input[1][i] * 32767;
+			output[i * 2] = to_16bit(input[0][i]);
+			output[i * 2 + 1] = to_16bit(input[1][i]);
 		}
 	}
 
@@ -318,16 +442,28 @@ namespace clan
 
 	void SoundSSE::mix_one_to_one(float *input, int size, float *output, float volume)
 	{
-#ifndef CL_DISABLE_SSE2
+#if defined CL_SOUND_NEON
 		int sse_size = (size / 4) * 4;
-		__m128 volume0 = _mm_set1_ps(volume);
+		float32x4_t volume0 = vdupq_n_f32(volume);
 		for (int i = 0; i < sse_size; i += 4)
+			vst1q_f32(output + i, vmlaq_f32(vld1q_f32(output + i), vld1q_f32(input + i), volume0));
+#elif !defined CL_DISABLE_SSE2
+		int sse_size = 0;
+#ifdef CL_SOUND_AVX
+		if (use_avx())
+			sse_size = avx_mix_one_to_one(input, size, output, volume, 0.0f);
+		else
+#endif
 		{
-			__m128 sample0 = _mm_loadu_ps(input + i);
-			__m128 sample1 = _mm_loadu_ps(output + i);
-			_mm_storeu_ps(output + i, _mm_add_ps(_mm_mul_ps(sample0, volume0), sample1));
+			sse_size = (size / 4) * 4;
+			__m128 volume0 = _mm_set1_ps(volume);
+			for (int i = 0; i < sse_size; i += 4)
+			{
+				__m128 sample0 = _mm_loadu_ps(input + i);
+				__m128 sample1 = _mm_loadu_ps(output + i);
+				_mm_storeu_ps(output + i, _mm_add_ps(_mm_mul_ps(sample0, volume0), sample1));
+			}
 		}
-
 #else
 		const int sse_size = 0;
 #endif
@@ -445,4 +581,123 @@ namespace clan
 		if (sse_size < size)
 			memcpy(output, input, (size - sse_size)*sizeof(float));
 	}
+
+	void SoundSSE::mix_one_to_one_ramp(float *input, int size, float *output, float start_volume, float end_volume)
+	{
+		float step = size > 0 ? (end_volume - start_volume) / size : 0.0f;
+#if defined CL_SOUND_NEON
+		int sse_size = (size / 4) * 4;
+		const float offsets[4] = { 0.0f, 1.0f, 2.0f, 3.0f };
+		float32x4_t volume0 = vmlaq_n_f32(vdupq_n_f32(start_volume), vld1q_f32(offsets), step);
+		float32x4_t volume_step = vdupq_n_f32(step * 4);
+		for (int i = 0; i < sse_size; i += 4)
+		{
+			vst1q_f32(output + i, vmlaq_f32(vld1q_f32(output + i), vld1q_f32(input + i), volume0));
+			volume0 = vaddq_f32(volume0, volume_step);
+		}
+#elif !defined CL_DISABLE_SSE2
+		int sse_size = 0;
+#ifdef CL_SOUND_AVX
+		if (use_avx())
+			sse_size = avx_mix_one_to_one(input, size, output, start_volume, step);
+		else
+#endif
+		{
+			sse_size = (size / 4) * 4;
+			__m128 volume0 = _mm_add_ps(_mm_set1_ps(start_volume), _mm_mul_ps(_mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f), _mm_set1_ps(step)));
+			__m128 volume_step = _mm_set1_ps(step * 4);
+			for (int i = 0; i < sse_size; i += 4)
+			{
+				__m128 sample0 = _mm_loadu_ps(input + i);
+				__m128 sample1 = _mm_loadu_ps(output + i);
+				_mm_storeu_ps(output + i, _mm_add_ps(_mm_mul_ps(sample0, volume0), sample1));
+				volume0 = _mm_add_ps(volume0, volume_step);
+			}
+		}
+#else
+		const int sse_size = 0;
+#endif
+
+		for (int i = sse_size; i < size; i++)
+		{
+			output[i] += input[i] * (start_volume + step * i);
+		}
+	}
+
+	void SoundSSE::mix_one_to_many_ramp(float *input, int size, float **output, float *start_volume, float *end_volume, int channels)
+	{
+		for (int j = 0; j < channels; j++)
+			mix_one_to_one_ramp(input, size, output[j], start_volume[j], end_volume[j]);
+	}
+
+	void SoundSSE::multiply_float_ramp(float *channel, int size, float start_volume, float end_volume)
+	{
+		float step = size > 0 ? (end_volume - start_volume) / size : 0.0f;
+#if defined CL_SOUND_NEON
+		int sse_size = (size / 4) * 4;
+		const float offsets[4] = { 0.0f, 1.0f, 2.0f, 3.0f };
+		float32x4_t volume0 = vmlaq_n_f32(vdupq_n_f32(start_volume), vld1q_f32(offsets), step);
+		float32x4_t volume_step = vdupq_n_f32(step * 4);
+		for (int i = 0; i < sse_size; i += 4)
+		{
+			vst1q_f32(channel + i, vmulq_f32(vld1q_f32(channel + i), volume0));
+			volume0 = vaddq_f32(volume0, volume_step);
+		}
+#elif !defined CL_DISABLE_SSE2
+		int sse_size = 0;
+#ifdef CL_SOUND_AVX
+		if (use_avx())
+			sse_size = avx_multiply_float(channel, size, start_volume, step);
+		else
+#endif
+		{
+			sse_size = (size / 4) * 4;
+			__m128 volume0 = _mm_add_ps(_mm_set1_ps(start_volume), _mm_mul_ps(_mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f), _mm_set1_ps(step)));
+			__m128 volume_step = _mm_set1_ps(step * 4);
+			for (int i = 0; i < sse_size; i += 4)
+			{
+				_mm_storeu_ps(channel + i, _mm_mul_ps(_mm_loadu_ps(channel + i), volume0));
+				volume0 = _mm_add_ps(volume0, volume_step);
+			}
+		}
+#else
+		const int sse_size = 0;
+#endif
+
+		for (int i = sse_size; i < size; i++)
+			channel[i] *= start_volume + step * i;
+	}
+
+	void SoundSSE::clamp_float(float *channel, int size, float min_value, float max_value)
+	{
+#if defined CL_SOUND_NEON
+		int sse_size = (size / 4) * 4;
+		float32x4_t min0 = vdupq_n_f32(min_value);
+		float32x4_t max0 = vdupq_n_f32(max_value);
+		for (int i = 0; i < sse_size; i += 4)
+			vst1q_f32(channel + i, vminq_f32(vmaxq_f32(vld1q_f32(channel + i), min0), max0));
+#elif !defined CL_DISABLE_SSE2
+		int sse_size = 0;
+#ifdef CL_SOUND_AVX
+		if (use_avx())
+			sse_size = avx_clamp_float(channel, size, min_value, max_value);
+		else
+#endif
+		{
+			sse_size = (size / 4) * 4;
+			__m128 min0 = _mm_set1_ps(min_value);
+			__m128 max0 = _mm_set1_ps(max_value);
+			for (int i = 0; i < sse_size; i += 4)
+				_mm_storeu_ps(channel + i, _mm_min_ps(_mm_max_ps(_mm_loadu_ps(channel + i), min0), max0));
+		}
+#else
+		const int sse_size = 0;
+#endif
+
+		for (int i = sse_size; i < size; i++)
+		{
+			if (channel[i] > max_value) channel[i] = max_value;
+			else if (channel[i] < min_value) channel[i] = min_value;
+		}
+	}
 }
@@ -30,6 +30,7 @@
 #include "API/Sound/soundbuffer_session.h"
 #include "API/Sound/SoundProviders/soundprovider_session.h"
 #include "API/Sound/soundfilter.h"
+#include "API/Sound/sound_mix_bus.h"
 #include "soundbuffer_session_impl.h"
 #include "soundoutput_impl.h"
 
@@ -42,6 +43,8 @@ namespace clan
 	SoundBuffer_Session::SoundBuffer_Session(SoundBuffer &soundbuffer, bool looping, SoundOutput &output)
 		: impl(std::make_shared<SoundBuffer_Session_Impl>(soundbuffer, looping, output))
 	{
+		if (!output.is_null())
+			impl->counters = &output.impl->counters;
 	}
 
 	SoundBuffer_Session::~SoundBuffer_Session()
@@ -108,6 +111,19 @@ namespace clan
 		}
 	}
 
+	ResampleQuality SoundBuffer_Session::get_resample_quality() const
+	{
+		if (impl)
+		{
+			std::unique_lock<std::recursive_mutex> mutex_lock(impl->mutex);
+			return impl->resampler.get_quality();
+		}
+		else
+		{
+			return resample_linear;
+		}
+	}
+
 	float SoundBuffer_Session::get_volume() const
 	{
 		if (impl)
@@ -211,19 +227,37 @@ namespace clan
 	void SoundBuffer_Session::set_volume(float new_volume)
 	{
 		if (impl)
+		{
 			impl->volume = new_volume;
+			impl->output.impl->queue_command(SoundCommand(SoundCommand::set_session_volume, *this, new_volume));
+		}
 	}
 
 	void SoundBuffer_Session::set_frequency(int new_frequency)
 	{
 		if (impl)
+		{
 			impl->frequency = new_frequency;
+			impl->output.impl->queue_command(SoundCommand(SoundCommand::set_session_frequency, *this, (float)new_frequency));
+		}
+	}
+
+	void SoundBuffer_Session::set_resample_quality(ResampleQuality quality)
+	{
+		if (impl)
+		{
+			std::unique_lock<std::recursive_mutex> mutex_lock(impl->mutex);
+			impl->resampler.set_quality(quality);
+		}
 	}
 
 	void SoundBuffer_Session::set_pan(float new_pan)
 	{
 		if (impl)
+		{
 			impl->pan = new_pan;
+			impl->output.impl->queue_command(SoundCommand(SoundCommand::set_session_pan, *this, new_pan));
+		}
 	}
 
 	void SoundBuffer_Session::play()
@@ -288,4 +322,16 @@ namespace clan
 			}
 		}
 	}
+
+	void SoundBuffer_Session::set_bus(const SoundMixBus &bus)
+	{
+		if (impl)
+			impl->output.impl->queue_command(SoundCommand(SoundCommand::set_session_bus, *this, bus.impl, 0.0f));
+	}
+
+	void SoundBuffer_Session::set_send(const SoundMixBus &bus, float level)
+	{
+		if (impl)
+			impl->output.impl->queue_command(SoundCommand(SoundCommand::set_session_send, *this, bus.impl, level));
+	}
 }
@@ -35,27 +35,38 @@
 #include "API/Sound/SoundProviders/soundprovider.h"
 #include "API/Sound/SoundProviders/soundprovider_session.h"
 #include "API/Core/Text/logger.h"
+#include "API/Core/System/system.h"
+#include <algorithm>
+#include <cmath>
 
 namespace clan
 {
 	SoundBuffer_Session_Impl::SoundBuffer_Session_Impl(SoundBuffer &soundbuffer, bool looping, SoundOutput &output)
-		: soundbuffer(soundbuffer), provider_session(nullptr), output(output), volume(1.0f), pan(0.0f), looping(looping), playing(false)
+		: soundbuffer(soundbuffer), provider_session(nullptr), output(output), volume(1.0f), pan(0.0f), looping(looping), playing(false),
+		mix_bus(0), mix_send_bus(-1), mix_send_level(0.0f), counters(nullptr), provider_name(nullptr)
 	{
 		volume = soundbuffer.get_volume();
 		pan = soundbuffer.get_pan();
 		provider_session = soundbuffer.get_provider()->begin_session();
+		provider_name = soundbuffer.get_provider()->get_name();
 		provider_session->set_looping(looping);
 		frequency = provider_session->get_frequency();
+		mix_volume = volume;
+		mix_pan = pan;
+		mix_frequency = frequency;
+		mixing_frequency = output.get_mixing_frequency();
 
 		num_buffer_samples = 16 * 1024;
 		num_buffer_channels = provider_session->get_num_channels();
-		buffer_position = 0.0;
-		buffer_samples_written = 0;
 
 		float_buffer_data = new float*[num_buffer_channels];
 		for (int i = 0; i < num_buffer_channels; i++) float_buffer_data[i] = new float[num_buffer_samples];
 
 		float_buffer_data_offsetted.resize(num_buffer_channels);
+		reset_buffer();
+		get_channel_volume(last_channel_volume);
+		last_send_volume[0] = 0.0f;
+		last_send_volume[1] = 0.0f;
 	}
 
 	SoundBuffer_Session_Impl::~SoundBuffer_Session_Impl()
@@ -69,12 +80,31 @@ namespace clan
 		delete[] float_buffer_data;
 	}
 
-	bool SoundBuffer_Session_Impl::mix_to(float **sample_data, float **temp_data, int num_samples, int num_channels)
+	bool SoundBuffer_Session_Impl::mix_to(float **targets, int num_targets, float **temp_data, int num_samples)
 	{
 		std::unique_lock<std::recursive_mutex> mutex_lock(mutex);
+		if (!playing)
+			return false;
 		get_data_in_mixer_frequency(num_samples, temp_data);
 		run_filters(temp_data, num_samples);
-		mix_channels(num_channels, num_samples, sample_data, temp_data);
+
+		float channel_volume[2];
+		get_channel_volume(channel_volume);
+
+		int bus = (mix_bus < num_targets) ? mix_bus : 0;
+		mix_channels(num_samples, targets + bus * 2, temp_data, last_channel_volume, channel_volume);
+
+		if (mix_send_bus >= 0 && mix_send_bus < num_targets)
+		{
+			float send_volume[2] = { channel_volume[0] * mix_send_level, channel_volume[1] * mix_send_level };
+			mix_channels(num_samples, targets + mix_send_bus * 2, temp_data, last_send_volume, send_volume);
+		}
+		else
+		{
+			last_send_volume[0] = 0.0f;
+			last_send_volume[1] = 0.0f;
+		}
+
 		return playing;
 	}
 
@@ -89,14 +119,17 @@ namespace clan
 
 		if (num_session_channels > 0)
 		{
-			// Copy stream data to working buffer:
-			int samples_left = num_buffer_samples;
+			// Append stream data to working buffer:
+			int samples_left = num_buffer_samples - buffer_samples_written;
 			while (samples_left > 0)
 			{
 				for (int i = 0; i < num_session_channels; i++)
 					float_buffer_data_offsetted[i] = float_buffer_data[i] + num_buffer_samples - samples_left;
 
+				uint64_t decode_start = counters ? System::get_microseconds() : 0;
 				int written = provider_session->get_data(&float_buffer_data_offsetted[0], samples_left);
+				if (counters)
+					counters->record_decode(provider_name, System::get_microseconds() - decode_start, written);
 				samples_left -= written;
 
 				if (samples_left > 0 && provider_session->eof())
@@ -130,49 +163,92 @@ namespace clan
 		}
 	}
 
+	void SoundBuffer_Session_Impl::reset_buffer()
+	{
+		for (int chan = 0; chan < num_buffer_channels; chan++)
+			SoundSSE::set_float(float_buffer_data[chan], SoundResampler::margin, 0.0f);
+		buffer_samples_written = SoundResampler::margin;
+		buffer_position = SoundResampler::margin;
+		buffer_end_padded = false;
+	}
+
+	void SoundBuffer_Session_Impl::discard_used_samples()
+	{
+		// At high speeds the position can be past the end of the data. History is kept for the resampler then too.
+		int start = std::min(int(buffer_position) - SoundResampler::margin + 1, buffer_samples_written - SoundResampler::margin);
+		if (start <= 0)
+			return;
+
+		int keep = buffer_samples_written - start;
+		for (int chan = 0; chan < num_buffer_channels; chan++)
+			memmove(float_buffer_data[chan], float_buffer_data[chan] + start, keep * sizeof(float));
+		buffer_samples_written = keep;
+		buffer_position -= start;
+	}
+
+	int SoundBuffer_Session_Impl::get_resample_count(double speed) const
+	{
+		// The last sample read for a position is int(position) + margin
+		double limit = buffer_samples_written - SoundResampler::margin;
+		if (buffer_position >= limit)
+			return 0;
+
+		double count = std::ceil((limit - buffer_position) / speed);
+		int samples = count < 0x7fffffff ? int(count) : 0x7fffffff;
+		while (samples > 0 && buffer_position + (samples - 1) * speed >= limit)
+			samples--;
+		return samples;
+	}
+
 	void SoundBuffer_Session_Impl::get_data_in_mixer_frequency(int num_samples, float **temp_data)
 	{
 		// Convert from session frequency to mixer frequency:
-		// This is done by copying data from the temporary session buffers (buffer_data) to
-		// the temporary mixing buffers (temp_data), and if buffer_data is exhausted, calling
-		// get_data() to fill it with new data from the soundprovider session object.
-		double speed = frequency / double(output.get_mixing_frequency());
-		int sample_count;
-		for (sample_count = 0; sample_count < num_samples; sample_count++)
+		// Whole blocks are resampled from the temporary session buffers (float_buffer_data) into
+		// the temporary mixing buffers (temp_data) for as long as every sample the resampler reads
+		// is present. When float_buffer_data runs dry, get_data() appends new data from the
+		// soundprovider session object after the samples still needed.
+		double speed = mix_frequency / double(mixing_frequency);
+		int sample_count = 0;
+		while (sample_count < num_samples)
 		{
-			if (buffer_position < buffer_samples_written)
+			int count = std::min(get_resample_count(speed), num_samples - sample_count);
+			if (count > 0)
 			{
 				for (int chan = 0; chan < num_buffer_channels; chan++)
-				{
-					temp_data[chan][sample_count] = float_buffer_data[chan][int(buffer_position)];
-				}
+					resampler.resample(float_buffer_data[chan], buffer_position, speed, temp_data[chan] + sample_count, count);
+				buffer_position += count * speed;
+				sample_count += count;
+				continue;
 			}
-			else
+
+			if (buffer_end_padded)
 			{
-				if (provider_session->eof())
-				{
-					playing = false;
+				// All samples of the stream were played
+				playing = false;
+				reset_buffer();
+				break;
+			}
+
+			// Out of data, get more from provider:
+			discard_used_samples();
+			int samples_before = buffer_samples_written;
+			get_data();
+			if (buffer_samples_written == samples_before)
+			{
+				if (!provider_session->eof())
 					break;
-				}
 
-				// Out of data, get more from provider:
-				buffer_position -= buffer_samples_written;
-				get_data();
-				sample_count--;
-				continue;
+				// Pad with silence so the resampler can read past the last sample
+				for (int chan = 0; chan < num_buffer_channels; chan++)
+					SoundSSE::set_float(float_buffer_data[chan] + buffer_samples_written, SoundResampler::margin, 0.0f);
+				buffer_samples_written += SoundResampler::margin;
+				buffer_end_padded = true;
 			}
-
-			buffer_position += speed;
 		}
 
 		// Clear the remaining samples (if any)
-		for (; sample_count < num_samples; sample_count++)
-		{
-			for (int chan = 0; chan < num_buffer_channels; chan++)
-			{
-				temp_data[chan][sample_count] = 0.0f;
-			}
-		}
+		for (int chan = 0; chan < num_buffer_channels; chan++)
+			SoundSSE::set_float(temp_data[chan] + sample_count, num_samples - sample_count, 0.0f);
 	}
 
 	void SoundBuffer_Session_Impl::run_filters(float **temp_data, int num_samples)
@@ -185,14 +261,13 @@ namespace clan
 
 	void SoundBuffer_Session_Impl::get_channel_volume(float *channel_volume)
 	{
-		float left_pan = 1 - pan;
-		float right_pan = 1 + pan;
+		float left_pan = 1 - mix_pan;
+		float right_pan = 1 + mix_pan;
 		if (left_pan < 0.0f) left_pan = 0.0f;
 		if (left_pan > 1.0f) left_pan = 1.0f;
 		if (right_pan < 0.0f) right_pan = 0.0f;
 		if (right_pan > 1.0f) right_pan = 1.0f;
-		if (volume < 0.0f) volume = 0.0f;
-		if (volume > 1.0f) volume = 1.0f;
+		float volume = std::max(std::min(mix_volume, 1.0f), 0.0f);
 
 		float left_volume = volume * left_pan;
 		float right_volume = volume * right_pan;
@@ -201,23 +276,21 @@ namespace clan
 		channel_volume[1] = right_volume;
 	}
 
-	void SoundBuffer_Session_Impl::mix_channels(int num_channels, int num_samples, float ** sample_data, float ** temp_data)
+	void SoundBuffer_Session_Impl::mix_channels(int num_samples, float ** sample_data, float ** temp_data, float *start_volume, float *end_volume)
 	{
-		float channel_volume[2];
-		get_channel_volume(channel_volume);
-
 		if (num_buffer_channels == 1)
 		{
 			// If its a mono stream, play it in left and right channels:
-			SoundSSE::mix_one_to_many(temp_data[0], num_samples, sample_data, channel_volume, 2);
+			SoundSSE::mix_one_to_many_ramp(temp_data[0], num_samples, sample_data, start_volume, end_volume, 2);
 		}
 		else
 		{
-			if (num_channels > num_buffer_channels)
-				num_channels = num_buffer_channels;
-
+			int num_channels = std::min(num_buffer_channels, 2);
 			for (int chan = 0; chan < num_channels; chan++)
-				SoundSSE::mix_one_to_one(temp_data[chan], num_samples, sample_data[chan], channel_volume[chan]);
+				SoundSSE::mix_one_to_one_ramp(temp_data[chan], num_samples, sample_data[chan], start_volume[chan], end_volume[chan]);
 		}
+
+		start_volume[0] = end_volume[0];
+		start_volume[1] = end_volume[1];
 	}
 }
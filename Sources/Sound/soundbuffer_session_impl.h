@@ -32,6 +32,7 @@
 #include "API/Sound/soundformat.h"
 #include "API/Sound/soundoutput.h"
 #include "API/Sound/soundbuffer.h"
+#include "sound_resampler.h"
 #include <memory>
 #include <mutex>
 
@@ -41,6 +42,7 @@ namespace clan
 	class SoundBuffer_Impl;
 	class SoundProvider_Session;
 	class SoundOutput_Impl;
+	class SoundOutputCounters;
 
 	class SoundBuffer_Session_Impl
 	{
@@ -60,14 +62,33 @@ namespace clan
 		float pan;
 		bool looping;
 		bool playing;
+
+		/// \brief Mixer thread copies of volume, pan and frequency. Only changed by commands processed between fragments.
+		float mix_volume;
+		float mix_pan;
+		float mix_frequency;
+
+		/// \brief Mixing target the session is routed to. 0 is the output, other values are SoundMixBus_Impl::index.
+		int mix_bus;
+
+		/// \brief Mixing target receiving a copy of the session at mix_send_level, or -1 for no send.
+		int mix_send_bus;
+		float mix_send_level;
+
 		std::vector<SoundFilter> filters;
+		SoundResampler resampler;
+
+		/// \brief Statistics of the output the session plays on, and the name its decode time is reported under
+		SoundOutputCounters *counters;
+		const char *provider_name;
 		mutable std::recursive_mutex mutex;
 
-		bool mix_to(float **sample_data, float **temp_data, int num_samples, int num_channels);
+		/// \brief Mixes the session into its bus and send targets. Each target is a pair of left and right channels in 'targets'.
+		bool mix_to(float **targets, int num_targets, float **temp_data, int num_samples);
 
 	private:
-		/// \brief Mixes the sample data from 'temp_data' into 'sample_data'
-		void mix_channels(int num_channels, int num_samples, float ** sample_data, float ** temp_data);
+		/// \brief Mixes the sample data from 'temp_data' into the stereo channels 'sample_data', ramping between the volumes
+		void mix_channels(int num_samples, float ** sample_data, float ** temp_data, float *start_volume, float *end_volume);
 
 		/// \brief Returns the volume of left and right channel
 		void get_channel_volume(float *out_volume);
@@ -78,9 +99,18 @@ namespace clan
 		/// \brief Runs the sample data through attached filters
 		void run_filters(float ** temp_data, int num_samples);
 
-		/// \brief Fills temporary buffers with data from provider.
+		/// \brief Appends data from provider to the temporary buffers.
 		void get_data();
 
+		/// \brief Empties the temporary buffers, leaving silence as history for the resampler.
+		void reset_buffer();
+
+		/// \brief Moves the samples the resampler still needs to the start of the temporary buffers.
+		void discard_used_samples();
+
+		/// \brief Returns how many samples can be resampled from the temporary buffers at the given speed
+		int get_resample_count(double speed) const;
+
 		/// \brief Temporary channel buffers containing sound data in provider frequency.
 		float **float_buffer_data;
 
@@ -97,5 +127,17 @@ namespace clan
 
 		/// \brief Number of samples currently written to buffer_data.
 		int buffer_samples_written;
+
+		/// \brief True once silence was appended after the last samples of the stream.
+		bool buffer_end_padded;
+
+		/// \brief Mixing frequency of the output, cached to avoid locking the output while mixing.
+		int mixing_frequency;
+
+		/// \brief Left and right volume reached at the end of the last mixed fragment. Volume changes ramp from here.
+		float last_channel_volume[2];
+
+		/// \brief Left and right send volume reached at the end of the last mixed fragment.
+		float last_send_volume[2];
 	};
 }
@@ -30,6 +30,7 @@
 #include "API/Sound/soundoutput.h"
 #include "API/Sound/soundoutput_description.h"
 #include "API/Sound/soundfilter.h"
+#include "API/Sound/soundoutput_stats.h"
 #include "API/Sound/sound.h"
 #include "soundoutput_impl.h"
 #include "setupsound.h"
@@ -49,6 +50,10 @@
 #include "Platform/Linux/soundoutput_alsa.h"
 #endif
 
+#ifdef HAVE_PULSE_PULSEAUDIO_H
+#include "Platform/Linux/soundoutput_pulseaudio.h"
+#endif
+
 namespace clan
 {
 	SoundOutput::SoundOutput()
@@ -82,17 +87,30 @@ namespace clan
 		std::shared_ptr<SoundOutput_Impl> soundoutput_impl(std::make_shared<SoundOutput_MacOSX>(desc.get_mixing_frequency(), desc.get_mixing_latency()));
 		impl = soundoutput_impl;
 #else
-#if defined(__linux__) && defined(HAVE_ALSA_ASOUNDLIB_H)
-		// Try building ALSA
-
-		std::shared_ptr<SoundOutput_Impl> alsa_impl(std::make_shared<SoundOutput_alsa>(desc.get_mixing_frequency(), desc.get_mixing_latency()));
-		if ( ( (SoundOutput_alsa *) (alsa_impl.get()))->handle)
+#if defined(__linux__) && defined(HAVE_PULSE_PULSEAUDIO_H)
+		// Try the callback driven PulseAudio (or PipeWire) output first, as it has the lowest latency
+		try
 		{
-			impl = alsa_impl;
+			impl = std::make_shared<SoundOutput_PulseAudio>(desc.get_mixing_frequency(), desc.get_mixing_latency());
 		}
-		else
+		catch (const Exception &)
 		{
-			alsa_impl.reset();
+		}
+#endif
+
+#if defined(__linux__) && defined(HAVE_ALSA_ASOUNDLIB_H)
+		// Try building ALSA
+		if (!impl)
+		{
+			std::shared_ptr<SoundOutput_Impl> alsa_impl(std::make_shared<SoundOutput_alsa>(desc.get_mixing_frequency(), desc.get_mixing_latency()));
+			if ( ( (SoundOutput_alsa *) (alsa_impl.get()))->handle)
+			{
+				impl = alsa_impl;
+			}
+			else
+			{
+				alsa_impl.reset();
+			}
 		}
 
 		if (!impl)
@@ -101,8 +119,11 @@ namespace clan
 			impl = soundoutput_impl;
 		}
 #else
-		std::shared_ptr<SoundOutput_Impl> soundoutput_impl(std::make_shared<SoundOutput_OSS>(desc.get_mixing_frequency(), desc.get_mixing_latency()));
-		impl = soundoutput_impl;
+		if (!impl)
+		{
+			std::shared_ptr<SoundOutput_Impl> soundoutput_impl(std::make_shared<SoundOutput_OSS>(desc.get_mixing_frequency(), desc.get_mixing_latency()));
+			impl = soundoutput_impl;
+		}
 #endif
 #endif
 #endif
@@ -164,6 +185,8 @@ namespace clan
 		{
 			std::unique_lock<std::recursive_mutex> mutex_lock(impl->mutex);
 			impl->volume = volume;
+			mutex_lock.unlock();
+			impl->queue_command(SoundCommand(SoundCommand::set_master_volume, volume));
 		}
 	}
 
@@ -173,6 +196,8 @@ namespace clan
 		{
 			std::unique_lock<std::recursive_mutex> mutex_lock(impl->mutex);
 			impl->pan = pan;
+			mutex_lock.unlock();
+			impl->queue_command(SoundCommand(SoundCommand::set_master_pan, pan));
 		}
 	}
 
@@ -182,6 +207,8 @@ namespace clan
 		{
 			std::unique_lock<std::recursive_mutex> mutex_lock(impl->mutex);
 			impl->filters.push_back(filter);
+			mutex_lock.unlock();
+			impl->queue_command(SoundCommand(SoundCommand::add_filter, filter));
 		}
 	}
 
@@ -198,6 +225,15 @@ namespace clan
 					break;
 				}
 			}
+			mutex_lock.unlock();
+			impl->queue_command(SoundCommand(SoundCommand::remove_filter, filter));
 		}
 	}
+
+	SoundOutputStats SoundOutput::get_stats() const
+	{
+		if (impl)
+			return impl->counters.get_stats();
+		return SoundOutputStats();
+	}
 }
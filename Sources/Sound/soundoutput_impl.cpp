@@ -29,9 +29,12 @@
 #include "Sound/precomp.h"
 #include "soundoutput_impl.h"
 #include "soundbuffer_session_impl.h"
+#include "sound_mix_bus_impl.h"
 #include "API/Sound/soundfilter.h"
 #include <algorithm>
 #include "API/Sound/sound_sse.h"
+#include "API/Core/System/profiler.h"
+#include "API/Core/System/system.h"
 
 namespace clan
 {
@@ -40,13 +43,17 @@ namespace clan
 
 	SoundOutput_Impl::SoundOutput_Impl(int mixing_frequency, int latency)
 		: mixing_frequency(mixing_frequency), mixing_latency(latency), volume(1.0f),
-		pan(0.0f), mix_buffer_size(0)
+		pan(0.0f), mix_volume(1.0f), mix_pan(0.0f), mixer_running(false), mix_buffer_size(0), next_bus_index(1), stereo_buffer_position(0)
 	{
+		sessions.reserve(256);
+		sessions_playing.reserve(256);
 		mix_buffers[0] = nullptr;
 		mix_buffers[1] = nullptr;
 		temp_buffers[0] = nullptr;
 		temp_buffers[1] = nullptr;
 		stereo_buffer = nullptr;
+		last_master_volume[0] = 1.0f;
+		last_master_volume[1] = 1.0f;
 
 		std::unique_lock<std::recursive_mutex> lock(singleton_mutex);
 		if (instance)
@@ -62,6 +69,8 @@ namespace clan
 		SoundSSE::aligned_free(mix_buffers[1]);
 		SoundSSE::aligned_free(temp_buffers[0]);
 		SoundSSE::aligned_free(temp_buffers[1]);
+		for (size_t i = 2; i < target_buffers.size(); i++)
+			SoundSSE::aligned_free(target_buffers[i]);
 
 		std::unique_lock<std::recursive_mutex> lock(singleton_mutex);
 		instance = nullptr;
@@ -69,19 +78,109 @@ namespace clan
 
 	void SoundOutput_Impl::play_session(SoundBuffer_Session &session)
 	{
-		std::unique_lock<std::recursive_mutex> mutex_lock(mutex);
-		sessions.push_back(session);
+		queue_command(SoundCommand(SoundCommand::play_session, session));
 	}
 
 	void SoundOutput_Impl::stop_session(SoundBuffer_Session &session)
+	{
+		queue_command(SoundCommand(SoundCommand::stop_session, session));
+	}
+
+	void SoundOutput_Impl::queue_command(const SoundCommand &command)
+	{
+		std::unique_lock<std::mutex> producer_lock(producer_mutex);
+		while (!commands.push(command))
+		{
+			// Without a mixer thread there is no other consumer, so the producer can drain the queue itself
+			if (mixer_running)
+				std::this_thread::yield();
+			else
+				process_commands();
+		}
+	}
+
+	int SoundOutput_Impl::create_bus_index()
 	{
 		std::unique_lock<std::recursive_mutex> mutex_lock(mutex);
+		return next_bus_index++;
+	}
 
-		for (auto it = sessions.begin(); it != sessions.end(); ++it)
+	void SoundOutput_Impl::add_virtual_voices(int delta)
+	{
+		std::unique_lock<std::recursive_mutex> lock(singleton_mutex);
+		if (instance)
+			instance->counters.add_virtual_voices(delta);
+	}
+
+	void SoundOutput_Impl::process_commands()
+	{
+		SoundCommand command;
+		while (commands.pop(command))
 		{
-			if (session.impl.get() == it->impl.get())
+			switch (command.type)
 			{
-				sessions.erase(it);
+			case SoundCommand::play_session:
+				if (std::find_if(sessions.begin(), sessions.end(), [&](const SoundBuffer_Session &session) { return session.impl == command.session.impl; }) == sessions.end())
+					sessions.push_back(command.session);
+				break;
+			case SoundCommand::stop_session:
+				sessions.erase(std::remove_if(sessions.begin(), sessions.end(), [&](const SoundBuffer_Session &session) { return session.impl == command.session.impl; }), sessions.end());
+				break;
+			case SoundCommand::set_session_volume:
+				command.session.impl->mix_volume = command.value;
+				break;
+			case SoundCommand::set_session_pan:
+				command.session.impl->mix_pan = command.value;
+				break;
+			case SoundCommand::set_session_frequency:
+				command.session.impl->mix_frequency = command.value;
+				break;
+			case SoundCommand::set_master_volume:
+				mix_volume = command.value;
+				break;
+			case SoundCommand::set_master_pan:
+				mix_pan = command.value;
+				break;
+			case SoundCommand::add_filter:
+				mix_filters.push_back(command.filter);
+				break;
+			case SoundCommand::remove_filter:
+				for (auto it = mix_filters.begin(); it != mix_filters.end(); ++it)
+				{
+					if (*it == command.filter)
+					{
+						mix_filters.erase(it);
+						break;
+					}
+				}
+				break;
+			case SoundCommand::add_bus:
+				if ((int)buses.size() < command.bus->index)
+					buses.resize(command.bus->index);
+				buses[command.bus->index - 1] = command.bus;
+				break;
+			case SoundCommand::set_bus_volume:
+				command.bus->mix_volume = command.value;
+				break;
+			case SoundCommand::add_bus_filter:
+				command.bus->mix_filters.push_back(command.filter);
+				break;
+			case SoundCommand::remove_bus_filter:
+				for (auto it = command.bus->mix_filters.begin(); it != command.bus->mix_filters.end(); ++it)
+				{
+					if (*it == command.filter)
+					{
+						command.bus->mix_filters.erase(it);
+						break;
+					}
+				}
+				break;
+			case SoundCommand::set_session_bus:
+				command.session.impl->mix_bus = command.bus ? command.bus->index : 0;
+				break;
+			case SoundCommand::set_session_send:
+				command.session.impl->mix_send_bus = command.bus ? command.bus->index : -1;
+				command.session.impl->mix_send_level = command.value;
 				break;
 			}
 		}
@@ -90,6 +189,8 @@ namespace clan
 	void SoundOutput_Impl::start_mixer_thread()
 	{
 		stop_flag = false;
+		start_device_mixing();
+
 		thread = std::thread(&SoundOutput_Impl::mixer_thread, this);
 		//	thread.set_priority(cl_priority_highest);
 	}
@@ -101,30 +202,90 @@ namespace clan
 		mutex_lock.unlock();
 		thread.join();
 		thread = std::thread();
+
+		stop_device_mixing();
+	}
+
+	void SoundOutput_Impl::start_device_mixing()
+	{
+		mixer_running = true;
+
+		// The mixing thread mixes sessions as well, so it counts as one of the cores
+		int num_workers = std::min(System::get_num_cores() - 1, max_mixer_workers);
+		mixer_pool.start(std::max(num_workers, 0));
+	}
+
+	void SoundOutput_Impl::stop_device_mixing()
+	{
+		mixer_running = false;
+		mixer_pool.stop();
+	}
+
+	void SoundOutput_Impl::mix_device_frames(float *data, int num_frames)
+	{
+		while (num_frames > 0)
+		{
+			if (stereo_buffer_position >= mix_buffer_size)
+			{
+				mix_fragment();
+				stereo_buffer_position = 0;
+				if (mix_buffer_size == 0)
+				{
+					SoundSSE::set_float(data, num_frames * 2, 0.0f);
+					return;
+				}
+			}
+
+			int count = std::min(num_frames, mix_buffer_size - stereo_buffer_position);
+			memcpy(data, stereo_buffer + stereo_buffer_position * 2, sizeof(float) * 2 * count);
+			stereo_buffer_position += count;
+			data += count * 2;
+			num_frames -= count;
+		}
+	}
+
+	int SoundOutput_Impl::get_device_period_frames() const
+	{
+		int period_ms = std::max(std::min(mixing_latency / 4, 10), 5);
+		return std::max(mixing_frequency * period_ms / 1000, 1);
 	}
 
 	void SoundOutput_Impl::mix_fragment()
 	{
+		uint64_t start_time = System::get_microseconds();
+
+		process_commands();
 		resize_mix_buffers();
 		clear_mix_buffers();
+		int num_voices = sessions.size();
 		fill_mix_buffers();
+		mix_buses();
 		filter_mix_buffers();
 		apply_master_volume_on_mix_buffers();
 		clamp_mix_buffers();
 		SoundSSE::pack_float_stereo(mix_buffers, mix_buffer_size, stereo_buffer);
+
+		int mix_time = (int)(System::get_microseconds() - start_time);
+		int deadline = (int)((int64_t)mix_buffer_size * 1000000 / std::max(mixing_frequency, 1));
+		counters.record_fragment(mix_time, deadline, num_voices);
 	}
 
 	void SoundOutput_Impl::mixer_thread()
 	{
 		mixer_thread_starting();
+		Profiler::set_thread_name("Sound mixer");
 
 		while (if_continue_mixing())
 		{
-			// Mix some audio:
-			mix_fragment();
+			{
+				cl_profile_zone("Mix fragment");
 
-			// Send mixed data to sound card:
-			write_fragment(stereo_buffer);
+				// Mix some audio:
+				mix_fragment();
+
+				// Send mixed data to sound card:
+				write_fragment(stereo_buffer);
+			}
 
 			// Wait for sound card to want more:
 			wait();
@@ -140,8 +301,13 @@ namespace clan
 
 	void SoundOutput_Impl::resize_mix_buffers()
 	{
-		if (get_fragment_size() != mix_buffer_size)
+		size_t num_target_buffers = 2 + buses.size() * 2;
+		if (get_fragment_size() != mix_buffer_size || target_buffers.size() != num_target_buffers)
 		{
+			for (size_t i = 2; i < target_buffers.size(); i++)
+				SoundSSE::aligned_free(target_buffers[i]);
+			target_buffers.clear();
+
 			SoundSSE::aligned_free(stereo_buffer); stereo_buffer = nullptr;
 			SoundSSE::aligned_free(mix_buffers[0]); mix_buffers[0] = nullptr;
 			SoundSSE::aligned_free(mix_buffers[1]); mix_buffers[1] = nullptr;
@@ -158,74 +324,88 @@ namespace clan
 			temp_buffers[1] = (float *)SoundSSE::aligned_alloc(sizeof(float) * mix_buffer_size);
 			stereo_buffer = (float *)SoundSSE::aligned_alloc(sizeof(float) * mix_buffer_size * 2);
 			SoundSSE::set_float(stereo_buffer, mix_buffer_size * 2, 0.0f);
+
+			target_buffers.push_back(mix_buffers[0]);
+			target_buffers.push_back(mix_buffers[1]);
+			while (target_buffers.size() < num_target_buffers)
+				target_buffers.push_back((float *)SoundSSE::aligned_alloc(sizeof(float) * mix_buffer_size));
 		}
 	}
 
 	void SoundOutput_Impl::clear_mix_buffers()
 	{
-		// Clear channel mixing buffers:
-		SoundSSE::set_float(mix_buffers[0], mix_buffer_size, 0.0f);
-		SoundSSE::set_float(mix_buffers[1], mix_buffer_size, 0.0f);
+		// Clear channel mixing buffers and the bus buffers following them:
+		for (float *buffer : target_buffers)
+			SoundSSE::set_float(buffer, mix_buffer_size, 0.0f);
 	}
 
 	void SoundOutput_Impl::fill_mix_buffers()
 	{
-		std::unique_lock<std::recursive_mutex> mutex_lock(mutex);
-		std::vector< SoundBuffer_Session > ended_sessions;
-		std::vector< SoundBuffer_Session >::iterator it;
-		for (it = sessions.begin(); it != sessions.end(); ++it)
+		int num_sessions = sessions.size();
+		sessions_playing.resize(num_sessions);
+
+		mixer_pool.mix(sessions.data(), sessions_playing.data(), num_sessions, target_buffers.data(), target_buffers.size() / 2, temp_buffers, mix_buffer_size);
+
+		// Release any sessions that ended during the fragment:
+		int num_playing = 0;
+		for (int i = 0; i < num_sessions; i++)
 		{
-			SoundBuffer_Session session = *it;
-			bool playing = session.impl->mix_to(mix_buffers, temp_buffers, mix_buffer_size, 2);
-			if (!playing) ended_sessions.push_back(session);
+			if (sessions_playing[i])
+				sessions[num_playing++] = sessions[i];
 		}
+		sessions.resize(num_playing);
+	}
+
+	void SoundOutput_Impl::mix_buses()
+	{
+		for (auto &bus : buses)
+		{
+			if (!bus)
+				continue;
 
-		// Release any sessions pending for removal:
-		int size_ended_sessions = ended_sessions.size();
-		for (int i = 0; i < size_ended_sessions; i++) stop_session(ended_sessions[i]);
+			// Bus filters run once on the sum of all sessions routed to the bus
+			float **bus_buffers = target_buffers.data() + bus->index * 2;
+			for (auto &filter : bus->mix_filters)
+				filter.filter(bus_buffers, mix_buffer_size, 2);
+
+			SoundSSE::mix_one_to_one_ramp(bus_buffers[0], mix_buffer_size, mix_buffers[0], bus->last_volume, bus->mix_volume);
+			SoundSSE::mix_one_to_one_ramp(bus_buffers[1], mix_buffer_size, mix_buffers[1], bus->last_volume, bus->mix_volume);
+			bus->last_volume = bus->mix_volume;
+		}
 	}
 
 	void SoundOutput_Impl::filter_mix_buffers()
 	{
 		// Apply global filters to mixing buffers:
-		std::unique_lock<std::recursive_mutex> mutex_lock(mutex);
-		int size_filters = filters.size();
-		int i;
-		for (i = 0; i < size_filters; i++)
-		{
-			filters[i].filter(mix_buffers, mix_buffer_size, 2);
-		}
+		for (auto &filter : mix_filters)
+			filter.filter(mix_buffers, mix_buffer_size, 2);
 	}
 
 	void SoundOutput_Impl::apply_master_volume_on_mix_buffers()
 	{
 		// Calculate volume on left and right channel:
-		float left_pan = 1 - pan;
-		float right_pan = 1 + pan;
+		float left_pan = 1 - mix_pan;
+		float right_pan = 1 + mix_pan;
 		if (left_pan < 0.0f) left_pan = 0.0f;
 		if (left_pan > 1.0f) left_pan = 1.0f;
 		if (right_pan < 0.0f) right_pan = 0.0f;
 		if (right_pan > 1.0f) right_pan = 1.0f;
-		if (volume < 0.0f) volume = 0.0f;
-		if (volume > 1.0f) volume = 1.0f;
+		if (mix_volume < 0.0f) mix_volume = 0.0f;
+		if (mix_volume > 1.0f) mix_volume = 1.0f;
 
-		float left_volume = volume * left_pan;
-		float right_volume = volume * right_pan;
+		float left_volume = mix_volume * left_pan;
+		float right_volume = mix_volume * right_pan;
 
-		SoundSSE::multiply_float(mix_buffers[0], mix_buffer_size, left_volume);
-		SoundSSE::multiply_float(mix_buffers[1], mix_buffer_size, right_volume);
+		SoundSSE::multiply_float_ramp(mix_buffers[0], mix_buffer_size, last_master_volume[0], left_volume);
+		SoundSSE::multiply_float_ramp(mix_buffers[1], mix_buffer_size, last_master_volume[1], right_volume);
+		last_master_volume[0] = left_volume;
+		last_master_volume[1] = right_volume;
 	}
 
 	void SoundOutput_Impl::clamp_mix_buffers()
 	{
 		// Make sure values stay inside 16 bit range:
 		for (auto & elem : mix_buffers)
-		{
-			for (int k = 0; k < mix_buffer_size; k++)
-			{
-				if (elem[k] > 1.0f)  elem[k] = 1.0f;
-				else if (elem[k] < -1.0f) elem[k] = -1.0f;
-			}
-		}
+			SoundSSE::clamp_float(elem, mix_buffer_size, -1.0f, 1.0f);
 	}
 }
@@ -34,12 +34,16 @@
 #include <mutex>
 #include <thread>
 #include <atomic>
+#include "sound_mixer_pool.h"
+#include "sound_command_queue.h"
+#include "sound_output_counters.h"
 
 namespace clan
 {
 	class SoundFilter;
 	class SoundBuffer_Session_Impl;
 	class SoundBuffer_Session;
+	class SoundMixBus_Impl;
 
 	class SoundOutput_Impl
 	{
@@ -50,6 +54,20 @@ namespace clan
 		void play_session(SoundBuffer_Session &session);
 		void stop_session(SoundBuffer_Session &session);
 
+		/// \brief Sends a state change to the mixer thread. It is applied at the start of the next fragment.
+		///
+		/// Callers on different threads are serialized by a producer mutex that the mixer thread never takes.
+		void queue_command(const SoundCommand &command);
+
+		/// \brief Returns the mixing target index for a new bus
+		int create_bus_index();
+
+		/// \brief Adjusts the virtual voice count of the current output instance, if any
+		static void add_virtual_voices(int delta);
+
+		/// \brief Mixer statistics. Safe to use from any thread.
+		SoundOutputCounters counters;
+
 	protected:
 		std::string name;
 		int mixing_frequency;
@@ -59,13 +77,42 @@ namespace clan
 		std::vector<SoundFilter> filters;
 		std::thread thread;
 		std::atomic_bool stop_flag;
+
+		/// \brief Mixer thread copies of the state above. Only changed by commands.
+		float mix_volume;
+		float mix_pan;
+		std::vector<SoundFilter> mix_filters;
+
+		/// \brief Playing sessions and whether they are still playing after the current fragment. Only accessed by the mixer thread.
 		std::vector< SoundBuffer_Session > sessions;
+		std::vector<char> sessions_playing;
+
+		SoundCommandQueue commands;
+		std::mutex producer_mutex;
+		std::atomic_bool mixer_running;
+
+		SoundMixerPool mixer_pool;
 
 		int mix_buffer_size;
 		float *mix_buffers[2];
 		float *temp_buffers[2];
 		float *stereo_buffer;
 
+		/// \brief Buses by SoundMixBus_Impl::index - 1. Holds null for buses whose add command has not arrived yet.
+		std::vector<std::shared_ptr<SoundMixBus_Impl>> buses;
+
+		/// \brief Left and right channels of each mixing target. The first pair is mix_buffers, followed by one pair per bus.
+		std::vector<float *> target_buffers;
+
+		/// \brief Next bus index handed out by create_bus_index. Protected by mutex.
+		int next_bus_index;
+
+		/// \brief Frames of stereo_buffer already handed out by mix_device_frames()
+		int stereo_buffer_position;
+
+		/// \brief Left and right master volume applied at the end of the last fragment. Volume changes ramp from here.
+		float last_master_volume[2];
+
 		/// \brief Called when we have no samples to play - and wants to tell the soundcard
 		/// \brief about this possible event.
 		virtual void silence() = 0;
@@ -91,6 +138,23 @@ namespace clan
 		/// \brief Stops the mixer thread.
 		void stop_mixer_thread();
 
+		/// \brief Prepares mixing for a callback driven device that calls mix_device_frames() from its own thread.
+		void start_device_mixing();
+
+		/// \brief Stops mixing for a callback driven device. The device must not call mix_device_frames() afterwards.
+		void stop_device_mixing();
+
+		/// \brief Mixes interleaved stereo frames straight into a device buffer.
+		///
+		/// Fragments of get_fragment_size() frames are mixed as needed. Frames of a fragment the device did not ask for
+		/// are kept for the next call, so devices may ask for any number of frames.
+		void mix_device_frames(float *data, int num_frames);
+
+		/// \brief Returns the device period callback driven devices should negotiate, in frames
+		///
+		/// A quarter of the mixing latency, kept between 5 and 10 ms.
+		int get_device_period_frames() const;
+
 		/// \brief Mixes a single fragment and stores the result in stereo_buffer.
 		void mix_fragment();
 
@@ -101,6 +165,9 @@ namespace clan
 		/// \brief Returns true if the mixer thread should continue mixing fragments
 		bool if_continue_mixing();
 
+		/// \brief Applies the queued commands to the mixer thread state
+		void process_commands();
+
 		/// \brief Ensures the mixing buffers match the fragment size
 		void resize_mix_buffers();
 
@@ -110,6 +177,9 @@ namespace clan
 		/// \brief Mixes soundbuffer sessions into the mixing buffers
 		void fill_mix_buffers();
 
+		/// \brief Applies the filters of each bus and mixes the buses into the mixing buffers
+		void mix_buses();
+
 		/// \brief Applies filters to the mixing buffers
 		void filter_mix_buffers();
 
@@ -119,6 +189,9 @@ namespace clan
 		/// \brief Clamp mixing buffer values to the -1 to 1 range
 		void clamp_mix_buffers();
 
+		/// \brief Upper limit on the number of mixer worker threads in addition to the mixer thread
+		static const int max_mixer_workers = 3;
+
 		static std::recursive_mutex singleton_mutex;
 		static SoundOutput_Impl *instance;
 
@@ -0,0 +1,136 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "UI/precomp.h"
+#include "animation_clock.h"
+#include "animation_group.h"
+#include "API/Display/System/timer.h"
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace clan
+{
+	namespace
+	{
+		// Frames presented closer together than this come from several windows showing the same vsync
+		const std::chrono::milliseconds min_tick_interval(4);
+
+		// Used when no frame is presented, for example when the animated values do not cause a render
+		const unsigned int fallback_timeout = 32;
+
+		struct AnimationClockState
+		{
+			std::vector<AnimationGroup *> groups;	// Removed groups are set to nullptr until the current tick is done
+			std::unique_ptr<Timer> timer;
+			std::chrono::steady_clock::time_point last_tick;
+			bool ticking = false;
+		};
+
+		AnimationClockState &clock_state()
+		{
+			static AnimationClockState state;
+			return state;
+		}
+	}
+
+	void AnimationClock::add(AnimationGroup *group)
+	{
+		AnimationClockState &state = clock_state();
+		state.groups.push_back(group);
+
+		if (!state.timer)
+		{
+			state.timer.reset(new Timer());
+			state.timer->func_expired() = []() { AnimationClock::tick(); };
+		}
+
+		// Start the first frame right away, the presented frames take over from there
+		if (!state.ticking && state.groups.size() == 1)
+			state.timer->start(0, false);
+	}
+
+	void AnimationClock::remove(AnimationGroup *group)
+	{
+		AnimationClockState &state = clock_state();
+		auto it = std::find(state.groups.begin(), state.groups.end(), group);
+		if (it == state.groups.end())
+			return;
+
+		if (state.ticking)
+		{
+			*it = nullptr;
+		}
+		else
+		{
+			state.groups.erase(it);
+			if (state.groups.empty())
+				state.timer->stop();
+		}
+	}
+
+	void AnimationClock::frame_presented()
+	{
+		AnimationClockState &state = clock_state();
+		if (state.groups.empty() || state.ticking)
+			return;
+
+		if (std::chrono::steady_clock::now() - state.last_tick < min_tick_interval)
+			return;
+
+		tick();
+	}
+
+	void AnimationClock::tick()
+	{
+		AnimationClockState &state = clock_state();
+		if (state.ticking)
+			return;
+
+		state.ticking = true;
+		state.last_tick = std::chrono::steady_clock::now();
+
+		// Groups added by animation callbacks start with the next tick
+		size_t count = state.groups.size();
+		for (size_t i = 0; i < count; i++)
+		{
+			if (state.groups[i])
+				state.groups[i]->tick(state.last_tick);
+		}
+
+		state.groups.erase(std::remove(state.groups.begin(), state.groups.end(), nullptr), state.groups.end());
+		state.ticking = false;
+
+		if (state.groups.empty())
+			state.timer->stop();
+		else
+			state.timer->start(fallback_timeout, false);
+	}
+}
@@ -28,14 +28,15 @@
 
 #pragma once
 
-#include "API/Display/System/timer.h"
 #include "animation.h"
+#include "animation_clock.h"
 #include <algorithm>
 #include <chrono>
 #include <vector>
 
 namespace clan
 {
+	/// \brief Animations of a view, advanced by the AnimationClock
 	class AnimationGroup
 	{
 	public:
@@ -53,38 +54,11 @@ namespace clan
 
 		void start(Animation animation)
 		{
-			if (active_animations.empty())
+			if (!running)
 			{
-				timer.func_expired() = [&]()
-				{
-					std::chrono::steady_clock::time_point current_time = std::chrono::steady_clock::now();
-
-					auto it = active_animations.begin();
-					while (it != active_animations.end())
-					{
-						long long elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(current_time - it->start_time).count();
-						float t = clan::max(clan::min(static_cast<float>(elapsed) / it->duration, 1.0f), 0.0f);
-
-						t = it->easing(t);
-						it->setter(it->from * (1.0f - t) + it->to * t);
-
-						if (t >= 1.0f)
-						{
-							if (it->animation_end)
-								it->animation_end();
-							it = active_animations.erase(it);
-						}
-						else
-						{
-							++it;
-						}
-					}
-
-					if (active_animations.empty())
-						timer.stop();
-				};
+				AnimationClock::add(this);
+				running = true;
 			}
-			timer.start(16, true);
 
 			animation.start_time = std::chrono::steady_clock::now();
 			active_animations.push_back(animation);
@@ -92,12 +66,53 @@ namespace clan
 
 		void stop()
 		{
-			timer.stop();
+			if (running)
+			{
+				AnimationClock::remove(this);
+				running = false;
+			}
 			active_animations.clear();
 		}
 
+		/// \brief Sets the animated values for the current frame. Called by AnimationClock.
+		void tick(const std::chrono::steady_clock::time_point &current_time)
+		{
+			std::vector<Animation> animations;
+			animations.swap(active_animations);
+
+			std::vector<std::function<void()>> ended;
+			for (Animation &animation : animations)
+			{
+				long long elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(current_time - animation.start_time).count();
+				float t = clan::max(clan::min(static_cast<float>(elapsed) / animation.duration, 1.0f), 0.0f);
+
+				float eased_t = animation.easing(t);
+				animation.setter(animation.from * (1.0f - eased_t) + animation.to * eased_t);
+
+				if (t >= 1.0f)
+				{
+					if (animation.animation_end)
+						ended.push_back(animation.animation_end);
+				}
+				else
+				{
+					active_animations.push_back(animation);
+				}
+			}
+
+			if (active_animations.empty())
+			{
+				AnimationClock::remove(this);
+				running = false;
+			}
+
+			// The end callbacks may start new animations or destroy this group
+			for (auto &animation_end : ended)
+				animation_end();
+		}
+
 	private:
 		std::vector<Animation> active_animations;
-		Timer timer;
+		bool running = false;
 	};
 }
@@ -31,6 +31,18 @@
 #include "API/UI/UIThread/ui_thread.h"
 #include "API/Display/2D/image.h"
 #include "API/Display/2D/canvas.h"
+#include "API/Display/Image/pixel_buffer_help.h"
+#include "API/Display/ImageProviders/jpeg_provider.h"
+#include "API/Display/ImageProviders/provider_factory.h"
+#include "API/Display/System/run_loop.h"
+#include "API/Core/IOData/file.h"
+#include "API/Core/IOData/path_help.h"
+#include "API/Core/System/work_queue.h"
+#include "API/Core/Text/string_help.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <tuple>
 
 namespace clan
 {
@@ -38,11 +50,201 @@ namespace clan
 	{
 	public:
 		ImageSourceCallback(const std::function<Image(Canvas &)> &cb_get_image) : cb_get_image(cb_get_image) { }
+		using ImageSource::get_image;
 		Image get_image(Canvas &canvas) override { return cb_get_image(canvas); }
 
 		std::function<Image(Canvas &)> cb_get_image;
 	};
 
+	/////////////////////////////////////////////////////////////////////////
+
+	class ImageFileDecode
+	{
+	public:
+		ImageFileDecode(const std::string &filename, const Size &display_size) : filename(filename), display_size(display_size) { }
+
+		Image get_image(Canvas &canvas)
+		{
+			if (image.is_null() && !pixels.is_null())
+			{
+				image = Image(canvas, pixels, Rect(0, 0, pixels.get_width(), pixels.get_height()));
+				pixels = PixelBuffer();
+			}
+			return image;
+		}
+
+		const std::string filename;
+		const Size display_size;
+
+		bool done = false;
+		PixelBuffer pixels;
+		Image image;
+		Signal<void()> sig_done;
+
+		static std::shared_ptr<ImageFileDecode> find_or_queue(const std::string &filename, const Size &display_size);
+		static PixelBuffer decode(const std::string &filename, const Size &display_size);
+		static Size get_fit_size(const Size &image_size, const Size &display_size);
+
+	private:
+		typedef std::tuple<std::string, int, int> CacheKey;
+
+		static std::map<CacheKey, std::weak_ptr<ImageFileDecode>> &get_cache()
+		{
+			static std::map<CacheKey, std::weak_ptr<ImageFileDecode>> cache;
+			return cache;
+		}
+
+		static WorkQueue &get_decode_queue()
+		{
+			static WorkQueue queue;
+			return queue;
+		}
+	};
+
+	class ImageSourceFile : public ImageSource
+	{
+	public:
+		ImageSourceFile(const std::string &filename) : filename(filename) { }
+
+		Image get_image(Canvas &canvas) override
+		{
+			if (current && current->done && current_size == Size())
+				return current->get_image(canvas);
+
+			PixelBuffer pixels = ImageProviderFactory::load(filename);
+			return Image(canvas, pixels, Rect(0, 0, pixels.get_width(), pixels.get_height()));
+		}
+
+		Image get_image(Canvas &canvas, const Size &display_size) override
+		{
+			if (!current || current_size != display_size)
+			{
+				current = ImageFileDecode::find_or_queue(filename, display_size);
+				current_size = display_size;
+				done_slot = current->sig_done.connect([this]() { sig_image_ready()(); });
+			}
+
+			return current->done ? current->get_image(canvas) : Image();
+		}
+
+		bool is_async() const override { return true; }
+
+	private:
+		std::string filename;
+		std::shared_ptr<ImageFileDecode> current;
+		Size current_size;
+		Slot done_slot;
+	};
+
+	std::shared_ptr<ImageFileDecode> ImageFileDecode::find_or_queue(const std::string &filename, const Size &display_size)
+	{
+		auto &cache = get_cache();
+
+		CacheKey key(filename, std::max(display_size.width, 0), std::max(display_size.height, 0));
+		std::shared_ptr<ImageFileDecode> decode = cache[key].lock();
+		if (decode)
+			return decode;
+
+		// Forget images no source uses anymore
+		for (auto it = cache.begin(); it != cache.end();)
+		{
+			if (it->second.expired() && it->first != key)
+				it = cache.erase(it);
+			else
+				++it;
+		}
+
+		decode = std::make_shared<ImageFileDecode>(filename, display_size);
+		cache[key] = decode;
+
+		std::shared_ptr<ImageFileDecode> worker_decode = decode;
+		get_decode_queue().queue([worker_decode]() mutable
+		{
+			PixelBuffer pixels;
+			try
+			{
+				pixels = ImageFileDecode::decode(worker_decode->filename, worker_decode->display_size);
+			}
+			catch (...)
+			{
+				// A failed decode leaves the source without an image, like a missing resource
+			}
+
+			// The last reference may own a texture, so it must be released on the UI thread
+			std::shared_ptr<ImageFileDecode> decode = std::move(worker_decode);
+			RunLoop::main_thread_async([decode, pixels]()
+			{
+				decode->pixels = pixels;
+				decode->done = true;
+				decode->sig_done();
+			});
+		});
+
+		return decode;
+	}
+
+	PixelBuffer ImageFileDecode::decode(const std::string &filename, const Size &display_size)
+	{
+		bool scaled = display_size.width > 0 && display_size.height > 0;
+
+		PixelBuffer pixels;
+		std::string extension = StringHelp::text_to_lower(PathHelp::get_extension(filename));
+		if (scaled && (extension == "jpg" || extension == "jpeg"))
+		{
+			File file(filename);
+			Size image_size = JPEGProvider::get_size(file);
+
+			// Let the IDCT do as much of the downscaling as possible
+			int scale_denominator = 1;
+			if (image_size.width > 0 && image_size.height > 0)
+			{
+				Size fit_size = get_fit_size(image_size, display_size);
+				while (scale_denominator < 8)
+				{
+					int next = scale_denominator * 2;
+					if ((image_size.width + next - 1) / next < fit_size.width || (image_size.height + next - 1) / next < fit_size.height)
+						break;
+					scale_denominator = next;
+				}
+			}
+
+			file.seek(0);
+			pixels = JPEGProvider::load_scaled(file, scale_denominator);
+		}
+		else
+		{
+			pixels = ImageProviderFactory::load(filename);
+		}
+
+		if (scaled && !pixels.is_compressed())
+		{
+			Size fit_size = get_fit_size(pixels.get_size(), display_size);
+			if (fit_size != pixels.get_size())
+				pixels = PixelBufferHelp::resample(pixels, fit_size.width, fit_size.height);
+		}
+
+		return pixels;
+	}
+
+	Size ImageFileDecode::get_fit_size(const Size &image_size, const Size &display_size)
+	{
+		if (image_size.width <= display_size.width && image_size.height <= display_size.height)
+			return image_size;
+
+		// Smallest size covering the display size with the aspect ratio kept, so nothing is upscaled when drawn
+		float scale = std::min((float)display_size.width / image_size.width, (float)display_size.height / image_size.height);
+		int width = std::min(std::max((int)std::ceil(image_size.width * scale), 1), image_size.width);
+		int height = std::min(std::max((int)std::ceil(image_size.height * scale), 1), image_size.height);
+		return Size(width, height);
+	}
+
+	/////////////////////////////////////////////////////////////////////////
+
+	Image ImageSource::get_image(Canvas &canvas, const Size &display_size)
+	{
+		return get_image(canvas);
+	}
+
 	std::shared_ptr<ImageSource> ImageSource::from_callback(const std::function<Image(Canvas &)> &get_image_callback)
 	{
 		return std::make_shared<ImageSourceCallback>(get_image_callback);
@@ -63,4 +265,8 @@ namespace clan
 			});
 	}
 
+	std::shared_ptr<ImageSource> ImageSource::from_file(const std::string &filename)
+	{
+		return std::make_shared<ImageSourceFile>(filename);
+	}
 }
@@ -59,10 +59,12 @@ namespace clan
 	void ListBoxView::set_items(const std::vector<std::shared_ptr<View>> &items)
 	{
 		impl->selected_item = -1;
+		impl->hot_item = -1;
+		impl->data_source.reset();
+		impl->items_view.reset();
 		
-		auto views = content_view()->subviews();
-		while (!views.empty())
-			views.back()->remove_from_super();
+		while (!content_view()->subviews().empty())
+			content_view()->subviews().back()->remove_from_super();
 		
 		for (auto &item : items)
 		{
@@ -74,6 +76,43 @@ namespace clan
 
 	}
 	
+	void ListBoxView::set_data_source(const std::shared_ptr<ListBoxDataSource> &data_source)
+	{
+		impl->selected_item = -1;
+		impl->hot_item = -1;
+
+		while (!content_view()->subviews().empty())
+			content_view()->subviews().back()->remove_from_super();
+
+		impl->data_source = data_source;
+		impl->items_view = std::make_shared<ListBoxItemsView>(impl.get());
+		content_view()->add_subview(impl->items_view);
+		impl->items_view->reload();
+	}
+
+	void ListBoxView::reload_data()
+	{
+		if (!impl->items_view)
+			return;
+
+		if (impl->selected_item >= impl->item_count())
+			impl->selected_item = -1;
+		impl->hot_item = -1;
+		impl->items_view->reload();
+	}
+
+	void ListBoxView::set_overscan(int rows)
+	{
+		impl->overscan = clan::max(rows, 0);
+		if (impl->items_view)
+			impl->items_view->set_needs_layout();
+	}
+
+	int ListBoxView::item_count() const
+	{
+		return impl->item_count();
+	}
+
 	int ListBoxView::selected_item() const
 	{
 		return impl->selected_item;
@@ -84,23 +123,32 @@ namespace clan
 		if (index == impl->selected_item)
 			return;
 		
-		if (index < -1 || index >= (int) content_view()->subviews().size())
+		if (index < -1 || index >= impl->item_count())
 			throw Exception("Listbox index out of bounds");
 
 		if (impl->selected_item != -1)
-			content_view()->subviews().at(impl->selected_item)->set_state("selected", false);
+		{
+			View *old_selected_item = impl->item_view(impl->selected_item);
+			if (old_selected_item)
+				old_selected_item->set_state("selected", false);
+		}
 		
 		if (index != -1)
 		{
 			if (impl->hot_item == index)
 				impl->set_hot_item(-1);
 
-			auto new_selected_item = content_view()->subviews().at(index);
-			new_selected_item->set_state("selected", true);
+			View *new_selected_item = impl->item_view(index);
+			if (new_selected_item)
+				new_selected_item->set_state("selected", true);
 			
 			// To do: call set_content_offset() if new_selected_item is not within range (maybe add a helper on ScrollView for this?)
 		}
 		
 		impl->selected_item = index;
+
+		// Virtualized rows may not have a view yet, so bring the row into view to have it bound
+		if (index != -1 && impl->items_view)
+			impl->items_view->scroll_to_row(index);
 	}
 }
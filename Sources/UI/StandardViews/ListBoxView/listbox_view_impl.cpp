@@ -33,12 +33,281 @@
 #include "API/UI/Events/pointer_event.h"
 #include "API/UI/Events/key_event.h"
 #include "listbox_view_impl.h"
+#include <algorithm>
 
 namespace clan
 {
+	void ListBoxRowHeights::reset(int count, float estimate)
+	{
+		heights.assign(count, -1.0f);
+		estimated_height = estimate;
+		rebuild();
+	}
+
+	void ListBoxRowHeights::set_estimate(float estimate)
+	{
+		estimated_height = estimate;
+		rebuild();
+	}
+
+	void ListBoxRowHeights::set_height(int index, float new_height)
+	{
+		float delta = new_height - height(index);
+		heights[index] = new_height;
+		if (delta != 0.0f)
+			add(index, delta);
+	}
+
+	float ListBoxRowHeights::offset(int index) const
+	{
+		float sum = 0.0f;
+		for (int i = index; i > 0; i -= i & -i)
+			sum += tree[i];
+		return sum;
+	}
+
+	int ListBoxRowHeights::find(float offset) const
+	{
+		int count = size();
+		if (count == 0 || offset <= 0.0f)
+			return 0;
+
+		int step = 1;
+		while (step * 2 <= count)
+			step *= 2;
+
+		// Descend the tree to the number of rows ending at or above the offset
+		int pos = 0;
+		for (; step > 0; step >>= 1)
+		{
+			if (pos + step <= count && tree[pos + step] <= offset)
+			{
+				pos += step;
+				offset -= tree[pos];
+			}
+		}
+		return std::min(pos, count - 1);
+	}
+
+	void ListBoxRowHeights::add(int index, float delta)
+	{
+		int count = size();
+		for (int i = index + 1; i <= count; i += i & -i)
+			tree[i] += delta;
+	}
+
+	void ListBoxRowHeights::rebuild()
+	{
+		int count = size();
+		tree.assign(count + 1, 0.0f);
+		for (int i = 1; i <= count; i++)
+		{
+			tree[i] += height(i - 1);
+			int parent = i + (i & -i);
+			if (parent <= count)
+				tree[parent] += tree[i];
+		}
+	}
+
+	/////////////////////////////////////////////////////////////////////////
+
+	ListBoxItemsView::ListBoxItemsView(ListBoxViewImpl *listbox) : listbox(listbox)
+	{
+		slots.connect(listbox->listbox->sig_content_offset_changed(), [this]() { set_needs_layout(); });
+	}
+
+	void ListBoxItemsView::reload()
+	{
+		int count = listbox->data_source ? listbox->data_source->item_count() : 0;
+		float estimate = listbox->data_source ? listbox->data_source->estimated_item_height() : 0.0f;
+		heights.reset(count, estimate > 0.0f ? estimate : heights.estimate());
+
+		for (auto &row_view : row_views)
+		{
+			row_view.index = -1;
+			row_view.view->set_hidden(true);
+		}
+		set_needs_layout();
+	}
+
+	View *ListBoxItemsView::find_row_view(int index) const
+	{
+		for (auto &row_view : row_views)
+		{
+			if (row_view.index == index)
+				return row_view.view.get();
+		}
+		return nullptr;
+	}
+
+	int ListBoxItemsView::row_at(const Pointf &pos) const
+	{
+		if (pos.y < 0.0f || pos.y >= heights.total())
+			return -1;
+		return heights.find(pos.y);
+	}
+
+	void ListBoxItemsView::scroll_to_row(int index)
+	{
+		if (index < 0 || index >= heights.size())
+			return;
+
+		Pointf offset = listbox->listbox->content_offset();
+		float viewport = listbox->listbox->geometry().content_height;
+		float top = heights.offset(index);
+		float bottom = top + heights.height(index);
+		if (top < offset.y)
+			offset.y = top;
+		else if (bottom > offset.y + viewport)
+			offset.y = bottom - viewport;
+		listbox->listbox->set_content_offset(offset);
+	}
+
+	void ListBoxItemsView::layout_subviews(Canvas &canvas)
+	{
+		float width = geometry().content_width;
+		update_rows(canvas, width);
+
+		for (auto &row_view : row_views)
+		{
+			if (row_view.index == -1)
+				continue;
+
+			float top = heights.offset(row_view.index);
+			float bottom = top + heights.height(row_view.index);
+			row_view.view->set_geometry(ViewGeometry::from_margin_box(row_view.view->style_cascade(), Rectf(0.0f, top, width, bottom)));
+			row_view.view->layout_subviews_if_needed(canvas);
+		}
+	}
+
+	float ListBoxItemsView::calculate_preferred_width(Canvas &canvas)
+	{
+		// The list box scrolls vertically only, so the rows take the width they are given
+		return 0.0f;
+	}
+
+	float ListBoxItemsView::calculate_preferred_height(Canvas &canvas, float width)
+	{
+		update_rows(canvas, width);
+		return heights.total();
+	}
+
+	void ListBoxItemsView::update_rows(Canvas &canvas, float width)
+	{
+		auto &data_source = listbox->data_source;
+		int count = heights.size();
+		if (!data_source || count == 0)
+			return;
+
+		auto measure = [&](View *view)
+		{
+			float content_height = view->get_preferred_height(canvas, width);
+			return ViewGeometry::from_content_box(view->style_cascade(), Rectf(0.0f, 0.0f, width, content_height)).margin_box().get_height();
+		};
+
+		// Row heights depend on the width, so a new width starts measuring over
+		if (width != measured_width)
+		{
+			heights.reset(count, heights.estimate());
+			measured_width = width;
+		}
+
+		// Without an estimate every row would count as visible. Measure the first row and use it for the others.
+		if (heights.estimate() <= 0.0f)
+		{
+			RowView &row_view = acquire_row_view();
+			data_source->bind_item_view(row_view.view.get(), 0);
+			listbox->update_item_states(row_view.view.get(), 0);
+			row_view.index = 0;
+			float first_height = measure(row_view.view.get());
+			heights.set_estimate(std::max(first_height, 1.0f));
+			heights.set_height(0, first_height);
+		}
+
+		Pointf offset = listbox->listbox->content_offset();
+		float viewport = listbox->listbox->geometry().content_height;
+		int anchor = heights.find(offset.y);
+		float anchor_offset = heights.offset(anchor);
+		int first = std::max(anchor - listbox->overscan, 0);
+		int last = std::min(heights.find(offset.y + viewport) + listbox->overscan, count - 1);
+
+		for (auto &row_view : row_views)
+		{
+			if (row_view.index != -1 && (row_view.index < first || row_view.index > last))
+			{
+				row_view.index = -1;
+				row_view.view->set_hidden(true);
+			}
+		}
+
+		for (int index = first; index <= last; index++)
+		{
+			if (find_row_view(index))
+				continue;
+
+			RowView &row_view = acquire_row_view();
+			data_source->bind_item_view(row_view.view.get(), index);
+			listbox->update_item_states(row_view.view.get(), index);
+			row_view.index = index;
+		}
+
+		for (auto &row_view : row_views)
+		{
+			if (row_view.index != -1 && !heights.measured(row_view.index))
+				heights.set_height(row_view.index, measure(row_view.view.get()));
+		}
+
+		// Keep the first visible row in place when rows above it turned out taller or shorter than estimated
+		float anchor_delta = heights.offset(anchor) - anchor_offset;
+		if (anchor_delta != 0.0f)
+			listbox->listbox->set_content_offset(Pointf(offset.x, offset.y + anchor_delta));
+	}
+
+	ListBoxItemsView::RowView &ListBoxItemsView::acquire_row_view()
+	{
+		for (auto &row_view : row_views)
+		{
+			if (row_view.index == -1)
+			{
+				row_view.view->set_hidden(false);
+				return row_view;
+			}
+		}
+
+		RowView row_view;
+		row_view.view = listbox->data_source->create_item_view();
+		add_subview(row_view.view);
+		slots.connect(row_view.view->sig_pointer_enter(), listbox, &ListBoxViewImpl::on_pointer_enter);
+		slots.connect(row_view.view->sig_pointer_leave(), listbox, &ListBoxViewImpl::on_pointer_leave);
+		row_views.push_back(row_view);
+		return row_views.back();
+	}
+
+	/////////////////////////////////////////////////////////////////////////
+
+	int ListBoxViewImpl::item_count() const
+	{
+		if (items_view)
+			return data_source ? data_source->item_count() : 0;
+		return (int)listbox->content_view()->subviews().size();
+	}
+
+	View *ListBoxViewImpl::item_view(int index) const
+	{
+		if (items_view)
+			return items_view->find_row_view(index);
+		return listbox->content_view()->subviews().at(index).get();
+	}
+
+	void ListBoxViewImpl::update_item_states(View *view, int index)
+	{
+		view->set_state("selected", index == selected_item);
+		view->set_state("hot", index == hot_item && index != selected_item);
+	}
+
 	void ListBoxViewImpl::on_key_press(KeyEvent &e)
 	{
-		if (listbox->content_view()->subviews().empty())
+		if (item_count() == 0)
 			return;
 
 		if (e.key() == Key::up)
@@ -49,7 +318,7 @@ namespace clan
 		}
 		else if (e.key() == Key::down)
 		{
-			listbox->set_selected_item(clan::min(selected_item + 1, (int)listbox->content_view()->subviews().size() - 1));
+			listbox->set_selected_item(clan::min(selected_item + 1, item_count() - 1));
 			if (func_selection_changed)
 				func_selection_changed();
 		}
@@ -84,6 +353,9 @@ namespace clan
 
 	int ListBoxViewImpl::get_selection_index(PointerEvent &e)
 	{
+		if (items_view)
+			return items_view->row_at(e.pos(items_view));
+
 		int index = 0;
 		for (auto &view : listbox->content_view()->subviews())
 		{
@@ -100,16 +372,21 @@ namespace clan
 		if ((index == hot_item) || (index == selected_item))		// Selected item state has priority
 			return;
 
-		if (index < -1 || index >= (int) listbox->content_view()->subviews().size())
+		if (index < -1 || index >= item_count())
 			throw Exception("Listbox index out of bounds");
 
 		if (hot_item != -1)
-			listbox->content_view()->subviews().at(hot_item)->set_state("hot", false);
+		{
+			View *old_hot_item = item_view(hot_item);
+			if (old_hot_item)
+				old_hot_item->set_state("hot", false);
+		}
 
 		if (index != -1)
 		{
-			auto new_selected_item = listbox->content_view()->subviews().at(index);
-			new_selected_item->set_state("hot", true);
+			View *new_hot_item = item_view(index);
+			if (new_hot_item)
+				new_hot_item->set_state("hot", true);
 		}
 
 		hot_item = index;
@@ -28,8 +28,87 @@
 */
 #pragma once
 
+#include <vector>
+
 namespace clan
 {
+	class ListBoxViewImpl;
+
+	/// Row heights of a virtualized list box, with unmeasured rows counted at an estimated height
+	///
+	/// Stored in a Fenwick tree, so row offsets and the row at an offset are found in logarithmic time.
+	class ListBoxRowHeights
+	{
+	public:
+		void reset(int count, float estimate);
+
+		/// Changes the height used for unmeasured rows
+		void set_estimate(float estimate);
+
+		int size() const { return (int)heights.size(); }
+		float estimate() const { return estimated_height; }
+
+		bool measured(int index) const { return heights[index] >= 0.0f; }
+		float height(int index) const { return heights[index] >= 0.0f ? heights[index] : estimated_height; }
+		void set_height(int index, float height);
+
+		/// Offset of the top of a row. Passing size() returns the total height.
+		float offset(int index) const;
+		float total() const { return offset(size()); }
+
+		/// Row containing the offset, clamped to the valid rows
+		int find(float offset) const;
+
+	private:
+		void add(int index, float delta);
+		void rebuild();
+
+		std::vector<float> heights;	// -1 for rows not measured yet
+		std::vector<float> tree;
+		float estimated_height = 0.0f;
+	};
+
+	/// Content of a virtualized list box. Only has views for the visible rows and the overscan.
+	class ListBoxItemsView : public View
+	{
+	public:
+		ListBoxItemsView(ListBoxViewImpl *listbox);
+
+		/// Rereads the row count and releases all row views for rebinding
+		void reload();
+
+		/// View currently showing a row, or null if the row is not realized
+		View *find_row_view(int index) const;
+
+		/// Row at a position in the coordinates of this view, or -1
+		int row_at(const Pointf &pos) const;
+
+		/// Changes the content offset of the list box so the row is fully visible
+		void scroll_to_row(int index);
+
+		void layout_subviews(Canvas &canvas) override;
+
+	protected:
+		float calculate_preferred_width(Canvas &canvas) override;
+		float calculate_preferred_height(Canvas &canvas, float width) override;
+
+	private:
+		struct RowView
+		{
+			std::shared_ptr<View> view;
+			int index = -1;	// -1 for views free for reuse
+		};
+
+		/// Binds views to the rows in the visible range and measures them
+		void update_rows(Canvas &canvas, float width);
+		RowView &acquire_row_view();
+
+		ListBoxViewImpl *listbox;
+		std::vector<RowView> row_views;
+		ListBoxRowHeights heights;
+		float measured_width = -1.0f;
+	};
+
 	class ListBoxViewImpl
 	{
 	public:
@@ -41,11 +120,23 @@ namespace clan
 
 		void set_hot_item(int index);
 
+		int item_count() const;
+
+		/// View showing an item, or null if the item is virtualized and not visible
+		View *item_view(int index) const;
+
+		/// Updates the selected and hot states of a row view after binding it to an item
+		void update_item_states(View *view, int index);
+
 		ListBoxView *listbox = nullptr;
 		int selected_item = -1;
 		int hot_item = -1;
 		int last_selected_item = -1;
 
+		std::shared_ptr<ListBoxDataSource> data_source;
+		std::shared_ptr<ListBoxItemsView> items_view;
+		int overscan = 4;
+
 		std::function<void()> func_selection_changed;
 
 	private:
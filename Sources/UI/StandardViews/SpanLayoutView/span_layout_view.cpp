@@ -95,18 +95,18 @@ namespace clan
 
 	float SpanLayoutView::calculate_preferred_width(Canvas &canvas)
 	{
-		if (style_cascade().computed_value("width").is_keyword("auto"))
+		if (style_cascade().computed_value(StylePropertyId::width).is_keyword("auto"))
 			return impl->get_preferred_width(canvas);
 		else
-			return style_cascade().computed_value("width").number();
+			return style_cascade().computed_value(StylePropertyId::width).number();
 	}
 
 	float SpanLayoutView::calculate_preferred_height(Canvas &canvas, float width)
 	{
-		if (style_cascade().computed_value("height").is_keyword("auto"))
+		if (style_cascade().computed_value(StylePropertyId::height).is_keyword("auto"))
 			return impl->get_preferred_height(canvas, width);
 		else
-			return style_cascade().computed_value("height").number();
+			return style_cascade().computed_value(StylePropertyId::height).number();
 	}
 
 	float SpanLayoutView::calculate_first_baseline_offset(Canvas &canvas, float width)
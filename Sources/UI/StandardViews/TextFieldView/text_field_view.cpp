@@ -369,7 +369,7 @@ namespace clan
 			Path::rect(selection_rect).fill(canvas, focus_view() == this ? Brush::solid_rgb8(51, 153, 255) : Brush::solid_rgb8(200, 200, 200));
 		}
 
-		Colorf color = style_cascade().computed_value("color").color();
+		Colorf color = style_cascade().computed_value(StylePropertyId::color).color();
 		font.draw_text(canvas, -impl->scroll_pos, baseline, txt_before, color);
 		font.draw_text(canvas, advance_before - impl->scroll_pos, baseline, txt_selected, focus_view() == this ? Colorf(255, 255, 255) : color);
 		font.draw_text(canvas, advance_before + advance_selected - impl->scroll_pos, baseline, txt_after, color);
@@ -391,24 +391,24 @@ namespace clan
 
 	float TextFieldView::calculate_preferred_width(Canvas &canvas)
 	{
-		if (style_cascade().computed_value("width").is_keyword("auto"))
+		if (style_cascade().computed_value(StylePropertyId::width).is_keyword("auto"))
 		{
 			Font font = impl->get_font(canvas);
 			return font.measure_text(canvas, "X").advance.width * impl->preferred_size;
 		}
 		else
-			return style_cascade().computed_value("width").number();
+			return style_cascade().computed_value(StylePropertyId::width).number();
 	}
 
 	float TextFieldView::calculate_preferred_height(Canvas &canvas, float width)
 	{
-		if (style_cascade().computed_value("height").is_keyword("auto"))
+		if (style_cascade().computed_value(StylePropertyId::height).is_keyword("auto"))
 		{
 			Font font = impl->get_font(canvas);
 			return font.get_font_metrics(canvas).get_line_height();
 		}
 		else
-			return style_cascade().computed_value("height").number();
+			return style_cascade().computed_value(StylePropertyId::height).number();
 	}
 
 	float TextFieldView::calculate_first_baseline_offset(Canvas &canvas, float width)
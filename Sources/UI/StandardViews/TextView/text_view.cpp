@@ -48,7 +48,6 @@ namespace clan
 	TextView::TextView() : impl(new TextViewImpl())
 	{
 		impl->textfield = this;
-		impl->text_lines.resize(1);
 		impl->selection.set_view(this);
 
 		set_focus_policy(FocusPolicy::accept);
@@ -94,26 +93,13 @@ namespace clan
 
 	std::string TextView::text() const
 	{
-		size_t length = 0;
-		for (const auto &line : impl->text_lines) length += line.length() + 1;
-
-		std::string all_text;
-		all_text.reserve(length);
-		for (const auto &line : impl->text_lines)
-		{
-			if (!all_text.empty())
-				all_text.push_back('\n');
-			all_text += line;
-		}
-
-		return all_text;
+		return impl->document.get_text();
 	}
 
 	void TextView::set_text(const std::string &text)
 	{
-		impl->text_lines = StringHelp::split_text(text, "\n", false);
-		if (impl->text_lines.empty())
-			impl->text_lines.resize(1);
+		impl->document.set_text(text);
+		impl->start_indexing_updates();
 
 		impl->selection.reset();
 		impl->cursor_pos = Vec2i();
@@ -182,10 +168,10 @@ namespace clan
 	void TextView::set_selection(Vec2i head, Vec2i tail)
 	{
 		// Bounds check: (to do: should we throw an out of bounds exception instead?)
-		head.y = std::max(std::min(head.y, (int)impl->text_lines.size() - 1), 0);
-		tail.y = std::max(std::min(head.y, (int)impl->text_lines.size() - 1), 0);
-		head.x = std::max(std::min(head.x, (int)impl->text_lines[head.y].size()), 0);
-		tail.x = std::max(std::min(tail.x, (int)impl->text_lines[tail.y].size()), 0);
+		head.y = std::max(std::min(head.y, (int)impl->document.size() - 1), 0);
+		tail.y = std::max(std::min(head.y, (int)impl->document.size() - 1), 0);
+		head.x = std::max(std::min(head.x, (int)impl->document.line_length(head.y)), 0);
+		tail.x = std::max(std::min(tail.x, (int)impl->document.line_length(tail.y)), 0);
 
 		impl->selection.set_head_and_tail(head, tail);
 		impl->cursor_pos = tail;
@@ -205,7 +191,7 @@ namespace clan
 
 	void TextView::select_all()
 	{
-		set_selection(Vec2i(0, 0), Vec2i(impl->text_lines.back().size(), impl->text_lines.size() - 1));
+		set_selection(Vec2i(0, 0), Vec2i(impl->document.line_length(impl->document.size() - 1), impl->document.size() - 1));
 	}
 
 	Vec2i TextView::cursor_pos() const
@@ -252,17 +238,31 @@ namespace clan
 		float top_y = baseline - font_metrics.get_ascent();
 		float bottom_y = baseline + font_metrics.get_descent();
 
-		Colorf color = style_cascade().computed_value("color").color();
+		Colorf color = style_cascade().computed_value(StylePropertyId::color).color();
+
+		float line_height = font_metrics.get_line_height();
 
-		float cursor_advance = canvas.grid_fit({ font.measure_text(canvas, impl->text_lines[impl->cursor_pos.y].substr(0, impl->cursor_pos.x)).advance.width, 0.0f }).x;
+		float cursor_advance = canvas.grid_fit({ font.measure_text(canvas, impl->document.line(impl->cursor_pos.y).substr(0, impl->cursor_pos.x)).advance.width, 0.0f }).x;
+		float cursor_top = line_height * impl->cursor_pos.y;
 
 		// Keep cursor in view
 		impl->scroll_pos.x = std::min(impl->scroll_pos.x, cursor_advance);
 		impl->scroll_pos.x = std::max(impl->scroll_pos.x, cursor_advance - geometry().content_width + 1.0f);
+		impl->scroll_pos.y = std::min(impl->scroll_pos.y, cursor_top);
+		impl->scroll_pos.y = std::max(impl->scroll_pos.y, cursor_top + line_height - geometry().content_height);
+
+		// Only the lines in view, plus a margin, are measured and drawn
+		size_t first_line = 0;
+		size_t end_line = impl->document.size();
+		if (line_height > 0.0f)
+		{
+			first_line = (size_t)std::max((int)(impl->scroll_pos.y / line_height) - TextViewImpl::viewport_margin_lines, 0);
+			end_line = std::min(end_line, (size_t)((impl->scroll_pos.y + geometry().content_height) / line_height) + 1 + TextViewImpl::viewport_margin_lines);
+		}
 
-		size_t line_start_y = -impl->scroll_pos.y;
+		float line_start_y = line_height * first_line - impl->scroll_pos.y;
 
-		for (size_t line_index = 0; line_index < impl->text_lines.size(); line_index++)
+		for (size_t line_index = first_line; line_index < end_line; line_index++)
 		{
 			std::string txt_before = impl->get_text_before_selection(line_index);
 			std::string txt_selected = impl->get_selected_text(line_index);
@@ -286,7 +286,7 @@ namespace clan
 			font.draw_text(canvas, advance_before - impl->scroll_pos.x, baseline + line_start_y, txt_selected, focus_view() == this ? Colorf(255, 255, 255) : color);
 			font.draw_text(canvas, advance_before + advance_selected - impl->scroll_pos.x, baseline + line_start_y, txt_after, color);
 
-			line_start_y += font_metrics.get_line_height();
+			line_start_y += line_height;
 		}
 
 		if (impl->cursor_blink_visible)
@@ -295,7 +295,7 @@ namespace clan
 			Path::rect(cursor_pos.x, cursor_pos.y, 1.0f, bottom_y - top_y).fill(canvas, Brush(color));
 		}
 
-		if (impl->text_lines.size() == 1 && impl->text_lines.front().empty())
+		if (impl->document.size() == 1 && impl->document.line_length(0) == 0)
 		{
 			color.r = color.r * 0.5f + 0.5f;
 			color.g = color.g * 0.5f + 0.5f;
@@ -306,24 +306,24 @@ namespace clan
 
 	float TextView::calculate_preferred_width(Canvas &canvas)
 	{
-		if (style_cascade().computed_value("width").is_keyword("auto"))
+		if (style_cascade().computed_value(StylePropertyId::width).is_keyword("auto"))
 		{
 			Font font = impl->get_font(canvas);
 			return font.measure_text(canvas, "X").advance.width * impl->preferred_size.width;
 		}
 		else
-			return style_cascade().computed_value("width").number();
+			return style_cascade().computed_value(StylePropertyId::width).number();
 	}
 
 	float TextView::calculate_preferred_height(Canvas &canvas, float width)
 	{
-		if (style_cascade().computed_value("height").is_keyword("auto"))
+		if (style_cascade().computed_value(StylePropertyId::height).is_keyword("auto"))
 		{
 			Font font = impl->get_font(canvas);
 			return font.get_font_metrics(canvas).get_line_height() * impl->preferred_size.height;
 		}
 		else
-			return style_cascade().computed_value("height").number();
+			return style_cascade().computed_value(StylePropertyId::height).number();
 	}
 
 	float TextView::calculate_first_baseline_offset(Canvas &canvas, float width)
@@ -346,6 +346,24 @@ namespace clan
 		return font;
 	}
 
+	void TextViewImpl::start_indexing_updates()
+	{
+		if (!document.is_indexing())
+		{
+			index_timer.stop();
+			return;
+		}
+
+		index_timer.func_expired() = [&]()
+		{
+			if (document.update_index())
+				textfield->set_needs_render();
+			if (!document.is_indexing())
+				index_timer.stop();
+		};
+		index_timer.start(100, true);
+	}
+
 	void TextViewImpl::start_blink()
 	{
 		blink_timer.func_expired() = [&]()
@@ -582,7 +600,7 @@ namespace clan
 
 	void TextViewImpl::select_all()
 	{
-		selection.set_head_and_tail(Vec2i(), Vec2i(text_lines.back().size(), text_lines.size()));
+		selection.set_head_and_tail(Vec2i(), Vec2i(document.line_length(document.size() - 1), document.size()));
 	}
 
 	void TextViewImpl::move_line(int steps, bool ctrl, bool shift, bool stay_on_line)
@@ -599,10 +617,10 @@ namespace clan
 		{
 			for (int i = 0; i < steps; i++)
 			{
-				if (pos.y + 1 != text_lines.size())
+				if ((size_t)(pos.y + 1) != document.size())
 				{
 					pos.y++;
-					pos.x = std::min(pos.x, (int)text_lines[pos.y].size());
+					pos.x = std::min(pos.x, (int)document.line_length(pos.y));
 				}
 			}
 		}
@@ -613,7 +631,7 @@ namespace clan
 				if (pos.y > 0)
 				{
 					pos.y--;
-					pos.x = std::min(pos.x, (int)text_lines[pos.y].size());
+					pos.x = std::min(pos.x, (int)document.line_length(pos.y));
 				}
 			}
 		}
@@ -646,13 +664,13 @@ namespace clan
 				if (!stay_on_line && pos.x == 0 && pos.y != 0)
 				{
 					pos.y--;
-					pos.x = text_lines[pos.y].size();
+					pos.x = document.line_length(pos.y);
 				}
 				pos.x = find_previous_break_character(pos.x, pos.y);
 			}
 			else
 			{
-				if (!stay_on_line && pos.x == text_lines[pos.y].size() && pos.y + 1 != text_lines.size())
+				if (!stay_on_line && (size_t)pos.x == document.line_length(pos.y) && (size_t)(pos.y + 1) != document.size())
 				{
 					pos.y++;
 					pos.x = 0;
@@ -662,17 +680,19 @@ namespace clan
 		}
 		else
 		{
-			UTF8_Reader utf8_reader(text_lines[pos.y].data(), text_lines[pos.y].length());
+			std::string line = document.line(pos.y);
+			UTF8_Reader utf8_reader(line.data(), line.length());
 			utf8_reader.set_position(pos.x);
 
 			if (steps > 0)
 			{
 				for (int i = 0; i < steps; i++)
 				{
-					if (!stay_on_line && utf8_reader.get_position() == text_lines[pos.y].size() && pos.y + 1 != text_lines.size())
+					if (!stay_on_line && utf8_reader.get_position() == line.size() && (size_t)(pos.y + 1) != document.size())
 					{
 						pos.y++;
-						utf8_reader = UTF8_Reader(text_lines[pos.y].data(), text_lines[pos.y].length());
+						line = document.line(pos.y);
+						utf8_reader = UTF8_Reader(line.data(), line.length());
 						utf8_reader.set_position(0);
 					}
 					else
@@ -688,8 +708,9 @@ namespace clan
 					if (!stay_on_line && utf8_reader.get_position() == 0 && pos.y != 0)
 					{
 						pos.y--;
-						utf8_reader = UTF8_Reader(text_lines[pos.y].data(), text_lines[pos.y].length());
-						utf8_reader.set_position(text_lines[pos.y].length());
+						line = document.line(pos.y);
+						utf8_reader = UTF8_Reader(line.data(), line.length());
+						utf8_reader.set_position(line.length());
 					}
 					else
 					{
@@ -748,8 +769,8 @@ namespace clan
 		Vec2i pos = cursor_pos;
 
 		if (ctrl)
-			pos.y = text_lines.size() - 1;
-		pos.x = text_lines[pos.y].size();
+			pos.y = document.size() - 1;
+		pos.x = document.line_length(pos.y);
 
 		if (pos == cursor_pos)
 			return;
@@ -771,6 +792,9 @@ namespace clan
 
 	void TextViewImpl::backspace()
 	{
+		if (document.is_indexing())
+			return;
+
 		if (selection.start() != selection.end())
 		{
 			del();
@@ -779,12 +803,13 @@ namespace clan
 		{
 			save_undo();
 
-			UTF8_Reader utf8_reader(text_lines[cursor_pos.y].data(), text_lines[cursor_pos.y].length());
+			std::string &line = document.edit_line(cursor_pos.y);
+			UTF8_Reader utf8_reader(line.data(), line.length());
 			utf8_reader.set_position(cursor_pos.x);
 			utf8_reader.prev();
 			int new_cursor_pos = utf8_reader.get_position();
 
-			text_lines[cursor_pos.y].erase(text_lines[cursor_pos.y].begin() + new_cursor_pos, text_lines[cursor_pos.y].begin() + cursor_pos.x);
+			line.erase(line.begin() + new_cursor_pos, line.begin() + cursor_pos.x);
 			cursor_pos.x = new_cursor_pos;
 
 			textfield->set_needs_render();
@@ -794,10 +819,11 @@ namespace clan
 			save_undo();
 
 			cursor_pos.y--;
-			cursor_pos.x = text_lines[cursor_pos.y].length();
+			cursor_pos.x = document.line_length(cursor_pos.y);
 
-			text_lines[cursor_pos.y] += text_lines[cursor_pos.y + 1];
-			text_lines.erase(text_lines.begin() + cursor_pos.y + 1);
+			std::string next_line = document.line(cursor_pos.y + 1);
+			document.edit_line(cursor_pos.y) += next_line;
+			document.erase_lines(cursor_pos.y + 1, cursor_pos.y + 2);
 
 			textfield->set_needs_render();
 		}
@@ -805,6 +831,9 @@ namespace clan
 
 	void TextViewImpl::del()
 	{
+		if (document.is_indexing())
+			return;
+
 		if (selection.start() != selection.end())
 		{
 			save_undo();
@@ -814,13 +843,15 @@ namespace clan
 
 			if (start.y == end.y)
 			{
-				text_lines[start.y].erase(text_lines[start.y].begin() + start.x, text_lines[start.y].begin() + end.x);
+				std::string &line = document.edit_line(start.y);
+				line.erase(line.begin() + start.x, line.begin() + end.x);
 			}
 			else
 			{
-				text_lines[start.y].erase(text_lines[start.y].begin() + start.x, text_lines[start.y].end());
-				text_lines[end.y].erase(text_lines[end.y].begin(), text_lines[end.y].begin() + end.x);
-				text_lines.erase(text_lines.begin() + start.y + 1, text_lines.begin() + end.y);
+				document.edit_line(start.y).resize(start.x);
+				std::string &end_line = document.edit_line(end.y);
+				end_line.erase(end_line.begin(), end_line.begin() + end.x);
+				document.erase_lines(start.y + 1, end.y);
 			}
 
 			cursor_pos = start;
@@ -828,22 +859,24 @@ namespace clan
 
 			textfield->set_needs_render();
 		}
-		else if (cursor_pos.x < text_lines[cursor_pos.y].length())
+		else if (cursor_pos.x < document.line_length(cursor_pos.y))
 		{
 			save_undo();
 
-			UTF8_Reader utf8_reader(text_lines[cursor_pos.y].data(), text_lines[cursor_pos.y].length());
+			std::string &line = document.edit_line(cursor_pos.y);
+			UTF8_Reader utf8_reader(line.data(), line.length());
 			utf8_reader.set_position(cursor_pos.x);
-			text_lines[cursor_pos.y].erase(text_lines[cursor_pos.y].begin() + cursor_pos.x, text_lines[cursor_pos.y].begin() + cursor_pos.x + utf8_reader.get_char_length());
+			line.erase(line.begin() + cursor_pos.x, line.begin() + cursor_pos.x + utf8_reader.get_char_length());
 
 			textfield->set_needs_render();
 		}
-		else if (cursor_pos.y + 1 < text_lines.size())
+		else if (cursor_pos.y + 1 < document.size())
 		{
 			save_undo();
 
-			text_lines[cursor_pos.y] += text_lines[cursor_pos.y + 1];
-			text_lines.erase(text_lines.begin() + cursor_pos.y + 1);
+			std::string next_line = document.line(cursor_pos.y + 1);
+			document.edit_line(cursor_pos.y) += next_line;
+			document.erase_lines(cursor_pos.y + 1, cursor_pos.y + 2);
 
 			textfield->set_needs_render();
 		}
@@ -950,6 +983,9 @@ namespace clan
 
 	void TextViewImpl::add(std::string new_text)
 	{
+		if (document.is_indexing())
+			return;
+
 		if (selection.start() != selection.end())
 			del();
 
@@ -962,15 +998,17 @@ namespace clan
 			if (end == std::string::npos)
 				end = new_text.size();
 
-			text_lines[cursor_pos.y] = text_lines[cursor_pos.y].substr(0, cursor_pos.x) + new_text.substr(start, end - start) + text_lines[cursor_pos.y].substr(cursor_pos.x);
+			document.edit_line(cursor_pos.y).insert(cursor_pos.x, new_text, start, end - start);
 			cursor_pos.x += end - start;
 
 			if (end == new_text.size())
 				break;
 			start = end + 1;
 
-			text_lines.insert(text_lines.begin() + cursor_pos.y + 1, text_lines[cursor_pos.y].substr(cursor_pos.x));
-			text_lines[cursor_pos.y].resize(cursor_pos.x);
+			std::string &line = document.edit_line(cursor_pos.y);
+			std::string line_end = line.substr(cursor_pos.x);
+			line.resize(cursor_pos.x);
+			document.insert_line(cursor_pos.y + 1, line_end);
 			cursor_pos = Vec2i(0, cursor_pos.y + 1);
 		}
 
@@ -984,24 +1022,24 @@ namespace clan
 
 		if (start.y == end.y)
 		{
-			return text_lines[start.y].substr(start.x, end.x - start.x);
+			return document.line(start.y).substr(start.x, end.x - start.x);
 		}
 		else
 		{
-			size_t length = text_lines[start.y].length() - start.x + text_lines[end.y].length() - end.x + 1;
+			size_t length = document.line_length(start.y) - start.x + end.x + 1;
 			for (auto y = start.y + 1; y < end.y; y++)
-				length += text_lines[y].length() + 1;
+				length += document.line_length(y) + 1;
 
 			std::string result;
 			result.reserve(length);
-			result += text_lines[start.y].substr(start.x);
+			result += document.line(start.y).substr(start.x);
 			result.push_back('\n');
 			for (auto y = start.y + 1; y < end.y; y++)
 			{
-				result += text_lines[y];
+				result += document.line(y);
 				result.push_back('\n');
 			}
-			result += text_lines[end.y].substr(0, end.x);
+			result += document.line(end.y).substr(0, end.x);
 			return result;
 		}
 	}
@@ -1011,9 +1049,9 @@ namespace clan
 		Vec2i start = selection.start();
 
 		if ((size_t)start.y == line_index)
-			return text_lines[line_index].substr(0, start.x);
+			return document.line(line_index).substr(0, start.x);
 		else if ((size_t)start.y > line_index)
-			return text_lines[line_index];
+			return document.line(line_index);
 		else
 			return std::string();
 	}
@@ -1024,15 +1062,15 @@ namespace clan
 		Vec2i end = selection.end();
 
 		if (start.y == line_index && end.y == line_index)
-			return text_lines[line_index].substr(start.x, end.x - start.x);
+			return document.line(line_index).substr(start.x, end.x - start.x);
 		else if ((size_t)start.y > line_index || (size_t)end.y < line_index)
 			return std::string();
 		else if (start.y == line_index)
-			return text_lines[line_index].substr(start.x);
+			return document.line(line_index).substr(start.x);
 		else if (end.y == line_index)
-			return text_lines[line_index].substr(0, end.x);
+			return document.line(line_index).substr(0, end.x);
 		else
-			return text_lines[line_index];
+			return document.line(line_index);
 	}
 
 	std::string TextViewImpl::get_text_after_selection(size_t line_index) const
@@ -1040,21 +1078,22 @@ namespace clan
 		Vec2i end = selection.end();
 
 		if ((size_t)end.y == line_index)
-			return text_lines[line_index].substr(end.x);
+			return document.line(line_index).substr(end.x);
 		else if ((size_t)end.y < line_index)
-			return text_lines[line_index];
+			return document.line(line_index);
 		else
 			return std::string();
 	}
 
 	int TextViewImpl::find_next_break_character(int search_start, int line) const
 	{
-		if (search_start == text_lines[line].size())
+		std::string text = document.line(line);
+		if ((size_t)search_start == text.size())
 			return search_start;
 
-		size_t pos = text_lines[line].find_first_of(break_characters, search_start + 1);
+		size_t pos = text.find_first_of(break_characters, search_start + 1);
 		if (pos == std::string::npos)
-			return text_lines[line].size();
+			return text.size();
 		return pos;
 	}
 
@@ -1062,7 +1101,7 @@ namespace clan
 	{
 		if (search_start == 0)
 			return 0;
-		size_t pos = text_lines[line].find_last_of(break_characters, search_start - 1);
+		size_t pos = document.line(line).find_last_of(break_characters, search_start - 1);
 		if (pos == std::string::npos)
 			return 0;
 		return pos;
@@ -0,0 +1,267 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "UI/precomp.h"
+#include "text_view_document.h"
+#include "API/Core/System/work_queue.h"
+#include <algorithm>
+
+namespace clan
+{
+	namespace
+	{
+		WorkQueue &get_index_queue()
+		{
+			static WorkQueue queue(true);
+			return queue;
+		}
+	}
+
+	TextViewDocument::TextViewDocument()
+	{
+		set_text(std::string());
+	}
+
+	TextViewDocument::~TextViewDocument()
+	{
+		cancel_indexing();
+	}
+
+	void TextViewDocument::set_text(std::string text)
+	{
+		cancel_indexing();
+
+		original = std::make_shared<const std::string>(std::move(text));
+		original_line_starts.assign(1, 0);
+		edited_lines.clear();
+		pieces.clear();
+
+		// Index the first lines right away, so there is something to show
+		size_t pos = original->find('\n');
+		while (pos != std::string::npos && original_line_starts.size() <= index_batch_lines)
+		{
+			original_line_starts.push_back(pos + 1);
+			pos = original->find('\n', pos + 1);
+		}
+
+		if (pos == std::string::npos)
+		{
+			pieces.push_back({ false, 0, original_line_starts.size() });
+		}
+		else
+		{
+			// The last line start found is only complete once the next one, or the end of the text, is found
+			pieces.push_back({ false, 0, original_line_starts.size() - 1 });
+
+			std::shared_ptr<IndexState> state = std::make_shared<IndexState>();
+			std::shared_ptr<const std::string> text_buffer = original;
+			index_state = state;
+			get_index_queue().queue([state, text_buffer, pos]()
+			{
+				std::vector<size_t> found;
+				for (size_t newline_pos = pos; newline_pos != std::string::npos; newline_pos = text_buffer->find('\n', newline_pos + 1))
+				{
+					found.push_back(newline_pos + 1);
+					if (found.size() == index_batch_lines)
+					{
+						std::unique_lock<std::mutex> lock(state->mutex);
+						if (state->cancelled)
+							return;
+						state->line_starts.insert(state->line_starts.end(), found.begin(), found.end());
+						found.clear();
+					}
+				}
+
+				std::unique_lock<std::mutex> lock(state->mutex);
+				state->line_starts.insert(state->line_starts.end(), found.begin(), found.end());
+				state->done = true;
+			});
+		}
+
+		update_piece_starts(0);
+	}
+
+	std::string TextViewDocument::get_text() const
+	{
+		std::string text;
+		for (size_t i = 0; i < line_count; i++)
+		{
+			if (i != 0)
+				text.push_back('\n');
+			text += line(i);
+		}
+		return text;
+	}
+
+	bool TextViewDocument::update_index()
+	{
+		if (!index_state)
+			return false;
+
+		std::vector<size_t> found;
+		bool done;
+		{
+			std::unique_lock<std::mutex> lock(index_state->mutex);
+			found.swap(index_state->line_starts);
+			done = index_state->done;
+		}
+
+		// Pieces are not split while indexing, so the original text is a single piece
+		original_line_starts.insert(original_line_starts.end(), found.begin(), found.end());
+		pieces.front().count = done ? original_line_starts.size() : original_line_starts.size() - 1;
+		update_piece_starts(0);
+
+		if (done)
+			index_state.reset();
+		return !found.empty() || done;
+	}
+
+	std::string TextViewDocument::line(size_t index) const
+	{
+		size_t offset;
+		const Piece &piece = pieces[find_piece(index, offset)];
+		if (piece.edited)
+			return edited_lines[piece.first + offset];
+
+		size_t original_index = piece.first + offset;
+		size_t start = original_line_starts[original_index];
+		size_t end = original_index + 1 < original_line_starts.size() ? original_line_starts[original_index + 1] - 1 : original->size();
+		return original->substr(start, end - start);
+	}
+
+	size_t TextViewDocument::line_length(size_t index) const
+	{
+		size_t offset;
+		const Piece &piece = pieces[find_piece(index, offset)];
+		if (piece.edited)
+			return edited_lines[piece.first + offset].length();
+
+		size_t original_index = piece.first + offset;
+		size_t end = original_index + 1 < original_line_starts.size() ? original_line_starts[original_index + 1] - 1 : original->size();
+		return end - original_line_starts[original_index];
+	}
+
+	std::string &TextViewDocument::edit_line(size_t index)
+	{
+		size_t offset;
+		size_t piece_index = find_piece(index, offset);
+		if (pieces[piece_index].edited)
+			return edited_lines[pieces[piece_index].first + offset];
+
+		std::string text = line(index);
+		split_piece(index + 1);
+		split_piece(index);
+		piece_index = find_piece(index, offset);
+		pieces[piece_index] = { true, edited_lines.size(), 1 };
+		edited_lines.push_back(std::move(text));
+		return edited_lines.back();
+	}
+
+	void TextViewDocument::insert_line(size_t index, std::string text)
+	{
+		split_piece(index);
+		size_t piece_index = std::lower_bound(piece_starts.begin(), piece_starts.end(), index) - piece_starts.begin();
+		if (index == line_count)
+			piece_index = pieces.size();
+		pieces.insert(pieces.begin() + piece_index, { true, edited_lines.size(), 1 });
+		edited_lines.push_back(std::move(text));
+		update_piece_starts(piece_index);
+	}
+
+	void TextViewDocument::erase_lines(size_t first, size_t end)
+	{
+		if (first >= end)
+			return;
+
+		split_piece(end);
+		split_piece(first);
+		size_t first_piece = std::lower_bound(piece_starts.begin(), piece_starts.end(), first) - piece_starts.begin();
+		size_t end_piece = end == line_count ? pieces.size() : std::lower_bound(piece_starts.begin(), piece_starts.end(), end) - piece_starts.begin();
+		pieces.erase(pieces.begin() + first_piece, pieces.begin() + end_piece);
+		update_piece_starts(first_piece);
+	}
+
+	size_t TextViewDocument::find_piece(size_t index, size_t &offset) const
+	{
+		size_t piece_index = std::upper_bound(piece_starts.begin(), piece_starts.end(), index) - piece_starts.begin() - 1;
+		offset = index - piece_starts[piece_index];
+		return piece_index;
+	}
+
+	void TextViewDocument::split_piece(size_t index)
+	{
+		if (index == 0 || index >= line_count)
+			return;
+
+		size_t offset;
+		size_t piece_index = find_piece(index, offset);
+		if (offset == 0)
+			return;
+
+		Piece head = pieces[piece_index];
+		Piece tail = { head.edited, head.first + offset, head.count - offset };
+		head.count = offset;
+		pieces[piece_index] = head;
+		pieces.insert(pieces.begin() + piece_index + 1, tail);
+		update_piece_starts(piece_index);
+	}
+
+	void TextViewDocument::update_piece_starts(size_t first_piece)
+	{
+		// Pieces emptied by edits are removed, except a single empty piece of an empty document
+		for (size_t i = first_piece; i < pieces.size();)
+		{
+			if (pieces[i].count == 0 && pieces.size() > 1)
+				pieces.erase(pieces.begin() + i);
+			else
+				i++;
+		}
+		if (pieces.empty())
+			pieces.push_back({ true, edited_lines.size(), 0 });
+
+		first_piece = std::min(first_piece, pieces.size() - 1);
+		piece_starts.resize(pieces.size());
+		size_t start = first_piece > 0 ? piece_starts[first_piece - 1] + pieces[first_piece - 1].count : 0;
+		for (size_t i = first_piece; i < pieces.size(); i++)
+		{
+			piece_starts[i] = start;
+			start += pieces[i].count;
+		}
+		line_count = start;
+	}
+
+	void TextViewDocument::cancel_indexing()
+	{
+		if (index_state)
+		{
+			std::unique_lock<std::mutex> lock(index_state->mutex);
+			index_state->cancelled = true;
+		}
+		index_state.reset();
+	}
+}
@@ -0,0 +1,106 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace clan
+{
+	/// \brief Lines of text edited by a TextView
+	///
+	/// The document is a piece table over lines. The text passed to set_text() is kept as a single buffer and
+	/// is never modified. Edited lines are stored separately and pieces refer to runs of lines in either.
+	/// Texts with more than index_batch_lines lines have the rest of their line index built in the background.
+	/// Until update_index() reports completion, the document holds the lines found so far and must not be edited.
+	class TextViewDocument
+	{
+	public:
+		TextViewDocument();
+		~TextViewDocument();
+
+		void set_text(std::string text);
+		std::string get_text() const;
+
+		/// \brief Number of lines, or the number indexed so far while indexing
+		size_t size() const { return line_count; }
+
+		/// \brief Returns true while the background indexer has not found all lines
+		bool is_indexing() const { return !!index_state; }
+
+		/// \brief Adds the lines found by the background indexer. Returns true if the document changed.
+		bool update_index();
+
+		std::string line(size_t index) const;
+		size_t line_length(size_t index) const;
+
+		/// \brief Returns a line for editing, moving it out of the original text if required
+		std::string &edit_line(size_t index);
+
+		void insert_line(size_t index, std::string text);
+		void erase_lines(size_t first, size_t end);
+
+	private:
+		/// \brief Run of lines in the original text (line index) or in the edited lines
+		struct Piece
+		{
+			bool edited;
+			size_t first;
+			size_t count;
+		};
+
+		/// \brief State shared with the background indexer, which may outlive the document
+		struct IndexState
+		{
+			std::mutex mutex;
+			bool cancelled = false;
+			bool done = false;
+			std::vector<size_t> line_starts;	// Found since the last update_index()
+		};
+
+		size_t find_piece(size_t index, size_t &offset) const;
+		void split_piece(size_t index);	// Makes a piece start at line index
+		void update_piece_starts(size_t first_piece);
+		void cancel_indexing();
+
+		std::shared_ptr<const std::string> original;
+		std::vector<size_t> original_line_starts;
+		std::vector<std::string> edited_lines;
+
+		std::vector<Piece> pieces;
+		std::vector<size_t> piece_starts;	// Index of the first line of each piece
+		size_t line_count = 0;
+
+		std::shared_ptr<IndexState> index_state;
+
+		static const size_t index_batch_lines = 65536;	// Lines indexed right away, and per background batch
+	};
+}
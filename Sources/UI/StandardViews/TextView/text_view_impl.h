@@ -32,6 +32,7 @@
 #include "API/UI/Events/key_event.h"
 #include "API/Display/System/timer.h"
 #include "API/Display/Font/font.h"
+#include "text_view_document.h"
 
 namespace clan
 {
@@ -107,6 +108,8 @@ namespace clan
 		void redo();
 		void add(std::string new_text);
 
+		void start_indexing_updates();
+
 		void start_blink();
 		void stop_blink();
 
@@ -120,7 +123,7 @@ namespace clan
 		Font font; // Do not use directly. Use get_font.
 
 		Size preferred_size = Size(20, 5);
-		std::vector<std::string> text_lines;
+		TextViewDocument document;
 		std::string placeholder;
 
 		Signal<void(KeyEvent &)> sig_before_edit_changed;
@@ -137,6 +140,7 @@ namespace clan
 
 		bool cursor_blink_visible = false;
 		Timer blink_timer;
+		Timer index_timer;	// Polls the document while its lines are being indexed
 		bool mouse_moves_left = false;
 		Timer scroll_timer;
 		bool ignore_mouse_events = false;
@@ -155,6 +159,7 @@ namespace clan
 		bool needs_new_undo_step = true;
 
 		static const std::string break_characters;
+		static const int viewport_margin_lines = 4;	// Lines measured and drawn beyond each edge of the view
 
 		std::vector<Rectf> last_measured_rects;
 
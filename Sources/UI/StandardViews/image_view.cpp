@@ -32,6 +32,7 @@
 #include "API/Display/2D/image.h"
 #include "API/Display/2D/canvas.h"
 #include <algorithm>
+#include <cmath>
 
 namespace clan
 {
@@ -41,23 +42,70 @@ namespace clan
 	class ImageViewImpl
 	{
 	public:
+		ImageView *view = nullptr;
+
 		std::shared_ptr<ImageSource> image;
 		std::shared_ptr<ImageSource> highlighted_image;
 		Image canvas_image;
 		Image canvas_highlighted_image;
 
+		Slot image_ready_slot;
+		Slot highlighted_image_ready_slot;
+
 		void get_images(Canvas &canvas)
 		{
-			if (canvas_image.is_null() && image)
-				canvas_image = image->get_image(canvas);
+			get_image(canvas, image, canvas_image);
+			get_image(canvas, highlighted_image, canvas_highlighted_image);
+		}
+
+		// Asynchronous sources are only asked for an image when the view is drawn, and then at the size it is drawn at
+		void get_visible_images(Canvas &canvas, const Size &display_size)
+		{
+			get_visible_image(canvas, display_size, image, canvas_image);
+			get_visible_image(canvas, display_size, highlighted_image, canvas_highlighted_image);
+		}
+
+		Slot connect_image_ready(const std::shared_ptr<ImageSource> &source)
+		{
+			if (!source || !source->is_async())
+				return Slot();
+
+			return source->sig_image_ready().connect([this]()
+			{
+				view->set_needs_render();
+				view->set_needs_layout();
+			});
+		}
 
-			if (canvas_highlighted_image.is_null() && highlighted_image)
-				canvas_highlighted_image = highlighted_image->get_image(canvas);
+	private:
+		static void get_image(Canvas &canvas, const std::shared_ptr<ImageSource> &source, Image &canvas_image)
+		{
+			if (canvas_image.is_null() && source && !source->is_async())
+				canvas_image = source->get_image(canvas);
+		}
+
+		static void get_visible_image(Canvas &canvas, const Size &display_size, const std::shared_ptr<ImageSource> &source, Image &canvas_image)
+		{
+			if (!source)
+				return;
+
+			if (source->is_async())
+			{
+				// Keep showing the previous image until the one for the new size is decoded
+				Image decoded = source->get_image(canvas, display_size);
+				if (!decoded.is_null())
+					canvas_image = decoded;
+			}
+			else if (canvas_image.is_null())
+			{
+				canvas_image = source->get_image(canvas);
+			}
 		}
 	};
 
 	ImageView::ImageView() : impl(std::make_shared<ImageViewImpl>())
 	{
+		impl->view = this;
 	}
 
 	std::shared_ptr<ImageSource> ImageView::image()
@@ -69,6 +117,7 @@ namespace clan
 	{
 		impl->image = image;
 		impl->canvas_image = Image();
+		impl->image_ready_slot = impl->connect_image_ready(image);
 		set_needs_render();
 		set_needs_layout();
 	}
@@ -87,6 +136,7 @@ namespace clan
 	{
 		impl->highlighted_image = image;
 		impl->canvas_highlighted_image = Image();
+		impl->highlighted_image_ready_slot = impl->connect_image_ready(image);
 		set_needs_render();
 		set_needs_layout();
 	}
@@ -98,7 +148,8 @@ namespace clan
 
 	void ImageView::render_content(Canvas &canvas)
 	{
-		impl->get_images(canvas);
+		float pixel_ratio = canvas.get_pixel_ratio();
+		impl->get_visible_images(canvas, Size((int)std::ceil(geometry().content_width * pixel_ratio), (int)std::ceil(geometry().content_height * pixel_ratio)));
 
 		if (!impl->canvas_image.is_null() && impl->canvas_image.get_width() != 0.0f && impl->canvas_image.get_height() != 0.0f)
 		{
@@ -107,7 +158,7 @@ namespace clan
 			float scale = std::min(scale_x, scale_y);
 
 			float width = impl->canvas_image.get_width() * scale;
-			float height = impl->canvas_image.get_width() * scale;
+			float height = impl->canvas_image.get_height() * scale;
 
 			impl->canvas_image.draw(canvas, Rectf::xywh((geometry().content_width - width) * 0.5f, (geometry().content_height - height) * 0.5f, width, height));
 		}
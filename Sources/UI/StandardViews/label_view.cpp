@@ -141,7 +141,7 @@ namespace clan
 				return; // Still no room.  Draw nothing!
 		}
 
-		Colorf color = style_cascade().computed_value("color").color();
+		Colorf color = style_cascade().computed_value(StylePropertyId::color).color();
 
 		if (impl->text_alignment == TextAlignment::left)
 		{
@@ -159,24 +159,24 @@ namespace clan
 
 	float LabelView::calculate_preferred_width(Canvas &canvas)
 	{
-		if (style_cascade().computed_value("width").is_keyword("auto"))
+		if (style_cascade().computed_value(StylePropertyId::width).is_keyword("auto"))
 		{
 			Font font = impl->get_font(this, canvas);
 			return font.measure_text(canvas, impl->_text).advance.width + 1.0f;
 		}
 		else
-			return style_cascade().computed_value("width").number();
+			return style_cascade().computed_value(StylePropertyId::width).number();
 	}
 
 	float LabelView::calculate_preferred_height(Canvas &canvas, float width)
 	{
-		if (style_cascade().computed_value("height").is_keyword("auto"))
+		if (style_cascade().computed_value(StylePropertyId::height).is_keyword("auto"))
 		{
 			Font font = impl->get_font(this, canvas);
 			return font.get_font_metrics(canvas).get_line_height();
 		}
 		else
-			return style_cascade().computed_value("height").number();
+			return style_cascade().computed_value(StylePropertyId::height).number();
 	}
 
 	float LabelView::calculate_first_baseline_offset(Canvas &canvas, float width)
@@ -49,7 +49,7 @@ namespace clan
 				geometry.content_y = 0.0f;
 				view->set_geometry(geometry);
 
-				view->layout_subviews(canvas); // Maybe this should be handled in View?
+				view->layout_subviews_if_needed(canvas);
 			}
 		}
 	};
@@ -65,6 +65,7 @@ namespace clan
 		ContentOverflow overflow_x = ContentOverflow::hidden;
 		ContentOverflow overflow_y = ContentOverflow::automatic;
 		Pointf content_offset;
+		Signal<void()> sig_content_offset_changed;
 	};
 
 	ScrollView::ScrollView() : impl(new ScrollViewImpl())
@@ -81,6 +82,9 @@ namespace clan
 		impl->content_container->set_content_clipped(true);
 		impl->content_container->add_subview(impl->content);
 
+		// Scrolling only moves the tiles, and only newly exposed tiles are rendered
+		impl->content->set_layer_tiled(true);
+
 		add_subview(impl->content_container);
 		add_subview(impl->scroll_x);
 		add_subview(impl->scroll_y);
@@ -163,6 +167,17 @@ namespace clan
 		
 		impl->content_offset = offset;
 		impl->content->set_view_transform(Mat4f::translate(-offset.x, -offset.y, 0.0f));
+
+		// Keep the scroll bars in sync when the offset is set programmatically. This does not emit sig_scroll.
+		impl->scroll_x->set_position(offset.x);
+		impl->scroll_y->set_position(offset.y);
+
+		impl->sig_content_offset_changed();
+	}
+
+	Signal<void()> &ScrollView::sig_content_offset_changed()
+	{
+		return impl->sig_content_offset_changed;
 	}
 	
 	void ScrollView::layout_subviews(Canvas &canvas)
@@ -216,15 +231,15 @@ namespace clan
 		
 		impl->content_container->set_geometry(ViewGeometry::from_margin_box(impl->content_container->style_cascade(), Rectf(0.0f, 0.0f, content_view_width, content_view_height)));
 
-		impl->scroll_x->layout_subviews(canvas);
-		impl->scroll_y->layout_subviews(canvas);
-		impl->content_container->layout_subviews(canvas);
+		impl->scroll_x->layout_subviews_if_needed(canvas);
+		impl->scroll_y->layout_subviews_if_needed(canvas);
+		impl->content_container->layout_subviews_if_needed(canvas);
 	}
 	
 	float ScrollView::calculate_preferred_width(Canvas &canvas)
 	{
-		if (style_cascade().computed_value("width").is_length())
-			return style_cascade().computed_value("width").number();
+		if (style_cascade().computed_value(StylePropertyId::width).is_length())
+			return style_cascade().computed_value(StylePropertyId::width).number();
 		
 		float width = impl->content_container->get_preferred_width(canvas);
 		if (impl->overflow_x == ContentOverflow::scroll)
@@ -234,8 +249,8 @@ namespace clan
 	
 	float ScrollView::calculate_preferred_height(Canvas &canvas, float width)
 	{
-		if (style_cascade().computed_value("height").is_length())
-			return style_cascade().computed_value("height").number();
+		if (style_cascade().computed_value(StylePropertyId::height).is_length())
+			return style_cascade().computed_value(StylePropertyId::height).number();
 		
 		float height = impl->content_container->get_preferred_height(canvas, width);
 		if (impl->overflow_y == ContentOverflow::scroll)
@@ -28,6 +28,7 @@
 
 #include "UI/precomp.h"
 #include "API/UI/Style/style.h"
+#include "API/UI/Style/style_cascade.h"
 #include "style_impl.h"
 #include "Properties/background.h"
 #include "Properties/border.h"
@@ -68,6 +69,7 @@ namespace clan
 
 	Style::~Style()
 	{
+		StyleCascade::invalidate_computed_values();
 	}
 
 	void Style::set(const std::string &properties)
@@ -75,39 +77,43 @@ namespace clan
 		StyleProperty::parse(impl.get(), properties);
 	}
 
-	StyleGetValue Style::declared_value(const char *property_name_str) const
+	StyleGetValue Style::declared_value(const char *property_name) const
 	{
-		StyleString property_name = property_name_str;
-		const auto it = impl->prop_type.find(property_name);
-		if (it != impl->prop_type.end())
+		return declared_value(StyleProperty::find_id(property_name));
+	}
+
+	StyleGetValue Style::declared_value(StylePropertyId id) const
+	{
+		const StyleImplValue *value = impl->find_value(id);
+		if (value)
 		{
-			switch (it->second)
+			switch (value->type)
 			{
 				default:
 				case StyleValueType::undefined:
 					return StyleGetValue();
 				case StyleValueType::keyword:
-					return StyleGetValue::from_keyword(impl->prop_text.find(property_name)->second.c_str());
+					return StyleGetValue::from_keyword(value->text.c_str());
 				case StyleValueType::string:
-					return StyleGetValue::from_string(impl->prop_text.find(property_name)->second.c_str());
+					return StyleGetValue::from_string(value->text.c_str());
 				case StyleValueType::url:
-					return StyleGetValue::from_url(impl->prop_text.find(property_name)->second.c_str());
+					return StyleGetValue::from_url(value->text.c_str());
 				case StyleValueType::length:
-					return StyleGetValue::from_length(impl->prop_number.find(property_name)->second, impl->prop_dimension.find(property_name)->second);
+					return StyleGetValue::from_length(value->number, value->dimension);
 				case StyleValueType::angle:
-					return StyleGetValue::from_angle(impl->prop_number.find(property_name)->second, impl->prop_dimension.find(property_name)->second);
+					return StyleGetValue::from_angle(value->number, value->dimension);
 				case StyleValueType::time:
-					return StyleGetValue::from_time(impl->prop_number.find(property_name)->second, impl->prop_dimension.find(property_name)->second);
+					return StyleGetValue::from_time(value->number, value->dimension);
 				case StyleValueType::frequency:
-					return StyleGetValue::from_frequency(impl->prop_number.find(property_name)->second, impl->prop_dimension.find(property_name)->second);
+					return StyleGetValue::from_frequency(value->number, value->dimension);
 				case StyleValueType::resolution:
-					return StyleGetValue::from_resolution(impl->prop_number.find(property_name)->second, impl->prop_dimension.find(property_name)->second);
+					return StyleGetValue::from_resolution(value->number, value->dimension);
 				case StyleValueType::percentage:
-					return StyleGetValue::from_percentage(impl->prop_number.find(property_name)->second);
+					return StyleGetValue::from_percentage(value->number);
 				case StyleValueType::number:
-					return StyleGetValue::from_number(impl->prop_number.find(property_name)->second);
+					return StyleGetValue::from_number(value->number);
 				case StyleValueType::color:
-					return StyleGetValue::from_color(impl->prop_color.find(property_name)->second);
+					return StyleGetValue::from_color(value->color);
 			}
 		}
 		return StyleGetValue();
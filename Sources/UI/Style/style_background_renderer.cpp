@@ -50,15 +50,17 @@ namespace clan
 
 		int num_layers = style.array_size("background-image");
 
-		StyleGetValue bg_color = style.computed_value("background-color");
+		StyleGetValue bg_color = style.computed_value(StylePropertyId::background_color);
 		if (bg_color.is_color() && bg_color.color().a != 0.0f)
 		{
-			auto border_points = get_border_points();
-
 			// To do: take get_layer_clip(num_layers - 1) into account
 
-			Path background_area = get_border_area_path(border_points);
-			background_area.fill(canvas, Brush(bg_color.color()));
+			Vec4f radii;
+			if (!get_circular_radii(radii) || !canvas.fill_rounded_box(geometry.border_box(), radii, Vec4f(0.0f), bg_color.color(), Colorf::transparent))
+			{
+				Path background_area = get_border_area_path(get_border_points());
+				background_area.fill(canvas, Brush(bg_color.color()));
+			}
 		}
 
 		for (int index = num_layers - 1; index >= 0; index--)
@@ -243,8 +245,6 @@ namespace clan
 		if (gradient_length <= 0.0f)
 			return;
 
-		Path border_area_path = get_border_area_path(get_border_points());
-
 		float last_position = 0.0f;
 		for (int stop_index = 0; stop_index < num_stops; stop_index++)
 		{
@@ -275,7 +275,12 @@ namespace clan
 			brush.stops.push_back(BrushGradientStop(prop_color.color(), position));
 		}
 
-		border_area_path.fill(canvas, brush);
+		// Plain boxes are drawn by the triangle batcher, with the stops baked into the gradient atlas
+		Vec4f radii;
+		if (get_circular_radii(radii) && radii == Vec4f(0.0f))
+			canvas.fill_rect(geometry.border_box(), brush);
+		else
+			get_border_area_path(get_border_points()).fill(canvas, brush);
 	}
 
 	void StyleBackgroundRenderer::render_background_radial_gradient(int index)
@@ -299,16 +304,24 @@ namespace clan
 		if (!get_layer_clip(num_layers - 1).is_keyword("border-box"))
 			return;
 
-		StyleGetValue style_top = style.computed_value("border-top-style");
+		StyleGetValue style_top = style.computed_value(StylePropertyId::border_top_style);
 		if (style_top.is_keyword("solid"))
 		{
-			Colorf color = style.computed_value("border-top-color").color();
+			Colorf color = style.computed_value(StylePropertyId::border_top_color).color();
 			if (color.a > 0.0f)
 			{
-				auto border_points = get_border_points();
-				auto padding_points = get_padding_points(border_points);
-				Path border_path = get_border_stroke_path(border_points, padding_points);
-				border_path.fill(canvas, Brush(color));
+				Rectf border_box = geometry.border_box();
+				Rectf padding_box = geometry.padding_box();
+				Vec4f border_widths(padding_box.left - border_box.left, padding_box.top - border_box.top, border_box.right - padding_box.right, border_box.bottom - padding_box.bottom);
+
+				Vec4f radii;
+				if (!get_circular_radii(radii) || !canvas.fill_rounded_box(border_box, radii, border_widths, Colorf::transparent, color))
+				{
+					auto border_points = get_border_points();
+					auto padding_points = get_padding_points(border_points);
+					Path border_path = get_border_stroke_path(border_points, padding_points);
+					border_path.fill(canvas, Brush(color));
+				}
 			}
 		}
 	}
@@ -548,14 +561,14 @@ namespace clan
 
 	std::array<Pointf, 2 * 4> StyleBackgroundRenderer::get_border_points()
 	{
-		float top_left_x = get_horizontal_radius(style.computed_value("border-top-left-radius-x"));
-		float top_left_y = get_vertical_radius(style.computed_value("border-top-left-radius-y"));
-		float top_right_x = get_horizontal_radius(style.computed_value("border-top-right-radius-x"));
-		float top_right_y = get_vertical_radius(style.computed_value("border-top-right-radius-y"));
-		float bottom_left_x = get_horizontal_radius(style.computed_value("border-bottom-left-radius-x"));
-		float bottom_left_y = get_vertical_radius(style.computed_value("border-bottom-left-radius-y"));
-		float bottom_right_x = get_horizontal_radius(style.computed_value("border-bottom-right-radius-x"));
-		float bottom_right_y = get_vertical_radius(style.computed_value("border-bottom-right-radius-y"));
+		float top_left_x = get_horizontal_radius(style.computed_value(StylePropertyId::border_top_left_radius_x));
+		float top_left_y = get_vertical_radius(style.computed_value(StylePropertyId::border_top_left_radius_y));
+		float top_right_x = get_horizontal_radius(style.computed_value(StylePropertyId::border_top_right_radius_x));
+		float top_right_y = get_vertical_radius(style.computed_value(StylePropertyId::border_top_right_radius_y));
+		float bottom_left_x = get_horizontal_radius(style.computed_value(StylePropertyId::border_bottom_left_radius_x));
+		float bottom_left_y = get_vertical_radius(style.computed_value(StylePropertyId::border_bottom_left_radius_y));
+		float bottom_right_x = get_horizontal_radius(style.computed_value(StylePropertyId::border_bottom_right_radius_x));
+		float bottom_right_y = get_vertical_radius(style.computed_value(StylePropertyId::border_bottom_right_radius_y));
 
 		Rectf border_box = geometry.border_box();
 
@@ -753,6 +766,9 @@ namespace clan
 		Rectf border_box = geometry.border_box();
 		auto border_points = get_border_points();
 
+		Vec4f radii;
+		bool circular_corners = get_circular_radii(radii);
+
 		for (int index = num_shadows - 1; index >= 0; index--)
 		{
 			auto layer_style = style.computed_value("box-shadow-style[" + StringHelp::int_to_text(index) + "]");
@@ -779,16 +795,19 @@ namespace clan
 			Colorf transparent = shadow_color;
 			transparent.a = 0.0f;
 
+			if (shadow_blur_radius > 0.0f && circular_corners && canvas.fill_box_shadow(border_box, radii, shadow_blur_radius, shadow_color))
+				continue;
+
 			float kappa = 0.552228474f;
 
-			float top_left_x = get_horizontal_radius(style.computed_value("border-top-left-radius-x"));
-			float top_left_y = get_vertical_radius(style.computed_value("border-top-left-radius-y"));
-			float top_right_x = get_horizontal_radius(style.computed_value("border-top-right-radius-x"));
-			float top_right_y = get_vertical_radius(style.computed_value("border-top-right-radius-y"));
-			float bottom_left_x = get_horizontal_radius(style.computed_value("border-bottom-left-radius-x"));
-			float bottom_left_y = get_vertical_radius(style.computed_value("border-bottom-left-radius-y"));
-			float bottom_right_x = get_horizontal_radius(style.computed_value("border-bottom-right-radius-x"));
-			float bottom_right_y = get_vertical_radius(style.computed_value("border-bottom-right-radius-y"));
+			float top_left_x = get_horizontal_radius(style.computed_value(StylePropertyId::border_top_left_radius_x));
+			float top_left_y = get_vertical_radius(style.computed_value(StylePropertyId::border_top_left_radius_y));
+			float top_right_x = get_horizontal_radius(style.computed_value(StylePropertyId::border_top_right_radius_x));
+			float top_right_y = get_vertical_radius(style.computed_value(StylePropertyId::border_top_right_radius_y));
+			float bottom_left_x = get_horizontal_radius(style.computed_value(StylePropertyId::border_bottom_left_radius_x));
+			float bottom_left_y = get_vertical_radius(style.computed_value(StylePropertyId::border_bottom_left_radius_y));
+			float bottom_right_x = get_horizontal_radius(style.computed_value(StylePropertyId::border_bottom_right_radius_x));
+			float bottom_right_y = get_vertical_radius(style.computed_value(StylePropertyId::border_bottom_right_radius_y));
 
 			if (shadow_blur_radius != 0.0f)
 			{
@@ -952,6 +971,20 @@ namespace clan
 		return a * (1.0f - t) + b * t;
 	}
 
+	bool StyleBackgroundRenderer::get_circular_radii(Vec4f &radii) const
+	{
+		radii.x = get_horizontal_radius(style.computed_value(StylePropertyId::border_top_left_radius_x));
+		radii.y = get_horizontal_radius(style.computed_value(StylePropertyId::border_top_right_radius_x));
+		radii.z = get_horizontal_radius(style.computed_value(StylePropertyId::border_bottom_right_radius_x));
+		radii.w = get_horizontal_radius(style.computed_value(StylePropertyId::border_bottom_left_radius_x));
+
+		return
+			radii.x == get_vertical_radius(style.computed_value(StylePropertyId::border_top_left_radius_y)) &&
+			radii.y == get_vertical_radius(style.computed_value(StylePropertyId::border_top_right_radius_y)) &&
+			radii.z == get_vertical_radius(style.computed_value(StylePropertyId::border_bottom_right_radius_y)) &&
+			radii.w == get_vertical_radius(style.computed_value(StylePropertyId::border_bottom_left_radius_y));
+	}
+
 	float StyleBackgroundRenderer::get_horizontal_radius(const StyleGetValue &border_radius) const
 	{
 		if (border_radius.is_length())
@@ -72,6 +72,8 @@ namespace clan
 		StyleGetValue get_layer_repeat_x(int index);
 		StyleGetValue get_layer_repeat_y(int index);
 
+		/// \brief Gets the corner radii for Canvas::fill_rounded_box. Returns false if a corner is elliptical.
+		bool get_circular_radii(Vec4f &radii) const;
 		float get_horizontal_radius(const StyleGetValue &border_radius) const;
 		float get_vertical_radius(const StyleGetValue &border_radius) const;
 		Colorf get_light_color(const StyleGetValue &border_color) const;
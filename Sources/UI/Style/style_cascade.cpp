@@ -39,11 +39,66 @@
 
 namespace clan
 {
+	class StyleComputedCache
+	{
+	public:
+		/// Properties read for every view during layout and rendering come first in StylePropertyId
+		enum { max_slots = (int)StylePropertyId::background_color + 1 };
+		static_assert(max_slots <= 64, "Too many cached style properties");
+
+		static unsigned int global_generation;
+
+		unsigned int generation = 0;
+		uint64_t valid_mask = 0;
+		StyleGetValue values[max_slots];
+	};
+
+	unsigned int StyleComputedCache::global_generation = 1;
+
+	/////////////////////////////////////////////////////////////////////////
+
+	StyleCascade::StyleCascade()
+	{
+	}
+
+	StyleCascade::StyleCascade(std::vector<Style *> cascade, const StyleCascade *parent) : cascade(std::move(cascade)), parent(parent)
+	{
+	}
+
+	StyleCascade::StyleCascade(const StyleCascade &that) : cascade(that.cascade), parent(that.parent)
+	{
+	}
+
+	StyleCascade::~StyleCascade()
+	{
+	}
+
+	StyleCascade &StyleCascade::operator=(const StyleCascade &that)
+	{
+		cascade = that.cascade;
+		parent = that.parent;
+		invalidate_computed_values();
+		return *this;
+	}
+
+	void StyleCascade::invalidate_computed_values()
+	{
+		StyleComputedCache::global_generation++;
+	}
+
 	StyleGetValue StyleCascade::cascade_value(const char *property_name) const
 	{
+		return cascade_value(StyleProperty::find_id(property_name));
+	}
+
+	StyleGetValue StyleCascade::cascade_value(StylePropertyId id) const
+	{
+		if (id == StylePropertyId::invalid)
+			return StyleGetValue();
+
 		for (Style *style : cascade)
 		{
-			StyleGetValue value = style->declared_value(property_name);
+			StyleGetValue value = style->declared_value(id);
 			if (!value.is_undefined())
 				return value;
 		}
@@ -52,15 +107,20 @@ namespace clan
 
 	StyleGetValue StyleCascade::specified_value(const char *property_name) const
 	{
-		StyleGetValue value = cascade_value(property_name);
-		bool inherit = (value.is_undefined() && StyleProperty::is_inherited(property_name)) || value.is_keyword("inherit");
+		return specified_value(StyleProperty::find_id(property_name));
+	}
+
+	StyleGetValue StyleCascade::specified_value(StylePropertyId id) const
+	{
+		StyleGetValue value = cascade_value(id);
+		bool inherit = (value.is_undefined() && StyleProperty::is_inherited(id)) || value.is_keyword("inherit");
 		if (inherit && parent)
 		{
-			return parent->computed_value(property_name);
+			return parent->computed_value(id);
 		}
 		else if (value.is_undefined() || value.is_keyword("initial") || value.is_keyword("inherit"))
 		{
-			return StyleProperty::default_value(property_name);
+			return StyleProperty::default_value(id);
 		}
 		else
 		{
@@ -69,10 +129,40 @@ namespace clan
 	}
 
 	StyleGetValue StyleCascade::computed_value(const char *property_name) const
+	{
+		return computed_value(StyleProperty::find_id(property_name));
+	}
+
+	StyleGetValue StyleCascade::computed_value(StylePropertyId id) const
+	{
+		int slot = (int)id;
+		if (slot < 0 || slot >= StyleComputedCache::max_slots)
+			return uncached_computed_value(id);
+
+		if (!computed_cache)
+			computed_cache.reset(new StyleComputedCache());
+
+		StyleComputedCache &cache = *computed_cache;
+		if (cache.generation != StyleComputedCache::global_generation)
+		{
+			cache.generation = StyleComputedCache::global_generation;
+			cache.valid_mask = 0;
+		}
+
+		uint64_t slot_bit = ((uint64_t)1) << slot;
+		if ((cache.valid_mask & slot_bit) == 0)
+		{
+			cache.values[slot] = uncached_computed_value(id);
+			cache.valid_mask |= slot_bit;
+		}
+		return cache.values[slot];
+	}
+
+	StyleGetValue StyleCascade::uncached_computed_value(StylePropertyId id) const
 	{
 		// To do: pass on to property compute functions
 
-		StyleGetValue specified = specified_value(property_name);
+		StyleGetValue specified = specified_value(id);
 		switch (specified.type())
 		{
 		case StyleValueType::length:
@@ -108,9 +198,9 @@ namespace clan
 		case StyleDimension::pc:
 			return StyleGetValue::from_length(length.number() * (float)(12.0 * 96.0 / 72.0));
 		case StyleDimension::em:
-			return StyleGetValue::from_length(computed_value("font-size").number() * length.number());
+			return StyleGetValue::from_length(computed_value(StylePropertyId::font_size).number() * length.number());
 		case StyleDimension::ex:
-			return StyleGetValue::from_length(computed_value("font-size").number() * length.number() * 0.5f);
+			return StyleGetValue::from_length(computed_value(StylePropertyId::font_size).number() * length.number() * 0.5f);
 		}
 	}
 
@@ -185,12 +275,12 @@ namespace clan
 
 	Font StyleCascade::get_font(Canvas &canvas) const
 	{
-		auto font_size = computed_value("font-size");
-		auto line_height = computed_value("line-height");
-		auto font_weight = computed_value("font-weight");
-		auto font_style = computed_value("font-style");
-		//auto font_variant = computed_value("font-variant"); // To do: needs FontDescription support
-		auto font_rendering = computed_value("-clan-font-rendering");
+		auto font_size = computed_value(StylePropertyId::font_size);
+		auto line_height = computed_value(StylePropertyId::line_height);
+		auto font_weight = computed_value(StylePropertyId::font_weight);
+		auto font_style = computed_value(StylePropertyId::font_style);
+		//auto font_variant = computed_value(StylePropertyId::font_variant); // To do: needs FontDescription support
+		auto font_rendering = computed_value(StylePropertyId::clan_font_rendering);
 		auto font_family_name = computed_value("font-family-names[0]");
 
 		FontDescription font_desc;
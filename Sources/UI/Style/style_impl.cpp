@@ -28,76 +28,57 @@
 
 #include "UI/precomp.h"
 #include "API/UI/Style/style.h"
+#include "API/UI/Style/style_cascade.h"
 #include "style_impl.h"
 
 namespace clan
 {
 	void StyleImpl::set_value(const std::string &name, const StyleSetValue &value)
 	{
-		auto type_it = prop_type.find(name);
-		if (type_it != prop_type.end() && type_it->second != value.type)
+		set_value(StyleProperty::intern_id(name), value);
+	}
+
+	void StyleImpl::set_value(StylePropertyId id, const StyleSetValue &value)
+	{
+		StyleCascade::invalidate_computed_values();
+
+		auto it = std::lower_bound(values.begin(), values.end(), id, [](const StyleImplValue &a, StylePropertyId b) { return a.id < b; });
+		if (value.type == StyleValueType::undefined)
 		{
-			switch (type_it->second)
-			{
-			default:
-			case StyleValueType::undefined:
-				break;
-			case StyleValueType::keyword:
-			case StyleValueType::string:
-			case StyleValueType::url:
-				prop_text.erase(prop_text.find(name));
-				break;
-			case StyleValueType::length:
-			case StyleValueType::angle:
-			case StyleValueType::time:
-			case StyleValueType::frequency:
-			case StyleValueType::resolution:
-				prop_dimension.erase(prop_dimension.find(name));
-				prop_number.erase(prop_number.find(name));
-				break;
-			case StyleValueType::percentage:
-			case StyleValueType::number:
-				prop_number.erase(prop_number.find(name));
-				break;
-			case StyleValueType::color:
-				prop_color.erase(prop_color.find(name));
-				break;
-			}
+			if (it != values.end() && it->id == id)
+				values.erase(it);
+			return;
 		}
 
-		if (value.type != StyleValueType::undefined)
-			prop_type[name] = value.type;
-		else if (type_it != prop_type.end())
-			prop_type.erase(type_it);
+		if (it == values.end() || it->id != id)
+		{
+			it = values.insert(it, StyleImplValue());
+			it->id = id;
+		}
 
+		it->type = value.type;
+		it->number = value.number;
+		it->dimension = value.dimension;
+		it->color = value.color;
 		switch (value.type)
 		{
-		default:
-		case StyleValueType::undefined:
-			break;
 		case StyleValueType::keyword:
 		case StyleValueType::string:
 		case StyleValueType::url:
-			prop_text[name] = value.text;
-			break;
-		case StyleValueType::length:
-		case StyleValueType::angle:
-		case StyleValueType::time:
-		case StyleValueType::frequency:
-		case StyleValueType::resolution:
-			prop_dimension[name] = value.dimension;
-			prop_number[name] = value.number;
-			break;
-		case StyleValueType::percentage:
-		case StyleValueType::number:
-			prop_number[name] = value.number;
+			it->text = value.text;
 			break;
-		case StyleValueType::color:
-			prop_color[name] = value.color;
+		default:
+			it->text.clear();
 			break;
 		}
 	}
 
+	const StyleImplValue *StyleImpl::find_value(StylePropertyId id) const
+	{
+		auto it = std::lower_bound(values.begin(), values.end(), id, [](const StyleImplValue &a, StylePropertyId b) { return a.id < b; });
+		return (it != values.end() && it->id == id) ? &(*it) : nullptr;
+	}
+
 	void StyleImpl::set_value_array(const std::string &name, const std::vector<StyleSetValue> &value_array)
 	{
 		for (size_t i = 0; i < value_array.size(); i++)
@@ -105,13 +86,12 @@ namespace clan
 			set_value(name + "[" + StringHelp::int_to_text(i) + "]", value_array[i]);
 		}
 
-		size_t i = value_array.size();
-		while (true)
+		for (size_t i = value_array.size(); ; i++)
 		{
-			auto index_name = name + "[" + StringHelp::int_to_text(i) + "]";
-			if (prop_type.find(index_name) == prop_type.end())
+			StylePropertyId index_id = StyleProperty::find_id((name + "[" + StringHelp::int_to_text(i) + "]").c_str());
+			if (index_id == StylePropertyId::invalid || !find_value(index_id))
 				break;
-			set_value(index_name, StyleSetValue());
+			set_value(index_id, StyleSetValue());
 		}
 	}
 }
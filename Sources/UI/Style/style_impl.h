@@ -138,16 +138,27 @@ namespace clan
 		mutable std::size_t _hash = 0;
 	};
 
+	class StyleImplValue
+	{
+	public:
+		StylePropertyId id = StylePropertyId::invalid;
+		StyleValueType type = StyleValueType::undefined;
+		float number = 0.0f;
+		StyleDimension dimension = StyleDimension::px;
+		Colorf color;
+		std::string text;
+	};
+
 	class StyleImpl : public StylePropertySetter
 	{
 	public:
 		void set_value(const std::string &name, const StyleSetValue &value) override;
 		void set_value_array(const std::string &name, const std::vector<StyleSetValue> &value_array) override;
 
-		std::unordered_map<StyleString, StyleValueType, StyleString::hash> prop_type;
-		std::unordered_map<StyleString, std::string, StyleString::hash> prop_text;
-		std::unordered_map<StyleString, float, StyleString::hash> prop_number;
-		std::unordered_map<StyleString, StyleDimension, StyleString::hash> prop_dimension;
-		std::unordered_map<StyleString, Colorf, StyleString::hash> prop_color;
+		void set_value(StylePropertyId id, const StyleSetValue &value);
+		const StyleImplValue *find_value(StylePropertyId id) const;
+
+		/// Declared values sorted by property id
+		std::vector<StyleImplValue> values;
 	};
 }
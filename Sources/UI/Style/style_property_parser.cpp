@@ -32,13 +32,67 @@
 #include "API/UI/Style/style_token.h"
 #include "style_impl.h"
 #include <unordered_map>
+#include <deque>
 
 namespace clan
 {
-	std::unordered_map<StyleString, std::pair<StyleGetValue, bool>, StyleString::hash> &style_defaults()
+	const char *style_known_property_names[] =
 	{
-		static std::unordered_map<StyleString, std::pair<StyleGetValue, bool>, StyleString::hash> defaults;
-		return defaults;
+		"width", "height", "min-width", "min-height",
+		"max-width", "max-height", "margin-left", "margin-top",
+		"margin-right", "margin-bottom", "padding-left", "padding-top",
+		"padding-right", "padding-bottom", "border-left-width", "border-top-width",
+		"border-right-width", "border-bottom-width", "flex-basis", "flex-grow",
+		"flex-shrink", "flex-direction", "layout", "position",
+		"left", "top", "right", "bottom",
+		"font-size", "color", "background-color", "align-content",
+		"align-items", "align-self", "background-attachment", "background-clip",
+		"background-image", "background-origin", "background-position", "background-repeat",
+		"background-size", "border-bottom-color", "border-bottom-left-radius-x", "border-bottom-left-radius-y",
+		"border-bottom-right-radius-x", "border-bottom-right-radius-y", "border-bottom-style", "border-image-outset-bottom",
+		"border-image-outset-left", "border-image-outset-right", "border-image-outset-top", "border-image-repeat-x",
+		"border-image-repeat-y", "border-image-slice-bottom", "border-image-slice-center", "border-image-slice-left",
+		"border-image-slice-right", "border-image-slice-top", "border-image-source", "border-image-width-bottom",
+		"border-image-width-left", "border-image-width-right", "border-image-width-top", "border-left-color",
+		"border-left-style", "border-right-color", "border-right-style", "border-top-color",
+		"border-top-left-radius-x", "border-top-left-radius-y", "border-top-right-radius-x", "border-top-right-radius-y",
+		"border-top-style", "box-shadow", "-clan-font-rendering", "flex-wrap",
+		"font-family", "font-style", "font-variant", "font-weight",
+		"justify-content", "letter-spacing", "line-height", "order",
+		"outline-color", "outline-style", "outline-width", "text-align",
+		"text-decoration-blink", "text-decoration-line-through", "text-decoration-overline", "text-decoration-underline",
+		"text-indent", "text-transform", "word-spacing", "z-index"
+	};
+
+	class StylePropertyRegistry
+	{
+	public:
+		StylePropertyRegistry()
+		{
+			static_assert(sizeof(style_known_property_names) / sizeof(style_known_property_names[0]) == (size_t)StylePropertyId::num_known_properties, "Property name table does not match StylePropertyId");
+
+			for (int i = 0; i < (int)StylePropertyId::num_known_properties; i++)
+				add(style_known_property_names[i]);
+		}
+
+		int add(const std::string &name)
+		{
+			int id = (int)names.size();
+			names.push_back(name);
+			ids[name] = id;
+			defaults.push_back({ StyleGetValue(), false });
+			return id;
+		}
+
+		std::unordered_map<StyleString, int, StyleString::hash> ids;
+		std::deque<std::string> names;	// deque keeps the name pointers stable
+		std::vector<std::pair<StyleGetValue, bool>> defaults;
+	};
+
+	StylePropertyRegistry &style_registry()
+	{
+		static StylePropertyRegistry registry;
+		return registry;
 	}
 
 	std::unordered_map<StyleString, StylePropertyParser *, StyleString::hash> &style_parsers()
@@ -51,7 +105,7 @@ namespace clan
 
 	StylePropertyDefault::StylePropertyDefault(const std::string &name, const StyleGetValue &value, bool inherit)
 	{
-		style_defaults()[name] = { value, inherit };
+		style_registry().defaults[(int)StyleProperty::intern_id(name)] = { value, inherit };
 	}
 
 	/////////////////////////////////////////////////////////////////////////
@@ -1091,31 +1145,43 @@ namespace clan
 
 	/////////////////////////////////////////////////////////////////////////
 
-	bool StyleProperty::is_inherited(const char *name)
+	StylePropertyId StyleProperty::find_id(const char *name)
 	{
-		auto it = style_defaults().find(name);
-		if (it != style_defaults().end())
-		{
-			return it->second.second;
-		}
+		auto &ids = style_registry().ids;
+		auto it = ids.find(name);
+		return it != ids.end() ? (StylePropertyId)it->second : StylePropertyId::invalid;
+	}
+
+	StylePropertyId StyleProperty::intern_id(const std::string &name)
+	{
+		auto &registry = style_registry();
+		auto it = registry.ids.find(name);
+		if (it != registry.ids.end())
+			return (StylePropertyId)it->second;
 		else
-		{
+			return (StylePropertyId)registry.add(name);
+	}
+
+	const char *StyleProperty::name(StylePropertyId id)
+	{
+		return style_registry().names[(int)id].c_str();
+	}
+
+	bool StyleProperty::is_inherited(StylePropertyId id)
+	{
+		if (id == StylePropertyId::invalid)
 			return false;
-		}
+		return style_registry().defaults[(int)id].second;
 	}
-	
-	const StyleGetValue &StyleProperty::default_value(const char *name)
+
+	const StyleGetValue &StyleProperty::default_value(StylePropertyId id)
 	{
-		auto it = style_defaults().find(name);
-		if (it != style_defaults().end())
-		{
-			return it->second.first;
-		}
-		else
+		if (id == StylePropertyId::invalid)
 		{
 			static StyleGetValue undefined;
 			return undefined;
 		}
+		return style_registry().defaults[(int)id].first;
 	}
 
 	void StyleProperty::parse(StylePropertySetter *setter, const std::string &properties)
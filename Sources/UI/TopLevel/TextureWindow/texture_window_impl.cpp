@@ -36,6 +36,7 @@
 #include "API/Display/Window/input_event.h"
 #include "API/Display/2D/canvas.h"
 #include "texture_window_impl.h"
+#include "UI/Animation/animation_clock.h"
 
 namespace clan
 {
@@ -69,6 +70,9 @@ namespace clan
 
 	void TextureWindow_Impl::update()
 	{
+		// The application calls update once per frame, so the animated values are set right before rendering
+		AnimationClock::frame_presented();
+
 		if (needs_render || always_render)
 		{
 			canvas.set_cliprect(canvas_rect);
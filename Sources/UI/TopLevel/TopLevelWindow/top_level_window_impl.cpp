@@ -35,6 +35,7 @@
 #include "API/Display/Window/input_event.h"
 #include "API/Display/2D/canvas.h"
 #include "top_level_window_impl.h"
+#include "UI/Animation/animation_clock.h"
 
 namespace clan
 {
@@ -78,6 +79,9 @@ namespace clan
 		window_view->render(canvas, window.get_viewport());
 		canvas.flush();
 		window.flip();
+
+		// The flip waits for vsync, so animations advance once per displayed frame
+		AnimationClock::frame_presented();
 	}
 
 	void TopLevelWindow_Impl::on_window_close()
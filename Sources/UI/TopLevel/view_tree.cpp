@@ -30,8 +30,8 @@
 #include "API/UI/TopLevel/view_tree.h"
 #include "API/UI/Events/event.h"
 #include "API/UI/Events/focus_change_event.h"
+#include "API/Display/Render/render_target_pool.h"
 #include "../View/view_impl.h"
-#include "../View/positioned_layout.h"
 #include <algorithm>
 
 namespace clan
@@ -51,6 +51,7 @@ namespace clan
 
 		View *focus_view = nullptr;
 		std::shared_ptr<View> root;
+		RenderTargetPool layer_pool;
 	};
 
 	ViewTree::ViewTree() : impl(new ViewTreeImpl)
@@ -109,16 +110,22 @@ namespace clan
 
 		view->set_geometry(ViewGeometry::from_margin_box(view->style_cascade(), margin_box));
 
-		if (view->needs_layout())
-		{
-			view->layout_subviews(canvas);
-			PositionedLayout::layout_subviews(canvas, view);
-		}
-		view->impl->needs_layout = false;
+		view->layout_subviews_if_needed(canvas);
 
 		view->impl->render(view, canvas, ViewRenderLayer::background);
 		view->impl->render(view, canvas, ViewRenderLayer::border);
 		view->impl->render(view, canvas, ViewRenderLayer::content);
+
+		// Targets released by layers that changed size this frame have been reused already
+		if (!impl->layer_pool.is_null())
+			impl->layer_pool.clear();
+	}
+
+	RenderTargetPool &ViewTree::layer_pool()
+	{
+		if (impl->layer_pool.is_null())
+			impl->layer_pool = RenderTargetPool(2);
+		return impl->layer_pool;
 	}
 
 	void ViewTree::dispatch_activation_change(ActivationChangeType type)
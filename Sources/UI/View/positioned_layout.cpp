@@ -40,12 +40,12 @@ namespace clan
 			{
 				continue;
 			}
-			else if (subview->style_cascade().computed_value("position").is_keyword("absolute"))
+			else if (subview->style_cascade().computed_value(StylePropertyId::position).is_keyword("absolute"))
 			{
 				// To do: decide how we determine the containing box used for absolute positioning. For now, use the parent content box.
 				layout_from_containing_box(canvas, subview.get(), view->geometry().content_box());
 			}
-			else if (subview->style_cascade().computed_value("position").is_keyword("fixed"))
+			else if (subview->style_cascade().computed_value(StylePropertyId::position).is_keyword("fixed"))
 			{
 				Rectf offset_initial_containing_box;
 				View *current = view->superview();
@@ -71,8 +71,6 @@ namespace clan
 
 				layout_from_containing_box(canvas, subview.get(), offset_initial_containing_box);
 			}
-
-			layout_subviews(canvas, subview.get());
 		}
 	}
 
@@ -81,30 +79,30 @@ namespace clan
 		float x = 0.0f;
 		float width = 0.0f;
 
-		if (!view->style_cascade().computed_value("left").is_keyword("auto") && !view->style_cascade().computed_value("right").is_keyword("auto"))
+		if (!view->style_cascade().computed_value(StylePropertyId::left).is_keyword("auto") && !view->style_cascade().computed_value(StylePropertyId::right).is_keyword("auto"))
 		{
-			x = view->style_cascade().computed_value("left").number();
-			width = clan::max(containing_box.get_width() - view->style_cascade().computed_value("right").number() - x, 0.0f);
+			x = view->style_cascade().computed_value(StylePropertyId::left).number();
+			width = clan::max(containing_box.get_width() - view->style_cascade().computed_value(StylePropertyId::right).number() - x, 0.0f);
 		}
-		else if (!view->style_cascade().computed_value("left").is_keyword("auto") && !view->style_cascade().computed_value("width").is_keyword("auto"))
+		else if (!view->style_cascade().computed_value(StylePropertyId::left).is_keyword("auto") && !view->style_cascade().computed_value(StylePropertyId::width).is_keyword("auto"))
 		{
-			x = view->style_cascade().computed_value("left").number();
-			width = view->style_cascade().computed_value("width").number();
+			x = view->style_cascade().computed_value(StylePropertyId::left).number();
+			width = view->style_cascade().computed_value(StylePropertyId::width).number();
 		}
-		else if (!view->style_cascade().computed_value("right").is_keyword("auto") && !view->style_cascade().computed_value("width").is_keyword("auto"))
+		else if (!view->style_cascade().computed_value(StylePropertyId::right).is_keyword("auto") && !view->style_cascade().computed_value(StylePropertyId::width).is_keyword("auto"))
 		{
-			width = view->style_cascade().computed_value("width").number();
-			x = containing_box.get_width() - view->style_cascade().computed_value("right").number() - width;
+			width = view->style_cascade().computed_value(StylePropertyId::width).number();
+			x = containing_box.get_width() - view->style_cascade().computed_value(StylePropertyId::right).number() - width;
 		}
-		else if (!view->style_cascade().computed_value("left").is_keyword("auto"))
+		else if (!view->style_cascade().computed_value(StylePropertyId::left).is_keyword("auto"))
 		{
-			x = view->style_cascade().computed_value("left").number();
+			x = view->style_cascade().computed_value(StylePropertyId::left).number();
 			width = view->get_preferred_width(canvas);
 		}
-		else if (!view->style_cascade().computed_value("right").is_keyword("auto"))
+		else if (!view->style_cascade().computed_value(StylePropertyId::right).is_keyword("auto"))
 		{
 			width = view->get_preferred_width(canvas);
-			x = containing_box.get_width() - view->style_cascade().computed_value("right").number() - width;
+			x = containing_box.get_width() - view->style_cascade().computed_value(StylePropertyId::right).number() - width;
 		}
 		else
 		{
@@ -115,30 +113,30 @@ namespace clan
 		float y = 0.0f;
 		float height = 0.0f;
 
-		if (!view->style_cascade().computed_value("top").is_keyword("auto") && !view->style_cascade().computed_value("bottom").is_keyword("auto"))
+		if (!view->style_cascade().computed_value(StylePropertyId::top).is_keyword("auto") && !view->style_cascade().computed_value(StylePropertyId::bottom).is_keyword("auto"))
 		{
-			y = view->style_cascade().computed_value("top").number();
-			height = clan::max(containing_box.get_height() - view->style_cascade().computed_value("bottom").number() - y, 0.0f);
+			y = view->style_cascade().computed_value(StylePropertyId::top).number();
+			height = clan::max(containing_box.get_height() - view->style_cascade().computed_value(StylePropertyId::bottom).number() - y, 0.0f);
 		}
-		else if (!view->style_cascade().computed_value("top").is_keyword("auto") && !view->style_cascade().computed_value("height").is_keyword("auto"))
+		else if (!view->style_cascade().computed_value(StylePropertyId::top).is_keyword("auto") && !view->style_cascade().computed_value(StylePropertyId::height).is_keyword("auto"))
 		{
-			y = view->style_cascade().computed_value("top").number();
-			height = view->style_cascade().computed_value("height").number();
+			y = view->style_cascade().computed_value(StylePropertyId::top).number();
+			height = view->style_cascade().computed_value(StylePropertyId::height).number();
 		}
-		else if (!view->style_cascade().computed_value("bottom").is_keyword("auto") && !view->style_cascade().computed_value("height").is_keyword("auto"))
+		else if (!view->style_cascade().computed_value(StylePropertyId::bottom).is_keyword("auto") && !view->style_cascade().computed_value(StylePropertyId::height).is_keyword("auto"))
 		{
-			height = view->style_cascade().computed_value("height").number();
-			y = containing_box.get_height() - view->style_cascade().computed_value("bottom").number() - height;
+			height = view->style_cascade().computed_value(StylePropertyId::height).number();
+			y = containing_box.get_height() - view->style_cascade().computed_value(StylePropertyId::bottom).number() - height;
 		}
-		else if (!view->style_cascade().computed_value("top").is_keyword("auto"))
+		else if (!view->style_cascade().computed_value(StylePropertyId::top).is_keyword("auto"))
 		{
-			y = view->style_cascade().computed_value("top").number();
+			y = view->style_cascade().computed_value(StylePropertyId::top).number();
 			height = view->get_preferred_height(canvas, width);
 		}
-		else if (!view->style_cascade().computed_value("bottom").is_keyword("auto"))
+		else if (!view->style_cascade().computed_value(StylePropertyId::bottom).is_keyword("auto"))
 		{
 			height = view->get_preferred_height(canvas, width);
-			y = containing_box.get_height() - view->style_cascade().computed_value("bottom").number() - height;
+			y = containing_box.get_height() - view->style_cascade().computed_value(StylePropertyId::bottom).number() - height;
 		}
 		else
 		{
@@ -152,6 +150,6 @@ namespace clan
 	void PositionedLayout::layout_from_containing_box(Canvas &canvas, View *view, const Rectf &containing_box)
 	{
 		view->set_geometry(get_geometry(canvas, view, containing_box));
-		view->layout_subviews(canvas);
+		view->layout_subviews_if_needed(canvas);
 	}
 }
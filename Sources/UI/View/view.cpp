@@ -38,10 +38,15 @@
 #include "API/UI/Events/resize_event.h"
 #include "API/UI/UIThread/ui_thread.h"
 #include "API/Display/2D/canvas.h"
+#include "API/Display/2D/image.h"
+#include "API/Display/Render/blend_state.h"
+#include "API/Display/Render/blend_state_description.h"
 #include "view_impl.h"
 #include "vbox_layout.h"
 #include "hbox_layout.h"
+#include "positioned_layout.h"
 #include <algorithm>
+#include <unordered_map>
 
 namespace clan
 {
@@ -72,6 +77,7 @@ namespace clan
 
 		auto &style = impl->styles[state];
 		style = std::make_shared<Style>();
+		impl->compile_style_rules();
 		impl->update_style_cascade();
 		return style;
 	}
@@ -90,8 +96,7 @@ namespace clan
 		if (impl->states[name].enabled != value)
 		{
 			impl->states[name] = ViewImpl::StyleState(false, value);
-			impl->update_style_cascade();
-			set_needs_layout();
+			impl->set_state_enabled(this, name, value);
 		}
 	}
 	void View::set_state_cascade(const std::string &name, bool value)
@@ -99,8 +104,7 @@ namespace clan
 		if (impl->states[name].enabled != value)
 		{
 			impl->states[name] = ViewImpl::StyleState(false, value);
-			impl->update_style_cascade();
-			set_needs_layout();
+			impl->set_state_enabled(this, name, value);
 			impl->set_state_cascade_siblings(name, value);
 		}
 	}
@@ -113,13 +117,61 @@ namespace clan
 			if (impl->states[name].inherited)
 			{
 				impl->states[name] = ViewImpl::StyleState(true, value);
-				impl->update_style_cascade();
-				view->set_needs_layout();
+				impl->set_state_enabled(view.get(), name, value);
 				impl->set_state_cascade_siblings(name, value);
 			}
 		}
 	}
 
+	void ViewImpl::set_state_enabled(View *self, const std::string &name, bool value)
+	{
+		unsigned int id = state_id(name);
+		if (enabled_state_ids.size() <= id)
+			enabled_state_ids.resize(id + 1, false);
+		enabled_state_ids[id] = value;
+
+		// Only rules naming the state can start or stop matching
+		if (id < rule_state_ids.size() && rule_state_ids[id] && update_style_cascade())
+			self->set_needs_layout();
+		else
+			self->set_needs_render();
+	}
+
+	unsigned int ViewImpl::state_id(const std::string &name)
+	{
+		static std::unordered_map<std::string, unsigned int> ids;
+		auto it = ids.find(name);
+		if (it != ids.end())
+			return it->second;
+
+		unsigned int id = (unsigned int)ids.size();
+		ids[name] = id;
+		return id;
+	}
+
+	void ViewImpl::compile_style_rules()
+	{
+		style_rules.clear();
+		rule_state_ids.clear();
+
+		for (const auto &it : styles)
+		{
+			StyleRule rule;
+			rule.style = it.second.get();
+			for (const auto &state : StringHelp::split_text(it.first, " "))
+			{
+				unsigned int id = state_id(state);
+				rule.state_ids.push_back(id);
+				if (rule_state_ids.size() <= id)
+					rule_state_ids.resize(id + 1, false);
+				rule_state_ids[id] = true;
+			}
+			style_rules.push_back(std::move(rule));
+		}
+
+		std::stable_sort(style_rules.begin(), style_rules.end(), [](const StyleRule &a, const StyleRule &b) { return a.state_ids.size() != b.state_ids.size() ? a.state_ids.size() > b.state_ids.size() : a.style > b.style; });
+	}
+
 	View *View::superview() const
 	{
 		return impl->_superview;
@@ -137,6 +189,7 @@ namespace clan
 			view->remove_from_super();
 
 			impl->_subviews.push_back(view);
+			impl->hit_grid_dirty = true;
 			view->impl->_superview = this;
 			view->impl->update_style_cascade();
 			view->set_needs_layout();
@@ -158,6 +211,7 @@ namespace clan
 			auto it = std::find_if(super->impl->_subviews.begin(), super->impl->_subviews.end(), [&](const std::shared_ptr<View> &view) { return view.get() == this; });
 			if (it != super->impl->_subviews.end())
 				super->impl->_subviews.erase(it);
+			super->impl->hit_grid_dirty = true;
 			impl->_superview = nullptr;
 			impl->update_style_cascade();
 
@@ -183,7 +237,7 @@ namespace clan
 
 	bool View::is_static_position_and_visible() const
 	{
-		return style_cascade().computed_value("position").is_keyword("static") && !hidden();
+		return style_cascade().computed_value(StylePropertyId::position).is_keyword("static") && !hidden();
 	}
 
 	bool View::needs_layout() const
@@ -196,11 +250,71 @@ namespace clan
 		impl->needs_layout = true;
 		impl->layout_cache.clear();
 
+		// The superview positions this view and must always be laid out again. Above that, ancestors only
+		// need layout while their preferred size depends on their content.
 		View *super = superview();
+		while (super)
+		{
+			super->impl->needs_layout = true;
+			super->impl->layout_cache.clear();
+			if (ViewImpl::is_layout_boundary(super))
+				break;
+			super = super->superview();
+		}
+
 		if (super)
-			super->set_needs_layout();
-		else
-			set_needs_render();
+			ViewImpl::set_subtree_needs_layout(super);
+
+		set_needs_render();
+	}
+
+	void View::layout_subviews_if_needed(Canvas &canvas)
+	{
+		if (impl->needs_layout)
+		{
+			layout_subviews(canvas);
+			PositionedLayout::layout_subviews(canvas, this);
+		}
+		else if (impl->subtree_needs_layout)
+		{
+			for (const std::shared_ptr<View> &subview : impl->_subviews)
+			{
+				if (!subview->hidden())
+					subview->layout_subviews_if_needed(canvas);
+			}
+		}
+
+		// Cleared last, as setting the geometry of subviews marks this view again
+		impl->needs_layout = false;
+		impl->subtree_needs_layout = false;
+	}
+
+	void ViewImpl::set_subtree_needs_layout(View *view)
+	{
+		for (View *super = view->superview(); super; super = super->superview())
+			super->impl->subtree_needs_layout = true;
+	}
+
+	void ViewImpl::set_layers_dirty(View *view)
+	{
+		for (View *current = view; current; current = current->superview())
+			current->impl->layer_dirty = true;
+	}
+
+	void ViewImpl::update_hit_grid(View *view, const Rectf &old_border_box)
+	{
+		ViewImpl *super_impl = view->superview() ? view->superview()->impl.get() : nullptr;
+		if (super_impl && super_impl->hit_grid && !super_impl->hit_grid_dirty)
+		{
+			if (!super_impl->hit_grid->move(view->impl->hit_grid_index, old_border_box, view->impl->_geometry.border_box()))
+				super_impl->hit_grid_dirty = true;
+		}
+	}
+
+	bool ViewImpl::is_layout_boundary(const View *view)
+	{
+		const StyleCascade &style = view->style_cascade();
+		return style.computed_value(StylePropertyId::width).is_length() && style.computed_value(StylePropertyId::height).is_length();
 	}
 
 	Canvas View::get_canvas() const
@@ -214,6 +328,8 @@ namespace clan
 
 	void View::set_needs_render()
 	{
+		ViewImpl::set_layers_dirty(this);
+
 		ViewTree *tree = view_tree();
 		if (tree)
 			tree->set_needs_render();
@@ -228,8 +344,14 @@ namespace clan
 	{
 		if (impl->_geometry.content_box() != geometry.content_box())
 		{
+			// Only the subviews need to be placed again. The superview is the one setting the geometry.
+			Rectf old_border_box = impl->_geometry.border_box();
 			impl->_geometry = geometry;
-			set_needs_layout();
+			ViewImpl::update_hit_grid(this, old_border_box);
+			impl->needs_layout = true;
+			impl->layout_cache.clear();
+			ViewImpl::set_subtree_needs_layout(this);
+			set_needs_render();
 		}
 	}
 
@@ -255,7 +377,65 @@ namespace clan
 	void View::set_view_transform(const Mat4f &transform)
 	{
 		impl->view_transform = transform;
-		set_needs_render();
+
+		// A cached layer is composited with the transform, so only the layers of the ancestors are affected
+		if (impl->uses_layer() && superview())
+			superview()->set_needs_render();
+		else
+			set_needs_render();
+	}
+
+	bool View::layer_cached() const
+	{
+		return impl->layer_cached;
+	}
+
+	void View::set_layer_cached(bool enable)
+	{
+		if (impl->layer_cached != enable)
+		{
+			impl->layer_cached = enable;
+			if (!impl->uses_layer())
+				impl->release_layer();
+			set_needs_render();
+		}
+	}
+
+	bool View::layer_tiled() const
+	{
+		return impl->layer_tiled;
+	}
+
+	void View::set_layer_tiled(bool enable)
+	{
+		if (impl->layer_tiled != enable)
+		{
+			impl->layer_tiled = enable;
+			impl->release_layer();
+			set_needs_render();
+		}
+	}
+
+	float View::layer_opacity() const
+	{
+		return impl->layer_opacity;
+	}
+
+	void View::set_layer_opacity(float opacity)
+	{
+		opacity = clamp(opacity, 0.0f, 1.0f);
+		if (impl->layer_opacity != opacity)
+		{
+			bool used_layer = impl->uses_layer();
+			impl->layer_opacity = opacity;
+			if (!impl->uses_layer())
+				impl->release_layer();
+
+			if (used_layer == impl->uses_layer() && superview())
+				superview()->set_needs_render();
+			else
+				set_needs_render();
+		}
 	}
 
 	bool View::content_clipped() const
@@ -284,66 +464,66 @@ namespace clan
 
 	float View::get_preferred_height(Canvas &canvas, float width)
 	{
-		auto it = impl->layout_cache.preferred_height.find(width);
-		if (it != impl->layout_cache.preferred_height.end())
-			return it->second;
-
-		float height = calculate_preferred_height(canvas, width);
-		impl->layout_cache.preferred_height[width] = height;
+		float height = 0.0f;
+		if (!impl->layout_cache.preferred_height.find(width, height))
+		{
+			height = calculate_preferred_height(canvas, width);
+			impl->layout_cache.preferred_height.insert(width, height);
+		}
 		return height;
 	}
 
 	float View::get_first_baseline_offset(Canvas &canvas, float width)
 	{
-		auto it = impl->layout_cache.first_baseline_offset.find(width);
-		if (it != impl->layout_cache.first_baseline_offset.end())
-			return it->second;
-
-		float baseline_offset = calculate_first_baseline_offset(canvas, width);
-		impl->layout_cache.first_baseline_offset[width] = baseline_offset;
+		float baseline_offset = 0.0f;
+		if (!impl->layout_cache.first_baseline_offset.find(width, baseline_offset))
+		{
+			baseline_offset = calculate_first_baseline_offset(canvas, width);
+			impl->layout_cache.first_baseline_offset.insert(width, baseline_offset);
+		}
 		return baseline_offset;
 	}
 
 	float View::get_last_baseline_offset(Canvas &canvas, float width)
 	{
-		auto it = impl->layout_cache.last_baseline_offset.find(width);
-		if (it != impl->layout_cache.last_baseline_offset.end())
-			return it->second;
-
-		float baseline_offset = calculate_last_baseline_offset(canvas, width);
-		impl->layout_cache.last_baseline_offset[width] = baseline_offset;
+		float baseline_offset = 0.0f;
+		if (!impl->layout_cache.last_baseline_offset.find(width, baseline_offset))
+		{
+			baseline_offset = calculate_last_baseline_offset(canvas, width);
+			impl->layout_cache.last_baseline_offset.insert(width, baseline_offset);
+		}
 		return baseline_offset;
 	}
 
 	float View::calculate_preferred_width(Canvas &canvas)
 	{
-		if (style_cascade().computed_value("layout").is_keyword("flex") && style_cascade().computed_value("flex-direction").is_keyword("column"))
+		if (style_cascade().computed_value(StylePropertyId::layout).is_keyword("flex") && style_cascade().computed_value(StylePropertyId::flex_direction).is_keyword("column"))
 			return VBoxLayout::get_preferred_width(canvas, this);
-		else if (style_cascade().computed_value("layout").is_keyword("flex") && style_cascade().computed_value("flex-direction").is_keyword("row"))
+		else if (style_cascade().computed_value(StylePropertyId::layout).is_keyword("flex") && style_cascade().computed_value(StylePropertyId::flex_direction).is_keyword("row"))
 			return HBoxLayout::get_preferred_width(canvas, this);
-		else if (style_cascade().computed_value("width").is_keyword("auto"))
+		else if (style_cascade().computed_value(StylePropertyId::width).is_keyword("auto"))
 			return 0.0f;
 		else
-			return style_cascade().computed_value("width").number();
+			return style_cascade().computed_value(StylePropertyId::width).number();
 	}
 
 	float View::calculate_preferred_height(Canvas &canvas, float width)
 	{
-		if (style_cascade().computed_value("layout").is_keyword("flex") && style_cascade().computed_value("flex-direction").is_keyword("column"))
+		if (style_cascade().computed_value(StylePropertyId::layout).is_keyword("flex") && style_cascade().computed_value(StylePropertyId::flex_direction).is_keyword("column"))
 			return VBoxLayout::get_preferred_height(canvas, this, width);
-		else if (style_cascade().computed_value("layout").is_keyword("flex") && style_cascade().computed_value("flex-direction").is_keyword("row"))
+		else if (style_cascade().computed_value(StylePropertyId::layout).is_keyword("flex") && style_cascade().computed_value(StylePropertyId::flex_direction).is_keyword("row"))
 			return HBoxLayout::get_preferred_height(canvas, this, width);
-		else if (style_cascade().computed_value("height").is_keyword("auto"))
+		else if (style_cascade().computed_value(StylePropertyId::height).is_keyword("auto"))
 			return 0.0f;
 		else
-			return style_cascade().computed_value("height").number();
+			return style_cascade().computed_value(StylePropertyId::height).number();
 	}
 
 	float View::calculate_first_baseline_offset(Canvas &canvas, float width)
 	{
-		if (style_cascade().computed_value("layout").is_keyword("flex") && style_cascade().computed_value("flex-direction").is_keyword("column"))
+		if (style_cascade().computed_value(StylePropertyId::layout).is_keyword("flex") && style_cascade().computed_value(StylePropertyId::flex_direction).is_keyword("column"))
 			return VBoxLayout::get_first_baseline_offset(canvas, this, width);
-		else if (style_cascade().computed_value("layout").is_keyword("flex") && style_cascade().computed_value("flex-direction").is_keyword("row"))
+		else if (style_cascade().computed_value(StylePropertyId::layout).is_keyword("flex") && style_cascade().computed_value(StylePropertyId::flex_direction).is_keyword("row"))
 			return HBoxLayout::get_first_baseline_offset(canvas, this, width);
 		else
 			return 0.0f;
@@ -351,9 +531,9 @@ namespace clan
 
 	float View::calculate_last_baseline_offset(Canvas &canvas, float width)
 	{
-		if (style_cascade().computed_value("layout").is_keyword("flex") && style_cascade().computed_value("flex-direction").is_keyword("column"))
+		if (style_cascade().computed_value(StylePropertyId::layout).is_keyword("flex") && style_cascade().computed_value(StylePropertyId::flex_direction).is_keyword("column"))
 			return VBoxLayout::get_last_baseline_offset(canvas, this, width);
-		else if (style_cascade().computed_value("layout").is_keyword("flex") && style_cascade().computed_value("flex-direction").is_keyword("row"))
+		else if (style_cascade().computed_value(StylePropertyId::layout).is_keyword("flex") && style_cascade().computed_value(StylePropertyId::flex_direction).is_keyword("row"))
 			return HBoxLayout::get_last_baseline_offset(canvas, this, width);
 		else
 			return 0.0f;
@@ -361,9 +541,9 @@ namespace clan
 
 	void View::layout_subviews(Canvas &canvas)
 	{
-		if (style_cascade().computed_value("layout").is_keyword("flex") && style_cascade().computed_value("flex-direction").is_keyword("column"))
+		if (style_cascade().computed_value(StylePropertyId::layout).is_keyword("flex") && style_cascade().computed_value(StylePropertyId::flex_direction).is_keyword("column"))
 			VBoxLayout::layout_subviews(canvas, this);
-		else if (style_cascade().computed_value("layout").is_keyword("flex") && style_cascade().computed_value("flex-direction").is_keyword("row"))
+		else if (style_cascade().computed_value(StylePropertyId::layout).is_keyword("flex") && style_cascade().computed_value(StylePropertyId::flex_direction).is_keyword("row"))
 			HBoxLayout::layout_subviews(canvas, this);
 	}
 
@@ -396,22 +576,63 @@ namespace clan
 
 	std::shared_ptr<View> View::find_view_at(const Pointf &pos) const
 	{
-		for (unsigned int cnt = impl->_subviews.size(); cnt > 0; --cnt)	// Search the subviews in reverse order, as we want to search the view that was "last drawn" first
+		const std::shared_ptr<View> *found = nullptr;
+		if (impl->hit_grid)
 		{
-			const std::shared_ptr<View> &child = impl->_subviews[cnt-1];
-			if (child->geometry().border_box().contains(pos) && !child->hidden())
+			if (impl->hit_grid_dirty)
 			{
-				Pointf child_content_pos(pos.x - child->geometry().content_x, pos.y - child->geometry().content_y);
-				child_content_pos = Vec2f(Mat4f::inverse(child->view_transform()) * Vec4f(child_content_pos, 0.0f, 1.0f));
-				std::shared_ptr<View> view = child->find_view_at(child_content_pos);
-				if (view)
-					return view;
-				else
-					return child;
+				impl->hit_grid->build(impl->_subviews);
+				for (unsigned int index = 0; index < impl->_subviews.size(); index++)
+					impl->_subviews[index]->impl->hit_grid_index = index;
+				impl->hit_grid_dirty = false;
 			}
+
+			int index = impl->hit_grid->find(impl->_subviews, pos);
+			if (index != -1)
+				found = &impl->_subviews[index];
 		}
+		else
+		{
+			for (unsigned int cnt = impl->_subviews.size(); cnt > 0; --cnt)	// Search the subviews in reverse order, as we want to search the view that was "last drawn" first
+			{
+				const std::shared_ptr<View> &child = impl->_subviews[cnt-1];
+				if (child->geometry().border_box().contains(pos) && !child->hidden())
+				{
+					found = &child;
+					break;
+				}
+			}
+		}
+
+		if (!found)
+			return std::shared_ptr<View>();
 
-		return std::shared_ptr<View>();
+		const std::shared_ptr<View> &child = *found;
+		Pointf child_content_pos(pos.x - child->geometry().content_x, pos.y - child->geometry().content_y);
+		child_content_pos = Vec2f(Mat4f::inverse(child->view_transform()) * Vec4f(child_content_pos, 0.0f, 1.0f));
+		std::shared_ptr<View> view = child->find_view_at(child_content_pos);
+		if (view)
+			return view;
+		else
+			return child;
+	}
+
+	bool View::subview_hit_grid() const
+	{
+		return impl->hit_grid != nullptr;
+	}
+
+	void View::set_subview_hit_grid(bool enable)
+	{
+		if (enable && !impl->hit_grid)
+		{
+			impl->hit_grid.reset(new ViewHitGrid());
+			impl->hit_grid_dirty = true;
+		}
+		else if (!enable)
+		{
+			impl->hit_grid.reset();
+		}
 	}
 
 	FocusPolicy View::focus_policy() const
@@ -727,6 +948,19 @@ namespace clan
 
 	void ViewImpl::render(View *self, Canvas &canvas, ViewRenderLayer layer)
 	{
+		if (uses_layer() && !rendering_layer)
+		{
+			// The whole subview tree is drawn by the layer as part of the background
+			if (layer == ViewRenderLayer::background)
+			{
+				if (layer_tiled)
+					render_tiles(self, canvas);
+				else
+					render_layer(self, canvas);
+			}
+			return;
+		}
+
 		if (layer == ViewRenderLayer::background)
 			style_cascade.render_background(canvas, _geometry);
 		else if (layer == ViewRenderLayer::border)
@@ -734,7 +968,10 @@ namespace clan
 
 		Mat4f old_transform = canvas.get_transform();
 		Pointf translate = _geometry.content_pos();
-		canvas.set_transform(old_transform * Mat4f::translate(translate.x, translate.y, 0) * view_transform);
+		if (rendering_layer)
+			canvas.set_transform(old_transform * Mat4f::translate(translate.x, translate.y, 0));
+		else
+			canvas.set_transform(old_transform * Mat4f::translate(translate.x, translate.y, 0) * view_transform);
 
 		bool clipped = content_clipped;
 		if (clipped)
@@ -793,39 +1030,200 @@ namespace clan
 		canvas.set_transform(old_transform);
 	}
 
-	void ViewImpl::update_style_cascade() const
+	void ViewImpl::render_layer(View *self, Canvas &canvas)
+	{
+		Rectf border_box = _geometry.border_box();
+		float pixel_ratio = canvas.get_pixel_ratio();
+		Size size((int)std::ceil(border_box.get_width() * pixel_ratio), (int)std::ceil(border_box.get_height() * pixel_ratio));
+		if (size.width <= 0 || size.height <= 0)
+			return;
+
+		if (layer_texture.is_null() || layer_texture.get_size() != size)
+		{
+			release_layer();
+
+			layer_pool = self->view_tree()->layer_pool();
+			layer_texture = layer_pool.acquire_texture(canvas, size);
+			layer_texture.set_pixel_ratio(pixel_ratio);
+			layer_frame_buffer = layer_pool.acquire_frame_buffer(canvas);
+			layer_frame_buffer.attach_color(0, layer_texture);
+			layer_canvas = Canvas(canvas, layer_frame_buffer);
+
+			// Store premultiplied colors, so that the layer composites the same way as its views would have
+			BlendStateDescription blend_desc;
+			blend_desc.set_blend_function(blend_src_alpha, blend_one_minus_src_alpha, blend_one, blend_one_minus_src_alpha);
+			layer_canvas.set_blend_state(BlendState(canvas, blend_desc));
+
+			BlendStateDescription composite_desc;
+			composite_desc.set_blend_function(blend_one, blend_one_minus_src_alpha, blend_one, blend_one_minus_src_alpha);
+			layer_composite_state = BlendState(canvas, composite_desc);
+
+			layer_dirty = true;
+		}
+
+		if (layer_dirty)
+		{
+			canvas.flush();
+
+			layer_canvas.clear(Colorf::transparent);
+			layer_canvas.set_transform(Mat4f::translate(-border_box.left, -border_box.top, 0.0f));
+
+			rendering_layer = true;
+			render(self, layer_canvas, ViewRenderLayer::background);
+			render(self, layer_canvas, ViewRenderLayer::border);
+			render(self, layer_canvas, ViewRenderLayer::content);
+			rendering_layer = false;
+
+			layer_canvas.flush();
+			layer_dirty = false;
+		}
+
+		// The view transform applies to the whole layer, including background and border
+		Mat4f old_transform = canvas.get_transform();
+		Pointf translate = _geometry.content_pos();
+		canvas.set_transform(old_transform * Mat4f::translate(translate.x, translate.y, 0) * view_transform * Mat4f::translate(-translate.x, -translate.y, 0));
+
+		canvas.set_blend_state(layer_composite_state);
+
+		Image image(layer_texture, Rect(Point(), size));
+		image.set_color(Colorf(layer_opacity, layer_opacity, layer_opacity, layer_opacity));
+		image.draw(canvas, border_box);
+
+		canvas.reset_blend_state();
+		canvas.set_transform(old_transform);
+	}
+
+	void ViewImpl::render_tiles(View *self, Canvas &canvas)
 	{
-		std::vector<std::pair<Style *, size_t>> matches;
+		Rectf border_box = _geometry.border_box();
+		if (border_box.get_width() <= 0.0f || border_box.get_height() <= 0.0f)
+			return;
+
+		// The view transform applies to the tiles as a whole, like it does for a cached layer
+		Mat4f old_transform = canvas.get_transform();
+		Pointf translate = _geometry.content_pos();
+		Mat4f tiles_transform = old_transform * Mat4f::translate(translate.x, translate.y, 0) * view_transform * Mat4f::translate(-translate.x, -translate.y, 0);
+
+		// Note: this code isn't correct for rotated transforms (plus canvas cliprect can only clip AABB)
+		Rectf clip_box = canvas.get_cliprect();
+		Mat4f inverse_transform = Mat4f::inverse(tiles_transform);
+		Vec4f tl_point = inverse_transform * Vec4f(clip_box.left, clip_box.top, 0.0f, 1.0f);
+		Vec4f br_point = inverse_transform * Vec4f(clip_box.right, clip_box.bottom, 0.0f, 1.0f);
+		Rectf visible_box(std::min(tl_point.x, br_point.x), std::min(tl_point.y, br_point.y), std::max(tl_point.x, br_point.x), std::max(tl_point.y, br_point.y));
+
+		if (!tile_cache)
+			tile_cache.reset(new ViewTileCache());
+
+		if (layer_dirty)
+		{
+			tile_cache->invalidate();
+			layer_dirty = false;
+		}
+
+		tile_cache->update(canvas, self->view_tree()->layer_pool(), border_box, visible_box, canvas.get_pixel_ratio());
+
+		auto render_tile = [&](ViewTileCache::Tile *tile)
+		{
+			canvas.flush();
+
+			Canvas &tile_canvas = tile_cache->begin_tile(canvas, *tile);
+			rendering_layer = true;
+			render(self, tile_canvas, ViewRenderLayer::background);
+			render(self, tile_canvas, ViewRenderLayer::border);
+			render(self, tile_canvas, ViewRenderLayer::content);
+			rendering_layer = false;
+			tile_canvas.flush();
+
+			tile->dirty = false;
+		};
+
+		for (ViewTileCache::Tile *tile : tile_cache->visible_tiles())
+		{
+			if (tile->dirty)
+				render_tile(tile);
+		}
+
+		// Spread the tiles about to scroll into view over several frames
+		int prefetched = 0;
+		bool prefetch_pending = false;
+		for (ViewTileCache::Tile *tile : tile_cache->prefetch_tiles())
+		{
+			if (!tile->dirty)
+				continue;
+
+			if (prefetched == ViewTileCache::max_prefetch_per_frame)
+			{
+				prefetch_pending = true;
+				break;
+			}
+
+			render_tile(tile);
+			prefetched++;
+		}
 
-		for (auto it : styles)
+		canvas.set_transform(tiles_transform);
+		canvas.set_blend_state(tile_cache->composite_state());
+
+		for (ViewTileCache::Tile *tile : tile_cache->visible_tiles())
 		{
-			auto &style_list = it.first;
-			auto &style = it.second;
+			Image image(tile->texture, Rect(Point(), tile->pixel_size));
+			image.set_color(Colorf(layer_opacity, layer_opacity, layer_opacity, layer_opacity));
+			image.draw(canvas, tile->box);
+		}
+
+		canvas.reset_blend_state();
+		canvas.set_transform(old_transform);
 
-			auto style_classes = StringHelp::split_text(style_list, " ");
+		if (prefetch_pending)
+			self->view_tree()->set_needs_render();
+	}
 
+	void ViewImpl::release_layer()
+	{
+		if (!layer_pool.is_null())
+		{
+			layer_pool.release(layer_texture);
+			layer_pool.release(layer_frame_buffer);
+		}
+		layer_pool = RenderTargetPool();
+		layer_texture = Texture2D();
+		layer_frame_buffer = FrameBuffer();
+		layer_canvas = Canvas();
+		layer_composite_state = BlendState();
+		tile_cache.reset();
+		layer_dirty = true;
+	}
+
+	bool ViewImpl::update_style_cascade() const
+	{
+		std::vector<Style *> matches;
+		matches.reserve(style_rules.size());
+
+		for (const StyleRule &rule : style_rules)
+		{
 			bool match = true;
-			for (const auto &state : style_classes)
+			for (unsigned int id : rule.state_ids)
 			{
-				auto search_it = states.find(state);
-				if (search_it == states.end() || !search_it->second.enabled)
+				if (id >= enabled_state_ids.size() || !enabled_state_ids[id])
+				{
 					match = false;
+					break;
+				}
 			}
 
 			if (match)
-				matches.push_back({ style.get(), style_classes.size() });
+				matches.push_back(rule.style);
 		}
 
-		std::stable_sort(matches.begin(), matches.end(), [](const std::pair<Style *, size_t> &a, const std::pair<Style *, size_t> &b) { return a.second != b.second ? a.second > b.second : a.first > b.first; });
+		const StyleCascade *parent = _superview ? &_superview->style_cascade() : nullptr;
+		if (style_cascade.parent == parent && style_cascade.cascade == matches)
+			return false;
 
-		if (_superview)
-			style_cascade.parent = &_superview->style_cascade();
-		else
-			style_cascade.parent = nullptr;
+		style_cascade.parent = parent;
+		style_cascade.cascade = std::move(matches);
 
-		style_cascade.cascade.clear();
-		for (auto &match : matches)
-			style_cascade.cascade.push_back(match.first);
+		StyleCascade::invalidate_computed_values();
+		return true;
 	}
 
 	void ViewImpl::process_event(View *self, EventUI *e, bool use_capture)
@@ -35,20 +35,20 @@ namespace clan
 {
 	ViewGeometry::ViewGeometry(const StyleCascade &style_cascade)
 	{
-		margin_left = style_cascade.computed_value("margin-left").number();
-		margin_top = style_cascade.computed_value("margin-top").number();
-		margin_right = style_cascade.computed_value("margin-right").number();
-		margin_bottom = style_cascade.computed_value("margin-bottom").number();
-
-		border_left = style_cascade.computed_value("border-left-width").number();
-		border_top = style_cascade.computed_value("border-top-width").number();
-		border_right = style_cascade.computed_value("border-right-width").number();
-		border_bottom = style_cascade.computed_value("border-bottom-width").number();
-
-		padding_left = style_cascade.computed_value("padding-left").number();
-		padding_top = style_cascade.computed_value("padding-top").number();
-		padding_right = style_cascade.computed_value("padding-right").number();
-		padding_bottom = style_cascade.computed_value("padding-bottom").number();
+		margin_left = style_cascade.computed_value(StylePropertyId::margin_left).number();
+		margin_top = style_cascade.computed_value(StylePropertyId::margin_top).number();
+		margin_right = style_cascade.computed_value(StylePropertyId::margin_right).number();
+		margin_bottom = style_cascade.computed_value(StylePropertyId::margin_bottom).number();
+
+		border_left = style_cascade.computed_value(StylePropertyId::border_left_width).number();
+		border_top = style_cascade.computed_value(StylePropertyId::border_top_width).number();
+		border_right = style_cascade.computed_value(StylePropertyId::border_right_width).number();
+		border_bottom = style_cascade.computed_value(StylePropertyId::border_bottom_width).number();
+
+		padding_left = style_cascade.computed_value(StylePropertyId::padding_left).number();
+		padding_top = style_cascade.computed_value(StylePropertyId::padding_top).number();
+		padding_right = style_cascade.computed_value(StylePropertyId::padding_right).number();
+		padding_bottom = style_cascade.computed_value(StylePropertyId::padding_bottom).number();
 	}
 
 	ViewGeometry ViewGeometry::from_margin_box(const StyleCascade &style, const Rectf &box)
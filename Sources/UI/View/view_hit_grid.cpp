@@ -0,0 +1,168 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "UI/precomp.h"
+#include "view_hit_grid.h"
+#include "API/UI/View/view.h"
+#include <algorithm>
+#include <cmath>
+
+namespace clan
+{
+	namespace
+	{
+		// Aim for about two subviews per cell
+		const int subviews_per_cell = 2;
+		const int max_cells = 4096;
+	}
+
+	void ViewHitGrid::build(const std::vector<std::shared_ptr<View>> &subviews)
+	{
+		cells.clear();
+		outside.clear();
+		columns = 0;
+		rows = 0;
+		subview_count = subviews.size();
+		if (subviews.empty())
+			return;
+
+		bounds = subviews.front()->geometry().border_box();
+		for (const auto &subview : subviews)
+		{
+			Rectf box = subview->geometry().border_box();
+			bounds.left = std::min(bounds.left, box.left);
+			bounds.top = std::min(bounds.top, box.top);
+			bounds.right = std::max(bounds.right, box.right);
+			bounds.bottom = std::max(bounds.bottom, box.bottom);
+		}
+
+		float width = std::max(bounds.get_width(), 1.0f);
+		float height = std::max(bounds.get_height(), 1.0f);
+
+		int num_cells = clamp((int)subview_count / subviews_per_cell, 1, max_cells);
+		columns = clamp((int)std::ceil(std::sqrt(num_cells * width / height)), 1, num_cells);
+		rows = std::max((num_cells + columns - 1) / columns, 1);
+		cell_width = width / columns;
+		cell_height = height / rows;
+		cells.resize(columns * rows);
+
+		for (unsigned int index = 0; index < subview_count; index++)
+			insert(index, subviews[index]->geometry().border_box());
+	}
+
+	bool ViewHitGrid::move(unsigned int index, const Rectf &old_box, const Rectf &new_box)
+	{
+		if (columns == 0 || index >= subview_count)
+			return false;
+
+		remove(index, old_box);
+		insert(index, new_box);
+		return outside.size() <= std::max(subview_count / 4, (size_t)16);
+	}
+
+	int ViewHitGrid::find(const std::vector<std::shared_ptr<View>> &subviews, const Pointf &pos) const
+	{
+		if (columns == 0)
+			return -1;
+
+		// A subview inside the bounds can not contain a position outside them
+		const std::vector<unsigned int> &candidates = bounds.contains(pos) ? cells[row_at(pos.y) * columns + column_at(pos.x)] : outside;
+
+		// The last subview is drawn on top of the others
+		int found = -1;
+		for (unsigned int index : candidates)
+		{
+			if ((int)index > found && index < subviews.size())
+			{
+				const std::shared_ptr<View> &subview = subviews[index];
+				if (!subview->hidden() && subview->geometry().border_box().contains(pos))
+					found = index;
+			}
+		}
+		return found;
+	}
+
+	void ViewHitGrid::insert(unsigned int index, const Rectf &box)
+	{
+		if (!is_inside_bounds(box))
+			outside.push_back(index);
+
+		if (box.right < bounds.left || box.left > bounds.right || box.bottom < bounds.top || box.top > bounds.bottom)
+			return;
+
+		int x0 = column_at(box.left), x1 = column_at(box.right);
+		int y0 = row_at(box.top), y1 = row_at(box.bottom);
+		for (int y = y0; y <= y1; y++)
+		{
+			for (int x = x0; x <= x1; x++)
+				cells[y * columns + x].push_back(index);
+		}
+	}
+
+	void ViewHitGrid::remove(unsigned int index, const Rectf &box)
+	{
+		if (!is_inside_bounds(box))
+		{
+			auto it = std::find(outside.begin(), outside.end(), index);
+			if (it != outside.end())
+				outside.erase(it);
+		}
+
+		if (box.right < bounds.left || box.left > bounds.right || box.bottom < bounds.top || box.top > bounds.bottom)
+			return;
+
+		int x0 = column_at(box.left), x1 = column_at(box.right);
+		int y0 = row_at(box.top), y1 = row_at(box.bottom);
+		for (int y = y0; y <= y1; y++)
+		{
+			for (int x = x0; x <= x1; x++)
+			{
+				std::vector<unsigned int> &cell = cells[y * columns + x];
+				auto it = std::find(cell.begin(), cell.end(), index);
+				if (it != cell.end())
+					cell.erase(it);
+			}
+		}
+	}
+
+	bool ViewHitGrid::is_inside_bounds(const Rectf &box) const
+	{
+		return box.left >= bounds.left && box.top >= bounds.top && box.right <= bounds.right && box.bottom <= bounds.bottom;
+	}
+
+	int ViewHitGrid::column_at(float x) const
+	{
+		return clamp((int)std::floor((x - bounds.left) / cell_width), 0, columns - 1);
+	}
+
+	int ViewHitGrid::row_at(float y) const
+	{
+		return clamp((int)std::floor((y - bounds.top) / cell_height), 0, rows - 1);
+	}
+}
@@ -0,0 +1,73 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+namespace clan
+{
+	class View;
+
+	/// \brief Uniform grid over the border boxes of the subviews of a view
+	///
+	/// Each cell lists the subviews overlapping it, by index. Subviews reaching outside the grid bounds are
+	/// also kept in a separate list, which is searched for positions outside the bounds.
+	class ViewHitGrid
+	{
+	public:
+		/// \brief Places all subviews in the grid, sized after their current border boxes
+		void build(const std::vector<std::shared_ptr<View>> &subviews);
+
+		/// \brief Moves a subview to the cells of its new border box
+		///
+		/// Returns false if too many subviews ended up outside the bounds and the grid should be built again.
+		bool move(unsigned int index, const Rectf &old_box, const Rectf &new_box);
+
+		/// \brief Returns the index of the last visible subview with a border box containing the position, or -1
+		int find(const std::vector<std::shared_ptr<View>> &subviews, const Pointf &pos) const;
+
+	private:
+		void insert(unsigned int index, const Rectf &box);
+		void remove(unsigned int index, const Rectf &box);
+		bool is_inside_bounds(const Rectf &box) const;
+		int column_at(float x) const;
+		int row_at(float y) const;
+
+		Rectf bounds;
+		float cell_width = 1.0f;
+		float cell_height = 1.0f;
+		int columns = 0;
+		int rows = 0;
+		std::vector<std::vector<unsigned int>> cells;
+		std::vector<unsigned int> outside;
+		size_t subview_count = 0;
+	};
+}
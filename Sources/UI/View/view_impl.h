@@ -32,18 +32,64 @@
 #include "API/Display/Window/display_window.h"
 #include "API/Display/Window/cursor.h"
 #include "API/Display/Window/cursor_description.h"
+#include "API/Display/Render/render_target_pool.h"
+#include "API/Display/Render/texture_2d.h"
+#include "API/Display/Render/frame_buffer.h"
+#include "API/Display/Render/blend_state.h"
+#include "API/Display/2D/canvas.h"
 #include "../Animation/animation_group.h"
+#include "view_hit_grid.h"
+#include "view_tile_cache.h"
 
 namespace clan
 {
+	/// Remembers the most recent results of a width dependent layout calculation
+	class ViewLayoutMemo
+	{
+	public:
+		bool find(float width, float &out_value) const
+		{
+			for (int i = 0; i < count; i++)
+			{
+				if (widths[i] == width)
+				{
+					out_value = values[i];
+					return true;
+				}
+			}
+			return false;
+		}
+
+		void insert(float width, float value)
+		{
+			widths[next] = width;
+			values[next] = value;
+			next = (next + 1) % max_entries;
+			count = clan::min(count + 1, (int)max_entries);
+		}
+
+		void clear()
+		{
+			count = 0;
+			next = 0;
+		}
+
+	private:
+		enum { max_entries = 4 };
+		float widths[max_entries];
+		float values[max_entries];
+		int count = 0;
+		int next = 0;
+	};
+
 	class ViewLayoutCache
 	{
 	public:
 		bool preferred_width_calculated = false;
 		float preferred_width = 0.0f;
-		std::map<float, float> preferred_height;
-		std::map<float, float> first_baseline_offset;
-		std::map<float, float> last_baseline_offset;
+		ViewLayoutMemo preferred_height;
+		ViewLayoutMemo first_baseline_offset;
+		ViewLayoutMemo last_baseline_offset;
 
 		void clear()
 		{
@@ -65,9 +111,17 @@ namespace clan
 	class ViewImpl
 	{
 	public:
+		~ViewImpl() { release_layer(); }
+
 		void render(View *self, Canvas &canvas, ViewRenderLayer layer);
+		void render_layer(View *self, Canvas &canvas);
+		void render_tiles(View *self, Canvas &canvas);
+		void release_layer();
+		bool uses_layer() const { return layer_cached || layer_tiled || layer_opacity < 1.0f; }
 		void process_event(View *self, EventUI *e, bool use_capture);
-		void update_style_cascade() const;
+		bool update_style_cascade() const;
+		void compile_style_rules();
+		void set_state_enabled(View *self, const std::string &name, bool value);
 
 		unsigned int find_next_tab_index(unsigned int tab_index) const;
 		unsigned int find_prev_tab_index(unsigned int tab_index) const;
@@ -77,6 +131,18 @@ namespace clan
 
 		void set_state_cascade_siblings(const std::string &name, bool value);
 
+		/// Marks the ancestors of a view as having a descendant that needs layout
+		static void set_subtree_needs_layout(View *view);
+
+		/// Test if the preferred size of a view is independent of its content
+		static bool is_layout_boundary(const View *view);
+
+		/// Marks the cached layers of a view and its ancestors as needing to be rendered again
+		static void set_layers_dirty(View *view);
+
+		/// Updates the hit grid of the superview after the border box of a view changed
+		static void update_hit_grid(View *view, const Rectf &old_border_box);
+
 		void inverse_bubble(EventUI *e);
 
 		View *_superview = nullptr;
@@ -97,16 +163,48 @@ namespace clan
 		};
 
 		std::map<std::string, StyleState> states;
+
+		/// Selector of a style in styles, with the state names replaced by their ids
+		struct StyleRule
+		{
+			std::vector<unsigned int> state_ids;
+			Style *style = nullptr;
+		};
+
+		std::vector<StyleRule> style_rules;	// Most specific first
+		std::vector<bool> rule_state_ids;	// States referenced by any rule, indexed by state id
+		std::vector<bool> enabled_state_ids;	// Mirrors the enabled flags in states, indexed by state id
+
+		/// Returns a small number identifying a state name in all views
+		static unsigned int state_id(const std::string &name);
 		
 		ViewGeometry _geometry;
 		bool hidden = false;
 
+		std::unique_ptr<ViewHitGrid> hit_grid;
+		bool hit_grid_dirty = true;
+		unsigned int hit_grid_index = 0;	// Index in the subviews of the superview when its hit grid was built
+
 		Mat4f view_transform = Mat4f::identity();
 		bool content_clipped = false;
 
+		bool layer_cached = false;
+		float layer_opacity = 1.0f;
+		bool layer_dirty = true;
+		bool rendering_layer = false;
+		RenderTargetPool layer_pool;
+		Texture2D layer_texture;
+		FrameBuffer layer_frame_buffer;
+		Canvas layer_canvas;
+		BlendState layer_composite_state;
+
+		bool layer_tiled = false;
+		std::unique_ptr<ViewTileCache> tile_cache;
+
 		bool exception_encountered = false;
 
 		bool needs_layout = true;
+		bool subtree_needs_layout = false;
 
 		Signal<void(ActivationChangeEvent &)> _sig_activated[2];
 		Signal<void(ActivationChangeEvent &)> _sig_deactivated[2];
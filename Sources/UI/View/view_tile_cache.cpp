@@ -0,0 +1,221 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "UI/precomp.h"
+#include "view_tile_cache.h"
+#include "API/Display/Render/blend_state_description.h"
+#include "API/Core/System/system.h"
+#include <algorithm>
+#include <cmath>
+
+namespace clan
+{
+	void ViewTileCache::update(Canvas &canvas, const RenderTargetPool &new_pool, const Rectf &new_bounds, const Rectf &visible_box, float new_pixel_ratio)
+	{
+		if (new_pixel_ratio != pixel_ratio || new_bounds.get_size() != bounds.get_size())
+		{
+			release();
+			pixel_ratio = new_pixel_ratio;
+		}
+		pool = new_pool;
+		bounds = new_bounds;
+
+		// The visible rectangle moves the opposite way of the content, so its position works as the scroll position
+		uint64_t time = System::get_time();
+		Pointf visible_pos(visible_box.left - bounds.left, visible_box.top - bounds.top);
+		if (last_update_time != 0 && time > last_update_time && time - last_update_time < 250)
+		{
+			float seconds = (time - last_update_time) / 1000.0f;
+			Vec2f frame_velocity((visible_pos.x - last_visible_pos.x) / seconds, (visible_pos.y - last_visible_pos.y) / seconds);
+			velocity = velocity * 0.5f + frame_velocity * 0.5f;
+		}
+		else if (last_update_time == 0 || time - last_update_time >= 250)
+		{
+			velocity = Vec2f();
+		}
+		last_visible_pos = visible_pos;
+		last_update_time = time;
+
+		// Prefetch where the visible rectangle will be in a few frames, but never less than one tile ahead
+		const float lookahead_seconds = 0.3f;
+		Vec2f ahead = velocity * lookahead_seconds;
+		if (ahead.x != 0.0f)
+			ahead.x = ahead.x < 0.0f ? std::min(ahead.x, -tile_size()) : std::max(ahead.x, tile_size());
+		if (ahead.y != 0.0f)
+			ahead.y = ahead.y < 0.0f ? std::min(ahead.y, -tile_size()) : std::max(ahead.y, tile_size());
+
+		Rectf predicted = visible_box;
+		predicted.translate(ahead.x, ahead.y);
+		Rectf prefetch_box = visible_box;
+		prefetch_box.bounding_rect(predicted);
+		prefetch_box.clip(bounds);
+
+		Rectf keep_box = prefetch_box;
+		keep_box.expand(tile_size());
+		evict_tiles(keep_box);
+
+		visible.clear();
+		prefetch.clear();
+
+		Rectf visible_bounds = visible_box;
+		visible_bounds.clip(bounds);
+		if (visible_bounds.get_width() > 0.0f && visible_bounds.get_height() > 0.0f)
+			collect_tiles(canvas, visible_bounds, visible);
+
+		if (prefetch_box.get_width() > 0.0f && prefetch_box.get_height() > 0.0f)
+		{
+			std::vector<Tile *> candidates;
+			collect_tiles(canvas, prefetch_box, candidates);
+
+			Pointf center = visible_box.get_center();
+			for (Tile *tile : candidates)
+			{
+				if (!tile->box.is_overlapped(visible_bounds))
+					prefetch.push_back(tile);
+			}
+
+			std::sort(prefetch.begin(), prefetch.end(), [&](const Tile *a, const Tile *b)
+			{
+				return a->box.get_center().distance(center) < b->box.get_center().distance(center);
+			});
+		}
+	}
+
+	Canvas &ViewTileCache::begin_tile(Canvas &canvas, Tile &tile)
+	{
+		if (tile_frame_buffer.is_null())
+			tile_frame_buffer = pool.acquire_frame_buffer(canvas);
+
+		tile_frame_buffer.attach_color(0, tile.texture);
+
+		if (tile_canvas.is_null())
+		{
+			tile_canvas = Canvas(canvas, tile_frame_buffer);
+
+			// Store premultiplied colors, so that the tiles composite the same way as the views would have
+			BlendStateDescription blend_desc;
+			blend_desc.set_blend_function(blend_src_alpha, blend_one_minus_src_alpha, blend_one, blend_one_minus_src_alpha);
+			tile_canvas.set_blend_state(BlendState(canvas, blend_desc));
+
+			BlendStateDescription composite_desc;
+			composite_desc.set_blend_function(blend_one, blend_one_minus_src_alpha, blend_one, blend_one_minus_src_alpha);
+			tile_composite_state = BlendState(canvas, composite_desc);
+		}
+
+		tile_canvas.clear(Colorf::transparent);
+		tile_canvas.set_transform(Mat4f::translate(-tile.box.left, -tile.box.top, 0.0f));
+		return tile_canvas;
+	}
+
+	void ViewTileCache::invalidate()
+	{
+		for (auto &it : tiles)
+			it.second->dirty = true;
+	}
+
+	void ViewTileCache::release()
+	{
+		tiles.clear();
+		visible.clear();
+		prefetch.clear();
+
+		if (!pool.is_null())
+		{
+			for (auto &texture : spare_textures)
+				pool.release(texture);
+			if (!tile_frame_buffer.is_null())
+				pool.release(tile_frame_buffer);
+		}
+		spare_textures.clear();
+		tile_frame_buffer = FrameBuffer();
+		tile_canvas = Canvas();
+	}
+
+	void ViewTileCache::evict_tiles(const Rectf &keep_box)
+	{
+		for (auto it = tiles.begin(); it != tiles.end();)
+		{
+			if (!it->second->box.is_overlapped(keep_box))
+			{
+				if ((int)spare_textures.size() < max_spare_textures)
+					spare_textures.push_back(it->second->texture);
+				else if (!pool.is_null())
+					pool.release(it->second->texture);
+				it = tiles.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+	}
+
+	ViewTileCache::Tile *ViewTileCache::get_tile(Canvas &canvas, int column, int row)
+	{
+		std::unique_ptr<Tile> &tile = tiles[TileIndex(column, row)];
+		if (!tile)
+		{
+			tile.reset(new Tile());
+
+			if (!spare_textures.empty())
+			{
+				tile->texture = spare_textures.back();
+				spare_textures.pop_back();
+			}
+			else
+			{
+				tile->texture = pool.acquire_texture(canvas, Size(tile_pixel_size, tile_pixel_size));
+				tile->texture.set_pixel_ratio(pixel_ratio);
+			}
+		}
+
+		// Tile boxes follow the view when it moves. The last row and column are cut off at the edge of the view.
+		float size = tile_size();
+		tile->box = Rectf(bounds.left + column * size, bounds.top + row * size, std::min(bounds.left + (column + 1) * size, bounds.right), std::min(bounds.top + (row + 1) * size, bounds.bottom));
+		tile->pixel_size = Size(
+			std::min((int)std::ceil(tile->box.get_width() * pixel_ratio), (int)tile_pixel_size),
+			std::min((int)std::ceil(tile->box.get_height() * pixel_ratio), (int)tile_pixel_size));
+		return tile.get();
+	}
+
+	void ViewTileCache::collect_tiles(Canvas &canvas, const Rectf &box, std::vector<Tile *> &out_tiles)
+	{
+		float size = tile_size();
+		int first_column = (int)std::floor((box.left - bounds.left) / size);
+		int last_column = (int)std::ceil((box.right - bounds.left) / size);
+		int first_row = (int)std::floor((box.top - bounds.top) / size);
+		int last_row = (int)std::ceil((box.bottom - bounds.top) / size);
+
+		for (int row = std::max(first_row, 0); row < last_row; row++)
+		{
+			for (int column = std::max(first_column, 0); column < last_column; column++)
+				out_tiles.push_back(get_tile(canvas, column, row));
+		}
+	}
+}
@@ -0,0 +1,118 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include "API/Display/Render/render_target_pool.h"
+#include "API/Display/Render/texture_2d.h"
+#include "API/Display/Render/frame_buffer.h"
+#include "API/Display/Render/blend_state.h"
+#include "API/Display/2D/canvas.h"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace clan
+{
+	/// \brief Fixed size textures holding the rendered content of a view, for views much larger than their visible part
+	///
+	/// Only the tiles covering the visible part of the view, and the part it is predicted to scroll to next, are kept.
+	/// Tile boxes are relative to the border box of the view, so moving the view does not invalidate them.
+	class ViewTileCache
+	{
+	public:
+		enum
+		{
+			tile_pixel_size = 256,
+			max_spare_textures = 8,
+			max_prefetch_per_frame = 2
+		};
+
+		struct Tile
+		{
+			Rectf box;			// In the coordinate system of the border box
+			Size pixel_size;	// Part of the texture covered by the view
+			Texture2D texture;
+			bool dirty = true;
+		};
+
+		~ViewTileCache() { release(); }
+
+		/// \brief Places the tiles for a new frame
+		///
+		/// \param bounds = Border box of the view
+		/// \param visible = Part of the border box visible this frame
+		void update(Canvas &canvas, const RenderTargetPool &pool, const Rectf &bounds, const Rectf &visible, float pixel_ratio);
+
+		/// \brief Tiles overlapping the visible rectangle
+		const std::vector<Tile *> &visible_tiles() const { return visible; }
+
+		/// \brief Tiles expected to come into view soon, nearest first
+		const std::vector<Tile *> &prefetch_tiles() const { return prefetch; }
+
+		/// \brief Returns a canvas drawing into the texture of a tile, with the transform set up for the tile box
+		Canvas &begin_tile(Canvas &canvas, Tile &tile);
+
+		/// \brief Blend state compositing the premultiplied tiles
+		const BlendState &composite_state() const { return tile_composite_state; }
+
+		/// \brief Marks all tiles as needing to be rendered again
+		void invalidate();
+
+		/// \brief Hands all textures back to the pool
+		void release();
+
+	private:
+		typedef std::pair<int, int> TileIndex;
+
+		void evict_tiles(const Rectf &keep_box);
+		Tile *get_tile(Canvas &canvas, int column, int row);
+		void collect_tiles(Canvas &canvas, const Rectf &box, std::vector<Tile *> &out_tiles);
+		float tile_size() const { return tile_pixel_size / pixel_ratio; }
+
+		std::map<TileIndex, std::unique_ptr<Tile>> tiles;
+		std::vector<Texture2D> spare_textures;
+		std::vector<Tile *> visible;
+		std::vector<Tile *> prefetch;
+
+		Rectf bounds;
+		float pixel_ratio = 0.0f;
+
+		// Scroll velocity in dips per second, measured from the movement of the visible rectangle
+		Pointf last_visible_pos;
+		uint64_t last_update_time = 0;
+		Vec2f velocity;
+
+		RenderTargetPool pool;
+		FrameBuffer tile_frame_buffer;
+		Canvas tile_canvas;
+		BlendState tile_composite_state;
+	};
+}
@@ -37,6 +37,7 @@
 #include "API/XML/dom_element.h"
 #include "API/Core/Text/string_help.h"
 #include "API/XML/Resources/xml_resource_document.h"
+#include "XML/Resources/xml_preload_cache.h"
 
 namespace clan
 {
@@ -60,7 +61,7 @@ namespace clan
 			if (tag_name == "image" || tag_name == "image-file")
 			{
 				std::string image_name = cur_element.get_attribute("file");
-				Texture2D texture = Texture2D(canvas, PathHelp::combine(resource.get_base_path(), image_name), resource.get_file_system());
+				Texture2D texture = XMLPreloadCache::load_texture(canvas, PathHelp::combine(resource.get_base_path(), image_name), resource.get_file_system());
 
 				DomNode cur_child(cur_element.get_first_child());
 				if (cur_child.is_null())
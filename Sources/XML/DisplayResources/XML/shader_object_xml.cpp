@@ -35,6 +35,7 @@
 #include "API/XML/Resources/xml_resource_node.h"
 #include "API/XML/dom_element.h"
 #include "API/Display/Render/shader_object.h"
+#include "XML/Resources/xml_preload_cache.h"
 
 namespace clan
 {
@@ -52,12 +53,7 @@ namespace clan
 		else
 			throw Exception("ShaderObject: Unknown shader type: " + type);
 
-		FileSystem fs = resource.get_file_system();
-
-		IODevice file = fs.open_file(PathHelp::combine(resource.get_base_path(), filename), File::open_existing, File::access_read, File::share_read);
-		int size = file.get_size();
-		std::string source(size, 0);
-		file.read(&source[0], size);
+		std::string source = XMLPreloadCache::load_text(PathHelp::combine(resource.get_base_path(), filename), resource.get_file_system());
 
 		ShaderObject shader_object(gc, shader_type, StringHelp::local8_to_text(source));
 
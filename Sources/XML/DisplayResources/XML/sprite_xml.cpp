@@ -38,6 +38,7 @@
 #include "API/Display/2D/sprite.h"
 #include "API/Display/2D/canvas.h"
 #include "API/Display/Render/texture_2d.h"
+#include "XML/Resources/xml_preload_cache.h"
 
 namespace clan
 {
@@ -125,7 +126,7 @@ namespace clan
 				{
 					std::string image_name = cur_element.get_attribute("file");
 					FileSystem fs = resource.get_file_system();
-					Texture2D texture = Texture2D(canvas, PathHelp::combine(resource.get_base_path(), image_name), fs);
+					Texture2D texture = XMLPreloadCache::load_texture(canvas, PathHelp::combine(resource.get_base_path(), image_name), fs);
 
 					DomNode cur_child(cur_element.get_first_child());
 					if (cur_child.is_null())
@@ -39,6 +39,7 @@
 #include "API/Core/Text/string_format.h"
 #include "API/Core/Text/string_help.h"
 #include "API/XML/dom_element.h"
+#include "API/XML/Resources/xml_resource_node.h"
 #include "API/Core/IOData/path_help.h"
 #include "xml_display_cache.h"
 #include "API/XML/Resources/resource_factory.h"
@@ -59,8 +60,14 @@ namespace clan
 
 
 	XMLDisplayCache::XMLDisplayCache(const XMLResourceDocument &doc)
-		: doc(doc)
+		: doc(doc),
+		sprites([](const Sprite &sprite) { return estimate_size(sprite); }),
+		images([](const Image &image) { return estimate_size(image); }),
+		textures([](const Texture &texture) { return estimate_size(texture); })
 	{
+		sprites.func_evicted() = [this](const std::string &id, Resource<Sprite> &) { if (func_resource_evicted()) func_resource_evicted()(display_cache_sprite, id); };
+		images.func_evicted() = [this](const std::string &id, Resource<Image> &) { if (func_resource_evicted()) func_resource_evicted()(display_cache_image, id); };
+		textures.func_evicted() = [this](const std::string &id, Resource<Texture> &) { if (func_resource_evicted()) func_resource_evicted()(display_cache_texture, id); };
 	}
 
 	XMLDisplayCache::~XMLDisplayCache()
@@ -69,44 +76,82 @@ namespace clan
 
 	Resource<Sprite> XMLDisplayCache::get_sprite(Canvas &canvas, const std::string &id)
 	{
-		auto it = sprites.find(id);
-		if (it != sprites.end())
+		Resource<Sprite> cached_sprite;
+		if (sprites.find(id, cached_sprite))
 		{
-			Resource<Sprite> sprite = it->second;
-			sprite.get() = sprite.get().clone();
-			return sprite;
+			cached_sprite.get() = cached_sprite.get().clone();
+			return cached_sprite;
 		}
 
 		Resource<Sprite> sprite = Sprite::load(canvas, id, doc);
-		sprites[id] = sprite;
+		sprites.insert(id, sprite);
+
+		std::weak_ptr<Resource_Impl<Sprite> > weak_sprite = sprite.handle();
+		add_resource_file_dependencies(sprite.handle(), id, [this, canvas, weak_sprite, id]() mutable
+		{
+			std::shared_ptr<Resource_Impl<Sprite> > handle = weak_sprite.lock();
+			if (handle)
+				Resource<Sprite>(handle).set(Sprite::load(canvas, id, doc));
+		});
+
 		sprite.get() = sprite.get().clone();
 		return sprite;
 	}
 
 	Resource<Image> XMLDisplayCache::get_image(Canvas &canvas, const std::string &id)
 	{
-		auto it = images.find(id);
-		if (it != images.end())
+		Resource<Image> cached_image;
+		if (images.find(id, cached_image))
 		{
-			Resource<Image> image = it->second;
-			image.get() = image.get().clone();
-			return image;
+			cached_image.get() = cached_image.get().clone();
+			return cached_image;
 		}
 
 		Resource<Image> image = Image::load(canvas, id, doc);
-		images[id] = image;
+		images.insert(id, image);
+
+		std::weak_ptr<Resource_Impl<Image> > weak_image = image.handle();
+		add_resource_file_dependencies(image.handle(), id, [this, canvas, weak_image, id]() mutable
+		{
+			std::shared_ptr<Resource_Impl<Image> > handle = weak_image.lock();
+			if (handle)
+				Resource<Image>(handle).set(Image::load(canvas, id, doc));
+		});
+
 		image.get() = image.get().clone();
 		return image;
 	}
 
 	Resource<Texture> XMLDisplayCache::get_texture(GraphicContext &gc, const std::string &id)
 	{
-		auto it = textures.find(id);
-		if (it != textures.end())
-			return it->second;
+		Resource<Texture> cached_texture;
+		if (textures.find(id, cached_texture))
+			return cached_texture;
 
 		Resource<Texture> texture = Texture::load(gc, id, doc);
-		textures[id] = texture;
+		textures.insert(id, texture);
+
+		XMLResourceNode resource = doc.get_resource(id);
+		add_texture_file_dependency(texture, PathHelp::combine(resource.get_base_path(), resource.get_element().get_attribute("file")), resource.get_file_system());
+		return texture;
+	}
+
+	Resource<Texture> XMLDisplayCache::get_texture_async(GraphicContext &gc, const std::string &id)
+	{
+		Resource<Texture> cached_texture;
+		if (textures.find(id, cached_texture))
+			return cached_texture;
+
+		XMLResourceNode resource = doc.get_resource(id);
+		if (resource.get_type() != "texture")
+			throw Exception(string_format("Resource '%1' is not of type 'texture'", id));
+
+		std::string filename = resource.get_element().get_attribute("file");
+
+		Resource<Texture> texture;
+		textures.insert(id, texture);
+		load_texture_async(texture, PathHelp::combine(resource.get_base_path(), filename), resource.get_file_system());
+		add_texture_file_dependency(texture, PathHelp::combine(resource.get_base_path(), filename), resource.get_file_system());
 		return texture;
 	}
 
@@ -143,4 +188,61 @@ namespace clan
 
 		return font;
 	}
+
+	void XMLDisplayCache::add_resource_file_dependencies(const std::weak_ptr<Resource_BaseImpl> &resource, const std::string &id, const std::function<void()> &reload)
+	{
+		XMLResourceNode resource_node = doc.get_resource(id);
+		DomElement element = resource_node.get_element();
+
+		if (element.has_attribute("file"))
+			add_file_dependency(resource, PathHelp::combine(resource_node.get_base_path(), element.get_attribute("file")), resource_node.get_file_system(), reload);
+
+		for (DomElement child = element.get_first_child_element(); !child.is_null(); child = child.get_next_sibling_element())
+		{
+			if (child.has_attribute("file"))
+				add_file_dependency(resource, PathHelp::combine(resource_node.get_base_path(), child.get_attribute("file")), resource_node.get_file_system(), reload);
+		}
+	}
+
+	size_t XMLDisplayCache::trim(DisplayCacheResourceType type, size_t max_bytes)
+	{
+		switch (type)
+		{
+		case display_cache_sprite: return sprites.trim(max_bytes);
+		case display_cache_image: return images.trim(max_bytes);
+		case display_cache_texture: return textures.trim(max_bytes);
+		}
+		return 0;
+	}
+
+	void XMLDisplayCache::set_memory_budget(DisplayCacheResourceType type, size_t bytes)
+	{
+		switch (type)
+		{
+		case display_cache_sprite: sprites.set_budget(bytes); break;
+		case display_cache_image: images.set_budget(bytes); break;
+		case display_cache_texture: textures.set_budget(bytes); break;
+		}
+	}
+
+	size_t XMLDisplayCache::get_memory_used(DisplayCacheResourceType type) const
+	{
+		switch (type)
+		{
+		case display_cache_sprite: return sprites.get_used_bytes();
+		case display_cache_image: return images.get_used_bytes();
+		case display_cache_texture: return textures.get_used_bytes();
+		}
+		return 0;
+	}
+
+	void XMLDisplayCache::set_pinned(DisplayCacheResourceType type, const std::string &id, bool pinned)
+	{
+		switch (type)
+		{
+		case display_cache_sprite: sprites.set_pinned(id, pinned); break;
+		case display_cache_image: images.set_pinned(id, pinned); break;
+		case display_cache_texture: textures.set_pinned(id, pinned); break;
+		}
+	}
 }
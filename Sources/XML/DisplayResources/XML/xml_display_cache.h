@@ -29,6 +29,7 @@
 #pragma once
 
 #include "API/Display/Resources/display_cache.h"
+#include "API/Core/Resources/resource_cache_map.h"
 #include "API/XML/Resources/xml_resource_document.h"
 
 namespace clan
@@ -44,16 +45,25 @@ namespace clan
 		Resource<Sprite> get_sprite(Canvas &canvas, const std::string &id) override;
 		Resource<Image> get_image(Canvas &canvas, const std::string &id) override;
 		Resource<Texture> get_texture(GraphicContext &gc, const std::string &id) override;
+		Resource<Texture> get_texture_async(GraphicContext &gc, const std::string &id) override;
 		Resource<Font> get_font(Canvas &canvas, const std::string &family_name, const FontDescription &desc) override;
 
+		size_t trim(DisplayCacheResourceType type, size_t max_bytes = 0) override;
+		void set_memory_budget(DisplayCacheResourceType type, size_t bytes) override;
+		size_t get_memory_used(DisplayCacheResourceType type) const override;
+		void set_pinned(DisplayCacheResourceType type, const std::string &id, bool pinned) override;
+
 		static void add_cache_factory(ResourceManager &manager, const XMLResourceDocument &doc);
 
 	private:
+		/// \brief Records the files named by the resource element and its children as dependencies of the resource
+		void add_resource_file_dependencies(const std::weak_ptr<Resource_BaseImpl> &resource, const std::string &id, const std::function<void()> &reload);
+
 		XMLResourceDocument doc;
 
-		std::map<std::string, Resource<Sprite> > sprites;
-		std::map<std::string, Resource<Image> > images;
-		std::map<std::string, Resource<Texture> > textures;
+		ResourceCacheMap<Sprite> sprites;
+		ResourceCacheMap<Image> images;
+		ResourceCacheMap<Texture> textures;
 		std::map<std::string, FontFamily > fonts;
 	};
 }
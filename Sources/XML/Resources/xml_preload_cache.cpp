@@ -0,0 +1,128 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "XML/precomp.h"
+#include "xml_preload_cache.h"
+#include "API/Core/IOData/iodevice.h"
+#include "API/Core/IOData/file.h"
+#include "API/Display/2D/canvas.h"
+#include "API/Display/Render/texture_2d.h"
+
+namespace clan
+{
+	std::mutex XMLPreloadCache::mutex;
+	std::map<std::string, PixelBuffer> XMLPreloadCache::images;
+	std::map<std::string, std::string> XMLPreloadCache::texts;
+	std::map<std::string, SoundBuffer> XMLPreloadCache::sounds;
+
+	std::string XMLPreloadCache::get_key(const std::string &filename, const FileSystem &fs)
+	{
+		if (fs.is_null())
+			return filename;
+		return fs.get_path() + "|" + fs.get_identifier() + "|" + filename;
+	}
+
+	void XMLPreloadCache::add_image(const std::string &key, const PixelBuffer &image)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		images[key] = image;
+	}
+
+	void XMLPreloadCache::add_text(const std::string &key, const std::string &text)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		texts[key] = text;
+	}
+
+	void XMLPreloadCache::add_sound(const std::string &key, const SoundBuffer &sound)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		sounds[key] = sound;
+	}
+
+	void XMLPreloadCache::remove(const std::vector<std::string> &keys)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		for (const auto &key : keys)
+		{
+			images.erase(key);
+			texts.erase(key);
+			sounds.erase(key);
+		}
+	}
+
+	Texture2D XMLPreloadCache::load_texture(Canvas &canvas, const std::string &filename, const FileSystem &fs)
+	{
+		PixelBuffer image;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			auto it = images.find(get_key(filename, fs));
+			if (it != images.end())
+			{
+				image = it->second;
+				images.erase(it);
+			}
+		}
+
+		if (image.is_null())
+			return Texture2D(canvas, filename, fs);
+		return Texture2D(canvas, image);
+	}
+
+	std::string XMLPreloadCache::load_text(const std::string &filename, const FileSystem &fs)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			auto it = texts.find(get_key(filename, fs));
+			if (it != texts.end())
+			{
+				std::string text = std::move(it->second);
+				texts.erase(it);
+				return text;
+			}
+		}
+
+		IODevice file = fs.open_file(filename, File::open_existing, File::access_read, File::share_read);
+		int size = file.get_size();
+		std::string text(size, 0);
+		file.read(&text[0], size);
+		return text;
+	}
+
+	SoundBuffer XMLPreloadCache::take_sound(const std::string &key)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		auto it = sounds.find(key);
+		if (it == sounds.end())
+			return SoundBuffer();
+		SoundBuffer sound = it->second;
+		sounds.erase(it);
+		return sound;
+	}
+}
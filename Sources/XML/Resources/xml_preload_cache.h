@@ -0,0 +1,80 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include "API/Core/IOData/file_system.h"
+#include "API/Display/Image/pixel_buffer.h"
+#include "API/Sound/soundbuffer.h"
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace clan
+{
+	class Canvas;
+	class Texture2D;
+
+	/// \brief Files read and decoded by XMLResourcePreloader on worker threads
+	///
+	/// The resource loaders of the XML module take their file from here before falling back to reading it,
+	/// so a preloaded file is only used once. Entries left over when the preloader is destroyed are removed.
+	class XMLPreloadCache
+	{
+	public:
+		/// \brief Returns the key of a file opened through a file system
+		static std::string get_key(const std::string &filename, const FileSystem &fs);
+
+		/// \brief Returns the key of a sound file loaded in a format
+		static std::string get_sound_key(const std::string &filename, const std::string &format) { return filename + "|" + format; }
+
+		static void add_image(const std::string &key, const PixelBuffer &image);
+		static void add_text(const std::string &key, const std::string &text);
+		static void add_sound(const std::string &key, const SoundBuffer &sound);
+
+		/// \brief Removes the entries of keys not taken yet
+		static void remove(const std::vector<std::string> &keys);
+
+		/// \brief Creates a texture from a preloaded image, or loads the image file if it was not preloaded
+		static Texture2D load_texture(Canvas &canvas, const std::string &filename, const FileSystem &fs);
+
+		/// \brief Returns a preloaded text file, or reads the file if it was not preloaded
+		static std::string load_text(const std::string &filename, const FileSystem &fs);
+
+		/// \brief Removes and returns a preloaded sound. Returns a null sound buffer if there is none.
+		static SoundBuffer take_sound(const std::string &key);
+
+	private:
+		static std::mutex mutex;
+		static std::map<std::string, PixelBuffer> images;
+		static std::map<std::string, std::string> texts;
+		static std::map<std::string, SoundBuffer> sounds;
+	};
+}
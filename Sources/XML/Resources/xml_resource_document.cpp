@@ -32,15 +32,186 @@
 #include "API/Core/IOData/file_system.h"
 #include "API/Core/IOData/path_help.h"
 #include "API/Core/IOData/file.h"
+#include "API/Core/IOData/memory_device.h"
+#include "API/Core/System/databuffer.h"
 #include "API/XML/dom_document.h"
 #include "API/XML/dom_element.h"
+#include "API/XML/dom_named_node_map.h"
+#include "API/XML/dom_text.h"
+#include "API/XML/dom_cdata_section.h"
+#include "API/XML/dom_comment.h"
+#include "API/XML/dom_processing_instruction.h"
+#include "API/XML/xml_reader.h"
+#include "API/XML/xml_token.h"
 #include "API/Core/Text/string_format.h"
 #include "API/Core/Text/string_help.h"
 #include "xml_resource_document_impl.h"
 #include <map>
+#include <unordered_map>
+#include <algorithm>
 
 namespace clan
 {
+	namespace
+	{
+		const char compiled_magic[4] = { 'C', 'L', 'R', 'B' };
+		const uint32_t compiled_version = 1;
+
+		/// \brief Writes a resource document as a string table, a preorder node stream and the resource index
+		class CompiledResourceWriter
+		{
+		public:
+			std::vector<unsigned char> strings_data;
+			std::vector<unsigned char> nodes_data;
+			std::unordered_map<std::string, uint32_t> string_indices;
+			std::vector<DomElement> elements;
+
+			static void write(std::vector<unsigned char> &out, uint32_t value)
+			{
+				out.push_back(value & 0xff);
+				out.push_back((value >> 8) & 0xff);
+				out.push_back((value >> 16) & 0xff);
+				out.push_back((value >> 24) & 0xff);
+			}
+
+			uint32_t string_index(const std::string &str)
+			{
+				auto it = string_indices.find(str);
+				if (it != string_indices.end())
+					return it->second;
+
+				uint32_t index = (uint32_t)string_indices.size();
+				string_indices[str] = index;
+				write(strings_data, (uint32_t)str.length());
+				strings_data.insert(strings_data.end(), str.begin(), str.end());
+				return index;
+			}
+
+			void write_node(const DomNode &node)
+			{
+				write(nodes_data, node.get_node_type());
+				write(nodes_data, string_index(node.get_namespace_uri()));
+				write(nodes_data, string_index(node.get_node_name()));
+				write(nodes_data, string_index(node.get_node_value()));
+
+				if (node.is_element())
+				{
+					elements.push_back(node.to_element());
+
+					DomNamedNodeMap attributes = node.get_attributes();
+					int num_attributes = attributes.get_length();
+					write(nodes_data, num_attributes);
+					for (int i = 0; i < num_attributes; i++)
+					{
+						DomNode attribute = attributes.item(i);
+						write(nodes_data, string_index(attribute.get_namespace_uri()));
+						write(nodes_data, string_index(attribute.get_node_name()));
+						write(nodes_data, string_index(attribute.get_node_value()));
+					}
+				}
+				else
+				{
+					write(nodes_data, 0);
+				}
+
+				uint32_t num_children = 0;
+				for (DomNode child = node.get_first_child(); !child.is_null(); child = child.get_next_sibling())
+					num_children++;
+				write(nodes_data, num_children);
+				for (DomNode child = node.get_first_child(); !child.is_null(); child = child.get_next_sibling())
+					write_node(child);
+			}
+		};
+
+		/// \brief Rebuilds the DOM of a compiled resource document without tokenizing or resolving namespaces
+		class CompiledResourceReader
+		{
+		public:
+			CompiledResourceReader(const DataBuffer &buffer) : data((const unsigned char *)buffer.get_data()), size(buffer.get_size()), pos(sizeof(compiled_magic)) { }
+
+			const unsigned char *data;
+			size_t size;
+			size_t pos;
+			std::vector<std::string> strings;
+			std::vector<DomElement> elements;
+
+			uint32_t read()
+			{
+				if (pos + 4 > size)
+					throw Exception("Compiled resource document is truncated");
+				uint32_t value = data[pos] | (data[pos + 1] << 8) | (data[pos + 2] << 16) | ((uint32_t)data[pos + 3] << 24);
+				pos += 4;
+				return value;
+			}
+
+			const std::string &read_string()
+			{
+				uint32_t index = read();
+				if (index >= strings.size())
+					throw Exception("Invalid string index in compiled resource document");
+				return strings[index];
+			}
+
+			void read_strings()
+			{
+				uint32_t num_strings = read();
+				strings.reserve(num_strings);
+				for (uint32_t i = 0; i < num_strings; i++)
+				{
+					uint32_t length = read();
+					if (length > size - pos)
+						throw Exception("Compiled resource document is truncated");
+					strings.push_back(std::string((const char *)data + pos, length));
+					pos += length;
+				}
+			}
+
+			void read_node(DomDocument &document, DomNode &parent)
+			{
+				unsigned short node_type = read();
+				const std::string &namespace_uri = read_string();
+				const std::string &name = read_string();
+				const std::string &value = read_string();
+
+				DomNode node;
+				switch (node_type)
+				{
+				case DomNode::ELEMENT_NODE:
+					node = document.create_element_ns(namespace_uri, name);
+					elements.push_back(node.to_element());
+					break;
+				case DomNode::TEXT_NODE:
+					node = document.create_text_node(value);
+					break;
+				case DomNode::CDATA_SECTION_NODE:
+					node = document.create_cdata_section(value);
+					break;
+				case DomNode::COMMENT_NODE:
+					node = document.create_comment(value);
+					break;
+				case DomNode::PROCESSING_INSTRUCTION_NODE:
+					node = document.create_processing_instruction(name, value);
+					break;
+				default:
+					throw Exception("Unsupported node type in compiled resource document");
+				}
+				parent.append_child(node);
+
+				uint32_t num_attributes = read();
+				for (uint32_t i = 0; i < num_attributes; i++)
+				{
+					const std::string &attribute_namespace_uri = read_string();
+					const std::string &attribute_name = read_string();
+					const std::string &attribute_value = read_string();
+					node.to_element().set_attribute_ns(attribute_namespace_uri, attribute_name, attribute_value);
+				}
+
+				uint32_t num_children = read();
+				for (uint32_t i = 0; i < num_children; i++)
+					read_node(document, node);
+			}
+		};
+	}
 	XMLResourceDocument::XMLResourceDocument()
 		: impl(std::make_shared<XMLResourceDocument_Impl>())
 	{
@@ -88,9 +259,7 @@ namespace clan
 
 	bool XMLResourceDocument::resource_exists(const std::string &resource_id) const
 	{
-		std::map<std::string, XMLResourceNode>::const_iterator it;
-		it = impl->resources.find(resource_id);
-		if (it != impl->resources.end())
+		if (impl->name_table.find(resource_id, impl->handle_names) != -1)
 			return true;
 
 		for (std::vector<XMLResourceDocument>::const_iterator it = impl->additional_resources.begin();
@@ -216,13 +385,40 @@ namespace clan
 		return node;
 	}
 
-	XMLResourceNode XMLResourceDocument_Impl::get_resource(const std::string &resource_id) const
+	int XMLResourceDocument::get_resource_handle(const std::string &resource_id) const
 	{
-		std::map<std::string, XMLResourceNode>::const_iterator it;
-		it = resources.find(resource_id);
-		if (it != resources.end())
+		int handle = impl->name_table.find(resource_id, impl->handle_names);
+		if (handle != -1)
+			return handle;
+
+		auto it = impl->additional_handles.find(resource_id);
+		if (it != impl->additional_handles.end())
 			return it->second;
 
+		XMLResourceNode node = impl->get_resource(resource_id);
+		if (node.is_null())
+			return -1;
+
+		handle = (int)impl->handle_nodes.size();
+		impl->handle_names.push_back(resource_id);
+		impl->handle_nodes.push_back(node);
+		impl->additional_handles[resource_id] = handle;
+		return handle;
+	}
+
+	XMLResourceNode XMLResourceDocument::get_resource_by_handle(int handle) const
+	{
+		if (handle < 0 || handle >= (int)impl->handle_nodes.size() || impl->handle_nodes[handle].is_null())
+			throw Exception(string_format("Invalid resource handle: %1", handle));
+		return impl->handle_nodes[handle];
+	}
+
+	XMLResourceNode XMLResourceDocument_Impl::get_resource(const std::string &resource_id) const
+	{
+		int handle = name_table.find(resource_id, handle_names);
+		if (handle != -1)
+			return handle_nodes[handle];
+
 		std::vector<XMLResourceDocument>::size_type i;
 		for (i = 0; i < additional_resources.size(); i++)
 		{
@@ -291,6 +487,11 @@ namespace clan
 			if (impl->additional_resources[i] == additional_resources)
 			{
 				impl->additional_resources.erase(impl->additional_resources.begin() + i);
+
+				// Resolved again on the next get_resource_handle, as they may now come from another document
+				for (const auto &it : impl->additional_handles)
+					impl->handle_nodes[it.second] = XMLResourceNode();
+				impl->additional_handles.clear();
 				break;
 			}
 		}
@@ -363,8 +564,12 @@ namespace clan
 		parent.append_child(resource_node);
 
 		// Create resource:
-		impl->resources[resource_id] = XMLResourceNode(resource_node, *this);
-		return impl->resources[resource_id];
+		XMLResourceNode resource(resource_node, *this);
+		impl->resources[resource_id] = resource;
+		impl->handle_names.push_back(resource_id);
+		impl->handle_nodes.push_back(resource);
+		impl->name_table.build(impl->handle_names, impl->handle_nodes);
+		return resource;
 	}
 
 	void XMLResourceDocument::destroy_resource(const std::string &resource_id)
@@ -375,6 +580,13 @@ namespace clan
 			return;
 		DomNode cur = it->second.get_element();
 		impl->resources.erase(it);
+
+		int handle = impl->name_table.find(resource_id, impl->handle_names);
+		if (handle != -1)
+		{
+			impl->handle_nodes[handle] = XMLResourceNode();
+			impl->name_table.build(impl->handle_names, impl->handle_nodes);
+		}
 		DomNode parent = cur.get_parent_node();
 		while (!parent.is_null())
 		{
@@ -402,6 +614,43 @@ namespace clan
 		impl->document.save(file);
 	}
 
+	void XMLResourceDocument::save_compiled(const std::string &filename)
+	{
+		File file(filename, File::create_always, File::access_read_write);
+		save_compiled(file);
+	}
+
+	void XMLResourceDocument::save_compiled(IODevice file)
+	{
+		CompiledResourceWriter writer;
+		uint32_t ns_resources_index = writer.string_index(impl->ns_resources);
+		writer.write_node(impl->document.get_document_element());
+
+		std::vector<unsigned char> index_data;
+		CompiledResourceWriter::write(index_data, (uint32_t)impl->resources.size());
+		for (auto &resource : impl->resources)
+		{
+			DomElement element = resource.second.get_element();
+			auto it = std::find(writer.elements.begin(), writer.elements.end(), element);
+			if (it == writer.elements.end())
+				throw Exception(string_format("Resource %1 is not part of the document", resource.first));
+
+			CompiledResourceWriter::write(index_data, writer.string_index(resource.first));
+			CompiledResourceWriter::write(index_data, (uint32_t)(it - writer.elements.begin()));
+		}
+
+		std::vector<unsigned char> header;
+		header.insert(header.end(), compiled_magic, compiled_magic + sizeof(compiled_magic));
+		CompiledResourceWriter::write(header, compiled_version);
+		CompiledResourceWriter::write(header, (uint32_t)writer.string_indices.size());
+		CompiledResourceWriter::write(writer.strings_data, ns_resources_index);
+
+		file.write(header.data(), header.size());
+		file.write(writer.strings_data.data(), writer.strings_data.size());
+		file.write(writer.nodes_data.data(), writer.nodes_data.size());
+		file.write(index_data.data(), index_data.size());
+	}
+
 	void XMLResourceDocument::load(const std::string &fullname)
 	{
 		std::string path = PathHelp::get_fullpath(fullname, PathHelp::path_type_file);
@@ -418,18 +667,47 @@ namespace clan
 
 	void XMLResourceDocument::load(IODevice file, const std::string &base_path, const FileSystem &fs)
 	{
-		DomDocument new_document;
-		new_document.load(file);
+		DataBuffer data(file.get_size());
+		if (data.get_size() > 0)
+			file.read(data.get_data(), data.get_size());
+
+		if (data.get_size() >= sizeof(compiled_magic) && memcmp(data.get_data(), compiled_magic, sizeof(compiled_magic)) == 0)
+		{
+			load_compiled(data, base_path, fs);
+			return;
+		}
+
+		// Check the document element with a streaming reader, so no DOM is built for documents that are rejected:
+		XMLToken root_token;
+		XMLReader reader(data);
+		reader.func_begin_element() = [&](const XMLToken &token) { root_token = token; reader.stop(); };
+		reader.parse();
+
+		std::string root_name = root_token.name;
+		std::string root_prefix;
+		std::string::size_type colon = root_name.find(':');
+		if (colon != std::string::npos)
+		{
+			root_prefix = root_name.substr(0, colon);
+			root_name = root_name.substr(colon + 1);
+		}
+
+		std::string root_namespace_uri;
+		std::string xmlns_attribute = root_prefix.empty() ? "xmlns" : "xmlns:" + root_prefix;
+		for (const auto &attribute : root_token.attributes)
+		{
+			if (attribute.first == xmlns_attribute)
+				root_namespace_uri = attribute.second;
+		}
 
 		// Check if loaded document uses namespaces and if its a clanlib resources xml document:
-		DomElement doc_element = new_document.get_document_element();
-		if (doc_element.get_namespace_uri().empty() && doc_element.get_local_name() == "resources")
+		if (root_namespace_uri.empty() && root_name == "resources")
 		{
 			impl->ns_resources = std::string();
 		}
-		else if (doc_element.get_namespace_uri() == "http://clanlib.org/xmlns/resources-1.0")
+		else if (root_namespace_uri == "http://clanlib.org/xmlns/resources-1.0")
 		{
-			if (doc_element.get_local_name() != "resources")
+			if (root_name != "resources")
 				throw Exception("ClanLib resource documents must begin with a resources element.");
 
 			impl->ns_resources = "http://clanlib.org/xmlns/resources-1.0";
@@ -439,6 +717,11 @@ namespace clan
 			throw Exception("XML document is not a ClanLib resources document.");
 		}
 
+		MemoryDevice memory(data);
+		DomDocument new_document;
+		new_document.load(memory);
+		DomElement doc_element = new_document.get_document_element();
+
 		impl->document = new_document;
 		impl->fs = fs;
 		impl->base_path = base_path;
@@ -479,5 +762,141 @@ namespace clan
 				nodes_stack.back() = nodes_stack.back().get_next_sibling();
 			}
 		}
+
+		impl->build_handles();
+	}
+
+	void XMLResourceDocument::load_compiled(const DataBuffer &data, const std::string &base_path, const FileSystem &fs)
+	{
+		CompiledResourceReader reader(data);
+		if (reader.read() != compiled_version)
+			throw Exception("Unsupported compiled resource document version");
+
+		reader.read_strings();
+		std::string ns_resources = reader.read_string();
+
+		DomDocument new_document;
+		reader.read_node(new_document, new_document);
+
+		impl->ns_resources = ns_resources;
+		impl->document = new_document;
+		impl->fs = fs;
+		impl->base_path = base_path;
+		impl->resources.clear();
+
+		// The resource index was resolved when compiling, so the sections do not need to be walked
+		uint32_t num_resources = reader.read();
+		for (uint32_t i = 0; i < num_resources; i++)
+		{
+			const std::string &resource_id = reader.read_string();
+			uint32_t element_index = reader.read();
+			if (element_index >= reader.elements.size())
+				throw Exception("Invalid resource index in compiled resource document");
+			impl->resources[resource_id] = XMLResourceNode(reader.elements[element_index], *this);
+		}
+
+		impl->build_handles();
+	}
+
+	void XMLResourceDocument_Impl::build_handles()
+	{
+		handle_names.clear();
+		handle_nodes.clear();
+		additional_handles.clear();
+		for (const auto &it : resources)
+		{
+			handle_names.push_back(it.first);
+			handle_nodes.push_back(it.second);
+		}
+		name_table.build(handle_names, handle_nodes);
+	}
+
+	void XMLResourceNameTable::build(const std::vector<std::string> &names, const std::vector<XMLResourceNode> &nodes)
+	{
+		std::vector<int> handles;
+		for (size_t i = 0; i < nodes.size(); i++)
+		{
+			if (!nodes[i].is_null())
+				handles.push_back((int)i);
+		}
+
+		seeds.clear();
+		slots.clear();
+		if (handles.empty())
+			return;
+
+		// A table about 80% full finds seeds quickly. Grow it in the unlikely case a bucket cannot be placed.
+		size_t slot_count = handles.size() + handles.size() / 4 + 1;
+		while (!try_build(names, handles, slot_count))
+			slot_count += slot_count / 2;
+	}
+
+	bool XMLResourceNameTable::try_build(const std::vector<std::string> &names, const std::vector<int> &handles, size_t slot_count)
+	{
+		std::vector<std::vector<int> > buckets(handles.size() / 4 + 1);
+		for (int handle : handles)
+			buckets[hash(names[handle], 0) % buckets.size()].push_back(handle);
+
+		// Place the largest buckets first, while the table is still empty
+		std::vector<size_t> order(buckets.size());
+		for (size_t i = 0; i < order.size(); i++)
+			order[i] = i;
+		std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return buckets[a].size() > buckets[b].size(); });
+
+		seeds.assign(buckets.size(), 0);
+		slots.assign(slot_count, -1);
+
+		std::vector<size_t> bucket_slots;
+		for (size_t bucket_index : order)
+		{
+			const std::vector<int> &bucket = buckets[bucket_index];
+			if (bucket.empty())
+				break;
+
+			bool placed = false;
+			for (uint32_t seed = 1; seed < 10000 && !placed; seed++)
+			{
+				bucket_slots.clear();
+				placed = true;
+				for (int handle : bucket)
+				{
+					size_t slot = hash(names[handle], seed) % slot_count;
+					if (slots[slot] != -1 || std::find(bucket_slots.begin(), bucket_slots.end(), slot) != bucket_slots.end())
+					{
+						placed = false;
+						break;
+					}
+					bucket_slots.push_back(slot);
+				}
+
+				if (placed)
+				{
+					seeds[bucket_index] = seed;
+					for (size_t i = 0; i < bucket.size(); i++)
+						slots[bucket_slots[i]] = bucket[i];
+				}
+			}
+
+			if (!placed)
+				return false;
+		}
+		return true;
+	}
+
+	uint32_t XMLResourceNameTable::hash(const std::string &name, uint32_t seed)
+	{
+		// FNV-1a, followed by a finalizer so that different seeds give unrelated hashes
+		uint32_t h = 2166136261u ^ (seed * 0x9e3779b9u);
+		for (unsigned char c : name)
+		{
+			h ^= c;
+			h *= 16777619u;
+		}
+		h ^= h >> 16;
+		h *= 0x85ebca6bu;
+		h ^= h >> 13;
+		h *= 0xc2b2ae35u;
+		h ^= h >> 16;
+		return h;
 	}
 }
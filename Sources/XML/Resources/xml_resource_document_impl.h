@@ -32,14 +32,46 @@
 #include "API/XML/dom_document.h"
 #include "API/XML/dom_element.h"
 #include <map>
+#include <cstdint>
 
 namespace clan
 {
+	/// \brief Perfect hash of resource names, built with the hash and displace method
+	///
+	/// Names are first hashed into buckets. Each bucket stores the seed that places all of its names
+	/// in distinct slots of the table, so a lookup costs two hashes and one string compare.
+	class XMLResourceNameTable
+	{
+	public:
+		/// \brief Builds the table for all names whose node is not null. The index of a name is its handle.
+		void build(const std::vector<std::string> &names, const std::vector<XMLResourceNode> &nodes);
+
+		/// \brief Returns the handle of a name, or -1 if it is not in the table
+		int find(const std::string &name, const std::vector<std::string> &names) const
+		{
+			if (slots.empty())
+				return -1;
+			uint32_t seed = seeds[hash(name, 0) % seeds.size()];
+			int handle = slots[hash(name, seed) % slots.size()];
+			return (handle != -1 && names[handle] == name) ? handle : -1;
+		}
+
+	private:
+		static uint32_t hash(const std::string &name, uint32_t seed);
+		bool try_build(const std::vector<std::string> &names, const std::vector<int> &handles, size_t slot_count);
+
+		std::vector<uint32_t> seeds;
+		std::vector<int> slots;
+	};
+
 	class XMLResourceDocument_Impl
 	{
 	public:
 		XMLResourceNode get_resource(const std::string &resource_id) const;
 
+		/// \brief Assigns handles to all resources and builds the name table. Invalidates existing handles.
+		void build_handles();
+
 		FileSystem fs;
 		std::string base_path;
 
@@ -48,5 +80,13 @@ namespace clan
 		std::map<std::string, XMLResourceNode> resources;
 		std::vector<XMLResourceDocument> additional_resources;
 		std::string ns_resources;
+
+		/// \brief Resource names and nodes by handle. Destroyed resources leave a null node.
+		std::vector<std::string> handle_names;
+		std::vector<XMLResourceNode> handle_nodes;
+		XMLResourceNameTable name_table;
+
+		/// \brief Handles of resources found in the additional documents
+		std::map<std::string, int> additional_handles;
 	};
 }
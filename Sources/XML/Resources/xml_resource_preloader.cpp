@@ -0,0 +1,447 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "XML/precomp.h"
+#include "API/XML/Resources/xml_resource_preloader.h"
+#include "API/XML/Resources/xml_resource_manager.h"
+#include "API/XML/Resources/xml_resource_document.h"
+#include "API/XML/Resources/xml_resource_node.h"
+#include "API/XML/dom_element.h"
+#include "API/Core/Resources/resource_manager.h"
+#include "API/Core/System/system.h"
+#include "API/Core/System/work_queue.h"
+#include "API/Core/IOData/path_help.h"
+#include "API/Core/Text/string_format.h"
+#include "API/Display/2D/canvas.h"
+#include "API/Display/2D/sprite.h"
+#include "API/Display/2D/image.h"
+#include "API/Display/Font/font.h"
+#include "API/Display/Font/font_description.h"
+#include "API/Display/Render/texture.h"
+#include "API/Display/Render/shader_object.h"
+#include "API/Display/Resources/display_cache.h"
+#include "API/Display/Image/image_import_description.h"
+#include "API/Display/ImageProviders/provider_factory.h"
+#include "API/Sound/Resources/sound_cache.h"
+#include "xml_preload_cache.h"
+#include <deque>
+#include <map>
+#include <set>
+
+namespace clan
+{
+	class XMLResourcePreloader_Impl
+	{
+	public:
+		XMLResourcePreloader_Impl(const ResourceManager &resources) : resources(resources), doc(XMLResourceManager::get_doc(resources))
+		{
+		}
+
+		~XMLResourcePreloader_Impl()
+		{
+			// Stop the worker threads before removing the files they decoded that were never used
+			work_queue.reset();
+			XMLPreloadCache::remove(keys);
+		}
+
+		enum ItemType
+		{
+			item_texture,
+			item_sprite,
+			item_image,
+			item_font,
+			item_shader,
+			item_sound
+		};
+
+		struct Item
+		{
+			std::string id;
+			ItemType type;
+			int files_pending = 0;
+			bool loaded = false;
+			Resource<Texture> texture;
+		};
+
+		struct FileJob
+		{
+			int index = 0;
+			std::string filename;
+			std::string key;
+			FileSystem fs;
+			std::string format;
+		};
+
+		void add_item(Canvas &canvas, const std::string &id);
+		std::shared_ptr<FileJob> create_job(int index, const std::string &filename, const std::string &key);
+		void queue_image(int index, const std::string &filename, const FileSystem &fs);
+		void queue_text(int index, const std::string &filename, const FileSystem &fs);
+		void queue_sound(int index, const std::string &filename, const std::string &format);
+		void file_done(int index);
+		void load_item(Canvas &canvas, Item &item);
+		void item_loaded(Item &item);
+
+		ResourceManager resources;
+		XMLResourceDocument doc;
+
+		std::vector<std::string> manifest;
+		std::set<std::string> added;
+		bool started = false;
+
+		std::vector<Item> items;
+		std::deque<int> ready;
+		int loaded = 0;
+		int textures_pending = 0;
+
+		std::vector<std::string> keys;
+		std::map<std::string, ShaderObject> shaders;
+		std::function<void(const std::string &, int, int)> progress;
+
+		std::unique_ptr<WorkQueue> work_queue;
+	};
+
+	XMLResourcePreloader::XMLResourcePreloader()
+	{
+	}
+
+	XMLResourcePreloader::XMLResourcePreloader(const ResourceManager &resources) : impl(std::make_shared<XMLResourcePreloader_Impl>(resources))
+	{
+	}
+
+	XMLResourcePreloader::~XMLResourcePreloader()
+	{
+	}
+
+	void XMLResourcePreloader::throw_if_null() const
+	{
+		if (!impl)
+			throw Exception("XMLResourcePreloader is null");
+	}
+
+	void XMLResourcePreloader::add(const std::string &resource_id)
+	{
+		throw_if_null();
+		if (impl->started)
+			throw Exception("Resources cannot be added to an XMLResourcePreloader that has been started");
+		impl->manifest.push_back(resource_id);
+	}
+
+	void XMLResourcePreloader::add_section(const std::string &section)
+	{
+		throw_if_null();
+		std::string path = PathHelp::add_trailing_slash(section, PathHelp::path_type_virtual);
+		for (const auto &name : impl->doc.get_resource_names(path))
+			add(path + name);
+	}
+
+	void XMLResourcePreloader::start(Canvas &canvas)
+	{
+		throw_if_null();
+		if (impl->started)
+			return;
+		impl->started = true;
+
+		impl->work_queue.reset(new WorkQueue());
+		for (const auto &id : impl->manifest)
+			impl->add_item(canvas, id);
+	}
+
+	bool XMLResourcePreloader::process(Canvas &canvas, int time_budget_microseconds)
+	{
+		throw_if_null();
+		start(canvas);
+
+		uint64_t start_time = System::get_microseconds();
+		if (impl->textures_pending > 0)
+		{
+			GraphicContext gc = canvas.get_gc();
+			DisplayCache::get(impl->resources).process_async_loads(gc, time_budget_microseconds);
+
+			for (auto &item : impl->items)
+			{
+				if (item.type == XMLResourcePreloader_Impl::item_texture && !item.loaded && !item.texture.get().is_null())
+				{
+					impl->textures_pending--;
+					impl->item_loaded(item);
+				}
+			}
+		}
+
+		impl->work_queue->process_work_completed();
+
+		// At least one resource is created, even when the texture uploads used up the budget
+		int created = 0;
+		while (!impl->ready.empty() && (created == 0 || System::get_microseconds() - start_time < (uint64_t)time_budget_microseconds))
+		{
+			XMLResourcePreloader_Impl::Item &item = impl->items[impl->ready.front()];
+			impl->ready.pop_front();
+			impl->load_item(canvas, item);
+			impl->item_loaded(item);
+			created++;
+		}
+
+		return is_done();
+	}
+
+	void XMLResourcePreloader::finish(Canvas &canvas)
+	{
+		while (!process(canvas))
+			System::sleep(1);
+	}
+
+	bool XMLResourcePreloader::is_done() const
+	{
+		throw_if_null();
+		return impl->started && impl->loaded == (int)impl->items.size();
+	}
+
+	int XMLResourcePreloader::get_total() const
+	{
+		throw_if_null();
+		return impl->started ? (int)impl->items.size() : (int)impl->manifest.size();
+	}
+
+	int XMLResourcePreloader::get_loaded() const
+	{
+		throw_if_null();
+		return impl->loaded;
+	}
+
+	float XMLResourcePreloader::get_progress() const
+	{
+		int total = get_total();
+		return total > 0 ? impl->loaded / (float)total : 1.0f;
+	}
+
+	ShaderObject XMLResourcePreloader::get_shader_object(const std::string &resource_id) const
+	{
+		throw_if_null();
+		auto it = impl->shaders.find(resource_id);
+		return it != impl->shaders.end() ? it->second : ShaderObject();
+	}
+
+	std::function<void(const std::string &, int, int)> &XMLResourcePreloader::func_progress()
+	{
+		throw_if_null();
+		return impl->progress;
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	void XMLResourcePreloader_Impl::add_item(Canvas &canvas, const std::string &id)
+	{
+		if (!added.insert(id).second)
+			return;
+
+		XMLResourceNode resource = doc.get_resource(id);
+		DomElement element = resource.get_element();
+		std::string type = resource.get_type();
+
+		Item item;
+		item.id = id;
+		if (type == "texture")
+		{
+			item.type = item_texture;
+		}
+		else if (type == "sprite" || type == "image")
+		{
+			item.type = (type == "sprite") ? item_sprite : item_image;
+		}
+		else if (type == "font")
+		{
+			// The glyph sprite is loaded by the font, so its files are decoded first
+			DomElement sprite_element = element.named_item("sprite").to_element();
+			if (!sprite_element.is_null() && sprite_element.has_attribute("glyphs"))
+				add_item(canvas, sprite_element.get_attribute("glyphs"));
+			item.type = item_font;
+		}
+		else if (type == "vertex-shader" || type == "fragment-shader")
+		{
+			item.type = item_shader;
+		}
+		else if (type == "sample" || type == "sound")
+		{
+			item.type = item_sound;
+		}
+		else
+		{
+			throw Exception(string_format("Resource '%1' of type '%2' cannot be preloaded", id, type));
+		}
+
+		int index = (int)items.size();
+		items.push_back(item);
+
+		switch (item.type)
+		{
+		case item_texture:
+		{
+			GraphicContext gc = canvas.get_gc();
+			items[index].texture = DisplayCache::get(resources).get_texture_async(gc, id);
+			textures_pending++;
+			return;
+		}
+		case item_sprite:
+		case item_image:
+			for (DomElement child = element.get_first_child_element(); !child.is_null(); child = child.get_next_sibling_element())
+			{
+				// File sequences are found by trying to load them, which stays on the rendering thread
+				if ((child.get_tag_name() == "image" || child.get_tag_name() == "image-file") && child.has_attribute("file"))
+					queue_image(index, PathHelp::combine(resource.get_base_path(), child.get_attribute("file")), resource.get_file_system());
+			}
+			break;
+		case item_shader:
+			queue_text(index, PathHelp::combine(resource.get_base_path(), element.get_attribute("file")), resource.get_file_system());
+			break;
+		case item_sound:
+			if (element.get_attribute("stream", "no") != "yes")
+				queue_sound(index, element.get_attribute("file"), element.get_attribute("format"));
+			break;
+		case item_font:
+			break;
+		}
+
+		if (items[index].files_pending == 0)
+			ready.push_back(index);
+	}
+
+	std::shared_ptr<XMLResourcePreloader_Impl::FileJob> XMLResourcePreloader_Impl::create_job(int index, const std::string &filename, const std::string &key)
+	{
+		keys.push_back(key);
+		items[index].files_pending++;
+
+		// Shared, so the queued functions stay small enough to be stored without an allocation
+		auto job = std::make_shared<FileJob>();
+		job->index = index;
+		job->filename = filename;
+		job->key = key;
+		return job;
+	}
+
+	void XMLResourcePreloader_Impl::queue_image(int index, const std::string &filename, const FileSystem &fs)
+	{
+		auto job = create_job(index, filename, XMLPreloadCache::get_key(filename, fs));
+		job->fs = fs;
+
+		WorkQueue *queue = work_queue.get();
+		queue->queue([this, queue, job]()
+		{
+			try
+			{
+				PixelBuffer image = ImageProviderFactory::load(job->filename, job->fs, std::string());
+				XMLPreloadCache::add_image(job->key, ImageImportDescription().process(image));
+			}
+			catch (const Exception &)
+			{
+				// Loaded again by the resource loader, which reports the error on the rendering thread
+			}
+			queue->work_completed([this, job]() { file_done(job->index); });
+		});
+	}
+
+	void XMLResourcePreloader_Impl::queue_text(int index, const std::string &filename, const FileSystem &fs)
+	{
+		auto job = create_job(index, filename, XMLPreloadCache::get_key(filename, fs));
+		job->fs = fs;
+
+		WorkQueue *queue = work_queue.get();
+		queue->queue([this, queue, job]()
+		{
+			try
+			{
+				XMLPreloadCache::add_text(job->key, XMLPreloadCache::load_text(job->filename, job->fs));
+			}
+			catch (const Exception &)
+			{
+				// Loaded again by the resource loader, which reports the error on the rendering thread
+			}
+			queue->work_completed([this, job]() { file_done(job->index); });
+		});
+	}
+
+	void XMLResourcePreloader_Impl::queue_sound(int index, const std::string &filename, const std::string &format)
+	{
+		auto job = create_job(index, filename, XMLPreloadCache::get_sound_key(filename, format));
+		job->format = format;
+
+		WorkQueue *queue = work_queue.get();
+		queue->queue([this, queue, job]()
+		{
+			try
+			{
+				XMLPreloadCache::add_sound(job->key, SoundBuffer(job->filename, false, job->format));
+			}
+			catch (const Exception &)
+			{
+				// Loaded again by the resource loader, which reports the error on the rendering thread
+			}
+			queue->work_completed([this, job]() { file_done(job->index); });
+		});
+	}
+
+	void XMLResourcePreloader_Impl::file_done(int index)
+	{
+		if (--items[index].files_pending == 0)
+			ready.push_back(index);
+	}
+
+	void XMLResourcePreloader_Impl::load_item(Canvas &canvas, Item &item)
+	{
+		switch (item.type)
+		{
+		case item_sprite:
+			DisplayCache::get(resources).get_sprite(canvas, item.id);
+			break;
+		case item_image:
+			DisplayCache::get(resources).get_image(canvas, item.id);
+			break;
+		case item_font:
+			DisplayCache::get(resources).get_font(canvas, item.id, FontDescription());
+			break;
+		case item_shader:
+		{
+			GraphicContext gc = canvas.get_gc();
+			shaders[item.id] = ShaderObject::load(gc, item.id, doc);
+			break;
+		}
+		case item_sound:
+			SoundCache::get(resources).get_sound(item.id);
+			break;
+		case item_texture:
+			break;
+		}
+	}
+
+	void XMLResourcePreloader_Impl::item_loaded(Item &item)
+	{
+		item.loaded = true;
+		loaded++;
+		if (progress)
+			progress(item.id, loaded, (int)items.size());
+	}
+}
@@ -31,6 +31,7 @@
 #include "API/XML/Resources/xml_resource_document.h"
 #include "API/XML/Resources/xml_resource_node.h"
 #include "API/XML/dom_element.h"
+#include "XML/Resources/xml_preload_cache.h"
 
 namespace clan
 {
@@ -43,6 +44,13 @@ namespace clan
 		std::string sound_format = resource.get_element().get_attribute("format");
 		bool streamed = (element.get_attribute("stream", "no") == "yes");
 
+		if (!streamed)
+		{
+			SoundBuffer preloaded = XMLPreloadCache::take_sound(XMLPreloadCache::get_sound_key(name, sound_format));
+			if (!preloaded.is_null())
+				return preloaded;
+		}
+
 		return SoundBuffer(name, streamed, sound_format);
 	}
 }
@@ -51,8 +51,9 @@ namespace clan
 	}
 
 	XMLSoundCache::XMLSoundCache(const XMLResourceDocument &doc)
-		: doc(doc)
+		: doc(doc), sounds([](const SoundBuffer &sound) { return estimate_size(sound); })
 	{
+		sounds.func_evicted() = [this](const std::string &id, Resource<SoundBuffer> &) { if (func_sound_evicted()) func_sound_evicted()(id); };
 	}
 
 	XMLSoundCache::~XMLSoundCache()
@@ -61,12 +62,32 @@ namespace clan
 
 	Resource<SoundBuffer> XMLSoundCache::get_sound(const std::string &id)
 	{
-		auto it = sounds.find(id);
-		if (it != sounds.end())
-			return it->second;
+		Resource<SoundBuffer> cached_sound;
+		if (sounds.find(id, cached_sound))
+			return cached_sound;
 
 		Resource<SoundBuffer> sound = SoundBuffer::load(id, doc);
-		sounds[id] = sound;
+		sounds.insert(id, sound);
 		return sound;
 	}
+
+	size_t XMLSoundCache::trim(size_t max_bytes)
+	{
+		return sounds.trim(max_bytes);
+	}
+
+	void XMLSoundCache::set_memory_budget(size_t bytes)
+	{
+		sounds.set_budget(bytes);
+	}
+
+	size_t XMLSoundCache::get_memory_used() const
+	{
+		return sounds.get_used_bytes();
+	}
+
+	void XMLSoundCache::set_pinned(const std::string &id, bool pinned)
+	{
+		sounds.set_pinned(id, pinned);
+	}
 }
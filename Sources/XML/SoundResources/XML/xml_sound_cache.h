@@ -30,6 +30,7 @@
 #pragma once
 
 #include "API/Sound/Resources/sound_cache.h"
+#include "API/Core/Resources/resource_cache_map.h"
 #include "API/XML/Resources/xml_resource_document.h"
 
 namespace clan
@@ -41,12 +42,16 @@ namespace clan
 		~XMLSoundCache();
 
 		Resource<SoundBuffer> get_sound(const std::string &id) override;
+		size_t trim(size_t max_bytes = 0) override;
+		void set_memory_budget(size_t bytes) override;
+		size_t get_memory_used() const override;
+		void set_pinned(const std::string &id, bool pinned) override;
+
 		static void add_cache_factory(ResourceManager &manager, const XMLResourceDocument &doc);
 
 	private:
 		XMLResourceDocument doc;
 
-
-		std::map<std::string, Resource<SoundBuffer> > sounds;
+		ResourceCacheMap<SoundBuffer> sounds;
 	};
 }
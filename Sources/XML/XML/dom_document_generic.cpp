@@ -29,6 +29,7 @@
 #include "XML/precomp.h"
 #include "API/XML/xml_token.h"
 #include "API/XML/dom_node.h"
+#include "API/Core/System/allocation_tracker.h"
 #include "dom_document_generic.h"
 #include "dom_tree_node.h"
 #include "dom_named_node_map_generic.h"
@@ -37,29 +38,31 @@ namespace clan
 {
 	DomDocument_Impl::DomDocument_Impl()
 	{
+		atoms.push_back(std::string());
+		atom_indices[std::string()] = 0;
+
 		node_index = DomDocument_Impl::allocate_tree_node();
-		nodes[node_index]->node_type = DomNode::DOCUMENT_NODE;
+		nodes[node_index].node_type = DomNode::DOCUMENT_NODE;
 	}
 
 	DomDocument_Impl::~DomDocument_Impl()
 	{
-		std::vector<DomNode_Impl *>::size_type pos, size;
-
-		size = nodes.size();
-		for (pos = 0; pos < size; pos++)
-			delete nodes[pos];
-
 		while (!free_dom_nodes.empty())
 		{
+			AllocationTracker::free(allocation_tag_xml, free_dom_nodes.back(), sizeof(DomNode_Impl));
 			delete free_dom_nodes.back();
 			free_dom_nodes.pop_back();
 		}
 
 		while (!free_named_node_maps.empty())
 		{
+			AllocationTracker::free(allocation_tag_xml, free_named_node_maps.back(), sizeof(DomNamedNodeMap_Impl));
 			delete free_named_node_maps.back();
 			free_named_node_maps.pop_back();
 		}
+
+		if (tracked_storage)
+			AllocationTracker::free(allocation_tag_xml, this, tracked_storage);
 	}
 
 	DomString DomDocument_Impl::find_namespace_uri(
@@ -93,18 +96,30 @@ namespace clan
 		return search_node.find_namespace_uri(qualified_name);
 	}
 
+	unsigned int DomDocument_Impl::get_atom(const DomString &str)
+	{
+		auto it = atom_indices.find(str);
+		if (it != atom_indices.end())
+			return it->second;
+
+		unsigned int atom = (unsigned int)atoms.size();
+		atoms.push_back(str);
+		atom_indices[str] = atom;
+		return atom;
+	}
+
 	unsigned int DomDocument_Impl::allocate_tree_node()
 	{
 		if (free_nodes.empty())
 		{
-			auto node = new (&node_allocator) DomTreeNode();
-			nodes.push_back(node);
+			nodes.push_back(DomTreeNode());
+			track_storage();
 			return nodes.size() - 1;
 		}
 		else
 		{
 			unsigned index = free_nodes.back();
-			nodes[index]->reset();
+			nodes[index].reset();
 			free_nodes.pop_back();
 			return index;
 		}
@@ -120,6 +135,7 @@ namespace clan
 		if (free_dom_nodes.empty())
 		{
 			auto node = new DomNode_Impl;
+			AllocationTracker::allocate(allocation_tag_xml, node, sizeof(DomNode_Impl));
 			node->owner_document = owner_document;
 			return node;
 		}
@@ -137,14 +153,18 @@ namespace clan
 		if (!node->owner_document.expired())
 			free_dom_nodes.push_back(node);
 		else
+		{
+			AllocationTracker::free(allocation_tag_xml, node, sizeof(DomNode_Impl));
 			delete node;
+		}
 	}
 
 	DomNamedNodeMap_Impl *DomDocument_Impl::allocate_named_node_map()
 	{
 		if (free_named_node_maps.empty())
 		{
-			auto map = new (&node_allocator) DomNamedNodeMap_Impl();
+			auto map = new DomNamedNodeMap_Impl();
+			AllocationTracker::allocate(allocation_tag_xml, map, sizeof(DomNamedNodeMap_Impl));
 			map->owner_document = owner_document;
 			return map;
 		}
@@ -163,6 +183,21 @@ namespace clan
 		if (!map->owner_document.expired())
 			free_named_node_maps.push_back(map);
 		else
+		{
+			AllocationTracker::free(allocation_tag_xml, map, sizeof(DomNamedNodeMap_Impl));
 			delete map;
+		}
+	}
+
+	void DomDocument_Impl::track_storage()
+	{
+		size_t storage = nodes.capacity() * sizeof(DomTreeNode) + values.capacity();
+		if (storage != tracked_storage)
+		{
+			if (tracked_storage)
+				AllocationTracker::free(allocation_tag_xml, this, tracked_storage);
+			tracked_storage = storage;
+			AllocationTracker::allocate(allocation_tag_xml, this, tracked_storage);
+		}
 	}
 }
@@ -29,9 +29,9 @@
 #pragma once
 
 #include "dom_node_generic.h"
-#include "API/Core/System/block_allocator.h"
 #include <vector>
 #include <stack>
+#include <unordered_map>
 
 namespace clan
 {
@@ -49,9 +49,18 @@ namespace clan
 		std::string public_id;
 		std::string system_id;
 		std::string internal_subset;
-		BlockAllocator node_allocator;
-		std::vector<DomTreeNode *> nodes;
+
+		/// \brief Node table. Nodes are referenced by index, and freed nodes are reused through free_nodes.
+		std::vector<DomTreeNode> nodes;
 		std::vector<int> free_nodes;
+
+		/// \brief Interned node names and namespace URIs. Atom 0 is the empty string.
+		std::vector<std::string> atoms;
+		std::unordered_map<std::string, unsigned int> atom_indices;
+
+		/// \brief Arena holding the node values
+		std::string values;
+
 		std::vector<DomNode_Impl *> free_dom_nodes;
 		std::vector<DomNamedNodeMap_Impl *> free_named_node_maps;
 
@@ -60,6 +69,8 @@ namespace clan
 			const XMLToken &search_token,
 			const DomNode &search_node);
 
+		unsigned int get_atom(const DomString &str);
+
 		unsigned int allocate_tree_node();
 		void free_tree_node(unsigned int node_index);
 		DomNode_Impl *allocate_dom_node();
@@ -67,6 +78,10 @@ namespace clan
 		DomNamedNodeMap_Impl *allocate_named_node_map();
 		void free_named_node_map(DomNamedNodeMap_Impl *map);
 
+		/// \brief Reports growth of the node table and value arena to AllocationTracker
+		void track_storage();
+		size_t tracked_storage = 0;
+
 		struct NodeDeleter
 		{
 			DomDocument_Impl *doc;
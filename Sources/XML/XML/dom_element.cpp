@@ -77,7 +77,7 @@ namespace clan
 			const DomTreeNode *cur_attribute = tree_node->get_first_attribute(doc_impl);
 			while (cur_attribute)
 			{
-				if (cur_attribute->get_node_name() == name)
+				if (cur_attribute->get_node_name(doc_impl) == name)
 					return true;
 
 				cur_index = cur_attribute->next_sibling;
@@ -110,8 +110,8 @@ namespace clan
 			const DomTreeNode *cur_attribute = tree_node->get_first_attribute(doc_impl);
 			while (cur_attribute)
 			{
-				if (cur_attribute->get_node_name() == name)
-					return cur_attribute->get_node_value();
+				if (cur_attribute->get_node_name(doc_impl) == name)
+					return cur_attribute->get_node_value(doc_impl);
 
 				cur_index = cur_attribute->next_sibling;
 				cur_attribute = cur_attribute->get_next_sibling(doc_impl);
@@ -131,8 +131,8 @@ namespace clan
 			const DomTreeNode *cur_attribute = tree_node->get_first_attribute(doc_impl);
 			while (cur_attribute)
 			{
-				if (cur_attribute->get_node_name() == name)
-					return cur_attribute->get_node_value();
+				if (cur_attribute->get_node_name(doc_impl) == name)
+					return cur_attribute->get_node_value(doc_impl);
 
 				cur_index = cur_attribute->next_sibling;
 				cur_attribute = cur_attribute->get_next_sibling(doc_impl);
@@ -154,13 +154,13 @@ namespace clan
 			const DomTreeNode *cur_attribute = tree_node->get_first_attribute(doc_impl);
 			while (cur_attribute)
 			{
-				std::string lname = cur_attribute->get_node_name();
+				std::string lname = cur_attribute->get_node_name(doc_impl);
 				std::string::size_type lpos = lname.find_first_of(':');
 				if (lpos != std::string::npos)
 					lname = lname.substr(lpos + 1);
 
-				if (cur_attribute->get_namespace_uri() == namespace_uri && lname == local_name)
-					return cur_attribute->get_node_value();
+				if (cur_attribute->get_namespace_uri(doc_impl) == namespace_uri && lname == local_name)
+					return cur_attribute->get_node_value(doc_impl);
 
 				cur_index = cur_attribute->next_sibling;
 				cur_attribute = cur_attribute->get_next_sibling(doc_impl);
@@ -183,13 +183,13 @@ namespace clan
 			const DomTreeNode *cur_attribute = tree_node->get_first_attribute(doc_impl);
 			while (cur_attribute)
 			{
-				std::string lname = cur_attribute->get_node_name();
+				std::string lname = cur_attribute->get_node_name(doc_impl);
 				std::string::size_type lpos = lname.find_first_of(':');
 				if (lpos != std::string::npos)
 					lname = lname.substr(lpos + 1);
 
-				if (cur_attribute->get_namespace_uri() == namespace_uri && lname == local_name)
-					return cur_attribute->get_node_value();
+				if (cur_attribute->get_namespace_uri(doc_impl) == namespace_uri && lname == local_name)
+					return cur_attribute->get_node_value(doc_impl);
 
 				cur_index = cur_attribute->next_sibling;
 				cur_attribute = cur_attribute->get_next_sibling(doc_impl);
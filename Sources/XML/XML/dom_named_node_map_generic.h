@@ -28,7 +28,7 @@
 
 #pragma once
 
-#include "API/Core/System/block_allocator.h"
+#include "API/Core/System/pool_allocator.h"
 #include "API/XML/dom_node.h"
 #include <vector>
 #include <memory>
@@ -38,7 +38,7 @@ namespace clan
 	class DomNode_Impl;
 	class DomTreeNode;
 
-	class DomNamedNodeMap_Impl : public BlockAllocated
+	class DomNamedNodeMap_Impl : public PoolAllocated
 	{
 	public:
 		DomNamedNodeMap_Impl();
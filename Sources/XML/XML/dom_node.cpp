@@ -84,6 +84,7 @@ namespace clan
 	{
 		if (impl)
 		{
+			DomDocument_Impl *doc_impl = (DomDocument_Impl *)impl->owner_document.lock().get();
 			const DomTreeNode *tree_node = impl->get_tree_node();
 			switch (tree_node->node_type)
 			{
@@ -105,7 +106,7 @@ namespace clan
 			case NOTATION_NODE:
 			case PROCESSING_INSTRUCTION_NODE:
 			default:
-				return tree_node->get_node_name();
+				return tree_node->get_node_name(doc_impl);
 			}
 		}
 		return DomString();
@@ -115,6 +116,7 @@ namespace clan
 	{
 		if (impl)
 		{
+			DomDocument_Impl *doc_impl = (DomDocument_Impl *)impl->owner_document.lock().get();
 			const DomTreeNode *tree_node = impl->get_tree_node();
 			switch (tree_node->node_type)
 			{
@@ -131,7 +133,7 @@ namespace clan
 			case ATTRIBUTE_NODE:
 			case PROCESSING_INSTRUCTION_NODE:
 			default:
-				return tree_node->get_node_value();
+				return tree_node->get_node_value(doc_impl);
 			}
 		}
 		return DomString();
@@ -140,7 +142,10 @@ namespace clan
 	DomString DomNode::get_namespace_uri() const
 	{
 		if (impl)
-			return impl->get_tree_node()->get_namespace_uri();
+		{
+			DomDocument_Impl *doc_impl = (DomDocument_Impl *)impl->owner_document.lock().get();
+			return impl->get_tree_node()->get_namespace_uri(doc_impl);
+		}
 		return DomString();
 	}
 
@@ -148,7 +153,8 @@ namespace clan
 	{
 		if (impl)
 		{
-			DomString node_name = impl->get_tree_node()->get_node_name();
+			DomDocument_Impl *doc_impl = (DomDocument_Impl *)impl->owner_document.lock().get();
+			DomString node_name = impl->get_tree_node()->get_node_name(doc_impl);
 			DomString::size_type pos = node_name.find(':');
 			if (pos != DomString::npos)
 				return node_name.substr(0, pos);
@@ -161,7 +167,7 @@ namespace clan
 		if (impl)
 		{
 			DomDocument_Impl *doc_impl = (DomDocument_Impl *)impl->owner_document.lock().get();
-			DomString node_name = impl->get_tree_node()->get_node_name();
+			DomString node_name = impl->get_tree_node()->get_node_name(doc_impl);
 			DomString::size_type pos = node_name.find(':');
 			if (pos == DomString::npos)
 				impl->get_tree_node()->set_node_name(doc_impl, prefix + ':' + node_name);
@@ -174,7 +180,8 @@ namespace clan
 	{
 		if (impl)
 		{
-			DomString node_name = impl->get_tree_node()->get_node_name();
+			DomDocument_Impl *doc_impl = (DomDocument_Impl *)impl->owner_document.lock().get();
+			DomString node_name = impl->get_tree_node()->get_node_name(doc_impl);
 			DomString::size_type pos = node_name.find(':');
 			if (pos != DomString::npos)
 				return node_name.substr(pos + 1);
@@ -668,16 +675,16 @@ namespace clan
 			const DomTreeNode *cur_attr = cur->get_first_attribute(doc_impl);
 			while (cur_attr)
 			{
-				std::string node_name = cur_attr->get_node_name();
+				std::string node_name = cur_attr->get_node_name(doc_impl);
 				if (prefix.empty())
 				{
 					if (node_name == xmlns_xmlns)
-						return cur_attr->get_node_value();
+						return cur_attr->get_node_value(doc_impl);
 				}
 				else
 				{
 					if (node_name.substr(0, 6) == xmlns_prefix && node_name.substr(6) == prefix)
-						return cur_attr->get_node_value();
+						return cur_attr->get_node_value(doc_impl);
 				}
 				cur_attr = cur_attr->get_next_sibling(doc_impl);
 			}
@@ -764,7 +771,7 @@ namespace clan
 		if (node_index == cl_null_node_index)
 			return nullptr;
 		DomDocument_Impl *doc_impl = (DomDocument_Impl *)owner_document.lock().get();
-		return doc_impl->nodes[node_index];
+		return &doc_impl->nodes[node_index];
 	}
 
 	const DomTreeNode *DomNode_Impl::get_tree_node() const
@@ -772,6 +779,6 @@ namespace clan
 		if (node_index == cl_null_node_index)
 			return nullptr;
 		DomDocument_Impl *doc_impl = (DomDocument_Impl *)owner_document.lock().get();
-		return doc_impl->nodes[node_index];
+		return &doc_impl->nodes[node_index];
 	}
 }
@@ -57,7 +57,10 @@ namespace clan
 	DomString DomProcessingInstruction::get_target() const
 	{
 		if (impl)
-			return impl->get_tree_node()->get_node_name();
+		{
+			DomDocument_Impl *doc_impl = (DomDocument_Impl *)impl->owner_document.lock().get();
+			return impl->get_tree_node()->get_node_name(doc_impl);
+		}
 		else
 			return DomString();
 	}
@@ -65,7 +68,10 @@ namespace clan
 	DomString DomProcessingInstruction::get_data() const
 	{
 		if (impl)
-			return impl->get_tree_node()->get_node_value();
+		{
+			DomDocument_Impl *doc_impl = (DomDocument_Impl *)impl->owner_document.lock().get();
+			return impl->get_tree_node()->get_node_value(doc_impl);
+		}
 		else
 			return DomString();
 	}
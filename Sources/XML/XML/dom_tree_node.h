@@ -28,7 +28,6 @@
 
 #pragma once
 
-#include "API/Core/System/block_allocator.h"
 #include "dom_document_generic.h"
 
 namespace clan
@@ -37,23 +36,24 @@ namespace clan
 
 	class DomDocument_Impl;
 
-	class DomTreeNode : public BlockAllocated
+	/// \brief Node record in the node table of a DomDocument_Impl
+	///
+	/// Names and namespace URIs are atoms interned by the document, and values are ranges in the document's value arena.
+	class DomTreeNode
 	{
 	public:
 		DomTreeNode()
-			: node_type(0), parent(cl_null_node_index), first_child(cl_null_node_index),
+			: node_name(0), namespace_uri(0), value_offset(0), value_length(0),
+			node_type(0), parent(cl_null_node_index), first_child(cl_null_node_index),
 			last_child(cl_null_node_index), previous_sibling(cl_null_node_index),
 			next_sibling(cl_null_node_index), first_attribute(cl_null_node_index)
 		{
 		}
 
-		virtual ~DomTreeNode()
-		{
-		}
-
-		std::string node_name;
-		std::string node_value;
-		std::string namespace_uri;
+		unsigned int node_name;
+		unsigned int namespace_uri;
+		unsigned int value_offset;
+		unsigned int value_length;
 		unsigned short node_type;
 		unsigned int parent;
 		unsigned int first_child;
@@ -64,106 +64,115 @@ namespace clan
 
 		void reset()
 		{
-			node_name.clear();
-			node_value.clear();
-			namespace_uri.clear();
-			node_type = 0;
-			parent = cl_null_node_index;
-			first_child = cl_null_node_index;
-			last_child = cl_null_node_index;
-			previous_sibling = cl_null_node_index;
-			next_sibling = cl_null_node_index;
-			first_attribute = cl_null_node_index;
+			*this = DomTreeNode();
 		}
 
-		std::string get_node_name() const
+		const std::string &get_node_name(const DomDocument_Impl *owner_document) const
 		{
-			return node_name;
+			return owner_document->atoms[node_name];
 		}
 
-		std::string get_node_value() const
+		std::string get_node_value(const DomDocument_Impl *owner_document) const
 		{
-			return node_value;
+			return owner_document->values.substr(value_offset, value_length);
 		}
 
-		std::string get_namespace_uri() const
+		const std::string &get_namespace_uri(const DomDocument_Impl *owner_document) const
 		{
-			return namespace_uri;
+			return owner_document->atoms[namespace_uri];
 		}
 
 		void set_node_name(DomDocument_Impl *owner_document, const DomString &str)
 		{
-			node_name = str;
+			node_name = owner_document->get_atom(str);
 		}
 
 		void set_node_value(DomDocument_Impl *owner_document, const DomString &str)
 		{
-			node_value = str;
+			std::string &values = owner_document->values;
+			if (str.length() <= value_length)
+			{
+				// Shrinking values are rewritten in place
+				values.replace(value_offset, str.length(), str);
+			}
+			else if (value_offset + value_length == values.size())
+			{
+				// The last value in the arena can grow in place, which keeps repeated appends cheap
+				values.resize(value_offset);
+				values.append(str);
+			}
+			else
+			{
+				value_offset = (unsigned int)values.size();
+				values.append(str);
+			}
+			value_length = (unsigned int)str.length();
+			owner_document->track_storage();
 		}
 
 		void set_namespace_uri(DomDocument_Impl *owner_document, const DomString &str)
 		{
-			namespace_uri = str;
+			namespace_uri = owner_document->get_atom(str);
 		}
 
 		DomTreeNode *get_parent(DomDocument_Impl *owner_document)
 		{
-			return parent != cl_null_node_index ? owner_document->nodes[parent] : nullptr;
+			return parent != cl_null_node_index ? &owner_document->nodes[parent] : nullptr;
 		}
 
 		const DomTreeNode *get_parent(DomDocument_Impl *owner_document) const
 		{
-			return parent != cl_null_node_index ? owner_document->nodes[parent] : nullptr;
+			return parent != cl_null_node_index ? &owner_document->nodes[parent] : nullptr;
 		}
 
 		DomTreeNode *get_first_child(DomDocument_Impl *owner_document)
 		{
-			return first_child != cl_null_node_index ? owner_document->nodes[first_child] : nullptr;
+			return first_child != cl_null_node_index ? &owner_document->nodes[first_child] : nullptr;
 		}
 
 		const DomTreeNode *get_first_child(DomDocument_Impl *owner_document) const
 		{
-			return first_child != cl_null_node_index ? owner_document->nodes[first_child] : nullptr;
+			return first_child != cl_null_node_index ? &owner_document->nodes[first_child] : nullptr;
 		}
 
 		DomTreeNode *get_last_child(DomDocument_Impl *owner_document)
 		{
-			return last_child != cl_null_node_index ? owner_document->nodes[last_child] : nullptr;
+			return last_child != cl_null_node_index ? &owner_document->nodes[last_child] : nullptr;
 		}
 
 		const DomTreeNode *get_last_child(DomDocument_Impl *owner_document) const
 		{
-			return last_child != cl_null_node_index ? owner_document->nodes[last_child] : nullptr;
+			return last_child != cl_null_node_index ? &owner_document->nodes[last_child] : nullptr;
 		}
 
 		DomTreeNode *get_previous_sibling(DomDocument_Impl *owner_document)
 		{
-			return previous_sibling != cl_null_node_index ? owner_document->nodes[previous_sibling] : nullptr;
+			return previous_sibling != cl_null_node_index ? &owner_document->nodes[previous_sibling] : nullptr;
 		}
 
 		const DomTreeNode *get_previous_sibling(DomDocument_Impl *owner_document) const
 		{
-			return previous_sibling != cl_null_node_index ? owner_document->nodes[previous_sibling] : nullptr;
+			return previous_sibling != cl_null_node_index ? &owner_document->nodes[previous_sibling] : nullptr;
 		}
 
 		DomTreeNode *get_next_sibling(DomDocument_Impl *owner_document)
 		{
-			return next_sibling != cl_null_node_index ? owner_document->nodes[next_sibling] : nullptr;
+			return next_sibling != cl_null_node_index ? &owner_document->nodes[next_sibling] : nullptr;
 		}
 
 		const DomTreeNode *get_next_sibling(DomDocument_Impl *owner_document) const
 		{
-			return next_sibling != cl_null_node_index ? owner_document->nodes[next_sibling] : nullptr;
+			return next_sibling != cl_null_node_index ? &owner_document->nodes[next_sibling] : nullptr;
 		}
 
 		DomTreeNode *get_first_attribute(DomDocument_Impl *owner_document)
 		{
-			return first_attribute != cl_null_node_index ? owner_document->nodes[first_attribute] : nullptr;
+			return first_attribute != cl_null_node_index ? &owner_document->nodes[first_attribute] : nullptr;
 		}
 
 		const DomTreeNode *get_first_attribute(DomDocument_Impl *owner_document) const
 		{
-			return first_attribute != cl_null_node_index ? owner_document->nodes[first_attribute] : nullptr;
+			return first_attribute != cl_null_node_index ? &owner_document->nodes[first_attribute] : nullptr;
 		}
 	};
 }
@@ -0,0 +1,141 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "XML/precomp.h"
+#include "API/XML/xml_reader.h"
+#include "API/XML/xml_tokenizer.h"
+#include "API/XML/xml_token.h"
+
+namespace clan
+{
+	class XMLReader_Impl
+	{
+	public:
+		XMLReader_Impl(const XMLTokenizer &tokenizer) : tokenizer(tokenizer), stopped(false) { }
+
+		XMLTokenizer tokenizer;
+		XMLToken token;
+		bool stopped;
+
+		std::function<void(const XMLToken &)> func_begin_element;
+		std::function<void(const XMLToken &)> func_end_element;
+		std::function<void(const XMLToken &)> func_text;
+		std::function<void(const XMLToken &)> func_other;
+
+		void invoke(const std::function<void(const XMLToken &)> &func)
+		{
+			if (func)
+				func(token);
+		}
+	};
+
+	XMLReader::XMLReader()
+	{
+	}
+
+	XMLReader::XMLReader(IODevice &input) : impl(std::make_shared<XMLReader_Impl>(XMLTokenizer(input)))
+	{
+	}
+
+	XMLReader::XMLReader(const DataBuffer &buffer) : impl(std::make_shared<XMLReader_Impl>(XMLTokenizer(buffer)))
+	{
+	}
+
+	XMLReader::XMLReader(const XMLTokenizer &tokenizer) : impl(std::make_shared<XMLReader_Impl>(tokenizer))
+	{
+	}
+
+	XMLReader::~XMLReader()
+	{
+	}
+
+	std::function<void(const XMLToken &)> &XMLReader::func_begin_element()
+	{
+		return impl->func_begin_element;
+	}
+
+	std::function<void(const XMLToken &)> &XMLReader::func_end_element()
+	{
+		return impl->func_end_element;
+	}
+
+	std::function<void(const XMLToken &)> &XMLReader::func_text()
+	{
+		return impl->func_text;
+	}
+
+	std::function<void(const XMLToken &)> &XMLReader::func_other()
+	{
+		return impl->func_other;
+	}
+
+	void XMLReader::parse()
+	{
+		if (!impl) return;
+
+		impl->stopped = false;
+		while (!impl->stopped)
+		{
+			XMLToken &token = impl->token;
+			impl->tokenizer.next(&token);
+
+			switch (token.type)
+			{
+			case XMLToken::NULL_TOKEN:
+				return;
+
+			case XMLToken::ELEMENT_TOKEN:
+				if (token.variant != XMLToken::END)
+					impl->invoke(impl->func_begin_element);
+				if (token.variant != XMLToken::BEGIN && !impl->stopped)
+					impl->invoke(impl->func_end_element);
+				break;
+
+			case XMLToken::TEXT_TOKEN:
+			case XMLToken::CDATA_SECTION_TOKEN:
+				impl->invoke(impl->func_text);
+				break;
+
+			case XMLToken::COMMENT_TOKEN:
+			case XMLToken::PROCESSING_INSTRUCTION_TOKEN:
+				impl->invoke(impl->func_other);
+				break;
+
+			default:
+				break;
+			}
+		}
+	}
+
+	void XMLReader::stop()
+	{
+		if (impl)
+			impl->stopped = true;
+	}
+}
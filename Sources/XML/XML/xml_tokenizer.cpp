@@ -49,32 +49,23 @@ namespace clan
 	XMLTokenizer::XMLTokenizer(IODevice &input) : impl(std::make_shared<XMLTokenizer_Impl>())
 	{
 		impl->input = input;
-		impl->size = input.get_size();
-		impl->pos = 0;
 
-		DataBuffer buffer(impl->size);
-		input.receive(buffer.get_data(), buffer.get_size(), true);
+		// Read straight into the string the tokens are taken from
+		impl->owned_data.resize(input.get_size());
+		if (!impl->owned_data.empty())
+			input.receive(&impl->owned_data[0], impl->owned_data.size(), true);
+		impl->set_data(impl->owned_data.data(), impl->owned_data.size());
+	}
 
-		StringHelp::BOMType bom_type = StringHelp::detect_bom(buffer.get_data(), buffer.get_size());
-		switch (bom_type)
-		{
-		default:
-		case StringHelp::bom_none:
-			impl->data = StringHelp::utf8_to_text(std::string(buffer.get_data(), buffer.get_size()));
-			break;
-		case StringHelp::bom_utf32_be:
-		case StringHelp::bom_utf32_le:
-			throw Exception("UTF-16 XML files not supported yet");
-			break;
-		case StringHelp::bom_utf16_be:
-		case StringHelp::bom_utf16_le:
-			throw Exception("UTF-32 XML files not supported yet");
-			break;
-		case StringHelp::bom_utf8:
-			impl->data = StringHelp::utf8_to_text(std::string(buffer.get_data() + 3, buffer.get_size() - 3));
-			break;
-		}
+	XMLTokenizer::XMLTokenizer(const DataBuffer &buffer) : impl(std::make_shared<XMLTokenizer_Impl>())
+	{
+		impl->buffer = buffer;
+		impl->set_data(impl->buffer.get_data(), impl->buffer.get_size());
+	}
 
+	XMLTokenizer::XMLTokenizer(const char *data, std::string::size_type size) : impl(std::make_shared<XMLTokenizer_Impl>())
+	{
+		impl->set_data(data, size);
 	}
 
 	XMLTokenizer::~XMLTokenizer()
@@ -95,16 +86,13 @@ namespace clan
 	{
 		out_token->type = XMLToken::NULL_TOKEN;
 		out_token->variant = XMLToken::SINGLE;
-		//	out_token->attributes.clear();
-		while (!out_token->attributes.empty())
-			out_token->attributes.pop_back();
 
-		if (impl)
-		{
-			if (impl->next_text_node(out_token))
-				return;
+		// Element tokens overwrite the attributes in place, so the strings of a reused token keep their memory
+		if (impl && !impl->next_text_node(out_token))
 			impl->next_tag_node(out_token);
-		}
+
+		if (out_token->type != XMLToken::ELEMENT_TOKEN)
+			out_token->attributes.clear();
 	}
 
 	XMLToken XMLTokenizer::next()
@@ -116,27 +104,53 @@ namespace clan
 
 	/////////////////////////////////////////////////////////////////////////////
 
+	void XMLTokenizer_Impl::set_data(const char *new_data, std::string::size_type new_size)
+	{
+		data = new_data;
+		size = new_size;
+		pos = 0;
+
+		StringHelp::BOMType bom_type = StringHelp::detect_bom(data, size);
+		switch (bom_type)
+		{
+		default:
+		case StringHelp::bom_none:
+			break;
+		case StringHelp::bom_utf32_be:
+		case StringHelp::bom_utf32_le:
+			throw Exception("UTF-16 XML files not supported yet");
+			break;
+		case StringHelp::bom_utf16_be:
+		case StringHelp::bom_utf16_le:
+			throw Exception("UTF-32 XML files not supported yet");
+			break;
+		case StringHelp::bom_utf8:
+			data += 3;
+			size -= 3;
+			break;
+		}
+	}
+
 	bool XMLTokenizer_Impl::next_text_node(XMLToken *out_token)
 	{
 		while (pos < size && data[pos] != '<')
 		{
 			std::string::size_type start_pos = pos;
-			std::string::size_type end_pos = data.find('<', start_pos);
-			if (end_pos == data.npos) end_pos = size;
+			std::string::size_type end_pos = find('<', start_pos);
+			if (end_pos == npos) end_pos = size;
 			pos = end_pos;
 
-			std::string text;
-			std::string text_orig = data.substr(start_pos, end_pos - start_pos);
-			unescape(text, text_orig);
+			const char *text_begin = data + start_pos;
+			const char *text_end = data + end_pos;
 			if (eat_whitespace)
 			{
-				text = trim_whitespace(text);
-				if (text.empty())
+				trim_whitespace(text_begin, text_end);
+				if (text_begin == text_end)
 					continue;
 			}
 
 			out_token->type = XMLToken::TEXT_TOKEN;
-			out_token->value = text;
+			unescape(out_token->value, text_begin, text_end);
 			return true;
 		}
 		return false;
@@ -171,36 +185,37 @@ namespace clan
 
 		// Extract the tag name:
 		std::string::size_type start_pos = pos;
-		std::string::size_type end_pos = data.find_first_of(" \r\n\t?/>", start_pos);
-		if (end_pos == data.npos)
+		std::string::size_type end_pos = find_first_of(" \r\n\t?/>", start_pos);
+		if (end_pos == npos)
 			XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 		pos = end_pos;
 
 		out_token->type = questionMark ? XMLToken::PROCESSING_INSTRUCTION_TOKEN : XMLToken::ELEMENT_TOKEN;
 		out_token->variant = closing ? XMLToken::END : XMLToken::BEGIN;
-		out_token->name = data.substr(start_pos, end_pos - start_pos);
+		out_token->name.assign(data + start_pos, end_pos - start_pos);
 
 		if (out_token->type == XMLToken::PROCESSING_INSTRUCTION_TOKEN)
 		{
 			// Strip whitespace:
-			pos = data.find_first_not_of(" \r\n\t", pos);
-			if (pos == data.npos)
+			pos = find_first_not_of(" \r\n\t", pos);
+			if (pos == npos)
 				XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 
-			end_pos = data.find_first_of("?", pos);
-			if (end_pos == data.npos)
+			end_pos = find_first_of("?", pos);
+			if (end_pos == npos)
 				XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
-			out_token->value = data.substr(pos, end_pos - pos);
+			out_token->value.assign(data + pos, end_pos - pos);
 			pos = end_pos;
 		}
 		else // out_token->type == XMLToken::ELEMENT_TOKEN
 		{
 			// Check for possible attributes:
+			std::vector<XMLToken::Attribute>::size_type num_attributes = 0;
 			while (true)
 			{
 				// Strip whitespace:
-				pos = data.find_first_not_of(" \r\n\t", pos);
-				if (pos == data.npos)
+				pos = find_first_not_of(" \r\n\t", pos);
+				if (pos == npos)
 					XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 
 				// End of tag, stop searching for more attributes:
@@ -209,23 +224,27 @@ namespace clan
 
 				// Extract attribute name:
 				std::string::size_type start_pos = pos;
-				std::string::size_type end_pos = data.find_first_of(" \r\n\t=", start_pos);
-				if (end_pos == data.npos)
+				std::string::size_type end_pos = find_first_of(" \r\n\t=", start_pos);
+				if (end_pos == npos)
 					XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 				pos = end_pos;
 
-				std::string attributeName = data.substr(start_pos, end_pos - start_pos);
+				if (num_attributes == out_token->attributes.size())
+					out_token->attributes.push_back(XMLToken::Attribute());
+				XMLToken::Attribute &attribute = out_token->attributes[num_attributes++];
+				std::string &attributeName = attribute.first;
+				attributeName.assign(data + start_pos, end_pos - start_pos);
 
 				// Find seperator:
-				pos = data.find_first_not_of(" \r\n\t", pos);
-				if (pos == data.npos || pos == size - 1)
+				pos = find_first_not_of(" \r\n\t", pos);
+				if (pos == npos || pos == size - 1)
 					XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 				if (data[pos++] != '=')
 					XMLTokenizer_Impl::throw_exception(string_format("XML error(s), parser confused at line %1 (tag=%2, attributeName=%3)", get_line_number(), out_token->name, attributeName));
 
 				// Strip whitespace:
-				pos = data.find_first_not_of(" \r\n\t", pos);
-				if (pos == data.npos)
+				pos = find_first_not_of(" \r\n\t", pos);
+				if (pos == npos)
 					XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 
 				// Extract attribute value:
@@ -247,21 +266,17 @@ namespace clan
 					}
 
 				start_pos = pos;
-				end_pos = data.find_first_of(first_of, start_pos);
-				if (end_pos == data.npos)
+				end_pos = find_first_of(first_of, start_pos);
+				if (end_pos == npos)
 					XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 
-				std::string attributeValue;
-				std::string attributeValueOrig = data.substr(start_pos, end_pos - start_pos);
-				unescape(attributeValue, attributeValueOrig);
+				unescape(attribute.second, data + start_pos, data + end_pos);
 
 				pos = end_pos + 1;
 				if (pos == size)
 					XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
-
-				// Finally apply attribute to token:
-				out_token->attributes.push_back(XMLToken::Attribute(attributeName, attributeValue));
 			}
+			out_token->attributes.resize(num_attributes);
 		}
 
 		// Check if its singular:
@@ -286,54 +301,53 @@ namespace clan
 		if (pos + 2 >= size)
 			XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 
-		if (data.compare(pos, 2, "--") == 0) // comment block
+		if (compare(pos, "--")) // comment block
 		{
 			std::string::size_type start_pos = pos + 2;
-			std::string::size_type end_pos = data.find("-->", start_pos);
-			if (end_pos == data.npos)
+			std::string::size_type end_pos = find("-->", start_pos);
+			if (end_pos == npos)
 				XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 			pos = end_pos + 3;
 
-			std::string text;
-			std::string text_orig = data.substr(start_pos, end_pos - start_pos);
-			unescape(text, text_orig);
+			const char *text_begin = data + start_pos;
+			const char *text_end = data + end_pos;
 			if (eat_whitespace)
-				text = trim_whitespace(text);
+				trim_whitespace(text_begin, text_end);
 
 			out_token->type = XMLToken::COMMENT_TOKEN;
 			out_token->variant = XMLToken::SINGLE;
-			out_token->value = text;
+			unescape(out_token->value, text_begin, text_end);
 			return true;
 		}
 
 		if (pos + 7 >= size)
 			XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 
-		if (data.compare(pos, 7, "DOCTYPE") == 0)
+		if (compare(pos, "DOCTYPE"))
 		{
 			// Strip whitespace:
-			pos = data.find_first_not_of(" \r\n\t", pos + 7);
-			if (pos == data.npos)
+			pos = find_first_not_of(" \r\n\t", pos + 7);
+			if (pos == npos)
 				XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 
 			// Find doctype name:				
 			std::string::size_type name_start = pos;
-			std::string::size_type name_end = data.find_first_of(" \r\n\t?/>", name_start);
-			if (name_end == data.npos)
+			std::string::size_type name_end = find_first_of(" \r\n\t?/>", name_start);
+			if (name_end == npos)
 				XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 			pos = name_end;
 
 			// Strip whitespace:
-			pos = data.find_first_not_of(" \r\n\t", pos);
-			if (pos == data.npos)
+			pos = find_first_not_of(" \r\n\t", pos);
+			if (pos == npos)
 				XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 
-			std::string::size_type public_start = data.npos;
-			std::string::size_type public_end = data.npos;
-			std::string::size_type system_start = data.npos;
-			std::string::size_type system_end = data.npos;
-			std::string::size_type subset_start = data.npos;
-			std::string::size_type subset_end = data.npos;
+			std::string::size_type public_start = npos;
+			std::string::size_type public_end = npos;
+			std::string::size_type system_start = npos;
+			std::string::size_type system_end = npos;
+			std::string::size_type subset_start = npos;
+			std::string::size_type subset_end = npos;
 
 			// Look for possible external id:
 			if (data[pos] != '[' && data[pos] != '>')
@@ -341,15 +355,15 @@ namespace clan
 				if (pos + 6 >= size)
 					XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 
-				if (data.compare(pos, 6, "SYSTEM") == 0)
+				if (compare(pos, "SYSTEM"))
 				{
 					pos += 6;
 					if (pos == size)
 						XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 
 					// Strip whitespace:
-					pos = data.find_first_not_of(" \r\n\t", pos);
-					if (pos == data.npos)
+					pos = find_first_not_of(" \r\n\t", pos);
+					if (pos == npos)
 						XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 
 					// Read system literal:
@@ -358,22 +372,22 @@ namespace clan
 						XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 
 					system_start = pos + 1;
-					system_end = data.find(literal_char, system_start);
-					if (system_end == data.npos)
+					system_end = find(literal_char, system_start);
+					if (system_end == npos)
 						XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 					pos = system_end + 1;
 					if (pos >= size)
 						XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 				}
-				else if (data.compare(pos, 6, "PUBLIC") == 0)
+				else if (compare(pos, "PUBLIC"))
 				{
 					pos += 6;
 					if (pos == size)
 						XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 
 					// Strip whitespace:
-					pos = data.find_first_not_of(" \r\n\t", pos);
-					if (pos == data.npos)
+					pos = find_first_not_of(" \r\n\t", pos);
+					if (pos == npos)
 						XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 
 					// Read public literal:
@@ -382,16 +396,16 @@ namespace clan
 						XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 
 					public_start = pos + 1;
-					public_end = data.find(literal_char, public_start);
-					if (public_end == data.npos)
+					public_end = find(literal_char, public_start);
+					if (public_end == npos)
 						XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 					pos = public_end + 1;
 					if (pos >= size)
 						XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 
 					// Strip whitespace:
-					pos = data.find_first_not_of(" \r\n\t", pos);
-					if (pos == data.npos)
+					pos = find_first_not_of(" \r\n\t", pos);
+					if (pos == npos)
 						XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 
 					// Read system literal:
@@ -400,8 +414,8 @@ namespace clan
 						XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 
 					system_start = pos + 1;
-					system_end = data.find(literal_char, system_start);
-					if (system_end == data.npos)
+					system_end = find(literal_char, system_start);
+					if (system_end == npos)
 						XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 					pos = system_end + 1;
 					if (pos >= size)
@@ -411,8 +425,8 @@ namespace clan
 					XMLTokenizer_Impl::throw_exception(string_format("Error in XML stream, line %1 (unknown external identifier type in DOCTYPE)", get_line_number()));
 
 				// Strip whitespace:
-				pos = data.find_first_not_of(" \r\n\t", pos);
-				if (pos == data.npos)
+				pos = find_first_not_of(" \r\n\t", pos);
+				if (pos == npos)
 					XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 			}
 
@@ -423,12 +437,12 @@ namespace clan
 
 				// Search for the end of the internal subset:
 				// (to avoid parsing it, we search backwards)
-				std::string::size_type end_pos = data.find('>', pos + 1);
-				if (end_pos == data.npos)
+				std::string::size_type end_pos = find('>', pos + 1);
+				if (end_pos == npos)
 					XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 
-				subset_end = data.rfind(']', end_pos);
-				if (subset_end == data.npos)
+				subset_end = rfind(']', end_pos);
+				if (subset_end == npos)
 					XMLTokenizer_Impl::throw_exception(string_format("Error in XML stream, line %1 (expected end of internal subset in DOCTYPE)", get_line_number()));
 
 				pos = end_pos;
@@ -442,19 +456,17 @@ namespace clan
 			out_token->type = XMLToken::DOCUMENT_TYPE_TOKEN;
 			return true;
 		}
-		else if (data.compare(pos, 7, "[CDATA[") == 0)
+		else if (compare(pos, "[CDATA["))
 		{
 			std::string::size_type start_pos = pos + 7;
-			std::string::size_type end_pos = data.find("]]>", start_pos);
-			if (end_pos == data.npos)
+			std::string::size_type end_pos = find("]]>", start_pos);
+			if (end_pos == npos)
 				XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
 			pos = end_pos + 3;
 
-			std::string value = data.substr(start_pos, end_pos - start_pos);
-
 			out_token->type = XMLToken::CDATA_SECTION_TOKEN;
 			out_token->variant = XMLToken::SINGLE;
-			out_token->value = value;
+			out_token->value.assign(data + start_pos, end_pos - start_pos);
 			return true;
 		}
 		else
@@ -471,66 +483,111 @@ namespace clan
 
 	int XMLTokenizer_Impl::get_line_number()
 	{
-		int line = 1;
-		std::string::size_type tmp_pos = 0;
+		return 1 + (int)std::count(data, data + std::min(pos + 1, size), '\n');
+	}
 
-		std::string::const_iterator it;
-		for (it = data.begin(); it != data.end() && tmp_pos <= pos; ++it, tmp_pos++)
+	std::string::size_type XMLTokenizer_Impl::find(char c, std::string::size_type start) const
+	{
+		if (start >= size)
+			return npos;
+		const char *found = static_cast<const char *>(memchr(data + start, c, size - start));
+		return found ? found - data : npos;
+	}
+
+	std::string::size_type XMLTokenizer_Impl::find(const char *str, std::string::size_type start) const
+	{
+		std::string::size_type length = strlen(str);
+		const char *found = std::search(data + std::min(start, size), data + size, str, str + length);
+		return found != data + size ? found - data : npos;
+	}
+
+	std::string::size_type XMLTokenizer_Impl::rfind(char c, std::string::size_type start) const
+	{
+		for (std::string::size_type i = std::min(start + 1, size); i > 0; i--)
 		{
-			if ((*it) == '\n')
-				line++;
+			if (data[i - 1] == c)
+				return i - 1;
 		}
+		return npos;
+	}
 
-		return line;
+	std::string::size_type XMLTokenizer_Impl::find_first_of(const char *chars, std::string::size_type start) const
+	{
+		for (std::string::size_type i = start; i < size; i++)
+		{
+			if (strchr(chars, data[i]))
+				return i;
+		}
+		return npos;
 	}
 
-	inline void XMLTokenizer_Impl::unescape(std::string &unescaped, const std::string &text)
+	std::string::size_type XMLTokenizer_Impl::find_first_not_of(const char *chars, std::string::size_type start) const
 	{
-		static const std::string quot("&quot;");
-		static const std::string apos("&apos;");
-		static const std::string lt("&lt;");
-		static const std::string gt("&gt;");
-		static const std::string amp("&amp;");
-
-		unescaped = text;
-		unescape(unescaped, quot, '"');
-		unescape(unescaped, apos, '\'');
-		unescape(unescaped, lt, '<');
-		unescape(unescaped, gt, '>');
-		unescape(unescaped, amp, '&');
+		for (std::string::size_type i = start; i < size; i++)
+		{
+			if (!strchr(chars, data[i]))
+				return i;
+		}
+		return npos;
+	}
+
+	bool XMLTokenizer_Impl::compare(std::string::size_type start, const char *str) const
+	{
+		std::string::size_type length = strlen(str);
+		return start + length <= size && memcmp(data + start, str, length) == 0;
 	}
 
-	inline void XMLTokenizer_Impl::unescape(std::string &text, const std::string &search, std::string::value_type replace)
+	void XMLTokenizer_Impl::unescape(std::string &unescaped, const char *begin, const char *end)
 	{
-		std::string::size_type read_pos = 0;
-		std::string::size_type length = text.length();
-		std::string::size_type search_length = search.length();
-		while (true)
+		// Most text has no entities and is copied as is
+		const char *entity = static_cast<const char *>(memchr(begin, '&', end - begin));
+		if (!entity)
+		{
+			unescaped.assign(begin, end);
+			return;
+		}
+
+		static const struct { const char *name; std::string::size_type length; char replace; } entities[] =
+		{
+			{ "&quot;", 6, '"' },
+			{ "&apos;", 6, '\'' },
+			{ "&lt;", 4, '<' },
+			{ "&gt;", 4, '>' },
+			{ "&amp;", 5, '&' }
+		};
+
+		unescaped.assign(begin, entity);
+		const char *p = entity;
+		while (p != end)
 		{
-			std::string::size_type next_match = text.find(search, read_pos);
-			if (next_match == std::string::npos)
-				break;
-
-			std::string::size_type copy_size = length - (next_match + search_length);
-			if (copy_size > 0)
-				memmove(&text[next_match + 1], &text[next_match + search_length], copy_size * sizeof(std::string::value_type));
-			text[next_match] = replace;
-			length -= search_length - 1;
-			read_pos = next_match + 1;
-			if (read_pos > length)
-				break;
+			if (*p != '&')
+			{
+				unescaped.push_back(*p++);
+				continue;
+			}
+
+			bool replaced = false;
+			for (const auto &e : entities)
+			{
+				if ((std::string::size_type)(end - p) >= e.length && memcmp(p, e.name, e.length) == 0)
+				{
+					unescaped.push_back(e.replace);
+					p += e.length;
+					replaced = true;
+					break;
+				}
+			}
+
+			if (!replaced)
+				unescaped.push_back(*p++);
 		}
-		text.resize(length);
 	}
 
-	inline std::string XMLTokenizer_Impl::trim_whitespace(const std::string &text)
+	void XMLTokenizer_Impl::trim_whitespace(const char *&begin, const char *&end)
 	{
-		std::string::size_type pos_start = text.find_first_not_of(" \t\r\n");
-		if (pos_start == std::string::npos)
-			return std::string();
-		std::string::size_type pos_end = text.find_last_not_of(" \t\r\n");
-		if (pos_end == std::string::npos)
-			return std::string();
-		return text.substr(pos_start, pos_end - pos_start + 1);
+		while (begin != end && strchr(" \t\r\n", *begin))
+			begin++;
+		while (end != begin && strchr(" \t\r\n", *(end - 1)))
+			end--;
 	}
 }
@@ -29,19 +29,28 @@
 #pragma once
 
 #include "API/Core/IOData/iodevice.h"
+#include "API/Core/System/databuffer.h"
 
 namespace clan
 {
 	class XMLTokenizer_Impl
 	{
 	public:
-		XMLTokenizer_Impl() : pos(0), size(0), eat_whitespace(true) { }
+		XMLTokenizer_Impl() : data(nullptr), size(0), pos(0), eat_whitespace(true) { }
+
+		static const std::string::size_type npos = std::string::npos;
 
 		IODevice input;
-		std::string::size_type pos, size;
-		std::string data;
+		std::string owned_data;
+		DataBuffer buffer;
+
+		/// \brief The tokenized text. Points into owned_data, buffer or memory owned by the caller.
+		const char *data;
+		std::string::size_type size, pos;
 		bool eat_whitespace;
 
+		void set_data(const char *data, std::string::size_type size);
+
 		static void throw_exception(const std::string &str);
 		bool next_text_node(XMLToken *out_token);
 		bool next_tag_node(XMLToken *out_token);
@@ -50,8 +59,15 @@ namespace clan
 		// used to get the line number when there is an error in the xml file
 		int get_line_number();
 
-		void unescape(std::string &text_out, const std::string &text_in);
-		void unescape(std::string &text, const std::string &search, std::string::value_type replace);
-		std::string trim_whitespace(const std::string &text);
+		std::string::size_type find(char c, std::string::size_type start) const;
+		std::string::size_type find(const char *str, std::string::size_type start) const;
+		std::string::size_type rfind(char c, std::string::size_type start) const;
+		std::string::size_type find_first_of(const char *chars, std::string::size_type start) const;
+		std::string::size_type find_first_not_of(const char *chars, std::string::size_type start) const;
+		bool compare(std::string::size_type start, const char *str) const;
+
+		/// \brief Copies [begin, end) to text_out, replacing the predefined entities
+		static void unescape(std::string &text_out, const char *begin, const char *end);
+		static void trim_whitespace(const char *&begin, const char *&end);
 	};
 }
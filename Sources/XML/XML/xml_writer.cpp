@@ -47,7 +47,6 @@ namespace clan
 	{
 		impl->output = output;
 		impl->str.reserve(4096);
-		impl->escaped_string.reserve(4096);
 	}
 
 	XMLWriter::~XMLWriter()
@@ -100,7 +99,7 @@ namespace clan
 				}
 
 				str.append("<");
-				str.append(impl->insert_escapes_fast(token.name));
+				impl->append_escaped(str, token.name);
 
 				int size = (int)token.attributes.size();
 				for (int i = 0; i < size; i++)
@@ -108,7 +107,7 @@ namespace clan
 					str.append(" ");
 					str.append(token.attributes[i].first);
 					str.append("=\"");
-					str.append(impl->insert_escapes_fast(token.attributes[i].second));
+					impl->append_escaped(str, token.attributes[i].second);
 					str.append("\"");
 				}
 
@@ -131,14 +130,14 @@ namespace clan
 					str.append(impl->indent, L'\t');
 				}
 				str.append("</");
-				str.append(impl->insert_escapes_fast(token.name));
+				impl->append_escaped(str, token.name);
 				str.append(">");
 				impl->single_line_tag = false;
 			}
 			break;
 
 		case XMLToken::TEXT_TOKEN:
-			str.append(impl->insert_escapes_fast(token.value));
+			impl->append_escaped(str, token.value);
 			break;
 
 		case XMLToken::CDATA_SECTION_TOKEN:
@@ -192,45 +191,29 @@ namespace clan
 
 	/////////////////////////////////////////////////////////////////////////////
 
-	std::string XMLWriter_Impl::insert_escapes_fast(const std::string &str)
+	void XMLWriter_Impl::append_escaped(std::string &out, const std::string &str)
 	{
-		static std::string const amp("&amp;");
-		static std::string const quot("&quot;");
-		static std::string const apos("&apos;");
-		static std::string const lt("&lt;");
-		static std::string const gt("&gt;");
-
-		escaped_string = str;
-		std::string::size_type pos = 0;
-		while (pos < escaped_string.size())
+		// Copy the runs between special characters in one go
+		std::string::size_type start = 0;
+		while (true)
 		{
-			switch (escaped_string[pos])
+			std::string::size_type pos = str.find_first_of("&'\"<>", start);
+			if (pos == std::string::npos)
 			{
-			case '&':
-				escaped_string.replace(pos, 1, amp);
-				pos += amp.size();
-				break;
-			case '\'':
-				escaped_string.replace(pos, 1, apos);
-				pos += apos.size();
-				break;
-			case '\"':
-				escaped_string.replace(pos, 1, quot);
-				pos += quot.size();
-				break;
-			case '<':
-				escaped_string.replace(pos, 1, lt);
-				pos += lt.size();
-				break;
-			case '>':
-				escaped_string.replace(pos, 1, gt);
-				pos += gt.size();
-				break;
-			default:
-				++pos;
-				break;
+				out.append(str, start, std::string::npos);
+				return;
 			}
+
+			out.append(str, start, pos - start);
+			switch (str[pos])
+			{
+			case '&': out.append("&amp;"); break;
+			case '\'': out.append("&apos;"); break;
+			case '\"': out.append("&quot;"); break;
+			case '<': out.append("&lt;"); break;
+			case '>': out.append("&gt;"); break;
+			}
+			start = pos + 1;
 		}
-		return escaped_string;
 	}
 }
@@ -42,10 +42,10 @@ namespace clan
 		int indent;
 		//XXX:	StringAllocator string_allocator;
 		std::string str;
-		std::string escaped_string;
 		bool first_token;
 		bool single_line_tag;
 
-		std::string insert_escapes_fast(const std::string &str);
+		/// \brief Appends str to out with the XML special characters replaced by entities
+		static void append_escaped(std::string &out, const std::string &str);
 	};
 }
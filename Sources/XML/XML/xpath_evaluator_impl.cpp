@@ -42,6 +42,8 @@
 #include "xpath_location_step.h"
 #include <cmath>
 #include <limits>
+#include <mutex>
+#include <unordered_map>
 
 namespace clan
 {
@@ -50,6 +52,70 @@ namespace clan
 		const XPathNodeSet &context,
 		XPathNodeSet::size_type context_node_index,
 		XPathToken prev_token) const
+	{
+		// Sub-expressions such as function parameters are evaluated on the string of the current expression
+		if (current_expression && &expression == &current_expression->expression)
+			return evaluate_compiled(expression, context, context_node_index, prev_token);
+
+		std::shared_ptr<const XPathCompiledExpression> compiled = compile(expression);
+		const XPathCompiledExpression *outer_expression = current_expression;
+		current_expression = compiled.get();
+		try
+		{
+			XPathEvaluateResult result = evaluate_compiled(compiled->expression, context, context_node_index, prev_token);
+			current_expression = outer_expression;
+			return result;
+		}
+		catch (...)
+		{
+			current_expression = outer_expression;
+			throw;
+		}
+	}
+
+	std::shared_ptr<const XPathCompiledExpression> XPathEvaluator_Impl::compile(const std::string &expression) const
+	{
+		static std::mutex mutex;
+		static std::unordered_map<std::string, std::shared_ptr<const XPathCompiledExpression>> cache;
+		const size_t max_cached_expressions = 256;
+
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			auto it = cache.find(expression);
+			if (it != cache.end())
+				return it->second;
+		}
+
+		// Tokens only depend on the previous token, so each expression has a single token sequence
+		auto compiled = std::make_shared<XPathCompiledExpression>();
+		compiled->expression = expression;
+		compiled->token_after.resize(expression.length() + 1, -1);
+
+		XPathToken token;
+		while (true)
+		{
+			XPathToken next_token = tokenize(expression, token);
+			std::string::size_type end = token.pos + token.length;
+			if (end < compiled->token_after.size())
+				compiled->token_after[end] = (int)compiled->tokens.size();
+			compiled->tokens.push_back(next_token);
+			if (next_token.type == XPathToken::type_none || next_token.length == 0)
+				break;
+			token = next_token;
+		}
+
+		std::unique_lock<std::mutex> lock(mutex);
+		if (cache.size() >= max_cached_expressions)
+			cache.clear();
+		cache[expression] = compiled;
+		return compiled;
+	}
+
+	XPathEvaluateResult XPathEvaluator_Impl::evaluate_compiled(
+		const std::string &expression,
+		const XPathNodeSet &context,
+		XPathNodeSet::size_type context_node_index,
+		XPathToken prev_token) const
 	{
 		std::vector<Operator> operator_stack;
 		std::vector<Operand> operand_stack;
@@ -1112,7 +1178,7 @@ namespace clan
 				select_nodes_descendant_or_self(context, context_node_index, steps, step_index, expression, nodes);
 			else if (steps[step_index].axis == "following")
 				select_nodes_following(context, context_node_index, steps, step_index, expression, nodes);
-			else if (steps[step_index].axis == "follwing-sibling")
+			else if (steps[step_index].axis == "following-sibling")
 				select_nodes_following_sibling(context, context_node_index, steps, step_index, expression, nodes);
 			else if (steps[step_index].axis == "namespace")
 				select_nodes_namespace(context, context_node_index, steps, step_index, expression, nodes);
@@ -1125,7 +1191,7 @@ namespace clan
 			else if (steps[step_index].axis == "self")
 				select_nodes_self(context, context_node_index, steps, step_index, expression, nodes);
 			else
-				throw XPathException(string_format("Unknown location step axis", steps[step_index].axis), expression);
+				throw XPathException(string_format("Unknown location step axis %1", steps[step_index].axis), expression);
 		}
 		else
 		{
@@ -1223,7 +1289,12 @@ namespace clan
 		XPathNodeSet parentNodes;
 		XPathNodeSet nodeset;
 
-		DomNode cur_node = context[context_node_index];
+		// Self first, then the descendants without leaving the subtree of the context node
+		const DomNode &self = context[context_node_index];
+		if (confirm_step_requirements(self, steps[step_index], expression))
+			nodeset.push_back(self);
+
+		DomNode cur_node = self.get_first_child();
 		while (!cur_node.is_null())
 		{
 			if (confirm_step_requirements(cur_node, steps[step_index], expression))
@@ -1455,6 +1526,19 @@ namespace clan
 	XPathToken XPathEvaluator_Impl::read_token(
 		const std::string &expression,
 		const XPathToken &previous_token) const
+	{
+		if (current_expression && &expression == &current_expression->expression)
+		{
+			std::string::size_type end = previous_token.pos + previous_token.length;
+			if (end < current_expression->token_after.size() && current_expression->token_after[end] != -1)
+				return current_expression->tokens[current_expression->token_after[end]];
+		}
+		return tokenize(expression, previous_token);
+	}
+
+	XPathToken XPathEvaluator_Impl::tokenize(
+		const std::string &expression,
+		const XPathToken &previous_token) const
 	{
 		std::string::size_type pos = previous_token.pos + previous_token.length;
 		pos = expression.find_first_not_of(" \t\r\n", pos);
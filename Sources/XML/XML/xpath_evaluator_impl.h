@@ -32,6 +32,7 @@
 #include "API/XML/xpath_object.h"
 #include "xpath_token.h"
 #include "xpath_location_step.h"
+#include <memory>
 
 namespace clan
 {
@@ -42,12 +43,25 @@ namespace clan
 		XPathToken next_token;
 	};
 
+	/// \brief Expression tokenized once, so repeated evaluations skip the tokenizer
+	class XPathCompiledExpression
+	{
+	public:
+		std::string expression;
+		std::vector<XPathToken> tokens;
+
+		/// \brief Index in tokens of the token that follows a token ending at a given position, or -1
+		std::vector<int> token_after;
+	};
+
 	class XPathEvaluator_Impl
 	{
 	public:
 		typedef std::vector<DomNode> XPathNodeSet;
 
 	public:
+		XPathEvaluator_Impl() : current_expression(nullptr) { }
+
 		XPathEvaluateResult evaluate(
 			const std::string &expression,
 			const XPathNodeSet &context,
@@ -55,6 +69,18 @@ namespace clan
 			XPathToken prev_token) const;
 
 	private:
+		/// \brief Returns the compiled form of an expression from a cache shared by all evaluators
+		std::shared_ptr<const XPathCompiledExpression> compile(const std::string &expression) const;
+
+		XPathEvaluateResult evaluate_compiled(
+			const std::string &expression,
+			const XPathNodeSet &context,
+			XPathNodeSet::size_type context_node_index,
+			XPathToken prev_token) const;
+
+		/// \brief Expression being evaluated. read_token looks up its tokens when passed its expression string.
+		mutable const XPathCompiledExpression *current_expression;
+
 		typedef XPathToken::Operator Operator;
 		typedef XPathObject Operand;
 		enum ErrorType
@@ -98,6 +124,10 @@ namespace clan
 			const std::string &expression,
 			const XPathToken &previous_token = XPathToken()) const;
 
+		XPathToken tokenize(
+			const std::string &expression,
+			const XPathToken &previous_token) const;
+
 		XPathToken skip_predicate_expression(
 			const std::string &expression,
 			const XPathToken &previous_token = XPathToken()) const;
@@ -0,0 +1,296 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "precomp.h"
+#include "benchmark.h"
+
+#ifdef WIN32
+#include <windows.h>
+#elif !defined(__APPLE__)
+#include <sched.h>
+#endif
+
+#ifdef _MSC_VER
+volatile const void *benchmark_sink = nullptr;
+#endif
+
+void BenchmarkRunner::add(const std::string &suite, const std::string &name, const std::function<void(int64_t iterations)> &run, int64_t bytes_per_iteration, int64_t items_per_iteration)
+{
+	BenchmarkCase benchmark;
+	benchmark.suite = suite;
+	benchmark.name = name;
+	benchmark.run = run;
+	benchmark.bytes_per_iteration = bytes_per_iteration;
+	benchmark.items_per_iteration = items_per_iteration;
+	cases.push_back(benchmark);
+}
+
+int BenchmarkRunner::run(const BenchmarkOptions &options)
+{
+	std::vector<const BenchmarkCase *> selected;
+	for (const auto &benchmark : cases)
+	{
+		if (options.filter.empty() || benchmark.get_full_name().find(options.filter) != std::string::npos)
+			selected.push_back(&benchmark);
+	}
+
+	if (options.list_only)
+	{
+		for (const auto benchmark : selected)
+			Console::write_line(benchmark->get_full_name());
+		return (int)selected.size();
+	}
+
+	print_environment(options);
+
+	std::vector<BenchmarkResult> results;
+	for (const auto benchmark : selected)
+	{
+		try
+		{
+			results.push_back(run_case(*benchmark, options));
+			print_result(results.back());
+		}
+		catch (const Exception &e)
+		{
+			Console::write_line("%1: skipped (%2)", benchmark->get_full_name(), e.message);
+		}
+	}
+
+	if (!options.json_filename.empty())
+		write_json(options.json_filename, options, results);
+
+	return (int)results.size();
+}
+
+BenchmarkResult BenchmarkRunner::run_case(const BenchmarkCase &benchmark, const BenchmarkOptions &options)
+{
+	// Grow the batch until one sample takes long enough for the clock resolution to be irrelevant
+	int64_t iterations = 1;
+	while (true)
+	{
+		double elapsed = time_batch(benchmark, iterations);
+		if (elapsed >= options.min_sample_seconds || iterations >= (int64_t(1) << 40))
+			break;
+
+		double scale = elapsed > 0.0 ? options.min_sample_seconds * 1.2 / elapsed : 10.0;
+		iterations = (int64_t)(iterations * std::max(2.0, std::min(scale, 10.0)));
+	}
+
+	// Bring caches, branch predictors and the clock frequency to a steady state
+	auto warmup_start = std::chrono::steady_clock::now();
+	while (std::chrono::duration<double>(std::chrono::steady_clock::now() - warmup_start).count() < options.warmup_seconds)
+		time_batch(benchmark, iterations);
+
+	BenchmarkResult result;
+	result.suite = benchmark.suite;
+	result.name = benchmark.name;
+	result.iterations_per_sample = iterations;
+
+	for (int i = 0; i < options.repetitions; i++)
+		result.samples.push_back(time_batch(benchmark, iterations) * 1e9 / iterations);
+
+	std::vector<double> sorted_samples = result.samples;
+	std::sort(sorted_samples.begin(), sorted_samples.end());
+
+	double sum = 0.0;
+	for (double sample : sorted_samples)
+		sum += sample;
+	result.mean = sum / sorted_samples.size();
+
+	double variance = 0.0;
+	for (double sample : sorted_samples)
+		variance += (sample - result.mean) * (sample - result.mean);
+	result.stddev = sorted_samples.size() > 1 ? std::sqrt(variance / (sorted_samples.size() - 1)) : 0.0;
+
+	result.min = sorted_samples.front();
+	result.median = percentile(sorted_samples, 0.5);
+	result.p90 = percentile(sorted_samples, 0.9);
+	result.p99 = percentile(sorted_samples, 0.99);
+
+	if (result.median > 0.0)
+	{
+		result.bytes_per_second = benchmark.bytes_per_iteration * 1e9 / result.median;
+		result.items_per_second = benchmark.items_per_iteration * 1e9 / result.median;
+	}
+
+	return result;
+}
+
+double BenchmarkRunner::time_batch(const BenchmarkCase &benchmark, int64_t iterations)
+{
+	auto start = std::chrono::steady_clock::now();
+	benchmark.run(iterations);
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double>(end - start).count();
+}
+
+double BenchmarkRunner::percentile(const std::vector<double> &sorted_samples, double fraction)
+{
+	if (sorted_samples.empty())
+		return 0.0;
+
+	double position = fraction * (sorted_samples.size() - 1);
+	size_t index = (size_t)position;
+	if (index + 1 >= sorted_samples.size())
+		return sorted_samples.back();
+
+	double t = position - index;
+	return sorted_samples[index] * (1.0 - t) + sorted_samples[index + 1] * t;
+}
+
+void BenchmarkRunner::print_environment(const BenchmarkOptions &options)
+{
+	int cpu = options.cpu;
+#ifdef WIN32
+	if (cpu < 0)
+		cpu = (int)GetCurrentProcessorNumber();
+#elif !defined(__APPLE__)
+	if (cpu < 0)
+		cpu = sched_getcpu();
+#endif
+
+	pinned = cpu >= 0 && pin_to_cpu(cpu);
+	if (pinned)
+		Console::write_line("Pinned to CPU %1", cpu);
+	else
+		Console::write_line("Warning: unable to pin the benchmark thread to a CPU, results may be noisy");
+
+	std::string governor = get_cpu_governor(cpu < 0 ? 0 : cpu);
+	if (!governor.empty())
+	{
+		Console::write_line("CPU frequency governor: %1", governor);
+		if (governor != "performance")
+			Console::write_line("Warning: frequency scaling is active, select the 'performance' governor for stable results");
+	}
+
+	Console::write_line("%1 repetitions, %2 ms minimum per sample, %3 ms warmup", options.repetitions, (int)(options.min_sample_seconds * 1000.0), (int)(options.warmup_seconds * 1000.0));
+	Console::write_line("");
+}
+
+void BenchmarkRunner::print_result(const BenchmarkResult &result)
+{
+	std::string line = string_format("%1 median %2, min %3, p90 %4, p99 %5, stddev %6",
+		result.suite + "/" + result.name,
+		format_time(result.median), format_time(result.min), format_time(result.p90), format_time(result.p99), format_time(result.stddev));
+
+	if (result.bytes_per_second > 0.0)
+		line += string_format(", %1 MB/s", StringHelp::double_to_text(result.bytes_per_second / (1024.0 * 1024.0), 1));
+	else
+		line += string_format(", %1 items/s", StringHelp::double_to_text(result.items_per_second, 0));
+
+	Console::write_line(line);
+}
+
+void BenchmarkRunner::write_json(const std::string &filename, const BenchmarkOptions &options, const std::vector<BenchmarkResult> &results)
+{
+	JsonValue json = JsonValue::object();
+
+	JsonValue &context = json.prop("context");
+	context = JsonValue::object();
+	context.prop("repetitions") = JsonValue::number(options.repetitions);
+	context.prop("min_sample_seconds") = JsonValue::number(options.min_sample_seconds);
+	context.prop("warmup_seconds") = JsonValue::number(options.warmup_seconds);
+	context.prop("pinned") = JsonValue::boolean(pinned);
+	context.prop("cpu_governor") = JsonValue::string(get_cpu_governor(options.cpu < 0 ? 0 : options.cpu));
+
+	JsonValue &benchmarks = json.prop("benchmarks");
+	benchmarks = JsonValue::array();
+	for (const auto &result : results)
+	{
+		JsonValue item = JsonValue::object();
+		item.prop("suite") = JsonValue::string(result.suite);
+		item.prop("name") = JsonValue::string(result.name);
+		item.prop("iterations_per_sample") = JsonValue::number((double)result.iterations_per_sample);
+		item.prop("time_unit") = JsonValue::string("ns");
+		item.prop("min") = JsonValue::number(result.min);
+		item.prop("median") = JsonValue::number(result.median);
+		item.prop("mean") = JsonValue::number(result.mean);
+		item.prop("stddev") = JsonValue::number(result.stddev);
+		item.prop("p90") = JsonValue::number(result.p90);
+		item.prop("p99") = JsonValue::number(result.p99);
+		item.prop("bytes_per_second") = JsonValue::number(result.bytes_per_second);
+		item.prop("items_per_second") = JsonValue::number(result.items_per_second);
+
+		JsonValue &samples = item.prop("samples");
+		samples = JsonValue::array();
+		for (double sample : result.samples)
+			samples.items().push_back(JsonValue::number(sample));
+
+		benchmarks.items().push_back(item);
+	}
+
+	File::write_text(filename, json.to_json());
+	Console::write_line("");
+	Console::write_line("Results written to %1", filename);
+}
+
+bool BenchmarkRunner::pin_to_cpu(int cpu)
+{
+#ifdef WIN32
+	if (cpu >= (int)sizeof(DWORD_PTR) * 8)
+		return false;
+	SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST);
+	return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu) != 0;
+#elif defined(__APPLE__)
+	// macOS offers no hard affinity, only scheduling hints
+	return false;
+#else
+	cpu_set_t cpu_set;
+	CPU_ZERO(&cpu_set);
+	CPU_SET(cpu, &cpu_set);
+	return sched_setaffinity(0, sizeof(cpu_set), &cpu_set) == 0;
+#endif
+}
+
+std::string BenchmarkRunner::get_cpu_governor(int cpu)
+{
+#if defined(WIN32) || defined(__APPLE__)
+	return std::string();
+#else
+	try
+	{
+		return StringHelp::trim(File::read_text(string_format("/sys/devices/system/cpu/cpu%1/cpufreq/scaling_governor", cpu)));
+	}
+	catch (const Exception &)
+	{
+		return std::string();
+	}
+#endif
+}
+
+std::string BenchmarkRunner::format_time(double nanoseconds)
+{
+	if (nanoseconds < 1000.0)
+		return StringHelp::double_to_text(nanoseconds, 1) + " ns";
+	else if (nanoseconds < 1000000.0)
+		return StringHelp::double_to_text(nanoseconds / 1000.0, 2) + " us";
+	else
+		return StringHelp::double_to_text(nanoseconds / 1000000.0, 2) + " ms";
+}
@@ -0,0 +1,119 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+/// \brief Keeps the compiler from optimizing away a value computed by a benchmark
+template<typename T>
+inline void do_not_optimize(const T &value)
+{
+#ifdef _MSC_VER
+	extern volatile const void *benchmark_sink;
+	benchmark_sink = &value;
+	_ReadWriteBarrier();
+#else
+	asm volatile("" : : "g"(&value) : "memory");
+#endif
+}
+
+/// \brief A registered benchmark
+///
+/// The run function must perform the measured operation the given number of times.
+class BenchmarkCase
+{
+public:
+	std::string suite;
+	std::string name;
+	std::function<void(int64_t iterations)> run;
+	int64_t bytes_per_iteration = 0;
+	int64_t items_per_iteration = 1;
+
+	std::string get_full_name() const { return suite + "/" + name; }
+};
+
+/// \brief Timing statistics for one benchmark, all in nanoseconds per iteration
+class BenchmarkResult
+{
+public:
+	std::string suite;
+	std::string name;
+	int64_t iterations_per_sample = 0;
+	std::vector<double> samples;
+
+	double min = 0.0;
+	double median = 0.0;
+	double mean = 0.0;
+	double stddev = 0.0;
+	double p90 = 0.0;
+	double p99 = 0.0;
+
+	double bytes_per_second = 0.0;
+	double items_per_second = 0.0;
+};
+
+class BenchmarkOptions
+{
+public:
+	std::string filter;
+	std::string json_filename;
+	int repetitions = 15;
+	double warmup_seconds = 0.2;
+	double min_sample_seconds = 0.01;
+	int cpu = -1;
+	bool list_only = false;
+};
+
+class BenchmarkRunner
+{
+public:
+	/// \brief Registers a benchmark
+	void add(const std::string &suite, const std::string &name, const std::function<void(int64_t iterations)> &run, int64_t bytes_per_iteration = 0, int64_t items_per_iteration = 1);
+
+	/// \brief Runs all benchmarks matching the filter and returns the number that ran
+	int run(const BenchmarkOptions &options);
+
+private:
+	BenchmarkResult run_case(const BenchmarkCase &benchmark, const BenchmarkOptions &options);
+	void print_environment(const BenchmarkOptions &options);
+	void print_result(const BenchmarkResult &result);
+	void write_json(const std::string &filename, const BenchmarkOptions &options, const std::vector<BenchmarkResult> &results);
+
+	static double time_batch(const BenchmarkCase &benchmark, int64_t iterations);
+	static double percentile(const std::vector<double> &sorted_samples, double fraction);
+	static bool pin_to_cpu(int cpu);
+	static std::string get_cpu_governor(int cpu);
+	static std::string format_time(double nanoseconds);
+
+	std::vector<BenchmarkCase> cases;
+	bool pinned = false;
+};
+
+void add_core_benchmarks(BenchmarkRunner &runner);
+void add_display_benchmarks(BenchmarkRunner &runner);
+void add_xml_benchmarks(BenchmarkRunner &runner);
@@ -1,9 +1,12 @@
 #pragma once
 
 #include <ClanLib/core.h>
-#include <ClanLib/application.h>
 #include <ClanLib/display.h>
 #include <ClanLib/gl.h>
+#include <ClanLib/xml.h>
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <functional>
 
-
+using namespace clan;
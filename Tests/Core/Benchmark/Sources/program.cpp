@@ -0,0 +1,104 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "precomp.h"
+#include "benchmark.h"
+
+namespace
+{
+	bool parse_option(const std::string &arg, const char *name, std::string &value)
+	{
+		std::string prefix = std::string(name) + "=";
+		if (arg.compare(0, prefix.size(), prefix) != 0)
+			return false;
+		value = arg.substr(prefix.size());
+		return true;
+	}
+
+	void print_usage()
+	{
+		Console::write_line("Usage: benchmark [options]");
+		Console::write_line("  --filter=<text>       Only run benchmarks whose suite/name contains text");
+		Console::write_line("  --repetitions=<n>     Number of timed samples per benchmark (default 15)");
+		Console::write_line("  --warmup=<ms>         Warmup time per benchmark (default 200)");
+		Console::write_line("  --min-time=<ms>       Minimum duration of one sample (default 10)");
+		Console::write_line("  --cpu=<n>             CPU to pin the benchmark thread to (default: current)");
+		Console::write_line("  --json=<file>         Write results as JSON");
+		Console::write_line("  --list                List benchmarks without running them");
+	}
+}
+
+int main(int argc, char **argv)
+{
+	ConsoleWindow console("Console");
+
+	try
+	{
+		BenchmarkOptions options;
+		for (int i = 1; i < argc; i++)
+		{
+			std::string arg = argv[i];
+			std::string value;
+			if (parse_option(arg, "--filter", value))
+				options.filter = value;
+			else if (parse_option(arg, "--repetitions", value))
+				options.repetitions = std::max(StringHelp::text_to_int(value), 1);
+			else if (parse_option(arg, "--warmup", value))
+				options.warmup_seconds = StringHelp::text_to_int(value) / 1000.0;
+			else if (parse_option(arg, "--min-time", value))
+				options.min_sample_seconds = std::max(StringHelp::text_to_int(value), 1) / 1000.0;
+			else if (parse_option(arg, "--cpu", value))
+				options.cpu = StringHelp::text_to_int(value);
+			else if (parse_option(arg, "--json", value))
+				options.json_filename = value;
+			else if (arg == "--list")
+				options.list_only = true;
+			else
+			{
+				print_usage();
+				return arg == "--help" ? 0 : 1;
+			}
+		}
+
+		BenchmarkRunner runner;
+		add_core_benchmarks(runner);
+		add_xml_benchmarks(runner);
+		add_display_benchmarks(runner);
+
+		if (runner.run(options) == 0)
+			Console::write_line("No benchmarks matched '%1'", options.filter);
+	}
+	catch (const Exception &e)
+	{
+		Console::write_line("Exception caught: %1", e.get_message_and_stack_trace());
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,161 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "precomp.h"
+#include "benchmark.h"
+
+namespace
+{
+	std::string create_json_document(int entries)
+	{
+		JsonValue document = JsonValue::object();
+		JsonValue &list = document.prop("entries");
+		list = JsonValue::array();
+		for (int i = 0; i < entries; i++)
+		{
+			JsonValue entry = JsonValue::object();
+			entry.prop("id") = JsonValue::number(i);
+			entry.prop("name") = JsonValue::string(string_format("entry %1", i));
+			entry.prop("visible") = JsonValue::boolean((i & 1) == 0);
+			entry.prop("position") = JsonValue::array();
+			entry.prop("position").items().push_back(JsonValue::number(i * 0.5));
+			entry.prop("position").items().push_back(JsonValue::number(i * -0.25));
+			list.items().push_back(entry);
+		}
+		return document.to_json();
+	}
+
+	DataBuffer create_zip_archive(int file_count, int file_size)
+	{
+		std::vector<char> contents(file_size);
+		for (int i = 0; i < file_size; i++)
+			contents[i] = 'a' + (i * 7 + i / 13) % 26;
+
+		MemoryDevice output;
+		ZipWriter writer(output, true);
+		for (int i = 0; i < file_count; i++)
+		{
+			writer.begin_file(string_format("data/file%1.txt", i), (i & 1) == 0);
+			writer.write_file_data(contents.data(), file_size);
+			writer.end_file();
+		}
+		writer.write_toc();
+		return output.get_data();
+	}
+}
+
+void add_core_benchmarks(BenchmarkRunner &runner)
+{
+	auto json = std::make_shared<std::string>(create_json_document(1000));
+	runner.add("JsonValue", "parse", [json](int64_t iterations)
+	{
+		for (int64_t i = 0; i < iterations; i++)
+		{
+			JsonValue value = JsonValue::parse(*json);
+			do_not_optimize(value);
+		}
+	}, json->size());
+
+	auto signal = std::make_shared<Signal<void(int)>>();
+	auto slots = std::make_shared<SlotContainer>();
+	auto counter = std::make_shared<int>(0);
+	for (int i = 0; i < 4; i++)
+		slots->connect(*signal, [counter](int value) { *counter += value; });
+	runner.add("Signal", "emit_4_slots", [signal, slots, counter](int64_t iterations)
+	{
+		for (int64_t i = 0; i < iterations; i++)
+			(*signal)(1);
+		do_not_optimize(*counter);
+	});
+
+	auto work_queue = std::make_shared<WorkQueue>();
+	runner.add("WorkQueue", "queue_1000_items", [work_queue](int64_t iterations)
+	{
+		std::atomic<int> sum(0);
+		for (int64_t i = 0; i < iterations; i++)
+		{
+			WorkGroup group;
+			for (int j = 0; j < 1000; j++)
+				work_queue->queue(group, [&sum]() { sum.fetch_add(1, std::memory_order_relaxed); });
+			work_queue->wait(group);
+		}
+		do_not_optimize(sum);
+	}, 0, 1000);
+
+	auto values = std::make_shared<std::vector<float>>(1 << 20, 1.0f);
+	runner.add("WorkQueue", "parallel_for_1M", [work_queue, values](int64_t iterations)
+	{
+		for (int64_t i = 0; i < iterations; i++)
+		{
+			float *data = values->data();
+			work_queue->parallel_for(0, (int)values->size(), 0, [data](int first, int last)
+			{
+				for (int j = first; j < last; j++)
+					data[j] = data[j] * 0.5f + 0.5f;
+			});
+		}
+		do_not_optimize(values->front());
+	}, values->size() * sizeof(float), values->size());
+
+	auto zip_data = std::make_shared<DataBuffer>(create_zip_archive(256, 4096));
+	auto zip_names = std::make_shared<std::vector<std::string>>();
+	for (int i = 0; i < 256; i++)
+		zip_names->push_back(string_format("data/file%1.txt", i));
+	runner.add("ZipArchive", "load", [zip_data](int64_t iterations)
+	{
+		for (int64_t i = 0; i < iterations; i++)
+		{
+			MemoryDevice input(*zip_data);
+			ZipArchive archive(input);
+			do_not_optimize(archive);
+		}
+	}, zip_data->get_size());
+
+	auto zip_input = std::make_shared<MemoryDevice>(*zip_data);
+	auto archive = std::make_shared<ZipArchive>(*zip_input);
+	runner.add("ZipArchive", "open_file", [archive, zip_input, zip_names](int64_t iterations)
+	{
+		char buffer[4096];
+		for (int64_t i = 0; i < iterations; i++)
+		{
+			IODevice file = archive->open_file((*zip_names)[i % zip_names->size()]);
+			file.read(buffer, sizeof(buffer));
+			do_not_optimize(buffer);
+		}
+	}, 4096);
+
+	runner.add("ZipArchive", "read_file", [archive, zip_input, zip_names](int64_t iterations)
+	{
+		for (int64_t i = 0; i < iterations; i++)
+		{
+			DataBufferView file = archive->read_file((*zip_names)[i % zip_names->size()]);
+			do_not_optimize(file);
+		}
+	}, 4096);
+}
@@ -0,0 +1,143 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "precomp.h"
+#include "benchmark.h"
+
+namespace
+{
+	struct PixelConversion
+	{
+		const char *name;
+		TextureFormat input_format;
+		int input_bytes_per_pixel;
+		TextureFormat output_format;
+		int output_bytes_per_pixel;
+	};
+
+	void add_pixel_converter_benchmark(BenchmarkRunner &runner, const PixelConversion &conversion)
+	{
+		const int width = 1024;
+		const int height = 256;
+
+		auto converter = std::make_shared<PixelConverter>();
+		converter->set_multithreaded(false);
+
+		auto input = std::make_shared<std::vector<char>>(width * height * conversion.input_bytes_per_pixel);
+		auto output = std::make_shared<std::vector<char>>(width * height * conversion.output_bytes_per_pixel);
+		for (size_t i = 0; i < input->size(); i++)
+			(*input)[i] = (char)(i * 31 + i / 7);
+
+		// Half float input is filled with a valid bit pattern to avoid measuring NaN handling
+		if (conversion.input_format == tf_rgba16f)
+		{
+			unsigned short *values = reinterpret_cast<unsigned short*>(input->data());
+			for (size_t i = 0; i < input->size() / 2; i++)
+				values[i] = HalfFloat::float_to_half((i % 256) / 255.0f);
+		}
+
+		runner.add("PixelConverter", conversion.name, [=](int64_t iterations)
+		{
+			for (int64_t i = 0; i < iterations; i++)
+			{
+				converter->convert(
+					output->data(), width * conversion.output_bytes_per_pixel, conversion.output_format,
+					input->data(), width * conversion.input_bytes_per_pixel, conversion.input_format,
+					width, height);
+			}
+			do_not_optimize(output->front());
+		}, width * height * conversion.input_bytes_per_pixel, width * height);
+	}
+
+	class DisplayContext
+	{
+	public:
+		DisplayContext()
+		{
+			OpenGLTarget::set_current();
+			window = DisplayWindow("Benchmark", 320.0f, 200.0f);
+			canvas = Canvas(window);
+		}
+
+		DisplayWindow window;
+		Canvas canvas;
+	};
+}
+
+void add_display_benchmarks(BenchmarkRunner &runner)
+{
+	static const PixelConversion conversions[] =
+	{
+		{ "rgba8_to_bgra8", tf_rgba8, 4, tf_bgra8, 4 },
+		{ "bgr8_to_rgba8", tf_bgr8, 3, tf_rgba8, 4 },
+		{ "rgba8_to_rgba16f", tf_rgba8, 4, tf_rgba16f, 8 },
+		{ "rgba16f_to_rgba8", tf_rgba16f, 8, tf_rgba8, 4 },
+		{ "rgba8_to_rgba32f", tf_rgba8, 4, tf_rgba32f, 16 }
+	};
+
+	for (const auto &conversion : conversions)
+		add_pixel_converter_benchmark(runner, conversion);
+
+	// The glyph cache needs a graphic context, so it is skipped when no display is available
+	std::shared_ptr<DisplayContext> display;
+	Font font;
+	try
+	{
+		display = std::make_shared<DisplayContext>();
+		font = Font("Tahoma", 16.0f);
+		font.measure_text(display->canvas, "warm up");
+	}
+	catch (const Exception &e)
+	{
+		Console::write_line("GlyphCache benchmarks skipped: %1", e.message);
+		return;
+	}
+
+	auto text = std::make_shared<std::string>("The quick brown fox jumps over the lazy dog. 0123456789 !?#%&()[]{}");
+	runner.add("GlyphCache", "measure_text", [display, font, text](int64_t iterations) mutable
+	{
+		for (int64_t i = 0; i < iterations; i++)
+		{
+			GlyphMetrics metrics = font.measure_text(display->canvas, *text);
+			do_not_optimize(metrics);
+		}
+	}, 0, text->size());
+
+	auto glyph_text = std::make_shared<std::string>();
+	for (int c = 0x20; c < 0x17f; c++)
+		*glyph_text += StringHelp::unicode_to_utf8(c);
+	runner.add("GlyphCache", "measure_text_latin", [display, font, glyph_text](int64_t iterations) mutable
+	{
+		for (int64_t i = 0; i < iterations; i++)
+		{
+			GlyphMetrics metrics = font.measure_text(display->canvas, *glyph_text);
+			do_not_optimize(metrics);
+		}
+	}, 0, 0x17f - 0x20);
+}
@@ -0,0 +1,87 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "precomp.h"
+#include "benchmark.h"
+
+namespace
+{
+	std::string create_xml_document(int elements)
+	{
+		std::string xml = "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<resources>\n";
+		for (int i = 0; i < elements; i++)
+		{
+			xml += string_format("\t<sprite name=\"sprite%1\" width=\"%2\" height=\"%3\">\n", i, 32 + i % 64, 16 + i % 32);
+			xml += string_format("\t\t<image file=\"images/sprite%1.png\"/>\n", i);
+			xml += "\t\t<!-- frame data -->\n";
+			xml += string_format("\t\t<frame delay=\"%1\">Frame &amp; text %2</frame>\n", 50 + i % 10, i);
+			xml += "\t</sprite>\n";
+		}
+		xml += "</resources>\n";
+		return xml;
+	}
+}
+
+void add_xml_benchmarks(BenchmarkRunner &runner)
+{
+	auto xml = std::make_shared<std::string>(create_xml_document(1000));
+
+	runner.add("XMLTokenizer", "next", [xml](int64_t iterations)
+	{
+		for (int64_t i = 0; i < iterations; i++)
+		{
+			XMLTokenizer tokenizer(xml->data(), xml->size());
+			XMLToken token;
+			int count = 0;
+			do
+			{
+				tokenizer.next(&token);
+				count++;
+			} while (token.type != XMLToken::NULL_TOKEN);
+			do_not_optimize(count);
+		}
+	}, xml->size());
+
+	runner.add("XMLTokenizer", "next_eat_whitespace", [xml](int64_t iterations)
+	{
+		for (int64_t i = 0; i < iterations; i++)
+		{
+			XMLTokenizer tokenizer(xml->data(), xml->size());
+			tokenizer.set_eat_whitespace(true);
+			XMLToken token;
+			int count = 0;
+			do
+			{
+				tokenizer.next(&token);
+				count++;
+			} while (token.type != XMLToken::NULL_TOKEN);
+			do_not_optimize(count);
+		}
+	}, xml->size());
+}
@@ -56,6 +56,9 @@ int TestApp::main()
 		test_aes128();
 		test_aes192();
 		test_aes256();
+		test_aes_gcm();
+		test_chacha20_poly1305();
+		test_x25519();
 		test_sha1();
 		test_sha224();
 		test_sha256();
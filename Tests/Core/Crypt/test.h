@@ -69,6 +69,11 @@ private:
 	void test_aes256();
 	void test_aes256_helper(const char *key_ptr, const char *iv_ptr, const char *plaintext_ptr, const char *ciphertext_ptr);
 	void convert_ascii(const char *src, std::vector<unsigned char> &dest);
+	void test_aes_gcm();
+	void test_aes_gcm_helper(const char *key_ptr, const char *nonce_ptr, const char *aad_ptr, const char *plaintext_ptr, const char *ciphertext_ptr, const char *tag_ptr);
+	void test_chacha20_poly1305();
+	void test_x25519();
+	void test_x25519_helper(const char *scalar_ptr, const char *point_ptr, const char *output_ptr);
 
 	void test_rsa();
 	void test_md5();
@@ -0,0 +1,108 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "test.h"
+#include "Core/Crypto/aes_gcm.h"
+
+void TestApp::test_aes_gcm()
+{
+	Console::write_line(" Header: aes_gcm.h");
+	Console::write_line("  Class: AES_GCM");
+
+	// Test cases 1, 4 and 16 from "The Galois/Counter Mode of Operation (GCM)", McGrew and Viega
+
+	test_aes_gcm_helper(
+		"00000000000000000000000000000000",	// KEY
+		"000000000000000000000000",	// NONCE
+		"",	// AAD
+		"",	// PLAINTEXT
+		"",	// CIPHERTEXT
+		"58e2fccefa7e3061367f1d57a4e7455a"	// TAG
+		);
+
+	test_aes_gcm_helper(
+		"feffe9928665731c6d6a8f9467308308",	// KEY
+		"cafebabefacedbaddecaf888",	// NONCE
+		"feedfacedeadbeeffeedfacedeadbeefabaddad2",	// AAD
+		"d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a72"	// PLAINTEXT
+		"1c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b39",
+		"42831ec2217774244b7221b784d0d49ce3aa212f2c02a4e035c17e2329aca12e"	// CIPHERTEXT
+		"21d514b25466931c7d8f6a5aac84aa051ba30b396a0aac973d58e091",
+		"5bc94fbc3221a5db94fae95ae7121a47"	// TAG
+		);
+
+	test_aes_gcm_helper(
+		"feffe9928665731c6d6a8f9467308308feffe9928665731c6d6a8f9467308308",	// KEY
+		"cafebabefacedbaddecaf888",	// NONCE
+		"feedfacedeadbeeffeedfacedeadbeefabaddad2",	// AAD
+		"d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a72"	// PLAINTEXT
+		"1c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b39",
+		"522dc1f099567d07f47f37a32a84427d643a8cdcbfe5c0c97598a2bd2555d1aa"	// CIPHERTEXT
+		"8cb08e48590dbb3da7b08b1056828838c5f61e6393ba7a0abcc9f662",
+		"76fc6ece0f4e1768cddf8853bb2d551b"	// TAG
+		);
+}
+
+void TestApp::test_aes_gcm_helper(const char *key_ptr, const char *nonce_ptr, const char *aad_ptr, const char *plaintext_ptr, const char *ciphertext_ptr, const char *tag_ptr)
+{
+	std::vector<unsigned char> key;
+	std::vector<unsigned char> nonce;
+	std::vector<unsigned char> aad;
+	std::vector<unsigned char> plaintext;
+	std::vector<unsigned char> ciphertext;
+	std::vector<unsigned char> tag;
+
+	convert_ascii(key_ptr, key);
+	convert_ascii(nonce_ptr, nonce);
+	convert_ascii(aad_ptr, aad);
+	convert_ascii(plaintext_ptr, plaintext);
+	convert_ascii(ciphertext_ptr, ciphertext);
+	convert_ascii(tag_ptr, tag);
+
+	AES_GCM cipher(&key[0], key.size());
+
+	std::vector<unsigned char> output(plaintext.size());
+	unsigned char result_tag[AES_GCM::tag_size];
+	cipher.encrypt(&nonce[0], aad.data(), aad.size(), plaintext.data(), plaintext.size(), output.data(), result_tag);
+	if (output != ciphertext)
+		fail();
+	if (memcmp(result_tag, &tag[0], AES_GCM::tag_size))
+		fail();
+
+	std::vector<unsigned char> decrypted(ciphertext.size());
+	if (!cipher.decrypt(&nonce[0], aad.data(), aad.size(), ciphertext.data(), ciphertext.size(), decrypted.data(), &tag[0]))
+		fail();
+	if (decrypted != plaintext)
+		fail();
+
+	// A modified tag must fail authentication
+	tag[AES_GCM::tag_size - 1] ^= 0x80;
+	if (cipher.decrypt(&nonce[0], aad.data(), aad.size(), ciphertext.data(), ciphertext.size(), decrypted.data(), &tag[0]))
+		fail();
+}
@@ -0,0 +1,80 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "test.h"
+#include "Core/Crypto/chacha20_poly1305.h"
+
+void TestApp::test_chacha20_poly1305()
+{
+	Console::write_line(" Header: chacha20_poly1305.h");
+	Console::write_line("  Class: ChaCha20_Poly1305");
+
+	// AEAD test vector from RFC 8439, section 2.8.2
+	std::vector<unsigned char> key;
+	std::vector<unsigned char> nonce;
+	std::vector<unsigned char> aad;
+	std::vector<unsigned char> ciphertext;
+	std::vector<unsigned char> tag;
+
+	convert_ascii("808182838485868788898a8b8c8d8e8f909192939495969798999a9b9c9d9e9f", key);
+	convert_ascii("070000004041424344454647", nonce);
+	convert_ascii("50515253c0c1c2c3c4c5c6c7", aad);
+	convert_ascii(
+		"d31a8d34648e60db7b86afbc53ef7ec2a4aded51296e08fea9e2b5a736ee62d6"
+		"3dbea45e8ca9671282fafb69da92728b1a71de0a9e060b2905d6a5b67ecd3b36"
+		"92ddbd7f2d778b8c9803aee328091b58fab324e4fad675945585808b4831d7bc"
+		"3ff4def08e4b7a9de576d26586cec64b6116", ciphertext);
+	convert_ascii("1ae10b594f09e26a7e902ecbd0600691", tag);
+
+	const char *plaintext = "Ladies and Gentlemen of the class of '99: If I could offer you only one tip for the future, sunscreen would be it.";
+	int plaintext_size = strlen(plaintext);
+	if (plaintext_size != (int)ciphertext.size())
+		fail();
+
+	ChaCha20_Poly1305 cipher(&key[0]);
+
+	std::vector<unsigned char> output(plaintext_size);
+	unsigned char result_tag[ChaCha20_Poly1305::tag_size];
+	cipher.encrypt(&nonce[0], &aad[0], aad.size(), plaintext, plaintext_size, &output[0], result_tag);
+	if (memcmp(&output[0], &ciphertext[0], ciphertext.size()))
+		fail();
+	if (memcmp(result_tag, &tag[0], ChaCha20_Poly1305::tag_size))
+		fail();
+
+	std::vector<unsigned char> decrypted(plaintext_size);
+	if (!cipher.decrypt(&nonce[0], &aad[0], aad.size(), &ciphertext[0], ciphertext.size(), &decrypted[0], &tag[0]))
+		fail();
+	if (memcmp(&decrypted[0], plaintext, plaintext_size))
+		fail();
+
+	// A modified tag must fail authentication
+	tag[0] ^= 0x01;
+	if (cipher.decrypt(&nonce[0], &aad[0], aad.size(), &ciphertext[0], ciphertext.size(), &decrypted[0], &tag[0]))
+		fail();
+}
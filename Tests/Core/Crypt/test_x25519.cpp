@@ -0,0 +1,97 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "test.h"
+#include "Core/Crypto/x25519.h"
+
+void TestApp::test_x25519()
+{
+	Console::write_line(" Header: x25519.h");
+	Console::write_line("  Class: X25519");
+
+	// Test vectors from RFC 7748, section 5.2
+	test_x25519_helper(
+		"a546e36bf0527c9d3b16154b82465edd62144c0ac1fc5a18506a2244ba449ac4",	// SCALAR
+		"e6db6867583030db3594c1a424b15f7c726624ec26b3353b10a903a6d0ab1c4c",	// U-COORDINATE
+		"c3da55379de9c6908e94ea4df28d084f32eccf03491c71f754b4075577a28552"	// OUTPUT
+		);
+
+	test_x25519_helper(
+		"4b66e9d4d1b4673c5ad22691957d6af5c11b6421e0ea01d42ca4169e7918ba0d",	// SCALAR
+		"e5210f12786811d3f4b7959d0538ae2c31dbe7106fc03c3efc4cd549c715a493",	// U-COORDINATE
+		"95cbde9476e8907d7aade45cb4b873f88b595a68799fa152e6f8f7647aac7957"	// OUTPUT
+		);
+
+	// Diffie-Hellman example from RFC 7748, section 6.1
+	std::vector<unsigned char> alice_private, alice_public, bob_private, bob_public, shared;
+	convert_ascii("77076d0a7318a57d3c16c17251b26645df4c2f87ebc0992ab177fba51db92c2a", alice_private);
+	convert_ascii("8520f0098930a754748b7ddcb43ef75a0dbf3a0d26381af4eba4a98eaa9b4e6a", alice_public);
+	convert_ascii("5dab087e624a8a4b79e17f8b83800ee66f3bb1292618b6fd1c2f8b27ff88e0eb", bob_private);
+	convert_ascii("de9edb7d7b7dc1b4d35b61c2ece435373f8343c85b78674dadfc7e146f882b4f", bob_public);
+	convert_ascii("4a5d9d5ba4ce2de1728e3bf480350f25e07e21c947d19e3376f09b3c1e161742", shared);
+
+	unsigned char result[X25519::key_size];
+	X25519::public_key(&alice_private[0], result);
+	if (memcmp(result, &alice_public[0], X25519::key_size))
+		fail();
+	X25519::public_key(&bob_private[0], result);
+	if (memcmp(result, &bob_public[0], X25519::key_size))
+		fail();
+
+	if (!X25519::shared_secret(&alice_private[0], &bob_public[0], result))
+		fail();
+	if (memcmp(result, &shared[0], X25519::key_size))
+		fail();
+	if (!X25519::shared_secret(&bob_private[0], &alice_public[0], result))
+		fail();
+	if (memcmp(result, &shared[0], X25519::key_size))
+		fail();
+
+	// A point of small order must be rejected
+	unsigned char zero_point[X25519::key_size] = { 0 };
+	if (X25519::shared_secret(&alice_private[0], zero_point, result))
+		fail();
+}
+
+void TestApp::test_x25519_helper(const char *scalar_ptr, const char *point_ptr, const char *output_ptr)
+{
+	std::vector<unsigned char> scalar;
+	std::vector<unsigned char> point;
+	std::vector<unsigned char> output;
+
+	convert_ascii(scalar_ptr, scalar);
+	convert_ascii(point_ptr, point);
+	convert_ascii(output_ptr, output);
+
+	unsigned char result[X25519::key_size];
+	if (!X25519::shared_secret(&scalar[0], &point[0], result))
+		fail();
+	if (memcmp(result, &output[0], X25519::key_size))
+		fail();
+}
@@ -0,0 +1,267 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "test.h"
+
+int main(int argc, char** argv)
+{
+	TestApp program;
+	return program.main();
+}
+
+int TestApp::main()
+{
+	// Create a console window for text-output if not available
+	ConsoleWindow console("Console");
+
+	try
+	{
+		Console::write_line("ClanLib Test Suite:");
+		Console::write_line("-------------------");
+#ifdef WIN32
+		Console::write_line("Target: WIN32");
+#else
+		Console::write_line("Target: LINUX");
+#endif
+		Console::write_line("Directory: API/Core/JSON");
+
+		test_parse();
+		test_escapes();
+		test_numbers();
+		test_nesting();
+		test_in_situ();
+		test_errors();
+
+		Console::write_line("All Tests Complete");
+		console.display_close_message();
+	}
+	catch (Exception &error)
+	{
+		Console::write_line("Exception caught:");
+		Console::write_line(error.message);
+		console.display_close_message();
+		return -1;
+	}
+
+	return 0;
+}
+
+void TestApp::test_parse()
+{
+	Console::write_line("   Function: JsonValue::parse()");
+
+	JsonValue value = JsonValue::parse(" { \"name\" : \"ClanLib\", \"version\": 4, \"tags\": [ \"a\", \"b\" ], \"stable\": true, \"beta\": false, \"parent\": null } ");
+	if (!value.is_object() || value.properties().size() != 6)
+		fail();
+	if (value["name"].to_string() != "ClanLib" || value["version"].to_int() != 4)
+		fail();
+	if (!value["tags"].is_array() || value["tags"].size() != 2 || value["tags"].at(1).to_string() != "b")
+		fail();
+	if (!value["stable"].to_boolean() || value["beta"].to_boolean() || !value["beta"].is_boolean())
+		fail();
+	if (!value["parent"].is_null())
+		fail();
+
+	// Runs of whitespace and strings longer than a vector register
+	std::string indent(37, ' ');
+	std::string long_text(100, 'x');
+	std::string json = "[\n" + indent + "\"" + long_text + "\",\r\n\t" + indent + "{}\n" + indent + "]";
+	value = JsonValue::parse(json);
+	if (value.size() != 2 || value.at(0).to_string() != long_text || !value.at(1).is_object())
+		fail();
+}
+
+void TestApp::test_escapes()
+{
+	Console::write_line("   Function: string escapes");
+
+	JsonValue value = JsonValue::parse("\"q\\\"b\\\\s\\/b\\bf\\fn\\nr\\rt\\t\\u0041\\u00e9\\u20AC\\ud83d\\ude00\"");
+	if (value.to_string() != "q\"b\\s/b\bf\fn\nr\rt\tA\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80")
+		fail();
+
+	// Every control character, the characters that must be escaped and raw UTF-8 survive a round trip
+	std::string all_special;
+	for (int c = 0; c < 32; c++)
+		all_special.push_back((char)c);
+	all_special += "\"\\/ plain text \xc3\xa6\xc3\xb8\xc3\xa5";
+	JsonValue special = JsonValue::string(all_special);
+	if (round_trip(special).to_string() != all_special)
+		fail();
+	if (special.to_json().find_first_of(std::string("\n\r\t\0", 4)) != std::string::npos)
+		fail();
+
+	// An escape at every offset relative to the vector scan
+	for (int offset = 0; offset < 40; offset++)
+	{
+		std::string text = std::string(offset, 'a') + "\"" + std::string(40 - offset, 'b') + "\\";
+		JsonValue parsed = round_trip(JsonValue::string(text));
+		if (parsed.to_string() != text)
+			fail();
+	}
+}
+
+void TestApp::test_numbers()
+{
+	Console::write_line("   Function: numbers");
+
+	const double numbers[] = { 0.0, 1.0, -1.0, 42.0, 0.1, -0.5, 1.0 / 3.0, 1e-7, 2.5e-300, 1.5e300, 123456789012345.0, 4294967296.0, -2147483649.0, 9007199254740993.0 };
+	for (double number : numbers)
+	{
+		JsonValue parsed = round_trip(JsonValue::number(number));
+		if (!parsed.is_number() || parsed.to_number() != number)
+			fail();
+	}
+
+	JsonValue value = JsonValue::parse("[0, -0, 12, -3.25, 1e2, 1E+2, 2.5e-1, 6.02214076e23]");
+	const double expected[] = { 0.0, 0.0, 12.0, -3.25, 100.0, 100.0, 0.25, 6.02214076e23 };
+	if (value.size() != sizeof(expected) / sizeof(expected[0]))
+		fail();
+	for (size_t i = 0; i < value.size(); i++)
+	{
+		if (value[i].to_number() != expected[i])
+			fail();
+	}
+}
+
+void TestApp::test_nesting()
+{
+	Console::write_line("   Function: nesting");
+
+	// The writer emits no whitespace and sorted keys, so canonical JSON is written back unchanged
+	std::string json = "{\"a\":[1,{\"b\":[[],{}],\"c\":[[[\"deep\"]]]},\"x\"],\"d\":{\"e\":null,\"f\":true,\"g\":false},\"h\":[]}";
+	JsonValue value = JsonValue::parse(json);
+	if (value["a"].at(1)["c"].at(0).at(0).at(0).to_string() != "deep")
+		fail();
+	if (!value["a"].at(1)["b"].at(0).is_array() || !value["a"].at(1)["b"].at(1).is_object())
+		fail();
+	if (value.to_json() != json)
+		fail();
+
+	// Deeply nested arrays
+	std::string deep = std::string(200, '[') + "7" + std::string(200, ']');
+	value = JsonValue::parse(deep);
+	if (value.to_json() != deep)
+		fail();
+
+	std::string buffer;
+	value.to_json(buffer);
+	if (buffer != deep)
+		fail();
+}
+
+void TestApp::test_in_situ()
+{
+	Console::write_line("   Function: JsonValue::parse() in situ");
+
+	std::string json = "{\"plain\": \"text\", \"escaped\": \"a\\nb\\u00e9c\\\"\", \"es\\tkey\": [1.5, \"\\ud83d\\ude00x\"], \"number\": 42}";
+	JsonValue expected = JsonValue::parse(json);
+
+	// The buffer is not null terminated and ends with a number
+	std::vector<char> buffer(json.begin(), json.end());
+	JsonValue value = JsonValue::parse(buffer.data(), buffer.size());
+	if (!equal(value, expected))
+		fail();
+	if (value["escaped"].to_string() != "a\nb\xc3\xa9" "c\"" || value["es\tkey"].at(1).to_string() != "\xf0\x9f\x98\x80x")
+		fail();
+
+	std::vector<char> number(1, '7');
+	if (JsonValue::parse(number.data(), number.size()).to_number() != 7.0)
+		fail();
+}
+
+void TestApp::test_errors()
+{
+	Console::write_line("   Function: invalid JSON");
+
+	const char *invalid[] = { "", "   ", "\"unterminated", "\"bad \\q escape\"", "\"\\u12\"", "[1, 2", "[1 2]", "{\"a\" 1}", "{\"a\": 1", "{1: 2}", "tru", "nul", "-" };
+	for (const char *json : invalid)
+	{
+		bool thrown = false;
+		try
+		{
+			JsonValue::parse(json);
+		}
+		catch (JsonException &)
+		{
+			thrown = true;
+		}
+		if (!thrown)
+			fail();
+	}
+}
+
+bool TestApp::equal(const JsonValue &a, const JsonValue &b)
+{
+	if (a.type() != b.type())
+		return false;
+
+	switch (a.type())
+	{
+	case JsonType::object:
+		if (a.properties().size() != b.properties().size())
+			return false;
+		for (const auto &it : a.properties())
+		{
+			auto other = b.properties().find(it.first);
+			if (other == b.properties().end() || !equal(it.second, other->second))
+				return false;
+		}
+		return true;
+	case JsonType::array:
+		if (a.size() != b.size())
+			return false;
+		for (size_t i = 0; i < a.size(); i++)
+		{
+			if (!equal(a[i], b[i]))
+				return false;
+		}
+		return true;
+	case JsonType::number:
+		return a.to_number() == b.to_number();
+	case JsonType::boolean:
+		return a.to_boolean() == b.to_boolean();
+	case JsonType::string:
+		return a.to_string() == b.to_string();
+	default:
+		return true;
+	}
+}
+
+JsonValue TestApp::round_trip(const JsonValue &value)
+{
+	JsonValue parsed = JsonValue::parse(value.to_json());
+	if (!equal(parsed, value))
+		fail();
+	return parsed;
+}
+
+void TestApp::fail(void)
+{
+	throw Exception("Failed Test");
+}
@@ -23,47 +23,29 @@
 **
 **  File Author(s):
 **
-**    Mark Page
+**    Magnus Norddahl
 */
 
+
 #pragma once
 
-#include "tests.h"
+#include <ClanLib/core.h>
+
+using namespace clan;
 
-class App : public clan::Application
+class TestApp
 {
 public:
-	App();
-	bool update() override;
-
+	int main();
 private:
-	void on_input_up(const clan::InputEvent &key);
-	void on_window_close();
-	void initial_pause();
-	void initialise_1();
-	void initialise_2();
-	void write_result();
-	void test();
-	void draw_info(const std::string &text);
-	int64_t run_test();
-	uint64_t get_start_time() const;
-private:
-	bool quit;
-	std::function<void()> cb_main;
-	std::function<void()> cb_test;
-	clan::DisplayWindow window;
-	clan::Canvas canvas;
-	clan::Font font;
-	clan::GameTime game_time;
-	Tests tests;
-	uint64_t num_iterations;
-	uint64_t base_line;
-	int testlist_offset;
-	std::vector<TestInfo> testlist;
-	uint64_t tests_run_length_microseconds;
-	float target_test_run_length_seconds;
-	std::string priority_class;
-	clan::SlotContainer sc;
-
+	void test_parse();
+	void test_escapes();
+	void test_numbers();
+	void test_nesting();
+	void test_in_situ();
+	void test_errors();
 
+	bool equal(const JsonValue &a, const JsonValue &b);
+	JsonValue round_trip(const JsonValue &value);
+	void fail(void);
 };
@@ -56,6 +56,8 @@ int TestApp::main()
 		Console::write_line("Directory: API/Core/Math");
 
 		test_bigint();
+		test_base64();
+		test_half_float();
 		test_angle();
 		test_quaternion_f();
 		test_quaternion_d();
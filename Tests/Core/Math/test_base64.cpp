@@ -0,0 +1,188 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "test.h"
+
+static const char *base64_alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Plain RFC 4648 encoding, as a reference for the vectorized encoder
+static std::string reference_base64_encode(const std::vector<unsigned char> &data)
+{
+	std::string result;
+	for (size_t i = 0; i < data.size(); i += 3)
+	{
+		unsigned int value = data[i] << 16;
+		if (i + 1 < data.size())
+			value |= data[i + 1] << 8;
+		if (i + 2 < data.size())
+			value |= data[i + 2];
+
+		result.push_back(base64_alphabet[(value >> 18) & 63]);
+		result.push_back(base64_alphabet[(value >> 12) & 63]);
+		result.push_back(i + 1 < data.size() ? base64_alphabet[(value >> 6) & 63] : '=');
+		result.push_back(i + 2 < data.size() ? base64_alphabet[value & 63] : '=');
+	}
+	return result;
+}
+
+// Decodes whole blocks of four characters the way the scalar decoder always has: characters outside
+// the alphabet, including '=', count as zero, and only padding at the very end shortens the result.
+static std::vector<unsigned char> reference_base64_decode(const std::string &text)
+{
+	int values[256];
+	for (int i = 0; i < 256; i++)
+		values[i] = 0;
+	for (int i = 0; i < 64; i++)
+		values[(unsigned char)base64_alphabet[i]] = i;
+
+	size_t size = text.length() / 4 * 4;
+	std::vector<unsigned char> result;
+	for (size_t i = 0; i < size; i += 4)
+	{
+		unsigned int value = 0;
+		for (size_t j = 0; j < 4; j++)
+			value = (value << 6) | values[(unsigned char)text[i + j]];
+		result.push_back((value >> 16) & 255);
+		result.push_back((value >> 8) & 255);
+		result.push_back(value & 255);
+	}
+
+	if (size > 0)
+	{
+		if (text[size - 2] == '=')
+			result.resize(result.size() - 2);
+		else if (text[size - 1] == '=')
+			result.resize(result.size() - 1);
+	}
+	return result;
+}
+
+static std::vector<unsigned char> pseudo_random_bytes(size_t size, unsigned int &seed)
+{
+	std::vector<unsigned char> bytes(size);
+	for (auto &byte : bytes)
+	{
+		seed = seed * 1103515245 + 12345;
+		byte = (unsigned char)(seed >> 16);
+	}
+	return bytes;
+}
+
+void TestApp::test_base64()
+{
+	Console::write_line("   Function: Base64Encoder::encode() and Base64Decoder::decode() known answers");
+
+	// RFC 4648 test vectors
+	const char *vectors[][2] = { { "", "" }, { "f", "Zg==" }, { "fo", "Zm8=" }, { "foo", "Zm9v" }, { "foob", "Zm9vYg==" }, { "fooba", "Zm9vYmE=" }, { "foobar", "Zm9vYmFy" } };
+	for (auto &vector : vectors)
+	{
+		if (Base64Encoder::encode(std::string(vector[0])) != vector[1])
+			fail();
+		DataBuffer decoded = Base64Decoder::decode(std::string(vector[1]));
+		if (std::string(decoded.get_data(), decoded.get_size()) != vector[0])
+			fail();
+	}
+
+	Console::write_line("   Function: Base64Encoder::encode() and Base64Decoder::decode() against a scalar reference");
+
+	// Lengths below, at and above the 12 and 24 byte steps of the vector kernels, with every tail length
+	unsigned int seed = 4711;
+	const size_t base_lengths[] = { 0, 48, 96, 384 };
+	for (size_t base : base_lengths)
+	{
+		for (size_t tail = 0; tail < 32; tail++)
+		{
+			std::vector<unsigned char> data = pseudo_random_bytes(base + tail, seed);
+			std::string expected = reference_base64_encode(data);
+
+			if (Base64Encoder::get_encoded_size((int)data.size()) != (int)expected.length())
+				fail();
+
+			// Guard bytes catch writes past the encoded size
+			std::string buffer(expected.length() + 16, '#');
+			if (Base64Encoder::encode(data.data(), (int)data.size(), &buffer[0]) != (int)expected.length())
+				fail();
+			if (buffer.substr(0, expected.length()) != expected || buffer.substr(expected.length()) != std::string(16, '#'))
+				fail();
+
+			// Streaming in uneven pieces must give the same result
+			Base64Encoder encoder;
+			for (size_t pos = 0; pos < data.size(); pos += 7)
+				encoder.feed(data.data() + pos, (int)std::min<size_t>(7, data.size() - pos));
+			encoder.finalize();
+			if (std::string(encoder.get_result().get_data(), encoder.get_result().get_size()) != expected)
+				fail();
+
+			std::vector<unsigned char> decoded(Base64Decoder::get_decoded_size((int)expected.length()) + 16, 0xcd);
+			int decoded_size = Base64Decoder::decode(expected.data(), (int)expected.length(), decoded.data());
+			if (decoded_size != (int)data.size() || !std::equal(data.begin(), data.end(), decoded.begin()))
+				fail();
+			for (size_t i = decoded.size() - 16; i < decoded.size(); i++)
+			{
+				if (decoded[i] != 0xcd)
+					fail();
+			}
+
+			Base64Decoder decoder;
+			for (size_t pos = 0; pos < expected.length(); pos += 5)
+				decoder.feed(expected.data() + pos, (int)std::min<size_t>(5, expected.length() - pos));
+			if (decoder.get_result().get_size() != data.size() || !std::equal(data.begin(), data.end(), decoder.get_result().get_data<unsigned char>()))
+				fail();
+		}
+	}
+
+	Console::write_line("   Function: Base64Decoder::decode() with invalid input");
+
+	// A character outside the alphabet at every position of a text long enough for the vector kernels
+	std::string text = reference_base64_encode(pseudo_random_bytes(96, seed));
+	const char invalid_chars[] = { '=', '-', '_', ' ', '\n', '*', '\0', (char)0x80, (char)0xff };
+	for (char invalid : invalid_chars)
+	{
+		for (size_t pos = 0; pos < text.length(); pos++)
+		{
+			std::string corrupted = text;
+			corrupted[pos] = invalid;
+
+			std::vector<unsigned char> expected = reference_base64_decode(corrupted);
+			DataBuffer decoded = Base64Decoder::decode(corrupted);
+			if (decoded.get_size() != expected.size() || !std::equal(expected.begin(), expected.end(), decoded.get_data<unsigned char>()))
+				fail();
+		}
+	}
+
+	// Bad padding: too much, in the middle, and text that is not a whole number of blocks
+	const char *bad_padding[] = { "====", "Zg===", "Z===", "=Zm9", "Zm=v", "Zg==Zm9v", "Zm8=Zm9vYmFyZm9vYmFyZm9vYmFyZm9vYmFyZm9vYmFyZm9vYmFy", "Zm9vYmFy=", "Zm9vYmFyZ", "Zm9vYmFyZm", "Zm9vYmFyZm9" };
+	for (const char *padding : bad_padding)
+	{
+		std::vector<unsigned char> expected = reference_base64_decode(padding);
+		DataBuffer decoded = Base64Decoder::decode(std::string(padding));
+		if (decoded.get_size() != expected.size() || !std::equal(expected.begin(), expected.end(), decoded.get_data<unsigned char>()))
+			fail();
+	}
+}
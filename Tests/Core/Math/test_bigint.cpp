@@ -29,6 +29,44 @@
 
 #include "test.h"
 
+// Square and multiply using plain multiplication and division, as a reference for exptmod
+static BigInt reference_exptmod(BigInt base, BigInt exponent, BigInt modulus)
+{
+	BigInt result((uint32_t)1);
+	result %= modulus;
+	base %= modulus;
+	while (exponent.cmp_z() != 0)
+	{
+		if (exponent.is_odd())
+			result = (result * base) % modulus;
+		base = (base * base) % modulus;
+		exponent.div_2(&exponent);
+	}
+	return result;
+}
+
+static BigInt pseudo_random_bigint(unsigned int num_bytes, unsigned int &seed)
+{
+	std::vector<unsigned char> bytes(num_bytes);
+	for (auto &byte : bytes)
+	{
+		seed = seed * 1103515245 + 12345;
+		byte = (unsigned char)(seed >> 16);
+	}
+	bytes[0] |= 0x80;
+	BigInt value;
+	value.read_unsigned_octets(bytes.data(), num_bytes);
+	return value;
+}
+
+static BigInt mersenne_number(unsigned int exponent)
+{
+	BigInt value((uint32_t)0);
+	for (unsigned int bit = 0; bit < exponent; bit++)
+		value.set_bit(bit, 1);
+	return value;
+}
+
 void TestApp::test_bigint(void)
 {
 	Console::write_line(" Header: bigint.h");
@@ -92,11 +130,11 @@ void TestApp::test_bigint(void)
 		value.get(result);
 		if (result != 1234ULL)
 			fail();
-		value.set(0xffffffffffffffffULL);
+		value.set((uint64_t)0xffffffffffffffffULL);
 		value.get(result);
 		if (result != 0xffffffffffffffffULL)
 			fail();
-		value.set(0x12345678ABCD6543ULL);
+		value.set((uint64_t)0x12345678ABCD6543ULL);
 		value.get(result);
 		if (result != 0x12345678ABCD6543ULL)
 			fail();
@@ -127,21 +165,21 @@ void TestApp::test_bigint(void)
 
 	Console::write_line("   Function: BigInt set(int64_t) and get(int64_t)");
 	{
-		BigInt value(1234LL);
+		BigInt value((int64_t)1234);
 		int64_t result;
 		value.get(result);
 		if (result != 1234LL)
 			fail();
 
-		value.set(-1234LL);
+		value.set((int64_t)-1234);
 		value.get(result);
 		if (result != -1234LL)
 			fail();
-		value.set(0x7fffffffffffffffLL);
+		value.set((int64_t)0x7fffffffffffffffLL);
 		value.get(result);
 		if (result != 0x7fffffffffffffffLL)
 			fail();
-		value.set(-0x7fffffffffffffffLL);
+		value.set((int64_t)-0x7fffffffffffffffLL);
 		value.get(result);
 		if (result != -0x7fffffffffffffffLL)
 			fail();
@@ -330,4 +368,88 @@ void TestApp::test_bigint(void)
 		if (!value.is_even())
 			fail();
 	}
+
+	Console::write_line("   Function: exptmod() ");
+	{
+		BigInt base((uint32_t)4), exponent((uint32_t)13), modulus((uint32_t)497), result;
+		base.exptmod(&exponent, &modulus, &result);
+		uint32_t result32;
+		result.get(result32);
+		if (result32 != 445)
+			fail();
+
+		// Even modulus
+		base.set((uint32_t)3);
+		exponent.set((uint32_t)200);
+		modulus.zero();
+		modulus.set_bit(64, 1);
+		base.exptmod(&exponent, &modulus, &result);
+		uint64_t result64;
+		result.get(result64);
+		if (result64 != 0x5bfaff1eaaf8b0a1ULL)
+			fail();
+
+		// Fermat's little theorem on the Mersenne primes 2^127-1 and 2^521-1
+		for (unsigned int mersenne_exponent : { 127, 521 })
+		{
+			BigInt prime = mersenne_number(mersenne_exponent);
+			BigInt prime_minus_one = prime - 1;
+			base.set((uint32_t)3);
+			base.exptmod(&prime_minus_one, &prime, &result);
+			if (result.cmp_d(1) != 0)
+				fail();
+		}
+
+		// Odd and even moduli against the reference implementation
+		unsigned int seed = 1;
+		for (unsigned int num_bytes : { 1, 2, 8, 64, 256 })
+		{
+			for (int odd = 0; odd < 2; odd++)
+			{
+				modulus = pseudo_random_bigint(num_bytes, seed);
+				if (modulus.is_odd() != (odd != 0))
+					modulus += 1;
+				base = pseudo_random_bigint(num_bytes + 1, seed) % modulus;
+				exponent = pseudo_random_bigint(num_bytes, seed);
+
+				base.exptmod(&exponent, &modulus, &result);
+				BigInt expected = reference_exptmod(base, exponent, modulus);
+				if (result.cmp(&expected) != 0)
+					fail();
+
+				// Zero exponent
+				BigInt zero((uint32_t)0);
+				base.exptmod(&zero, &modulus, &result);
+				if (result.cmp_d(1) != 0)
+					fail();
+
+				// Zero base
+				zero.exptmod(&exponent, &modulus, &result);
+				if (result.cmp_z() != 0)
+					fail();
+			}
+		}
+	}
+
+	Console::write_line("   Function: exptmod() with CRT recombination");
+	{
+		// RSA private key operation done as in RSA_Impl::rsadp_crt (p = 61, q = 53, d = 2753)
+		BigInt p((uint32_t)61), q((uint32_t)53), n((uint32_t)3233);
+		BigInt d((uint32_t)2753), dp((uint32_t)53), dq((uint32_t)49), q_inv((uint32_t)38);
+		BigInt cipher((uint32_t)2790);
+
+		BigInt m1, m2;
+		cipher.exptmod(&dp, &p, &m1);
+		cipher.exptmod(&dq, &q, &m2);
+		BigInt h = (m1 - m2) * q_inv;
+		h.mod(&p, &h);
+		BigInt msg = m2 + h * q;
+		if (msg.cmp_d(65) != 0)
+			fail();
+
+		BigInt direct;
+		cipher.exptmod(&d, &n, &direct);
+		if (direct.cmp(&msg) != 0)
+			fail();
+	}
 }
@@ -0,0 +1,207 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "test.h"
+#include <cmath>
+#include <cstring>
+
+static unsigned int float_bits(float value)
+{
+	unsigned int bits;
+	memcpy(&bits, &value, sizeof(float));
+	return bits;
+}
+
+static float bits_float(unsigned int bits)
+{
+	float value;
+	memcpy(&value, &bits, sizeof(float));
+	return value;
+}
+
+static bool is_half_nan(unsigned short h)
+{
+	return (h & 0x7c00) == 0x7c00 && (h & 0x03ff) != 0;
+}
+
+// Value of a finite half; the infinity bit pattern gives 65536, the next step after the largest half
+static double half_magnitude(unsigned short h)
+{
+	int exponent = (h >> 10) & 0x1f;
+	int mantissa = h & 0x3ff;
+	if (exponent == 0)
+		return std::ldexp((double)mantissa, -24);
+	return std::ldexp((double)(mantissa | 0x400), exponent - 25);
+}
+
+// Round to nearest even by picking the closer of the two halfs around the value
+static unsigned short reference_float_to_half(float value)
+{
+	unsigned int bits = float_bits(value);
+	unsigned short sign = (unsigned short)((bits >> 16) & 0x8000);
+	if ((bits & 0x7fffffff) > 0x7f800000)
+		return sign | 0x7e00;
+
+	double magnitude = std::fabs((double)value);
+	if (magnitude >= 65520.0) // Halfway between the largest half and the next step rounds to even, which is infinity
+		return sign | 0x7c00;
+
+	// Largest half not above the value, by bisection since half magnitudes grow with their bits
+	unsigned short low = 0;
+	unsigned short high = 0x7c00;
+	while (high - low > 1)
+	{
+		unsigned short middle = (low + high) / 2;
+		if (half_magnitude(middle) <= magnitude)
+			low = middle;
+		else
+			high = middle;
+	}
+
+	double distance_low = magnitude - half_magnitude(low);
+	double distance_high = half_magnitude(high) - magnitude;
+	unsigned short result = low;
+	if (distance_high < distance_low || (distance_high == distance_low && (high & 1) == 0))
+		result = high;
+	return sign | result;
+}
+
+static unsigned int next_random(unsigned int &seed)
+{
+	seed = seed * 1664525 + 1013904223;
+	return seed;
+}
+
+void TestApp::test_half_float()
+{
+	Console::write_line("   Function: HalfFloat::half_to_float(const unsigned short *, float *, size_t)");
+
+	// Every half, compared with the single value table lookup
+	std::vector<unsigned short> halfs(65536);
+	for (size_t i = 0; i < halfs.size(); i++)
+		halfs[i] = (unsigned short)i;
+	std::vector<float> floats(halfs.size());
+	HalfFloat::half_to_float(halfs.data(), floats.data(), halfs.size());
+	for (size_t i = 0; i < halfs.size(); i++)
+	{
+		float expected = HalfFloat::half_to_float(halfs[i]);
+		if (is_half_nan(halfs[i]) ? !std::isnan(floats[i]) : float_bits(floats[i]) != float_bits(expected))
+			fail();
+	}
+
+	// Known values, including negative normals that the table used to decode as denormals
+	const unsigned short known_halfs[] = { 0x0000, 0x8000, 0x3c00, 0xbc00, 0x0001, 0x03ff, 0x0400, 0x8400, 0x7bff, 0xfbff, 0x7c00, 0xfc00, 0x3555 };
+	const float known_floats[] = { 0.0f, -0.0f, 1.0f, -1.0f, 5.9604645e-8f, 6.0975552e-5f, 6.1035156e-5f, -6.1035156e-5f, 65504.0f, -65504.0f, INFINITY, -INFINITY, 0.33325195f };
+	for (size_t i = 0; i < sizeof(known_halfs) / sizeof(known_halfs[0]); i++)
+	{
+		float value;
+		HalfFloat::half_to_float(&known_halfs[i], &value, 1);
+		if (float_bits(value) != float_bits(known_floats[i]) || float_bits(HalfFloat::half_to_float(known_halfs[i])) != float_bits(known_floats[i]))
+			fail();
+	}
+
+	Console::write_line("   Function: HalfFloat::float_to_half(const float *, unsigned short *, size_t)");
+
+	// Special values, exact halfs, midpoints between halfs and values just around them
+	std::vector<float> inputs = { 0.0f, -0.0f, 1.0f, -1.0f, 65504.0f, 65519.0f, 65520.0f, 70000.0f, -70000.0f, 1e-8f, 2.9802322e-8f, 2.9802326e-8f, 1e-30f, INFINITY, -INFINITY, NAN };
+	unsigned int seed = 1234;
+	for (int i = 0; i < 2000; i++)
+	{
+		unsigned short h = (unsigned short)(next_random(seed) >> 16);
+		if ((h & 0x7c00) == 0x7c00 || (h & 0x7fff) == 0x7bff)
+			continue;
+		float exact = HalfFloat::half_to_float(h);
+		float midpoint = (float)(((double)exact + (double)HalfFloat::half_to_float((unsigned short)(h + 1))) / 2.0);
+		inputs.push_back(exact);
+		inputs.push_back(midpoint);
+		inputs.push_back(bits_float(float_bits(midpoint) + 1));
+		inputs.push_back(bits_float(float_bits(midpoint) - 1));
+	}
+
+	// Random floats within and around the half range
+	for (int i = 0; i < 20000; i++)
+	{
+		unsigned int bits = next_random(seed);
+		bits = (bits & 0x807fffff) | ((100 + (bits >> 23) % 60) << 23);
+		inputs.push_back(bits_float(bits));
+	}
+
+	std::vector<unsigned short> converted(inputs.size());
+	HalfFloat::float_to_half(inputs.data(), converted.data(), inputs.size());
+	for (size_t i = 0; i < inputs.size(); i++)
+	{
+		unsigned short expected = reference_float_to_half(inputs[i]);
+		if (is_half_nan(expected) ? !is_half_nan(converted[i]) : converted[i] != expected)
+			fail();
+	}
+
+	Console::write_line("   Function: HalfFloat array conversion tail lengths");
+
+	// Every length from 0 to 31 behind a few vector steps, at an unaligned start, with guard values after the end
+	for (size_t base = 0; base <= 64; base += 32)
+	{
+		for (size_t tail = 0; tail < 32; tail++)
+		{
+			size_t count = base + tail;
+			std::vector<float> input(count + 1);
+			for (size_t i = 0; i < input.size(); i++)
+				input[i] = (float)(i * 37 % 101) / 7.0f - 5.0f;
+
+			std::vector<unsigned short> output(count + 9, 0xabcd);
+			HalfFloat::float_to_half(input.data() + 1, output.data() + 1, count);
+			if (output[0] != 0xabcd)
+				fail();
+			for (size_t i = 0; i < count; i++)
+			{
+				if (output[i + 1] != reference_float_to_half(input[i + 1]))
+					fail();
+			}
+			for (size_t i = count + 1; i < output.size(); i++)
+			{
+				if (output[i] != 0xabcd)
+					fail();
+			}
+
+			std::vector<float> back(count + 9, 123.0f);
+			HalfFloat::half_to_float(output.data() + 1, back.data() + 1, count);
+			if (back[0] != 123.0f)
+				fail();
+			for (size_t i = 0; i < count; i++)
+			{
+				if (float_bits(back[i + 1]) != float_bits(HalfFloat::half_to_float(output[i + 1])))
+					fail();
+			}
+			for (size_t i = count + 1; i < back.size(); i++)
+			{
+				if (back[i] != 123.0f)
+					fail();
+			}
+		}
+	}
+}
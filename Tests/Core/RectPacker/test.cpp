@@ -1,6 +1,168 @@
 #include <ClanLib/core.h>
 using namespace clan;
 
+void fail()
+{
+	throw Exception("Failed Test");
+}
+
+const char *method_name(RectPacker::PackingMethod method)
+{
+	switch (method)
+	{
+	case RectPacker::binary_tree: return "binary_tree";
+	case RectPacker::max_rects: return "max_rects";
+	case RectPacker::skyline: return "skyline";
+	default: return "unknown";
+	}
+}
+
+Rect reserved_rect(const Rect &rect, const Size &block_size)
+{
+	return Rect(rect.get_top_left(), Size(
+		(rect.get_width() + block_size.width - 1) / block_size.width * block_size.width,
+		(rect.get_height() + block_size.height - 1) / block_size.height * block_size.height));
+}
+
+void check_allocations(const RectPacker &packer, const std::vector<Size> &sizes, const std::vector<RectPacker::AllocatedRect> &allocations)
+{
+	Size group_size = packer.get_max_group_size();
+	Size block_size = packer.get_block_size();
+
+	if (allocations.size() != sizes.size() || packer.get_total_rect_count() != (int)sizes.size())
+		fail();
+
+	for (size_t i = 0; i < allocations.size(); i++)
+	{
+		const RectPacker::AllocatedRect &a = allocations[i];
+		if (a.rect.get_size() != sizes[i])
+			fail();
+		if (a.group_index < 0 || a.group_index >= packer.get_group_count())
+			fail();
+		if (a.rect.left % block_size.width != 0 || a.rect.top % block_size.height != 0)
+			fail();
+
+		Rect reserved = reserved_rect(a.rect, block_size);
+		if (reserved.left < 0 || reserved.top < 0 || reserved.right > group_size.width || reserved.bottom > group_size.height)
+			fail();
+
+		for (size_t j = 0; j < i; j++)
+		{
+			if (allocations[j].group_index == a.group_index && reserved_rect(allocations[j].rect, block_size).is_overlapped(reserved))
+				fail();
+		}
+	}
+
+	int count = 0;
+	for (int group = 0; group < packer.get_group_count(); group++)
+		count += packer.get_rect_count(group);
+	if (count != (int)sizes.size())
+		fail();
+}
+
+std::vector<Size> random_sizes(int count, int max_size, unsigned int seed)
+{
+	std::vector<Size> sizes;
+	for (int i = 0; i < count; i++)
+	{
+		seed = seed * 1664525 + 1013904223;
+		int width = 1 + (seed >> 8) % max_size;
+		seed = seed * 1664525 + 1013904223;
+		int height = 1 + (seed >> 8) % max_size;
+		sizes.push_back(Size(width, height));
+	}
+	return sizes;
+}
+
+void test_packing_method(RectPacker::PackingMethod method)
+{
+	std::cout << "Testing " << method_name(method) << ":" << std::endl;
+
+	// One rect at a time and as a batch, into several groups
+	std::vector<Size> sizes = random_sizes(400, 60, 1234);
+	{
+		RectPacker packer(Size(256, 256), RectPacker::create_new_group, method);
+		std::vector<RectPacker::AllocatedRect> allocations;
+		for (auto &size : sizes)
+			allocations.push_back(packer.add(size));
+		check_allocations(packer, sizes, allocations);
+		if (packer.get_group_count() < 2)
+			fail();
+	}
+	{
+		RectPacker packer(Size(256, 256), RectPacker::create_new_group, method);
+		check_allocations(packer, sizes, packer.add_batch(sizes));
+	}
+
+	// Block alignment with sizes that are not block multiples
+	{
+		RectPacker packer(Size(130, 130), RectPacker::create_new_group, method);
+		packer.set_block_size(Size(4, 4));
+		std::vector<Size> odd_sizes = random_sizes(200, 21, 99);
+		check_allocations(packer, odd_sizes, packer.add_batch(odd_sizes));
+	}
+
+	// A full group falls back to a new one
+	{
+		RectPacker packer(Size(100, 100), RectPacker::create_new_group, method);
+		for (int i = 0; i < 4; i++)
+		{
+			if (packer.add(Size(50, 50)).group_index != 0)
+				fail();
+		}
+		RectPacker::AllocatedRect overflow = packer.add(Size(50, 50));
+		if (overflow.group_index != 1 || overflow.rect != Rect(0, 0, 50, 50) || packer.get_group_count() != 2)
+			fail();
+	}
+
+	// search_previous_groups places rects in the earlier group with room and reports that group
+	{
+		RectPacker packer(Size(100, 100), RectPacker::search_previous_groups, method);
+		if (packer.add(Size(60, 60)).group_index != 0)
+			fail();
+		if (packer.add(Size(100, 100)).group_index != 1)
+			fail();
+		if (packer.add(Size(30, 30)).group_index != 0)
+			fail();
+		if (packer.get_rect_count(0) != 2 || packer.get_rect_count(1) != 1)
+			fail();
+	}
+
+	// fail_if_full and oversized rects throw
+	{
+		RectPacker packer(Size(100, 100), RectPacker::fail_if_full, method);
+		for (int i = 0; i < 4; i++)
+			packer.add(Size(50, 50));
+
+		bool thrown = false;
+		try
+		{
+			packer.add(Size(1, 1));
+		}
+		catch (Exception &)
+		{
+			thrown = true;
+		}
+		if (!thrown || packer.get_total_rect_count() != 4)
+			fail();
+
+		thrown = false;
+		try
+		{
+			RectPacker other(Size(100, 100), RectPacker::create_new_group, method);
+			other.add(Size(101, 10));
+		}
+		catch (Exception &)
+		{
+			thrown = true;
+		}
+		if (!thrown)
+			fail();
+	}
+
+	std::cout << "Expected: Allocation OK" << std::endl;
+}
+
 int main(int argc, char** argv)
 {
 	try
@@ -95,6 +257,18 @@ int main(int argc, char** argv)
 	{
 		std::cout << "Expected: " << e.message.c_str() << std::endl;		
 	}
+
+	try
+	{
+		test_packing_method(RectPacker::binary_tree);
+		test_packing_method(RectPacker::max_rects);
+		test_packing_method(RectPacker::skyline);
+	}
+	catch (Exception &e)
+	{
+		std::cout << "Did not expect: " << e.message.c_str() << std::endl;
+		return 1;
+	}
 	return 0;
 }
 
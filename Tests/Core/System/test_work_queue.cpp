@@ -0,0 +1,142 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+**    (if your name is missing here, please add it)
+*/
+
+
+#include "test.h"
+#include <atomic>
+
+namespace
+{
+	class MoveOnlyFunctor
+	{
+	public:
+		MoveOnlyFunctor(std::atomic_int &counter) : value(new int(42)), counter(counter) { }
+		MoveOnlyFunctor(MoveOnlyFunctor &&other) : value(std::move(other.value)), counter(other.counter) { }
+		void operator()() { if (value && *value == 42) counter++; }
+
+	private:
+		std::unique_ptr<int> value;
+		std::atomic_int &counter;
+	};
+}
+
+void TestApp::test_work_queue()
+{
+	Console::write_line(" Header: work_queue.h");
+	Console::write_line("  Class: WorkQueue");
+
+	for (int work_stealing = 0; work_stealing < 2; work_stealing++)
+	{
+		Console::write_line(work_stealing ? "   Function: queue(WorkGroup) (work stealing)" : "   Function: queue(WorkGroup)");
+		WorkQueue queue(false, work_stealing != 0);
+		std::atomic_int counter(0);
+		WorkGroup outer;
+		for (int i = 0; i < 100; i++)
+		{
+			queue.queue(outer, [&]()
+			{
+				WorkGroup inner;
+				for (int j = 0; j < 10; j++)
+					queue.queue(inner, [&]() { counter++; });
+				queue.wait(inner);
+				if (!inner.is_done()) fail();
+			});
+		}
+		queue.wait(outer);
+		if (counter != 1000) fail();
+
+		queue.process_work_completed();
+		if (queue.get_items_queued() != 0) fail();
+	}
+
+	Console::write_line("   Function: queue(WorkFunction) (move-only functor)");
+	{
+		WorkQueue queue;
+		std::atomic_int counter(0);
+		WorkGroup group;
+		for (int i = 0; i < 100; i++)
+			queue.queue(group, MoveOnlyFunctor(counter));
+		queue.wait(group);
+		if (counter != 100) fail();
+	}
+
+	Console::write_line("   Function: parallel_for()");
+	{
+		WorkQueue queue(false, true);
+		std::vector<int> values(10000, 0);
+		queue.parallel_for(0, (int)values.size(), 0, [&](int first, int last)
+		{
+			for (int i = first; i < last; i++)
+				values[i] += i;
+		});
+		for (int i = 0; i < (int)values.size(); i++)
+			if (values[i] != i) fail();
+	}
+
+	Console::write_line("   Function: parallel_reduce()");
+	{
+		WorkQueue queue;
+		long long sum = queue.parallel_reduce(0, 10000, 100, 0LL,
+			[](int first, int last) { long long s = 0; for (int i = first; i < last; i++) s += i; return s; },
+			[](long long a, long long b) { return a + b; });
+		if (sum != 49995000LL) fail();
+	}
+
+	Console::write_line(" Header: task_graph.h");
+	Console::write_line("  Class: TaskGraph");
+
+	Console::write_line("   Function: run() and then()");
+	{
+		WorkQueue queue(false, true);
+		TaskGraph graph(queue);
+
+		std::atomic_int stage(0);
+		Task first = graph.run([&]() { if (stage++ != 0) fail(); });
+		Task second = first.then([&]() { if (stage++ != 1) fail(); });
+		graph.wait(second);
+		if (!first.is_done() || stage != 2) fail();
+	}
+
+	Console::write_line("   Function: when_all() and then_main()");
+	{
+		WorkQueue queue;
+		TaskGraph graph(queue);
+
+		std::atomic_int counter(0);
+		std::vector<Task> tasks;
+		for (int i = 0; i < 16; i++)
+			tasks.push_back(graph.run([&]() { counter++; }));
+
+		bool main_done = false;
+		Task final_task = graph.when_all(tasks).then_main([&]() { if (counter != 16) fail(); main_done = true; });
+		while (!final_task.is_done())
+			queue.process_work_completed();
+		if (!main_done) fail();
+	}
+}
@@ -24,24 +24,22 @@
 **  File Author(s):
 **
 **    Magnus Norddahl
-**    Mark Page
 */
 
+
 #pragma once
 
-class Utils
+#include <ClanLib/core.h>
+
+using namespace clan;
+
+class TestApp
 {
 public:
-	Utils();
-
-	void test_empty();
-	int test_return_int();
-	std::string test_return_string();
-	std::string &test_return_string2();
-	std::string test_return_string3();
-	void test_get_string(std::string &out_string);
-	int test_string_v8(const std::string &s);
+	int main();
+private:
+	void test_utf8_reader();
+	void test_string_help();
 
-	std::string string_hello_world;
-	int five;
+	void fail(void);
 };
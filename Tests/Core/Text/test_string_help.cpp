@@ -0,0 +1,91 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "test.h"
+
+static char reference_to_upper(char c)
+{
+	return (c >= 'a' && c <= 'z') ? (char)(c - 'a' + 'A') : c;
+}
+
+static char reference_to_lower(char c)
+{
+	return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+}
+
+void TestApp::test_string_help()
+{
+	Console::write_line(" Header: string_help.h");
+	Console::write_line("  Class: StringHelp");
+
+	Console::write_line("   Function: ascii_to_upper() and ascii_to_lower()");
+
+	// All byte values, so the letter range edges and bytes above 0x7f are covered
+	std::string all_bytes;
+	for (int i = 0; i < 256; i++)
+		all_bytes.push_back((char)i);
+
+	// Every length from 0 to 31 after zero, one or two vector blocks, at an unaligned start with guard bytes on both sides
+	for (size_t base = 0; base <= 64; base += 32)
+	{
+		for (size_t tail = 0; tail < 32; tail++)
+		{
+			size_t length = base + tail;
+			for (size_t start = 0; start < all_bytes.length(); start += 7)
+			{
+				std::string text;
+				for (size_t i = 0; i < length; i++)
+					text.push_back(all_bytes[(start + i * 13) % all_bytes.length()]);
+
+				std::string upper = "#" + text + "########";
+				StringHelp::ascii_to_upper(&upper[1], length);
+				std::string lower = "#" + text + "########";
+				StringHelp::ascii_to_lower(&lower[1], length);
+
+				for (size_t i = 0; i < upper.length(); i++)
+				{
+					bool inside = i >= 1 && i <= length;
+					if (upper[i] != (inside ? reference_to_upper(text[i - 1]) : '#'))
+						fail();
+					if (lower[i] != (inside ? reference_to_lower(text[i - 1]) : '#'))
+						fail();
+				}
+			}
+		}
+	}
+
+	// UTF-8 text keeps its non-ASCII characters
+	std::string text = "\xc3\xa5ngstr\xc3\xb6m \xe2\x82\xac Abc";
+	StringHelp::ascii_to_upper(&text[0], text.length());
+	if (text != "\xc3\xa5NGSTR\xc3\xb6M \xe2\x82\xac ABC")
+		fail();
+	StringHelp::ascii_to_lower(&text[0], text.length());
+	if (text != "\xc3\xa5ngstr\xc3\xb6m \xe2\x82\xac abc")
+		fail();
+}
@@ -0,0 +1,227 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "test.h"
+
+// Well-formed UTF-8 as listed in table 3-7 of the Unicode standard, checked one byte at a time
+static bool reference_is_valid(const unsigned char *text, size_t length)
+{
+	size_t pos = 0;
+	while (pos < length)
+	{
+		unsigned char lead = text[pos];
+		size_t trail_count;
+		unsigned char second_min = 0x80, second_max = 0xbf;
+		if (lead < 0x80)
+			trail_count = 0;
+		else if (lead >= 0xc2 && lead <= 0xdf)
+			trail_count = 1;
+		else if (lead >= 0xe0 && lead <= 0xef)
+		{
+			trail_count = 2;
+			if (lead == 0xe0)
+				second_min = 0xa0;
+			else if (lead == 0xed)
+				second_max = 0x9f;
+		}
+		else if (lead >= 0xf0 && lead <= 0xf4)
+		{
+			trail_count = 3;
+			if (lead == 0xf0)
+				second_min = 0x90;
+			else if (lead == 0xf4)
+				second_max = 0x8f;
+		}
+		else
+			return false;
+
+		if (length - pos - 1 < trail_count)
+			return false;
+		for (size_t i = 1; i <= trail_count; i++)
+		{
+			unsigned char c = text[pos + i];
+			unsigned char min = (i == 1) ? second_min : 0x80;
+			unsigned char max = (i == 1) ? second_max : 0xbf;
+			if (c < min || c > max)
+				return false;
+		}
+		pos += trail_count + 1;
+	}
+	return true;
+}
+
+static size_t reference_ascii_length(const unsigned char *text, size_t length)
+{
+	size_t pos = 0;
+	while (pos < length && text[pos] < 0x80)
+		pos++;
+	return pos;
+}
+
+static std::vector<char32_t> reference_decode(const char *text, size_t length)
+{
+	std::vector<char32_t> output;
+	UTF8_Reader reader(text, length);
+	while (!reader.is_end())
+	{
+		output.push_back(reader.get_char());
+		reader.next();
+	}
+	return output;
+}
+
+// Text of the given length, either plain ASCII or a mix of one to four byte characters padded with ASCII
+static std::string make_text(size_t length, bool multibyte)
+{
+	static const char *characters[] = { "a", "\xc3\xa5", "Z", "\xe2\x82\xac", "\xf0\x9f\x98\x80", "\xdf\xbf", "\xef\xbf\xbf", "\xf4\x8f\xbf\xbf", "0" };
+	std::string text;
+	for (size_t i = 0; text.length() < length; i++)
+	{
+		std::string c = multibyte ? characters[i % (sizeof(characters) / sizeof(characters[0]))] : std::string(1, (char)('a' + i % 26));
+		if (text.length() + c.length() > length)
+			c = "x";
+		text += c;
+	}
+	return text;
+}
+
+static void check_text(const std::string &text, bool expected_valid)
+{
+	const unsigned char *data = reinterpret_cast<const unsigned char *>(text.data());
+	bool valid = UTF8_Reader::is_valid(text.data(), text.length());
+	if (valid != reference_is_valid(data, text.length()) || valid != expected_valid)
+		throw Exception("Failed Test");
+
+	if (UTF8_Reader::ascii_length(text.data(), text.length()) != reference_ascii_length(data, text.length()))
+		throw Exception("Failed Test");
+
+	std::vector<char32_t> expected = reference_decode(text.data(), text.length());
+	std::vector<char32_t> output(text.length() + 4, 0xdeadbeef);
+	if (UTF8_Reader::decode(text.data(), text.length(), output.data()) != expected.size())
+		throw Exception("Failed Test");
+	for (size_t i = 0; i < output.size(); i++)
+	{
+		char32_t c = (i < expected.size()) ? expected[i] : 0xdeadbeef;
+		if (output[i] != c)
+			throw Exception("Failed Test");
+	}
+}
+
+void TestApp::test_utf8_reader()
+{
+	Console::write_line(" Header: utf8_reader.h");
+	Console::write_line("  Class: UTF8_Reader");
+
+	Console::write_line("   Function: is_valid() known answers");
+
+	struct KnownAnswer
+	{
+		const char *text;
+		bool valid;
+	};
+	static const KnownAnswer known_answers[] =
+	{
+		{ "", true },
+		{ "hello", true },
+		{ "\x7f", true },
+		{ "\xc2\x80", true },
+		{ "\xdf\xbf", true },
+		{ "\xe0\xa0\x80", true },
+		{ "\xed\x9f\xbf", true },
+		{ "\xee\x80\x80", true },
+		{ "\xef\xbf\xbf", true },
+		{ "\xf0\x90\x80\x80", true },
+		{ "\xf4\x8f\xbf\xbf", true },
+		{ "\xc0\x80", false },
+		{ "\xc1\xbf", false },
+		{ "\xe0\x80\x80", false },
+		{ "\xe0\x9f\xbf", false },
+		{ "\xf0\x80\x80\x80", false },
+		{ "\xf0\x8f\xbf\xbf", false },
+		{ "\xed\xa0\x80", false },
+		{ "\xed\xbf\xbf", false },
+		{ "\xf4\x90\x80\x80", false },
+		{ "\xf5\x80\x80\x80", false },
+		{ "\xff", false },
+		{ "\x80", false },
+		{ "\xbf", false },
+		{ "\xc3", false },
+		{ "\xe2\x82", false },
+		{ "\xf0\x9f\x98", false },
+		{ "\xc3\x28", false },
+		{ "\xe2\x28\xa1", false }
+	};
+	for (const auto &answer : known_answers)
+	{
+		std::string text = answer.text;
+		if (UTF8_Reader::is_valid(text.data(), text.length()) != answer.valid || reference_is_valid(reinterpret_cast<const unsigned char *>(text.data()), text.length()) != answer.valid)
+			fail();
+	}
+
+	Console::write_line("   Function: is_valid(), ascii_length() and decode() against scalar references");
+
+	// Every length from 0 to 31 after zero, one or two vector blocks, valid as it is
+	for (size_t base = 0; base <= 64; base += 32)
+	{
+		for (size_t tail = 0; tail < 32; tail++)
+		{
+			check_text(make_text(base + tail, false), true);
+			check_text(make_text(base + tail, true), true);
+		}
+	}
+
+	// Invalid sequences placed at every offset of ASCII text, and at every offset of mixed text where the reference decides
+	static const char *invalid_sequences[] =
+	{
+		"\xc0\x80", "\xc1\xbf", "\xe0\x80\x80", "\xf0\x80\x80\x80",
+		"\xed\xa0\x80", "\xed\xbf\xbf", "\xf4\x90\x80\x80",
+		"\xf5", "\xf8\x88\x80\x80\x80", "\xfe", "\xff",
+		"\x80", "\xbf", "\xc3", "\xe2\x82", "\xf0\x9f\x98"
+	};
+	for (size_t base = 0; base <= 64; base += 32)
+	{
+		for (size_t tail = 0; tail < 32; tail++)
+		{
+			size_t length = base + tail;
+			for (const char *sequence : invalid_sequences)
+			{
+				std::string invalid = sequence;
+				for (size_t offset = 0; offset <= length; offset++)
+				{
+					std::string ascii = make_text(length, false);
+					check_text(ascii.substr(0, offset) + invalid + ascii.substr(offset), false);
+
+					std::string mixed = make_text(length, true);
+					mixed.replace(offset, std::min(invalid.length(), length - offset), invalid);
+					check_text(mixed, reference_is_valid(reinterpret_cast<const unsigned char *>(mixed.data()), mixed.length()));
+				}
+			}
+		}
+	}
+}
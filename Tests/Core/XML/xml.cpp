@@ -1,5 +1,6 @@
 
 #include <ClanLib/core.h>
+#include <ClanLib/xml.h>
 using namespace clan;
 
 void TestXMLFile(const std::string &filename)
@@ -25,6 +26,220 @@ void TestXMLFile(const std::string &filename)
 	Console::write_line("");
 }
 
+void fail()
+{
+	throw Exception("Failed Test");
+}
+
+std::vector<XMLToken> read_tokens(XMLTokenizer &tokenizer)
+{
+	std::vector<XMLToken> tokens;
+	XMLToken token;
+	while (true)
+	{
+		// Reuse one token, as XMLReader does, so stale attributes would show up in the copies
+		tokenizer.next(&token);
+		if (token.type == XMLToken::NULL_TOKEN)
+			break;
+		tokens.push_back(token);
+	}
+	return tokens;
+}
+
+std::vector<XMLToken> read_tokens(const std::string &xml)
+{
+	XMLTokenizer tokenizer(xml.data(), xml.size());
+	tokenizer.set_eat_whitespace(true);
+	return read_tokens(tokenizer);
+}
+
+void TestTokenizerEntities()
+{
+	Console::write_line("   Function: XMLTokenizer entities");
+
+	std::vector<XMLToken> tokens = read_tokens("<a v=\"1 &amp; 2 &lt;3&gt; &quot;q&quot; &apos;s&apos;\">x &amp;lt; y &nbsp; &amp z</a>");
+	if (tokens.size() != 3)
+		fail();
+	if (tokens[0].type != XMLToken::ELEMENT_TOKEN || tokens[0].variant != XMLToken::BEGIN || tokens[0].name != "a")
+		fail();
+	if (tokens[0].attributes.size() != 1 || tokens[0].attributes[0].first != "v" || tokens[0].attributes[0].second != "1 & 2 <3> \"q\" 's'")
+		fail();
+
+	// Entities are replaced once, unknown and unterminated ones are kept as they are
+	if (tokens[1].type != XMLToken::TEXT_TOKEN || tokens[1].value != "x &lt; y &nbsp; &amp z")
+		fail();
+	if (tokens[2].type != XMLToken::ELEMENT_TOKEN || tokens[2].variant != XMLToken::END || tokens[2].name != "a")
+		fail();
+
+	// Text without entities and with an entity at either end
+	tokens = read_tokens("<a>plain</a><b>&amp;</b><c>&lt;mid&gt;</c>");
+	if (tokens.size() != 9 || tokens[1].value != "plain" || tokens[4].value != "&" || tokens[7].value != "<mid>")
+		fail();
+}
+
+void TestTokenizerCData()
+{
+	Console::write_line("   Function: XMLTokenizer CDATA sections");
+
+	std::vector<XMLToken> tokens = read_tokens("<a><![CDATA[<raw> &amp; ]] ]]></a>");
+	if (tokens.size() != 3)
+		fail();
+	if (tokens[1].type != XMLToken::CDATA_SECTION_TOKEN || tokens[1].value != "<raw> &amp; ]] ")
+		fail();
+
+	tokens = read_tokens("<a>before<![CDATA[]]>after</a>");
+	if (tokens.size() != 5)
+		fail();
+	if (tokens[1].type != XMLToken::TEXT_TOKEN || tokens[1].value != "before")
+		fail();
+	if (tokens[2].type != XMLToken::CDATA_SECTION_TOKEN || !tokens[2].value.empty())
+		fail();
+	if (tokens[3].type != XMLToken::TEXT_TOKEN || tokens[3].value != "after")
+		fail();
+}
+
+void TestTokenizerNamespaces()
+{
+	Console::write_line("   Function: XMLTokenizer namespaces");
+
+	std::string xml =
+		"<?xml version=\"1.0\"?>\n"
+		"<!-- comment -->\n"
+		"<com:root xmlns:com=\"urn:test\" xmlns=\"urn:default\">\n"
+		"  <com:item com:id='1'/>\n"
+		"  <item id='2'></item>\n"
+		"</com:root>\n";
+
+	std::vector<XMLToken> tokens = read_tokens(xml);
+	if (tokens.size() != 7)
+		fail();
+	if (tokens[0].type != XMLToken::PROCESSING_INSTRUCTION_TOKEN || tokens[0].name != "xml")
+		fail();
+	if (tokens[1].type != XMLToken::COMMENT_TOKEN || tokens[1].value != "comment")
+		fail();
+
+	// The tokenizer keeps qualified names as written
+	if (tokens[2].name != "com:root" || tokens[2].attributes.size() != 2 || tokens[2].attributes[0].first != "xmlns:com" || tokens[2].attributes[1].second != "urn:default")
+		fail();
+	if (tokens[3].name != "com:item" || tokens[3].variant != XMLToken::SINGLE || tokens[3].attributes.size() != 1 || tokens[3].attributes[0].first != "com:id")
+		fail();
+	if (tokens[4].name != "item" || tokens[4].variant != XMLToken::BEGIN || tokens[4].attributes.size() != 1 || tokens[4].attributes[0].second != "2")
+		fail();
+	if (tokens[5].name != "item" || tokens[5].variant != XMLToken::END || !tokens[5].attributes.empty())
+		fail();
+	if (tokens[6].name != "com:root" || tokens[6].variant != XMLToken::END)
+		fail();
+
+	// The DOM resolves them
+	DataBuffer buffer(xml.data(), xml.size());
+	MemoryDevice device(buffer);
+	DomDocument document;
+	document.load(device);
+
+	DomElement root = document.get_document_element();
+	if (root.get_namespace_uri() != "urn:test" || root.get_local_name() != "root" || root.get_prefix() != "com")
+		fail();
+	DomElement item = root.get_first_child_element();
+	if (item.get_namespace_uri() != "urn:test" || item.get_attribute_ns("urn:test", "id") != "1")
+		fail();
+	DomElement default_item = item.get_next_sibling_element();
+	if (default_item.get_namespace_uri() != "urn:default" || default_item.get_local_name() != "item")
+		fail();
+}
+
+void TestTokenizerSources()
+{
+	Console::write_line("   Function: XMLTokenizer input sources");
+
+	std::string xml = "<root a=\"1\"><child>text &amp; more</child><empty/></root>";
+	std::vector<XMLToken> expected = read_tokens(xml);
+
+	DataBuffer buffer(xml.data(), xml.size());
+	XMLTokenizer buffer_tokenizer(buffer);
+	buffer_tokenizer.set_eat_whitespace(true);
+
+	DataBuffer device_buffer(xml.data(), xml.size());
+	MemoryDevice device(device_buffer);
+	XMLTokenizer device_tokenizer(device);
+	device_tokenizer.set_eat_whitespace(true);
+
+	std::vector<XMLToken> sources[] = { read_tokens(buffer_tokenizer), read_tokens(device_tokenizer) };
+	for (auto &tokens : sources)
+	{
+		if (tokens.size() != expected.size())
+			fail();
+		for (size_t i = 0; i < tokens.size(); i++)
+		{
+			if (tokens[i].type != expected[i].type || tokens[i].variant != expected[i].variant || tokens[i].attributes != expected[i].attributes)
+				fail();
+			if (tokens[i].type == XMLToken::ELEMENT_TOKEN && tokens[i].name != expected[i].name)
+				fail();
+			if (tokens[i].type == XMLToken::TEXT_TOKEN && tokens[i].value != expected[i].value)
+				fail();
+		}
+	}
+}
+
+void TestReaderAndWriter()
+{
+	Console::write_line("   Function: XMLReader and XMLWriter");
+
+	// Write a document with every escaped character in names, attributes and text
+	DataBuffer output_buffer;
+	MemoryDevice output(output_buffer);
+	XMLWriter writer(output);
+	writer.set_insert_whitespace(false);
+
+	XMLToken token;
+	token.type = XMLToken::ELEMENT_TOKEN;
+	token.variant = XMLToken::BEGIN;
+	token.name = "root";
+	token.attributes.push_back(XMLToken::Attribute("v", "<&'\">"));
+	writer.write(token);
+
+	token.type = XMLToken::TEXT_TOKEN;
+	token.variant = XMLToken::SINGLE;
+	token.attributes.clear();
+	token.value = "a < b && c > \"d\"";
+	writer.write(token);
+
+	token.type = XMLToken::ELEMENT_TOKEN;
+	token.variant = XMLToken::SINGLE;
+	token.name = "stop";
+	writer.write(token);
+
+	token.variant = XMLToken::SINGLE;
+	token.name = "never";
+	writer.write(token);
+
+	token.variant = XMLToken::END;
+	token.name = "root";
+	writer.write(token);
+
+	std::string written(output.get_data().get_data(), output.get_data().get_size());
+	if (written.find('<', 1) == std::string::npos || written.find("&amp;&amp;") == std::string::npos)
+		fail();
+
+	DataBuffer input(written.data(), written.size());
+	XMLReader reader(input);
+
+	std::vector<std::string> events;
+	reader.func_begin_element() = [&](const XMLToken &token)
+	{
+		events.push_back("begin " + token.name + (token.attributes.empty() ? std::string() : " " + token.attributes[0].second));
+		if (token.name == "stop")
+			reader.stop();
+	};
+	reader.func_end_element() = [&](const XMLToken &token) { events.push_back("end " + token.name); };
+	reader.func_text() = [&](const XMLToken &token) { events.push_back("text " + token.value); };
+	reader.parse();
+
+	// stop() ends parsing before the end callback of the empty element and everything after it
+	std::vector<std::string> expected = { "begin root <&'\">", "text a < b && c > \"d\"", "begin stop" };
+	if (events != expected)
+		fail();
+}
+
 int main(int, char**)
 {
 
@@ -35,5 +250,21 @@ int main(int, char**)
 	TestXMLFile("test-notepad-unicode.xml");
 	TestXMLFile("test-notepad-ansi.xml");
 
+	try
+	{
+		TestTokenizerEntities();
+		TestTokenizerCData();
+		TestTokenizerNamespaces();
+		TestTokenizerSources();
+		TestReaderAndWriter();
+		Console::write_line("All Tests Complete");
+	}
+	catch(Exception &error)
+	{
+		Console::write_line("Exception caught:");
+		Console::write_line(error.message);
+		return -1;
+	}
+
 	return 0;
 }
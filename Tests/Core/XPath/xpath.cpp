@@ -1,5 +1,6 @@
 
 #include <ClanLib/core.h>
+#include <ClanLib/xml.h>
 using namespace clan;
 
 void evaluate(const std::string &xpath, const DomDocument &document)
@@ -39,6 +40,151 @@ void evaluate(const std::string &xpath, const DomDocument &document)
 	Console::write_line("");
 }
 
+void fail()
+{
+	throw Exception("Failed Test");
+}
+
+XPathObject check_evaluate(const std::string &xpath, const DomDocument &document)
+{
+	// The second evaluation uses the cached tokens of the first and must give the same result
+	XPathObject result = XPathEvaluator().evaluate(xpath, document);
+	XPathObject cached = XPathEvaluator().evaluate(xpath, document);
+	if (result.get_type() != cached.get_type())
+		fail();
+	switch (result.get_type())
+	{
+	case XPathObject::type_node_set:
+		if (result.get_node_set() != cached.get_node_set())
+			fail();
+		break;
+	case XPathObject::type_number:
+		if (result.get_number() != cached.get_number())
+			fail();
+		break;
+	case XPathObject::type_string:
+		if (result.get_string() != cached.get_string())
+			fail();
+		break;
+	case XPathObject::type_boolean:
+		if (result.get_boolean() != cached.get_boolean())
+			fail();
+		break;
+	default:
+		break;
+	}
+	return result;
+}
+
+void check_nodes(const std::string &xpath, const DomDocument &document, const std::vector<std::string> &texts)
+{
+	XPathObject result = check_evaluate(xpath, document);
+	if (result.get_type() != XPathObject::type_node_set)
+		fail();
+	std::vector<DomNode> nodes = result.get_node_set();
+	if (nodes.size() != texts.size())
+		fail();
+	for (std::vector<DomNode>::size_type i = 0; i < nodes.size(); i++)
+	{
+		if (!nodes[i].is_element() || nodes[i].to_element().get_text() != texts[i])
+			fail();
+	}
+}
+
+void check_number(const std::string &xpath, const DomDocument &document, double value)
+{
+	XPathObject result = check_evaluate(xpath, document);
+	if (result.get_type() != XPathObject::type_number || result.get_number() != value)
+		fail();
+}
+
+void check_string(const std::string &xpath, const DomDocument &document, const std::string &value)
+{
+	XPathObject result = check_evaluate(xpath, document);
+	if (result.get_type() != XPathObject::type_string || result.get_string() != value)
+		fail();
+}
+
+void check_boolean(const std::string &xpath, const DomDocument &document, bool value)
+{
+	XPathObject result = check_evaluate(xpath, document);
+	if (result.get_type() != XPathObject::type_boolean || result.get_boolean() != value)
+		fail();
+}
+
+void test_predicates(const DomDocument &document)
+{
+	Console::write_line("   Function: XPathEvaluator predicates");
+
+	check_number("count(/root/child)", document, 8);
+	check_nodes("root/child[2]/childchild", document, { "Test4", "Test5" });
+	check_nodes("root/child[1]/childchild[2]", document, { "Test2" });
+	check_nodes("root/child[@foo]/childchild", document, { "Test4", "Test5", "Test4.1", "Test5.1" });
+	check_nodes("root/child[@foo=\"barism\"]/childchild", document, { "Test4.1", "Test5.1" });
+	check_nodes("root/child[childchild=\"Test6\"]/foobar", document, { "Muh!" });
+	check_nodes("root/child[@age>27]/foobar", document, { "Age over 27" });
+	check_nodes("root/child[@age!=10]/foobar", document, { "Age over 27" });
+	check_nodes("root/child[not(@foo) and not(@age)]/foobar", document, { "Muh!" });
+	check_nodes("root/child[last()]", document, { "child id Test" });
+	check_nodes("root/child[last()-2]/foobar", document, { "Age over 27" });
+	check_number("count(root/child[position() mod 2 = 0])", document, 4);
+	check_nodes("root/*[local-name()='child' and (@age=10 or namespace-uri()='fisk')]/foobar", document, { "Age under 27", "To foobar!!" });
+	check_nodes("root/child[@age=10]/foobar | root/child[@age=77]/foobar", document, { "Age under 27", "Age over 27" });
+	check_number("sum(root/child[@type='numbers']/number)", document, 45);
+	check_boolean("not(root/child[@age=99])", document, true);
+}
+
+void test_axes(const DomDocument &document)
+{
+	Console::write_line("   Function: XPathEvaluator axes");
+
+	check_number("count(//childchild)", document, 13);
+	check_number("count(root//childchild)", document, 13);
+	check_number("count(/root/descendant::foobar)", document, 5);
+	check_number("count(/root/child[1]/descendant-or-self::*)", document, 4);
+	check_number("count(/root/child[1]/childchild[1]/ancestor::*)", document, 2);
+	check_number("count(/root/child[1]/childchild[1]/ancestor-or-self::*)", document, 3);
+	check_nodes("/root/child[1]/childchild[2]/following-sibling::*", document, { "Test3" });
+	check_nodes("/root/child[1]/childchild[3]/preceding-sibling::*[1]", document, { "Test2" });
+	check_number("count(/root/child[1]/childchild[3]/following::childchild)", document, 10);
+	check_number("count(/root/child[2]/preceding::childchild)", document, 3);
+	check_string("string(/root/child[2]/childchild[1]/parent::*/@foo)", document, "bar");
+	check_string("string(/root/child[2]/childchild[1]/../attribute::foo)", document, "bar");
+	check_number("count(/child::root/child::child/child::childchild)", document, 13);
+	check_number("count(root/child::*[local-name()='child'])", document, 10);
+	check_string("local-name(root/com:child)", document, "child");
+	check_string("namespace-uri(root/com:child)", document, "fisk");
+}
+
+void test_functions(const DomDocument &document)
+{
+	Console::write_line("   Function: XPathEvaluator functions");
+
+	check_number("6 mod 4", document, 2);
+	check_string("translate('bare', 'abr', 'AB')", document, "BAe");
+	check_string("substring-before('1999/04/01','/')", document, "1999");
+	check_string("substring-after('1999/04/01','/')", document, "04/01");
+	check_string("substring('12345', 2)", document, "2345");
+	check_string("substring('12345', 2, 3)", document, "234");
+	check_string("normalize-space('\tchild    \tname\n  \t  thingie\n')", document, "child name thingie");
+	check_number("string-length(root/*[local-name()='child'][position()=last()-2]/foobar)", document, 11);
+}
+
+void test_cache(const DomDocument &document)
+{
+	Console::write_line("   Function: XPathEvaluator expression cache");
+
+	// More distinct expressions than the cache holds, then the first ones again
+	for (int pass = 0; pass < 2; pass++)
+	{
+		for (int i = 1; i <= 300; i++)
+			check_number(string_format("count(root/child[%1]/childchild)", i), document, i == 1 ? 3 : (i <= 6 ? 2 : 0));
+	}
+
+	// Expressions differing only in whitespace tokenize to the same result
+	check_number("count( root / child [ 1 ] / childchild )", document, 3);
+}
+
 int main(int, char**)
 {
 	try
@@ -92,6 +238,12 @@ int main(int, char**)
 // 		evaluate("local-name(/root/child[1])", document);
 // 		evaluate("id(/root/child[1]/childchild[1])", document);
 // 		evaluate("//childchild[1]", document);
+
+		test_predicates(document);
+		test_axes(document);
+		test_functions(document);
+		test_cache(document);
+		Console::write_line("All Tests Complete");
 	}
 	catch(Exception &error)
 	{
@@ -41,6 +41,7 @@ int TestApp::main()
 	try
 	{
 		run_test();
+		test_seek();
 		console.display_close_message();
 	}
 	catch(Exception error)
@@ -86,3 +87,82 @@ void TestApp::run_test()
 		Console::write_line("Contents: %1", StringHelp::utf8_to_text(str8));
 	}
 }
+
+void TestApp::test_seek()
+{
+	Console::write_line("");
+	Console::write_line("Seek:");
+
+	std::vector<char> contents(64 * 1024);
+	unsigned int seed = 1;
+	for (size_t i = 0; i < contents.size(); i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		contents[i] = 'a' + ((seed >> 16) % 16);
+	}
+
+	File file("ZipSeek.zip", File::create_always, File::access_write);
+	ZipWriter zip_writer(file);
+	zip_writer.begin_file("stored.txt", false);
+	zip_writer.write_file_data(contents.data(), contents.size());
+	zip_writer.end_file();
+	zip_writer.begin_file("deflated.txt", true);
+	zip_writer.write_file_data(contents.data(), contents.size());
+	zip_writer.end_file();
+	zip_writer.write_toc();
+	file.close();
+
+	ZipArchive archive("ZipSeek.zip");
+	test_seek_entry(archive, "stored.txt", contents);
+	test_seek_entry(archive, "deflated.txt", contents);
+}
+
+void TestApp::test_seek_entry(ZipArchive &archive, const std::string &filename, const std::vector<char> &contents)
+{
+	IODevice device = archive.open_file(filename);
+	const int size = (int)contents.size();
+	char buffer[256];
+
+	struct SeekStep { int offset; IODevice::SeekMode mode; int expected_pos; };
+	const SeekStep steps[] =
+	{
+		{ 1000, IODevice::seek_set, 1000 },
+		{ 5000, IODevice::seek_cur, 6256 },
+		{ 100, IODevice::seek_set, 100 },
+		{ -256, IODevice::seek_end, size - 256 },
+		{ -40000, IODevice::seek_cur, size - 40000 },
+		{ 0, IODevice::seek_set, 0 }
+	};
+
+	for (const auto &step : steps)
+	{
+		if (!device.seek(step.offset, step.mode))
+			throw Exception(string_format("%1: seek to %2 failed", filename, step.expected_pos));
+		if (device.get_position() != step.expected_pos)
+			throw Exception(string_format("%1: position is %2 after seek, expected %3", filename, (int)device.get_position(), step.expected_pos));
+
+		int received = device.read(buffer, sizeof(buffer));
+		if (received != sizeof(buffer) || memcmp(buffer, contents.data() + step.expected_pos, sizeof(buffer)) != 0)
+			throw Exception(string_format("%1: wrong data read at %2", filename, step.expected_pos));
+	}
+
+	int64_t position = device.get_position();
+	if (device.seek(size + 1, IODevice::seek_set) || device.seek(1, IODevice::seek_end) || device.seek(-1, IODevice::seek_set) || device.get_position() != position)
+		throw Exception(string_format("%1: out of range seek was accepted", filename));
+
+	if (!device.seek(0, IODevice::seek_end) || device.get_position() != size || device.read(buffer, sizeof(buffer)) != 0)
+		throw Exception(string_format("%1: seek to the end failed", filename));
+
+	// Peeked data must not survive a backward seek. A new device has no checkpoints, so the stream restarts.
+	device = archive.open_file(filename);
+	if (!device.seek(5000, IODevice::seek_set))
+		throw Exception(string_format("%1: seek to 5000 failed", filename));
+	if (device.peek(buffer, sizeof(buffer)) != sizeof(buffer) || memcmp(buffer, contents.data() + 5000, sizeof(buffer)) != 0)
+		throw Exception(string_format("%1: wrong data peeked at 5000", filename));
+	if (!device.seek(0, IODevice::seek_set))
+		throw Exception(string_format("%1: backward seek after peek failed", filename));
+	if (device.read(buffer, sizeof(buffer)) != sizeof(buffer) || memcmp(buffer, contents.data(), sizeof(buffer)) != 0)
+		throw Exception(string_format("%1: wrong data read after peek and backward seek", filename));
+
+	Console::write_line("%1: ok", filename);
+}
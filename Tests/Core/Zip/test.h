@@ -40,6 +40,8 @@ public:
 
 private:
 	void run_test();
+	void test_seek();
+	void test_seek_entry(ZipArchive &archive, const std::string &filename, const std::vector<char> &contents);
 };
 
 #endif
@@ -0,0 +1,206 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "test.h"
+#include <cmath>
+
+int main(int argc, char** argv)
+{
+	TestApp program;
+	return program.main();
+}
+
+int TestApp::main()
+{
+	// Create a console window for text-output if not available
+	ConsoleWindow console("Console");
+
+	try
+	{
+		Console::write_line("ClanLib Test Suite:");
+		Console::write_line("-------------------");
+#ifdef WIN32
+		Console::write_line("Target: WIN32");
+#else
+		Console::write_line("Target: LINUX");
+#endif
+		Console::write_line("Directory: API/Display/ImageProviders");
+
+		test_round_trip();
+		test_quality_range();
+		test_buffer_reuse();
+
+		Console::write_line("All Tests Complete");
+		console.display_close_message();
+	}
+	catch (Exception &error)
+	{
+		Console::write_line("Exception caught:");
+		Console::write_line(error.message);
+		console.display_close_message();
+		return -1;
+	}
+
+	return 0;
+}
+
+void TestApp::test_round_trip()
+{
+	Console::write_line("   Function: JPEGProvider::save() and JPEGProvider::load()");
+
+	// Whole MCUs, partial MCUs in either direction and images smaller than one MCU
+	const int sizes[][2] = { { 16, 16 }, { 64, 32 }, { 1, 1 }, { 7, 3 }, { 17, 9 }, { 33, 47 }, { 100, 75 }, { 257, 130 } };
+
+	DataBuffer output;
+	for (auto &size : sizes)
+	{
+		PixelBuffer image = create_image(size[0], size[1]);
+		PixelBuffer decoded = round_trip(image, 90, output);
+		if (psnr(image, decoded) < 36.0)
+			fail();
+	}
+
+	// Formats other than rgba8 are converted before encoding
+	PixelBuffer image = create_image(45, 21, tf_rgb8);
+	PixelBuffer decoded = round_trip(image, 90, output);
+	if (psnr(image.to_format(tf_rgba8), decoded) < 36.0)
+		fail();
+}
+
+void TestApp::test_quality_range()
+{
+	Console::write_line("   Function: JPEGProvider::save() quality");
+
+	PixelBuffer image = create_image(123, 77);
+
+	DataBuffer output;
+	PixelBuffer decoded = round_trip(image, 1, output);
+	double psnr_low = psnr(image, decoded);
+	unsigned int size_low = output.get_size();
+
+	decoded = round_trip(image, 50, output);
+	double psnr_medium = psnr(image, decoded);
+	unsigned int size_medium = output.get_size();
+
+	decoded = round_trip(image, 100, output);
+	double psnr_high = psnr(image, decoded);
+	unsigned int size_high = output.get_size();
+
+	if (psnr_low < 18.0 || psnr_medium < 33.0 || psnr_high < 40.0)
+		fail();
+	if (!(psnr_low < psnr_medium && psnr_medium < psnr_high))
+		fail();
+	if (!(size_low < size_medium && size_medium < size_high))
+		fail();
+}
+
+void TestApp::test_buffer_reuse()
+{
+	Console::write_line("   Function: JPEGProvider::save() into a reused DataBuffer");
+
+	PixelBuffer large = create_image(200, 150);
+	PixelBuffer small = create_image(31, 17);
+
+	DataBuffer first;
+	JPEGProvider::save(small, first, 75);
+
+	// Encoding a smaller image into a buffer that held a larger file must replace its contents
+	DataBuffer output;
+	JPEGProvider::save(large, output, 75);
+	JPEGProvider::save(small, output, 75);
+	if (output.get_size() != first.get_size() || memcmp(output.get_data(), first.get_data(), first.get_size()) != 0)
+		fail();
+}
+
+PixelBuffer TestApp::create_image(int width, int height, TextureFormat format)
+{
+	// Smooth waves in pixel units, similar to photographic content at any image size
+	PixelBuffer image(width, height, tf_rgba8);
+	for (int y = 0; y < height; y++)
+	{
+		unsigned char *line = image.get_line_uint8(y);
+		for (int x = 0; x < width; x++)
+		{
+			line[x * 4 + 0] = (unsigned char)(128.0f + 90.0f * std::sin(x * 0.05f + y * 0.02f));
+			line[x * 4 + 1] = (unsigned char)(128.0f + 90.0f * std::cos(x * 0.03f - y * 0.04f));
+			line[x * 4 + 2] = (unsigned char)(128.0f + 90.0f * std::sin((x + y) * 0.025f));
+			line[x * 4 + 3] = 255;
+		}
+	}
+
+	if (format != tf_rgba8)
+		return image.to_format(format);
+	return image;
+}
+
+PixelBuffer TestApp::round_trip(const PixelBuffer &image, int quality, DataBuffer &output)
+{
+	JPEGProvider::save(image, output, quality);
+	if (output.get_size() < 4)
+		fail();
+
+	const unsigned char *data = output.get_data<unsigned char>();
+	if (data[0] != 0xff || data[1] != 0xd8 || data[output.get_size() - 2] != 0xff || data[output.get_size() - 1] != 0xd9)
+		fail();
+
+	DataBuffer copy(output.get_data(), output.get_size());
+	MemoryDevice device(copy);
+	PixelBuffer decoded = JPEGProvider::load(device);
+	if (decoded.get_width() != image.get_width() || decoded.get_height() != image.get_height())
+		fail();
+
+	return decoded.to_format(tf_rgba8);
+}
+
+double TestApp::psnr(const PixelBuffer &a, const PixelBuffer &b)
+{
+	double squared_error = 0.0;
+	for (int y = 0; y < a.get_height(); y++)
+	{
+		const unsigned char *line_a = a.get_line_uint8(y);
+		const unsigned char *line_b = b.get_line_uint8(y);
+		for (int x = 0; x < a.get_width() * 4; x++)
+		{
+			if (x % 4 == 3)
+				continue;
+			double delta = (double)line_a[x] - (double)line_b[x];
+			squared_error += delta * delta;
+		}
+	}
+
+	double mse = squared_error / (a.get_width() * a.get_height() * 3.0);
+	if (mse == 0.0)
+		return 100.0;
+	return 10.0 * std::log10(255.0 * 255.0 / mse);
+}
+
+void TestApp::fail(void)
+{
+	throw Exception("Failed Test");
+}
@@ -0,0 +1,177 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "test.h"
+#include <cmath>
+
+int main(int argc, char** argv)
+{
+	TestApp program;
+	return program.main();
+}
+
+int TestApp::main()
+{
+	// Create a console window for text-output if not available
+	ConsoleWindow console("Console");
+
+	try
+	{
+		Console::write_line("ClanLib Test Suite:");
+		Console::write_line("-------------------");
+#ifdef WIN32
+		Console::write_line("Target: WIN32");
+#else
+		Console::write_line("Target: LINUX");
+#endif
+		Console::write_line("Directory: API/Display/Image");
+
+		test_reference_values();
+
+		Console::write_line("All Tests Complete");
+		console.display_close_message();
+	}
+	catch (Exception &error)
+	{
+		Console::write_line("Exception caught:");
+		Console::write_line(error.message);
+		console.display_close_message();
+		return -1;
+	}
+
+	return 0;
+}
+
+void TestApp::test_reference_values()
+{
+	Console::write_line("   Function: PerlinNoise::create_noise1d/2d/3d/4d()");
+
+	// Values from the scalar implementation that predates the SSE kernel
+	static const float expected_noise1d[] =
+	{
+		-2.25f, 0.763282657f, 0.198494732f, 1.4627986f, -0.179676175f, 0.37762177f, 0.849421382f, 1.85925674f,
+		1.23717499f, 0.517034948f, 0.660944223f, -2.10246754f, -0.768633664f, 0.568809867f, -0.563970327f, 4.08588982f,
+	};
+	static const float expected_noise2d[] =
+	{
+		0.0f, -1.38626552f, -1.04734039f, 0.210296452f, -0.0291938782f, -0.0809429884f, 0.400940895f, 0.426638246f,
+		1.41789746f, -0.943650305f, 1.17863011f, -0.0621514469f, 0.647680998f, -0.0837999433f, -0.0745374635f, -0.208701342f,
+		-0.446758866f, -0.32722491f, -0.738622725f, -0.700562239f, -1.22143388f, -0.122503236f, -0.0127945095f, -0.568237841f,
+		2.19177246f, -1.2109375f, -0.485020816f, 0.689343691f, 0.632122636f, 0.913397789f, 0.330499291f, -1.52137041f,
+		-1.56018662f, 0.622035563f, -0.813930035f, -1.12864721f, 0.822139561f, -0.960236669f, -0.75457561f, 0.572041392f,
+		0.291734457f, -0.614426374f, -0.559274197f, 0.0983615369f, -1.26452684f, 0.195633054f, -0.642608345f, 0.0898103043f,
+	};
+	static const float expected_noise3d[] =
+	{
+		-0.129272461f, 0.680327654f, 0.311158687f, -0.598775983f, -0.120918274f, -0.081671074f, 0.261876881f, 0.01616548f,
+		-0.394530356f, 0.693665266f, -0.606611192f, 0.541136146f, -0.01925046f, 0.122236699f, -0.323876411f, 0.127564371f,
+		0.0692959428f, -0.517884374f, 0.211001366f, -0.12534368f, -0.320996225f, -0.513231277f, 0.00852632523f, 0.0686600208f,
+		0.180868149f, -0.126250654f, 0.244811386f, 0.202098906f, -0.347912788f, 0.399436802f, -0.1360223f, -0.205002189f,
+		-1.22718918f, 0.00427912921f, -0.205617771f, 0.0631325245f, -0.593975663f, -0.212103009f, -0.387114912f, -0.442565382f,
+		-0.0527469814f, -0.0842082798f, -1.19238353f, 0.249268606f, -0.471636355f, -0.419880569f, -0.0388620943f, 0.0948543325f,
+	};
+	static const float expected_noise4d[] =
+	{
+		0.491870582f, -0.0204975158f, 0.0934238732f, 0.681871295f, 0.526968777f, 0.610431552f, 0.127368554f, 0.304499447f,
+		0.140565842f, -0.744666338f, -0.361682713f, 0.442022324f, -0.241790563f, -0.313329011f, -0.249245971f, -0.351464689f,
+		0.778715193f, 0.282331198f, -0.277368039f, 0.188713446f, -0.0149319172f, -0.0683946609f, -0.517773986f, 0.132358387f,
+		0.412349999f, -0.0415143967f, -0.105001509f, 0.794996977f, -0.338574976f, -0.434705049f, 0.265494198f, 0.15217194f,
+		-0.696813822f, 0.340497315f, -0.124383487f, -0.468843192f, -0.180803463f, -0.615811765f, 0.0490886793f, -0.107013673f,
+		0.476624548f, 0.574921191f, 0.719575524f, -0.277369589f, 0.488107026f, 0.321196616f, -0.398830175f, 0.103664152f,
+	};
+	static const unsigned char expected_noise2d_rgb8[] =
+	{
+		128, 128, 128, 68, 68, 68, 83, 83, 83, 136, 136, 136, 126, 126, 126, 124,
+		124, 124, 145, 145, 145, 146, 146, 146, 221, 221, 221, 76, 76, 76, 107, 107,
+		107, 157, 157, 157, 154, 154, 154, 166, 166, 166, 142, 142, 142, 63, 63, 63,
+	};
+
+	// Fixed permutation table, so the result does not depend on rand()
+	unsigned char table[256];
+	for (int i = 0; i < 256; i++)
+		table[i] = i;
+	unsigned int seed = 12345;
+	for (int i = 255; i > 0; i--)
+	{
+		seed = seed * 1664525 + 1013904223;
+		int j = (seed >> 8) % (i + 1);
+		std::swap(table[i], table[j]);
+	}
+
+	PerlinNoise noise;
+	noise.set_permutations(table);
+	noise.set_format(tf_r32f);
+	noise.set_octaves(3);
+	noise.set_amplitude(1.5f);
+
+	noise.set_size(16, 1);
+	check_values(noise.create_noise1d(0.5f, 9.25f), expected_noise1d);
+
+	noise.set_size(8, 6);
+	check_values(noise.create_noise2d(0.5f, 9.25f, 1.0f, 6.5f), expected_noise2d);
+	check_values(noise.create_noise3d(0.5f, 9.25f, 1.0f, 6.5f, 2.75f), expected_noise3d);
+	check_values(noise.create_noise4d(0.5f, 9.25f, 1.0f, 6.5f, 2.75f, 4.125f), expected_noise4d);
+
+	noise.set_format(tf_rgb8);
+	noise.set_amplitude(0.5f);
+	noise.set_size(8, 2);
+	check_values(noise.create_noise2d(0.5f, 9.25f, 1.0f, 6.5f), expected_noise2d_rgb8);
+}
+
+void TestApp::check_values(const PixelBuffer &noise, const float *expected)
+{
+	for (int y = 0; y < noise.get_height(); y++)
+	{
+		const float *line = reinterpret_cast<const float*>(noise.get_line(y));
+		for (int x = 0; x < noise.get_width(); x++)
+		{
+			if (std::fabs(line[x] - expected[y * noise.get_width() + x]) > 1.0e-5f)
+				fail();
+		}
+	}
+}
+
+void TestApp::check_values(const PixelBuffer &noise, const unsigned char *expected)
+{
+	for (int y = 0; y < noise.get_height(); y++)
+	{
+		const unsigned char *line = noise.get_line_uint8(y);
+		for (int x = 0; x < noise.get_width() * 3; x++)
+		{
+			// Allow for rounding of values that were close to a step
+			if (std::abs(line[x] - expected[y * noise.get_width() * 3 + x]) > 1)
+				fail();
+		}
+	}
+}
+
+void TestApp::fail(void)
+{
+	throw Exception("Failed Test");
+}
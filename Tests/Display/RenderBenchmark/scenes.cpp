@@ -0,0 +1,286 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "test.h"
+
+namespace
+{
+	/// \brief Deterministic pseudo random numbers so every run draws the same frames
+	class SceneRandom
+	{
+	public:
+		SceneRandom(unsigned int seed) : state(seed) { }
+
+		float next(float range)
+		{
+			state = state * 1664525u + 1013904223u;
+			return (state >> 8) * (range / 16777216.0f);
+		}
+
+	private:
+		unsigned int state;
+	};
+
+	class SpriteScene : public BenchmarkScene
+	{
+	public:
+		SpriteScene(Canvas &canvas) : sprite(canvas)
+		{
+			// A few generated frames so the sprite also exercises frame switching
+			for (int frame = 0; frame < 4; frame++)
+			{
+				PixelBuffer image(32, 32, tf_rgba8);
+				unsigned char *pixels = image.get_data_uint8();
+				for (int y = 0; y < 32; y++)
+				{
+					for (int x = 0; x < 32; x++)
+					{
+						int dx = x - 16, dy = y - 16;
+						bool inside = dx * dx + dy * dy < 15 * 15;
+						unsigned char *pixel = pixels + (y * 32 + x) * 4;
+						pixel[0] = (unsigned char)(64 * frame + x * 2);
+						pixel[1] = (unsigned char)(y * 8);
+						pixel[2] = (unsigned char)(255 - 64 * frame);
+						pixel[3] = inside ? 255 : 0;
+					}
+				}
+				Texture2D texture(canvas, 32, 32);
+				texture.set_image(canvas, image);
+				sprite.add_frame(texture);
+			}
+		}
+
+		std::string get_name() const override { return "sprites"; }
+		std::string get_unit() const override { return "sprites"; }
+		int get_items_per_frame() const override { return sprite_count; }
+
+		void render(Canvas &canvas, int frame) override
+		{
+			canvas.clear(Colorf(0.1f, 0.1f, 0.15f));
+
+			SceneRandom random(1);
+			float width = canvas.get_width();
+			float height = canvas.get_height();
+			for (int i = 0; i < sprite_count; i++)
+			{
+				float x = random.next(width);
+				float y = random.next(height);
+				sprite.set_frame((i + frame) & 3);
+				if ((i & 7) == 0)
+				{
+					sprite.set_angle(Angle((float)(i + frame), angle_degrees));
+					sprite.set_scale(1.5f, 1.5f);
+				}
+				else
+				{
+					sprite.set_angle(Angle(0.0f, angle_degrees));
+					sprite.set_scale(1.0f, 1.0f);
+				}
+				sprite.draw(canvas, x, y);
+			}
+		}
+
+	private:
+		static const int sprite_count = 10000;
+		Sprite sprite;
+	};
+
+	class TextScene : public BenchmarkScene
+	{
+	public:
+		TextScene(Canvas &canvas) : font("Tahoma", 14.0f)
+		{
+			const std::string words = "The quick brown fox jumps over the lazy dog 0123456789 ";
+			for (int i = 0; i < line_count; i++)
+			{
+				std::string line;
+				while (line.size() < 100)
+					line += words.substr(i % 9);
+				line.resize(100);
+				lines.push_back(line);
+
+				for (char c : line)
+				{
+					if (c != ' ')
+						glyph_count++;
+				}
+			}
+		}
+
+		std::string get_name() const override { return "text"; }
+		std::string get_unit() const override { return "glyphs"; }
+		int get_items_per_frame() const override { return glyph_count; }
+
+		void render(Canvas &canvas, int frame) override
+		{
+			canvas.clear(Colorf::white);
+			for (int i = 0; i < line_count; i++)
+			{
+				Colorf color = ((i + frame) & 1) ? Colorf::black : Colorf::darkblue;
+				font.draw_text(canvas, 4.0f, 14.0f + i * 16.0f, lines[i], color);
+			}
+		}
+
+	private:
+		static const int line_count = 44;
+		Font font;
+		std::vector<std::string> lines;
+		int glyph_count = 0;
+	};
+
+	class PathScene : public BenchmarkScene
+	{
+	public:
+		PathScene(Canvas &canvas)
+		{
+			SceneRandom random(2);
+			float width = canvas.get_width();
+			float height = canvas.get_height();
+			for (int i = 0; i < path_count; i++)
+			{
+				float x = random.next(width);
+				float y = random.next(height);
+				float size = 10.0f + random.next(40.0f);
+				switch (i % 4)
+				{
+				case 0: paths.push_back(Path::circle(x, y, size)); break;
+				case 1: paths.push_back(Path::rect(Rectf(x, y, Sizef(size * 2.0f, size)), Sizef(6.0f, 6.0f))); break;
+				case 2: paths.push_back(create_star(x, y, size)); break;
+				case 3: paths.push_back(create_curve(x, y, size)); break;
+				}
+				brushes.push_back(Brush::solid(random.next(1.0f), random.next(1.0f), random.next(1.0f), 0.5f + random.next(0.5f)));
+			}
+		}
+
+		std::string get_name() const override { return "paths"; }
+		std::string get_unit() const override { return "paths"; }
+		int get_items_per_frame() const override { return path_count; }
+
+		void render(Canvas &canvas, int frame) override
+		{
+			canvas.clear(Colorf::white);
+			for (int i = 0; i < path_count; i++)
+				paths[i].fill(canvas, brushes[(i + frame) % path_count]);
+		}
+
+	private:
+		static Path create_star(float x, float y, float size)
+		{
+			Path path;
+			for (int i = 0; i < 10; i++)
+			{
+				float radius = (i & 1) ? size * 0.4f : size;
+				float angle = i * 3.14159265f / 5.0f;
+				Pointf point(x + std::cos(angle) * radius, y + std::sin(angle) * radius);
+				if (i == 0)
+					path.move_to(point);
+				else
+					path.line_to(point);
+			}
+			path.close();
+			return path;
+		}
+
+		static Path create_curve(float x, float y, float size)
+		{
+			Path path;
+			path.move_to(x, y);
+			path.bezier_to(Pointf(x + size, y - size), Pointf(x + size * 2.0f, y + size), Pointf(x + size * 3.0f, y));
+			path.bezier_to(Pointf(x + size * 1.5f, y + size * 2.0f), Pointf(x, y));
+			path.close();
+			return path;
+		}
+
+		static const int path_count = 400;
+		std::vector<Path> paths;
+		std::vector<Brush> brushes;
+	};
+
+	class ViewScene : public BenchmarkScene
+	{
+	public:
+		ViewScene(Canvas &canvas) : ui_window(canvas)
+		{
+			ui_window.set_viewport(Rectf(0.0f, 0.0f, canvas.get_width(), canvas.get_height()));
+			ui_window.set_always_render(true);
+			ui_window.set_clear_background(true);
+			ui_window.set_background_color(Colorf::white);
+
+			auto root = ui_window.root_view();
+			root->style()->set("flex-direction: row; flex-wrap: wrap; padding: 4px");
+
+			for (int i = 0; i < view_count; i++)
+			{
+				auto panel = std::make_shared<View>();
+				panel->style()->set("width: 56px; height: 40px; margin: 2px; padding: 2px");
+				panel->style()->set("background: %1; border: 1px solid #404040; border-radius: 4px", (i & 1) ? "#e0e8f0" : "#f0e8e0");
+
+				auto label = std::make_shared<LabelView>();
+				label->style()->set("font: 11px/14px 'Tahoma'; color: black");
+				label->set_text(string_format("View %1", i));
+				panel->add_subview(label);
+
+				root->add_subview(panel);
+			}
+		}
+
+		std::string get_name() const override { return "views"; }
+		std::string get_unit() const override { return "views"; }
+		int get_items_per_frame() const override { return view_count * 2; }
+
+		void render(Canvas &canvas, int frame) override
+		{
+			ui_window.update();
+		}
+
+	private:
+		static const int view_count = 300;
+		TextureWindow ui_window;
+	};
+}
+
+std::unique_ptr<BenchmarkScene> create_sprite_scene(Canvas &canvas)
+{
+	return std::unique_ptr<BenchmarkScene>(new SpriteScene(canvas));
+}
+
+std::unique_ptr<BenchmarkScene> create_text_scene(Canvas &canvas)
+{
+	return std::unique_ptr<BenchmarkScene>(new TextScene(canvas));
+}
+
+std::unique_ptr<BenchmarkScene> create_path_scene(Canvas &canvas)
+{
+	return std::unique_ptr<BenchmarkScene>(new PathScene(canvas));
+}
+
+std::unique_ptr<BenchmarkScene> create_view_scene(Canvas &canvas)
+{
+	return std::unique_ptr<BenchmarkScene>(new ViewScene(canvas));
+}
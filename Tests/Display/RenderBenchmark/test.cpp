@@ -0,0 +1,362 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "test.h"
+
+int main(int argc, char **argv)
+{
+	std::vector<std::string> args(argv + 1, argv + argc);
+	TestApp app;
+	return app.main(args);
+}
+
+int TestApp::main(const std::vector<std::string> &args)
+{
+	// Create a console window for text-output if not available
+	ConsoleWindow console("Console");
+
+	try
+	{
+		if (!parse_arguments(args))
+			return 1;
+
+		if (settings.target == "d3d")
+		{
+#ifdef WIN32
+			D3DTarget::set_current();
+#else
+			throw Exception("The D3D target is only available on Windows");
+#endif
+		}
+		else
+		{
+			OpenGLTarget::set_current();
+		}
+
+		create_render_target();
+
+		try
+		{
+			for (int i = 0; i < max_queries_in_flight; i++)
+				timer_queries.push_back(TimerQuery(canvas));
+		}
+		catch (const Exception &e)
+		{
+			Console::write_line("GPU timing unavailable: %1", e.message);
+			timer_queries.clear();
+		}
+
+		UIThread ui_thread;
+
+		std::vector<std::unique_ptr<BenchmarkScene>> scenes;
+		scenes.push_back(create_sprite_scene(canvas));
+		scenes.push_back(create_text_scene(canvas));
+		scenes.push_back(create_path_scene(canvas));
+		scenes.push_back(create_view_scene(canvas));
+
+		Console::write_line("Render benchmark: target %1, %2x%3 %4, %5 frames per scene", settings.target, settings.width, settings.height, settings.onscreen ? "onscreen" : "offscreen", settings.frames);
+
+		std::vector<SceneResult> results;
+		for (auto &scene : scenes)
+		{
+			if (!settings.filter.empty() && scene->get_name().find(settings.filter) == std::string::npos)
+				continue;
+
+			results.push_back(run_scene(*scene));
+			print_result(results.back());
+		}
+
+		bool passed = true;
+		if (!settings.baseline_filename.empty())
+			passed = compare_baseline(results);
+
+		if (!settings.save_baseline_filename.empty())
+			save_baseline(results);
+
+		return passed ? 0 : 2;
+	}
+	catch (const Exception &e)
+	{
+		Console::write_line("Exception caught: %1", e.get_message_and_stack_trace());
+		return -1;
+	}
+}
+
+bool TestApp::parse_arguments(const std::vector<std::string> &args)
+{
+	for (const auto &arg : args)
+	{
+		size_t separator = arg.find('=');
+		std::string name = arg.substr(0, separator);
+		std::string value = separator != std::string::npos ? arg.substr(separator + 1) : std::string();
+
+		if (name == "--target" && (value == "gl3" || value == "d3d"))
+			settings.target = value;
+		else if (name == "--filter")
+			settings.filter = value;
+		else if (name == "--frames")
+			settings.frames = std::max(StringHelp::text_to_int(value), 1);
+		else if (name == "--warmup")
+			settings.warmup_frames = std::max(StringHelp::text_to_int(value), 0);
+		else if (name == "--size" && value.find('x') != std::string::npos)
+		{
+			settings.width = std::max(StringHelp::text_to_int(value.substr(0, value.find('x'))), 1);
+			settings.height = std::max(StringHelp::text_to_int(value.substr(value.find('x') + 1)), 1);
+		}
+		else if (name == "--baseline")
+			settings.baseline_filename = value;
+		else if (name == "--save-baseline")
+			settings.save_baseline_filename = value;
+		else if (name == "--tolerance")
+			settings.tolerance = StringHelp::text_to_int(value) / 100.0;
+		else if (name == "--onscreen")
+			settings.onscreen = true;
+		else
+		{
+			Console::write_line("Usage: renderbenchmark [options]");
+			Console::write_line("  --target=gl3|d3d        Display target (default gl3)");
+			Console::write_line("  --filter=<name>         Only run scenes whose name contains name");
+			Console::write_line("  --frames=<n>            Timed frames per scene (default 300)");
+			Console::write_line("  --warmup=<n>            Untimed frames per scene (default 30)");
+			Console::write_line("  --size=<w>x<h>          Render target size (default 1280x720)");
+			Console::write_line("  --onscreen              Render to the window instead of an offscreen texture");
+			Console::write_line("  --baseline=<file>       Compare against a stored baseline");
+			Console::write_line("  --save-baseline=<file>  Store the results as the baseline for this target");
+			Console::write_line("  --tolerance=<percent>   Allowed slowdown before reporting a regression (default 10)");
+			return false;
+		}
+	}
+	return true;
+}
+
+void TestApp::create_render_target()
+{
+	DisplayWindowDescription desc;
+	desc.set_title("Render Benchmark");
+	desc.set_size(Sizef((float)settings.width, (float)settings.height), true);
+	desc.set_visible(settings.onscreen);
+	window = DisplayWindow(desc);
+	window_canvas = Canvas(window);
+
+	if (settings.onscreen)
+	{
+		canvas = window_canvas;
+	}
+	else
+	{
+		// Rendering into a texture keeps the compositor and vsync out of the measurements
+		target_texture = Texture2D(window_canvas, settings.width, settings.height);
+		FrameBuffer framebuffer(window_canvas);
+		framebuffer.attach_color(0, target_texture);
+		canvas = Canvas(window_canvas, framebuffer);
+	}
+}
+
+SceneResult TestApp::run_scene(BenchmarkScene &scene)
+{
+	for (int frame = 0; frame < settings.warmup_frames; frame++)
+	{
+		scene.render(canvas, frame);
+		canvas.flush();
+		end_frame();
+	}
+
+	// Reading back a pixel waits for the GPU to finish all queued work
+	canvas.get_gc().get_pixeldata(Rect(0, 0, 1, 1));
+
+	std::vector<double> cpu_times;
+	std::vector<double> gpu_times;
+	std::vector<bool> query_pending(timer_queries.size(), false);
+
+	auto collect_query = [&](size_t index)
+	{
+		if (query_pending[index])
+		{
+			uint64_t nanoseconds = timer_queries[index].get_result();
+			if (nanoseconds != 0)
+				gpu_times.push_back(nanoseconds / 1000000.0);
+			query_pending[index] = false;
+		}
+	};
+
+	auto start = std::chrono::steady_clock::now();
+	for (int frame = 0; frame < settings.frames; frame++)
+	{
+		// Reusing a query waits for the frame that used it, which bounds how far the CPU runs ahead of the GPU
+		size_t query_index = frame % max_queries_in_flight;
+		if (!timer_queries.empty())
+		{
+			collect_query(query_index);
+			timer_queries[query_index].begin();
+		}
+
+		auto frame_start = std::chrono::steady_clock::now();
+		scene.render(canvas, settings.warmup_frames + frame);
+		canvas.flush();
+		auto frame_end = std::chrono::steady_clock::now();
+		cpu_times.push_back(std::chrono::duration<double, std::milli>(frame_end - frame_start).count());
+
+		if (!timer_queries.empty())
+		{
+			timer_queries[query_index].end();
+			query_pending[query_index] = true;
+		}
+
+		end_frame();
+	}
+
+	canvas.get_gc().get_pixeldata(Rect(0, 0, 1, 1));
+	double total_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	for (size_t i = 0; i < timer_queries.size(); i++)
+		collect_query(i);
+
+	SceneResult result;
+	result.name = scene.get_name();
+	result.unit = scene.get_unit();
+	result.frames = settings.frames;
+	result.cpu_median_ms = percentile(cpu_times, 0.5);
+	result.cpu_p90_ms = percentile(cpu_times, 0.9);
+	if (!gpu_times.empty())
+	{
+		result.gpu_median_ms = percentile(gpu_times, 0.5);
+		result.gpu_p90_ms = percentile(gpu_times, 0.9);
+	}
+	if (total_seconds > 0.0)
+		result.items_per_second = (double)scene.get_items_per_frame() * settings.frames / total_seconds;
+	return result;
+}
+
+void TestApp::end_frame()
+{
+	if (settings.onscreen)
+		window.flip(0);
+	RunLoop::process();
+}
+
+void TestApp::print_result(const SceneResult &result)
+{
+	std::string line = string_format("%1: %2 %3/s, cpu %4 ms (p90 %5 ms)",
+		result.name,
+		StringHelp::double_to_text(result.items_per_second, 0),
+		result.unit,
+		StringHelp::double_to_text(result.cpu_median_ms, 3),
+		StringHelp::double_to_text(result.cpu_p90_ms, 3));
+
+	if (result.gpu_median_ms >= 0.0)
+		line += string_format(", gpu %1 ms (p90 %2 ms)", StringHelp::double_to_text(result.gpu_median_ms, 3), StringHelp::double_to_text(result.gpu_p90_ms, 3));
+
+	Console::write_line(line);
+}
+
+bool TestApp::compare_baseline(const std::vector<SceneResult> &results)
+{
+	JsonValue baseline = JsonValue::parse(File::read_text(settings.baseline_filename));
+	const JsonValue &target_baseline = baseline.prop(settings.target);
+	if (!target_baseline.is_object())
+	{
+		Console::write_line("No baseline stored for target %1 in %2", settings.target, settings.baseline_filename);
+		return true;
+	}
+
+	Console::write_line("");
+	Console::write_line("Baseline comparison (%1%% tolerance):", (int)(settings.tolerance * 100.0 + 0.5));
+
+	bool passed = true;
+	for (const auto &result : results)
+	{
+		const JsonValue &scene_baseline = target_baseline.prop(result.name);
+		if (!scene_baseline.is_object())
+		{
+			Console::write_line("%1: no baseline", result.name);
+			continue;
+		}
+
+		double baseline_throughput = scene_baseline.prop("items_per_second").to_double();
+		double baseline_gpu = scene_baseline.prop("gpu_median_ms").to_double();
+
+		bool regressed = false;
+		std::string line = result.name + ":";
+		if (baseline_throughput > 0.0)
+		{
+			double change = result.items_per_second / baseline_throughput - 1.0;
+			line += string_format(" throughput %1%%", StringHelp::double_to_text(change * 100.0, 1));
+			regressed = regressed || change < -settings.tolerance;
+		}
+		if (baseline_gpu > 0.0 && result.gpu_median_ms > 0.0)
+		{
+			double change = result.gpu_median_ms / baseline_gpu - 1.0;
+			line += string_format(", gpu time %1%%", StringHelp::double_to_text(change * 100.0, 1));
+			regressed = regressed || change > settings.tolerance;
+		}
+		if (regressed)
+		{
+			line += " REGRESSION";
+			passed = false;
+		}
+		Console::write_line(line);
+	}
+	return passed;
+}
+
+void TestApp::save_baseline(const std::vector<SceneResult> &results)
+{
+	// Baselines for other targets in the same file are kept
+	JsonValue baseline = JsonValue::object();
+	if (FileHelp::file_exists(settings.save_baseline_filename))
+		baseline = JsonValue::parse(File::read_text(settings.save_baseline_filename));
+
+	JsonValue &target_baseline = baseline.prop(settings.target);
+	if (!target_baseline.is_object())
+		target_baseline = JsonValue::object();
+
+	for (const auto &result : results)
+	{
+		JsonValue scene_baseline = JsonValue::object();
+		scene_baseline.prop("unit") = JsonValue::string(result.unit);
+		scene_baseline.prop("items_per_second") = JsonValue::number(result.items_per_second);
+		scene_baseline.prop("cpu_median_ms") = JsonValue::number(result.cpu_median_ms);
+		if (result.gpu_median_ms >= 0.0)
+			scene_baseline.prop("gpu_median_ms") = JsonValue::number(result.gpu_median_ms);
+		target_baseline.prop(result.name) = scene_baseline;
+	}
+
+	File::write_text(settings.save_baseline_filename, baseline.to_json());
+	Console::write_line("Baseline for %1 written to %2", settings.target, settings.save_baseline_filename);
+}
+
+double TestApp::percentile(std::vector<double> values, double fraction)
+{
+	if (values.empty())
+		return 0.0;
+
+	std::sort(values.begin(), values.end());
+	size_t index = std::min((size_t)(fraction * (values.size() - 1) + 0.5), values.size() - 1);
+	return values[index];
+}
@@ -0,0 +1,118 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include <ClanLib/core.h>
+#include <ClanLib/display.h>
+#include <ClanLib/gl.h>
+#include <ClanLib/ui.h>
+#ifdef WIN32
+#include <ClanLib/d3d.h>
+#endif
+#include <chrono>
+#include <algorithm>
+
+using namespace clan;
+
+/// \brief A workload rendered once per benchmark frame
+class BenchmarkScene
+{
+public:
+	virtual ~BenchmarkScene() { }
+
+	virtual std::string get_name() const = 0;
+
+	/// \brief Name of the counted item, such as "sprites" or "glyphs"
+	virtual std::string get_unit() const = 0;
+
+	virtual int get_items_per_frame() const = 0;
+
+	virtual void render(Canvas &canvas, int frame) = 0;
+};
+
+std::unique_ptr<BenchmarkScene> create_sprite_scene(Canvas &canvas);
+std::unique_ptr<BenchmarkScene> create_text_scene(Canvas &canvas);
+std::unique_ptr<BenchmarkScene> create_path_scene(Canvas &canvas);
+std::unique_ptr<BenchmarkScene> create_view_scene(Canvas &canvas);
+
+class SceneResult
+{
+public:
+	std::string name;
+	std::string unit;
+	int frames = 0;
+	double cpu_median_ms = 0.0;
+	double cpu_p90_ms = 0.0;
+	double gpu_median_ms = -1.0;
+	double gpu_p90_ms = -1.0;
+	double items_per_second = 0.0;
+};
+
+class BenchmarkSettings
+{
+public:
+	std::string target = "gl3";
+	std::string filter;
+	std::string baseline_filename;
+	std::string save_baseline_filename;
+	int width = 1280;
+	int height = 720;
+	int warmup_frames = 30;
+	int frames = 300;
+	double tolerance = 0.1;
+	bool onscreen = false;
+};
+
+class TestApp
+{
+public:
+	int main(const std::vector<std::string> &args);
+
+private:
+	bool parse_arguments(const std::vector<std::string> &args);
+	void create_render_target();
+	SceneResult run_scene(BenchmarkScene &scene);
+	void end_frame();
+	void print_result(const SceneResult &result);
+	bool compare_baseline(const std::vector<SceneResult> &results);
+	void save_baseline(const std::vector<SceneResult> &results);
+
+	static double percentile(std::vector<double> values, double fraction);
+
+	BenchmarkSettings settings;
+
+	DisplayWindow window;
+	Canvas window_canvas;
+	Canvas canvas;
+	Texture2D target_texture;
+
+	static const int max_queries_in_flight = 4;
+	std::vector<TimerQuery> timer_queries;
+};
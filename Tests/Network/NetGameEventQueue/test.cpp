@@ -0,0 +1,165 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include <ClanLib/core.h>
+#include <ClanLib/network.h>
+#include "Network/NetGame/network_event_queue.h"
+#include <thread>
+
+using namespace clan;
+
+const int producer_count = 8;
+const int events_per_producer = 100000;
+
+void test_order();
+void test_stress();
+void fail();
+
+int main(int, char**)
+{
+	ConsoleWindow console("Console");
+
+	try
+	{
+		Console::write_line("ClanLib Test Suite:");
+		Console::write_line("-------------------");
+		Console::write_line("Directory: Network/NetGame");
+
+		test_order();
+		test_stress();
+
+		Console::write_line("All Tests Complete");
+		console.display_close_message();
+	}
+	catch (Exception &error)
+	{
+		Console::write_line("Exception caught:");
+		Console::write_line(error.message);
+		console.display_close_message();
+		return -1;
+	}
+	return 0;
+}
+
+NetGameNetworkEvent make_event(int producer, int sequence)
+{
+	return NetGameNetworkEvent((NetGameConnection *)(intptr_t)(producer + 1), NetGameEvent("seq", { sequence }));
+}
+
+void test_order()
+{
+	Console::write_line("   Function: NetGameNetworkEventQueue single thread order");
+
+	NetGameNetworkEventQueue queue;
+	std::vector<NetGameNetworkEvent> events;
+
+	queue.drain(events);
+	if (!events.empty())
+		fail();
+
+	// Several rounds so later pushes run on recycled nodes
+	for (int round = 0; round < 4; round++)
+	{
+		int count = 10 + round * 7;
+		for (int i = 0; i < count; i++)
+			queue.push(make_event(0, i));
+
+		events.clear();
+		queue.drain(events);
+		if ((int)events.size() != count)
+			fail();
+		for (int i = 0; i < count; i++)
+		{
+			if (events[i].connection != (NetGameConnection *)(intptr_t)1 || events[i].game_event.get_argument(0).get_integer() != i)
+				fail();
+		}
+	}
+}
+
+void test_stress()
+{
+	Console::write_line("   Function: NetGameNetworkEventQueue many producers");
+
+	NetGameNetworkEventQueue queue;
+	std::atomic<int> producers_done(0);
+
+	std::vector<std::thread> producers;
+	for (int p = 0; p < producer_count; p++)
+	{
+		producers.push_back(std::thread([&queue, &producers_done, p]()
+		{
+			for (int i = 0; i < events_per_producer; i++)
+				queue.push(make_event(p, i));
+			producers_done++;
+		}));
+	}
+
+	// Each producer's events must arrive exactly once and in the order it pushed them
+	std::vector<int> next_sequence(producer_count, 0);
+	std::vector<NetGameNetworkEvent> events;
+	int received = 0;
+	bool error = false;
+	while (true)
+	{
+		bool done = producers_done == producer_count;
+
+		events.clear();
+		queue.drain(events);
+		for (auto &e : events)
+		{
+			int producer = (int)(intptr_t)e.connection - 1;
+			if (producer < 0 || producer >= producer_count || e.type != NetGameNetworkEvent::event_received || e.game_event.get_argument(0).get_integer() != next_sequence[producer])
+				error = true;
+			else
+				next_sequence[producer]++;
+		}
+		received += (int)events.size();
+
+		if (done && events.empty())
+			break;
+		if (events.empty())
+			std::this_thread::yield();
+	}
+
+	for (auto &producer : producers)
+		producer.join();
+
+	if (error || received != producer_count * events_per_producer)
+		fail();
+	for (int p = 0; p < producer_count; p++)
+	{
+		if (next_sequence[p] != events_per_producer)
+			fail();
+	}
+}
+
+void fail()
+{
+	throw Exception("Failed Test");
+}
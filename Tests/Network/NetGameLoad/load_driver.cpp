@@ -0,0 +1,222 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "test.h"
+
+struct LoadDriver::SimulatedClient
+{
+	NetGameClient client;
+	SlotContainer slots;
+	int id = 0;
+	bool connected = false;
+	bool disconnected = false;
+
+	/// \brief Index of the next trace event to send and the time the current trace loop started
+	size_t next_event = 0;
+	unsigned int loop_start_us = 0;
+};
+
+LoadDriver::LoadDriver(const LoadSettings &settings, const EventTrace &trace, int first_client, int client_count)
+	: settings(settings), trace(trace), first_client(first_client), client_count(client_count), stop_flag(false), replay_flag(false), connect_done(false), connected_count(0), time_base(std::chrono::steady_clock::now())
+{
+}
+
+LoadDriver::~LoadDriver()
+{
+	stop();
+}
+
+void LoadDriver::start()
+{
+	thread = std::thread(&LoadDriver::thread_main, this);
+}
+
+void LoadDriver::begin_replay()
+{
+	replay_flag = true;
+}
+
+void LoadDriver::stop()
+{
+	stop_flag = true;
+	if (thread.joinable())
+		thread.join();
+}
+
+void LoadDriver::thread_main()
+{
+	try
+	{
+		connect_clients();
+		connect_done = true;
+
+		while (!stop_flag)
+		{
+			bool busy = process_clients(replay_flag);
+			if (!busy)
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+		for (auto &client : clients)
+			client->client.disconnect();
+	}
+	catch (const Exception &e)
+	{
+		Console::write_line("Load driver failed: %1", e.message);
+		connect_done = true;
+	}
+}
+
+void LoadDriver::connect_clients()
+{
+	// Each driver paces its share of the total connect rate so the server's accept queue is not flooded
+	double connects_per_second = std::max((double)settings.connect_rate / settings.driver_threads, 1.0);
+	auto connect_start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < client_count && !stop_flag; i++)
+	{
+		std::unique_ptr<SimulatedClient> client(new SimulatedClient());
+		client->id = first_client + i;
+
+		SimulatedClient *c = client.get();
+		c->slots.connect(c->client.sig_connected(), [this, c]()
+		{
+			c->connected = true;
+			c->loop_start_us = get_time_us();
+			results.connected++;
+			connected_count++;
+		});
+		c->slots.connect(c->client.sig_disconnected(), [this, c]()
+		{
+			c->disconnected = true;
+			results.disconnected++;
+		});
+		c->slots.connect(c->client.sig_event_received(), [this](const NetGameEvent &e)
+		{
+			if (e.get_argument_count() == 0)
+				return;
+			unsigned int sent_us = e.get_argument(0).get_uinteger();
+			results.samples[e.get_name()].push_back(get_time_us() - sent_us);
+			results.events_received++;
+		});
+
+		try
+		{
+			c->client.connect(settings.host, settings.port);
+		}
+		catch (const Exception &)
+		{
+			c->disconnected = true;
+			results.disconnected++;
+		}
+		clients.push_back(std::move(client));
+
+		auto due = connect_start + std::chrono::microseconds((int64_t)((i + 1) * 1000000.0 / connects_per_second));
+		while (std::chrono::steady_clock::now() < due && !stop_flag)
+		{
+			if (!process_clients(false))
+				std::this_thread::sleep_for(std::chrono::microseconds(500));
+		}
+	}
+
+	// Give the remaining connection attempts a moment to complete
+	auto wait_end = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+	while (connected_count + results.disconnected < (int)clients.size() && std::chrono::steady_clock::now() < wait_end && !stop_flag)
+	{
+		if (!process_clients(false))
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+}
+
+bool LoadDriver::process_clients(bool replaying)
+{
+	bool busy = false;
+	unsigned int now_us = get_time_us();
+	for (auto &client : clients)
+	{
+		client->client.process_events();
+		if (replaying && client->connected && !client->disconnected)
+			busy = replay(*client, now_us) || busy;
+	}
+	return busy;
+}
+
+bool LoadDriver::replay(SimulatedClient &client, unsigned int now_us)
+{
+	if (trace.events.empty())
+		return false;
+
+	bool sent = false;
+	while (true)
+	{
+		const TraceEvent &trace_event = trace.events[client.next_event];
+		if ((int)(now_us - client.loop_start_us) < trace_event.offset_ms * 1000)
+			break;
+
+		send_trace_event(client, trace_event, now_us);
+		sent = true;
+
+		client.next_event++;
+		if (client.next_event == trace.events.size())
+		{
+			client.next_event = 0;
+			client.loop_start_us += trace.loop_ms * 1000;
+		}
+	}
+	return sent;
+}
+
+void LoadDriver::send_trace_event(SimulatedClient &client, const TraceEvent &trace_event, unsigned int now_us)
+{
+	NetGameEvent e(trace_event.name);
+	e.add_argument(now_us);
+	e.add_argument(client.id);
+	if (trace_event.payload_size > 0)
+		e.add_argument(DataBuffer(trace_event.payload_size));
+	client.client.send_event(e);
+	results.events_sent++;
+}
+
+unsigned int LoadDriver::get_time_us() const
+{
+	return (unsigned int)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - time_base).count();
+}
+
+void LatencySamples::merge(const LatencySamples &other)
+{
+	for (const auto &it : other.samples)
+	{
+		std::vector<unsigned int> &target = samples[it.first];
+		target.insert(target.end(), it.second.begin(), it.second.end());
+	}
+	events_sent += other.events_sent;
+	events_received += other.events_received;
+	connected += other.connected;
+	disconnected += other.disconnected;
+}
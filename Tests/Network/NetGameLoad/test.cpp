@@ -0,0 +1,384 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "test.h"
+#if defined(WIN32)
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+int main(int argc, char **argv)
+{
+	ConsoleWindow console("Console");
+
+	std::vector<std::string> args;
+	for (int i = 1; i < argc; i++)
+		args.push_back(argv[i]);
+
+	try
+	{
+		TestApp app;
+		return app.main(args);
+	}
+	catch (const Exception &e)
+	{
+		Console::write_line("Exception caught: %1", e.message);
+		return 1;
+	}
+}
+
+int TestApp::main(const std::vector<std::string> &args)
+{
+	if (!parse_arguments(args))
+		return 1;
+
+	EventTrace trace = settings.trace_filename.empty() ? EventTrace::create_default() : EventTrace::load(settings.trace_filename);
+	if (trace.events.empty())
+		throw Exception("Trace contains no events");
+
+	NetGameClient::set_shared_io_thread_count(settings.client_io_threads);
+
+	ResourceUsage idle = ResourceUsage::capture();
+
+	if (settings.start_server)
+		start_server();
+
+	Console::write_line("Connecting %1 clients to %2:%3 from %4 threads", settings.clients, settings.host, settings.port, settings.driver_threads);
+
+	std::vector<std::unique_ptr<LoadDriver>> drivers;
+	int first_client = 0;
+	for (int i = 0; i < settings.driver_threads; i++)
+	{
+		int count = settings.clients / settings.driver_threads + (i < settings.clients % settings.driver_threads ? 1 : 0);
+		drivers.push_back(std::unique_ptr<LoadDriver>(new LoadDriver(settings, trace, first_client, count)));
+		first_client += count;
+	}
+
+	for (auto &driver : drivers)
+		driver->start();
+
+	while (true)
+	{
+		server.process_events();
+
+		bool done = true;
+		for (auto &driver : drivers)
+			done = done && driver->is_connect_done();
+		if (done)
+			break;
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	int connected = 0;
+	for (auto &driver : drivers)
+		connected += driver->get_connected_count();
+	Console::write_line("%1 of %2 clients connected", connected, settings.clients);
+
+	ResourceUsage connected_usage = ResourceUsage::capture();
+
+	Console::write_line("Replaying trace of %1 events for %2 seconds", (int)trace.events.size(), settings.duration_seconds);
+
+	server_events.clear();
+	auto run_start = std::chrono::steady_clock::now();
+	auto run_end = run_start + std::chrono::seconds(settings.duration_seconds);
+	for (auto &driver : drivers)
+		driver->begin_replay();
+
+	while (std::chrono::steady_clock::now() < run_end)
+	{
+		server.process_events();
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	ResourceUsage done = ResourceUsage::capture();
+	double run_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - run_start).count();
+
+	LatencySamples results;
+	for (auto &driver : drivers)
+	{
+		driver->stop();
+		results.merge(driver->get_results());
+	}
+
+	report(results, run_seconds, idle, connected_usage, done);
+
+	if (settings.start_server)
+		server.stop();
+
+	return 0;
+}
+
+namespace
+{
+	bool parse_option(const std::string &arg, const std::string &name, std::string &value)
+	{
+		if (arg.compare(0, name.length() + 1, name + "=") != 0)
+			return false;
+		value = arg.substr(name.length() + 1);
+		return true;
+	}
+
+	void print_usage()
+	{
+		Console::write_line("Usage: netgameload [options]");
+		Console::write_line("  --host=<name>              Server to connect to (default localhost)");
+		Console::write_line("  --port=<port>              Server port (default 4556)");
+		Console::write_line("  --no-server                Do not start an in-process echo server");
+		Console::write_line("  --clients=<n>              Simulated clients (default 1000)");
+		Console::write_line("  --threads=<n>              Threads driving the clients (default 4)");
+		Console::write_line("  --client-io-threads=<n>    Socket threads shared by all clients (default 4, 0 = one thread per client)");
+		Console::write_line("  --server-io-threads=<n>    Socket threads of the in-process server (default 4)");
+		Console::write_line("  --connect-rate=<n>         New connections per second (default 500)");
+		Console::write_line("  --duration=<seconds>       Length of the replay (default 10)");
+		Console::write_line("  --trace=<file>             Event trace to replay (default: built-in movement/action/chat mix)");
+	}
+}
+
+bool TestApp::parse_arguments(const std::vector<std::string> &args)
+{
+	for (const auto &arg : args)
+	{
+		std::string value;
+		if (parse_option(arg, "--host", value))
+			settings.host = value;
+		else if (parse_option(arg, "--port", value))
+			settings.port = value;
+		else if (arg == "--no-server")
+			settings.start_server = false;
+		else if (parse_option(arg, "--clients", value))
+			settings.clients = std::max(StringHelp::text_to_int(value), 1);
+		else if (parse_option(arg, "--threads", value))
+			settings.driver_threads = std::max(StringHelp::text_to_int(value), 1);
+		else if (parse_option(arg, "--client-io-threads", value))
+			settings.client_io_threads = std::max(StringHelp::text_to_int(value), 0);
+		else if (parse_option(arg, "--server-io-threads", value))
+			settings.server_io_threads = std::max(StringHelp::text_to_int(value), 0);
+		else if (parse_option(arg, "--connect-rate", value))
+			settings.connect_rate = std::max(StringHelp::text_to_int(value), 1);
+		else if (parse_option(arg, "--duration", value))
+			settings.duration_seconds = std::max(StringHelp::text_to_int(value), 1);
+		else if (parse_option(arg, "--trace", value))
+			settings.trace_filename = value;
+		else
+		{
+			print_usage();
+			return false;
+		}
+	}
+	settings.driver_threads = std::min(settings.driver_threads, settings.clients);
+	return true;
+}
+
+void TestApp::start_server()
+{
+	NetGameLoadLimits limits;
+	limits.listen_backlog = std::max(settings.connect_rate, 128);
+	server.set_load_limits(limits);
+	server.set_io_thread_count(settings.server_io_threads);
+
+	slots.connect(server.sig_event_received(), this, &TestApp::on_server_event);
+	server.start(settings.port);
+}
+
+void TestApp::on_server_event(NetGameConnection *connection, const NetGameEvent &e)
+{
+	// Echo the event so the client can measure the round trip from the timestamp in the first argument
+	server_events[e.get_name()]++;
+	connection->send_event(e);
+}
+
+namespace
+{
+	std::string pad_left(const std::string &text, size_t width)
+	{
+		return text.length() < width ? std::string(width - text.length(), ' ') + text : text;
+	}
+
+	std::string pad_right(const std::string &text, size_t width)
+	{
+		return text.length() < width ? text + std::string(width - text.length(), ' ') : text;
+	}
+
+	double percentile_ms(const std::vector<unsigned int> &sorted, double fraction)
+	{
+		size_t index = std::min((size_t)(fraction * sorted.size()), sorted.size() - 1);
+		return sorted[index] / 1000.0;
+	}
+}
+
+void TestApp::report(const LatencySamples &results, double run_seconds, const ResourceUsage &idle, const ResourceUsage &connected, const ResourceUsage &done)
+{
+	Console::write_line("");
+	Console::write_line("Connections: %1 established, %2 lost", results.connected, results.disconnected);
+	Console::write_line("Client events: %1 sent, %2 echoed (%3/s)", (int)results.events_sent, (int)results.events_received, (int)(results.events_received / run_seconds));
+
+	if (settings.start_server)
+	{
+		uint64_t total = 0;
+		for (const auto &it : server_events)
+			total += it.second;
+		Console::write_line("Server throughput: %1 events/s received and echoed", (int)(total / run_seconds));
+	}
+
+	Console::write_line("");
+	Console::write_line("Round trip latency in ms (includes the driver thread loop delay):");
+	Console::write_line("  %1 %2 %3 %4 %5 %6 %7", pad_right("event", 16), pad_left("count", 9), pad_left("p50", 8), pad_left("p90", 8), pad_left("p99", 8), pad_left("p99.9", 8), pad_left("max", 8));
+	for (const auto &it : results.samples)
+	{
+		std::vector<unsigned int> sorted = it.second;
+		if (sorted.empty())
+			continue;
+		std::sort(sorted.begin(), sorted.end());
+
+		Console::write_line("  %1 %2 %3 %4 %5 %6 %7",
+			pad_right(it.first, 16),
+			pad_left(StringHelp::int_to_text((int)sorted.size()), 9),
+			pad_left(StringHelp::double_to_text(percentile_ms(sorted, 0.5), 2), 8),
+			pad_left(StringHelp::double_to_text(percentile_ms(sorted, 0.9), 2), 8),
+			pad_left(StringHelp::double_to_text(percentile_ms(sorted, 0.99), 2), 8),
+			pad_left(StringHelp::double_to_text(percentile_ms(sorted, 0.999), 2), 8),
+			pad_left(StringHelp::double_to_text(sorted.back() / 1000.0, 2), 8));
+	}
+
+	// Client and server share the process unless --no-server is used, so these are totals for both ends of every connection
+	if (results.connected > 0)
+	{
+		double memory_per_connection = ((double)connected.resident_bytes - (double)idle.resident_bytes) / results.connected;
+		double cpu_per_connection = (done.cpu_seconds - connected.cpu_seconds) * 1000.0 / run_seconds / results.connected;
+
+		Console::write_line("");
+		Console::write_line("Resources per connection%1:", settings.start_server ? " (client and server)" : "");
+		Console::write_line("  Memory: %1 KB", StringHelp::double_to_text(memory_per_connection / 1024.0, 1));
+		Console::write_line("  CPU: %1 ms per second", StringHelp::double_to_text(cpu_per_connection, 3));
+		Console::write_line("  Process: %1 MB resident, %2 s CPU", (int)(done.resident_bytes / (1024 * 1024)), StringHelp::double_to_text(done.cpu_seconds, 2));
+	}
+}
+
+EventTrace EventTrace::load(const std::string &filename)
+{
+	EventTrace trace;
+	std::vector<std::string> lines = StringHelp::split_text(File::read_text(filename), "\n");
+	for (const auto &line : lines)
+	{
+		std::string text = StringHelp::trim(line);
+		if (text.empty() || text[0] == '#')
+			continue;
+
+		std::vector<std::string> fields = StringHelp::split_text(text, " ");
+		if (fields.size() != 3)
+			throw Exception(string_format("Invalid trace line in %1: %2", filename, text));
+
+		TraceEvent trace_event;
+		trace_event.offset_ms = StringHelp::text_to_int(fields[0]);
+		trace_event.name = fields[1];
+		trace_event.payload_size = StringHelp::text_to_int(fields[2]);
+		trace.events.push_back(trace_event);
+	}
+
+	std::stable_sort(trace.events.begin(), trace.events.end(), [](const TraceEvent &a, const TraceEvent &b) { return a.offset_ms < b.offset_ms; });
+	if (!trace.events.empty())
+		trace.loop_ms = trace.events.back().offset_ms + 1;
+	return trace;
+}
+
+EventTrace EventTrace::create_default()
+{
+	// Two seconds of a typical action game client: movement updates at 20 Hz, an action twice a second and one chat line
+	EventTrace trace;
+	trace.loop_ms = 2000;
+	for (int t = 0; t < trace.loop_ms; t += 50)
+	{
+		TraceEvent move;
+		move.offset_ms = t;
+		move.name = "move";
+		move.payload_size = 24;
+		trace.events.push_back(move);
+
+		if (t % 500 == 0)
+		{
+			TraceEvent action;
+			action.offset_ms = t;
+			action.name = "action";
+			action.payload_size = 40;
+			trace.events.push_back(action);
+		}
+	}
+
+	TraceEvent chat;
+	chat.offset_ms = 1000;
+	chat.name = "chat";
+	chat.payload_size = 80;
+	trace.events.push_back(chat);
+
+	std::stable_sort(trace.events.begin(), trace.events.end(), [](const TraceEvent &a, const TraceEvent &b) { return a.offset_ms < b.offset_ms; });
+	return trace;
+}
+
+ResourceUsage ResourceUsage::capture()
+{
+	ResourceUsage usage;
+#if defined(WIN32)
+	FILETIME creation_time, exit_time, kernel_time, user_time;
+	if (GetProcessTimes(GetCurrentProcess(), &creation_time, &exit_time, &kernel_time, &user_time))
+	{
+		uint64_t kernel = ((uint64_t)kernel_time.dwHighDateTime << 32) | kernel_time.dwLowDateTime;
+		uint64_t user = ((uint64_t)user_time.dwHighDateTime << 32) | user_time.dwLowDateTime;
+		usage.cpu_seconds = (kernel + user) / 10000000.0;
+	}
+
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		usage.resident_bytes = counters.WorkingSetSize;
+#else
+	rusage ru;
+	if (getrusage(RUSAGE_SELF, &ru) == 0)
+	{
+		usage.cpu_seconds = ru.ru_utime.tv_sec + ru.ru_stime.tv_sec + (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1000000.0;
+#if defined(__APPLE__)
+		usage.resident_bytes = ru.ru_maxrss; // Peak, in bytes on macOS
+#endif
+	}
+
+#if !defined(__APPLE__)
+	FILE *statm = fopen("/proc/self/statm", "r");
+	if (statm)
+	{
+		unsigned long size = 0, resident = 0;
+		if (fscanf(statm, "%lu %lu", &size, &resident) == 2)
+			usage.resident_bytes = (uint64_t)resident * sysconf(_SC_PAGESIZE);
+		fclose(statm);
+	}
+#endif
+#endif
+	return usage;
+}
@@ -0,0 +1,164 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include <ClanLib/core.h>
+#include <ClanLib/network.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <thread>
+
+using namespace clan;
+
+/// \brief One event of a recorded trace
+class TraceEvent
+{
+public:
+	int offset_ms = 0;
+	std::string name;
+	int payload_size = 0;
+};
+
+/// \brief Sequence of events a simulated client sends, replayed in a loop
+///
+/// Trace files hold one event per line: the time in milliseconds since the start of the trace,
+/// the event name and the payload size in bytes. Lines starting with # are comments.
+class EventTrace
+{
+public:
+	static EventTrace load(const std::string &filename);
+	static EventTrace create_default();
+
+	std::vector<TraceEvent> events;
+
+	/// \brief Length of one replay loop in milliseconds
+	int loop_ms = 0;
+};
+
+class LoadSettings
+{
+public:
+	std::string host = "localhost";
+	std::string port = "4556";
+	std::string trace_filename;
+	bool start_server = true;
+	int clients = 1000;
+	int driver_threads = 4;
+	int client_io_threads = 4;
+	int server_io_threads = 4;
+	int connect_rate = 500;
+	int duration_seconds = 10;
+};
+
+/// \brief Round trip times of echoed events, in microseconds, grouped by event name
+class LatencySamples
+{
+public:
+	std::map<std::string, std::vector<unsigned int>> samples;
+	uint64_t events_sent = 0;
+	uint64_t events_received = 0;
+	int connected = 0;
+	int disconnected = 0;
+
+	void merge(const LatencySamples &other);
+};
+
+/// \brief Simulates a group of clients from one thread
+///
+/// The thread first connects its clients, then replays the trace on every client once begin_replay() is called.
+class LoadDriver
+{
+public:
+	LoadDriver(const LoadSettings &settings, const EventTrace &trace, int first_client, int client_count);
+	~LoadDriver();
+
+	void start();
+	void begin_replay();
+	void stop();
+
+	/// \brief Returns the measurements. Only valid after stop().
+	const LatencySamples &get_results() const { return results; }
+
+	int get_connected_count() const { return connected_count; }
+	bool is_connect_done() const { return connect_done; }
+
+private:
+	struct SimulatedClient;
+
+	void thread_main();
+	void connect_clients();
+	bool process_clients(bool replaying);
+	bool replay(SimulatedClient &client, unsigned int now_us);
+	void send_trace_event(SimulatedClient &client, const TraceEvent &trace_event, unsigned int now_us);
+	unsigned int get_time_us() const;
+
+	const LoadSettings &settings;
+	const EventTrace &trace;
+	int first_client;
+	int client_count;
+	std::vector<std::unique_ptr<SimulatedClient>> clients;
+
+	std::thread thread;
+	std::atomic<bool> stop_flag;
+	std::atomic<bool> replay_flag;
+	std::atomic<bool> connect_done;
+	std::atomic<int> connected_count;
+	std::chrono::steady_clock::time_point time_base;
+	LatencySamples results;
+};
+
+/// \brief Process wide CPU time and resident memory
+class ResourceUsage
+{
+public:
+	static ResourceUsage capture();
+
+	double cpu_seconds = 0.0;
+	uint64_t resident_bytes = 0;
+};
+
+class TestApp
+{
+public:
+	int main(const std::vector<std::string> &args);
+
+private:
+	bool parse_arguments(const std::vector<std::string> &args);
+	void start_server();
+	void on_server_event(NetGameConnection *connection, const NetGameEvent &e);
+	void report(const LatencySamples &results, double run_seconds, const ResourceUsage &idle, const ResourceUsage &connected, const ResourceUsage &done);
+
+	LoadSettings settings;
+	NetGameServer server;
+	SlotContainer slots;
+	std::map<std::string, uint64_t> server_events;
+};
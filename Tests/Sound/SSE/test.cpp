@@ -52,6 +52,7 @@ int TestApp::main()
 		Console::write_line("For clanSound SSE functions");
 
 		do_test();
+		do_benchmark();
 		
 		Console::write_line("All Tests Complete");
 		console.display_close_message();
@@ -217,6 +218,103 @@ void TestApp::do_test()
 	SoundSSE::mix_many_to_one(in_float, volumes, 2, data_size, out2_float_buffer1);
 	check_float(out_float_buffer1, out2_float_buffer1, data_size);
 
+	memcpy(out_float_buffer1, in_float_buffer2, sizeof(out_float_buffer1));
+	mix_one_to_one_ramp(in_float_buffer1, data_size, out_float_buffer1, 0.34f, 0.82f);
+	memcpy(out2_float_buffer1, in_float_buffer2, sizeof(out2_float_buffer1));
+	SoundSSE::mix_one_to_one_ramp(in_float_buffer1, data_size, out2_float_buffer1, 0.34f, 0.82f);
+	check_float(out_float_buffer1, out2_float_buffer1, data_size);
+
+	memcpy(out_float_buffer1, in_float_buffer1, sizeof(out_float_buffer1));
+	multiply_float_ramp(out_float_buffer1, data_size, 0.82f, 0.34f);
+	memcpy(out2_float_buffer1, in_float_buffer1, sizeof(out2_float_buffer1));
+	SoundSSE::multiply_float_ramp(out2_float_buffer1, data_size, 0.82f, 0.34f);
+	check_float(out_float_buffer1, out2_float_buffer1, data_size);
+
+	for (int cnt = 0; cnt < data_size; cnt++)
+	{
+		out_float_buffer1[cnt] = in_float_buffer1[cnt] * 3.0f;
+		out_float_buffer2[cnt] = in_float_buffer2[cnt] * 3.0f;
+	}
+	memcpy(out2_float_buffer1, out_float_buffer1, sizeof(out2_float_buffer1));
+	clamp_float(out_float_buffer1, data_size, -1.0f, 1.0f);
+	SoundSSE::clamp_float(out2_float_buffer1, data_size, -1.0f, 1.0f);
+	check_float(out_float_buffer1, out2_float_buffer1, data_size);
+
+	// Out of range samples must saturate rather than wrap around
+	memcpy(out2_float_buffer1, out_float_buffer1, sizeof(out2_float_buffer1));
+	memcpy(out2_float_buffer2, out_float_buffer2, sizeof(out2_float_buffer2));
+	clamp_float(out2_float_buffer1, data_size, -1.0f, 1.0f);
+	clamp_float(out2_float_buffer2, data_size, -1.0f, 1.0f);
+	memset(out_16_buffer1, 0, sizeof(out_16_buffer1));
+	pack_16bit_stereo(out2_float, data_size/2, out_16_buffer1);
+	out_float_buffer1[0] = 1.0e10f;
+	out_float_buffer2[0] = -1.0e10f;
+	out2_float_buffer1[0] = 1.0f;
+	out2_float_buffer2[0] = -1.0f;
+	memset(out2_16_buffer1, 0, sizeof(out2_16_buffer1));
+	SoundSSE::pack_16bit_stereo(out_float, data_size/2, out2_16_buffer1);
+	check_16(out_16_buffer1 + 2, out2_16_buffer1 + 2, data_size - 2);
+	if (out2_16_buffer1[0] != 32767 || out2_16_buffer1[1] != -32767)
+		fail();
+}
+
+void TestApp::do_benchmark()
+{
+	// Mixes a fragment of 128 stereo voices, like SoundOutput_Impl::mix_fragment does
+	const int fragment_size = 1024;
+	const int num_voices = 128;
+	const int num_fragments = 200;
+
+	float *voice = (float *)SoundSSE::aligned_alloc(sizeof(float) * fragment_size);
+	float *mix_left = (float *)SoundSSE::aligned_alloc(sizeof(float) * fragment_size);
+	float *mix_right = (float *)SoundSSE::aligned_alloc(sizeof(float) * fragment_size);
+	float *mix[2] = { mix_left, mix_right };
+	short *packed = (short *)SoundSSE::aligned_alloc(sizeof(short) * fragment_size * 2);
+	for (int i = 0; i < fragment_size; i++)
+		voice[i] = std::sin(i * 0.01f);
+
+	float start_volume[2] = { 0.3f, 0.7f };
+	float end_volume[2] = { 0.4f, 0.6f };
+
+	uint64_t start = System::get_microseconds();
+	for (int fragment = 0; fragment < num_fragments; fragment++)
+	{
+		SoundSSE::set_float(mix_left, fragment_size, 0.0f);
+		SoundSSE::set_float(mix_right, fragment_size, 0.0f);
+		for (int v = 0; v < num_voices; v++)
+			SoundSSE::mix_one_to_many_ramp(voice, fragment_size, mix, start_volume, end_volume, 2);
+		SoundSSE::multiply_float_ramp(mix_left, fragment_size, 0.9f, 1.0f);
+		SoundSSE::multiply_float_ramp(mix_right, fragment_size, 0.9f, 1.0f);
+		SoundSSE::clamp_float(mix_left, fragment_size, -1.0f, 1.0f);
+		SoundSSE::clamp_float(mix_right, fragment_size, -1.0f, 1.0f);
+		SoundSSE::pack_16bit_stereo(mix, fragment_size, packed);
+	}
+	uint64_t simd_time = System::get_microseconds() - start;
+
+	start = System::get_microseconds();
+	for (int fragment = 0; fragment < num_fragments; fragment++)
+	{
+		set_float(mix_left, fragment_size, 0.0f);
+		set_float(mix_right, fragment_size, 0.0f);
+		for (int v = 0; v < num_voices; v++)
+		{
+			mix_one_to_one_ramp(voice, fragment_size, mix_left, start_volume[0], end_volume[0]);
+			mix_one_to_one_ramp(voice, fragment_size, mix_right, start_volume[1], end_volume[1]);
+		}
+		multiply_float_ramp(mix_left, fragment_size, 0.9f, 1.0f);
+		multiply_float_ramp(mix_right, fragment_size, 0.9f, 1.0f);
+		clamp_float(mix_left, fragment_size, -1.0f, 1.0f);
+		clamp_float(mix_right, fragment_size, -1.0f, 1.0f);
+		pack_16bit_stereo(mix, fragment_size, packed);
+	}
+	uint64_t scalar_time = System::get_microseconds() - start;
+
+	Console::write_line("Mixing %1 fragments of %2 voices: SIMD %3 us, scalar %4 us", num_fragments, num_voices, (int)simd_time, (int)scalar_time);
+
+	SoundSSE::aligned_free(voice);
+	SoundSSE::aligned_free(mix_left);
+	SoundSSE::aligned_free(mix_right);
+	SoundSSE::aligned_free(packed);
 }
 
 void TestApp::check_float(float *aptr, float *bptr, int num)
@@ -403,3 +501,26 @@ void TestApp::unpack_float_mono(float *input, int size, float *output)
 	if(sse_size < size)
 		memcpy(output, input, (size-sse_size)*sizeof(float));
 }
+
+void TestApp::mix_one_to_one_ramp(float *input, int size, float *output, float start_volume, float end_volume)
+{
+	float step = (end_volume - start_volume) / size;
+	for (int i = 0; i < size; i++)
+		output[i] += input[i] * (start_volume + step * i);
+}
+
+void TestApp::multiply_float_ramp(float *channel, int size, float start_volume, float end_volume)
+{
+	float step = (end_volume - start_volume) / size;
+	for (int i = 0; i < size; i++)
+		channel[i] *= start_volume + step * i;
+}
+
+void TestApp::clamp_float(float *channel, int size, float min_value, float max_value)
+{
+	for (int i = 0; i < size; i++)
+	{
+		if (channel[i] > max_value) channel[i] = max_value;
+		else if (channel[i] < min_value) channel[i] = min_value;
+	}
+}
@@ -40,6 +40,7 @@ public:
 
 private:
 	void do_test();
+	void do_benchmark();
 
 	static void unpack_16bit_stereo(short *input, int size, float *output[2]);
 	static void unpack_16bit_mono(short *input, int size, float *output);
@@ -55,6 +56,9 @@ private:
 	static void mix_one_to_one(float *input, int size, float *output, float volume);
 	static void mix_one_to_many(float *input, int size, float **output, float *volume, int channels);
 	static void mix_many_to_one(float **input, float *volume, int channels, int size, float *output);
+	static void mix_one_to_one_ramp(float *input, int size, float *output, float start_volume, float end_volume);
+	static void multiply_float_ramp(float *channel, int size, float start_volume, float end_volume);
+	static void clamp_float(float *channel, int size, float min_value, float max_value);
 
 	void check_16(short *aptr, short *bptr, int num);
 	void check_float(float *aptr, float *bptr, int num);